@@ -68,6 +68,7 @@ start:
         << "| [d] Select FTS pwm trigger position, support on M400                                                           |\n"
         << "| [e] Flight controller sample - set get perception parameters, support on M400                                  |\n"
         << "| [f] Flight controller sample - set cmd start mission, support on M400                                          |\n"
+        << "| [g] Waypoint 3.0 sample - run survey mission generated in memory (not support on M300 RTK)                     |\n"
         << std::endl;
 
     std::cin >> inputSelectSample;
@@ -122,6 +123,9 @@ start:
         case 'f' : // for m400
             DjiTest_FlightControlRunSample(E_DJI_TEST_FLIGHT_CTRL_SAMPLE_SELECT_SET_CMD_START_MISSION);
             goto start;
+        case 'g':
+            DjiTest_WaypointV3RunGeneratedMissionSample();
+            break;
         case 'q':
             break;
         default:
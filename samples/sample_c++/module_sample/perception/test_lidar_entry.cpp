@@ -26,6 +26,9 @@
 #include "test_lidar_entry.hpp"
 #include <dirent.h>
 #include "dji_logger.h"
+#include "utils/util_misc.h"
+#include "telemetry_bus/test_telemetry_bus.h"
+#include "flight_recorder/test_flight_recorder.h"
 #include <iostream>
 #include <fstream>
 #include <string>
@@ -46,6 +49,7 @@
 #define SUBSCRIBE_DATA_TIME_MS                  (1000 * 10)
 #define USER_PERCEPTION_LIRDAR_TASK_STACK_SIZE  (2042)
 #define PCD_FILE_PATH                           "./DJI_cloud_data"
+#define LIDAR_BUS_SLOT_COUNT                    (4)
 
 /* Private types -------------------------------------------------------------*/
 
@@ -56,12 +60,17 @@ static T_DjiMutexHandle queueMutex;
 static T_DjiSemaHandle dataSemaphore;
 static bool stopProcessing = false;
 static T_DjiSemaHandle taskExitSema;
+static uint16_t s_lidarBusTopicId;
+static bool s_isLidarBusTopicAdded = false;
+static uint16_t s_lidarRecordChannelId;
+static bool s_isLidarRecordChannelAdded = false;
 
 /* Private functions declaration ---------------------------------------------*/
 static void DjiTest_PerceptionLidarCallback(uint8_t *recvBuffer, uint32_t bufferLen);
 static std::string DjiTest_getCurrentTimestamp();
 static void DjiTest_WriteLidarFrameToBinaryPcdFile(const T_DjiLidarFrame *frame);
 static void* DjiTest_ProcessLidarDataTask(void* arg);
+static void DjiTest_LidarReplayRecord(const T_DjiTestFlightRecordSample *sample, void *userData);
 
 /* Exported functions definition ---------------------------------------------*/
 void DjiUser_RunLidarDataSubscriptionSample(void) {
@@ -86,6 +95,27 @@ start:
         return;
     }
 
+    returnCode = DjiTest_TelemetryBusAddDefaultTopic("perception/lidar", "dji.perception.lidar", 1, "frame:bytes",
+                                                     sizeof(T_DjiLidarFrame), LIDAR_BUS_SLOT_COUNT,
+                                                     &s_lidarBusTopicId);
+    if (returnCode != DJI_ERROR_SYSTEM_MODULE_CODE_SUCCESS) {
+        USER_LOG_WARN("Add telemetry bus topic error, return code:0x%08X", returnCode);
+    } else {
+        s_isLidarBusTopicAdded = true;
+    }
+
+    {
+        T_DjiTestFlightRecorderChannelInfo channelInfo = {"perception/lidar", "dji.perception.lidar", "frame:bytes"};
+
+        returnCode = DjiTest_FlightRecorderAddChannel(&channelInfo, DjiTest_LidarReplayRecord, nullptr,
+                                                      &s_lidarRecordChannelId);
+        if (returnCode != DJI_ERROR_SYSTEM_MODULE_CODE_SUCCESS) {
+            USER_LOG_WARN("Add flight record channel error, return code:0x%08X", returnCode);
+        } else {
+            s_isLidarRecordChannelAdded = true;
+        }
+    }
+
     std::cout << "start subscribe Lidar data from aircraft" << std::endl;
 
     returnCode = DjiPerception_SubscribeLidarData(DjiTest_PerceptionLidarCallback);
@@ -112,6 +142,10 @@ start:
 
     std::cout << "unsubscribe Lidar data success" << std::endl;
 
+    if (s_isLidarRecordChannelAdded) {
+        DjiTest_FlightRecorderSetReplayHandler(s_lidarRecordChannelId, nullptr, nullptr);
+    }
+
     osalHandler->MutexLock(queueMutex);
     stopProcessing = true;
     osalHandler->MutexUnlock(queueMutex);
@@ -131,6 +165,14 @@ static void DjiTest_PerceptionLidarCallback(uint8_t *LidarFrame, uint32_t buffer
         return;
     }
 
+    if (s_isLidarBusTopicAdded) {
+        DjiTest_TelemetryBusPublish(DjiTest_TelemetryBusGetDefault(), s_lidarBusTopicId, LidarFrame, bufferLen);
+    }
+    if (s_isLidarRecordChannelAdded && DjiTest_FlightRecorderIsRecording()) {
+        DjiTest_FlightRecorderWrite(s_lidarRecordChannelId, ((T_DjiLidarFrame *) LidarFrame)->timeStampNs / 1000,
+                                    nullptr, 0, LidarFrame, bufferLen);
+    }
+
     T_DjiOsalHandler *osalHandler = DjiPlatform_GetOsalHandler();
     T_DjiLidarFrame * curFrame =  (T_DjiLidarFrame *)osalHandler->Malloc(bufferLen);
     memcpy(curFrame, LidarFrame, bufferLen);
@@ -269,4 +311,10 @@ static void* DjiTest_ProcessLidarDataTask(void* arg) {
     osalHandler->SemaphorePost(taskExitSema);
     return nullptr;
 }
+
+static void DjiTest_LidarReplayRecord(const T_DjiTestFlightRecordSample *sample, void *userData) {
+    USER_UTIL_UNUSED(userData);
+    DjiTest_PerceptionLidarCallback(const_cast<uint8_t *>(sample->data), sample->dataLen);
+}
+
 /****************** (C) COPYRIGHT DJI Innovations *****END OF FILE****/
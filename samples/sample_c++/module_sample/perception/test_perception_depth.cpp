@@ -0,0 +1,1026 @@
+ /**
+ ********************************************************************
+ * @file    test_perception_depth.cpp
+ * @brief   Stereo disparity, depth and point cloud estimation on rectified perception image pairs.
+ *
+ * @copyright (c) 2021 DJI. All rights reserved.
+ *
+ * All information contained herein is, and remains, the property of DJI.
+ * The intellectual and technical concepts contained herein are proprietary
+ * to DJI and may be covered by U.S. and foreign patents, patents in process,
+ * and protected by trade secret or copyright law.  Dissemination of this
+ * information, including but not limited to data and other proprietary
+ * material(s) incorporated within the information, in any form, is strictly
+ * prohibited without the express written consent of DJI.
+ *
+ * If you receive this source code without DJI’s authorization, you may not
+ * further disseminate the information, and you must immediately remove the
+ * source code and notify DJI of its removal. DJI reserves the right to pursue
+ * legal actions against you for any loss(es) or damage(s) caused by your
+ * failure to do so.
+ *
+ *********************************************************************
+ */
+
+
+/* Includes ------------------------------------------------------------------*/
+#include <cmath>
+#include <cstring>
+#include <climits>
+#include <new>
+#include <utility>
+#include <initializer_list>
+#include "test_perception_depth.hpp"
+#include "test_perception_recorder.hpp"
+#include "dji_logger.h"
+
+/* Private constants ---------------------------------------------------------*/
+#define PERCEPTION_DEPTH_CENSUS_RADIUS          (2)
+#define PERCEPTION_DEPTH_CENSUS_BITS            (24)
+#define PERCEPTION_DEPTH_SGM_MARGIN             (16)
+#define PERCEPTION_DEPTH_MAX_BLOCK_RADIUS       (7)
+#define PERCEPTION_DEPTH_VECTOR_LANES           (8)
+#define PERCEPTION_DEPTH_PATH_INVALID           (0x3FFF)
+#define PERCEPTION_DEPTH_TASK_STACK_SIZE        (2048)
+#define PERCEPTION_DEPTH_BENCHMARK_POLL_MS      (10)
+
+/* Private types -------------------------------------------------------------*/
+typedef int16_t T_PerceptionDepthVector __attribute__((vector_size(16)));
+
+struct PerceptionDepthWorker {
+    PerceptionDepthEstimator *owner;
+    T_DjiTaskHandle task;
+    T_DjiSemaHandle startSema;
+    const T_PerceptionDepthConfig *config;
+    const uint8_t *left;
+    const uint8_t *right;
+    float *disparity;
+    uint32_t width;
+    uint32_t height;
+    uint32_t rowBegin;
+    uint32_t rowEnd;
+    std::vector<uint32_t> censusLeft;
+    std::vector<uint32_t> censusRight;
+    std::vector<uint8_t> cost;
+    std::vector<int16_t> aggregate;
+    std::vector<int16_t> temp;
+    std::vector<int16_t> pathRow;
+    std::vector<int16_t> pathRowMin;
+    std::vector<int16_t> pathPrev;
+    std::vector<int16_t> pathCur;
+    std::vector<int16_t> pathTemp;
+    std::vector<int32_t> rightDisparity;
+};
+
+typedef struct {
+    uint32_t pairNum;
+    uint64_t totalUs;
+    uint64_t minUs;
+    uint64_t maxUs;
+    uint64_t validNum;
+    uint64_t pixelNum;
+} T_PerceptionDepthBenchmarkStat;
+
+/* Private values -------------------------------------------------------------*/
+static PerceptionDepthEstimator *s_benchmarkEstimator = nullptr;
+
+/* Private functions declaration ---------------------------------------------*/
+static void PerceptionDepth_Census(const uint8_t *image, uint32_t width, uint32_t height, uint32_t rowBegin,
+                                   uint32_t rowEnd, uint32_t *census);
+static void PerceptionDepth_MatchBand(PerceptionDepthWorker *worker);
+static void PerceptionDepth_AggregateBlock(PerceptionDepthWorker *worker, uint32_t rows, uint32_t width,
+                                           uint32_t maxDisparity);
+static void PerceptionDepth_AggregateSgm(PerceptionDepthWorker *worker, uint32_t rows, uint32_t width,
+                                         uint32_t maxDisparity, bool isForward);
+static int16_t PerceptionDepth_InitPath(const uint8_t *cost, int16_t *path, uint32_t maxDisparity);
+static int16_t PerceptionDepth_UpdatePath(const uint8_t *cost, const int16_t *prev, int16_t prevMin, int16_t *cur,
+                                          uint32_t maxDisparity, int16_t penaltySmall, int16_t penaltyLarge);
+static void PerceptionDepth_SelectDisparity(PerceptionDepthWorker *worker, const int16_t *aggregate, uint32_t width,
+                                            uint32_t maxDisparity, float *disparity);
+static void DjiTest_DepthBenchmarkImageCallback(T_DjiPerceptionImageInfo imageInfo, uint8_t *imageRawBuffer,
+                                                uint32_t bufferLen);
+static void DjiTest_DepthBenchmarkResultCallback(const PerceptionDepthResult &result, void *userData);
+
+/* Exported functions definition ---------------------------------------------*/
+PerceptionDepthEstimator::PerceptionDepthEstimator() : m_cameraParameters(), m_doneSema(nullptr),
+                                                       m_isWorkerExit(false), m_width(0), m_height(0),
+                                                       m_jobDirection(0), m_pairMutex(nullptr), m_jobSema(nullptr),
+                                                       m_idleSema(nullptr), m_exitSema(nullptr),
+                                                       m_depthThread(nullptr), m_callback(nullptr),
+                                                       m_userData(nullptr), m_isRunning(false),
+                                                       m_isDepthExit(false), m_droppedCount(0)
+{
+    GetDefaultConfig(&m_config);
+    for (auto &direction: m_pending) {
+        direction[0].isValid = false;
+        direction[1].isValid = false;
+    }
+}
+
+PerceptionDepthEstimator::~PerceptionDepthEstimator()
+{
+    Stop();
+    DestroyWorkers();
+    if (m_pairMutex != nullptr) {
+        DjiPlatform_GetOsalHandler()->MutexDestroy(m_pairMutex);
+        m_pairMutex = nullptr;
+    }
+}
+
+void PerceptionDepthEstimator::GetDefaultConfig(T_PerceptionDepthConfig *config)
+{
+    config->method = PERCEPTION_DEPTH_METHOD_SGM;
+    config->scale = 2;
+    config->maxDisparity = 32;
+    config->threadNum = 4;
+    config->blockRadius = 3;
+    config->penaltySmall = 8;
+    config->penaltyLarge = 64;
+    config->uniquenessPercent = 5;
+    config->pointCloudStep = 4;
+    config->maxDepth = 30.0f;
+}
+
+T_DjiReturnCode PerceptionDepthEstimator::SetConfig(const T_PerceptionDepthConfig &config)
+{
+    if ((config.scale != 1 && config.scale != 2 && config.scale != 4) || config.maxDisparity == 0 ||
+        config.threadNum == 0 || config.threadNum > PERCEPTION_DEPTH_MAX_THREAD_NUM ||
+        config.blockRadius > PERCEPTION_DEPTH_MAX_BLOCK_RADIUS || config.penaltySmall >= config.penaltyLarge) {
+        return DJI_ERROR_SYSTEM_MODULE_CODE_INVALID_PARAMETER;
+    }
+
+    if (IsRunning()) {
+        return DJI_ERROR_SYSTEM_MODULE_CODE_NONSUPPORT_IN_CURRENT_STATE;
+    }
+
+    DestroyWorkers();
+    m_config = config;
+    m_config.maxDisparity = (config.maxDisparity + PERCEPTION_DEPTH_VECTOR_LANES - 1) /
+                            PERCEPTION_DEPTH_VECTOR_LANES * PERCEPTION_DEPTH_VECTOR_LANES;
+
+    return DJI_ERROR_SYSTEM_MODULE_CODE_SUCCESS;
+}
+
+void PerceptionDepthEstimator::SetCameraParameters(const T_DjiPerceptionCameraParametersPacket &packet)
+{
+    m_cameraParameters = packet;
+}
+
+T_DjiReturnCode PerceptionDepthEstimator::Compute(const uint8_t *left, const uint8_t *right, uint32_t width,
+                                                  uint32_t height, uint8_t direction, PerceptionDepthResult &result)
+{
+    T_DjiOsalHandler *osalHandler = DjiPlatform_GetOsalHandler();
+    T_DjiReturnCode returnCode;
+    uint64_t beginUs = 0;
+    uint64_t endUs = 0;
+    uint32_t bandNum;
+    uint32_t bandRows;
+    uint32_t i;
+
+    if (left == nullptr || right == nullptr) {
+        return DJI_ERROR_SYSTEM_MODULE_CODE_INVALID_PARAMETER;
+    }
+
+    m_width = width / m_config.scale;
+    m_height = height / m_config.scale;
+    if (m_width <= m_config.maxDisparity || m_height == 0) {
+        return DJI_ERROR_SYSTEM_MODULE_CODE_INVALID_PARAMETER;
+    }
+
+    if (m_workers.empty()) {
+        returnCode = CreateWorkers();
+        if (returnCode != DJI_ERROR_SYSTEM_MODULE_CODE_SUCCESS) {
+            return returnCode;
+        }
+    }
+
+    osalHandler->GetTimeUs(&beginUs);
+
+    if (m_config.scale > 1) {
+        Downsample(left, width, height, m_left);
+        Downsample(right, width, height, m_right);
+        left = m_left.data();
+        right = m_right.data();
+    }
+    m_disparity.resize((size_t) m_width * m_height);
+
+    /* The caller matches band 0 itself, the other bands run on the worker tasks. */
+    bandNum = m_workers.size() < m_height ? (uint32_t) m_workers.size() : m_height;
+    bandRows = (m_height + bandNum - 1) / bandNum;
+    for (i = 0; i < bandNum; i++) {
+        PerceptionDepthWorker *worker = m_workers[i];
+
+        worker->left = left;
+        worker->right = right;
+        worker->disparity = m_disparity.data();
+        worker->width = m_width;
+        worker->height = m_height;
+        worker->rowBegin = i * bandRows < m_height ? i * bandRows : m_height;
+        worker->rowEnd = (i + 1) * bandRows < m_height ? (i + 1) * bandRows : m_height;
+        if (i > 0) {
+            osalHandler->SemaphorePost(worker->startSema);
+        }
+    }
+
+    PerceptionDepth_MatchBand(m_workers[0]);
+    for (i = 1; i < bandNum; i++) {
+        osalHandler->SemaphoreWait(m_doneSema);
+    }
+
+    FillResult(direction, result);
+    osalHandler->GetTimeUs(&endUs);
+    result.computeTimeUs = endUs - beginUs;
+
+    return DJI_ERROR_SYSTEM_MODULE_CODE_SUCCESS;
+}
+
+T_DjiReturnCode PerceptionDepthEstimator::Start(PerceptionDepthCallback callback, void *userData)
+{
+    T_DjiOsalHandler *osalHandler = DjiPlatform_GetOsalHandler();
+    T_DjiReturnCode returnCode;
+
+    if (IsRunning()) {
+        return DJI_ERROR_SYSTEM_MODULE_CODE_NONSUPPORT_IN_CURRENT_STATE;
+    }
+
+    if (callback == nullptr) {
+        return DJI_ERROR_SYSTEM_MODULE_CODE_INVALID_PARAMETER;
+    }
+
+    /* The pair lock outlives Stop, an image callback still running into PushImage never sees it destroyed. */
+    if ((m_pairMutex == nullptr && osalHandler->MutexCreate(&m_pairMutex) != DJI_ERROR_SYSTEM_MODULE_CODE_SUCCESS) ||
+        osalHandler->SemaphoreCreate(0, &m_jobSema) != DJI_ERROR_SYSTEM_MODULE_CODE_SUCCESS ||
+        osalHandler->SemaphoreCreate(1, &m_idleSema) != DJI_ERROR_SYSTEM_MODULE_CODE_SUCCESS ||
+        osalHandler->SemaphoreCreate(0, &m_exitSema) != DJI_ERROR_SYSTEM_MODULE_CODE_SUCCESS) {
+        USER_LOG_ERROR("Create perception depth lock failed.");
+        returnCode = DJI_ERROR_SYSTEM_MODULE_CODE_SYSTEM_ERROR;
+        goto DestroyLock;
+    }
+
+    for (auto &direction: m_pending) {
+        direction[0].isValid = false;
+        direction[1].isValid = false;
+    }
+    m_callback = callback;
+    m_userData = userData;
+    m_droppedCount = 0;
+    m_isDepthExit = false;
+
+    returnCode = osalHandler->TaskCreate("perception_depth", DepthTask, PERCEPTION_DEPTH_TASK_STACK_SIZE, this,
+                                         &m_depthThread);
+    if (returnCode != DJI_ERROR_SYSTEM_MODULE_CODE_SUCCESS) {
+        USER_LOG_ERROR("Create perception depth task failed, return code:0x%08X", returnCode);
+        goto DestroyLock;
+    }
+    osalHandler->MutexLock(m_pairMutex);
+    __atomic_store_n(&m_isRunning, true, __ATOMIC_RELEASE);
+    osalHandler->MutexUnlock(m_pairMutex);
+
+    return DJI_ERROR_SYSTEM_MODULE_CODE_SUCCESS;
+
+DestroyLock:
+    for (T_DjiSemaHandle *sema: {&m_jobSema, &m_idleSema, &m_exitSema}) {
+        if (*sema != nullptr) {
+            osalHandler->SemaphoreDestroy(*sema);
+            *sema = nullptr;
+        }
+    }
+
+    return returnCode;
+}
+
+T_DjiReturnCode PerceptionDepthEstimator::Stop()
+{
+    T_DjiOsalHandler *osalHandler = DjiPlatform_GetOsalHandler();
+
+    if (!IsRunning()) {
+        return DJI_ERROR_SYSTEM_MODULE_CODE_SUCCESS;
+    }
+
+    /* PushImage checks the flag under the pair lock, no new pair can be handed over after this. */
+    osalHandler->MutexLock(m_pairMutex);
+    __atomic_store_n(&m_isRunning, false, __ATOMIC_RELEASE);
+    osalHandler->MutexUnlock(m_pairMutex);
+
+    osalHandler->SemaphoreWait(m_idleSema);
+    m_isDepthExit = true;
+    osalHandler->SemaphorePost(m_jobSema);
+    osalHandler->SemaphoreWait(m_exitSema);
+    osalHandler->TaskDestroy(m_depthThread);
+    m_depthThread = nullptr;
+
+    for (T_DjiSemaHandle *sema: {&m_jobSema, &m_idleSema, &m_exitSema}) {
+        osalHandler->SemaphoreDestroy(*sema);
+        *sema = nullptr;
+    }
+
+    return DJI_ERROR_SYSTEM_MODULE_CODE_SUCCESS;
+}
+
+bool PerceptionDepthEstimator::IsRunning() const
+{
+    return __atomic_load_n(&m_isRunning, __ATOMIC_ACQUIRE);
+}
+
+void PerceptionDepthEstimator::PushImage(const T_DjiPerceptionImageInfo &imageInfo, const uint8_t *imageRawBuffer,
+                                         uint32_t bufferLen, bool isBlocking)
+{
+    T_DjiOsalHandler *osalHandler = DjiPlatform_GetOsalHandler();
+    uint8_t direction = imageInfo.rawInfo.direction;
+    /* Left camera positions are odd in E_DjiPerceptionCameraPosition. */
+    uint32_t side = (imageInfo.dataType & 1) ? 0 : 1;
+    uint32_t imageSize = imageInfo.rawInfo.width * imageInfo.rawInfo.height;
+    T_DjiReturnCode returnCode;
+
+    /* A started estimator has its pair lock, the flag is checked again under the lock against a concurrent Stop. */
+    if (!IsRunning() || imageRawBuffer == nullptr || direction >= IMAGE_MAX_DIRECTION_NUM ||
+        imageInfo.rawInfo.bpp != 8 || imageSize == 0 || bufferLen < imageSize) {
+        return;
+    }
+
+    osalHandler->MutexLock(m_pairMutex);
+    if (!m_isRunning) {
+        osalHandler->MutexUnlock(m_pairMutex);
+        return;
+    }
+
+    PendingImage &image = m_pending[direction][side];
+    PendingImage &other = m_pending[direction][1 - side];
+    image.data.assign(imageRawBuffer, imageRawBuffer + imageSize);
+    image.sequence = imageInfo.sequence;
+    image.timeStamp = imageInfo.timeStamp;
+    image.width = imageInfo.rawInfo.width;
+    image.height = imageInfo.rawInfo.height;
+    image.isValid = true;
+
+    if (!other.isValid || other.sequence != image.sequence || other.width != image.width ||
+        other.height != image.height) {
+        osalHandler->MutexUnlock(m_pairMutex);
+        return;
+    }
+
+    returnCode = isBlocking ? osalHandler->SemaphoreWait(m_idleSema) :
+                 osalHandler->SemaphoreTimedWait(m_idleSema, 0);
+    if (returnCode == DJI_ERROR_SYSTEM_MODULE_CODE_SUCCESS) {
+        /* Swap instead of copy, the buffers of both sides keep their capacity across pairs. */
+        for (uint32_t i = 0; i < 2; i++) {
+            std::swap(m_job[i].data, m_pending[direction][i].data);
+            m_job[i].sequence = m_pending[direction][i].sequence;
+            m_job[i].timeStamp = m_pending[direction][i].timeStamp;
+            m_job[i].width = m_pending[direction][i].width;
+            m_job[i].height = m_pending[direction][i].height;
+        }
+        m_jobDirection = direction;
+        osalHandler->SemaphorePost(m_jobSema);
+    } else {
+        __atomic_add_fetch(&m_droppedCount, 1, __ATOMIC_RELAXED);
+    }
+    image.isValid = false;
+    other.isValid = false;
+    osalHandler->MutexUnlock(m_pairMutex);
+}
+
+uint32_t PerceptionDepthEstimator::GetDroppedCount()
+{
+    return __atomic_load_n(&m_droppedCount, __ATOMIC_RELAXED);
+}
+
+T_DjiReturnCode DjiUser_RunStereoDepthBenchmark(const char *path, const T_PerceptionDepthConfig *config)
+{
+    T_DjiOsalHandler *osalHandler = DjiPlatform_GetOsalHandler();
+    T_PerceptionDepthBenchmarkStat stat = {};
+    T_PerceptionDepthConfig depthConfig;
+    PerceptionDepthEstimator estimator;
+    PerceptionReplay replay;
+    T_DjiReturnCode returnCode;
+    uint64_t beginUs = 0;
+    uint64_t endUs = 0;
+
+    if (config != nullptr) {
+        depthConfig = *config;
+    } else {
+        PerceptionDepthEstimator::GetDefaultConfig(&depthConfig);
+    }
+
+    returnCode = estimator.SetConfig(depthConfig);
+    if (returnCode != DJI_ERROR_SYSTEM_MODULE_CODE_SUCCESS) {
+        USER_LOG_ERROR("Invalid perception depth config.");
+        return returnCode;
+    }
+
+    returnCode = replay.Open(path);
+    if (returnCode != DJI_ERROR_SYSTEM_MODULE_CODE_SUCCESS) {
+        return returnCode;
+    }
+    estimator.SetCameraParameters(replay.GetCameraParameters());
+
+    stat.minUs = UINT64_MAX;
+    returnCode = estimator.Start(DjiTest_DepthBenchmarkResultCallback, &stat);
+    if (returnCode != DJI_ERROR_SYSTEM_MODULE_CODE_SUCCESS) {
+        return returnCode;
+    }
+
+    /* Replay without delay and block on the depth task, so every recorded pair is measured. */
+    s_benchmarkEstimator = &estimator;
+    osalHandler->GetTimeUs(&beginUs);
+    returnCode = replay.Start(DjiTest_DepthBenchmarkImageCallback, 0, false);
+    if (returnCode == DJI_ERROR_SYSTEM_MODULE_CODE_SUCCESS) {
+        while (!replay.IsFinished()) {
+            osalHandler->TaskSleepMs(PERCEPTION_DEPTH_BENCHMARK_POLL_MS);
+        }
+    }
+    replay.Close();
+    estimator.Stop();
+    osalHandler->GetTimeUs(&endUs);
+    s_benchmarkEstimator = nullptr;
+
+    if (stat.pairNum == 0) {
+        USER_LOG_ERROR("No stereo pair found in %s.", path);
+        return DJI_ERROR_SYSTEM_MODULE_CODE_INVALID_PARAMETER;
+    }
+
+    USER_LOG_INFO("Depth benchmark: method %s scale %u disparity %u threads %u, %u pairs in %.1f ms (%.1f fps).",
+                  depthConfig.method == PERCEPTION_DEPTH_METHOD_SGM ? "sgm" : "bm", depthConfig.scale,
+                  depthConfig.maxDisparity, depthConfig.threadNum, stat.pairNum, (endUs - beginUs) / 1000.0,
+                  stat.pairNum * 1000000.0 / (double) (endUs - beginUs));
+    USER_LOG_INFO("Depth benchmark: compute min %.2f ms, mean %.2f ms, max %.2f ms, valid pixels %.1f%%.",
+                  stat.minUs / 1000.0, stat.totalUs / 1000.0 / stat.pairNum, stat.maxUs / 1000.0,
+                  stat.pixelNum ? 100.0 * stat.validNum / stat.pixelNum : 0.0);
+
+    return returnCode;
+}
+
+/* Private functions definition-----------------------------------------------*/
+T_DjiReturnCode PerceptionDepthEstimator::CreateWorkers()
+{
+    T_DjiOsalHandler *osalHandler = DjiPlatform_GetOsalHandler();
+    T_DjiReturnCode returnCode;
+    uint32_t i;
+
+    returnCode = osalHandler->SemaphoreCreate(0, &m_doneSema);
+    if (returnCode != DJI_ERROR_SYSTEM_MODULE_CODE_SUCCESS) {
+        return returnCode;
+    }
+    m_isWorkerExit = false;
+
+    for (i = 0; i < m_config.threadNum; i++) {
+        auto *worker = new(std::nothrow) PerceptionDepthWorker();
+        if (worker == nullptr) {
+            DestroyWorkers();
+            return DJI_ERROR_SYSTEM_MODULE_CODE_MEMORY_ALLOC_FAILED;
+        }
+        worker->owner = this;
+        worker->config = &m_config;
+        m_workers.push_back(worker);
+
+        if (i == 0) {
+            continue;
+        }
+
+        if (osalHandler->SemaphoreCreate(0, &worker->startSema) != DJI_ERROR_SYSTEM_MODULE_CODE_SUCCESS ||
+            osalHandler->TaskCreate("perception_depth_band", WorkerTask, PERCEPTION_DEPTH_TASK_STACK_SIZE, worker,
+                                    &worker->task) != DJI_ERROR_SYSTEM_MODULE_CODE_SUCCESS) {
+            USER_LOG_ERROR("Create perception depth worker %u failed.", i);
+            DestroyWorkers();
+            return DJI_ERROR_SYSTEM_MODULE_CODE_SYSTEM_ERROR;
+        }
+    }
+
+    return DJI_ERROR_SYSTEM_MODULE_CODE_SUCCESS;
+}
+
+void PerceptionDepthEstimator::DestroyWorkers()
+{
+    T_DjiOsalHandler *osalHandler = DjiPlatform_GetOsalHandler();
+
+    m_isWorkerExit = true;
+    for (auto worker: m_workers) {
+        if (worker->task != nullptr) {
+            osalHandler->SemaphorePost(worker->startSema);
+            osalHandler->SemaphoreWait(m_doneSema);
+            osalHandler->TaskDestroy(worker->task);
+        }
+        if (worker->startSema != nullptr) {
+            osalHandler->SemaphoreDestroy(worker->startSema);
+        }
+        delete worker;
+    }
+    m_workers.clear();
+
+    if (m_doneSema != nullptr) {
+        osalHandler->SemaphoreDestroy(m_doneSema);
+        m_doneSema = nullptr;
+    }
+}
+
+void PerceptionDepthEstimator::Downsample(const uint8_t *src, uint32_t width, uint32_t height,
+                                          std::vector<uint8_t> &dst)
+{
+    uint32_t scale = m_config.scale;
+    uint32_t dstWidth = width / scale;
+    uint32_t dstHeight = height / scale;
+    uint32_t area = scale * scale;
+    uint32_t x;
+    uint32_t y;
+    uint32_t i;
+    uint32_t j;
+
+    dst.resize((size_t) dstWidth * dstHeight);
+    for (y = 0; y < dstHeight; y++) {
+        for (x = 0; x < dstWidth; x++) {
+            uint32_t sum = 0;
+
+            for (j = 0; j < scale; j++) {
+                const uint8_t *row = src + (size_t) (y * scale + j) * width + x * scale;
+                for (i = 0; i < scale; i++) {
+                    sum += row[i];
+                }
+            }
+            dst[(size_t) y * dstWidth + x] = (uint8_t) ((sum + area / 2) / area);
+        }
+    }
+}
+
+void PerceptionDepthEstimator::FillResult(uint8_t direction, PerceptionDepthResult &result)
+{
+    const T_DjiPerceptionCameraParameters *parameters = nullptr;
+    float focalX = 0;
+    float focalY = 0;
+    float centerX = 0;
+    float centerY = 0;
+    float baseline = 0;
+    uint32_t step = m_config.pointCloudStep;
+    uint32_t x;
+    uint32_t y;
+    uint32_t i;
+
+    for (i = 0; i < m_cameraParameters.directionNum && i < IMAGE_MAX_DIRECTION_NUM; i++) {
+        if (m_cameraParameters.cameraParameters[i].direction == direction) {
+            parameters = &m_cameraParameters.cameraParameters[i];
+            break;
+        }
+    }
+
+    if (parameters != nullptr) {
+        focalX = parameters->leftIntrinsics[0] / m_config.scale;
+        focalY = parameters->leftIntrinsics[4] / m_config.scale;
+        centerX = parameters->leftIntrinsics[2] / m_config.scale;
+        centerY = parameters->leftIntrinsics[5] / m_config.scale;
+        baseline = sqrtf(parameters->translationLeftInRight[0] * parameters->translationLeftInRight[0] +
+                         parameters->translationLeftInRight[1] * parameters->translationLeftInRight[1] +
+                         parameters->translationLeftInRight[2] * parameters->translationLeftInRight[2]);
+    }
+
+    result.direction = direction;
+    result.width = m_width;
+    result.height = m_height;
+    result.disparity.resize((size_t) m_width * m_height);
+    result.depth.resize((size_t) m_width * m_height);
+    result.points.clear();
+    result.validCount = 0;
+
+    for (y = 0; y < m_height; y++) {
+        for (x = 0; x < m_width; x++) {
+            size_t index = (size_t) y * m_width + x;
+            float disparity = m_disparity[index];
+            float depth = 0;
+
+            if (disparity <= 0) {
+                result.disparity[index] = 0;
+                result.depth[index] = 0;
+                continue;
+            }
+
+            result.disparity[index] = (uint16_t) (disparity * (1 << PERCEPTION_DEPTH_DISPARITY_SHIFT) + 0.5f);
+            if (focalX > 0 && baseline > 0) {
+                depth = focalX * baseline / disparity;
+            }
+            result.depth[index] = depth;
+            result.validCount++;
+
+            if (step > 0 && depth > 0 && depth <= m_config.maxDepth && x % step == 0 && y % step == 0) {
+                T_PerceptionDepthPoint point;
+
+                point.x = ((float) x - centerX) * depth / focalX;
+                point.y = ((float) y - centerY) * depth / focalY;
+                point.z = depth;
+                result.points.push_back(point);
+            }
+        }
+    }
+}
+
+void *PerceptionDepthEstimator::WorkerTask(void *arg)
+{
+    T_DjiOsalHandler *osalHandler = DjiPlatform_GetOsalHandler();
+    auto *worker = (PerceptionDepthWorker *) arg;
+    PerceptionDepthEstimator *estimator = worker->owner;
+
+    while (true) {
+        osalHandler->SemaphoreWait(worker->startSema);
+        if (estimator->m_isWorkerExit) {
+            break;
+        }
+
+        PerceptionDepth_MatchBand(worker);
+        osalHandler->SemaphorePost(estimator->m_doneSema);
+    }
+
+    osalHandler->SemaphorePost(estimator->m_doneSema);
+
+    return nullptr;
+}
+
+void *PerceptionDepthEstimator::DepthTask(void *arg)
+{
+    T_DjiOsalHandler *osalHandler = DjiPlatform_GetOsalHandler();
+    auto *estimator = (PerceptionDepthEstimator *) arg;
+    T_DjiReturnCode returnCode;
+
+    while (true) {
+        osalHandler->SemaphoreWait(estimator->m_jobSema);
+        if (estimator->m_isDepthExit) {
+            break;
+        }
+
+        returnCode = estimator->Compute(estimator->m_job[0].data.data(), estimator->m_job[1].data.data(),
+                                        estimator->m_job[0].width, estimator->m_job[0].height,
+                                        estimator->m_jobDirection, estimator->m_result);
+        if (returnCode == DJI_ERROR_SYSTEM_MODULE_CODE_SUCCESS) {
+            estimator->m_result.sequence = estimator->m_job[0].sequence;
+            estimator->m_result.timeStamp = estimator->m_job[0].timeStamp;
+            estimator->m_callback(estimator->m_result, estimator->m_userData);
+        } else {
+            USER_LOG_ERROR("Compute perception depth failed, return code:0x%08X", returnCode);
+        }
+
+        osalHandler->SemaphorePost(estimator->m_idleSema);
+    }
+
+    osalHandler->SemaphorePost(estimator->m_exitSema);
+
+    return nullptr;
+}
+
+static void PerceptionDepth_Census(const uint8_t *image, uint32_t width, uint32_t height, uint32_t rowBegin,
+                                   uint32_t rowEnd, uint32_t *census)
+{
+    int32_t radius = PERCEPTION_DEPTH_CENSUS_RADIUS;
+    uint32_t x;
+    uint32_t y;
+
+    for (y = rowBegin; y < rowEnd; y++) {
+        for (x = 0; x < width; x++) {
+            uint8_t center = image[(size_t) y * width + x];
+            uint32_t bits = 0;
+
+            /* Border pixels are clamped, the window keeps its 24 bits everywhere. */
+            for (int32_t dy = -radius; dy <= radius; dy++) {
+                int32_t yy = (int32_t) y + dy;
+                yy = yy < 0 ? 0 : (yy >= (int32_t) height ? (int32_t) height - 1 : yy);
+                const uint8_t *row = image + (size_t) yy * width;
+
+                for (int32_t dx = -radius; dx <= radius; dx++) {
+                    int32_t xx = (int32_t) x + dx;
+
+                    if (dx == 0 && dy == 0) {
+                        continue;
+                    }
+                    xx = xx < 0 ? 0 : (xx >= (int32_t) width ? (int32_t) width - 1 : xx);
+                    bits = (bits << 1) | (row[xx] < center ? 1 : 0);
+                }
+            }
+            census[(size_t) (y - rowBegin) * width + x] = bits;
+        }
+    }
+}
+
+static void PerceptionDepth_MatchBand(PerceptionDepthWorker *worker)
+{
+    const T_PerceptionDepthConfig *config = worker->config;
+    uint32_t width = worker->width;
+    uint32_t maxDisparity = config->maxDisparity;
+    uint32_t margin = config->method == PERCEPTION_DEPTH_METHOD_SGM ? PERCEPTION_DEPTH_SGM_MARGIN :
+                      config->blockRadius;
+    uint32_t bandBegin = worker->rowBegin > margin ? worker->rowBegin - margin : 0;
+    uint32_t bandEnd = worker->rowEnd + margin < worker->height ? worker->rowEnd + margin : worker->height;
+    uint32_t rows = bandEnd - bandBegin;
+    size_t volumeSize = (size_t) rows * width * maxDisparity;
+    uint32_t x;
+    uint32_t y;
+    uint32_t d;
+
+    if (worker->rowBegin >= worker->rowEnd) {
+        return;
+    }
+
+    /* Buffers only ever grow, a steady stream of equally sized pairs allocates nothing. */
+    worker->censusLeft.resize((size_t) rows * width);
+    worker->censusRight.resize((size_t) rows * width);
+    worker->cost.resize(volumeSize);
+    worker->aggregate.resize(volumeSize);
+
+    PerceptionDepth_Census(worker->left, width, worker->height, bandBegin, bandEnd, worker->censusLeft.data());
+    PerceptionDepth_Census(worker->right, width, worker->height, bandBegin, bandEnd, worker->censusRight.data());
+
+    for (y = 0; y < rows; y++) {
+        const uint32_t *censusLeft = worker->censusLeft.data() + (size_t) y * width;
+        const uint32_t *censusRight = worker->censusRight.data() + (size_t) y * width;
+
+        for (x = 0; x < width; x++) {
+            uint8_t *cost = worker->cost.data() + ((size_t) y * width + x) * maxDisparity;
+
+            for (d = 0; d < maxDisparity; d++) {
+                cost[d] = d <= x ? (uint8_t) __builtin_popcount(censusLeft[x] ^ censusRight[x - d]) :
+                          PERCEPTION_DEPTH_CENSUS_BITS;
+            }
+        }
+    }
+
+    if (config->method == PERCEPTION_DEPTH_METHOD_SGM) {
+        PerceptionDepth_AggregateSgm(worker, rows, width, maxDisparity, true);
+        PerceptionDepth_AggregateSgm(worker, rows, width, maxDisparity, false);
+    } else {
+        PerceptionDepth_AggregateBlock(worker, rows, width, maxDisparity);
+    }
+
+    for (y = worker->rowBegin; y < worker->rowEnd; y++) {
+        PerceptionDepth_SelectDisparity(worker, worker->aggregate.data() +
+                                                (size_t) (y - bandBegin) * width * maxDisparity,
+                                        width, maxDisparity, worker->disparity + (size_t) y * width);
+    }
+}
+
+static void PerceptionDepth_AggregateBlock(PerceptionDepthWorker *worker, uint32_t rows, uint32_t width,
+                                           uint32_t maxDisparity)
+{
+    int32_t radius = (int32_t) worker->config->blockRadius;
+    std::vector<int16_t> &rowSum = worker->temp;
+    int16_t *aggregate = worker->aggregate.data();
+    uint32_t x;
+    uint32_t y;
+    uint32_t d;
+
+    rowSum.resize((size_t) rows * width * maxDisparity);
+
+    /* Horizontal box sum with a sliding window, then the vertical sum of those rows. */
+    for (y = 0; y < rows; y++) {
+        const uint8_t *costRow = worker->cost.data() + (size_t) y * width * maxDisparity;
+        int16_t *sumRow = rowSum.data() + (size_t) y * width * maxDisparity;
+
+        for (d = 0; d < maxDisparity; d++) {
+            sumRow[d] = 0;
+        }
+        for (int32_t i = -radius; i <= radius; i++) {
+            const uint8_t *cost = costRow + (size_t) (i < 0 ? 0 : i) * maxDisparity;
+            for (d = 0; d < maxDisparity; d++) {
+                sumRow[d] += cost[d];
+            }
+        }
+        for (x = 1; x < width; x++) {
+            int32_t addX = (int32_t) x + radius < (int32_t) width ? (int32_t) x + radius : (int32_t) width - 1;
+            int32_t subX = (int32_t) x - radius - 1 > 0 ? (int32_t) x - radius - 1 : 0;
+            const uint8_t *addCost = costRow + (size_t) addX * maxDisparity;
+            const uint8_t *subCost = costRow + (size_t) subX * maxDisparity;
+            const int16_t *prev = sumRow + (size_t) (x - 1) * maxDisparity;
+            int16_t *cur = sumRow + (size_t) x * maxDisparity;
+
+            for (d = 0; d < maxDisparity; d++) {
+                cur[d] = (int16_t) (prev[d] + addCost[d] - subCost[d]);
+            }
+        }
+    }
+
+    for (y = 0; y < rows; y++) {
+        int16_t *out = aggregate + (size_t) y * width * maxDisparity;
+        size_t rowSize = (size_t) width * maxDisparity;
+
+        memset(out, 0, rowSize * sizeof(int16_t));
+        for (int32_t i = -radius; i <= radius; i++) {
+            int32_t yy = (int32_t) y + i;
+            yy = yy < 0 ? 0 : (yy >= (int32_t) rows ? (int32_t) rows - 1 : yy);
+            const int16_t *in = rowSum.data() + (size_t) yy * rowSize;
+
+            for (size_t k = 0; k < rowSize; k++) {
+                out[k] += in[k];
+            }
+        }
+    }
+}
+
+static void PerceptionDepth_AggregateSgm(PerceptionDepthWorker *worker, uint32_t rows, uint32_t width,
+                                         uint32_t maxDisparity, bool isForward)
+{
+    int16_t penaltySmall = (int16_t) worker->config->penaltySmall;
+    int16_t penaltyLarge = (int16_t) worker->config->penaltyLarge;
+    uint32_t pathStride = maxDisparity + 2;
+    int16_t *pathRow;
+    int16_t *pathRowMin;
+    int16_t *pathPrev;
+    int16_t *pathCur;
+    int16_t *pathTemp;
+    int16_t prevMin = 0;
+    uint32_t d;
+
+    /* Every path buffer keeps an invalid entry at both ends, so d - 1 and d + 1 need no bound check. */
+    worker->pathRow.assign((size_t) width * pathStride, PERCEPTION_DEPTH_PATH_INVALID);
+    worker->pathRowMin.resize(width);
+    worker->pathPrev.assign(pathStride, PERCEPTION_DEPTH_PATH_INVALID);
+    worker->pathCur.assign(pathStride, PERCEPTION_DEPTH_PATH_INVALID);
+    worker->pathTemp.assign(pathStride, PERCEPTION_DEPTH_PATH_INVALID);
+    pathRow = worker->pathRow.data();
+    pathRowMin = worker->pathRowMin.data();
+    pathPrev = worker->pathPrev.data();
+    pathCur = worker->pathCur.data();
+    pathTemp = worker->pathTemp.data();
+
+    /* The forward pass runs the left and top paths, the backward pass the right and bottom paths. */
+    for (uint32_t i = 0; i < rows; i++) {
+        uint32_t y = isForward ? i : rows - 1 - i;
+
+        for (uint32_t j = 0; j < width; j++) {
+            uint32_t x = isForward ? j : width - 1 - j;
+            size_t offset = ((size_t) y * width + x) * maxDisparity;
+            const uint8_t *cost = worker->cost.data() + offset;
+            int16_t *aggregate = worker->aggregate.data() + offset;
+            int16_t *pathVertical = pathRow + (size_t) x * pathStride;
+            int16_t curMin;
+
+            if (j == 0) {
+                curMin = PerceptionDepth_InitPath(cost, pathCur, maxDisparity);
+            } else {
+                curMin = PerceptionDepth_UpdatePath(cost, pathPrev, prevMin, pathCur, maxDisparity, penaltySmall,
+                                                    penaltyLarge);
+            }
+            prevMin = curMin;
+
+            if (i == 0) {
+                pathRowMin[x] = PerceptionDepth_InitPath(cost, pathTemp, maxDisparity);
+            } else {
+                pathRowMin[x] = PerceptionDepth_UpdatePath(cost, pathVertical, pathRowMin[x], pathTemp,
+                                                           maxDisparity, penaltySmall, penaltyLarge);
+            }
+            memcpy(pathVertical + 1, pathTemp + 1, maxDisparity * sizeof(int16_t));
+
+            if (isForward) {
+                for (d = 0; d < maxDisparity; d++) {
+                    aggregate[d] = (int16_t) (pathCur[d + 1] + pathTemp[d + 1]);
+                }
+            } else {
+                for (d = 0; d < maxDisparity; d++) {
+                    aggregate[d] = (int16_t) (aggregate[d] + pathCur[d + 1] + pathTemp[d + 1]);
+                }
+            }
+
+            std::swap(pathPrev, pathCur);
+        }
+    }
+}
+
+static int16_t PerceptionDepth_InitPath(const uint8_t *cost, int16_t *path, uint32_t maxDisparity)
+{
+    int16_t minCost = PERCEPTION_DEPTH_PATH_INVALID;
+    uint32_t d;
+
+    for (d = 0; d < maxDisparity; d++) {
+        path[d + 1] = cost[d];
+        minCost = path[d + 1] < minCost ? path[d + 1] : minCost;
+    }
+
+    return minCost;
+}
+
+static int16_t PerceptionDepth_UpdatePath(const uint8_t *cost, const int16_t *prev, int16_t prevMin, int16_t *cur,
+                                          uint32_t maxDisparity, int16_t penaltySmall, int16_t penaltyLarge)
+{
+    const int16_t jump = (int16_t) (prevMin + penaltyLarge);
+    const T_PerceptionDepthVector small = {penaltySmall, penaltySmall, penaltySmall, penaltySmall,
+                                           penaltySmall, penaltySmall, penaltySmall, penaltySmall};
+    const T_PerceptionDepthVector large = {jump, jump, jump, jump, jump, jump, jump, jump};
+    const T_PerceptionDepthVector base = {prevMin, prevMin, prevMin, prevMin, prevMin, prevMin, prevMin, prevMin};
+    T_PerceptionDepthVector minVector = {PERCEPTION_DEPTH_PATH_INVALID, PERCEPTION_DEPTH_PATH_INVALID,
+                                         PERCEPTION_DEPTH_PATH_INVALID, PERCEPTION_DEPTH_PATH_INVALID,
+                                         PERCEPTION_DEPTH_PATH_INVALID, PERCEPTION_DEPTH_PATH_INVALID,
+                                         PERCEPTION_DEPTH_PATH_INVALID, PERCEPTION_DEPTH_PATH_INVALID};
+    int16_t minCost;
+    uint32_t d;
+
+    /* L(d) = C(d) + min(L'(d), L'(d - 1) + P1, L'(d + 1) + P1, min L' + P2) - min L', 8 disparities per step. */
+    for (d = 0; d < maxDisparity; d += PERCEPTION_DEPTH_VECTOR_LANES) {
+        T_PerceptionDepthVector same;
+        T_PerceptionDepthVector lower;
+        T_PerceptionDepthVector upper;
+        T_PerceptionDepthVector step;
+        T_PerceptionDepthVector result;
+        const uint8_t *c = cost + d;
+        T_PerceptionDepthVector matchCost = {c[0], c[1], c[2], c[3], c[4], c[5], c[6], c[7]};
+
+        memcpy(&same, prev + d + 1, sizeof(same));
+        memcpy(&lower, prev + d, sizeof(lower));
+        memcpy(&upper, prev + d + 2, sizeof(upper));
+
+        step = lower < upper ? lower : upper;
+        step += small;
+        step = step < same ? step : same;
+        step = step < large ? step : large;
+        result = matchCost + step - base;
+
+        memcpy(cur + d + 1, &result, sizeof(result));
+        minVector = result < minVector ? result : minVector;
+    }
+
+    minCost = minVector[0];
+    for (d = 1; d < PERCEPTION_DEPTH_VECTOR_LANES; d++) {
+        minCost = minVector[d] < minCost ? minVector[d] : minCost;
+    }
+
+    return minCost;
+}
+
+static void PerceptionDepth_SelectDisparity(PerceptionDepthWorker *worker, const int16_t *aggregate, uint32_t width,
+                                            uint32_t maxDisparity, float *disparity)
+{
+    uint32_t uniqueness = worker->config->uniquenessPercent;
+    int32_t *rightDisparity;
+    uint32_t x;
+    uint32_t d;
+
+    /* Right image disparities straight from the same volume, used for the left-right consistency check. */
+    worker->rightDisparity.resize(width);
+    rightDisparity = worker->rightDisparity.data();
+    for (x = 0; x < width; x++) {
+        int32_t best = INT_MAX;
+        int32_t bestDisparity = -1;
+
+        for (d = 0; d < maxDisparity && x + d < width; d++) {
+            int32_t value = aggregate[(size_t) (x + d) * maxDisparity + d];
+            if (value < best) {
+                best = value;
+                bestDisparity = (int32_t) d;
+            }
+        }
+        rightDisparity[x] = bestDisparity;
+    }
+
+    for (x = 0; x < width; x++) {
+        const int16_t *cost = aggregate + (size_t) x * maxDisparity;
+        uint32_t range = x + 1 < maxDisparity ? x + 1 : maxDisparity;
+        int32_t best = INT_MAX;
+        int32_t second = INT_MAX;
+        uint32_t bestDisparity = 0;
+        float subPixel = 0;
+        int32_t matchX;
+
+        for (d = 0; d < range; d++) {
+            if (cost[d] < best) {
+                best = cost[d];
+                bestDisparity = d;
+            }
+        }
+        for (d = 0; d < range; d++) {
+            if ((d + 1 < bestDisparity || d > bestDisparity + 1) && cost[d] < second) {
+                second = cost[d];
+            }
+        }
+
+        matchX = (int32_t) x - (int32_t) bestDisparity;
+        if (range < maxDisparity || (second != INT_MAX && (int64_t) second * 100 <= (int64_t) best * (100 + uniqueness)) ||
+            matchX < 0 || rightDisparity[matchX] < 0 || abs(rightDisparity[matchX] - (int32_t) bestDisparity) > 1) {
+            disparity[x] = -1;
+            continue;
+        }
+
+        if (bestDisparity > 0 && bestDisparity + 1 < maxDisparity) {
+            int32_t lower = cost[bestDisparity - 1];
+            int32_t upper = cost[bestDisparity + 1];
+            int32_t denominator = lower + upper - 2 * best;
+
+            if (denominator > 0) {
+                subPixel = (float) (lower - upper) / (2.0f * denominator);
+            }
+        }
+        disparity[x] = (float) bestDisparity + subPixel;
+    }
+}
+
+static void DjiTest_DepthBenchmarkImageCallback(T_DjiPerceptionImageInfo imageInfo, uint8_t *imageRawBuffer,
+                                                uint32_t bufferLen)
+{
+    if (s_benchmarkEstimator != nullptr) {
+        s_benchmarkEstimator->PushImage(imageInfo, imageRawBuffer, bufferLen, true);
+    }
+}
+
+static void DjiTest_DepthBenchmarkResultCallback(const PerceptionDepthResult &result, void *userData)
+{
+    auto *stat = (T_PerceptionDepthBenchmarkStat *) userData;
+
+    stat->pairNum++;
+    stat->totalUs += result.computeTimeUs;
+    stat->minUs = result.computeTimeUs < stat->minUs ? result.computeTimeUs : stat->minUs;
+    stat->maxUs = result.computeTimeUs > stat->maxUs ? result.computeTimeUs : stat->maxUs;
+    stat->validNum += result.validCount;
+    stat->pixelNum += (uint64_t) result.width * result.height;
+}
+
+/****************** (C) COPYRIGHT DJI Innovations *****END OF FILE****/
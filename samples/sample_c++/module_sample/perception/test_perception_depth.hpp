@@ -0,0 +1,176 @@
+/**
+ ********************************************************************
+ * @file    test_perception_depth.hpp
+ * @brief   This is the header file for "test_perception_depth.cpp", defining the structure and
+ * (exported) function prototypes.
+ *
+ * @copyright (c) 2021 DJI. All rights reserved.
+ *
+ * All information contained herein is, and remains, the property of DJI.
+ * The intellectual and technical concepts contained herein are proprietary
+ * to DJI and may be covered by U.S. and foreign patents, patents in process,
+ * and protected by trade secret or copyright law.  Dissemination of this
+ * information, including but not limited to data and other proprietary
+ * material(s) incorporated within the information, in any form, is strictly
+ * prohibited without the express written consent of DJI.
+ *
+ * If you receive this source code without DJI’s authorization, you may not
+ * further disseminate the information, and you must immediately remove the
+ * source code and notify DJI of its removal. DJI reserves the right to pursue
+ * legal actions against you for any loss(es) or damage(s) caused by your
+ * failure to do so.
+ *
+ *********************************************************************
+ */
+
+/* Define to prevent recursive inclusion -------------------------------------*/
+#ifndef TEST_PERCEPTION_DEPTH_H
+#define TEST_PERCEPTION_DEPTH_H
+
+/* Includes ------------------------------------------------------------------*/
+#include <vector>
+#include "dji_perception.h"
+#include "dji_platform.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Exported constants --------------------------------------------------------*/
+#define PERCEPTION_DEPTH_MAX_THREAD_NUM         (8)
+#define PERCEPTION_DEPTH_DISPARITY_SHIFT        (4)
+
+/* Exported types ------------------------------------------------------------*/
+typedef enum {
+    PERCEPTION_DEPTH_METHOD_BLOCK_MATCHING = 0,
+    PERCEPTION_DEPTH_METHOD_SGM = 1,
+} E_PerceptionDepthMethod;
+
+typedef struct {
+    E_PerceptionDepthMethod method;
+    uint32_t scale;                 /*!< Inputs are box-downsampled by 1, 2 or 4, all outputs use this resolution. */
+    uint32_t maxDisparity;          /*!< Search range at the processing resolution, rounded up to a multiple of 8. */
+    uint32_t threadNum;             /*!< Number of horizontal bands matched in parallel, the caller runs one band. */
+    uint32_t blockRadius;           /*!< Half window of the block matching aggregation. */
+    uint16_t penaltySmall;          /*!< SGM penalty for a disparity step of one. */
+    uint16_t penaltyLarge;          /*!< SGM penalty for larger disparity jumps. */
+    uint32_t uniquenessPercent;     /*!< Best cost must beat the second best by this margin. */
+    uint32_t pointCloudStep;        /*!< Every n-th pixel in both directions becomes a point, 0 disables the cloud. */
+    float maxDepth;                 /*!< Points beyond this depth are not put into the cloud. */
+} T_PerceptionDepthConfig;
+
+typedef struct {
+    float x;
+    float y;
+    float z;
+} T_PerceptionDepthPoint;
+
+/**
+ * @brief Output of one stereo pair, depth and points use the unit of the stereo baseline in the camera parameters.
+ */
+struct PerceptionDepthResult {
+    uint8_t direction;
+    uint16_t sequence;
+    uint64_t timeStamp;
+    uint32_t width;
+    uint32_t height;
+    std::vector<uint16_t> disparity;            /*!< Left image disparity in 1/16 pixel, 0 is invalid. */
+    std::vector<float> depth;                   /*!< 0 is invalid. */
+    std::vector<T_PerceptionDepthPoint> points; /*!< Left rectified camera frame, x right, y down, z forward. */
+    uint32_t validCount;
+    uint64_t computeTimeUs;
+};
+
+typedef void (*PerceptionDepthCallback)(const PerceptionDepthResult &result, void *userData);
+
+struct PerceptionDepthWorker;
+
+/**
+ * @brief Census based block matching or semi-global matching on rectified stereo pairs.
+ * @note Compute splits the image into horizontal bands with overlapping margins and matches them on a fixed pool of
+ * worker tasks, the path recurrences run on 8 disparities at a time. PushImage pairs the left and right images of
+ * the perception image callback and hands complete pairs to a depth task that calls the result callback. IsRunning
+ * and PushImage may be called from the image callback while another task starts or stops the estimator.
+ */
+class PerceptionDepthEstimator {
+public:
+    PerceptionDepthEstimator();
+    ~PerceptionDepthEstimator();
+
+    static void GetDefaultConfig(T_PerceptionDepthConfig *config);
+    T_DjiReturnCode SetConfig(const T_PerceptionDepthConfig &config);
+    void SetCameraParameters(const T_DjiPerceptionCameraParametersPacket &packet);
+    T_DjiReturnCode Compute(const uint8_t *left, const uint8_t *right, uint32_t width, uint32_t height,
+                            uint8_t direction, PerceptionDepthResult &result);
+
+    T_DjiReturnCode Start(PerceptionDepthCallback callback, void *userData);
+    T_DjiReturnCode Stop();
+    bool IsRunning() const;
+
+    /**
+     * @brief Feed one image of the perception image callback.
+     * @param isBlocking: wait for the depth task instead of dropping the pair when it is still busy.
+     */
+    void PushImage(const T_DjiPerceptionImageInfo &imageInfo, const uint8_t *imageRawBuffer, uint32_t bufferLen,
+                   bool isBlocking);
+    uint32_t GetDroppedCount();
+
+private:
+    struct PendingImage {
+        bool isValid;
+        uint16_t sequence;
+        uint64_t timeStamp;
+        uint32_t width;
+        uint32_t height;
+        std::vector<uint8_t> data;
+    };
+
+    T_DjiReturnCode CreateWorkers();
+    void DestroyWorkers();
+    void Downsample(const uint8_t *src, uint32_t width, uint32_t height, std::vector<uint8_t> &dst);
+    void FillResult(uint8_t direction, PerceptionDepthResult &result);
+    static void *WorkerTask(void *arg);
+    static void *DepthTask(void *arg);
+
+    T_PerceptionDepthConfig m_config;
+    T_DjiPerceptionCameraParametersPacket m_cameraParameters;
+    std::vector<PerceptionDepthWorker *> m_workers;
+    T_DjiSemaHandle m_doneSema;
+    bool m_isWorkerExit;
+    std::vector<uint8_t> m_left;
+    std::vector<uint8_t> m_right;
+    std::vector<float> m_disparity;
+    uint32_t m_width;
+    uint32_t m_height;
+
+    PendingImage m_pending[IMAGE_MAX_DIRECTION_NUM][2];
+    PendingImage m_job[2];
+    uint8_t m_jobDirection;
+    T_DjiMutexHandle m_pairMutex;
+    T_DjiSemaHandle m_jobSema;
+    T_DjiSemaHandle m_idleSema;
+    T_DjiSemaHandle m_exitSema;
+    T_DjiTaskHandle m_depthThread;
+    PerceptionDepthCallback m_callback;
+    void *m_userData;
+    bool m_isRunning;
+    bool m_isDepthExit;
+    uint32_t m_droppedCount;
+    PerceptionDepthResult m_result;
+};
+
+/* Exported functions --------------------------------------------------------*/
+/**
+ * @brief Run the depth estimation on every pair of a perception record file and log the timing.
+ * @param path: file written by PerceptionRecorder.
+ * @param config: depth configuration, NULL uses the default one.
+ * @return an enum that represents a status of PSDK
+ */
+T_DjiReturnCode DjiUser_RunStereoDepthBenchmark(const char *path, const T_PerceptionDepthConfig *config);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // TEST_PERCEPTION_DEPTH_H
+/************************ (C) COPYRIGHT DJI Innovations *******END OF FILE******/
@@ -28,7 +28,14 @@
 #include "dji_logger.h"
 #include "dji_perception.h"
 #include "test_perception.hpp"
+#include "test_perception_recorder.hpp"
+#include "test_perception_depth.hpp"
+#include "utils/util_misc.h"
+#include "telemetry_bus/test_telemetry_bus.h"
+#include "flight_recorder/test_flight_recorder.h"
 #include <iostream>
+#include <string>
+#include <ctime>
 
 #ifdef OPEN_CV_INSTALLED
 
@@ -41,6 +48,13 @@
 #define USER_PERCEPTION_TASK_STACK_SIZE    (1024)
 #define USER_PERCEPTION_DIRECTION_NUM      (12)
 #define FPS_STRING_LEN                     (50)
+#define RECORD_FILE_PATH_LEN               (64)
+#define DEPTH_LOG_INTERVAL                 (10)
+/* A sample is the packed T_DjiPerceptionImageInfo followed by the image, a 640x480 8 bit image fits. */
+#define PERCEPTION_BUS_SLOT_SIZE           (512 * 1024)
+#define PERCEPTION_BUS_SLOT_COUNT          (8)
+#define PERCEPTION_BUS_IMAGE_LAYOUT        "index:u32 direction:u8 bpp:u8 width:u32 height:u32 dataId:u16 " \
+                                           "sequence:u16 dataType:u32 timeStamp:u64 image:bytes"
 
 /* Private types -------------------------------------------------------------*/
 typedef struct {
@@ -67,6 +81,13 @@ static T_DjiTestStereoImagePacket s_stereoImagePacket = {
     .imageRawBuffer = nullptr,
     .mutex          = nullptr,
     .gotData        = false};
+static PerceptionRecorder s_stereoImageRecorder;
+static PerceptionReplay s_stereoImageReplay;
+static PerceptionDepthEstimator s_stereoDepthEstimator;
+static uint16_t s_perceptionBusTopicId;
+static bool s_isPerceptionBusTopicAdded = false;
+static uint16_t s_perceptionRecordChannelId;
+static bool s_isPerceptionRecordChannelAdded = false;
 
 static const T_DjiTestPerceptionDirectionName directionName[] = {
     {.direction = DJI_PERCEPTION_RECTIFY_DOWN, .name = "down"},
@@ -95,7 +116,11 @@ static const T_DjiTestPerceptionCameraPositionName positionName[] = {
 /* Private functions declaration ---------------------------------------------*/
 static void DjiTest_PerceptionImageCallback(T_DjiPerceptionImageInfo imageInfo, uint8_t *imageRawBuffer,
                                             uint32_t bufferLen);
+static void DjiTest_StereoDepthResultCallback(const PerceptionDepthResult &result, void *userData);
 static void *DjiTest_StereoImagesDisplayTask(void *arg);
+static void DjiTest_PerceptionPublishToBus(const T_DjiPerceptionImageInfo &imageInfo, const uint8_t *imageRawBuffer,
+                                           uint32_t bufferLen);
+static void DjiTest_PerceptionReplayRecord(const T_DjiTestFlightRecordSample *sample, void *userData);
 
 /* Exported functions definition ---------------------------------------------*/
 void DjiUser_RunStereoVisionViewSample(void)
@@ -105,6 +130,11 @@ void DjiUser_RunStereoVisionViewSample(void)
     char isQuit;
     T_DjiReturnCode returnCode;
     T_DjiPerceptionCameraParametersPacket cameraParametersPacket = {0};
+    char recordFilePath[RECORD_FILE_PATH_LEN];
+    std::string replayFilePath;
+    std::string benchmarkFilePath;
+    double replayRate;
+    time_t currentTime;
 
     PerceptionSample *perceptionSample;
     try {
@@ -119,6 +149,28 @@ void DjiUser_RunStereoVisionViewSample(void)
         goto DeletePerception;
     }
 
+    returnCode = DjiTest_TelemetryBusAddDefaultTopic("perception/image", "dji.perception.image", 1,
+                                                     PERCEPTION_BUS_IMAGE_LAYOUT, PERCEPTION_BUS_SLOT_SIZE,
+                                                     PERCEPTION_BUS_SLOT_COUNT, &s_perceptionBusTopicId);
+    if (returnCode != DJI_ERROR_SYSTEM_MODULE_CODE_SUCCESS) {
+        USER_LOG_WARN("Add telemetry bus topic error, return code:0x%08X", returnCode);
+    } else {
+        s_isPerceptionBusTopicAdded = true;
+    }
+
+    {
+        T_DjiTestFlightRecorderChannelInfo channelInfo = {"perception/image", "dji.perception.image",
+                                                          PERCEPTION_BUS_IMAGE_LAYOUT};
+
+        returnCode = DjiTest_FlightRecorderAddChannel(&channelInfo, DjiTest_PerceptionReplayRecord, nullptr,
+                                                      &s_perceptionRecordChannelId);
+        if (returnCode != DJI_ERROR_SYSTEM_MODULE_CODE_SUCCESS) {
+            USER_LOG_WARN("Add flight record channel error, return code:0x%08X", returnCode);
+        } else {
+            s_isPerceptionRecordChannelAdded = true;
+        }
+    }
+
     returnCode = osalHandler->TaskCreate("user_perception_task", DjiTest_StereoImagesDisplayTask,
                                          USER_PERCEPTION_TASK_STACK_SIZE, &s_stereoImagePacket, &s_stereoImageThread);
     if (returnCode != DJI_ERROR_SYSTEM_MODULE_CODE_SUCCESS) {
@@ -203,6 +255,22 @@ void DjiUser_RunStereoVisionViewSample(void)
             << "| [t] Subscribe right stereo camera pair images                  |"
             <<
             std::endl;
+        std::cout
+            << "| [c] Start or stop recording the subscribed images to a file    |"
+            <<
+            std::endl;
+        std::cout
+            << "| [p] Replay a recorded file instead of the live images          |"
+            <<
+            std::endl;
+        std::cout
+            << "| [e] Start or stop the stereo depth estimation                  |"
+            <<
+            std::endl;
+        std::cout
+            << "| [k] Run the stereo depth benchmark on a recorded file          |"
+            <<
+            std::endl;
         std::cout
             << "| [q] quit                                                       |"
             <<
@@ -237,6 +305,50 @@ void DjiUser_RunStereoVisionViewSample(void)
             case 'g':
                 USER_LOG_INFO("Do stereo camera parameters subscription");
                 break;
+            case 'c':
+                if (s_stereoImageRecorder.IsRecording()) {
+                    s_stereoImageRecorder.Stop();
+                } else {
+                    currentTime = time(nullptr);
+                    strftime(recordFilePath, sizeof(recordFilePath), "perception_%Y%m%d_%H%M%S.dat",
+                             localtime(&currentTime));
+                    s_stereoImageRecorder.Start(recordFilePath, cameraParametersPacket);
+                }
+                continue;
+            case 'p':
+                std::cout << "Please input the record file path and the replay rate (0 for no delay): ";
+                std::cin >> replayFilePath >> replayRate;
+                returnCode = s_stereoImageReplay.Open(replayFilePath.c_str());
+                if (returnCode == DJI_ERROR_SYSTEM_MODULE_CODE_SUCCESS) {
+                    returnCode = s_stereoImageReplay.Start(DjiTest_PerceptionImageCallback, replayRate, true);
+                }
+                if (returnCode != DJI_ERROR_SYSTEM_MODULE_CODE_SUCCESS) {
+                    USER_LOG_ERROR("Replay perception record failed, return code:0x%08X", returnCode);
+                    s_stereoImageReplay.Close();
+                    continue;
+                }
+                break;
+            case 'e':
+                if (s_stereoDepthEstimator.IsRunning()) {
+                    s_stereoDepthEstimator.Stop();
+                    USER_LOG_INFO("Stop stereo depth estimation, %u pairs dropped.",
+                                  s_stereoDepthEstimator.GetDroppedCount());
+                } else {
+                    s_stereoDepthEstimator.SetCameraParameters(cameraParametersPacket);
+                    returnCode = s_stereoDepthEstimator.Start(DjiTest_StereoDepthResultCallback, nullptr);
+                    if (returnCode != DJI_ERROR_SYSTEM_MODULE_CODE_SUCCESS) {
+                        USER_LOG_ERROR("Start stereo depth estimation failed, return code:0x%08X", returnCode);
+                    }
+                }
+                continue;
+            case 'k':
+                std::cout << "Please input the record file path: ";
+                std::cin >> benchmarkFilePath;
+                returnCode = DjiUser_RunStereoDepthBenchmark(benchmarkFilePath.c_str(), nullptr);
+                if (returnCode != DJI_ERROR_SYSTEM_MODULE_CODE_SUCCESS) {
+                    USER_LOG_ERROR("Run stereo depth benchmark failed, return code:0x%08X", returnCode);
+                }
+                continue;
             case 'q':
                 goto DestroyTask;
             default:
@@ -280,6 +392,10 @@ void DjiUser_RunStereoVisionViewSample(void)
                 USER_LOG_INFO("Unsubscribe right stereo camera pair images.");
                 perceptionSample->UnSubscribeRightImage();
                 break;
+            case 'p':
+                USER_LOG_INFO("Stop replaying perception record.");
+                s_stereoImageReplay.Close();
+                break;
             default:
                 break;
         }
@@ -289,6 +405,12 @@ void DjiUser_RunStereoVisionViewSample(void)
     }
 
 DestroyTask:
+    if (s_isPerceptionRecordChannelAdded) {
+        DjiTest_FlightRecorderSetReplayHandler(s_perceptionRecordChannelId, nullptr, nullptr);
+    }
+    s_stereoDepthEstimator.Stop();
+    s_stereoImageRecorder.Stop();
+    s_stereoImageReplay.Close();
     returnCode = osalHandler->TaskDestroy(s_stereoImageThread);
     if (returnCode != DJI_ERROR_SYSTEM_MODULE_CODE_SUCCESS) {
         USER_LOG_ERROR("Destroy task failed, return code:0x%08X", returnCode);
@@ -317,6 +439,16 @@ static void DjiTest_PerceptionImageCallback(T_DjiPerceptionImageInfo imageInfo,
                   imageInfo.rawInfo.direction,
                   imageInfo.rawInfo.bpp, bufferLen);
 
+    s_stereoImageRecorder.PushFrame(imageInfo, imageRawBuffer, bufferLen);
+    DjiTest_PerceptionPublishToBus(imageInfo, imageRawBuffer, bufferLen);
+    if (s_isPerceptionRecordChannelAdded && imageRawBuffer != nullptr && DjiTest_FlightRecorderIsRecording()) {
+        DjiTest_FlightRecorderWrite(s_perceptionRecordChannelId, imageInfo.timeStamp, &imageInfo,
+                                    sizeof(T_DjiPerceptionImageInfo), imageRawBuffer, bufferLen);
+    }
+    if (s_stereoDepthEstimator.IsRunning()) {
+        s_stereoDepthEstimator.PushImage(imageInfo, imageRawBuffer, bufferLen, false);
+    }
+
     if (imageRawBuffer) {
         osalHandler->MutexLock(s_stereoImagePacket.mutex);
         s_stereoImagePacket.info = imageInfo;
@@ -328,6 +460,23 @@ static void DjiTest_PerceptionImageCallback(T_DjiPerceptionImageInfo imageInfo,
     }
 }
 
+static void DjiTest_StereoDepthResultCallback(const PerceptionDepthResult &result, void *userData)
+{
+    static uint32_t resultCount = 0;
+    float centerDepth;
+
+    USER_UTIL_UNUSED(userData);
+
+    if (resultCount++ % DEPTH_LOG_INTERVAL != 0 || result.width == 0 || result.height == 0) {
+        return;
+    }
+
+    centerDepth = result.depth[(result.height / 2) * result.width + result.width / 2];
+    USER_LOG_INFO("depth info : dir(%d) seq(%d) valid(%.1f%%) center depth(%.2f) points(%d) time(%.1f ms)",
+                  result.direction, result.sequence, 100.0f * result.validCount / (result.width * result.height),
+                  centerDepth, (int) result.points.size(), result.computeTimeUs / 1000.0f);
+}
+
 static void *DjiTest_StereoImagesDisplayTask(void *arg)
 {
     T_DjiOsalHandler *osalHandler = DjiPlatform_GetOsalHandler();
@@ -396,4 +545,40 @@ static void *DjiTest_StereoImagesDisplayTask(void *arg)
     }
 }
 
+static void DjiTest_PerceptionPublishToBus(const T_DjiPerceptionImageInfo &imageInfo, const uint8_t *imageRawBuffer,
+                                           uint32_t bufferLen)
+{
+    T_DjiTestTelemetryBus *bus = DjiTest_TelemetryBusGetDefault();
+    uint8_t *sample;
+    uint32_t capacity;
+
+    if (!s_isPerceptionBusTopicAdded || imageRawBuffer == nullptr ||
+        bufferLen > PERCEPTION_BUS_SLOT_SIZE - sizeof(T_DjiPerceptionImageInfo)) {
+        return;
+    }
+
+    /* Written into the slot directly, the image is copied once on its way to the other processes. */
+    if (DjiTest_TelemetryBusLoan(bus, s_perceptionBusTopicId, &sample, &capacity) !=
+        DJI_ERROR_SYSTEM_MODULE_CODE_SUCCESS) {
+        return;
+    }
+    memcpy(sample, &imageInfo, sizeof(T_DjiPerceptionImageInfo));
+    memcpy(sample + sizeof(T_DjiPerceptionImageInfo), imageRawBuffer, bufferLen);
+    DjiTest_TelemetryBusCommit(bus, s_perceptionBusTopicId, sizeof(T_DjiPerceptionImageInfo) + bufferLen);
+}
+
+static void DjiTest_PerceptionReplayRecord(const T_DjiTestFlightRecordSample *sample, void *userData)
+{
+    T_DjiPerceptionImageInfo imageInfo;
+
+    USER_UTIL_UNUSED(userData);
+
+    if (sample->headerLen != sizeof(T_DjiPerceptionImageInfo)) {
+        return;
+    }
+
+    memcpy(&imageInfo, sample->header, sizeof(T_DjiPerceptionImageInfo));
+    DjiTest_PerceptionImageCallback(imageInfo, const_cast<uint8_t *>(sample->data), sample->dataLen);
+}
+
 /****************** (C) COPYRIGHT DJI Innovations *****END OF FILE****/
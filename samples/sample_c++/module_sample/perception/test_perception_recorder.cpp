@@ -0,0 +1,668 @@
+ /**
+ ********************************************************************
+ * @file    test_perception_recorder.cpp
+ * @brief   Stereo image recorder writing an indexed chunked file, and the matching replay source.
+ *
+ * @copyright (c) 2021 DJI. All rights reserved.
+ *
+ * All information contained herein is, and remains, the property of DJI.
+ * The intellectual and technical concepts contained herein are proprietary
+ * to DJI and may be covered by U.S. and foreign patents, patents in process,
+ * and protected by trade secret or copyright law.  Dissemination of this
+ * information, including but not limited to data and other proprietary
+ * material(s) incorporated within the information, in any form, is strictly
+ * prohibited without the express written consent of DJI.
+ *
+ * If you receive this source code without DJI’s authorization, you may not
+ * further disseminate the information, and you must immediately remove the
+ * source code and notify DJI of its removal. DJI reserves the right to pursue
+ * legal actions against you for any loss(es) or damage(s) caused by your
+ * failure to do so.
+ *
+ *********************************************************************
+ */
+
+
+/* Includes ------------------------------------------------------------------*/
+#include <cstring>
+#include "test_perception_recorder.hpp"
+#include "dji_logger.h"
+
+/* Private constants ---------------------------------------------------------*/
+#define PERCEPTION_RECORD_VERSION               (1)
+#define PERCEPTION_RECORD_CHUNK_MAGIC           (0x4B4E4843U)  /* "CHNK" */
+#define PERCEPTION_RECORD_FOOTER_MAGIC          (0x58444E49U)  /* "INDX" */
+#define PERCEPTION_RECORD_FILE_BUFFER_SIZE      (1024 * 1024)
+#define PERCEPTION_RECORD_INDEX_RESERVE_NUM     (4096)
+#define PERCEPTION_RECORD_WAIT_MS               (100)
+#define PERCEPTION_RECORD_REPLAY_SLEEP_MAX_MS   (10)
+#define PERCEPTION_RECORD_TASK_STACK_SIZE       (2048)
+
+/* Private types -------------------------------------------------------------*/
+
+/* Private values -------------------------------------------------------------*/
+static const char s_recordFileMagic[8] = {'D', 'J', 'I', 'S', 'T', 'R', 'E', 'O'};
+
+/* Private functions declaration ---------------------------------------------*/
+
+/* Exported functions definition ---------------------------------------------*/
+PerceptionRecorder::PerceptionRecorder() : m_mutex(nullptr), m_dataSema(nullptr), m_exitSema(nullptr),
+                                           m_writerThread(nullptr), m_slotMemory(nullptr), m_frameMemory(nullptr),
+                                           m_maxFrameSize(0), m_file(nullptr), m_isRecording(false),
+                                           m_stopWriter(false), m_startTimeUs(0), m_droppedCount(0),
+                                           m_recordedCount(0), m_chunkCount(0), m_chunkOffset(0), m_chunkHeader()
+{
+}
+
+PerceptionRecorder::~PerceptionRecorder()
+{
+    Stop();
+}
+
+T_DjiReturnCode PerceptionRecorder::Start(const char *path,
+                                          const T_DjiPerceptionCameraParametersPacket &cameraParameters,
+                                          uint32_t slotNum, uint32_t maxFrameSize)
+{
+    T_DjiOsalHandler *osalHandler = DjiPlatform_GetOsalHandler();
+    T_PerceptionRecordFileHeader fileHeader = {};
+    T_DjiReturnCode returnCode;
+    size_t slotMemorySize = UtilPool_GetMemorySize(slotNum, sizeof(T_PerceptionRecordSlot));
+
+    if (m_file != nullptr) {
+        USER_LOG_ERROR("Perception recorder is already running.");
+        return DJI_ERROR_SYSTEM_MODULE_CODE_NONSUPPORT_IN_CURRENT_STATE;
+    }
+
+    if (path == nullptr || slotNum == 0 || maxFrameSize == 0) {
+        return DJI_ERROR_SYSTEM_MODULE_CODE_INVALID_PARAMETER;
+    }
+
+    /* All image buffers are taken here, recording itself never allocates them again. */
+    m_slotMemory = (uint8_t *) osalHandler->Malloc(slotMemorySize);
+    m_frameMemory = (uint8_t *) osalHandler->Malloc((size_t) slotNum * maxFrameSize);
+    if (m_slotMemory == nullptr || m_frameMemory == nullptr) {
+        USER_LOG_ERROR("Malloc perception record buffers failed.");
+        ReleaseResource();
+        return DJI_ERROR_SYSTEM_MODULE_CODE_MEMORY_ALLOC_FAILED;
+    }
+
+    returnCode = UtilPool_Init(&m_slotPool, m_slotMemory, slotMemorySize, sizeof(T_PerceptionRecordSlot));
+    if (returnCode != DJI_ERROR_SYSTEM_MODULE_CODE_SUCCESS) {
+        ReleaseResource();
+        return returnCode;
+    }
+    UtilDlist_Init(&m_pendingList);
+    m_maxFrameSize = maxFrameSize;
+
+    if (osalHandler->MutexCreate(&m_mutex) != DJI_ERROR_SYSTEM_MODULE_CODE_SUCCESS ||
+        osalHandler->SemaphoreCreate(0, &m_dataSema) != DJI_ERROR_SYSTEM_MODULE_CODE_SUCCESS ||
+        osalHandler->SemaphoreCreate(0, &m_exitSema) != DJI_ERROR_SYSTEM_MODULE_CODE_SUCCESS) {
+        USER_LOG_ERROR("Create perception recorder lock failed.");
+        ReleaseResource();
+        return DJI_ERROR_SYSTEM_MODULE_CODE_SYSTEM_ERROR;
+    }
+
+    m_file = fopen(path, "wb");
+    if (m_file == nullptr) {
+        USER_LOG_ERROR("Open perception record file %s failed.", path);
+        ReleaseResource();
+        return DJI_ERROR_SYSTEM_MODULE_CODE_SYSTEM_ERROR;
+    }
+    setvbuf(m_file, nullptr, _IOFBF, PERCEPTION_RECORD_FILE_BUFFER_SIZE);
+
+    osalHandler->GetTimeUs(&m_startTimeUs);
+    memcpy(fileHeader.magic, s_recordFileMagic, sizeof(fileHeader.magic));
+    fileHeader.version = PERCEPTION_RECORD_VERSION;
+    fileHeader.headerSize = sizeof(T_PerceptionRecordFileHeader);
+    fileHeader.imageInfoSize = sizeof(T_DjiPerceptionImageInfo);
+    fileHeader.chunkFrameNum = PERCEPTION_RECORD_DEFAULT_CHUNK_FRAME_NUM;
+    fileHeader.startTimeUs = m_startTimeUs;
+    fileHeader.cameraParameters = cameraParameters;
+    if (fwrite(&fileHeader, sizeof(fileHeader), 1, m_file) != 1) {
+        USER_LOG_ERROR("Write perception record file header failed.");
+        ReleaseResource();
+        return DJI_ERROR_SYSTEM_MODULE_CODE_SYSTEM_ERROR;
+    }
+
+    m_index.clear();
+    m_index.reserve(PERCEPTION_RECORD_INDEX_RESERVE_NUM);
+    m_chunkHeader = T_PerceptionRecordChunkHeader();
+    m_chunkCount = 0;
+    m_droppedCount = 0;
+    m_recordedCount = 0;
+    m_stopWriter = false;
+    m_isRecording = true;
+
+    returnCode = osalHandler->TaskCreate("perception_record", WriterTask, PERCEPTION_RECORD_TASK_STACK_SIZE, this,
+                                         &m_writerThread);
+    if (returnCode != DJI_ERROR_SYSTEM_MODULE_CODE_SUCCESS) {
+        USER_LOG_ERROR("Create perception record task failed, return code:0x%08X", returnCode);
+        m_isRecording = false;
+        ReleaseResource();
+        return returnCode;
+    }
+
+    USER_LOG_INFO("Start recording perception images to %s.", path);
+
+    return DJI_ERROR_SYSTEM_MODULE_CODE_SUCCESS;
+}
+
+T_DjiReturnCode PerceptionRecorder::Stop()
+{
+    T_DjiOsalHandler *osalHandler = DjiPlatform_GetOsalHandler();
+    T_DjiReturnCode returnCode;
+
+    if (m_file == nullptr) {
+        return DJI_ERROR_SYSTEM_MODULE_CODE_SUCCESS;
+    }
+
+    osalHandler->MutexLock(m_mutex);
+    m_isRecording = false;
+    m_stopWriter = true;
+    osalHandler->MutexUnlock(m_mutex);
+
+    /* The writer drains every queued frame before it signals the exit. */
+    osalHandler->SemaphorePost(m_dataSema);
+    osalHandler->SemaphoreWait(m_exitSema);
+    osalHandler->TaskDestroy(m_writerThread);
+    m_writerThread = nullptr;
+
+    returnCode = CloseChunk();
+    if (returnCode == DJI_ERROR_SYSTEM_MODULE_CODE_SUCCESS) {
+        returnCode = WriteIndex();
+    }
+    if (returnCode != DJI_ERROR_SYSTEM_MODULE_CODE_SUCCESS) {
+        USER_LOG_ERROR("Finish perception record file failed, the replay will rebuild the index.");
+    }
+
+    USER_LOG_INFO("Stop recording perception images, recorded %u frames in %u chunks, dropped %u frames.",
+                  m_recordedCount, m_chunkCount, m_droppedCount);
+    ReleaseResource();
+
+    return returnCode;
+}
+
+bool PerceptionRecorder::IsRecording()
+{
+    T_DjiOsalHandler *osalHandler = DjiPlatform_GetOsalHandler();
+    bool isRecording;
+
+    if (m_mutex == nullptr) {
+        return false;
+    }
+
+    osalHandler->MutexLock(m_mutex);
+    isRecording = m_isRecording;
+    osalHandler->MutexUnlock(m_mutex);
+
+    return isRecording;
+}
+
+void PerceptionRecorder::PushFrame(const T_DjiPerceptionImageInfo &imageInfo, const uint8_t *imageRawBuffer,
+                                   uint32_t bufferLen)
+{
+    T_DjiOsalHandler *osalHandler = DjiPlatform_GetOsalHandler();
+    T_PerceptionRecordSlot *slot;
+    uint64_t nowUs = 0;
+
+    if (m_mutex == nullptr || imageRawBuffer == nullptr) {
+        return;
+    }
+
+    osalHandler->GetTimeUs(&nowUs);
+
+    /* The copy runs under the lock so Stop can never release a buffer that is still being filled. */
+    osalHandler->MutexLock(m_mutex);
+    if (!m_isRecording) {
+        osalHandler->MutexUnlock(m_mutex);
+        return;
+    }
+
+    slot = (T_PerceptionRecordSlot *) UtilPool_Alloc(&m_slotPool);
+    if (slot == nullptr || bufferLen > m_maxFrameSize) {
+        if (slot != nullptr) {
+            UtilPool_Free(&m_slotPool, slot);
+        }
+        __atomic_add_fetch(&m_droppedCount, 1, __ATOMIC_RELAXED);
+        osalHandler->MutexUnlock(m_mutex);
+        return;
+    }
+
+    slot->data = m_frameMemory + (size_t) UtilPool_GetIndex(&m_slotPool, slot) * m_maxFrameSize;
+    slot->header.info = imageInfo;
+    slot->header.recvTimeUs = nowUs - m_startTimeUs;
+    slot->header.bufferLen = bufferLen;
+    memcpy(slot->data, imageRawBuffer, bufferLen);
+    UtilDlist_AddLast(&m_pendingList, &slot->node);
+    osalHandler->MutexUnlock(m_mutex);
+
+    osalHandler->SemaphorePost(m_dataSema);
+}
+
+uint32_t PerceptionRecorder::GetRecordedCount()
+{
+    return __atomic_load_n(&m_recordedCount, __ATOMIC_RELAXED);
+}
+
+uint32_t PerceptionRecorder::GetDroppedCount()
+{
+    return __atomic_load_n(&m_droppedCount, __ATOMIC_RELAXED);
+}
+
+PerceptionReplay::PerceptionReplay() : m_file(nullptr), m_header(), m_callback(nullptr), m_rate(1.0),
+                                       m_isLoop(false), m_stop(false), m_isFinished(true), m_isRunning(false),
+                                       m_exitSema(nullptr), m_replayThread(nullptr)
+{
+}
+
+PerceptionReplay::~PerceptionReplay()
+{
+    Close();
+}
+
+T_DjiReturnCode PerceptionReplay::Open(const char *path)
+{
+    T_DjiReturnCode returnCode;
+
+    if (m_file != nullptr) {
+        return DJI_ERROR_SYSTEM_MODULE_CODE_NONSUPPORT_IN_CURRENT_STATE;
+    }
+
+    m_file = fopen(path, "rb");
+    if (m_file == nullptr) {
+        USER_LOG_ERROR("Open perception record file %s failed.", path);
+        return DJI_ERROR_SYSTEM_MODULE_CODE_INVALID_PARAMETER;
+    }
+
+    if (fread(&m_header, sizeof(m_header), 1, m_file) != 1 ||
+        memcmp(m_header.magic, s_recordFileMagic, sizeof(m_header.magic)) != 0 ||
+        m_header.version != PERCEPTION_RECORD_VERSION || m_header.headerSize != sizeof(T_PerceptionRecordFileHeader) ||
+        m_header.imageInfoSize != sizeof(T_DjiPerceptionImageInfo)) {
+        USER_LOG_ERROR("File %s is not a supported perception record.", path);
+        Close();
+        return DJI_ERROR_SYSTEM_MODULE_CODE_INVALID_PARAMETER;
+    }
+
+    returnCode = LoadIndex();
+    if (returnCode != DJI_ERROR_SYSTEM_MODULE_CODE_SUCCESS || m_index.empty()) {
+        USER_LOG_ERROR("Perception record %s has no frame.", path);
+        Close();
+        return DJI_ERROR_SYSTEM_MODULE_CODE_INVALID_PARAMETER;
+    }
+
+    USER_LOG_INFO("Open perception record %s, %u frames.", path, (uint32_t) m_index.size());
+
+    return DJI_ERROR_SYSTEM_MODULE_CODE_SUCCESS;
+}
+
+void PerceptionReplay::Close()
+{
+    Stop();
+
+    if (m_file != nullptr) {
+        fclose(m_file);
+        m_file = nullptr;
+    }
+    m_index.clear();
+}
+
+const T_DjiPerceptionCameraParametersPacket &PerceptionReplay::GetCameraParameters() const
+{
+    return m_header.cameraParameters;
+}
+
+uint32_t PerceptionReplay::GetFrameCount() const
+{
+    return (uint32_t) m_index.size();
+}
+
+T_DjiReturnCode PerceptionReplay::Start(DjiPerceptionImageCallback callback, double rate, bool isLoop)
+{
+    T_DjiOsalHandler *osalHandler = DjiPlatform_GetOsalHandler();
+    T_DjiReturnCode returnCode;
+
+    if (m_file == nullptr || m_isRunning) {
+        return DJI_ERROR_SYSTEM_MODULE_CODE_NONSUPPORT_IN_CURRENT_STATE;
+    }
+
+    if (callback == nullptr || rate < 0) {
+        return DJI_ERROR_SYSTEM_MODULE_CODE_INVALID_PARAMETER;
+    }
+
+    returnCode = osalHandler->SemaphoreCreate(0, &m_exitSema);
+    if (returnCode != DJI_ERROR_SYSTEM_MODULE_CODE_SUCCESS) {
+        return returnCode;
+    }
+
+    m_callback = callback;
+    m_rate = rate;
+    m_isLoop = isLoop;
+    m_stop = false;
+    m_isFinished = false;
+
+    returnCode = osalHandler->TaskCreate("perception_replay", ReplayTask, PERCEPTION_RECORD_TASK_STACK_SIZE, this,
+                                         &m_replayThread);
+    if (returnCode != DJI_ERROR_SYSTEM_MODULE_CODE_SUCCESS) {
+        USER_LOG_ERROR("Create perception replay task failed, return code:0x%08X", returnCode);
+        osalHandler->SemaphoreDestroy(m_exitSema);
+        m_exitSema = nullptr;
+        m_isFinished = true;
+        return returnCode;
+    }
+    m_isRunning = true;
+
+    return DJI_ERROR_SYSTEM_MODULE_CODE_SUCCESS;
+}
+
+T_DjiReturnCode PerceptionReplay::Stop()
+{
+    T_DjiOsalHandler *osalHandler = DjiPlatform_GetOsalHandler();
+
+    if (!m_isRunning) {
+        return DJI_ERROR_SYSTEM_MODULE_CODE_SUCCESS;
+    }
+
+    __atomic_store_n(&m_stop, true, __ATOMIC_RELEASE);
+    osalHandler->SemaphoreWait(m_exitSema);
+    osalHandler->TaskDestroy(m_replayThread);
+    osalHandler->SemaphoreDestroy(m_exitSema);
+    m_replayThread = nullptr;
+    m_exitSema = nullptr;
+    m_isRunning = false;
+
+    return DJI_ERROR_SYSTEM_MODULE_CODE_SUCCESS;
+}
+
+bool PerceptionReplay::IsFinished()
+{
+    return __atomic_load_n(&m_isFinished, __ATOMIC_ACQUIRE);
+}
+
+/* Private functions definition-----------------------------------------------*/
+void *PerceptionRecorder::WriterTask(void *arg)
+{
+    T_DjiOsalHandler *osalHandler = DjiPlatform_GetOsalHandler();
+    auto *recorder = (PerceptionRecorder *) arg;
+    T_UtilDlistNode *node;
+    T_PerceptionRecordSlot *slot;
+    bool isExit = false;
+
+    while (!isExit) {
+        osalHandler->SemaphoreTimedWait(recorder->m_dataSema, PERCEPTION_RECORD_WAIT_MS);
+
+        while (true) {
+            osalHandler->MutexLock(recorder->m_mutex);
+            node = UtilDlist_RemoveFirst(&recorder->m_pendingList);
+            osalHandler->MutexUnlock(recorder->m_mutex);
+            if (node == nullptr) {
+                break;
+            }
+
+            slot = UTIL_DLIST_ENTRY(node, T_PerceptionRecordSlot, node);
+            if (recorder->WriteSlot(slot) != DJI_ERROR_SYSTEM_MODULE_CODE_SUCCESS) {
+                __atomic_add_fetch(&recorder->m_droppedCount, 1, __ATOMIC_RELAXED);
+            }
+
+            osalHandler->MutexLock(recorder->m_mutex);
+            UtilPool_Free(&recorder->m_slotPool, slot);
+            osalHandler->MutexUnlock(recorder->m_mutex);
+        }
+
+        osalHandler->MutexLock(recorder->m_mutex);
+        isExit = recorder->m_stopWriter && UtilDlist_IsEmpty(&recorder->m_pendingList);
+        osalHandler->MutexUnlock(recorder->m_mutex);
+    }
+
+    osalHandler->SemaphorePost(recorder->m_exitSema);
+
+    return nullptr;
+}
+
+T_DjiReturnCode PerceptionRecorder::WriteSlot(T_PerceptionRecordSlot *slot)
+{
+    T_PerceptionRecordIndexEntry entry = {};
+
+    if (m_chunkHeader.frameCount == 0) {
+        /* Written with a zero count first, CloseChunk patches it once the chunk is full. */
+        m_chunkOffset = ftello(m_file);
+        m_chunkHeader.magic = PERCEPTION_RECORD_CHUNK_MAGIC;
+        m_chunkHeader.payloadSize = 0;
+        if (fwrite(&m_chunkHeader, sizeof(m_chunkHeader), 1, m_file) != 1) {
+            return DJI_ERROR_SYSTEM_MODULE_CODE_SYSTEM_ERROR;
+        }
+    }
+
+    entry.offset = (uint64_t) ftello(m_file);
+    entry.recvTimeUs = slot->header.recvTimeUs;
+    entry.dataType = slot->header.info.dataType;
+    entry.sequence = slot->header.info.sequence;
+    if (fwrite(&slot->header, sizeof(slot->header), 1, m_file) != 1 ||
+        fwrite(slot->data, 1, slot->header.bufferLen, m_file) != slot->header.bufferLen) {
+        return DJI_ERROR_SYSTEM_MODULE_CODE_SYSTEM_ERROR;
+    }
+
+    m_index.push_back(entry);
+    m_chunkHeader.frameCount++;
+    m_chunkHeader.payloadSize += sizeof(slot->header) + slot->header.bufferLen;
+    __atomic_add_fetch(&m_recordedCount, 1, __ATOMIC_RELAXED);
+
+    if (m_chunkHeader.frameCount >= PERCEPTION_RECORD_DEFAULT_CHUNK_FRAME_NUM) {
+        return CloseChunk();
+    }
+
+    return DJI_ERROR_SYSTEM_MODULE_CODE_SUCCESS;
+}
+
+T_DjiReturnCode PerceptionRecorder::CloseChunk()
+{
+    off_t endOffset;
+
+    if (m_chunkHeader.frameCount == 0) {
+        return DJI_ERROR_SYSTEM_MODULE_CODE_SUCCESS;
+    }
+
+    endOffset = ftello(m_file);
+    if (fseeko(m_file, m_chunkOffset, SEEK_SET) != 0 ||
+        fwrite(&m_chunkHeader, sizeof(m_chunkHeader), 1, m_file) != 1 ||
+        fseeko(m_file, endOffset, SEEK_SET) != 0) {
+        return DJI_ERROR_SYSTEM_MODULE_CODE_SYSTEM_ERROR;
+    }
+
+    m_chunkCount++;
+    m_chunkHeader.frameCount = 0;
+
+    return DJI_ERROR_SYSTEM_MODULE_CODE_SUCCESS;
+}
+
+T_DjiReturnCode PerceptionRecorder::WriteIndex()
+{
+    T_PerceptionRecordFooter footer = {};
+
+    footer.magic = PERCEPTION_RECORD_FOOTER_MAGIC;
+    footer.frameCount = (uint32_t) m_index.size();
+    footer.indexOffset = (uint64_t) ftello(m_file);
+    footer.chunkCount = m_chunkCount;
+    footer.droppedCount = m_droppedCount;
+
+    if (!m_index.empty() &&
+        fwrite(m_index.data(), sizeof(T_PerceptionRecordIndexEntry), m_index.size(), m_file) != m_index.size()) {
+        return DJI_ERROR_SYSTEM_MODULE_CODE_SYSTEM_ERROR;
+    }
+
+    if (fwrite(&footer, sizeof(footer), 1, m_file) != 1 || fflush(m_file) != 0) {
+        return DJI_ERROR_SYSTEM_MODULE_CODE_SYSTEM_ERROR;
+    }
+
+    return DJI_ERROR_SYSTEM_MODULE_CODE_SUCCESS;
+}
+
+void PerceptionRecorder::ReleaseResource()
+{
+    T_DjiOsalHandler *osalHandler = DjiPlatform_GetOsalHandler();
+
+    if (m_file != nullptr) {
+        fclose(m_file);
+        m_file = nullptr;
+    }
+    if (m_mutex != nullptr) {
+        osalHandler->MutexDestroy(m_mutex);
+        m_mutex = nullptr;
+    }
+    if (m_dataSema != nullptr) {
+        osalHandler->SemaphoreDestroy(m_dataSema);
+        m_dataSema = nullptr;
+    }
+    if (m_exitSema != nullptr) {
+        osalHandler->SemaphoreDestroy(m_exitSema);
+        m_exitSema = nullptr;
+    }
+    if (m_slotMemory != nullptr) {
+        osalHandler->Free(m_slotMemory);
+        m_slotMemory = nullptr;
+    }
+    if (m_frameMemory != nullptr) {
+        osalHandler->Free(m_frameMemory);
+        m_frameMemory = nullptr;
+    }
+    m_index.clear();
+}
+
+void *PerceptionReplay::ReplayTask(void *arg)
+{
+    T_DjiOsalHandler *osalHandler = DjiPlatform_GetOsalHandler();
+    auto *replay = (PerceptionReplay *) arg;
+    T_PerceptionRecordFrameHeader frameHeader;
+    uint64_t baseUs = 0;
+    uint64_t nowUs = 0;
+    uint64_t targetUs;
+    size_t i = 0;
+
+    osalHandler->GetTimeUs(&baseUs);
+
+    while (!__atomic_load_n(&replay->m_stop, __ATOMIC_ACQUIRE)) {
+        if (i >= replay->m_index.size()) {
+            if (!replay->m_isLoop) {
+                break;
+            }
+            i = 0;
+            osalHandler->GetTimeUs(&baseUs);
+        }
+
+        const T_PerceptionRecordIndexEntry &entry = replay->m_index[i];
+        if (replay->m_rate > 0) {
+            /* Sleep in short steps so Stop is served quickly even for sparse recordings. */
+            targetUs = baseUs + (uint64_t) ((double) (entry.recvTimeUs - replay->m_index[0].recvTimeUs) /
+                                            replay->m_rate);
+            osalHandler->GetTimeUs(&nowUs);
+            while (nowUs < targetUs && !__atomic_load_n(&replay->m_stop, __ATOMIC_ACQUIRE)) {
+                uint64_t sleepMs = (targetUs - nowUs) / 1000;
+
+                osalHandler->TaskSleepMs(sleepMs > PERCEPTION_RECORD_REPLAY_SLEEP_MAX_MS ?
+                                         PERCEPTION_RECORD_REPLAY_SLEEP_MAX_MS : (uint32_t) sleepMs + 1);
+                osalHandler->GetTimeUs(&nowUs);
+            }
+        }
+
+        if (replay->ReadFrame(entry, frameHeader) != DJI_ERROR_SYSTEM_MODULE_CODE_SUCCESS) {
+            USER_LOG_ERROR("Read perception record frame %u failed.", (uint32_t) i);
+            break;
+        }
+
+        replay->m_callback(frameHeader.info, replay->m_frameBuffer.data(), frameHeader.bufferLen);
+        i++;
+    }
+
+    __atomic_store_n(&replay->m_isFinished, true, __ATOMIC_RELEASE);
+    osalHandler->SemaphorePost(replay->m_exitSema);
+
+    return nullptr;
+}
+
+T_DjiReturnCode PerceptionReplay::LoadIndex()
+{
+    T_PerceptionRecordFooter footer = {};
+    off_t fileSize;
+
+    m_index.clear();
+
+    if (fseeko(m_file, 0, SEEK_END) != 0) {
+        return DJI_ERROR_SYSTEM_MODULE_CODE_SYSTEM_ERROR;
+    }
+    fileSize = ftello(m_file);
+
+    if (fileSize >= (off_t) (sizeof(m_header) + sizeof(footer)) &&
+        fseeko(m_file, fileSize - (off_t) sizeof(footer), SEEK_SET) == 0 &&
+        fread(&footer, sizeof(footer), 1, m_file) == 1 && footer.magic == PERCEPTION_RECORD_FOOTER_MAGIC &&
+        footer.indexOffset + (uint64_t) footer.frameCount * sizeof(T_PerceptionRecordIndexEntry) + sizeof(footer) ==
+        (uint64_t) fileSize) {
+        m_index.resize(footer.frameCount);
+        if (fseeko(m_file, (off_t) footer.indexOffset, SEEK_SET) == 0 &&
+            (footer.frameCount == 0 ||
+             fread(m_index.data(), sizeof(T_PerceptionRecordIndexEntry), m_index.size(), m_file) == m_index.size())) {
+            return DJI_ERROR_SYSTEM_MODULE_CODE_SUCCESS;
+        }
+    }
+
+    USER_LOG_WARN("Perception record has no valid index, rebuild it from the chunks.");
+
+    return ScanChunks();
+}
+
+T_DjiReturnCode PerceptionReplay::ScanChunks()
+{
+    T_PerceptionRecordChunkHeader chunkHeader;
+    T_PerceptionRecordFrameHeader frameHeader;
+    T_PerceptionRecordIndexEntry entry = {};
+    off_t offset = sizeof(m_header);
+    off_t fileSize;
+    uint32_t i;
+
+    m_index.clear();
+
+    if (fseeko(m_file, 0, SEEK_END) != 0) {
+        return DJI_ERROR_SYSTEM_MODULE_CODE_SYSTEM_ERROR;
+    }
+    fileSize = ftello(m_file);
+
+    while (fseeko(m_file, offset, SEEK_SET) == 0 && fread(&chunkHeader, sizeof(chunkHeader), 1, m_file) == 1 &&
+           chunkHeader.magic == PERCEPTION_RECORD_CHUNK_MAGIC) {
+        offset += sizeof(chunkHeader);
+
+        /* A zero count marks the chunk that was open when the recording stopped, read it up to the end of file. */
+        for (i = 0; chunkHeader.frameCount == 0 || i < chunkHeader.frameCount; i++) {
+            if (fseeko(m_file, offset, SEEK_SET) != 0 || fread(&frameHeader, sizeof(frameHeader), 1, m_file) != 1 ||
+                offset + (off_t) (sizeof(frameHeader) + frameHeader.bufferLen) > fileSize) {
+                return DJI_ERROR_SYSTEM_MODULE_CODE_SUCCESS;
+            }
+
+            entry.offset = (uint64_t) offset;
+            entry.recvTimeUs = frameHeader.recvTimeUs;
+            entry.dataType = frameHeader.info.dataType;
+            entry.sequence = frameHeader.info.sequence;
+            m_index.push_back(entry);
+            offset += sizeof(frameHeader) + frameHeader.bufferLen;
+        }
+    }
+
+    return DJI_ERROR_SYSTEM_MODULE_CODE_SUCCESS;
+}
+
+T_DjiReturnCode PerceptionReplay::ReadFrame(const T_PerceptionRecordIndexEntry &entry,
+                                            T_PerceptionRecordFrameHeader &header)
+{
+    if (fseeko(m_file, (off_t) entry.offset, SEEK_SET) != 0 || fread(&header, sizeof(header), 1, m_file) != 1) {
+        return DJI_ERROR_SYSTEM_MODULE_CODE_SYSTEM_ERROR;
+    }
+
+    if (m_frameBuffer.size() < header.bufferLen) {
+        m_frameBuffer.resize(header.bufferLen);
+    }
+
+    if (header.bufferLen > 0 && fread(m_frameBuffer.data(), 1, header.bufferLen, m_file) != header.bufferLen) {
+        return DJI_ERROR_SYSTEM_MODULE_CODE_SYSTEM_ERROR;
+    }
+
+    return DJI_ERROR_SYSTEM_MODULE_CODE_SUCCESS;
+}
+
+/****************** (C) COPYRIGHT DJI Innovations *****END OF FILE****/
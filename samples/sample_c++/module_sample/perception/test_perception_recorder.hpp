@@ -0,0 +1,199 @@
+/**
+ ********************************************************************
+ * @file    test_perception_recorder.hpp
+ * @brief   This is the header file for "test_perception_recorder.cpp", defining the structure and
+ * (exported) function prototypes.
+ *
+ * @copyright (c) 2021 DJI. All rights reserved.
+ *
+ * All information contained herein is, and remains, the property of DJI.
+ * The intellectual and technical concepts contained herein are proprietary
+ * to DJI and may be covered by U.S. and foreign patents, patents in process,
+ * and protected by trade secret or copyright law.  Dissemination of this
+ * information, including but not limited to data and other proprietary
+ * material(s) incorporated within the information, in any form, is strictly
+ * prohibited without the express written consent of DJI.
+ *
+ * If you receive this source code without DJI’s authorization, you may not
+ * further disseminate the information, and you must immediately remove the
+ * source code and notify DJI of its removal. DJI reserves the right to pursue
+ * legal actions against you for any loss(es) or damage(s) caused by your
+ * failure to do so.
+ *
+ *********************************************************************
+ */
+
+/* Define to prevent recursive inclusion -------------------------------------*/
+#ifndef TEST_PERCEPTION_RECORDER_H
+#define TEST_PERCEPTION_RECORDER_H
+
+/* Includes ------------------------------------------------------------------*/
+#include <cstdio>
+#include <sys/types.h>
+#include <vector>
+#include "dji_perception.h"
+#include "dji_platform.h"
+#include "utils/util_pool.h"
+#include "utils/util_dlist.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Exported constants --------------------------------------------------------*/
+#define PERCEPTION_RECORD_DEFAULT_SLOT_NUM          (32)
+#define PERCEPTION_RECORD_DEFAULT_MAX_FRAME_SIZE    (640 * 480)
+#define PERCEPTION_RECORD_DEFAULT_CHUNK_FRAME_NUM   (64)
+
+/* Exported types ------------------------------------------------------------*/
+#pragma pack(1)
+/**
+ * @brief Layout of a stereo record file: file header, chunks of frames, frame index, footer.
+ * @note Each chunk is a chunk header followed by "frameCount" frame records (frame header plus raw image). The index
+ * at the end lists every frame record, the footer points at it. A file without footer, e.g. after a power cut, is
+ * still replayable, the replay rebuilds the index by walking the chunks.
+ */
+typedef struct {
+    char magic[8];
+    uint32_t version;
+    uint32_t headerSize;
+    uint32_t imageInfoSize;
+    uint32_t chunkFrameNum;
+    uint64_t startTimeUs;
+    T_DjiPerceptionCameraParametersPacket cameraParameters;
+} T_PerceptionRecordFileHeader;
+
+typedef struct {
+    uint32_t magic;
+    uint32_t frameCount;
+    uint64_t payloadSize;
+} T_PerceptionRecordChunkHeader;
+
+typedef struct {
+    T_DjiPerceptionImageInfo info;
+    uint64_t recvTimeUs;
+    uint32_t bufferLen;
+} T_PerceptionRecordFrameHeader;
+
+typedef struct {
+    uint64_t offset;
+    uint64_t recvTimeUs;
+    uint32_t dataType;
+    uint16_t sequence;
+    uint16_t reserved;
+} T_PerceptionRecordIndexEntry;
+
+typedef struct {
+    uint32_t magic;
+    uint32_t frameCount;
+    uint64_t indexOffset;
+    uint32_t chunkCount;
+    uint32_t droppedCount;
+} T_PerceptionRecordFooter;
+#pragma pack()
+
+typedef struct {
+    T_UtilDlistNode node;
+    T_PerceptionRecordFrameHeader header;
+    uint8_t *data;
+} T_PerceptionRecordSlot;
+
+/**
+ * @brief Records stereo images from the perception image callback without blocking it.
+ * @note PushFrame copies the image into a preallocated slot and queues it, a writer task appends the queued slots to
+ * the file. When all slots are in flight the frame is dropped and counted instead of stalling the callback.
+ */
+class PerceptionRecorder {
+public:
+    PerceptionRecorder();
+    ~PerceptionRecorder();
+
+    T_DjiReturnCode Start(const char *path, const T_DjiPerceptionCameraParametersPacket &cameraParameters,
+                          uint32_t slotNum = PERCEPTION_RECORD_DEFAULT_SLOT_NUM,
+                          uint32_t maxFrameSize = PERCEPTION_RECORD_DEFAULT_MAX_FRAME_SIZE);
+    T_DjiReturnCode Stop();
+    bool IsRecording();
+    void PushFrame(const T_DjiPerceptionImageInfo &imageInfo, const uint8_t *imageRawBuffer, uint32_t bufferLen);
+    uint32_t GetRecordedCount();
+    uint32_t GetDroppedCount();
+
+private:
+    static void *WriterTask(void *arg);
+    T_DjiReturnCode WriteSlot(T_PerceptionRecordSlot *slot);
+    T_DjiReturnCode CloseChunk();
+    T_DjiReturnCode WriteIndex();
+    void ReleaseResource();
+
+    T_DjiMutexHandle m_mutex;
+    T_DjiSemaHandle m_dataSema;
+    T_DjiSemaHandle m_exitSema;
+    T_DjiTaskHandle m_writerThread;
+    T_UtilPool m_slotPool;
+    T_UtilDlist m_pendingList;
+    uint8_t *m_slotMemory;
+    uint8_t *m_frameMemory;
+    uint32_t m_maxFrameSize;
+    FILE *m_file;
+    bool m_isRecording;
+    bool m_stopWriter;
+    uint64_t m_startTimeUs;
+    uint32_t m_droppedCount;
+    uint32_t m_recordedCount;
+    uint32_t m_chunkCount;
+    off_t m_chunkOffset;
+    T_PerceptionRecordChunkHeader m_chunkHeader;
+    std::vector<T_PerceptionRecordIndexEntry> m_index;
+};
+
+/**
+ * @brief Feeds a stereo record file into a perception image callback at the recorded rate or faster.
+ */
+class PerceptionReplay {
+public:
+    PerceptionReplay();
+    ~PerceptionReplay();
+
+    T_DjiReturnCode Open(const char *path);
+    void Close();
+    const T_DjiPerceptionCameraParametersPacket &GetCameraParameters() const;
+    uint32_t GetFrameCount() const;
+
+    /**
+     * @brief Start feeding frames to the callback from a replay task.
+     * @param callback: callback that normally receives the live images.
+     * @param rate: speed factor against the recorded timing, 0 replays as fast as the callback returns.
+     * @param isLoop: restart from the first frame after the last one.
+     * @return an enum that represents a status of PSDK
+     */
+    T_DjiReturnCode Start(DjiPerceptionImageCallback callback, double rate, bool isLoop);
+    T_DjiReturnCode Stop();
+    bool IsFinished();
+
+private:
+    static void *ReplayTask(void *arg);
+    T_DjiReturnCode LoadIndex();
+    T_DjiReturnCode ScanChunks();
+    T_DjiReturnCode ReadFrame(const T_PerceptionRecordIndexEntry &entry, T_PerceptionRecordFrameHeader &header);
+
+    FILE *m_file;
+    T_PerceptionRecordFileHeader m_header;
+    std::vector<T_PerceptionRecordIndexEntry> m_index;
+    std::vector<uint8_t> m_frameBuffer;
+    DjiPerceptionImageCallback m_callback;
+    double m_rate;
+    bool m_isLoop;
+    bool m_stop;
+    bool m_isFinished;
+    bool m_isRunning;
+    T_DjiSemaHandle m_exitSema;
+    T_DjiTaskHandle m_replayThread;
+};
+
+/* Exported functions --------------------------------------------------------*/
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // TEST_PERCEPTION_RECORDER_H
+/************************ (C) COPYRIGHT DJI Innovations *******END OF FILE******/
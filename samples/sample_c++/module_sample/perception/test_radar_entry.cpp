@@ -24,7 +24,10 @@
 
 /* Includes ------------------------------------------------------------------*/
 #include "test_radar_entry.hpp"
+#include "test_radar_processor.hpp"
+#include "utils/util_misc.h"
 #include "dji_logger.h"
+#include "flight_recorder/test_flight_recorder.h"
 #include <iostream>
 #include <ctime>
 #include <chrono>
@@ -33,12 +36,15 @@
 /* Private types -------------------------------------------------------------*/
 
 /* Private values -------------------------------------------------------------*/
+static RadarProcessor s_radarProcessor;
+static uint16_t s_radarRecordChannelId;
+static bool s_isRadarRecordChannelAdded = false;
 
 /* Private functions declaration ---------------------------------------------*/
 static void DjiTest_PerceptionRadarCallback(E_DjiPerceptionRadarPosition radarPosition,
                                              uint8_t *radarDataBuffer, uint32_t bufferLen);
-static float parseVelocity(uint16_t velocity);
-static float parseBeamAngle(uint16_t beamAngle);
+static void DjiTest_RadarFrameResultCallback(const T_RadarFrameResult *result, void *userData);
+static void DjiTest_RadarReplayRecord(const T_DjiTestFlightRecordSample *sample, void *userData);
 /* Exported functions definition ---------------------------------------------*/
 void DjiUser_RunRadarDataSubscriptionSample(void) {
     int subscriptionDuration = 10;
@@ -46,12 +52,34 @@ void DjiUser_RunRadarDataSubscriptionSample(void) {
     char inputChar;
     T_DjiOsalHandler *osalHandler = DjiPlatform_GetOsalHandler();
     E_DjiPerceptionRadarPosition curPosition = MAX_RADAR_NUM;
+    T_RadarProcessorConfig radarProcessorConfig;
+    T_RadarProcessorStatistics radarProcessorStatistics;
     returnCode = DjiPerception_Init();
     if (returnCode != DJI_ERROR_SYSTEM_MODULE_CODE_SUCCESS) {
         USER_LOG_ERROR("DjiPerception Init failed");
         return;
     }
 
+    RadarProcessor::GetDefaultConfig(&radarProcessorConfig);
+    returnCode = s_radarProcessor.Init(radarProcessorConfig, DjiTest_RadarFrameResultCallback, nullptr);
+    if (returnCode != DJI_ERROR_SYSTEM_MODULE_CODE_SUCCESS) {
+        USER_LOG_ERROR("Radar processor init failed");
+        goto endOfSample;
+    }
+
+    {
+        T_DjiTestFlightRecorderChannelInfo channelInfo = {"perception/radar", "dji.perception.radar",
+                                                          "position:u8 packet:bytes"};
+
+        returnCode = DjiTest_FlightRecorderAddChannel(&channelInfo, DjiTest_RadarReplayRecord, nullptr,
+                                                      &s_radarRecordChannelId);
+        if (returnCode != DJI_ERROR_SYSTEM_MODULE_CODE_SUCCESS) {
+            USER_LOG_WARN("Add flight record channel error, return code:0x%08X", returnCode);
+        } else {
+            s_isRadarRecordChannelAdded = true;
+        }
+    }
+
 inputAgain:
     std::cout
         << "| Available commands:                                          |"
@@ -132,9 +160,21 @@ subscribeFailed:
     if (returnCode != DJI_ERROR_SYSTEM_MODULE_CODE_SUCCESS) {
         USER_LOG_ERROR("Request to unsubscribe Radar data failed");
     }
+
+    s_radarProcessor.GetStatistics(&radarProcessorStatistics);
+    if (radarProcessorStatistics.frameCount > 0) {
+        USER_LOG_INFO("Radar processing: %u frames, %u packets dropped, latency mean %llu us, max %u us",
+                      radarProcessorStatistics.frameCount, radarProcessorStatistics.droppedPacketCount,
+                      radarProcessorStatistics.sumTotalUs / radarProcessorStatistics.frameCount,
+                      radarProcessorStatistics.maxTotalUs);
+    }
     goto inputAgain;
 
 endOfSample:
+    if (s_isRadarRecordChannelAdded) {
+        DjiTest_FlightRecorderSetReplayHandler(s_radarRecordChannelId, nullptr, nullptr);
+    }
+    s_radarProcessor.Deinit();
     returnCode = DjiPerception_Deinit();
     if (returnCode != DJI_ERROR_SYSTEM_MODULE_CODE_SUCCESS) {
         USER_LOG_ERROR("DjiPerception DeInit failed");
@@ -145,46 +185,54 @@ endOfSample:
 /* Private functions definition-----------------------------------------------*/
 static void DjiTest_PerceptionRadarCallback(E_DjiPerceptionRadarPosition radarPosition,
                                              uint8_t *radarDataBuffer, uint32_t bufferLen) {
-    T_DjiRadarDataFrame* radarData;
-    radarData = (T_DjiRadarDataFrame*)radarDataBuffer;
+    T_DjiReturnCode returnCode;
 
     if (radarDataBuffer == nullptr || bufferLen == 0) {
         USER_LOG_ERROR("Invalid radar data: buffer=%p len=%u", radarDataBuffer, bufferLen);
         return;
     }
 
-    USER_LOG_INFO("RadarData[pos:%d][len:%u][units:%u][pack:%u/%u]",
-                  radarPosition,
-                  bufferLen,
-                  static_cast<unsigned>(radarData->headInfo.dataLen),
-                  static_cast<unsigned>(radarData->headInfo.curPack),
-                  static_cast<unsigned>(radarData->headInfo.packNum));
-
-    for (uint32_t i = 0; i < radarData->headInfo.dataLen; ++i) {
-        const T_DjiRadarCloudUnit* unit = &radarData->data[i];
-        float azimuth = unit->azimuth / 1000.0f - 2*3.14;
-        float elevation = unit->elevation / 1000.0f - 2*3.14;
-        float radius = unit->radius / 100.0f;
-        float energy = unit->ene / 100.0f;
-        float velocity = parseVelocity(unit->base_info.velocity);
-        uint8_t snr = unit->base_info.snr;
-        float beamAngle = parseBeamAngle(unit->base_info.beamAngle);
-
-        USER_LOG_INFO(
-            "[Unit%d] Azimuth=%.3f(rad), Elevation=%.3f(rad), Radius=%.2f(m), Energy=%.2f, "
-            "Velocity=%.2f(m/s), SNR=%u(dB), BeamAngle=%.2f(deg)",
-            i, azimuth, elevation, radius, energy, velocity, snr, beamAngle);
+    if (s_isRadarRecordChannelAdded && DjiTest_FlightRecorderIsRecording()) {
+        uint8_t position = (uint8_t) radarPosition;
+
+        DjiTest_FlightRecorderWrite(s_radarRecordChannelId, 0, &position, sizeof(position), radarDataBuffer,
+                                    bufferLen);
+    }
+
+    returnCode = s_radarProcessor.PushPacket(radarPosition, radarDataBuffer, bufferLen);
+    if (returnCode != DJI_ERROR_SYSTEM_MODULE_CODE_SUCCESS) {
+        USER_LOG_WARN("Drop radar packet, return code:0x%08X", returnCode);
     }
 }
 
-static float parseVelocity(uint16_t velocity) {
-    return (velocity - 32767) / 100.0f;
+static void DjiTest_RadarFrameResultCallback(const T_RadarFrameResult *result, void *userData) {
+    USER_UTIL_UNUSED(userData);
+
+    USER_LOG_INFO("RadarFrame[pos:%d][points:%u/%u][clusters:%u][tracks:%u][latency:%u us]",
+                  result->position, result->frame->count, result->rawPointCount, result->clusterNum,
+                  result->trackNum, result->latency.totalUs);
+
+    for (uint32_t i = 0; i < result->trackNum; ++i) {
+        const T_RadarTrack *track = &result->tracks[i];
+
+        if (!track->isConfirmed || track->misses > 0) {
+            continue;
+        }
+
+        USER_LOG_INFO("[Track%u] x=%.2f(m) y=%.2f(m) z=%.2f(m) vx=%.2f(m/s) vy=%.2f(m/s) radialVelocity=%.2f(m/s) "
+                      "points=%u age=%u", track->id, track->x, track->y, track->z, track->vx, track->vy,
+                      track->radialVelocity, track->pointCount, track->age);
+    }
 }
-static float parseBeamAngle(uint16_t beamAngle) {
-    if (beamAngle <= 450) {
-        return beamAngle / 10.0f;
-    } else {
-        return (beamAngle / 10.0f) - 90.0f;
+
+static void DjiTest_RadarReplayRecord(const T_DjiTestFlightRecordSample *sample, void *userData) {
+    USER_UTIL_UNUSED(userData);
+
+    if (sample->headerLen != sizeof(uint8_t)) {
+        return;
     }
+
+    DjiTest_PerceptionRadarCallback((E_DjiPerceptionRadarPosition) sample->header[0],
+                                    const_cast<uint8_t *>(sample->data), sample->dataLen);
 }
 /****************** (C) COPYRIGHT DJI Innovations *****END OF FILE****/
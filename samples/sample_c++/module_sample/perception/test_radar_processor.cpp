@@ -0,0 +1,722 @@
+ /**
+ ********************************************************************
+ * @file    test_radar_processor.cpp
+ * @brief   Radar point decoding, clustering and target tracking.
+ *
+ * @copyright (c) 2021 DJI. All rights reserved.
+ *
+ * All information contained herein is, and remains, the property of DJI.
+ * The intellectual and technical concepts contained herein are proprietary
+ * to DJI and may be covered by U.S. and foreign patents, patents in process,
+ * and protected by trade secret or copyright law.  Dissemination of this
+ * information, including but not limited to data and other proprietary
+ * material(s) incorporated within the information, in any form, is strictly
+ * prohibited without the express written consent of DJI.
+ *
+ * If you receive this source code without DJI’s authorization, you may not
+ * further disseminate the information, and you must immediately remove the
+ * source code and notify DJI of its removal. DJI reserves the right to pursue
+ * legal actions against you for any loss(es) or damage(s) caused by your
+ * failure to do so.
+ *
+ *********************************************************************
+ */
+
+
+/* Includes ------------------------------------------------------------------*/
+#include <cmath>
+#include <cstring>
+#include <algorithm>
+#include "test_radar_processor.hpp"
+#include "dji_logger.h"
+
+/* Private constants ---------------------------------------------------------*/
+#define RADAR_PROCESSOR_VECTOR_LANES            (4)
+#define RADAR_PROCESSOR_UNVISITED_LABEL         (-2)
+#define RADAR_PROCESSOR_GRID_OFFSET             (1 << 20)
+#define RADAR_PROCESSOR_GRID_MASK               ((1 << 21) - 1)
+#define RADAR_PROCESSOR_MAX_TRACK_DT            (1.0f)
+#define RADAR_PROCESSOR_PI                      (3.14159265358979f)
+
+/* Private types -------------------------------------------------------------*/
+typedef float T_RadarFloatVector __attribute__((vector_size(16)));
+typedef int32_t T_RadarIntVector __attribute__((vector_size(16)));
+
+/* Private values -------------------------------------------------------------*/
+
+/* Private functions declaration ---------------------------------------------*/
+static uint32_t RadarProcessor_Decode(const T_DjiRadarCloudUnit *units, uint32_t unitNum,
+                                      const T_RadarProcessorConfig *config, T_RadarPointFrame *frame);
+static void RadarProcessor_SinCos(T_RadarFloatVector angle, T_RadarFloatVector *sinValue,
+                                  T_RadarFloatVector *cosValue);
+static T_RadarFloatVector RadarProcessor_Splat(float value);
+static uint64_t RadarProcessor_GetCellKey(int32_t x, int32_t y, int32_t z);
+static void RadarProcessor_GetCell(const T_RadarPointFrame *frame, uint32_t index, float cellSize, int32_t *x,
+                                   int32_t *y, int32_t *z);
+
+/* Exported functions definition ---------------------------------------------*/
+RadarProcessor::RadarProcessor() : m_config(), m_callback(nullptr), m_userData(nullptr), m_mutex(nullptr),
+                                   m_isInit(false), m_poolMemory(nullptr), m_framePool(), m_pending(),
+                                   m_rawPointCount(), m_decodeUs(), m_gridMemory(nullptr), m_grid(), m_clusters(),
+                                   m_trackers(), m_nextTrackId(0), m_statistics()
+{
+}
+
+RadarProcessor::~RadarProcessor()
+{
+    Deinit();
+}
+
+void RadarProcessor::GetDefaultConfig(T_RadarProcessorConfig *config)
+{
+    config->isClutterDropped = true;
+    config->minSnr = 6;
+    config->minRange = 0.5f;
+    config->maxRange = 60.0f;
+    config->clusterDistance = 1.0f;
+    config->clusterVelocity = 1.0f;
+    config->clusterMinPoints = 3;
+    config->trackGateDistance = 2.0f;
+    config->trackAlpha = 0.6f;
+    config->trackBeta = 0.2f;
+    config->trackConfirmHits = 3;
+    config->trackMaxMisses = 5;
+}
+
+T_DjiReturnCode RadarProcessor::Init(const T_RadarProcessorConfig &config, RadarProcessorCallback callback,
+                                     void *userData)
+{
+    T_DjiOsalHandler *osalHandler = DjiPlatform_GetOsalHandler();
+    size_t poolSize = UtilPool_GetMemorySize(MAX_RADAR_NUM, sizeof(T_RadarPointFrame));
+    size_t gridSize = UtilHashMap_GetMemorySize(RADAR_PROCESSOR_MAX_POINT_NUM);
+    T_DjiReturnCode returnCode;
+
+    if (m_isInit) {
+        return DJI_ERROR_SYSTEM_MODULE_CODE_NONSUPPORT_IN_CURRENT_STATE;
+    }
+
+    if (callback == nullptr || config.clusterDistance <= 0 || config.clusterMinPoints == 0 ||
+        config.trackGateDistance <= 0 || config.minRange >= config.maxRange) {
+        return DJI_ERROR_SYSTEM_MODULE_CODE_INVALID_PARAMETER;
+    }
+
+    /* One pending frame per radar position, all memory is taken here and reused for every frame. */
+    m_poolMemory = osalHandler->Malloc(poolSize);
+    m_gridMemory = osalHandler->Malloc(gridSize);
+    if (m_poolMemory == nullptr || m_gridMemory == nullptr) {
+        USER_LOG_ERROR("Malloc radar processor memory failed.");
+        returnCode = DJI_ERROR_SYSTEM_MODULE_CODE_MEMORY_ALLOC_FAILED;
+        goto FreeMemory;
+    }
+
+    UtilPool_Init(&m_framePool, m_poolMemory, poolSize, sizeof(T_RadarPointFrame));
+    UtilHashMap_Init(&m_grid, m_gridMemory, gridSize);
+
+    returnCode = osalHandler->MutexCreate(&m_mutex);
+    if (returnCode != DJI_ERROR_SYSTEM_MODULE_CODE_SUCCESS) {
+        USER_LOG_ERROR("Create radar processor mutex failed, return code:0x%08X", returnCode);
+        goto FreeMemory;
+    }
+
+    m_cells.resize(RADAR_PROCESSOR_MAX_POINT_NUM);
+    m_cellKeys.resize(RADAR_PROCESSOR_MAX_POINT_NUM);
+    m_cellOrder.resize(RADAR_PROCESSOR_MAX_POINT_NUM);
+    m_neighbours.resize(RADAR_PROCESSOR_MAX_POINT_NUM);
+    m_queue.resize(RADAR_PROCESSOR_MAX_POINT_NUM);
+
+    memset(m_pending, 0, sizeof(m_pending));
+    memset(m_trackers, 0, sizeof(m_trackers));
+    memset(&m_statistics, 0, sizeof(m_statistics));
+    m_config = config;
+    m_callback = callback;
+    m_userData = userData;
+    m_nextTrackId = 1;
+    m_isInit = true;
+
+    return DJI_ERROR_SYSTEM_MODULE_CODE_SUCCESS;
+
+FreeMemory:
+    osalHandler->Free(m_poolMemory);
+    osalHandler->Free(m_gridMemory);
+    m_poolMemory = nullptr;
+    m_gridMemory = nullptr;
+
+    return returnCode;
+}
+
+T_DjiReturnCode RadarProcessor::Deinit()
+{
+    T_DjiOsalHandler *osalHandler = DjiPlatform_GetOsalHandler();
+
+    if (!m_isInit) {
+        return DJI_ERROR_SYSTEM_MODULE_CODE_SUCCESS;
+    }
+
+    osalHandler->MutexLock(m_mutex);
+    m_isInit = false;
+    osalHandler->MutexUnlock(m_mutex);
+
+    osalHandler->MutexDestroy(m_mutex);
+    m_mutex = nullptr;
+    osalHandler->Free(m_poolMemory);
+    osalHandler->Free(m_gridMemory);
+    m_poolMemory = nullptr;
+    m_gridMemory = nullptr;
+
+    return DJI_ERROR_SYSTEM_MODULE_CODE_SUCCESS;
+}
+
+T_DjiReturnCode RadarProcessor::PushPacket(E_DjiPerceptionRadarPosition position, const uint8_t *buffer,
+                                           uint32_t bufferLen)
+{
+    T_DjiOsalHandler *osalHandler = DjiPlatform_GetOsalHandler();
+    const T_DjiRadarDataFrame *packet = (const T_DjiRadarDataFrame *) buffer;
+    T_RadarPointFrame *frame;
+    uint64_t beginUs = 0;
+    uint64_t endUs = 0;
+    uint32_t unitNum;
+
+    if (buffer == nullptr || bufferLen < sizeof(T_DjiRadarDataHeader) || (uint32_t) position >= MAX_RADAR_NUM) {
+        return DJI_ERROR_SYSTEM_MODULE_CODE_INVALID_PARAMETER;
+    }
+
+    /* dataLen counts the point units of the packet, never trust it beyond the received buffer. */
+    unitNum = std::min<uint32_t>(packet->headInfo.dataLen,
+                                 (bufferLen - sizeof(T_DjiRadarDataHeader)) / sizeof(T_DjiRadarCloudUnit));
+
+    osalHandler->GetTimeUs(&beginUs);
+    osalHandler->MutexLock(m_mutex);
+    if (!m_isInit) {
+        osalHandler->MutexUnlock(m_mutex);
+        return DJI_ERROR_SYSTEM_MODULE_CODE_NONSUPPORT_IN_CURRENT_STATE;
+    }
+
+    frame = m_pending[position];
+    if (packet->headInfo.curPack <= 1 || frame == nullptr || packet->headInfo.curPack != frame->nextPack ||
+        packet->headInfo.packNum != frame->packNum) {
+        /* A new circle starts, an unfinished one before it has lost packets and is dropped as a whole. */
+        if (frame != nullptr) {
+            m_statistics.droppedPacketCount += frame->nextPack - 1;
+            UtilPool_Free(&m_framePool, frame);
+            m_pending[position] = nullptr;
+        }
+
+        if (packet->headInfo.curPack > 1) {
+            m_statistics.droppedPacketCount++;
+            osalHandler->MutexUnlock(m_mutex);
+            return DJI_ERROR_SYSTEM_MODULE_CODE_INVALID_PARAMETER;
+        }
+
+        frame = (T_RadarPointFrame *) UtilPool_Alloc(&m_framePool);
+        if (frame == nullptr) {
+            m_statistics.droppedPacketCount++;
+            osalHandler->MutexUnlock(m_mutex);
+            return DJI_ERROR_SYSTEM_MODULE_CODE_BUSY;
+        }
+        frame->timestampUs = beginUs;
+        frame->packNum = packet->headInfo.packNum > 0 ? packet->headInfo.packNum : 1;
+        frame->nextPack = 1;
+        m_pending[position] = frame;
+        m_rawPointCount[position] = 0;
+        m_decodeUs[position] = 0;
+    }
+
+    m_rawPointCount[position] += unitNum;
+    RadarProcessor_Decode(packet->data, unitNum, &m_config, frame);
+    osalHandler->GetTimeUs(&endUs);
+    m_decodeUs[position] += (uint32_t) (endUs - beginUs);
+
+    if (frame->nextPack++ >= frame->packNum) {
+        m_pending[position] = nullptr;
+        ProcessFrame(position, frame, beginUs);
+        UtilPool_Free(&m_framePool, frame);
+    }
+    osalHandler->MutexUnlock(m_mutex);
+
+    return DJI_ERROR_SYSTEM_MODULE_CODE_SUCCESS;
+}
+
+void RadarProcessor::GetStatistics(T_RadarProcessorStatistics *statistics)
+{
+    T_DjiOsalHandler *osalHandler = DjiPlatform_GetOsalHandler();
+
+    if (!m_isInit) {
+        memset(statistics, 0, sizeof(T_RadarProcessorStatistics));
+        return;
+    }
+
+    osalHandler->MutexLock(m_mutex);
+    *statistics = m_statistics;
+    osalHandler->MutexUnlock(m_mutex);
+}
+
+/* Private functions definition-----------------------------------------------*/
+void RadarProcessor::ProcessFrame(E_DjiPerceptionRadarPosition position, T_RadarPointFrame *frame,
+                                  uint64_t lastPacketUs)
+{
+    T_DjiOsalHandler *osalHandler = DjiPlatform_GetOsalHandler();
+    T_RadarFrameResult result;
+    uint64_t clusterBeginUs = 0;
+    uint64_t trackBeginUs = 0;
+    uint64_t endUs = 0;
+
+    osalHandler->GetTimeUs(&clusterBeginUs);
+    result.clusterNum = Cluster(frame);
+    osalHandler->GetTimeUs(&trackBeginUs);
+    result.trackNum = Track(&m_trackers[position], result.clusterNum, frame->timestampUs);
+    osalHandler->GetTimeUs(&endUs);
+
+    result.position = position;
+    result.timestampUs = frame->timestampUs;
+    result.rawPointCount = m_rawPointCount[position];
+    result.frame = frame;
+    result.clusters = m_clusters;
+    result.tracks = m_trackers[position].tracks;
+    result.latency.decodeUs = m_decodeUs[position];
+    result.latency.clusterUs = (uint32_t) (trackBeginUs - clusterBeginUs);
+    result.latency.trackUs = (uint32_t) (endUs - trackBeginUs);
+    result.latency.totalUs = (uint32_t) (endUs - lastPacketUs);
+
+    m_statistics.frameCount++;
+    m_statistics.sumTotalUs += result.latency.totalUs;
+    m_statistics.maxTotalUs = std::max(m_statistics.maxTotalUs, result.latency.totalUs);
+
+    m_callback(&result, m_userData);
+}
+
+void RadarProcessor::BuildGrid(const T_RadarPointFrame *frame)
+{
+    uint32_t cellNum = 0;
+    uint32_t i;
+    int32_t x;
+    int32_t y;
+    int32_t z;
+
+    UtilHashMap_Clear(&m_grid);
+    for (i = 0; i < frame->count; i++) {
+        RadarProcessor_GetCell(frame, i, m_config.clusterDistance, &x, &y, &z);
+        m_cellKeys[i] = RadarProcessor_GetCellKey(x, y, z);
+        m_cellOrder[i] = i;
+    }
+
+    /* Points of one cell become a contiguous run of the order array, the map points at the run. */
+    std::sort(m_cellOrder.begin(), m_cellOrder.begin() + frame->count, [this](uint32_t a, uint32_t b) {
+        return m_cellKeys[a] < m_cellKeys[b];
+    });
+    for (i = 0; i < frame->count; i++) {
+        uint64_t key = m_cellKeys[m_cellOrder[i]];
+
+        if (i == 0 || key != m_cellKeys[m_cellOrder[i - 1]]) {
+            m_cells[cellNum].begin = i;
+            m_cells[cellNum].count = 0;
+            UtilHashMap_Put(&m_grid, key, &m_cells[cellNum]);
+            cellNum++;
+        }
+        m_cells[cellNum - 1].count++;
+    }
+}
+
+uint32_t RadarProcessor::QueryNeighbours(const T_RadarPointFrame *frame, uint32_t index)
+{
+    float distance = m_config.clusterDistance * m_config.clusterDistance;
+    float velocity = m_config.clusterVelocity;
+    uint32_t neighbourNum = 0;
+    int32_t cellX;
+    int32_t cellY;
+    int32_t cellZ;
+
+    RadarProcessor_GetCell(frame, index, m_config.clusterDistance, &cellX, &cellY, &cellZ);
+    for (int32_t dz = -1; dz <= 1; dz++) {
+        for (int32_t dy = -1; dy <= 1; dy++) {
+            for (int32_t dx = -1; dx <= 1; dx++) {
+                auto *cell = (const GridCell *) UtilHashMap_Get(&m_grid, RadarProcessor_GetCellKey(cellX + dx,
+                                                                                                  cellY + dy,
+                                                                                                  cellZ + dz));
+                if (cell == nullptr) {
+                    continue;
+                }
+
+                for (uint32_t i = cell->begin; i < cell->begin + cell->count; i++) {
+                    uint32_t other = m_cellOrder[i];
+                    float diffX = frame->x[other] - frame->x[index];
+                    float diffY = frame->y[other] - frame->y[index];
+                    float diffZ = frame->z[other] - frame->z[index];
+
+                    if (diffX * diffX + diffY * diffY + diffZ * diffZ > distance ||
+                        (velocity > 0 && fabsf(frame->velocity[other] - frame->velocity[index]) > velocity)) {
+                        continue;
+                    }
+                    m_neighbours[neighbourNum++] = other;
+                }
+            }
+        }
+    }
+
+    return neighbourNum;
+}
+
+uint32_t RadarProcessor::Cluster(T_RadarPointFrame *frame)
+{
+    uint32_t clusterNum = 0;
+    uint32_t i;
+    uint32_t j;
+
+    BuildGrid(frame);
+    for (i = 0; i < frame->count; i++) {
+        frame->label[i] = RADAR_PROCESSOR_UNVISITED_LABEL;
+    }
+
+    for (i = 0; i < frame->count; i++) {
+        uint32_t queueHead = 0;
+        uint32_t queueTail = 0;
+        uint32_t neighbourNum;
+
+        if (frame->label[i] != RADAR_PROCESSOR_UNVISITED_LABEL) {
+            continue;
+        }
+
+        neighbourNum = QueryNeighbours(frame, i);
+        if (neighbourNum < m_config.clusterMinPoints || clusterNum >= RADAR_PROCESSOR_MAX_CLUSTER_NUM) {
+            frame->label[i] = RADAR_PROCESSOR_NOISE_LABEL;
+            continue;
+        }
+
+        /* Points are labelled when queued, so every point enters the queue at most once. */
+        frame->label[i] = (int16_t) clusterNum;
+        m_queue[queueTail++] = i;
+        while (queueHead < queueTail) {
+            uint32_t point = m_queue[queueHead++];
+
+            neighbourNum = point == i ? neighbourNum : QueryNeighbours(frame, point);
+            if (neighbourNum < m_config.clusterMinPoints) {
+                continue;
+            }
+
+            for (j = 0; j < neighbourNum; j++) {
+                uint32_t neighbour = m_neighbours[j];
+
+                if (frame->label[neighbour] == RADAR_PROCESSOR_UNVISITED_LABEL) {
+                    m_queue[queueTail++] = neighbour;
+                    frame->label[neighbour] = (int16_t) clusterNum;
+                } else if (frame->label[neighbour] == RADAR_PROCESSOR_NOISE_LABEL) {
+                    frame->label[neighbour] = (int16_t) clusterNum;
+                }
+            }
+        }
+        clusterNum++;
+    }
+
+    for (i = 0; i < clusterNum; i++) {
+        T_RadarCluster *cluster = &m_clusters[i];
+
+        memset(cluster, 0, sizeof(T_RadarCluster));
+        cluster->minX = cluster->minY = cluster->minZ = INFINITY;
+        cluster->maxX = cluster->maxY = cluster->maxZ = -INFINITY;
+    }
+
+    for (i = 0; i < frame->count; i++) {
+        T_RadarCluster *cluster;
+
+        if (frame->label[i] < 0) {
+            continue;
+        }
+
+        cluster = &m_clusters[frame->label[i]];
+        cluster->x += frame->x[i];
+        cluster->y += frame->y[i];
+        cluster->z += frame->z[i];
+        cluster->velocity += frame->velocity[i];
+        cluster->minX = std::min(cluster->minX, frame->x[i]);
+        cluster->minY = std::min(cluster->minY, frame->y[i]);
+        cluster->minZ = std::min(cluster->minZ, frame->z[i]);
+        cluster->maxX = std::max(cluster->maxX, frame->x[i]);
+        cluster->maxY = std::max(cluster->maxY, frame->y[i]);
+        cluster->maxZ = std::max(cluster->maxZ, frame->z[i]);
+        cluster->pointCount++;
+    }
+
+    for (i = 0; i < clusterNum; i++) {
+        T_RadarCluster *cluster = &m_clusters[i];
+
+        cluster->x /= cluster->pointCount;
+        cluster->y /= cluster->pointCount;
+        cluster->z /= cluster->pointCount;
+        cluster->velocity /= cluster->pointCount;
+        cluster->range = sqrtf(cluster->x * cluster->x + cluster->y * cluster->y + cluster->z * cluster->z);
+    }
+
+    return clusterNum;
+}
+
+uint32_t RadarProcessor::Track(TrackerState *state, uint32_t clusterNum, uint64_t timestampUs)
+{
+    bool isClusterUsed[RADAR_PROCESSOR_MAX_CLUSTER_NUM] = {false};
+    bool isTrackUsed[RADAR_PROCESSOR_MAX_TRACK_NUM] = {false};
+    float gate = m_config.trackGateDistance * m_config.trackGateDistance;
+    float dt = 0;
+    uint32_t i;
+    uint32_t j;
+
+    if (state->lastTimestampUs != 0 && timestampUs > state->lastTimestampUs) {
+        dt = std::min((timestampUs - state->lastTimestampUs) / 1000000.0f, RADAR_PROCESSOR_MAX_TRACK_DT);
+    }
+    state->lastTimestampUs = timestampUs;
+
+    for (i = 0; i < state->trackNum; i++) {
+        T_RadarTrack *track = &state->tracks[i];
+
+        track->x += track->vx * dt;
+        track->y += track->vy * dt;
+        track->z += track->vz * dt;
+        track->age++;
+    }
+
+    /* Greedy global nearest neighbour, the closest remaining track and cluster pair inside the gate goes first. */
+    while (true) {
+        float bestDistance = gate;
+        int32_t bestTrack = -1;
+        int32_t bestCluster = -1;
+
+        for (i = 0; i < state->trackNum; i++) {
+            if (isTrackUsed[i]) {
+                continue;
+            }
+
+            for (j = 0; j < clusterNum; j++) {
+                float diffX = m_clusters[j].x - state->tracks[i].x;
+                float diffY = m_clusters[j].y - state->tracks[i].y;
+                float diffZ = m_clusters[j].z - state->tracks[i].z;
+                float distance = diffX * diffX + diffY * diffY + diffZ * diffZ;
+
+                if (!isClusterUsed[j] && distance <= bestDistance) {
+                    bestDistance = distance;
+                    bestTrack = (int32_t) i;
+                    bestCluster = (int32_t) j;
+                }
+            }
+        }
+
+        if (bestTrack < 0) {
+            break;
+        }
+
+        T_RadarTrack *track = &state->tracks[bestTrack];
+        const T_RadarCluster *cluster = &m_clusters[bestCluster];
+        float residualX = cluster->x - track->x;
+        float residualY = cluster->y - track->y;
+        float residualZ = cluster->z - track->z;
+
+        track->x += m_config.trackAlpha * residualX;
+        track->y += m_config.trackAlpha * residualY;
+        track->z += m_config.trackAlpha * residualZ;
+        if (dt > 0) {
+            track->vx += m_config.trackBeta * residualX / dt;
+            track->vy += m_config.trackBeta * residualY / dt;
+            track->vz += m_config.trackBeta * residualZ / dt;
+        }
+        track->radialVelocity = cluster->velocity;
+        track->pointCount = cluster->pointCount;
+        track->hits++;
+        track->misses = 0;
+        track->isConfirmed = track->isConfirmed || track->hits >= m_config.trackConfirmHits;
+        isTrackUsed[bestTrack] = true;
+        isClusterUsed[bestCluster] = true;
+    }
+
+    for (i = state->trackNum; i > 0; i--) {
+        T_RadarTrack *track = &state->tracks[i - 1];
+
+        if (isTrackUsed[i - 1]) {
+            continue;
+        }
+
+        track->misses++;
+        if (track->misses > m_config.trackMaxMisses) {
+            *track = state->tracks[--state->trackNum];
+        }
+    }
+
+    for (j = 0; j < clusterNum && state->trackNum < RADAR_PROCESSOR_MAX_TRACK_NUM; j++) {
+        T_RadarTrack *track;
+
+        if (isClusterUsed[j]) {
+            continue;
+        }
+
+        track = &state->tracks[state->trackNum++];
+        memset(track, 0, sizeof(T_RadarTrack));
+        track->id = m_nextTrackId++;
+        track->x = m_clusters[j].x;
+        track->y = m_clusters[j].y;
+        track->z = m_clusters[j].z;
+        track->radialVelocity = m_clusters[j].velocity;
+        track->pointCount = m_clusters[j].pointCount;
+        track->hits = 1;
+        track->isConfirmed = m_config.trackConfirmHits <= 1;
+    }
+
+    return state->trackNum;
+}
+
+static uint32_t RadarProcessor_Decode(const T_DjiRadarCloudUnit *units, uint32_t unitNum,
+                                      const T_RadarProcessorConfig *config, T_RadarPointFrame *frame)
+{
+    const T_RadarFloatVector angleOffset = RadarProcessor_Splat(2 * RADAR_PROCESSOR_PI);
+    const T_RadarFloatVector milli = RadarProcessor_Splat(0.001f);
+    const T_RadarFloatVector centi = RadarProcessor_Splat(0.01f);
+    const T_RadarFloatVector deci = RadarProcessor_Splat(0.1f);
+    const T_RadarFloatVector velocityOffset = RadarProcessor_Splat(32767.0f);
+    const T_RadarFloatVector beamLimit = RadarProcessor_Splat(450.0f);
+    const T_RadarFloatVector beamOffset = RadarProcessor_Splat(90.0f);
+    const T_RadarFloatVector minRange = RadarProcessor_Splat(config->minRange);
+    const T_RadarFloatVector maxRange = RadarProcessor_Splat(config->maxRange);
+    T_DjiRadarCloudUnit block[RADAR_PROCESSOR_VECTOR_LANES];
+    uint32_t begin = frame->count;
+    uint32_t i;
+
+    for (i = 0; i < unitNum; i += RADAR_PROCESSOR_VECTOR_LANES) {
+        uint32_t laneNum = std::min<uint32_t>(unitNum - i, RADAR_PROCESSOR_VECTOR_LANES);
+        T_RadarFloatVector azimuth;
+        T_RadarFloatVector elevation;
+        T_RadarFloatVector radius;
+        T_RadarFloatVector energy;
+        T_RadarFloatVector velocity;
+        T_RadarFloatVector beamAngle;
+        T_RadarFloatVector snr;
+        T_RadarIntVector isValid;
+        T_RadarFloatVector sinAzimuth;
+        T_RadarFloatVector cosAzimuth;
+        T_RadarFloatVector sinElevation;
+        T_RadarFloatVector cosElevation;
+        T_RadarFloatVector planar;
+        T_RadarFloatVector x;
+        T_RadarFloatVector y;
+        T_RadarFloatVector z;
+        uint32_t snrValue[RADAR_PROCESSOR_VECTOR_LANES];
+        uint32_t beamValue[RADAR_PROCESSOR_VECTOR_LANES];
+        uint32_t velocityValue[RADAR_PROCESSOR_VECTOR_LANES];
+        int32_t clutter[RADAR_PROCESSOR_VECTOR_LANES];
+
+        /* The tail is padded with zero units, an SNR of 0 marks them invalid below. */
+        memset(block, 0, sizeof(block));
+        memcpy(block, units + i, laneNum * sizeof(T_DjiRadarCloudUnit));
+        for (uint32_t lane = 0; lane < RADAR_PROCESSOR_VECTOR_LANES; lane++) {
+            snrValue[lane] = block[lane].base_info.snr;
+            beamValue[lane] = block[lane].base_info.beamAngle;
+            velocityValue[lane] = block[lane].base_info.velocity;
+            clutter[lane] = config->isClutterDropped && block[lane].base_info.clitterFlag ? -1 : 0;
+        }
+
+        azimuth = (T_RadarFloatVector) {(float) block[0].azimuth, (float) block[1].azimuth,
+                                        (float) block[2].azimuth, (float) block[3].azimuth};
+        elevation = (T_RadarFloatVector) {(float) block[0].elevation, (float) block[1].elevation,
+                                          (float) block[2].elevation, (float) block[3].elevation};
+        radius = (T_RadarFloatVector) {(float) block[0].radius, (float) block[1].radius,
+                                       (float) block[2].radius, (float) block[3].radius};
+        energy = (T_RadarFloatVector) {(float) block[0].ene, (float) block[1].ene,
+                                       (float) block[2].ene, (float) block[3].ene};
+        velocity = (T_RadarFloatVector) {(float) velocityValue[0], (float) velocityValue[1],
+                                         (float) velocityValue[2], (float) velocityValue[3]};
+        beamAngle = (T_RadarFloatVector) {(float) beamValue[0], (float) beamValue[1],
+                                          (float) beamValue[2], (float) beamValue[3]};
+        snr = (T_RadarFloatVector) {(float) snrValue[0], (float) snrValue[1],
+                                    (float) snrValue[2], (float) snrValue[3]};
+
+        azimuth = azimuth * milli - angleOffset;
+        elevation = elevation * milli - angleOffset;
+        radius = radius * centi;
+        energy = energy * centi;
+        velocity = (velocity - velocityOffset) * centi;
+        beamAngle = beamAngle > beamLimit ? beamAngle * deci - beamOffset : beamAngle * deci;
+
+        RadarProcessor_SinCos(azimuth, &sinAzimuth, &cosAzimuth);
+        RadarProcessor_SinCos(elevation, &sinElevation, &cosElevation);
+        planar = radius * cosElevation;
+        x = planar * cosAzimuth;
+        y = planar * sinAzimuth;
+        z = radius * sinElevation;
+
+        isValid = (snr >= RadarProcessor_Splat(config->minSnr > 0 ? config->minSnr : 1)) &
+                  (radius >= minRange) & (radius <= maxRange) &
+                  ~(T_RadarIntVector) {clutter[0], clutter[1], clutter[2], clutter[3]};
+
+        /* Compaction keeps the valid lanes only, this is the one scalar store per point. */
+        for (uint32_t lane = 0; lane < RADAR_PROCESSOR_VECTOR_LANES; lane++) {
+            uint32_t index = frame->count;
+
+            if (!isValid[lane] || index >= RADAR_PROCESSOR_MAX_POINT_NUM) {
+                continue;
+            }
+
+            frame->x[index] = x[lane];
+            frame->y[index] = y[lane];
+            frame->z[index] = z[lane];
+            frame->radius[index] = radius[lane];
+            frame->azimuth[index] = azimuth[lane];
+            frame->elevation[index] = elevation[lane];
+            frame->velocity[index] = velocity[lane];
+            frame->energy[index] = energy[lane];
+            frame->beamAngle[index] = beamAngle[lane];
+            frame->snr[index] = (uint8_t) snrValue[lane];
+            frame->count++;
+        }
+    }
+
+    return frame->count - begin;
+}
+
+static void RadarProcessor_SinCos(T_RadarFloatVector angle, T_RadarFloatVector *sinValue,
+                                  T_RadarFloatVector *cosValue)
+{
+    /* Adding 1.5 * 2^23 rounds to the nearest integer, whose low mantissa bits then hold the quadrant. */
+    const T_RadarFloatVector roundMagic = RadarProcessor_Splat(12582912.0f);
+    const T_RadarIntVector one = {1, 1, 1, 1};
+    const T_RadarIntVector two = {2, 2, 2, 2};
+    T_RadarFloatVector quadrant = angle * RadarProcessor_Splat(0.636619772f) + roundMagic;
+    T_RadarIntVector quadrantBits = (T_RadarIntVector) quadrant;
+    T_RadarFloatVector reduced;
+    T_RadarFloatVector square;
+    T_RadarFloatVector sinPoly;
+    T_RadarFloatVector cosPoly;
+    T_RadarIntVector isSwapped;
+
+    quadrant -= roundMagic;
+    reduced = angle - quadrant * RadarProcessor_Splat(1.57079637f) - quadrant * RadarProcessor_Splat(-4.37113883e-8f);
+    square = reduced * reduced;
+
+    /* Minimax polynomials on [-pi/4, pi/4], accurate to about one float ulp. */
+    sinPoly = RadarProcessor_Splat(-1.9515295891e-4f) * square + RadarProcessor_Splat(8.3321608736e-3f);
+    sinPoly = sinPoly * square + RadarProcessor_Splat(-1.6666654611e-1f);
+    sinPoly = sinPoly * square * reduced + reduced;
+    cosPoly = RadarProcessor_Splat(2.443315711809948e-5f) * square + RadarProcessor_Splat(-1.388731625493765e-3f);
+    cosPoly = cosPoly * square + RadarProcessor_Splat(4.166664568298827e-2f);
+    cosPoly = cosPoly * square * square - RadarProcessor_Splat(0.5f) * square + RadarProcessor_Splat(1.0f);
+
+    isSwapped = (quadrantBits & one) != 0;
+    *sinValue = isSwapped ? cosPoly : sinPoly;
+    *cosValue = isSwapped ? sinPoly : cosPoly;
+    *sinValue = (quadrantBits & two) != 0 ? -*sinValue : *sinValue;
+    *cosValue = ((quadrantBits + one) & two) != 0 ? -*cosValue : *cosValue;
+}
+
+static T_RadarFloatVector RadarProcessor_Splat(float value)
+{
+    return (T_RadarFloatVector) {value, value, value, value};
+}
+
+static uint64_t RadarProcessor_GetCellKey(int32_t x, int32_t y, int32_t z)
+{
+    return ((uint64_t) ((x + RADAR_PROCESSOR_GRID_OFFSET) & RADAR_PROCESSOR_GRID_MASK)) |
+           ((uint64_t) ((y + RADAR_PROCESSOR_GRID_OFFSET) & RADAR_PROCESSOR_GRID_MASK) << 21) |
+           ((uint64_t) ((z + RADAR_PROCESSOR_GRID_OFFSET) & RADAR_PROCESSOR_GRID_MASK) << 42);
+}
+
+static void RadarProcessor_GetCell(const T_RadarPointFrame *frame, uint32_t index, float cellSize, int32_t *x,
+                                   int32_t *y, int32_t *z)
+{
+    *x = (int32_t) floorf(frame->x[index] / cellSize);
+    *y = (int32_t) floorf(frame->y[index] / cellSize);
+    *z = (int32_t) floorf(frame->z[index] / cellSize);
+}
+
+/****************** (C) COPYRIGHT DJI Innovations *****END OF FILE****/
@@ -0,0 +1,212 @@
+/**
+ ********************************************************************
+ * @file    test_radar_processor.hpp
+ * @brief   This is the header file for "test_radar_processor.cpp", defining the structure and
+ * (exported) function prototypes.
+ *
+ * @copyright (c) 2021 DJI. All rights reserved.
+ *
+ * All information contained herein is, and remains, the property of DJI.
+ * The intellectual and technical concepts contained herein are proprietary
+ * to DJI and may be covered by U.S. and foreign patents, patents in process,
+ * and protected by trade secret or copyright law.  Dissemination of this
+ * information, including but not limited to data and other proprietary
+ * material(s) incorporated within the information, in any form, is strictly
+ * prohibited without the express written consent of DJI.
+ *
+ * If you receive this source code without DJI’s authorization, you may not
+ * further disseminate the information, and you must immediately remove the
+ * source code and notify DJI of its removal. DJI reserves the right to pursue
+ * legal actions against you for any loss(es) or damage(s) caused by your
+ * failure to do so.
+ *
+ *********************************************************************
+ */
+
+/* Define to prevent recursive inclusion -------------------------------------*/
+#ifndef TEST_RADAR_PROCESSOR_H
+#define TEST_RADAR_PROCESSOR_H
+
+/* Includes ------------------------------------------------------------------*/
+#include <vector>
+#include "dji_perception.h"
+#include "dji_platform.h"
+#include "utils/util_pool.h"
+#include "utils/util_hash_map.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Exported constants --------------------------------------------------------*/
+#define RADAR_PROCESSOR_MAX_POINT_NUM           (1024)
+#define RADAR_PROCESSOR_MAX_CLUSTER_NUM         (64)
+#define RADAR_PROCESSOR_MAX_TRACK_NUM           (32)
+#define RADAR_PROCESSOR_NOISE_LABEL             (-1)
+
+/* Exported types ------------------------------------------------------------*/
+typedef struct {
+    bool isClutterDropped;          /*!< Drop points carrying the clutter flag of the planar radar. */
+    uint8_t minSnr;                 /*!< Points below this SNR are dropped, 0 echo points are always dropped. */
+    float minRange;
+    float maxRange;
+    float clusterDistance;          /*!< DBSCAN neighbourhood radius in meters, also the grid cell size. */
+    float clusterVelocity;          /*!< Neighbours must differ less than this in radial velocity, 0 ignores it. */
+    uint32_t clusterMinPoints;      /*!< Neighbours including the point itself needed to make a core point. */
+    float trackGateDistance;        /*!< Clusters farther than this from a predicted track are never associated. */
+    float trackAlpha;               /*!< Position gain of the alpha-beta filter. */
+    float trackBeta;                /*!< Velocity gain of the alpha-beta filter. */
+    uint32_t trackConfirmHits;      /*!< Associated frames before a track is reported as confirmed. */
+    uint32_t trackMaxMisses;        /*!< Frames without association before a track is deleted. */
+} T_RadarProcessorConfig;
+
+/**
+ * @brief Decoded points of one radar frame as structure of arrays, in meters, m/s and degrees.
+ * @note x points along the radar boresight, y towards positive azimuth and z towards positive elevation. Frames come
+ * from the pool of the processor and are only valid during the result callback.
+ */
+typedef struct {
+    uint32_t count;
+    uint8_t packNum;
+    uint8_t nextPack;
+    uint64_t timestampUs;
+    float x[RADAR_PROCESSOR_MAX_POINT_NUM];
+    float y[RADAR_PROCESSOR_MAX_POINT_NUM];
+    float z[RADAR_PROCESSOR_MAX_POINT_NUM];
+    float radius[RADAR_PROCESSOR_MAX_POINT_NUM];
+    float azimuth[RADAR_PROCESSOR_MAX_POINT_NUM];
+    float elevation[RADAR_PROCESSOR_MAX_POINT_NUM];
+    float velocity[RADAR_PROCESSOR_MAX_POINT_NUM];
+    float energy[RADAR_PROCESSOR_MAX_POINT_NUM];
+    float beamAngle[RADAR_PROCESSOR_MAX_POINT_NUM];
+    uint8_t snr[RADAR_PROCESSOR_MAX_POINT_NUM];
+    int16_t label[RADAR_PROCESSOR_MAX_POINT_NUM];   /*!< Cluster index or RADAR_PROCESSOR_NOISE_LABEL. */
+} T_RadarPointFrame;
+
+typedef struct {
+    float x;
+    float y;
+    float z;
+    float minX;
+    float minY;
+    float minZ;
+    float maxX;
+    float maxY;
+    float maxZ;
+    float range;
+    float velocity;                 /*!< Mean radial velocity, positive when closing in. */
+    uint32_t pointCount;
+} T_RadarCluster;
+
+typedef struct {
+    uint32_t id;
+    float x;
+    float y;
+    float z;
+    float vx;
+    float vy;
+    float vz;
+    float radialVelocity;
+    uint32_t pointCount;
+    uint32_t hits;
+    uint32_t misses;
+    uint32_t age;
+    bool isConfirmed;
+} T_RadarTrack;
+
+typedef struct {
+    uint32_t decodeUs;
+    uint32_t clusterUs;
+    uint32_t trackUs;
+    uint32_t totalUs;               /*!< From the last packet of the frame to the result callback. */
+} T_RadarProcessorLatency;
+
+typedef struct {
+    E_DjiPerceptionRadarPosition position;
+    uint64_t timestampUs;
+    uint32_t rawPointCount;
+    const T_RadarPointFrame *frame;
+    const T_RadarCluster *clusters;
+    uint32_t clusterNum;
+    const T_RadarTrack *tracks;
+    uint32_t trackNum;
+    T_RadarProcessorLatency latency;
+} T_RadarFrameResult;
+
+typedef struct {
+    uint32_t frameCount;
+    uint32_t droppedPacketCount;
+    uint32_t maxTotalUs;
+    uint64_t sumTotalUs;
+} T_RadarProcessorStatistics;
+
+typedef void (*RadarProcessorCallback)(const T_RadarFrameResult *result, void *userData);
+
+/**
+ * @brief Decodes radar packets into pooled point frames, clusters them with a grid indexed DBSCAN and follows the
+ * clusters with one nearest-neighbour alpha-beta tracker per radar position.
+ * @note PushPacket is meant to be called from the radar callbacks of several positions, the whole processing runs
+ * under one lock in the calling thread, so the result callback must return quickly.
+ */
+class RadarProcessor {
+public:
+    RadarProcessor();
+    ~RadarProcessor();
+
+    static void GetDefaultConfig(T_RadarProcessorConfig *config);
+    T_DjiReturnCode Init(const T_RadarProcessorConfig &config, RadarProcessorCallback callback, void *userData);
+    T_DjiReturnCode Deinit();
+
+    T_DjiReturnCode PushPacket(E_DjiPerceptionRadarPosition position, const uint8_t *buffer, uint32_t bufferLen);
+    void GetStatistics(T_RadarProcessorStatistics *statistics);
+
+private:
+    struct TrackerState {
+        T_RadarTrack tracks[RADAR_PROCESSOR_MAX_TRACK_NUM];
+        uint32_t trackNum;
+        uint64_t lastTimestampUs;
+    };
+
+    struct GridCell {
+        uint32_t begin;
+        uint32_t count;
+    };
+
+    void ProcessFrame(E_DjiPerceptionRadarPosition position, T_RadarPointFrame *frame, uint64_t lastPacketUs);
+    void BuildGrid(const T_RadarPointFrame *frame);
+    uint32_t QueryNeighbours(const T_RadarPointFrame *frame, uint32_t index);
+    uint32_t Cluster(T_RadarPointFrame *frame);
+    uint32_t Track(TrackerState *state, uint32_t clusterNum, uint64_t timestampUs);
+
+    T_RadarProcessorConfig m_config;
+    RadarProcessorCallback m_callback;
+    void *m_userData;
+    T_DjiMutexHandle m_mutex;
+    bool m_isInit;
+
+    void *m_poolMemory;
+    T_UtilPool m_framePool;
+    T_RadarPointFrame *m_pending[MAX_RADAR_NUM];
+    uint32_t m_rawPointCount[MAX_RADAR_NUM];
+    uint32_t m_decodeUs[MAX_RADAR_NUM];
+
+    void *m_gridMemory;
+    T_UtilHashMap m_grid;
+    std::vector<GridCell> m_cells;
+    std::vector<uint64_t> m_cellKeys;
+    std::vector<uint32_t> m_cellOrder;
+    std::vector<uint32_t> m_neighbours;
+    std::vector<uint32_t> m_queue;
+
+    T_RadarCluster m_clusters[RADAR_PROCESSOR_MAX_CLUSTER_NUM];
+    TrackerState m_trackers[MAX_RADAR_NUM];
+    uint32_t m_nextTrackId;
+    T_RadarProcessorStatistics m_statistics;
+};
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // TEST_RADAR_PROCESSOR_H
+/************************ (C) COPYRIGHT DJI Innovations *******END OF FILE******/
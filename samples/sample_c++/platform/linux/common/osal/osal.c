@@ -31,10 +31,12 @@
 /* Private types -------------------------------------------------------------*/
 
 /* Private values -------------------------------------------------------------*/
-static uint32_t s_localTimeMsOffset = 0;
 static uint64_t s_localTimeUsOffset = 0;
+static pthread_once_t s_localTimeOffsetOnce = PTHREAD_ONCE_INIT;
 
 /* Private functions declaration ---------------------------------------------*/
+static uint64_t Osal_GetMonotonicTimeUs(void);
+static void Osal_InitLocalTimeOffset(void);
 
 /* Exported functions definition ---------------------------------------------*/
 
@@ -292,36 +294,22 @@ T_DjiReturnCode Osal_SemaphorePost(T_DjiSemaHandle semaphore)
 
 /**
  * @brief Get the system time for ms.
+ * @note The monotonic clock is used, the wall clock steps whenever NTP or the user sets the date, which would corrupt
+ * the time synchronization with the aircraft that is built on the local time.
  * @return an uint32 that the time of system, uint:ms
  */
 T_DjiReturnCode Osal_GetTimeMs(uint32_t *ms)
 {
-    struct timeval time;
-
-    gettimeofday(&time, NULL);
-    *ms = (time.tv_sec * 1000 + time.tv_usec / 1000);
-
-    if (s_localTimeMsOffset == 0) {
-        s_localTimeMsOffset = *ms;
-    } else {
-        *ms = *ms - s_localTimeMsOffset;
-    }
+    pthread_once(&s_localTimeOffsetOnce, Osal_InitLocalTimeOffset);
+    *ms = (uint32_t) ((Osal_GetMonotonicTimeUs() - s_localTimeUsOffset) / 1000);
 
     return DJI_ERROR_SYSTEM_MODULE_CODE_SUCCESS;
 }
 
 T_DjiReturnCode Osal_GetTimeUs(uint64_t *us)
 {
-    struct timeval time;
-
-    gettimeofday(&time, NULL);
-    *us = (time.tv_sec * 1000000 + time.tv_usec);
-
-    if (s_localTimeUsOffset == 0) {
-        s_localTimeUsOffset = *us;
-    } else {
-        *us = *us - s_localTimeUsOffset;
-    }
+    pthread_once(&s_localTimeOffsetOnce, Osal_InitLocalTimeOffset);
+    *us = Osal_GetMonotonicTimeUs() - s_localTimeUsOffset;
 
     return DJI_ERROR_SYSTEM_MODULE_CODE_SUCCESS;
 }
@@ -344,4 +332,23 @@ void Osal_Free(void *ptr)
     free(ptr);
 }
 
+/* Private functions definition-----------------------------------------------*/
+static uint64_t Osal_GetMonotonicTimeUs(void)
+{
+    struct timespec time;
+
+    clock_gettime(CLOCK_MONOTONIC, &time);
+
+    return (uint64_t) time.tv_sec * 1000000 + time.tv_nsec / 1000;
+}
+
+/**
+ * @brief Both time functions count from the first call of either, every task calls them, so the offset is taken
+ * once under pthread_once.
+ */
+static void Osal_InitLocalTimeOffset(void)
+{
+    s_localTimeUsOffset = Osal_GetMonotonicTimeUs();
+}
+
 /****************** (C) COPYRIGHT DJI Innovations *****END OF FILE****/
\ No newline at end of file
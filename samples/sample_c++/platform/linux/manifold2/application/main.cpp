@@ -43,14 +43,20 @@
 #include <positioning/test_positioning.h>
 #include <hms_manager/hms_manager_entry.h>
 #include "camera_manager/test_camera_manager_entry.h"
+#include "flight_recorder/test_flight_recorder.h"
+#include <string>
 
 /* Private constants ---------------------------------------------------------*/
+#define DJI_FLIGHT_RECORD_FOLDER_NAME    "Flights"
+#define DJI_FLIGHT_RECORD_FILE_PREFIX    "flight"
 
 /* Private types -------------------------------------------------------------*/
 
 /* Private values -------------------------------------------------------------*/
 
 /* Private functions declaration ---------------------------------------------*/
+static void DjiUser_ToggleFlightRecorder(void);
+static void DjiUser_ReplayFlightRecord(void);
 
 /* Exported functions definition ---------------------------------------------*/
 int main(int argc, char **argv)
@@ -75,6 +81,8 @@ start:
         << "| [f] Start rtk positioning sample - you can receive rtk rtcm data when rtk signal is ok           |\n"
         << "| [g] Request Lidar data sample - Request Lidar data and store the point cloud data as pcd files   |\n"
         << "| [h] Request Radar data sample - Request radar data                                               |\n"
+        << "| [r] Start or stop flight recorder - record the data of the samples started afterwards            |\n"
+        << "| [p] Replay flight record - feed a record into the callbacks of the started samples               |\n"
         << std::endl;
 
     std::cin >> inputChar;
@@ -115,6 +123,12 @@ start:
         case 'h':
             DjiUser_RunRadarDataSubscriptionSample();
             break;
+        case 'r':
+            DjiUser_ToggleFlightRecorder();
+            break;
+        case 'p':
+            DjiUser_ReplayFlightRecord();
+            break;
         default:
             break;
     }
@@ -125,5 +139,57 @@ start:
 }
 
 /* Private functions definition-----------------------------------------------*/
+static void DjiUser_ToggleFlightRecorder(void)
+{
+    T_DjiTestFlightRecorderConfig config;
+    T_DjiTestFlightRecorderStatistics statistics;
+    T_DjiReturnCode returnCode;
+
+    if (DjiTest_FlightRecorderIsRecording()) {
+        DjiTest_FlightRecorderGetStatistics(&statistics);
+        DjiTest_FlightRecorderStop();
+        USER_LOG_INFO("Flight recorder stopped, %llu records, %u dropped", statistics.recordCount,
+                      statistics.droppedCount);
+        return;
+    }
+
+    DjiTest_FlightRecorderGetDefaultConfig(&config);
+    config.directory = DJI_FLIGHT_RECORD_FOLDER_NAME;
+    config.prefix = DJI_FLIGHT_RECORD_FILE_PREFIX;
+    returnCode = DjiTest_FlightRecorderStart(&config);
+    if (returnCode != DJI_ERROR_SYSTEM_MODULE_CODE_SUCCESS) {
+        USER_LOG_ERROR("Flight recorder start failed, return code:0x%08X", returnCode);
+        return;
+    }
+
+    USER_LOG_INFO("Flight recorder started");
+}
+
+static void DjiUser_ReplayFlightRecord(void)
+{
+    std::string replayFilePath;
+    double replayRate;
+    T_DjiReturnCode returnCode;
+
+    if (DjiTest_FlightRecorderIsReplaying()) {
+        DjiTest_FlightRecorderReplayStop();
+        USER_LOG_INFO("Flight record replay stopped");
+        return;
+    }
+
+    std::cout << "Please enter the flight record file path: ";
+    std::cin >> replayFilePath;
+    std::cout << "Please enter the replay rate (0 as fast as possible): ";
+    std::cin >> replayRate;
+
+    returnCode = DjiTest_FlightRecorderReplayStart(replayFilePath.c_str(), replayRate, false);
+    if (returnCode != DJI_ERROR_SYSTEM_MODULE_CODE_SUCCESS) {
+        USER_LOG_ERROR("Flight record replay start failed, return code:0x%08X", returnCode);
+        return;
+    }
+
+    USER_LOG_INFO("Flight record replay started");
+}
+
 
 /****************** (C) COPYRIGHT DJI Innovations *****END OF FILE****/
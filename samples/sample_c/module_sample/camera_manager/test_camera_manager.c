@@ -27,6 +27,7 @@
 #include <utils/util_misc.h>
 #include <time.h>
 #include "test_camera_manager.h"
+#include "test_camera_manager_media_catalog.h"
 #include "dji_camera_manager.h"
 #include "dji_platform.h"
 #include "dji_logger.h"
@@ -46,6 +47,8 @@
 #define TEST_CAMERA_MOP_CHANNEL_MAX_RECV_COUNT                           30
 #define TEST_CAMEAR_POINT_CLOUD_FILE_PATH_STR_MAX_SIZE                   256
 #define TEST_CAMEAR_MEDIA_SUB_FILE_NOT_FOUND                             -1
+#define TEST_CAMERA_MEDIA_CATALOG_SNAPSHOT_PATH                          "media_file_catalog.bin"
+#define TEST_CAMERA_MEDIA_CATALOG_LARGE_FILE_SIZE                        (100 * 1024 * 1024)
 
 /* Private types -------------------------------------------------------------*/
 typedef struct {
@@ -92,6 +95,10 @@ static uint32_t s_nextDownloadFileIndex = 0;
 static T_DjiMopChannelHandle s_mopChannelHandle;
 static char s_pointCloudFilePath[TEST_CAMEAR_POINT_CLOUD_FILE_PATH_STR_MAX_SIZE];
 #endif
+#ifdef SYSTEM_ARCH_LINUX
+static T_DjiTestMediaCatalog s_mediaCatalog;
+static bool s_isMediaCatalogInited = false;
+#endif
 
 /* Private functions declaration ---------------------------------------------*/
 static uint8_t DjiTest_CameraManagerGetCameraTypeIndex(E_DjiCameraType cameraType);
@@ -2279,9 +2286,11 @@ ReleaseDownloaderRights:
 static T_DjiReturnCode DjiTest_CameraManagerMediaDownloadFileListBySlices(E_DjiMountPosition position)
 {
     T_DjiReturnCode returnCode;
-    T_DjiOsalHandler *osalHandler = DjiPlatform_GetOsalHandler();
-    uint16_t downloadCount = 0;
-    T_DjiCameraManagerSliceConfig sliceConfig = {0};
+    T_DjiTestMediaCatalogSyncInfo syncInfo = {0};
+    T_DjiTestMediaCatalogQuery query = {0};
+    T_DjiCameraManagerFileCreateTime createTime;
+    const T_DjiTestMediaCatalogEntry *entry;
+    uint32_t matchCount;
 
     s_nextDownloadFileIndex = 0;
     returnCode = DjiCameraManager_RegDownloadFileDataCallback(position, DjiTest_CameraManagerDownloadFileDataCallback);
@@ -2290,57 +2299,72 @@ static T_DjiReturnCode DjiTest_CameraManagerMediaDownloadFileListBySlices(E_DjiM
         return returnCode;
     }
 
+    if (s_isMediaCatalogInited == false) {
+        returnCode = DjiTest_MediaCatalogInit(&s_mediaCatalog, TEST_CAMERA_MEDIA_CATALOG_SNAPSHOT_PATH);
+        if (returnCode != DJI_ERROR_SYSTEM_MODULE_CODE_SUCCESS) {
+            USER_LOG_ERROR("Init media file catalog failed, error code: 0x%08X.", returnCode);
+            return returnCode;
+        }
+        s_isMediaCatalogInited = true;
+        USER_LOG_INFO("Media file catalog warm started with %d files.", s_mediaCatalog.entryCount);
+    }
+
     returnCode = DjiCameraManager_ObtainDownloaderRights(position);
     if (returnCode != DJI_ERROR_SYSTEM_MODULE_CODE_SUCCESS) {
         USER_LOG_ERROR("Obtain downloader rights failed, error code: 0x%08X.", returnCode);
     }
 
-    sliceConfig.countPerSlice = DJI_CAMERA_MANAGER_FILE_LIST_COUNT_ALL_PER_SLICE;
-    sliceConfig.sliceStartIndex = 0;
-
-    returnCode = DjiCameraManager_DownloadFileListBySlices(position, sliceConfig, &s_meidaFileList);
+    returnCode = DjiTest_MediaCatalogSync(&s_mediaCatalog, position, &syncInfo);
     if (returnCode != DJI_ERROR_SYSTEM_MODULE_CODE_SUCCESS) {
         USER_LOG_ERROR("Download file list failed, error code: 0x%08X.", returnCode);
-        return returnCode;
+        goto releaseDownloaderRights;
     }
 
-    if (s_meidaFileList.totalCount > 0) {
-        downloadCount = s_meidaFileList.totalCount;
+    USER_LOG_INFO("Media file catalog %s refresh done, %d new files, %d files total, %d slice requests, %d ms.",
+                  syncInfo.isFullRefresh ? "full" : "incremental", syncInfo.newFileCount, syncInfo.totalFileCount,
+                  syncInfo.sliceRequestCount, syncInfo.elapsedMs);
+
+    returnCode = DjiTest_MediaCatalogSaveSnapshot(&s_mediaCatalog);
+    if (returnCode != DJI_ERROR_SYSTEM_MODULE_CODE_SUCCESS) {
+        USER_LOG_WARN("Save media file catalog snapshot failed, error code: 0x%08X.", returnCode);
+    }
+
+    if (s_mediaCatalog.entryCount > 0) {
         printf(
-            "\033[1;33;40m -> Download file list finished, total file count is %d, the following %d is list details: \033[0m\r\n",
-            s_meidaFileList.totalCount, downloadCount);
-        for (int i = 0; i < downloadCount; ++i) {
-            if (s_meidaFileList.fileListInfo[i].fileSize < 1 * 1024 * 1024) {
+            "\033[1;33;40m -> Download file list finished, total file count is %d, the following %d is new files details: \033[0m\r\n",
+            s_mediaCatalog.entryCount, syncInfo.newFileCount);
+        for (uint32_t i = s_mediaCatalog.entryCount - syncInfo.newFileCount; i < s_mediaCatalog.entryCount; ++i) {
+            entry = &s_mediaCatalog.entries[i];
+            DjiTest_MediaCatalogParseTimeKey(entry->createTimeKey, &createTime);
+            if (entry->fileSize < 1 * 1024 * 1024) {
                 printf(
                     "\033[1;32;40m ### Media file_%03d name: %s, index: %d, time:%04d-%02d-%02d_%02d:%02d:%02d, size: %.2f KB, type: %d \033[0m\r\n",
-                    i, s_meidaFileList.fileListInfo[i].fileName,
-                    s_meidaFileList.fileListInfo[i].fileIndex,
-                    s_meidaFileList.fileListInfo[i].createTime.year,
-                    s_meidaFileList.fileListInfo[i].createTime.month,
-                    s_meidaFileList.fileListInfo[i].createTime.day,
-                    s_meidaFileList.fileListInfo[i].createTime.hour,
-                    s_meidaFileList.fileListInfo[i].createTime.minute,
-                    s_meidaFileList.fileListInfo[i].createTime.second,
-                    (dji_f32_t) s_meidaFileList.fileListInfo[i].fileSize / 1024,
-                    s_meidaFileList.fileListInfo[i].type);
+                    i, DjiTest_MediaCatalogGetFileName(&s_mediaCatalog, entry), entry->fileIndex,
+                    createTime.year, createTime.month, createTime.day,
+                    createTime.hour, createTime.minute, createTime.second,
+                    (dji_f32_t) entry->fileSize / 1024, entry->type);
             } else {
                 printf(
                     "\033[1;32;40m ### Media file_%03d name: %s, index: %d, time:%04d-%02d-%02d_%02d:%02d:%02d, size: %.2f MB, type: %d \033[0m\r\n",
-                    i, s_meidaFileList.fileListInfo[i].fileName,
-                    s_meidaFileList.fileListInfo[i].fileIndex,
-                    s_meidaFileList.fileListInfo[i].createTime.year,
-                    s_meidaFileList.fileListInfo[i].createTime.month,
-                    s_meidaFileList.fileListInfo[i].createTime.day,
-                    s_meidaFileList.fileListInfo[i].createTime.hour,
-                    s_meidaFileList.fileListInfo[i].createTime.minute,
-                    s_meidaFileList.fileListInfo[i].createTime.second,
-                    (dji_f32_t) s_meidaFileList.fileListInfo[i].fileSize / (1024 * 1024),
-                    s_meidaFileList.fileListInfo[i].type);
+                    i, DjiTest_MediaCatalogGetFileName(&s_mediaCatalog, entry), entry->fileIndex,
+                    createTime.year, createTime.month, createTime.day,
+                    createTime.hour, createTime.minute, createTime.second,
+                    (dji_f32_t) entry->fileSize / (1024 * 1024), entry->type);
             }
         }
         printf("\r\n");
 
-        returnCode = DjiCameraManager_DownloadFileByIndex(position, s_meidaFileList.fileListInfo[0].fileIndex);
+        query.type = DJI_CAMERA_FILE_TYPE_JPEG;
+        matchCount = DjiTest_MediaCatalogQuery(&s_mediaCatalog, &query, NULL, 0);
+        USER_LOG_INFO("Media file catalog holds %d jpeg files.", matchCount);
+
+        query.type = DJI_TEST_MEDIA_CATALOG_TYPE_ANY;
+        query.minFileSize = TEST_CAMERA_MEDIA_CATALOG_LARGE_FILE_SIZE;
+        matchCount = DjiTest_MediaCatalogQuery(&s_mediaCatalog, &query, NULL, 0);
+        USER_LOG_INFO("Media file catalog holds %d files larger than %d MB.", matchCount,
+                      TEST_CAMERA_MEDIA_CATALOG_LARGE_FILE_SIZE / (1024 * 1024));
+
+        returnCode = DjiCameraManager_DownloadFileByIndex(position, s_mediaCatalog.entries[0].fileIndex);
         if (returnCode != DJI_ERROR_SYSTEM_MODULE_CODE_SUCCESS) {
             USER_LOG_ERROR("Download media file by index failed, error code: 0x%08X.", returnCode);
         }
@@ -2349,6 +2373,7 @@ static T_DjiReturnCode DjiTest_CameraManagerMediaDownloadFileListBySlices(E_DjiM
         USER_LOG_WARN("Media file is not existed in sdcard.\r\n");
     }
 
+releaseDownloaderRights:
     returnCode = DjiCameraManager_ReleaseDownloaderRights(position);
     if (returnCode != DJI_ERROR_SYSTEM_MODULE_CODE_SUCCESS) {
         USER_LOG_ERROR("Release downloader rights failed, error code: 0x%08X.", returnCode);
@@ -2376,6 +2401,12 @@ static T_DjiReturnCode DjiTest_CameraManagerDownloadFileDataCallback(T_DjiDownlo
                     break;
                 }
             }
+            if (strlen(downloadFileName) == 0 && s_isMediaCatalogInited) {
+                snprintf(downloadFileName, sizeof(downloadFileName), "%s",
+                         DjiTest_MediaCatalogGetFileName(&s_mediaCatalog,
+                                                         DjiTest_MediaCatalogFindByIndex(&s_mediaCatalog,
+                                                                                         packetInfo.fileIndex)));
+            }
         } else {
             for (i = 0; i < s_meidaFileList.totalCount; ++i) {
                 for (j = 0; j < s_meidaFileList.fileListInfo[i].subFileListTotalNum; ++j) {
@@ -2441,6 +2472,12 @@ static T_DjiReturnCode DjiTest_CameraManagerDownloadFileDataCallback(T_DjiDownlo
                     break;
                 }
             }
+            if (strlen(downloadFileName) == 0 && s_isMediaCatalogInited) {
+                snprintf(downloadFileName, sizeof(downloadFileName), "%s",
+                         DjiTest_MediaCatalogGetFileName(&s_mediaCatalog,
+                                                         DjiTest_MediaCatalogFindByIndex(&s_mediaCatalog,
+                                                                                         packetInfo.fileIndex)));
+            }
         } else {
             for (i = 0; i < s_meidaFileList.totalCount; ++i) {
                 for (j = 0; j < s_meidaFileList.fileListInfo[i].subFileListTotalNum; ++j) {
@@ -0,0 +1,799 @@
+/**
+ ********************************************************************
+ * @file    test_camera_manager_media_catalog.c
+ * @brief   Local catalogue of the camera media file list, refreshed incrementally by slices and
+ *          persisted as a compact snapshot for warm starts.
+ *
+ * @copyright (c) 2021 DJI. All rights reserved.
+ *
+ * All information contained herein is, and remains, the property of DJI.
+ * The intellectual and technical concepts contained herein are proprietary
+ * to DJI and may be covered by U.S. and foreign patents, patents in process,
+ * and protected by trade secret or copyright law.  Dissemination of this
+ * information, including but not limited to data and other proprietary
+ * material(s) incorporated within the information, in any form, is strictly
+ * prohibited without the express written consent of DJI.
+ *
+ * If you receive this source code without DJI’s authorization, you may not
+ * further disseminate the information, and you must immediately remove the
+ * source code and notify DJI of its removal. DJI reserves the right to pursue
+ * legal actions against you for any loss(es) or damage(s) caused by your
+ * failure to do so.
+ *
+ *********************************************************************
+ */
+
+/* Includes ------------------------------------------------------------------*/
+#include "test_camera_manager_media_catalog.h"
+
+#ifdef SYSTEM_ARCH_LINUX
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "dji_platform.h"
+#include "dji_logger.h"
+
+/* Private constants ---------------------------------------------------------*/
+#define DJI_TEST_MEDIA_CATALOG_SNAPSHOT_MAGIC           0x31434D44  /* "DMC1" */
+#define DJI_TEST_MEDIA_CATALOG_SNAPSHOT_VERSION         1
+#define DJI_TEST_MEDIA_CATALOG_INIT_ENTRY_CAPACITY      256
+#define DJI_TEST_MEDIA_CATALOG_INIT_NAME_POOL_SIZE      (16 * 1024)
+#define DJI_TEST_MEDIA_CATALOG_SLICE_COUNT              DJI_CAMERA_MANAGER_FILE_LIST_COUNT_120_PER_SLICE
+#define DJI_TEST_MEDIA_CATALOG_SLICE_START_INDEX_MAX    0xFFFF
+#define DJI_TEST_MEDIA_CATALOG_TIME_BASE_YEAR           2000
+#define DJI_TEST_MEDIA_CATALOG_ENTRY_COUNT_MAX          (DJI_TEST_MEDIA_CATALOG_SLICE_START_INDEX_MAX + 1 + \
+                                                         DJI_TEST_MEDIA_CATALOG_SLICE_COUNT)
+#define DJI_TEST_MEDIA_CATALOG_NAME_POOL_SIZE_MAX       (16 * 1024 * 1024)
+
+/* Private types -------------------------------------------------------------*/
+typedef struct {
+    uint32_t magic;
+    uint16_t version;
+    uint16_t entrySize;
+    uint32_t entryCount;
+    uint32_t namePoolUsed;
+    uint32_t checksum;
+} T_DjiTestMediaCatalogSnapshotHeader;
+
+/* Private functions declaration ---------------------------------------------*/
+static T_DjiReturnCode DjiTest_MediaCatalogReserveEntries(T_DjiTestMediaCatalog *catalog, uint32_t count);
+static T_DjiReturnCode DjiTest_MediaCatalogReserveNamePool(T_DjiTestMediaCatalog *catalog, uint32_t size);
+static T_DjiReturnCode DjiTest_MediaCatalogRebuildIndexes(T_DjiTestMediaCatalog *catalog);
+static int32_t DjiTest_MediaCatalogSearchEntry(const T_DjiTestMediaCatalog *catalog, uint32_t fileIndex);
+static uint32_t DjiTest_MediaCatalogLowerBound(const uint64_t *order, uint32_t count, uint64_t key);
+static int DjiTest_MediaCatalogCompareEntry(const void *a, const void *b);
+static int DjiTest_MediaCatalogCompareOrderKey(const void *a, const void *b);
+static bool DjiTest_MediaCatalogIsMatch(const T_DjiTestMediaCatalogEntry *entry,
+                                        const T_DjiTestMediaCatalogQuery *query);
+static uint32_t DjiTest_MediaCatalogChecksum(uint32_t hash, const uint8_t *data, uint32_t len);
+
+/* Private values -------------------------------------------------------------*/
+
+/* Exported functions definition ---------------------------------------------*/
+T_DjiReturnCode DjiTest_MediaCatalogInit(T_DjiTestMediaCatalog *catalog, const char *snapshotPath)
+{
+    T_DjiReturnCode returnCode;
+
+    if (catalog == NULL) {
+        return DJI_ERROR_SYSTEM_MODULE_CODE_INVALID_PARAMETER;
+    }
+
+    memset(catalog, 0, sizeof(T_DjiTestMediaCatalog));
+    if (snapshotPath != NULL) {
+        snprintf(catalog->snapshotPath, sizeof(catalog->snapshotPath), "%s", snapshotPath);
+    }
+
+    returnCode = DjiTest_MediaCatalogReserveEntries(catalog, DJI_TEST_MEDIA_CATALOG_INIT_ENTRY_CAPACITY);
+    if (returnCode != DJI_ERROR_SYSTEM_MODULE_CODE_SUCCESS) {
+        return returnCode;
+    }
+
+    returnCode = DjiTest_MediaCatalogReserveNamePool(catalog, DJI_TEST_MEDIA_CATALOG_INIT_NAME_POOL_SIZE);
+    if (returnCode != DJI_ERROR_SYSTEM_MODULE_CODE_SUCCESS) {
+        return returnCode;
+    }
+
+    if (strlen(catalog->snapshotPath) > 0) {
+        returnCode = DjiTest_MediaCatalogLoadSnapshot(catalog);
+        if (returnCode != DJI_ERROR_SYSTEM_MODULE_CODE_SUCCESS) {
+            USER_LOG_WARN("Media catalog snapshot %s not loaded, start with empty catalog.", catalog->snapshotPath);
+            DjiTest_MediaCatalogClear(catalog);
+        }
+    }
+
+    return DJI_ERROR_SYSTEM_MODULE_CODE_SUCCESS;
+}
+
+T_DjiReturnCode DjiTest_MediaCatalogDeInit(T_DjiTestMediaCatalog *catalog)
+{
+    T_DjiOsalHandler *osalHandler = DjiPlatform_GetOsalHandler();
+
+    if (catalog == NULL) {
+        return DJI_ERROR_SYSTEM_MODULE_CODE_INVALID_PARAMETER;
+    }
+
+    if (catalog->entries != NULL) {
+        osalHandler->Free(catalog->entries);
+    }
+    if (catalog->timeOrder != NULL) {
+        osalHandler->Free(catalog->timeOrder);
+    }
+    if (catalog->sizeOrder != NULL) {
+        osalHandler->Free(catalog->sizeOrder);
+    }
+    if (catalog->namePool != NULL) {
+        osalHandler->Free(catalog->namePool);
+    }
+    memset(catalog, 0, sizeof(T_DjiTestMediaCatalog));
+
+    return DJI_ERROR_SYSTEM_MODULE_CODE_SUCCESS;
+}
+
+T_DjiReturnCode DjiTest_MediaCatalogClear(T_DjiTestMediaCatalog *catalog)
+{
+    if (catalog == NULL) {
+        return DJI_ERROR_SYSTEM_MODULE_CODE_INVALID_PARAMETER;
+    }
+
+    catalog->entryCount = 0;
+    catalog->orderCount = 0;
+    catalog->namePoolUsed = 0;
+
+    return DJI_ERROR_SYSTEM_MODULE_CODE_SUCCESS;
+}
+
+/**
+ * @brief Bring the catalogue up to date with the camera.
+ * @note The last known entry is requested again as an anchor. If the camera still reports it at the same
+ * position only the range after it is downloaded, otherwise files were deleted or the card was formatted
+ * and the whole list is downloaded again. Downloader rights must be obtained by the caller.
+ * @param catalog: pointer to the catalogue.
+ * @param position: mount position of the camera.
+ * @param syncInfo: optional, filled with the statistics of this refresh.
+ * @return Execution result.
+ */
+T_DjiReturnCode DjiTest_MediaCatalogSync(T_DjiTestMediaCatalog *catalog, E_DjiMountPosition position,
+                                         T_DjiTestMediaCatalogSyncInfo *syncInfo)
+{
+    T_DjiReturnCode returnCode;
+    T_DjiOsalHandler *osalHandler = DjiPlatform_GetOsalHandler();
+    T_DjiCameraManagerSliceConfig sliceConfig = {0};
+    T_DjiCameraManagerFileList fileList = {0};
+    T_DjiTestMediaCatalogSyncInfo info = {0};
+    uint32_t startMs = 0;
+    uint32_t endMs = 0;
+    uint32_t countBefore;
+    uint32_t nextStartIndex = 0;
+    bool isListEnd = false;
+
+    if (catalog == NULL) {
+        return DJI_ERROR_SYSTEM_MODULE_CODE_INVALID_PARAMETER;
+    }
+
+    osalHandler->GetTimeMs(&startMs);
+    countBefore = catalog->entryCount;
+    sliceConfig.countPerSlice = DJI_TEST_MEDIA_CATALOG_SLICE_COUNT;
+
+    if (catalog->entryCount > 0 && catalog->entryCount - 1 <= DJI_TEST_MEDIA_CATALOG_SLICE_START_INDEX_MAX) {
+        sliceConfig.sliceStartIndex = (uint16_t) (catalog->entryCount - 1);
+        returnCode = DjiCameraManager_DownloadFileListBySlices(position, sliceConfig, &fileList);
+        if (returnCode != DJI_ERROR_SYSTEM_MODULE_CODE_SUCCESS) {
+            USER_LOG_ERROR("Download anchor slice of file list failed, error code: 0x%08X.", returnCode);
+            return returnCode;
+        }
+        info.sliceRequestCount++;
+
+        if (fileList.totalCount > 0 && fileList.fileListInfo != NULL &&
+            fileList.fileListInfo[0].fileIndex == catalog->entries[catalog->entryCount - 1].fileIndex) {
+            returnCode = DjiTest_MediaCatalogMerge(catalog, &fileList, 1);
+            if (returnCode != DJI_ERROR_SYSTEM_MODULE_CODE_SUCCESS) {
+                return returnCode;
+            }
+            nextStartIndex = sliceConfig.sliceStartIndex + fileList.totalCount;
+            isListEnd = fileList.totalCount < DJI_TEST_MEDIA_CATALOG_SLICE_COUNT;
+        } else {
+            USER_LOG_INFO("Media catalog anchor mismatch, refresh whole file list.");
+            info.isFullRefresh = true;
+        }
+    } else {
+        info.isFullRefresh = true;
+    }
+
+    if (info.isFullRefresh) {
+        DjiTest_MediaCatalogClear(catalog);
+        countBefore = 0;
+        nextStartIndex = 0;
+    }
+
+    while (!isListEnd) {
+        if (nextStartIndex > DJI_TEST_MEDIA_CATALOG_SLICE_START_INDEX_MAX) {
+            USER_LOG_WARN("Media file list exceeds slice index range, stop at %d files.", catalog->entryCount);
+            break;
+        }
+
+        sliceConfig.sliceStartIndex = (uint16_t) nextStartIndex;
+        returnCode = DjiCameraManager_DownloadFileListBySlices(position, sliceConfig, &fileList);
+        if (returnCode != DJI_ERROR_SYSTEM_MODULE_CODE_SUCCESS) {
+            USER_LOG_ERROR("Download slice %d of file list failed, error code: 0x%08X.", nextStartIndex,
+                           returnCode);
+            DjiTest_MediaCatalogRebuildIndexes(catalog);
+            return returnCode;
+        }
+        info.sliceRequestCount++;
+
+        returnCode = DjiTest_MediaCatalogMerge(catalog, &fileList, 0);
+        if (returnCode != DJI_ERROR_SYSTEM_MODULE_CODE_SUCCESS) {
+            return returnCode;
+        }
+
+        nextStartIndex += fileList.totalCount;
+        isListEnd = fileList.totalCount < DJI_TEST_MEDIA_CATALOG_SLICE_COUNT;
+    }
+
+    returnCode = DjiTest_MediaCatalogRebuildIndexes(catalog);
+    if (returnCode != DJI_ERROR_SYSTEM_MODULE_CODE_SUCCESS) {
+        return returnCode;
+    }
+
+    osalHandler->GetTimeMs(&endMs);
+    info.newFileCount = catalog->entryCount > countBefore ? catalog->entryCount - countBefore : 0;
+    info.totalFileCount = catalog->entryCount;
+    info.elapsedMs = endMs - startMs;
+    if (syncInfo != NULL) {
+        *syncInfo = info;
+    }
+
+    return DJI_ERROR_SYSTEM_MODULE_CODE_SUCCESS;
+}
+
+/**
+ * @brief Add the files of one downloaded list or slice to the catalogue.
+ * @note Files already known by index are updated in place. Secondary indexes are rebuilt lazily, call
+ * DjiTest_MediaCatalogQuery() or DjiTest_MediaCatalogSync() to refresh them.
+ * @param catalog: pointer to the catalogue.
+ * @param fileList: list returned by the camera manager.
+ * @param skipCount: number of leading files of the list to ignore.
+ * @return Execution result.
+ */
+T_DjiReturnCode DjiTest_MediaCatalogMerge(T_DjiTestMediaCatalog *catalog,
+                                          const T_DjiCameraManagerFileList *fileList, uint32_t skipCount)
+{
+    T_DjiReturnCode returnCode;
+    const T_DjiCameraManagerFileListInfo *fileInfo;
+    T_DjiTestMediaCatalogEntry *entry;
+    uint32_t nameLen;
+    uint32_t i;
+    int32_t pos;
+    bool isSorted = true;
+
+    if (catalog == NULL || fileList == NULL) {
+        return DJI_ERROR_SYSTEM_MODULE_CODE_INVALID_PARAMETER;
+    }
+
+    if (fileList->totalCount <= skipCount || fileList->fileListInfo == NULL) {
+        return DJI_ERROR_SYSTEM_MODULE_CODE_SUCCESS;
+    }
+
+    returnCode = DjiTest_MediaCatalogReserveEntries(catalog, catalog->entryCount + fileList->totalCount - skipCount);
+    if (returnCode != DJI_ERROR_SYSTEM_MODULE_CODE_SUCCESS) {
+        return returnCode;
+    }
+
+    for (i = skipCount; i < fileList->totalCount; i++) {
+        fileInfo = &fileList->fileListInfo[i];
+
+        pos = -1;
+        if (catalog->entryCount > 0 && fileInfo->fileIndex <= catalog->entries[catalog->entryCount - 1].fileIndex) {
+            pos = isSorted ? DjiTest_MediaCatalogSearchEntry(catalog, fileInfo->fileIndex) : -1;
+            if (pos < 0) {
+                isSorted = false;
+            }
+        }
+
+        if (pos >= 0) {
+            entry = &catalog->entries[pos];
+        } else {
+            nameLen = strnlen(fileInfo->fileName, sizeof(fileInfo->fileName));
+            returnCode = DjiTest_MediaCatalogReserveNamePool(catalog, catalog->namePoolUsed + nameLen + 1);
+            if (returnCode != DJI_ERROR_SYSTEM_MODULE_CODE_SUCCESS) {
+                return returnCode;
+            }
+
+            entry = &catalog->entries[catalog->entryCount++];
+            entry->nameOffset = catalog->namePoolUsed;
+            entry->nameLen = (uint16_t) nameLen;
+            memcpy(&catalog->namePool[catalog->namePoolUsed], fileInfo->fileName, nameLen);
+            catalog->namePool[catalog->namePoolUsed + nameLen] = '\0';
+            catalog->namePoolUsed += nameLen + 1;
+        }
+
+        entry->fileIndex = fileInfo->fileIndex;
+        entry->fileSize = fileInfo->fileSize;
+        entry->createTimeKey = DjiTest_MediaCatalogMakeTimeKey(&fileInfo->createTime);
+        entry->type = (uint8_t) fileInfo->type;
+        entry->subFileCount = fileInfo->subFileListTotalNum;
+    }
+
+    if (!isSorted) {
+        qsort(catalog->entries, catalog->entryCount, sizeof(T_DjiTestMediaCatalogEntry),
+              DjiTest_MediaCatalogCompareEntry);
+    }
+    catalog->orderCount = 0;
+
+    return DJI_ERROR_SYSTEM_MODULE_CODE_SUCCESS;
+}
+
+T_DjiReturnCode DjiTest_MediaCatalogLoadSnapshot(T_DjiTestMediaCatalog *catalog)
+{
+    T_DjiReturnCode returnCode;
+    T_DjiTestMediaCatalogSnapshotHeader header;
+    uint32_t checksum;
+    long fileSize;
+    FILE *fp;
+
+    if (catalog == NULL) {
+        return DJI_ERROR_SYSTEM_MODULE_CODE_INVALID_PARAMETER;
+    }
+
+    fp = fopen(catalog->snapshotPath, "rb");
+    if (fp == NULL) {
+        return DJI_ERROR_SYSTEM_MODULE_CODE_NOT_FOUND;
+    }
+
+    if (fread(&header, 1, sizeof(header), fp) != sizeof(header) ||
+        header.magic != DJI_TEST_MEDIA_CATALOG_SNAPSHOT_MAGIC ||
+        header.version != DJI_TEST_MEDIA_CATALOG_SNAPSHOT_VERSION ||
+        header.entrySize != sizeof(T_DjiTestMediaCatalogEntry)) {
+        returnCode = DJI_ERROR_SYSTEM_MODULE_CODE_INVALID_PARAMETER;
+        goto out;
+    }
+
+    /* The counts size the allocations below before the checksum can be verified, so bound them first. */
+    if (header.entryCount > DJI_TEST_MEDIA_CATALOG_ENTRY_COUNT_MAX ||
+        header.namePoolUsed > DJI_TEST_MEDIA_CATALOG_NAME_POOL_SIZE_MAX) {
+        USER_LOG_WARN("Media catalog snapshot counts out of range, entry %u name pool %u.",
+                      header.entryCount, header.namePoolUsed);
+        returnCode = DJI_ERROR_SYSTEM_MODULE_CODE_INVALID_PARAMETER;
+        goto out;
+    }
+
+    if (fseek(fp, 0, SEEK_END) != 0 || (fileSize = ftell(fp)) < 0 ||
+        fseek(fp, sizeof(header), SEEK_SET) != 0) {
+        returnCode = DJI_ERROR_SYSTEM_MODULE_CODE_SYSTEM_ERROR;
+        goto out;
+    }
+    if ((uint64_t) fileSize != sizeof(header) + (uint64_t) header.entryCount * sizeof(T_DjiTestMediaCatalogEntry) +
+                               header.namePoolUsed) {
+        USER_LOG_WARN("Media catalog snapshot size %ld does not match its header.", fileSize);
+        returnCode = DJI_ERROR_SYSTEM_MODULE_CODE_INVALID_PARAMETER;
+        goto out;
+    }
+
+    DjiTest_MediaCatalogClear(catalog);
+    returnCode = DjiTest_MediaCatalogReserveEntries(catalog, header.entryCount);
+    if (returnCode != DJI_ERROR_SYSTEM_MODULE_CODE_SUCCESS) {
+        goto out;
+    }
+    returnCode = DjiTest_MediaCatalogReserveNamePool(catalog, header.namePoolUsed);
+    if (returnCode != DJI_ERROR_SYSTEM_MODULE_CODE_SUCCESS) {
+        goto out;
+    }
+
+    if (fread(catalog->entries, sizeof(T_DjiTestMediaCatalogEntry), header.entryCount, fp) != header.entryCount ||
+        fread(catalog->namePool, 1, header.namePoolUsed, fp) != header.namePoolUsed) {
+        returnCode = DJI_ERROR_SYSTEM_MODULE_CODE_SYSTEM_ERROR;
+        goto out;
+    }
+
+    checksum = DjiTest_MediaCatalogChecksum(0, (const uint8_t *) catalog->entries,
+                                            header.entryCount * sizeof(T_DjiTestMediaCatalogEntry));
+    checksum = DjiTest_MediaCatalogChecksum(checksum, (const uint8_t *) catalog->namePool, header.namePoolUsed);
+    if (checksum != header.checksum) {
+        USER_LOG_WARN("Media catalog snapshot checksum mismatch.");
+        returnCode = DJI_ERROR_SYSTEM_MODULE_CODE_INVALID_PARAMETER;
+        goto out;
+    }
+
+    catalog->entryCount = header.entryCount;
+    catalog->namePoolUsed = header.namePoolUsed;
+    returnCode = DjiTest_MediaCatalogRebuildIndexes(catalog);
+
+out:
+    fclose(fp);
+    if (returnCode != DJI_ERROR_SYSTEM_MODULE_CODE_SUCCESS) {
+        DjiTest_MediaCatalogClear(catalog);
+    }
+
+    return returnCode;
+}
+
+/**
+ * @brief Write the catalogue to its snapshot path. The snapshot is written to a temporary file first and then
+ * renamed, so an interrupted write never leaves a truncated snapshot behind.
+ * @param catalog: pointer to the catalogue.
+ * @return Execution result.
+ */
+T_DjiReturnCode DjiTest_MediaCatalogSaveSnapshot(const T_DjiTestMediaCatalog *catalog)
+{
+    T_DjiTestMediaCatalogSnapshotHeader header = {0};
+    char tempPath[DJI_FILE_PATH_SIZE_MAX + 8];
+    FILE *fp;
+    bool isWriteOk;
+
+    if (catalog == NULL || strlen(catalog->snapshotPath) == 0) {
+        return DJI_ERROR_SYSTEM_MODULE_CODE_INVALID_PARAMETER;
+    }
+
+    header.magic = DJI_TEST_MEDIA_CATALOG_SNAPSHOT_MAGIC;
+    header.version = DJI_TEST_MEDIA_CATALOG_SNAPSHOT_VERSION;
+    header.entrySize = sizeof(T_DjiTestMediaCatalogEntry);
+    header.entryCount = catalog->entryCount;
+    header.namePoolUsed = catalog->namePoolUsed;
+    header.checksum = DjiTest_MediaCatalogChecksum(0, (const uint8_t *) catalog->entries,
+                                                   catalog->entryCount * sizeof(T_DjiTestMediaCatalogEntry));
+    header.checksum = DjiTest_MediaCatalogChecksum(header.checksum, (const uint8_t *) catalog->namePool,
+                                                   catalog->namePoolUsed);
+
+    snprintf(tempPath, sizeof(tempPath), "%s.tmp", catalog->snapshotPath);
+    fp = fopen(tempPath, "wb");
+    if (fp == NULL) {
+        USER_LOG_ERROR("Open media catalog snapshot %s failed.", tempPath);
+        return DJI_ERROR_SYSTEM_MODULE_CODE_SYSTEM_ERROR;
+    }
+
+    isWriteOk = fwrite(&header, 1, sizeof(header), fp) == sizeof(header) &&
+                fwrite(catalog->entries, sizeof(T_DjiTestMediaCatalogEntry), catalog->entryCount, fp) ==
+                catalog->entryCount &&
+                fwrite(catalog->namePool, 1, catalog->namePoolUsed, fp) == catalog->namePoolUsed;
+    if (fclose(fp) != 0) {
+        isWriteOk = false;
+    }
+
+    if (!isWriteOk || rename(tempPath, catalog->snapshotPath) != 0) {
+        USER_LOG_ERROR("Write media catalog snapshot %s failed.", catalog->snapshotPath);
+        remove(tempPath);
+        return DJI_ERROR_SYSTEM_MODULE_CODE_SYSTEM_ERROR;
+    }
+
+    return DJI_ERROR_SYSTEM_MODULE_CODE_SUCCESS;
+}
+
+const T_DjiTestMediaCatalogEntry *DjiTest_MediaCatalogFindByIndex(const T_DjiTestMediaCatalog *catalog,
+                                                                  uint32_t fileIndex)
+{
+    int32_t pos;
+
+    if (catalog == NULL) {
+        return NULL;
+    }
+
+    pos = DjiTest_MediaCatalogSearchEntry(catalog, fileIndex);
+
+    return pos >= 0 ? &catalog->entries[pos] : NULL;
+}
+
+const char *DjiTest_MediaCatalogGetFileName(const T_DjiTestMediaCatalog *catalog,
+                                            const T_DjiTestMediaCatalogEntry *entry)
+{
+    if (catalog == NULL || entry == NULL || entry->nameOffset >= catalog->namePoolUsed) {
+        return "";
+    }
+
+    return &catalog->namePool[entry->nameOffset];
+}
+
+/**
+ * @brief Find the files matching a filter.
+ * @note A time or size range is served from the sorted index of that key, only type filtering falls back to
+ * a scan. Results are ordered by the index that was used.
+ * @param catalog: pointer to the catalogue.
+ * @param query: filter of the query.
+ * @param result: optional array receiving the matched entries.
+ * @param resultMaxCount: capacity of the result array.
+ * @return Number of matched files, which may exceed resultMaxCount.
+ */
+uint32_t DjiTest_MediaCatalogQuery(const T_DjiTestMediaCatalog *catalog, const T_DjiTestMediaCatalogQuery *query,
+                                   const T_DjiTestMediaCatalogEntry **result, uint32_t resultMaxCount)
+{
+    const uint64_t *order = NULL;
+    const T_DjiTestMediaCatalogEntry *entry;
+    uint32_t begin = 0;
+    uint32_t end;
+    uint32_t matchCount = 0;
+    uint32_t i;
+
+    if (catalog == NULL || query == NULL) {
+        return 0;
+    }
+
+    if (catalog->orderCount != catalog->entryCount &&
+        DjiTest_MediaCatalogRebuildIndexes((T_DjiTestMediaCatalog *) catalog) != DJI_ERROR_SYSTEM_MODULE_CODE_SUCCESS) {
+        return 0;
+    }
+
+    end = catalog->entryCount;
+    if (query->startTimeKey != DJI_TEST_MEDIA_CATALOG_TIME_ANY ||
+        query->endTimeKey != DJI_TEST_MEDIA_CATALOG_TIME_ANY) {
+        order = catalog->timeOrder;
+        begin = DjiTest_MediaCatalogLowerBound(order, catalog->orderCount, (uint64_t) query->startTimeKey << 32);
+        if (query->endTimeKey != DJI_TEST_MEDIA_CATALOG_TIME_ANY) {
+            end = DjiTest_MediaCatalogLowerBound(order, catalog->orderCount,
+                                                 ((uint64_t) query->endTimeKey + 1) << 32);
+        }
+    } else if (query->minFileSize != DJI_TEST_MEDIA_CATALOG_SIZE_ANY ||
+               query->maxFileSize != DJI_TEST_MEDIA_CATALOG_SIZE_ANY) {
+        order = catalog->sizeOrder;
+        begin = DjiTest_MediaCatalogLowerBound(order, catalog->orderCount, (uint64_t) query->minFileSize << 32);
+        if (query->maxFileSize != DJI_TEST_MEDIA_CATALOG_SIZE_ANY) {
+            end = DjiTest_MediaCatalogLowerBound(order, catalog->orderCount,
+                                                 ((uint64_t) query->maxFileSize + 1) << 32);
+        }
+    }
+
+    for (i = begin; i < end; i++) {
+        entry = order != NULL ? &catalog->entries[(uint32_t) order[i]] : &catalog->entries[i];
+        if (!DjiTest_MediaCatalogIsMatch(entry, query)) {
+            continue;
+        }
+        if (result != NULL && matchCount < resultMaxCount) {
+            result[matchCount] = entry;
+        }
+        matchCount++;
+    }
+
+    return matchCount;
+}
+
+uint32_t DjiTest_MediaCatalogMakeTimeKey(const T_DjiCameraManagerFileCreateTime *createTime)
+{
+    uint32_t year;
+
+    if (createTime == NULL) {
+        return 0;
+    }
+
+    year = createTime->year > DJI_TEST_MEDIA_CATALOG_TIME_BASE_YEAR ?
+           createTime->year - DJI_TEST_MEDIA_CATALOG_TIME_BASE_YEAR : 0;
+    if (year > 0x3F) {
+        year = 0x3F;
+    }
+
+    return (year << 26) | ((uint32_t) (createTime->month & 0x0F) << 22) | ((uint32_t) (createTime->day & 0x1F) << 17) |
+           ((uint32_t) (createTime->hour & 0x1F) << 12) | ((uint32_t) (createTime->minute & 0x3F) << 6) |
+           (uint32_t) (createTime->second & 0x3F);
+}
+
+void DjiTest_MediaCatalogParseTimeKey(uint32_t timeKey, T_DjiCameraManagerFileCreateTime *createTime)
+{
+    if (createTime == NULL) {
+        return;
+    }
+
+    createTime->year = (uint16_t) ((timeKey >> 26) + DJI_TEST_MEDIA_CATALOG_TIME_BASE_YEAR);
+    createTime->month = (uint8_t) ((timeKey >> 22) & 0x0F);
+    createTime->day = (uint8_t) ((timeKey >> 17) & 0x1F);
+    createTime->hour = (uint8_t) ((timeKey >> 12) & 0x1F);
+    createTime->minute = (uint8_t) ((timeKey >> 6) & 0x3F);
+    createTime->second = (uint8_t) (timeKey & 0x3F);
+}
+
+/* Private functions definition-----------------------------------------------*/
+static T_DjiReturnCode DjiTest_MediaCatalogReserveEntries(T_DjiTestMediaCatalog *catalog, uint32_t count)
+{
+    T_DjiOsalHandler *osalHandler = DjiPlatform_GetOsalHandler();
+    T_DjiTestMediaCatalogEntry *entries;
+    uint32_t capacity = catalog->entryCapacity > 0 ? catalog->entryCapacity
+                                                   : DJI_TEST_MEDIA_CATALOG_INIT_ENTRY_CAPACITY;
+
+    if (count <= catalog->entryCapacity) {
+        return DJI_ERROR_SYSTEM_MODULE_CODE_SUCCESS;
+    }
+    if (count > DJI_TEST_MEDIA_CATALOG_ENTRY_COUNT_MAX) {
+        return DJI_ERROR_SYSTEM_MODULE_CODE_OUT_OF_RANGE;
+    }
+
+    while (capacity < count) {
+        capacity = capacity > DJI_TEST_MEDIA_CATALOG_ENTRY_COUNT_MAX / 2 ? DJI_TEST_MEDIA_CATALOG_ENTRY_COUNT_MAX
+                                                                          : capacity * 2;
+    }
+    if (capacity > UINT32_MAX / sizeof(T_DjiTestMediaCatalogEntry)) {
+        return DJI_ERROR_SYSTEM_MODULE_CODE_OUT_OF_RANGE;
+    }
+
+    entries = osalHandler->Malloc(capacity * sizeof(T_DjiTestMediaCatalogEntry));
+    if (entries == NULL) {
+        return DJI_ERROR_SYSTEM_MODULE_CODE_MEMORY_ALLOC_FAILED;
+    }
+
+    if (catalog->entries != NULL) {
+        memcpy(entries, catalog->entries, catalog->entryCount * sizeof(T_DjiTestMediaCatalogEntry));
+        osalHandler->Free(catalog->entries);
+    }
+    catalog->entries = entries;
+    catalog->entryCapacity = capacity;
+
+    return DJI_ERROR_SYSTEM_MODULE_CODE_SUCCESS;
+}
+
+static T_DjiReturnCode DjiTest_MediaCatalogReserveNamePool(T_DjiTestMediaCatalog *catalog, uint32_t size)
+{
+    T_DjiOsalHandler *osalHandler = DjiPlatform_GetOsalHandler();
+    char *namePool;
+    uint32_t capacity = catalog->namePoolCapacity > 0 ? catalog->namePoolCapacity
+                                                      : DJI_TEST_MEDIA_CATALOG_INIT_NAME_POOL_SIZE;
+
+    if (size <= catalog->namePoolCapacity) {
+        return DJI_ERROR_SYSTEM_MODULE_CODE_SUCCESS;
+    }
+    if (size > DJI_TEST_MEDIA_CATALOG_NAME_POOL_SIZE_MAX) {
+        return DJI_ERROR_SYSTEM_MODULE_CODE_OUT_OF_RANGE;
+    }
+
+    while (capacity < size) {
+        capacity = capacity > DJI_TEST_MEDIA_CATALOG_NAME_POOL_SIZE_MAX / 2 ? DJI_TEST_MEDIA_CATALOG_NAME_POOL_SIZE_MAX
+                                                                            : capacity * 2;
+    }
+
+    namePool = osalHandler->Malloc(capacity);
+    if (namePool == NULL) {
+        return DJI_ERROR_SYSTEM_MODULE_CODE_MEMORY_ALLOC_FAILED;
+    }
+
+    if (catalog->namePool != NULL) {
+        memcpy(namePool, catalog->namePool, catalog->namePoolUsed);
+        osalHandler->Free(catalog->namePool);
+    }
+    catalog->namePool = namePool;
+    catalog->namePoolCapacity = capacity;
+
+    return DJI_ERROR_SYSTEM_MODULE_CODE_SUCCESS;
+}
+
+/*
+ * The order arrays hold (key << 32 | entry position) pairs, so one plain integer sort orders them by key and
+ * keeps the position next to it without a comparison context.
+ */
+static T_DjiReturnCode DjiTest_MediaCatalogRebuildIndexes(T_DjiTestMediaCatalog *catalog)
+{
+    T_DjiOsalHandler *osalHandler = DjiPlatform_GetOsalHandler();
+    uint64_t *timeOrder;
+    uint64_t *sizeOrder;
+    uint32_t i;
+
+    if (catalog->timeOrder != NULL) {
+        osalHandler->Free(catalog->timeOrder);
+        catalog->timeOrder = NULL;
+    }
+    if (catalog->sizeOrder != NULL) {
+        osalHandler->Free(catalog->sizeOrder);
+        catalog->sizeOrder = NULL;
+    }
+    catalog->orderCount = 0;
+
+    if (catalog->entryCount == 0) {
+        return DJI_ERROR_SYSTEM_MODULE_CODE_SUCCESS;
+    }
+
+    timeOrder = osalHandler->Malloc(catalog->entryCount * sizeof(uint64_t));
+    sizeOrder = osalHandler->Malloc(catalog->entryCount * sizeof(uint64_t));
+    if (timeOrder == NULL || sizeOrder == NULL) {
+        if (timeOrder != NULL) {
+            osalHandler->Free(timeOrder);
+        }
+        if (sizeOrder != NULL) {
+            osalHandler->Free(sizeOrder);
+        }
+        return DJI_ERROR_SYSTEM_MODULE_CODE_MEMORY_ALLOC_FAILED;
+    }
+
+    for (i = 0; i < catalog->entryCount; i++) {
+        timeOrder[i] = ((uint64_t) catalog->entries[i].createTimeKey << 32) | i;
+        sizeOrder[i] = ((uint64_t) catalog->entries[i].fileSize << 32) | i;
+    }
+    qsort(timeOrder, catalog->entryCount, sizeof(uint64_t), DjiTest_MediaCatalogCompareOrderKey);
+    qsort(sizeOrder, catalog->entryCount, sizeof(uint64_t), DjiTest_MediaCatalogCompareOrderKey);
+
+    catalog->timeOrder = timeOrder;
+    catalog->sizeOrder = sizeOrder;
+    catalog->orderCount = catalog->entryCount;
+
+    return DJI_ERROR_SYSTEM_MODULE_CODE_SUCCESS;
+}
+
+static int32_t DjiTest_MediaCatalogSearchEntry(const T_DjiTestMediaCatalog *catalog, uint32_t fileIndex)
+{
+    int32_t low = 0;
+    int32_t high = (int32_t) catalog->entryCount - 1;
+    int32_t mid;
+
+    while (low <= high) {
+        mid = low + (high - low) / 2;
+        if (catalog->entries[mid].fileIndex == fileIndex) {
+            return mid;
+        } else if (catalog->entries[mid].fileIndex < fileIndex) {
+            low = mid + 1;
+        } else {
+            high = mid - 1;
+        }
+    }
+
+    return -1;
+}
+
+static uint32_t DjiTest_MediaCatalogLowerBound(const uint64_t *order, uint32_t count, uint64_t key)
+{
+    uint32_t low = 0;
+    uint32_t high = count;
+    uint32_t mid;
+
+    while (low < high) {
+        mid = low + (high - low) / 2;
+        if (order[mid] < key) {
+            low = mid + 1;
+        } else {
+            high = mid;
+        }
+    }
+
+    return low;
+}
+
+static int DjiTest_MediaCatalogCompareEntry(const void *a, const void *b)
+{
+    uint32_t indexA = ((const T_DjiTestMediaCatalogEntry *) a)->fileIndex;
+    uint32_t indexB = ((const T_DjiTestMediaCatalogEntry *) b)->fileIndex;
+
+    return (indexA > indexB) - (indexA < indexB);
+}
+
+static int DjiTest_MediaCatalogCompareOrderKey(const void *a, const void *b)
+{
+    uint64_t keyA = *(const uint64_t *) a;
+    uint64_t keyB = *(const uint64_t *) b;
+
+    return (keyA > keyB) - (keyA < keyB);
+}
+
+static bool DjiTest_MediaCatalogIsMatch(const T_DjiTestMediaCatalogEntry *entry,
+                                        const T_DjiTestMediaCatalogQuery *query)
+{
+    if (query->type != DJI_TEST_MEDIA_CATALOG_TYPE_ANY && entry->type != query->type) {
+        return false;
+    }
+    if (query->startTimeKey != DJI_TEST_MEDIA_CATALOG_TIME_ANY && entry->createTimeKey < query->startTimeKey) {
+        return false;
+    }
+    if (query->endTimeKey != DJI_TEST_MEDIA_CATALOG_TIME_ANY && entry->createTimeKey > query->endTimeKey) {
+        return false;
+    }
+    if (query->minFileSize != DJI_TEST_MEDIA_CATALOG_SIZE_ANY && entry->fileSize < query->minFileSize) {
+        return false;
+    }
+    if (query->maxFileSize != DJI_TEST_MEDIA_CATALOG_SIZE_ANY && entry->fileSize > query->maxFileSize) {
+        return false;
+    }
+
+    return true;
+}
+
+/* FNV-1a, only used to detect a damaged or truncated snapshot. */
+static uint32_t DjiTest_MediaCatalogChecksum(uint32_t hash, const uint8_t *data, uint32_t len)
+{
+    uint32_t i;
+
+    if (hash == 0) {
+        hash = 2166136261U;
+    }
+
+    for (i = 0; i < len; i++) {
+        hash ^= data[i];
+        hash *= 16777619U;
+    }
+
+    return hash;
+}
+
+#endif
+
+/****************** (C) COPYRIGHT DJI Innovations *****END OF FILE****/
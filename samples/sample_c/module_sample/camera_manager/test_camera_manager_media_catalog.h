@@ -0,0 +1,127 @@
+/**
+ ********************************************************************
+ * @file    test_camera_manager_media_catalog.h
+ * @brief   This is the header file for "test_camera_manager_media_catalog.c", defining the structure and
+ * (exported) function prototypes.
+ *
+ * @copyright (c) 2021 DJI. All rights reserved.
+ *
+ * All information contained herein is, and remains, the property of DJI.
+ * The intellectual and technical concepts contained herein are proprietary
+ * to DJI and may be covered by U.S. and foreign patents, patents in process,
+ * and protected by trade secret or copyright law.  Dissemination of this
+ * information, including but not limited to data and other proprietary
+ * material(s) incorporated within the information, in any form, is strictly
+ * prohibited without the express written consent of DJI.
+ *
+ * If you receive this source code without DJI’s authorization, you may not
+ * further disseminate the information, and you must immediately remove the
+ * source code and notify DJI of its removal. DJI reserves the right to pursue
+ * legal actions against you for any loss(es) or damage(s) caused by your
+ * failure to do so.
+ *
+ *********************************************************************
+ */
+
+/* Define to prevent recursive inclusion -------------------------------------*/
+#ifndef TEST_CAMERA_MANAGER_MEDIA_CATALOG_H
+#define TEST_CAMERA_MANAGER_MEDIA_CATALOG_H
+
+/* Includes ------------------------------------------------------------------*/
+#include "dji_typedef.h"
+#include "dji_camera_manager.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#ifdef SYSTEM_ARCH_LINUX
+
+/* Exported constants --------------------------------------------------------*/
+#define DJI_TEST_MEDIA_CATALOG_TYPE_ANY             0xFF
+#define DJI_TEST_MEDIA_CATALOG_TIME_ANY             0
+#define DJI_TEST_MEDIA_CATALOG_SIZE_ANY             0
+
+/* Exported types ------------------------------------------------------------*/
+/**
+ * @brief One media file known by the catalogue. The file name lives in the catalogue name pool, use
+ * DjiTest_MediaCatalogGetFileName() to read it.
+ */
+typedef struct {
+    uint32_t fileIndex;
+    uint32_t fileSize;
+    uint32_t createTimeKey;
+    uint32_t nameOffset;
+    uint16_t nameLen;
+    uint8_t type;
+    uint8_t subFileCount;
+} T_DjiTestMediaCatalogEntry;
+
+/**
+ * @brief Local copy of the camera media file list. Entries are kept in the order the camera reports them
+ * (ascending file index), with secondary indexes by create time and by file size for range queries.
+ */
+typedef struct {
+    T_DjiTestMediaCatalogEntry *entries;
+    uint32_t entryCount;
+    uint32_t entryCapacity;
+    uint64_t *timeOrder;
+    uint64_t *sizeOrder;
+    uint32_t orderCount;
+    char *namePool;
+    uint32_t namePoolUsed;
+    uint32_t namePoolCapacity;
+    char snapshotPath[DJI_FILE_PATH_SIZE_MAX];
+} T_DjiTestMediaCatalog;
+
+/**
+ * @brief Query filter, set a field to the matching *_ANY value to skip it. Time bounds are create time keys
+ * made by DjiTest_MediaCatalogMakeTimeKey(), size bounds are in bytes and both ends are inclusive.
+ */
+typedef struct {
+    uint8_t type;
+    uint32_t startTimeKey;
+    uint32_t endTimeKey;
+    uint32_t minFileSize;
+    uint32_t maxFileSize;
+} T_DjiTestMediaCatalogQuery;
+
+typedef struct {
+    bool isFullRefresh;
+    uint32_t sliceRequestCount;
+    uint32_t newFileCount;
+    uint32_t totalFileCount;
+    uint32_t elapsedMs;
+} T_DjiTestMediaCatalogSyncInfo;
+
+/* Exported functions --------------------------------------------------------*/
+T_DjiReturnCode DjiTest_MediaCatalogInit(T_DjiTestMediaCatalog *catalog, const char *snapshotPath);
+T_DjiReturnCode DjiTest_MediaCatalogDeInit(T_DjiTestMediaCatalog *catalog);
+T_DjiReturnCode DjiTest_MediaCatalogClear(T_DjiTestMediaCatalog *catalog);
+
+T_DjiReturnCode DjiTest_MediaCatalogSync(T_DjiTestMediaCatalog *catalog, E_DjiMountPosition position,
+                                         T_DjiTestMediaCatalogSyncInfo *syncInfo);
+T_DjiReturnCode DjiTest_MediaCatalogMerge(T_DjiTestMediaCatalog *catalog,
+                                          const T_DjiCameraManagerFileList *fileList, uint32_t skipCount);
+
+T_DjiReturnCode DjiTest_MediaCatalogLoadSnapshot(T_DjiTestMediaCatalog *catalog);
+T_DjiReturnCode DjiTest_MediaCatalogSaveSnapshot(const T_DjiTestMediaCatalog *catalog);
+
+const T_DjiTestMediaCatalogEntry *DjiTest_MediaCatalogFindByIndex(const T_DjiTestMediaCatalog *catalog,
+                                                                  uint32_t fileIndex);
+const char *DjiTest_MediaCatalogGetFileName(const T_DjiTestMediaCatalog *catalog,
+                                            const T_DjiTestMediaCatalogEntry *entry);
+uint32_t DjiTest_MediaCatalogQuery(const T_DjiTestMediaCatalog *catalog, const T_DjiTestMediaCatalogQuery *query,
+                                   const T_DjiTestMediaCatalogEntry **result, uint32_t resultMaxCount);
+
+uint32_t DjiTest_MediaCatalogMakeTimeKey(const T_DjiCameraManagerFileCreateTime *createTime);
+void DjiTest_MediaCatalogParseTimeKey(uint32_t timeKey, T_DjiCameraManagerFileCreateTime *createTime);
+
+#endif
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // TEST_CAMERA_MANAGER_MEDIA_CATALOG_H
+/************************ (C) COPYRIGHT DJI Innovations *******END OF FILE******/
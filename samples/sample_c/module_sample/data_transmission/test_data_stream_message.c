@@ -0,0 +1,748 @@
+/**
+ ********************************************************************
+ * @file    test_data_stream_message.c
+ * @brief   Framed, checksummed and reassembled messages over the data stream of the high speed data channel.
+ *
+ * @copyright (c) 2021 DJI. All rights reserved.
+ *
+ * All information contained herein is, and remains, the property of DJI.
+ * The intellectual and technical concepts contained herein are proprietary
+ * to DJI and may be covered by U.S. and foreign patents, patents in process,
+ * and protected by trade secret or copyright law.  Dissemination of this
+ * information, including but not limited to data and other proprietary
+ * material(s) incorporated within the information, in any form, is strictly
+ * prohibited without the express written consent of DJI.
+ *
+ * If you receive this source code without DJI’s authorization, you may not
+ * further disseminate the information, and you must immediately remove the
+ * source code and notify DJI of its removal. DJI reserves the right to pursue
+ * legal actions against you for any loss(es) or damage(s) caused by your
+ * failure to do so.
+ *
+ *********************************************************************
+ */
+
+/* Includes ------------------------------------------------------------------*/
+#include "test_data_stream_message.h"
+
+#ifdef SYSTEM_ARCH_LINUX
+
+#include <string.h>
+#include "dji_logger.h"
+#include "dji_high_speed_data_channel.h"
+#include "utils/util_misc.h"
+#include "utils/util_zip.h"
+
+/* Private constants ---------------------------------------------------------*/
+
+/* Private types -------------------------------------------------------------*/
+
+/* Private functions declaration ---------------------------------------------*/
+static uint32_t DjiTest_DataStreamFrameCrc(T_DjiTestDataStreamFrameHeader *header, const T_DjiTestDataStreamIov *iov,
+                                           uint32_t iovCount);
+static T_DjiReturnCode DjiTest_DataStreamSendFrames(T_DjiTestDataStreamSender *sender,
+                                                    const T_DjiTestDataStreamIov *iov, uint32_t iovCount,
+                                                    uint32_t messageSize, uint32_t originalSize, uint8_t flags,
+                                                    uint32_t messageId);
+static bool DjiTest_DataStreamCheckHeader(const T_DjiTestDataStreamReceiver *receiver,
+                                          const T_DjiTestDataStreamFrameHeader *header);
+static bool DjiTest_DataStreamIsCompleted(const T_DjiTestDataStreamReceiver *receiver, uint32_t messageId);
+static T_DjiTestDataStreamReassemblySlot *DjiTest_DataStreamGetSlot(T_DjiTestDataStreamReceiver *receiver,
+                                                                    const T_DjiTestDataStreamFrameHeader *header,
+                                                                    uint32_t nowMs);
+static void DjiTest_DataStreamExpireSlots(T_DjiTestDataStreamReceiver *receiver, uint32_t nowMs);
+static void DjiTest_DataStreamCompleteSlot(T_DjiTestDataStreamReceiver *receiver,
+                                           T_DjiTestDataStreamReassemblySlot *slot);
+static T_DjiReturnCode DjiTest_DataStreamHighSpeedSendFrame(void *userData, const T_DjiTestDataStreamIov *iov,
+                                                            uint32_t iovCount, uint32_t frameLen);
+static T_DjiReturnCode DjiTest_DataStreamLoopbackSendFrame(void *userData, const T_DjiTestDataStreamIov *iov,
+                                                           uint32_t iovCount, uint32_t frameLen);
+static void DjiTest_DataStreamGather(uint8_t *dst, const T_DjiTestDataStreamIov *iov, uint32_t iovCount);
+
+/* Private values ------------------------------------------------------------*/
+
+/* Exported functions definition ---------------------------------------------*/
+void DjiTest_DataStreamGetDataStreamChannel(T_DjiTestDataStreamChannel *channel)
+{
+    channel->SendFrame = DjiTest_DataStreamHighSpeedSendFrame;
+    channel->userData = NULL;
+}
+
+void DjiTest_DataStreamSenderGetDefaultConfig(T_DjiTestDataStreamSenderConfig *config)
+{
+    memset(config, 0, sizeof(T_DjiTestDataStreamSenderConfig));
+
+    config->frameSize = DJI_TEST_DATA_STREAM_FRAME_MAX_SIZE;
+    config->maxMessageSize = 4 * 1024 * 1024;
+}
+
+T_DjiReturnCode DjiTest_DataStreamSenderInit(T_DjiTestDataStreamSender *sender,
+                                             const T_DjiTestDataStreamSenderConfig *config,
+                                             const T_DjiTestDataStreamChannel *channel)
+{
+    T_DjiOsalHandler *osalHandler = DjiPlatform_GetOsalHandler();
+    uint16_t randomNum = 0;
+    uint32_t nowMs = 0;
+    T_DjiReturnCode returnCode;
+
+    if (sender == NULL || config == NULL || channel == NULL || channel->SendFrame == NULL ||
+        config->frameSize <= DJI_TEST_DATA_STREAM_FRAME_HEADER_SIZE ||
+        config->frameSize > DJI_TEST_DATA_STREAM_FRAME_MAX_SIZE ||
+        config->maxMessageSize > UTIL_LZ4_MAX_INPUT_SIZE) {
+        return DJI_ERROR_SYSTEM_MODULE_CODE_INVALID_PARAMETER;
+    }
+
+    memset(sender, 0, sizeof(T_DjiTestDataStreamSender));
+    sender->config = *config;
+    sender->channel = *channel;
+    /* A restarted sender must not reuse the ids a receiver still remembers as completed. */
+    osalHandler->GetRandomNum(&randomNum);
+    osalHandler->GetTimeMs(&nowMs);
+    sender->nextMessageId = ((uint32_t) randomNum << 16) ^ nowMs;
+    if (sender->nextMessageId == 0) {
+        sender->nextMessageId = 1;
+    }
+
+    if (config->maxMessageSize > 0) {
+        sender->gatherBuffer = osalHandler->Malloc(config->maxMessageSize);
+        sender->compressBuffer = osalHandler->Malloc(UtilLz4_CompressBound(config->maxMessageSize));
+        sender->encoder = osalHandler->Malloc(sizeof(T_UtilLz4Encoder));
+        if (sender->gatherBuffer == NULL || sender->compressBuffer == NULL || sender->encoder == NULL) {
+            returnCode = DJI_ERROR_SYSTEM_MODULE_CODE_MEMORY_ALLOC_FAILED;
+            goto freeBuffer;
+        }
+    }
+
+    returnCode = osalHandler->MutexCreate(&sender->mutex);
+    if (returnCode != DJI_ERROR_SYSTEM_MODULE_CODE_SUCCESS) {
+        USER_LOG_ERROR("Create data stream sender mutex error: 0x%08llX.", returnCode);
+        goto freeBuffer;
+    }
+
+    return DJI_ERROR_SYSTEM_MODULE_CODE_SUCCESS;
+
+freeBuffer:
+    if (sender->gatherBuffer != NULL) {
+        osalHandler->Free(sender->gatherBuffer);
+    }
+    if (sender->compressBuffer != NULL) {
+        osalHandler->Free(sender->compressBuffer);
+    }
+    if (sender->encoder != NULL) {
+        osalHandler->Free(sender->encoder);
+    }
+    memset(sender, 0, sizeof(T_DjiTestDataStreamSender));
+
+    return returnCode;
+}
+
+T_DjiReturnCode DjiTest_DataStreamSenderDeInit(T_DjiTestDataStreamSender *sender)
+{
+    T_DjiOsalHandler *osalHandler = DjiPlatform_GetOsalHandler();
+    T_DjiReturnCode returnCode;
+
+    if (sender == NULL || sender->mutex == NULL) {
+        return DJI_ERROR_SYSTEM_MODULE_CODE_INVALID_PARAMETER;
+    }
+
+    returnCode = osalHandler->MutexDestroy(sender->mutex);
+    if (sender->gatherBuffer != NULL) {
+        osalHandler->Free(sender->gatherBuffer);
+    }
+    if (sender->compressBuffer != NULL) {
+        osalHandler->Free(sender->compressBuffer);
+    }
+    if (sender->encoder != NULL) {
+        osalHandler->Free(sender->encoder);
+    }
+    memset(sender, 0, sizeof(T_DjiTestDataStreamSender));
+
+    return returnCode;
+}
+
+T_DjiReturnCode DjiTest_DataStreamSendMessage(T_DjiTestDataStreamSender *sender, const T_DjiTestDataStreamIov *iov,
+                                              uint32_t iovCount, uint32_t flags, uint32_t *messageId)
+{
+    T_DjiOsalHandler *osalHandler = DjiPlatform_GetOsalHandler();
+    T_DjiTestDataStreamIov compressedIov;
+    const uint8_t *source;
+    uint64_t totalLen = 0;
+    uint32_t compressedLen;
+    uint32_t id;
+    uint32_t i;
+    T_DjiReturnCode returnCode;
+
+    if (sender == NULL || sender->mutex == NULL || (iov == NULL && iovCount > 0) ||
+        iovCount > DJI_TEST_DATA_STREAM_IOV_MAX_NUM || (flags & ~DJI_TEST_DATA_STREAM_FLAG_COMPRESSED) != 0) {
+        return DJI_ERROR_SYSTEM_MODULE_CODE_INVALID_PARAMETER;
+    }
+
+    for (i = 0; i < iovCount; i++) {
+        if (iov[i].data == NULL && iov[i].len > 0) {
+            return DJI_ERROR_SYSTEM_MODULE_CODE_INVALID_PARAMETER;
+        }
+        totalLen += iov[i].len;
+    }
+    if (totalLen > UINT32_MAX) {
+        return DJI_ERROR_SYSTEM_MODULE_CODE_OUT_OF_RANGE;
+    }
+    if ((flags & DJI_TEST_DATA_STREAM_FLAG_COMPRESSED) != 0 && totalLen > sender->config.maxMessageSize) {
+        return DJI_ERROR_SYSTEM_MODULE_CODE_OUT_OF_RANGE;
+    }
+
+    osalHandler->MutexLock(sender->mutex);
+
+    id = sender->nextMessageId++;
+    if (sender->nextMessageId == 0) {
+        sender->nextMessageId = 1;
+    }
+
+    if ((flags & DJI_TEST_DATA_STREAM_FLAG_COMPRESSED) != 0 && totalLen > 0) {
+        if (iovCount == 1) {
+            source = iov[0].data;
+        } else {
+            DjiTest_DataStreamGather(sender->gatherBuffer, iov, iovCount);
+            source = sender->gatherBuffer;
+        }
+
+        returnCode = UtilLz4_Compress(sender->encoder, source, (uint32_t) totalLen, sender->compressBuffer,
+                                      UtilLz4_CompressBound(sender->config.maxMessageSize), &compressedLen);
+        /* Incompressible data goes out as it is, the flag only marks what is on the wire. */
+        if (returnCode == DJI_ERROR_SYSTEM_MODULE_CODE_SUCCESS && compressedLen < totalLen) {
+            compressedIov.data = sender->compressBuffer;
+            compressedIov.len = compressedLen;
+            returnCode = DjiTest_DataStreamSendFrames(sender, &compressedIov, 1, compressedLen, (uint32_t) totalLen,
+                                                      DJI_TEST_DATA_STREAM_FLAG_COMPRESSED, id);
+            if (returnCode == DJI_ERROR_SYSTEM_MODULE_CODE_SUCCESS) {
+                sender->statistics.compressedCount++;
+            }
+            goto out;
+        }
+    }
+
+    returnCode = DjiTest_DataStreamSendFrames(sender, iov, iovCount, (uint32_t) totalLen, (uint32_t) totalLen, 0, id);
+
+out:
+    if (returnCode == DJI_ERROR_SYSTEM_MODULE_CODE_SUCCESS) {
+        sender->statistics.messageCount++;
+        sender->statistics.messageBytes += totalLen;
+    } else {
+        sender->statistics.failedCount++;
+    }
+    osalHandler->MutexUnlock(sender->mutex);
+
+    if (messageId != NULL) {
+        *messageId = id;
+    }
+
+    return returnCode;
+}
+
+void DjiTest_DataStreamSenderGetStatistics(T_DjiTestDataStreamSender *sender,
+                                           T_DjiTestDataStreamSenderStatistics *statistics)
+{
+    T_DjiOsalHandler *osalHandler = DjiPlatform_GetOsalHandler();
+
+    osalHandler->MutexLock(sender->mutex);
+    *statistics = sender->statistics;
+    osalHandler->MutexUnlock(sender->mutex);
+}
+
+void DjiTest_DataStreamReceiverGetDefaultConfig(T_DjiTestDataStreamReceiverConfig *config)
+{
+    memset(config, 0, sizeof(T_DjiTestDataStreamReceiverConfig));
+
+    config->maxMessageSize = 4 * 1024 * 1024;
+    config->slotCount = 4;
+    config->timeoutMs = 2000;
+}
+
+T_DjiReturnCode DjiTest_DataStreamReceiverInit(T_DjiTestDataStreamReceiver *receiver,
+                                               const T_DjiTestDataStreamReceiverConfig *config)
+{
+    T_DjiOsalHandler *osalHandler = DjiPlatform_GetOsalHandler();
+    uint32_t bitmapSize;
+    uint32_t i;
+
+    if (receiver == NULL || config == NULL || config->callback == NULL || config->slotCount == 0 ||
+        config->maxMessageSize == 0 || config->maxMessageSize > UTIL_LZ4_MAX_INPUT_SIZE) {
+        return DJI_ERROR_SYSTEM_MODULE_CODE_INVALID_PARAMETER;
+    }
+
+    memset(receiver, 0, sizeof(T_DjiTestDataStreamReceiver));
+    receiver->config = *config;
+
+    receiver->slots = osalHandler->Malloc(sizeof(T_DjiTestDataStreamReassemblySlot) * config->slotCount);
+    if (receiver->slots == NULL) {
+        goto freeBuffer;
+    }
+    memset(receiver->slots, 0, sizeof(T_DjiTestDataStreamReassemblySlot) * config->slotCount);
+
+    receiver->decompressBuffer = osalHandler->Malloc(config->maxMessageSize);
+    if (receiver->decompressBuffer == NULL) {
+        goto freeBuffer;
+    }
+
+    /* Every frame carries at least one byte, so a message never has more frames than bytes. */
+    bitmapSize = (config->maxMessageSize + 7) / 8;
+    for (i = 0; i < config->slotCount; i++) {
+        receiver->slots[i].buffer = osalHandler->Malloc(config->maxMessageSize);
+        receiver->slots[i].frameBitmap = osalHandler->Malloc(bitmapSize);
+        if (receiver->slots[i].buffer == NULL || receiver->slots[i].frameBitmap == NULL) {
+            goto freeBuffer;
+        }
+    }
+
+    return DJI_ERROR_SYSTEM_MODULE_CODE_SUCCESS;
+
+freeBuffer:
+    DjiTest_DataStreamReceiverDeInit(receiver);
+
+    return DJI_ERROR_SYSTEM_MODULE_CODE_MEMORY_ALLOC_FAILED;
+}
+
+T_DjiReturnCode DjiTest_DataStreamReceiverDeInit(T_DjiTestDataStreamReceiver *receiver)
+{
+    T_DjiOsalHandler *osalHandler = DjiPlatform_GetOsalHandler();
+    uint32_t i;
+
+    if (receiver == NULL) {
+        return DJI_ERROR_SYSTEM_MODULE_CODE_INVALID_PARAMETER;
+    }
+
+    if (receiver->slots != NULL) {
+        for (i = 0; i < receiver->config.slotCount; i++) {
+            if (receiver->slots[i].buffer != NULL) {
+                osalHandler->Free(receiver->slots[i].buffer);
+            }
+            if (receiver->slots[i].frameBitmap != NULL) {
+                osalHandler->Free(receiver->slots[i].frameBitmap);
+            }
+        }
+        osalHandler->Free(receiver->slots);
+    }
+    if (receiver->decompressBuffer != NULL) {
+        osalHandler->Free(receiver->decompressBuffer);
+    }
+    memset(receiver, 0, sizeof(T_DjiTestDataStreamReceiver));
+
+    return DJI_ERROR_SYSTEM_MODULE_CODE_SUCCESS;
+}
+
+T_DjiReturnCode DjiTest_DataStreamReceiverInput(T_DjiTestDataStreamReceiver *receiver, const uint8_t *frame,
+                                                uint32_t len)
+{
+    T_DjiOsalHandler *osalHandler = DjiPlatform_GetOsalHandler();
+    T_DjiTestDataStreamFrameHeader header;
+    T_DjiTestDataStreamReassemblySlot *slot;
+    T_DjiTestDataStreamIov payload;
+    uint32_t crc;
+    uint32_t nowMs = 0;
+
+    if (receiver == NULL || receiver->slots == NULL || (frame == NULL && len > 0)) {
+        return DJI_ERROR_SYSTEM_MODULE_CODE_INVALID_PARAMETER;
+    }
+
+    receiver->statistics.frameCount++;
+
+    if (len < DJI_TEST_DATA_STREAM_FRAME_HEADER_SIZE) {
+        receiver->statistics.malformedCount++;
+        return DJI_ERROR_SYSTEM_MODULE_CODE_INVALID_PARAMETER;
+    }
+    memcpy(&header, frame, DJI_TEST_DATA_STREAM_FRAME_HEADER_SIZE);
+    if (header.magic != DJI_TEST_DATA_STREAM_FRAME_MAGIC || header.version != DJI_TEST_DATA_STREAM_FRAME_VERSION ||
+        header.payloadLen != len - DJI_TEST_DATA_STREAM_FRAME_HEADER_SIZE) {
+        receiver->statistics.malformedCount++;
+        return DJI_ERROR_SYSTEM_MODULE_CODE_INVALID_PARAMETER;
+    }
+
+    payload.data = frame + DJI_TEST_DATA_STREAM_FRAME_HEADER_SIZE;
+    payload.len = header.payloadLen;
+    crc = header.crc;
+    if (DjiTest_DataStreamFrameCrc(&header, &payload, 1) != crc) {
+        receiver->statistics.crcErrorCount++;
+        return DJI_ERROR_SYSTEM_MODULE_CODE_INVALID_PARAMETER;
+    }
+
+    if (!DjiTest_DataStreamCheckHeader(receiver, &header)) {
+        receiver->statistics.malformedCount++;
+        return DJI_ERROR_SYSTEM_MODULE_CODE_INVALID_PARAMETER;
+    }
+
+    osalHandler->GetTimeMs(&nowMs);
+    DjiTest_DataStreamExpireSlots(receiver, nowMs);
+
+    if (DjiTest_DataStreamIsCompleted(receiver, header.messageId)) {
+        receiver->statistics.duplicateCount++;
+        return DJI_ERROR_SYSTEM_MODULE_CODE_DUPLICATE;
+    }
+
+    slot = DjiTest_DataStreamGetSlot(receiver, &header, nowMs);
+    if (slot->frameCount != header.frameCount || slot->messageSize != header.messageSize ||
+        slot->originalSize != header.originalSize || slot->flags != header.flags) {
+        receiver->statistics.malformedCount++;
+        return DJI_ERROR_SYSTEM_MODULE_CODE_INVALID_PARAMETER;
+    }
+    if ((slot->frameBitmap[header.frameIndex / 8] & (1 << (header.frameIndex % 8))) != 0) {
+        receiver->statistics.duplicateCount++;
+        return DJI_ERROR_SYSTEM_MODULE_CODE_DUPLICATE;
+    }
+
+    slot->frameBitmap[header.frameIndex / 8] |= (uint8_t) (1 << (header.frameIndex % 8));
+    memcpy(slot->buffer + header.frameOffset, payload.data, header.payloadLen);
+    slot->receivedCount++;
+    slot->receivedBytes += header.payloadLen;
+    slot->lastFrameTimeMs = nowMs;
+    if (header.frameIndex < slot->nextFrameIndex) {
+        receiver->statistics.outOfOrderCount++;
+    } else {
+        slot->nextFrameIndex = header.frameIndex + 1;
+    }
+
+    if (slot->receivedCount == slot->frameCount) {
+        DjiTest_DataStreamCompleteSlot(receiver, slot);
+    }
+
+    return DJI_ERROR_SYSTEM_MODULE_CODE_SUCCESS;
+}
+
+void DjiTest_DataStreamReceiverGetStatistics(const T_DjiTestDataStreamReceiver *receiver,
+                                             T_DjiTestDataStreamReceiverStatistics *statistics)
+{
+    *statistics = receiver->statistics;
+}
+
+T_DjiReturnCode DjiTest_DataStreamLoopbackInit(T_DjiTestDataStreamLoopback *loopback,
+                                               T_DjiTestDataStreamReceiver *receiver, uint32_t reorderDepth)
+{
+    T_DjiOsalHandler *osalHandler = DjiPlatform_GetOsalHandler();
+
+    if (loopback == NULL || receiver == NULL) {
+        return DJI_ERROR_SYSTEM_MODULE_CODE_INVALID_PARAMETER;
+    }
+
+    memset(loopback, 0, sizeof(T_DjiTestDataStreamLoopback));
+    loopback->receiver = receiver;
+    loopback->reorderDepth = reorderDepth > 1 ? reorderDepth : 1;
+
+    loopback->heldFrames = osalHandler->Malloc(DJI_TEST_DATA_STREAM_FRAME_MAX_SIZE * loopback->reorderDepth);
+    loopback->heldLens = osalHandler->Malloc(sizeof(uint32_t) * loopback->reorderDepth);
+    if (loopback->heldFrames == NULL || loopback->heldLens == NULL) {
+        DjiTest_DataStreamLoopbackDeInit(loopback);
+        return DJI_ERROR_SYSTEM_MODULE_CODE_MEMORY_ALLOC_FAILED;
+    }
+
+    return DJI_ERROR_SYSTEM_MODULE_CODE_SUCCESS;
+}
+
+T_DjiReturnCode DjiTest_DataStreamLoopbackDeInit(T_DjiTestDataStreamLoopback *loopback)
+{
+    T_DjiOsalHandler *osalHandler = DjiPlatform_GetOsalHandler();
+
+    if (loopback == NULL) {
+        return DJI_ERROR_SYSTEM_MODULE_CODE_INVALID_PARAMETER;
+    }
+
+    if (loopback->heldFrames != NULL) {
+        osalHandler->Free(loopback->heldFrames);
+    }
+    if (loopback->heldLens != NULL) {
+        osalHandler->Free(loopback->heldLens);
+    }
+    memset(loopback, 0, sizeof(T_DjiTestDataStreamLoopback));
+
+    return DJI_ERROR_SYSTEM_MODULE_CODE_SUCCESS;
+}
+
+void DjiTest_DataStreamLoopbackGetChannel(T_DjiTestDataStreamLoopback *loopback, T_DjiTestDataStreamChannel *channel)
+{
+    channel->SendFrame = DjiTest_DataStreamLoopbackSendFrame;
+    channel->userData = loopback;
+}
+
+void DjiTest_DataStreamLoopbackFlush(T_DjiTestDataStreamLoopback *loopback)
+{
+    uint32_t index;
+
+    while (loopback->heldCount > 0) {
+        index = --loopback->heldCount;
+        DjiTest_DataStreamReceiverInput(loopback->receiver,
+                                        loopback->heldFrames + (size_t) index * DJI_TEST_DATA_STREAM_FRAME_MAX_SIZE,
+                                        loopback->heldLens[index]);
+    }
+}
+
+/* Private functions definition-----------------------------------------------*/
+static uint32_t DjiTest_DataStreamFrameCrc(T_DjiTestDataStreamFrameHeader *header, const T_DjiTestDataStreamIov *iov,
+                                           uint32_t iovCount)
+{
+    uint32_t crc;
+    uint32_t i;
+
+    header->crc = 0;
+    crc = UtilZip_Crc32(0, (const uint8_t *) header, DJI_TEST_DATA_STREAM_FRAME_HEADER_SIZE);
+    for (i = 0; i < iovCount; i++) {
+        crc = UtilZip_Crc32(crc, iov[i].data, iov[i].len);
+    }
+
+    return crc;
+}
+
+static T_DjiReturnCode DjiTest_DataStreamSendFrames(T_DjiTestDataStreamSender *sender,
+                                                    const T_DjiTestDataStreamIov *iov, uint32_t iovCount,
+                                                    uint32_t messageSize, uint32_t originalSize, uint8_t flags,
+                                                    uint32_t messageId)
+{
+    T_DjiTestDataStreamFrameHeader header;
+    T_DjiTestDataStreamIov frameIov[DJI_TEST_DATA_STREAM_IOV_MAX_NUM + 1];
+    uint32_t payloadMaxLen = sender->config.frameSize - DJI_TEST_DATA_STREAM_FRAME_HEADER_SIZE;
+    uint32_t frameCount;
+    uint32_t frameIndex;
+    uint32_t frameIovCount;
+    uint32_t payloadLen;
+    uint32_t remainLen;
+    uint32_t sliceLen;
+    uint32_t iovIndex = 0;
+    uint32_t iovOffset = 0;
+    T_DjiReturnCode returnCode;
+
+    frameCount = messageSize == 0 ? 1 : (uint32_t) (((uint64_t) messageSize + payloadMaxLen - 1) / payloadMaxLen);
+
+    memset(&header, 0, sizeof(header));
+    header.magic = DJI_TEST_DATA_STREAM_FRAME_MAGIC;
+    header.version = DJI_TEST_DATA_STREAM_FRAME_VERSION;
+    header.flags = flags;
+    header.messageId = messageId;
+    header.frameCount = frameCount;
+    header.messageSize = messageSize;
+    header.originalSize = originalSize;
+
+    for (frameIndex = 0; frameIndex < frameCount; frameIndex++) {
+        payloadLen = USER_UTIL_MIN(payloadMaxLen, messageSize - frameIndex * payloadMaxLen);
+
+        /* The payload is described by slices of the caller's pieces, the header is the only thing built here. */
+        frameIovCount = 1;
+        remainLen = payloadLen;
+        while (remainLen > 0 && iovIndex < iovCount) {
+            if (iovOffset == iov[iovIndex].len) {
+                iovIndex++;
+                iovOffset = 0;
+                continue;
+            }
+            sliceLen = USER_UTIL_MIN(remainLen, iov[iovIndex].len - iovOffset);
+            frameIov[frameIovCount].data = (const uint8_t *) iov[iovIndex].data + iovOffset;
+            frameIov[frameIovCount].len = sliceLen;
+            frameIovCount++;
+            iovOffset += sliceLen;
+            remainLen -= sliceLen;
+        }
+
+        header.frameIndex = frameIndex;
+        header.frameOffset = frameIndex * payloadMaxLen;
+        header.payloadLen = (uint16_t) payloadLen;
+        header.crc = DjiTest_DataStreamFrameCrc(&header, &frameIov[1], frameIovCount - 1);
+        frameIov[0].data = &header;
+        frameIov[0].len = DJI_TEST_DATA_STREAM_FRAME_HEADER_SIZE;
+
+        returnCode = sender->channel.SendFrame(sender->channel.userData, frameIov, frameIovCount,
+                                               DJI_TEST_DATA_STREAM_FRAME_HEADER_SIZE + payloadLen);
+        if (returnCode != DJI_ERROR_SYSTEM_MODULE_CODE_SUCCESS) {
+            USER_LOG_ERROR("Send frame %u/%u of message %u error: 0x%08llX.", frameIndex, frameCount, messageId,
+                           returnCode);
+            return returnCode;
+        }
+
+        sender->statistics.frameCount++;
+        sender->statistics.wireBytes += DJI_TEST_DATA_STREAM_FRAME_HEADER_SIZE + payloadLen;
+    }
+
+    return DJI_ERROR_SYSTEM_MODULE_CODE_SUCCESS;
+}
+
+static bool DjiTest_DataStreamCheckHeader(const T_DjiTestDataStreamReceiver *receiver,
+                                          const T_DjiTestDataStreamFrameHeader *header)
+{
+    if ((header->flags & ~DJI_TEST_DATA_STREAM_FLAG_COMPRESSED) != 0 || header->frameCount == 0 ||
+        header->frameIndex >= header->frameCount ||
+        header->messageSize > receiver->config.maxMessageSize ||
+        header->originalSize > receiver->config.maxMessageSize ||
+        header->frameCount > USER_UTIL_MAX(header->messageSize, 1) ||
+        (uint64_t) header->frameOffset + header->payloadLen > header->messageSize) {
+        return false;
+    }
+    if ((header->flags & DJI_TEST_DATA_STREAM_FLAG_COMPRESSED) == 0 && header->originalSize != header->messageSize) {
+        return false;
+    }
+    if (header->payloadLen == 0 && header->messageSize != 0) {
+        return false;
+    }
+
+    return true;
+}
+
+static bool DjiTest_DataStreamIsCompleted(const T_DjiTestDataStreamReceiver *receiver, uint32_t messageId)
+{
+    uint32_t count = USER_UTIL_MIN(receiver->completedCount, DJI_TEST_DATA_STREAM_COMPLETED_HISTORY_NUM);
+    uint32_t i;
+
+    for (i = 0; i < count; i++) {
+        if (receiver->completedIds[i] == messageId) {
+            return true;
+        }
+    }
+
+    return false;
+}
+
+static T_DjiTestDataStreamReassemblySlot *DjiTest_DataStreamGetSlot(T_DjiTestDataStreamReceiver *receiver,
+                                                                    const T_DjiTestDataStreamFrameHeader *header,
+                                                                    uint32_t nowMs)
+{
+    T_DjiTestDataStreamReassemblySlot *slot = NULL;
+    T_DjiTestDataStreamReassemblySlot *oldestSlot = NULL;
+    uint32_t i;
+
+    for (i = 0; i < receiver->config.slotCount; i++) {
+        if (receiver->slots[i].isUsed && receiver->slots[i].messageId == header->messageId) {
+            return &receiver->slots[i];
+        }
+    }
+
+    for (i = 0; i < receiver->config.slotCount; i++) {
+        if (!receiver->slots[i].isUsed) {
+            slot = &receiver->slots[i];
+            break;
+        }
+        if (oldestSlot == NULL || (int32_t) (receiver->slots[i].lastFrameTimeMs - oldestSlot->lastFrameTimeMs) < 0) {
+            oldestSlot = &receiver->slots[i];
+        }
+    }
+
+    /* All slots busy: the message that made no progress for the longest time is given up. */
+    if (slot == NULL) {
+        slot = oldestSlot;
+        receiver->statistics.droppedCount++;
+        USER_LOG_WARN("Drop incomplete message %u, %u/%u frames received.", slot->messageId, slot->receivedCount,
+                      slot->frameCount);
+    }
+
+    slot->isUsed = true;
+    slot->messageId = header->messageId;
+    slot->frameCount = header->frameCount;
+    slot->receivedCount = 0;
+    slot->receivedBytes = 0;
+    slot->nextFrameIndex = 0;
+    slot->messageSize = header->messageSize;
+    slot->originalSize = header->originalSize;
+    slot->flags = header->flags;
+    slot->lastFrameTimeMs = nowMs;
+    memset(slot->frameBitmap, 0, (header->frameCount + 7) / 8);
+
+    return slot;
+}
+
+static void DjiTest_DataStreamExpireSlots(T_DjiTestDataStreamReceiver *receiver, uint32_t nowMs)
+{
+    T_DjiTestDataStreamReassemblySlot *slot;
+    uint32_t i;
+
+    if (receiver->config.timeoutMs == 0) {
+        return;
+    }
+
+    for (i = 0; i < receiver->config.slotCount; i++) {
+        slot = &receiver->slots[i];
+        if (slot->isUsed && (int32_t) (nowMs - slot->lastFrameTimeMs) > (int32_t) receiver->config.timeoutMs) {
+            receiver->statistics.droppedCount++;
+            USER_LOG_WARN("Message %u timed out, %u/%u frames received.", slot->messageId, slot->receivedCount,
+                          slot->frameCount);
+            slot->isUsed = false;
+        }
+    }
+}
+
+static void DjiTest_DataStreamCompleteSlot(T_DjiTestDataStreamReceiver *receiver,
+                                           T_DjiTestDataStreamReassemblySlot *slot)
+{
+    const uint8_t *data = slot->buffer;
+    uint32_t len = slot->messageSize;
+    T_DjiReturnCode returnCode;
+
+    slot->isUsed = false;
+    receiver->completedIds[receiver->completedCount % DJI_TEST_DATA_STREAM_COMPLETED_HISTORY_NUM] = slot->messageId;
+    receiver->completedCount++;
+
+    /* Overlapping offsets would leave holes the bitmap cannot see. */
+    if (slot->receivedBytes != slot->messageSize) {
+        receiver->statistics.malformedCount++;
+        return;
+    }
+
+    if ((slot->flags & DJI_TEST_DATA_STREAM_FLAG_COMPRESSED) != 0) {
+        returnCode = UtilLz4_Decompress(slot->buffer, slot->messageSize, receiver->decompressBuffer,
+                                        receiver->config.maxMessageSize, &len);
+        if (returnCode != DJI_ERROR_SYSTEM_MODULE_CODE_SUCCESS || len != slot->originalSize) {
+            receiver->statistics.decompressErrorCount++;
+            USER_LOG_ERROR("Decompress message %u error: 0x%08llX.", slot->messageId, returnCode);
+            return;
+        }
+        data = receiver->decompressBuffer;
+    }
+
+    receiver->statistics.messageCount++;
+    receiver->statistics.messageBytes += len;
+    receiver->config.callback(receiver->config.userData, slot->messageId, data, len);
+}
+
+static T_DjiReturnCode DjiTest_DataStreamHighSpeedSendFrame(void *userData, const T_DjiTestDataStreamIov *iov,
+                                                            uint32_t iovCount, uint32_t frameLen)
+{
+    T_DjiOsalHandler *osalHandler = DjiPlatform_GetOsalHandler();
+    T_DjiReturnCode returnCode;
+    uint8_t *frame;
+
+    (void) userData;
+
+    /* The data stream takes one contiguous buffer, this is the single copy of an uncompressed message. */
+    frame = osalHandler->Malloc(frameLen);
+    if (frame == NULL) {
+        return DJI_ERROR_SYSTEM_MODULE_CODE_MEMORY_ALLOC_FAILED;
+    }
+    DjiTest_DataStreamGather(frame, iov, iovCount);
+
+    returnCode = DjiHighSpeedDataChannel_SendDataStreamData(frame, (uint16_t) frameLen);
+    osalHandler->Free(frame);
+
+    return returnCode;
+}
+
+static T_DjiReturnCode DjiTest_DataStreamLoopbackSendFrame(void *userData, const T_DjiTestDataStreamIov *iov,
+                                                           uint32_t iovCount, uint32_t frameLen)
+{
+    T_DjiTestDataStreamLoopback *loopback = userData;
+
+    DjiTest_DataStreamGather(loopback->heldFrames + (size_t) loopback->heldCount * DJI_TEST_DATA_STREAM_FRAME_MAX_SIZE,
+                             iov, iovCount);
+    loopback->heldLens[loopback->heldCount] = frameLen;
+    loopback->heldCount++;
+
+    if (loopback->heldCount == loopback->reorderDepth) {
+        DjiTest_DataStreamLoopbackFlush(loopback);
+    }
+
+    return DJI_ERROR_SYSTEM_MODULE_CODE_SUCCESS;
+}
+
+static void DjiTest_DataStreamGather(uint8_t *dst, const T_DjiTestDataStreamIov *iov, uint32_t iovCount)
+{
+    uint32_t i;
+
+    for (i = 0; i < iovCount; i++) {
+        memcpy(dst, iov[i].data, iov[i].len);
+        dst += iov[i].len;
+    }
+}
+
+#endif
+
+/****************** (C) COPYRIGHT DJI Innovations *****END OF FILE****/
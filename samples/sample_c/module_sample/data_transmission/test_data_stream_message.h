@@ -0,0 +1,219 @@
+/**
+ ********************************************************************
+ * @file    test_data_stream_message.h
+ * @brief   This is the header file for "test_data_stream_message.c", defining the structure and
+ * (exported) function prototypes.
+ *
+ * @copyright (c) 2021 DJI. All rights reserved.
+ *
+ * All information contained herein is, and remains, the property of DJI.
+ * The intellectual and technical concepts contained herein are proprietary
+ * to DJI and may be covered by U.S. and foreign patents, patents in process,
+ * and protected by trade secret or copyright law.  Dissemination of this
+ * information, including but not limited to data and other proprietary
+ * material(s) incorporated within the information, in any form, is strictly
+ * prohibited without the express written consent of DJI.
+ *
+ * If you receive this source code without DJI’s authorization, you may not
+ * further disseminate the information, and you must immediately remove the
+ * source code and notify DJI of its removal. DJI reserves the right to pursue
+ * legal actions against you for any loss(es) or damage(s) caused by your
+ * failure to do so.
+ *
+ *********************************************************************
+ */
+
+/* Define to prevent recursive inclusion -------------------------------------*/
+#ifndef TEST_DATA_STREAM_MESSAGE_H
+#define TEST_DATA_STREAM_MESSAGE_H
+
+/* Includes ------------------------------------------------------------------*/
+#include "dji_typedef.h"
+#include "dji_platform.h"
+#include "utils/util_lz4.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#ifdef SYSTEM_ARCH_LINUX
+
+/* Exported constants --------------------------------------------------------*/
+#define DJI_TEST_DATA_STREAM_FRAME_MAGIC            (0x4D44)
+#define DJI_TEST_DATA_STREAM_FRAME_VERSION          (1)
+#define DJI_TEST_DATA_STREAM_FRAME_HEADER_SIZE      (36)
+/* Limit of DjiHighSpeedDataChannel_SendDataStreamData. */
+#define DJI_TEST_DATA_STREAM_FRAME_MAX_SIZE         (65000)
+#define DJI_TEST_DATA_STREAM_IOV_MAX_NUM            (16)
+#define DJI_TEST_DATA_STREAM_COMPLETED_HISTORY_NUM  (16)
+
+#define DJI_TEST_DATA_STREAM_FLAG_COMPRESSED        (0x01)
+
+/* Exported types ------------------------------------------------------------*/
+/**
+ * @brief Header in front of every frame, all fields little endian.
+ * @note The crc covers the header with the crc field zeroed, followed by the payload.
+ */
+#pragma pack(1)
+typedef struct {
+    uint16_t magic;
+    uint8_t version;
+    uint8_t flags;
+    uint32_t messageId;
+    uint32_t frameIndex;
+    uint32_t frameCount;
+    uint32_t frameOffset;           /*!< Position of this payload in the transmitted message. */
+    uint32_t messageSize;           /*!< Transmitted size, the compressed size for compressed messages. */
+    uint32_t originalSize;          /*!< Size handed to the receiver callback. */
+    uint16_t payloadLen;
+    uint16_t reserved;
+    uint32_t crc;
+} T_DjiTestDataStreamFrameHeader;
+#pragma pack()
+
+typedef struct {
+    const void *data;
+    uint32_t len;
+} T_DjiTestDataStreamIov;
+
+/**
+ * @brief Frame sink, the real data stream, a loopback or a socket. A frame is handed over as gathered pieces, the
+ * first one being the header.
+ */
+typedef struct {
+    T_DjiReturnCode (*SendFrame)(void *userData, const T_DjiTestDataStreamIov *iov, uint32_t iovCount,
+                                 uint32_t frameLen);
+    void *userData;
+} T_DjiTestDataStreamChannel;
+
+typedef struct {
+    uint32_t frameSize;             /*!< Header plus payload of a full frame, at most the data stream limit. */
+    uint32_t maxMessageSize;        /*!< Bounds the compression buffers, 0 disables compression. */
+} T_DjiTestDataStreamSenderConfig;
+
+typedef struct {
+    uint32_t messageCount;
+    uint32_t compressedCount;       /*!< Messages sent compressed, the others did not shrink or were not asked to. */
+    uint32_t frameCount;
+    uint32_t failedCount;           /*!< Messages abandoned after a frame was rejected by the channel. */
+    uint64_t messageBytes;          /*!< Bytes before compression. */
+    uint64_t wireBytes;             /*!< Bytes of all frames including headers. */
+} T_DjiTestDataStreamSenderStatistics;
+
+/**
+ * @brief Splits messages of any size into checksummed frames of at most frameSize bytes.
+ * @note Uncompressed messages are never copied by the sender: each frame is passed to the channel as the header and
+ * the slices of the caller's pieces it covers. Compressed messages are gathered and compressed into an internal
+ * buffer first. Send calls are serialized by a mutex.
+ */
+typedef struct {
+    T_DjiTestDataStreamSenderConfig config;
+    T_DjiTestDataStreamChannel channel;
+    T_DjiMutexHandle mutex;
+    uint32_t nextMessageId;
+    uint8_t *gatherBuffer;
+    uint8_t *compressBuffer;
+    T_UtilLz4Encoder *encoder;
+    T_DjiTestDataStreamSenderStatistics statistics;
+} T_DjiTestDataStreamSender;
+
+typedef void (*DjiTestDataStreamMessageCallback)(void *userData, uint32_t messageId, const uint8_t *data,
+                                                 uint32_t len);
+
+typedef struct {
+    uint32_t maxMessageSize;        /*!< Larger messages are rejected on their first frame. */
+    uint32_t slotCount;             /*!< Messages reassembled at the same time. */
+    uint32_t timeoutMs;             /*!< An incomplete message is dropped when no frame arrived for this long. */
+    DjiTestDataStreamMessageCallback callback;
+    void *userData;
+} T_DjiTestDataStreamReceiverConfig;
+
+typedef struct {
+    uint32_t frameCount;
+    uint32_t crcErrorCount;
+    uint32_t malformedCount;        /*!< Bad magic, version, sizes or offsets. */
+    uint32_t duplicateCount;
+    uint32_t outOfOrderCount;       /*!< Frames that arrived after a higher index of the same message. */
+    uint32_t messageCount;
+    uint32_t droppedCount;          /*!< Incomplete messages that timed out or were evicted by newer ones. */
+    uint32_t decompressErrorCount;
+    uint64_t messageBytes;
+} T_DjiTestDataStreamReceiverStatistics;
+
+typedef struct {
+    bool isUsed;
+    uint32_t messageId;
+    uint32_t frameCount;
+    uint32_t receivedCount;
+    uint32_t receivedBytes;
+    uint32_t nextFrameIndex;        /*!< Highest index seen plus one, for the out-of-order statistics. */
+    uint32_t messageSize;
+    uint32_t originalSize;
+    uint8_t flags;
+    uint32_t lastFrameTimeMs;
+    uint8_t *buffer;
+    uint8_t *frameBitmap;
+} T_DjiTestDataStreamReassemblySlot;
+
+/**
+ * @brief Rebuilds messages from frames arriving in any order, with duplicates and with losses.
+ * @note A frame is copied once, straight to its place in the message buffer, and a bitmap tracks which frames are
+ * present. The ids of recently completed messages are remembered so late duplicates do not start a new message.
+ * Input is not thread-safe, feed it from one receiving task.
+ */
+typedef struct {
+    T_DjiTestDataStreamReceiverConfig config;
+    T_DjiTestDataStreamReassemblySlot *slots;
+    uint8_t *decompressBuffer;
+    uint32_t completedIds[DJI_TEST_DATA_STREAM_COMPLETED_HISTORY_NUM];
+    uint32_t completedCount;
+    T_DjiTestDataStreamReceiverStatistics statistics;
+} T_DjiTestDataStreamReceiver;
+
+/**
+ * @brief Channel stand-in that hands frames to a receiver, optionally in reversed groups to exercise reordering.
+ */
+typedef struct {
+    T_DjiTestDataStreamReceiver *receiver;
+    uint32_t reorderDepth;          /*!< Frames held back and delivered last first, 0 or 1 keeps the order. */
+    uint32_t heldCount;
+    uint8_t *heldFrames;
+    uint32_t *heldLens;
+} T_DjiTestDataStreamLoopback;
+
+/* Exported functions --------------------------------------------------------*/
+void DjiTest_DataStreamGetDataStreamChannel(T_DjiTestDataStreamChannel *channel);
+
+void DjiTest_DataStreamSenderGetDefaultConfig(T_DjiTestDataStreamSenderConfig *config);
+T_DjiReturnCode DjiTest_DataStreamSenderInit(T_DjiTestDataStreamSender *sender,
+                                             const T_DjiTestDataStreamSenderConfig *config,
+                                             const T_DjiTestDataStreamChannel *channel);
+T_DjiReturnCode DjiTest_DataStreamSenderDeInit(T_DjiTestDataStreamSender *sender);
+T_DjiReturnCode DjiTest_DataStreamSendMessage(T_DjiTestDataStreamSender *sender, const T_DjiTestDataStreamIov *iov,
+                                              uint32_t iovCount, uint32_t flags, uint32_t *messageId);
+void DjiTest_DataStreamSenderGetStatistics(T_DjiTestDataStreamSender *sender,
+                                           T_DjiTestDataStreamSenderStatistics *statistics);
+
+void DjiTest_DataStreamReceiverGetDefaultConfig(T_DjiTestDataStreamReceiverConfig *config);
+T_DjiReturnCode DjiTest_DataStreamReceiverInit(T_DjiTestDataStreamReceiver *receiver,
+                                               const T_DjiTestDataStreamReceiverConfig *config);
+T_DjiReturnCode DjiTest_DataStreamReceiverDeInit(T_DjiTestDataStreamReceiver *receiver);
+T_DjiReturnCode DjiTest_DataStreamReceiverInput(T_DjiTestDataStreamReceiver *receiver, const uint8_t *frame,
+                                                uint32_t len);
+void DjiTest_DataStreamReceiverGetStatistics(const T_DjiTestDataStreamReceiver *receiver,
+                                             T_DjiTestDataStreamReceiverStatistics *statistics);
+
+T_DjiReturnCode DjiTest_DataStreamLoopbackInit(T_DjiTestDataStreamLoopback *loopback,
+                                               T_DjiTestDataStreamReceiver *receiver, uint32_t reorderDepth);
+T_DjiReturnCode DjiTest_DataStreamLoopbackDeInit(T_DjiTestDataStreamLoopback *loopback);
+void DjiTest_DataStreamLoopbackGetChannel(T_DjiTestDataStreamLoopback *loopback, T_DjiTestDataStreamChannel *channel);
+void DjiTest_DataStreamLoopbackFlush(T_DjiTestDataStreamLoopback *loopback);
+
+#endif
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // TEST_DATA_STREAM_MESSAGE_H
+/************************ (C) COPYRIGHT DJI Innovations *******END OF FILE******/
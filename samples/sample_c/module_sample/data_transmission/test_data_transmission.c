@@ -32,10 +32,15 @@
 #include "dji_high_speed_data_channel.h"
 #include "dji_aircraft_info.h"
 #include "widget_interaction_test/test_widget_interaction.h"
+#include "test_data_transmission_scheduler.h"
+#include "test_data_stream_message.h"
 
 /* Private constants ---------------------------------------------------------*/
 #define DATA_TRANSMISSION_TASK_FREQ         (1)
 #define DATA_TRANSMISSION_TASK_STACK_SIZE   (2048)
+#define DATA_TRANSMISSION_SCHEDULE_PERIOD_MS (20)
+#define DATA_TRANSMISSION_TEST_DATA_TOPIC   (1)
+#define DATA_TRANSMISSION_STREAM_MESSAGE_MAX_SIZE   (1024 * 1024)
 
 /* Private types -------------------------------------------------------------*/
 typedef struct {
@@ -45,6 +50,8 @@ typedef struct {
 
 /* Private functions declaration ---------------------------------------------*/
 static void *UserDataTransmission_Task(void *arg);
+static void UserDataTransmission_SendTestData(void);
+static void UserDataTransmission_LogTxStatistics(void);
 static T_DjiReturnCode ReceiveDataFromMobile(const uint8_t *data, uint16_t len);
 static T_DjiReturnCode ReceiveDataFromCloud(const uint8_t *data, uint16_t len);
 static T_DjiReturnCode ReceiveDataFromExtensionPort(const uint8_t *data, uint16_t len);
@@ -61,6 +68,10 @@ static T_DjiReturnCode ReceiveDataFromPayload8(const uint8_t *data, uint16_t len
 /* Private variables ---------------------------------------------------------*/
 static T_DjiTaskHandle s_userDataTransmissionThread;
 static T_DjiAircraftInfoBaseInfo s_aircraftInfoBaseInfo;
+static T_DjiTestDataTxScheduler s_dataTxScheduler;
+#ifdef SYSTEM_ARCH_LINUX
+static T_DjiTestDataStreamSender s_dataStreamSender;
+#endif
 
 static const ChannelCallbackEntry g_channelCallbacks[] = {
     {DJI_CHANNEL_ADDRESS_PAYLOAD_PORT_NO1, ReceiveDataFromPayload1},
@@ -78,6 +89,12 @@ T_DjiReturnCode DjiTest_DataTransmissionStartService(void)
     T_DjiReturnCode djiStat;
     T_DjiOsalHandler *osalHandler = DjiPlatform_GetOsalHandler();
     E_DjiChannelAddress channelAddress;
+    T_DjiTestDataTxSchedulerConfig schedulerConfig;
+    T_DjiTestDataTxChannel txChannel;
+#ifdef SYSTEM_ARCH_LINUX
+    T_DjiTestDataStreamSenderConfig streamSenderConfig;
+    T_DjiTestDataStreamChannel streamChannel;
+#endif
     const T_DjiDataChannelBandwidthProportionOfHighspeedChannel bandwidthProportionOfHighspeedChannel =
         {10, 60, 30};
     char ipAddr[DJI_IP_ADDR_STR_SIZE_MAX];
@@ -153,6 +170,17 @@ T_DjiReturnCode DjiTest_DataTransmissionStartService(void)
             USER_LOG_ERROR("get data stream remote address error.");
         }
 
+#ifdef SYSTEM_ARCH_LINUX
+        DjiTest_DataStreamSenderGetDefaultConfig(&streamSenderConfig);
+        streamSenderConfig.maxMessageSize = DATA_TRANSMISSION_STREAM_MESSAGE_MAX_SIZE;
+        DjiTest_DataStreamGetDataStreamChannel(&streamChannel);
+        djiStat = DjiTest_DataStreamSenderInit(&s_dataStreamSender, &streamSenderConfig, &streamChannel);
+        if (djiStat != DJI_ERROR_SYSTEM_MODULE_CODE_SUCCESS) {
+            USER_LOG_ERROR("init data stream sender error, stat = 0x%08llX", djiStat);
+            return djiStat;
+        }
+#endif
+
     } else if (s_aircraftInfoBaseInfo.mountPosition == DJI_MOUNT_POSITION_EXTENSION_PORT
                 || DJI_MOUNT_POSITION_EXTENSION_LITE_PORT == s_aircraftInfoBaseInfo.mountPosition) {
         channelAddress = DJI_CHANNEL_ADDRESS_PAYLOAD_PORT_NO1;
@@ -179,10 +207,19 @@ T_DjiReturnCode DjiTest_DataTransmissionStartService(void)
         return DJI_ERROR_SYSTEM_MODULE_CODE_NONSUPPORT;
     }
 
+    DjiTest_DataTxSchedulerGetDefaultConfig(&schedulerConfig);
+    DjiTest_DataTxSchedulerGetLowSpeedChannel(&txChannel);
+    djiStat = DjiTest_DataTxSchedulerInit(&s_dataTxScheduler, &schedulerConfig, &txChannel);
+    if (djiStat != DJI_ERROR_SYSTEM_MODULE_CODE_SUCCESS) {
+        USER_LOG_ERROR("init data transmission scheduler error, stat = 0x%08llX", djiStat);
+        return djiStat;
+    }
+
     if (osalHandler->TaskCreate("user_transmission_task", UserDataTransmission_Task,
                                 DATA_TRANSMISSION_TASK_STACK_SIZE, NULL, &s_userDataTransmissionThread) !=
         DJI_ERROR_SYSTEM_MODULE_CODE_SUCCESS) {
         USER_LOG_ERROR("user data transmission task create error.");
+        DjiTest_DataTxSchedulerDeInit(&s_dataTxScheduler);
         return DJI_ERROR_SYSTEM_MODULE_CODE_UNKNOWN;
     }
 
@@ -199,6 +236,17 @@ T_DjiReturnCode DjiTest_DataTransmissionStopService(void)
         return DJI_ERROR_SYSTEM_MODULE_CODE_UNKNOWN;
     }
 
+    returnCode = DjiTest_DataTxSchedulerDeInit(&s_dataTxScheduler);
+    if (returnCode != DJI_ERROR_SYSTEM_MODULE_CODE_SUCCESS) {
+        USER_LOG_ERROR("deinit data transmission scheduler error.");
+    }
+
+#ifdef SYSTEM_ARCH_LINUX
+    if (s_dataStreamSender.mutex != NULL) {
+        DjiTest_DataStreamSenderDeInit(&s_dataStreamSender);
+    }
+#endif
+
     returnCode = DjiLowSpeedDataChannel_DeInit();
     if (returnCode != DJI_ERROR_SYSTEM_MODULE_CODE_SUCCESS) {
         USER_LOG_ERROR("deinit data transmission module error.");
@@ -208,6 +256,40 @@ T_DjiReturnCode DjiTest_DataTransmissionStopService(void)
     return DJI_ERROR_SYSTEM_MODULE_CODE_SUCCESS;
 }
 
+/**
+ * @brief Queue data for the low speed channel, it is sent by the data transmission task in priority order.
+ * @note Use DJI_TEST_DATA_TX_CLASS_COMMAND for data that must not wait behind telemetry, and a non-zero topic for
+ * values where only the newest one matters.
+ */
+T_DjiReturnCode DjiTest_DataTransmissionSendLowSpeedData(E_DjiChannelAddress channelAddress,
+                                                         E_DjiTestDataTxClass txClass, uint16_t topic,
+                                                         const uint8_t *data, uint8_t len)
+{
+    return DjiTest_DataTxSchedulerEnqueue(&s_dataTxScheduler, channelAddress, txClass, topic, data, len);
+}
+
+void DjiTest_DataTransmissionGetTxStatistics(T_DjiTestDataTxStatistics *statistics)
+{
+    DjiTest_DataTxSchedulerGetStatistics(&s_dataTxScheduler, statistics);
+}
+
+#ifdef SYSTEM_ARCH_LINUX
+/**
+ * @brief Send a message of any size through the data stream, split into checksummed frames the receiver reassembles.
+ * @note The pieces are framed without being copied together first. Pass DJI_TEST_DATA_STREAM_FLAG_COMPRESSED to
+ * compress messages of up to 1MB with LZ4. Only available when mounted on a payload port.
+ */
+T_DjiReturnCode DjiTest_DataTransmissionSendStreamMessage(const T_DjiTestDataStreamIov *iov, uint32_t iovCount,
+                                                          uint32_t flags)
+{
+    if (s_dataStreamSender.mutex == NULL) {
+        return DJI_ERROR_SYSTEM_MODULE_CODE_NONSUPPORT_IN_CURRENT_STATE;
+    }
+
+    return DjiTest_DataStreamSendMessage(&s_dataStreamSender, iov, iovCount, flags, NULL);
+}
+#endif
+
 /* Private functions definition-----------------------------------------------*/
 #ifndef __CC_ARM
 #pragma GCC diagnostic push
@@ -217,131 +299,144 @@ T_DjiReturnCode DjiTest_DataTransmissionStopService(void)
 
 static void *UserDataTransmission_Task(void *arg)
 {
-    T_DjiReturnCode djiStat;
-    const uint8_t dataToBeSent[] = "DJI Data Transmission Test Data.";
-    T_DjiDataChannelState state = {0};
     T_DjiOsalHandler *osalHandler = DjiPlatform_GetOsalHandler();
-    E_DjiChannelAddress channelAddress;
+    uint32_t nowMs = 0;
+    uint32_t lastTestDataTimeMs = 0;
 
     USER_UTIL_UNUSED(arg);
 
-    while (1) {
-        osalHandler->TaskSleepMs(1000 / DATA_TRANSMISSION_TASK_FREQ);
+    osalHandler->GetTimeMs(&lastTestDataTimeMs);
 
-        channelAddress = DJI_CHANNEL_ADDRESS_MASTER_RC_APP;
-        djiStat = DjiLowSpeedDataChannel_SendData(channelAddress, dataToBeSent, sizeof(dataToBeSent));
-        if (djiStat != DJI_ERROR_SYSTEM_MODULE_CODE_SUCCESS)
-            USER_LOG_ERROR("send data to mobile error.");
+    while (1) {
+        osalHandler->TaskSleepMs(DATA_TRANSMISSION_SCHEDULE_PERIOD_MS);
+        osalHandler->GetTimeMs(&nowMs);
 
-        djiStat = DjiLowSpeedDataChannel_GetSendDataState(channelAddress, &state);
-        if (djiStat == DJI_ERROR_SYSTEM_MODULE_CODE_SUCCESS) {
-            USER_LOG_DEBUG(
-                "send to mobile state: realtimeBandwidthBeforeFlowController: %d, realtimeBandwidthAfterFlowController: %d, busyState: %d.",
-                state.realtimeBandwidthBeforeFlowController, state.realtimeBandwidthAfterFlowController,
-                state.busyState);
-        } else {
-            USER_LOG_ERROR("get send to mobile channel state error.");
+        if (nowMs - lastTestDataTimeMs >= 1000 / DATA_TRANSMISSION_TASK_FREQ) {
+            lastTestDataTimeMs = nowMs;
+            UserDataTransmission_SendTestData();
+            UserDataTransmission_LogTxStatistics();
         }
 
-        if (s_aircraftInfoBaseInfo.aircraftType == DJI_AIRCRAFT_TYPE_M30  ||
-            s_aircraftInfoBaseInfo.aircraftType == DJI_AIRCRAFT_TYPE_M30T ||
-            s_aircraftInfoBaseInfo.aircraftType == DJI_AIRCRAFT_TYPE_M3D  ||
-            s_aircraftInfoBaseInfo.aircraftType == DJI_AIRCRAFT_TYPE_M3TD ||
-            s_aircraftInfoBaseInfo.aircraftType == DJI_AIRCRAFT_TYPE_M4D  ||
-            s_aircraftInfoBaseInfo.aircraftType == DJI_AIRCRAFT_TYPE_M4TD ) {
-            channelAddress = DJI_CHANNEL_ADDRESS_CLOUD_API;
-            djiStat = DjiLowSpeedDataChannel_SendData(channelAddress, dataToBeSent, sizeof(dataToBeSent));
-            if (djiStat != DJI_ERROR_SYSTEM_MODULE_CODE_SUCCESS)
-                USER_LOG_ERROR("send data to cloud error.");
-
-            djiStat = DjiLowSpeedDataChannel_GetSendDataState(channelAddress, &state);
-            if (djiStat == DJI_ERROR_SYSTEM_MODULE_CODE_SUCCESS) {
-                USER_LOG_DEBUG(
-                    "send to cloud state: realtimeBandwidthBeforeFlowController: %d, realtimeBandwidthAfterFlowController: %d, busyState: %d.",
-                    state.realtimeBandwidthBeforeFlowController, state.realtimeBandwidthAfterFlowController,
-                    state.busyState);
-            } else {
-                USER_LOG_ERROR("get send to cloud channel state error.");
-            }
-        }
+        DjiTest_DataTxSchedulerProcess(&s_dataTxScheduler);
+    }
+}
 
-        if (s_aircraftInfoBaseInfo.aircraftType == DJI_AIRCRAFT_TYPE_M400){
-            /*!< Code Example for Data Transmission Between PSDK and PSDK. */
-            /*!< Only support Psdk on M400. */
-            /*
-            channelAddress = DJI_CHANNEL_ADDRESS_EXTENSION_PORT_V2_NO1;
-            djiStat = DjiLowSpeedDataChannel_SendData(channelAddress, dataToBeSent, sizeof(dataToBeSent));
-            if (djiStat != DJI_ERROR_SYSTEM_MODULE_CODE_SUCCESS)
-                USER_LOG_ERROR("send data to psdk error port1.");
-
-            djiStat = DjiLowSpeedDataChannel_GetSendDataState(channelAddress, &state);
-            if (djiStat == DJI_ERROR_SYSTEM_MODULE_CODE_SUCCESS) {
-                USER_LOG_DEBUG(
-                    "send to psdk state: realtimeBandwidthBeforeFlowController: %d, realtimeBandwidthAfterFlowController: %d, busyState: %d.",
-                    state.realtimeBandwidthBeforeFlowController, state.realtimeBandwidthAfterFlowController,
-                    state.busyState);
-            } else {
-                USER_LOG_ERROR("get send to psdk channel state error.");
-            }
-            */
-        }else{
-            if (s_aircraftInfoBaseInfo.mountPosition == DJI_MOUNT_POSITION_PAYLOAD_PORT_NO1 ||
-                s_aircraftInfoBaseInfo.mountPosition == DJI_MOUNT_POSITION_PAYLOAD_PORT_NO2 ||
-                s_aircraftInfoBaseInfo.mountPosition == DJI_MOUNT_POSITION_PAYLOAD_PORT_NO3) {
-                channelAddress = DJI_CHANNEL_ADDRESS_EXTENSION_PORT;
-                djiStat = DjiLowSpeedDataChannel_SendData(channelAddress, dataToBeSent, sizeof(dataToBeSent));
-                if (djiStat != DJI_ERROR_SYSTEM_MODULE_CODE_SUCCESS)
-                    USER_LOG_ERROR("send data to extension port error.");
+#ifndef __CC_ARM
+#pragma GCC diagnostic pop
+#endif
 
-                djiStat = DjiLowSpeedDataChannel_GetSendDataState(channelAddress, &state);
-                if (djiStat == DJI_ERROR_SYSTEM_MODULE_CODE_SUCCESS) {
-                    USER_LOG_DEBUG(
-                        "send to extension port state: realtimeBandwidthBeforeFlowController: %d, realtimeBandwidthAfterFlowController: %d, busyState: %d.",
-                        state.realtimeBandwidthBeforeFlowController, state.realtimeBandwidthAfterFlowController,
-                        state.busyState);
-                } else {
-                    USER_LOG_ERROR("get send to extension port channel state error.");
-                }
+/**
+ * @brief Queue the test data as a latest-value status, a queued copy not yet sent is replaced instead of piling up.
+ */
+static void UserDataTransmission_SendTestData(void)
+{
+    T_DjiReturnCode djiStat;
+    const uint8_t dataToBeSent[] = "DJI Data Transmission Test Data.";
+#ifdef SYSTEM_ARCH_LINUX
+    const T_DjiTestDataStreamIov streamIov = {dataToBeSent, sizeof(dataToBeSent)};
+#endif
+    T_DjiDataChannelState state = {0};
+    E_DjiChannelAddress channelAddress;
 
-                if (DjiPlatform_GetSocketHandler() != NULL) {
-    #ifdef SYSTEM_ARCH_LINUX
-                    djiStat = DjiHighSpeedDataChannel_SendDataStreamData(dataToBeSent, sizeof(dataToBeSent));
-                    if (djiStat != DJI_ERROR_SYSTEM_MODULE_CODE_SUCCESS)
-                        USER_LOG_ERROR("send data to data stream error.");
-
-                    djiStat = DjiHighSpeedDataChannel_GetDataStreamState(&state);
-                    if (djiStat == DJI_ERROR_SYSTEM_MODULE_CODE_SUCCESS) {
-                        USER_LOG_DEBUG(
-                            "data stream state: realtimeBandwidthLimit: %d, realtimeBandwidthBeforeFlowController: %d, busyState: %d.",
-                            state.realtimeBandwidthLimit, state.realtimeBandwidthBeforeFlowController, state.busyState);
-                    } else {
-                        USER_LOG_ERROR("get data stream state error.");
-                    }
-    #endif
-                }
-            } else if (s_aircraftInfoBaseInfo.mountPosition == DJI_MOUNT_POSITION_EXTENSION_PORT) {
-                channelAddress = DJI_CHANNEL_ADDRESS_PAYLOAD_PORT_NO1;
-                djiStat = DjiLowSpeedDataChannel_SendData(channelAddress, dataToBeSent, sizeof(dataToBeSent));
+    USER_UTIL_UNUSED(state);
+
+    channelAddress = DJI_CHANNEL_ADDRESS_MASTER_RC_APP;
+    djiStat = DjiTest_DataTransmissionSendLowSpeedData(channelAddress, DJI_TEST_DATA_TX_CLASS_STATUS,
+                                                       DATA_TRANSMISSION_TEST_DATA_TOPIC, dataToBeSent,
+                                                       sizeof(dataToBeSent));
+    if (djiStat != DJI_ERROR_SYSTEM_MODULE_CODE_SUCCESS)
+        USER_LOG_ERROR("send data to mobile error.");
+
+    if (s_aircraftInfoBaseInfo.aircraftType == DJI_AIRCRAFT_TYPE_M30  ||
+        s_aircraftInfoBaseInfo.aircraftType == DJI_AIRCRAFT_TYPE_M30T ||
+        s_aircraftInfoBaseInfo.aircraftType == DJI_AIRCRAFT_TYPE_M3D  ||
+        s_aircraftInfoBaseInfo.aircraftType == DJI_AIRCRAFT_TYPE_M3TD ||
+        s_aircraftInfoBaseInfo.aircraftType == DJI_AIRCRAFT_TYPE_M4D  ||
+        s_aircraftInfoBaseInfo.aircraftType == DJI_AIRCRAFT_TYPE_M4TD ) {
+        channelAddress = DJI_CHANNEL_ADDRESS_CLOUD_API;
+        djiStat = DjiTest_DataTransmissionSendLowSpeedData(channelAddress, DJI_TEST_DATA_TX_CLASS_STATUS,
+                                                           DATA_TRANSMISSION_TEST_DATA_TOPIC, dataToBeSent,
+                                                           sizeof(dataToBeSent));
+        if (djiStat != DJI_ERROR_SYSTEM_MODULE_CODE_SUCCESS)
+            USER_LOG_ERROR("send data to cloud error.");
+    }
+
+    if (s_aircraftInfoBaseInfo.aircraftType == DJI_AIRCRAFT_TYPE_M400){
+        /*!< Code Example for Data Transmission Between PSDK and PSDK. */
+        /*!< Only support Psdk on M400. */
+        /*
+        channelAddress = DJI_CHANNEL_ADDRESS_EXTENSION_PORT_V2_NO1;
+        djiStat = DjiTest_DataTransmissionSendLowSpeedData(channelAddress, DJI_TEST_DATA_TX_CLASS_STATUS,
+                                                           DATA_TRANSMISSION_TEST_DATA_TOPIC, dataToBeSent,
+                                                           sizeof(dataToBeSent));
+        if (djiStat != DJI_ERROR_SYSTEM_MODULE_CODE_SUCCESS)
+            USER_LOG_ERROR("send data to psdk error port1.");
+        */
+    }else{
+        if (s_aircraftInfoBaseInfo.mountPosition == DJI_MOUNT_POSITION_PAYLOAD_PORT_NO1 ||
+            s_aircraftInfoBaseInfo.mountPosition == DJI_MOUNT_POSITION_PAYLOAD_PORT_NO2 ||
+            s_aircraftInfoBaseInfo.mountPosition == DJI_MOUNT_POSITION_PAYLOAD_PORT_NO3) {
+            channelAddress = DJI_CHANNEL_ADDRESS_EXTENSION_PORT;
+            djiStat = DjiTest_DataTransmissionSendLowSpeedData(channelAddress, DJI_TEST_DATA_TX_CLASS_STATUS,
+                                                               DATA_TRANSMISSION_TEST_DATA_TOPIC, dataToBeSent,
+                                                               sizeof(dataToBeSent));
+            if (djiStat != DJI_ERROR_SYSTEM_MODULE_CODE_SUCCESS)
+                USER_LOG_ERROR("send data to extension port error.");
+
+            if (DjiPlatform_GetSocketHandler() != NULL) {
+#ifdef SYSTEM_ARCH_LINUX
+                djiStat = DjiTest_DataTransmissionSendStreamMessage(&streamIov, 1, 0);
                 if (djiStat != DJI_ERROR_SYSTEM_MODULE_CODE_SUCCESS)
-                    USER_LOG_ERROR("send data to extension port error.");
+                    USER_LOG_ERROR("send data to data stream error.");
 
-                djiStat = DjiLowSpeedDataChannel_GetSendDataState(channelAddress, &state);
+                djiStat = DjiHighSpeedDataChannel_GetDataStreamState(&state);
                 if (djiStat == DJI_ERROR_SYSTEM_MODULE_CODE_SUCCESS) {
                     USER_LOG_DEBUG(
-                        "send to extension port state: realtimeBandwidthBeforeFlowController: %d, realtimeBandwidthAfterFlowController: %d, busyState: %d.",
-                        state.realtimeBandwidthBeforeFlowController, state.realtimeBandwidthAfterFlowController,
-                        state.busyState);
+                        "data stream state: realtimeBandwidthLimit: %d, realtimeBandwidthBeforeFlowController: %d, busyState: %d.",
+                        state.realtimeBandwidthLimit, state.realtimeBandwidthBeforeFlowController, state.busyState);
                 } else {
-                    USER_LOG_ERROR("get send to extension port channel state error.");
+                    USER_LOG_ERROR("get data stream state error.");
                 }
+#endif
             }
+        } else if (s_aircraftInfoBaseInfo.mountPosition == DJI_MOUNT_POSITION_EXTENSION_PORT) {
+            channelAddress = DJI_CHANNEL_ADDRESS_PAYLOAD_PORT_NO1;
+            djiStat = DjiTest_DataTransmissionSendLowSpeedData(channelAddress, DJI_TEST_DATA_TX_CLASS_STATUS,
+                                                               DATA_TRANSMISSION_TEST_DATA_TOPIC, dataToBeSent,
+                                                               sizeof(dataToBeSent));
+            if (djiStat != DJI_ERROR_SYSTEM_MODULE_CODE_SUCCESS)
+                USER_LOG_ERROR("send data to extension port error.");
         }
     }
 }
 
-#ifndef __CC_ARM
-#pragma GCC diagnostic pop
-#endif
+static void UserDataTransmission_LogTxStatistics(void)
+{
+    T_DjiTestDataTxStatistics statistics;
+    const T_DjiTestDataTxClassStatistics *classStatistics;
+    uint32_t i;
+
+    DjiTest_DataTransmissionGetTxStatistics(&statistics);
+
+    for (i = 0; i < statistics.destinationCount; i++) {
+        USER_LOG_DEBUG("low speed channel %d: rate %d byte/s, queued %d/%d/%d, congestion %d.",
+                       statistics.destinations[i].channelAddress, statistics.destinations[i].rate,
+                       statistics.destinations[i].queuedCount[DJI_TEST_DATA_TX_CLASS_COMMAND],
+                       statistics.destinations[i].queuedCount[DJI_TEST_DATA_TX_CLASS_STATUS],
+                       statistics.destinations[i].queuedCount[DJI_TEST_DATA_TX_CLASS_BULK],
+                       statistics.destinations[i].congestionCount);
+    }
+
+    for (i = 0; i < DJI_TEST_DATA_TX_CLASS_NUM; i++) {
+        classStatistics = &statistics.classes[i];
+        USER_LOG_DEBUG("low speed class %d: sent %d, coalesced %d, dropped %d, failed %d, latency avg %d max %d ms.",
+                       i, classStatistics->sentCount, classStatistics->coalescedCount, classStatistics->droppedCount,
+                       classStatistics->failedCount,
+                       classStatistics->sentCount != 0 ?
+                       (uint32_t) (classStatistics->latencySumMs / classStatistics->sentCount) : 0,
+                       classStatistics->latencyMaxMs);
+    }
+}
 
 static T_DjiReturnCode ReceiveDataFromMobile(const uint8_t *data, uint16_t len)
 {
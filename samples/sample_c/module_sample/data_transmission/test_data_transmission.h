@@ -29,6 +29,8 @@
 
 /* Includes ------------------------------------------------------------------*/
 #include "dji_typedef.h"
+#include "test_data_transmission_scheduler.h"
+#include "test_data_stream_message.h"
 
 #ifdef __cplusplus
 extern "C" {
@@ -42,6 +44,14 @@ extern "C" {
 /* Exported functions --------------------------------------------------------*/
 T_DjiReturnCode DjiTest_DataTransmissionStartService(void);
 T_DjiReturnCode DjiTest_DataTransmissionStopService(void);
+T_DjiReturnCode DjiTest_DataTransmissionSendLowSpeedData(E_DjiChannelAddress channelAddress,
+                                                         E_DjiTestDataTxClass txClass, uint16_t topic,
+                                                         const uint8_t *data, uint8_t len);
+void DjiTest_DataTransmissionGetTxStatistics(T_DjiTestDataTxStatistics *statistics);
+#ifdef SYSTEM_ARCH_LINUX
+T_DjiReturnCode DjiTest_DataTransmissionSendStreamMessage(const T_DjiTestDataStreamIov *iov, uint32_t iovCount,
+                                                          uint32_t flags);
+#endif
 
 #ifdef __cplusplus
 }
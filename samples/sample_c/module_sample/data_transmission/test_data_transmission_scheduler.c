@@ -0,0 +1,665 @@
+/**
+ ********************************************************************
+ * @file    test_data_transmission_scheduler.c
+ * @brief   Priority transmit scheduler with token bucket rate control for the low speed data channel.
+ *
+ * @copyright (c) 2021 DJI. All rights reserved.
+ *
+ * All information contained herein is, and remains, the property of DJI.
+ * The intellectual and technical concepts contained herein are proprietary
+ * to DJI and may be covered by U.S. and foreign patents, patents in process,
+ * and protected by trade secret or copyright law.  Dissemination of this
+ * information, including but not limited to data and other proprietary
+ * material(s) incorporated within the information, in any form, is strictly
+ * prohibited without the express written consent of DJI.
+ *
+ * If you receive this source code without DJI’s authorization, you may not
+ * further disseminate the information, and you must immediately remove the
+ * source code and notify DJI of its removal. DJI reserves the right to pursue
+ * legal actions against you for any loss(es) or damage(s) caused by your
+ * failure to do so.
+ *
+ *********************************************************************
+ */
+
+/* Includes ------------------------------------------------------------------*/
+#include "test_data_transmission_scheduler.h"
+#include <string.h>
+#include "dji_low_speed_data_channel.h"
+#include "utils/util_misc.h"
+
+/* Private constants ---------------------------------------------------------*/
+#define DJI_TEST_DATA_TX_TOKEN_SCALE                (1000)
+#define DJI_TEST_DATA_TX_RATE_INCREASE_DIVISOR      (8)
+#define DJI_TEST_DATA_TX_SIM_WINDOW_MS              (1000)
+
+/* Private types -------------------------------------------------------------*/
+
+/* Private functions declaration ---------------------------------------------*/
+static T_DjiTestDataTxDestination *DjiTest_DataTxGetDestination(T_DjiTestDataTxScheduler *scheduler,
+                                                                 E_DjiChannelAddress channelAddress, uint32_t nowMs);
+static uint16_t DjiTest_DataTxAllocMessage(T_DjiTestDataTxScheduler *scheduler, E_DjiTestDataTxClass txClass);
+static void DjiTest_DataTxFreeMessage(T_DjiTestDataTxScheduler *scheduler, uint16_t index);
+static void DjiTest_DataTxPushMessage(T_DjiTestDataTxScheduler *scheduler, T_DjiTestDataTxQueue *queue,
+                                      uint16_t index);
+static uint16_t DjiTest_DataTxPopMessage(T_DjiTestDataTxScheduler *scheduler, T_DjiTestDataTxQueue *queue);
+static void DjiTest_DataTxUpdateRate(T_DjiTestDataTxScheduler *scheduler, T_DjiTestDataTxDestination *destination,
+                                     const T_DjiDataChannelState *state);
+static void DjiTest_DataTxRefillTokens(T_DjiTestDataTxScheduler *scheduler, T_DjiTestDataTxDestination *destination,
+                                       uint32_t nowMs);
+static uint16_t DjiTest_DataTxPickMessage(T_DjiTestDataTxScheduler *scheduler,
+                                          T_DjiTestDataTxDestination *destination, uint32_t nowMs);
+static T_DjiReturnCode DjiTest_DataTxLowSpeedSendData(void *userData, E_DjiChannelAddress channelAddress,
+                                                      const uint8_t *data, uint8_t len);
+static T_DjiReturnCode DjiTest_DataTxLowSpeedGetSendDataState(void *userData, E_DjiChannelAddress channelAddress,
+                                                              T_DjiDataChannelState *state);
+static uint32_t DjiTest_DataTxGetTimeMs(const T_DjiTestDataTxScheduler *scheduler);
+static uint32_t DjiTest_DataTxSimGetTimeMs(void *userData);
+static void DjiTest_DataTxSimDrain(T_DjiTestDataTxSimChannel *simChannel);
+static T_DjiReturnCode DjiTest_DataTxSimSendData(void *userData, E_DjiChannelAddress channelAddress,
+                                                 const uint8_t *data, uint8_t len);
+static T_DjiReturnCode DjiTest_DataTxSimGetSendDataState(void *userData, E_DjiChannelAddress channelAddress,
+                                                         T_DjiDataChannelState *state);
+
+/* Private values ------------------------------------------------------------*/
+
+/* Exported functions definition ---------------------------------------------*/
+void DjiTest_DataTxSchedulerGetDefaultConfig(T_DjiTestDataTxSchedulerConfig *config)
+{
+    memset(config, 0, sizeof(T_DjiTestDataTxSchedulerConfig));
+
+    config->messageCount = 32;
+    config->queueDepth[DJI_TEST_DATA_TX_CLASS_COMMAND] = 8;
+    config->queueDepth[DJI_TEST_DATA_TX_CLASS_STATUS] = 8;
+    config->queueDepth[DJI_TEST_DATA_TX_CLASS_BULK] = 16;
+    config->maxAgeMs[DJI_TEST_DATA_TX_CLASS_STATUS] = 1000;
+    config->initialRate = 1024;
+    config->minRate = 128;
+    config->maxRate = 4096;
+    config->burstSize = 256;
+    config->stateIntervalMs = 200;
+}
+
+void DjiTest_DataTxSchedulerGetLowSpeedChannel(T_DjiTestDataTxChannel *channel)
+{
+    channel->SendData = DjiTest_DataTxLowSpeedSendData;
+    channel->GetSendDataState = DjiTest_DataTxLowSpeedGetSendDataState;
+    channel->GetTimeMs = NULL;
+    channel->userData = NULL;
+}
+
+T_DjiReturnCode DjiTest_DataTxSchedulerInit(T_DjiTestDataTxScheduler *scheduler,
+                                            const T_DjiTestDataTxSchedulerConfig *config,
+                                            const T_DjiTestDataTxChannel *channel)
+{
+    T_DjiOsalHandler *osalHandler = DjiPlatform_GetOsalHandler();
+    T_DjiReturnCode returnCode;
+    uint16_t i;
+
+    if (scheduler == NULL || config == NULL || channel == NULL || channel->SendData == NULL ||
+        channel->GetSendDataState == NULL || config->messageCount == 0 ||
+        config->messageCount >= DJI_TEST_DATA_TX_INVALID_INDEX || config->minRate == 0 ||
+        config->minRate > config->maxRate || config->burstSize < DJI_TEST_DATA_TX_MESSAGE_MAX_SIZE ||
+        config->burstSize > UINT32_MAX / DJI_TEST_DATA_TX_TOKEN_SCALE) {
+        return DJI_ERROR_SYSTEM_MODULE_CODE_INVALID_PARAMETER;
+    }
+
+    memset(scheduler, 0, sizeof(T_DjiTestDataTxScheduler));
+    scheduler->config = *config;
+    scheduler->channel = *channel;
+    scheduler->config.initialRate = USER_UTIL_MIN(USER_UTIL_MAX(config->initialRate, config->minRate),
+                                                  config->maxRate);
+
+    scheduler->messages = osalHandler->Malloc(sizeof(T_DjiTestDataTxMessage) * config->messageCount);
+    if (scheduler->messages == NULL) {
+        return DJI_ERROR_SYSTEM_MODULE_CODE_MEMORY_ALLOC_FAILED;
+    }
+
+    for (i = 0; i < config->messageCount; i++) {
+        scheduler->messages[i].next = (uint16_t) (i + 1 < config->messageCount ? i + 1 :
+                                                  DJI_TEST_DATA_TX_INVALID_INDEX);
+    }
+    scheduler->freeHead = 0;
+
+    returnCode = osalHandler->MutexCreate(&scheduler->mutex);
+    if (returnCode != DJI_ERROR_SYSTEM_MODULE_CODE_SUCCESS) {
+        osalHandler->Free(scheduler->messages);
+        scheduler->messages = NULL;
+        return returnCode;
+    }
+
+    return DJI_ERROR_SYSTEM_MODULE_CODE_SUCCESS;
+}
+
+T_DjiReturnCode DjiTest_DataTxSchedulerDeInit(T_DjiTestDataTxScheduler *scheduler)
+{
+    T_DjiOsalHandler *osalHandler = DjiPlatform_GetOsalHandler();
+    T_DjiReturnCode returnCode;
+
+    if (scheduler == NULL || scheduler->messages == NULL) {
+        return DJI_ERROR_SYSTEM_MODULE_CODE_INVALID_PARAMETER;
+    }
+
+    returnCode = osalHandler->MutexDestroy(scheduler->mutex);
+    osalHandler->Free(scheduler->messages);
+    scheduler->messages = NULL;
+
+    return returnCode;
+}
+
+/**
+ * @brief Queue a message for one destination.
+ * @note A non-zero topic marks a latest-value message: a queued message of the same destination, class and topic is
+ * overwritten in place and keeps its queue position, so the newest value goes out as soon as the old one would have.
+ * A full status or bulk queue drops its oldest message, a full command queue rejects the new one. When all messages
+ * are in use the oldest message of a lower class is evicted.
+ */
+T_DjiReturnCode DjiTest_DataTxSchedulerEnqueue(T_DjiTestDataTxScheduler *scheduler, E_DjiChannelAddress channelAddress,
+                                               E_DjiTestDataTxClass txClass, uint16_t topic, const uint8_t *data,
+                                               uint8_t len)
+{
+    T_DjiOsalHandler *osalHandler = DjiPlatform_GetOsalHandler();
+    T_DjiTestDataTxClassStatistics *classStatistics;
+    T_DjiTestDataTxDestination *destination;
+    T_DjiTestDataTxQueue *queue;
+    T_DjiTestDataTxMessage *message;
+    T_DjiReturnCode returnCode = DJI_ERROR_SYSTEM_MODULE_CODE_SUCCESS;
+    uint32_t nowMs;
+    uint16_t index;
+
+    if (scheduler == NULL || scheduler->messages == NULL || txClass >= DJI_TEST_DATA_TX_CLASS_NUM ||
+        data == NULL || len == 0 || len > DJI_TEST_DATA_TX_MESSAGE_MAX_SIZE) {
+        return DJI_ERROR_SYSTEM_MODULE_CODE_INVALID_PARAMETER;
+    }
+
+    nowMs = DjiTest_DataTxGetTimeMs(scheduler);
+    classStatistics = &scheduler->classStatistics[txClass];
+
+    osalHandler->MutexLock(scheduler->mutex);
+
+    destination = DjiTest_DataTxGetDestination(scheduler, channelAddress, nowMs);
+    if (destination == NULL) {
+        returnCode = DJI_ERROR_SYSTEM_MODULE_CODE_OUT_OF_RANGE;
+        goto out;
+    }
+    queue = &destination->queues[txClass];
+    classStatistics->enqueuedCount++;
+
+    if (topic != 0) {
+        for (index = queue->head; index != DJI_TEST_DATA_TX_INVALID_INDEX; index = scheduler->messages[index].next) {
+            message = &scheduler->messages[index];
+            if (message->topic == topic) {
+                memcpy(message->data, data, len);
+                message->len = len;
+                message->updateTimeMs = nowMs;
+                classStatistics->coalescedCount++;
+                goto out;
+            }
+        }
+    }
+
+    if (scheduler->config.queueDepth[txClass] != 0 && queue->count >= scheduler->config.queueDepth[txClass]) {
+        if (txClass == DJI_TEST_DATA_TX_CLASS_COMMAND) {
+            classStatistics->droppedCount++;
+            returnCode = DJI_ERROR_SYSTEM_MODULE_CODE_BUSY;
+            goto out;
+        }
+        DjiTest_DataTxFreeMessage(scheduler, DjiTest_DataTxPopMessage(scheduler, queue));
+        classStatistics->droppedCount++;
+    }
+
+    index = DjiTest_DataTxAllocMessage(scheduler, txClass);
+    if (index == DJI_TEST_DATA_TX_INVALID_INDEX) {
+        classStatistics->droppedCount++;
+        returnCode = DJI_ERROR_SYSTEM_MODULE_CODE_BUSY;
+        goto out;
+    }
+
+    message = &scheduler->messages[index];
+    message->topic = topic;
+    message->txClass = (uint8_t) txClass;
+    message->len = len;
+    message->enqueueTimeMs = nowMs;
+    message->updateTimeMs = nowMs;
+    memcpy(message->data, data, len);
+    DjiTest_DataTxPushMessage(scheduler, queue, index);
+
+out:
+    osalHandler->MutexUnlock(scheduler->mutex);
+
+    return returnCode;
+}
+
+/**
+ * @brief Query the channel state when due, then send every message the token buckets allow.
+ * @note The channel is called without the lock held, so producers are never blocked by a slow send.
+ */
+T_DjiReturnCode DjiTest_DataTxSchedulerProcess(T_DjiTestDataTxScheduler *scheduler)
+{
+    T_DjiOsalHandler *osalHandler = DjiPlatform_GetOsalHandler();
+    T_DjiTestDataTxDestination *destination;
+    T_DjiTestDataTxClassStatistics *classStatistics;
+    T_DjiTestDataTxMessage *message;
+    T_DjiDataChannelState state;
+    E_DjiChannelAddress channelAddress;
+    T_DjiReturnCode returnCode;
+    uint8_t data[DJI_TEST_DATA_TX_MESSAGE_MAX_SIZE];
+    uint32_t destinationCount;
+    uint32_t nowMs;
+    uint32_t latencyMs;
+    uint32_t idleCount;
+    uint16_t index;
+    uint8_t txClass;
+    uint8_t len;
+    uint32_t i;
+
+    if (scheduler == NULL || scheduler->messages == NULL) {
+        return DJI_ERROR_SYSTEM_MODULE_CODE_INVALID_PARAMETER;
+    }
+
+    nowMs = DjiTest_DataTxGetTimeMs(scheduler);
+
+    osalHandler->MutexLock(scheduler->mutex);
+    destinationCount = scheduler->destinationCount;
+    osalHandler->MutexUnlock(scheduler->mutex);
+
+    /* Destinations are only ever added, so the first destinationCount entries stay valid without the lock. */
+    for (i = 0; i < destinationCount; i++) {
+        destination = &scheduler->destinations[i];
+        if (nowMs - destination->lastStateTimeMs < scheduler->config.stateIntervalMs) {
+            continue;
+        }
+        destination->lastStateTimeMs = nowMs;
+
+        returnCode = scheduler->channel.GetSendDataState(scheduler->channel.userData, destination->channelAddress,
+                                                         &state);
+        if (returnCode != DJI_ERROR_SYSTEM_MODULE_CODE_SUCCESS) {
+            continue;
+        }
+
+        osalHandler->MutexLock(scheduler->mutex);
+        DjiTest_DataTxUpdateRate(scheduler, destination, &state);
+        osalHandler->MutexUnlock(scheduler->mutex);
+    }
+
+    osalHandler->MutexLock(scheduler->mutex);
+
+    for (i = 0; i < destinationCount; i++) {
+        DjiTest_DataTxRefillTokens(scheduler, &scheduler->destinations[i], nowMs);
+    }
+
+    idleCount = 0;
+    while (destinationCount != 0 && idleCount < destinationCount) {
+        destination = &scheduler->destinations[scheduler->nextDestination];
+        scheduler->nextDestination = (scheduler->nextDestination + 1) % destinationCount;
+
+        index = DjiTest_DataTxPickMessage(scheduler, destination, nowMs);
+        if (index == DJI_TEST_DATA_TX_INVALID_INDEX) {
+            idleCount++;
+            continue;
+        }
+        idleCount = 0;
+
+        message = &scheduler->messages[index];
+        destination->tokens -= (uint32_t) message->len * DJI_TEST_DATA_TX_TOKEN_SCALE;
+        channelAddress = destination->channelAddress;
+        txClass = message->txClass;
+        len = message->len;
+        latencyMs = (int32_t) (nowMs - message->enqueueTimeMs) > 0 ? nowMs - message->enqueueTimeMs : 0;
+        memcpy(data, message->data, len);
+        DjiTest_DataTxFreeMessage(scheduler, DjiTest_DataTxPopMessage(scheduler, &destination->queues[txClass]));
+
+        osalHandler->MutexUnlock(scheduler->mutex);
+        returnCode = scheduler->channel.SendData(scheduler->channel.userData, channelAddress, data, len);
+        osalHandler->MutexLock(scheduler->mutex);
+
+        classStatistics = &scheduler->classStatistics[txClass];
+        if (returnCode != DJI_ERROR_SYSTEM_MODULE_CODE_SUCCESS) {
+            classStatistics->failedCount++;
+            continue;
+        }
+        classStatistics->sentCount++;
+        classStatistics->sentBytes += len;
+        classStatistics->latencySumMs += latencyMs;
+        if (latencyMs > classStatistics->latencyMaxMs) {
+            classStatistics->latencyMaxMs = latencyMs;
+        }
+    }
+
+    osalHandler->MutexUnlock(scheduler->mutex);
+
+    return DJI_ERROR_SYSTEM_MODULE_CODE_SUCCESS;
+}
+
+void DjiTest_DataTxSchedulerGetStatistics(T_DjiTestDataTxScheduler *scheduler, T_DjiTestDataTxStatistics *statistics)
+{
+    T_DjiOsalHandler *osalHandler = DjiPlatform_GetOsalHandler();
+    T_DjiTestDataTxDestination *destination;
+    uint32_t i;
+    uint32_t j;
+
+    memset(statistics, 0, sizeof(T_DjiTestDataTxStatistics));
+
+    osalHandler->MutexLock(scheduler->mutex);
+    memcpy(statistics->classes, scheduler->classStatistics, sizeof(statistics->classes));
+    statistics->destinationCount = scheduler->destinationCount;
+    for (i = 0; i < scheduler->destinationCount; i++) {
+        destination = &scheduler->destinations[i];
+        statistics->destinations[i].channelAddress = destination->channelAddress;
+        statistics->destinations[i].rate = destination->rate;
+        statistics->destinations[i].congestionCount = destination->congestionCount;
+        for (j = 0; j < DJI_TEST_DATA_TX_CLASS_NUM; j++) {
+            statistics->destinations[i].queuedCount[j] = destination->queues[j].count;
+        }
+    }
+    osalHandler->MutexUnlock(scheduler->mutex);
+}
+
+void DjiTest_DataTxSimChannelInit(T_DjiTestDataTxSimChannel *simChannel, uint32_t bandwidth)
+{
+    memset(simChannel, 0, sizeof(T_DjiTestDataTxSimChannel));
+    simChannel->bandwidth = bandwidth;
+}
+
+void DjiTest_DataTxSimChannelGetChannel(T_DjiTestDataTxSimChannel *simChannel, T_DjiTestDataTxChannel *channel)
+{
+    simChannel->lastDrainTimeMs = DjiTest_DataTxSimGetTimeMs(simChannel);
+    simChannel->windowStartTimeMs = simChannel->lastDrainTimeMs;
+
+    channel->SendData = DjiTest_DataTxSimSendData;
+    channel->GetSendDataState = DjiTest_DataTxSimGetSendDataState;
+    channel->GetTimeMs = DjiTest_DataTxSimGetTimeMs;
+    channel->userData = simChannel;
+}
+
+/* Private functions definition-----------------------------------------------*/
+static T_DjiTestDataTxDestination *DjiTest_DataTxGetDestination(T_DjiTestDataTxScheduler *scheduler,
+                                                                 E_DjiChannelAddress channelAddress, uint32_t nowMs)
+{
+    T_DjiTestDataTxDestination *destination;
+    uint32_t i;
+    uint32_t j;
+
+    for (i = 0; i < scheduler->destinationCount; i++) {
+        if (scheduler->destinations[i].channelAddress == channelAddress) {
+            return &scheduler->destinations[i];
+        }
+    }
+
+    if (scheduler->destinationCount >= DJI_TEST_DATA_TX_DESTINATION_MAX_NUM) {
+        return NULL;
+    }
+
+    destination = &scheduler->destinations[scheduler->destinationCount];
+    memset(destination, 0, sizeof(T_DjiTestDataTxDestination));
+    destination->channelAddress = channelAddress;
+    destination->rate = scheduler->config.initialRate;
+    destination->tokens = scheduler->config.burstSize * DJI_TEST_DATA_TX_TOKEN_SCALE;
+    destination->lastRefillTimeMs = nowMs;
+    /* Query the state at the first process. */
+    destination->lastStateTimeMs = nowMs - scheduler->config.stateIntervalMs;
+    for (j = 0; j < DJI_TEST_DATA_TX_CLASS_NUM; j++) {
+        destination->queues[j].head = DJI_TEST_DATA_TX_INVALID_INDEX;
+        destination->queues[j].tail = DJI_TEST_DATA_TX_INVALID_INDEX;
+    }
+    scheduler->destinationCount++;
+
+    return destination;
+}
+
+static uint16_t DjiTest_DataTxAllocMessage(T_DjiTestDataTxScheduler *scheduler, E_DjiTestDataTxClass txClass)
+{
+    T_DjiTestDataTxDestination *destination;
+    T_DjiTestDataTxQueue *queue;
+    uint16_t index;
+    int32_t victimClass;
+    uint32_t i;
+
+    if (scheduler->freeHead == DJI_TEST_DATA_TX_INVALID_INDEX) {
+        for (victimClass = DJI_TEST_DATA_TX_CLASS_NUM - 1; victimClass > (int32_t) txClass; victimClass--) {
+            for (i = 0; i < scheduler->destinationCount; i++) {
+                destination = &scheduler->destinations[i];
+                queue = &destination->queues[victimClass];
+                if (queue->count != 0) {
+                    DjiTest_DataTxFreeMessage(scheduler, DjiTest_DataTxPopMessage(scheduler, queue));
+                    scheduler->classStatistics[victimClass].droppedCount++;
+                    goto alloc;
+                }
+            }
+        }
+        return DJI_TEST_DATA_TX_INVALID_INDEX;
+    }
+
+alloc:
+    index = scheduler->freeHead;
+    scheduler->freeHead = scheduler->messages[index].next;
+    scheduler->messages[index].next = DJI_TEST_DATA_TX_INVALID_INDEX;
+
+    return index;
+}
+
+static void DjiTest_DataTxFreeMessage(T_DjiTestDataTxScheduler *scheduler, uint16_t index)
+{
+    scheduler->messages[index].next = scheduler->freeHead;
+    scheduler->freeHead = index;
+}
+
+static void DjiTest_DataTxPushMessage(T_DjiTestDataTxScheduler *scheduler, T_DjiTestDataTxQueue *queue,
+                                      uint16_t index)
+{
+    scheduler->messages[index].next = DJI_TEST_DATA_TX_INVALID_INDEX;
+    if (queue->tail == DJI_TEST_DATA_TX_INVALID_INDEX) {
+        queue->head = index;
+    } else {
+        scheduler->messages[queue->tail].next = index;
+    }
+    queue->tail = index;
+    queue->count++;
+}
+
+static uint16_t DjiTest_DataTxPopMessage(T_DjiTestDataTxScheduler *scheduler, T_DjiTestDataTxQueue *queue)
+{
+    uint16_t index = queue->head;
+
+    queue->head = scheduler->messages[index].next;
+    if (queue->head == DJI_TEST_DATA_TX_INVALID_INDEX) {
+        queue->tail = DJI_TEST_DATA_TX_INVALID_INDEX;
+    }
+    queue->count--;
+
+    return index;
+}
+
+/**
+ * @brief Additive increase, multiplicative decrease of the token rate from one send state report.
+ */
+static void DjiTest_DataTxUpdateRate(T_DjiTestDataTxScheduler *scheduler, T_DjiTestDataTxDestination *destination,
+                                     const T_DjiDataChannelState *state)
+{
+    uint32_t ceiling = scheduler->config.maxRate;
+    uint32_t step;
+
+    if (state->realtimeBandwidthLimit > 0) {
+        ceiling = USER_UTIL_MIN((uint32_t) state->realtimeBandwidthLimit, ceiling);
+        ceiling = USER_UTIL_MAX(ceiling, scheduler->config.minRate);
+    }
+
+    if (state->busyState ||
+        (state->realtimeBandwidthLimit > 0 &&
+         state->realtimeBandwidthBeforeFlowController > state->realtimeBandwidthLimit)) {
+        destination->rate = USER_UTIL_MAX(destination->rate / 2, scheduler->config.minRate);
+        /* The flow controller already holds data, a full bucket would only add to it. */
+        destination->tokens = 0;
+        destination->congestionCount++;
+        return;
+    }
+
+    step = USER_UTIL_MAX(ceiling / DJI_TEST_DATA_TX_RATE_INCREASE_DIVISOR, 1);
+    destination->rate = USER_UTIL_MIN(destination->rate + step, ceiling);
+}
+
+static void DjiTest_DataTxRefillTokens(T_DjiTestDataTxScheduler *scheduler, T_DjiTestDataTxDestination *destination,
+                                       uint32_t nowMs)
+{
+    uint32_t capacity = scheduler->config.burstSize * DJI_TEST_DATA_TX_TOKEN_SCALE;
+    uint64_t tokens;
+
+    /* byte/s multiplied by ms gives 1/1000 byte. */
+    tokens = (uint64_t) destination->tokens + (uint64_t) (nowMs - destination->lastRefillTimeMs) * destination->rate;
+    destination->tokens = (uint32_t) USER_UTIL_MIN(tokens, (uint64_t) capacity);
+    destination->lastRefillTimeMs = nowMs;
+}
+
+/**
+ * @brief Drop expired heads, then return the head of the highest class if it fits into the tokens.
+ */
+static uint16_t DjiTest_DataTxPickMessage(T_DjiTestDataTxScheduler *scheduler,
+                                          T_DjiTestDataTxDestination *destination, uint32_t nowMs)
+{
+    T_DjiTestDataTxQueue *queue;
+    T_DjiTestDataTxMessage *message;
+    uint32_t maxAgeMs;
+    uint32_t txClass;
+
+    for (txClass = 0; txClass < DJI_TEST_DATA_TX_CLASS_NUM; txClass++) {
+        queue = &destination->queues[txClass];
+        maxAgeMs = scheduler->config.maxAgeMs[txClass];
+
+        while (queue->count != 0) {
+            message = &scheduler->messages[queue->head];
+            /* Messages enqueued after nowMs was read have a negative age. */
+            if (maxAgeMs == 0 || (int32_t) (nowMs - message->updateTimeMs) <= (int32_t) maxAgeMs) {
+                break;
+            }
+            DjiTest_DataTxFreeMessage(scheduler, DjiTest_DataTxPopMessage(scheduler, queue));
+            scheduler->classStatistics[txClass].droppedCount++;
+        }
+
+        if (queue->count == 0) {
+            continue;
+        }
+
+        message = &scheduler->messages[queue->head];
+        if ((uint32_t) message->len * DJI_TEST_DATA_TX_TOKEN_SCALE > destination->tokens) {
+            return DJI_TEST_DATA_TX_INVALID_INDEX;
+        }
+
+        return queue->head;
+    }
+
+    return DJI_TEST_DATA_TX_INVALID_INDEX;
+}
+
+static T_DjiReturnCode DjiTest_DataTxLowSpeedSendData(void *userData, E_DjiChannelAddress channelAddress,
+                                                      const uint8_t *data, uint8_t len)
+{
+    USER_UTIL_UNUSED(userData);
+
+    return DjiLowSpeedDataChannel_SendData(channelAddress, data, len);
+}
+
+static T_DjiReturnCode DjiTest_DataTxLowSpeedGetSendDataState(void *userData, E_DjiChannelAddress channelAddress,
+                                                              T_DjiDataChannelState *state)
+{
+    USER_UTIL_UNUSED(userData);
+
+    return DjiLowSpeedDataChannel_GetSendDataState(channelAddress, state);
+}
+
+static uint32_t DjiTest_DataTxGetTimeMs(const T_DjiTestDataTxScheduler *scheduler)
+{
+    T_DjiOsalHandler *osalHandler = DjiPlatform_GetOsalHandler();
+    uint32_t nowMs = 0;
+
+    if (scheduler->channel.GetTimeMs != NULL) {
+        return scheduler->channel.GetTimeMs(scheduler->channel.userData);
+    }
+
+    osalHandler->GetTimeMs(&nowMs);
+
+    return nowMs;
+}
+
+static uint32_t DjiTest_DataTxSimGetTimeMs(void *userData)
+{
+    T_DjiTestDataTxSimChannel *simChannel = userData;
+    T_DjiOsalHandler *osalHandler = DjiPlatform_GetOsalHandler();
+    uint32_t nowMs = 0;
+
+    if (simChannel->GetTimeMs != NULL) {
+        return simChannel->GetTimeMs(simChannel->timeUserData);
+    }
+
+    osalHandler->GetTimeMs(&nowMs);
+
+    return nowMs;
+}
+
+static void DjiTest_DataTxSimDrain(T_DjiTestDataTxSimChannel *simChannel)
+{
+    uint32_t nowMs = DjiTest_DataTxSimGetTimeMs(simChannel);
+    uint32_t windowMs;
+    uint64_t drained;
+
+    drained = (uint64_t) (nowMs - simChannel->lastDrainTimeMs) * simChannel->bandwidth;
+    drained = USER_UTIL_MIN(drained, (uint64_t) simChannel->bufferedBytes);
+    simChannel->bufferedBytes -= (uint32_t) drained;
+    simChannel->windowOutputBytes += (uint32_t) drained;
+    simChannel->lastDrainTimeMs = nowMs;
+
+    windowMs = nowMs - simChannel->windowStartTimeMs;
+    if (windowMs >= DJI_TEST_DATA_TX_SIM_WINDOW_MS) {
+        simChannel->lastInputBandwidth = (uint32_t) ((uint64_t) simChannel->windowInputBytes * 1000 / windowMs);
+        simChannel->lastOutputBandwidth = simChannel->windowOutputBytes / windowMs;
+        simChannel->windowInputBytes = 0;
+        simChannel->windowOutputBytes = 0;
+        simChannel->windowDiscardedBytes = 0;
+        simChannel->windowStartTimeMs = nowMs;
+    }
+}
+
+static T_DjiReturnCode DjiTest_DataTxSimSendData(void *userData, E_DjiChannelAddress channelAddress,
+                                                 const uint8_t *data, uint8_t len)
+{
+    T_DjiTestDataTxSimChannel *simChannel = userData;
+
+    USER_UTIL_UNUSED(channelAddress);
+    USER_UTIL_UNUSED(data);
+
+    DjiTest_DataTxSimDrain(simChannel);
+
+    simChannel->windowInputBytes += len;
+    if (simChannel->bufferedBytes + (uint32_t) len * DJI_TEST_DATA_TX_TOKEN_SCALE >
+        DJI_TEST_DATA_TX_FLOW_CONTROLLER_SIZE * DJI_TEST_DATA_TX_TOKEN_SCALE) {
+        simChannel->windowDiscardedBytes += len;
+        simChannel->discardedBytes += len;
+        return DJI_ERROR_SYSTEM_MODULE_CODE_SUCCESS;
+    }
+
+    simChannel->bufferedBytes += (uint32_t) len * DJI_TEST_DATA_TX_TOKEN_SCALE;
+    simChannel->acceptedBytes += len;
+
+    return DJI_ERROR_SYSTEM_MODULE_CODE_SUCCESS;
+}
+
+static T_DjiReturnCode DjiTest_DataTxSimGetSendDataState(void *userData, E_DjiChannelAddress channelAddress,
+                                                         T_DjiDataChannelState *state)
+{
+    T_DjiTestDataTxSimChannel *simChannel = userData;
+
+    USER_UTIL_UNUSED(channelAddress);
+
+    DjiTest_DataTxSimDrain(simChannel);
+
+    state->realtimeBandwidthLimit = (int32_t) simChannel->bandwidth;
+    state->realtimeBandwidthBeforeFlowController = (int32_t) simChannel->lastInputBandwidth;
+    state->realtimeBandwidthAfterFlowController = (int32_t) simChannel->lastOutputBandwidth;
+    /* Data that has to wait for more than a quarter of the buffer, or any discarded data, means busy. */
+    state->busyState = simChannel->windowDiscardedBytes != 0 ||
+                       simChannel->bufferedBytes >
+                       DJI_TEST_DATA_TX_FLOW_CONTROLLER_SIZE * DJI_TEST_DATA_TX_TOKEN_SCALE / 4;
+
+    return DJI_ERROR_SYSTEM_MODULE_CODE_SUCCESS;
+}
+
+/****************** (C) COPYRIGHT DJI Innovations *****END OF FILE****/
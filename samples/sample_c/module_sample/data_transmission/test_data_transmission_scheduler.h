@@ -0,0 +1,192 @@
+/**
+ ********************************************************************
+ * @file    test_data_transmission_scheduler.h
+ * @brief   This is the header file for "test_data_transmission_scheduler.c", defining the structure and
+ * (exported) function prototypes.
+ *
+ * @copyright (c) 2021 DJI. All rights reserved.
+ *
+ * All information contained herein is, and remains, the property of DJI.
+ * The intellectual and technical concepts contained herein are proprietary
+ * to DJI and may be covered by U.S. and foreign patents, patents in process,
+ * and protected by trade secret or copyright law.  Dissemination of this
+ * information, including but not limited to data and other proprietary
+ * material(s) incorporated within the information, in any form, is strictly
+ * prohibited without the express written consent of DJI.
+ *
+ * If you receive this source code without DJI’s authorization, you may not
+ * further disseminate the information, and you must immediately remove the
+ * source code and notify DJI of its removal. DJI reserves the right to pursue
+ * legal actions against you for any loss(es) or damage(s) caused by your
+ * failure to do so.
+ *
+ *********************************************************************
+ */
+
+/* Define to prevent recursive inclusion -------------------------------------*/
+#ifndef TEST_DATA_TRANSMISSION_SCHEDULER_H
+#define TEST_DATA_TRANSMISSION_SCHEDULER_H
+
+/* Includes ------------------------------------------------------------------*/
+#include "dji_typedef.h"
+#include "dji_platform.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Exported constants --------------------------------------------------------*/
+/* One package on the physical link of the command channel, larger data is split by the caller. */
+#define DJI_TEST_DATA_TX_MESSAGE_MAX_SIZE           (128)
+#define DJI_TEST_DATA_TX_DESTINATION_MAX_NUM        (4)
+#define DJI_TEST_DATA_TX_INVALID_INDEX              (0xFFFF)
+/* Data buffered by the flow controller of the low speed channel before it discards. */
+#define DJI_TEST_DATA_TX_FLOW_CONTROLLER_SIZE       (512)
+
+/* Exported types ------------------------------------------------------------*/
+/**
+ * @brief Priority classes, a lower value is always sent first.
+ */
+typedef enum {
+    DJI_TEST_DATA_TX_CLASS_COMMAND = 0,     /*!< Urgent commands and their acknowledgements, never dropped for space. */
+    DJI_TEST_DATA_TX_CLASS_STATUS,          /*!< Latest-value telemetry, usually enqueued with a topic to coalesce. */
+    DJI_TEST_DATA_TX_CLASS_BULK,            /*!< Everything that may wait, evicted first when messages run out. */
+    DJI_TEST_DATA_TX_CLASS_NUM,
+} E_DjiTestDataTxClass;
+
+/**
+ * @brief The channel the scheduler sends through, the real low speed channel or a simulated one.
+ */
+typedef struct {
+    T_DjiReturnCode (*SendData)(void *userData, E_DjiChannelAddress channelAddress, const uint8_t *data,
+                                uint8_t len);
+    T_DjiReturnCode (*GetSendDataState)(void *userData, E_DjiChannelAddress channelAddress,
+                                        T_DjiDataChannelState *state);
+    uint32_t (*GetTimeMs)(void *userData);  /*!< Clock of queueing and rate control, NULL uses the osal time. */
+    void *userData;
+} T_DjiTestDataTxChannel;
+
+typedef struct {
+    uint16_t messageCount;                              /*!< Messages shared by all destinations and classes. */
+    uint16_t queueDepth[DJI_TEST_DATA_TX_CLASS_NUM];    /*!< Per destination, 0 for no limit beyond messageCount. */
+    uint32_t maxAgeMs[DJI_TEST_DATA_TX_CLASS_NUM];      /*!< Older messages are dropped unsent, 0 keeps them. */
+    uint32_t initialRate;                   /*!< Token rate before the first channel state, unit: byte/s. */
+    uint32_t minRate;                       /*!< Lower bound of the rate after congestion, unit: byte/s. */
+    uint32_t maxRate;                       /*!< Upper bound when the channel reports no limit, unit: byte/s. */
+    uint32_t burstSize;                     /*!< Bucket size, at least DJI_TEST_DATA_TX_MESSAGE_MAX_SIZE. */
+    uint32_t stateIntervalMs;               /*!< Interval of the send state queries that drive the rate. */
+} T_DjiTestDataTxSchedulerConfig;
+
+typedef struct {
+    uint32_t enqueuedCount;
+    uint32_t sentCount;
+    uint32_t sentBytes;
+    uint32_t coalescedCount;                /*!< Messages replaced by a newer value of the same topic before sent. */
+    uint32_t droppedCount;                  /*!< Queue overflow, eviction for a higher class and expiry. */
+    uint32_t failedCount;                   /*!< Rejected by the channel, not retried. */
+    uint32_t latencyMaxMs;                  /*!< From the first enqueue of a message to its send. */
+    uint64_t latencySumMs;
+} T_DjiTestDataTxClassStatistics;
+
+typedef struct {
+    E_DjiChannelAddress channelAddress;
+    uint32_t rate;                          /*!< Current token rate, unit: byte/s. */
+    uint32_t queuedCount[DJI_TEST_DATA_TX_CLASS_NUM];
+    uint32_t congestionCount;               /*!< Send state reports that made the rate back off. */
+} T_DjiTestDataTxDestinationStatistics;
+
+typedef struct {
+    T_DjiTestDataTxClassStatistics classes[DJI_TEST_DATA_TX_CLASS_NUM];
+    T_DjiTestDataTxDestinationStatistics destinations[DJI_TEST_DATA_TX_DESTINATION_MAX_NUM];
+    uint32_t destinationCount;
+} T_DjiTestDataTxStatistics;
+
+typedef struct {
+    uint16_t next;
+    uint16_t topic;
+    uint8_t txClass;
+    uint8_t len;
+    uint32_t enqueueTimeMs;
+    uint32_t updateTimeMs;                  /*!< Time of the newest coalesced value, the age limit applies to it. */
+    uint8_t data[DJI_TEST_DATA_TX_MESSAGE_MAX_SIZE];
+} T_DjiTestDataTxMessage;
+
+typedef struct {
+    uint16_t head;
+    uint16_t tail;
+    uint16_t count;
+} T_DjiTestDataTxQueue;
+
+typedef struct {
+    E_DjiChannelAddress channelAddress;
+    T_DjiTestDataTxQueue queues[DJI_TEST_DATA_TX_CLASS_NUM];
+    uint32_t rate;
+    uint32_t tokens;                        /*!< Unit: 1/1000 byte, so slow rates still refill every poll. */
+    uint32_t lastRefillTimeMs;
+    uint32_t lastStateTimeMs;
+    uint32_t congestionCount;
+} T_DjiTestDataTxDestination;
+
+/**
+ * @brief Transmit scheduler with per-destination queues in front of the low speed data channel.
+ * @note Each destination owns a token bucket whose rate follows the send state of its channel: it halves when the
+ * channel reports busy or more input than its limit, and grows back by an eighth of the limit per good report. Inside a
+ * destination the classes are served strictly by priority, and a head message that does not fit the tokens blocks the
+ * lower classes so urgent messages never wait behind bulk data. Destinations are served round robin. Enqueue may be
+ * called from any task, Process from one scheduling task.
+ */
+typedef struct {
+    T_DjiTestDataTxSchedulerConfig config;
+    T_DjiTestDataTxChannel channel;
+    T_DjiMutexHandle mutex;
+    T_DjiTestDataTxMessage *messages;
+    uint16_t freeHead;
+    T_DjiTestDataTxDestination destinations[DJI_TEST_DATA_TX_DESTINATION_MAX_NUM];
+    uint32_t destinationCount;
+    uint32_t nextDestination;
+    T_DjiTestDataTxClassStatistics classStatistics[DJI_TEST_DATA_TX_CLASS_NUM];
+} T_DjiTestDataTxScheduler;
+
+/**
+ * @brief Flow controller model of the low speed channel with a configurable bandwidth.
+ * @note Sent data enters a DJI_TEST_DATA_TX_FLOW_CONTROLLER_SIZE buffer drained at the bandwidth, data that does not fit
+ * is discarded like the real channel does. The reported state is measured over the last second.
+ */
+typedef struct {
+    uint32_t bandwidth;                     /*!< Unit: byte/s. */
+    uint32_t bufferedBytes;                 /*!< Unit: 1/1000 byte. */
+    uint32_t lastDrainTimeMs;
+    uint32_t windowStartTimeMs;
+    uint32_t windowInputBytes;
+    uint32_t windowOutputBytes;             /*!< Unit: 1/1000 byte. */
+    uint32_t lastInputBandwidth;
+    uint32_t lastOutputBandwidth;
+    uint32_t windowDiscardedBytes;
+    uint32_t acceptedBytes;                 /*!< Bytes that fitted into the flow controller and will be delivered. */
+    uint32_t discardedBytes;
+    uint32_t (*GetTimeMs)(void *userData);  /*!< NULL uses the osal time, a virtual clock speeds up simulations. */
+    void *timeUserData;                     /*!< Passed to GetTimeMs, which the scheduler shares through the channel. */
+} T_DjiTestDataTxSimChannel;
+
+/* Exported functions --------------------------------------------------------*/
+void DjiTest_DataTxSchedulerGetDefaultConfig(T_DjiTestDataTxSchedulerConfig *config);
+void DjiTest_DataTxSchedulerGetLowSpeedChannel(T_DjiTestDataTxChannel *channel);
+T_DjiReturnCode DjiTest_DataTxSchedulerInit(T_DjiTestDataTxScheduler *scheduler,
+                                            const T_DjiTestDataTxSchedulerConfig *config,
+                                            const T_DjiTestDataTxChannel *channel);
+T_DjiReturnCode DjiTest_DataTxSchedulerDeInit(T_DjiTestDataTxScheduler *scheduler);
+T_DjiReturnCode DjiTest_DataTxSchedulerEnqueue(T_DjiTestDataTxScheduler *scheduler, E_DjiChannelAddress channelAddress,
+                                               E_DjiTestDataTxClass txClass, uint16_t topic, const uint8_t *data,
+                                               uint8_t len);
+T_DjiReturnCode DjiTest_DataTxSchedulerProcess(T_DjiTestDataTxScheduler *scheduler);
+void DjiTest_DataTxSchedulerGetStatistics(T_DjiTestDataTxScheduler *scheduler, T_DjiTestDataTxStatistics *statistics);
+
+void DjiTest_DataTxSimChannelInit(T_DjiTestDataTxSimChannel *simChannel, uint32_t bandwidth);
+void DjiTest_DataTxSimChannelGetChannel(T_DjiTestDataTxSimChannel *simChannel, T_DjiTestDataTxChannel *channel);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // TEST_DATA_TRANSMISSION_SCHEDULER_H
+/************************ (C) COPYRIGHT DJI Innovations *******END OF FILE******/
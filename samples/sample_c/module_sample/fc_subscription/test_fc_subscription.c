@@ -25,27 +25,69 @@
 /* Includes ------------------------------------------------------------------*/
 #include <utils/util_misc.h>
 #include <math.h>
+#include <stdio.h>
+#include <string.h>
 #include "test_fc_subscription.h"
 #include "dji_logger.h"
 #include "dji_platform.h"
 #include "widget_interaction_test/test_widget_interaction.h"
+#include "telemetry_bus/test_telemetry_bus.h"
+#include "flight_recorder/test_flight_recorder.h"
 
 /* Private constants ---------------------------------------------------------*/
 #define FC_SUBSCRIPTION_TASK_FREQ         (1)
 #define FC_SUBSCRIPTION_TASK_STACK_SIZE   (2048)
+#define FC_SUBSCRIPTION_BUS_SLOT_COUNT    (64)
+/* Records carry the T_DjiDataTimestamp of the topic in front of the data. */
+#define FC_SUBSCRIPTION_RECORD_LAYOUT     "millisecond:u32 microsecond:u32 "
 
 /* Private types -------------------------------------------------------------*/
+#ifdef SYSTEM_ARCH_LINUX
+typedef struct {
+    E_DjiFcSubscriptionTopic topic;
+    const char *topicName;
+    const char *schemaName;
+    const char *layout;
+    uint32_t size;
+} T_DjiTestFcSubscriptionBusTopic;
+#endif
 
 /* Private functions declaration ---------------------------------------------*/
 static void *UserFcSubscription_Task(void *arg);
 static T_DjiReturnCode DjiTest_FcSubscriptionReceiveQuaternionCallback(const uint8_t *data, uint16_t dataSize,
                                                                        const T_DjiDataTimestamp *timestamp);
+#ifdef SYSTEM_ARCH_LINUX
+static void DjiTest_FcSubscriptionAddBusTopics(void);
+static void DjiTest_FcSubscriptionAddRecordChannels(void);
+static void DjiTest_FcSubscriptionReplayRecord(const T_DjiTestFlightRecordSample *sample, void *userData);
+#endif
+static void DjiTest_FcSubscriptionPublishToBus(E_DjiFcSubscriptionTopic topic, const uint8_t *data, uint16_t len);
+static void DjiTest_FcSubscriptionRecord(E_DjiFcSubscriptionTopic topic, const uint8_t *data, uint16_t len,
+                                         const T_DjiDataTimestamp *timestamp);
 
 /* Private variables ---------------------------------------------------------*/
 static T_DjiTaskHandle s_userFcSubscriptionThread;
 static bool s_userFcSubscriptionDataShow = false;
 static uint8_t s_totalSatelliteNumberUsed = 0;
 static uint32_t s_userFcSubscriptionDataCnt = 0;
+#ifdef SYSTEM_ARCH_LINUX
+/* The layouts describe the packed structures of dji_fc_subscription.h, the readers decode the samples by them. */
+static const T_DjiTestFcSubscriptionBusTopic s_fcSubscriptionBusTopics[] = {
+    {DJI_FC_SUBSCRIPTION_TOPIC_QUATERNION,   "fc/quaternion",   "dji.fc.quaternion",
+        "q0:f32 q1:f32 q2:f32 q3:f32",       sizeof(T_DjiFcSubscriptionQuaternion)},
+    {DJI_FC_SUBSCRIPTION_TOPIC_VELOCITY,     "fc/velocity",     "dji.fc.velocity",
+        "x:f32 y:f32 z:f32 health:u8",       sizeof(T_DjiFcSubscriptionVelocity)},
+    {DJI_FC_SUBSCRIPTION_TOPIC_GPS_POSITION, "fc/gps_position", "dji.fc.gps_position",
+        "x:i32 y:i32 z:i32",                 sizeof(T_DjiFcSubscriptionGpsPosition)},
+    {DJI_FC_SUBSCRIPTION_TOPIC_GPS_DETAILS,  "fc/gps_details",  "dji.fc.gps_details",
+        "hdop:f32 pdop:f32 fixState:f32 vacc:f32 hacc:f32 sacc:f32 gpsUsed:u32 glonassUsed:u32 totalUsed:u16 "
+        "gpsCounter:u16",                    sizeof(T_DjiFcSubscriptionGpsDetails)},
+};
+static uint16_t s_fcSubscriptionBusTopicIds[UTIL_ARRAY_SIZE(s_fcSubscriptionBusTopics)];
+static bool s_isFcSubscriptionBusTopicAdded[UTIL_ARRAY_SIZE(s_fcSubscriptionBusTopics)];
+static uint16_t s_fcSubscriptionRecordChannelIds[UTIL_ARRAY_SIZE(s_fcSubscriptionBusTopics)];
+static bool s_isFcSubscriptionRecordChannelAdded[UTIL_ARRAY_SIZE(s_fcSubscriptionBusTopics)];
+#endif
 
 /* Exported functions definition ---------------------------------------------*/
 T_DjiReturnCode DjiTest_FcSubscriptionStartService(void)
@@ -96,6 +138,11 @@ T_DjiReturnCode DjiTest_FcSubscriptionStartService(void)
         USER_LOG_DEBUG("Subscribe topic gps details success.");
     }
 
+#ifdef SYSTEM_ARCH_LINUX
+    DjiTest_FcSubscriptionAddBusTopics();
+    DjiTest_FcSubscriptionAddRecordChannels();
+#endif
+
     if (osalHandler->TaskCreate("user_subscription_task", UserFcSubscription_Task,
                                 FC_SUBSCRIPTION_TASK_STACK_SIZE, NULL, &s_userFcSubscriptionThread) !=
         DJI_ERROR_SYSTEM_MODULE_CODE_SUCCESS) {
@@ -279,6 +326,11 @@ static void *UserFcSubscription_Task(void *arg)
                                                           &timestamp);
         if (djiStat != DJI_ERROR_SYSTEM_MODULE_CODE_SUCCESS) {
             USER_LOG_ERROR("get value of topic velocity error.");
+        } else {
+            DjiTest_FcSubscriptionPublishToBus(DJI_FC_SUBSCRIPTION_TOPIC_VELOCITY, (const uint8_t *) &velocity,
+                                               sizeof(velocity));
+            DjiTest_FcSubscriptionRecord(DJI_FC_SUBSCRIPTION_TOPIC_VELOCITY, (const uint8_t *) &velocity,
+                                         sizeof(velocity), &timestamp);
         }
 
         if (s_userFcSubscriptionDataShow == true) {
@@ -292,6 +344,11 @@ static void *UserFcSubscription_Task(void *arg)
                                                           &timestamp);
         if (djiStat != DJI_ERROR_SYSTEM_MODULE_CODE_SUCCESS) {
             USER_LOG_ERROR("get value of topic gps position error.");
+        } else {
+            DjiTest_FcSubscriptionPublishToBus(DJI_FC_SUBSCRIPTION_TOPIC_GPS_POSITION, (const uint8_t *) &gpsPosition,
+                                               sizeof(gpsPosition));
+            DjiTest_FcSubscriptionRecord(DJI_FC_SUBSCRIPTION_TOPIC_GPS_POSITION, (const uint8_t *) &gpsPosition,
+                                         sizeof(gpsPosition), &timestamp);
         }
 
         if (s_userFcSubscriptionDataShow == true) {
@@ -304,6 +361,11 @@ static void *UserFcSubscription_Task(void *arg)
                                                           &timestamp);
         if (djiStat != DJI_ERROR_SYSTEM_MODULE_CODE_SUCCESS) {
             USER_LOG_ERROR("get value of topic gps details error.");
+        } else {
+            DjiTest_FcSubscriptionPublishToBus(DJI_FC_SUBSCRIPTION_TOPIC_GPS_DETAILS, (const uint8_t *) &gpsDetails,
+                                               sizeof(gpsDetails));
+            DjiTest_FcSubscriptionRecord(DJI_FC_SUBSCRIPTION_TOPIC_GPS_DETAILS, (const uint8_t *) &gpsDetails,
+                                         sizeof(gpsDetails), &timestamp);
         }
 
         if (s_userFcSubscriptionDataShow == true) {
@@ -327,7 +389,8 @@ static T_DjiReturnCode DjiTest_FcSubscriptionReceiveQuaternionCallback(const uin
     T_DjiFcSubscriptionQuaternion *quaternion = (T_DjiFcSubscriptionQuaternion *) data;
     dji_f64_t pitch, yaw, roll;
 
-    USER_UTIL_UNUSED(dataSize);
+    DjiTest_FcSubscriptionPublishToBus(DJI_FC_SUBSCRIPTION_TOPIC_QUATERNION, data, dataSize);
+    DjiTest_FcSubscriptionRecord(DJI_FC_SUBSCRIPTION_TOPIC_QUATERNION, data, dataSize, timestamp);
 
     pitch = (dji_f64_t) asinf(-2 * quaternion->q1 * quaternion->q3 + 2 * quaternion->q0 * quaternion->q2) * 57.3;
     roll = (dji_f64_t) atan2f(2 * quaternion->q2 * quaternion->q3 + 2 * quaternion->q0 * quaternion->q1,
@@ -352,4 +415,113 @@ static T_DjiReturnCode DjiTest_FcSubscriptionReceiveQuaternionCallback(const uin
     return DJI_ERROR_SYSTEM_MODULE_CODE_SUCCESS;
 }
 
+#ifdef SYSTEM_ARCH_LINUX
+static void DjiTest_FcSubscriptionAddBusTopics(void)
+{
+    T_DjiReturnCode returnCode;
+    uint32_t i;
+
+    /* The bus is for other local processes, the sample runs the same without it. */
+    for (i = 0; i < UTIL_ARRAY_SIZE(s_fcSubscriptionBusTopics); i++) {
+        returnCode = DjiTest_TelemetryBusAddDefaultTopic(s_fcSubscriptionBusTopics[i].topicName,
+                                                         s_fcSubscriptionBusTopics[i].schemaName, 1,
+                                                         s_fcSubscriptionBusTopics[i].layout,
+                                                         s_fcSubscriptionBusTopics[i].size,
+                                                         FC_SUBSCRIPTION_BUS_SLOT_COUNT,
+                                                         &s_fcSubscriptionBusTopicIds[i]);
+        if (returnCode != DJI_ERROR_SYSTEM_MODULE_CODE_SUCCESS) {
+            USER_LOG_WARN("Add telemetry bus topic %s error, stat = 0x%08llX", s_fcSubscriptionBusTopics[i].topicName,
+                          returnCode);
+            continue;
+        }
+        s_isFcSubscriptionBusTopicAdded[i] = true;
+    }
+}
+
+static void DjiTest_FcSubscriptionAddRecordChannels(void)
+{
+    T_DjiTestFlightRecorderChannelInfo channelInfo;
+    char layout[DJI_TEST_FLIGHT_RECORDER_LAYOUT_MAX_SIZE];
+    T_DjiReturnCode returnCode;
+    uint32_t i;
+
+    for (i = 0; i < UTIL_ARRAY_SIZE(s_fcSubscriptionBusTopics); i++) {
+        snprintf(layout, sizeof(layout), "%s%s", FC_SUBSCRIPTION_RECORD_LAYOUT, s_fcSubscriptionBusTopics[i].layout);
+        channelInfo.name = s_fcSubscriptionBusTopics[i].topicName;
+        channelInfo.schemaName = s_fcSubscriptionBusTopics[i].schemaName;
+        channelInfo.layout = layout;
+        returnCode = DjiTest_FlightRecorderAddChannel(&channelInfo, DjiTest_FcSubscriptionReplayRecord,
+                                                      (void *) &s_fcSubscriptionBusTopics[i],
+                                                      &s_fcSubscriptionRecordChannelIds[i]);
+        if (returnCode != DJI_ERROR_SYSTEM_MODULE_CODE_SUCCESS) {
+            USER_LOG_WARN("Add flight record channel %s error, stat = 0x%08llX",
+                          s_fcSubscriptionBusTopics[i].topicName, returnCode);
+            continue;
+        }
+        s_isFcSubscriptionRecordChannelAdded[i] = true;
+    }
+}
+
+static void DjiTest_FcSubscriptionReplayRecord(const T_DjiTestFlightRecordSample *sample, void *userData)
+{
+    const T_DjiTestFcSubscriptionBusTopic *busTopic = (const T_DjiTestFcSubscriptionBusTopic *) userData;
+    T_DjiDataTimestamp timestamp;
+
+    if (sample->headerLen != sizeof(T_DjiDataTimestamp) || sample->dataLen != busTopic->size) {
+        return;
+    }
+    memcpy(&timestamp, sample->header, sizeof(T_DjiDataTimestamp));
+
+    /* The quaternion arrives by callback, the other topics are polled and only go on to the bus. */
+    if (busTopic->topic == DJI_FC_SUBSCRIPTION_TOPIC_QUATERNION) {
+        DjiTest_FcSubscriptionReceiveQuaternionCallback(sample->data, (uint16_t) sample->dataLen, &timestamp);
+    } else {
+        DjiTest_FcSubscriptionPublishToBus(busTopic->topic, sample->data, (uint16_t) sample->dataLen);
+    }
+}
+#endif
+
+static void DjiTest_FcSubscriptionPublishToBus(E_DjiFcSubscriptionTopic topic, const uint8_t *data, uint16_t len)
+{
+#ifdef SYSTEM_ARCH_LINUX
+    uint32_t i;
+
+    for (i = 0; i < UTIL_ARRAY_SIZE(s_fcSubscriptionBusTopics); i++) {
+        if (s_fcSubscriptionBusTopics[i].topic == topic && s_isFcSubscriptionBusTopicAdded[i]) {
+            DjiTest_TelemetryBusPublish(DjiTest_TelemetryBusGetDefault(), s_fcSubscriptionBusTopicIds[i], data, len);
+            return;
+        }
+    }
+#else
+    USER_UTIL_UNUSED(topic);
+    USER_UTIL_UNUSED(data);
+    USER_UTIL_UNUSED(len);
+#endif
+}
+
+static void DjiTest_FcSubscriptionRecord(E_DjiFcSubscriptionTopic topic, const uint8_t *data, uint16_t len,
+                                         const T_DjiDataTimestamp *timestamp)
+{
+#ifdef SYSTEM_ARCH_LINUX
+    uint32_t i;
+
+    if (!DjiTest_FlightRecorderIsRecording()) {
+        return;
+    }
+
+    for (i = 0; i < UTIL_ARRAY_SIZE(s_fcSubscriptionBusTopics); i++) {
+        if (s_fcSubscriptionBusTopics[i].topic == topic && s_isFcSubscriptionRecordChannelAdded[i]) {
+            DjiTest_FlightRecorderWrite(s_fcSubscriptionRecordChannelIds[i], timestamp->microsecond, timestamp,
+                                        sizeof(T_DjiDataTimestamp), data, len);
+            return;
+        }
+    }
+#else
+    USER_UTIL_UNUSED(topic);
+    USER_UTIL_UNUSED(data);
+    USER_UTIL_UNUSED(len);
+    USER_UTIL_UNUSED(timestamp);
+#endif
+}
+
 /****************** (C) COPYRIGHT DJI Innovations *****END OF FILE****/
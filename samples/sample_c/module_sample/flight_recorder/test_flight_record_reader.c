@@ -0,0 +1,529 @@
+/**
+ ********************************************************************
+ * @file    test_flight_record_reader.c
+ * @brief   Reads the files of the flight recorder through their index, or by scanning when the index is missing.
+ *
+ * @copyright (c) 2021 DJI. All rights reserved.
+ *
+ * All information contained herein is, and remains, the property of DJI.
+ * The intellectual and technical concepts contained herein are proprietary
+ * to DJI and may be covered by U.S. and foreign patents, patents in process,
+ * and protected by trade secret or copyright law.  Dissemination of this
+ * information, including but not limited to data and other proprietary
+ * material(s) incorporated within the information, in any form, is strictly
+ * prohibited without the express written consent of DJI.
+ *
+ * If you receive this source code without DJI’s authorization, you may not
+ * further disseminate the information, and you must immediately remove the
+ * source code and notify DJI of its removal. DJI reserves the right to pursue
+ * legal actions against you for any loss(es) or damage(s) caused by your
+ * failure to do so.
+ *
+ *********************************************************************
+ */
+
+/* Includes ------------------------------------------------------------------*/
+#include "test_flight_recorder.h"
+
+#ifdef SYSTEM_ARCH_LINUX
+
+#include <string.h>
+#include <sys/types.h>
+#include "utils/util_zip.h"
+
+/* Private constants ---------------------------------------------------------*/
+#define DJI_TEST_FLIGHT_RECORD_CHUNK_MAX_SIZE       (256 * 1024 * 1024)
+#define DJI_TEST_FLIGHT_RECORD_ARRAY_INIT_CAPACITY  (256)
+
+#define DJI_TEST_FLIGHT_RECORD_ALIGN(size)          (((size) + 7U) & ~7U)
+
+/* Private types -------------------------------------------------------------*/
+
+/* Private functions declaration ---------------------------------------------*/
+static T_DjiReturnCode DjiTest_FlightRecordReaderLoadSummary(T_DjiTestFlightRecordReader *reader,
+                                                             uint64_t fileSize);
+static T_DjiReturnCode DjiTest_FlightRecordReaderScan(T_DjiTestFlightRecordReader *reader);
+static T_DjiReturnCode DjiTest_FlightRecordReaderScanChunk(T_DjiTestFlightRecordReader *reader, uint64_t offset,
+                                                           const T_DjiTestFlightRecordChunkHeader *chunkHeader);
+static T_DjiReturnCode DjiTest_FlightRecordReaderLoadChunk(T_DjiTestFlightRecordReader *reader, uint64_t offset,
+                                                           T_DjiTestFlightRecordChunkHeader *chunkHeader);
+static T_DjiReturnCode DjiTest_FlightRecordReaderParseRecord(const uint8_t *payload, uint32_t payloadSize,
+                                                             uint32_t offset, T_DjiTestFlightRecordSample *sample,
+                                                             uint32_t *recordSize);
+static T_DjiReturnCode DjiTest_FlightRecordReaderGrow(void **array, uint32_t count, uint32_t *capacity,
+                                                      size_t entrySize);
+
+/* Private values ------------------------------------------------------------*/
+
+/* Exported functions definition ---------------------------------------------*/
+T_DjiReturnCode DjiTest_FlightRecordReaderOpen(T_DjiTestFlightRecordReader *reader, const char *path)
+{
+    T_DjiOsalHandler *osalHandler = DjiPlatform_GetOsalHandler();
+    T_DjiTestFlightRecordFileHeader *fileHeader;
+    T_DjiReturnCode returnCode;
+    uint64_t fileSize;
+
+    if (reader == NULL || path == NULL) {
+        return DJI_ERROR_SYSTEM_MODULE_CODE_INVALID_PARAMETER;
+    }
+
+    memset(reader, 0, sizeof(T_DjiTestFlightRecordReader));
+    fileHeader = &reader->fileHeader;
+
+    reader->file = fopen(path, "rb");
+    if (reader->file == NULL) {
+        return DJI_ERROR_SYSTEM_MODULE_CODE_NOT_FOUND;
+    }
+
+    if (fread(fileHeader, sizeof(T_DjiTestFlightRecordFileHeader), 1, reader->file) != 1 ||
+        memcmp(fileHeader->magic, DJI_TEST_FLIGHT_RECORD_FILE_MAGIC, DJI_TEST_FLIGHT_RECORD_MAGIC_SIZE) != 0 ||
+        fileHeader->version != DJI_TEST_FLIGHT_RECORD_FORMAT_VERSION ||
+        fileHeader->headerSize < sizeof(T_DjiTestFlightRecordFileHeader) ||
+        fileHeader->chunkSize <= sizeof(T_DjiTestFlightRecordChunkHeader) ||
+        fileHeader->chunkSize > DJI_TEST_FLIGHT_RECORD_CHUNK_MAX_SIZE) {
+        returnCode = DJI_ERROR_SYSTEM_MODULE_CODE_ADAPTER_NOT_MATCH;
+        goto CloseFile;
+    }
+
+    reader->chunkBuffer = osalHandler->Malloc(fileHeader->chunkSize);
+    if (reader->chunkBuffer == NULL) {
+        returnCode = DJI_ERROR_SYSTEM_MODULE_CODE_MEMORY_ALLOC_FAILED;
+        goto CloseFile;
+    }
+
+    if (fseeko(reader->file, 0, SEEK_END) != 0) {
+        returnCode = DJI_ERROR_SYSTEM_MODULE_CODE_SYSTEM_ERROR;
+        goto CloseFile;
+    }
+    fileSize = (uint64_t) ftello(reader->file);
+
+    /* A recording that was not stopped has no footer, everything up to the last complete chunk is still there. */
+    returnCode = DjiTest_FlightRecordReaderLoadSummary(reader, fileSize);
+    if (returnCode != DJI_ERROR_SYSTEM_MODULE_CODE_SUCCESS) {
+        reader->isRecovered = true;
+        returnCode = DjiTest_FlightRecordReaderScan(reader);
+    }
+    if (returnCode != DJI_ERROR_SYSTEM_MODULE_CODE_SUCCESS) {
+        goto CloseFile;
+    }
+
+    DjiTest_FlightRecordReaderSeek(reader, 0);
+
+    return DJI_ERROR_SYSTEM_MODULE_CODE_SUCCESS;
+
+CloseFile:
+    DjiTest_FlightRecordReaderClose(reader);
+
+    return returnCode;
+}
+
+T_DjiReturnCode DjiTest_FlightRecordReaderClose(T_DjiTestFlightRecordReader *reader)
+{
+    T_DjiOsalHandler *osalHandler = DjiPlatform_GetOsalHandler();
+
+    if (reader == NULL) {
+        return DJI_ERROR_SYSTEM_MODULE_CODE_INVALID_PARAMETER;
+    }
+
+    if (reader->file != NULL) {
+        fclose(reader->file);
+    }
+    osalHandler->Free(reader->chunkBuffer);
+    osalHandler->Free(reader->index);
+    osalHandler->Free(reader->chunks);
+    memset(reader, 0, sizeof(T_DjiTestFlightRecordReader));
+
+    return DJI_ERROR_SYSTEM_MODULE_CODE_SUCCESS;
+}
+
+T_DjiReturnCode DjiTest_FlightRecordReaderFindChannel(const T_DjiTestFlightRecordReader *reader, const char *name,
+                                                      uint16_t *channelId)
+{
+    uint32_t i;
+
+    if (reader == NULL || name == NULL || channelId == NULL) {
+        return DJI_ERROR_SYSTEM_MODULE_CODE_INVALID_PARAMETER;
+    }
+
+    for (i = 0; i < DJI_TEST_FLIGHT_RECORDER_CHANNEL_MAX_NUM; i++) {
+        if ((reader->definedChannelMask & (1ULL << i)) != 0 &&
+            strcmp(reader->channels[i].definition.name, name) == 0) {
+            *channelId = (uint16_t) i;
+            return DJI_ERROR_SYSTEM_MODULE_CODE_SUCCESS;
+        }
+    }
+
+    return DJI_ERROR_SYSTEM_MODULE_CODE_NOT_FOUND;
+}
+
+void DjiTest_FlightRecordReaderSetChannelMask(T_DjiTestFlightRecordReader *reader, uint64_t channelMask)
+{
+    reader->channelMask = channelMask;
+    DjiTest_FlightRecordReaderSeek(reader, reader->startTimeUs);
+}
+
+void DjiTest_FlightRecordReaderSeek(T_DjiTestFlightRecordReader *reader, uint64_t timeUs)
+{
+    uint32_t low = 0;
+    uint32_t high = reader->chunkCount;
+    uint32_t middle;
+
+    /* Chunks are in time order, the first one ending at or after the time may hold the first record to read. */
+    while (low < high) {
+        middle = low + (high - low) / 2;
+        if (reader->chunks[middle].endTimeUs < timeUs) {
+            low = middle + 1;
+        } else {
+            high = middle;
+        }
+    }
+
+    reader->startTimeUs = timeUs;
+    reader->nextChunk = low;
+    reader->chunkOffset = 0;
+    reader->chunkPayloadSize = 0;
+}
+
+T_DjiReturnCode DjiTest_FlightRecordReaderReadNext(T_DjiTestFlightRecordReader *reader,
+                                                   T_DjiTestFlightRecordSample *sample)
+{
+    T_DjiTestFlightRecordChunkHeader chunkHeader;
+    const T_DjiTestFlightRecordChunkInfo *chunk;
+    T_DjiReturnCode returnCode;
+    uint32_t recordSize;
+
+    if (reader == NULL || reader->file == NULL || sample == NULL) {
+        return DJI_ERROR_SYSTEM_MODULE_CODE_INVALID_PARAMETER;
+    }
+
+    while (true) {
+        while (reader->chunkOffset < reader->chunkPayloadSize) {
+            returnCode = DjiTest_FlightRecordReaderParseRecord(reader->chunkBuffer, reader->chunkPayloadSize,
+                                                               reader->chunkOffset, sample, &recordSize);
+            if (returnCode != DJI_ERROR_SYSTEM_MODULE_CODE_SUCCESS) {
+                return returnCode;
+            }
+            reader->chunkOffset += recordSize;
+
+            if (sample->channelId == DJI_TEST_FLIGHT_RECORD_DEFINITION_CHANNEL ||
+                sample->monotonicUs < reader->startTimeUs ||
+                (reader->channelMask != 0 && (reader->channelMask & (1ULL << sample->channelId)) == 0)) {
+                continue;
+            }
+
+            return DJI_ERROR_SYSTEM_MODULE_CODE_SUCCESS;
+        }
+
+        /* The index tells which chunks hold the selected channels, the others are never read. */
+        while (reader->nextChunk < reader->chunkCount && reader->channelMask != 0 &&
+               (reader->chunks[reader->nextChunk].channelMask & reader->channelMask) == 0) {
+            reader->nextChunk++;
+        }
+        if (reader->nextChunk >= reader->chunkCount) {
+            return DJI_ERROR_SYSTEM_MODULE_CODE_NOT_FOUND;
+        }
+
+        chunk = &reader->chunks[reader->nextChunk++];
+        returnCode = DjiTest_FlightRecordReaderLoadChunk(reader, chunk->offset, &chunkHeader);
+        if (returnCode != DJI_ERROR_SYSTEM_MODULE_CODE_SUCCESS) {
+            return returnCode;
+        }
+        reader->chunkOffset = 0;
+        reader->chunkPayloadSize = chunkHeader.payloadSize;
+    }
+}
+
+/* Private functions definition-----------------------------------------------*/
+static T_DjiReturnCode DjiTest_FlightRecordReaderLoadSummary(T_DjiTestFlightRecordReader *reader, uint64_t fileSize)
+{
+    T_DjiOsalHandler *osalHandler = DjiPlatform_GetOsalHandler();
+    T_DjiTestFlightRecordFooter *footer = &reader->footer;
+    T_DjiTestFlightRecordChannelSummary summary;
+    T_DjiTestFlightRecordIndexEntry *entry;
+    T_DjiTestFlightRecordChunkInfo *chunk = NULL;
+    uint32_t i;
+
+    if (fileSize < reader->fileHeader.headerSize + sizeof(T_DjiTestFlightRecordFooter) ||
+        fseeko(reader->file, (off_t) (fileSize - sizeof(T_DjiTestFlightRecordFooter)), SEEK_SET) != 0 ||
+        fread(footer, sizeof(T_DjiTestFlightRecordFooter), 1, reader->file) != 1 ||
+        memcmp(footer->magic, DJI_TEST_FLIGHT_RECORD_FOOTER_MAGIC, DJI_TEST_FLIGHT_RECORD_MAGIC_SIZE) != 0 ||
+        footer->channelCount > DJI_TEST_FLIGHT_RECORDER_CHANNEL_MAX_NUM ||
+        footer->summaryOffset + (uint64_t) footer->channelCount * sizeof(T_DjiTestFlightRecordChannelSummary) +
+        (uint64_t) footer->indexCount * sizeof(T_DjiTestFlightRecordIndexEntry) +
+        sizeof(T_DjiTestFlightRecordFooter) != fileSize ||
+        fseeko(reader->file, (off_t) footer->summaryOffset, SEEK_SET) != 0) {
+        memset(footer, 0, sizeof(T_DjiTestFlightRecordFooter));
+        return DJI_ERROR_SYSTEM_MODULE_CODE_NOT_FOUND;
+    }
+
+    for (i = 0; i < footer->channelCount; i++) {
+        if (fread(&summary, sizeof(summary), 1, reader->file) != 1 || summary.definition.channelId != i) {
+            return DJI_ERROR_SYSTEM_MODULE_CODE_ADAPTER_NOT_MATCH;
+        }
+        summary.definition.name[DJI_TEST_FLIGHT_RECORDER_NAME_MAX_SIZE - 1] = '\0';
+        summary.definition.schemaName[DJI_TEST_FLIGHT_RECORDER_NAME_MAX_SIZE - 1] = '\0';
+        summary.definition.layout[DJI_TEST_FLIGHT_RECORDER_LAYOUT_MAX_SIZE - 1] = '\0';
+        reader->channels[i] = summary;
+        reader->definedChannelMask |= 1ULL << i;
+    }
+
+    if (footer->indexCount == 0) {
+        return DJI_ERROR_SYSTEM_MODULE_CODE_SUCCESS;
+    }
+
+    reader->index = osalHandler->Malloc((size_t) footer->indexCount * sizeof(T_DjiTestFlightRecordIndexEntry));
+    reader->chunks = osalHandler->Malloc((size_t) footer->indexCount * sizeof(T_DjiTestFlightRecordChunkInfo));
+    if (reader->index == NULL || reader->chunks == NULL) {
+        return DJI_ERROR_SYSTEM_MODULE_CODE_MEMORY_ALLOC_FAILED;
+    }
+    if (fread(reader->index, sizeof(T_DjiTestFlightRecordIndexEntry), footer->indexCount, reader->file) !=
+        footer->indexCount) {
+        return DJI_ERROR_SYSTEM_MODULE_CODE_SYSTEM_ERROR;
+    }
+    reader->indexCount = footer->indexCount;
+    reader->indexCapacity = footer->indexCount;
+    reader->chunkCapacity = footer->indexCount;
+
+    /* Entries of one chunk are adjacent, the chunk table is folded from them. */
+    for (i = 0; i < reader->indexCount; i++) {
+        entry = &reader->index[i];
+        if (entry->channelId >= footer->channelCount || entry->chunkOffset >= footer->summaryOffset) {
+            return DJI_ERROR_SYSTEM_MODULE_CODE_ADAPTER_NOT_MATCH;
+        }
+        if (chunk == NULL || chunk->offset != entry->chunkOffset) {
+            chunk = &reader->chunks[reader->chunkCount++];
+            chunk->offset = entry->chunkOffset;
+            chunk->startTimeUs = entry->startTimeUs;
+            chunk->endTimeUs = entry->endTimeUs;
+            chunk->channelMask = 0;
+        }
+        chunk->startTimeUs = entry->startTimeUs < chunk->startTimeUs ? entry->startTimeUs : chunk->startTimeUs;
+        chunk->endTimeUs = entry->endTimeUs > chunk->endTimeUs ? entry->endTimeUs : chunk->endTimeUs;
+        chunk->channelMask |= 1ULL << entry->channelId;
+    }
+
+    return DJI_ERROR_SYSTEM_MODULE_CODE_SUCCESS;
+}
+
+static T_DjiReturnCode DjiTest_FlightRecordReaderScan(T_DjiTestFlightRecordReader *reader)
+{
+    T_DjiOsalHandler *osalHandler = DjiPlatform_GetOsalHandler();
+    T_DjiTestFlightRecordChunkHeader chunkHeader;
+    uint64_t offset = reader->fileHeader.headerSize;
+    T_DjiReturnCode returnCode;
+
+    /* Whatever the summary left behind is dropped and rebuilt from the chunks. */
+    osalHandler->Free(reader->index);
+    osalHandler->Free(reader->chunks);
+    reader->index = NULL;
+    reader->chunks = NULL;
+    reader->indexCount = 0;
+    reader->indexCapacity = 0;
+    reader->chunkCount = 0;
+    reader->chunkCapacity = 0;
+    reader->definedChannelMask = 0;
+    memset(reader->channels, 0, sizeof(reader->channels));
+    memset(&reader->footer, 0, sizeof(T_DjiTestFlightRecordFooter));
+
+    while (DjiTest_FlightRecordReaderLoadChunk(reader, offset, &chunkHeader) == DJI_ERROR_SYSTEM_MODULE_CODE_SUCCESS) {
+        returnCode = DjiTest_FlightRecordReaderScanChunk(reader, offset, &chunkHeader);
+        if (returnCode == DJI_ERROR_SYSTEM_MODULE_CODE_MEMORY_ALLOC_FAILED) {
+            return returnCode;
+        } else if (returnCode != DJI_ERROR_SYSTEM_MODULE_CODE_SUCCESS) {
+            break;
+        }
+        offset += sizeof(T_DjiTestFlightRecordChunkHeader) + chunkHeader.payloadSize;
+    }
+
+    reader->footer.summaryOffset = offset;
+    reader->footer.indexCount = reader->indexCount;
+    for (reader->footer.channelCount = DJI_TEST_FLIGHT_RECORDER_CHANNEL_MAX_NUM;
+         reader->footer.channelCount > 0 &&
+         (reader->definedChannelMask & (1ULL << (reader->footer.channelCount - 1))) == 0;
+         reader->footer.channelCount--) {
+    }
+
+    return DJI_ERROR_SYSTEM_MODULE_CODE_SUCCESS;
+}
+
+static T_DjiReturnCode DjiTest_FlightRecordReaderScanChunk(T_DjiTestFlightRecordReader *reader, uint64_t offset,
+                                                           const T_DjiTestFlightRecordChunkHeader *chunkHeader)
+{
+    T_DjiTestFlightRecordIndexEntry entries[DJI_TEST_FLIGHT_RECORDER_CHANNEL_MAX_NUM];
+    T_DjiTestFlightRecordChannelDefinition definition;
+    T_DjiTestFlightRecordChannelSummary *channel;
+    T_DjiTestFlightRecordChunkInfo *chunk;
+    T_DjiTestFlightRecordSample sample;
+    T_DjiReturnCode returnCode;
+    uint64_t channelMask = 0;
+    uint32_t chunkOffset = 0;
+    uint32_t recordCount = 0;
+    uint32_t recordSize;
+    uint32_t i;
+
+    while (chunkOffset < chunkHeader->payloadSize) {
+        returnCode = DjiTest_FlightRecordReaderParseRecord(reader->chunkBuffer, chunkHeader->payloadSize,
+                                                           chunkOffset, &sample, &recordSize);
+        if (returnCode != DJI_ERROR_SYSTEM_MODULE_CODE_SUCCESS) {
+            return returnCode;
+        }
+        chunkOffset += recordSize;
+        recordCount++;
+
+        if (sample.channelId == DJI_TEST_FLIGHT_RECORD_DEFINITION_CHANNEL) {
+            if (sample.dataLen != sizeof(definition)) {
+                return DJI_ERROR_SYSTEM_MODULE_CODE_ADAPTER_NOT_MATCH;
+            }
+            memcpy(&definition, sample.data, sizeof(definition));
+            if (definition.channelId >= DJI_TEST_FLIGHT_RECORDER_CHANNEL_MAX_NUM) {
+                return DJI_ERROR_SYSTEM_MODULE_CODE_ADAPTER_NOT_MATCH;
+            }
+            definition.name[DJI_TEST_FLIGHT_RECORDER_NAME_MAX_SIZE - 1] = '\0';
+            definition.schemaName[DJI_TEST_FLIGHT_RECORDER_NAME_MAX_SIZE - 1] = '\0';
+            definition.layout[DJI_TEST_FLIGHT_RECORDER_LAYOUT_MAX_SIZE - 1] = '\0';
+            reader->channels[definition.channelId].definition = definition;
+            reader->definedChannelMask |= 1ULL << definition.channelId;
+            continue;
+        }
+
+        if ((reader->definedChannelMask & (1ULL << sample.channelId)) == 0) {
+            return DJI_ERROR_SYSTEM_MODULE_CODE_ADAPTER_NOT_MATCH;
+        }
+        channel = &reader->channels[sample.channelId];
+        channel->recordCount++;
+        channel->byteCount += (uint64_t) sample.headerLen + sample.dataLen;
+        if ((uint32_t) sample.headerLen + sample.dataLen > channel->maxRecordSize) {
+            channel->maxRecordSize = (uint32_t) sample.headerLen + sample.dataLen;
+        }
+
+        if ((channelMask & (1ULL << sample.channelId)) == 0) {
+            channelMask |= 1ULL << sample.channelId;
+            memset(&entries[sample.channelId], 0, sizeof(T_DjiTestFlightRecordIndexEntry));
+            entries[sample.channelId].chunkOffset = offset;
+            entries[sample.channelId].channelId = sample.channelId;
+            entries[sample.channelId].startTimeUs = sample.monotonicUs;
+        }
+        entries[sample.channelId].endTimeUs = sample.monotonicUs;
+        entries[sample.channelId].recordCount++;
+        reader->footer.recordCount++;
+    }
+    if (recordCount != chunkHeader->recordCount) {
+        return DJI_ERROR_SYSTEM_MODULE_CODE_ADAPTER_NOT_MATCH;
+    }
+    reader->footer.chunkCount++;
+
+    if (channelMask == 0) {
+        return DJI_ERROR_SYSTEM_MODULE_CODE_SUCCESS;
+    }
+
+    returnCode = DjiTest_FlightRecordReaderGrow((void **) &reader->chunks, reader->chunkCount + 1,
+                                                &reader->chunkCapacity,
+                                                sizeof(T_DjiTestFlightRecordChunkInfo));
+    if (returnCode != DJI_ERROR_SYSTEM_MODULE_CODE_SUCCESS) {
+        return returnCode;
+    }
+    chunk = &reader->chunks[reader->chunkCount++];
+    chunk->offset = offset;
+    chunk->startTimeUs = chunkHeader->startTimeUs;
+    chunk->endTimeUs = chunkHeader->endTimeUs;
+    chunk->channelMask = channelMask;
+
+    for (i = 0; i < DJI_TEST_FLIGHT_RECORDER_CHANNEL_MAX_NUM; i++) {
+        if ((channelMask & (1ULL << i)) == 0) {
+            continue;
+        }
+        returnCode = DjiTest_FlightRecordReaderGrow((void **) &reader->index, reader->indexCount + 1,
+                                                    &reader->indexCapacity, sizeof(T_DjiTestFlightRecordIndexEntry));
+        if (returnCode != DJI_ERROR_SYSTEM_MODULE_CODE_SUCCESS) {
+            return returnCode;
+        }
+        reader->index[reader->indexCount++] = entries[i];
+    }
+
+    return DJI_ERROR_SYSTEM_MODULE_CODE_SUCCESS;
+}
+
+static T_DjiReturnCode DjiTest_FlightRecordReaderLoadChunk(T_DjiTestFlightRecordReader *reader, uint64_t offset,
+                                                           T_DjiTestFlightRecordChunkHeader *chunkHeader)
+{
+    if (fseeko(reader->file, (off_t) offset, SEEK_SET) != 0 ||
+        fread(chunkHeader, sizeof(T_DjiTestFlightRecordChunkHeader), 1, reader->file) != 1) {
+        return DJI_ERROR_SYSTEM_MODULE_CODE_NOT_FOUND;
+    }
+    if (chunkHeader->magic != DJI_TEST_FLIGHT_RECORD_CHUNK_MAGIC ||
+        chunkHeader->payloadSize > reader->fileHeader.chunkSize - sizeof(T_DjiTestFlightRecordChunkHeader)) {
+        return DJI_ERROR_SYSTEM_MODULE_CODE_ADAPTER_NOT_MATCH;
+    }
+    if (fread(reader->chunkBuffer, 1, chunkHeader->payloadSize, reader->file) != chunkHeader->payloadSize) {
+        return DJI_ERROR_SYSTEM_MODULE_CODE_NOT_FOUND;
+    }
+    if (UtilZip_Crc32(0, reader->chunkBuffer, chunkHeader->payloadSize) != chunkHeader->crc32) {
+        return DJI_ERROR_SYSTEM_MODULE_CODE_ADAPTER_NOT_MATCH;
+    }
+
+    return DJI_ERROR_SYSTEM_MODULE_CODE_SUCCESS;
+}
+
+static T_DjiReturnCode DjiTest_FlightRecordReaderParseRecord(const uint8_t *payload, uint32_t payloadSize,
+                                                             uint32_t offset, T_DjiTestFlightRecordSample *sample,
+                                                             uint32_t *recordSize)
+{
+    T_DjiTestFlightRecordRecordHeader recordHeader;
+    uint64_t size;
+
+    if (payloadSize - offset < sizeof(recordHeader)) {
+        return DJI_ERROR_SYSTEM_MODULE_CODE_ADAPTER_NOT_MATCH;
+    }
+    memcpy(&recordHeader, payload + offset, sizeof(recordHeader));
+
+    size = sizeof(recordHeader) + DJI_TEST_FLIGHT_RECORD_ALIGN((uint64_t) recordHeader.headerLen +
+                                                               recordHeader.dataLen);
+    if (size > payloadSize - offset ||
+        (recordHeader.channelId != DJI_TEST_FLIGHT_RECORD_DEFINITION_CHANNEL &&
+         recordHeader.channelId >= DJI_TEST_FLIGHT_RECORDER_CHANNEL_MAX_NUM)) {
+        return DJI_ERROR_SYSTEM_MODULE_CODE_ADAPTER_NOT_MATCH;
+    }
+
+    sample->channelId = recordHeader.channelId;
+    sample->headerLen = recordHeader.headerLen;
+    sample->dataLen = recordHeader.dataLen;
+    sample->sequence = recordHeader.sequence;
+    sample->monotonicUs = recordHeader.monotonicUs;
+    sample->aircraftUs = recordHeader.aircraftUs;
+    sample->header = payload + offset + sizeof(recordHeader);
+    sample->data = sample->header + recordHeader.headerLen;
+    *recordSize = (uint32_t) size;
+
+    return DJI_ERROR_SYSTEM_MODULE_CODE_SUCCESS;
+}
+
+static T_DjiReturnCode DjiTest_FlightRecordReaderGrow(void **array, uint32_t count, uint32_t *capacity,
+                                                      size_t entrySize)
+{
+    T_DjiOsalHandler *osalHandler = DjiPlatform_GetOsalHandler();
+    uint32_t newCapacity;
+    void *newArray;
+
+    if (count <= *capacity && *array != NULL) {
+        return DJI_ERROR_SYSTEM_MODULE_CODE_SUCCESS;
+    }
+
+    newCapacity = *capacity < DJI_TEST_FLIGHT_RECORD_ARRAY_INIT_CAPACITY ? DJI_TEST_FLIGHT_RECORD_ARRAY_INIT_CAPACITY :
+                  *capacity * 2;
+    newArray = osalHandler->Malloc((size_t) newCapacity * entrySize);
+    if (newArray == NULL) {
+        return DJI_ERROR_SYSTEM_MODULE_CODE_MEMORY_ALLOC_FAILED;
+    }
+    if (*array != NULL) {
+        memcpy(newArray, *array, (size_t) (count - 1) * entrySize);
+        osalHandler->Free(*array);
+    }
+    *array = newArray;
+    *capacity = newCapacity;
+
+    return DJI_ERROR_SYSTEM_MODULE_CODE_SUCCESS;
+}
+
+#endif
+
+/****************** (C) COPYRIGHT DJI Innovations *****END OF FILE****/
@@ -0,0 +1,1053 @@
+/**
+ ********************************************************************
+ * @file    test_flight_recorder.c
+ * @brief   Records the data arriving through the SDK into one time-aligned chunked file and replays it.
+ *
+ * @copyright (c) 2021 DJI. All rights reserved.
+ *
+ * All information contained herein is, and remains, the property of DJI.
+ * The intellectual and technical concepts contained herein are proprietary
+ * to DJI and may be covered by U.S. and foreign patents, patents in process,
+ * and protected by trade secret or copyright law.  Dissemination of this
+ * information, including but not limited to data and other proprietary
+ * material(s) incorporated within the information, in any form, is strictly
+ * prohibited without the express written consent of DJI.
+ *
+ * If you receive this source code without DJI’s authorization, you may not
+ * further disseminate the information, and you must immediately remove the
+ * source code and notify DJI of its removal. DJI reserves the right to pursue
+ * legal actions against you for any loss(es) or damage(s) caused by your
+ * failure to do so.
+ *
+ *********************************************************************
+ */
+
+/* Includes ------------------------------------------------------------------*/
+#include "test_flight_recorder.h"
+
+#ifdef SYSTEM_ARCH_LINUX
+
+#include <errno.h>
+#include <pthread.h>
+#include <string.h>
+#include <time.h>
+#include <sys/stat.h>
+#include "dji_logger.h"
+#include "utils/util_misc.h"
+#include "utils/util_dlist.h"
+#include "utils/util_pool.h"
+#include "utils/util_zip.h"
+
+/* Private constants ---------------------------------------------------------*/
+#define DJI_TEST_FLIGHT_RECORDER_DEFAULT_CHUNK_SIZE         (4 * 1024 * 1024)
+#define DJI_TEST_FLIGHT_RECORDER_DEFAULT_CHUNK_COUNT        (8)
+#define DJI_TEST_FLIGHT_RECORDER_DEFAULT_MAX_LATENCY_MS     (200)
+#define DJI_TEST_FLIGHT_RECORDER_CHUNK_MIN_SIZE             (64 * 1024)
+#define DJI_TEST_FLIGHT_RECORDER_INDEX_INIT_CAPACITY        (1024)
+#define DJI_TEST_FLIGHT_RECORDER_TASK_STACK_SIZE            (4096)
+#define DJI_TEST_FLIGHT_RECORDER_REPLAY_SLEEP_MAX_MS        (50)
+#define DJI_TEST_FLIGHT_RECORDER_CHANNEL_UNRESOLVED         (0xFFFF)
+#define DJI_TEST_FLIGHT_RECORDER_CHANNEL_REJECTED           (0xFFFE)
+
+#define DJI_TEST_FLIGHT_RECORD_ALIGN(size)                  (((size) + 7U) & ~7U)
+
+/* Private types -------------------------------------------------------------*/
+typedef struct {
+    uint32_t recordCount;
+    uint64_t startTimeUs;
+    uint64_t endTimeUs;
+} T_DjiTestFlightRecordChunkChannel;
+
+/**
+ * @brief A chunk buffer, the header is filled in by the writer task just before the buffer goes to the file.
+ */
+typedef struct {
+    T_UtilDlistNode node;
+    uint8_t *buffer;
+    uint32_t used;                  /*!< Payload bytes after the chunk header. */
+    uint32_t recordCount;
+    uint64_t startTimeUs;
+    uint64_t endTimeUs;
+    uint64_t channelMask;
+    T_DjiTestFlightRecordChunkChannel channels[DJI_TEST_FLIGHT_RECORDER_CHANNEL_MAX_NUM];
+} T_DjiTestFlightRecordChunk;
+
+typedef struct {
+    T_DjiTestFlightRecordChannelDefinition definition;
+    DjiTestFlightRecorderReplayHandler handler;
+    void *userData;
+    uint32_t recordCount;
+    uint32_t droppedCount;
+    uint32_t maxRecordSize;
+    uint64_t byteCount;
+} T_DjiTestFlightRecorderChannel;
+
+/**
+ * @brief The control mutex serializes start, stop and replay. The channel mutex guards the channel table and the
+ * replay handlers and is held while a handler runs. The record mutex guards the chunks and the statistics, it is
+ * taken inside the channel mutex when a handler records again.
+ */
+typedef struct {
+    T_DjiMutexHandle controlMutex;
+    T_DjiMutexHandle channelMutex;
+    T_DjiMutexHandle recordMutex;
+    T_DjiTestFlightRecorderChannel channels[DJI_TEST_FLIGHT_RECORDER_CHANNEL_MAX_NUM];
+    uint32_t channelCount;
+    bool isRecording;
+    T_DjiTestFlightRecorderConfig config;
+    char path[DJI_TEST_FLIGHT_RECORDER_PATH_MAX_SIZE * 2];
+    FILE *file;
+    uint8_t *chunkMemory;
+    uint8_t *chunkPoolMemory;
+    T_UtilPool chunkPool;
+    T_DjiTestFlightRecordChunk *currentChunk;
+    T_UtilDlist pendingList;
+    uint32_t sequence;
+    uint64_t startMonotonicUs;
+    T_DjiTaskHandle writerTask;
+    T_DjiSemaHandle dataSema;
+    T_DjiSemaHandle exitSema;
+    bool stopWriter;
+    T_DjiTestFlightRecordIndexEntry *index;     /*!< Owned by the writer task until it exits. */
+    uint32_t indexCount;
+    uint32_t indexCapacity;
+    uint64_t fileOffset;
+    T_DjiTestFlightRecorderStatistics statistics;
+} T_DjiTestFlightRecorderState;
+
+typedef struct {
+    T_DjiTestFlightRecordReader reader;
+    T_DjiTaskHandle task;
+    T_DjiSemaHandle exitSema;
+    double rate;
+    bool isLoop;
+    bool stop;
+    bool isRunning;
+    bool isFinished;
+    uint16_t channelMap[DJI_TEST_FLIGHT_RECORDER_CHANNEL_MAX_NUM];    /*!< File channel to registered channel. */
+} T_DjiTestFlightReplayState;
+
+/* Private functions declaration ---------------------------------------------*/
+static void DjiTest_FlightRecorderInit(void);
+static uint64_t DjiTest_FlightRecorderGetMonotonicUs(void);
+static T_DjiReturnCode DjiTest_FlightRecorderOpenFile(void);
+static void DjiTest_FlightRecorderCloseFile(void);
+static void DjiTest_FlightRecorderFreeChunks(void);
+static T_DjiReturnCode DjiTest_FlightRecorderAppend(uint16_t channelId, uint64_t aircraftUs, const void *header,
+                                                    uint16_t headerLen, const void *data, uint32_t dataLen,
+                                                    bool *isSealed);
+static void DjiTest_FlightRecorderSealChunk(void);
+static void DjiTest_FlightRecorderWriteChunk(T_DjiTestFlightRecordChunk *chunk);
+static T_DjiReturnCode DjiTest_FlightRecorderAddIndexEntry(const T_DjiTestFlightRecordIndexEntry *entry);
+static void *DjiTest_FlightRecorderWriterTask(void *arg);
+static void DjiTest_FlightRecorderDispatch(const T_DjiTestFlightRecordSample *sample);
+static void *DjiTest_FlightRecorderReplayTask(void *arg);
+
+/* Private values ------------------------------------------------------------*/
+static pthread_once_t s_flightRecorderOnce = PTHREAD_ONCE_INIT;
+static bool s_isFlightRecorderReady = false;
+static T_DjiTestFlightRecorderState s_flightRecorder;
+static T_DjiTestFlightReplayState s_flightReplay;
+
+/* Exported functions definition ---------------------------------------------*/
+void DjiTest_FlightRecorderGetDefaultConfig(T_DjiTestFlightRecorderConfig *config)
+{
+    config->directory = NULL;
+    config->prefix = "flight";
+    config->chunkSize = DJI_TEST_FLIGHT_RECORDER_DEFAULT_CHUNK_SIZE;
+    config->chunkCount = DJI_TEST_FLIGHT_RECORDER_DEFAULT_CHUNK_COUNT;
+    config->maxLatencyMs = DJI_TEST_FLIGHT_RECORDER_DEFAULT_MAX_LATENCY_MS;
+}
+
+T_DjiReturnCode DjiTest_FlightRecorderAddChannel(const T_DjiTestFlightRecorderChannelInfo *info,
+                                                 DjiTestFlightRecorderReplayHandler handler, void *userData,
+                                                 uint16_t *channelId)
+{
+    T_DjiOsalHandler *osalHandler = DjiPlatform_GetOsalHandler();
+    T_DjiTestFlightRecorderChannel *channel;
+    T_DjiReturnCode returnCode = DJI_ERROR_SYSTEM_MODULE_CODE_SUCCESS;
+    const char *layout;
+    bool isSealed = false;
+    uint32_t i;
+
+    if (info == NULL || info->name == NULL || info->schemaName == NULL || channelId == NULL ||
+        strlen(info->name) >= DJI_TEST_FLIGHT_RECORDER_NAME_MAX_SIZE ||
+        strlen(info->schemaName) >= DJI_TEST_FLIGHT_RECORDER_NAME_MAX_SIZE ||
+        (info->layout != NULL && strlen(info->layout) >= DJI_TEST_FLIGHT_RECORDER_LAYOUT_MAX_SIZE)) {
+        return DJI_ERROR_SYSTEM_MODULE_CODE_INVALID_PARAMETER;
+    }
+
+    pthread_once(&s_flightRecorderOnce, DjiTest_FlightRecorderInit);
+    if (!s_isFlightRecorderReady) {
+        return DJI_ERROR_SYSTEM_MODULE_CODE_SYSTEM_ERROR;
+    }
+    layout = info->layout != NULL ? info->layout : "";
+
+    osalHandler->MutexLock(s_flightRecorder.channelMutex);
+
+    /* A sample started again gets its channel back, the id stays valid for the whole process. */
+    for (i = 0; i < s_flightRecorder.channelCount; i++) {
+        channel = &s_flightRecorder.channels[i];
+        if (strcmp(channel->definition.name, info->name) != 0) {
+            continue;
+        }
+        if (strcmp(channel->definition.schemaName, info->schemaName) != 0 ||
+            strcmp(channel->definition.layout, layout) != 0) {
+            returnCode = DJI_ERROR_SYSTEM_MODULE_CODE_DUPLICATE;
+        } else {
+            channel->handler = handler;
+            channel->userData = userData;
+            *channelId = (uint16_t) i;
+        }
+        osalHandler->MutexUnlock(s_flightRecorder.channelMutex);
+        return returnCode;
+    }
+
+    if (s_flightRecorder.channelCount >= DJI_TEST_FLIGHT_RECORDER_CHANNEL_MAX_NUM) {
+        osalHandler->MutexUnlock(s_flightRecorder.channelMutex);
+        return DJI_ERROR_SYSTEM_MODULE_CODE_OUT_OF_RANGE;
+    }
+
+    channel = &s_flightRecorder.channels[s_flightRecorder.channelCount];
+    memset(channel, 0, sizeof(T_DjiTestFlightRecorderChannel));
+    channel->definition.channelId = (uint16_t) s_flightRecorder.channelCount;
+    strcpy(channel->definition.name, info->name);
+    strcpy(channel->definition.schemaName, info->schemaName);
+    strcpy(channel->definition.layout, layout);
+    channel->handler = handler;
+    channel->userData = userData;
+    *channelId = channel->definition.channelId;
+
+    /* Published after the entry is complete, writers check the id against the count without a lock. */
+    __atomic_store_n(&s_flightRecorder.channelCount, s_flightRecorder.channelCount + 1, __ATOMIC_RELEASE);
+
+    osalHandler->MutexLock(s_flightRecorder.recordMutex);
+    if (s_flightRecorder.isRecording) {
+        DjiTest_FlightRecorderAppend(DJI_TEST_FLIGHT_RECORD_DEFINITION_CHANNEL, 0, NULL, 0, &channel->definition,
+                                     sizeof(T_DjiTestFlightRecordChannelDefinition), &isSealed);
+    }
+    osalHandler->MutexUnlock(s_flightRecorder.recordMutex);
+    osalHandler->MutexUnlock(s_flightRecorder.channelMutex);
+
+    if (isSealed) {
+        osalHandler->SemaphorePost(s_flightRecorder.dataSema);
+    }
+
+    return DJI_ERROR_SYSTEM_MODULE_CODE_SUCCESS;
+}
+
+T_DjiReturnCode DjiTest_FlightRecorderSetReplayHandler(uint16_t channelId, DjiTestFlightRecorderReplayHandler handler,
+                                                       void *userData)
+{
+    T_DjiOsalHandler *osalHandler = DjiPlatform_GetOsalHandler();
+
+    if (!s_isFlightRecorderReady || channelId >= __atomic_load_n(&s_flightRecorder.channelCount, __ATOMIC_ACQUIRE)) {
+        return DJI_ERROR_SYSTEM_MODULE_CODE_INVALID_PARAMETER;
+    }
+
+    /* No handler call is in flight when this returns, a sample may free its resources right after. */
+    osalHandler->MutexLock(s_flightRecorder.channelMutex);
+    s_flightRecorder.channels[channelId].handler = handler;
+    s_flightRecorder.channels[channelId].userData = userData;
+    osalHandler->MutexUnlock(s_flightRecorder.channelMutex);
+
+    return DJI_ERROR_SYSTEM_MODULE_CODE_SUCCESS;
+}
+
+T_DjiReturnCode DjiTest_FlightRecorderStart(const T_DjiTestFlightRecorderConfig *config)
+{
+    T_DjiOsalHandler *osalHandler = DjiPlatform_GetOsalHandler();
+    T_DjiReturnCode returnCode;
+    size_t poolMemorySize;
+    bool isSealed = false;
+    uint32_t channelCount;
+    uint32_t i;
+
+    if (config == NULL || config->prefix == NULL || config->chunkCount < 2 ||
+        config->chunkSize < DJI_TEST_FLIGHT_RECORDER_CHUNK_MIN_SIZE || config->maxLatencyMs == 0 ||
+        strlen(config->prefix) >= DJI_TEST_FLIGHT_RECORDER_NAME_MAX_SIZE ||
+        (config->directory != NULL && strlen(config->directory) >= DJI_TEST_FLIGHT_RECORDER_PATH_MAX_SIZE)) {
+        return DJI_ERROR_SYSTEM_MODULE_CODE_INVALID_PARAMETER;
+    }
+
+    pthread_once(&s_flightRecorderOnce, DjiTest_FlightRecorderInit);
+    if (!s_isFlightRecorderReady) {
+        return DJI_ERROR_SYSTEM_MODULE_CODE_SYSTEM_ERROR;
+    }
+
+    osalHandler->MutexLock(s_flightRecorder.controlMutex);
+    if (s_flightRecorder.file != NULL) {
+        osalHandler->MutexUnlock(s_flightRecorder.controlMutex);
+        return DJI_ERROR_SYSTEM_MODULE_CODE_NONSUPPORT_IN_CURRENT_STATE;
+    }
+
+    s_flightRecorder.config = *config;
+    s_flightRecorder.config.chunkSize = DJI_TEST_FLIGHT_RECORD_ALIGN(config->chunkSize);
+
+    /* Every buffer is allocated here, recording never touches the heap except for growing the index. */
+    poolMemorySize = UtilPool_GetMemorySize(config->chunkCount, sizeof(T_DjiTestFlightRecordChunk));
+    s_flightRecorder.chunkMemory = osalHandler->Malloc((size_t) config->chunkCount *
+                                                       s_flightRecorder.config.chunkSize);
+    s_flightRecorder.chunkPoolMemory = osalHandler->Malloc(poolMemorySize);
+    s_flightRecorder.indexCapacity = DJI_TEST_FLIGHT_RECORDER_INDEX_INIT_CAPACITY;
+    s_flightRecorder.index = osalHandler->Malloc(s_flightRecorder.indexCapacity *
+                                                 sizeof(T_DjiTestFlightRecordIndexEntry));
+    if (s_flightRecorder.chunkMemory == NULL || s_flightRecorder.chunkPoolMemory == NULL ||
+        s_flightRecorder.index == NULL) {
+        USER_LOG_ERROR("Malloc flight recorder buffer failed.");
+        returnCode = DJI_ERROR_SYSTEM_MODULE_CODE_MEMORY_ALLOC_FAILED;
+        goto FreeChunks;
+    }
+
+    returnCode = UtilPool_Init(&s_flightRecorder.chunkPool, s_flightRecorder.chunkPoolMemory, poolMemorySize,
+                               sizeof(T_DjiTestFlightRecordChunk));
+    if (returnCode != DJI_ERROR_SYSTEM_MODULE_CODE_SUCCESS) {
+        goto FreeChunks;
+    }
+    UtilDlist_Init(&s_flightRecorder.pendingList);
+    s_flightRecorder.currentChunk = NULL;
+    s_flightRecorder.indexCount = 0;
+    s_flightRecorder.stopWriter = false;
+
+    returnCode = DjiTest_FlightRecorderOpenFile();
+    if (returnCode != DJI_ERROR_SYSTEM_MODULE_CODE_SUCCESS) {
+        goto FreeChunks;
+    }
+
+    if (osalHandler->SemaphoreCreate(0, &s_flightRecorder.dataSema) != DJI_ERROR_SYSTEM_MODULE_CODE_SUCCESS) {
+        returnCode = DJI_ERROR_SYSTEM_MODULE_CODE_SYSTEM_ERROR;
+        goto CloseFile;
+    }
+    if (osalHandler->SemaphoreCreate(0, &s_flightRecorder.exitSema) != DJI_ERROR_SYSTEM_MODULE_CODE_SUCCESS) {
+        returnCode = DJI_ERROR_SYSTEM_MODULE_CODE_SYSTEM_ERROR;
+        goto DestroyDataSema;
+    }
+
+    returnCode = osalHandler->TaskCreate("flight_record", DjiTest_FlightRecorderWriterTask,
+                                         DJI_TEST_FLIGHT_RECORDER_TASK_STACK_SIZE, NULL,
+                                         &s_flightRecorder.writerTask);
+    if (returnCode != DJI_ERROR_SYSTEM_MODULE_CODE_SUCCESS) {
+        USER_LOG_ERROR("Create flight recorder task failed, return code:0x%08X", returnCode);
+        goto DestroyExitSema;
+    }
+
+    osalHandler->MutexLock(s_flightRecorder.recordMutex);
+    memset(&s_flightRecorder.statistics, 0, sizeof(T_DjiTestFlightRecorderStatistics));
+    s_flightRecorder.sequence = 0;
+    channelCount = __atomic_load_n(&s_flightRecorder.channelCount, __ATOMIC_ACQUIRE);
+    for (i = 0; i < channelCount; i++) {
+        s_flightRecorder.channels[i].recordCount = 0;
+        s_flightRecorder.channels[i].droppedCount = 0;
+        s_flightRecorder.channels[i].maxRecordSize = 0;
+        s_flightRecorder.channels[i].byteCount = 0;
+    }
+    __atomic_store_n(&s_flightRecorder.isRecording, true, __ATOMIC_RELEASE);
+
+    /* Channels added later write their definition themselves, see DjiTest_FlightRecorderAddChannel. */
+    for (i = 0; i < channelCount; i++) {
+        DjiTest_FlightRecorderAppend(DJI_TEST_FLIGHT_RECORD_DEFINITION_CHANNEL, 0, NULL, 0,
+                                     &s_flightRecorder.channels[i].definition,
+                                     sizeof(T_DjiTestFlightRecordChannelDefinition), &isSealed);
+    }
+    osalHandler->MutexUnlock(s_flightRecorder.recordMutex);
+    osalHandler->MutexUnlock(s_flightRecorder.controlMutex);
+
+    USER_LOG_INFO("Start flight record %s with %u channels.", s_flightRecorder.path, channelCount);
+
+    return DJI_ERROR_SYSTEM_MODULE_CODE_SUCCESS;
+
+DestroyExitSema:
+    osalHandler->SemaphoreDestroy(s_flightRecorder.exitSema);
+DestroyDataSema:
+    osalHandler->SemaphoreDestroy(s_flightRecorder.dataSema);
+CloseFile:
+    fclose(s_flightRecorder.file);
+    s_flightRecorder.file = NULL;
+    remove(s_flightRecorder.path);
+FreeChunks:
+    DjiTest_FlightRecorderFreeChunks();
+    osalHandler->MutexUnlock(s_flightRecorder.controlMutex);
+
+    return returnCode;
+}
+
+T_DjiReturnCode DjiTest_FlightRecorderStop(void)
+{
+    T_DjiOsalHandler *osalHandler = DjiPlatform_GetOsalHandler();
+    T_DjiTestFlightRecorderStatistics statistics;
+
+    if (!s_isFlightRecorderReady) {
+        return DJI_ERROR_SYSTEM_MODULE_CODE_NONSUPPORT_IN_CURRENT_STATE;
+    }
+
+    osalHandler->MutexLock(s_flightRecorder.controlMutex);
+    if (s_flightRecorder.file == NULL) {
+        osalHandler->MutexUnlock(s_flightRecorder.controlMutex);
+        return DJI_ERROR_SYSTEM_MODULE_CODE_NONSUPPORT_IN_CURRENT_STATE;
+    }
+
+    osalHandler->MutexLock(s_flightRecorder.recordMutex);
+    __atomic_store_n(&s_flightRecorder.isRecording, false, __ATOMIC_RELEASE);
+    if (s_flightRecorder.currentChunk != NULL) {
+        DjiTest_FlightRecorderSealChunk();
+    }
+    s_flightRecorder.stopWriter = true;
+    osalHandler->MutexUnlock(s_flightRecorder.recordMutex);
+
+    osalHandler->SemaphorePost(s_flightRecorder.dataSema);
+    osalHandler->SemaphoreWait(s_flightRecorder.exitSema);
+    osalHandler->TaskDestroy(s_flightRecorder.writerTask);
+    osalHandler->SemaphoreDestroy(s_flightRecorder.dataSema);
+    osalHandler->SemaphoreDestroy(s_flightRecorder.exitSema);
+
+    DjiTest_FlightRecorderCloseFile();
+    DjiTest_FlightRecorderFreeChunks();
+
+    osalHandler->MutexLock(s_flightRecorder.recordMutex);
+    statistics = s_flightRecorder.statistics;
+    osalHandler->MutexUnlock(s_flightRecorder.recordMutex);
+    osalHandler->MutexUnlock(s_flightRecorder.controlMutex);
+
+    USER_LOG_INFO("Stop flight record %s, %llu records in %u chunks, %u dropped, max latency %u us.",
+                  s_flightRecorder.path, statistics.recordCount, statistics.chunkCount, statistics.droppedCount,
+                  statistics.maxLatencyUs);
+
+    return DJI_ERROR_SYSTEM_MODULE_CODE_SUCCESS;
+}
+
+bool DjiTest_FlightRecorderIsRecording(void)
+{
+    return __atomic_load_n(&s_flightRecorder.isRecording, __ATOMIC_ACQUIRE);
+}
+
+T_DjiReturnCode DjiTest_FlightRecorderWrite(uint16_t channelId, uint64_t aircraftUs, const void *header,
+                                            uint16_t headerLen, const void *data, uint32_t dataLen)
+{
+    T_DjiOsalHandler *osalHandler;
+    T_DjiReturnCode returnCode;
+    bool isSealed = false;
+
+    /* The callbacks of every sample call this, without a recording it must cost no more than this load. */
+    if (!__atomic_load_n(&s_flightRecorder.isRecording, __ATOMIC_ACQUIRE)) {
+        return DJI_ERROR_SYSTEM_MODULE_CODE_NONSUPPORT_IN_CURRENT_STATE;
+    }
+    if (channelId >= __atomic_load_n(&s_flightRecorder.channelCount, __ATOMIC_ACQUIRE) ||
+        (header == NULL && headerLen > 0) || (data == NULL && dataLen > 0)) {
+        return DJI_ERROR_SYSTEM_MODULE_CODE_INVALID_PARAMETER;
+    }
+
+    osalHandler = DjiPlatform_GetOsalHandler();
+    osalHandler->MutexLock(s_flightRecorder.recordMutex);
+    returnCode = DjiTest_FlightRecorderAppend(channelId, aircraftUs, header, headerLen, data, dataLen, &isSealed);
+    osalHandler->MutexUnlock(s_flightRecorder.recordMutex);
+
+    if (isSealed) {
+        osalHandler->SemaphorePost(s_flightRecorder.dataSema);
+    }
+
+    return returnCode;
+}
+
+void DjiTest_FlightRecorderGetStatistics(T_DjiTestFlightRecorderStatistics *statistics)
+{
+    T_DjiOsalHandler *osalHandler = DjiPlatform_GetOsalHandler();
+
+    if (statistics == NULL) {
+        return;
+    }
+    if (!s_isFlightRecorderReady) {
+        memset(statistics, 0, sizeof(T_DjiTestFlightRecorderStatistics));
+        return;
+    }
+
+    osalHandler->MutexLock(s_flightRecorder.recordMutex);
+    *statistics = s_flightRecorder.statistics;
+    osalHandler->MutexUnlock(s_flightRecorder.recordMutex);
+}
+
+T_DjiReturnCode DjiTest_FlightRecorderReplayStart(const char *path, double rate, bool isLoop)
+{
+    T_DjiOsalHandler *osalHandler = DjiPlatform_GetOsalHandler();
+    T_DjiReturnCode returnCode;
+    uint32_t i;
+
+    if (path == NULL || rate < 0) {
+        return DJI_ERROR_SYSTEM_MODULE_CODE_INVALID_PARAMETER;
+    }
+
+    pthread_once(&s_flightRecorderOnce, DjiTest_FlightRecorderInit);
+    if (!s_isFlightRecorderReady) {
+        return DJI_ERROR_SYSTEM_MODULE_CODE_SYSTEM_ERROR;
+    }
+
+    osalHandler->MutexLock(s_flightRecorder.controlMutex);
+    if (s_flightReplay.isRunning) {
+        osalHandler->MutexUnlock(s_flightRecorder.controlMutex);
+        return DJI_ERROR_SYSTEM_MODULE_CODE_NONSUPPORT_IN_CURRENT_STATE;
+    }
+
+    returnCode = DjiTest_FlightRecordReaderOpen(&s_flightReplay.reader, path);
+    if (returnCode != DJI_ERROR_SYSTEM_MODULE_CODE_SUCCESS) {
+        USER_LOG_ERROR("Open flight record %s failed, return code:0x%08X", path, returnCode);
+        goto Unlock;
+    }
+
+    returnCode = osalHandler->SemaphoreCreate(0, &s_flightReplay.exitSema);
+    if (returnCode != DJI_ERROR_SYSTEM_MODULE_CODE_SUCCESS) {
+        goto CloseReader;
+    }
+
+    /* Channels are matched by name when their first record is replayed, samples may register them later. */
+    for (i = 0; i < DJI_TEST_FLIGHT_RECORDER_CHANNEL_MAX_NUM; i++) {
+        s_flightReplay.channelMap[i] = DJI_TEST_FLIGHT_RECORDER_CHANNEL_UNRESOLVED;
+    }
+    s_flightReplay.rate = rate;
+    s_flightReplay.isLoop = isLoop;
+    s_flightReplay.stop = false;
+    s_flightReplay.isFinished = false;
+
+    returnCode = osalHandler->TaskCreate("flight_replay", DjiTest_FlightRecorderReplayTask,
+                                         DJI_TEST_FLIGHT_RECORDER_TASK_STACK_SIZE, NULL, &s_flightReplay.task);
+    if (returnCode != DJI_ERROR_SYSTEM_MODULE_CODE_SUCCESS) {
+        USER_LOG_ERROR("Create flight replay task failed, return code:0x%08X", returnCode);
+        osalHandler->SemaphoreDestroy(s_flightReplay.exitSema);
+        goto CloseReader;
+    }
+    s_flightReplay.isRunning = true;
+    osalHandler->MutexUnlock(s_flightRecorder.controlMutex);
+
+    USER_LOG_INFO("Replay flight record %s%s at rate %.2f.", path,
+                  s_flightReplay.reader.isRecovered ? " (recovered)" : "", rate);
+
+    return DJI_ERROR_SYSTEM_MODULE_CODE_SUCCESS;
+
+CloseReader:
+    DjiTest_FlightRecordReaderClose(&s_flightReplay.reader);
+Unlock:
+    osalHandler->MutexUnlock(s_flightRecorder.controlMutex);
+
+    return returnCode;
+}
+
+T_DjiReturnCode DjiTest_FlightRecorderReplayStop(void)
+{
+    T_DjiOsalHandler *osalHandler = DjiPlatform_GetOsalHandler();
+
+    if (!s_isFlightRecorderReady) {
+        return DJI_ERROR_SYSTEM_MODULE_CODE_NONSUPPORT_IN_CURRENT_STATE;
+    }
+
+    osalHandler->MutexLock(s_flightRecorder.controlMutex);
+    if (!s_flightReplay.isRunning) {
+        osalHandler->MutexUnlock(s_flightRecorder.controlMutex);
+        return DJI_ERROR_SYSTEM_MODULE_CODE_NONSUPPORT_IN_CURRENT_STATE;
+    }
+
+    __atomic_store_n(&s_flightReplay.stop, true, __ATOMIC_RELEASE);
+    osalHandler->SemaphoreWait(s_flightReplay.exitSema);
+    osalHandler->TaskDestroy(s_flightReplay.task);
+    osalHandler->SemaphoreDestroy(s_flightReplay.exitSema);
+    DjiTest_FlightRecordReaderClose(&s_flightReplay.reader);
+    s_flightReplay.isRunning = false;
+    osalHandler->MutexUnlock(s_flightRecorder.controlMutex);
+
+    return DJI_ERROR_SYSTEM_MODULE_CODE_SUCCESS;
+}
+
+bool DjiTest_FlightRecorderIsReplaying(void)
+{
+    return s_flightReplay.isRunning && !__atomic_load_n(&s_flightReplay.isFinished, __ATOMIC_ACQUIRE);
+}
+
+/* Private functions definition-----------------------------------------------*/
+static void DjiTest_FlightRecorderInit(void)
+{
+    T_DjiOsalHandler *osalHandler = DjiPlatform_GetOsalHandler();
+
+    if (osalHandler == NULL) {
+        return;
+    }
+
+    if (osalHandler->MutexCreate(&s_flightRecorder.controlMutex) != DJI_ERROR_SYSTEM_MODULE_CODE_SUCCESS) {
+        return;
+    }
+    if (osalHandler->MutexCreate(&s_flightRecorder.channelMutex) != DJI_ERROR_SYSTEM_MODULE_CODE_SUCCESS) {
+        osalHandler->MutexDestroy(s_flightRecorder.controlMutex);
+        return;
+    }
+    if (osalHandler->MutexCreate(&s_flightRecorder.recordMutex) != DJI_ERROR_SYSTEM_MODULE_CODE_SUCCESS) {
+        osalHandler->MutexDestroy(s_flightRecorder.channelMutex);
+        osalHandler->MutexDestroy(s_flightRecorder.controlMutex);
+        return;
+    }
+
+    s_isFlightRecorderReady = true;
+}
+
+static uint64_t DjiTest_FlightRecorderGetMonotonicUs(void)
+{
+    struct timespec time;
+
+    clock_gettime(CLOCK_MONOTONIC, &time);
+
+    return (uint64_t) time.tv_sec * 1000000 + (uint64_t) time.tv_nsec / 1000;
+}
+
+static T_DjiReturnCode DjiTest_FlightRecorderOpenFile(void)
+{
+    T_DjiTestFlightRecordFileHeader fileHeader = {0};
+    const char *directory = s_flightRecorder.config.directory != NULL ? s_flightRecorder.config.directory : ".";
+    struct timespec realTime;
+    struct tm localTime;
+
+    clock_gettime(CLOCK_REALTIME, &realTime);
+    localtime_r(&realTime.tv_sec, &localTime);
+
+    if (mkdir(directory, 0755) != 0 && errno != EEXIST) {
+        USER_LOG_ERROR("Create flight record directory %s failed, errno %d.", directory, errno);
+        return DJI_ERROR_SYSTEM_MODULE_CODE_SYSTEM_ERROR;
+    }
+
+    snprintf(s_flightRecorder.path, sizeof(s_flightRecorder.path), "%s/%s_%04d%02d%02d_%02d-%02d-%02d%s", directory,
+             s_flightRecorder.config.prefix, localTime.tm_year + 1900, localTime.tm_mon + 1, localTime.tm_mday,
+             localTime.tm_hour, localTime.tm_min, localTime.tm_sec, DJI_TEST_FLIGHT_RECORD_FILE_SUFFIX);
+
+    s_flightRecorder.file = fopen(s_flightRecorder.path, "wb");
+    if (s_flightRecorder.file == NULL) {
+        USER_LOG_ERROR("Open flight record %s failed, errno %d.", s_flightRecorder.path, errno);
+        return DJI_ERROR_SYSTEM_MODULE_CODE_SYSTEM_ERROR;
+    }
+
+    s_flightRecorder.startMonotonicUs = DjiTest_FlightRecorderGetMonotonicUs();
+    memcpy(fileHeader.magic, DJI_TEST_FLIGHT_RECORD_FILE_MAGIC, DJI_TEST_FLIGHT_RECORD_MAGIC_SIZE);
+    fileHeader.version = DJI_TEST_FLIGHT_RECORD_FORMAT_VERSION;
+    fileHeader.headerSize = sizeof(T_DjiTestFlightRecordFileHeader);
+    fileHeader.chunkSize = s_flightRecorder.config.chunkSize;
+    fileHeader.startMonotonicUs = s_flightRecorder.startMonotonicUs;
+    fileHeader.startRealTimeUs = (uint64_t) realTime.tv_sec * 1000000 + (uint64_t) realTime.tv_nsec / 1000;
+
+    if (fwrite(&fileHeader, sizeof(fileHeader), 1, s_flightRecorder.file) != 1 ||
+        fflush(s_flightRecorder.file) != 0) {
+        fclose(s_flightRecorder.file);
+        s_flightRecorder.file = NULL;
+        remove(s_flightRecorder.path);
+        return DJI_ERROR_SYSTEM_MODULE_CODE_SYSTEM_ERROR;
+    }
+    s_flightRecorder.fileOffset = sizeof(fileHeader);
+
+    return DJI_ERROR_SYSTEM_MODULE_CODE_SUCCESS;
+}
+
+static void DjiTest_FlightRecorderCloseFile(void)
+{
+    T_DjiTestFlightRecordFooter footer = {0};
+    T_DjiTestFlightRecordChannelSummary summary;
+    T_DjiTestFlightRecorderChannel *channel;
+    uint32_t channelCount = __atomic_load_n(&s_flightRecorder.channelCount, __ATOMIC_ACQUIRE);
+    bool isOk = true;
+    uint32_t i;
+
+    /* The writer task has exited, the index and the statistics are not touched by anyone else. */
+    memcpy(footer.magic, DJI_TEST_FLIGHT_RECORD_FOOTER_MAGIC, DJI_TEST_FLIGHT_RECORD_MAGIC_SIZE);
+    footer.channelCount = channelCount;
+    footer.indexCount = s_flightRecorder.indexCount;
+    footer.chunkCount = s_flightRecorder.statistics.chunkCount;
+    footer.droppedCount = s_flightRecorder.statistics.droppedCount;
+    footer.recordCount = s_flightRecorder.statistics.recordCount;
+    footer.summaryOffset = s_flightRecorder.fileOffset;
+
+    for (i = 0; i < channelCount && isOk; i++) {
+        channel = &s_flightRecorder.channels[i];
+        memset(&summary, 0, sizeof(summary));
+        summary.definition = channel->definition;
+        summary.recordCount = channel->recordCount;
+        summary.droppedCount = channel->droppedCount;
+        summary.maxRecordSize = channel->maxRecordSize;
+        summary.byteCount = channel->byteCount;
+        isOk = fwrite(&summary, sizeof(summary), 1, s_flightRecorder.file) == 1;
+    }
+
+    if (isOk && s_flightRecorder.indexCount > 0) {
+        isOk = fwrite(s_flightRecorder.index, sizeof(T_DjiTestFlightRecordIndexEntry), s_flightRecorder.indexCount,
+                      s_flightRecorder.file) == s_flightRecorder.indexCount;
+    }
+    if (isOk) {
+        isOk = fwrite(&footer, sizeof(footer), 1, s_flightRecorder.file) == 1;
+    }
+    if (!isOk) {
+        USER_LOG_WARN("Write flight record summary failed, the file is read back by scanning.");
+    }
+
+    fclose(s_flightRecorder.file);
+    s_flightRecorder.file = NULL;
+}
+
+static void DjiTest_FlightRecorderFreeChunks(void)
+{
+    T_DjiOsalHandler *osalHandler = DjiPlatform_GetOsalHandler();
+
+    osalHandler->Free(s_flightRecorder.chunkMemory);
+    osalHandler->Free(s_flightRecorder.chunkPoolMemory);
+    osalHandler->Free(s_flightRecorder.index);
+    s_flightRecorder.chunkMemory = NULL;
+    s_flightRecorder.chunkPoolMemory = NULL;
+    s_flightRecorder.index = NULL;
+    s_flightRecorder.currentChunk = NULL;
+}
+
+static T_DjiReturnCode DjiTest_FlightRecorderAppend(uint16_t channelId, uint64_t aircraftUs, const void *header,
+                                                    uint16_t headerLen, const void *data, uint32_t dataLen,
+                                                    bool *isSealed)
+{
+    T_DjiTestFlightRecorderChannel *channel = channelId != DJI_TEST_FLIGHT_RECORD_DEFINITION_CHANNEL ?
+                                              &s_flightRecorder.channels[channelId] : NULL;
+    T_DjiTestFlightRecordChunk *chunk;
+    T_DjiTestFlightRecordChunkChannel *chunkChannel;
+    T_DjiTestFlightRecordRecordHeader *recordHeader;
+    uint32_t payloadCapacity = s_flightRecorder.config.chunkSize - sizeof(T_DjiTestFlightRecordChunkHeader);
+    uint64_t recordSize = sizeof(T_DjiTestFlightRecordRecordHeader) +
+                          DJI_TEST_FLIGHT_RECORD_ALIGN((uint64_t) headerLen + dataLen);
+    uint8_t *record;
+    uint64_t nowUs;
+
+    if (!s_flightRecorder.isRecording) {
+        return DJI_ERROR_SYSTEM_MODULE_CODE_NONSUPPORT_IN_CURRENT_STATE;
+    }
+
+    if (recordSize > payloadCapacity) {
+        s_flightRecorder.statistics.droppedCount++;
+        if (channel != NULL) {
+            channel->droppedCount++;
+        }
+        return DJI_ERROR_SYSTEM_MODULE_CODE_OUT_OF_RANGE;
+    }
+
+    if (s_flightRecorder.currentChunk != NULL && s_flightRecorder.currentChunk->used + recordSize > payloadCapacity) {
+        DjiTest_FlightRecorderSealChunk();
+        *isSealed = true;
+    }
+
+    if (s_flightRecorder.currentChunk == NULL) {
+        chunk = UtilPool_Alloc(&s_flightRecorder.chunkPool);
+        if (chunk == NULL) {
+            /* Every buffer waits for the disk, losing this record is better than stalling an SDK callback. */
+            s_flightRecorder.statistics.droppedCount++;
+            if (channel != NULL) {
+                channel->droppedCount++;
+            }
+            return DJI_ERROR_SYSTEM_MODULE_CODE_BUSY;
+        }
+        UtilDlist_InitNode(&chunk->node);
+        chunk->buffer = s_flightRecorder.chunkMemory +
+                        (size_t) UtilPool_GetIndex(&s_flightRecorder.chunkPool, chunk) *
+                        s_flightRecorder.config.chunkSize;
+        chunk->used = 0;
+        chunk->recordCount = 0;
+        chunk->channelMask = 0;
+        s_flightRecorder.currentChunk = chunk;
+    }
+    chunk = s_flightRecorder.currentChunk;
+
+    /* Taken under the lock, so the file order is the order of the times. */
+    nowUs = DjiTest_FlightRecorderGetMonotonicUs() - s_flightRecorder.startMonotonicUs;
+
+    record = chunk->buffer + sizeof(T_DjiTestFlightRecordChunkHeader) + chunk->used;
+    recordHeader = (T_DjiTestFlightRecordRecordHeader *) record;
+    recordHeader->channelId = channelId;
+    recordHeader->headerLen = headerLen;
+    recordHeader->dataLen = dataLen;
+    recordHeader->sequence = s_flightRecorder.sequence++;
+    recordHeader->reserved = 0;
+    recordHeader->monotonicUs = nowUs;
+    recordHeader->aircraftUs = aircraftUs;
+    record += sizeof(T_DjiTestFlightRecordRecordHeader);
+    if (headerLen > 0) {
+        memcpy(record, header, headerLen);
+    }
+    if (dataLen > 0) {
+        memcpy(record + headerLen, data, dataLen);
+    }
+    memset(record + headerLen + dataLen, 0,
+           recordSize - sizeof(T_DjiTestFlightRecordRecordHeader) - headerLen - dataLen);
+
+    if (chunk->recordCount == 0) {
+        chunk->startTimeUs = nowUs;
+    }
+    chunk->endTimeUs = nowUs;
+    chunk->used += (uint32_t) recordSize;
+    chunk->recordCount++;
+
+    if (channel != NULL) {
+        s_flightRecorder.statistics.recordCount++;
+        chunkChannel = &chunk->channels[channelId];
+        if ((chunk->channelMask & (1ULL << channelId)) == 0) {
+            chunk->channelMask |= 1ULL << channelId;
+            chunkChannel->recordCount = 0;
+            chunkChannel->startTimeUs = nowUs;
+        }
+        chunkChannel->recordCount++;
+        chunkChannel->endTimeUs = nowUs;
+
+        channel->recordCount++;
+        channel->byteCount += (uint64_t) headerLen + dataLen;
+        if ((uint32_t) headerLen + dataLen > channel->maxRecordSize) {
+            channel->maxRecordSize = (uint32_t) headerLen + dataLen;
+        }
+    }
+
+    return DJI_ERROR_SYSTEM_MODULE_CODE_SUCCESS;
+}
+
+static void DjiTest_FlightRecorderSealChunk(void)
+{
+    uint32_t pendingCount;
+
+    if (s_flightRecorder.currentChunk->recordCount == 0) {
+        UtilPool_Free(&s_flightRecorder.chunkPool, s_flightRecorder.currentChunk);
+        s_flightRecorder.currentChunk = NULL;
+        return;
+    }
+
+    UtilDlist_AddLast(&s_flightRecorder.pendingList, &s_flightRecorder.currentChunk->node);
+    s_flightRecorder.currentChunk = NULL;
+
+    pendingCount = UtilDlist_GetCount(&s_flightRecorder.pendingList);
+    if (pendingCount > s_flightRecorder.statistics.maxPendingChunkCount) {
+        s_flightRecorder.statistics.maxPendingChunkCount = pendingCount;
+    }
+}
+
+static void DjiTest_FlightRecorderWriteChunk(T_DjiTestFlightRecordChunk *chunk)
+{
+    T_DjiOsalHandler *osalHandler = DjiPlatform_GetOsalHandler();
+    T_DjiTestFlightRecordChunkHeader *chunkHeader = (T_DjiTestFlightRecordChunkHeader *) chunk->buffer;
+    T_DjiTestFlightRecordIndexEntry entry = {0};
+    size_t chunkLen = sizeof(T_DjiTestFlightRecordChunkHeader) + chunk->used;
+    uint64_t beginUs = DjiTest_FlightRecorderGetMonotonicUs();
+    uint64_t endUs;
+    uint64_t latencyUs;
+    bool isOk;
+    uint32_t i;
+
+    chunkHeader->magic = DJI_TEST_FLIGHT_RECORD_CHUNK_MAGIC;
+    chunkHeader->recordCount = chunk->recordCount;
+    chunkHeader->payloadSize = chunk->used;
+    chunkHeader->crc32 = UtilZip_Crc32(0, chunk->buffer + sizeof(T_DjiTestFlightRecordChunkHeader), chunk->used);
+    chunkHeader->startTimeUs = chunk->startTimeUs;
+    chunkHeader->endTimeUs = chunk->endTimeUs;
+
+    /* One write per chunk, a crash leaves at most the last chunk incomplete and a scan stops right there. */
+    isOk = fwrite(chunk->buffer, 1, chunkLen, s_flightRecorder.file) == chunkLen &&
+           fflush(s_flightRecorder.file) == 0;
+    endUs = DjiTest_FlightRecorderGetMonotonicUs();
+
+    if (isOk) {
+        entry.chunkOffset = s_flightRecorder.fileOffset;
+        for (i = 0; i < DJI_TEST_FLIGHT_RECORDER_CHANNEL_MAX_NUM; i++) {
+            if ((chunk->channelMask & (1ULL << i)) == 0) {
+                continue;
+            }
+            entry.channelId = (uint16_t) i;
+            entry.startTimeUs = chunk->channels[i].startTimeUs;
+            entry.endTimeUs = chunk->channels[i].endTimeUs;
+            entry.recordCount = chunk->channels[i].recordCount;
+            if (DjiTest_FlightRecorderAddIndexEntry(&entry) != DJI_ERROR_SYSTEM_MODULE_CODE_SUCCESS) {
+                break;
+            }
+        }
+        s_flightRecorder.fileOffset += chunkLen;
+    } else {
+        /* The index only lists complete chunks, the offset is taken back from the file. */
+        s_flightRecorder.fileOffset = (uint64_t) ftell(s_flightRecorder.file);
+    }
+
+    latencyUs = endUs - s_flightRecorder.startMonotonicUs - chunk->startTimeUs;
+    osalHandler->MutexLock(s_flightRecorder.recordMutex);
+    if (isOk) {
+        s_flightRecorder.statistics.chunkCount++;
+        s_flightRecorder.statistics.fileBytes += chunkLen;
+    } else {
+        s_flightRecorder.statistics.writeErrorCount++;
+    }
+    if (latencyUs > s_flightRecorder.statistics.maxLatencyUs) {
+        s_flightRecorder.statistics.maxLatencyUs = (uint32_t) latencyUs;
+    }
+    if (endUs - beginUs > s_flightRecorder.statistics.maxWriteUs) {
+        s_flightRecorder.statistics.maxWriteUs = (uint32_t) (endUs - beginUs);
+    }
+    osalHandler->MutexUnlock(s_flightRecorder.recordMutex);
+}
+
+static T_DjiReturnCode DjiTest_FlightRecorderAddIndexEntry(const T_DjiTestFlightRecordIndexEntry *entry)
+{
+    T_DjiOsalHandler *osalHandler = DjiPlatform_GetOsalHandler();
+    T_DjiTestFlightRecordIndexEntry *index;
+
+    if (s_flightRecorder.indexCount == s_flightRecorder.indexCapacity) {
+        index = osalHandler->Malloc((size_t) s_flightRecorder.indexCapacity * 2 *
+                                    sizeof(T_DjiTestFlightRecordIndexEntry));
+        if (index == NULL) {
+            /* The chunks stay readable, a reader without the full index falls back to scanning. */
+            return DJI_ERROR_SYSTEM_MODULE_CODE_MEMORY_ALLOC_FAILED;
+        }
+        memcpy(index, s_flightRecorder.index, s_flightRecorder.indexCount * sizeof(T_DjiTestFlightRecordIndexEntry));
+        osalHandler->Free(s_flightRecorder.index);
+        s_flightRecorder.index = index;
+        s_flightRecorder.indexCapacity *= 2;
+    }
+
+    s_flightRecorder.index[s_flightRecorder.indexCount++] = *entry;
+
+    return DJI_ERROR_SYSTEM_MODULE_CODE_SUCCESS;
+}
+
+static void *DjiTest_FlightRecorderWriterTask(void *arg)
+{
+    T_DjiOsalHandler *osalHandler = DjiPlatform_GetOsalHandler();
+    uint32_t waitMs = s_flightRecorder.config.maxLatencyMs / 4 + 1;
+    uint64_t maxLatencyUs = (uint64_t) s_flightRecorder.config.maxLatencyMs * 1000;
+    T_DjiTestFlightRecordChunk *chunk;
+    T_UtilDlistNode *node;
+    uint64_t nowUs;
+    bool isExit = false;
+
+    USER_UTIL_UNUSED(arg);
+
+    while (!isExit) {
+        osalHandler->SemaphoreTimedWait(s_flightRecorder.dataSema, waitMs);
+
+        /* A quiet channel must not keep its records in memory, the age of a chunk bounds the latency. */
+        osalHandler->MutexLock(s_flightRecorder.recordMutex);
+        nowUs = DjiTest_FlightRecorderGetMonotonicUs() - s_flightRecorder.startMonotonicUs;
+        chunk = s_flightRecorder.currentChunk;
+        if (chunk != NULL && chunk->recordCount > 0 && nowUs - chunk->startTimeUs >= maxLatencyUs) {
+            DjiTest_FlightRecorderSealChunk();
+        }
+        osalHandler->MutexUnlock(s_flightRecorder.recordMutex);
+
+        while (true) {
+            osalHandler->MutexLock(s_flightRecorder.recordMutex);
+            node = UtilDlist_RemoveFirst(&s_flightRecorder.pendingList);
+            osalHandler->MutexUnlock(s_flightRecorder.recordMutex);
+            if (node == NULL) {
+                break;
+            }
+
+            chunk = UTIL_DLIST_ENTRY(node, T_DjiTestFlightRecordChunk, node);
+            DjiTest_FlightRecorderWriteChunk(chunk);
+
+            osalHandler->MutexLock(s_flightRecorder.recordMutex);
+            UtilPool_Free(&s_flightRecorder.chunkPool, chunk);
+            osalHandler->MutexUnlock(s_flightRecorder.recordMutex);
+        }
+
+        osalHandler->MutexLock(s_flightRecorder.recordMutex);
+        isExit = s_flightRecorder.stopWriter && UtilDlist_IsEmpty(&s_flightRecorder.pendingList);
+        osalHandler->MutexUnlock(s_flightRecorder.recordMutex);
+    }
+
+    osalHandler->SemaphorePost(s_flightRecorder.exitSema);
+
+    return NULL;
+}
+
+static void DjiTest_FlightRecorderDispatch(const T_DjiTestFlightRecordSample *sample)
+{
+    T_DjiOsalHandler *osalHandler = DjiPlatform_GetOsalHandler();
+    const T_DjiTestFlightRecordChannelDefinition *definition;
+    T_DjiTestFlightRecorderChannel *channel;
+    uint16_t channelId;
+    uint32_t i;
+
+    osalHandler->MutexLock(s_flightRecorder.channelMutex);
+    channelId = s_flightReplay.channelMap[sample->channelId];
+    if (channelId == DJI_TEST_FLIGHT_RECORDER_CHANNEL_UNRESOLVED) {
+        definition = &s_flightReplay.reader.channels[sample->channelId].definition;
+        for (i = 0; i < s_flightRecorder.channelCount; i++) {
+            if (strcmp(s_flightRecorder.channels[i].definition.name, definition->name) != 0) {
+                continue;
+            }
+            if (strcmp(s_flightRecorder.channels[i].definition.schemaName, definition->schemaName) != 0) {
+                USER_LOG_WARN("Skip replay of %s, recorded as %s but registered as %s.", definition->name,
+                              definition->schemaName, s_flightRecorder.channels[i].definition.schemaName);
+                channelId = DJI_TEST_FLIGHT_RECORDER_CHANNEL_REJECTED;
+            } else {
+                channelId = (uint16_t) i;
+            }
+            s_flightReplay.channelMap[sample->channelId] = channelId;
+            break;
+        }
+    }
+
+    if (channelId < s_flightRecorder.channelCount) {
+        channel = &s_flightRecorder.channels[channelId];
+        if (channel->handler != NULL) {
+            channel->handler(sample, channel->userData);
+        }
+    }
+    osalHandler->MutexUnlock(s_flightRecorder.channelMutex);
+}
+
+static void *DjiTest_FlightRecorderReplayTask(void *arg)
+{
+    T_DjiOsalHandler *osalHandler = DjiPlatform_GetOsalHandler();
+    T_DjiTestFlightRecordReader *reader = &s_flightReplay.reader;
+    T_DjiTestFlightRecordSample sample;
+    T_DjiReturnCode returnCode;
+    bool isFirst = true;
+    uint64_t firstUs = 0;
+    uint64_t baseUs = 0;
+    uint64_t nowUs;
+    uint64_t targetUs;
+    uint64_t sleepMs;
+
+    USER_UTIL_UNUSED(arg);
+
+    while (!__atomic_load_n(&s_flightReplay.stop, __ATOMIC_ACQUIRE)) {
+        returnCode = DjiTest_FlightRecordReaderReadNext(reader, &sample);
+        if (returnCode == DJI_ERROR_SYSTEM_MODULE_CODE_NOT_FOUND) {
+            if (!s_flightReplay.isLoop) {
+                break;
+            }
+            DjiTest_FlightRecordReaderSeek(reader, 0);
+            isFirst = true;
+            continue;
+        } else if (returnCode != DJI_ERROR_SYSTEM_MODULE_CODE_SUCCESS) {
+            USER_LOG_ERROR("Read flight record failed, return code:0x%08X", returnCode);
+            break;
+        }
+
+        /* Delays follow the recorded arrival times, the order is always the recorded one. */
+        if (isFirst) {
+            firstUs = sample.monotonicUs;
+            baseUs = DjiTest_FlightRecorderGetMonotonicUs();
+            isFirst = false;
+        }
+        if (s_flightReplay.rate > 0) {
+            targetUs = baseUs + (uint64_t) ((double) (sample.monotonicUs - firstUs) / s_flightReplay.rate);
+            nowUs = DjiTest_FlightRecorderGetMonotonicUs();
+            while (nowUs < targetUs && !__atomic_load_n(&s_flightReplay.stop, __ATOMIC_ACQUIRE)) {
+                sleepMs = (targetUs - nowUs) / 1000;
+                if (sleepMs == 0) {
+                    /* Below the resolution of the task sleep, the remaining microseconds are spent spinning. */
+                    nowUs = DjiTest_FlightRecorderGetMonotonicUs();
+                    continue;
+                }
+                osalHandler->TaskSleepMs(sleepMs > DJI_TEST_FLIGHT_RECORDER_REPLAY_SLEEP_MAX_MS ?
+                                         DJI_TEST_FLIGHT_RECORDER_REPLAY_SLEEP_MAX_MS : (uint32_t) sleepMs);
+                nowUs = DjiTest_FlightRecorderGetMonotonicUs();
+            }
+        }
+
+        DjiTest_FlightRecorderDispatch(&sample);
+    }
+
+    __atomic_store_n(&s_flightReplay.isFinished, true, __ATOMIC_RELEASE);
+    osalHandler->SemaphorePost(s_flightReplay.exitSema);
+
+    return NULL;
+}
+
+#endif
+
+/****************** (C) COPYRIGHT DJI Innovations *****END OF FILE****/
@@ -0,0 +1,241 @@
+/**
+ ********************************************************************
+ * @file    test_flight_recorder.h
+ * @brief   This is the header file for "test_flight_recorder.c" and "test_flight_record_reader.c", defining the
+ * structure and (exported) function prototypes.
+ *
+ * @copyright (c) 2021 DJI. All rights reserved.
+ *
+ * All information contained herein is, and remains, the property of DJI.
+ * The intellectual and technical concepts contained herein are proprietary
+ * to DJI and may be covered by U.S. and foreign patents, patents in process,
+ * and protected by trade secret or copyright law.  Dissemination of this
+ * information, including but not limited to data and other proprietary
+ * material(s) incorporated within the information, in any form, is strictly
+ * prohibited without the express written consent of DJI.
+ *
+ * If you receive this source code without DJI’s authorization, you may not
+ * further disseminate the information, and you must immediately remove the
+ * source code and notify DJI of its removal. DJI reserves the right to pursue
+ * legal actions against you for any loss(es) or damage(s) caused by your
+ * failure to do so.
+ *
+ *********************************************************************
+ */
+
+/* Define to prevent recursive inclusion -------------------------------------*/
+#ifndef TEST_FLIGHT_RECORDER_H
+#define TEST_FLIGHT_RECORDER_H
+
+/* Includes ------------------------------------------------------------------*/
+#include <stdio.h>
+#include "dji_typedef.h"
+#include "dji_platform.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#ifdef SYSTEM_ARCH_LINUX
+
+/* Exported constants --------------------------------------------------------*/
+#define DJI_TEST_FLIGHT_RECORD_FILE_MAGIC           "DJIFREC1"
+#define DJI_TEST_FLIGHT_RECORD_FOOTER_MAGIC         "DJIFIDX1"
+#define DJI_TEST_FLIGHT_RECORD_CHUNK_MAGIC          (0x4B4E4843)    /*!< "CHNK" in little endian. */
+#define DJI_TEST_FLIGHT_RECORD_MAGIC_SIZE           (8)
+#define DJI_TEST_FLIGHT_RECORD_FORMAT_VERSION       (1)
+#define DJI_TEST_FLIGHT_RECORD_FILE_SUFFIX          ".dfr"
+#define DJI_TEST_FLIGHT_RECORDER_CHANNEL_MAX_NUM    (64)
+#define DJI_TEST_FLIGHT_RECORDER_NAME_MAX_SIZE      (32)
+#define DJI_TEST_FLIGHT_RECORDER_LAYOUT_MAX_SIZE    (256)
+#define DJI_TEST_FLIGHT_RECORDER_PATH_MAX_SIZE      (256)
+/* Channel id of the in-stream records carrying a T_DjiTestFlightRecordChannelDefinition. */
+#define DJI_TEST_FLIGHT_RECORD_DEFINITION_CHANNEL   (0xFFFF)
+
+/* Exported types ------------------------------------------------------------*/
+/**
+ * @brief Layout of a record file: the file header, the chunks, then the summary (the channel table and the chunk
+ * index) and the footer. Chunks are written whole and in order, the records of all channels inside them are in
+ * arrival order. Channel definitions are also written as records, so a file cut short by a crash is read back by
+ * scanning the chunks until the first incomplete one. All integers are little endian.
+ */
+#pragma pack(1)
+typedef struct {
+    char magic[DJI_TEST_FLIGHT_RECORD_MAGIC_SIZE];
+    uint16_t version;
+    uint16_t headerSize;
+    uint32_t chunkSize;             /*!< Largest chunk including its header, the buffer a reader needs. */
+    uint64_t startMonotonicUs;      /*!< CLOCK_MONOTONIC of the start, record times are relative to it. */
+    uint64_t startRealTimeUs;       /*!< Unix time of the start in microseconds. */
+} T_DjiTestFlightRecordFileHeader;
+
+typedef struct {
+    uint32_t magic;
+    uint32_t recordCount;
+    uint32_t payloadSize;           /*!< Bytes of records following this header. */
+    uint32_t crc32;                 /*!< Of the payload. */
+    uint64_t startTimeUs;           /*!< Monotonic time of the first record. */
+    uint64_t endTimeUs;             /*!< Monotonic time of the last record. */
+} T_DjiTestFlightRecordChunkHeader;
+
+/**
+ * @brief Prefix of every record, the header and the data given to the write follow back to back and are padded to
+ * 8 bytes.
+ */
+typedef struct {
+    uint16_t channelId;
+    uint16_t headerLen;
+    uint32_t dataLen;
+    uint32_t sequence;              /*!< Counts the records of the file over all channels. */
+    uint32_t reserved;
+    uint64_t monotonicUs;           /*!< Arrival time since the start of the file. */
+    uint64_t aircraftUs;            /*!< Time given by the source of the data, 0 if it has none. */
+} T_DjiTestFlightRecordRecordHeader;
+
+typedef struct {
+    uint16_t channelId;
+    uint16_t reserved;
+    char name[DJI_TEST_FLIGHT_RECORDER_NAME_MAX_SIZE];          /*!< e.g. "fc/quaternion". */
+    char schemaName[DJI_TEST_FLIGHT_RECORDER_NAME_MAX_SIZE];    /*!< e.g. "dji.fc.quaternion". */
+    char layout[DJI_TEST_FLIGHT_RECORDER_LAYOUT_MAX_SIZE];      /*!< Telemetry bus layout of header and data. */
+} T_DjiTestFlightRecordChannelDefinition;
+
+typedef struct {
+    T_DjiTestFlightRecordChannelDefinition definition;
+    uint32_t recordCount;
+    uint32_t droppedCount;          /*!< Records lost while writing, no free chunk or larger than a chunk. */
+    uint32_t maxRecordSize;         /*!< Largest header plus data. */
+    uint32_t reserved;
+    uint64_t byteCount;
+} T_DjiTestFlightRecordChannelSummary;
+
+/**
+ * @brief One entry per channel present in a chunk, a reader of some channels only visits the chunks holding them.
+ */
+typedef struct {
+    uint64_t chunkOffset;
+    uint64_t startTimeUs;
+    uint64_t endTimeUs;
+    uint16_t channelId;
+    uint16_t reserved;
+    uint32_t recordCount;
+} T_DjiTestFlightRecordIndexEntry;
+
+typedef struct {
+    char magic[DJI_TEST_FLIGHT_RECORD_MAGIC_SIZE];
+    uint32_t channelCount;          /*!< Channel summaries at summaryOffset. */
+    uint32_t indexCount;            /*!< Index entries after the channel summaries. */
+    uint32_t chunkCount;
+    uint32_t droppedCount;
+    uint64_t recordCount;
+    uint64_t summaryOffset;
+} T_DjiTestFlightRecordFooter;
+#pragma pack()
+
+typedef struct {
+    uint16_t channelId;             /*!< Id of the channel in the file. */
+    uint16_t headerLen;
+    uint32_t dataLen;
+    uint32_t sequence;
+    uint64_t monotonicUs;
+    uint64_t aircraftUs;
+    const uint8_t *header;
+    const uint8_t *data;
+} T_DjiTestFlightRecordSample;
+
+/**
+ * @brief Gets back a recorded sample during replay, typically by calling the SDK callback that recorded it.
+ */
+typedef void (*DjiTestFlightRecorderReplayHandler)(const T_DjiTestFlightRecordSample *sample, void *userData);
+
+typedef struct {
+    const char *name;
+    const char *schemaName;
+    const char *layout;             /*!< NULL if the data has no layout, see T_DjiTestTelemetrySchema. */
+} T_DjiTestFlightRecorderChannelInfo;
+
+typedef struct {
+    const char *directory;          /*!< Directory of the record file, NULL for the working directory. */
+    const char *prefix;             /*!< File name prefix, the start time and ".dfr" are appended. */
+    uint32_t chunkSize;             /*!< Bytes of a chunk buffer, also the largest record. */
+    uint32_t chunkCount;            /*!< Chunk buffers, records are dropped when all of them wait for the disk. */
+    uint32_t maxLatencyMs;          /*!< A partly filled chunk is written after this time. */
+} T_DjiTestFlightRecorderConfig;
+
+typedef struct {
+    uint64_t recordCount;
+    uint64_t fileBytes;
+    uint32_t droppedCount;
+    uint32_t chunkCount;
+    uint32_t writeErrorCount;
+    uint32_t maxPendingChunkCount;
+    uint32_t maxLatencyUs;          /*!< From the first record of a chunk until the chunk reached the file. */
+    uint32_t maxWriteUs;
+} T_DjiTestFlightRecorderStatistics;
+
+typedef struct {
+    uint64_t offset;
+    uint64_t startTimeUs;
+    uint64_t endTimeUs;
+    uint64_t channelMask;
+} T_DjiTestFlightRecordChunkInfo;
+
+/**
+ * @brief Reads a record file in recorded order. With a channel mask the chunks without any of the channels are
+ * skipped by the index. Samples point into the reader and stay valid until the next read.
+ */
+typedef struct {
+    FILE *file;
+    T_DjiTestFlightRecordFileHeader fileHeader;
+    T_DjiTestFlightRecordFooter footer;
+    bool isRecovered;               /*!< The file had no footer, the index was rebuilt by scanning the chunks. */
+    T_DjiTestFlightRecordChannelSummary channels[DJI_TEST_FLIGHT_RECORDER_CHANNEL_MAX_NUM];
+    uint64_t definedChannelMask;
+    T_DjiTestFlightRecordIndexEntry *index;
+    uint32_t indexCount;
+    uint32_t indexCapacity;
+    T_DjiTestFlightRecordChunkInfo *chunks;
+    uint32_t chunkCount;
+    uint32_t chunkCapacity;
+    uint64_t channelMask;
+    uint64_t startTimeUs;
+    uint8_t *chunkBuffer;
+    uint32_t nextChunk;
+    uint32_t chunkOffset;
+    uint32_t chunkPayloadSize;
+} T_DjiTestFlightRecordReader;
+
+/* Exported functions --------------------------------------------------------*/
+void DjiTest_FlightRecorderGetDefaultConfig(T_DjiTestFlightRecorderConfig *config);
+T_DjiReturnCode DjiTest_FlightRecorderAddChannel(const T_DjiTestFlightRecorderChannelInfo *info,
+                                                 DjiTestFlightRecorderReplayHandler handler, void *userData,
+                                                 uint16_t *channelId);
+T_DjiReturnCode DjiTest_FlightRecorderSetReplayHandler(uint16_t channelId, DjiTestFlightRecorderReplayHandler handler,
+                                                       void *userData);
+T_DjiReturnCode DjiTest_FlightRecorderStart(const T_DjiTestFlightRecorderConfig *config);
+T_DjiReturnCode DjiTest_FlightRecorderStop(void);
+bool DjiTest_FlightRecorderIsRecording(void);
+T_DjiReturnCode DjiTest_FlightRecorderWrite(uint16_t channelId, uint64_t aircraftUs, const void *header,
+                                            uint16_t headerLen, const void *data, uint32_t dataLen);
+void DjiTest_FlightRecorderGetStatistics(T_DjiTestFlightRecorderStatistics *statistics);
+T_DjiReturnCode DjiTest_FlightRecorderReplayStart(const char *path, double rate, bool isLoop);
+T_DjiReturnCode DjiTest_FlightRecorderReplayStop(void);
+bool DjiTest_FlightRecorderIsReplaying(void);
+
+T_DjiReturnCode DjiTest_FlightRecordReaderOpen(T_DjiTestFlightRecordReader *reader, const char *path);
+T_DjiReturnCode DjiTest_FlightRecordReaderClose(T_DjiTestFlightRecordReader *reader);
+T_DjiReturnCode DjiTest_FlightRecordReaderFindChannel(const T_DjiTestFlightRecordReader *reader, const char *name,
+                                                      uint16_t *channelId);
+void DjiTest_FlightRecordReaderSetChannelMask(T_DjiTestFlightRecordReader *reader, uint64_t channelMask);
+void DjiTest_FlightRecordReaderSeek(T_DjiTestFlightRecordReader *reader, uint64_t timeUs);
+T_DjiReturnCode DjiTest_FlightRecordReaderReadNext(T_DjiTestFlightRecordReader *reader,
+                                                   T_DjiTestFlightRecordSample *sample);
+
+#endif
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // TEST_FLIGHT_RECORDER_H
+/************************ (C) COPYRIGHT DJI Innovations *******END OF FILE******/
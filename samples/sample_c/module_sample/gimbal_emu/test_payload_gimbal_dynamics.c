@@ -0,0 +1,551 @@
+/**
+ ********************************************************************
+ * @file    test_payload_gimbal_dynamics.c
+ * @brief
+ *
+ * @copyright (c) 2021 DJI. All rights reserved.
+ *
+ * All information contained herein is, and remains, the property of DJI.
+ * The intellectual and technical concepts contained herein are proprietary
+ * to DJI and may be covered by U.S. and foreign patents, patents in process,
+ * and protected by trade secret or copyright law.  Dissemination of this
+ * information, including but not limited to data and other proprietary
+ * material(s) incorporated within the information, in any form, is strictly
+ * prohibited without the express written consent of DJI.
+ *
+ * If you receive this source code without DJI’s authorization, you may not
+ * further disseminate the information, and you must immediately remove the
+ * source code and notify DJI of its removal. DJI reserves the right to pursue
+ * legal actions against you for any loss(es) or damage(s) caused by your
+ * failure to do so.
+ *
+ *********************************************************************
+ */
+
+/* Includes ------------------------------------------------------------------*/
+#include "test_payload_gimbal_dynamics.h"
+
+#ifdef SYSTEM_ARCH_LINUX
+
+#include <math.h>
+#include <string.h>
+#include "dji_logger.h"
+#include "dji_platform.h"
+#include "utils/util_misc.h"
+
+/* Private constants ---------------------------------------------------------*/
+#define GIMBAL_DYNAMICS_DELAY_LINE_SIZE         (DJI_TEST_GIMBAL_DYNAMICS_MAX_DELAY_STEPS + 1)
+#define GIMBAL_DYNAMICS_MAX_STEPS_PER_CALL      (100000)
+#define GIMBAL_DYNAMICS_DEG_PER_RAD             (57.29577951f)
+#define GIMBAL_DYNAMICS_TWO_PI                  (6.28318531f)
+#define GIMBAL_DYNAMICS_DEFAULT_SEED            (0x9E3779B97F4A7C15ULL)
+
+/* Private types -------------------------------------------------------------*/
+typedef struct {
+    E_DjiTestGimbalDynamicsCommandType type;
+    float value[DJI_TEST_GIMBAL_DYNAMICS_AXIS_NUM];
+    float rateLimit[DJI_TEST_GIMBAL_DYNAMICS_AXIS_NUM];
+} T_GimbalDynamicsCommand;
+
+typedef struct {
+    float angle; // unit: degree
+    float rate; // unit: degree/s
+    float measuredAngle; // unit: degree
+    float measuredRate; // unit: degree/s
+    float lastMeasuredRate; // unit: degree/s
+    float rateIntegral; // unit: degree
+    float torque; // unit: N*m
+} T_GimbalDynamicsAxisState;
+
+typedef struct {
+    T_DjiTestGimbalDynamicsConfig config;
+    T_GimbalDynamicsAxisState axis[DJI_TEST_GIMBAL_DYNAMICS_AXIS_NUM];
+    T_GimbalDynamicsCommand latestCommand;
+    T_GimbalDynamicsCommand delayLine[GIMBAL_DYNAMICS_DELAY_LINE_SIZE];
+    uint32_t delayLineIndex;
+    uint64_t randomState;
+    float spareGaussian;
+    bool spareGaussianValid;
+    float pendingTime; // unit: s
+    uint64_t stepCount;
+} T_GimbalDynamics;
+
+/* Private functions declaration ---------------------------------------------*/
+static T_DjiReturnCode DjiTest_GimbalDynamicsCheckConfig(const T_DjiTestGimbalDynamicsConfig *config);
+static void DjiTest_GimbalDynamicsSimulateStep(T_GimbalDynamics *dynamics);
+static void DjiTest_GimbalDynamicsMeasure(T_GimbalDynamics *dynamics, uint8_t axisIndex);
+static float DjiTest_GimbalDynamicsClamp(float value, float limit);
+static float DjiTest_GimbalDynamicsRandomUniform(T_GimbalDynamics *dynamics);
+static float DjiTest_GimbalDynamicsRandomGaussian(T_GimbalDynamics *dynamics);
+static void DjiTest_GimbalDynamicsAttitudeToArray(const T_DjiAttitude3f *attitude,
+                                                  float array[DJI_TEST_GIMBAL_DYNAMICS_AXIS_NUM]);
+static void DjiTest_GimbalDynamicsArrayToAttitude(const float array[DJI_TEST_GIMBAL_DYNAMICS_AXIS_NUM],
+                                                  T_DjiAttitude3f *attitude);
+static T_DjiReturnCode DjiTest_GimbalDynamicsModelReset(void *context, const T_DjiAttitude3f *attitude);
+static T_DjiReturnCode DjiTest_GimbalDynamicsModelCommand(void *context, const T_DjiTestGimbalDynamicsCommand *command);
+static T_DjiReturnCode DjiTest_GimbalDynamicsModelStep(void *context, float elapsedTime);
+static T_DjiReturnCode DjiTest_GimbalDynamicsModelGetAttitude(void *context, T_DjiAttitude3f *attitude,
+                                                              T_DjiAttitude3f *rate);
+
+/* Exported functions definition ---------------------------------------------*/
+/**
+ * @brief Parameters of a small three axis brushless gimbal, controlled at 1 kHz with two steps of command delay.
+ * @param config: pointer to the config to fill.
+ */
+void DjiTest_GimbalDynamicsGetDefaultConfig(T_DjiTestGimbalDynamicsConfig *config)
+{
+    T_DjiTestGimbalDynamicsAxisConfig axisConfig = {
+        .inertia = 0.002f,
+        .damping = 0.001f,
+        .maxTorque = 0.2f,
+        .maxRate = 180.0f,
+        .angleKp = 8.0f,
+        .rateKp = 0.002f,
+        .rateKi = 0.02f,
+        .rateKd = 0.0f,
+        .gyroNoiseStd = 0.05f,
+        .angleNoiseStd = 0.02f,
+        .encoderCountsPerRev = 16384,
+    };
+    uint8_t i;
+
+    memset(config, 0, sizeof(T_DjiTestGimbalDynamicsConfig));
+    for (i = 0; i < DJI_TEST_GIMBAL_DYNAMICS_AXIS_NUM; i++) {
+        config->axis[i] = axisConfig;
+    }
+    // yaw motor drives the whole gimbal
+    config->axis[DJI_TEST_GIMBAL_DYNAMICS_AXIS_YAW].inertia = 0.004f;
+    config->stepTime = 0.001f;
+    config->commandDelaySteps = 2;
+    config->seed = GIMBAL_DYNAMICS_DEFAULT_SEED;
+}
+
+T_DjiReturnCode DjiTest_GimbalDynamicsCreate(const T_DjiTestGimbalDynamicsConfig *config,
+                                             T_DjiTestGimbalDynamicsHandle *handle)
+{
+    T_DjiReturnCode returnCode;
+    T_GimbalDynamics *dynamics;
+    T_DjiAttitude3f attitude = {0};
+    T_DjiOsalHandler *osalHandler = DjiPlatform_GetOsalHandler();
+
+    if (config == NULL || handle == NULL) {
+        return DJI_ERROR_SYSTEM_MODULE_CODE_INVALID_PARAMETER;
+    }
+
+    returnCode = DjiTest_GimbalDynamicsCheckConfig(config);
+    if (returnCode != DJI_ERROR_SYSTEM_MODULE_CODE_SUCCESS) {
+        return returnCode;
+    }
+
+    dynamics = osalHandler->Malloc(sizeof(T_GimbalDynamics));
+    if (dynamics == NULL) {
+        USER_LOG_ERROR("malloc gimbal dynamics error.");
+        return DJI_ERROR_SYSTEM_MODULE_CODE_MEMORY_ALLOC_FAILED;
+    }
+
+    memset(dynamics, 0, sizeof(T_GimbalDynamics));
+    dynamics->config = *config;
+    // xorshift state must not be zero
+    dynamics->randomState = config->seed != 0 ? config->seed : GIMBAL_DYNAMICS_DEFAULT_SEED;
+    DjiTest_GimbalDynamicsReset(dynamics, &attitude);
+
+    *handle = dynamics;
+
+    return DJI_ERROR_SYSTEM_MODULE_CODE_SUCCESS;
+}
+
+T_DjiReturnCode DjiTest_GimbalDynamicsDestroy(T_DjiTestGimbalDynamicsHandle handle)
+{
+    if (handle == NULL) {
+        return DJI_ERROR_SYSTEM_MODULE_CODE_INVALID_PARAMETER;
+    }
+
+    DjiPlatform_GetOsalHandler()->Free(handle);
+
+    return DJI_ERROR_SYSTEM_MODULE_CODE_SUCCESS;
+}
+
+/**
+ * @brief Place the gimbal at rest on the given attitude and hold it there. Pending commands are dropped, the
+ * noise sequence continues.
+ * @param handle: gimbal dynamics handle.
+ * @param attitude: unit: degree.
+ * @return Execution result.
+ */
+T_DjiReturnCode DjiTest_GimbalDynamicsReset(T_DjiTestGimbalDynamicsHandle handle, const T_DjiAttitude3f *attitude)
+{
+    T_GimbalDynamics *dynamics = (T_GimbalDynamics *) handle;
+    float angle[DJI_TEST_GIMBAL_DYNAMICS_AXIS_NUM];
+    uint32_t i;
+
+    if (dynamics == NULL || attitude == NULL) {
+        return DJI_ERROR_SYSTEM_MODULE_CODE_INVALID_PARAMETER;
+    }
+
+    DjiTest_GimbalDynamicsAttitudeToArray(attitude, angle);
+
+    memset(dynamics->axis, 0, sizeof(dynamics->axis));
+    memset(&dynamics->latestCommand, 0, sizeof(T_GimbalDynamicsCommand));
+    dynamics->latestCommand.type = DJI_TEST_GIMBAL_DYNAMICS_COMMAND_ANGLE;
+    for (i = 0; i < DJI_TEST_GIMBAL_DYNAMICS_AXIS_NUM; i++) {
+        dynamics->axis[i].angle = angle[i];
+        dynamics->latestCommand.value[i] = angle[i];
+        DjiTest_GimbalDynamicsMeasure(dynamics, i);
+    }
+
+    for (i = 0; i < GIMBAL_DYNAMICS_DELAY_LINE_SIZE; i++) {
+        dynamics->delayLine[i] = dynamics->latestCommand;
+    }
+    dynamics->pendingTime = 0;
+
+    return DJI_ERROR_SYSTEM_MODULE_CODE_SUCCESS;
+}
+
+/**
+ * @brief Set the command the controller acts on after the configured command delay. The command stays in
+ * effect until the next one.
+ * @param handle: gimbal dynamics handle.
+ * @param command: rate or angle command.
+ * @return Execution result.
+ */
+T_DjiReturnCode DjiTest_GimbalDynamicsCommand(T_DjiTestGimbalDynamicsHandle handle,
+                                              const T_DjiTestGimbalDynamicsCommand *command)
+{
+    T_GimbalDynamics *dynamics = (T_GimbalDynamics *) handle;
+
+    if (dynamics == NULL || command == NULL) {
+        return DJI_ERROR_SYSTEM_MODULE_CODE_INVALID_PARAMETER;
+    }
+
+    if (command->type != DJI_TEST_GIMBAL_DYNAMICS_COMMAND_RATE &&
+        command->type != DJI_TEST_GIMBAL_DYNAMICS_COMMAND_ANGLE) {
+        return DJI_ERROR_SYSTEM_MODULE_CODE_INVALID_PARAMETER;
+    }
+
+    dynamics->latestCommand.type = command->type;
+    DjiTest_GimbalDynamicsAttitudeToArray(&command->value, dynamics->latestCommand.value);
+    DjiTest_GimbalDynamicsAttitudeToArray(&command->rateLimit, dynamics->latestCommand.rateLimit);
+
+    return DJI_ERROR_SYSTEM_MODULE_CODE_SUCCESS;
+}
+
+/**
+ * @brief Advance the model by the elapsed time in fixed steps, the remainder is carried to the next call. The
+ * model does not look at the wall clock, so it can be stepped faster than real time.
+ * @param handle: gimbal dynamics handle.
+ * @param elapsedTime: unit: s.
+ * @return Execution result.
+ */
+T_DjiReturnCode DjiTest_GimbalDynamicsStep(T_DjiTestGimbalDynamicsHandle handle, float elapsedTime)
+{
+    T_GimbalDynamics *dynamics = (T_GimbalDynamics *) handle;
+    uint32_t stepNum = 0;
+
+    if (dynamics == NULL || elapsedTime < 0) {
+        return DJI_ERROR_SYSTEM_MODULE_CODE_INVALID_PARAMETER;
+    }
+
+    dynamics->pendingTime += elapsedTime;
+    while (dynamics->pendingTime >= dynamics->config.stepTime) {
+        if (stepNum >= GIMBAL_DYNAMICS_MAX_STEPS_PER_CALL) {
+            USER_LOG_WARN("gimbal dynamics step time too long, drop %d ms.", (int) (dynamics->pendingTime * 1000));
+            dynamics->pendingTime = 0;
+            break;
+        }
+
+        DjiTest_GimbalDynamicsSimulateStep(dynamics);
+        dynamics->pendingTime -= dynamics->config.stepTime;
+        stepNum++;
+    }
+
+    return DJI_ERROR_SYSTEM_MODULE_CODE_SUCCESS;
+}
+
+T_DjiReturnCode DjiTest_GimbalDynamicsGetState(T_DjiTestGimbalDynamicsHandle handle,
+                                               T_DjiTestGimbalDynamicsState *state)
+{
+    T_GimbalDynamics *dynamics = (T_GimbalDynamics *) handle;
+    float value[DJI_TEST_GIMBAL_DYNAMICS_AXIS_NUM];
+    uint8_t i;
+
+    if (dynamics == NULL || state == NULL) {
+        return DJI_ERROR_SYSTEM_MODULE_CODE_INVALID_PARAMETER;
+    }
+
+    for (i = 0; i < DJI_TEST_GIMBAL_DYNAMICS_AXIS_NUM; i++) {
+        value[i] = dynamics->axis[i].angle;
+    }
+    DjiTest_GimbalDynamicsArrayToAttitude(value, &state->attitude);
+
+    for (i = 0; i < DJI_TEST_GIMBAL_DYNAMICS_AXIS_NUM; i++) {
+        value[i] = dynamics->axis[i].rate;
+    }
+    DjiTest_GimbalDynamicsArrayToAttitude(value, &state->rate);
+
+    for (i = 0; i < DJI_TEST_GIMBAL_DYNAMICS_AXIS_NUM; i++) {
+        value[i] = dynamics->axis[i].measuredAngle;
+    }
+    DjiTest_GimbalDynamicsArrayToAttitude(value, &state->measuredAttitude);
+
+    for (i = 0; i < DJI_TEST_GIMBAL_DYNAMICS_AXIS_NUM; i++) {
+        value[i] = dynamics->axis[i].measuredRate;
+    }
+    DjiTest_GimbalDynamicsArrayToAttitude(value, &state->measuredRate);
+
+    for (i = 0; i < DJI_TEST_GIMBAL_DYNAMICS_AXIS_NUM; i++) {
+        value[i] = dynamics->axis[i].torque;
+    }
+    DjiTest_GimbalDynamicsArrayToAttitude(value, &state->torque);
+
+    state->stepCount = dynamics->stepCount;
+    state->simulationTime = (double) dynamics->stepCount * (double) dynamics->config.stepTime;
+
+    return DJI_ERROR_SYSTEM_MODULE_CODE_SUCCESS;
+}
+
+/**
+ * @brief Wrap the model into the interface driven by the gimbal emulator.
+ * @param handle: gimbal dynamics handle, must stay valid as long as the model is in use.
+ * @param model: pointer to the model interface to fill.
+ * @return Execution result.
+ */
+T_DjiReturnCode DjiTest_GimbalDynamicsGetModel(T_DjiTestGimbalDynamicsHandle handle,
+                                               T_DjiTestGimbalDynamicsModel *model)
+{
+    if (handle == NULL || model == NULL) {
+        return DJI_ERROR_SYSTEM_MODULE_CODE_INVALID_PARAMETER;
+    }
+
+    model->context = handle;
+    model->Reset = DjiTest_GimbalDynamicsModelReset;
+    model->Command = DjiTest_GimbalDynamicsModelCommand;
+    model->Step = DjiTest_GimbalDynamicsModelStep;
+    model->GetAttitude = DjiTest_GimbalDynamicsModelGetAttitude;
+
+    return DJI_ERROR_SYSTEM_MODULE_CODE_SUCCESS;
+}
+
+/* Private functions definition-----------------------------------------------*/
+static T_DjiReturnCode DjiTest_GimbalDynamicsCheckConfig(const T_DjiTestGimbalDynamicsConfig *config)
+{
+    const T_DjiTestGimbalDynamicsAxisConfig *axisConfig;
+    uint8_t i;
+
+    if (config->stepTime <= 0) {
+        USER_LOG_ERROR("gimbal dynamics step time invalid.");
+        return DJI_ERROR_SYSTEM_MODULE_CODE_INVALID_PARAMETER;
+    }
+
+    if (config->commandDelaySteps > DJI_TEST_GIMBAL_DYNAMICS_MAX_DELAY_STEPS) {
+        USER_LOG_ERROR("gimbal dynamics command delay %d steps out of range.", config->commandDelaySteps);
+        return DJI_ERROR_SYSTEM_MODULE_CODE_OUT_OF_RANGE;
+    }
+
+    for (i = 0; i < DJI_TEST_GIMBAL_DYNAMICS_AXIS_NUM; i++) {
+        axisConfig = &config->axis[i];
+        if (axisConfig->inertia <= 0 || axisConfig->damping < 0 || axisConfig->maxTorque <= 0 ||
+            axisConfig->maxRate <= 0 || axisConfig->gyroNoiseStd < 0 || axisConfig->angleNoiseStd < 0) {
+            USER_LOG_ERROR("gimbal dynamics axis %d config invalid.", i);
+            return DJI_ERROR_SYSTEM_MODULE_CODE_INVALID_PARAMETER;
+        }
+    }
+
+    return DJI_ERROR_SYSTEM_MODULE_CODE_SUCCESS;
+}
+
+/**
+ * @brief One control and integration step. The controller only sees the delayed command and the sensor
+ * readings of the previous step, the plant is integrated with semi-implicit Euler.
+ */
+static void DjiTest_GimbalDynamicsSimulateStep(T_GimbalDynamics *dynamics)
+{
+    const T_GimbalDynamicsCommand *command;
+    const T_DjiTestGimbalDynamicsAxisConfig *axisConfig;
+    T_GimbalDynamicsAxisState *axisState;
+    float dt = dynamics->config.stepTime;
+    float rateLimit;
+    float rateSetpoint;
+    float rateError;
+    float rateDerivative;
+    float integralLimit;
+    float torque;
+    float acceleration;
+    uint32_t readIndex;
+    uint8_t i;
+
+    dynamics->delayLine[dynamics->delayLineIndex] = dynamics->latestCommand;
+    readIndex = (dynamics->delayLineIndex + GIMBAL_DYNAMICS_DELAY_LINE_SIZE - dynamics->config.commandDelaySteps) %
+                GIMBAL_DYNAMICS_DELAY_LINE_SIZE;
+    command = &dynamics->delayLine[readIndex];
+    dynamics->delayLineIndex = (dynamics->delayLineIndex + 1) % GIMBAL_DYNAMICS_DELAY_LINE_SIZE;
+
+    for (i = 0; i < DJI_TEST_GIMBAL_DYNAMICS_AXIS_NUM; i++) {
+        axisConfig = &dynamics->config.axis[i];
+        axisState = &dynamics->axis[i];
+
+        // angle loop
+        if (command->type == DJI_TEST_GIMBAL_DYNAMICS_COMMAND_ANGLE) {
+            rateLimit = command->rateLimit[i] > 0 ? USER_UTIL_MIN(fabsf(command->rateLimit[i]), axisConfig->maxRate)
+                                                  : axisConfig->maxRate;
+            rateSetpoint = DjiTest_GimbalDynamicsClamp(
+                axisConfig->angleKp * (command->value[i] - axisState->measuredAngle), rateLimit);
+        } else {
+            rateSetpoint = DjiTest_GimbalDynamicsClamp(command->value[i], axisConfig->maxRate);
+        }
+
+        // rate loop, derivative on measurement to avoid kicks on setpoint changes
+        rateError = rateSetpoint - axisState->measuredRate;
+        rateDerivative = -(axisState->measuredRate - axisState->lastMeasuredRate) / dt;
+        axisState->lastMeasuredRate = axisState->measuredRate;
+
+        torque = axisConfig->rateKp * rateError + axisConfig->rateKi * axisState->rateIntegral +
+                 axisConfig->rateKd * rateDerivative;
+        // stop integrating while the motor saturates in the same direction
+        if (fabsf(torque) < axisConfig->maxTorque || torque * rateError < 0) {
+            axisState->rateIntegral += rateError * dt;
+            if (axisConfig->rateKi > 0) {
+                integralLimit = axisConfig->maxTorque / axisConfig->rateKi;
+                axisState->rateIntegral = DjiTest_GimbalDynamicsClamp(axisState->rateIntegral, integralLimit);
+            }
+        }
+        torque = DjiTest_GimbalDynamicsClamp(torque, axisConfig->maxTorque);
+        axisState->torque = torque;
+
+        // plant
+        acceleration = (torque - axisConfig->damping * axisState->rate / GIMBAL_DYNAMICS_DEG_PER_RAD) /
+                       axisConfig->inertia * GIMBAL_DYNAMICS_DEG_PER_RAD;
+        axisState->rate = DjiTest_GimbalDynamicsClamp(axisState->rate + acceleration * dt, axisConfig->maxRate);
+        axisState->angle += axisState->rate * dt;
+
+        DjiTest_GimbalDynamicsMeasure(dynamics, i);
+    }
+
+    dynamics->stepCount++;
+}
+
+static void DjiTest_GimbalDynamicsMeasure(T_GimbalDynamics *dynamics, uint8_t axisIndex)
+{
+    const T_DjiTestGimbalDynamicsAxisConfig *axisConfig = &dynamics->config.axis[axisIndex];
+    T_GimbalDynamicsAxisState *axisState = &dynamics->axis[axisIndex];
+    float resolution;
+    float angle = axisState->angle;
+
+    if (axisConfig->encoderCountsPerRev != 0) {
+        resolution = 360.0f / (float) axisConfig->encoderCountsPerRev;
+        angle = roundf(angle / resolution) * resolution;
+    }
+
+    axisState->measuredAngle = angle + axisConfig->angleNoiseStd * DjiTest_GimbalDynamicsRandomGaussian(dynamics);
+    axisState->measuredRate =
+        axisState->rate + axisConfig->gyroNoiseStd * DjiTest_GimbalDynamicsRandomGaussian(dynamics);
+}
+
+static float DjiTest_GimbalDynamicsClamp(float value, float limit)
+{
+    if (value > limit) {
+        return limit;
+    } else if (value < -limit) {
+        return -limit;
+    }
+
+    return value;
+}
+
+/**
+ * @brief Uniform random number in (0, 1] from a xorshift64* generator.
+ */
+static float DjiTest_GimbalDynamicsRandomUniform(T_GimbalDynamics *dynamics)
+{
+    uint64_t x = dynamics->randomState;
+
+    x ^= x >> 12;
+    x ^= x << 25;
+    x ^= x >> 27;
+    dynamics->randomState = x;
+
+    return (float) (((x * 0x2545F4914F6CDD1DULL) >> 40) + 1) / 16777216.0f;
+}
+
+/**
+ * @brief Standard normal random number, Box-Muller transform producing two values per call pair.
+ */
+static float DjiTest_GimbalDynamicsRandomGaussian(T_GimbalDynamics *dynamics)
+{
+    float radius;
+    float theta;
+
+    if (dynamics->spareGaussianValid) {
+        dynamics->spareGaussianValid = false;
+        return dynamics->spareGaussian;
+    }
+
+    radius = sqrtf(-2.0f * logf(DjiTest_GimbalDynamicsRandomUniform(dynamics)));
+    theta = GIMBAL_DYNAMICS_TWO_PI * DjiTest_GimbalDynamicsRandomUniform(dynamics);
+    dynamics->spareGaussian = radius * sinf(theta);
+    dynamics->spareGaussianValid = true;
+
+    return radius * cosf(theta);
+}
+
+static void DjiTest_GimbalDynamicsAttitudeToArray(const T_DjiAttitude3f *attitude,
+                                                  float array[DJI_TEST_GIMBAL_DYNAMICS_AXIS_NUM])
+{
+    array[DJI_TEST_GIMBAL_DYNAMICS_AXIS_PITCH] = attitude->pitch;
+    array[DJI_TEST_GIMBAL_DYNAMICS_AXIS_ROLL] = attitude->roll;
+    array[DJI_TEST_GIMBAL_DYNAMICS_AXIS_YAW] = attitude->yaw;
+}
+
+static void DjiTest_GimbalDynamicsArrayToAttitude(const float array[DJI_TEST_GIMBAL_DYNAMICS_AXIS_NUM],
+                                                  T_DjiAttitude3f *attitude)
+{
+    attitude->pitch = array[DJI_TEST_GIMBAL_DYNAMICS_AXIS_PITCH];
+    attitude->roll = array[DJI_TEST_GIMBAL_DYNAMICS_AXIS_ROLL];
+    attitude->yaw = array[DJI_TEST_GIMBAL_DYNAMICS_AXIS_YAW];
+}
+
+static T_DjiReturnCode DjiTest_GimbalDynamicsModelReset(void *context, const T_DjiAttitude3f *attitude)
+{
+    return DjiTest_GimbalDynamicsReset(context, attitude);
+}
+
+static T_DjiReturnCode DjiTest_GimbalDynamicsModelCommand(void *context, const T_DjiTestGimbalDynamicsCommand *command)
+{
+    return DjiTest_GimbalDynamicsCommand(context, command);
+}
+
+static T_DjiReturnCode DjiTest_GimbalDynamicsModelStep(void *context, float elapsedTime)
+{
+    return DjiTest_GimbalDynamicsStep(context, elapsedTime);
+}
+
+static T_DjiReturnCode DjiTest_GimbalDynamicsModelGetAttitude(void *context, T_DjiAttitude3f *attitude,
+                                                              T_DjiAttitude3f *rate)
+{
+    T_GimbalDynamics *dynamics = (T_GimbalDynamics *) context;
+    float value[DJI_TEST_GIMBAL_DYNAMICS_AXIS_NUM];
+    uint8_t i;
+
+    if (dynamics == NULL) {
+        return DJI_ERROR_SYSTEM_MODULE_CODE_INVALID_PARAMETER;
+    }
+
+    if (attitude != NULL) {
+        for (i = 0; i < DJI_TEST_GIMBAL_DYNAMICS_AXIS_NUM; i++) {
+            value[i] = dynamics->axis[i].measuredAngle;
+        }
+        DjiTest_GimbalDynamicsArrayToAttitude(value, attitude);
+    }
+
+    if (rate != NULL) {
+        for (i = 0; i < DJI_TEST_GIMBAL_DYNAMICS_AXIS_NUM; i++) {
+            value[i] = dynamics->axis[i].measuredRate;
+        }
+        DjiTest_GimbalDynamicsArrayToAttitude(value, rate);
+    }
+
+    return DJI_ERROR_SYSTEM_MODULE_CODE_SUCCESS;
+}
+
+#endif
+
+/****************** (C) COPYRIGHT DJI Innovations *****END OF FILE****/
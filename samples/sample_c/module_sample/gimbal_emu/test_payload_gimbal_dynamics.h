@@ -0,0 +1,131 @@
+/**
+ ********************************************************************
+ * @file    test_payload_gimbal_dynamics.h
+ * @brief   This is the header file for "test_payload_gimbal_dynamics.c", defining the structure and
+ * (exported) function prototypes.
+ *
+ * @copyright (c) 2021 DJI. All rights reserved.
+ *
+ * All information contained herein is, and remains, the property of DJI.
+ * The intellectual and technical concepts contained herein are proprietary
+ * to DJI and may be covered by U.S. and foreign patents, patents in process,
+ * and protected by trade secret or copyright law.  Dissemination of this
+ * information, including but not limited to data and other proprietary
+ * material(s) incorporated within the information, in any form, is strictly
+ * prohibited without the express written consent of DJI.
+ *
+ * If you receive this source code without DJI’s authorization, you may not
+ * further disseminate the information, and you must immediately remove the
+ * source code and notify DJI of its removal. DJI reserves the right to pursue
+ * legal actions against you for any loss(es) or damage(s) caused by your
+ * failure to do so.
+ *
+ *********************************************************************
+ */
+
+/* Define to prevent recursive inclusion -------------------------------------*/
+#ifndef TEST_PAYLOAD_GIMBAL_DYNAMICS_H
+#define TEST_PAYLOAD_GIMBAL_DYNAMICS_H
+
+/* Includes ------------------------------------------------------------------*/
+#include "dji_typedef.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#ifdef SYSTEM_ARCH_LINUX
+
+/* Exported constants --------------------------------------------------------*/
+#define DJI_TEST_GIMBAL_DYNAMICS_AXIS_NUM               (3)
+#define DJI_TEST_GIMBAL_DYNAMICS_MAX_DELAY_STEPS        (127)
+
+/* Exported types ------------------------------------------------------------*/
+typedef void *T_DjiTestGimbalDynamicsHandle;
+
+typedef enum {
+    DJI_TEST_GIMBAL_DYNAMICS_AXIS_PITCH = 0,
+    DJI_TEST_GIMBAL_DYNAMICS_AXIS_ROLL = 1,
+    DJI_TEST_GIMBAL_DYNAMICS_AXIS_YAW = 2,
+} E_DjiTestGimbalDynamicsAxis;
+
+typedef enum {
+    DJI_TEST_GIMBAL_DYNAMICS_COMMAND_RATE = 0,
+    DJI_TEST_GIMBAL_DYNAMICS_COMMAND_ANGLE = 1,
+} E_DjiTestGimbalDynamicsCommandType;
+
+/**
+ * @brief Motor, controller and sensor parameters of one axis. The rate loop is a PID producing motor torque,
+ * the angle loop is a P controller producing the rate setpoint.
+ */
+typedef struct {
+    float inertia; /*!< Unit: kg*m^2. */
+    float damping; /*!< Viscous friction, unit: N*m*s/rad. */
+    float maxTorque; /*!< Unit: N*m. */
+    float maxRate; /*!< Unit: degree/s. */
+    float angleKp; /*!< Unit: 1/s. */
+    float rateKp; /*!< Unit: N*m/(degree/s). */
+    float rateKi; /*!< Unit: N*m/degree. */
+    float rateKd; /*!< Unit: N*m/(degree/s^2). */
+    float gyroNoiseStd; /*!< Standard deviation of the rate sensor, unit: degree/s. */
+    float angleNoiseStd; /*!< Standard deviation of the angle sensor, unit: degree. */
+    uint32_t encoderCountsPerRev; /*!< Angle sensor resolution, 0 disables the quantization. */
+} T_DjiTestGimbalDynamicsAxisConfig;
+
+typedef struct {
+    T_DjiTestGimbalDynamicsAxisConfig axis[DJI_TEST_GIMBAL_DYNAMICS_AXIS_NUM];
+    float stepTime; /*!< Fixed integration and control step, unit: s. */
+    uint32_t commandDelaySteps; /*!< Steps between a command and the controller acting on it. */
+    uint64_t seed; /*!< Seed of the sensor noise, the same seed and inputs give the same trajectory. */
+} T_DjiTestGimbalDynamicsConfig;
+
+typedef struct {
+    E_DjiTestGimbalDynamicsCommandType type;
+    T_DjiAttitude3f value; /*!< Unit: degree for angle command, degree/s for rate command. */
+    T_DjiAttitude3f rateLimit; /*!< Rate limit of the angle command, 0 means the axis max rate, unit: degree/s. */
+} T_DjiTestGimbalDynamicsCommand;
+
+typedef struct {
+    T_DjiAttitude3f attitude; /*!< Ground truth, unit: degree. */
+    T_DjiAttitude3f rate; /*!< Ground truth, unit: degree/s. */
+    T_DjiAttitude3f measuredAttitude; /*!< Unit: degree. */
+    T_DjiAttitude3f measuredRate; /*!< Unit: degree/s. */
+    T_DjiAttitude3f torque; /*!< Unit: N*m. */
+    uint64_t stepCount;
+    double simulationTime; /*!< Unit: s. */
+} T_DjiTestGimbalDynamicsState;
+
+/**
+ * @brief Dynamics model driven by the gimbal emulator. Step() advances the model by the elapsed time and is
+ * free to run it faster than real time, GetAttitude() returns what the gimbal sensors report.
+ */
+typedef struct {
+    void *context;
+    T_DjiReturnCode (*Reset)(void *context, const T_DjiAttitude3f *attitude);
+    T_DjiReturnCode (*Command)(void *context, const T_DjiTestGimbalDynamicsCommand *command);
+    T_DjiReturnCode (*Step)(void *context, float elapsedTime);
+    T_DjiReturnCode (*GetAttitude)(void *context, T_DjiAttitude3f *attitude, T_DjiAttitude3f *rate);
+} T_DjiTestGimbalDynamicsModel;
+
+/* Exported functions --------------------------------------------------------*/
+void DjiTest_GimbalDynamicsGetDefaultConfig(T_DjiTestGimbalDynamicsConfig *config);
+T_DjiReturnCode DjiTest_GimbalDynamicsCreate(const T_DjiTestGimbalDynamicsConfig *config,
+                                             T_DjiTestGimbalDynamicsHandle *handle);
+T_DjiReturnCode DjiTest_GimbalDynamicsDestroy(T_DjiTestGimbalDynamicsHandle handle);
+T_DjiReturnCode DjiTest_GimbalDynamicsReset(T_DjiTestGimbalDynamicsHandle handle, const T_DjiAttitude3f *attitude);
+T_DjiReturnCode DjiTest_GimbalDynamicsCommand(T_DjiTestGimbalDynamicsHandle handle,
+                                              const T_DjiTestGimbalDynamicsCommand *command);
+T_DjiReturnCode DjiTest_GimbalDynamicsStep(T_DjiTestGimbalDynamicsHandle handle, float elapsedTime);
+T_DjiReturnCode DjiTest_GimbalDynamicsGetState(T_DjiTestGimbalDynamicsHandle handle,
+                                               T_DjiTestGimbalDynamicsState *state);
+T_DjiReturnCode DjiTest_GimbalDynamicsGetModel(T_DjiTestGimbalDynamicsHandle handle,
+                                               T_DjiTestGimbalDynamicsModel *model);
+
+#endif
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // TEST_PAYLOAD_GIMBAL_DYNAMICS_H
+/************************ (C) COPYRIGHT DJI Innovations *******END OF FILE******/
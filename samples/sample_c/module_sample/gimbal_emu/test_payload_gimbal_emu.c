@@ -26,18 +26,37 @@
 #include "math.h"
 #include <dji_gimbal.h>
 #include "test_payload_gimbal_emu.h"
+#include "test_payload_gimbal_dynamics.h"
 #include "dji_fc_subscription.h"
 #include "dji_logger.h"
 #include "dji_platform.h"
 #include "utils/util_misc.h"
 #include "widget_interaction_test/test_widget_interaction.h"
 
+#ifdef SYSTEM_ARCH_LINUX
+
+#include <time.h>
+#include <errno.h>
+
+#endif
+
 /* Private constants ---------------------------------------------------------*/
 #define PAYLOAD_GIMBAL_EMU_TASK_STACK_SIZE  (2048)
 #define PAYLOAD_GIMBAL_TASK_FREQ            1000
 #define PAYLOAD_GIMBAL_CALIBRATION_TIME_MS  2000
 #define PAYLOAD_GIMBAL_MIN_ACTION_TIME      5
 
+#ifdef SYSTEM_ARCH_LINUX
+/* Absolute deadline scheduling of the control loop, getters read the state published by the loop without lock */
+#define PAYLOAD_GIMBAL_DEADLINE_LOOP_ENABLE
+#endif
+
+#define PAYLOAD_GIMBAL_TASK_PERIOD_NS       (1000000000ULL / PAYLOAD_GIMBAL_TASK_FREQ)
+#define PAYLOAD_GIMBAL_MAX_STEP_TIME_S      (0.1f)
+#define PAYLOAD_GIMBAL_LOOP_REPORT_FREQ     (0.1f)
+#define PAYLOAD_GIMBAL_DYNAMICS_ANGLE_TOLERANCE     (2.0f) // unit: 0.1 degree
+#define PAYLOAD_GIMBAL_DYNAMICS_RESYNC_THRESHOLD    (1.0f) // unit: 0.1 degree
+
 /* Private types -------------------------------------------------------------*/
 typedef enum {
     TEST_GIMBAL_CONTROL_TYPE_UNKNOWN = 0,
@@ -45,6 +64,22 @@ typedef enum {
     TEST_GIMBAL_CONTROL_TYPE_ANGLE = 2,
 } E_TestGimbalControlType;
 
+#ifdef PAYLOAD_GIMBAL_DEADLINE_LOOP_ENABLE
+typedef struct {
+    T_DjiGimbalAttitudeInformation attitudeInformation;
+    T_DjiAttitude3d speed;
+    T_DjiAttitude3d jointAngle;
+    T_DjiTestGimbalLoopStatistics loopStatistics;
+} T_TestGimbalPublishedState;
+
+typedef struct {
+    uint64_t startNs;
+    uint64_t deadlineNs;
+    uint64_t lastWakeNs;
+    T_DjiTestGimbalLoopStatistics statistics;
+} T_TestGimbalLoopTiming;
+#endif
+
 /* Private functions declaration ---------------------------------------------*/
 static void *UserGimbal_Task(void *arg);
 static T_DjiReturnCode GetSystemState(T_DjiGimbalSystemState *systemState);
@@ -66,6 +101,17 @@ static T_DjiReturnCode
 DjiTest_GimbalCalculateSpeed(T_DjiAttitude3d originalAttitude, T_DjiAttitude3d targetAttitude, uint16_t actionTime,
                              T_DjiAttitude3d *speed);
 static void DjiTest_GimbalSpeedLegalization(T_DjiAttitude3d *speed);
+static float DjiTest_GimbalWaitNextPeriod(void);
+#ifdef PAYLOAD_GIMBAL_DEADLINE_LOOP_ENABLE
+static void DjiTest_GimbalPublishState(void);
+static void DjiTest_GimbalReadPublishedState(T_TestGimbalPublishedState *state);
+#endif
+#ifdef SYSTEM_ARCH_LINUX
+static T_DjiReturnCode DjiTest_GimbalInstallDefaultDynamicsModel(void);
+static void DjiTest_GimbalRunDynamicsModel(float stepTime);
+static bool DjiTest_GimbalAttitudeDiffer(const T_DjiAttitude3f *attitude1, const T_DjiAttitude3f *attitude2,
+                                         float threshold);
+#endif
 static T_DjiReturnCode DjiTest_GimbalCalculateGroundAttitudeBaseQuaternion(T_DjiFcSubscriptionQuaternion quaternion,
                                                                            T_DjiAttitude3d *attitude);
 
@@ -95,6 +141,25 @@ static uint32_t s_calibrationStartTime = 0; // unit: ms
 static T_DjiMutexHandle s_attitudeMutex = NULL;
 static T_DjiMutexHandle s_calibrationMutex = NULL;
 
+#ifdef PAYLOAD_GIMBAL_DEADLINE_LOOP_ENABLE
+static const uint32_t s_loopJitterBucketBoundUs[DJI_TEST_GIMBAL_LOOP_JITTER_BUCKET_NUM - 1] = {
+    50, 100, 200, 500, 1000, 2000, 5000
+};
+static T_TestGimbalLoopTiming s_loopTiming = {0};
+static uint32_t s_publishedStateSeq = 0;
+static T_TestGimbalPublishedState s_publishedState = {0};
+#endif
+
+#ifdef SYSTEM_ARCH_LINUX
+static T_DjiTestGimbalDynamicsModel s_dynamicsModel = {0};
+static T_DjiTestGimbalDynamicsHandle s_defaultDynamicsHandle = NULL;
+static bool s_dynamicsModelConfigured = false;
+static bool s_dynamicsModelEnabled = false;
+static bool s_dynamicsModelSynced = false;
+static T_DjiAttitude3f s_dynamicsLastAttitude = {0}; // unit: 0.1 degree, ground coordination
+static T_DjiAttitude3f s_dynamicsHoldAttitude = {0}; // unit: 0.1 degree, ground coordination
+#endif
+
 /* Exported functions definition ---------------------------------------------*/
 /**
  * @brief
@@ -162,6 +227,17 @@ T_DjiReturnCode DjiTest_GimbalStartService(void)
         return djiStat;
     }
 
+#ifdef SYSTEM_ARCH_LINUX
+    /* The motors, controllers and sensors are simulated unless a model, or none, was set before the start */
+    if (s_dynamicsModelConfigured != true) {
+        djiStat = DjiTest_GimbalInstallDefaultDynamicsModel();
+        if (djiStat != DJI_ERROR_SYSTEM_MODULE_CODE_SUCCESS) {
+            USER_LOG_ERROR("install gimbal dynamics model error: 0x%08llX", djiStat);
+            return djiStat;
+        }
+    }
+#endif
+
     if (osalHandler->TaskCreate("user_gimbal_task", UserGimbal_Task,
                                 PAYLOAD_GIMBAL_EMU_TASK_STACK_SIZE, NULL, &s_userGimbalThread) !=
         DJI_ERROR_SYSTEM_MODULE_CODE_SUCCESS) {
@@ -182,6 +258,15 @@ T_DjiReturnCode DjiTest_GimbalDeInit(void)
         USER_LOG_ERROR("Destroy test gimbal thread error: 0x%08llX.", djiStat);
         return djiStat;
     }
+    s_userGimbalThread = NULL;
+
+#ifdef SYSTEM_ARCH_LINUX
+    if (s_defaultDynamicsHandle != NULL) {
+        s_dynamicsModelEnabled = false;
+        DjiTest_GimbalDynamicsDestroy(s_defaultDynamicsHandle);
+        s_defaultDynamicsHandle = NULL;
+    }
+#endif
 
     djiStat = DjiGimbal_DeInit();
     if (djiStat != DJI_ERROR_SYSTEM_MODULE_CODE_SUCCESS) {
@@ -372,6 +457,61 @@ out2:
     return returnCode;
 }
 
+#ifdef PAYLOAD_GIMBAL_DEADLINE_LOOP_ENABLE
+/**
+ * @brief Get the timing statistics of the gimbal control loop, read without blocking the loop.
+ * @param statistics: pointer to the statistics.
+ * @return Execution result.
+ */
+T_DjiReturnCode DjiTest_GimbalGetLoopStatistics(T_DjiTestGimbalLoopStatistics *statistics)
+{
+    T_TestGimbalPublishedState state;
+
+    if (statistics == NULL) {
+        return DJI_ERROR_SYSTEM_MODULE_CODE_INVALID_PARAMETER;
+    }
+
+    DjiTest_GimbalReadPublishedState(&state);
+    *statistics = state.loopStatistics;
+
+    return DJI_ERROR_SYSTEM_MODULE_CODE_SUCCESS;
+}
+#endif
+
+#ifdef SYSTEM_ARCH_LINUX
+/**
+ * @brief Drive the gimbal attitude by a dynamics model instead of integrating the commanded speed directly.
+ * @note Call before DjiTest_GimbalStartService(), the model is used by the gimbal task without further locking.
+ * Without a call the service installs the model of DjiTest_GimbalDynamicsGetDefaultConfig().
+ * @param model: dynamics model, NULL falls back to the ideal speed integration.
+ * @return Execution result.
+ */
+T_DjiReturnCode DjiTest_GimbalSetDynamicsModel(const T_DjiTestGimbalDynamicsModel *model)
+{
+    if (s_userGimbalThread != NULL) {
+        USER_LOG_ERROR("gimbal dynamics model can not be changed after service started.");
+        return DJI_ERROR_SYSTEM_MODULE_CODE_BUSY;
+    }
+
+    if (model == NULL) {
+        s_dynamicsModelEnabled = false;
+        s_dynamicsModelConfigured = true;
+        return DJI_ERROR_SYSTEM_MODULE_CODE_SUCCESS;
+    }
+
+    if (model->Reset == NULL || model->Command == NULL || model->Step == NULL || model->GetAttitude == NULL) {
+        return DJI_ERROR_SYSTEM_MODULE_CODE_INVALID_PARAMETER;
+    }
+
+    s_dynamicsModel = *model;
+    s_dynamicsModelEnabled = true;
+    s_dynamicsModelConfigured = true;
+    s_dynamicsModelSynced = false;
+
+    return DJI_ERROR_SYSTEM_MODULE_CODE_SUCCESS;
+}
+#endif
+
 /* Private functions definition-----------------------------------------------*/
 #ifndef __CC_ARM
 #pragma GCC diagnostic push
@@ -389,6 +529,7 @@ static void *UserGimbal_Task(void *arg)
     T_DjiAttitude3f attitudeFTemp = {0};
     uint32_t currentTime = 0;
     uint32_t progressTemp = 0;
+    float stepTime;
     T_DjiOsalHandler *osalHandler = DjiPlatform_GetOsalHandler();
 
     USER_UTIL_UNUSED(arg);
@@ -406,7 +547,7 @@ static void *UserGimbal_Task(void *arg)
     }
 
     while (1) {
-        osalHandler->TaskSleepMs(1000 / PAYLOAD_GIMBAL_TASK_FREQ);
+        stepTime = DjiTest_GimbalWaitNextPeriod();
         step++;
 
         if (osalHandler->MutexLock(s_attitudeMutex) != DJI_ERROR_SYSTEM_MODULE_CODE_SUCCESS) {
@@ -427,6 +568,20 @@ static void *UserGimbal_Task(void *arg)
                            s_systemState.fineTuneAngle.roll, s_systemState.fineTuneAngle.yaw);
         }
 
+#ifdef PAYLOAD_GIMBAL_DEADLINE_LOOP_ENABLE
+        if (USER_UTIL_IS_WORK_TURN(step, PAYLOAD_GIMBAL_LOOP_REPORT_FREQ, PAYLOAD_GIMBAL_TASK_FREQ)) {
+            USER_LOG_DEBUG("gimbal loop: %d loops in %d ms, overrun %d, missed periods %d, max lateness %d us.",
+                           s_loopTiming.statistics.loopCount, s_loopTiming.statistics.runTimeMs,
+                           s_loopTiming.statistics.overrunCount, s_loopTiming.statistics.missedPeriodCount,
+                           s_loopTiming.statistics.maxLatenessUs);
+            USER_LOG_DEBUG("gimbal loop lateness(us) <50:%d <100:%d <200:%d <500:%d <1000:%d <2000:%d <5000:%d >=5000:%d",
+                           s_loopTiming.statistics.jitterHistogram[0], s_loopTiming.statistics.jitterHistogram[1],
+                           s_loopTiming.statistics.jitterHistogram[2], s_loopTiming.statistics.jitterHistogram[3],
+                           s_loopTiming.statistics.jitterHistogram[4], s_loopTiming.statistics.jitterHistogram[5],
+                           s_loopTiming.statistics.jitterHistogram[6], s_loopTiming.statistics.jitterHistogram[7]);
+        }
+#endif
+
         // update aircraft attitude
         if (USER_UTIL_IS_WORK_TURN(step, 50, PAYLOAD_GIMBAL_TASK_FREQ)) {
             djiStat = DjiFcSubscription_GetLatestValueOfTopic(DJI_FC_SUBSCRIPTION_TOPIC_QUATERNION,
@@ -491,15 +646,22 @@ static void *UserGimbal_Task(void *arg)
         s_targetAttitude.roll = attitudeFTemp.roll;
         s_targetAttitude.yaw = attitudeFTemp.yaw;
 
+#ifdef SYSTEM_ARCH_LINUX
+        if (s_dynamicsModelEnabled == true) {
+            DjiTest_GimbalRunDynamicsModel(stepTime);
+            goto out1;
+        }
+#endif
+
         // rotation
         if (s_rotatingFlag != true)
             goto out1;
 
         nextAttitude.pitch =
-            (float) s_attitudeHighPrecision.pitch + (float) s_speed.pitch / (float) PAYLOAD_GIMBAL_TASK_FREQ;
+            (float) s_attitudeHighPrecision.pitch + (float) s_speed.pitch * stepTime;
         nextAttitude.roll =
-            (float) s_attitudeHighPrecision.roll + (float) s_speed.roll / (float) PAYLOAD_GIMBAL_TASK_FREQ;
-        nextAttitude.yaw = (float) s_attitudeHighPrecision.yaw + (float) s_speed.yaw / (float) PAYLOAD_GIMBAL_TASK_FREQ;
+            (float) s_attitudeHighPrecision.roll + (float) s_speed.roll * stepTime;
+        nextAttitude.yaw = (float) s_attitudeHighPrecision.yaw + (float) s_speed.yaw * stepTime;
 
         if (s_controlType == TEST_GIMBAL_CONTROL_TYPE_ANGLE) {
             nextAttitude.pitch =
@@ -533,6 +695,10 @@ static void *UserGimbal_Task(void *arg)
         }
 
 out1:
+#ifdef PAYLOAD_GIMBAL_DEADLINE_LOOP_ENABLE
+        DjiTest_GimbalPublishState();
+#endif
+
         if (osalHandler->MutexUnlock(s_commonMutex) != DJI_ERROR_SYSTEM_MODULE_CODE_SUCCESS) {
             USER_LOG_ERROR("mutex unlock error");
             goto out2;
@@ -599,6 +765,14 @@ static T_DjiReturnCode GetSystemState(T_DjiGimbalSystemState *systemState)
 
 static T_DjiReturnCode GetAttitudeInformation(T_DjiGimbalAttitudeInformation *attitudeInformation)
 {
+#ifdef PAYLOAD_GIMBAL_DEADLINE_LOOP_ENABLE
+    T_TestGimbalPublishedState state;
+
+    DjiTest_GimbalReadPublishedState(&state);
+    *attitudeInformation = state.attitudeInformation;
+
+    return DJI_ERROR_SYSTEM_MODULE_CODE_SUCCESS;
+#else
     T_DjiOsalHandler *osalHandler = DjiPlatform_GetOsalHandler();
 
     if (osalHandler->MutexLock(s_attitudeMutex) != DJI_ERROR_SYSTEM_MODULE_CODE_SUCCESS) {
@@ -614,6 +788,7 @@ static T_DjiReturnCode GetAttitudeInformation(T_DjiGimbalAttitudeInformation *at
     }
 
     return DJI_ERROR_SYSTEM_MODULE_CODE_SUCCESS;
+#endif
 }
 
 static T_DjiReturnCode GetCalibrationState(T_DjiGimbalCalibrationState *calibrationState)
@@ -637,6 +812,14 @@ static T_DjiReturnCode GetCalibrationState(T_DjiGimbalCalibrationState *calibrat
 
 static T_DjiReturnCode GetRotationSpeed(T_DjiAttitude3d *rotationSpeed)
 {
+#ifdef PAYLOAD_GIMBAL_DEADLINE_LOOP_ENABLE
+    T_TestGimbalPublishedState state;
+
+    DjiTest_GimbalReadPublishedState(&state);
+    *rotationSpeed = state.speed;
+
+    return DJI_ERROR_SYSTEM_MODULE_CODE_SUCCESS;
+#else
     T_DjiOsalHandler *osalHandler = DjiPlatform_GetOsalHandler();
 
     if (osalHandler->MutexLock(s_attitudeMutex) != DJI_ERROR_SYSTEM_MODULE_CODE_SUCCESS) {
@@ -652,10 +835,19 @@ static T_DjiReturnCode GetRotationSpeed(T_DjiAttitude3d *rotationSpeed)
     }
 
     return DJI_ERROR_SYSTEM_MODULE_CODE_SUCCESS;
+#endif
 }
 
 static T_DjiReturnCode GetJointAngle(T_DjiAttitude3d *jointAngle)
 {
+#ifdef PAYLOAD_GIMBAL_DEADLINE_LOOP_ENABLE
+    T_TestGimbalPublishedState state;
+
+    DjiTest_GimbalReadPublishedState(&state);
+    *jointAngle = state.jointAngle;
+
+    return DJI_ERROR_SYSTEM_MODULE_CODE_SUCCESS;
+#else
     T_DjiOsalHandler *osalHandler = DjiPlatform_GetOsalHandler();
 
     if (osalHandler->MutexLock(s_attitudeMutex) != DJI_ERROR_SYSTEM_MODULE_CODE_SUCCESS) {
@@ -673,6 +865,7 @@ static T_DjiReturnCode GetJointAngle(T_DjiAttitude3d *jointAngle)
     }
 
     return DJI_ERROR_SYSTEM_MODULE_CODE_SUCCESS;
+#endif
 }
 
 static T_DjiReturnCode StartCalibrate(void)
@@ -1162,4 +1355,256 @@ static T_DjiReturnCode DjiTest_GimbalCalculateGroundAttitudeBaseQuaternion(T_Dji
     return DJI_ERROR_SYSTEM_MODULE_CODE_SUCCESS;
 }
 
+/**
+ * @brief Wait for the next period of the control loop.
+ * @return Time elapsed since the last period, unit: s.
+ */
+static float DjiTest_GimbalWaitNextPeriod(void)
+{
+#ifdef PAYLOAD_GIMBAL_DEADLINE_LOOP_ENABLE
+    struct timespec now;
+    struct timespec deadline;
+    uint64_t nowNs;
+    uint64_t latenessNs;
+    uint64_t missedPeriods;
+    uint32_t bucket;
+    float stepTime;
+    T_DjiTestGimbalLoopStatistics *statistics = &s_loopTiming.statistics;
+
+    if (s_loopTiming.deadlineNs == 0) {
+        clock_gettime(CLOCK_MONOTONIC, &now);
+        s_loopTiming.startNs = (uint64_t) now.tv_sec * 1000000000ULL + (uint64_t) now.tv_nsec;
+        s_loopTiming.deadlineNs = s_loopTiming.startNs;
+        s_loopTiming.lastWakeNs = s_loopTiming.startNs;
+    }
+
+    /* Sleep to an absolute deadline, so the time spent in the loop body does not shift the period */
+    s_loopTiming.deadlineNs += PAYLOAD_GIMBAL_TASK_PERIOD_NS;
+    deadline.tv_sec = (time_t) (s_loopTiming.deadlineNs / 1000000000ULL);
+    deadline.tv_nsec = (long) (s_loopTiming.deadlineNs % 1000000000ULL);
+    while (clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &deadline, NULL) == EINTR) {
+    }
+
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    nowNs = (uint64_t) now.tv_sec * 1000000000ULL + (uint64_t) now.tv_nsec;
+    latenessNs = nowNs > s_loopTiming.deadlineNs ? nowNs - s_loopTiming.deadlineNs : 0;
+
+    statistics->loopCount++;
+    statistics->runTimeMs = (uint32_t) ((nowNs - s_loopTiming.startNs) / 1000000ULL);
+    statistics->maxLatenessUs = USER_UTIL_MAX(statistics->maxLatenessUs, (uint32_t) (latenessNs / 1000));
+    for (bucket = 0; bucket < DJI_TEST_GIMBAL_LOOP_JITTER_BUCKET_NUM - 1; bucket++) {
+        if (latenessNs / 1000 < s_loopJitterBucketBoundUs[bucket]) {
+            break;
+        }
+    }
+    statistics->jitterHistogram[bucket]++;
+
+    /* The following deadlines have passed as well, skip them instead of running the loop back to back */
+    if (latenessNs >= PAYLOAD_GIMBAL_TASK_PERIOD_NS) {
+        missedPeriods = latenessNs / PAYLOAD_GIMBAL_TASK_PERIOD_NS;
+        statistics->overrunCount++;
+        statistics->missedPeriodCount += (uint32_t) missedPeriods;
+        s_loopTiming.deadlineNs += missedPeriods * PAYLOAD_GIMBAL_TASK_PERIOD_NS;
+    }
+
+    /* Integrate over the real elapsed time, so the gimbal keeps the commanded speed when the loop runs late */
+    stepTime = (float) (nowNs - s_loopTiming.lastWakeNs) / 1e9f;
+    s_loopTiming.lastWakeNs = nowNs;
+
+    return USER_UTIL_MIN(stepTime, PAYLOAD_GIMBAL_MAX_STEP_TIME_S);
+#else
+    DjiPlatform_GetOsalHandler()->TaskSleepMs(1000 / PAYLOAD_GIMBAL_TASK_FREQ);
+
+    return 1.0f / (float) PAYLOAD_GIMBAL_TASK_FREQ;
+#endif
+}
+
+#ifdef PAYLOAD_GIMBAL_DEADLINE_LOOP_ENABLE
+/**
+ * @brief Publish the gimbal state for the getters with a sequence lock, only called by the gimbal task.
+ * The sequence is odd while the state is being written.
+ */
+static void DjiTest_GimbalPublishState(void)
+{
+    uint32_t seq = s_publishedStateSeq;
+
+    __atomic_store_n(&s_publishedStateSeq, seq + 1, __ATOMIC_RELAXED);
+    __atomic_thread_fence(__ATOMIC_RELEASE);
+
+    s_publishedState.attitudeInformation = s_attitudeInformation;
+    s_publishedState.speed = s_speed;
+    s_publishedState.jointAngle.pitch = s_attitudeInformation.attitude.pitch - s_aircraftAttitude.pitch;
+    s_publishedState.jointAngle.roll = s_attitudeInformation.attitude.roll - s_aircraftAttitude.roll;
+    s_publishedState.jointAngle.yaw = s_attitudeInformation.attitude.yaw - s_aircraftAttitude.yaw;
+    s_publishedState.loopStatistics = s_loopTiming.statistics;
+
+    __atomic_store_n(&s_publishedStateSeq, seq + 2, __ATOMIC_RELEASE);
+}
+
+static void DjiTest_GimbalReadPublishedState(T_TestGimbalPublishedState *state)
+{
+    uint32_t seqBegin;
+    uint32_t seqEnd;
+
+    do {
+        seqBegin = __atomic_load_n(&s_publishedStateSeq, __ATOMIC_ACQUIRE);
+        memcpy(state, &s_publishedState, sizeof(T_TestGimbalPublishedState));
+        __atomic_thread_fence(__ATOMIC_ACQUIRE);
+        seqEnd = __atomic_load_n(&s_publishedStateSeq, __ATOMIC_RELAXED);
+    } while ((seqBegin & 1) != 0 || seqBegin != seqEnd);
+}
+#endif
+
+#ifdef SYSTEM_ARCH_LINUX
+static T_DjiReturnCode DjiTest_GimbalInstallDefaultDynamicsModel(void)
+{
+    T_DjiReturnCode djiStat;
+    T_DjiTestGimbalDynamicsConfig dynamicsConfig;
+    T_DjiTestGimbalDynamicsModel dynamicsModel;
+
+    DjiTest_GimbalDynamicsGetDefaultConfig(&dynamicsConfig);
+    djiStat = DjiTest_GimbalDynamicsCreate(&dynamicsConfig, &s_defaultDynamicsHandle);
+    if (djiStat != DJI_ERROR_SYSTEM_MODULE_CODE_SUCCESS) {
+        return djiStat;
+    }
+
+    djiStat = DjiTest_GimbalDynamicsGetModel(s_defaultDynamicsHandle, &dynamicsModel);
+    if (djiStat == DJI_ERROR_SYSTEM_MODULE_CODE_SUCCESS) {
+        djiStat = DjiTest_GimbalSetDynamicsModel(&dynamicsModel);
+    }
+    if (djiStat != DJI_ERROR_SYSTEM_MODULE_CODE_SUCCESS) {
+        DjiTest_GimbalDynamicsDestroy(s_defaultDynamicsHandle);
+        s_defaultDynamicsHandle = NULL;
+        return djiStat;
+    }
+
+    /* Still the default at the next start */
+    s_dynamicsModelConfigured = false;
+
+    return DJI_ERROR_SYSTEM_MODULE_CODE_SUCCESS;
+}
+
+/**
+ * @brief Command the dynamics model from the rotation state and take the attitude reported by its sensors,
+ * only called by the gimbal task with the attitude locks held. The model holds the last attitude when the
+ * gimbal does not rotate.
+ * @param stepTime: time elapsed since the last call, unit: s.
+ */
+static void DjiTest_GimbalRunDynamicsModel(float stepTime)
+{
+    T_DjiReturnCode djiStat;
+    T_DjiTestGimbalDynamicsCommand command = {0};
+    T_DjiAttitude3f attitude = {0};
+    T_DjiAttitude3f nextAttitude = {0};
+    T_DjiAttitude3f targetAttitude = {0};
+
+    /* The attitude was moved outside the model by reset, fine tune or the stable control, move the model too */
+    if (s_dynamicsModelSynced != true ||
+        DjiTest_GimbalAttitudeDiffer(&s_attitudeHighPrecision, &s_dynamicsLastAttitude,
+                                     PAYLOAD_GIMBAL_DYNAMICS_RESYNC_THRESHOLD)) {
+        attitude.pitch = s_attitudeHighPrecision.pitch / 10.0f;
+        attitude.roll = s_attitudeHighPrecision.roll / 10.0f;
+        attitude.yaw = s_attitudeHighPrecision.yaw / 10.0f;
+        djiStat = s_dynamicsModel.Reset(s_dynamicsModel.context, &attitude);
+        if (djiStat != DJI_ERROR_SYSTEM_MODULE_CODE_SUCCESS) {
+            USER_LOG_ERROR("reset gimbal dynamics model error: 0x%08llX.", djiStat);
+            return;
+        }
+
+        s_dynamicsHoldAttitude = s_attitudeHighPrecision;
+        s_dynamicsLastAttitude = s_attitudeHighPrecision;
+        s_dynamicsModelSynced = true;
+    }
+
+    targetAttitude.pitch = (float) s_targetAttitude.pitch;
+    targetAttitude.roll = (float) s_targetAttitude.roll;
+    targetAttitude.yaw = (float) s_targetAttitude.yaw;
+
+    if (s_rotatingFlag == true && s_controlType == TEST_GIMBAL_CONTROL_TYPE_SPEED) {
+        command.type = DJI_TEST_GIMBAL_DYNAMICS_COMMAND_RATE;
+        command.value.pitch = (float) s_speed.pitch / 10.0f;
+        command.value.roll = (float) s_speed.roll / 10.0f;
+        command.value.yaw = (float) s_speed.yaw / 10.0f;
+    } else if (s_rotatingFlag == true && s_controlType == TEST_GIMBAL_CONTROL_TYPE_ANGLE) {
+        command.type = DJI_TEST_GIMBAL_DYNAMICS_COMMAND_ANGLE;
+        command.value.pitch = targetAttitude.pitch / 10.0f;
+        command.value.roll = targetAttitude.roll / 10.0f;
+        command.value.yaw = targetAttitude.yaw / 10.0f;
+        command.rateLimit.pitch = fabsf((float) s_speed.pitch) / 10.0f;
+        command.rateLimit.roll = fabsf((float) s_speed.roll) / 10.0f;
+        command.rateLimit.yaw = fabsf((float) s_speed.yaw) / 10.0f;
+    } else {
+        command.type = DJI_TEST_GIMBAL_DYNAMICS_COMMAND_ANGLE;
+        command.value.pitch = s_dynamicsHoldAttitude.pitch / 10.0f;
+        command.value.roll = s_dynamicsHoldAttitude.roll / 10.0f;
+        command.value.yaw = s_dynamicsHoldAttitude.yaw / 10.0f;
+    }
+
+    djiStat = s_dynamicsModel.Command(s_dynamicsModel.context, &command);
+    if (djiStat != DJI_ERROR_SYSTEM_MODULE_CODE_SUCCESS) {
+        USER_LOG_ERROR("command gimbal dynamics model error: 0x%08llX.", djiStat);
+        return;
+    }
+
+    djiStat = s_dynamicsModel.Step(s_dynamicsModel.context, stepTime);
+    if (djiStat != DJI_ERROR_SYSTEM_MODULE_CODE_SUCCESS) {
+        USER_LOG_ERROR("step gimbal dynamics model error: 0x%08llX.", djiStat);
+        return;
+    }
+
+    djiStat = s_dynamicsModel.GetAttitude(s_dynamicsModel.context, &attitude, NULL);
+    if (djiStat != DJI_ERROR_SYSTEM_MODULE_CODE_SUCCESS) {
+        USER_LOG_ERROR("get gimbal dynamics model attitude error: 0x%08llX.", djiStat);
+        return;
+    }
+
+    attitude.pitch *= 10.0f;
+    attitude.roll *= 10.0f;
+    attitude.yaw *= 10.0f;
+    nextAttitude = attitude;
+    DjiTest_GimbalAngleLegalization(&nextAttitude, s_aircraftAttitude, &s_attitudeInformation.reachLimitFlag);
+
+    /* Mechanical stop, the gimbal can not move past the limit whatever the motor does */
+    if (DjiTest_GimbalAttitudeDiffer(&nextAttitude, &attitude, PAYLOAD_GIMBAL_DYNAMICS_RESYNC_THRESHOLD)) {
+        attitude.pitch = nextAttitude.pitch / 10.0f;
+        attitude.roll = nextAttitude.roll / 10.0f;
+        attitude.yaw = nextAttitude.yaw / 10.0f;
+        s_dynamicsModel.Reset(s_dynamicsModel.context, &attitude);
+    }
+
+    s_attitudeInformation.attitude.pitch = nextAttitude.pitch;
+    s_attitudeInformation.attitude.roll = nextAttitude.roll;
+    s_attitudeInformation.attitude.yaw = nextAttitude.yaw;
+    s_attitudeHighPrecision = nextAttitude;
+    s_dynamicsLastAttitude = nextAttitude;
+
+    if (s_rotatingFlag != true) {
+        return;
+    }
+
+    s_dynamicsHoldAttitude = nextAttitude;
+    if (s_controlType == TEST_GIMBAL_CONTROL_TYPE_ANGLE) {
+        /* Sensor noise never lets the attitude hit the target exactly, finish inside the tolerance */
+        if (!DjiTest_GimbalAttitudeDiffer(&nextAttitude, &targetAttitude, PAYLOAD_GIMBAL_DYNAMICS_ANGLE_TOLERANCE)) {
+            s_rotatingFlag = false;
+            s_dynamicsHoldAttitude = targetAttitude;
+        }
+    } else if (s_controlType == TEST_GIMBAL_CONTROL_TYPE_SPEED) {
+        if ((s_attitudeInformation.reachLimitFlag.pitch == true || s_speed.pitch == 0) &&
+            (s_attitudeInformation.reachLimitFlag.roll == true || s_speed.roll == 0) &&
+            (s_attitudeInformation.reachLimitFlag.yaw == true || s_speed.yaw == 0)) {
+            s_rotatingFlag = false;
+        }
+    }
+}
+
+static bool DjiTest_GimbalAttitudeDiffer(const T_DjiAttitude3f *attitude1, const T_DjiAttitude3f *attitude2,
+                                         float threshold)
+{
+    return fabsf(attitude1->pitch - attitude2->pitch) > threshold ||
+           fabsf(attitude1->roll - attitude2->roll) > threshold ||
+           fabsf(attitude1->yaw - attitude2->yaw) > threshold;
+}
+#endif
+
 /****************** (C) COPYRIGHT DJI Innovations *****END OF FILE****/
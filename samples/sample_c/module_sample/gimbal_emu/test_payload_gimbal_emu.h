@@ -30,16 +30,28 @@
 /* Includes ------------------------------------------------------------------*/
 #include "dji_typedef.h"
 #include "dji_gimbal.h"
+#include "test_payload_gimbal_dynamics.h"
 
 #ifdef __cplusplus
 extern "C" {
 #endif
 
 /* Exported constants --------------------------------------------------------*/
-
+#define DJI_TEST_GIMBAL_LOOP_JITTER_BUCKET_NUM      (8)
 
 /* Exported types ------------------------------------------------------------*/
-
+/**
+ * @brief Timing statistics of the gimbal emulator control loop. Lateness is the wake up time after the loop
+ * deadline, histogram buckets are bounded by 50, 100, 200, 500, 1000, 2000, 5000 us.
+ */
+typedef struct {
+    uint32_t loopCount;
+    uint32_t runTimeMs;
+    uint32_t overrunCount;
+    uint32_t missedPeriodCount;
+    uint32_t maxLatenessUs;
+    uint32_t jitterHistogram[DJI_TEST_GIMBAL_LOOP_JITTER_BUCKET_NUM];
+} T_DjiTestGimbalLoopStatistics;
 
 /* Exported functions --------------------------------------------------------*/
 T_DjiReturnCode DjiTest_GimbalStartService(void);
@@ -48,6 +60,10 @@ T_DjiReturnCode DjiTest_GimbalDeInit(void);
 T_DjiReturnCode DjiTest_GimbalRotate(E_DjiGimbalRotationMode rotationMode,
                                      T_DjiGimbalRotationProperty rotationProperty,
                                      T_DjiAttitude3d rotationValue); // unit if angle control: 0.1 degree, unit if speed control: 0.1 degree/s
+#ifdef SYSTEM_ARCH_LINUX
+T_DjiReturnCode DjiTest_GimbalGetLoopStatistics(T_DjiTestGimbalLoopStatistics *statistics);
+T_DjiReturnCode DjiTest_GimbalSetDynamicsModel(const T_DjiTestGimbalDynamicsModel *model);
+#endif
 
 #ifdef __cplusplus
 }
@@ -30,6 +30,8 @@
 #include "dji_logger.h"
 #include "dji_platform.h"
 #include "dji_aircraft_info.h"
+#include "telemetry_bus/test_telemetry_bus.h"
+#include "flight_recorder/test_flight_recorder.h"
 #include "time.h"
 
 /* Private constants ---------------------------------------------------------*/
@@ -39,17 +41,38 @@
 #define TEST_LIVEVIEW_STREAM_REQUEST_I_FRAME_ON                 1
 #define TEST_LIVEVIEW_STREAM_REQUEST_I_FRAME_TICK_IN_SECONDS    5
 
+/* One access unit of the stream per sample, an I frame of 4K fits. */
+#define TEST_LIVEVIEW_STREAM_BUS_SLOT_SIZE                      (1024 * 1024)
+#define TEST_LIVEVIEW_STREAM_BUS_SLOT_COUNT                     (8)
+
 /* Private types -------------------------------------------------------------*/
 
 /* Private values -------------------------------------------------------------*/
 static char s_fpvCameraStreamFilePath[TEST_LIVEVIEW_STREAM_FILE_PATH_STR_MAX_SIZE];
 static char s_payloadCameraStreamFilePath[TEST_LIVEVIEW_STREAM_FILE_PATH_STR_MAX_SIZE];
+#ifdef SYSTEM_ARCH_LINUX
+static uint16_t s_fpvCameraStreamBusTopicId;
+static bool s_isFpvCameraStreamBusTopicAdded = false;
+static uint16_t s_payloadCameraStreamBusTopicId;
+static bool s_isPayloadCameraStreamBusTopicAdded = false;
+static uint16_t s_fpvCameraStreamRecordChannelId;
+static bool s_isFpvCameraStreamRecordChannelAdded = false;
+static uint16_t s_payloadCameraStreamRecordChannelId;
+static bool s_isPayloadCameraStreamRecordChannelAdded = false;
+#endif
 
 /* Private functions declaration ---------------------------------------------*/
 static void DjiTest_FpvCameraStreamCallback(E_DjiLiveViewCameraPosition position, const uint8_t *buf,
                                             uint32_t bufLen);
 static void DjiTest_PayloadCameraStreamCallback(E_DjiLiveViewCameraPosition position, const uint8_t *buf,
                                                 uint32_t bufLen);
+#ifdef SYSTEM_ARCH_LINUX
+static bool DjiTest_LiveviewAddBusTopic(const char *topicName, uint16_t *topicId);
+static bool DjiTest_LiveviewAddRecordChannel(const char *channelName, uint16_t *channelId);
+static void DjiTest_LiveviewRecordStream(uint16_t channelId, E_DjiLiveViewCameraPosition position,
+                                         const uint8_t *buf, uint32_t bufLen);
+static void DjiTest_LiveviewReplayStream(const T_DjiTestFlightRecordSample *sample, void *userData);
+#endif
 
 /* Exported functions definition ---------------------------------------------*/
 
@@ -94,6 +117,16 @@ T_DjiReturnCode DjiTest_LiveviewRunSample(E_DjiMountPosition mountPosition)
         goto out;
     }
 
+#ifdef SYSTEM_ARCH_LINUX
+    s_isFpvCameraStreamBusTopicAdded = DjiTest_LiveviewAddBusTopic("liveview/fpv", &s_fpvCameraStreamBusTopicId);
+    s_isPayloadCameraStreamBusTopicAdded = DjiTest_LiveviewAddBusTopic("liveview/payload",
+                                                                       &s_payloadCameraStreamBusTopicId);
+    s_isFpvCameraStreamRecordChannelAdded = DjiTest_LiveviewAddRecordChannel("liveview/fpv",
+                                                                             &s_fpvCameraStreamRecordChannelId);
+    s_isPayloadCameraStreamRecordChannelAdded = DjiTest_LiveviewAddRecordChannel("liveview/payload",
+                                                                                 &s_payloadCameraStreamRecordChannelId);
+#endif
+
     USER_LOG_INFO("--> Step 2: Start h264 stream of the fpv and default of selected payload\r\n");
     DjiTest_WidgetLogAppend("--> Step 2: Start h264 stream of the fpv and selected payload\r\n");
 
@@ -240,6 +273,15 @@ static void DjiTest_FpvCameraStreamCallback(E_DjiLiveViewCameraPosition position
     FILE *fp = NULL;
     size_t size;
 
+#ifdef SYSTEM_ARCH_LINUX
+    if (s_isFpvCameraStreamBusTopicAdded) {
+        DjiTest_TelemetryBusPublish(DjiTest_TelemetryBusGetDefault(), s_fpvCameraStreamBusTopicId, buf, bufLen);
+    }
+    if (s_isFpvCameraStreamRecordChannelAdded) {
+        DjiTest_LiveviewRecordStream(s_fpvCameraStreamRecordChannelId, position, buf, bufLen);
+    }
+#endif
+
     fp = fopen(s_fpvCameraStreamFilePath, "ab+");
     if (fp == NULL) {
         printf("fopen failed!\n");
@@ -262,6 +304,15 @@ static void DjiTest_PayloadCameraStreamCallback(E_DjiLiveViewCameraPosition posi
     FILE *fp = NULL;
     size_t size;
 
+#ifdef SYSTEM_ARCH_LINUX
+    if (s_isPayloadCameraStreamBusTopicAdded) {
+        DjiTest_TelemetryBusPublish(DjiTest_TelemetryBusGetDefault(), s_payloadCameraStreamBusTopicId, buf, bufLen);
+    }
+    if (s_isPayloadCameraStreamRecordChannelAdded) {
+        DjiTest_LiveviewRecordStream(s_payloadCameraStreamRecordChannelId, position, buf, bufLen);
+    }
+#endif
+
     fp = fopen(s_payloadCameraStreamFilePath, "ab+");
     if (fp == NULL) {
         printf("fopen failed!\n");
@@ -278,4 +329,70 @@ static void DjiTest_PayloadCameraStreamCallback(E_DjiLiveViewCameraPosition posi
     fclose(fp);
 }
 
+#ifdef SYSTEM_ARCH_LINUX
+static bool DjiTest_LiveviewAddBusTopic(const char *topicName, uint16_t *topicId)
+{
+    T_DjiReturnCode returnCode;
+
+    returnCode = DjiTest_TelemetryBusAddDefaultTopic(topicName, "dji.liveview.h264", 1, "stream:bytes",
+                                                     TEST_LIVEVIEW_STREAM_BUS_SLOT_SIZE,
+                                                     TEST_LIVEVIEW_STREAM_BUS_SLOT_COUNT, topicId);
+    if (returnCode != DJI_ERROR_SYSTEM_MODULE_CODE_SUCCESS) {
+        USER_LOG_WARN("Add telemetry bus topic %s error, stat = 0x%08llX", topicName, returnCode);
+        return false;
+    }
+
+    return true;
+}
+
+static bool DjiTest_LiveviewAddRecordChannel(const char *channelName, uint16_t *channelId)
+{
+    T_DjiTestFlightRecorderChannelInfo channelInfo = {
+        .name = channelName,
+        .schemaName = "dji.liveview.h264",
+        .layout = "position:u8 stream:bytes",
+    };
+    T_DjiReturnCode returnCode;
+
+    returnCode = DjiTest_FlightRecorderAddChannel(&channelInfo, DjiTest_LiveviewReplayStream, NULL, channelId);
+    if (returnCode != DJI_ERROR_SYSTEM_MODULE_CODE_SUCCESS) {
+        USER_LOG_WARN("Add flight record channel %s error, stat = 0x%08llX", channelName, returnCode);
+        return false;
+    }
+
+    return true;
+}
+
+static void DjiTest_LiveviewRecordStream(uint16_t channelId, E_DjiLiveViewCameraPosition position,
+                                         const uint8_t *buf, uint32_t bufLen)
+{
+    uint8_t cameraPosition = (uint8_t) position;
+
+    if (!DjiTest_FlightRecorderIsRecording()) {
+        return;
+    }
+
+    /* The stream carries no time of the aircraft, the recorder orders it by arrival. */
+    DjiTest_FlightRecorderWrite(channelId, 0, &cameraPosition, sizeof(cameraPosition), buf, bufLen);
+}
+
+static void DjiTest_LiveviewReplayStream(const T_DjiTestFlightRecordSample *sample, void *userData)
+{
+    E_DjiLiveViewCameraPosition position;
+
+    USER_UTIL_UNUSED(userData);
+
+    if (sample->headerLen != sizeof(uint8_t)) {
+        return;
+    }
+
+    position = (E_DjiLiveViewCameraPosition) sample->header[0];
+    if (position == DJI_LIVEVIEW_CAMERA_POSITION_FPV) {
+        DjiTest_FpvCameraStreamCallback(position, sample->data, sample->dataLen);
+    } else {
+        DjiTest_PayloadCameraStreamCallback(position, sample->data, sample->dataLen);
+    }
+}
+#endif
+
 /****************** (C) COPYRIGHT DJI Innovations *****END OF FILE****/
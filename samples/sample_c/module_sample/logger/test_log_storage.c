@@ -0,0 +1,1184 @@
+/**
+ ********************************************************************
+ * @file    test_log_storage.c
+ * @brief   Compressed log storage with rotating segments, a time and level index and queries.
+ *
+ * @copyright (c) 2021 DJI. All rights reserved.
+ *
+ * All information contained herein is, and remains, the property of DJI.
+ * The intellectual and technical concepts contained herein are proprietary
+ * to DJI and may be covered by U.S. and foreign patents, patents in process,
+ * and protected by trade secret or copyright law.  Dissemination of this
+ * information, including but not limited to data and other proprietary
+ * material(s) incorporated within the information, in any form, is strictly
+ * prohibited without the express written consent of DJI.
+ *
+ * If you receive this source code without DJI’s authorization, you may not
+ * further disseminate the information, and you must immediately remove the
+ * source code and notify DJI of its removal. DJI reserves the right to pursue
+ * legal actions against you for any loss(es) or damage(s) caused by your
+ * failure to do so.
+ *
+ *********************************************************************
+ */
+
+/* Includes ------------------------------------------------------------------*/
+#include "test_log_storage.h"
+
+#ifdef SYSTEM_ARCH_LINUX
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <signal.h>
+#include <pthread.h>
+#include <time.h>
+#include <unistd.h>
+#include <dirent.h>
+#include <sys/stat.h>
+#include "utils/util_misc.h"
+
+/* Private constants ---------------------------------------------------------*/
+#define DJI_TEST_LOG_SEGMENT_MAGIC                  0x534C4A44      /* "DJLS" */
+#define DJI_TEST_LOG_INDEX_MAGIC                    0x494C4A44      /* "DJLI" */
+#define DJI_TEST_LOG_BLOCK_MAGIC                    0x424C4A44      /* "DJLB" */
+#define DJI_TEST_LOG_FORMAT_VERSION                 1
+#define DJI_TEST_LOG_DEFAULT_BLOCK_SIZE             (64 * 1024)
+#define DJI_TEST_LOG_DEFAULT_BLOCK_INTERVAL_MS      (2000)
+#define DJI_TEST_LOG_DEFAULT_SEGMENT_MAX_SIZE       (16 * 1024 * 1024)
+#define DJI_TEST_LOG_DEFAULT_SEGMENT_DURATION_S     (3600)
+#define DJI_TEST_LOG_DEFAULT_MAX_TOTAL_SIZE         (512ULL * 1024 * 1024)
+#define DJI_TEST_LOG_DEFAULT_MAX_AGE_S              (30 * 24 * 3600)
+/* Block offsets in the index are 32 bit, a segment is rotated before this size whatever the configuration. */
+#define DJI_TEST_LOG_SEGMENT_SIZE_LIMIT             (0xF0000000U)
+#define DJI_TEST_LOG_VARINT_MAX_SIZE                (10)
+/* Level, time difference and text length of a record. */
+#define DJI_TEST_LOG_RECORD_HEADER_MAX_SIZE         (1 + 2 * DJI_TEST_LOG_VARINT_MAX_SIZE)
+/* The level tag follows the time and module tags near the start of the line. */
+#define DJI_TEST_LOG_LEVEL_SEARCH_SIZE              (96)
+#define DJI_TEST_LOG_SEAL_TASK_STACK_SIZE           (2048)
+
+/* Private types -------------------------------------------------------------*/
+#pragma pack(1)
+/**
+ * @brief Start of the segment and index file. The segment continues with blocks of {T_DjiTestLogBlockHeader, data},
+ * the index with one T_DjiTestLogIndexEntry per block. The data is LZ4 or raw when dataLen equals rawLen and holds
+ * records of {level u8, time varint, len varint, text[len]}. The time of a record is the zigzag difference to the
+ * previous record of the block, or to 0 for the first one.
+ */
+typedef struct {
+    uint32_t magic;
+    uint16_t version;
+    uint16_t headerSize;
+    uint64_t openTimeMs;
+} T_DjiTestLogFileHeader;
+
+typedef struct {
+    uint32_t magic;
+    T_DjiTestLogBlockInfo info;
+} T_DjiTestLogBlockHeader;
+#pragma pack()
+
+typedef struct {
+    const T_DjiTestLogQuery *query;
+    DjiTestLogQueryCallback callback;
+    void *userData;
+    uint8_t levelMask;
+    uint8_t *rawBuffer;
+    uint8_t *dataBuffer;
+    uint32_t dataCapacity;
+    T_DjiTestLogQueryStatistics *statistics;
+} T_DjiTestLogQueryContext;
+
+/* Private functions declaration ---------------------------------------------*/
+static T_DjiReturnCode DjiTest_LogStorageAppend(T_DjiTestLogStorage *storage, uint64_t timeMs, uint8_t level,
+                                                const uint8_t *text, uint32_t len, bool isStripColor);
+static T_DjiReturnCode DjiTest_LogStorageSealBlock(T_DjiTestLogStorage *storage, bool isSegmentFixed);
+static void *DjiTest_LogStorageSealTask(void *arg);
+static void DjiTest_LogStorageStopSealTask(T_DjiTestLogStorage *storage);
+static void DjiTest_LogStorageExitHandler(void);
+static void DjiTest_LogStorageFatalSignalHandler(int signalNum);
+static T_DjiReturnCode DjiTest_LogStorageOpenSegment(T_DjiTestLogStorage *storage);
+static void DjiTest_LogStorageCloseSegment(T_DjiTestLogStorage *storage);
+static void DjiTest_LogStorageRetain(T_DjiTestLogStorage *storage);
+static T_DjiReturnCode DjiTest_LogStorageQuerySegment(T_DjiTestLogQueryContext *context, const char *directory,
+                                                      const char *name);
+static T_DjiReturnCode DjiTest_LogStorageQueryBlock(T_DjiTestLogQueryContext *context, int fd, uint32_t offset,
+                                                    const T_DjiTestLogBlockInfo *info);
+static bool DjiTest_LogStorageIsBlockMatched(const T_DjiTestLogQueryContext *context,
+                                             const T_DjiTestLogBlockInfo *info);
+static uint8_t DjiTest_LogStorageParseLevel(const uint8_t *data, uint32_t len);
+static uint32_t DjiTest_LogStorageStripColor(const uint8_t *src, uint32_t len, uint8_t *dst, uint32_t dstCapacity);
+static bool DjiTest_LogStorageContains(const char *text, uint32_t len, const char *keyword, uint32_t keywordLen);
+static int DjiTest_LogStorageCompareSegment(const void *a, const void *b);
+static bool DjiTest_LogStorageMakeDirectory(const char *directory);
+static bool DjiTest_LogStorageWriteAll(int fd, const void *data, uint32_t len);
+static bool DjiTest_LogStorageReadAll(int fd, uint64_t offset, void *data, uint32_t len);
+static uint64_t DjiTest_LogStorageGetWallTimeMs(void);
+static uint8_t *DjiTest_LogStoragePutVarint(uint8_t *out, uint64_t value);
+static bool DjiTest_LogStorageGetVarint(const uint8_t **in, const uint8_t *end, uint64_t *value);
+
+/* Private values ------------------------------------------------------------*/
+static const char *s_logLevelTags[DJI_TEST_LOG_STORAGE_LEVEL_NUM] = {"[Error]", "[Warn]", "[Info]", "[Debug]"};
+static const int s_logFatalSignals[] = {SIGSEGV, SIGBUS, SIGFPE, SIGILL, SIGABRT};
+static T_DjiTestLogStorage *volatile s_exitFlushStorage = NULL;
+static bool s_isExitHandlerRegistered = false;
+
+/* Exported functions definition ---------------------------------------------*/
+void DjiTest_LogStorageGetDefaultConfig(T_DjiTestLogStorageConfig *config)
+{
+    config->directory = NULL;
+    config->prefix = "DJI";
+    config->blockSize = DJI_TEST_LOG_DEFAULT_BLOCK_SIZE;
+    config->blockIntervalMs = DJI_TEST_LOG_DEFAULT_BLOCK_INTERVAL_MS;
+    config->isSealOnError = true;
+    config->segmentMaxSize = DJI_TEST_LOG_DEFAULT_SEGMENT_MAX_SIZE;
+    config->segmentMaxDurationS = DJI_TEST_LOG_DEFAULT_SEGMENT_DURATION_S;
+    config->maxTotalSize = DJI_TEST_LOG_DEFAULT_MAX_TOTAL_SIZE;
+    config->maxAgeS = DJI_TEST_LOG_DEFAULT_MAX_AGE_S;
+}
+
+T_DjiReturnCode DjiTest_LogStorageOpen(T_DjiTestLogStorage *storage, const T_DjiTestLogStorageConfig *config)
+{
+    T_DjiOsalHandler *osalHandler = DjiPlatform_GetOsalHandler();
+    T_DjiTestLogSegment *segments;
+    T_DjiReturnCode returnCode;
+    uint32_t count = 0;
+
+    if (storage == NULL || config == NULL || config->prefix == NULL || config->prefix[0] == '\0' ||
+        strlen(config->prefix) >= DJI_TEST_LOG_STORAGE_PREFIX_MAX_SIZE ||
+        (config->directory != NULL && strlen(config->directory) >= DJI_TEST_LOG_STORAGE_PATH_MAX_SIZE) ||
+        config->blockSize < 1024 || config->blockSize > DJI_TEST_LOG_STORAGE_BLOCK_MAX_SIZE) {
+        return DJI_ERROR_SYSTEM_MODULE_CODE_INVALID_PARAMETER;
+    }
+
+    memset(storage, 0, sizeof(T_DjiTestLogStorage));
+    storage->config = *config;
+    strcpy(storage->prefix, config->prefix);
+    strcpy(storage->directory, config->directory != NULL ? config->directory : ".");
+    storage->segmentFd = -1;
+    storage->indexFd = -1;
+
+    if (!DjiTest_LogStorageMakeDirectory(storage->directory)) {
+        return DJI_ERROR_SYSTEM_MODULE_CODE_SYSTEM_ERROR;
+    }
+
+    /* Numbers continue after the newest segment, so names sort in write order even when the clock is not set. */
+    segments = osalHandler->Malloc(DJI_TEST_LOG_STORAGE_SEGMENT_MAX_NUM * sizeof(T_DjiTestLogSegment));
+    if (segments == NULL) {
+        return DJI_ERROR_SYSTEM_MODULE_CODE_MEMORY_ALLOC_FAILED;
+    }
+    returnCode = DjiTest_LogStorageListSegments(storage->directory, storage->prefix, segments,
+                                                DJI_TEST_LOG_STORAGE_SEGMENT_MAX_NUM, &count);
+    storage->segmentNumber = count > 0 ? segments[count - 1].number + 1 : 0;
+    osalHandler->Free(segments);
+    if (returnCode != DJI_ERROR_SYSTEM_MODULE_CODE_SUCCESS) {
+        return returnCode;
+    }
+
+    storage->rawBuffer = osalHandler->Malloc(config->blockSize);
+    storage->dataBuffer = osalHandler->Malloc(sizeof(T_DjiTestLogBlockHeader) +
+                                              UtilLz4_CompressBound(config->blockSize));
+    if (storage->rawBuffer == NULL || storage->dataBuffer == NULL) {
+        returnCode = DJI_ERROR_SYSTEM_MODULE_CODE_MEMORY_ALLOC_FAILED;
+        goto FreeBuffer;
+    }
+
+    returnCode = osalHandler->MutexCreate(&storage->mutex);
+    if (returnCode != DJI_ERROR_SYSTEM_MODULE_CODE_SUCCESS) {
+        goto FreeBuffer;
+    }
+
+    returnCode = DjiTest_LogStorageOpenSegment(storage);
+    if (returnCode != DJI_ERROR_SYSTEM_MODULE_CODE_SUCCESS) {
+        goto DestroyMutex;
+    }
+
+    if (config->blockIntervalMs == 0) {
+        return DJI_ERROR_SYSTEM_MODULE_CODE_SUCCESS;
+    }
+
+    /* Blocks are sealed on time even when no further line arrives. */
+    returnCode = osalHandler->SemaphoreCreate(0, &storage->sealSema);
+    if (returnCode != DJI_ERROR_SYSTEM_MODULE_CODE_SUCCESS) {
+        goto CloseSegment;
+    }
+    returnCode = osalHandler->SemaphoreCreate(0, &storage->sealExitSema);
+    if (returnCode != DJI_ERROR_SYSTEM_MODULE_CODE_SUCCESS) {
+        goto DestroySealSema;
+    }
+    returnCode = osalHandler->TaskCreate("log_storage", DjiTest_LogStorageSealTask, DJI_TEST_LOG_SEAL_TASK_STACK_SIZE,
+                                         storage, &storage->sealTask);
+    if (returnCode != DJI_ERROR_SYSTEM_MODULE_CODE_SUCCESS) {
+        goto DestroySealExitSema;
+    }
+
+    return DJI_ERROR_SYSTEM_MODULE_CODE_SUCCESS;
+
+DestroySealExitSema:
+    osalHandler->SemaphoreDestroy(storage->sealExitSema);
+    storage->sealExitSema = NULL;
+DestroySealSema:
+    osalHandler->SemaphoreDestroy(storage->sealSema);
+    storage->sealSema = NULL;
+CloseSegment:
+    DjiTest_LogStorageCloseSegment(storage);
+DestroyMutex:
+    osalHandler->MutexDestroy(storage->mutex);
+    storage->mutex = NULL;
+FreeBuffer:
+    osalHandler->Free(storage->rawBuffer);
+    osalHandler->Free(storage->dataBuffer);
+    storage->rawBuffer = NULL;
+    storage->dataBuffer = NULL;
+
+    return returnCode;
+}
+
+T_DjiReturnCode DjiTest_LogStorageWrite(T_DjiTestLogStorage *storage, const uint8_t *data, uint32_t len)
+{
+    T_DjiOsalHandler *osalHandler = DjiPlatform_GetOsalHandler();
+    T_DjiReturnCode returnCode;
+
+    if (storage == NULL || storage->mutex == NULL || (data == NULL && len > 0)) {
+        return DJI_ERROR_SYSTEM_MODULE_CODE_INVALID_PARAMETER;
+    }
+
+    osalHandler->MutexLock(storage->mutex);
+    returnCode = DjiTest_LogStorageAppend(storage, DjiTest_LogStorageGetWallTimeMs(),
+                                          DjiTest_LogStorageParseLevel(data, len), data, len, true);
+    osalHandler->MutexUnlock(storage->mutex);
+
+    return returnCode;
+}
+
+T_DjiReturnCode DjiTest_LogStorageWriteLine(T_DjiTestLogStorage *storage, uint64_t timeMs, uint8_t level,
+                                            const char *line, uint32_t len)
+{
+    T_DjiOsalHandler *osalHandler = DjiPlatform_GetOsalHandler();
+    T_DjiReturnCode returnCode;
+
+    if (storage == NULL || storage->mutex == NULL || (line == NULL && len > 0) ||
+        level >= DJI_TEST_LOG_STORAGE_LEVEL_NUM) {
+        return DJI_ERROR_SYSTEM_MODULE_CODE_INVALID_PARAMETER;
+    }
+
+    osalHandler->MutexLock(storage->mutex);
+    returnCode = DjiTest_LogStorageAppend(storage, timeMs, level, (const uint8_t *) line, len, false);
+    osalHandler->MutexUnlock(storage->mutex);
+
+    return returnCode;
+}
+
+T_DjiReturnCode DjiTest_LogStorageFlush(T_DjiTestLogStorage *storage)
+{
+    T_DjiOsalHandler *osalHandler = DjiPlatform_GetOsalHandler();
+    T_DjiReturnCode returnCode;
+
+    if (storage == NULL || storage->mutex == NULL) {
+        return DJI_ERROR_SYSTEM_MODULE_CODE_INVALID_PARAMETER;
+    }
+
+    osalHandler->MutexLock(storage->mutex);
+    returnCode = DjiTest_LogStorageSealBlock(storage, false);
+    if (storage->segmentFd >= 0 && (fdatasync(storage->segmentFd) != 0 || fdatasync(storage->indexFd) != 0)) {
+        returnCode = DJI_ERROR_SYSTEM_MODULE_CODE_SYSTEM_ERROR;
+    }
+    osalHandler->MutexUnlock(storage->mutex);
+
+    return returnCode;
+}
+
+T_DjiReturnCode DjiTest_LogStorageClose(T_DjiTestLogStorage *storage)
+{
+    T_DjiOsalHandler *osalHandler = DjiPlatform_GetOsalHandler();
+    T_DjiReturnCode returnCode;
+
+    if (storage == NULL || storage->mutex == NULL) {
+        return DJI_ERROR_SYSTEM_MODULE_CODE_INVALID_PARAMETER;
+    }
+
+    if (s_exitFlushStorage == storage) {
+        s_exitFlushStorage = NULL;
+    }
+    DjiTest_LogStorageStopSealTask(storage);
+
+    osalHandler->MutexLock(storage->mutex);
+    returnCode = DjiTest_LogStorageSealBlock(storage, false);
+    DjiTest_LogStorageCloseSegment(storage);
+    osalHandler->MutexUnlock(storage->mutex);
+
+    osalHandler->MutexDestroy(storage->mutex);
+    storage->mutex = NULL;
+    osalHandler->Free(storage->rawBuffer);
+    osalHandler->Free(storage->dataBuffer);
+    storage->rawBuffer = NULL;
+    storage->dataBuffer = NULL;
+
+    return returnCode;
+}
+
+T_DjiReturnCode DjiTest_LogStorageFlushOnExit(T_DjiTestLogStorage *storage)
+{
+    struct sigaction action;
+    uint32_t i;
+
+    if (storage == NULL || storage->mutex == NULL) {
+        return DJI_ERROR_SYSTEM_MODULE_CODE_INVALID_PARAMETER;
+    }
+
+    if (!s_isExitHandlerRegistered) {
+        if (atexit(DjiTest_LogStorageExitHandler) != 0) {
+            return DJI_ERROR_SYSTEM_MODULE_CODE_SYSTEM_ERROR;
+        }
+        s_isExitHandlerRegistered = true;
+    }
+    s_exitFlushStorage = storage;
+
+    /* The handler runs once, the signal raised again at its end takes the default action and dumps the core. */
+    memset(&action, 0, sizeof(action));
+    action.sa_handler = DjiTest_LogStorageFatalSignalHandler;
+    action.sa_flags = SA_RESETHAND;
+    sigemptyset(&action.sa_mask);
+    for (i = 0; i < sizeof(s_logFatalSignals) / sizeof(s_logFatalSignals[0]); i++) {
+        if (sigaction(s_logFatalSignals[i], &action, NULL) != 0) {
+            return DJI_ERROR_SYSTEM_MODULE_CODE_SYSTEM_ERROR;
+        }
+    }
+
+    return DJI_ERROR_SYSTEM_MODULE_CODE_SUCCESS;
+}
+
+void DjiTest_LogStorageGetStatistics(T_DjiTestLogStorage *storage, T_DjiTestLogStorageStatistics *statistics)
+{
+    T_DjiOsalHandler *osalHandler = DjiPlatform_GetOsalHandler();
+
+    if (storage->mutex == NULL) {
+        *statistics = storage->statistics;
+        return;
+    }
+
+    osalHandler->MutexLock(storage->mutex);
+    *statistics = storage->statistics;
+    osalHandler->MutexUnlock(storage->mutex);
+}
+
+T_DjiReturnCode DjiTest_LogStorageListSegments(const char *directory, const char *prefix,
+                                               T_DjiTestLogSegment *segments, uint32_t maxCount, uint32_t *count)
+{
+    char path[DJI_TEST_LOG_STORAGE_PATH_MAX_SIZE + DJI_TEST_LOG_STORAGE_NAME_MAX_SIZE + 8];
+    T_DjiTestLogSegment segment;
+    struct dirent *entry;
+    struct stat fileStat;
+    size_t prefixLen = strlen(prefix);
+    size_t suffixLen = strlen(DJI_TEST_LOG_STORAGE_SEGMENT_SUFFIX);
+    size_t nameLen;
+    uint32_t newest;
+    uint32_t i;
+    char *end;
+    DIR *dir;
+
+    *count = 0;
+    if (maxCount == 0) {
+        return DJI_ERROR_SYSTEM_MODULE_CODE_INVALID_PARAMETER;
+    }
+
+    dir = opendir(directory);
+    if (dir == NULL) {
+        return errno == ENOENT ? DJI_ERROR_SYSTEM_MODULE_CODE_SUCCESS : DJI_ERROR_SYSTEM_MODULE_CODE_SYSTEM_ERROR;
+    }
+
+    while ((entry = readdir(dir)) != NULL) {
+        nameLen = strlen(entry->d_name);
+        if (nameLen <= prefixLen + 1 + suffixLen || nameLen - suffixLen >= DJI_TEST_LOG_STORAGE_NAME_MAX_SIZE ||
+            strncmp(entry->d_name, prefix, prefixLen) != 0 || entry->d_name[prefixLen] != '_' ||
+            strcmp(entry->d_name + nameLen - suffixLen, DJI_TEST_LOG_STORAGE_SEGMENT_SUFFIX) != 0) {
+            continue;
+        }
+
+        memset(&segment, 0, sizeof(segment));
+        segment.number = (uint32_t) strtoul(entry->d_name + prefixLen + 1, &end, 10);
+        if (end == entry->d_name + prefixLen + 1 || *end != '_') {
+            continue;
+        }
+        memcpy(segment.name, entry->d_name, nameLen - suffixLen);
+
+        snprintf(path, sizeof(path), "%s/%s", directory, entry->d_name);
+        if (stat(path, &fileStat) != 0 || !S_ISREG(fileStat.st_mode)) {
+            continue;
+        }
+        segment.size = (uint64_t) fileStat.st_size;
+        segment.modifyTime = (uint64_t) fileStat.st_mtime;
+        snprintf(path, sizeof(path), "%s/%s" DJI_TEST_LOG_STORAGE_INDEX_SUFFIX, directory, segment.name);
+        if (stat(path, &fileStat) == 0) {
+            segment.size += (uint64_t) fileStat.st_size;
+        }
+
+        if (*count < maxCount) {
+            segments[(*count)++] = segment;
+            continue;
+        }
+        /* Full, keep the oldest ones since they are the next to be deleted. */
+        newest = 0;
+        for (i = 1; i < maxCount; i++) {
+            if (segments[i].number > segments[newest].number) {
+                newest = i;
+            }
+        }
+        if (segment.number < segments[newest].number) {
+            segments[newest] = segment;
+        }
+    }
+    closedir(dir);
+
+    qsort(segments, *count, sizeof(T_DjiTestLogSegment), DjiTest_LogStorageCompareSegment);
+
+    return DJI_ERROR_SYSTEM_MODULE_CODE_SUCCESS;
+}
+
+T_DjiReturnCode DjiTest_LogStorageQuery(const char *directory, const char *prefix, const T_DjiTestLogQuery *query,
+                                        DjiTestLogQueryCallback callback, void *userData,
+                                        T_DjiTestLogQueryStatistics *statistics)
+{
+    T_DjiOsalHandler *osalHandler = DjiPlatform_GetOsalHandler();
+    T_DjiTestLogQueryStatistics localStatistics;
+    T_DjiTestLogQueryContext context;
+    T_DjiTestLogSegment *segments;
+    T_DjiReturnCode returnCode;
+    uint32_t count = 0;
+    uint32_t i;
+
+    if (prefix == NULL || query == NULL || callback == NULL || query->maxLevel >= DJI_TEST_LOG_STORAGE_LEVEL_NUM) {
+        return DJI_ERROR_SYSTEM_MODULE_CODE_INVALID_PARAMETER;
+    }
+    if (directory == NULL) {
+        directory = ".";
+    }
+
+    memset(&context, 0, sizeof(context));
+    context.query = query;
+    context.callback = callback;
+    context.userData = userData;
+    context.levelMask = (uint8_t) ((1U << (query->maxLevel + 1)) - 1);
+    context.statistics = statistics != NULL ? statistics : &localStatistics;
+    memset(context.statistics, 0, sizeof(T_DjiTestLogQueryStatistics));
+    context.dataCapacity = sizeof(T_DjiTestLogBlockHeader) + UtilLz4_CompressBound(DJI_TEST_LOG_STORAGE_BLOCK_MAX_SIZE);
+
+    segments = osalHandler->Malloc(DJI_TEST_LOG_STORAGE_SEGMENT_MAX_NUM * sizeof(T_DjiTestLogSegment));
+    context.rawBuffer = osalHandler->Malloc(DJI_TEST_LOG_STORAGE_BLOCK_MAX_SIZE);
+    context.dataBuffer = osalHandler->Malloc(context.dataCapacity);
+    if (segments == NULL || context.rawBuffer == NULL || context.dataBuffer == NULL) {
+        returnCode = DJI_ERROR_SYSTEM_MODULE_CODE_MEMORY_ALLOC_FAILED;
+        goto FreeBuffer;
+    }
+
+    returnCode = DjiTest_LogStorageListSegments(directory, prefix, segments, DJI_TEST_LOG_STORAGE_SEGMENT_MAX_NUM,
+                                                &count);
+    for (i = 0; i < count && returnCode == DJI_ERROR_SYSTEM_MODULE_CODE_SUCCESS; i++) {
+        returnCode = DjiTest_LogStorageQuerySegment(&context, directory, segments[i].name);
+    }
+
+FreeBuffer:
+    if (segments != NULL) {
+        osalHandler->Free(segments);
+    }
+    if (context.rawBuffer != NULL) {
+        osalHandler->Free(context.rawBuffer);
+    }
+    if (context.dataBuffer != NULL) {
+        osalHandler->Free(context.dataBuffer);
+    }
+
+    return returnCode;
+}
+
+/* Private functions definition-----------------------------------------------*/
+static T_DjiReturnCode DjiTest_LogStorageAppend(T_DjiTestLogStorage *storage, uint64_t timeMs, uint8_t level,
+                                                const uint8_t *text, uint32_t len, bool isStripColor)
+{
+    T_DjiOsalHandler *osalHandler = DjiPlatform_GetOsalHandler();
+    T_DjiReturnCode returnCode;
+    uint32_t textLen;
+    uint32_t nowMs = 0;
+    uint8_t *out;
+    int64_t timeDiff;
+
+    storage->statistics.lineCount++;
+    storage->statistics.rawBytes += len;
+
+    while (len > 0 && (text[len - 1] == '\n' || text[len - 1] == '\r')) {
+        len--;
+    }
+    textLen = isStripColor ? DjiTest_LogStorageStripColor(text, len, NULL, UINT32_MAX) : len;
+    /* A line longer than a whole block is cut to fit. */
+    textLen = USER_UTIL_MIN(textLen, storage->config.blockSize - DJI_TEST_LOG_RECORD_HEADER_MAX_SIZE);
+
+    if (storage->rawLen + DJI_TEST_LOG_RECORD_HEADER_MAX_SIZE + textLen > storage->config.blockSize) {
+        returnCode = DjiTest_LogStorageSealBlock(storage, false);
+        if (returnCode != DJI_ERROR_SYSTEM_MODULE_CODE_SUCCESS) {
+            return returnCode;
+        }
+    }
+
+    osalHandler->GetTimeMs(&nowMs);
+    if (storage->rawLen == 0) {
+        storage->block.minTimeMs = timeMs;
+        storage->block.maxTimeMs = timeMs;
+        storage->blockOpenTimeMs = nowMs;
+        storage->lastTimeMs = 0;
+    }
+
+    timeDiff = (int64_t) (timeMs - storage->lastTimeMs);
+    out = &storage->rawBuffer[storage->rawLen];
+    *out++ = level;
+    out = DjiTest_LogStoragePutVarint(out, ((uint64_t) timeDiff << 1) ^ (uint64_t) (timeDiff >> 63));
+    out = DjiTest_LogStoragePutVarint(out, textLen);
+    if (isStripColor) {
+        DjiTest_LogStorageStripColor(text, len, out, textLen);
+    } else {
+        memcpy(out, text, textLen);
+    }
+    out += textLen;
+
+    storage->rawLen = (uint32_t) (out - storage->rawBuffer);
+    storage->lastTimeMs = timeMs;
+    storage->block.lineCount++;
+    storage->block.levelMask |= (uint8_t) (1U << level);
+    storage->block.minTimeMs = USER_UTIL_MIN(storage->block.minTimeMs, timeMs);
+    storage->block.maxTimeMs = USER_UTIL_MAX(storage->block.maxTimeMs, timeMs);
+
+    if ((storage->config.isSealOnError && level == DJI_LOGGER_CONSOLE_LOG_LEVEL_ERROR) ||
+        nowMs - storage->blockOpenTimeMs >= storage->config.blockIntervalMs) {
+        return DjiTest_LogStorageSealBlock(storage, false);
+    }
+
+    return DJI_ERROR_SYSTEM_MODULE_CODE_SUCCESS;
+}
+
+/**
+ * @brief Writes the open block to the segment, rotating it when full. With isSegmentFixed the block goes to the open
+ * segment or is dropped, nothing is allocated, closed or deleted, so it may run in a fatal signal handler.
+ */
+static T_DjiReturnCode DjiTest_LogStorageSealBlock(T_DjiTestLogStorage *storage, bool isSegmentFixed)
+{
+    T_DjiTestLogBlockHeader header;
+    T_DjiTestLogIndexEntry entry;
+    T_DjiReturnCode returnCode;
+    uint32_t dataLen = 0;
+    uint32_t blockLen;
+    uint32_t nowMs = 0;
+    off_t fileSize;
+
+    if (storage->rawLen == 0) {
+        return DJI_ERROR_SYSTEM_MODULE_CODE_SUCCESS;
+    }
+
+    returnCode = UtilLz4_Compress(&storage->encoder, storage->rawBuffer, storage->rawLen,
+                                  storage->dataBuffer + sizeof(header), UtilLz4_CompressBound(storage->rawLen),
+                                  &dataLen);
+    if (returnCode != DJI_ERROR_SYSTEM_MODULE_CODE_SUCCESS || dataLen >= storage->rawLen) {
+        memcpy(storage->dataBuffer + sizeof(header), storage->rawBuffer, storage->rawLen);
+        dataLen = storage->rawLen;
+    }
+    storage->block.rawLen = storage->rawLen;
+    storage->block.dataLen = dataLen;
+    blockLen = (uint32_t) sizeof(header) + dataLen;
+
+    DjiPlatform_GetOsalHandler()->GetTimeMs(&nowMs);
+    if (isSegmentFixed && storage->segmentFd < 0) {
+        returnCode = DJI_ERROR_SYSTEM_MODULE_CODE_NONSUPPORT_IN_CURRENT_STATE;
+        goto DropBlock;
+    }
+    if (!isSegmentFixed && storage->segmentFd >= 0 && storage->segmentSize > sizeof(T_DjiTestLogFileHeader) &&
+        ((storage->config.segmentMaxSize > 0 && storage->segmentSize + blockLen > storage->config.segmentMaxSize) ||
+         (storage->config.segmentMaxDurationS > 0 &&
+          nowMs - storage->segmentOpenTimeMs >= storage->config.segmentMaxDurationS * 1000) ||
+         storage->segmentSize + blockLen > DJI_TEST_LOG_SEGMENT_SIZE_LIMIT)) {
+        DjiTest_LogStorageCloseSegment(storage);
+    }
+    if (storage->segmentFd < 0) {
+        returnCode = DjiTest_LogStorageOpenSegment(storage);
+        if (returnCode != DJI_ERROR_SYSTEM_MODULE_CODE_SUCCESS) {
+            goto DropBlock;
+        }
+    }
+
+    header.magic = DJI_TEST_LOG_BLOCK_MAGIC;
+    header.info = storage->block;
+    memcpy(storage->dataBuffer, &header, sizeof(header));
+    entry.offset = storage->segmentSize;
+    entry.info = storage->block;
+    if (!DjiTest_LogStorageWriteAll(storage->segmentFd, storage->dataBuffer, blockLen)) {
+        /* The partial block is skipped by the offsets of the index, continue behind it. */
+        fileSize = lseek(storage->segmentFd, 0, SEEK_END);
+        storage->segmentSize = fileSize > 0 ? (uint32_t) fileSize : storage->segmentSize;
+        returnCode = DJI_ERROR_SYSTEM_MODULE_CODE_SYSTEM_ERROR;
+        goto DropBlock;
+    }
+    storage->segmentSize += blockLen;
+    if (!DjiTest_LogStorageWriteAll(storage->indexFd, &entry, sizeof(entry))) {
+        /* The block is still found by scanning the segment behind the last index entry. */
+        storage->statistics.writeErrorCount++;
+    }
+
+    storage->statistics.storedBytes += blockLen;
+    storage->statistics.blockCount++;
+    returnCode = DJI_ERROR_SYSTEM_MODULE_CODE_SUCCESS;
+    goto ResetBlock;
+
+DropBlock:
+    storage->statistics.writeErrorCount++;
+ResetBlock:
+    storage->rawLen = 0;
+    memset(&storage->block, 0, sizeof(storage->block));
+
+    return returnCode;
+}
+
+static void *DjiTest_LogStorageSealTask(void *arg)
+{
+    T_DjiOsalHandler *osalHandler = DjiPlatform_GetOsalHandler();
+    T_DjiTestLogStorage *storage = arg;
+    uint32_t waitMs = storage->config.blockIntervalMs / 4 + 1;
+    uint32_t nowMs = 0;
+    bool isExit = false;
+
+    while (!isExit) {
+        osalHandler->SemaphoreTimedWait(storage->sealSema, waitMs);
+
+        osalHandler->MutexLock(storage->mutex);
+        isExit = storage->isSealTaskStop;
+        osalHandler->GetTimeMs(&nowMs);
+        if (!isExit && storage->rawLen > 0 && nowMs - storage->blockOpenTimeMs >= storage->config.blockIntervalMs) {
+            /* A failed write is counted in the statistics, there is nobody to return it to. */
+            DjiTest_LogStorageSealBlock(storage, false);
+        }
+        osalHandler->MutexUnlock(storage->mutex);
+    }
+
+    osalHandler->SemaphorePost(storage->sealExitSema);
+
+    return NULL;
+}
+
+static void DjiTest_LogStorageStopSealTask(T_DjiTestLogStorage *storage)
+{
+    T_DjiOsalHandler *osalHandler = DjiPlatform_GetOsalHandler();
+
+    if (storage->sealTask == NULL) {
+        return;
+    }
+
+    osalHandler->MutexLock(storage->mutex);
+    storage->isSealTaskStop = true;
+    osalHandler->MutexUnlock(storage->mutex);
+
+    osalHandler->SemaphorePost(storage->sealSema);
+    osalHandler->SemaphoreWait(storage->sealExitSema);
+    osalHandler->TaskDestroy(storage->sealTask);
+    osalHandler->SemaphoreDestroy(storage->sealSema);
+    osalHandler->SemaphoreDestroy(storage->sealExitSema);
+    storage->sealTask = NULL;
+    storage->sealSema = NULL;
+    storage->sealExitSema = NULL;
+}
+
+static void DjiTest_LogStorageExitHandler(void)
+{
+    T_DjiTestLogStorage *storage = s_exitFlushStorage;
+
+    if (storage != NULL) {
+        DjiTest_LogStorageFlush(storage);
+    }
+}
+
+static void DjiTest_LogStorageFatalSignalHandler(int signalNum)
+{
+    T_DjiTestLogStorage *storage = s_exitFlushStorage;
+
+    /*
+     * The crash may have happened inside the storage with its mutex held, by this thread or while another one was
+     * writing. The Linux OSAL mutex is a pthread mutex, try it and leave the block in memory when it is busy rather
+     * than wait for a lock that may never be released.
+     */
+    if (storage != NULL && pthread_mutex_trylock((pthread_mutex_t *) storage->mutex) == 0) {
+        if (DjiTest_LogStorageSealBlock(storage, true) == DJI_ERROR_SYSTEM_MODULE_CODE_SUCCESS) {
+            fdatasync(storage->segmentFd);
+            fdatasync(storage->indexFd);
+        }
+        pthread_mutex_unlock((pthread_mutex_t *) storage->mutex);
+    }
+
+    raise(signalNum);
+}
+
+static T_DjiReturnCode DjiTest_LogStorageOpenSegment(T_DjiTestLogStorage *storage)
+{
+    char path[DJI_TEST_LOG_STORAGE_PATH_MAX_SIZE + DJI_TEST_LOG_STORAGE_NAME_MAX_SIZE + 8];
+    T_DjiTestLogFileHeader header = {0};
+    time_t currentTime = time(NULL);
+    struct tm localTime;
+    int pathLen;
+
+    localtime_r(&currentTime, &localTime);
+    pathLen = snprintf(path, sizeof(path), "%s/%s_%06u_%04d%02d%02d_%02d-%02d-%02d" DJI_TEST_LOG_STORAGE_SEGMENT_SUFFIX,
+                       storage->directory, storage->prefix, storage->segmentNumber, localTime.tm_year + 1900,
+                       localTime.tm_mon + 1, localTime.tm_mday, localTime.tm_hour, localTime.tm_min,
+                       localTime.tm_sec);
+
+    storage->segmentFd = open(path, O_WRONLY | O_CREAT | O_TRUNC | O_APPEND | O_CLOEXEC, 0644);
+    if (storage->segmentFd < 0) {
+        return DJI_ERROR_SYSTEM_MODULE_CODE_SYSTEM_ERROR;
+    }
+    strcpy(path + pathLen - strlen(DJI_TEST_LOG_STORAGE_SEGMENT_SUFFIX), DJI_TEST_LOG_STORAGE_INDEX_SUFFIX);
+    storage->indexFd = open(path, O_WRONLY | O_CREAT | O_TRUNC | O_APPEND | O_CLOEXEC, 0644);
+    if (storage->indexFd < 0) {
+        DjiTest_LogStorageCloseSegment(storage);
+        return DJI_ERROR_SYSTEM_MODULE_CODE_SYSTEM_ERROR;
+    }
+
+    header.version = DJI_TEST_LOG_FORMAT_VERSION;
+    header.headerSize = sizeof(header);
+    header.openTimeMs = DjiTest_LogStorageGetWallTimeMs();
+    header.magic = DJI_TEST_LOG_SEGMENT_MAGIC;
+    if (!DjiTest_LogStorageWriteAll(storage->segmentFd, &header, sizeof(header))) {
+        DjiTest_LogStorageCloseSegment(storage);
+        return DJI_ERROR_SYSTEM_MODULE_CODE_SYSTEM_ERROR;
+    }
+    header.magic = DJI_TEST_LOG_INDEX_MAGIC;
+    if (!DjiTest_LogStorageWriteAll(storage->indexFd, &header, sizeof(header))) {
+        DjiTest_LogStorageCloseSegment(storage);
+        return DJI_ERROR_SYSTEM_MODULE_CODE_SYSTEM_ERROR;
+    }
+
+    storage->segmentNumber++;
+    storage->segmentSize = sizeof(header);
+    DjiPlatform_GetOsalHandler()->GetTimeMs(&storage->segmentOpenTimeMs);
+    storage->statistics.segmentCount++;
+
+    DjiTest_LogStorageRetain(storage);
+
+    return DJI_ERROR_SYSTEM_MODULE_CODE_SUCCESS;
+}
+
+static void DjiTest_LogStorageCloseSegment(T_DjiTestLogStorage *storage)
+{
+    if (storage->segmentFd >= 0) {
+        close(storage->segmentFd);
+        storage->segmentFd = -1;
+    }
+    if (storage->indexFd >= 0) {
+        close(storage->indexFd);
+        storage->indexFd = -1;
+    }
+}
+
+/**
+ * @brief Delete segments past the age limit, then the oldest ones until the total size fits. The segment being
+ * written is never deleted.
+ */
+static void DjiTest_LogStorageRetain(T_DjiTestLogStorage *storage)
+{
+    T_DjiOsalHandler *osalHandler = DjiPlatform_GetOsalHandler();
+    char path[DJI_TEST_LOG_STORAGE_PATH_MAX_SIZE + DJI_TEST_LOG_STORAGE_NAME_MAX_SIZE + 8];
+    T_DjiTestLogSegment *segments;
+    uint64_t currentTime = (uint64_t) time(NULL);
+    uint64_t totalSize = 0;
+    uint32_t count = 0;
+    uint32_t i;
+    bool isExpired;
+
+    if (storage->config.maxTotalSize == 0 && storage->config.maxAgeS == 0) {
+        return;
+    }
+
+    segments = osalHandler->Malloc(DJI_TEST_LOG_STORAGE_SEGMENT_MAX_NUM * sizeof(T_DjiTestLogSegment));
+    if (segments == NULL) {
+        return;
+    }
+    if (DjiTest_LogStorageListSegments(storage->directory, storage->prefix, segments,
+                                       DJI_TEST_LOG_STORAGE_SEGMENT_MAX_NUM, &count) !=
+        DJI_ERROR_SYSTEM_MODULE_CODE_SUCCESS) {
+        osalHandler->Free(segments);
+        return;
+    }
+
+    for (i = 0; i < count; i++) {
+        totalSize += segments[i].size;
+    }
+    for (i = 0; i < count; i++) {
+        if (segments[i].number + 1 == storage->segmentNumber) {
+            continue;
+        }
+        isExpired = storage->config.maxAgeS > 0 && currentTime > segments[i].modifyTime &&
+                    currentTime - segments[i].modifyTime > storage->config.maxAgeS;
+        if (!isExpired && (storage->config.maxTotalSize == 0 || totalSize <= storage->config.maxTotalSize)) {
+            continue;
+        }
+
+        snprintf(path, sizeof(path), "%s/%s" DJI_TEST_LOG_STORAGE_SEGMENT_SUFFIX, storage->directory,
+                 segments[i].name);
+        if (unlink(path) != 0 && errno != ENOENT) {
+            continue;
+        }
+        snprintf(path, sizeof(path), "%s/%s" DJI_TEST_LOG_STORAGE_INDEX_SUFFIX, storage->directory,
+                 segments[i].name);
+        unlink(path);
+        totalSize -= segments[i].size;
+        storage->statistics.deletedSegmentCount++;
+        storage->statistics.deletedBytes += segments[i].size;
+    }
+
+    osalHandler->Free(segments);
+}
+
+/**
+ * @brief Query the blocks listed by the index file, then the ones appended after its last entry. Those are found by
+ * their headers, the index of a segment whose writer stopped between the two writes of a block misses them.
+ */
+static T_DjiReturnCode DjiTest_LogStorageQuerySegment(T_DjiTestLogQueryContext *context, const char *directory,
+                                                      const char *name)
+{
+    T_DjiOsalHandler *osalHandler = DjiPlatform_GetOsalHandler();
+    char path[DJI_TEST_LOG_STORAGE_PATH_MAX_SIZE + DJI_TEST_LOG_STORAGE_NAME_MAX_SIZE + 8];
+    T_DjiReturnCode returnCode = DJI_ERROR_SYSTEM_MODULE_CODE_SUCCESS;
+    T_DjiTestLogIndexEntry *entries = NULL;
+    T_DjiTestLogFileHeader header;
+    T_DjiTestLogBlockHeader blockHeader;
+    struct stat fileStat;
+    uint64_t segmentSize;
+    uint64_t nextOffset = sizeof(T_DjiTestLogFileHeader);
+    uint64_t blockEnd;
+    uint32_t entryCount = 0;
+    uint32_t i;
+    int indexFd;
+    int fd;
+
+    snprintf(path, sizeof(path), "%s/%s" DJI_TEST_LOG_STORAGE_SEGMENT_SUFFIX, directory, name);
+    fd = open(path, O_RDONLY | O_CLOEXEC);
+    if (fd < 0) {
+        /* Deleted by the retention of a running writer since the listing. */
+        return DJI_ERROR_SYSTEM_MODULE_CODE_SUCCESS;
+    }
+    if (fstat(fd, &fileStat) != 0 || !DjiTest_LogStorageReadAll(fd, 0, &header, sizeof(header)) ||
+        header.magic != DJI_TEST_LOG_SEGMENT_MAGIC || header.version != DJI_TEST_LOG_FORMAT_VERSION) {
+        context->statistics->corruptBlockCount++;
+        goto CloseFile;
+    }
+    segmentSize = (uint64_t) fileStat.st_size;
+    context->statistics->segmentCount++;
+
+    snprintf(path, sizeof(path), "%s/%s" DJI_TEST_LOG_STORAGE_INDEX_SUFFIX, directory, name);
+    indexFd = open(path, O_RDONLY | O_CLOEXEC);
+    if (indexFd >= 0) {
+        if (fstat(indexFd, &fileStat) == 0 && fileStat.st_size > (off_t) sizeof(header) &&
+            DjiTest_LogStorageReadAll(indexFd, 0, &header, sizeof(header)) &&
+            header.magic == DJI_TEST_LOG_INDEX_MAGIC) {
+            /* A torn last entry of a running writer is left out. */
+            entryCount = (uint32_t) ((fileStat.st_size - sizeof(header)) / sizeof(T_DjiTestLogIndexEntry));
+            entries = osalHandler->Malloc(USER_UTIL_MAX(entryCount, 1) * sizeof(T_DjiTestLogIndexEntry));
+            if (entries == NULL || !DjiTest_LogStorageReadAll(indexFd, sizeof(header), entries,
+                                                             entryCount * sizeof(T_DjiTestLogIndexEntry))) {
+                entryCount = 0;
+            }
+        }
+        close(indexFd);
+    }
+
+    for (i = 0; i < entryCount && returnCode == DJI_ERROR_SYSTEM_MODULE_CODE_SUCCESS; i++) {
+        blockEnd = (uint64_t) entries[i].offset + sizeof(T_DjiTestLogBlockHeader) + entries[i].info.dataLen;
+        if (entries[i].offset < sizeof(header) || blockEnd > segmentSize) {
+            context->statistics->corruptBlockCount++;
+            continue;
+        }
+        context->statistics->blockCount++;
+        nextOffset = USER_UTIL_MAX(nextOffset, blockEnd);
+        if (DjiTest_LogStorageIsBlockMatched(context, &entries[i].info)) {
+            returnCode = DjiTest_LogStorageQueryBlock(context, fd, entries[i].offset, &entries[i].info);
+        }
+    }
+
+    while (returnCode == DJI_ERROR_SYSTEM_MODULE_CODE_SUCCESS && nextOffset + sizeof(blockHeader) <= segmentSize) {
+        if (!DjiTest_LogStorageReadAll(fd, nextOffset, &blockHeader, sizeof(blockHeader)) ||
+            blockHeader.magic != DJI_TEST_LOG_BLOCK_MAGIC ||
+            blockHeader.info.dataLen > segmentSize - nextOffset - sizeof(blockHeader)) {
+            break;
+        }
+        context->statistics->blockCount++;
+        context->statistics->recoveredBlockCount++;
+        if (DjiTest_LogStorageIsBlockMatched(context, &blockHeader.info)) {
+            returnCode = DjiTest_LogStorageQueryBlock(context, fd, (uint32_t) nextOffset, &blockHeader.info);
+        }
+        nextOffset += sizeof(blockHeader) + blockHeader.info.dataLen;
+    }
+
+    if (entries != NULL) {
+        osalHandler->Free(entries);
+    }
+CloseFile:
+    close(fd);
+
+    return returnCode;
+}
+
+static T_DjiReturnCode DjiTest_LogStorageQueryBlock(T_DjiTestLogQueryContext *context, int fd, uint32_t offset,
+                                                    const T_DjiTestLogBlockInfo *info)
+{
+    const T_DjiTestLogQuery *query = context->query;
+    T_DjiTestLogBlockHeader header;
+    T_DjiReturnCode returnCode;
+    const uint8_t *raw;
+    const uint8_t *end;
+    uint32_t blockLen = (uint32_t) sizeof(header) + info->dataLen;
+    uint32_t keywordLen = query->keyword != NULL ? (uint32_t) strlen(query->keyword) : 0;
+    uint32_t rawLen = 0;
+    uint64_t timeMs = 0;
+    uint64_t zigzagTime;
+    uint64_t len;
+    uint8_t level;
+
+    if (info->rawLen > DJI_TEST_LOG_STORAGE_BLOCK_MAX_SIZE || blockLen > context->dataCapacity ||
+        info->dataLen > info->rawLen || !DjiTest_LogStorageReadAll(fd, offset, context->dataBuffer, blockLen)) {
+        context->statistics->corruptBlockCount++;
+        return DJI_ERROR_SYSTEM_MODULE_CODE_SUCCESS;
+    }
+    memcpy(&header, context->dataBuffer, sizeof(header));
+    if (header.magic != DJI_TEST_LOG_BLOCK_MAGIC || memcmp(&header.info, info, sizeof(*info)) != 0) {
+        context->statistics->corruptBlockCount++;
+        return DJI_ERROR_SYSTEM_MODULE_CODE_SUCCESS;
+    }
+
+    if (info->dataLen == info->rawLen) {
+        memcpy(context->rawBuffer, context->dataBuffer + sizeof(header), info->rawLen);
+        rawLen = info->rawLen;
+    } else if (UtilLz4_Decompress(context->dataBuffer + sizeof(header), info->dataLen, context->rawBuffer,
+                                  info->rawLen, &rawLen) != DJI_ERROR_SYSTEM_MODULE_CODE_SUCCESS ||
+               rawLen != info->rawLen) {
+        context->statistics->corruptBlockCount++;
+        return DJI_ERROR_SYSTEM_MODULE_CODE_SUCCESS;
+    }
+    context->statistics->decodedBlockCount++;
+    context->statistics->decodedBytes += rawLen;
+
+    raw = context->rawBuffer;
+    end = raw + rawLen;
+    while (raw < end) {
+        level = *raw++;
+        if (!DjiTest_LogStorageGetVarint(&raw, end, &zigzagTime) || !DjiTest_LogStorageGetVarint(&raw, end, &len) ||
+            len > (uint64_t) (end - raw) || level >= DJI_TEST_LOG_STORAGE_LEVEL_NUM) {
+            context->statistics->corruptBlockCount++;
+            break;
+        }
+        timeMs += (uint64_t) ((int64_t) (zigzagTime >> 1) ^ -(int64_t) (zigzagTime & 1));
+
+        if (level <= query->maxLevel && timeMs >= query->startTimeMs &&
+            (query->endTimeMs == 0 || timeMs < query->endTimeMs) &&
+            (keywordLen == 0 || DjiTest_LogStorageContains((const char *) raw, (uint32_t) len, query->keyword,
+                                                           keywordLen))) {
+            context->statistics->matchedLineCount++;
+            returnCode = context->callback(context->userData, timeMs, level, (const char *) raw, (uint32_t) len);
+            if (returnCode != DJI_ERROR_SYSTEM_MODULE_CODE_SUCCESS) {
+                return returnCode;
+            }
+        }
+        raw += len;
+    }
+
+    return DJI_ERROR_SYSTEM_MODULE_CODE_SUCCESS;
+}
+
+static bool DjiTest_LogStorageIsBlockMatched(const T_DjiTestLogQueryContext *context,
+                                             const T_DjiTestLogBlockInfo *info)
+{
+    return (info->levelMask & context->levelMask) != 0 && info->maxTimeMs >= context->query->startTimeMs &&
+           (context->query->endTimeMs == 0 || info->minTimeMs < context->query->endTimeMs);
+}
+
+static uint8_t DjiTest_LogStorageParseLevel(const uint8_t *data, uint32_t len)
+{
+    const char *text = (const char *) data;
+    const char *tag;
+    uint32_t searchLen = USER_UTIL_MIN(len, DJI_TEST_LOG_LEVEL_SEARCH_SIZE);
+    uint32_t i;
+    uint8_t level;
+
+    /* Lines look like "[12.345][module]-[Info]-...", the level is the tag after the first "]-". */
+    for (i = 0; i + 2 < searchLen; i++) {
+        if (text[i] != ']' || text[i + 1] != '-') {
+            continue;
+        }
+        for (level = 0; level < DJI_TEST_LOG_STORAGE_LEVEL_NUM; level++) {
+            tag = s_logLevelTags[level];
+            if (strlen(tag) <= len - i - 2 && memcmp(&text[i + 2], tag, strlen(tag)) == 0) {
+                return level;
+            }
+        }
+        break;
+    }
+
+    return DJI_LOGGER_CONSOLE_LOG_LEVEL_INFO;
+}
+
+/**
+ * @brief Copy without the ANSI escape sequences of the console colors, only measure when dst is NULL.
+ */
+static uint32_t DjiTest_LogStorageStripColor(const uint8_t *src, uint32_t len, uint8_t *dst, uint32_t dstCapacity)
+{
+    uint32_t outLen = 0;
+    uint32_t i = 0;
+
+    while (i < len && outLen < dstCapacity) {
+        if (src[i] == 0x1B && i + 1 < len && src[i + 1] == '[') {
+            i += 2;
+            while (i < len && (src[i] < 0x40 || src[i] > 0x7E)) {
+                i++;
+            }
+            i++;
+            continue;
+        }
+        if (dst != NULL) {
+            dst[outLen] = src[i];
+        }
+        outLen++;
+        i++;
+    }
+
+    return outLen;
+}
+
+static bool DjiTest_LogStorageContains(const char *text, uint32_t len, const char *keyword, uint32_t keywordLen)
+{
+    const char *position = text;
+    const char *last;
+
+    if (keywordLen > len) {
+        return false;
+    }
+
+    last = text + len - keywordLen;
+    while (position <= last) {
+        position = memchr(position, keyword[0], (size_t) (last - position) + 1);
+        if (position == NULL) {
+            return false;
+        }
+        if (memcmp(position, keyword, keywordLen) == 0) {
+            return true;
+        }
+        position++;
+    }
+
+    return false;
+}
+
+static int DjiTest_LogStorageCompareSegment(const void *a, const void *b)
+{
+    uint32_t numberA = ((const T_DjiTestLogSegment *) a)->number;
+    uint32_t numberB = ((const T_DjiTestLogSegment *) b)->number;
+
+    return numberA < numberB ? -1 : (numberA > numberB ? 1 : 0);
+}
+
+/**
+ * @brief Create the directory and its missing parents.
+ */
+static bool DjiTest_LogStorageMakeDirectory(const char *directory)
+{
+    char path[DJI_TEST_LOG_STORAGE_PATH_MAX_SIZE];
+    char *separator;
+
+    strcpy(path, directory);
+    for (separator = strchr(path + 1, '/'); separator != NULL; separator = strchr(separator + 1, '/')) {
+        *separator = '\0';
+        if (mkdir(path, 0755) != 0 && errno != EEXIST) {
+            return false;
+        }
+        *separator = '/';
+    }
+
+    return mkdir(path, 0755) == 0 || errno == EEXIST;
+}
+
+static bool DjiTest_LogStorageWriteAll(int fd, const void *data, uint32_t len)
+{
+    const uint8_t *position = data;
+    ssize_t writeLen;
+
+    while (len > 0) {
+        writeLen = write(fd, position, len);
+        if (writeLen < 0 && errno == EINTR) {
+            continue;
+        }
+        if (writeLen <= 0) {
+            return false;
+        }
+        position += writeLen;
+        len -= (uint32_t) writeLen;
+    }
+
+    return true;
+}
+
+static bool DjiTest_LogStorageReadAll(int fd, uint64_t offset, void *data, uint32_t len)
+{
+    uint8_t *position = data;
+    ssize_t readLen;
+
+    while (len > 0) {
+        readLen = pread(fd, position, len, (off_t) offset);
+        if (readLen < 0 && errno == EINTR) {
+            continue;
+        }
+        if (readLen <= 0) {
+            return false;
+        }
+        position += readLen;
+        offset += (uint64_t) readLen;
+        len -= (uint32_t) readLen;
+    }
+
+    return true;
+}
+
+static uint64_t DjiTest_LogStorageGetWallTimeMs(void)
+{
+    struct timespec now;
+
+    clock_gettime(CLOCK_REALTIME, &now);
+
+    return (uint64_t) now.tv_sec * 1000 + (uint64_t) now.tv_nsec / 1000000;
+}
+
+static uint8_t *DjiTest_LogStoragePutVarint(uint8_t *out, uint64_t value)
+{
+    while (value >= 0x80) {
+        *out++ = (uint8_t) (value | 0x80);
+        value >>= 7;
+    }
+    *out++ = (uint8_t) value;
+
+    return out;
+}
+
+static bool DjiTest_LogStorageGetVarint(const uint8_t **in, const uint8_t *end, uint64_t *value)
+{
+    const uint8_t *p = *in;
+    uint32_t shift = 0;
+
+    *value = 0;
+    while (p < end && shift < 64) {
+        *value |= (uint64_t) (*p & 0x7F) << shift;
+        if ((*p++ & 0x80) == 0) {
+            *in = p;
+            return true;
+        }
+        shift += 7;
+    }
+
+    return false;
+}
+
+#endif
+
+/****************** (C) COPYRIGHT DJI Innovations *****END OF FILE****/
@@ -0,0 +1,198 @@
+/**
+ ********************************************************************
+ * @file    test_log_storage.h
+ * @brief   This is the header file for "test_log_storage.c", defining the structure and
+ * (exported) function prototypes.
+ *
+ * @copyright (c) 2021 DJI. All rights reserved.
+ *
+ * All information contained herein is, and remains, the property of DJI.
+ * The intellectual and technical concepts contained herein are proprietary
+ * to DJI and may be covered by U.S. and foreign patents, patents in process,
+ * and protected by trade secret or copyright law.  Dissemination of this
+ * information, including but not limited to data and other proprietary
+ * material(s) incorporated within the information, in any form, is strictly
+ * prohibited without the express written consent of DJI.
+ *
+ * If you receive this source code without DJI’s authorization, you may not
+ * further disseminate the information, and you must immediately remove the
+ * source code and notify DJI of its removal. DJI reserves the right to pursue
+ * legal actions against you for any loss(es) or damage(s) caused by your
+ * failure to do so.
+ *
+ *********************************************************************
+ */
+
+/* Define to prevent recursive inclusion -------------------------------------*/
+#ifndef TEST_LOG_STORAGE_H
+#define TEST_LOG_STORAGE_H
+
+/* Includes ------------------------------------------------------------------*/
+#include "dji_typedef.h"
+#include "dji_platform.h"
+#include "dji_logger.h"
+#include "utils/util_lz4.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#ifdef SYSTEM_ARCH_LINUX
+
+/* Exported constants --------------------------------------------------------*/
+#define DJI_TEST_LOG_STORAGE_PATH_MAX_SIZE          (256)
+#define DJI_TEST_LOG_STORAGE_PREFIX_MAX_SIZE        (32)
+#define DJI_TEST_LOG_STORAGE_NAME_MAX_SIZE          (DJI_TEST_LOG_STORAGE_PREFIX_MAX_SIZE + 32)
+#define DJI_TEST_LOG_STORAGE_BLOCK_MAX_SIZE         (1024 * 1024)
+#define DJI_TEST_LOG_STORAGE_SEGMENT_MAX_NUM        (1024)
+#define DJI_TEST_LOG_STORAGE_LEVEL_NUM              (DJI_LOGGER_CONSOLE_LOG_LEVEL_DEBUG + 1)
+#define DJI_TEST_LOG_STORAGE_SEGMENT_SUFFIX         ".dlog"
+#define DJI_TEST_LOG_STORAGE_INDEX_SUFFIX           ".didx"
+
+/* Exported types ------------------------------------------------------------*/
+typedef struct {
+    const char *directory;          /*!< Created if missing, NULL for the working directory. */
+    const char *prefix;             /*!< Segment names are "<prefix>_<number>_<open time>.dlog". */
+    uint32_t blockSize;             /*!< Text bytes compressed together, at most DJI_TEST_LOG_STORAGE_BLOCK_MAX_SIZE. */
+    uint32_t blockIntervalMs;       /*!< Longest time a line waits in memory, a task seals older blocks. */
+    bool isSealOnError;             /*!< Seal the block at every error line, so errors reach the file at once. */
+    uint32_t segmentMaxSize;        /*!< Start a new segment after this many bytes on disk, 0 disables. */
+    uint32_t segmentMaxDurationS;   /*!< Start a new segment after this many seconds, 0 disables. */
+    uint64_t maxTotalSize;          /*!< Delete the oldest segments above this many bytes in total, 0 disables. */
+    uint32_t maxAgeS;               /*!< Delete segments last written this many seconds ago, 0 disables. */
+} T_DjiTestLogStorageConfig;
+
+/**
+ * @brief Summary of one compressed block, stored in front of the block and again in the index file of its segment.
+ * @note Times are wall clock milliseconds since the epoch taken at write. They are the extremes of the block rather
+ * than the first and last line, the clock may be stepped by time synchronization while logging.
+ */
+#pragma pack(1)
+typedef struct {
+    uint32_t rawLen;                /*!< Records before compression. */
+    uint32_t dataLen;               /*!< LZ4 block following the header. */
+    uint32_t lineCount;
+    uint8_t levelMask;              /*!< Bit n is set when the block holds a line of E_DjiLoggerConsoleLogLevel n. */
+    uint8_t reserved[3];
+    uint64_t minTimeMs;
+    uint64_t maxTimeMs;
+} T_DjiTestLogBlockInfo;
+
+typedef struct {
+    uint32_t offset;                /*!< Block header position in the segment. */
+    T_DjiTestLogBlockInfo info;
+} T_DjiTestLogIndexEntry;
+#pragma pack()
+
+typedef struct {
+    uint32_t number;
+    char name[DJI_TEST_LOG_STORAGE_NAME_MAX_SIZE];  /*!< Without suffix. */
+    uint64_t size;                  /*!< Segment and index file together. */
+    uint64_t modifyTime;            /*!< Seconds since the epoch. */
+} T_DjiTestLogSegment;
+
+typedef struct {
+    uint64_t lineCount;
+    uint64_t rawBytes;              /*!< Text as received, color codes included. */
+    uint64_t storedBytes;           /*!< Block headers and compressed data written. */
+    uint32_t blockCount;
+    uint32_t segmentCount;          /*!< Segments created by this open. */
+    uint32_t deletedSegmentCount;
+    uint64_t deletedBytes;
+    uint32_t writeErrorCount;
+} T_DjiTestLogStorageStatistics;
+
+/**
+ * @brief Stores log lines in compressed blocks of rotating segment files, indexed by time and level.
+ * @note Each line is kept with its wall clock time and the level read from its "-[Level]-" tag, color codes and the
+ * line end are dropped. A block is compressed and appended when it is full, at an error line, blockIntervalMs after its
+ * first line or on flush, so a crash loses at most that much. Old segments are deleted in the process on open and on
+ * rotation. All functions are thread-safe. They never log themselves, the storage is meant to be a logger console.
+ */
+typedef struct {
+    T_DjiTestLogStorageConfig config;
+    char directory[DJI_TEST_LOG_STORAGE_PATH_MAX_SIZE];
+    char prefix[DJI_TEST_LOG_STORAGE_PREFIX_MAX_SIZE];
+    T_DjiMutexHandle mutex;
+    T_DjiTaskHandle sealTask;
+    T_DjiSemaHandle sealSema;
+    T_DjiSemaHandle sealExitSema;
+    bool isSealTaskStop;
+    int segmentFd;
+    int indexFd;
+    uint32_t segmentNumber;
+    uint32_t segmentSize;
+    uint32_t segmentOpenTimeMs;
+    uint8_t *rawBuffer;
+    uint8_t *dataBuffer;
+    uint32_t rawLen;
+    uint32_t blockOpenTimeMs;
+    uint64_t lastTimeMs;            /*!< Time of the previous record of the block, records store the difference. */
+    T_DjiTestLogBlockInfo block;
+    T_UtilLz4Encoder encoder;
+    T_DjiTestLogStorageStatistics statistics;
+} T_DjiTestLogStorage;
+
+typedef struct {
+    uint64_t startTimeMs;           /*!< Wall clock milliseconds since the epoch, 0 for no lower bound. */
+    uint64_t endTimeMs;             /*!< Exclusive, 0 for no upper bound. */
+    uint8_t maxLevel;               /*!< Lines of this E_DjiLoggerConsoleLogLevel and more severe ones. */
+    const char *keyword;            /*!< Lines containing this text, NULL for all. */
+} T_DjiTestLogQuery;
+
+typedef struct {
+    uint32_t segmentCount;
+    uint32_t blockCount;
+    uint32_t decodedBlockCount;     /*!< Blocks whose index entry matched, the only ones decompressed. */
+    uint64_t decodedBytes;
+    uint64_t matchedLineCount;
+    uint32_t recoveredBlockCount;   /*!< Blocks missing in the index file of a segment cut short, found by scanning. */
+    uint32_t corruptBlockCount;
+} T_DjiTestLogQueryStatistics;
+
+/**
+ * @brief Receives each matching line in time order within a segment, line is not terminated. A return code other
+ * than success stops the query and is returned by it.
+ */
+typedef T_DjiReturnCode (*DjiTestLogQueryCallback)(void *userData, uint64_t timeMs, uint8_t level, const char *line,
+                                                   uint32_t len);
+
+/* Exported functions --------------------------------------------------------*/
+void DjiTest_LogStorageGetDefaultConfig(T_DjiTestLogStorageConfig *config);
+T_DjiReturnCode DjiTest_LogStorageOpen(T_DjiTestLogStorage *storage, const T_DjiTestLogStorageConfig *config);
+T_DjiReturnCode DjiTest_LogStorageWrite(T_DjiTestLogStorage *storage, const uint8_t *data, uint32_t len);
+T_DjiReturnCode DjiTest_LogStorageWriteLine(T_DjiTestLogStorage *storage, uint64_t timeMs, uint8_t level,
+                                            const char *line, uint32_t len);
+T_DjiReturnCode DjiTest_LogStorageFlush(T_DjiTestLogStorage *storage);
+T_DjiReturnCode DjiTest_LogStorageClose(T_DjiTestLogStorage *storage);
+/**
+ * @brief Flush the storage when the process ends through exit() or a fatal signal.
+ * @note One storage per process. The fatal signal handler writes the open block to the open segment only when the
+ * storage is not locked, it never rotates or deletes segments, and then raises the signal again with its default
+ * action.
+ */
+T_DjiReturnCode DjiTest_LogStorageFlushOnExit(T_DjiTestLogStorage *storage);
+void DjiTest_LogStorageGetStatistics(T_DjiTestLogStorage *storage, T_DjiTestLogStorageStatistics *statistics);
+
+/**
+ * @brief List the segments of a prefix in a directory, oldest first.
+ * @note At most maxCount segments are returned, the oldest ones when there are more.
+ */
+T_DjiReturnCode DjiTest_LogStorageListSegments(const char *directory, const char *prefix,
+                                               T_DjiTestLogSegment *segments, uint32_t maxCount, uint32_t *count);
+/**
+ * @brief Search the segments of a prefix, closed or still written. Only the index files are read in full, the blocks
+ * outside the time range or without a line of the wanted levels are skipped undecoded.
+ */
+T_DjiReturnCode DjiTest_LogStorageQuery(const char *directory, const char *prefix, const T_DjiTestLogQuery *query,
+                                        DjiTestLogQueryCallback callback, void *userData,
+                                        T_DjiTestLogQueryStatistics *statistics);
+
+#endif
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // TEST_LOG_STORAGE_H
+/************************ (C) COPYRIGHT DJI Innovations *******END OF FILE******/
@@ -31,6 +31,7 @@
 #include "dji_logger.h"
 #include "dji_platform.h"
 #include "test_mop_channel.h"
+#include "test_mop_file_transfer.h"
 
 /* Private constants ---------------------------------------------------------*/
 #define DJI_MOP_CHANNEL_TASK_STACK_SIZE                          2048
@@ -48,6 +49,12 @@
 #define TEST_MOP_CHANNEL_FILE_SERVICE_RECV_BUFFER                (100 * 1024)
 #define TEST_MOP_CHANNEL_FILE_SERVICE_CLIENT_MAX_SUPPORT_NUM     10
 
+/* Ranged, pipelined and resumable downloads, see test_mop_file_transfer.h. */
+#define TEST_MOP_CHANNEL_CHUNKED_FILE_SERVICE_CHANNEL_ID         49154
+#define TEST_MOP_CHANNEL_CHUNKED_FILE_SERVICE_CLIENT_MAX_NUM     4
+#define TEST_MOP_CHANNEL_CHUNKED_FILE_SERVICE_STREAM_ID          1
+#define TEST_MOP_CHANNEL_CHUNKED_FILE_SERVICE_SEND_QUEUE_SIZE    (8 * DJI_TEST_MOP_FILE_CHUNK_MAX_SIZE)
+
 /* Private types -------------------------------------------------------------*/
 typedef enum {
     MOP_FILE_SERVICE_DOWNLOAD_IDEL = 0,
@@ -82,6 +89,16 @@ typedef struct {
     uint16_t uploadSeqNum;
 } T_MopFileServiceClientContent;
 
+#ifdef SYSTEM_ARCH_LINUX
+typedef struct {
+    bool isUsed;
+    bool isClosed;
+    T_DjiMopChannelHandle clientHandle;
+    T_DjiTestMopMux mux;
+    T_DjiTestMopFileServer server;
+} T_MopChunkedFileServiceClient;
+#endif
+
 /* Private values -------------------------------------------------------------*/
 static T_DjiMopChannelHandle s_testMopChannelNormalHandle;
 static T_DjiMopChannelHandle s_testMopChannelNormalOutHandle;
@@ -94,12 +111,26 @@ static T_DjiTaskHandle s_fileServiceMopChannelAcceptTask;
 static T_DjiMopChannelHandle s_fileServiceMopChannelHandle;
 static T_MopFileServiceClientContent s_fileServiceContent[TEST_MOP_CHANNEL_FILE_SERVICE_CLIENT_MAX_SUPPORT_NUM];
 
+#ifdef SYSTEM_ARCH_LINUX
+static T_DjiTaskHandle s_chunkedFileServiceAcceptTask;
+static T_DjiMopChannelHandle s_chunkedFileServiceHandle;
+static T_MopChunkedFileServiceClient s_chunkedFileServiceClient[TEST_MOP_CHANNEL_CHUNKED_FILE_SERVICE_CLIENT_MAX_NUM];
+#endif
+
 /* Private functions declaration ---------------------------------------------*/
 static void *DjiTest_MopChannelSendNormalTask(void *arg);
 static void *DjiTest_MopChannelRecvNormalTask(void *arg);
 static void *DjiTest_MopChannelFileServiceAcceptTask(void *arg);
 static void *DjiTest_MopChannelFileServiceRecvTask(void *arg);
 static void *DjiTest_MopChannelFileServiceSendTask(void *arg);
+#ifdef SYSTEM_ARCH_LINUX
+static void *DjiTest_MopChannelChunkedFileServiceAcceptTask(void *arg);
+static T_DjiReturnCode DjiTest_MopChannelChunkedFileServiceOpen(T_MopChunkedFileServiceClient *client);
+static void DjiTest_MopChannelChunkedFileServiceRelease(T_MopChunkedFileServiceClient *client);
+static void DjiTest_MopChannelChunkedFileServiceOnMessage(void *userData, uint16_t streamId, const uint8_t *data,
+                                                          uint32_t len);
+static void DjiTest_MopChannelChunkedFileServiceOnClose(void *userData, T_DjiReturnCode returnCode);
+#endif
 
 /* Exported functions definition ---------------------------------------------*/
 T_DjiReturnCode DjiTest_MopChannelStartService(void)
@@ -140,6 +171,15 @@ T_DjiReturnCode DjiTest_MopChannelStartService(void)
         return DJI_ERROR_SYSTEM_MODULE_CODE_UNKNOWN;
     }
 
+#ifdef SYSTEM_ARCH_LINUX
+    returnCode = osalHandler->TaskCreate("mop_chunked_accept_task", DjiTest_MopChannelChunkedFileServiceAcceptTask,
+                                         DJI_MOP_CHANNEL_TASK_STACK_SIZE, NULL, &s_chunkedFileServiceAcceptTask);
+    if (returnCode != DJI_ERROR_SYSTEM_MODULE_CODE_SUCCESS) {
+        USER_LOG_ERROR("mop channel chunked file service task create error, stat:0x%08llX.", returnCode);
+        return DJI_ERROR_SYSTEM_MODULE_CODE_UNKNOWN;
+    }
+#endif
+
     return DJI_ERROR_SYSTEM_MODULE_CODE_SUCCESS;
 }
 
@@ -832,4 +872,161 @@ static void *DjiTest_MopChannelFileServiceRecvTask(void *arg)
 
 #pragma GCC diagnostic pop
 
+#ifdef SYSTEM_ARCH_LINUX
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wmissing-noreturn"
+#pragma GCC diagnostic ignored "-Wreturn-type"
+
+static void *DjiTest_MopChannelChunkedFileServiceAcceptTask(void *arg)
+{
+    T_DjiReturnCode returnCode;
+    T_MopChunkedFileServiceClient *client;
+    T_DjiOsalHandler *osalHandler = DjiPlatform_GetOsalHandler();
+    uint8_t i;
+
+    USER_UTIL_UNUSED(arg);
+
+    USER_LOG_DEBUG("[Chunked-File-Service] Start the chunked file service.");
+
+    returnCode = DjiMopChannel_Create(&s_chunkedFileServiceHandle, DJI_MOP_CHANNEL_TRANS_RELIABLE);
+    if (returnCode != DJI_ERROR_SYSTEM_MODULE_CODE_SUCCESS) {
+        USER_LOG_ERROR("[Chunked-File-Service] mop channel create handle error, stat:0x%08llX.", returnCode);
+        return NULL;
+    }
+
+REBIND:
+    returnCode = DjiMopChannel_Bind(s_chunkedFileServiceHandle, TEST_MOP_CHANNEL_CHUNKED_FILE_SERVICE_CHANNEL_ID);
+    if (returnCode != DJI_ERROR_SYSTEM_MODULE_CODE_SUCCESS) {
+        USER_LOG_ERROR("[Chunked-File-Service] mop bind channel error :0x%08llX", returnCode);
+        osalHandler->TaskSleepMs(TEST_MOP_CHANNEL_RETRY_TIMEMS);
+        goto REBIND;
+    }
+
+    while (1) {
+        /* Free the clients whose link dropped, a reconnecting ground station resumes from its manifest. */
+        client = NULL;
+        for (i = 0; i < TEST_MOP_CHANNEL_CHUNKED_FILE_SERVICE_CLIENT_MAX_NUM; i++) {
+            if (s_chunkedFileServiceClient[i].isUsed && s_chunkedFileServiceClient[i].isClosed) {
+                USER_LOG_INFO("[Chunked-File-Service] [Client:%d] mop channel is disconnected", i);
+                DjiTest_MopChannelChunkedFileServiceRelease(&s_chunkedFileServiceClient[i]);
+            }
+            if (client == NULL && !s_chunkedFileServiceClient[i].isUsed) {
+                client = &s_chunkedFileServiceClient[i];
+            }
+        }
+        if (client == NULL) {
+            osalHandler->TaskSleepMs(TEST_MOP_CHANNEL_RETRY_TIMEMS);
+            continue;
+        }
+
+        returnCode = DjiMopChannel_Accept(s_chunkedFileServiceHandle, &client->clientHandle);
+        if (returnCode != DJI_ERROR_SYSTEM_MODULE_CODE_SUCCESS) {
+            USER_LOG_WARN("[Chunked-File-Service] mop accept channel error :0x%08llX", returnCode);
+            osalHandler->TaskSleepMs(TEST_MOP_CHANNEL_RETRY_TIMEMS);
+            continue;
+        }
+
+        returnCode = DjiTest_MopChannelChunkedFileServiceOpen(client);
+        if (returnCode != DJI_ERROR_SYSTEM_MODULE_CODE_SUCCESS) {
+            USER_LOG_ERROR("[Chunked-File-Service] open client error, stat:0x%08llX.", returnCode);
+            DjiMopChannel_Close(client->clientHandle);
+            DjiMopChannel_Destroy(client->clientHandle);
+            continue;
+        }
+
+        USER_LOG_INFO("[Chunked-File-Service] [Client:%d] mop channel is connected",
+                      (int) (client - s_chunkedFileServiceClient));
+    }
+}
+
+#pragma GCC diagnostic pop
+
+static T_DjiReturnCode DjiTest_MopChannelChunkedFileServiceOpen(T_MopChunkedFileServiceClient *client)
+{
+    T_DjiReturnCode returnCode;
+    T_DjiTestMopMuxConfig muxConfig;
+    T_DjiTestMopMuxTransport transport;
+    char curFileDirPath[DJI_FILE_PATH_SIZE_MAX];
+    char rootPath[DJI_FILE_PATH_SIZE_MAX];
+
+    returnCode = DjiUserUtil_GetCurrentFileDirPath(__FILE__, DJI_FILE_PATH_SIZE_MAX, curFileDirPath);
+    if (returnCode != DJI_ERROR_SYSTEM_MODULE_CODE_SUCCESS) {
+        return returnCode;
+    }
+    snprintf(rootPath, DJI_FILE_PATH_SIZE_MAX, "%smop_channel_test_file", curFileDirPath);
+
+    client->isClosed = false;
+
+    DjiTest_MopMuxGetDefaultConfig(&muxConfig);
+    muxConfig.sendQueueSize = TEST_MOP_CHANNEL_CHUNKED_FILE_SERVICE_SEND_QUEUE_SIZE;
+    muxConfig.callbacks.OnMessage = DjiTest_MopChannelChunkedFileServiceOnMessage;
+    muxConfig.callbacks.OnClose = DjiTest_MopChannelChunkedFileServiceOnClose;
+    muxConfig.callbacks.userData = client;
+    DjiTest_MopMuxGetMopTransport(client->clientHandle, &transport);
+
+    returnCode = DjiTest_MopMuxInit(&client->mux, &muxConfig, &transport);
+    if (returnCode != DJI_ERROR_SYSTEM_MODULE_CODE_SUCCESS) {
+        return returnCode;
+    }
+
+    returnCode = DjiTest_MopFileServerInit(&client->server, &client->mux,
+                                           TEST_MOP_CHANNEL_CHUNKED_FILE_SERVICE_STREAM_ID, rootPath);
+    if (returnCode != DJI_ERROR_SYSTEM_MODULE_CODE_SUCCESS) {
+        goto deInitMux;
+    }
+
+    returnCode = DjiTest_MopMuxOpenStream(&client->mux, TEST_MOP_CHANNEL_CHUNKED_FILE_SERVICE_STREAM_ID,
+                                          DJI_TEST_MOP_MUX_PRIORITY_DEFAULT);
+    if (returnCode != DJI_ERROR_SYSTEM_MODULE_CODE_SUCCESS) {
+        goto deInitServer;
+    }
+
+    returnCode = DjiTest_MopMuxStart(&client->mux);
+    if (returnCode != DJI_ERROR_SYSTEM_MODULE_CODE_SUCCESS) {
+        goto deInitServer;
+    }
+    client->isUsed = true;
+
+    return DJI_ERROR_SYSTEM_MODULE_CODE_SUCCESS;
+
+deInitServer:
+    DjiTest_MopFileServerDeInit(&client->server);
+deInitMux:
+    DjiTest_MopMuxDeInit(&client->mux);
+
+    return returnCode;
+}
+
+static void DjiTest_MopChannelChunkedFileServiceRelease(T_MopChunkedFileServiceClient *client)
+{
+    /* Stopping the mux closes the channel to end its blocked receive. */
+    DjiTest_MopMuxStop(&client->mux);
+    DjiTest_MopFileServerDeInit(&client->server);
+    DjiTest_MopMuxDeInit(&client->mux);
+    DjiMopChannel_Destroy(client->clientHandle);
+    client->isUsed = false;
+}
+
+static void DjiTest_MopChannelChunkedFileServiceOnMessage(void *userData, uint16_t streamId, const uint8_t *data,
+                                                          uint32_t len)
+{
+    T_MopChunkedFileServiceClient *client = userData;
+
+    if (streamId != TEST_MOP_CHANNEL_CHUNKED_FILE_SERVICE_STREAM_ID) {
+        return;
+    }
+
+    DjiTest_MopFileServerInput(&client->server, data, len);
+}
+
+static void DjiTest_MopChannelChunkedFileServiceOnClose(void *userData, T_DjiReturnCode returnCode)
+{
+    T_MopChunkedFileServiceClient *client = userData;
+
+    USER_UTIL_UNUSED(returnCode);
+
+    client->isClosed = true;
+}
+#endif
+
 /****************** (C) COPYRIGHT DJI Innovations *****END OF FILE****/
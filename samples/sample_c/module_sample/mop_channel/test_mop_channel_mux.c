@@ -0,0 +1,1049 @@
+/**
+ ********************************************************************
+ * @file    test_mop_channel_mux.c
+ * @brief   Multiplexed message streams with credit based flow control over one reliable mop channel.
+ *
+ * @copyright (c) 2021 DJI. All rights reserved.
+ *
+ * All information contained herein is, and remains, the property of DJI.
+ * The intellectual and technical concepts contained herein are proprietary
+ * to DJI and may be covered by U.S. and foreign patents, patents in process,
+ * and protected by trade secret or copyright law.  Dissemination of this
+ * information, including but not limited to data and other proprietary
+ * material(s) incorporated within the information, in any form, is strictly
+ * prohibited without the express written consent of DJI.
+ *
+ * If you receive this source code without DJI’s authorization, you may not
+ * further disseminate the information, and you must immediately remove the
+ * source code and notify DJI of its removal. DJI reserves the right to pursue
+ * legal actions against you for any loss(es) or damage(s) caused by your
+ * failure to do so.
+ *
+ *********************************************************************
+ */
+
+/* Includes ------------------------------------------------------------------*/
+#include "test_mop_channel_mux.h"
+#include <string.h>
+#include "dji_logger.h"
+#include "utils/util_misc.h"
+
+/* Private constants ---------------------------------------------------------*/
+#define DJI_TEST_MOP_MUX_TASK_STACK_SIZE        (2048)
+#define DJI_TEST_MOP_MUX_BUSY_RETRY_MS          (1)
+
+/* Private types -------------------------------------------------------------*/
+struct T_DjiTestMopMuxMessage {
+    struct T_DjiTestMopMuxMessage *next;
+    uint32_t len;
+    uint32_t offset;                /*!< Bytes already framed. */
+    uint8_t data[];
+};
+
+/* Private functions declaration ---------------------------------------------*/
+static T_DjiTestMopMuxStream *DjiTest_MopMuxFindStream(T_DjiTestMopMux *mux, uint16_t streamId);
+static T_DjiTestMopMuxStream *DjiTest_MopMuxAddStream(T_DjiTestMopMux *mux, uint16_t streamId, uint8_t priority);
+static void DjiTest_MopMuxFreeStream(T_DjiTestMopMuxStream *stream);
+static void DjiTest_MopMuxFreeMessages(T_DjiTestMopMuxMessage *message);
+static bool DjiTest_MopMuxBuildWindowFrame(T_DjiTestMopMux *mux);
+static bool DjiTest_MopMuxBuildDataFrame(T_DjiTestMopMux *mux);
+static uint32_t DjiTest_MopMuxGetFrameLen(const T_DjiTestMopMux *mux, const T_DjiTestMopMuxStream *stream);
+static void DjiTest_MopMuxPutHeader(uint8_t *buffer, uint8_t type, uint8_t flags, uint16_t streamId, uint32_t len);
+static T_DjiReturnCode DjiTest_MopMuxParseHeader(T_DjiTestMopMux *mux);
+static void DjiTest_MopMuxInputData(T_DjiTestMopMux *mux, const uint8_t *data, uint32_t len);
+static void DjiTest_MopMuxEndFrame(T_DjiTestMopMux *mux);
+static void *DjiTest_MopMuxIoTask(void *arg);
+static void *DjiTest_MopMuxPumpTask(void *arg);
+static T_DjiReturnCode DjiTest_MopMuxMopSend(void *userData, const uint8_t *data, uint32_t len, uint32_t *realLen);
+static T_DjiReturnCode DjiTest_MopMuxMopRecv(void *userData, uint8_t *data, uint32_t len, uint32_t *realLen);
+static T_DjiReturnCode DjiTest_MopMuxMopClose(void *userData);
+static T_DjiReturnCode DjiTest_MopMuxLoopbackSend(void *userData, const uint8_t *data, uint32_t len,
+                                                  uint32_t *realLen);
+
+/* Private values ------------------------------------------------------------*/
+
+/* Exported functions definition ---------------------------------------------*/
+void DjiTest_MopMuxGetDefaultConfig(T_DjiTestMopMuxConfig *config)
+{
+    memset(config, 0, sizeof(T_DjiTestMopMuxConfig));
+
+    config->streamCount = 8;
+    config->initialWindow = 64 * 1024;
+    config->maxFrameSize = 8 * 1024;
+    config->maxMessageSize = 1024 * 1024;
+    config->sendQueueSize = 256 * 1024;
+    config->recvBufferSize = 64 * 1024;
+    config->pollIntervalMs = 50;
+}
+
+void DjiTest_MopMuxGetMopTransport(T_DjiMopChannelHandle channelHandle, T_DjiTestMopMuxTransport *transport)
+{
+    transport->Send = DjiTest_MopMuxMopSend;
+    transport->Recv = DjiTest_MopMuxMopRecv;
+    transport->Close = DjiTest_MopMuxMopClose;
+    transport->userData = channelHandle;
+}
+
+T_DjiReturnCode DjiTest_MopMuxInit(T_DjiTestMopMux *mux, const T_DjiTestMopMuxConfig *config,
+                                   const T_DjiTestMopMuxTransport *transport)
+{
+    T_DjiOsalHandler *osalHandler = DjiPlatform_GetOsalHandler();
+    T_DjiReturnCode returnCode;
+
+    if (mux == NULL || config == NULL || transport == NULL || transport->Send == NULL ||
+        (transport->Recv != NULL && transport->Close == NULL) ||
+        config->streamCount == 0 || config->streamCount > DJI_TEST_MOP_MUX_STREAM_MAX_NUM ||
+        config->maxFrameSize == 0 || config->initialWindow < config->maxFrameSize ||
+        config->maxMessageSize == 0 || config->recvBufferSize == 0 || config->callbacks.OnMessage == NULL) {
+        return DJI_ERROR_SYSTEM_MODULE_CODE_INVALID_PARAMETER;
+    }
+
+    memset(mux, 0, sizeof(T_DjiTestMopMux));
+    mux->config = *config;
+    mux->transport = *transport;
+
+    mux->txBuffer = osalHandler->Malloc(DJI_TEST_MOP_MUX_FRAME_HEADER_SIZE + config->maxFrameSize);
+    if (mux->txBuffer == NULL) {
+        return DJI_ERROR_SYSTEM_MODULE_CODE_MEMORY_ALLOC_FAILED;
+    }
+
+    returnCode = osalHandler->MutexCreate(&mux->mutex);
+    if (returnCode != DJI_ERROR_SYSTEM_MODULE_CODE_SUCCESS) {
+        USER_LOG_ERROR("Create mop mux mutex error: 0x%08llX.", returnCode);
+        goto freeTxBuffer;
+    }
+
+    returnCode = osalHandler->SemaphoreCreate(0, &mux->wakeSema);
+    if (returnCode != DJI_ERROR_SYSTEM_MODULE_CODE_SUCCESS) {
+        USER_LOG_ERROR("Create mop mux semaphore error: 0x%08llX.", returnCode);
+        goto destroyMutex;
+    }
+
+    return DJI_ERROR_SYSTEM_MODULE_CODE_SUCCESS;
+
+destroyMutex:
+    osalHandler->MutexDestroy(mux->mutex);
+freeTxBuffer:
+    osalHandler->Free(mux->txBuffer);
+    memset(mux, 0, sizeof(T_DjiTestMopMux));
+
+    return returnCode;
+}
+
+T_DjiReturnCode DjiTest_MopMuxDeInit(T_DjiTestMopMux *mux)
+{
+    T_DjiOsalHandler *osalHandler = DjiPlatform_GetOsalHandler();
+    uint32_t i;
+
+    if (mux == NULL || mux->mutex == NULL) {
+        return DJI_ERROR_SYSTEM_MODULE_CODE_INVALID_PARAMETER;
+    }
+
+    if (mux->isRunning) {
+        DjiTest_MopMuxStop(mux);
+    }
+
+    for (i = 0; i < mux->config.streamCount; i++) {
+        DjiTest_MopMuxFreeStream(&mux->streams[i]);
+    }
+
+    osalHandler->SemaphoreDestroy(mux->wakeSema);
+    osalHandler->MutexDestroy(mux->mutex);
+    osalHandler->Free(mux->txBuffer);
+    memset(mux, 0, sizeof(T_DjiTestMopMux));
+
+    return DJI_ERROR_SYSTEM_MODULE_CODE_SUCCESS;
+}
+
+T_DjiReturnCode DjiTest_MopMuxStart(T_DjiTestMopMux *mux)
+{
+    T_DjiOsalHandler *osalHandler = DjiPlatform_GetOsalHandler();
+    T_DjiReturnCode returnCode;
+
+    if (mux == NULL || mux->mutex == NULL || mux->isRunning) {
+        return DJI_ERROR_SYSTEM_MODULE_CODE_INVALID_PARAMETER;
+    }
+
+    returnCode = osalHandler->SemaphoreCreate(0, &mux->ioStoppedSema);
+    if (returnCode != DJI_ERROR_SYSTEM_MODULE_CODE_SUCCESS) {
+        return returnCode;
+    }
+
+    if (mux->transport.Recv != NULL) {
+        mux->pumpBuffer = osalHandler->Malloc(mux->config.recvBufferSize);
+        if (mux->pumpBuffer == NULL) {
+            returnCode = DJI_ERROR_SYSTEM_MODULE_CODE_MEMORY_ALLOC_FAILED;
+            goto destroyStoppedSema;
+        }
+
+        returnCode = osalHandler->SemaphoreCreate(0, &mux->pumpSpaceSema);
+        if (returnCode != DJI_ERROR_SYSTEM_MODULE_CODE_SUCCESS) {
+            goto freePumpBuffer;
+        }
+
+        returnCode = osalHandler->SemaphoreCreate(0, &mux->pumpStoppedSema);
+        if (returnCode != DJI_ERROR_SYSTEM_MODULE_CODE_SUCCESS) {
+            goto destroyPumpSema;
+        }
+    }
+
+    mux->isRunning = true;
+    returnCode = osalHandler->TaskCreate("mop_mux_io", DjiTest_MopMuxIoTask, DJI_TEST_MOP_MUX_TASK_STACK_SIZE, mux,
+                                         &mux->ioTask);
+    if (returnCode != DJI_ERROR_SYSTEM_MODULE_CODE_SUCCESS) {
+        USER_LOG_ERROR("Create mop mux io task error: 0x%08llX.", returnCode);
+        mux->isRunning = false;
+        goto destroyPumpStoppedSema;
+    }
+
+    if (mux->transport.Recv != NULL) {
+        returnCode = osalHandler->TaskCreate("mop_mux_pump", DjiTest_MopMuxPumpTask, DJI_TEST_MOP_MUX_TASK_STACK_SIZE,
+                                             mux, &mux->pumpTask);
+        if (returnCode != DJI_ERROR_SYSTEM_MODULE_CODE_SUCCESS) {
+            USER_LOG_ERROR("Create mop mux pump task error: 0x%08llX.", returnCode);
+            DjiTest_MopMuxStop(mux);
+            return returnCode;
+        }
+    }
+
+    return DJI_ERROR_SYSTEM_MODULE_CODE_SUCCESS;
+
+destroyPumpStoppedSema:
+    if (mux->pumpStoppedSema != NULL) {
+        osalHandler->SemaphoreDestroy(mux->pumpStoppedSema);
+        mux->pumpStoppedSema = NULL;
+    }
+destroyPumpSema:
+    if (mux->pumpSpaceSema != NULL) {
+        osalHandler->SemaphoreDestroy(mux->pumpSpaceSema);
+        mux->pumpSpaceSema = NULL;
+    }
+freePumpBuffer:
+    if (mux->pumpBuffer != NULL) {
+        osalHandler->Free(mux->pumpBuffer);
+        mux->pumpBuffer = NULL;
+    }
+destroyStoppedSema:
+    osalHandler->SemaphoreDestroy(mux->ioStoppedSema);
+    mux->ioStoppedSema = NULL;
+
+    return returnCode;
+}
+
+T_DjiReturnCode DjiTest_MopMuxStop(T_DjiTestMopMux *mux)
+{
+    T_DjiOsalHandler *osalHandler = DjiPlatform_GetOsalHandler();
+
+    if (mux == NULL || !mux->isRunning) {
+        return DJI_ERROR_SYSTEM_MODULE_CODE_INVALID_PARAMETER;
+    }
+
+    /* The io task leaves its loop between two events. The pump may be blocked in the transport, closing it makes Recv
+     * fail, or waiting for queue space, which is posted. Both tasks have left their loops before anything they use
+     * is freed. */
+    osalHandler->MutexLock(mux->mutex);
+    mux->isRunning = false;
+    osalHandler->MutexUnlock(mux->mutex);
+    osalHandler->SemaphorePost(mux->wakeSema);
+    if (mux->pumpTask != NULL) {
+        mux->transport.Close(mux->transport.userData);
+        osalHandler->SemaphorePost(mux->pumpSpaceSema);
+    }
+
+    osalHandler->SemaphoreWait(mux->ioStoppedSema);
+    osalHandler->TaskDestroy(mux->ioTask);
+    mux->ioTask = NULL;
+
+    if (mux->pumpTask != NULL) {
+        osalHandler->SemaphoreWait(mux->pumpStoppedSema);
+        osalHandler->TaskDestroy(mux->pumpTask);
+        mux->pumpTask = NULL;
+    }
+    if (mux->pumpStoppedSema != NULL) {
+        osalHandler->SemaphoreDestroy(mux->pumpStoppedSema);
+        mux->pumpStoppedSema = NULL;
+    }
+    if (mux->pumpSpaceSema != NULL) {
+        osalHandler->SemaphoreDestroy(mux->pumpSpaceSema);
+        mux->pumpSpaceSema = NULL;
+    }
+    if (mux->pumpBuffer != NULL) {
+        osalHandler->Free(mux->pumpBuffer);
+        mux->pumpBuffer = NULL;
+    }
+    DjiTest_MopMuxFreeMessages(mux->rxChunkHead);
+    mux->rxChunkHead = NULL;
+    mux->rxChunkTail = NULL;
+    mux->rxChunkBytes = 0;
+    mux->isPumpWaiting = false;
+
+    osalHandler->SemaphoreDestroy(mux->ioStoppedSema);
+    mux->ioStoppedSema = NULL;
+
+    return DJI_ERROR_SYSTEM_MODULE_CODE_SUCCESS;
+}
+
+/**
+ * @brief Open a stream, or change its priority when it is already open.
+ * @note Streams are identified by numbers both sides agree on, there is no handshake.
+ */
+T_DjiReturnCode DjiTest_MopMuxOpenStream(T_DjiTestMopMux *mux, uint16_t streamId, uint8_t priority)
+{
+    T_DjiOsalHandler *osalHandler = DjiPlatform_GetOsalHandler();
+    T_DjiTestMopMuxStream *stream;
+
+    if (mux == NULL || mux->mutex == NULL || priority > DJI_TEST_MOP_MUX_PRIORITY_MAX) {
+        return DJI_ERROR_SYSTEM_MODULE_CODE_INVALID_PARAMETER;
+    }
+
+    osalHandler->MutexLock(mux->mutex);
+    stream = DjiTest_MopMuxFindStream(mux, streamId);
+    if (stream != NULL) {
+        stream->priority = priority;
+    } else {
+        stream = DjiTest_MopMuxAddStream(mux, streamId, priority);
+    }
+    osalHandler->MutexUnlock(mux->mutex);
+
+    return stream != NULL ? DJI_ERROR_SYSTEM_MODULE_CODE_SUCCESS : DJI_ERROR_SYSTEM_MODULE_CODE_OUT_OF_RANGE;
+}
+
+T_DjiReturnCode DjiTest_MopMuxCloseStream(T_DjiTestMopMux *mux, uint16_t streamId)
+{
+    T_DjiOsalHandler *osalHandler = DjiPlatform_GetOsalHandler();
+    T_DjiTestMopMuxStream *stream;
+
+    if (mux == NULL || mux->mutex == NULL) {
+        return DJI_ERROR_SYSTEM_MODULE_CODE_INVALID_PARAMETER;
+    }
+
+    osalHandler->MutexLock(mux->mutex);
+    stream = DjiTest_MopMuxFindStream(mux, streamId);
+    if (stream != NULL) {
+        DjiTest_MopMuxFreeStream(stream);
+    }
+    osalHandler->MutexUnlock(mux->mutex);
+
+    return stream != NULL ? DJI_ERROR_SYSTEM_MODULE_CODE_SUCCESS : DJI_ERROR_SYSTEM_MODULE_CODE_NOT_FOUND;
+}
+
+/**
+ * @brief Queue a message on a stream, it is delivered to the peer in one OnMessage call.
+ * @note The data is copied. A stream holds at most sendQueueSize bytes, except that a single message of any size up
+ * to maxMessageSize is always accepted into an empty queue.
+ */
+T_DjiReturnCode DjiTest_MopMuxSend(T_DjiTestMopMux *mux, uint16_t streamId, const uint8_t *data, uint32_t len)
+{
+    T_DjiOsalHandler *osalHandler = DjiPlatform_GetOsalHandler();
+    T_DjiTestMopMuxStream *stream;
+    T_DjiTestMopMuxMessage *message;
+    T_DjiReturnCode returnCode = DJI_ERROR_SYSTEM_MODULE_CODE_SUCCESS;
+
+    if (mux == NULL || mux->mutex == NULL || (data == NULL && len > 0)) {
+        return DJI_ERROR_SYSTEM_MODULE_CODE_INVALID_PARAMETER;
+    }
+    if (len > mux->config.maxMessageSize) {
+        return DJI_ERROR_SYSTEM_MODULE_CODE_OUT_OF_RANGE;
+    }
+
+    osalHandler->MutexLock(mux->mutex);
+
+    stream = DjiTest_MopMuxFindStream(mux, streamId);
+    if (stream == NULL) {
+        returnCode = DJI_ERROR_SYSTEM_MODULE_CODE_NOT_FOUND;
+        goto unlock;
+    }
+    if (stream->head != NULL && stream->queuedBytes + len > mux->config.sendQueueSize) {
+        returnCode = DJI_ERROR_SYSTEM_MODULE_CODE_BUSY;
+        goto unlock;
+    }
+
+    message = osalHandler->Malloc(sizeof(T_DjiTestMopMuxMessage) + len);
+    if (message == NULL) {
+        returnCode = DJI_ERROR_SYSTEM_MODULE_CODE_MEMORY_ALLOC_FAILED;
+        goto unlock;
+    }
+    message->next = NULL;
+    message->len = len;
+    message->offset = 0;
+    if (len > 0) {
+        memcpy(message->data, data, len);
+    }
+
+    if (stream->tail != NULL) {
+        stream->tail->next = message;
+    } else {
+        stream->head = message;
+    }
+    stream->tail = message;
+    stream->queuedBytes += len;
+
+unlock:
+    osalHandler->MutexUnlock(mux->mutex);
+
+    if (returnCode == DJI_ERROR_SYSTEM_MODULE_CODE_SUCCESS && mux->isRunning) {
+        osalHandler->SemaphorePost(mux->wakeSema);
+    }
+
+    return returnCode;
+}
+
+void DjiTest_MopMuxGetStatistics(T_DjiTestMopMux *mux, T_DjiTestMopMuxStatistics *statistics)
+{
+    T_DjiOsalHandler *osalHandler = DjiPlatform_GetOsalHandler();
+    T_DjiTestMopMuxStream *stream;
+    uint32_t i;
+
+    osalHandler->MutexLock(mux->mutex);
+
+    *statistics = mux->statistics;
+    statistics->streamCount = 0;
+    for (i = 0; i < mux->config.streamCount; i++) {
+        stream = &mux->streams[i];
+        if (!stream->isUsed) {
+            continue;
+        }
+
+        stream->statistics.streamId = stream->streamId;
+        stream->statistics.priority = stream->priority;
+        stream->statistics.sendCredit = stream->sendCredit;
+        stream->statistics.queuedBytes = stream->queuedBytes;
+        statistics->streams[statistics->streamCount++] = stream->statistics;
+    }
+
+    osalHandler->MutexUnlock(mux->mutex);
+}
+
+/**
+ * @brief Feed bytes received from the transport, complete messages are passed to OnMessage before it returns.
+ */
+T_DjiReturnCode DjiTest_MopMuxInput(T_DjiTestMopMux *mux, const uint8_t *data, uint32_t len)
+{
+    T_DjiOsalHandler *osalHandler = DjiPlatform_GetOsalHandler();
+    T_DjiReturnCode returnCode = DJI_ERROR_SYSTEM_MODULE_CODE_SUCCESS;
+    uint32_t copyLen;
+    bool isRunning;
+
+    if (mux == NULL || mux->mutex == NULL || (data == NULL && len > 0)) {
+        return DJI_ERROR_SYSTEM_MODULE_CODE_INVALID_PARAMETER;
+    }
+
+    osalHandler->MutexLock(mux->mutex);
+
+    while (len > 0 && !mux->isBroken) {
+        if (mux->rxHeaderLen < DJI_TEST_MOP_MUX_FRAME_HEADER_SIZE) {
+            copyLen = USER_UTIL_MIN(len, DJI_TEST_MOP_MUX_FRAME_HEADER_SIZE - mux->rxHeaderLen);
+            memcpy(&mux->rxHeader[mux->rxHeaderLen], data, copyLen);
+            mux->rxHeaderLen += copyLen;
+            data += copyLen;
+            len -= copyLen;
+
+            if (mux->rxHeaderLen == DJI_TEST_MOP_MUX_FRAME_HEADER_SIZE) {
+                returnCode = DjiTest_MopMuxParseHeader(mux);
+                if (returnCode != DJI_ERROR_SYSTEM_MODULE_CODE_SUCCESS) {
+                    break;
+                }
+                if (mux->rxPayloadLen == 0) {
+                    DjiTest_MopMuxEndFrame(mux);
+                }
+            }
+            continue;
+        }
+
+        copyLen = USER_UTIL_MIN(len, mux->rxPayloadLen - mux->rxPayloadOffset);
+        if (mux->rxType == DJI_TEST_MOP_MUX_FRAME_WINDOW) {
+            memcpy(&mux->rxWindow[mux->rxPayloadOffset], data, copyLen);
+        } else {
+            DjiTest_MopMuxInputData(mux, data, copyLen);
+        }
+        mux->rxPayloadOffset += copyLen;
+        data += copyLen;
+        len -= copyLen;
+
+        if (mux->rxPayloadOffset == mux->rxPayloadLen) {
+            DjiTest_MopMuxEndFrame(mux);
+        }
+    }
+
+    if (mux->isBroken) {
+        returnCode = DJI_ERROR_SYSTEM_MODULE_CODE_SYSTEM_ERROR;
+    }
+    isRunning = mux->isRunning;
+
+    osalHandler->MutexUnlock(mux->mutex);
+
+    /* Consumed data owes the peer a window update, which a started mux only sends from its io task. */
+    if (isRunning) {
+        osalHandler->SemaphorePost(mux->wakeSema);
+    }
+
+    return returnCode;
+}
+
+/**
+ * @brief Write pending frames to the transport until nothing is sendable or the transport is full.
+ * @return Busy when the transport took part of a frame only, the caller should poll again soon.
+ */
+T_DjiReturnCode DjiTest_MopMuxPoll(T_DjiTestMopMux *mux)
+{
+    T_DjiOsalHandler *osalHandler = DjiPlatform_GetOsalHandler();
+    T_DjiReturnCode returnCode = DJI_ERROR_SYSTEM_MODULE_CODE_SUCCESS;
+    uint32_t realLen;
+
+    if (mux == NULL || mux->mutex == NULL) {
+        return DJI_ERROR_SYSTEM_MODULE_CODE_INVALID_PARAMETER;
+    }
+
+    osalHandler->MutexLock(mux->mutex);
+
+    while (1) {
+        if (mux->txOffset == mux->txLen &&
+            !DjiTest_MopMuxBuildWindowFrame(mux) && !DjiTest_MopMuxBuildDataFrame(mux)) {
+            break;
+        }
+
+        /* Only the io task touches the frame buffer, the lock is released so the transport may block. */
+        osalHandler->MutexUnlock(mux->mutex);
+        realLen = 0;
+        returnCode = mux->transport.Send(mux->transport.userData, mux->txBuffer + mux->txOffset,
+                                         mux->txLen - mux->txOffset, &realLen);
+        osalHandler->MutexLock(mux->mutex);
+
+        if (returnCode != DJI_ERROR_SYSTEM_MODULE_CODE_SUCCESS) {
+            break;
+        }
+
+        mux->txOffset += USER_UTIL_MIN(realLen, mux->txLen - mux->txOffset);
+        mux->statistics.sentWireBytes += realLen;
+        if (mux->txOffset < mux->txLen) {
+            returnCode = DJI_ERROR_SYSTEM_MODULE_CODE_BUSY;
+            break;
+        }
+        mux->statistics.sentFrameCount++;
+        mux->txOffset = 0;
+        mux->txLen = 0;
+    }
+
+    osalHandler->MutexUnlock(mux->mutex);
+
+    return returnCode;
+}
+
+void DjiTest_MopMuxLoopbackInit(T_DjiTestMopMuxLoopback *loopback, T_DjiTestMopMux *peer, uint32_t bytesPerTick)
+{
+    loopback->peer = peer;
+    loopback->bytesPerTick = bytesPerTick;
+    loopback->budget = bytesPerTick;
+}
+
+void DjiTest_MopMuxLoopbackGetTransport(T_DjiTestMopMuxLoopback *loopback, T_DjiTestMopMuxTransport *transport)
+{
+    transport->Send = DjiTest_MopMuxLoopbackSend;
+    transport->Recv = NULL;
+    transport->Close = NULL;
+    transport->userData = loopback;
+}
+
+void DjiTest_MopMuxLoopbackTick(T_DjiTestMopMuxLoopback *loopback)
+{
+    loopback->budget = loopback->bytesPerTick;
+}
+
+/* Private functions definition-----------------------------------------------*/
+static T_DjiTestMopMuxStream *DjiTest_MopMuxFindStream(T_DjiTestMopMux *mux, uint16_t streamId)
+{
+    uint32_t i;
+
+    for (i = 0; i < mux->config.streamCount; i++) {
+        if (mux->streams[i].isUsed && mux->streams[i].streamId == streamId) {
+            return &mux->streams[i];
+        }
+    }
+
+    return NULL;
+}
+
+static T_DjiTestMopMuxStream *DjiTest_MopMuxAddStream(T_DjiTestMopMux *mux, uint16_t streamId, uint8_t priority)
+{
+    T_DjiTestMopMuxStream *stream;
+    uint32_t i;
+
+    for (i = 0; i < mux->config.streamCount; i++) {
+        stream = &mux->streams[i];
+        if (stream->isUsed) {
+            continue;
+        }
+
+        memset(stream, 0, sizeof(T_DjiTestMopMuxStream));
+        stream->isUsed = true;
+        stream->streamId = streamId;
+        stream->priority = priority;
+        stream->sendCredit = mux->config.initialWindow;
+        stream->recvWindow = mux->config.initialWindow;
+
+        return stream;
+    }
+
+    return NULL;
+}
+
+static void DjiTest_MopMuxFreeStream(T_DjiTestMopMuxStream *stream)
+{
+    T_DjiOsalHandler *osalHandler = DjiPlatform_GetOsalHandler();
+
+    DjiTest_MopMuxFreeMessages(stream->head);
+    if (stream->recvBuffer != NULL) {
+        osalHandler->Free(stream->recvBuffer);
+    }
+
+    memset(stream, 0, sizeof(T_DjiTestMopMuxStream));
+}
+
+static void DjiTest_MopMuxFreeMessages(T_DjiTestMopMuxMessage *message)
+{
+    T_DjiOsalHandler *osalHandler = DjiPlatform_GetOsalHandler();
+    T_DjiTestMopMuxMessage *next;
+
+    while (message != NULL) {
+        next = message->next;
+        osalHandler->Free(message);
+        message = next;
+    }
+}
+
+static bool DjiTest_MopMuxBuildWindowFrame(T_DjiTestMopMux *mux)
+{
+    T_DjiTestMopMuxStream *stream;
+    uint32_t credit;
+    uint32_t i;
+
+    /* Credit goes back in batches of half a window, the peer keeps sending meanwhile on the other half. */
+    for (i = 0; i < mux->config.streamCount; i++) {
+        stream = &mux->streams[i];
+        if (!stream->isUsed || stream->pendingCredit < mux->config.initialWindow / 2) {
+            continue;
+        }
+
+        credit = stream->pendingCredit;
+        stream->pendingCredit = 0;
+        stream->recvWindow += credit;
+
+        DjiTest_MopMuxPutHeader(mux->txBuffer, DJI_TEST_MOP_MUX_FRAME_WINDOW, 0, stream->streamId, sizeof(uint32_t));
+        mux->txBuffer[DJI_TEST_MOP_MUX_FRAME_HEADER_SIZE] = (uint8_t) credit;
+        mux->txBuffer[DJI_TEST_MOP_MUX_FRAME_HEADER_SIZE + 1] = (uint8_t) (credit >> 8);
+        mux->txBuffer[DJI_TEST_MOP_MUX_FRAME_HEADER_SIZE + 2] = (uint8_t) (credit >> 16);
+        mux->txBuffer[DJI_TEST_MOP_MUX_FRAME_HEADER_SIZE + 3] = (uint8_t) (credit >> 24);
+        mux->txLen = DJI_TEST_MOP_MUX_FRAME_HEADER_SIZE + sizeof(uint32_t);
+        mux->txOffset = 0;
+        mux->statistics.windowFrameCount++;
+
+        return true;
+    }
+
+    return false;
+}
+
+static bool DjiTest_MopMuxBuildDataFrame(T_DjiTestMopMux *mux)
+{
+    T_DjiOsalHandler *osalHandler = DjiPlatform_GetOsalHandler();
+    T_DjiTestMopMuxStream *stream;
+    T_DjiTestMopMuxMessage *message;
+    uint32_t frameLen = 0;
+    uint8_t flags = 0;
+    uint32_t visited;
+
+    /* Deficit round robin: a stream gets (priority + 1) frames worth of bytes per turn, unused bytes carry over while
+     * it stays backlogged. */
+    for (visited = 0; visited <= mux->config.streamCount; visited++) {
+        stream = &mux->streams[mux->nextStream];
+        if (stream->isUsed && stream->head != NULL) {
+            frameLen = DjiTest_MopMuxGetFrameLen(mux, stream);
+            if (frameLen == 0 && stream->head->len > stream->head->offset) {
+                stream->statistics.creditStallCount++;
+            } else {
+                if (!stream->isVisited) {
+                    stream->deficit += (stream->priority + 1) * mux->config.maxFrameSize;
+                    stream->isVisited = true;
+                }
+                if (stream->deficit >= frameLen) {
+                    break;
+                }
+            }
+        } else if (stream->isUsed) {
+            stream->deficit = 0;
+        }
+
+        stream->isVisited = false;
+        mux->nextStream = (mux->nextStream + 1) % mux->config.streamCount;
+    }
+    if (visited > mux->config.streamCount) {
+        return false;
+    }
+
+    message = stream->head;
+    DjiTest_MopMuxPutHeader(mux->txBuffer, DJI_TEST_MOP_MUX_FRAME_DATA, 0, stream->streamId, frameLen);
+    memcpy(mux->txBuffer + DJI_TEST_MOP_MUX_FRAME_HEADER_SIZE, message->data + message->offset, frameLen);
+    mux->txLen = DJI_TEST_MOP_MUX_FRAME_HEADER_SIZE + frameLen;
+    mux->txOffset = 0;
+
+    message->offset += frameLen;
+    stream->deficit -= frameLen;
+    stream->sendCredit -= frameLen;
+    stream->queuedBytes -= frameLen;
+    stream->statistics.sentBytes += frameLen;
+
+    if (message->offset == message->len) {
+        flags = DJI_TEST_MOP_MUX_FRAME_FLAG_END;
+        mux->txBuffer[1] = flags;
+        stream->head = message->next;
+        if (stream->head == NULL) {
+            stream->tail = NULL;
+        }
+        stream->statistics.sentMessageCount++;
+        osalHandler->Free(message);
+    }
+
+    return true;
+}
+
+static uint32_t DjiTest_MopMuxGetFrameLen(const T_DjiTestMopMux *mux, const T_DjiTestMopMuxStream *stream)
+{
+    uint32_t frameLen = stream->head->len - stream->head->offset;
+
+    frameLen = USER_UTIL_MIN(frameLen, mux->config.maxFrameSize);
+    frameLen = USER_UTIL_MIN(frameLen, stream->sendCredit);
+
+    return frameLen;
+}
+
+static void DjiTest_MopMuxPutHeader(uint8_t *buffer, uint8_t type, uint8_t flags, uint16_t streamId, uint32_t len)
+{
+    buffer[0] = type;
+    buffer[1] = flags;
+    buffer[2] = (uint8_t) streamId;
+    buffer[3] = (uint8_t) (streamId >> 8);
+    buffer[4] = (uint8_t) len;
+    buffer[5] = (uint8_t) (len >> 8);
+    buffer[6] = (uint8_t) (len >> 16);
+    buffer[7] = (uint8_t) (len >> 24);
+}
+
+static T_DjiReturnCode DjiTest_MopMuxParseHeader(T_DjiTestMopMux *mux)
+{
+    T_DjiOsalHandler *osalHandler = DjiPlatform_GetOsalHandler();
+    T_DjiTestMopMuxStream *stream;
+    uint32_t len;
+
+    mux->rxType = mux->rxHeader[0];
+    mux->rxFlags = mux->rxHeader[1];
+    mux->rxStreamId = (uint16_t) (mux->rxHeader[2] | (mux->rxHeader[3] << 8));
+    len = (uint32_t) mux->rxHeader[4] | ((uint32_t) mux->rxHeader[5] << 8) | ((uint32_t) mux->rxHeader[6] << 16) |
+          ((uint32_t) mux->rxHeader[7] << 24);
+    mux->rxPayloadLen = len;
+    mux->rxPayloadOffset = 0;
+
+    if (mux->rxType == DJI_TEST_MOP_MUX_FRAME_WINDOW) {
+        if (len != sizeof(uint32_t)) {
+            goto protocolError;
+        }
+        return DJI_ERROR_SYSTEM_MODULE_CODE_SUCCESS;
+    }
+    if (mux->rxType != DJI_TEST_MOP_MUX_FRAME_DATA) {
+        goto protocolError;
+    }
+
+    stream = DjiTest_MopMuxFindStream(mux, mux->rxStreamId);
+    if (stream == NULL) {
+        stream = DjiTest_MopMuxAddStream(mux, mux->rxStreamId, DJI_TEST_MOP_MUX_PRIORITY_DEFAULT);
+        if (stream == NULL) {
+            USER_LOG_ERROR("No room for mop mux stream %d.", mux->rxStreamId);
+            goto protocolError;
+        }
+        if (mux->config.callbacks.OnStreamOpen != NULL) {
+            osalHandler->MutexUnlock(mux->mutex);
+            mux->config.callbacks.OnStreamOpen(mux->config.callbacks.userData, mux->rxStreamId);
+            osalHandler->MutexLock(mux->mutex);
+        }
+    }
+
+    /* The peer must never exceed the credit granted, anything else means both sides lost the frame boundary. */
+    stream = DjiTest_MopMuxFindStream(mux, mux->rxStreamId);
+    if (stream != NULL) {
+        if (len > stream->recvWindow) {
+            goto protocolError;
+        }
+        stream->recvWindow -= len;
+    }
+
+    return DJI_ERROR_SYSTEM_MODULE_CODE_SUCCESS;
+
+protocolError:
+    USER_LOG_ERROR("Mop mux protocol error, frame type %d stream %d length %u.", mux->rxType, mux->rxStreamId, len);
+    mux->isBroken = true;
+    mux->statistics.protocolErrorCount++;
+
+    return DJI_ERROR_SYSTEM_MODULE_CODE_SYSTEM_ERROR;
+}
+
+static void DjiTest_MopMuxInputData(T_DjiTestMopMux *mux, const uint8_t *data, uint32_t len)
+{
+    T_DjiOsalHandler *osalHandler = DjiPlatform_GetOsalHandler();
+    T_DjiTestMopMuxStream *stream;
+    uint32_t capacity;
+    uint8_t *buffer;
+
+    /* A stream closed locally in the middle of a frame swallows the rest of it. */
+    stream = DjiTest_MopMuxFindStream(mux, mux->rxStreamId);
+    if (stream == NULL) {
+        return;
+    }
+
+    stream->pendingCredit += len;
+    stream->statistics.receivedBytes += len;
+
+    if (stream->isDiscarding) {
+        return;
+    }
+    if (stream->recvLen + len > mux->config.maxMessageSize) {
+        stream->isDiscarding = true;
+        stream->recvLen = 0;
+        return;
+    }
+
+    if (stream->recvLen + len > stream->recvCapacity) {
+        capacity = stream->recvCapacity != 0 ? stream->recvCapacity : mux->config.maxFrameSize;
+        while (capacity < stream->recvLen + len) {
+            capacity = capacity <= mux->config.maxMessageSize / 2 ? capacity * 2 : mux->config.maxMessageSize;
+        }
+
+        buffer = osalHandler->Malloc(capacity);
+        if (buffer == NULL) {
+            stream->isDiscarding = true;
+            stream->recvLen = 0;
+            return;
+        }
+        if (stream->recvBuffer != NULL) {
+            memcpy(buffer, stream->recvBuffer, stream->recvLen);
+            osalHandler->Free(stream->recvBuffer);
+        }
+        stream->recvBuffer = buffer;
+        stream->recvCapacity = capacity;
+    }
+
+    memcpy(stream->recvBuffer + stream->recvLen, data, len);
+    stream->recvLen += len;
+}
+
+static void DjiTest_MopMuxEndFrame(T_DjiTestMopMux *mux)
+{
+    T_DjiOsalHandler *osalHandler = DjiPlatform_GetOsalHandler();
+    T_DjiTestMopMuxStream *stream;
+    uint16_t streamId = mux->rxStreamId;
+    uint8_t *buffer;
+    uint32_t capacity;
+    uint32_t len;
+    uint32_t credit;
+
+    mux->rxHeaderLen = 0;
+    mux->statistics.receivedFrameCount++;
+
+    stream = DjiTest_MopMuxFindStream(mux, streamId);
+    if (stream == NULL) {
+        return;
+    }
+
+    if (mux->rxType == DJI_TEST_MOP_MUX_FRAME_WINDOW) {
+        credit = (uint32_t) mux->rxWindow[0] | ((uint32_t) mux->rxWindow[1] << 8) |
+                 ((uint32_t) mux->rxWindow[2] << 16) | ((uint32_t) mux->rxWindow[3] << 24);
+        stream->sendCredit += credit;
+        return;
+    }
+
+    if ((mux->rxFlags & DJI_TEST_MOP_MUX_FRAME_FLAG_END) == 0) {
+        return;
+    }
+
+    if (stream->isDiscarding) {
+        stream->isDiscarding = false;
+        stream->statistics.discardedMessageCount++;
+        USER_LOG_WARN("Discard message of mop mux stream %d larger than %u bytes.", streamId,
+                      mux->config.maxMessageSize);
+        return;
+    }
+
+    /* The buffer is lent to the callback without the lock, a stream closed meanwhile no longer owns it. */
+    buffer = stream->recvBuffer;
+    capacity = stream->recvCapacity;
+    len = stream->recvLen;
+    stream->recvBuffer = NULL;
+    stream->recvCapacity = 0;
+    stream->recvLen = 0;
+    stream->statistics.receivedMessageCount++;
+
+    osalHandler->MutexUnlock(mux->mutex);
+    mux->config.callbacks.OnMessage(mux->config.callbacks.userData, streamId, buffer, len);
+    osalHandler->MutexLock(mux->mutex);
+
+    stream = DjiTest_MopMuxFindStream(mux, streamId);
+    if (stream != NULL && stream->recvBuffer == NULL) {
+        stream->recvBuffer = buffer;
+        stream->recvCapacity = capacity;
+    } else if (buffer != NULL) {
+        osalHandler->Free(buffer);
+    }
+}
+
+static void *DjiTest_MopMuxIoTask(void *arg)
+{
+    T_DjiTestMopMux *mux = arg;
+    T_DjiOsalHandler *osalHandler = DjiPlatform_GetOsalHandler();
+    T_DjiReturnCode returnCode = DJI_ERROR_SYSTEM_MODULE_CODE_SUCCESS;
+    T_DjiTestMopMuxMessage *chunk;
+    T_DjiTestMopMuxMessage *next;
+    bool isPumpWaiting;
+
+    while (1) {
+        osalHandler->SemaphoreTimedWait(mux->wakeSema, returnCode == DJI_ERROR_SYSTEM_MODULE_CODE_BUSY ?
+                                                       DJI_TEST_MOP_MUX_BUSY_RETRY_MS : mux->config.pollIntervalMs);
+
+        osalHandler->MutexLock(mux->mutex);
+        if (!mux->isRunning) {
+            osalHandler->MutexUnlock(mux->mutex);
+            break;
+        }
+        chunk = mux->rxChunkHead;
+        mux->rxChunkHead = NULL;
+        mux->rxChunkTail = NULL;
+        mux->rxChunkBytes = 0;
+        isPumpWaiting = mux->isPumpWaiting;
+        mux->isPumpWaiting = false;
+        osalHandler->MutexUnlock(mux->mutex);
+
+        if (isPumpWaiting) {
+            osalHandler->SemaphorePost(mux->pumpSpaceSema);
+        }
+
+        while (chunk != NULL) {
+            next = chunk->next;
+            DjiTest_MopMuxInput(mux, chunk->data, chunk->len);
+            osalHandler->Free(chunk);
+            chunk = next;
+        }
+
+        returnCode = DjiTest_MopMuxPoll(mux);
+    }
+
+    osalHandler->SemaphorePost(mux->ioStoppedSema);
+
+    return NULL;
+}
+
+static void *DjiTest_MopMuxPumpTask(void *arg)
+{
+    T_DjiTestMopMux *mux = arg;
+    T_DjiOsalHandler *osalHandler = DjiPlatform_GetOsalHandler();
+    T_DjiTestMopMuxMessage *chunk;
+    T_DjiReturnCode returnCode;
+    uint32_t realLen;
+    bool isRunning;
+    /* What the credit of all streams lets a peer have in flight, plus one read. Only empty messages and window
+     * updates are not bounded by credit, past this the pump stops reading until the io task catches up. */
+    uint32_t queueLimit = mux->config.streamCount * mux->config.initialWindow + mux->config.recvBufferSize;
+
+    while (1) {
+        realLen = 0;
+        returnCode = mux->transport.Recv(mux->transport.userData, mux->pumpBuffer, mux->config.recvBufferSize,
+                                         &realLen);
+        /* A stop closes the transport, that error is not reported as a close. */
+        osalHandler->MutexLock(mux->mutex);
+        isRunning = mux->isRunning;
+        osalHandler->MutexUnlock(mux->mutex);
+        if (!isRunning) {
+            break;
+        }
+        if (returnCode != DJI_ERROR_SYSTEM_MODULE_CODE_SUCCESS) {
+            USER_LOG_WARN("Mop mux transport closed: 0x%08llX.", returnCode);
+            if (mux->config.callbacks.OnClose != NULL) {
+                mux->config.callbacks.OnClose(mux->config.callbacks.userData, returnCode);
+            }
+            break;
+        }
+        if (realLen == 0) {
+            continue;
+        }
+
+        chunk = osalHandler->Malloc(sizeof(T_DjiTestMopMuxMessage) + realLen);
+        if (chunk == NULL) {
+            USER_LOG_ERROR("Mop mux receive chunk malloc error.");
+            osalHandler->TaskSleepMs(DJI_TEST_MOP_MUX_BUSY_RETRY_MS);
+            continue;
+        }
+        chunk->next = NULL;
+        chunk->len = realLen;
+        chunk->offset = 0;
+        memcpy(chunk->data, mux->pumpBuffer, realLen);
+
+        osalHandler->MutexLock(mux->mutex);
+        while (mux->isRunning && mux->rxChunkBytes > 0 && mux->rxChunkBytes + realLen > queueLimit) {
+            mux->isPumpWaiting = true;
+            osalHandler->MutexUnlock(mux->mutex);
+            osalHandler->SemaphorePost(mux->wakeSema);
+            osalHandler->SemaphoreWait(mux->pumpSpaceSema);
+            osalHandler->MutexLock(mux->mutex);
+        }
+        if (!mux->isRunning) {
+            osalHandler->MutexUnlock(mux->mutex);
+            osalHandler->Free(chunk);
+            break;
+        }
+        if (mux->rxChunkTail != NULL) {
+            mux->rxChunkTail->next = chunk;
+        } else {
+            mux->rxChunkHead = chunk;
+        }
+        mux->rxChunkTail = chunk;
+        mux->rxChunkBytes += realLen;
+        osalHandler->MutexUnlock(mux->mutex);
+        osalHandler->SemaphorePost(mux->wakeSema);
+    }
+
+    osalHandler->SemaphorePost(mux->pumpStoppedSema);
+
+    return NULL;
+}
+
+static T_DjiReturnCode DjiTest_MopMuxMopSend(void *userData, const uint8_t *data, uint32_t len, uint32_t *realLen)
+{
+    return DjiMopChannel_SendData((T_DjiMopChannelHandle) userData, (uint8_t *) data, len, realLen);
+}
+
+static T_DjiReturnCode DjiTest_MopMuxMopRecv(void *userData, uint8_t *data, uint32_t len, uint32_t *realLen)
+{
+    return DjiMopChannel_RecvData((T_DjiMopChannelHandle) userData, data, len, realLen);
+}
+
+static T_DjiReturnCode DjiTest_MopMuxMopClose(void *userData)
+{
+    return DjiMopChannel_Close((T_DjiMopChannelHandle) userData);
+}
+
+static T_DjiReturnCode DjiTest_MopMuxLoopbackSend(void *userData, const uint8_t *data, uint32_t len,
+                                                  uint32_t *realLen)
+{
+    T_DjiTestMopMuxLoopback *loopback = userData;
+    uint32_t sendLen = len;
+
+    if (loopback->bytesPerTick != 0) {
+        sendLen = USER_UTIL_MIN(len, loopback->budget);
+        loopback->budget -= sendLen;
+    }
+
+    *realLen = sendLen;
+    if (sendLen == 0) {
+        return DJI_ERROR_SYSTEM_MODULE_CODE_SUCCESS;
+    }
+
+    return DjiTest_MopMuxInput(loopback->peer, data, sendLen);
+}
+
+/****************** (C) COPYRIGHT DJI Innovations *****END OF FILE****/
@@ -0,0 +1,222 @@
+/**
+ ********************************************************************
+ * @file    test_mop_channel_mux.h
+ * @brief   This is the header file for "test_mop_channel_mux.c", defining the structure and
+ * (exported) function prototypes.
+ *
+ * @copyright (c) 2021 DJI. All rights reserved.
+ *
+ * All information contained herein is, and remains, the property of DJI.
+ * The intellectual and technical concepts contained herein are proprietary
+ * to DJI and may be covered by U.S. and foreign patents, patents in process,
+ * and protected by trade secret or copyright law.  Dissemination of this
+ * information, including but not limited to data and other proprietary
+ * material(s) incorporated within the information, in any form, is strictly
+ * prohibited without the express written consent of DJI.
+ *
+ * If you receive this source code without DJI’s authorization, you may not
+ * further disseminate the information, and you must immediately remove the
+ * source code and notify DJI of its removal. DJI reserves the right to pursue
+ * legal actions against you for any loss(es) or damage(s) caused by your
+ * failure to do so.
+ *
+ *********************************************************************
+ */
+
+/* Define to prevent recursive inclusion -------------------------------------*/
+#ifndef TEST_MOP_CHANNEL_MUX_H
+#define TEST_MOP_CHANNEL_MUX_H
+
+/* Includes ------------------------------------------------------------------*/
+#include "dji_typedef.h"
+#include "dji_platform.h"
+#include "dji_mop_channel.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Exported constants --------------------------------------------------------*/
+#define DJI_TEST_MOP_MUX_FRAME_HEADER_SIZE      (8)
+#define DJI_TEST_MOP_MUX_STREAM_MAX_NUM         (32)
+#define DJI_TEST_MOP_MUX_PRIORITY_MAX           (7)
+#define DJI_TEST_MOP_MUX_PRIORITY_DEFAULT       (3)
+
+/* Exported types ------------------------------------------------------------*/
+/**
+ * @brief Frame types on the wire. A frame is a little endian header {type u8, flags u8, streamId u16, length u32}
+ * followed by length bytes.
+ */
+typedef enum {
+    DJI_TEST_MOP_MUX_FRAME_DATA = 1,        /*!< Part of a message, the END flag marks its last part. */
+    DJI_TEST_MOP_MUX_FRAME_WINDOW = 2,      /*!< Grants the peer more send credit on a stream, payload u32 bytes. */
+} E_DjiTestMopMuxFrameType;
+
+#define DJI_TEST_MOP_MUX_FRAME_FLAG_END         (0x01)
+
+/**
+ * @brief The byte stream under the multiplexer, a reliable mop channel or a loopback.
+ * @note Send may accept fewer bytes than given, the rest is retried on the next poll. Recv blocks until data arrives
+ * and is NULL when received data is fed with DjiTest_MopMuxInput instead. Close makes a blocked Recv return an error,
+ * it is required with Recv and called once by DjiTest_MopMuxStop.
+ */
+typedef struct {
+    T_DjiReturnCode (*Send)(void *userData, const uint8_t *data, uint32_t len, uint32_t *realLen);
+    T_DjiReturnCode (*Recv)(void *userData, uint8_t *data, uint32_t len, uint32_t *realLen);
+    T_DjiReturnCode (*Close)(void *userData);
+    void *userData;
+} T_DjiTestMopMuxTransport;
+
+typedef struct {
+    /* A complete message of a stream, data is valid during the call only. */
+    void (*OnMessage)(void *userData, uint16_t streamId, const uint8_t *data, uint32_t len);
+    /* The peer sent on a stream not opened locally, it is opened with the default priority before OnMessage. */
+    void (*OnStreamOpen)(void *userData, uint16_t streamId);
+    /* The transport failed, no more data is received. */
+    void (*OnClose)(void *userData, T_DjiReturnCode returnCode);
+    void *userData;
+} T_DjiTestMopMuxCallbacks;
+
+typedef struct {
+    uint32_t streamCount;           /*!< Streams open at the same time, at most DJI_TEST_MOP_MUX_STREAM_MAX_NUM. */
+    uint32_t initialWindow;         /*!< Credit of a new stream, both sides must use the same value, unit: byte. */
+    uint32_t maxFrameSize;          /*!< Largest payload of a data frame, it bounds the wait of other streams. */
+    uint32_t maxMessageSize;        /*!< Larger received messages are discarded. */
+    uint32_t sendQueueSize;         /*!< Bytes queued per stream before Send returns busy. */
+    uint32_t recvBufferSize;        /*!< Read size of the receive pump. */
+    uint32_t pollIntervalMs;        /*!< Longest sleep of the io task without events. */
+    T_DjiTestMopMuxCallbacks callbacks;
+} T_DjiTestMopMuxConfig;
+
+typedef struct {
+    uint16_t streamId;
+    uint8_t priority;
+    uint32_t sendCredit;            /*!< Bytes the peer still accepts on this stream. */
+    uint32_t queuedBytes;
+    uint32_t sentMessageCount;
+    uint64_t sentBytes;
+    uint32_t receivedMessageCount;
+    uint64_t receivedBytes;
+    uint32_t discardedMessageCount; /*!< Received messages larger than maxMessageSize. */
+    uint32_t creditStallCount;      /*!< Polls that found data queued but no credit. */
+} T_DjiTestMopMuxStreamStatistics;
+
+typedef struct {
+    uint32_t streamCount;
+    T_DjiTestMopMuxStreamStatistics streams[DJI_TEST_MOP_MUX_STREAM_MAX_NUM];
+    uint32_t sentFrameCount;
+    uint32_t receivedFrameCount;
+    uint32_t windowFrameCount;      /*!< Window updates sent. */
+    uint32_t protocolErrorCount;
+    uint64_t sentWireBytes;
+} T_DjiTestMopMuxStatistics;
+
+typedef struct T_DjiTestMopMuxMessage T_DjiTestMopMuxMessage;
+
+typedef struct {
+    bool isUsed;
+    uint16_t streamId;
+    uint8_t priority;
+    /* Send side, the queue is appended by Send and consumed by the io task. */
+    T_DjiTestMopMuxMessage *head;
+    T_DjiTestMopMuxMessage *tail;
+    uint32_t queuedBytes;
+    uint32_t sendCredit;
+    uint32_t deficit;               /*!< Deficit round robin counter, unit: byte. */
+    bool isVisited;                 /*!< The current round robin turn has added its quantum. */
+    /* Receive side, filled by the io task. */
+    uint8_t *recvBuffer;
+    uint32_t recvCapacity;
+    uint32_t recvLen;
+    bool isDiscarding;
+    uint32_t recvWindow;            /*!< Bytes the peer may still send, more is a protocol error. */
+    uint32_t pendingCredit;         /*!< Consumed bytes not yet granted back to the peer. */
+    T_DjiTestMopMuxStreamStatistics statistics;
+} T_DjiTestMopMuxStream;
+
+/**
+ * @brief Carries many logical streams of messages over one reliable byte stream.
+ * @note Each stream has its own send credit granted by the receiver, so a stream the peer does not drain cannot
+ * occupy the link. Streams with data and credit share the link by deficit round robin weighted by priority + 1, in
+ * frames of at most maxFrameSize, window updates go first. All framing, sending and callbacks happen on one io task.
+ * Mop receive blocks, so a pump task reads the channel and queues the chunks for the io task. The pump keeps reading
+ * while the io task is blocked in a send, otherwise two peers sending to each other could wait on each other forever;
+ * the credit bounds what a well-behaved peer can have queued. Send, OpenStream, CloseStream and GetStatistics may be
+ * called from any task, including the callbacks, but a callback must not wait for Send to stop returning busy since
+ * only the io task it runs on drains the queue.
+ */
+typedef struct {
+    T_DjiTestMopMuxConfig config;
+    T_DjiTestMopMuxTransport transport;
+    T_DjiMutexHandle mutex;
+    T_DjiSemaHandle wakeSema;
+    T_DjiTestMopMuxStream streams[DJI_TEST_MOP_MUX_STREAM_MAX_NUM];
+    uint32_t nextStream;
+    /* Frame being written, kept across polls when the transport takes it partially. */
+    uint8_t *txBuffer;
+    uint32_t txLen;
+    uint32_t txOffset;
+    /* Receive parser. */
+    uint8_t rxHeader[DJI_TEST_MOP_MUX_FRAME_HEADER_SIZE];
+    uint32_t rxHeaderLen;
+    uint32_t rxPayloadLen;
+    uint32_t rxPayloadOffset;
+    uint8_t rxType;
+    uint8_t rxFlags;
+    uint16_t rxStreamId;
+    uint8_t rxWindow[sizeof(uint32_t)];
+    bool isBroken;
+    /* Chunks read by the pump and not yet parsed by the io task. */
+    uint8_t *pumpBuffer;
+    T_DjiTestMopMuxMessage *rxChunkHead;
+    T_DjiTestMopMuxMessage *rxChunkTail;
+    uint32_t rxChunkBytes;
+    bool isPumpWaiting;
+    T_DjiSemaHandle pumpSpaceSema;
+    /* Io task. */
+    T_DjiTaskHandle ioTask;
+    T_DjiTaskHandle pumpTask;
+    T_DjiSemaHandle ioStoppedSema;
+    T_DjiSemaHandle pumpStoppedSema;
+    bool isRunning;
+    T_DjiTestMopMuxStatistics statistics;
+} T_DjiTestMopMux;
+
+/**
+ * @brief Transport that writes into the input of another multiplexer, with a byte budget per tick to act as a link of
+ * limited bandwidth.
+ */
+typedef struct {
+    T_DjiTestMopMux *peer;
+    uint32_t bytesPerTick;          /*!< 0 for no limit. */
+    uint32_t budget;
+} T_DjiTestMopMuxLoopback;
+
+/* Exported functions --------------------------------------------------------*/
+void DjiTest_MopMuxGetDefaultConfig(T_DjiTestMopMuxConfig *config);
+void DjiTest_MopMuxGetMopTransport(T_DjiMopChannelHandle channelHandle, T_DjiTestMopMuxTransport *transport);
+T_DjiReturnCode DjiTest_MopMuxInit(T_DjiTestMopMux *mux, const T_DjiTestMopMuxConfig *config,
+                                   const T_DjiTestMopMuxTransport *transport);
+T_DjiReturnCode DjiTest_MopMuxDeInit(T_DjiTestMopMux *mux);
+T_DjiReturnCode DjiTest_MopMuxStart(T_DjiTestMopMux *mux);
+T_DjiReturnCode DjiTest_MopMuxStop(T_DjiTestMopMux *mux);
+
+T_DjiReturnCode DjiTest_MopMuxOpenStream(T_DjiTestMopMux *mux, uint16_t streamId, uint8_t priority);
+T_DjiReturnCode DjiTest_MopMuxCloseStream(T_DjiTestMopMux *mux, uint16_t streamId);
+T_DjiReturnCode DjiTest_MopMuxSend(T_DjiTestMopMux *mux, uint16_t streamId, const uint8_t *data, uint32_t len);
+void DjiTest_MopMuxGetStatistics(T_DjiTestMopMux *mux, T_DjiTestMopMuxStatistics *statistics);
+
+/* Without Start, the owner drives the multiplexer by calling these from one task. */
+T_DjiReturnCode DjiTest_MopMuxInput(T_DjiTestMopMux *mux, const uint8_t *data, uint32_t len);
+T_DjiReturnCode DjiTest_MopMuxPoll(T_DjiTestMopMux *mux);
+
+void DjiTest_MopMuxLoopbackInit(T_DjiTestMopMuxLoopback *loopback, T_DjiTestMopMux *peer, uint32_t bytesPerTick);
+void DjiTest_MopMuxLoopbackGetTransport(T_DjiTestMopMuxLoopback *loopback, T_DjiTestMopMuxTransport *transport);
+void DjiTest_MopMuxLoopbackTick(T_DjiTestMopMuxLoopback *loopback);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // TEST_MOP_CHANNEL_MUX_H
+/************************ (C) COPYRIGHT DJI Innovations *******END OF FILE******/
@@ -0,0 +1,1322 @@
+/**
+ ********************************************************************
+ * @file    test_mop_file_transfer.c
+ * @brief   Ranged, pipelined and resumable file transfer over a stream of the mop channel multiplexer.
+ *
+ * @copyright (c) 2021 DJI. All rights reserved.
+ *
+ * All information contained herein is, and remains, the property of DJI.
+ * The intellectual and technical concepts contained herein are proprietary
+ * to DJI and may be covered by U.S. and foreign patents, patents in process,
+ * and protected by trade secret or copyright law.  Dissemination of this
+ * information, including but not limited to data and other proprietary
+ * material(s) incorporated within the information, in any form, is strictly
+ * prohibited without the express written consent of DJI.
+ *
+ * If you receive this source code without DJI’s authorization, you may not
+ * further disseminate the information, and you must immediately remove the
+ * source code and notify DJI of its removal. DJI reserves the right to pursue
+ * legal actions against you for any loss(es) or damage(s) caused by your
+ * failure to do so.
+ *
+ *********************************************************************
+ */
+
+/* Includes ------------------------------------------------------------------*/
+#include "test_mop_file_transfer.h"
+
+#ifdef SYSTEM_ARCH_LINUX
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <dirent.h>
+#include <unistd.h>
+#include <sys/stat.h>
+#include "dji_logger.h"
+#include "utils/util_md5.h"
+#include "utils/util_misc.h"
+
+/* Private constants ---------------------------------------------------------*/
+#define DJI_TEST_MOP_FILE_MANIFEST_MAGIC        0x31464D44  /* "DMF1" */
+#define DJI_TEST_MOP_FILE_MANIFEST_VERSION      1
+#define DJI_TEST_MOP_FILE_SUFFIX_MAX_LEN        16
+#define DJI_TEST_MOP_FILE_WAIT_MAX_MS           100
+
+/* Private types -------------------------------------------------------------*/
+#pragma pack(1)
+typedef struct {
+    uint8_t opcode;
+    uint8_t status;
+    uint16_t reserved;
+    uint32_t requestId;
+} T_DjiTestMopFileHeader;
+
+typedef struct {
+    uint16_t pathLen;
+} T_DjiTestMopFileStatRequest;
+
+typedef struct {
+    uint64_t size;
+    uint64_t modifyTime;
+    uint8_t isDirectory;
+} T_DjiTestMopFileStatResponse;
+
+typedef struct {
+    uint64_t offset;
+    uint32_t len;
+    uint16_t pathLen;
+} T_DjiTestMopFileReadRequest;
+
+typedef struct {
+    uint64_t offset;
+    uint32_t len;
+    uint8_t md5[DJI_TEST_MOP_FILE_MD5_SIZE];
+} T_DjiTestMopFileReadResponse;
+
+typedef struct {
+    uint16_t maxEntries;
+    uint16_t pathLen;
+    uint16_t cursorLen;
+} T_DjiTestMopFileListRequest;
+
+typedef struct {
+    uint16_t count;
+    uint8_t isEnd;
+} T_DjiTestMopFileListResponse;
+
+typedef struct {
+    uint8_t isDirectory;
+    uint64_t size;
+    uint64_t modifyTime;
+    uint16_t nameLen;
+} T_DjiTestMopFileListEntry;
+
+typedef struct {
+    uint32_t magic;
+    uint16_t version;
+    uint16_t pathLen;
+    uint64_t fileSize;
+    uint64_t modifyTime;
+    uint32_t chunkSize;
+    uint32_t chunkCount;
+    uint8_t md5[DJI_TEST_MOP_FILE_MD5_SIZE];    /*!< Over the remote path and the bitmap that follow the header. */
+} T_DjiTestMopFileManifestHeader;
+#pragma pack()
+
+struct T_DjiTestMopFileResponse {
+    struct T_DjiTestMopFileResponse *next;
+    uint32_t len;
+    uint8_t data[];
+};
+
+typedef struct {
+    bool isUsed;
+    uint32_t chunkIndex;
+    uint32_t requestId;
+    uint32_t sentTimeMs;
+    uint32_t retryCount;
+} T_DjiTestMopFileInflight;
+
+/* A range split in chunks, written to a file or to memory as they arrive. */
+typedef struct {
+    const char *remotePath;
+    uint64_t offset;
+    uint64_t len;
+    uint32_t chunkSize;
+    uint32_t chunkCount;
+    uint8_t *bitmap;
+    uint32_t nextChunk;
+    FILE *file;
+    uint8_t *buffer;
+    /* Download only, the manifest is saved while chunks complete. */
+    const char *manifestPath;
+    uint64_t modifyTime;
+    uint32_t lastSaveMs;
+    bool isDirty;
+    T_DjiTestMopFileInflight inflight[DJI_TEST_MOP_FILE_INFLIGHT_MAX_NUM];
+} T_DjiTestMopFileTransfer;
+
+/* Private functions declaration ---------------------------------------------*/
+static T_DjiReturnCode DjiTest_MopFileServerResolvePath(const T_DjiTestMopFileServer *server, const char *path,
+                                                        uint32_t pathLen, char *fullPath);
+static uint32_t DjiTest_MopFileServerStat(T_DjiTestMopFileServer *server, const uint8_t *body, uint32_t bodyLen,
+                                          uint8_t *status);
+static uint32_t DjiTest_MopFileServerRead(T_DjiTestMopFileServer *server, const uint8_t *body, uint32_t bodyLen,
+                                          uint8_t *status);
+static uint32_t DjiTest_MopFileServerList(T_DjiTestMopFileServer *server, const uint8_t *body, uint32_t bodyLen,
+                                          uint8_t *status);
+static int DjiTest_MopFileServerListFilter(const struct dirent *entry);
+static T_DjiReturnCode DjiTest_MopFileStatusToReturnCode(uint8_t status);
+static T_DjiReturnCode DjiTest_MopFileClientRequest(T_DjiTestMopFileClient *client, uint8_t *request,
+                                                    uint32_t requestLen, T_DjiTestMopFileResponse **response);
+static T_DjiTestMopFileResponse *DjiTest_MopFileClientPopResponse(T_DjiTestMopFileClient *client);
+static void DjiTest_MopFileClientFlushResponses(T_DjiTestMopFileClient *client);
+static T_DjiReturnCode DjiTest_MopFileClientSendRead(T_DjiTestMopFileClient *client,
+                                                     T_DjiTestMopFileTransfer *transfer,
+                                                     T_DjiTestMopFileInflight *inflight);
+static T_DjiReturnCode DjiTest_MopFileClientHandleRead(T_DjiTestMopFileClient *client,
+                                                       T_DjiTestMopFileTransfer *transfer,
+                                                       const T_DjiTestMopFileResponse *response);
+static T_DjiReturnCode DjiTest_MopFileClientRunTransfer(T_DjiTestMopFileClient *client,
+                                                        T_DjiTestMopFileTransfer *transfer);
+static uint32_t DjiTest_MopFileGetChunkLen(const T_DjiTestMopFileTransfer *transfer, uint32_t chunkIndex);
+static T_DjiReturnCode DjiTest_MopFileLoadManifest(T_DjiTestMopFileTransfer *transfer);
+static T_DjiReturnCode DjiTest_MopFileSaveManifest(T_DjiTestMopFileTransfer *transfer);
+static void DjiTest_MopFileManifestMd5(const T_DjiTestMopFileTransfer *transfer, uint8_t *md5);
+
+/* Private values ------------------------------------------------------------*/
+
+/* Exported functions definition ---------------------------------------------*/
+T_DjiReturnCode DjiTest_MopFileServerInit(T_DjiTestMopFileServer *server, T_DjiTestMopMux *mux, uint16_t streamId,
+                                          const char *rootPath)
+{
+    T_DjiOsalHandler *osalHandler = DjiPlatform_GetOsalHandler();
+
+    if (server == NULL || mux == NULL || rootPath == NULL || strlen(rootPath) == 0 ||
+        strlen(rootPath) >= DJI_TEST_MOP_FILE_PATH_MAX_LEN) {
+        return DJI_ERROR_SYSTEM_MODULE_CODE_INVALID_PARAMETER;
+    }
+
+    memset(server, 0, sizeof(T_DjiTestMopFileServer));
+    server->mux = mux;
+    server->streamId = streamId;
+    strcpy(server->rootPath, rootPath);
+
+    server->responseBuffer = osalHandler->Malloc(DJI_TEST_MOP_FILE_MESSAGE_MAX_SIZE);
+    if (server->responseBuffer == NULL) {
+        return DJI_ERROR_SYSTEM_MODULE_CODE_MEMORY_ALLOC_FAILED;
+    }
+
+    return DJI_ERROR_SYSTEM_MODULE_CODE_SUCCESS;
+}
+
+T_DjiReturnCode DjiTest_MopFileServerDeInit(T_DjiTestMopFileServer *server)
+{
+    T_DjiOsalHandler *osalHandler = DjiPlatform_GetOsalHandler();
+
+    if (server == NULL || server->responseBuffer == NULL) {
+        return DJI_ERROR_SYSTEM_MODULE_CODE_INVALID_PARAMETER;
+    }
+
+    if (server->openFile != NULL) {
+        fclose(server->openFile);
+    }
+    osalHandler->Free(server->responseBuffer);
+    memset(server, 0, sizeof(T_DjiTestMopFileServer));
+
+    return DJI_ERROR_SYSTEM_MODULE_CODE_SUCCESS;
+}
+
+/**
+ * @brief Handle one request message and send its response on the server stream.
+ * @note A response the mux does not accept is dropped, the client sends the request again after its timeout.
+ */
+T_DjiReturnCode DjiTest_MopFileServerInput(T_DjiTestMopFileServer *server, const uint8_t *data, uint32_t len)
+{
+    T_DjiTestMopFileHeader header;
+    T_DjiTestMopFileHeader *responseHeader;
+    T_DjiReturnCode returnCode;
+    uint32_t bodyLen = 0;
+    uint8_t status = DJI_TEST_MOP_FILE_STATUS_INVALID;
+
+    if (server == NULL || server->responseBuffer == NULL || data == NULL) {
+        return DJI_ERROR_SYSTEM_MODULE_CODE_INVALID_PARAMETER;
+    }
+    if (len < sizeof(T_DjiTestMopFileHeader)) {
+        USER_LOG_WARN("Mop file request of %u bytes is too short.", len);
+        return DJI_ERROR_SYSTEM_MODULE_CODE_INVALID_PARAMETER;
+    }
+
+    memcpy(&header, data, sizeof(header));
+    data += sizeof(header);
+    len -= sizeof(header);
+    server->requestCount++;
+
+    switch (header.opcode) {
+        case DJI_TEST_MOP_FILE_OP_STAT:
+            bodyLen = DjiTest_MopFileServerStat(server, data, len, &status);
+            break;
+        case DJI_TEST_MOP_FILE_OP_READ:
+            bodyLen = DjiTest_MopFileServerRead(server, data, len, &status);
+            break;
+        case DJI_TEST_MOP_FILE_OP_LIST:
+            bodyLen = DjiTest_MopFileServerList(server, data, len, &status);
+            break;
+        default:
+            USER_LOG_WARN("Unknown mop file opcode %d.", header.opcode);
+            break;
+    }
+
+    responseHeader = (T_DjiTestMopFileHeader *) server->responseBuffer;
+    responseHeader->opcode = header.opcode;
+    responseHeader->status = status;
+    responseHeader->reserved = 0;
+    responseHeader->requestId = header.requestId;
+    if (status != DJI_TEST_MOP_FILE_STATUS_OK) {
+        bodyLen = 0;
+    }
+
+    returnCode = DjiTest_MopMuxSend(server->mux, server->streamId, server->responseBuffer,
+                                    sizeof(T_DjiTestMopFileHeader) + bodyLen);
+    if (returnCode != DJI_ERROR_SYSTEM_MODULE_CODE_SUCCESS) {
+        server->droppedResponseCount++;
+    }
+
+    return returnCode;
+}
+
+void DjiTest_MopFileClientGetDefaultConfig(T_DjiTestMopFileClientConfig *config)
+{
+    memset(config, 0, sizeof(T_DjiTestMopFileClientConfig));
+
+    config->chunkSize = 256 * 1024;
+    config->maxInflight = 4;
+    config->requestTimeoutMs = 3000;
+    config->maxRetryCount = 5;
+    config->manifestSaveIntervalMs = 1000;
+}
+
+T_DjiReturnCode DjiTest_MopFileClientInit(T_DjiTestMopFileClient *client, const T_DjiTestMopFileClientConfig *config,
+                                          T_DjiTestMopMux *mux, uint16_t streamId)
+{
+    T_DjiOsalHandler *osalHandler = DjiPlatform_GetOsalHandler();
+    T_DjiReturnCode returnCode;
+
+    if (client == NULL || config == NULL || mux == NULL || config->chunkSize == 0 ||
+        config->chunkSize > DJI_TEST_MOP_FILE_CHUNK_MAX_SIZE || config->maxInflight == 0 ||
+        config->maxInflight > DJI_TEST_MOP_FILE_INFLIGHT_MAX_NUM || config->requestTimeoutMs == 0) {
+        return DJI_ERROR_SYSTEM_MODULE_CODE_INVALID_PARAMETER;
+    }
+
+    memset(client, 0, sizeof(T_DjiTestMopFileClient));
+    client->config = *config;
+    client->mux = mux;
+    client->streamId = streamId;
+    client->nextRequestId = 1;
+
+    returnCode = osalHandler->MutexCreate(&client->operationMutex);
+    if (returnCode != DJI_ERROR_SYSTEM_MODULE_CODE_SUCCESS) {
+        USER_LOG_ERROR("Create mop file client mutex error: 0x%08llX.", returnCode);
+        return returnCode;
+    }
+
+    returnCode = osalHandler->MutexCreate(&client->responseMutex);
+    if (returnCode != DJI_ERROR_SYSTEM_MODULE_CODE_SUCCESS) {
+        USER_LOG_ERROR("Create mop file client mutex error: 0x%08llX.", returnCode);
+        goto destroyOperationMutex;
+    }
+
+    returnCode = osalHandler->SemaphoreCreate(0, &client->responseSema);
+    if (returnCode != DJI_ERROR_SYSTEM_MODULE_CODE_SUCCESS) {
+        USER_LOG_ERROR("Create mop file client semaphore error: 0x%08llX.", returnCode);
+        goto destroyResponseMutex;
+    }
+
+    return DJI_ERROR_SYSTEM_MODULE_CODE_SUCCESS;
+
+destroyResponseMutex:
+    osalHandler->MutexDestroy(client->responseMutex);
+destroyOperationMutex:
+    osalHandler->MutexDestroy(client->operationMutex);
+    memset(client, 0, sizeof(T_DjiTestMopFileClient));
+
+    return returnCode;
+}
+
+T_DjiReturnCode DjiTest_MopFileClientDeInit(T_DjiTestMopFileClient *client)
+{
+    T_DjiOsalHandler *osalHandler = DjiPlatform_GetOsalHandler();
+
+    if (client == NULL || client->operationMutex == NULL) {
+        return DJI_ERROR_SYSTEM_MODULE_CODE_INVALID_PARAMETER;
+    }
+
+    DjiTest_MopFileClientFlushResponses(client);
+    osalHandler->SemaphoreDestroy(client->responseSema);
+    osalHandler->MutexDestroy(client->responseMutex);
+    osalHandler->MutexDestroy(client->operationMutex);
+    memset(client, 0, sizeof(T_DjiTestMopFileClient));
+
+    return DJI_ERROR_SYSTEM_MODULE_CODE_SUCCESS;
+}
+
+/**
+ * @brief Queue a response message for the operation in progress, call it from the OnMessage callback of the mux.
+ */
+T_DjiReturnCode DjiTest_MopFileClientInput(T_DjiTestMopFileClient *client, const uint8_t *data, uint32_t len)
+{
+    T_DjiOsalHandler *osalHandler = DjiPlatform_GetOsalHandler();
+    T_DjiTestMopFileResponse *response;
+
+    if (client == NULL || client->operationMutex == NULL || data == NULL ||
+        len < sizeof(T_DjiTestMopFileHeader)) {
+        return DJI_ERROR_SYSTEM_MODULE_CODE_INVALID_PARAMETER;
+    }
+
+    response = osalHandler->Malloc(sizeof(T_DjiTestMopFileResponse) + len);
+    if (response == NULL) {
+        return DJI_ERROR_SYSTEM_MODULE_CODE_MEMORY_ALLOC_FAILED;
+    }
+    response->next = NULL;
+    response->len = len;
+    memcpy(response->data, data, len);
+
+    osalHandler->MutexLock(client->responseMutex);
+    if (client->responseTail != NULL) {
+        client->responseTail->next = response;
+    } else {
+        client->responseHead = response;
+    }
+    client->responseTail = response;
+    osalHandler->MutexUnlock(client->responseMutex);
+
+    osalHandler->SemaphorePost(client->responseSema);
+
+    return DJI_ERROR_SYSTEM_MODULE_CODE_SUCCESS;
+}
+
+T_DjiReturnCode DjiTest_MopFileClientStat(T_DjiTestMopFileClient *client, const char *remotePath,
+                                          T_DjiTestMopFileEntry *entry)
+{
+    T_DjiOsalHandler *osalHandler = DjiPlatform_GetOsalHandler();
+    uint8_t request[sizeof(T_DjiTestMopFileHeader) + sizeof(T_DjiTestMopFileStatRequest) +
+                    DJI_TEST_MOP_FILE_PATH_MAX_LEN];
+    T_DjiTestMopFileStatRequest statRequest;
+    T_DjiTestMopFileStatResponse statResponse;
+    T_DjiTestMopFileResponse *response = NULL;
+    T_DjiReturnCode returnCode;
+    const char *name;
+
+    if (client == NULL || client->operationMutex == NULL || remotePath == NULL || entry == NULL ||
+        strlen(remotePath) >= DJI_TEST_MOP_FILE_PATH_MAX_LEN) {
+        return DJI_ERROR_SYSTEM_MODULE_CODE_INVALID_PARAMETER;
+    }
+
+    statRequest.pathLen = strlen(remotePath);
+    request[0] = DJI_TEST_MOP_FILE_OP_STAT;
+    memcpy(&request[sizeof(T_DjiTestMopFileHeader)], &statRequest, sizeof(statRequest));
+    memcpy(&request[sizeof(T_DjiTestMopFileHeader) + sizeof(statRequest)], remotePath, statRequest.pathLen);
+
+    osalHandler->MutexLock(client->operationMutex);
+    client->isCancelled = false;
+    returnCode = DjiTest_MopFileClientRequest(client, request, sizeof(T_DjiTestMopFileHeader) + sizeof(statRequest) +
+                                                               statRequest.pathLen, &response);
+    osalHandler->MutexUnlock(client->operationMutex);
+    if (returnCode != DJI_ERROR_SYSTEM_MODULE_CODE_SUCCESS) {
+        return returnCode;
+    }
+
+    if (response->len < sizeof(T_DjiTestMopFileHeader) + sizeof(statResponse)) {
+        returnCode = DJI_ERROR_SYSTEM_MODULE_CODE_SYSTEM_ERROR;
+        goto freeResponse;
+    }
+    memcpy(&statResponse, &response->data[sizeof(T_DjiTestMopFileHeader)], sizeof(statResponse));
+
+    memset(entry, 0, sizeof(T_DjiTestMopFileEntry));
+    name = strrchr(remotePath, '/');
+    name = name != NULL ? name + 1 : remotePath;
+    strncpy(entry->name, name, sizeof(entry->name) - 1);
+    entry->isDirectory = statResponse.isDirectory != 0;
+    entry->size = statResponse.size;
+    entry->modifyTime = statResponse.modifyTime;
+
+freeResponse:
+    osalHandler->Free(response);
+
+    return returnCode;
+}
+
+/**
+ * @brief Read one page of a directory listing, in name order.
+ * @param cursor: "" or NULL for the first page, else the name of the last entry of the previous page.
+ * @note Paging by name stays consistent when files are added or removed between pages.
+ */
+T_DjiReturnCode DjiTest_MopFileClientList(T_DjiTestMopFileClient *client, const char *remotePath, const char *cursor,
+                                          T_DjiTestMopFileEntry *entries, uint32_t maxEntries, uint32_t *count,
+                                          bool *isEnd)
+{
+    T_DjiOsalHandler *osalHandler = DjiPlatform_GetOsalHandler();
+    uint8_t request[sizeof(T_DjiTestMopFileHeader) + sizeof(T_DjiTestMopFileListRequest) +
+                    DJI_TEST_MOP_FILE_PATH_MAX_LEN + DJI_FILE_NAME_SIZE_MAX];
+    T_DjiTestMopFileListRequest listRequest;
+    T_DjiTestMopFileListResponse listResponse;
+    T_DjiTestMopFileListEntry listEntry;
+    T_DjiTestMopFileResponse *response = NULL;
+    T_DjiReturnCode returnCode;
+    uint32_t requestLen;
+    uint32_t offset;
+    uint32_t i;
+
+    if (client == NULL || client->operationMutex == NULL || remotePath == NULL || entries == NULL ||
+        count == NULL || isEnd == NULL || maxEntries == 0 || strlen(remotePath) >= DJI_TEST_MOP_FILE_PATH_MAX_LEN ||
+        (cursor != NULL && strlen(cursor) >= DJI_FILE_NAME_SIZE_MAX)) {
+        return DJI_ERROR_SYSTEM_MODULE_CODE_INVALID_PARAMETER;
+    }
+
+    listRequest.maxEntries = USER_UTIL_MIN(maxEntries, DJI_TEST_MOP_FILE_LIST_MAX_NUM);
+    listRequest.pathLen = strlen(remotePath);
+    listRequest.cursorLen = cursor != NULL ? strlen(cursor) : 0;
+    request[0] = DJI_TEST_MOP_FILE_OP_LIST;
+    requestLen = sizeof(T_DjiTestMopFileHeader);
+    memcpy(&request[requestLen], &listRequest, sizeof(listRequest));
+    requestLen += sizeof(listRequest);
+    memcpy(&request[requestLen], remotePath, listRequest.pathLen);
+    requestLen += listRequest.pathLen;
+    if (listRequest.cursorLen > 0) {
+        memcpy(&request[requestLen], cursor, listRequest.cursorLen);
+        requestLen += listRequest.cursorLen;
+    }
+
+    osalHandler->MutexLock(client->operationMutex);
+    client->isCancelled = false;
+    returnCode = DjiTest_MopFileClientRequest(client, request, requestLen, &response);
+    osalHandler->MutexUnlock(client->operationMutex);
+    if (returnCode != DJI_ERROR_SYSTEM_MODULE_CODE_SUCCESS) {
+        return returnCode;
+    }
+
+    returnCode = DJI_ERROR_SYSTEM_MODULE_CODE_SYSTEM_ERROR;
+    offset = sizeof(T_DjiTestMopFileHeader);
+    if (response->len < offset + sizeof(listResponse)) {
+        goto freeResponse;
+    }
+    memcpy(&listResponse, &response->data[offset], sizeof(listResponse));
+    offset += sizeof(listResponse);
+    if (listResponse.count > listRequest.maxEntries) {
+        goto freeResponse;
+    }
+
+    for (i = 0; i < listResponse.count; i++) {
+        if (response->len < offset + sizeof(listEntry)) {
+            goto freeResponse;
+        }
+        memcpy(&listEntry, &response->data[offset], sizeof(listEntry));
+        offset += sizeof(listEntry);
+        if (listEntry.nameLen >= DJI_FILE_NAME_SIZE_MAX || response->len < offset + listEntry.nameLen) {
+            goto freeResponse;
+        }
+
+        memset(&entries[i], 0, sizeof(T_DjiTestMopFileEntry));
+        memcpy(entries[i].name, &response->data[offset], listEntry.nameLen);
+        entries[i].isDirectory = listEntry.isDirectory != 0;
+        entries[i].size = listEntry.size;
+        entries[i].modifyTime = listEntry.modifyTime;
+        offset += listEntry.nameLen;
+    }
+
+    *count = listResponse.count;
+    *isEnd = listResponse.isEnd != 0;
+    returnCode = DJI_ERROR_SYSTEM_MODULE_CODE_SUCCESS;
+
+freeResponse:
+    osalHandler->Free(response);
+
+    return returnCode;
+}
+
+/**
+ * @brief Read a byte range of a remote file into memory, with up to maxInflight chunks requested at the same time.
+ * @note A range past the end of the file fails with DJI_ERROR_SYSTEM_MODULE_CODE_INVALID_PARAMETER.
+ */
+T_DjiReturnCode DjiTest_MopFileClientReadRange(T_DjiTestMopFileClient *client, const char *remotePath,
+                                               uint64_t offset, uint32_t len, uint8_t *buffer)
+{
+    T_DjiOsalHandler *osalHandler = DjiPlatform_GetOsalHandler();
+    T_DjiTestMopFileTransfer *transfer;
+    T_DjiReturnCode returnCode;
+
+    if (client == NULL || client->operationMutex == NULL || remotePath == NULL || (buffer == NULL && len > 0) ||
+        strlen(remotePath) >= DJI_TEST_MOP_FILE_PATH_MAX_LEN) {
+        return DJI_ERROR_SYSTEM_MODULE_CODE_INVALID_PARAMETER;
+    }
+
+    transfer = osalHandler->Malloc(sizeof(T_DjiTestMopFileTransfer));
+    if (transfer == NULL) {
+        return DJI_ERROR_SYSTEM_MODULE_CODE_MEMORY_ALLOC_FAILED;
+    }
+    memset(transfer, 0, sizeof(T_DjiTestMopFileTransfer));
+    transfer->remotePath = remotePath;
+    transfer->offset = offset;
+    transfer->len = len;
+    transfer->chunkSize = client->config.chunkSize;
+    transfer->chunkCount = (len + client->config.chunkSize - 1) / client->config.chunkSize;
+    transfer->buffer = buffer;
+
+    transfer->bitmap = osalHandler->Malloc(transfer->chunkCount / 8 + 1);
+    if (transfer->bitmap == NULL) {
+        returnCode = DJI_ERROR_SYSTEM_MODULE_CODE_MEMORY_ALLOC_FAILED;
+        goto freeTransfer;
+    }
+    memset(transfer->bitmap, 0, transfer->chunkCount / 8 + 1);
+
+    osalHandler->MutexLock(client->operationMutex);
+    memset(&client->statistics, 0, sizeof(client->statistics));
+    client->statistics.fileSize = len;
+    client->statistics.chunkCount = transfer->chunkCount;
+    client->isCancelled = false;
+    returnCode = DjiTest_MopFileClientRunTransfer(client, transfer);
+    osalHandler->MutexUnlock(client->operationMutex);
+
+    osalHandler->Free(transfer->bitmap);
+freeTransfer:
+    osalHandler->Free(transfer);
+
+    return returnCode;
+}
+
+/**
+ * @brief Download a remote file to localPath, resuming an earlier download of the same file when possible.
+ * @note Chunks are written to "<localPath>.part" at their offsets and recorded in "<localPath>.manifest", the part
+ * file is renamed to localPath once complete. The manifest only names chunks already flushed to the part file, and is
+ * thrown away when the remote size or modify time has changed since. A failed or cancelled download keeps both files;
+ * cancelling returns DJI_ERROR_SYSTEM_MODULE_CODE_NONSUPPORT_IN_CURRENT_STATE.
+ */
+T_DjiReturnCode DjiTest_MopFileClientDownload(T_DjiTestMopFileClient *client, const char *remotePath,
+                                              const char *localPath)
+{
+    T_DjiOsalHandler *osalHandler = DjiPlatform_GetOsalHandler();
+    char partPath[DJI_TEST_MOP_FILE_PATH_MAX_LEN + DJI_TEST_MOP_FILE_SUFFIX_MAX_LEN];
+    char manifestPath[DJI_TEST_MOP_FILE_PATH_MAX_LEN + DJI_TEST_MOP_FILE_SUFFIX_MAX_LEN];
+    T_DjiTestMopFileTransfer *transfer;
+    T_DjiTestMopFileEntry entry;
+    T_DjiReturnCode returnCode;
+    uint32_t startMs;
+    uint32_t i;
+
+    if (client == NULL || client->operationMutex == NULL || remotePath == NULL || localPath == NULL ||
+        strlen(localPath) >= DJI_TEST_MOP_FILE_PATH_MAX_LEN) {
+        return DJI_ERROR_SYSTEM_MODULE_CODE_INVALID_PARAMETER;
+    }
+
+    returnCode = DjiTest_MopFileClientStat(client, remotePath, &entry);
+    if (returnCode != DJI_ERROR_SYSTEM_MODULE_CODE_SUCCESS) {
+        USER_LOG_ERROR("Stat mop file %s error: 0x%08llX.", remotePath, returnCode);
+        return returnCode;
+    }
+    if (entry.isDirectory) {
+        return DJI_ERROR_SYSTEM_MODULE_CODE_INVALID_PARAMETER;
+    }
+
+    snprintf(partPath, sizeof(partPath), "%s.part", localPath);
+    snprintf(manifestPath, sizeof(manifestPath), "%s.manifest", localPath);
+
+    transfer = osalHandler->Malloc(sizeof(T_DjiTestMopFileTransfer));
+    if (transfer == NULL) {
+        return DJI_ERROR_SYSTEM_MODULE_CODE_MEMORY_ALLOC_FAILED;
+    }
+    memset(transfer, 0, sizeof(T_DjiTestMopFileTransfer));
+    transfer->remotePath = remotePath;
+    transfer->len = entry.size;
+    transfer->chunkSize = client->config.chunkSize;
+    transfer->chunkCount = (entry.size + client->config.chunkSize - 1) / client->config.chunkSize;
+    transfer->manifestPath = manifestPath;
+    transfer->modifyTime = entry.modifyTime;
+
+    transfer->bitmap = osalHandler->Malloc(transfer->chunkCount / 8 + 1);
+    if (transfer->bitmap == NULL) {
+        returnCode = DJI_ERROR_SYSTEM_MODULE_CODE_MEMORY_ALLOC_FAILED;
+        goto freeTransfer;
+    }
+    memset(transfer->bitmap, 0, transfer->chunkCount / 8 + 1);
+
+    osalHandler->MutexLock(client->operationMutex);
+    memset(&client->statistics, 0, sizeof(client->statistics));
+    client->statistics.fileSize = entry.size;
+    client->statistics.chunkCount = transfer->chunkCount;
+    client->isCancelled = false;
+    osalHandler->GetTimeMs(&startMs);
+
+    /* Resume only with both the manifest and the data it describes, else start over. */
+    if (DjiTest_MopFileLoadManifest(transfer) == DJI_ERROR_SYSTEM_MODULE_CODE_SUCCESS) {
+        transfer->file = fopen(partPath, "r+b");
+    }
+    if (transfer->file == NULL) {
+        memset(transfer->bitmap, 0, transfer->chunkCount / 8 + 1);
+        transfer->file = fopen(partPath, "w+b");
+    }
+    if (transfer->file == NULL) {
+        USER_LOG_ERROR("Open mop file download %s error.", partPath);
+        returnCode = DJI_ERROR_SYSTEM_MODULE_CODE_SYSTEM_ERROR;
+        goto unlock;
+    }
+
+    for (i = 0; i < transfer->chunkCount; i++) {
+        if (transfer->bitmap[i / 8] & (1 << (i % 8))) {
+            client->statistics.completedChunkCount++;
+            client->statistics.resumedBytes += DjiTest_MopFileGetChunkLen(transfer, i);
+        }
+    }
+    if (client->statistics.resumedBytes > 0) {
+        USER_LOG_INFO("Resume mop file download %s at %llu of %llu bytes.", remotePath,
+                      client->statistics.resumedBytes, entry.size);
+    }
+
+    returnCode = DjiTest_MopFileClientRunTransfer(client, transfer);
+    if (returnCode != DJI_ERROR_SYSTEM_MODULE_CODE_SUCCESS) {
+        DjiTest_MopFileSaveManifest(transfer);
+        fclose(transfer->file);
+        goto unlock;
+    }
+
+    if (fclose(transfer->file) != 0 || rename(partPath, localPath) != 0) {
+        USER_LOG_ERROR("Finish mop file download %s error.", localPath);
+        returnCode = DJI_ERROR_SYSTEM_MODULE_CODE_SYSTEM_ERROR;
+        goto unlock;
+    }
+    remove(manifestPath);
+
+    osalHandler->GetTimeMs(&client->statistics.elapsedMs);
+    client->statistics.elapsedMs -= startMs;
+    USER_LOG_INFO("Mop file download %s finished, %llu bytes in %u ms, %u timeouts, %u hash errors.", remotePath,
+                  client->statistics.receivedBytes, client->statistics.elapsedMs, client->statistics.timeoutCount,
+                  client->statistics.hashErrorCount);
+
+unlock:
+    osalHandler->MutexUnlock(client->operationMutex);
+    osalHandler->Free(transfer->bitmap);
+freeTransfer:
+    osalHandler->Free(transfer);
+
+    return returnCode;
+}
+
+/**
+ * @brief Make the operation in progress return, a download keeps its manifest and resumes on the next call.
+ */
+void DjiTest_MopFileClientCancel(T_DjiTestMopFileClient *client)
+{
+    T_DjiOsalHandler *osalHandler = DjiPlatform_GetOsalHandler();
+
+    client->isCancelled = true;
+    osalHandler->SemaphorePost(client->responseSema);
+}
+
+void DjiTest_MopFileClientGetStatistics(T_DjiTestMopFileClient *client,
+                                        T_DjiTestMopFileTransferStatistics *statistics)
+{
+    *statistics = client->statistics;
+}
+
+/* Private functions definition-----------------------------------------------*/
+/**
+ * @brief Join a requested path to the server root, rejecting paths that climb out of it with "..".
+ */
+static T_DjiReturnCode DjiTest_MopFileServerResolvePath(const T_DjiTestMopFileServer *server, const char *path,
+                                                        uint32_t pathLen, char *fullPath)
+{
+    uint32_t segmentStart = 0;
+    uint32_t i;
+
+    if (pathLen >= DJI_TEST_MOP_FILE_PATH_MAX_LEN || memchr(path, '\0', pathLen) != NULL) {
+        return DJI_ERROR_SYSTEM_MODULE_CODE_INVALID_PARAMETER;
+    }
+
+    for (i = 0; i <= pathLen; i++) {
+        if (i < pathLen && path[i] != '/') {
+            continue;
+        }
+        if (i - segmentStart == 2 && path[segmentStart] == '.' && path[segmentStart + 1] == '.') {
+            return DJI_ERROR_SYSTEM_MODULE_CODE_INVALID_PARAMETER;
+        }
+        segmentStart = i + 1;
+    }
+
+    while (pathLen > 0 && *path == '/') {
+        path++;
+        pathLen--;
+    }
+
+    if (snprintf(fullPath, DJI_TEST_MOP_FILE_PATH_MAX_LEN, "%s/%.*s", server->rootPath, (int) pathLen, path) >=
+        DJI_TEST_MOP_FILE_PATH_MAX_LEN) {
+        return DJI_ERROR_SYSTEM_MODULE_CODE_OUT_OF_RANGE;
+    }
+
+    return DJI_ERROR_SYSTEM_MODULE_CODE_SUCCESS;
+}
+
+static uint32_t DjiTest_MopFileServerStat(T_DjiTestMopFileServer *server, const uint8_t *body, uint32_t bodyLen,
+                                          uint8_t *status)
+{
+    T_DjiTestMopFileStatRequest request;
+    T_DjiTestMopFileStatResponse response;
+    char fullPath[DJI_TEST_MOP_FILE_PATH_MAX_LEN];
+    struct stat fileStat;
+
+    if (bodyLen < sizeof(request)) {
+        return 0;
+    }
+    memcpy(&request, body, sizeof(request));
+    if (bodyLen < sizeof(request) + request.pathLen ||
+        DjiTest_MopFileServerResolvePath(server, (const char *) body + sizeof(request), request.pathLen, fullPath) !=
+        DJI_ERROR_SYSTEM_MODULE_CODE_SUCCESS) {
+        return 0;
+    }
+
+    if (stat(fullPath, &fileStat) != 0) {
+        *status = DJI_TEST_MOP_FILE_STATUS_NOT_FOUND;
+        return 0;
+    }
+
+    response.size = S_ISDIR(fileStat.st_mode) ? 0 : (uint64_t) fileStat.st_size;
+    response.modifyTime = (uint64_t) fileStat.st_mtime;
+    response.isDirectory = S_ISDIR(fileStat.st_mode) ? 1 : 0;
+    memcpy(server->responseBuffer + sizeof(T_DjiTestMopFileHeader), &response, sizeof(response));
+    *status = DJI_TEST_MOP_FILE_STATUS_OK;
+
+    return sizeof(response);
+}
+
+static uint32_t DjiTest_MopFileServerRead(T_DjiTestMopFileServer *server, const uint8_t *body, uint32_t bodyLen,
+                                          uint8_t *status)
+{
+    T_DjiTestMopFileReadRequest request;
+    T_DjiTestMopFileReadResponse response;
+    char fullPath[DJI_TEST_MOP_FILE_PATH_MAX_LEN];
+    uint8_t *data = server->responseBuffer + sizeof(T_DjiTestMopFileHeader) + sizeof(response);
+    struct stat fileStat;
+    MD5_CTX md5Ctx;
+
+    if (bodyLen < sizeof(request)) {
+        return 0;
+    }
+    memcpy(&request, body, sizeof(request));
+    if (bodyLen < sizeof(request) + request.pathLen || request.len > DJI_TEST_MOP_FILE_CHUNK_MAX_SIZE ||
+        DjiTest_MopFileServerResolvePath(server, (const char *) body + sizeof(request), request.pathLen, fullPath) !=
+        DJI_ERROR_SYSTEM_MODULE_CODE_SUCCESS) {
+        return 0;
+    }
+
+    if (server->openFile == NULL || strcmp(server->openPath, fullPath) != 0) {
+        if (server->openFile != NULL) {
+            fclose(server->openFile);
+        }
+        server->openFile = fopen(fullPath, "rb");
+        if (server->openFile == NULL) {
+            *status = DJI_TEST_MOP_FILE_STATUS_NOT_FOUND;
+            return 0;
+        }
+        strcpy(server->openPath, fullPath);
+    }
+
+    if (fstat(fileno(server->openFile), &fileStat) != 0 || S_ISDIR(fileStat.st_mode)) {
+        *status = DJI_TEST_MOP_FILE_STATUS_IO_ERROR;
+        return 0;
+    }
+    if (request.offset > (uint64_t) fileStat.st_size || request.len > (uint64_t) fileStat.st_size - request.offset) {
+        return 0;
+    }
+
+    if (fseeko(server->openFile, (off_t) request.offset, SEEK_SET) != 0 ||
+        fread(data, 1, request.len, server->openFile) != request.len) {
+        *status = DJI_TEST_MOP_FILE_STATUS_IO_ERROR;
+        return 0;
+    }
+
+    response.offset = request.offset;
+    response.len = request.len;
+    UtilMd5_Init(&md5Ctx);
+    UtilMd5_Update(&md5Ctx, data, request.len);
+    UtilMd5_Final(&md5Ctx, response.md5);
+    memcpy(server->responseBuffer + sizeof(T_DjiTestMopFileHeader), &response, sizeof(response));
+    *status = DJI_TEST_MOP_FILE_STATUS_OK;
+
+    return sizeof(response) + request.len;
+}
+
+static uint32_t DjiTest_MopFileServerList(T_DjiTestMopFileServer *server, const uint8_t *body, uint32_t bodyLen,
+                                          uint8_t *status)
+{
+    T_DjiTestMopFileListRequest request;
+    T_DjiTestMopFileListResponse response = {0};
+    T_DjiTestMopFileListEntry listEntry;
+    char fullPath[DJI_TEST_MOP_FILE_PATH_MAX_LEN];
+    char entryPath[DJI_TEST_MOP_FILE_PATH_MAX_LEN + DJI_FILE_NAME_SIZE_MAX];
+    char cursor[DJI_FILE_NAME_SIZE_MAX] = {0};
+    uint8_t *out = server->responseBuffer + sizeof(T_DjiTestMopFileHeader) + sizeof(response);
+    uint32_t outLen = 0;
+    struct dirent **names = NULL;
+    struct stat fileStat;
+    int nameCount;
+    int i;
+
+    if (bodyLen < sizeof(request)) {
+        return 0;
+    }
+    memcpy(&request, body, sizeof(request));
+    if (bodyLen < sizeof(request) + request.pathLen + request.cursorLen ||
+        request.cursorLen >= DJI_FILE_NAME_SIZE_MAX ||
+        DjiTest_MopFileServerResolvePath(server, (const char *) body + sizeof(request), request.pathLen, fullPath) !=
+        DJI_ERROR_SYSTEM_MODULE_CODE_SUCCESS) {
+        return 0;
+    }
+    memcpy(cursor, body + sizeof(request) + request.pathLen, request.cursorLen);
+    request.maxEntries = USER_UTIL_MIN(request.maxEntries, DJI_TEST_MOP_FILE_LIST_MAX_NUM);
+
+    nameCount = scandir(fullPath, &names, DjiTest_MopFileServerListFilter, alphasort);
+    if (nameCount < 0) {
+        *status = DJI_TEST_MOP_FILE_STATUS_NOT_FOUND;
+        return 0;
+    }
+
+    response.isEnd = 1;
+    for (i = 0; i < nameCount; i++) {
+        if (strcmp(names[i]->d_name, cursor) <= 0) {
+            continue;
+        }
+        if (response.count == request.maxEntries) {
+            response.isEnd = 0;
+            break;
+        }
+
+        snprintf(entryPath, sizeof(entryPath), "%s/%s", fullPath, names[i]->d_name);
+        if (stat(entryPath, &fileStat) != 0) {
+            continue;
+        }
+
+        listEntry.isDirectory = S_ISDIR(fileStat.st_mode) ? 1 : 0;
+        listEntry.size = S_ISDIR(fileStat.st_mode) ? 0 : (uint64_t) fileStat.st_size;
+        listEntry.modifyTime = (uint64_t) fileStat.st_mtime;
+        listEntry.nameLen = strlen(names[i]->d_name);
+        memcpy(out + outLen, &listEntry, sizeof(listEntry));
+        outLen += sizeof(listEntry);
+        memcpy(out + outLen, names[i]->d_name, listEntry.nameLen);
+        outLen += listEntry.nameLen;
+        response.count++;
+    }
+
+    for (i = 0; i < nameCount; i++) {
+        free(names[i]);
+    }
+    free(names);
+
+    memcpy(server->responseBuffer + sizeof(T_DjiTestMopFileHeader), &response, sizeof(response));
+    *status = DJI_TEST_MOP_FILE_STATUS_OK;
+
+    return sizeof(response) + outLen;
+}
+
+static int DjiTest_MopFileServerListFilter(const struct dirent *entry)
+{
+    return strcmp(entry->d_name, ".") != 0 && strcmp(entry->d_name, "..") != 0;
+}
+
+static T_DjiReturnCode DjiTest_MopFileStatusToReturnCode(uint8_t status)
+{
+    switch (status) {
+        case DJI_TEST_MOP_FILE_STATUS_OK:
+            return DJI_ERROR_SYSTEM_MODULE_CODE_SUCCESS;
+        case DJI_TEST_MOP_FILE_STATUS_NOT_FOUND:
+            return DJI_ERROR_SYSTEM_MODULE_CODE_NOT_FOUND;
+        case DJI_TEST_MOP_FILE_STATUS_INVALID:
+            return DJI_ERROR_SYSTEM_MODULE_CODE_INVALID_PARAMETER;
+        default:
+            return DJI_ERROR_SYSTEM_MODULE_CODE_SYSTEM_ERROR;
+    }
+}
+
+/**
+ * @brief Send a request and wait for its response, sending it again after each timeout.
+ * @note The request header is filled in here. Responses to other requests, late answers of earlier operations, are
+ * dropped.
+ */
+static T_DjiReturnCode DjiTest_MopFileClientRequest(T_DjiTestMopFileClient *client, uint8_t *request,
+                                                    uint32_t requestLen, T_DjiTestMopFileResponse **response)
+{
+    T_DjiOsalHandler *osalHandler = DjiPlatform_GetOsalHandler();
+    T_DjiTestMopFileHeader header = {0};
+    T_DjiTestMopFileHeader responseHeader;
+    T_DjiTestMopFileResponse *received;
+    T_DjiReturnCode returnCode;
+    uint32_t retryCount;
+    uint32_t sentMs;
+    uint32_t nowMs;
+
+    header.opcode = request[0];
+
+    for (retryCount = 0; retryCount <= client->config.maxRetryCount; retryCount++) {
+        if (client->isCancelled) {
+            return DJI_ERROR_SYSTEM_MODULE_CODE_NONSUPPORT_IN_CURRENT_STATE;
+        }
+
+        header.requestId = client->nextRequestId++;
+        memcpy(request, &header, sizeof(header));
+        returnCode = DjiTest_MopMuxSend(client->mux, client->streamId, request, requestLen);
+        if (returnCode != DJI_ERROR_SYSTEM_MODULE_CODE_SUCCESS &&
+            returnCode != DJI_ERROR_SYSTEM_MODULE_CODE_BUSY) {
+            return returnCode;
+        }
+        client->statistics.requestCount++;
+        osalHandler->GetTimeMs(&sentMs);
+
+        while (1) {
+            received = DjiTest_MopFileClientPopResponse(client);
+            if (received != NULL) {
+                memcpy(&responseHeader, received->data, sizeof(responseHeader));
+                if (responseHeader.requestId != header.requestId || responseHeader.opcode != header.opcode) {
+                    client->statistics.lateResponseCount++;
+                    osalHandler->Free(received);
+                    continue;
+                }
+
+                returnCode = DjiTest_MopFileStatusToReturnCode(responseHeader.status);
+                if (returnCode != DJI_ERROR_SYSTEM_MODULE_CODE_SUCCESS) {
+                    osalHandler->Free(received);
+                    return returnCode;
+                }
+                *response = received;
+                return DJI_ERROR_SYSTEM_MODULE_CODE_SUCCESS;
+            }
+
+            osalHandler->GetTimeMs(&nowMs);
+            if (nowMs - sentMs >= client->config.requestTimeoutMs || client->isCancelled) {
+                break;
+            }
+            osalHandler->SemaphoreTimedWait(client->responseSema,
+                                            client->config.requestTimeoutMs - (nowMs - sentMs));
+        }
+        client->statistics.timeoutCount++;
+    }
+
+    return DJI_ERROR_SYSTEM_MODULE_CODE_TIMEOUT;
+}
+
+static T_DjiTestMopFileResponse *DjiTest_MopFileClientPopResponse(T_DjiTestMopFileClient *client)
+{
+    T_DjiOsalHandler *osalHandler = DjiPlatform_GetOsalHandler();
+    T_DjiTestMopFileResponse *response;
+
+    osalHandler->MutexLock(client->responseMutex);
+    response = client->responseHead;
+    if (response != NULL) {
+        client->responseHead = response->next;
+        if (client->responseHead == NULL) {
+            client->responseTail = NULL;
+        }
+    }
+    osalHandler->MutexUnlock(client->responseMutex);
+
+    return response;
+}
+
+static void DjiTest_MopFileClientFlushResponses(T_DjiTestMopFileClient *client)
+{
+    T_DjiOsalHandler *osalHandler = DjiPlatform_GetOsalHandler();
+    T_DjiTestMopFileResponse *response;
+
+    while ((response = DjiTest_MopFileClientPopResponse(client)) != NULL) {
+        osalHandler->Free(response);
+    }
+}
+
+static T_DjiReturnCode DjiTest_MopFileClientSendRead(T_DjiTestMopFileClient *client,
+                                                     T_DjiTestMopFileTransfer *transfer,
+                                                     T_DjiTestMopFileInflight *inflight)
+{
+    T_DjiOsalHandler *osalHandler = DjiPlatform_GetOsalHandler();
+    uint8_t request[sizeof(T_DjiTestMopFileHeader) + sizeof(T_DjiTestMopFileReadRequest) +
+                    DJI_TEST_MOP_FILE_PATH_MAX_LEN];
+    T_DjiTestMopFileHeader header = {0};
+    T_DjiTestMopFileReadRequest readRequest;
+    T_DjiReturnCode returnCode;
+    uint32_t requestId = client->nextRequestId++;
+
+    header.opcode = DJI_TEST_MOP_FILE_OP_READ;
+    header.requestId = requestId;
+    readRequest.offset = transfer->offset + (uint64_t) inflight->chunkIndex * transfer->chunkSize;
+    readRequest.len = DjiTest_MopFileGetChunkLen(transfer, inflight->chunkIndex);
+    readRequest.pathLen = strlen(transfer->remotePath);
+    memcpy(request, &header, sizeof(header));
+    memcpy(&request[sizeof(header)], &readRequest, sizeof(readRequest));
+    memcpy(&request[sizeof(header) + sizeof(readRequest)], transfer->remotePath, readRequest.pathLen);
+
+    returnCode = DjiTest_MopMuxSend(client->mux, client->streamId, request,
+                                    sizeof(header) + sizeof(readRequest) + readRequest.pathLen);
+    if (returnCode != DJI_ERROR_SYSTEM_MODULE_CODE_SUCCESS) {
+        return returnCode;
+    }
+
+    inflight->requestId = requestId;
+    osalHandler->GetTimeMs(&inflight->sentTimeMs);
+    client->statistics.requestCount++;
+
+    return DJI_ERROR_SYSTEM_MODULE_CODE_SUCCESS;
+}
+
+static T_DjiReturnCode DjiTest_MopFileClientHandleRead(T_DjiTestMopFileClient *client,
+                                                       T_DjiTestMopFileTransfer *transfer,
+                                                       const T_DjiTestMopFileResponse *response)
+{
+    T_DjiTestMopFileHeader header;
+    T_DjiTestMopFileReadResponse readResponse;
+    T_DjiTestMopFileInflight *inflight = NULL;
+    const uint8_t *data;
+    uint8_t md5[DJI_TEST_MOP_FILE_MD5_SIZE];
+    uint64_t chunkOffset;
+    uint32_t chunkLen;
+    MD5_CTX md5Ctx;
+    uint32_t i;
+
+    memcpy(&header, response->data, sizeof(header));
+    for (i = 0; i < client->config.maxInflight; i++) {
+        if (transfer->inflight[i].isUsed && transfer->inflight[i].requestId == header.requestId) {
+            inflight = &transfer->inflight[i];
+            break;
+        }
+    }
+    if (inflight == NULL || header.opcode != DJI_TEST_MOP_FILE_OP_READ) {
+        client->statistics.lateResponseCount++;
+        return DJI_ERROR_SYSTEM_MODULE_CODE_SUCCESS;
+    }
+
+    if (header.status != DJI_TEST_MOP_FILE_STATUS_OK) {
+        return DjiTest_MopFileStatusToReturnCode(header.status);
+    }
+
+    chunkOffset = (uint64_t) inflight->chunkIndex * transfer->chunkSize;
+    chunkLen = DjiTest_MopFileGetChunkLen(transfer, inflight->chunkIndex);
+    data = response->data + sizeof(header) + sizeof(readResponse);
+    if (response->len >= sizeof(header) + sizeof(readResponse)) {
+        memcpy(&readResponse, response->data + sizeof(header), sizeof(readResponse));
+        UtilMd5_Init(&md5Ctx);
+        UtilMd5_Update(&md5Ctx, data, response->len - sizeof(header) - sizeof(readResponse));
+        UtilMd5_Final(&md5Ctx, md5);
+    }
+    if (response->len != sizeof(header) + sizeof(readResponse) + chunkLen || readResponse.len != chunkLen ||
+        readResponse.offset != transfer->offset + chunkOffset ||
+        memcmp(md5, readResponse.md5, sizeof(md5)) != 0) {
+        /* The chunk is asked for again at once, a corrupted link does not wait for the timeout. */
+        USER_LOG_WARN("Mop file chunk %u of %s failed verification.", inflight->chunkIndex, transfer->remotePath);
+        client->statistics.hashErrorCount++;
+        if (++inflight->retryCount > client->config.maxRetryCount) {
+            return DJI_ERROR_SYSTEM_MODULE_CODE_SYSTEM_ERROR;
+        }
+        DjiTest_MopFileClientSendRead(client, transfer, inflight);
+        return DJI_ERROR_SYSTEM_MODULE_CODE_SUCCESS;
+    }
+
+    if (transfer->file != NULL) {
+        if (fseeko(transfer->file, (off_t) chunkOffset, SEEK_SET) != 0 ||
+            fwrite(data, 1, chunkLen, transfer->file) != chunkLen) {
+            USER_LOG_ERROR("Write mop file chunk %u error.", inflight->chunkIndex);
+            return DJI_ERROR_SYSTEM_MODULE_CODE_SYSTEM_ERROR;
+        }
+    } else {
+        memcpy(transfer->buffer + chunkOffset, data, chunkLen);
+    }
+
+    transfer->bitmap[inflight->chunkIndex / 8] |= (uint8_t) (1 << (inflight->chunkIndex % 8));
+    transfer->isDirty = true;
+    inflight->isUsed = false;
+    client->statistics.completedChunkCount++;
+    client->statistics.receivedBytes += chunkLen;
+
+    if (client->config.progressCallback != NULL) {
+        client->config.progressCallback(client->config.userData, &client->statistics);
+    }
+
+    return DJI_ERROR_SYSTEM_MODULE_CODE_SUCCESS;
+}
+
+/**
+ * @brief Keep up to maxInflight chunk reads outstanding until every chunk of the transfer is verified and stored.
+ */
+static T_DjiReturnCode DjiTest_MopFileClientRunTransfer(T_DjiTestMopFileClient *client,
+                                                        T_DjiTestMopFileTransfer *transfer)
+{
+    T_DjiOsalHandler *osalHandler = DjiPlatform_GetOsalHandler();
+    T_DjiTestMopFileInflight *inflight;
+    T_DjiTestMopFileResponse *response;
+    T_DjiReturnCode returnCode = DJI_ERROR_SYSTEM_MODULE_CODE_SUCCESS;
+    uint32_t waitMs;
+    uint32_t nowMs;
+    uint32_t i;
+
+    DjiTest_MopFileClientFlushResponses(client);
+    osalHandler->GetTimeMs(&transfer->lastSaveMs);
+
+    while (client->statistics.completedChunkCount < transfer->chunkCount) {
+        if (client->isCancelled) {
+            return DJI_ERROR_SYSTEM_MODULE_CODE_NONSUPPORT_IN_CURRENT_STATE;
+        }
+
+        /* Hand out the chunks still missing, in file order. */
+        for (i = 0; i < client->config.maxInflight; i++) {
+            inflight = &transfer->inflight[i];
+            if (inflight->isUsed) {
+                continue;
+            }
+            while (transfer->nextChunk < transfer->chunkCount &&
+                   (transfer->bitmap[transfer->nextChunk / 8] & (1 << (transfer->nextChunk % 8)))) {
+                transfer->nextChunk++;
+            }
+            if (transfer->nextChunk == transfer->chunkCount) {
+                break;
+            }
+
+            inflight->chunkIndex = transfer->nextChunk;
+            inflight->retryCount = 0;
+            if (DjiTest_MopFileClientSendRead(client, transfer, inflight) != DJI_ERROR_SYSTEM_MODULE_CODE_SUCCESS) {
+                break;
+            }
+            inflight->isUsed = true;
+            transfer->nextChunk++;
+        }
+
+        /* Wake for the earliest timeout at the latest. */
+        osalHandler->GetTimeMs(&nowMs);
+        waitMs = DJI_TEST_MOP_FILE_WAIT_MAX_MS;
+        for (i = 0; i < client->config.maxInflight; i++) {
+            inflight = &transfer->inflight[i];
+            if (inflight->isUsed) {
+                waitMs = USER_UTIL_MIN(waitMs, nowMs - inflight->sentTimeMs >= client->config.requestTimeoutMs ? 0 :
+                                               client->config.requestTimeoutMs - (nowMs - inflight->sentTimeMs));
+            }
+        }
+        if (waitMs > 0) {
+            osalHandler->SemaphoreTimedWait(client->responseSema, waitMs);
+        }
+
+        while ((response = DjiTest_MopFileClientPopResponse(client)) != NULL) {
+            returnCode = DjiTest_MopFileClientHandleRead(client, transfer, response);
+            osalHandler->Free(response);
+            if (returnCode != DJI_ERROR_SYSTEM_MODULE_CODE_SUCCESS) {
+                return returnCode;
+            }
+        }
+
+        osalHandler->GetTimeMs(&nowMs);
+        for (i = 0; i < client->config.maxInflight; i++) {
+            inflight = &transfer->inflight[i];
+            if (!inflight->isUsed || nowMs - inflight->sentTimeMs < client->config.requestTimeoutMs) {
+                continue;
+            }
+
+            client->statistics.timeoutCount++;
+            if (++inflight->retryCount > client->config.maxRetryCount) {
+                USER_LOG_ERROR("Mop file chunk %u of %s timed out.", inflight->chunkIndex, transfer->remotePath);
+                return DJI_ERROR_SYSTEM_MODULE_CODE_TIMEOUT;
+            }
+            if (DjiTest_MopFileClientSendRead(client, transfer, inflight) != DJI_ERROR_SYSTEM_MODULE_CODE_SUCCESS) {
+                inflight->sentTimeMs = nowMs;
+            }
+        }
+
+        if (transfer->manifestPath != NULL && transfer->isDirty &&
+            nowMs - transfer->lastSaveMs >= client->config.manifestSaveIntervalMs) {
+            DjiTest_MopFileSaveManifest(transfer);
+            transfer->lastSaveMs = nowMs;
+        }
+    }
+
+    return DJI_ERROR_SYSTEM_MODULE_CODE_SUCCESS;
+}
+
+static uint32_t DjiTest_MopFileGetChunkLen(const T_DjiTestMopFileTransfer *transfer, uint32_t chunkIndex)
+{
+    uint64_t chunkOffset = (uint64_t) chunkIndex * transfer->chunkSize;
+
+    return (uint32_t) USER_UTIL_MIN((uint64_t) transfer->chunkSize, transfer->len - chunkOffset);
+}
+
+static T_DjiReturnCode DjiTest_MopFileLoadManifest(T_DjiTestMopFileTransfer *transfer)
+{
+    T_DjiTestMopFileManifestHeader header;
+    char remotePath[DJI_TEST_MOP_FILE_PATH_MAX_LEN];
+    uint8_t md5[DJI_TEST_MOP_FILE_MD5_SIZE];
+    uint32_t bitmapLen = transfer->chunkCount / 8 + 1;
+    bool isValid;
+    FILE *fp;
+
+    fp = fopen(transfer->manifestPath, "rb");
+    if (fp == NULL) {
+        return DJI_ERROR_SYSTEM_MODULE_CODE_NOT_FOUND;
+    }
+
+    isValid = fread(&header, 1, sizeof(header), fp) == sizeof(header) &&
+              header.magic == DJI_TEST_MOP_FILE_MANIFEST_MAGIC &&
+              header.version == DJI_TEST_MOP_FILE_MANIFEST_VERSION &&
+              header.pathLen == strlen(transfer->remotePath) && header.fileSize == transfer->len &&
+              header.modifyTime == transfer->modifyTime && header.chunkSize == transfer->chunkSize &&
+              header.chunkCount == transfer->chunkCount &&
+              fread(remotePath, 1, header.pathLen, fp) == header.pathLen &&
+              memcmp(remotePath, transfer->remotePath, header.pathLen) == 0 &&
+              fread(transfer->bitmap, 1, bitmapLen, fp) == bitmapLen;
+    fclose(fp);
+
+    if (isValid) {
+        DjiTest_MopFileManifestMd5(transfer, md5);
+        isValid = memcmp(md5, header.md5, sizeof(md5)) == 0;
+    }
+    if (!isValid) {
+        USER_LOG_WARN("Mop file manifest %s does not match the remote file, start over.", transfer->manifestPath);
+        memset(transfer->bitmap, 0, bitmapLen);
+        return DJI_ERROR_SYSTEM_MODULE_CODE_INVALID_PARAMETER;
+    }
+
+    return DJI_ERROR_SYSTEM_MODULE_CODE_SUCCESS;
+}
+
+/**
+ * @brief Record the completed chunks. The part file is flushed to disk first so the manifest never names data that a
+ * power loss could take back, and the manifest is replaced by a rename so it is never seen half written.
+ */
+static T_DjiReturnCode DjiTest_MopFileSaveManifest(T_DjiTestMopFileTransfer *transfer)
+{
+    T_DjiTestMopFileManifestHeader header = {0};
+    char tempPath[DJI_TEST_MOP_FILE_PATH_MAX_LEN + DJI_TEST_MOP_FILE_SUFFIX_MAX_LEN + 8];
+    uint32_t bitmapLen = transfer->chunkCount / 8 + 1;
+    bool isWriteOk;
+    FILE *fp;
+
+    if (fflush(transfer->file) != 0 || fsync(fileno(transfer->file)) != 0) {
+        USER_LOG_ERROR("Flush mop file download data error.");
+        return DJI_ERROR_SYSTEM_MODULE_CODE_SYSTEM_ERROR;
+    }
+
+    header.magic = DJI_TEST_MOP_FILE_MANIFEST_MAGIC;
+    header.version = DJI_TEST_MOP_FILE_MANIFEST_VERSION;
+    header.pathLen = strlen(transfer->remotePath);
+    header.fileSize = transfer->len;
+    header.modifyTime = transfer->modifyTime;
+    header.chunkSize = transfer->chunkSize;
+    header.chunkCount = transfer->chunkCount;
+    DjiTest_MopFileManifestMd5(transfer, header.md5);
+
+    snprintf(tempPath, sizeof(tempPath), "%s.tmp", transfer->manifestPath);
+    fp = fopen(tempPath, "wb");
+    if (fp == NULL) {
+        USER_LOG_ERROR("Open mop file manifest %s failed.", tempPath);
+        return DJI_ERROR_SYSTEM_MODULE_CODE_SYSTEM_ERROR;
+    }
+
+    isWriteOk = fwrite(&header, 1, sizeof(header), fp) == sizeof(header) &&
+                fwrite(transfer->remotePath, 1, header.pathLen, fp) == header.pathLen &&
+                fwrite(transfer->bitmap, 1, bitmapLen, fp) == bitmapLen;
+    if (fclose(fp) != 0) {
+        isWriteOk = false;
+    }
+
+    if (!isWriteOk || rename(tempPath, transfer->manifestPath) != 0) {
+        USER_LOG_ERROR("Write mop file manifest %s failed.", transfer->manifestPath);
+        remove(tempPath);
+        return DJI_ERROR_SYSTEM_MODULE_CODE_SYSTEM_ERROR;
+    }
+    transfer->isDirty = false;
+
+    return DJI_ERROR_SYSTEM_MODULE_CODE_SUCCESS;
+}
+
+static void DjiTest_MopFileManifestMd5(const T_DjiTestMopFileTransfer *transfer, uint8_t *md5)
+{
+    MD5_CTX md5Ctx;
+
+    UtilMd5_Init(&md5Ctx);
+    UtilMd5_Update(&md5Ctx, (const uint8_t *) transfer->remotePath, strlen(transfer->remotePath));
+    UtilMd5_Update(&md5Ctx, transfer->bitmap, transfer->chunkCount / 8 + 1);
+    UtilMd5_Final(&md5Ctx, md5);
+}
+
+#endif
+
+/****************** (C) COPYRIGHT DJI Innovations *****END OF FILE****/
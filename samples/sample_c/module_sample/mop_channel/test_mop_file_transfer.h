@@ -0,0 +1,176 @@
+/**
+ ********************************************************************
+ * @file    test_mop_file_transfer.h
+ * @brief   This is the header file for "test_mop_file_transfer.c", defining the structure and
+ * (exported) function prototypes.
+ *
+ * @copyright (c) 2021 DJI. All rights reserved.
+ *
+ * All information contained herein is, and remains, the property of DJI.
+ * The intellectual and technical concepts contained herein are proprietary
+ * to DJI and may be covered by U.S. and foreign patents, patents in process,
+ * and protected by trade secret or copyright law.  Dissemination of this
+ * information, including but not limited to data and other proprietary
+ * material(s) incorporated within the information, in any form, is strictly
+ * prohibited without the express written consent of DJI.
+ *
+ * If you receive this source code without DJI’s authorization, you may not
+ * further disseminate the information, and you must immediately remove the
+ * source code and notify DJI of its removal. DJI reserves the right to pursue
+ * legal actions against you for any loss(es) or damage(s) caused by your
+ * failure to do so.
+ *
+ *********************************************************************
+ */
+
+/* Define to prevent recursive inclusion -------------------------------------*/
+#ifndef TEST_MOP_FILE_TRANSFER_H
+#define TEST_MOP_FILE_TRANSFER_H
+
+/* Includes ------------------------------------------------------------------*/
+#include "dji_typedef.h"
+#include "dji_platform.h"
+#include "test_mop_channel_mux.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#ifdef SYSTEM_ARCH_LINUX
+
+/* Exported constants --------------------------------------------------------*/
+#define DJI_TEST_MOP_FILE_HEADER_SIZE           (8)
+#define DJI_TEST_MOP_FILE_PATH_MAX_LEN          (DJI_FILE_PATH_SIZE_MAX)
+#define DJI_TEST_MOP_FILE_CHUNK_MAX_SIZE        (512 * 1024)
+#define DJI_TEST_MOP_FILE_INFLIGHT_MAX_NUM      (32)
+#define DJI_TEST_MOP_FILE_LIST_MAX_NUM          (64)
+#define DJI_TEST_MOP_FILE_MD5_SIZE              (16)
+/* Response of the largest request, a chunk or a full page of listing. */
+#define DJI_TEST_MOP_FILE_MESSAGE_MAX_SIZE      (DJI_TEST_MOP_FILE_HEADER_SIZE + 32 + DJI_TEST_MOP_FILE_CHUNK_MAX_SIZE)
+
+/* Exported types ------------------------------------------------------------*/
+/**
+ * @brief Requests and their responses, one mux message each. A message starts with the little endian header
+ * {opcode u8, status u8, reserved u16, requestId u32}, the response echoes the opcode and requestId.
+ */
+typedef enum {
+    DJI_TEST_MOP_FILE_OP_STAT = 1,      /*!< {pathLen u16, path} -> {size u64, modifyTime u64, isDirectory u8} */
+    DJI_TEST_MOP_FILE_OP_READ = 2,      /*!< {offset u64, len u32, pathLen u16, path} -> {offset u64, len u32,
+                                             md5[16], data} */
+    DJI_TEST_MOP_FILE_OP_LIST = 3,      /*!< {maxEntries u16, pathLen u16, cursorLen u16, path, cursor} ->
+                                             {count u16, isEnd u8, {isDirectory u8, size u64, modifyTime u64,
+                                             nameLen u16, name} * count} */
+} E_DjiTestMopFileOpcode;
+
+typedef enum {
+    DJI_TEST_MOP_FILE_STATUS_OK = 0,
+    DJI_TEST_MOP_FILE_STATUS_NOT_FOUND = 1,
+    DJI_TEST_MOP_FILE_STATUS_INVALID = 2,   /*!< Malformed request, a path leaving the root or a range past the end. */
+    DJI_TEST_MOP_FILE_STATUS_IO_ERROR = 3,
+} E_DjiTestMopFileStatus;
+
+typedef struct {
+    char name[DJI_FILE_NAME_SIZE_MAX];
+    bool isDirectory;
+    uint64_t size;
+    uint64_t modifyTime;                /*!< Seconds since the epoch. */
+} T_DjiTestMopFileEntry;
+
+/**
+ * @brief Serves files below a root directory on one stream of a multiplexer.
+ * @note Requests are handled in the caller of DjiTest_MopFileServerInput, usually the OnMessage callback of the mux.
+ * The file of the last read stays open for the following chunks. A response the mux refuses is dropped and requested
+ * again after the client timeout, so the sendQueueSize of the server mux should hold maxInflight chunks of the client.
+ */
+typedef struct {
+    T_DjiTestMopMux *mux;
+    uint16_t streamId;
+    char rootPath[DJI_TEST_MOP_FILE_PATH_MAX_LEN];
+    uint8_t *responseBuffer;
+    FILE *openFile;
+    char openPath[DJI_TEST_MOP_FILE_PATH_MAX_LEN];
+    uint32_t requestCount;
+    uint32_t droppedResponseCount;      /*!< Responses the mux refused, the client requests them again. */
+} T_DjiTestMopFileServer;
+
+typedef struct {
+    uint64_t fileSize;
+    uint32_t chunkCount;
+    uint32_t completedChunkCount;
+    uint64_t resumedBytes;              /*!< Bytes already present from an earlier, interrupted download. */
+    uint64_t receivedBytes;             /*!< Bytes received by this download. */
+    uint32_t requestCount;
+    uint32_t timeoutCount;
+    uint32_t hashErrorCount;
+    uint32_t lateResponseCount;         /*!< Responses to requests that had already been sent again. */
+    uint32_t elapsedMs;
+} T_DjiTestMopFileTransferStatistics;
+
+typedef void (*DjiTestMopFileProgressCallback)(void *userData, const T_DjiTestMopFileTransferStatistics *statistics);
+
+typedef struct {
+    uint32_t chunkSize;                 /*!< Bytes per read request, at most DJI_TEST_MOP_FILE_CHUNK_MAX_SIZE. */
+    uint32_t maxInflight;               /*!< Read requests outstanding at the same time. */
+    uint32_t requestTimeoutMs;          /*!< A request without response for this long is sent again. */
+    uint32_t maxRetryCount;             /*!< Consecutive timeouts of a chunk before the download gives up. */
+    uint32_t manifestSaveIntervalMs;    /*!< Longest time completed chunks stay unrecorded in the manifest. */
+    DjiTestMopFileProgressCallback progressCallback;
+    void *userData;
+} T_DjiTestMopFileClientConfig;
+
+typedef struct T_DjiTestMopFileResponse T_DjiTestMopFileResponse;
+
+/**
+ * @brief Fetches files, byte ranges and directory listings from a file server.
+ * @note Operations block the calling task and are serialized. Responses are queued by DjiTest_MopFileClientInput on
+ * the mux io task and verified and written on the calling task, so hashing and disk writes overlap the transfer.
+ * A download keeps its data in "<localPath>.part" and the completed chunks in "<localPath>.manifest", a download of
+ * the same remote file restarted after a failure or a reboot fetches only the missing chunks.
+ */
+typedef struct {
+    T_DjiTestMopFileClientConfig config;
+    T_DjiTestMopMux *mux;
+    uint16_t streamId;
+    T_DjiMutexHandle operationMutex;
+    T_DjiMutexHandle responseMutex;
+    T_DjiSemaHandle responseSema;
+    T_DjiTestMopFileResponse *responseHead;
+    T_DjiTestMopFileResponse *responseTail;
+    uint32_t nextRequestId;
+    bool isCancelled;
+    T_DjiTestMopFileTransferStatistics statistics;
+} T_DjiTestMopFileClient;
+
+/* Exported functions --------------------------------------------------------*/
+T_DjiReturnCode DjiTest_MopFileServerInit(T_DjiTestMopFileServer *server, T_DjiTestMopMux *mux, uint16_t streamId,
+                                          const char *rootPath);
+T_DjiReturnCode DjiTest_MopFileServerDeInit(T_DjiTestMopFileServer *server);
+T_DjiReturnCode DjiTest_MopFileServerInput(T_DjiTestMopFileServer *server, const uint8_t *data, uint32_t len);
+
+void DjiTest_MopFileClientGetDefaultConfig(T_DjiTestMopFileClientConfig *config);
+T_DjiReturnCode DjiTest_MopFileClientInit(T_DjiTestMopFileClient *client, const T_DjiTestMopFileClientConfig *config,
+                                          T_DjiTestMopMux *mux, uint16_t streamId);
+T_DjiReturnCode DjiTest_MopFileClientDeInit(T_DjiTestMopFileClient *client);
+T_DjiReturnCode DjiTest_MopFileClientInput(T_DjiTestMopFileClient *client, const uint8_t *data, uint32_t len);
+
+T_DjiReturnCode DjiTest_MopFileClientStat(T_DjiTestMopFileClient *client, const char *remotePath,
+                                          T_DjiTestMopFileEntry *entry);
+T_DjiReturnCode DjiTest_MopFileClientList(T_DjiTestMopFileClient *client, const char *remotePath, const char *cursor,
+                                          T_DjiTestMopFileEntry *entries, uint32_t maxEntries, uint32_t *count,
+                                          bool *isEnd);
+T_DjiReturnCode DjiTest_MopFileClientReadRange(T_DjiTestMopFileClient *client, const char *remotePath,
+                                               uint64_t offset, uint32_t len, uint8_t *buffer);
+T_DjiReturnCode DjiTest_MopFileClientDownload(T_DjiTestMopFileClient *client, const char *remotePath,
+                                              const char *localPath);
+void DjiTest_MopFileClientCancel(T_DjiTestMopFileClient *client);
+void DjiTest_MopFileClientGetStatistics(T_DjiTestMopFileClient *client,
+                                        T_DjiTestMopFileTransferStatistics *statistics);
+
+#endif
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // TEST_MOP_FILE_TRANSFER_H
+/************************ (C) COPYRIGHT DJI Innovations *******END OF FILE******/
@@ -32,6 +32,8 @@
 #include "utils/util_misc.h"
 #include "dji_platform.h"
 #include "time_sync/test_time_sync.h"
+#include "test_rtcm_recorder.h"
+#include "flight_recorder/test_flight_recorder.h"
 
 #ifdef SYSTEM_ARCH_LINUX
 
@@ -42,7 +44,6 @@
 /* Private constants ---------------------------------------------------------*/
 #define POSITIONING_TASK_FREQ                     (0.1)
 #define POSITIONING_TASK_STACK_SIZE               (3 * 1024)
-#define TEST_RTCM_FILE_PATH_STR_MAX_SIZE          (64)
 
 #define DJI_TEST_POSITIONING_EVENT_COUNT          (1)
 #define DJI_TEST_TIME_INTERVAL_AMONG_EVENTS_US    (200000)
@@ -55,13 +56,23 @@ static T_DjiReturnCode DjiTest_ReceiveRtkOnAircraftRtcmDataCallback(uint8_t inde
                                                                     uint16_t dataLen);
 static T_DjiReturnCode DjiTest_ReceiveRtkBaseStationRtcmDataCallback(uint8_t index, const uint8_t *data,
                                                                      uint16_t dataLen);
+#ifdef SYSTEM_ARCH_LINUX
+static void DjiTest_PositioningAddRecordChannel(const char *channelName, uint16_t *channelId, bool *isAdded);
+static void DjiTest_PositioningRecordRtcm(uint16_t channelId, uint8_t index, const uint8_t *data, uint16_t dataLen);
+static void DjiTest_PositioningReplayRtcm(const T_DjiTestFlightRecordSample *sample, void *userData);
+#endif
 
 /* Private variables ---------------------------------------------------------*/
 static T_DjiTaskHandle s_userPositioningThread;
 static int32_t s_eventIndex = 0;
 #ifdef SYSTEM_ARCH_LINUX
-static char s_rtkOnAircraftRtcmFilePath[TEST_RTCM_FILE_PATH_STR_MAX_SIZE];
-static char s_rtkBaseStationRtcmFilePath[TEST_RTCM_FILE_PATH_STR_MAX_SIZE];
+static T_DjiTestRtcmRecorder s_rtkOnAircraftRtcmRecorder;
+static T_DjiTestRtcmRecorder s_rtkBaseStationRtcmRecorder;
+static bool s_isRtcmRecorderOpened = false;
+static uint16_t s_rtkOnAircraftRecordChannelId;
+static bool s_isRtkOnAircraftRecordChannelAdded = false;
+static uint16_t s_rtkBaseStationRecordChannelId;
+static bool s_isRtkBaseStationRecordChannelAdded = false;
 #endif
 
 /* Exported functions definition ---------------------------------------------*/
@@ -86,18 +97,29 @@ T_DjiReturnCode DjiTest_PositioningStartService(void)
         return DJI_ERROR_SYSTEM_MODULE_CODE_UNKNOWN;
     }
 #else
-    time_t currentTime = time(NULL);
-    struct tm *localTime = NULL;
-
-    localTime = localtime(&currentTime);
-    sprintf(s_rtkOnAircraftRtcmFilePath, "rtk_on_aircraft_%04d%02d%02d_%02d-%02d-%02d.rtcm",
-            localTime->tm_year + 1900, localTime->tm_mon + 1, localTime->tm_mday,
-            localTime->tm_hour, localTime->tm_min, localTime->tm_sec);
-
-    localTime = localtime(&currentTime);
-    sprintf(s_rtkBaseStationRtcmFilePath, "rtk_base_station_%04d%02d%02d_%02d-%02d-%02d.rtcm",
-            localTime->tm_year + 1900, localTime->tm_mon + 1, localTime->tm_mday,
-            localTime->tm_hour, localTime->tm_min, localTime->tm_sec);
+    T_DjiTestRtcmRecorderConfig rtcmRecorderConfig;
+
+    DjiTest_RtcmRecorderGetDefaultConfig(&rtcmRecorderConfig);
+    rtcmRecorderConfig.prefix = "rtk_on_aircraft";
+    djiStat = DjiTest_RtcmRecorderOpen(&s_rtkOnAircraftRtcmRecorder, &rtcmRecorderConfig);
+    if (djiStat != DJI_ERROR_SYSTEM_MODULE_CODE_SUCCESS) {
+        USER_LOG_ERROR("Open rtk on aircraft rtcm recorder error.");
+        return djiStat;
+    }
+
+    rtcmRecorderConfig.prefix = "rtk_base_station";
+    djiStat = DjiTest_RtcmRecorderOpen(&s_rtkBaseStationRtcmRecorder, &rtcmRecorderConfig);
+    if (djiStat != DJI_ERROR_SYSTEM_MODULE_CODE_SUCCESS) {
+        USER_LOG_ERROR("Open rtk base station rtcm recorder error.");
+        DjiTest_RtcmRecorderClose(&s_rtkOnAircraftRtcmRecorder);
+        return djiStat;
+    }
+    s_isRtcmRecorderOpened = true;
+
+    DjiTest_PositioningAddRecordChannel("rtk/on_aircraft", &s_rtkOnAircraftRecordChannelId,
+                                        &s_isRtkOnAircraftRecordChannelAdded);
+    DjiTest_PositioningAddRecordChannel("rtk/base_station", &s_rtkBaseStationRecordChannelId,
+                                        &s_isRtkBaseStationRecordChannelAdded);
 #endif
     djiStat = DjiPositioning_RegReceiveRtcmDataCallback(DJI_POSITIONING_RTCM_DATA_TYPE_RTK_BASE_STATION,
                                                         DjiTest_ReceiveRtkBaseStationRtcmDataCallback);
@@ -116,6 +138,41 @@ T_DjiReturnCode DjiTest_PositioningStartService(void)
     return DJI_ERROR_SYSTEM_MODULE_CODE_SUCCESS;
 }
 
+/**
+ * @brief Stop the positioning sample. The rtcm recorders are flushed and closed, so the tail of the streams
+ * and the index files are complete on disk. Call it from the exit path of the application. The rtcm callbacks stay
+ * registered, data they receive later is rejected by the closed recorders.
+ * @return Execution result.
+ */
+T_DjiReturnCode DjiTest_PositioningStopService(void)
+{
+#ifdef SYSTEM_ARCH_LINUX
+    T_DjiReturnCode djiStat;
+    T_DjiReturnCode returnCode = DJI_ERROR_SYSTEM_MODULE_CODE_SUCCESS;
+
+    if (!s_isRtcmRecorderOpened) {
+        return DJI_ERROR_SYSTEM_MODULE_CODE_SUCCESS;
+    }
+    s_isRtcmRecorderOpened = false;
+
+    djiStat = DjiTest_RtcmRecorderClose(&s_rtkOnAircraftRtcmRecorder);
+    if (djiStat != DJI_ERROR_SYSTEM_MODULE_CODE_SUCCESS) {
+        USER_LOG_ERROR("Close rtk on aircraft rtcm recorder error: 0x%08llX.", djiStat);
+        returnCode = djiStat;
+    }
+
+    djiStat = DjiTest_RtcmRecorderClose(&s_rtkBaseStationRtcmRecorder);
+    if (djiStat != DJI_ERROR_SYSTEM_MODULE_CODE_SUCCESS) {
+        USER_LOG_ERROR("Close rtk base station rtcm recorder error: 0x%08llX.", djiStat);
+        returnCode = djiStat;
+    }
+
+    return returnCode;
+#else
+    return DJI_ERROR_SYSTEM_MODULE_CODE_SUCCESS;
+#endif
+}
+
 static void DjiTest_ReceiveNetworkRtkStateCallback(E_DjiNetworkRtkOnboardState state)
 {
     USER_LOG_INFO("Network rtk state: %d", state);
@@ -246,37 +303,16 @@ static void *DjiTest_PositioningTask(void *arg)
 #pragma GCC diagnostic pop
 #endif
 
-#ifdef SYSTEM_ARCH_LINUX
-static int32_t DjiTest_SaveRtcmData(char *filePath, const uint8_t *data, uint32_t len)
-{
-    FILE *fp = NULL;
-    size_t size;
-
-    fp = fopen(filePath, "ab+");
-    if (fp == NULL) {
-        printf("fopen failed!\n");
-        return -1;
-    }
-
-    size = fwrite(data, 1, len, fp);
-    if (size != len) {
-        fclose(fp);
-        return -1;
-    }
-
-    fflush(fp);
-    fclose(fp);
-    return 0;
-}
-#endif
-
 static T_DjiReturnCode DjiTest_ReceiveRtkOnAircraftRtcmDataCallback(uint8_t index, const uint8_t *data,
                                                                     uint16_t dataLen)
 {
     USER_LOG_INFO("Receive rtcm data from rtk on aircraft, index: %d, len: %d", index, dataLen);
 
 #ifdef SYSTEM_ARCH_LINUX
-    DjiTest_SaveRtcmData(s_rtkOnAircraftRtcmFilePath, data, dataLen);
+    DjiTest_RtcmRecorderWrite(&s_rtkOnAircraftRtcmRecorder, data, dataLen);
+    if (s_isRtkOnAircraftRecordChannelAdded) {
+        DjiTest_PositioningRecordRtcm(s_rtkOnAircraftRecordChannelId, index, data, dataLen);
+    }
 #endif
     return DJI_ERROR_SYSTEM_MODULE_CODE_SUCCESS;
 }
@@ -287,10 +323,56 @@ static T_DjiReturnCode DjiTest_ReceiveRtkBaseStationRtcmDataCallback(uint8_t ind
     USER_LOG_INFO("Receive rtcm data from rtk base station, index: %d, len: %d", index, dataLen);
 
 #ifdef SYSTEM_ARCH_LINUX
-    DjiTest_SaveRtcmData(s_rtkBaseStationRtcmFilePath, data, dataLen);
+    DjiTest_RtcmRecorderWrite(&s_rtkBaseStationRtcmRecorder, data, dataLen);
+    if (s_isRtkBaseStationRecordChannelAdded) {
+        DjiTest_PositioningRecordRtcm(s_rtkBaseStationRecordChannelId, index, data, dataLen);
+    }
 #endif
     return DJI_ERROR_SYSTEM_MODULE_CODE_SUCCESS;
 }
 
+#ifdef SYSTEM_ARCH_LINUX
+static void DjiTest_PositioningAddRecordChannel(const char *channelName, uint16_t *channelId, bool *isAdded)
+{
+    T_DjiTestFlightRecorderChannelInfo channelInfo = {
+        .name = channelName,
+        .schemaName = "dji.positioning.rtcm",
+        .layout = "index:u8 rtcm:bytes",
+    };
+    T_DjiReturnCode returnCode;
+
+    returnCode = DjiTest_FlightRecorderAddChannel(&channelInfo, DjiTest_PositioningReplayRtcm, isAdded, channelId);
+    if (returnCode != DJI_ERROR_SYSTEM_MODULE_CODE_SUCCESS) {
+        USER_LOG_WARN("Add flight record channel %s error, stat = 0x%08llX", channelName, returnCode);
+        return;
+    }
+
+    *isAdded = true;
+}
+
+static void DjiTest_PositioningRecordRtcm(uint16_t channelId, uint8_t index, const uint8_t *data, uint16_t dataLen)
+{
+    if (!DjiTest_FlightRecorderIsRecording()) {
+        return;
+    }
+
+    DjiTest_FlightRecorderWrite(channelId, 0, &index, sizeof(index), data, dataLen);
+}
+
+static void DjiTest_PositioningReplayRtcm(const T_DjiTestFlightRecordSample *sample, void *userData)
+{
+    if (sample->headerLen != sizeof(uint8_t) || sample->dataLen > UINT16_MAX) {
+        return;
+    }
+
+    /* The user data tells the two channels apart, see DjiTest_PositioningAddRecordChannel. */
+    if (userData == &s_isRtkOnAircraftRecordChannelAdded) {
+        DjiTest_ReceiveRtkOnAircraftRtcmDataCallback(sample->header[0], sample->data, (uint16_t) sample->dataLen);
+    } else {
+        DjiTest_ReceiveRtkBaseStationRtcmDataCallback(sample->header[0], sample->data, (uint16_t) sample->dataLen);
+    }
+}
+#endif
+
 
 /****************** (C) COPYRIGHT DJI Innovations *****END OF FILE****/
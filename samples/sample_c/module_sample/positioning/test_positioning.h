@@ -47,6 +47,7 @@ typedef enum {
 
 /* Exported functions --------------------------------------------------------*/
 T_DjiReturnCode DjiTest_PositioningStartService(void);
+T_DjiReturnCode DjiTest_PositioningStopService(void);
 T_DjiReturnCode DjiTest_NetworkRtkOnBoardService(E_DjiTestNetworkRtkCtrl ctrl);
 
 #ifdef __cplusplus
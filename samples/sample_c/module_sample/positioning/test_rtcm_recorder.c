@@ -0,0 +1,527 @@
+/**
+ ********************************************************************
+ * @file    test_rtcm_recorder.c
+ * @brief   Buffered RTCM3 stream recorder with frame indexing and file rotation.
+ *
+ * @copyright (c) 2021 DJI. All rights reserved.
+ *
+ * All information contained herein is, and remains, the property of DJI.
+ * The intellectual and technical concepts contained herein are proprietary
+ * to DJI and may be covered by U.S. and foreign patents, patents in process,
+ * and protected by trade secret or copyright law.  Dissemination of this
+ * information, including but not limited to data and other proprietary
+ * material(s) incorporated within the information, in any form, is strictly
+ * prohibited without the express written consent of DJI.
+ *
+ * If you receive this source code without DJI’s authorization, you may not
+ * further disseminate the information, and you must immediately remove the
+ * source code and notify DJI of its removal. DJI reserves the right to pursue
+ * legal actions against you for any loss(es) or damage(s) caused by your
+ * failure to do so.
+ *
+ *********************************************************************
+ */
+
+
+/* Includes ------------------------------------------------------------------*/
+#include "test_rtcm_recorder.h"
+
+#ifdef SYSTEM_ARCH_LINUX
+
+#include <stddef.h>
+#include <string.h>
+#include <time.h>
+#include <pthread.h>
+#include "dji_logger.h"
+
+/* Private constants ---------------------------------------------------------*/
+#define DJI_TEST_RTCM_PREAMBLE                      0xD3
+#define DJI_TEST_RTCM_HEADER_SIZE                   3
+#define DJI_TEST_RTCM_CRC_SIZE                      3
+#define DJI_TEST_RTCM_CRC24Q_POLY                   0x1864CFB
+#define DJI_TEST_RTCM_INDEX_VERSION                 1
+#define DJI_TEST_RTCM_INDEX_MAGIC                   "RTCMIDX1"
+#define DJI_TEST_RTCM_TYPE_MAGIC                    "RTCMTYPE"
+#define DJI_TEST_RTCM_MAGIC_SIZE                    8
+#define DJI_TEST_RTCM_DEFAULT_BUFFER_SIZE           (64 * 1024)
+#define DJI_TEST_RTCM_DEFAULT_ROTATE_SIZE           (64 * 1024 * 1024)
+#define DJI_TEST_RTCM_DEFAULT_ROTATE_INTERVAL_S     (3600)
+#define DJI_TEST_RTCM_DEFAULT_FLUSH_INTERVAL_MS     (2000)
+
+/* Private types -------------------------------------------------------------*/
+#pragma pack(1)
+typedef struct {
+    char magic[DJI_TEST_RTCM_MAGIC_SIZE];
+    uint16_t version;
+    uint16_t entrySize;
+    uint16_t summarySize;
+    uint16_t fileNumber;
+    uint64_t openTime;              /*!< Unix time in seconds. */
+    uint64_t openTimestampUs;       /*!< Local OSAL time matching openTime. */
+} T_DjiTestRtcmIndexHeader;
+
+/**
+ * @brief Written at close after the type summaries, a file without it was cut short and is read entry by entry.
+ */
+typedef struct {
+    char magic[DJI_TEST_RTCM_MAGIC_SIZE];
+    uint32_t summaryCount;
+    uint32_t summaryOffset;
+} T_DjiTestRtcmIndexTrailer;
+#pragma pack()
+
+/* Private functions declaration ---------------------------------------------*/
+static T_DjiReturnCode DjiTest_RtcmRecorderOpenFiles(T_DjiTestRtcmRecorder *recorder);
+static T_DjiReturnCode DjiTest_RtcmRecorderCloseFiles(T_DjiTestRtcmRecorder *recorder);
+static T_DjiReturnCode DjiTest_RtcmRecorderParse(T_DjiTestRtcmRecorder *recorder);
+static T_DjiReturnCode DjiTest_RtcmRecorderWriteFrame(T_DjiTestRtcmRecorder *recorder, const uint8_t *frame,
+                                                      uint32_t length);
+static T_DjiReturnCode DjiTest_RtcmRecorderWriteRaw(T_DjiTestRtcmRecorder *recorder, const uint8_t *data,
+                                                    uint32_t length);
+static void DjiTest_RtcmRecorderCountType(T_DjiTestRtcmRecorder *recorder, uint16_t messageType);
+static void DjiTest_RtcmInitCrcTable(void);
+
+/* Private values ------------------------------------------------------------*/
+static uint32_t s_rtcmCrc24qTable[256];
+static pthread_once_t s_rtcmCrcTableOnce = PTHREAD_ONCE_INIT;
+
+/* Exported functions definition ---------------------------------------------*/
+void DjiTest_RtcmRecorderGetDefaultConfig(T_DjiTestRtcmRecorderConfig *config)
+{
+    config->directory = NULL;
+    config->prefix = "rtcm";
+    config->bufferSize = DJI_TEST_RTCM_DEFAULT_BUFFER_SIZE;
+    config->rotateSize = DJI_TEST_RTCM_DEFAULT_ROTATE_SIZE;
+    config->rotateIntervalS = DJI_TEST_RTCM_DEFAULT_ROTATE_INTERVAL_S;
+    config->flushIntervalMs = DJI_TEST_RTCM_DEFAULT_FLUSH_INTERVAL_MS;
+}
+
+T_DjiReturnCode DjiTest_RtcmRecorderOpen(T_DjiTestRtcmRecorder *recorder, const T_DjiTestRtcmRecorderConfig *config)
+{
+    T_DjiOsalHandler *osalHandler = DjiPlatform_GetOsalHandler();
+    T_DjiReturnCode returnCode;
+
+    if (recorder == NULL || config == NULL || config->prefix == NULL || config->bufferSize < 1024 ||
+        strlen(config->prefix) >= DJI_TEST_RTCM_PREFIX_MAX_SIZE ||
+        (config->directory != NULL && strlen(config->directory) >= DJI_TEST_RTCM_FILE_PATH_MAX_SIZE)) {
+        return DJI_ERROR_SYSTEM_MODULE_CODE_INVALID_PARAMETER;
+    }
+
+    pthread_once(&s_rtcmCrcTableOnce, DjiTest_RtcmInitCrcTable);
+
+    if (recorder->mutex == NULL) {
+        returnCode = osalHandler->MutexCreate(&recorder->mutex);
+        if (returnCode != DJI_ERROR_SYSTEM_MODULE_CODE_SUCCESS) {
+            USER_LOG_ERROR("Create rtcm recorder mutex failed, return code:0x%08X", returnCode);
+            return returnCode;
+        }
+    }
+
+    osalHandler->MutexLock(recorder->mutex);
+    if (recorder->dataFile != NULL) {
+        osalHandler->MutexUnlock(recorder->mutex);
+        return DJI_ERROR_SYSTEM_MODULE_CODE_NONSUPPORT_IN_CURRENT_STATE;
+    }
+
+    memset(&recorder->config, 0, sizeof(T_DjiTestRtcmRecorder) - offsetof(T_DjiTestRtcmRecorder, config));
+    recorder->config = *config;
+    strcpy(recorder->prefix, config->prefix);
+    strcpy(recorder->directory, config->directory != NULL ? config->directory : ".");
+
+    recorder->dataBuffer = osalHandler->Malloc(config->bufferSize);
+    recorder->indexBuffer = osalHandler->Malloc(config->bufferSize / 4);
+    if (recorder->dataBuffer == NULL || recorder->indexBuffer == NULL) {
+        USER_LOG_ERROR("Malloc rtcm recorder buffer failed.");
+        returnCode = DJI_ERROR_SYSTEM_MODULE_CODE_MEMORY_ALLOC_FAILED;
+        goto FreeBuffer;
+    }
+
+    returnCode = DjiTest_RtcmRecorderOpenFiles(recorder);
+    if (returnCode != DJI_ERROR_SYSTEM_MODULE_CODE_SUCCESS) {
+        goto FreeBuffer;
+    }
+    osalHandler->MutexUnlock(recorder->mutex);
+
+    return DJI_ERROR_SYSTEM_MODULE_CODE_SUCCESS;
+
+FreeBuffer:
+    osalHandler->Free(recorder->dataBuffer);
+    osalHandler->Free(recorder->indexBuffer);
+    recorder->dataBuffer = NULL;
+    recorder->indexBuffer = NULL;
+    osalHandler->MutexUnlock(recorder->mutex);
+
+    return returnCode;
+}
+
+T_DjiReturnCode DjiTest_RtcmRecorderWrite(T_DjiTestRtcmRecorder *recorder, const uint8_t *data, uint32_t len)
+{
+    T_DjiOsalHandler *osalHandler = DjiPlatform_GetOsalHandler();
+    T_DjiReturnCode returnCode = DJI_ERROR_SYSTEM_MODULE_CODE_SUCCESS;
+    uint32_t timeMs = 0;
+    uint32_t copyLen;
+
+    if (recorder == NULL || recorder->mutex == NULL || (data == NULL && len > 0)) {
+        return DJI_ERROR_SYSTEM_MODULE_CODE_INVALID_PARAMETER;
+    }
+
+    osalHandler->MutexLock(recorder->mutex);
+    if (recorder->dataFile == NULL) {
+        osalHandler->MutexUnlock(recorder->mutex);
+        return DJI_ERROR_SYSTEM_MODULE_CODE_NONSUPPORT_IN_CURRENT_STATE;
+    }
+
+    recorder->statistics.totalBytes += len;
+    while (len > 0 && returnCode == DJI_ERROR_SYSTEM_MODULE_CODE_SUCCESS) {
+        copyLen = DJI_TEST_RTCM_FRAME_MAX_SIZE - recorder->frameLen;
+        copyLen = copyLen < len ? copyLen : len;
+        memcpy(recorder->frame + recorder->frameLen, data, copyLen);
+        recorder->frameLen += copyLen;
+        data += copyLen;
+        len -= copyLen;
+
+        returnCode = DjiTest_RtcmRecorderParse(recorder);
+    }
+
+    osalHandler->GetTimeMs(&timeMs);
+    if (returnCode == DJI_ERROR_SYSTEM_MODULE_CODE_SUCCESS &&
+        timeMs - recorder->lastFlushTimeMs >= recorder->config.flushIntervalMs) {
+        if (fflush(recorder->dataFile) != 0 || fflush(recorder->indexFile) != 0) {
+            returnCode = DJI_ERROR_SYSTEM_MODULE_CODE_SYSTEM_ERROR;
+        }
+        recorder->lastFlushTimeMs = timeMs;
+        recorder->statistics.flushCount++;
+    }
+    osalHandler->MutexUnlock(recorder->mutex);
+
+    return returnCode;
+}
+
+T_DjiReturnCode DjiTest_RtcmRecorderFlush(T_DjiTestRtcmRecorder *recorder)
+{
+    T_DjiOsalHandler *osalHandler = DjiPlatform_GetOsalHandler();
+    T_DjiReturnCode returnCode = DJI_ERROR_SYSTEM_MODULE_CODE_SUCCESS;
+
+    if (recorder == NULL || recorder->mutex == NULL) {
+        return DJI_ERROR_SYSTEM_MODULE_CODE_INVALID_PARAMETER;
+    }
+
+    osalHandler->MutexLock(recorder->mutex);
+    if (recorder->dataFile != NULL) {
+        if (fflush(recorder->dataFile) != 0 || fflush(recorder->indexFile) != 0) {
+            returnCode = DJI_ERROR_SYSTEM_MODULE_CODE_SYSTEM_ERROR;
+        }
+        osalHandler->GetTimeMs(&recorder->lastFlushTimeMs);
+        recorder->statistics.flushCount++;
+    }
+    osalHandler->MutexUnlock(recorder->mutex);
+
+    return returnCode;
+}
+
+T_DjiReturnCode DjiTest_RtcmRecorderClose(T_DjiTestRtcmRecorder *recorder)
+{
+    T_DjiOsalHandler *osalHandler = DjiPlatform_GetOsalHandler();
+    T_DjiReturnCode returnCode = DJI_ERROR_SYSTEM_MODULE_CODE_SUCCESS;
+
+    if (recorder == NULL || recorder->mutex == NULL) {
+        return DJI_ERROR_SYSTEM_MODULE_CODE_INVALID_PARAMETER;
+    }
+
+    osalHandler->MutexLock(recorder->mutex);
+    if (recorder->dataFile != NULL) {
+        /* A partial frame at the end never completes, keep its bytes as received. */
+        DjiTest_RtcmRecorderWriteRaw(recorder, recorder->frame, recorder->frameLen);
+        recorder->statistics.discardedBytes += recorder->frameLen;
+        recorder->frameLen = 0;
+        returnCode = DjiTest_RtcmRecorderCloseFiles(recorder);
+    }
+    /* The files hold no pointer to the buffers after fclose, writes that follow see no data file and leave. */
+    osalHandler->Free(recorder->dataBuffer);
+    osalHandler->Free(recorder->indexBuffer);
+    recorder->dataBuffer = NULL;
+    recorder->indexBuffer = NULL;
+    osalHandler->MutexUnlock(recorder->mutex);
+
+    return returnCode;
+}
+
+void DjiTest_RtcmRecorderGetStatistics(T_DjiTestRtcmRecorder *recorder, T_DjiTestRtcmRecorderStatistics *statistics)
+{
+    T_DjiOsalHandler *osalHandler = DjiPlatform_GetOsalHandler();
+
+    if (recorder->mutex == NULL) {
+        *statistics = recorder->statistics;
+        return;
+    }
+
+    osalHandler->MutexLock(recorder->mutex);
+    *statistics = recorder->statistics;
+    osalHandler->MutexUnlock(recorder->mutex);
+}
+
+uint32_t DjiTest_RtcmCrc24q(const uint8_t *data, uint32_t len)
+{
+    uint32_t crc = 0;
+    uint32_t i;
+
+    pthread_once(&s_rtcmCrcTableOnce, DjiTest_RtcmInitCrcTable);
+    for (i = 0; i < len; i++) {
+        crc = ((crc << 8) & 0xFFFFFF) ^ s_rtcmCrc24qTable[((crc >> 16) ^ data[i]) & 0xFF];
+    }
+
+    return crc;
+}
+
+/* Private functions definition-----------------------------------------------*/
+static T_DjiReturnCode DjiTest_RtcmRecorderOpenFiles(T_DjiTestRtcmRecorder *recorder)
+{
+    T_DjiOsalHandler *osalHandler = DjiPlatform_GetOsalHandler();
+    char filePath[DJI_TEST_RTCM_FILE_PATH_MAX_SIZE + DJI_TEST_RTCM_PREFIX_MAX_SIZE + 32];
+    T_DjiTestRtcmIndexHeader header = {0};
+    time_t currentTime = time(NULL);
+    struct tm localTime;
+    uint64_t timestampUs = 0;
+    int pathLen;
+
+    localtime_r(&currentTime, &localTime);
+    pathLen = snprintf(filePath, sizeof(filePath), "%s/%s_%04d%02d%02d_%02d-%02d-%02d_%03u.rtcm",
+                       recorder->directory, recorder->prefix, localTime.tm_year + 1900, localTime.tm_mon + 1,
+                       localTime.tm_mday, localTime.tm_hour, localTime.tm_min, localTime.tm_sec,
+                       recorder->fileNumber);
+
+    recorder->dataFile = fopen(filePath, "wb");
+    if (recorder->dataFile == NULL) {
+        USER_LOG_ERROR("Open rtcm file %s failed.", filePath);
+        return DJI_ERROR_SYSTEM_MODULE_CODE_SYSTEM_ERROR;
+    }
+
+    strcpy(filePath + pathLen - strlen("rtcm"), "idx");
+    recorder->indexFile = fopen(filePath, "wb");
+    if (recorder->indexFile == NULL) {
+        USER_LOG_ERROR("Open rtcm index file %s failed.", filePath);
+        fclose(recorder->dataFile);
+        recorder->dataFile = NULL;
+        return DJI_ERROR_SYSTEM_MODULE_CODE_SYSTEM_ERROR;
+    }
+
+    /* One large buffer per file turns the per-message writes into a few block sized syscalls. */
+    setvbuf(recorder->dataFile, recorder->dataBuffer, _IOFBF, recorder->config.bufferSize);
+    setvbuf(recorder->indexFile, recorder->indexBuffer, _IOFBF, recorder->config.bufferSize / 4);
+
+    osalHandler->GetTimeUs(&timestampUs);
+    memcpy(header.magic, DJI_TEST_RTCM_INDEX_MAGIC, DJI_TEST_RTCM_MAGIC_SIZE);
+    header.version = DJI_TEST_RTCM_INDEX_VERSION;
+    header.entrySize = sizeof(T_DjiTestRtcmIndexEntry);
+    header.summarySize = sizeof(T_DjiTestRtcmTypeSummary);
+    header.fileNumber = (uint16_t) recorder->fileNumber;
+    header.openTime = (uint64_t) currentTime;
+    header.openTimestampUs = timestampUs;
+    if (fwrite(&header, sizeof(header), 1, recorder->indexFile) != 1) {
+        DjiTest_RtcmRecorderCloseFiles(recorder);
+        return DJI_ERROR_SYSTEM_MODULE_CODE_SYSTEM_ERROR;
+    }
+
+    recorder->fileNumber++;
+    recorder->fileOffset = 0;
+    recorder->fileEntryCount = 0;
+    recorder->typeCount = 0;
+    osalHandler->GetTimeMs(&recorder->fileOpenTimeMs);
+    recorder->lastFlushTimeMs = recorder->fileOpenTimeMs;
+    recorder->statistics.fileCount++;
+    USER_LOG_INFO("Record rtcm data to %s.", filePath);
+
+    return DJI_ERROR_SYSTEM_MODULE_CODE_SUCCESS;
+}
+
+static T_DjiReturnCode DjiTest_RtcmRecorderCloseFiles(T_DjiTestRtcmRecorder *recorder)
+{
+    T_DjiTestRtcmIndexTrailer trailer = {0};
+    T_DjiReturnCode returnCode = DJI_ERROR_SYSTEM_MODULE_CODE_SUCCESS;
+
+    memcpy(trailer.magic, DJI_TEST_RTCM_TYPE_MAGIC, DJI_TEST_RTCM_MAGIC_SIZE);
+    trailer.summaryCount = recorder->typeCount;
+    trailer.summaryOffset = (uint32_t) (sizeof(T_DjiTestRtcmIndexHeader) +
+                                        recorder->fileEntryCount * sizeof(T_DjiTestRtcmIndexEntry));
+    if (fwrite(recorder->typeTable, sizeof(T_DjiTestRtcmTypeSummary), recorder->typeCount, recorder->indexFile) !=
+        recorder->typeCount || fwrite(&trailer, sizeof(trailer), 1, recorder->indexFile) != 1) {
+        returnCode = DJI_ERROR_SYSTEM_MODULE_CODE_SYSTEM_ERROR;
+    }
+
+    if (fclose(recorder->indexFile) != 0 || fclose(recorder->dataFile) != 0) {
+        returnCode = DJI_ERROR_SYSTEM_MODULE_CODE_SYSTEM_ERROR;
+    }
+    recorder->indexFile = NULL;
+    recorder->dataFile = NULL;
+
+    return returnCode;
+}
+
+static T_DjiReturnCode DjiTest_RtcmRecorderParse(T_DjiTestRtcmRecorder *recorder)
+{
+    T_DjiReturnCode returnCode = DJI_ERROR_SYSTEM_MODULE_CODE_SUCCESS;
+    uint8_t *frame = recorder->frame;
+    uint32_t position = 0;
+    uint32_t frameLen;
+    uint32_t crc;
+
+    while (position < recorder->frameLen && returnCode == DJI_ERROR_SYSTEM_MODULE_CODE_SUCCESS) {
+        uint32_t available = recorder->frameLen - position;
+        const uint8_t *preamble;
+        uint32_t skipLen;
+
+        /* Bytes before the next preamble can not start a frame, they go to the file unindexed. */
+        preamble = memchr(frame + position, DJI_TEST_RTCM_PREAMBLE, available);
+        skipLen = preamble != NULL ? (uint32_t) (preamble - (frame + position)) : available;
+        if (skipLen > 0) {
+            returnCode = DjiTest_RtcmRecorderWriteRaw(recorder, frame + position, skipLen);
+            recorder->statistics.discardedBytes += skipLen;
+            position += skipLen;
+            continue;
+        }
+
+        if (available < DJI_TEST_RTCM_HEADER_SIZE) {
+            break;
+        }
+
+        /* The six bits after the preamble are reserved zero, anything else is a false preamble. */
+        if ((frame[position + 1] & 0xFC) != 0) {
+            returnCode = DjiTest_RtcmRecorderWriteRaw(recorder, frame + position, 1);
+            recorder->statistics.discardedBytes++;
+            position++;
+            continue;
+        }
+
+        frameLen = DJI_TEST_RTCM_HEADER_SIZE + (((frame[position + 1] & 0x03) << 8) | frame[position + 2]) +
+                   DJI_TEST_RTCM_CRC_SIZE;
+        if (available < frameLen) {
+            break;
+        }
+
+        crc = DjiTest_RtcmCrc24q(frame + position, frameLen - DJI_TEST_RTCM_CRC_SIZE);
+        if (crc != (((uint32_t) frame[position + frameLen - 3] << 16) |
+                    ((uint32_t) frame[position + frameLen - 2] << 8) | frame[position + frameLen - 1])) {
+            returnCode = DjiTest_RtcmRecorderWriteRaw(recorder, frame + position, 1);
+            recorder->statistics.crcErrorCount++;
+            recorder->statistics.discardedBytes++;
+            position++;
+            continue;
+        }
+
+        returnCode = DjiTest_RtcmRecorderWriteFrame(recorder, frame + position, frameLen);
+        position += frameLen;
+    }
+
+    memmove(frame, frame + position, recorder->frameLen - position);
+    recorder->frameLen -= position;
+
+    return returnCode;
+}
+
+static T_DjiReturnCode DjiTest_RtcmRecorderWriteFrame(T_DjiTestRtcmRecorder *recorder, const uint8_t *frame,
+                                                      uint32_t length)
+{
+    T_DjiOsalHandler *osalHandler = DjiPlatform_GetOsalHandler();
+    T_DjiTestRtcmIndexEntry entry;
+    T_DjiReturnCode returnCode;
+    uint64_t timestampUs = 0;
+    uint32_t timeMs = 0;
+
+    osalHandler->GetTimeMs(&timeMs);
+    if ((recorder->config.rotateSize > 0 && recorder->fileOffset > 0 &&
+         recorder->fileOffset + length > recorder->config.rotateSize) ||
+        (recorder->config.rotateIntervalS > 0 &&
+         timeMs - recorder->fileOpenTimeMs >= recorder->config.rotateIntervalS * 1000)) {
+        returnCode = DjiTest_RtcmRecorderCloseFiles(recorder);
+        if (returnCode == DJI_ERROR_SYSTEM_MODULE_CODE_SUCCESS) {
+            returnCode = DjiTest_RtcmRecorderOpenFiles(recorder);
+        }
+        if (returnCode != DJI_ERROR_SYSTEM_MODULE_CODE_SUCCESS) {
+            return returnCode;
+        }
+    }
+
+    osalHandler->GetTimeUs(&timestampUs);
+    entry.timestampUs = timestampUs;
+    entry.offset = recorder->fileOffset;
+    entry.length = (uint16_t) length;
+    entry.messageType = 0;
+    if (length >= DJI_TEST_RTCM_HEADER_SIZE + 2 + DJI_TEST_RTCM_CRC_SIZE) {
+        /* The message number is the first 12 bits of the payload. */
+        entry.messageType = (uint16_t) ((frame[DJI_TEST_RTCM_HEADER_SIZE] << 4) |
+                                        (frame[DJI_TEST_RTCM_HEADER_SIZE + 1] >> 4));
+    }
+
+    if (fwrite(&entry, sizeof(entry), 1, recorder->indexFile) != 1) {
+        return DJI_ERROR_SYSTEM_MODULE_CODE_SYSTEM_ERROR;
+    }
+
+    DjiTest_RtcmRecorderCountType(recorder, entry.messageType);
+    recorder->fileEntryCount++;
+    recorder->statistics.frameCount++;
+
+    return DjiTest_RtcmRecorderWriteRaw(recorder, frame, length);
+}
+
+static T_DjiReturnCode DjiTest_RtcmRecorderWriteRaw(T_DjiTestRtcmRecorder *recorder, const uint8_t *data,
+                                                    uint32_t length)
+{
+    if (length == 0) {
+        return DJI_ERROR_SYSTEM_MODULE_CODE_SUCCESS;
+    }
+
+    if (fwrite(data, 1, length, recorder->dataFile) != length) {
+        return DJI_ERROR_SYSTEM_MODULE_CODE_SYSTEM_ERROR;
+    }
+    recorder->fileOffset += length;
+
+    return DJI_ERROR_SYSTEM_MODULE_CODE_SUCCESS;
+}
+
+static void DjiTest_RtcmRecorderCountType(T_DjiTestRtcmRecorder *recorder, uint16_t messageType)
+{
+    T_DjiTestRtcmTypeSummary *summary;
+    uint32_t i;
+
+    for (i = 0; i < recorder->typeCount; i++) {
+        summary = &recorder->typeTable[i];
+        if (summary->messageType == messageType) {
+            summary->count++;
+            summary->lastEntry = recorder->fileEntryCount;
+            return;
+        }
+    }
+
+    /* Types beyond the table are still in the index, only their summary is missing. */
+    if (recorder->typeCount >= DJI_TEST_RTCM_TYPE_TABLE_SIZE) {
+        return;
+    }
+
+    summary = &recorder->typeTable[recorder->typeCount++];
+    summary->messageType = messageType;
+    summary->count = 1;
+    summary->firstEntry = recorder->fileEntryCount;
+    summary->lastEntry = recorder->fileEntryCount;
+}
+
+static void DjiTest_RtcmInitCrcTable(void)
+{
+    uint32_t crc;
+    uint32_t i;
+    uint32_t j;
+
+    for (i = 0; i < 256; i++) {
+        crc = i << 16;
+        for (j = 0; j < 8; j++) {
+            crc <<= 1;
+            if (crc & 0x1000000) {
+                crc ^= DJI_TEST_RTCM_CRC24Q_POLY;
+            }
+        }
+        s_rtcmCrc24qTable[i] = crc & 0xFFFFFF;
+    }
+}
+
+#endif
+
+/****************** (C) COPYRIGHT DJI Innovations *****END OF FILE****/
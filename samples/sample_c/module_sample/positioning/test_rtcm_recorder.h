@@ -0,0 +1,129 @@
+/**
+ ********************************************************************
+ * @file    test_rtcm_recorder.h
+ * @brief   This is the header file for "test_rtcm_recorder.c", defining the structure and
+ * (exported) function prototypes.
+ *
+ * @copyright (c) 2021 DJI. All rights reserved.
+ *
+ * All information contained herein is, and remains, the property of DJI.
+ * The intellectual and technical concepts contained herein are proprietary
+ * to DJI and may be covered by U.S. and foreign patents, patents in process,
+ * and protected by trade secret or copyright law.  Dissemination of this
+ * information, including but not limited to data and other proprietary
+ * material(s) incorporated within the information, in any form, is strictly
+ * prohibited without the express written consent of DJI.
+ *
+ * If you receive this source code without DJI’s authorization, you may not
+ * further disseminate the information, and you must immediately remove the
+ * source code and notify DJI of its removal. DJI reserves the right to pursue
+ * legal actions against you for any loss(es) or damage(s) caused by your
+ * failure to do so.
+ *
+ *********************************************************************
+ */
+
+/* Define to prevent recursive inclusion -------------------------------------*/
+#ifndef TEST_RTCM_RECORDER_H
+#define TEST_RTCM_RECORDER_H
+
+/* Includes ------------------------------------------------------------------*/
+#include <stdio.h>
+#include "dji_typedef.h"
+#include "dji_platform.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#ifdef SYSTEM_ARCH_LINUX
+
+/* Exported constants --------------------------------------------------------*/
+#define DJI_TEST_RTCM_FRAME_MAX_SIZE                (3 + 1023 + 3)
+#define DJI_TEST_RTCM_TYPE_TABLE_SIZE               (64)
+#define DJI_TEST_RTCM_PREFIX_MAX_SIZE               (32)
+#define DJI_TEST_RTCM_FILE_PATH_MAX_SIZE            (256)
+
+/* Exported types ------------------------------------------------------------*/
+typedef struct {
+    const char *directory;          /*!< Directory of the record files, NULL for the working directory. */
+    const char *prefix;             /*!< File name prefix, the open time and a file number are appended. */
+    uint32_t bufferSize;            /*!< stdio buffer of the data file, the index file gets a quarter of it. */
+    uint32_t rotateSize;            /*!< Start a new file before this many bytes, 0 disables size rotation. */
+    uint32_t rotateIntervalS;       /*!< Start a new file after this many seconds, 0 disables time rotation. */
+    uint32_t flushIntervalMs;       /*!< Upper bound of the data lost on power failure. */
+} T_DjiTestRtcmRecorderConfig;
+
+/**
+ * @brief One record of the ".idx" file next to each ".rtcm" data file, offsets are relative to the data file.
+ */
+#pragma pack(1)
+typedef struct {
+    uint64_t timestampUs;           /*!< Local OSAL time of the callback that completed the frame. */
+    uint32_t offset;                /*!< First byte of the frame, the 0xD3 preamble. */
+    uint16_t length;                /*!< Whole frame including header and CRC. */
+    uint16_t messageType;
+} T_DjiTestRtcmIndexEntry;
+
+typedef struct {
+    uint16_t messageType;
+    uint32_t count;
+    uint32_t firstEntry;            /*!< Position of the first entry of this type in the index file. */
+    uint32_t lastEntry;
+} T_DjiTestRtcmTypeSummary;
+#pragma pack()
+
+typedef struct {
+    uint64_t totalBytes;
+    uint32_t frameCount;
+    uint32_t crcErrorCount;
+    uint32_t discardedBytes;        /*!< Bytes outside any valid frame, kept in the data file as received. */
+    uint32_t fileCount;
+    uint32_t flushCount;
+} T_DjiTestRtcmRecorderStatistics;
+
+/**
+ * @brief RTCM3 stream recorder keeping the data and index file open with large stdio buffers.
+ * @note Received bytes are framed first and reach the data file when a frame completes or a byte is known not to
+ * start one, so rotation always happens on a frame boundary. All functions are thread-safe. The recorder must be
+ * zeroed before its first open. The mutex is kept after close, a write racing or following close is rejected under
+ * it, and a later open reuses it.
+ */
+typedef struct {
+    T_DjiMutexHandle mutex;         /*!< Created by the first open and never destroyed. */
+    T_DjiTestRtcmRecorderConfig config;
+    char directory[DJI_TEST_RTCM_FILE_PATH_MAX_SIZE];
+    char prefix[DJI_TEST_RTCM_PREFIX_MAX_SIZE];
+    FILE *dataFile;
+    FILE *indexFile;
+    char *dataBuffer;
+    char *indexBuffer;
+    uint32_t fileNumber;
+    uint32_t fileOffset;
+    uint32_t fileEntryCount;
+    uint32_t fileOpenTimeMs;
+    uint32_t lastFlushTimeMs;
+    uint8_t frame[DJI_TEST_RTCM_FRAME_MAX_SIZE];
+    uint32_t frameLen;
+    T_DjiTestRtcmTypeSummary typeTable[DJI_TEST_RTCM_TYPE_TABLE_SIZE];
+    uint32_t typeCount;
+    T_DjiTestRtcmRecorderStatistics statistics;
+} T_DjiTestRtcmRecorder;
+
+/* Exported functions --------------------------------------------------------*/
+void DjiTest_RtcmRecorderGetDefaultConfig(T_DjiTestRtcmRecorderConfig *config);
+T_DjiReturnCode DjiTest_RtcmRecorderOpen(T_DjiTestRtcmRecorder *recorder, const T_DjiTestRtcmRecorderConfig *config);
+T_DjiReturnCode DjiTest_RtcmRecorderWrite(T_DjiTestRtcmRecorder *recorder, const uint8_t *data, uint32_t len);
+T_DjiReturnCode DjiTest_RtcmRecorderFlush(T_DjiTestRtcmRecorder *recorder);
+T_DjiReturnCode DjiTest_RtcmRecorderClose(T_DjiTestRtcmRecorder *recorder);
+void DjiTest_RtcmRecorderGetStatistics(T_DjiTestRtcmRecorder *recorder, T_DjiTestRtcmRecorderStatistics *statistics);
+uint32_t DjiTest_RtcmCrc24q(const uint8_t *data, uint32_t len);
+
+#endif
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // TEST_RTCM_RECORDER_H
+/************************ (C) COPYRIGHT DJI Innovations *******END OF FILE******/
@@ -0,0 +1,562 @@
+/**
+ ********************************************************************
+ * @file    test_telemetry_bus.c
+ * @brief   Publisher side of the shared memory telemetry bus the samples publish the received data on.
+ *
+ * @copyright (c) 2021 DJI. All rights reserved.
+ *
+ * All information contained herein is, and remains, the property of DJI.
+ * The intellectual and technical concepts contained herein are proprietary
+ * to DJI and may be covered by U.S. and foreign patents, patents in process,
+ * and protected by trade secret or copyright law.  Dissemination of this
+ * information, including but not limited to data and other proprietary
+ * material(s) incorporated within the information, in any form, is strictly
+ * prohibited without the express written consent of DJI.
+ *
+ * If you receive this source code without DJI’s authorization, you may not
+ * further disseminate the information, and you must immediately remove the
+ * source code and notify DJI of its removal. DJI reserves the right to pursue
+ * legal actions against you for any loss(es) or damage(s) caused by your
+ * failure to do so.
+ *
+ *********************************************************************
+ */
+
+/* Includes ------------------------------------------------------------------*/
+#include "test_telemetry_bus.h"
+
+#ifdef SYSTEM_ARCH_LINUX
+
+#include <stdio.h>
+#include <string.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <limits.h>
+#include <pthread.h>
+#include <signal.h>
+#include <time.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <linux/futex.h>
+
+/* Private constants ---------------------------------------------------------*/
+#define DJI_TEST_TELEMETRY_BUS_MAGIC                0x42544A44      /* "DJTB" */
+#define DJI_TEST_TELEMETRY_TOPIC_MAGIC              0x54544A44      /* "DJTT" */
+#define DJI_TEST_TELEMETRY_SLOT_ALIGN               (64)
+/* Mapping of one topic, the slots of all topics together live in RAM. */
+#define DJI_TEST_TELEMETRY_TOPIC_MAX_MAP_SIZE       (0x40000000U)
+/* Readers in other processes may map the objects, the publisher and they run as one user or group. */
+#define DJI_TEST_TELEMETRY_OBJECT_MODE              (0660)
+
+/* Private types -------------------------------------------------------------*/
+
+/* Private functions declaration ---------------------------------------------*/
+static T_DjiReturnCode DjiTest_TelemetryBusCreateTopicObject(T_DjiTestTelemetryBus *bus, uint16_t topicId,
+                                                             uint32_t slotCount, uint32_t slotSize);
+static void DjiTest_TelemetryBusCloseTopic(T_DjiTestTelemetryBus *bus, uint16_t topicId);
+static void *DjiTest_TelemetryBusCreateObject(const char *path, uint32_t len);
+static bool DjiTest_TelemetryBusIsNameValid(const char *name);
+static T_DjiTestTelemetryBusTopic *DjiTest_TelemetryBusGetTopic(T_DjiTestTelemetryBus *bus, uint16_t topicId);
+static void DjiTest_TelemetryBusCreateDefault(void);
+static uint64_t DjiTest_TelemetryBusGetTimeUs(clockid_t clockId);
+
+/* Private values ------------------------------------------------------------*/
+static T_DjiTestTelemetryBus s_defaultTelemetryBus;
+static bool s_isDefaultTelemetryBusCreated = false;
+static pthread_once_t s_defaultTelemetryBusOnce = PTHREAD_ONCE_INIT;
+
+/* Exported functions definition ---------------------------------------------*/
+T_DjiReturnCode DjiTest_TelemetryBusCreate(T_DjiTestTelemetryBus *bus, const char *name)
+{
+    T_DjiOsalHandler *osalHandler = DjiPlatform_GetOsalHandler();
+    T_DjiTestTelemetryClient client;
+    char path[DJI_TEST_TELEMETRY_BUS_PATH_MAX_SIZE];
+    T_DjiReturnCode returnCode;
+    int32_t i;
+
+    if (bus == NULL || !DjiTest_TelemetryGetObjectPath(name, -1, path, sizeof(path))) {
+        return DJI_ERROR_SYSTEM_MODULE_CODE_INVALID_PARAMETER;
+    }
+
+    /* A bus left by a publisher that crashed is replaced, one of a running publisher is not. */
+    if (DjiTest_TelemetryClientOpen(&client, name) == DJI_ERROR_SYSTEM_MODULE_CODE_SUCCESS) {
+        if (DjiTest_TelemetryClientIsAlive(&client) && client.header->pid != getpid()) {
+            DjiTest_TelemetryClientClose(&client);
+            return DJI_ERROR_SYSTEM_MODULE_CODE_BUSY;
+        }
+        DjiTest_TelemetryClientClose(&client);
+    }
+
+    /* Subscribers of the old bus keep their mappings of the unlinked objects and see the publisher gone. */
+    unlink(path);
+    for (i = 0; i < DJI_TEST_TELEMETRY_BUS_TOPIC_MAX_NUM; i++) {
+        DjiTest_TelemetryGetObjectPath(name, i, path, sizeof(path));
+        unlink(path);
+    }
+
+    memset(bus, 0, sizeof(T_DjiTestTelemetryBus));
+    strcpy(bus->name, name);
+
+    returnCode = osalHandler->MutexCreate(&bus->mutex);
+    if (returnCode != DJI_ERROR_SYSTEM_MODULE_CODE_SUCCESS) {
+        return returnCode;
+    }
+
+    DjiTest_TelemetryGetObjectPath(name, -1, path, sizeof(path));
+    bus->header = DjiTest_TelemetryBusCreateObject(path, sizeof(T_DjiTestTelemetryBusHeader));
+    if (bus->header == NULL) {
+        osalHandler->MutexDestroy(bus->mutex);
+        bus->mutex = NULL;
+        return DJI_ERROR_SYSTEM_MODULE_CODE_SYSTEM_ERROR;
+    }
+
+    bus->header->version = DJI_TEST_TELEMETRY_BUS_FORMAT_VERSION;
+    bus->header->headerSize = sizeof(T_DjiTestTelemetryBusHeader);
+    bus->header->pid = getpid();
+    bus->header->generation = DjiTest_TelemetryBusGetTimeUs(CLOCK_REALTIME);
+    __atomic_store_n(&bus->header->magic, DJI_TEST_TELEMETRY_BUS_MAGIC, __ATOMIC_RELEASE);
+
+    return DJI_ERROR_SYSTEM_MODULE_CODE_SUCCESS;
+}
+
+T_DjiReturnCode DjiTest_TelemetryBusDestroy(T_DjiTestTelemetryBus *bus)
+{
+    T_DjiOsalHandler *osalHandler = DjiPlatform_GetOsalHandler();
+    char path[DJI_TEST_TELEMETRY_BUS_PATH_MAX_SIZE];
+    uint16_t i;
+
+    if (bus == NULL || bus->header == NULL) {
+        return DJI_ERROR_SYSTEM_MODULE_CODE_INVALID_PARAMETER;
+    }
+
+    osalHandler->MutexLock(bus->mutex);
+    __atomic_store_n(&bus->header->isClosed, 1, __ATOMIC_RELEASE);
+    for (i = 0; i < bus->header->topicCount; i++) {
+        DjiTest_TelemetryBusCloseTopic(bus, i);
+    }
+    osalHandler->MutexUnlock(bus->mutex);
+
+    munmap(bus->header, sizeof(T_DjiTestTelemetryBusHeader));
+    bus->header = NULL;
+    DjiTest_TelemetryGetObjectPath(bus->name, -1, path, sizeof(path));
+    unlink(path);
+
+    osalHandler->MutexDestroy(bus->mutex);
+    bus->mutex = NULL;
+
+    return DJI_ERROR_SYSTEM_MODULE_CODE_SUCCESS;
+}
+
+T_DjiReturnCode DjiTest_TelemetryBusRegisterSchema(T_DjiTestTelemetryBus *bus, const char *name, uint32_t version,
+                                                   const char *layout, uint16_t *schemaId)
+{
+    T_DjiOsalHandler *osalHandler = DjiPlatform_GetOsalHandler();
+    T_DjiTestTelemetrySchema *schema;
+    T_DjiReturnCode returnCode = DJI_ERROR_SYSTEM_MODULE_CODE_SUCCESS;
+    uint32_t fixedSize;
+    bool isVariable;
+    uint32_t i;
+
+    if (bus == NULL || bus->header == NULL || !DjiTest_TelemetryBusIsNameValid(name) || schemaId == NULL) {
+        return DJI_ERROR_SYSTEM_MODULE_CODE_INVALID_PARAMETER;
+    }
+
+    returnCode = DjiTest_TelemetryGetLayoutSize(layout, &fixedSize, &isVariable);
+    if (returnCode != DJI_ERROR_SYSTEM_MODULE_CODE_SUCCESS) {
+        return returnCode;
+    }
+
+    osalHandler->MutexLock(bus->mutex);
+
+    /* Registering again is how a sample started twice finds its schema. */
+    for (i = 0; i < bus->header->schemaCount; i++) {
+        schema = &bus->header->schemas[i];
+        if (strcmp(schema->name, name) == 0 && schema->version == version) {
+            if (strcmp(schema->layout, layout) == 0) {
+                *schemaId = (uint16_t) i;
+            } else {
+                returnCode = DJI_ERROR_SYSTEM_MODULE_CODE_DUPLICATE;
+            }
+            goto out;
+        }
+    }
+
+    if (bus->header->schemaCount >= DJI_TEST_TELEMETRY_BUS_SCHEMA_MAX_NUM) {
+        returnCode = DJI_ERROR_SYSTEM_MODULE_CODE_OUT_OF_RANGE;
+        goto out;
+    }
+
+    schema = &bus->header->schemas[bus->header->schemaCount];
+    strcpy(schema->name, name);
+    strcpy(schema->layout, layout);
+    schema->version = version;
+    schema->fixedSize = fixedSize;
+    schema->isVariable = isVariable;
+    *schemaId = (uint16_t) bus->header->schemaCount;
+    __atomic_store_n(&bus->header->schemaCount, bus->header->schemaCount + 1, __ATOMIC_RELEASE);
+
+out:
+    osalHandler->MutexUnlock(bus->mutex);
+
+    return returnCode;
+}
+
+T_DjiReturnCode DjiTest_TelemetryBusAddTopic(T_DjiTestTelemetryBus *bus, const T_DjiTestTelemetryTopicConfig *config,
+                                             uint16_t *topicId)
+{
+    T_DjiOsalHandler *osalHandler = DjiPlatform_GetOsalHandler();
+    T_DjiTestTelemetryTopicInfo *info;
+    T_DjiReturnCode returnCode = DJI_ERROR_SYSTEM_MODULE_CODE_SUCCESS;
+    uint32_t slotCount = 1;
+    uint32_t i;
+
+    if (bus == NULL || bus->header == NULL || config == NULL || topicId == NULL ||
+        !DjiTest_TelemetryBusIsNameValid(config->name) || config->slotCount == 0 ||
+        config->slotCount > DJI_TEST_TELEMETRY_BUS_SLOT_MAX_NUM || config->slotSize == 0 ||
+        config->slotSize > DJI_TEST_TELEMETRY_BUS_SLOT_MAX_SIZE) {
+        return DJI_ERROR_SYSTEM_MODULE_CODE_INVALID_PARAMETER;
+    }
+    while (slotCount < config->slotCount) {
+        slotCount <<= 1;
+    }
+
+    osalHandler->MutexLock(bus->mutex);
+
+    if (config->schemaId >= bus->header->schemaCount ||
+        config->slotSize < bus->header->schemas[config->schemaId].fixedSize) {
+        returnCode = DJI_ERROR_SYSTEM_MODULE_CODE_INVALID_PARAMETER;
+        goto out;
+    }
+
+    for (i = 0; i < bus->header->topicCount; i++) {
+        info = &bus->header->topics[i];
+        if (strcmp(info->name, config->name) == 0) {
+            if (info->schemaId == config->schemaId && info->slotSize >= config->slotSize) {
+                *topicId = (uint16_t) i;
+            } else {
+                returnCode = DJI_ERROR_SYSTEM_MODULE_CODE_DUPLICATE;
+            }
+            goto out;
+        }
+    }
+
+    if (bus->header->topicCount >= DJI_TEST_TELEMETRY_BUS_TOPIC_MAX_NUM) {
+        returnCode = DJI_ERROR_SYSTEM_MODULE_CODE_OUT_OF_RANGE;
+        goto out;
+    }
+
+    returnCode = DjiTest_TelemetryBusCreateTopicObject(bus, (uint16_t) bus->header->topicCount, slotCount,
+                                                       config->slotSize);
+    if (returnCode != DJI_ERROR_SYSTEM_MODULE_CODE_SUCCESS) {
+        goto out;
+    }
+
+    info = &bus->header->topics[bus->header->topicCount];
+    strcpy(info->name, config->name);
+    info->schemaId = config->schemaId;
+    info->slotCount = slotCount;
+    info->slotSize = config->slotSize;
+    *topicId = (uint16_t) bus->header->topicCount;
+    __atomic_store_n(&bus->header->topicCount, bus->header->topicCount + 1, __ATOMIC_RELEASE);
+
+out:
+    osalHandler->MutexUnlock(bus->mutex);
+
+    return returnCode;
+}
+
+T_DjiReturnCode DjiTest_TelemetryBusPublish(T_DjiTestTelemetryBus *bus, uint16_t topicId, const void *data,
+                                            uint32_t len)
+{
+    T_DjiTestTelemetryBusTopic *topic = DjiTest_TelemetryBusGetTopic(bus, topicId);
+    T_DjiReturnCode returnCode;
+    uint8_t *slotData;
+    uint32_t capacity;
+
+    if (topic == NULL || (data == NULL && len > 0)) {
+        return DJI_ERROR_SYSTEM_MODULE_CODE_INVALID_PARAMETER;
+    }
+    if (len > topic->header->slotSize) {
+        __atomic_add_fetch(&topic->statistics.oversizeCount, 1, __ATOMIC_RELAXED);
+        return DJI_ERROR_SYSTEM_MODULE_CODE_OUT_OF_RANGE;
+    }
+
+    returnCode = DjiTest_TelemetryBusLoan(bus, topicId, &slotData, &capacity);
+    if (returnCode != DJI_ERROR_SYSTEM_MODULE_CODE_SUCCESS) {
+        return returnCode;
+    }
+    if (len > 0) {
+        memcpy(slotData, data, len);
+    }
+
+    return DjiTest_TelemetryBusCommit(bus, topicId, len);
+}
+
+T_DjiReturnCode DjiTest_TelemetryBusLoan(T_DjiTestTelemetryBus *bus, uint16_t topicId, uint8_t **data,
+                                         uint32_t *capacity)
+{
+    T_DjiOsalHandler *osalHandler = DjiPlatform_GetOsalHandler();
+    T_DjiTestTelemetryBusTopic *topic = DjiTest_TelemetryBusGetTopic(bus, topicId);
+    T_DjiTestTelemetrySlotHeader *slot;
+    uint64_t seq;
+
+    if (topic == NULL || data == NULL || capacity == NULL) {
+        return DJI_ERROR_SYSTEM_MODULE_CODE_INVALID_PARAMETER;
+    }
+
+    osalHandler->MutexLock(topic->mutex);
+    if (__atomic_load_n(&topic->header->isClosed, __ATOMIC_RELAXED) != 0) {
+        osalHandler->MutexUnlock(topic->mutex);
+        return DJI_ERROR_SYSTEM_MODULE_CODE_NONSUPPORT_IN_CURRENT_STATE;
+    }
+
+    seq = topic->header->writeSeq;
+    slot = (T_DjiTestTelemetrySlotHeader *) (topic->slots + (uint64_t) (seq & (topic->header->slotCount - 1)) *
+                                                            topic->header->slotStride);
+
+    /* Odd while writing, the fence keeps the writes of the sample behind it for the readers. */
+    __atomic_store_n(&slot->seq, seq * 2 + 1, __ATOMIC_RELAXED);
+    __atomic_thread_fence(__ATOMIC_RELEASE);
+
+    topic->isLoaned = true;
+    *data = (uint8_t *) (slot + 1);
+    *capacity = topic->header->slotSize;
+
+    return DJI_ERROR_SYSTEM_MODULE_CODE_SUCCESS;
+}
+
+T_DjiReturnCode DjiTest_TelemetryBusCommit(T_DjiTestTelemetryBus *bus, uint16_t topicId, uint32_t len)
+{
+    T_DjiOsalHandler *osalHandler = DjiPlatform_GetOsalHandler();
+    T_DjiTestTelemetryBusTopic *topic = DjiTest_TelemetryBusGetTopic(bus, topicId);
+    T_DjiTestTelemetryTopicHeader *header;
+    T_DjiTestTelemetrySlotHeader *slot;
+    uint64_t seq;
+
+    if (topic == NULL || !topic->isLoaned) {
+        return DJI_ERROR_SYSTEM_MODULE_CODE_INVALID_PARAMETER;
+    }
+    header = topic->header;
+
+    topic->isLoaned = false;
+    if (len > header->slotSize) {
+        /* The slot stays odd, readers count the sample it held as lost and the next loan reuses it. */
+        topic->statistics.oversizeCount++;
+        osalHandler->MutexUnlock(topic->mutex);
+        return DJI_ERROR_SYSTEM_MODULE_CODE_OUT_OF_RANGE;
+    }
+
+    seq = header->writeSeq;
+    slot = (T_DjiTestTelemetrySlotHeader *) (topic->slots + (uint64_t) (seq & (header->slotCount - 1)) *
+                                                            header->slotStride);
+    slot->len = len;
+    slot->timeUs = DjiTest_TelemetryBusGetTimeUs(CLOCK_MONOTONIC);
+    __atomic_store_n(&slot->seq, seq * 2 + 2, __ATOMIC_RELEASE);
+    __atomic_store_n(&header->writeSeq, seq + 1, __ATOMIC_RELEASE);
+
+    /* Pairs with the increment of waiterCount before a subscriber sleeps, one of the two sees the other. */
+    __atomic_add_fetch(&header->notifySeq, 1, __ATOMIC_SEQ_CST);
+    if (__atomic_load_n(&header->waiterCount, __ATOMIC_SEQ_CST) != 0) {
+        syscall(SYS_futex, &header->notifySeq, FUTEX_WAKE, INT_MAX, NULL, NULL, 0);
+        topic->statistics.wakeCount++;
+    }
+
+    topic->statistics.publishedCount++;
+    topic->statistics.publishedBytes += len;
+    osalHandler->MutexUnlock(topic->mutex);
+
+    return DJI_ERROR_SYSTEM_MODULE_CODE_SUCCESS;
+}
+
+void DjiTest_TelemetryBusGetStatistics(T_DjiTestTelemetryBus *bus, uint16_t topicId,
+                                       T_DjiTestTelemetryTopicStatistics *statistics)
+{
+    T_DjiOsalHandler *osalHandler = DjiPlatform_GetOsalHandler();
+    T_DjiTestTelemetryBusTopic *topic = DjiTest_TelemetryBusGetTopic(bus, topicId);
+
+    if (topic == NULL || statistics == NULL) {
+        return;
+    }
+
+    osalHandler->MutexLock(topic->mutex);
+    *statistics = topic->statistics;
+    osalHandler->MutexUnlock(topic->mutex);
+}
+
+T_DjiTestTelemetryBus *DjiTest_TelemetryBusGetDefault(void)
+{
+    pthread_once(&s_defaultTelemetryBusOnce, DjiTest_TelemetryBusCreateDefault);
+
+    return s_isDefaultTelemetryBusCreated ? &s_defaultTelemetryBus : NULL;
+}
+
+T_DjiReturnCode DjiTest_TelemetryBusAddDefaultTopic(const char *topicName, const char *schemaName,
+                                                    uint32_t schemaVersion, const char *layout, uint32_t slotSize,
+                                                    uint32_t slotCount, uint16_t *topicId)
+{
+    T_DjiTestTelemetryBus *bus = DjiTest_TelemetryBusGetDefault();
+    T_DjiTestTelemetryTopicConfig config = {0};
+    T_DjiReturnCode returnCode;
+
+    if (bus == NULL) {
+        return DJI_ERROR_SYSTEM_MODULE_CODE_NOT_FOUND;
+    }
+    if (topicName == NULL || strlen(topicName) >= sizeof(config.name)) {
+        return DJI_ERROR_SYSTEM_MODULE_CODE_INVALID_PARAMETER;
+    }
+
+    returnCode = DjiTest_TelemetryBusRegisterSchema(bus, schemaName, schemaVersion, layout, &config.schemaId);
+    if (returnCode != DJI_ERROR_SYSTEM_MODULE_CODE_SUCCESS) {
+        return returnCode;
+    }
+
+    strcpy(config.name, topicName);
+    config.slotCount = slotCount;
+    config.slotSize = slotSize;
+
+    return DjiTest_TelemetryBusAddTopic(bus, &config, topicId);
+}
+
+/* Private functions definition-----------------------------------------------*/
+static T_DjiReturnCode DjiTest_TelemetryBusCreateTopicObject(T_DjiTestTelemetryBus *bus, uint16_t topicId,
+                                                             uint32_t slotCount, uint32_t slotSize)
+{
+    T_DjiOsalHandler *osalHandler = DjiPlatform_GetOsalHandler();
+    T_DjiTestTelemetryBusTopic *topic = &bus->topics[topicId];
+    T_DjiTestTelemetryTopicHeader *header;
+    char path[DJI_TEST_TELEMETRY_BUS_PATH_MAX_SIZE];
+    T_DjiReturnCode returnCode;
+    long pageSize = sysconf(_SC_PAGESIZE);
+    uint32_t slotOffset;
+    uint32_t slotStride;
+    uint64_t mapSize;
+
+    if (pageSize <= 0) {
+        pageSize = 4096;
+    }
+    slotOffset = (uint32_t) ((sizeof(T_DjiTestTelemetryTopicHeader) + pageSize - 1) / pageSize * pageSize);
+    slotStride = (uint32_t) ((sizeof(T_DjiTestTelemetrySlotHeader) + slotSize + DJI_TEST_TELEMETRY_SLOT_ALIGN - 1) /
+                             DJI_TEST_TELEMETRY_SLOT_ALIGN * DJI_TEST_TELEMETRY_SLOT_ALIGN);
+    mapSize = slotOffset + (uint64_t) slotStride * slotCount;
+    if (mapSize > DJI_TEST_TELEMETRY_TOPIC_MAX_MAP_SIZE) {
+        return DJI_ERROR_SYSTEM_MODULE_CODE_OUT_OF_RANGE;
+    }
+
+    returnCode = osalHandler->MutexCreate(&topic->mutex);
+    if (returnCode != DJI_ERROR_SYSTEM_MODULE_CODE_SUCCESS) {
+        return returnCode;
+    }
+
+    DjiTest_TelemetryGetObjectPath(bus->name, topicId, path, sizeof(path));
+    header = DjiTest_TelemetryBusCreateObject(path, (uint32_t) mapSize);
+    if (header == NULL) {
+        osalHandler->MutexDestroy(topic->mutex);
+        topic->mutex = NULL;
+        return DJI_ERROR_SYSTEM_MODULE_CODE_SYSTEM_ERROR;
+    }
+
+    /* The object is zero filled, so no slot looks complete before its first publish. */
+    header->version = DJI_TEST_TELEMETRY_BUS_FORMAT_VERSION;
+    header->topicId = topicId;
+    header->slotCount = slotCount;
+    header->slotSize = slotSize;
+    header->slotStride = slotStride;
+    header->slotOffset = slotOffset;
+    header->generation = bus->header->generation;
+    __atomic_store_n(&header->magic, DJI_TEST_TELEMETRY_TOPIC_MAGIC, __ATOMIC_RELEASE);
+
+    topic->header = header;
+    topic->slots = (uint8_t *) header + slotOffset;
+    topic->mapSize = (uint32_t) mapSize;
+
+    return DJI_ERROR_SYSTEM_MODULE_CODE_SUCCESS;
+}
+
+static void DjiTest_TelemetryBusCloseTopic(T_DjiTestTelemetryBus *bus, uint16_t topicId)
+{
+    T_DjiOsalHandler *osalHandler = DjiPlatform_GetOsalHandler();
+    T_DjiTestTelemetryBusTopic *topic = &bus->topics[topicId];
+    char path[DJI_TEST_TELEMETRY_BUS_PATH_MAX_SIZE];
+
+    if (topic->header == NULL) {
+        return;
+    }
+
+    /* Waiting subscribers wake up, see the topic closed and return. */
+    osalHandler->MutexLock(topic->mutex);
+    __atomic_store_n(&topic->header->isClosed, 1, __ATOMIC_RELEASE);
+    __atomic_add_fetch(&topic->header->notifySeq, 1, __ATOMIC_SEQ_CST);
+    syscall(SYS_futex, &topic->header->notifySeq, FUTEX_WAKE, INT_MAX, NULL, NULL, 0);
+    munmap(topic->header, topic->mapSize);
+    topic->header = NULL;
+    topic->slots = NULL;
+    osalHandler->MutexUnlock(topic->mutex);
+
+    DjiTest_TelemetryGetObjectPath(bus->name, topicId, path, sizeof(path));
+    unlink(path);
+
+    osalHandler->MutexDestroy(topic->mutex);
+    topic->mutex = NULL;
+}
+
+static void *DjiTest_TelemetryBusCreateObject(const char *path, uint32_t len)
+{
+    void *address;
+    int fd;
+
+    fd = open(path, O_RDWR | O_CREAT | O_EXCL | O_CLOEXEC, DJI_TEST_TELEMETRY_OBJECT_MODE);
+    if (fd < 0) {
+        return NULL;
+    }
+
+    if (ftruncate(fd, len) != 0) {
+        close(fd);
+        unlink(path);
+        return NULL;
+    }
+
+    address = mmap(NULL, len, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    close(fd);
+    if (address == MAP_FAILED) {
+        unlink(path);
+        return NULL;
+    }
+
+    return address;
+}
+
+static bool DjiTest_TelemetryBusIsNameValid(const char *name)
+{
+    return name != NULL && name[0] != '\0' && strlen(name) < DJI_TEST_TELEMETRY_BUS_NAME_MAX_SIZE;
+}
+
+static T_DjiTestTelemetryBusTopic *DjiTest_TelemetryBusGetTopic(T_DjiTestTelemetryBus *bus, uint16_t topicId)
+{
+    if (bus == NULL || bus->header == NULL || topicId >= DJI_TEST_TELEMETRY_BUS_TOPIC_MAX_NUM ||
+        topicId >= __atomic_load_n(&bus->header->topicCount, __ATOMIC_ACQUIRE)) {
+        return NULL;
+    }
+
+    return &bus->topics[topicId];
+}
+
+static void DjiTest_TelemetryBusCreateDefault(void)
+{
+    s_isDefaultTelemetryBusCreated = DjiTest_TelemetryBusCreate(&s_defaultTelemetryBus,
+                                                                DJI_TEST_TELEMETRY_BUS_DEFAULT_NAME) ==
+                                     DJI_ERROR_SYSTEM_MODULE_CODE_SUCCESS;
+}
+
+static uint64_t DjiTest_TelemetryBusGetTimeUs(clockid_t clockId)
+{
+    struct timespec now;
+
+    clock_gettime(clockId, &now);
+
+    return (uint64_t) now.tv_sec * 1000000 + (uint64_t) now.tv_nsec / 1000;
+}
+
+#endif
+
+/****************** (C) COPYRIGHT DJI Innovations *****END OF FILE****/
@@ -0,0 +1,288 @@
+/**
+ ********************************************************************
+ * @file    test_telemetry_bus.h
+ * @brief   This is the header file for "test_telemetry_bus.c" and "test_telemetry_bus_client.c", defining the
+ * structure and (exported) function prototypes.
+ *
+ * @copyright (c) 2021 DJI. All rights reserved.
+ *
+ * All information contained herein is, and remains, the property of DJI.
+ * The intellectual and technical concepts contained herein are proprietary
+ * to DJI and may be covered by U.S. and foreign patents, patents in process,
+ * and protected by trade secret or copyright law.  Dissemination of this
+ * information, including but not limited to data and other proprietary
+ * material(s) incorporated within the information, in any form, is strictly
+ * prohibited without the express written consent of DJI.
+ *
+ * If you receive this source code without DJI’s authorization, you may not
+ * further disseminate the information, and you must immediately remove the
+ * source code and notify DJI of its removal. DJI reserves the right to pursue
+ * legal actions against you for any loss(es) or damage(s) caused by your
+ * failure to do so.
+ *
+ *********************************************************************
+ */
+
+/* Define to prevent recursive inclusion -------------------------------------*/
+#ifndef TEST_TELEMETRY_BUS_H
+#define TEST_TELEMETRY_BUS_H
+
+/* Includes ------------------------------------------------------------------*/
+#include "dji_typedef.h"
+#include "dji_platform.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#ifdef SYSTEM_ARCH_LINUX
+
+/* Exported constants --------------------------------------------------------*/
+#define DJI_TEST_TELEMETRY_BUS_DEFAULT_NAME         "psdk"
+/* Bus and topic objects are files of this tmpfs, the same place shm_open uses on Linux. */
+#define DJI_TEST_TELEMETRY_BUS_SHM_DIRECTORY        "/dev/shm"
+#define DJI_TEST_TELEMETRY_BUS_OBJECT_PREFIX        "dji_bus_"
+#define DJI_TEST_TELEMETRY_BUS_FORMAT_VERSION       (1)
+#define DJI_TEST_TELEMETRY_BUS_NAME_MAX_SIZE        (32)
+#define DJI_TEST_TELEMETRY_BUS_LAYOUT_MAX_SIZE      (256)
+#define DJI_TEST_TELEMETRY_BUS_TOPIC_MAX_NUM        (64)
+#define DJI_TEST_TELEMETRY_BUS_SCHEMA_MAX_NUM       (64)
+#define DJI_TEST_TELEMETRY_BUS_SLOT_MAX_NUM         (1024)
+#define DJI_TEST_TELEMETRY_BUS_SLOT_MAX_SIZE        (64 * 1024 * 1024)
+#define DJI_TEST_TELEMETRY_BUS_PATH_MAX_SIZE        (sizeof(DJI_TEST_TELEMETRY_BUS_SHM_DIRECTORY) + \
+                                                     DJI_TEST_TELEMETRY_BUS_NAME_MAX_SIZE + 16)
+
+/* Exported types ------------------------------------------------------------*/
+/**
+ * @brief Description of the samples of a topic. The layout lists the packed little endian fields of a sample as
+ * space separated "name:type", type is one of u8 i8 u16 i16 u32 i32 u64 i64 f32 f64, optionally followed by "[count]"
+ * for an array. A last field of type "bytes" takes the rest of the sample, e.g. the pixels after an image header.
+ */
+typedef struct {
+    char name[DJI_TEST_TELEMETRY_BUS_NAME_MAX_SIZE];    /*!< e.g. "dji.fc.quaternion". */
+    uint32_t version;               /*!< Incremented on any change of the layout. */
+    uint32_t fixedSize;             /*!< Bytes of the fields before "bytes", computed from the layout. */
+    uint32_t isVariable;            /*!< The layout ends with "bytes", samples may be longer than fixedSize. */
+    uint32_t reserved;
+    char layout[DJI_TEST_TELEMETRY_BUS_LAYOUT_MAX_SIZE];
+} T_DjiTestTelemetrySchema;
+
+typedef struct {
+    char name[DJI_TEST_TELEMETRY_BUS_NAME_MAX_SIZE];    /*!< e.g. "fc/quaternion". */
+    uint16_t schemaId;
+    uint16_t reserved;
+    uint32_t slotCount;
+    uint32_t slotSize;              /*!< Largest sample. */
+    uint32_t reserved2;
+} T_DjiTestTelemetryTopicInfo;
+
+/**
+ * @brief The bus object "dji_bus_<name>", the registry of schemas and topics. Entries are only appended, a count is
+ * stored after its entry so readers never see a partial one.
+ */
+typedef struct {
+    uint32_t magic;
+    uint16_t version;
+    uint16_t headerSize;
+    int32_t pid;                    /*!< Publisher, the bus is dead when it no longer exists. */
+    uint32_t isClosed;
+    uint64_t generation;            /*!< Creation time, topic objects carry the same value. */
+    uint32_t schemaCount;
+    uint32_t topicCount;
+    T_DjiTestTelemetrySchema schemas[DJI_TEST_TELEMETRY_BUS_SCHEMA_MAX_NUM];
+    T_DjiTestTelemetryTopicInfo topics[DJI_TEST_TELEMETRY_BUS_TOPIC_MAX_NUM];
+} T_DjiTestTelemetryBusHeader;
+
+/**
+ * @brief Start of the topic object "dji_bus_<name>_<topicId>", followed at slotOffset by slotCount slots of
+ * slotStride bytes, each a T_DjiTestTelemetrySlotHeader and the sample.
+ * @note The header has a page of its own, subscribers map it writable to count themselves as waiters and map the
+ * slots read only.
+ */
+typedef struct {
+    uint32_t magic;
+    uint16_t version;
+    uint16_t topicId;
+    uint32_t slotCount;             /*!< Power of two. */
+    uint32_t slotSize;
+    uint32_t slotStride;
+    uint32_t slotOffset;
+    uint64_t generation;
+    uint32_t isClosed;
+    uint32_t reserved[7];
+    /* Second cache line, written on every publish. */
+    uint64_t writeSeq;              /*!< Samples published, sample n is in slot n % slotCount. */
+    uint32_t notifySeq;             /*!< Futex word, incremented after each publish. */
+    uint32_t waiterCount;           /*!< Subscribers blocked on notifySeq, the publisher skips the wake when 0. */
+} T_DjiTestTelemetryTopicHeader;
+
+/**
+ * @brief The slot is a sequence lock, seq is 2n + 1 while sample n is written and 2n + 2 once it is complete.
+ */
+typedef struct {
+    uint64_t seq;
+    uint64_t timeUs;                /*!< CLOCK_MONOTONIC at publish, the same clock for all processes of the host. */
+    uint32_t len;
+    uint32_t reserved;
+} T_DjiTestTelemetrySlotHeader;
+
+typedef struct {
+    char name[DJI_TEST_TELEMETRY_BUS_NAME_MAX_SIZE];
+    uint16_t schemaId;
+    uint32_t slotCount;             /*!< Rounded up to a power of two, at most DJI_TEST_TELEMETRY_BUS_SLOT_MAX_NUM. */
+    uint32_t slotSize;
+} T_DjiTestTelemetryTopicConfig;
+
+typedef struct {
+    uint64_t publishedCount;
+    uint64_t publishedBytes;
+    uint32_t oversizeCount;         /*!< Samples larger than the slot, not published. */
+    uint32_t wakeCount;             /*!< Publishes that found a waiting subscriber. */
+} T_DjiTestTelemetryTopicStatistics;
+
+typedef struct {
+    T_DjiTestTelemetryTopicHeader *header;
+    uint8_t *slots;
+    uint32_t mapSize;
+    T_DjiMutexHandle mutex;
+    bool isLoaned;
+    T_DjiTestTelemetryTopicStatistics statistics;
+} T_DjiTestTelemetryBusTopic;
+
+/**
+ * @brief Publisher side of a bus, owned by one process.
+ * @note Every topic is a ring of slots that the publisher overwrites in order and never waits for, a subscriber that
+ * falls more than slotCount samples behind loses the oldest ones. Readers take samples in place from the shared
+ * memory and learn afterwards whether the slot was overwritten meanwhile, so nothing is copied and a slow or dead
+ * reader cannot delay a callback of the SDK. All functions are thread-safe.
+ */
+typedef struct {
+    char name[DJI_TEST_TELEMETRY_BUS_NAME_MAX_SIZE];
+    T_DjiTestTelemetryBusHeader *header;
+    T_DjiMutexHandle mutex;
+    T_DjiTestTelemetryBusTopic topics[DJI_TEST_TELEMETRY_BUS_TOPIC_MAX_NUM];
+} T_DjiTestTelemetryBus;
+
+/**
+ * @brief Read side of a bus, used by other processes. Needs no SDK library, only the client source file.
+ */
+typedef struct {
+    char name[DJI_TEST_TELEMETRY_BUS_NAME_MAX_SIZE];
+    const T_DjiTestTelemetryBusHeader *header;
+} T_DjiTestTelemetryClient;
+
+typedef struct {
+    uint64_t receivedCount;
+    uint64_t lostCount;             /*!< Samples overwritten before they were received. */
+    uint64_t tornCount;             /*!< Samples overwritten while they were read, counted as lost too. */
+    uint64_t waitCount;             /*!< Receives that blocked on the futex. */
+} T_DjiTestTelemetrySubscriberStatistics;
+
+typedef struct {
+    const T_DjiTestTelemetryClient *client;
+    T_DjiTestTelemetryTopicHeader *header;
+    const uint8_t *slots;
+    uint32_t slotsMapSize;
+    uint16_t topicId;
+    uint32_t slotMask;
+    uint32_t slotSize;
+    uint32_t slotStride;
+    uint64_t nextSeq;
+    T_DjiTestTelemetrySubscriberStatistics statistics;
+} T_DjiTestTelemetrySubscriber;
+
+/**
+ * @brief A sample in the shared memory, valid until DjiTest_TelemetrySubscriberRelease says otherwise.
+ */
+typedef struct {
+    const uint8_t *data;
+    uint32_t len;
+    uint64_t seq;
+    uint64_t timeUs;
+    uint64_t slotSeq;
+} T_DjiTestTelemetrySample;
+
+/* Exported functions --------------------------------------------------------*/
+/* Publisher, test_telemetry_bus.c. */
+T_DjiReturnCode DjiTest_TelemetryBusCreate(T_DjiTestTelemetryBus *bus, const char *name);
+T_DjiReturnCode DjiTest_TelemetryBusDestroy(T_DjiTestTelemetryBus *bus);
+T_DjiReturnCode DjiTest_TelemetryBusRegisterSchema(T_DjiTestTelemetryBus *bus, const char *name, uint32_t version,
+                                                   const char *layout, uint16_t *schemaId);
+T_DjiReturnCode DjiTest_TelemetryBusAddTopic(T_DjiTestTelemetryBus *bus, const T_DjiTestTelemetryTopicConfig *config,
+                                             uint16_t *topicId);
+T_DjiReturnCode DjiTest_TelemetryBusPublish(T_DjiTestTelemetryBus *bus, uint16_t topicId, const void *data,
+                                            uint32_t len);
+/**
+ * @brief Write a sample in place, e.g. straight from a decoder. Loan returns the slot, Commit publishes len bytes of
+ * it. Other publishes of the topic wait in between.
+ */
+T_DjiReturnCode DjiTest_TelemetryBusLoan(T_DjiTestTelemetryBus *bus, uint16_t topicId, uint8_t **data,
+                                         uint32_t *capacity);
+T_DjiReturnCode DjiTest_TelemetryBusCommit(T_DjiTestTelemetryBus *bus, uint16_t topicId, uint32_t len);
+void DjiTest_TelemetryBusGetStatistics(T_DjiTestTelemetryBus *bus, uint16_t topicId,
+                                       T_DjiTestTelemetryTopicStatistics *statistics);
+
+/**
+ * @brief The bus the samples publish what they receive on, created on first use with the default name. Returns NULL
+ * when it cannot be created, publishing is then skipped.
+ */
+T_DjiTestTelemetryBus *DjiTest_TelemetryBusGetDefault(void);
+/**
+ * @brief Register the schema and add the topic on the default bus in one step, for the samples.
+ */
+T_DjiReturnCode DjiTest_TelemetryBusAddDefaultTopic(const char *topicName, const char *schemaName,
+                                                    uint32_t schemaVersion, const char *layout, uint32_t slotSize,
+                                                    uint32_t slotCount, uint16_t *topicId);
+
+/* Client, test_telemetry_bus_client.c. */
+T_DjiReturnCode DjiTest_TelemetryClientOpen(T_DjiTestTelemetryClient *client, const char *name);
+T_DjiReturnCode DjiTest_TelemetryClientClose(T_DjiTestTelemetryClient *client);
+/**
+ * @brief False once the publisher closed the bus or exited, a new publisher creates a new bus to open again.
+ */
+bool DjiTest_TelemetryClientIsAlive(const T_DjiTestTelemetryClient *client);
+uint32_t DjiTest_TelemetryClientGetTopicCount(const T_DjiTestTelemetryClient *client);
+T_DjiReturnCode DjiTest_TelemetryClientGetTopic(const T_DjiTestTelemetryClient *client, uint16_t topicId,
+                                                T_DjiTestTelemetryTopicInfo *info, T_DjiTestTelemetrySchema *schema);
+T_DjiReturnCode DjiTest_TelemetryClientFindTopic(const T_DjiTestTelemetryClient *client, const char *name,
+                                                 uint16_t *topicId);
+
+/**
+ * @brief Start receiving a topic with the next sample published, or with the oldest one still in the ring.
+ */
+T_DjiReturnCode DjiTest_TelemetrySubscribe(const T_DjiTestTelemetryClient *client, uint16_t topicId,
+                                           bool isFromOldest, T_DjiTestTelemetrySubscriber *subscriber);
+T_DjiReturnCode DjiTest_TelemetryUnsubscribe(T_DjiTestTelemetrySubscriber *subscriber);
+/**
+ * @brief Take the next sample, waiting up to timeoutMs for it. Returns timeout when none arrived and not found when
+ * the publisher is gone.
+ */
+T_DjiReturnCode DjiTest_TelemetrySubscriberReceive(T_DjiTestTelemetrySubscriber *subscriber,
+                                                   T_DjiTestTelemetrySample *sample, uint32_t timeoutMs);
+/**
+ * @brief Finish reading a sample. Returns success when the data read was intact and out of range when the publisher
+ * overwrote the slot meanwhile, the data must then be discarded.
+ */
+T_DjiReturnCode DjiTest_TelemetrySubscriberRelease(T_DjiTestTelemetrySubscriber *subscriber,
+                                                   const T_DjiTestTelemetrySample *sample);
+
+/**
+ * @brief Path of the bus object, or of a topic object when topicId is not negative. False for names other than 1 to
+ * DJI_TEST_TELEMETRY_BUS_NAME_MAX_SIZE - 1 letters, digits, '-' and '_'.
+ */
+bool DjiTest_TelemetryGetObjectPath(const char *busName, int32_t topicId, char *path, uint32_t size);
+T_DjiReturnCode DjiTest_TelemetryGetLayoutSize(const char *layout, uint32_t *fixedSize, bool *isVariable);
+/**
+ * @brief Print the fields of a sample as "name=value" by its schema, the bytes field as its length.
+ */
+uint32_t DjiTest_TelemetryFormatSample(const T_DjiTestTelemetrySchema *schema, const uint8_t *data, uint32_t len,
+                                       char *text, uint32_t size);
+
+#endif
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // TEST_TELEMETRY_BUS_H
+/************************ (C) COPYRIGHT DJI Innovations *******END OF FILE******/
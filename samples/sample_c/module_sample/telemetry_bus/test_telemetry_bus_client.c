@@ -0,0 +1,649 @@
+/**
+ ********************************************************************
+ * @file    test_telemetry_bus_client.c
+ * @brief   Read side of the shared memory telemetry bus, for the processes consuming the data of the samples.
+ *
+ * @copyright (c) 2021 DJI. All rights reserved.
+ *
+ * All information contained herein is, and remains, the property of DJI.
+ * The intellectual and technical concepts contained herein are proprietary
+ * to DJI and may be covered by U.S. and foreign patents, patents in process,
+ * and protected by trade secret or copyright law.  Dissemination of this
+ * information, including but not limited to data and other proprietary
+ * material(s) incorporated within the information, in any form, is strictly
+ * prohibited without the express written consent of DJI.
+ *
+ * If you receive this source code without DJI’s authorization, you may not
+ * further disseminate the information, and you must immediately remove the
+ * source code and notify DJI of its removal. DJI reserves the right to pursue
+ * legal actions against you for any loss(es) or damage(s) caused by your
+ * failure to do so.
+ *
+ *********************************************************************
+ */
+
+/* Includes ------------------------------------------------------------------*/
+#include "test_telemetry_bus.h"
+
+#ifdef SYSTEM_ARCH_LINUX
+
+#include <stdio.h>
+#include <stdarg.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <signal.h>
+#include <time.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/syscall.h>
+#include <linux/futex.h>
+
+/* Only the headers of the SDK are used here, a client builds without the SDK library and without an osal. */
+
+/* Private constants ---------------------------------------------------------*/
+#define DJI_TEST_TELEMETRY_BUS_MAGIC                0x42544A44      /* "DJTB" */
+#define DJI_TEST_TELEMETRY_TOPIC_MAGIC              0x54544A44      /* "DJTT" */
+#define DJI_TEST_TELEMETRY_LAYOUT_TYPE_NUM          (10)
+
+/* Private types -------------------------------------------------------------*/
+typedef enum {
+    DJI_TEST_TELEMETRY_FIELD_UNSIGNED = 0,
+    DJI_TEST_TELEMETRY_FIELD_SIGNED,
+    DJI_TEST_TELEMETRY_FIELD_FLOAT,
+} E_DjiTestTelemetryFieldKind;
+
+typedef struct {
+    const char *name;
+    uint8_t size;
+    E_DjiTestTelemetryFieldKind kind;
+} T_DjiTestTelemetryFieldType;
+
+typedef struct {
+    const char *name;
+    uint32_t nameLen;
+    const T_DjiTestTelemetryFieldType *type;    /*!< NULL for the bytes field. */
+    uint32_t count;
+} T_DjiTestTelemetryField;
+
+/* Private functions declaration ---------------------------------------------*/
+static bool DjiTest_TelemetryNextField(const char **layout, T_DjiTestTelemetryField *field);
+static void DjiTest_TelemetryFormatValue(const T_DjiTestTelemetryFieldType *type, const uint8_t *data,
+                                         char *text, uint32_t size, uint32_t *textLen);
+static void DjiTest_TelemetryAppend(char *text, uint32_t size, uint32_t *textLen, const char *format, ...);
+static void *DjiTest_TelemetryMapObject(const char *path, uint32_t offset, uint32_t len, bool isWritable);
+static uint32_t DjiTest_TelemetryGetPageSize(void);
+static uint64_t DjiTest_TelemetryGetMonotonicMs(void);
+
+/* Private values ------------------------------------------------------------*/
+static const T_DjiTestTelemetryFieldType s_telemetryFieldTypes[DJI_TEST_TELEMETRY_LAYOUT_TYPE_NUM] = {
+    {"u8",  1, DJI_TEST_TELEMETRY_FIELD_UNSIGNED},
+    {"i8",  1, DJI_TEST_TELEMETRY_FIELD_SIGNED},
+    {"u16", 2, DJI_TEST_TELEMETRY_FIELD_UNSIGNED},
+    {"i16", 2, DJI_TEST_TELEMETRY_FIELD_SIGNED},
+    {"u32", 4, DJI_TEST_TELEMETRY_FIELD_UNSIGNED},
+    {"i32", 4, DJI_TEST_TELEMETRY_FIELD_SIGNED},
+    {"u64", 8, DJI_TEST_TELEMETRY_FIELD_UNSIGNED},
+    {"i64", 8, DJI_TEST_TELEMETRY_FIELD_SIGNED},
+    {"f32", 4, DJI_TEST_TELEMETRY_FIELD_FLOAT},
+    {"f64", 8, DJI_TEST_TELEMETRY_FIELD_FLOAT},
+};
+
+/* Exported functions definition ---------------------------------------------*/
+T_DjiReturnCode DjiTest_TelemetryClientOpen(T_DjiTestTelemetryClient *client, const char *name)
+{
+    char path[DJI_TEST_TELEMETRY_BUS_PATH_MAX_SIZE];
+    const T_DjiTestTelemetryBusHeader *header;
+
+    if (client == NULL || !DjiTest_TelemetryGetObjectPath(name, -1, path, sizeof(path))) {
+        return DJI_ERROR_SYSTEM_MODULE_CODE_INVALID_PARAMETER;
+    }
+
+    memset(client, 0, sizeof(T_DjiTestTelemetryClient));
+
+    header = DjiTest_TelemetryMapObject(path, 0, sizeof(T_DjiTestTelemetryBusHeader), false);
+    if (header == NULL) {
+        return DJI_ERROR_SYSTEM_MODULE_CODE_NOT_FOUND;
+    }
+
+    /* The magic is stored last by the publisher, a bus still being created looks absent. */
+    if (__atomic_load_n(&header->magic, __ATOMIC_ACQUIRE) != DJI_TEST_TELEMETRY_BUS_MAGIC ||
+        header->version != DJI_TEST_TELEMETRY_BUS_FORMAT_VERSION ||
+        header->headerSize != sizeof(T_DjiTestTelemetryBusHeader)) {
+        munmap((void *) header, sizeof(T_DjiTestTelemetryBusHeader));
+        return DJI_ERROR_SYSTEM_MODULE_CODE_NONSUPPORT;
+    }
+
+    strcpy(client->name, name);
+    client->header = header;
+
+    return DJI_ERROR_SYSTEM_MODULE_CODE_SUCCESS;
+}
+
+T_DjiReturnCode DjiTest_TelemetryClientClose(T_DjiTestTelemetryClient *client)
+{
+    if (client == NULL || client->header == NULL) {
+        return DJI_ERROR_SYSTEM_MODULE_CODE_INVALID_PARAMETER;
+    }
+
+    munmap((void *) client->header, sizeof(T_DjiTestTelemetryBusHeader));
+    client->header = NULL;
+
+    return DJI_ERROR_SYSTEM_MODULE_CODE_SUCCESS;
+}
+
+bool DjiTest_TelemetryClientIsAlive(const T_DjiTestTelemetryClient *client)
+{
+    if (client == NULL || client->header == NULL ||
+        __atomic_load_n(&client->header->isClosed, __ATOMIC_ACQUIRE) != 0) {
+        return false;
+    }
+
+    /* A publisher of another user is alive as well, kill only checks the permission then. */
+    return kill(client->header->pid, 0) == 0 || errno == EPERM;
+}
+
+uint32_t DjiTest_TelemetryClientGetTopicCount(const T_DjiTestTelemetryClient *client)
+{
+    uint32_t count;
+
+    if (client == NULL || client->header == NULL) {
+        return 0;
+    }
+
+    count = __atomic_load_n(&client->header->topicCount, __ATOMIC_ACQUIRE);
+
+    return count < DJI_TEST_TELEMETRY_BUS_TOPIC_MAX_NUM ? count : DJI_TEST_TELEMETRY_BUS_TOPIC_MAX_NUM;
+}
+
+T_DjiReturnCode DjiTest_TelemetryClientGetTopic(const T_DjiTestTelemetryClient *client, uint16_t topicId,
+                                                T_DjiTestTelemetryTopicInfo *info, T_DjiTestTelemetrySchema *schema)
+{
+    uint32_t schemaCount;
+
+    if (client == NULL || client->header == NULL || info == NULL) {
+        return DJI_ERROR_SYSTEM_MODULE_CODE_INVALID_PARAMETER;
+    }
+    if (topicId >= DjiTest_TelemetryClientGetTopicCount(client)) {
+        return DJI_ERROR_SYSTEM_MODULE_CODE_NOT_FOUND;
+    }
+
+    *info = client->header->topics[topicId];
+    info->name[sizeof(info->name) - 1] = '\0';
+
+    if (schema != NULL) {
+        schemaCount = __atomic_load_n(&client->header->schemaCount, __ATOMIC_ACQUIRE);
+        if (info->schemaId >= schemaCount || info->schemaId >= DJI_TEST_TELEMETRY_BUS_SCHEMA_MAX_NUM) {
+            return DJI_ERROR_SYSTEM_MODULE_CODE_NOT_FOUND;
+        }
+        *schema = client->header->schemas[info->schemaId];
+        schema->name[sizeof(schema->name) - 1] = '\0';
+        schema->layout[sizeof(schema->layout) - 1] = '\0';
+    }
+
+    return DJI_ERROR_SYSTEM_MODULE_CODE_SUCCESS;
+}
+
+T_DjiReturnCode DjiTest_TelemetryClientFindTopic(const T_DjiTestTelemetryClient *client, const char *name,
+                                                 uint16_t *topicId)
+{
+    uint32_t count = DjiTest_TelemetryClientGetTopicCount(client);
+    uint32_t i;
+
+    if (name == NULL || topicId == NULL) {
+        return DJI_ERROR_SYSTEM_MODULE_CODE_INVALID_PARAMETER;
+    }
+
+    for (i = 0; i < count; i++) {
+        if (strncmp(client->header->topics[i].name, name, DJI_TEST_TELEMETRY_BUS_NAME_MAX_SIZE) == 0) {
+            *topicId = (uint16_t) i;
+            return DJI_ERROR_SYSTEM_MODULE_CODE_SUCCESS;
+        }
+    }
+
+    return DJI_ERROR_SYSTEM_MODULE_CODE_NOT_FOUND;
+}
+
+T_DjiReturnCode DjiTest_TelemetrySubscribe(const T_DjiTestTelemetryClient *client, uint16_t topicId,
+                                           bool isFromOldest, T_DjiTestTelemetrySubscriber *subscriber)
+{
+    T_DjiTestTelemetryTopicInfo info;
+    T_DjiTestTelemetryTopicHeader *header;
+    char path[DJI_TEST_TELEMETRY_BUS_PATH_MAX_SIZE];
+    T_DjiReturnCode returnCode;
+    uint32_t pageSize = DjiTest_TelemetryGetPageSize();
+    uint32_t headerMapSize = (sizeof(T_DjiTestTelemetryTopicHeader) + pageSize - 1) / pageSize * pageSize;
+    uint64_t slotsSize;
+    uint64_t writeSeq;
+
+    if (subscriber == NULL) {
+        return DJI_ERROR_SYSTEM_MODULE_CODE_INVALID_PARAMETER;
+    }
+
+    returnCode = DjiTest_TelemetryClientGetTopic(client, topicId, &info, NULL);
+    if (returnCode != DJI_ERROR_SYSTEM_MODULE_CODE_SUCCESS) {
+        return returnCode;
+    }
+    DjiTest_TelemetryGetObjectPath(client->name, topicId, path, sizeof(path));
+
+    memset(subscriber, 0, sizeof(T_DjiTestTelemetrySubscriber));
+
+    header = DjiTest_TelemetryMapObject(path, 0, headerMapSize, true);
+    if (header == NULL) {
+        return DJI_ERROR_SYSTEM_MODULE_CODE_NOT_FOUND;
+    }
+
+    /* Everything the slot addressing depends on is checked, the memory is shared with another process. */
+    slotsSize = (uint64_t) header->slotStride * header->slotCount;
+    if (__atomic_load_n(&header->magic, __ATOMIC_ACQUIRE) != DJI_TEST_TELEMETRY_TOPIC_MAGIC ||
+        header->version != DJI_TEST_TELEMETRY_BUS_FORMAT_VERSION || header->topicId != topicId ||
+        header->generation != client->header->generation || header->slotCount != info.slotCount ||
+        header->slotSize != info.slotSize || header->slotCount == 0 ||
+        (header->slotCount & (header->slotCount - 1)) != 0 ||
+        header->slotStride < sizeof(T_DjiTestTelemetrySlotHeader) + header->slotSize ||
+        header->slotStride % sizeof(uint64_t) != 0 || header->slotOffset != headerMapSize ||
+        slotsSize > UINT32_MAX) {
+        munmap(header, headerMapSize);
+        return DJI_ERROR_SYSTEM_MODULE_CODE_NONSUPPORT;
+    }
+
+    subscriber->slots = DjiTest_TelemetryMapObject(path, header->slotOffset, (uint32_t) slotsSize, false);
+    if (subscriber->slots == NULL) {
+        munmap(header, headerMapSize);
+        return DJI_ERROR_SYSTEM_MODULE_CODE_SYSTEM_ERROR;
+    }
+
+    subscriber->client = client;
+    subscriber->header = header;
+    subscriber->slotsMapSize = (uint32_t) slotsSize;
+    subscriber->topicId = topicId;
+    subscriber->slotMask = header->slotCount - 1;
+    subscriber->slotSize = header->slotSize;
+    subscriber->slotStride = header->slotStride;
+
+    writeSeq = __atomic_load_n(&header->writeSeq, __ATOMIC_ACQUIRE);
+    if (isFromOldest) {
+        subscriber->nextSeq = writeSeq > header->slotCount ? writeSeq - header->slotCount : 0;
+    } else {
+        subscriber->nextSeq = writeSeq;
+    }
+
+    return DJI_ERROR_SYSTEM_MODULE_CODE_SUCCESS;
+}
+
+T_DjiReturnCode DjiTest_TelemetryUnsubscribe(T_DjiTestTelemetrySubscriber *subscriber)
+{
+    uint32_t pageSize = DjiTest_TelemetryGetPageSize();
+
+    if (subscriber == NULL || subscriber->header == NULL) {
+        return DJI_ERROR_SYSTEM_MODULE_CODE_INVALID_PARAMETER;
+    }
+
+    munmap((void *) subscriber->slots, subscriber->slotsMapSize);
+    munmap(subscriber->header, (sizeof(T_DjiTestTelemetryTopicHeader) + pageSize - 1) / pageSize * pageSize);
+    subscriber->header = NULL;
+    subscriber->slots = NULL;
+
+    return DJI_ERROR_SYSTEM_MODULE_CODE_SUCCESS;
+}
+
+T_DjiReturnCode DjiTest_TelemetrySubscriberReceive(T_DjiTestTelemetrySubscriber *subscriber,
+                                                   T_DjiTestTelemetrySample *sample, uint32_t timeoutMs)
+{
+    T_DjiTestTelemetryTopicHeader *header;
+    const T_DjiTestTelemetrySlotHeader *slot;
+    uint64_t deadlineMs = 0;
+    uint64_t nowMs;
+    uint64_t writeSeq;
+    uint64_t slotSeq;
+    uint32_t notifySeq;
+    struct timespec timeout;
+
+    if (subscriber == NULL || subscriber->header == NULL || sample == NULL) {
+        return DJI_ERROR_SYSTEM_MODULE_CODE_INVALID_PARAMETER;
+    }
+    header = subscriber->header;
+
+    while (true) {
+        writeSeq = __atomic_load_n(&header->writeSeq, __ATOMIC_ACQUIRE);
+        if (subscriber->nextSeq < writeSeq) {
+            if (writeSeq - subscriber->nextSeq > subscriber->slotMask + 1) {
+                subscriber->statistics.lostCount += writeSeq - (subscriber->slotMask + 1) - subscriber->nextSeq;
+                subscriber->nextSeq = writeSeq - (subscriber->slotMask + 1);
+            }
+
+            slot = (const T_DjiTestTelemetrySlotHeader *) (subscriber->slots +
+                                                           (uint64_t) (subscriber->nextSeq & subscriber->slotMask) *
+                                                           subscriber->slotStride);
+            slotSeq = __atomic_load_n(&slot->seq, __ATOMIC_ACQUIRE);
+            if (slotSeq != subscriber->nextSeq * 2 + 2) {
+                /* Already overwritten by a publisher that lapped the ring since writeSeq was read. */
+                subscriber->statistics.lostCount++;
+                subscriber->nextSeq++;
+                continue;
+            }
+
+            sample->data = (const uint8_t *) (slot + 1);
+            sample->len = slot->len <= subscriber->slotSize ? slot->len : subscriber->slotSize;
+            sample->seq = subscriber->nextSeq;
+            sample->timeUs = slot->timeUs;
+            sample->slotSeq = slotSeq;
+            subscriber->nextSeq++;
+
+            return DJI_ERROR_SYSTEM_MODULE_CODE_SUCCESS;
+        }
+
+        if (__atomic_load_n(&header->isClosed, __ATOMIC_ACQUIRE) != 0) {
+            return DJI_ERROR_SYSTEM_MODULE_CODE_NOT_FOUND;
+        }
+        if (timeoutMs == 0) {
+            return DJI_ERROR_SYSTEM_MODULE_CODE_TIMEOUT;
+        }
+
+        nowMs = DjiTest_TelemetryGetMonotonicMs();
+        if (deadlineMs == 0) {
+            deadlineMs = nowMs + timeoutMs;
+        } else if (nowMs >= deadlineMs) {
+            /* A publisher that crashed never closes its topics. */
+            return DjiTest_TelemetryClientIsAlive(subscriber->client) ? DJI_ERROR_SYSTEM_MODULE_CODE_TIMEOUT :
+                   DJI_ERROR_SYSTEM_MODULE_CODE_NOT_FOUND;
+        }
+
+        /* A publish after writeSeq was read changes notifySeq, the futex then returns at once. */
+        notifySeq = __atomic_load_n(&header->notifySeq, __ATOMIC_ACQUIRE);
+        if (__atomic_load_n(&header->writeSeq, __ATOMIC_ACQUIRE) != writeSeq) {
+            continue;
+        }
+
+        timeout.tv_sec = (time_t) ((deadlineMs - nowMs) / 1000);
+        timeout.tv_nsec = (long) ((deadlineMs - nowMs) % 1000) * 1000000;
+        __atomic_add_fetch(&header->waiterCount, 1, __ATOMIC_SEQ_CST);
+        syscall(SYS_futex, &header->notifySeq, FUTEX_WAIT, notifySeq, &timeout, NULL, 0);
+        __atomic_sub_fetch(&header->waiterCount, 1, __ATOMIC_SEQ_CST);
+        subscriber->statistics.waitCount++;
+    }
+}
+
+T_DjiReturnCode DjiTest_TelemetrySubscriberRelease(T_DjiTestTelemetrySubscriber *subscriber,
+                                                   const T_DjiTestTelemetrySample *sample)
+{
+    const T_DjiTestTelemetrySlotHeader *slot;
+
+    if (subscriber == NULL || subscriber->header == NULL || sample == NULL) {
+        return DJI_ERROR_SYSTEM_MODULE_CODE_INVALID_PARAMETER;
+    }
+
+    slot = (const T_DjiTestTelemetrySlotHeader *) (subscriber->slots + (uint64_t) (sample->seq & subscriber->slotMask) *
+                                                                       subscriber->slotStride);
+
+    /* The reads of the sample are ordered before the second read of the sequence. */
+    __atomic_thread_fence(__ATOMIC_ACQUIRE);
+    if (__atomic_load_n(&slot->seq, __ATOMIC_RELAXED) != sample->slotSeq) {
+        subscriber->statistics.tornCount++;
+        subscriber->statistics.lostCount++;
+        return DJI_ERROR_SYSTEM_MODULE_CODE_OUT_OF_RANGE;
+    }
+
+    subscriber->statistics.receivedCount++;
+
+    return DJI_ERROR_SYSTEM_MODULE_CODE_SUCCESS;
+}
+
+bool DjiTest_TelemetryGetObjectPath(const char *busName, int32_t topicId, char *path, uint32_t size)
+{
+    uint32_t i;
+
+    if (busName == NULL || busName[0] == '\0' || path == NULL) {
+        return false;
+    }
+    for (i = 0; busName[i] != '\0'; i++) {
+        if (i >= DJI_TEST_TELEMETRY_BUS_NAME_MAX_SIZE - 1 ||
+            !((busName[i] >= 'a' && busName[i] <= 'z') || (busName[i] >= 'A' && busName[i] <= 'Z') ||
+              (busName[i] >= '0' && busName[i] <= '9') || busName[i] == '-' || busName[i] == '_')) {
+            return false;
+        }
+    }
+
+    if (topicId < 0) {
+        snprintf(path, size, "%s/%s%s", DJI_TEST_TELEMETRY_BUS_SHM_DIRECTORY, DJI_TEST_TELEMETRY_BUS_OBJECT_PREFIX,
+                 busName);
+    } else {
+        snprintf(path, size, "%s/%s%s_%d", DJI_TEST_TELEMETRY_BUS_SHM_DIRECTORY, DJI_TEST_TELEMETRY_BUS_OBJECT_PREFIX,
+                 busName, topicId);
+    }
+
+    return true;
+}
+
+T_DjiReturnCode DjiTest_TelemetryGetLayoutSize(const char *layout, uint32_t *fixedSize, bool *isVariable)
+{
+    T_DjiTestTelemetryField field;
+    uint64_t size = 0;
+
+    if (layout == NULL || fixedSize == NULL || isVariable == NULL ||
+        strlen(layout) >= DJI_TEST_TELEMETRY_BUS_LAYOUT_MAX_SIZE) {
+        return DJI_ERROR_SYSTEM_MODULE_CODE_INVALID_PARAMETER;
+    }
+
+    *isVariable = false;
+    while (*layout != '\0') {
+        if (*isVariable || !DjiTest_TelemetryNextField(&layout, &field)) {
+            /* Bytes must be the last field. */
+            return DJI_ERROR_SYSTEM_MODULE_CODE_INVALID_PARAMETER;
+        }
+        if (field.type == NULL) {
+            *isVariable = true;
+        } else {
+            size += (uint64_t) field.type->size * field.count;
+        }
+        while (*layout == ' ') {
+            layout++;
+        }
+    }
+
+    if (size > DJI_TEST_TELEMETRY_BUS_SLOT_MAX_SIZE) {
+        return DJI_ERROR_SYSTEM_MODULE_CODE_OUT_OF_RANGE;
+    }
+    *fixedSize = (uint32_t) size;
+
+    return DJI_ERROR_SYSTEM_MODULE_CODE_SUCCESS;
+}
+
+uint32_t DjiTest_TelemetryFormatSample(const T_DjiTestTelemetrySchema *schema, const uint8_t *data, uint32_t len,
+                                       char *text, uint32_t size)
+{
+    T_DjiTestTelemetryField field;
+    const char *layout;
+    uint32_t offset = 0;
+    uint32_t textLen = 0;
+    uint32_t i;
+
+    if (schema == NULL || text == NULL || size == 0) {
+        return 0;
+    }
+
+    text[0] = '\0';
+    layout = schema->layout;
+    while (*layout != '\0' && DjiTest_TelemetryNextField(&layout, &field)) {
+        DjiTest_TelemetryAppend(text, size, &textLen, "%s%.*s=", textLen > 0 ? " " : "", (int) field.nameLen,
+                                field.name);
+        if (field.type == NULL) {
+            DjiTest_TelemetryAppend(text, size, &textLen, "<%u bytes>", len > offset ? len - offset : 0);
+            break;
+        }
+
+        for (i = 0; i < field.count; i++) {
+            if (offset + field.type->size > len) {
+                DjiTest_TelemetryAppend(text, size, &textLen, "?");
+                break;
+            }
+            if (i > 0) {
+                DjiTest_TelemetryAppend(text, size, &textLen, ",");
+            }
+            DjiTest_TelemetryFormatValue(field.type, data + offset, text, size, &textLen);
+            offset += field.type->size;
+        }
+        if (textLen + 1 >= size) {
+            break;
+        }
+    }
+
+    return textLen;
+}
+
+/* Private functions definition-----------------------------------------------*/
+/**
+ * @brief Parse one "name:type[count]" of a layout, layout is left on the character after it.
+ */
+static bool DjiTest_TelemetryNextField(const char **layout, T_DjiTestTelemetryField *field)
+{
+    const char *position = *layout;
+    const char *typeName;
+    uint32_t typeLen;
+    char *end;
+    unsigned long count;
+    uint32_t i;
+
+    while (*position == ' ') {
+        position++;
+    }
+
+    field->name = position;
+    while (*position != ':' && *position != ' ' && *position != '\0') {
+        position++;
+    }
+    field->nameLen = (uint32_t) (position - field->name);
+    if (*position != ':' || field->nameLen == 0) {
+        return false;
+    }
+
+    typeName = ++position;
+    while (*position != '[' && *position != ' ' && *position != '\0') {
+        position++;
+    }
+    typeLen = (uint32_t) (position - typeName);
+
+    field->count = 1;
+    if (*position == '[') {
+        count = strtoul(position + 1, &end, 10);
+        if (end == position + 1 || *end != ']' || count == 0 || count > DJI_TEST_TELEMETRY_BUS_SLOT_MAX_SIZE) {
+            return false;
+        }
+        field->count = (uint32_t) count;
+        position = end + 1;
+    }
+    if (*position != ' ' && *position != '\0') {
+        return false;
+    }
+    *layout = position;
+
+    if (typeLen == strlen("bytes") && strncmp(typeName, "bytes", typeLen) == 0) {
+        field->type = NULL;
+        return field->count == 1;
+    }
+    for (i = 0; i < DJI_TEST_TELEMETRY_LAYOUT_TYPE_NUM; i++) {
+        if (typeLen == strlen(s_telemetryFieldTypes[i].name) &&
+            strncmp(typeName, s_telemetryFieldTypes[i].name, typeLen) == 0) {
+            field->type = &s_telemetryFieldTypes[i];
+            return true;
+        }
+    }
+
+    return false;
+}
+
+static void DjiTest_TelemetryFormatValue(const T_DjiTestTelemetryFieldType *type, const uint8_t *data,
+                                         char *text, uint32_t size, uint32_t *textLen)
+{
+    uint64_t value = 0;
+    int64_t signedValue;
+    float floatValue;
+    double doubleValue;
+
+    /* Samples are packed, fields may be unaligned. */
+    memcpy(&value, data, type->size);
+
+    switch (type->kind) {
+        case DJI_TEST_TELEMETRY_FIELD_FLOAT:
+            if (type->size == sizeof(float)) {
+                memcpy(&floatValue, data, sizeof(floatValue));
+                doubleValue = floatValue;
+            } else {
+                memcpy(&doubleValue, data, sizeof(doubleValue));
+            }
+            DjiTest_TelemetryAppend(text, size, textLen, "%g", doubleValue);
+            break;
+        case DJI_TEST_TELEMETRY_FIELD_SIGNED:
+            signedValue = (int64_t) (value << (64 - 8 * type->size)) >> (64 - 8 * type->size);
+            DjiTest_TelemetryAppend(text, size, textLen, "%lld", (long long) signedValue);
+            break;
+        default:
+            DjiTest_TelemetryAppend(text, size, textLen, "%llu", (unsigned long long) value);
+            break;
+    }
+}
+
+/**
+ * @brief snprintf at the end of text, textLen stops at size - 1 when the text is full.
+ */
+static void DjiTest_TelemetryAppend(char *text, uint32_t size, uint32_t *textLen, const char *format, ...)
+{
+    va_list args;
+    int len;
+
+    if (*textLen + 1 >= size) {
+        return;
+    }
+
+    va_start(args, format);
+    len = vsnprintf(text + *textLen, size - *textLen, format, args);
+    va_end(args);
+
+    if (len > 0) {
+        *textLen = *textLen + (uint32_t) len < size ? *textLen + (uint32_t) len : size - 1;
+    }
+}
+
+static void *DjiTest_TelemetryMapObject(const char *path, uint32_t offset, uint32_t len, bool isWritable)
+{
+    struct stat fileStat;
+    void *address;
+    int fd;
+
+    fd = open(path, (isWritable ? O_RDWR : O_RDONLY) | O_CLOEXEC);
+    if (fd < 0) {
+        return NULL;
+    }
+
+    if (fstat(fd, &fileStat) != 0 || (uint64_t) fileStat.st_size < (uint64_t) offset + len) {
+        close(fd);
+        return NULL;
+    }
+
+    address = mmap(NULL, len, isWritable ? PROT_READ | PROT_WRITE : PROT_READ, MAP_SHARED, fd, offset);
+    close(fd);
+
+    return address == MAP_FAILED ? NULL : address;
+}
+
+static uint32_t DjiTest_TelemetryGetPageSize(void)
+{
+    long pageSize = sysconf(_SC_PAGESIZE);
+
+    return pageSize > 0 ? (uint32_t) pageSize : 4096;
+}
+
+static uint64_t DjiTest_TelemetryGetMonotonicMs(void)
+{
+    struct timespec now;
+
+    clock_gettime(CLOCK_MONOTONIC, &now);
+
+    return (uint64_t) now.tv_sec * 1000 + (uint64_t) now.tv_nsec / 1000000;
+}
+
+#endif
+
+/****************** (C) COPYRIGHT DJI Innovations *****END OF FILE****/
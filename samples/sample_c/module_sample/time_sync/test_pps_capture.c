@@ -0,0 +1,604 @@
+/**
+ ********************************************************************
+ * @file    test_pps_capture.c
+ * @brief   PPS edge capture from the kernel PPS API, a GPIO line or a simulated source.
+ *
+ * @copyright (c) 2021 DJI. All rights reserved.
+ *
+ * All information contained herein is, and remains, the property of DJI.
+ * The intellectual and technical concepts contained herein are proprietary
+ * to DJI and may be covered by U.S. and foreign patents, patents in process,
+ * and protected by trade secret or copyright law.  Dissemination of this
+ * information, including but not limited to data and other proprietary
+ * material(s) incorporated within the information, in any form, is strictly
+ * prohibited without the express written consent of DJI.
+ *
+ * If you receive this source code without DJI’s authorization, you may not
+ * further disseminate the information, and you must immediately remove the
+ * source code and notify DJI of its removal. DJI reserves the right to pursue
+ * legal actions against you for any loss(es) or damage(s) caused by your
+ * failure to do so.
+ *
+ *********************************************************************
+ */
+
+
+/* Includes ------------------------------------------------------------------*/
+#include "test_pps_capture.h"
+
+#ifdef SYSTEM_ARCH_LINUX
+
+#include <errno.h>
+#include <fcntl.h>
+#include <poll.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include <sys/ioctl.h>
+#include <linux/gpio.h>
+#include <linux/pps.h>
+#include "dji_logger.h"
+#include "dji_platform.h"
+#include "utils/util_misc.h"
+
+/* Private constants ---------------------------------------------------------*/
+#define DJI_TEST_PPS_CAPTURE_TASK_STACK_SIZE            (2048)
+#define DJI_TEST_PPS_CAPTURE_WAIT_TIMEOUT_MS            (1500)
+#define DJI_TEST_PPS_CAPTURE_ERROR_RETRY_MS             (100)
+#define DJI_TEST_PPS_CAPTURE_EXIT_TIMEOUT_MS            (3000)
+#define DJI_TEST_PPS_CAPTURE_PERIOD_US                  (1000000)
+#define DJI_TEST_PPS_CAPTURE_SIMULATED_OUTLIER_NS       (5000000)
+#define DJI_TEST_PPS_CAPTURE_GPIO_CONSUMER              "psdk_pps"
+#define DJI_TEST_PPS_CAPTURE_DEFAULT_PPS_DEVICE         "/dev/pps0"
+#define DJI_TEST_PPS_CAPTURE_DEFAULT_GPIO_DEVICE        "/dev/gpiochip0"
+
+/* Private types -------------------------------------------------------------*/
+typedef struct {
+    T_DjiTestPpsCaptureConfig config;
+    char devicePath[DJI_TEST_PPS_CAPTURE_DEVICE_PATH_MAX_SIZE];
+    bool isConfigured;
+    bool isRunning;
+    T_DjiTaskHandle task;
+    T_DjiMutexHandle mutex;
+    T_DjiSemaHandle exitSema;
+    int deviceFd;
+    int eventFd;
+    uint32_t kernelSequence;
+    bool hasKernelSequence;
+    int64_t simulatedBaseNs;
+    uint64_t simulatedIndex;
+    unsigned int simulatedSeed;
+    T_DjiTestPpsEdge newestEdge;
+    bool hasEdge;
+    T_DjiTestPpsCaptureStatistics statistics;
+} T_DjiTestPpsCaptureContext;
+
+/* Private functions declaration ---------------------------------------------*/
+static void *DjiTest_PpsCaptureTask(void *arg);
+static bool DjiTest_PpsCaptureIsRunning(void);
+static T_DjiReturnCode DjiTest_PpsCaptureOpenSource(void);
+static void DjiTest_PpsCaptureCloseSource(void);
+static T_DjiReturnCode DjiTest_PpsCaptureWaitKernelPps(int64_t *edgeNs, clockid_t *clockId);
+static T_DjiReturnCode DjiTest_PpsCaptureWaitGpio(int64_t *edgeNs, clockid_t *clockId);
+static T_DjiReturnCode DjiTest_PpsCaptureWaitSimulated(int64_t *edgeNs, clockid_t *clockId);
+static void DjiTest_PpsCapturePublishEdge(uint64_t localTimeUs);
+static uint64_t DjiTest_PpsCaptureToLocalTimeUs(clockid_t clockId, int64_t edgeNs);
+static int64_t DjiTest_PpsCaptureGetClockNs(clockid_t clockId);
+
+/* Private variables ---------------------------------------------------------*/
+static T_DjiTestPpsCaptureContext s_ppsCapture = {.deviceFd = -1, .eventFd = -1};
+
+/* Exported functions definition ---------------------------------------------*/
+void DjiTest_PpsCaptureGetDefaultConfig(T_DjiTestPpsCaptureConfig *config)
+{
+    memset(config, 0, sizeof(T_DjiTestPpsCaptureConfig));
+    config->source = DJI_TEST_PPS_CAPTURE_SOURCE_KERNEL_PPS;
+    config->devicePath = NULL;
+    config->gpioLine = 0;
+    config->isFallingEdge = false;
+    config->simulatedDriftPpm = 20.0f;
+    config->simulatedJitterUs = 10.0f;
+    config->simulatedOutlierPeriod = 0;
+}
+
+/**
+ * @brief Select the PPS source used by DjiTest_PpsCaptureSignalResponseInit, the default one is "/dev/pps0".
+ * @param config: pointer to the configuration, the device path is copied.
+ * @return Execution result.
+ */
+T_DjiReturnCode DjiTest_PpsCaptureSetConfig(const T_DjiTestPpsCaptureConfig *config)
+{
+    const char *devicePath;
+
+    if (config == NULL || config->source > DJI_TEST_PPS_CAPTURE_SOURCE_SIMULATED) {
+        return DJI_ERROR_SYSTEM_MODULE_CODE_INVALID_PARAMETER;
+    }
+
+    if (s_ppsCapture.task != NULL) {
+        USER_LOG_ERROR("pps capture is running, stop it before changing the configuration.");
+        return DJI_ERROR_SYSTEM_MODULE_CODE_BUSY;
+    }
+
+    devicePath = config->devicePath;
+    if (devicePath == NULL) {
+        devicePath = config->source == DJI_TEST_PPS_CAPTURE_SOURCE_GPIO ? DJI_TEST_PPS_CAPTURE_DEFAULT_GPIO_DEVICE :
+                     DJI_TEST_PPS_CAPTURE_DEFAULT_PPS_DEVICE;
+    }
+    if (strlen(devicePath) >= sizeof(s_ppsCapture.devicePath)) {
+        return DJI_ERROR_SYSTEM_MODULE_CODE_INVALID_PARAMETER;
+    }
+
+    s_ppsCapture.config = *config;
+    strcpy(s_ppsCapture.devicePath, devicePath);
+    s_ppsCapture.config.devicePath = s_ppsCapture.devicePath;
+    s_ppsCapture.isConfigured = true;
+
+    return DJI_ERROR_SYSTEM_MODULE_CODE_SUCCESS;
+}
+
+T_DjiReturnCode DjiTest_PpsCaptureSignalResponseInit(void)
+{
+    T_DjiOsalHandler *osalHandler = DjiPlatform_GetOsalHandler();
+    T_DjiTestPpsCaptureConfig defaultConfig;
+    T_DjiReturnCode returnCode;
+
+    if (s_ppsCapture.task != NULL) {
+        return DJI_ERROR_SYSTEM_MODULE_CODE_BUSY;
+    }
+
+    if (!s_ppsCapture.isConfigured) {
+        DjiTest_PpsCaptureGetDefaultConfig(&defaultConfig);
+        returnCode = DjiTest_PpsCaptureSetConfig(&defaultConfig);
+        if (returnCode != DJI_ERROR_SYSTEM_MODULE_CODE_SUCCESS) {
+            return returnCode;
+        }
+    }
+
+    s_ppsCapture.hasEdge = false;
+    s_ppsCapture.hasKernelSequence = false;
+    memset(&s_ppsCapture.newestEdge, 0, sizeof(T_DjiTestPpsEdge));
+    memset(&s_ppsCapture.statistics, 0, sizeof(T_DjiTestPpsCaptureStatistics));
+
+    returnCode = osalHandler->MutexCreate(&s_ppsCapture.mutex);
+    if (returnCode != DJI_ERROR_SYSTEM_MODULE_CODE_SUCCESS) {
+        USER_LOG_ERROR("create pps capture mutex error: 0x%08llX.", returnCode);
+        return returnCode;
+    }
+
+    returnCode = osalHandler->SemaphoreCreate(0, &s_ppsCapture.exitSema);
+    if (returnCode != DJI_ERROR_SYSTEM_MODULE_CODE_SUCCESS) {
+        USER_LOG_ERROR("create pps capture semaphore error: 0x%08llX.", returnCode);
+        goto destroy_mutex;
+    }
+
+    returnCode = DjiTest_PpsCaptureOpenSource();
+    if (returnCode != DJI_ERROR_SYSTEM_MODULE_CODE_SUCCESS) {
+        goto destroy_sema;
+    }
+
+    s_ppsCapture.isRunning = true;
+    returnCode = osalHandler->TaskCreate("user_pps_capture", DjiTest_PpsCaptureTask,
+                                         DJI_TEST_PPS_CAPTURE_TASK_STACK_SIZE, NULL, &s_ppsCapture.task);
+    if (returnCode != DJI_ERROR_SYSTEM_MODULE_CODE_SUCCESS) {
+        USER_LOG_ERROR("create pps capture task error: 0x%08llX.", returnCode);
+        s_ppsCapture.isRunning = false;
+        s_ppsCapture.task = NULL;
+        goto close_source;
+    }
+
+    USER_LOG_INFO("pps capture started on %s.",
+                  s_ppsCapture.config.source == DJI_TEST_PPS_CAPTURE_SOURCE_SIMULATED ? "simulated source" :
+                  s_ppsCapture.devicePath);
+
+    return DJI_ERROR_SYSTEM_MODULE_CODE_SUCCESS;
+
+close_source:
+    DjiTest_PpsCaptureCloseSource();
+destroy_sema:
+    osalHandler->SemaphoreDestroy(s_ppsCapture.exitSema);
+destroy_mutex:
+    osalHandler->MutexDestroy(s_ppsCapture.mutex);
+
+    return returnCode;
+}
+
+T_DjiReturnCode DjiTest_PpsCaptureGetNewestPpsTriggerLocalTimeUs(uint64_t *localTimeUs)
+{
+    T_DjiTestPpsEdge edge;
+    T_DjiReturnCode returnCode;
+
+    if (localTimeUs == NULL) {
+        return DJI_ERROR_SYSTEM_MODULE_CODE_INVALID_PARAMETER;
+    }
+
+    returnCode = DjiTest_PpsCaptureGetNewestEdge(&edge);
+    if (returnCode != DJI_ERROR_SYSTEM_MODULE_CODE_SUCCESS) {
+        return returnCode;
+    }
+
+    *localTimeUs = edge.localTimeUs;
+
+    return DJI_ERROR_SYSTEM_MODULE_CODE_SUCCESS;
+}
+
+T_DjiReturnCode DjiTest_PpsCaptureDeInit(void)
+{
+    T_DjiOsalHandler *osalHandler = DjiPlatform_GetOsalHandler();
+    T_DjiReturnCode returnCode;
+
+    if (s_ppsCapture.task == NULL) {
+        return DJI_ERROR_SYSTEM_MODULE_CODE_SUCCESS;
+    }
+
+    osalHandler->MutexLock(s_ppsCapture.mutex);
+    s_ppsCapture.isRunning = false;
+    osalHandler->MutexUnlock(s_ppsCapture.mutex);
+
+    /* Every wait of the task ends within DJI_TEST_PPS_CAPTURE_WAIT_TIMEOUT_MS, the exit is normally prompt. */
+    returnCode = osalHandler->SemaphoreTimedWait(s_ppsCapture.exitSema, DJI_TEST_PPS_CAPTURE_EXIT_TIMEOUT_MS);
+    if (returnCode != DJI_ERROR_SYSTEM_MODULE_CODE_SUCCESS) {
+        USER_LOG_WARN("pps capture task did not exit in time, cancel it.");
+    }
+    osalHandler->TaskDestroy(s_ppsCapture.task);
+    s_ppsCapture.task = NULL;
+
+    DjiTest_PpsCaptureCloseSource();
+    osalHandler->SemaphoreDestroy(s_ppsCapture.exitSema);
+    osalHandler->MutexDestroy(s_ppsCapture.mutex);
+
+    return DJI_ERROR_SYSTEM_MODULE_CODE_SUCCESS;
+}
+
+T_DjiReturnCode DjiTest_PpsCaptureGetNewestEdge(T_DjiTestPpsEdge *edge)
+{
+    T_DjiOsalHandler *osalHandler = DjiPlatform_GetOsalHandler();
+    T_DjiReturnCode returnCode = DJI_ERROR_SYSTEM_MODULE_CODE_SUCCESS;
+
+    if (edge == NULL) {
+        return DJI_ERROR_SYSTEM_MODULE_CODE_INVALID_PARAMETER;
+    }
+
+    if (s_ppsCapture.task == NULL) {
+        return DJI_ERROR_SYSTEM_MODULE_CODE_NONSUPPORT_IN_CURRENT_STATE;
+    }
+
+    /* Polled by the payload sdk as well, so a missing edge is reported without logging. */
+    osalHandler->MutexLock(s_ppsCapture.mutex);
+    if (s_ppsCapture.hasEdge) {
+        *edge = s_ppsCapture.newestEdge;
+    } else {
+        returnCode = DJI_ERROR_SYSTEM_MODULE_CODE_BUSY;
+    }
+    osalHandler->MutexUnlock(s_ppsCapture.mutex);
+
+    return returnCode;
+}
+
+void DjiTest_PpsCaptureGetStatistics(T_DjiTestPpsCaptureStatistics *statistics)
+{
+    T_DjiOsalHandler *osalHandler = DjiPlatform_GetOsalHandler();
+
+    if (s_ppsCapture.task == NULL) {
+        *statistics = s_ppsCapture.statistics;
+        return;
+    }
+
+    osalHandler->MutexLock(s_ppsCapture.mutex);
+    *statistics = s_ppsCapture.statistics;
+    osalHandler->MutexUnlock(s_ppsCapture.mutex);
+}
+
+/* Private functions definition-----------------------------------------------*/
+static void *DjiTest_PpsCaptureTask(void *arg)
+{
+    T_DjiOsalHandler *osalHandler = DjiPlatform_GetOsalHandler();
+    T_DjiReturnCode returnCode;
+    int64_t edgeNs = 0;
+    clockid_t clockId = CLOCK_MONOTONIC;
+
+    USER_UTIL_UNUSED(arg);
+
+    while (DjiTest_PpsCaptureIsRunning()) {
+        switch (s_ppsCapture.config.source) {
+            case DJI_TEST_PPS_CAPTURE_SOURCE_KERNEL_PPS:
+                returnCode = DjiTest_PpsCaptureWaitKernelPps(&edgeNs, &clockId);
+                break;
+            case DJI_TEST_PPS_CAPTURE_SOURCE_GPIO:
+                returnCode = DjiTest_PpsCaptureWaitGpio(&edgeNs, &clockId);
+                break;
+            default:
+                returnCode = DjiTest_PpsCaptureWaitSimulated(&edgeNs, &clockId);
+                break;
+        }
+
+        if (returnCode == DJI_ERROR_SYSTEM_MODULE_CODE_TIMEOUT) {
+            osalHandler->MutexLock(s_ppsCapture.mutex);
+            s_ppsCapture.statistics.timeoutCount++;
+            osalHandler->MutexUnlock(s_ppsCapture.mutex);
+            continue;
+        } else if (returnCode != DJI_ERROR_SYSTEM_MODULE_CODE_SUCCESS) {
+            osalHandler->MutexLock(s_ppsCapture.mutex);
+            s_ppsCapture.statistics.errorCount++;
+            osalHandler->MutexUnlock(s_ppsCapture.mutex);
+            osalHandler->TaskSleepMs(DJI_TEST_PPS_CAPTURE_ERROR_RETRY_MS);
+            continue;
+        }
+
+        DjiTest_PpsCapturePublishEdge(DjiTest_PpsCaptureToLocalTimeUs(clockId, edgeNs));
+    }
+
+    osalHandler->SemaphorePost(s_ppsCapture.exitSema);
+
+    return NULL;
+}
+
+static bool DjiTest_PpsCaptureIsRunning(void)
+{
+    T_DjiOsalHandler *osalHandler = DjiPlatform_GetOsalHandler();
+    bool isRunning;
+
+    osalHandler->MutexLock(s_ppsCapture.mutex);
+    isRunning = s_ppsCapture.isRunning;
+    osalHandler->MutexUnlock(s_ppsCapture.mutex);
+
+    return isRunning;
+}
+
+static T_DjiReturnCode DjiTest_PpsCaptureOpenSource(void)
+{
+    const T_DjiTestPpsCaptureConfig *config = &s_ppsCapture.config;
+    struct pps_kparams params;
+    struct gpioevent_request request;
+    int captureMode;
+    int capabilities = 0;
+
+    if (config->source == DJI_TEST_PPS_CAPTURE_SOURCE_SIMULATED) {
+        s_ppsCapture.simulatedBaseNs = DjiTest_PpsCaptureGetClockNs(CLOCK_MONOTONIC);
+        s_ppsCapture.simulatedIndex = 0;
+        s_ppsCapture.simulatedSeed = (unsigned int) s_ppsCapture.simulatedBaseNs;
+        return DJI_ERROR_SYSTEM_MODULE_CODE_SUCCESS;
+    }
+
+    s_ppsCapture.deviceFd = open(s_ppsCapture.devicePath, config->source == DJI_TEST_PPS_CAPTURE_SOURCE_GPIO ?
+                                                          O_RDONLY : O_RDWR);
+    if (s_ppsCapture.deviceFd < 0) {
+        USER_LOG_ERROR("open pps device %s error: %s.", s_ppsCapture.devicePath, strerror(errno));
+        return DJI_ERROR_SYSTEM_MODULE_CODE_NOT_FOUND;
+    }
+
+    if (config->source == DJI_TEST_PPS_CAPTURE_SOURCE_GPIO) {
+        /* The v1 line event interface exists since kernel 4.8, older than the v2 one, so it covers every Manifold. */
+        memset(&request, 0, sizeof(request));
+        request.lineoffset = config->gpioLine;
+        request.handleflags = GPIOHANDLE_REQUEST_INPUT;
+        request.eventflags = config->isFallingEdge ? GPIOEVENT_REQUEST_FALLING_EDGE : GPIOEVENT_REQUEST_RISING_EDGE;
+        strncpy(request.consumer_label, DJI_TEST_PPS_CAPTURE_GPIO_CONSUMER, sizeof(request.consumer_label) - 1);
+        if (ioctl(s_ppsCapture.deviceFd, GPIO_GET_LINEEVENT_IOCTL, &request) < 0) {
+            USER_LOG_ERROR("request edge events of line %d on %s error: %s.", config->gpioLine,
+                           s_ppsCapture.devicePath, strerror(errno));
+            goto close_device;
+        }
+        s_ppsCapture.eventFd = request.fd;
+        return DJI_ERROR_SYSTEM_MODULE_CODE_SUCCESS;
+    }
+
+    captureMode = config->isFallingEdge ? PPS_CAPTURECLEAR : PPS_CAPTUREASSERT;
+    if (ioctl(s_ppsCapture.deviceFd, PPS_GETCAP, &capabilities) < 0 || (capabilities & captureMode) == 0) {
+        USER_LOG_ERROR("pps device %s can not capture the %s edge.", s_ppsCapture.devicePath,
+                       config->isFallingEdge ? "clear" : "assert");
+        goto close_device;
+    }
+
+    if (ioctl(s_ppsCapture.deviceFd, PPS_GETPARAMS, &params) < 0) {
+        USER_LOG_ERROR("get pps parameters of %s error: %s.", s_ppsCapture.devicePath, strerror(errno));
+        goto close_device;
+    }
+
+    /* Changing the mode needs CAP_SYS_TIME, without it the edge must already be captured by the default mode. */
+    if ((params.mode & captureMode) == 0 || (params.mode & PPS_TSFMT_TSPEC) == 0) {
+        params.mode |= captureMode | PPS_TSFMT_TSPEC;
+        if (ioctl(s_ppsCapture.deviceFd, PPS_SETPARAMS, &params) < 0) {
+            USER_LOG_ERROR("set pps capture mode of %s error: %s.", s_ppsCapture.devicePath, strerror(errno));
+            goto close_device;
+        }
+    }
+
+    return DJI_ERROR_SYSTEM_MODULE_CODE_SUCCESS;
+
+close_device:
+    close(s_ppsCapture.deviceFd);
+    s_ppsCapture.deviceFd = -1;
+
+    return DJI_ERROR_SYSTEM_MODULE_CODE_SYSTEM_ERROR;
+}
+
+static void DjiTest_PpsCaptureCloseSource(void)
+{
+    if (s_ppsCapture.eventFd >= 0) {
+        close(s_ppsCapture.eventFd);
+        s_ppsCapture.eventFd = -1;
+    }
+
+    if (s_ppsCapture.deviceFd >= 0) {
+        close(s_ppsCapture.deviceFd);
+        s_ppsCapture.deviceFd = -1;
+    }
+}
+
+static T_DjiReturnCode DjiTest_PpsCaptureWaitKernelPps(int64_t *edgeNs, clockid_t *clockId)
+{
+    struct pps_fdata fetchData;
+    struct pps_ktime *edgeTime;
+    uint32_t sequence;
+
+    memset(&fetchData, 0, sizeof(fetchData));
+    fetchData.timeout.sec = DJI_TEST_PPS_CAPTURE_WAIT_TIMEOUT_MS / 1000;
+    fetchData.timeout.nsec = (DJI_TEST_PPS_CAPTURE_WAIT_TIMEOUT_MS % 1000) * 1000000;
+
+    if (ioctl(s_ppsCapture.deviceFd, PPS_FETCH, &fetchData) < 0) {
+        if (errno == ETIMEDOUT || errno == EINTR) {
+            return DJI_ERROR_SYSTEM_MODULE_CODE_TIMEOUT;
+        }
+        USER_LOG_ERROR("fetch pps event error: %s.", strerror(errno));
+        return DJI_ERROR_SYSTEM_MODULE_CODE_SYSTEM_ERROR;
+    }
+
+    if (s_ppsCapture.config.isFallingEdge) {
+        sequence = fetchData.info.clear_sequence;
+        edgeTime = &fetchData.info.clear_tu;
+    } else {
+        sequence = fetchData.info.assert_sequence;
+        edgeTime = &fetchData.info.assert_tu;
+    }
+
+    /* Depending on the kernel version a fetch may also return the event already seen instead of waiting. */
+    if (sequence == 0 || (s_ppsCapture.hasKernelSequence && sequence == s_ppsCapture.kernelSequence)) {
+        return DJI_ERROR_SYSTEM_MODULE_CODE_TIMEOUT;
+    }
+    s_ppsCapture.kernelSequence = sequence;
+    s_ppsCapture.hasKernelSequence = true;
+
+    /* The pps core timestamps with the realtime clock in the interrupt handler. */
+    *edgeNs = (int64_t) edgeTime->sec * 1000000000LL + edgeTime->nsec;
+    *clockId = CLOCK_REALTIME;
+
+    return DJI_ERROR_SYSTEM_MODULE_CODE_SUCCESS;
+}
+
+static T_DjiReturnCode DjiTest_PpsCaptureWaitGpio(int64_t *edgeNs, clockid_t *clockId)
+{
+    struct pollfd pollFd = {.fd = s_ppsCapture.eventFd, .events = POLLIN};
+    struct gpioevent_data event;
+    int64_t realtimeNs, monotonicNs;
+    int result;
+
+    result = poll(&pollFd, 1, DJI_TEST_PPS_CAPTURE_WAIT_TIMEOUT_MS);
+    if (result == 0 || (result < 0 && errno == EINTR)) {
+        return DJI_ERROR_SYSTEM_MODULE_CODE_TIMEOUT;
+    } else if (result < 0) {
+        USER_LOG_ERROR("poll gpio event error: %s.", strerror(errno));
+        return DJI_ERROR_SYSTEM_MODULE_CODE_SYSTEM_ERROR;
+    }
+
+    if (read(s_ppsCapture.eventFd, &event, sizeof(event)) != sizeof(event)) {
+        USER_LOG_ERROR("read gpio event error: %s.", strerror(errno));
+        return DJI_ERROR_SYSTEM_MODULE_CODE_SYSTEM_ERROR;
+    }
+
+    /* Kernels before 5.7 stamp line events with the realtime clock, later ones with the monotonic clock. The edge is
+     * at most a poll timeout old, so the clock closer to the stamp is the one that produced it. */
+    realtimeNs = DjiTest_PpsCaptureGetClockNs(CLOCK_REALTIME);
+    monotonicNs = DjiTest_PpsCaptureGetClockNs(CLOCK_MONOTONIC);
+    *edgeNs = (int64_t) event.timestamp;
+    *clockId = llabs(realtimeNs - *edgeNs) < llabs(monotonicNs - *edgeNs) ? CLOCK_REALTIME : CLOCK_MONOTONIC;
+
+    return DJI_ERROR_SYSTEM_MODULE_CODE_SUCCESS;
+}
+
+static T_DjiReturnCode DjiTest_PpsCaptureWaitSimulated(int64_t *edgeNs, clockid_t *clockId)
+{
+    const T_DjiTestPpsCaptureConfig *config = &s_ppsCapture.config;
+    double periodNs = 1e9 * (1.0 + config->simulatedDriftPpm * 1e-6);
+    double jitterNs = config->simulatedJitterUs * 1e3 *
+                      (2.0 * rand_r(&s_ppsCapture.simulatedSeed) / RAND_MAX - 1.0);
+    struct timespec wakeTime;
+    int64_t targetNs;
+
+    s_ppsCapture.simulatedIndex++;
+    targetNs = s_ppsCapture.simulatedBaseNs + (int64_t) (periodNs * (double) s_ppsCapture.simulatedIndex + jitterNs);
+    if (config->simulatedOutlierPeriod != 0 && s_ppsCapture.simulatedIndex % config->simulatedOutlierPeriod == 0) {
+        targetNs += DJI_TEST_PPS_CAPTURE_SIMULATED_OUTLIER_NS;
+    }
+
+    /* Sleep until the edge and report its exact time, like a source timestamped in the interrupt handler. */
+    wakeTime.tv_sec = (time_t) (targetNs / 1000000000LL);
+    wakeTime.tv_nsec = (long) (targetNs % 1000000000LL);
+    while (clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &wakeTime, NULL) == EINTR) {
+    }
+
+    *edgeNs = targetNs;
+    *clockId = CLOCK_MONOTONIC;
+
+    return DJI_ERROR_SYSTEM_MODULE_CODE_SUCCESS;
+}
+
+static void DjiTest_PpsCapturePublishEdge(uint64_t localTimeUs)
+{
+    T_DjiOsalHandler *osalHandler = DjiPlatform_GetOsalHandler();
+    T_DjiTestPpsCaptureStatistics *statistics = &s_ppsCapture.statistics;
+    uint64_t intervalUs;
+    uint32_t seconds;
+
+    osalHandler->MutexLock(s_ppsCapture.mutex);
+
+    if (s_ppsCapture.hasEdge) {
+        if (localTimeUs <= s_ppsCapture.newestEdge.localTimeUs) {
+            osalHandler->MutexUnlock(s_ppsCapture.mutex);
+            return;
+        }
+
+        intervalUs = localTimeUs - s_ppsCapture.newestEdge.localTimeUs;
+        seconds = (uint32_t) ((intervalUs + DJI_TEST_PPS_CAPTURE_PERIOD_US / 2) / DJI_TEST_PPS_CAPTURE_PERIOD_US);
+        if (seconds == 0) {
+            seconds = 1;
+        }
+
+        if (seconds == 1) {
+            if (statistics->intervalMinUs == 0 || intervalUs < statistics->intervalMinUs) {
+                statistics->intervalMinUs = (uint32_t) intervalUs;
+            }
+            if (intervalUs > statistics->intervalMaxUs) {
+                statistics->intervalMaxUs = (uint32_t) intervalUs;
+            }
+        } else {
+            statistics->missedEdgeCount += seconds - 1;
+        }
+        s_ppsCapture.newestEdge.sequence += seconds;
+    } else {
+        s_ppsCapture.newestEdge.sequence = 0;
+    }
+
+    s_ppsCapture.newestEdge.localTimeUs = localTimeUs;
+    s_ppsCapture.hasEdge = true;
+    statistics->edgeCount++;
+
+    osalHandler->MutexUnlock(s_ppsCapture.mutex);
+}
+
+/**
+ * @brief Move a kernel timestamp onto the local OSAL time base.
+ * @note The clock and the OSAL time are read back to back, the age of the edge on its own clock is then subtracted
+ * from the OSAL time. The error is the read latency of the clocks, far below the interrupt latency of the edge.
+ */
+static uint64_t DjiTest_PpsCaptureToLocalTimeUs(clockid_t clockId, int64_t edgeNs)
+{
+    T_DjiOsalHandler *osalHandler = DjiPlatform_GetOsalHandler();
+    int64_t beforeNs, afterNs;
+    uint64_t localNowUs = 0;
+    uint64_t ageUs;
+
+    beforeNs = DjiTest_PpsCaptureGetClockNs(clockId);
+    osalHandler->GetTimeUs(&localNowUs);
+    afterNs = DjiTest_PpsCaptureGetClockNs(clockId);
+
+    ageUs = 0;
+    if (beforeNs / 2 + afterNs / 2 > edgeNs) {
+        ageUs = (uint64_t) (beforeNs / 2 + afterNs / 2 - edgeNs) / 1000;
+    }
+
+    return ageUs < localNowUs ? localNowUs - ageUs : 0;
+}
+
+static int64_t DjiTest_PpsCaptureGetClockNs(clockid_t clockId)
+{
+    struct timespec now;
+
+    clock_gettime(clockId, &now);
+
+    return (int64_t) now.tv_sec * 1000000000LL + now.tv_nsec;
+}
+
+#endif
+
+/****************** (C) COPYRIGHT DJI Innovations *****END OF FILE****/
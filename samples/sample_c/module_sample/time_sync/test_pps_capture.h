@@ -0,0 +1,92 @@
+/**
+ ********************************************************************
+ * @file    test_pps_capture.h
+ * @brief   This is the header file for "test_pps_capture.c", defining the structure and
+ * (exported) function prototypes.
+ *
+ * @copyright (c) 2021 DJI. All rights reserved.
+ *
+ * All information contained herein is, and remains, the property of DJI.
+ * The intellectual and technical concepts contained herein are proprietary
+ * to DJI and may be covered by U.S. and foreign patents, patents in process,
+ * and protected by trade secret or copyright law.  Dissemination of this
+ * information, including but not limited to data and other proprietary
+ * material(s) incorporated within the information, in any form, is strictly
+ * prohibited without the express written consent of DJI.
+ *
+ * If you receive this source code without DJI’s authorization, you may not
+ * further disseminate the information, and you must immediately remove the
+ * source code and notify DJI of its removal. DJI reserves the right to pursue
+ * legal actions against you for any loss(es) or damage(s) caused by your
+ * failure to do so.
+ *
+ *********************************************************************
+ */
+
+/* Define to prevent recursive inclusion -------------------------------------*/
+#ifndef TEST_PPS_CAPTURE_H
+#define TEST_PPS_CAPTURE_H
+
+/* Includes ------------------------------------------------------------------*/
+#include "dji_typedef.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#ifdef SYSTEM_ARCH_LINUX
+
+/* Exported constants --------------------------------------------------------*/
+#define DJI_TEST_PPS_CAPTURE_DEVICE_PATH_MAX_SIZE   (64)
+
+/* Exported types ------------------------------------------------------------*/
+typedef enum {
+    DJI_TEST_PPS_CAPTURE_SOURCE_KERNEL_PPS = 0, /*!< RFC 2783 device "/dev/ppsX", timestamped in the interrupt handler. */
+    DJI_TEST_PPS_CAPTURE_SOURCE_GPIO,           /*!< Edge events of a line of "/dev/gpiochipX", timestamped by the kernel. */
+    DJI_TEST_PPS_CAPTURE_SOURCE_SIMULATED,      /*!< Edges generated from the monotonic clock, for tests without hardware. */
+} E_DjiTestPpsCaptureSource;
+
+typedef struct {
+    E_DjiTestPpsCaptureSource source;
+    const char *devicePath;         /*!< PPS device or GPIO chip, NULL selects "/dev/pps0" or "/dev/gpiochip0". */
+    uint32_t gpioLine;              /*!< Line offset on the GPIO chip. */
+    bool isFallingEdge;             /*!< The pulse starts with a falling edge, e.g. behind an inverting level shifter. */
+    float simulatedDriftPpm;        /*!< Rate error of the local clock seen by the simulated source. */
+    float simulatedJitterUs;        /*!< Amplitude of the uniform jitter of the simulated edges. */
+    uint32_t simulatedOutlierPeriod; /*!< One simulated edge in this many is 5 ms late, 0 disables the outliers. */
+} T_DjiTestPpsCaptureConfig;
+
+typedef struct {
+    uint64_t localTimeUs;           /*!< Local OSAL time of the edge. */
+    uint32_t sequence;              /*!< Counts PPS seconds, skips the seconds whose edge was missed. */
+} T_DjiTestPpsEdge;
+
+typedef struct {
+    uint32_t edgeCount;
+    uint32_t missedEdgeCount;       /*!< Estimated from the gaps between consecutive edges. */
+    uint32_t timeoutCount;
+    uint32_t errorCount;
+    uint32_t intervalMinUs;         /*!< Extremes of the intervals between consecutive edges, on the local clock. */
+    uint32_t intervalMaxUs;
+} T_DjiTestPpsCaptureStatistics;
+
+/* Exported functions --------------------------------------------------------*/
+void DjiTest_PpsCaptureGetDefaultConfig(T_DjiTestPpsCaptureConfig *config);
+T_DjiReturnCode DjiTest_PpsCaptureSetConfig(const T_DjiTestPpsCaptureConfig *config);
+
+/* Signatures of T_DjiTestTimeSyncHandler, the capture starts with the configuration set before. */
+T_DjiReturnCode DjiTest_PpsCaptureSignalResponseInit(void);
+T_DjiReturnCode DjiTest_PpsCaptureGetNewestPpsTriggerLocalTimeUs(uint64_t *localTimeUs);
+
+T_DjiReturnCode DjiTest_PpsCaptureDeInit(void);
+T_DjiReturnCode DjiTest_PpsCaptureGetNewestEdge(T_DjiTestPpsEdge *edge);
+void DjiTest_PpsCaptureGetStatistics(T_DjiTestPpsCaptureStatistics *statistics);
+
+#endif
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // TEST_PPS_CAPTURE_H
+/************************ (C) COPYRIGHT DJI Innovations *******END OF FILE******/
@@ -32,17 +32,21 @@
 #include "dji_platform.h"
 
 /* Private constants ---------------------------------------------------------*/
-#define DJI_TEST_TIME_SYNC_TASK_FREQ            (1)
+#define DJI_TEST_TIME_SYNC_TASK_FREQ            (10)
 #define DJI_TEST_TIME_SYNC_TASK_STACK_SIZE      (1024)
+#define DJI_TEST_TIME_SYNC_STATISTICS_LOG_EDGES (60)
 
 /* Private types -------------------------------------------------------------*/
 
 /* Private functions declaration ---------------------------------------------*/
 static void *DjiTest_TimeSyncTask(void *arg);
+static void DjiTest_TimeSyncProcessPpsEdge(uint64_t ppsLocalTimeUs);
 
 /* Private variables ---------------------------------------------------------*/
 static T_DjiTestTimeSyncHandler s_timeSyncHandler;
 static T_DjiTaskHandle s_timeSyncThread;
+static T_DjiTestTimeSyncModel s_timeSyncModel;
+static bool s_isTimeSyncModelLocked = false;
 
 /* Exported functions definition ---------------------------------------------*/
 /**
@@ -73,12 +77,21 @@ T_DjiReturnCode DjiTest_TimeSyncStartService(void)
     T_DjiReturnCode djiStat;
     T_DjiOsalHandler *osalHandler = DjiPlatform_GetOsalHandler();
 
+    T_DjiTestTimeSyncModelConfig modelConfig;
+
     djiStat = DjiTimeSync_Init();
     if (djiStat != DJI_ERROR_SYSTEM_MODULE_CODE_SUCCESS) {
         USER_LOG_ERROR("time synchronization module init error.");
         return djiStat;
     }
 
+    DjiTest_TimeSyncModelGetDefaultConfig(&modelConfig);
+    djiStat = DjiTest_TimeSyncModelInit(&s_timeSyncModel, &modelConfig);
+    if (djiStat != DJI_ERROR_SYSTEM_MODULE_CODE_SUCCESS) {
+        USER_LOG_ERROR("time synchronization model init error.");
+        return djiStat;
+    }
+
     if (s_timeSyncHandler.PpsSignalResponseInit == NULL) {
         USER_LOG_ERROR("time sync handler PpsSignalResponseInit interface is NULL error");
         return DJI_ERROR_SYSTEM_MODULE_CODE_UNKNOWN;
@@ -122,6 +135,73 @@ T_DjiReturnCode DjiTest_TimeSyncGetNewestPpsTriggerLocalTimeUs(uint64_t *localTi
     return s_timeSyncHandler.GetNewestPpsTriggerLocalTimeUs(localTimeUs);
 }
 
+/**
+ * @brief Convert a local time to the aircraft time.
+ * @note Once the clock model is locked to the PPS edges the conversion is done locally in constant time, before that
+ * the request is forwarded to DjiTimeSync_TransferToAircraftTime.
+ * @param localTimeUs: local OSAL time.
+ * @param aircraftTime: pointer to the aircraft time.
+ * @return Execution result.
+ */
+T_DjiReturnCode DjiTest_TimeSyncTransferToAircraftTime(uint64_t localTimeUs, T_DjiTimeSyncAircraftTime *aircraftTime)
+{
+    T_DjiReturnCode djiStat;
+    uint64_t aircraftTimeUs = 0;
+
+    if (aircraftTime == NULL) {
+        return DJI_ERROR_SYSTEM_MODULE_CODE_INVALID_PARAMETER;
+    }
+
+    if (s_timeSyncModel.mutex == NULL) {
+        return DjiTimeSync_TransferToAircraftTime(localTimeUs, aircraftTime);
+    }
+
+    djiStat = DjiTest_TimeSyncModelLocalToAircraft(&s_timeSyncModel, localTimeUs, &aircraftTimeUs);
+    if (djiStat != DJI_ERROR_SYSTEM_MODULE_CODE_SUCCESS) {
+        return DjiTimeSync_TransferToAircraftTime(localTimeUs, aircraftTime);
+    }
+
+    DjiTest_TimeSyncUsToAircraftTime(aircraftTimeUs, aircraftTime);
+
+    return DJI_ERROR_SYSTEM_MODULE_CODE_SUCCESS;
+}
+
+/**
+ * @brief Convert an aircraft time to the local time, e.g. to find the local samples of an event the aircraft reported.
+ * @param aircraftTime: pointer to the aircraft time.
+ * @param localTimeUs: pointer to the local OSAL time.
+ * @return Execution result, fails until the clock model is locked.
+ */
+T_DjiReturnCode DjiTest_TimeSyncTransferToLocalTimeUs(const T_DjiTimeSyncAircraftTime *aircraftTime,
+                                                      uint64_t *localTimeUs)
+{
+    if (aircraftTime == NULL || localTimeUs == NULL) {
+        return DJI_ERROR_SYSTEM_MODULE_CODE_INVALID_PARAMETER;
+    }
+
+    if (s_timeSyncModel.mutex == NULL) {
+        return DJI_ERROR_SYSTEM_MODULE_CODE_NONSUPPORT_IN_CURRENT_STATE;
+    }
+
+    return DjiTest_TimeSyncModelAircraftToLocal(&s_timeSyncModel, DjiTest_TimeSyncAircraftTimeToUs(aircraftTime),
+                                                localTimeUs);
+}
+
+T_DjiReturnCode DjiTest_TimeSyncGetStatistics(T_DjiTestTimeSyncModelStatistics *statistics)
+{
+    if (statistics == NULL) {
+        return DJI_ERROR_SYSTEM_MODULE_CODE_INVALID_PARAMETER;
+    }
+
+    if (s_timeSyncModel.mutex == NULL) {
+        return DJI_ERROR_SYSTEM_MODULE_CODE_NONSUPPORT_IN_CURRENT_STATE;
+    }
+
+    DjiTest_TimeSyncModelGetStatistics(&s_timeSyncModel, statistics);
+
+    return DJI_ERROR_SYSTEM_MODULE_CODE_SUCCESS;
+}
+
 /* Private functions definition-----------------------------------------------*/
 #ifndef __CC_ARM
 #pragma GCC diagnostic push
@@ -132,7 +212,10 @@ T_DjiReturnCode DjiTest_TimeSyncGetNewestPpsTriggerLocalTimeUs(uint64_t *localTi
 static void *DjiTest_TimeSyncTask(void *arg)
 {
     T_DjiReturnCode djiStat;
-    uint32_t currentTimeMs = 0;
+    uint64_t currentTimeUs = 0;
+    uint64_t ppsLocalTimeUs = 0;
+    uint64_t lastPpsLocalTimeUs = 0;
+    uint32_t step = 0;
     T_DjiTimeSyncAircraftTime aircraftTime = {0};
     T_DjiOsalHandler *osalHandler = DjiPlatform_GetOsalHandler();
     uint8_t totalSatelliteNumber = 0;
@@ -142,19 +225,30 @@ static void *DjiTest_TimeSyncTask(void *arg)
     while (1) {
         osalHandler->TaskSleepMs(1000 / DJI_TEST_TIME_SYNC_TASK_FREQ);
 
+        /* Edges are stamped where they are captured, polling only delays the model update, not its accuracy. */
+        djiStat = DjiTest_TimeSyncGetNewestPpsTriggerLocalTimeUs(&ppsLocalTimeUs);
+        if (djiStat == DJI_ERROR_SYSTEM_MODULE_CODE_SUCCESS && ppsLocalTimeUs != lastPpsLocalTimeUs) {
+            lastPpsLocalTimeUs = ppsLocalTimeUs;
+            DjiTest_TimeSyncProcessPpsEdge(ppsLocalTimeUs);
+        }
+
+        if (++step % DJI_TEST_TIME_SYNC_TASK_FREQ != 0) {
+            continue;
+        }
+
         djiStat = DjiTest_FcSubscriptionGetTotalSatelliteNumber(&totalSatelliteNumber);
         if (djiStat != DJI_ERROR_SYSTEM_MODULE_CODE_SUCCESS) {
             USER_LOG_ERROR("get total satellite number error: 0x%08llX.", djiStat);
             continue;
         }
 
-        djiStat = osalHandler->GetTimeMs(&currentTimeMs);
+        djiStat = osalHandler->GetTimeUs(&currentTimeUs);
         if (djiStat != DJI_ERROR_SYSTEM_MODULE_CODE_SUCCESS) {
             USER_LOG_ERROR("get current time error: 0x%08llX.", djiStat);
             continue;
         }
 
-        djiStat = DjiTimeSync_TransferToAircraftTime(currentTimeMs * 1000, &aircraftTime);
+        djiStat = DjiTest_TimeSyncTransferToAircraftTime(currentTimeUs, &aircraftTime);
         if (djiStat != DJI_ERROR_SYSTEM_MODULE_CODE_SUCCESS) {
             USER_LOG_ERROR("transfer to aircraft time error: 0x%08llX.", djiStat);
             continue;
@@ -177,4 +271,49 @@ static void *DjiTest_TimeSyncTask(void *arg)
 #pragma GCC diagnostic pop
 #endif
 
+static void DjiTest_TimeSyncProcessPpsEdge(uint64_t ppsLocalTimeUs)
+{
+    T_DjiReturnCode djiStat;
+    T_DjiTimeSyncAircraftTime aircraftTime = {0};
+    T_DjiTestTimeSyncModelStatistics statistics;
+    uint64_t aircraftTimeUs;
+    bool isAccepted = false;
+
+    djiStat = DjiTimeSync_TransferToAircraftTime(ppsLocalTimeUs, &aircraftTime);
+    if (djiStat != DJI_ERROR_SYSTEM_MODULE_CODE_SUCCESS) {
+        USER_LOG_DEBUG("transfer pps edge to aircraft time error: 0x%08llX.", djiStat);
+        return;
+    }
+
+    /* The pulse marks the start of an aircraft second, rounding drops the error of the transfer above. */
+    aircraftTimeUs = DjiTest_TimeSyncAircraftTimeToUs(&aircraftTime) + DJI_TEST_TIME_SYNC_MODEL_US_PER_SECOND / 2;
+    aircraftTimeUs -= aircraftTimeUs % DJI_TEST_TIME_SYNC_MODEL_US_PER_SECOND;
+
+    djiStat = DjiTest_TimeSyncModelUpdate(&s_timeSyncModel, ppsLocalTimeUs, aircraftTimeUs, &isAccepted);
+    if (djiStat != DJI_ERROR_SYSTEM_MODULE_CODE_SUCCESS) {
+        USER_LOG_WARN("pps edge at local time %llu us is out of order.", ppsLocalTimeUs);
+        return;
+    }
+
+    DjiTest_TimeSyncModelGetStatistics(&s_timeSyncModel, &statistics);
+    if (!isAccepted) {
+        USER_LOG_WARN("reject pps edge at local time %llu us, residual %.1f us.", ppsLocalTimeUs,
+                      statistics.lastResidualUs);
+    }
+
+    if (statistics.isLocked != s_isTimeSyncModelLocked) {
+        s_isTimeSyncModelLocked = statistics.isLocked;
+        USER_LOG_INFO("time sync model %s, offset %.1f us, drift %.3f ppm.",
+                      statistics.isLocked ? "locked" : "lost lock", statistics.offsetUs, statistics.driftPpm);
+    }
+
+    if (statistics.sampleCount % DJI_TEST_TIME_SYNC_STATISTICS_LOG_EDGES == 0) {
+        USER_LOG_INFO("time sync: %d edges, %d rejected, %d resets, drift %.3f +- %.3f ppm, residual mean %.2f us "
+                      "std %.2f us max %.2f us recent rms %.2f us.", statistics.sampleCount,
+                      statistics.rejectedCount, statistics.resetCount, statistics.driftPpm, statistics.driftStdPpm,
+                      statistics.residualMeanUs, statistics.residualStdUs, statistics.residualMaxAbsUs,
+                      statistics.recentResidualRmsUs);
+    }
+}
+
 /****************** (C) COPYRIGHT DJI Innovations *****END OF FILE****/
@@ -29,6 +29,8 @@
 
 /* Includes ------------------------------------------------------------------*/
 #include "dji_typedef.h"
+#include "dji_time_sync.h"
+#include "test_time_sync_model.h"
 
 #ifdef __cplusplus
 extern "C" {
@@ -48,6 +50,11 @@ T_DjiReturnCode DjiTest_TimeSyncStartService(void);
 
 T_DjiReturnCode DjiTest_TimeSyncGetNewestPpsTriggerLocalTimeUs(uint64_t *localTimeUs);
 T_DjiReturnCode DjiTest_TimeSyncRegHandler(T_DjiTestTimeSyncHandler *timeSyncHandler);
+
+T_DjiReturnCode DjiTest_TimeSyncTransferToAircraftTime(uint64_t localTimeUs, T_DjiTimeSyncAircraftTime *aircraftTime);
+T_DjiReturnCode DjiTest_TimeSyncTransferToLocalTimeUs(const T_DjiTimeSyncAircraftTime *aircraftTime,
+                                                      uint64_t *localTimeUs);
+T_DjiReturnCode DjiTest_TimeSyncGetStatistics(T_DjiTestTimeSyncModelStatistics *statistics);
 #ifdef __cplusplus
 }
 #endif
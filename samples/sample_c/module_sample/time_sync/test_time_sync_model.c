@@ -0,0 +1,370 @@
+/**
+ ********************************************************************
+ * @file    test_time_sync_model.c
+ * @brief   Filtered offset and drift model between the local clock and the aircraft clock.
+ *
+ * @copyright (c) 2021 DJI. All rights reserved.
+ *
+ * All information contained herein is, and remains, the property of DJI.
+ * The intellectual and technical concepts contained herein are proprietary
+ * to DJI and may be covered by U.S. and foreign patents, patents in process,
+ * and protected by trade secret or copyright law.  Dissemination of this
+ * information, including but not limited to data and other proprietary
+ * material(s) incorporated within the information, in any form, is strictly
+ * prohibited without the express written consent of DJI.
+ *
+ * If you receive this source code without DJI’s authorization, you may not
+ * further disseminate the information, and you must immediately remove the
+ * source code and notify DJI of its removal. DJI reserves the right to pursue
+ * legal actions against you for any loss(es) or damage(s) caused by your
+ * failure to do so.
+ *
+ *********************************************************************
+ */
+
+
+/* Includes ------------------------------------------------------------------*/
+#include "test_time_sync_model.h"
+#include <math.h>
+#include <string.h>
+
+/* Private constants ---------------------------------------------------------*/
+#define DJI_TEST_TIME_SYNC_MODEL_PPM                        (1e-6)
+#define DJI_TEST_TIME_SYNC_MODEL_RECENT_WEIGHT              (1.0 / 16.0)
+#define DJI_TEST_TIME_SYNC_MODEL_DAYS_PER_ERA               (146097)
+#define DJI_TEST_TIME_SYNC_MODEL_EPOCH_DAY_OFFSET           (719468)
+#define DJI_TEST_TIME_SYNC_MODEL_SECONDS_PER_DAY            (86400)
+
+/* Private types -------------------------------------------------------------*/
+
+/* Private functions declaration ---------------------------------------------*/
+static void DjiTest_TimeSyncModelRestart(T_DjiTestTimeSyncModel *model, uint64_t localTimeUs, int64_t offsetUs);
+static void DjiTest_TimeSyncModelPublish(T_DjiTestTimeSyncModel *model);
+static int64_t DjiTest_TimeSyncDaysFromCivil(int32_t year, uint32_t month, uint32_t day);
+
+/* Private variables ---------------------------------------------------------*/
+
+/* Exported functions definition ---------------------------------------------*/
+void DjiTest_TimeSyncModelGetDefaultConfig(T_DjiTestTimeSyncModelConfig *config)
+{
+    config->measurementNoiseUs = 20.0f;
+    config->phaseNoiseUs2PerS = 1.0f;
+    config->frequencyNoisePpm2PerS = 0.01f;
+    config->initialDriftPpm = 100.0f;
+    config->outlierGateSigma = 5.0f;
+    config->outlierGateMinUs = 200.0f;
+    config->maxConsecutiveOutliers = 5;
+    config->minSamplesForLock = 5;
+}
+
+T_DjiReturnCode DjiTest_TimeSyncModelInit(T_DjiTestTimeSyncModel *model, const T_DjiTestTimeSyncModelConfig *config)
+{
+    T_DjiOsalHandler *osalHandler = DjiPlatform_GetOsalHandler();
+    T_DjiReturnCode returnCode;
+
+    if (model == NULL || config == NULL || config->measurementNoiseUs <= 0 || config->outlierGateSigma <= 0 ||
+        config->maxConsecutiveOutliers == 0) {
+        return DJI_ERROR_SYSTEM_MODULE_CODE_INVALID_PARAMETER;
+    }
+
+    memset(model, 0, sizeof(T_DjiTestTimeSyncModel));
+    model->config = *config;
+
+    returnCode = osalHandler->MutexCreate(&model->mutex);
+    if (returnCode != DJI_ERROR_SYSTEM_MODULE_CODE_SUCCESS) {
+        return returnCode;
+    }
+
+    return DJI_ERROR_SYSTEM_MODULE_CODE_SUCCESS;
+}
+
+T_DjiReturnCode DjiTest_TimeSyncModelDeInit(T_DjiTestTimeSyncModel *model)
+{
+    T_DjiOsalHandler *osalHandler = DjiPlatform_GetOsalHandler();
+
+    if (model == NULL || model->mutex == NULL) {
+        return DJI_ERROR_SYSTEM_MODULE_CODE_INVALID_PARAMETER;
+    }
+
+    osalHandler->MutexDestroy(model->mutex);
+    model->mutex = NULL;
+
+    return DJI_ERROR_SYSTEM_MODULE_CODE_SUCCESS;
+}
+
+/**
+ * @brief Forget the clock state and the statistics, the next sample starts a new model.
+ * @param model: pointer to the model.
+ */
+void DjiTest_TimeSyncModelReset(T_DjiTestTimeSyncModel *model)
+{
+    T_DjiOsalHandler *osalHandler = DjiPlatform_GetOsalHandler();
+
+    osalHandler->MutexLock(model->mutex);
+    model->isInitialized = false;
+    model->consecutiveOutliers = 0;
+    model->residualSum = 0;
+    model->residualSquareSum = 0;
+    model->residualCount = 0;
+    memset(&model->statistics, 0, sizeof(T_DjiTestTimeSyncModelStatistics));
+    osalHandler->MutexUnlock(model->mutex);
+}
+
+/**
+ * @brief Feed one pair of simultaneous timestamps, usually the local time of a PPS edge and the whole aircraft second
+ * the edge marks.
+ * @note The pair is rejected when its innovation falls outside the gate. A run of maxConsecutiveOutliers rejected
+ * pairs means the clock itself stepped, the model then restarts from the newest pair.
+ * @param model: pointer to the model.
+ * @param localTimeUs: local OSAL time, must increase from sample to sample.
+ * @param aircraftTimeUs: aircraft time in microseconds since 1970, see DjiTest_TimeSyncAircraftTimeToUs.
+ * @param isAccepted: optional, reports whether the pair updated the model.
+ * @return Execution result.
+ */
+T_DjiReturnCode DjiTest_TimeSyncModelUpdate(T_DjiTestTimeSyncModel *model, uint64_t localTimeUs,
+                                            uint64_t aircraftTimeUs, bool *isAccepted)
+{
+    T_DjiOsalHandler *osalHandler = DjiPlatform_GetOsalHandler();
+    const T_DjiTestTimeSyncModelConfig *config = &model->config;
+    double measurementVar = (double) config->measurementNoiseUs * config->measurementNoiseUs;
+    double dt, dt2, predictedOffset, innovation, innovationVar, gate;
+    double p00, p01, p11, gain0, gain1;
+    int64_t rebase;
+    bool accepted = false;
+
+    osalHandler->MutexLock(model->mutex);
+
+    if (model->isInitialized && localTimeUs <= model->refLocalTimeUs) {
+        osalHandler->MutexUnlock(model->mutex);
+        return DJI_ERROR_SYSTEM_MODULE_CODE_INVALID_PARAMETER;
+    }
+
+    model->statistics.sampleCount++;
+
+    if (!model->isInitialized) {
+        DjiTest_TimeSyncModelRestart(model, localTimeUs, (int64_t) (aircraftTimeUs - localTimeUs));
+        model->statistics.acceptedCount++;
+        accepted = true;
+        goto out;
+    }
+
+    /* Predict with F = [1 dt; 0 1], the offset integrates the drift, and continuous white noise on both states. */
+    dt = (double) (localTimeUs - model->refLocalTimeUs) / DJI_TEST_TIME_SYNC_MODEL_US_PER_SECOND;
+    dt2 = dt * dt;
+    predictedOffset = model->state[0] + model->state[1] * dt;
+    p00 = model->covariance[0][0] + 2 * dt * model->covariance[0][1] + dt2 * model->covariance[1][1] +
+          config->phaseNoiseUs2PerS * dt + config->frequencyNoisePpm2PerS * dt2 * dt / 3;
+    p01 = model->covariance[0][1] + dt * model->covariance[1][1] + config->frequencyNoisePpm2PerS * dt2 / 2;
+    p11 = model->covariance[1][1] + config->frequencyNoisePpm2PerS * dt;
+
+    innovation = (double) ((int64_t) (aircraftTimeUs - localTimeUs) - model->offsetBaseUs) - predictedOffset;
+    innovationVar = p00 + measurementVar;
+    model->statistics.lastResidualUs = innovation;
+
+    gate = config->outlierGateSigma * sqrt(innovationVar);
+    if (gate < config->outlierGateMinUs) {
+        gate = config->outlierGateMinUs;
+    }
+
+    if (fabs(innovation) > gate) {
+        model->statistics.rejectedCount++;
+        model->consecutiveOutliers++;
+        if (model->consecutiveOutliers >= config->maxConsecutiveOutliers) {
+            model->statistics.resetCount++;
+            DjiTest_TimeSyncModelRestart(model, localTimeUs, (int64_t) (aircraftTimeUs - localTimeUs));
+        }
+        goto out;
+    }
+
+    gain0 = p00 / innovationVar;
+    gain1 = p01 / innovationVar;
+    model->state[0] = predictedOffset + gain0 * innovation;
+    model->state[1] += gain1 * innovation;
+    model->covariance[0][0] = (1 - gain0) * p00;
+    model->covariance[0][1] = (1 - gain0) * p01;
+    model->covariance[1][0] = model->covariance[0][1];
+    model->covariance[1][1] = p11 - gain1 * p01;
+    model->refLocalTimeUs = localTimeUs;
+    model->consecutiveOutliers = 0;
+
+    /* Move the whole microseconds into the base, the double then only carries the fraction and the recent change. */
+    rebase = (int64_t) floor(model->state[0]);
+    model->offsetBaseUs += rebase;
+    model->state[0] -= (double) rebase;
+
+    model->residualSum += innovation;
+    model->residualSquareSum += innovation * innovation;
+    model->residualCount++;
+    if (fabs(innovation) > model->statistics.residualMaxAbsUs) {
+        model->statistics.residualMaxAbsUs = fabs(innovation);
+    }
+    if (model->residualCount == 1) {
+        model->statistics.recentResidualRmsUs = fabs(innovation);
+    } else {
+        double recentSquare = model->statistics.recentResidualRmsUs * model->statistics.recentResidualRmsUs;
+
+        recentSquare += DJI_TEST_TIME_SYNC_MODEL_RECENT_WEIGHT * (innovation * innovation - recentSquare);
+        model->statistics.recentResidualRmsUs = sqrt(recentSquare);
+    }
+    model->statistics.acceptedCount++;
+    accepted = true;
+
+out:
+    DjiTest_TimeSyncModelPublish(model);
+    osalHandler->MutexUnlock(model->mutex);
+
+    if (isAccepted != NULL) {
+        *isAccepted = accepted;
+    }
+
+    return DJI_ERROR_SYSTEM_MODULE_CODE_SUCCESS;
+}
+
+T_DjiReturnCode DjiTest_TimeSyncModelLocalToAircraft(T_DjiTestTimeSyncModel *model, uint64_t localTimeUs,
+                                                     uint64_t *aircraftTimeUs)
+{
+    T_DjiOsalHandler *osalHandler = DjiPlatform_GetOsalHandler();
+    double correction;
+
+    osalHandler->MutexLock(model->mutex);
+    if (!model->statistics.isLocked) {
+        osalHandler->MutexUnlock(model->mutex);
+        return DJI_ERROR_SYSTEM_MODULE_CODE_NONSUPPORT_IN_CURRENT_STATE;
+    }
+
+    correction = model->state[0] + model->state[1] * DJI_TEST_TIME_SYNC_MODEL_PPM *
+                                   (double) (int64_t) (localTimeUs - model->refLocalTimeUs);
+    *aircraftTimeUs = localTimeUs + (uint64_t) model->offsetBaseUs + (uint64_t) (int64_t) llround(correction);
+    osalHandler->MutexUnlock(model->mutex);
+
+    return DJI_ERROR_SYSTEM_MODULE_CODE_SUCCESS;
+}
+
+T_DjiReturnCode DjiTest_TimeSyncModelAircraftToLocal(T_DjiTestTimeSyncModel *model, uint64_t aircraftTimeUs,
+                                                     uint64_t *localTimeUs)
+{
+    T_DjiOsalHandler *osalHandler = DjiPlatform_GetOsalHandler();
+    double elapsed;
+
+    osalHandler->MutexLock(model->mutex);
+    if (!model->statistics.isLocked) {
+        osalHandler->MutexUnlock(model->mutex);
+        return DJI_ERROR_SYSTEM_MODULE_CODE_NONSUPPORT_IN_CURRENT_STATE;
+    }
+
+    /* Invert a = l + base + x0 + x1 * (l - ref), the local time elapsed since ref in aircraft time is (1 + x1) longer. */
+    elapsed = (double) (int64_t) (aircraftTimeUs - model->refLocalTimeUs - (uint64_t) model->offsetBaseUs) -
+              model->state[0];
+    elapsed /= 1 + model->state[1] * DJI_TEST_TIME_SYNC_MODEL_PPM;
+    *localTimeUs = model->refLocalTimeUs + (uint64_t) (int64_t) llround(elapsed);
+    osalHandler->MutexUnlock(model->mutex);
+
+    return DJI_ERROR_SYSTEM_MODULE_CODE_SUCCESS;
+}
+
+void DjiTest_TimeSyncModelGetStatistics(T_DjiTestTimeSyncModel *model, T_DjiTestTimeSyncModelStatistics *statistics)
+{
+    T_DjiOsalHandler *osalHandler = DjiPlatform_GetOsalHandler();
+
+    osalHandler->MutexLock(model->mutex);
+    *statistics = model->statistics;
+    osalHandler->MutexUnlock(model->mutex);
+}
+
+/**
+ * @brief Convert a calendar time reported by the aircraft to microseconds since 1970-01-01 00:00:00.
+ * @note The aircraft time is UTC without leap seconds, the same convention as the POSIX epoch.
+ * @param aircraftTime: pointer to the calendar time.
+ * @return Microseconds since the epoch.
+ */
+uint64_t DjiTest_TimeSyncAircraftTimeToUs(const T_DjiTimeSyncAircraftTime *aircraftTime)
+{
+    int64_t days = DjiTest_TimeSyncDaysFromCivil(aircraftTime->year, aircraftTime->month, aircraftTime->day);
+    int64_t seconds = days * DJI_TEST_TIME_SYNC_MODEL_SECONDS_PER_DAY + aircraftTime->hour * 3600 +
+                      aircraftTime->minute * 60 + aircraftTime->second;
+
+    return (uint64_t) seconds * DJI_TEST_TIME_SYNC_MODEL_US_PER_SECOND + aircraftTime->microsecond;
+}
+
+void DjiTest_TimeSyncUsToAircraftTime(uint64_t timeUs, T_DjiTimeSyncAircraftTime *aircraftTime)
+{
+    int64_t seconds = (int64_t) (timeUs / DJI_TEST_TIME_SYNC_MODEL_US_PER_SECOND);
+    int64_t days = seconds / DJI_TEST_TIME_SYNC_MODEL_SECONDS_PER_DAY;
+    int64_t secondOfDay = seconds % DJI_TEST_TIME_SYNC_MODEL_SECONDS_PER_DAY;
+    int64_t era, dayOfEra, yearOfEra, dayOfYear, monthIndex;
+    uint32_t month;
+
+    /* Inverse of DjiTest_TimeSyncDaysFromCivil, years start on March 1st so the leap day is the last one. */
+    days += DJI_TEST_TIME_SYNC_MODEL_EPOCH_DAY_OFFSET;
+    era = days / DJI_TEST_TIME_SYNC_MODEL_DAYS_PER_ERA;
+    dayOfEra = days - era * DJI_TEST_TIME_SYNC_MODEL_DAYS_PER_ERA;
+    yearOfEra = (dayOfEra - dayOfEra / 1460 + dayOfEra / 36524 - dayOfEra / 146096) / 365;
+    dayOfYear = dayOfEra - (365 * yearOfEra + yearOfEra / 4 - yearOfEra / 100);
+    monthIndex = (5 * dayOfYear + 2) / 153;
+    month = (uint32_t) (monthIndex < 10 ? monthIndex + 3 : monthIndex - 9);
+
+    aircraftTime->year = (uint16_t) (yearOfEra + era * 400 + (month <= 2 ? 1 : 0));
+    aircraftTime->month = (uint8_t) month;
+    aircraftTime->day = (uint8_t) (dayOfYear - (153 * monthIndex + 2) / 5 + 1);
+    aircraftTime->hour = (uint8_t) (secondOfDay / 3600);
+    aircraftTime->minute = (uint8_t) (secondOfDay / 60 % 60);
+    aircraftTime->second = (uint8_t) (secondOfDay % 60);
+    aircraftTime->microsecond = (uint32_t) (timeUs % DJI_TEST_TIME_SYNC_MODEL_US_PER_SECOND);
+}
+
+/* Private functions definition-----------------------------------------------*/
+static void DjiTest_TimeSyncModelRestart(T_DjiTestTimeSyncModel *model, uint64_t localTimeUs, int64_t offsetUs)
+{
+    double measurementVar = (double) model->config.measurementNoiseUs * model->config.measurementNoiseUs;
+
+    model->isInitialized = true;
+    model->refLocalTimeUs = localTimeUs;
+    model->offsetBaseUs = offsetUs;
+    model->state[0] = 0;
+    model->state[1] = 0;
+    model->covariance[0][0] = measurementVar;
+    model->covariance[0][1] = 0;
+    model->covariance[1][0] = 0;
+    model->covariance[1][1] = (double) model->config.initialDriftPpm * model->config.initialDriftPpm;
+    model->consecutiveOutliers = 0;
+    model->residualSum = 0;
+    model->residualSquareSum = 0;
+    model->residualCount = 0;
+    model->statistics.residualMaxAbsUs = 0;
+    model->statistics.recentResidualRmsUs = 0;
+}
+
+static void DjiTest_TimeSyncModelPublish(T_DjiTestTimeSyncModel *model)
+{
+    T_DjiTestTimeSyncModelStatistics *statistics = &model->statistics;
+    double mean = 0, variance = 0;
+
+    if (model->residualCount > 0) {
+        mean = model->residualSum / model->residualCount;
+        variance = model->residualSquareSum / model->residualCount - mean * mean;
+    }
+
+    /* The sample that started the model has no residual, it still counts towards the lock. */
+    statistics->isLocked = model->isInitialized && model->residualCount + 1 >= model->config.minSamplesForLock;
+    statistics->offsetUs = (double) model->offsetBaseUs + model->state[0];
+    statistics->driftPpm = model->state[1];
+    statistics->offsetStdUs = sqrt(model->covariance[0][0]);
+    statistics->driftStdPpm = sqrt(model->covariance[1][1]);
+    statistics->residualMeanUs = mean;
+    statistics->residualStdUs = variance > 0 ? sqrt(variance) : 0;
+}
+
+static int64_t DjiTest_TimeSyncDaysFromCivil(int32_t year, uint32_t month, uint32_t day)
+{
+    int64_t era, yearOfEra, dayOfYear, dayOfEra;
+
+    year -= month <= 2 ? 1 : 0;
+    era = (year >= 0 ? year : year - 399) / 400;
+    yearOfEra = year - era * 400;
+    dayOfYear = (153 * (month > 2 ? month - 3 : month + 9) + 2) / 5 + day - 1;
+    dayOfEra = yearOfEra * 365 + yearOfEra / 4 - yearOfEra / 100 + dayOfYear;
+
+    return era * DJI_TEST_TIME_SYNC_MODEL_DAYS_PER_ERA + dayOfEra - DJI_TEST_TIME_SYNC_MODEL_EPOCH_DAY_OFFSET;
+}
+
+/****************** (C) COPYRIGHT DJI Innovations *****END OF FILE****/
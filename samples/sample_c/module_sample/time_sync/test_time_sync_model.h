@@ -0,0 +1,115 @@
+/**
+ ********************************************************************
+ * @file    test_time_sync_model.h
+ * @brief   This is the header file for "test_time_sync_model.c", defining the structure and
+ * (exported) function prototypes.
+ *
+ * @copyright (c) 2021 DJI. All rights reserved.
+ *
+ * All information contained herein is, and remains, the property of DJI.
+ * The intellectual and technical concepts contained herein are proprietary
+ * to DJI and may be covered by U.S. and foreign patents, patents in process,
+ * and protected by trade secret or copyright law.  Dissemination of this
+ * information, including but not limited to data and other proprietary
+ * material(s) incorporated within the information, in any form, is strictly
+ * prohibited without the express written consent of DJI.
+ *
+ * If you receive this source code without DJI’s authorization, you may not
+ * further disseminate the information, and you must immediately remove the
+ * source code and notify DJI of its removal. DJI reserves the right to pursue
+ * legal actions against you for any loss(es) or damage(s) caused by your
+ * failure to do so.
+ *
+ *********************************************************************
+ */
+
+/* Define to prevent recursive inclusion -------------------------------------*/
+#ifndef TEST_TIME_SYNC_MODEL_H
+#define TEST_TIME_SYNC_MODEL_H
+
+/* Includes ------------------------------------------------------------------*/
+#include "dji_typedef.h"
+#include "dji_platform.h"
+#include "dji_time_sync.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Exported constants --------------------------------------------------------*/
+#define DJI_TEST_TIME_SYNC_MODEL_US_PER_SECOND      (1000000ULL)
+
+/* Exported types ------------------------------------------------------------*/
+typedef struct {
+    float measurementNoiseUs;       /*!< 1-sigma error of one PPS edge timestamp. */
+    float phaseNoiseUs2PerS;        /*!< Random walk of the offset, white frequency noise of the local oscillator. */
+    float frequencyNoisePpm2PerS;   /*!< Random walk of the drift, wander of the local oscillator. */
+    float initialDriftPpm;          /*!< 1-sigma of the drift before the second sample, the crystal tolerance. */
+    float outlierGateSigma;         /*!< Samples whose innovation exceeds this many sigma are rejected. */
+    float outlierGateMinUs;         /*!< Lower bound of the gate so a well settled model still tolerates jitter. */
+    uint32_t maxConsecutiveOutliers; /*!< Restart the model after this many rejected samples in a row, a clock step. */
+    uint32_t minSamplesForLock;     /*!< Accepted samples before the model reports itself locked. */
+} T_DjiTestTimeSyncModelConfig;
+
+typedef struct {
+    bool isLocked;
+    uint32_t sampleCount;
+    uint32_t acceptedCount;
+    uint32_t rejectedCount;
+    uint32_t resetCount;
+    double offsetUs;                /*!< Aircraft time minus local time at the newest accepted sample. */
+    double driftPpm;                /*!< Rate of the aircraft clock against the local clock, minus one. */
+    double offsetStdUs;
+    double driftStdPpm;
+    double lastResidualUs;          /*!< Innovation of the newest sample, its prediction error before the update. */
+    double residualMeanUs;          /*!< Over the accepted samples since the last restart. */
+    double residualStdUs;
+    double residualMaxAbsUs;
+    double recentResidualRmsUs;     /*!< Exponentially weighted over roughly the last 16 accepted samples. */
+} T_DjiTestTimeSyncModelStatistics;
+
+/**
+ * @brief Two-state Kalman filter of the offset and the drift of the aircraft clock against the local clock.
+ * @note The model is fed with (local time, aircraft time) pairs taken at PPS edges. Conversions use the published
+ * state, a reference point and two coefficients, so they cost a few multiplications regardless of the history. They
+ * fail until minSamplesForLock samples are accepted.
+ * All functions are thread-safe.
+ */
+typedef struct {
+    T_DjiTestTimeSyncModelConfig config;
+    T_DjiMutexHandle mutex;
+    bool isInitialized;
+    uint64_t refLocalTimeUs;
+    int64_t offsetBaseUs;           /*!< Integer part of the offset, keeps the state small enough for full precision. */
+    double state[2];                /*!< Offset in us at refLocalTimeUs on top of offsetBaseUs, drift in ppm. */
+    double covariance[2][2];
+    uint32_t consecutiveOutliers;
+    double residualSum;
+    double residualSquareSum;
+    uint32_t residualCount;
+    T_DjiTestTimeSyncModelStatistics statistics;
+} T_DjiTestTimeSyncModel;
+
+/* Exported functions --------------------------------------------------------*/
+void DjiTest_TimeSyncModelGetDefaultConfig(T_DjiTestTimeSyncModelConfig *config);
+T_DjiReturnCode DjiTest_TimeSyncModelInit(T_DjiTestTimeSyncModel *model, const T_DjiTestTimeSyncModelConfig *config);
+T_DjiReturnCode DjiTest_TimeSyncModelDeInit(T_DjiTestTimeSyncModel *model);
+void DjiTest_TimeSyncModelReset(T_DjiTestTimeSyncModel *model);
+
+T_DjiReturnCode DjiTest_TimeSyncModelUpdate(T_DjiTestTimeSyncModel *model, uint64_t localTimeUs,
+                                            uint64_t aircraftTimeUs, bool *isAccepted);
+T_DjiReturnCode DjiTest_TimeSyncModelLocalToAircraft(T_DjiTestTimeSyncModel *model, uint64_t localTimeUs,
+                                                     uint64_t *aircraftTimeUs);
+T_DjiReturnCode DjiTest_TimeSyncModelAircraftToLocal(T_DjiTestTimeSyncModel *model, uint64_t aircraftTimeUs,
+                                                     uint64_t *localTimeUs);
+void DjiTest_TimeSyncModelGetStatistics(T_DjiTestTimeSyncModel *model, T_DjiTestTimeSyncModelStatistics *statistics);
+
+uint64_t DjiTest_TimeSyncAircraftTimeToUs(const T_DjiTimeSyncAircraftTime *aircraftTime);
+void DjiTest_TimeSyncUsToAircraftTime(uint64_t timeUs, T_DjiTimeSyncAircraftTime *aircraftTime);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // TEST_TIME_SYNC_MODEL_H
+/************************ (C) COPYRIGHT DJI Innovations *******END OF FILE******/
@@ -29,16 +29,16 @@
 #include "test_upgrade_platform_opt.h"
 
 /* Private constants ---------------------------------------------------------*/
-#define DJI_TEST_FILE_MD5_BUFFER_SIZE              256
 
 /* Private types -------------------------------------------------------------*/
 
 /* Private values -------------------------------------------------------------*/
 static T_DjiUpgradeFileInfo s_upgradeFileInfo = {0};
 static uint32_t s_alreadyTransferFileSize = 0;
+static bool s_isPlatformFileMd5 = false;
+static MD5_CTX s_upgradeFileMd5Ctx;
 
 /* Private functions declaration ---------------------------------------------*/
-static T_DjiReturnCode DjiTestFile_GetUpgradeFileMd5(uint8_t md5[DJI_MD5_BUFFER_LEN]);
 
 /* Exported functions definition ---------------------------------------------*/
 T_DjiReturnCode DjiTestCommonFileTransfer_Start(const T_DjiUpgradeFileInfo *fileInfo)
@@ -55,6 +55,9 @@ T_DjiReturnCode DjiTestCommonFileTransfer_Start(const T_DjiUpgradeFileInfo *file
         return returnCode;
     }
 
+    /* The file is hashed while it is received, by the platform if it can, so finishing needs no read back. */
+    s_isPlatformFileMd5 = DjiTest_IsUpgradeProgramFileMd5Supported();
+    UtilMd5_Init(&s_upgradeFileMd5Ctx);
     s_upgradeFileInfo = *fileInfo;
 
     return DJI_ERROR_SYSTEM_MODULE_CODE_SUCCESS;
@@ -75,6 +78,9 @@ T_DjiReturnCode DjiTestCommonFileTransfer_Transfer(const uint8_t *data, uint16_t
         return DJI_ERROR_SYSTEM_MODULE_CODE_SYSTEM_ERROR;
     }
 
+    if (!s_isPlatformFileMd5) {
+        UtilMd5_Update(&s_upgradeFileMd5Ctx, data, dataLen);
+    }
     s_alreadyTransferFileSize += dataLen;
 
     return DJI_ERROR_SYSTEM_MODULE_CODE_SUCCESS;
@@ -90,10 +96,14 @@ T_DjiReturnCode DjiTestCommonFileTransfer_Finish(const uint8_t md5[DJI_MD5_BUFFE
         return DJI_ERROR_SYSTEM_MODULE_CODE_INVALID_PARAMETER;
     }
 
-    returnCode = DjiTestFile_GetUpgradeFileMd5(localFileMd5);
-    if (returnCode != DJI_ERROR_SYSTEM_MODULE_CODE_SUCCESS) {
-        USER_LOG_ERROR("Get file md5 error, return code = 0x%08llX", returnCode);
-        goto out;
+    if (s_isPlatformFileMd5) {
+        returnCode = DjiTest_GetUpgradeProgramFileMd5(localFileMd5);
+        if (returnCode != DJI_ERROR_SYSTEM_MODULE_CODE_SUCCESS) {
+            USER_LOG_ERROR("Get file md5 error, return code = 0x%08llX", returnCode);
+            goto out;
+        }
+    } else {
+        UtilMd5_Final(&s_upgradeFileMd5Ctx, localFileMd5);
     }
 
     if (memcmp(md5, localFileMd5, DJI_MD5_BUFFER_LEN) == 0) {
@@ -110,40 +120,4 @@ out:
     return returnCode;
 }
 
-/* Private functions definition-----------------------------------------------*/
-static T_DjiReturnCode DjiTestFile_GetUpgradeFileMd5(uint8_t md5[DJI_MD5_BUFFER_LEN])
-{
-    uint8_t fileBuffer[DJI_TEST_FILE_MD5_BUFFER_SIZE] = {0};
-    T_DjiReturnCode returnCode;
-    uint32_t offset;
-    MD5_CTX fileMd5Ctx;
-    uint16_t realLen = 0;
-
-    offset = 0;
-    UtilMd5_Init(&fileMd5Ctx);
-    while (s_upgradeFileInfo.fileSize - offset > DJI_TEST_FILE_MD5_BUFFER_SIZE) {
-        returnCode = DjiTest_ReadUpgradeProgramFile(offset, DJI_TEST_FILE_MD5_BUFFER_SIZE,
-                                                     fileBuffer, &realLen);
-        if (returnCode != DJI_ERROR_SYSTEM_MODULE_CODE_SUCCESS || realLen != DJI_TEST_FILE_MD5_BUFFER_SIZE) {
-            USER_LOG_ERROR("Get file data error, return code = 0x%08llX", returnCode);
-            return returnCode;
-        }
-
-        UtilMd5_Update(&fileMd5Ctx, fileBuffer, DJI_TEST_FILE_MD5_BUFFER_SIZE);
-
-        offset += DJI_TEST_FILE_MD5_BUFFER_SIZE;
-    }
-
-    returnCode = DjiTest_ReadUpgradeProgramFile(offset, s_upgradeFileInfo.fileSize - offset, fileBuffer, &realLen);
-    if (returnCode != DJI_ERROR_SYSTEM_MODULE_CODE_SUCCESS || realLen != s_upgradeFileInfo.fileSize - offset) {
-        USER_LOG_ERROR("Get file data error, return code = 0x%08llX", returnCode);
-        return returnCode;
-    }
-
-    UtilMd5_Update(&fileMd5Ctx, fileBuffer, s_upgradeFileInfo.fileSize - offset);
-    UtilMd5_Final(&fileMd5Ctx, md5);
-
-    return DJI_ERROR_SYSTEM_MODULE_CODE_SUCCESS;
-}
-
 /****************** (C) COPYRIGHT DJI Innovations *****END OF FILE****/
@@ -116,6 +116,20 @@ T_DjiReturnCode DjiTest_CloseUpgradeProgramFile(void)
     return s_upgradePlatformOpt.closeUpgradeProgramFile();
 }
 
+bool DjiTest_IsUpgradeProgramFileMd5Supported(void)
+{
+    return s_upgradePlatformOpt.getUpgradeProgramFileMd5 != NULL;
+}
+
+T_DjiReturnCode DjiTest_GetUpgradeProgramFileMd5(uint8_t md5[DJI_MD5_BUFFER_LEN])
+{
+    if (s_upgradePlatformOpt.getUpgradeProgramFileMd5 == NULL) {
+        return DJI_ERROR_SYSTEM_MODULE_CODE_NONSUPPORT;
+    }
+
+    return s_upgradePlatformOpt.getUpgradeProgramFileMd5(md5);
+}
+
 T_DjiReturnCode DjiTest_ReplaceOldProgram(void)
 {
     return s_upgradePlatformOpt.replaceOldProgram();
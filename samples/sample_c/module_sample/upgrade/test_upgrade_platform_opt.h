@@ -49,6 +49,8 @@ typedef struct {
     T_DjiReturnCode (*readUpgradeProgramFile)(uint32_t offset, uint16_t readDataLen, uint8_t *data,
                                                uint16_t *realLen);
     T_DjiReturnCode (*closeUpgradeProgramFile)(void);
+    /* Optional, md5 of the program file the platform computed while receiving it. */
+    T_DjiReturnCode (*getUpgradeProgramFileMd5)(uint8_t md5[DJI_MD5_BUFFER_LEN]);
 
     T_DjiReturnCode (*replaceOldProgram)(void);
 
@@ -68,6 +70,8 @@ T_DjiReturnCode DjiTest_WriteUpgradeProgramFile(uint32_t offset, const uint8_t *
 T_DjiReturnCode DjiTest_ReadUpgradeProgramFile(uint32_t offset, uint16_t readDataLen, uint8_t *data,
                                                  uint16_t *realLen);
 T_DjiReturnCode DjiTest_CloseUpgradeProgramFile(void);
+bool DjiTest_IsUpgradeProgramFileMd5Supported(void);
+T_DjiReturnCode DjiTest_GetUpgradeProgramFileMd5(uint8_t md5[DJI_MD5_BUFFER_LEN]);
 
 T_DjiReturnCode DjiTest_ReplaceOldProgram(void);
 
@@ -0,0 +1,419 @@
+/**
+ ******************************************************************************
+ * @file    util_deflate.c
+ * @brief   Streaming raw deflate (RFC 1951) compressor with fixed Huffman codes.
+ *
+ * @copyright (c) 2021 DJI. All rights reserved.
+ *
+ * All information contained herein is, and remains, the property of DJI.
+ * The intellectual and technical concepts contained herein are proprietary
+ * to DJI and may be covered by U.S. and foreign patents, patents in process,
+ * and protected by trade secret or copyright law.  Dissemination of this
+ * information, including but not limited to data and other proprietary
+ * material(s) incorporated within the information, in any form, is strictly
+ * prohibited without the express written consent of DJI.
+ *
+ * If you receive this source code without DJI’s authorization, you may not
+ * further disseminate the information, and you must immediately remove the
+ * source code and notify DJI of its removal. DJI reserves the right to pursue
+ * legal actions against you for any loss(es) or damage(s) caused by your
+ * failure to do so.
+ *
+ ******************************************************************************
+ */
+
+
+/* Includes ------------------------------------------------------------------*/
+#include "util_deflate.h"
+#include <string.h>
+
+/* Private constants ---------------------------------------------------------*/
+#define UTIL_DEFLATE_WINDOW_MASK            (UTIL_DEFLATE_WINDOW_SIZE - 1)
+#define UTIL_DEFLATE_HASH_SIZE              (1U << UTIL_DEFLATE_HASH_BITS)
+#define UTIL_DEFLATE_MIN_MATCH              3
+#define UTIL_DEFLATE_MAX_MATCH              258
+#define UTIL_DEFLATE_END_OF_BLOCK           256
+#define UTIL_DEFLATE_FIXED_BLOCK_HEADER     2   /* BFINAL = 0, BTYPE = 01 */
+#define UTIL_DEFLATE_FINAL_BLOCK_HEADER     3   /* BFINAL = 1, BTYPE = 01 */
+#define UTIL_DEFLATE_BLOCK_HEADER_BITS      3
+
+/* Private types -------------------------------------------------------------*/
+typedef struct {
+    uint32_t literalCode[UTIL_DEFLATE_END_OF_BLOCK + 1];
+    uint8_t literalBits[UTIL_DEFLATE_END_OF_BLOCK + 1];
+    uint32_t lengthCode[UTIL_DEFLATE_MAX_MATCH + 1];        /*!< Huffman code and extra bits of every match length. */
+    uint8_t lengthBits[UTIL_DEFLATE_MAX_MATCH + 1];
+    uint8_t distanceCode[512];                              /*!< Same two-level lookup as zlib's _dist_code. */
+} T_UtilDeflateTables;
+
+/* Private functions declaration ---------------------------------------------*/
+static void UtilDeflate_BuildTables(void);
+static uint32_t UtilDeflate_GetFixedCode(uint32_t symbol, uint32_t *bits);
+static uint32_t UtilDeflate_ReverseBits(uint32_t code, uint32_t bits);
+static uint32_t UtilDeflate_Hash(const uint8_t *data);
+static uint32_t UtilDeflate_GetMatchLength(const uint8_t *match, const uint8_t *current, uint32_t maxLength);
+static void UtilDeflate_Compress(T_UtilDeflate *deflate, bool isFlush);
+static void UtilDeflate_PutMatch(T_UtilDeflate *deflate, uint32_t length, uint32_t distance);
+static void UtilDeflate_PutBits(T_UtilDeflate *deflate, uint32_t value, uint32_t count);
+static void UtilDeflate_PutByte(T_UtilDeflate *deflate, uint8_t byte);
+static void UtilDeflate_FlushOutput(T_UtilDeflate *deflate);
+
+/* Private values ------------------------------------------------------------*/
+static const uint16_t s_lengthBase[29] = {
+    3, 4, 5, 6, 7, 8, 9, 10, 11, 13, 15, 17, 19, 23, 27, 31, 35, 43, 51, 59, 67, 83, 99, 115, 131, 163, 195, 227, 258
+};
+static const uint8_t s_lengthExtraBits[29] = {
+    0, 0, 0, 0, 0, 0, 0, 0, 1, 1, 1, 1, 2, 2, 2, 2, 3, 3, 3, 3, 4, 4, 4, 4, 5, 5, 5, 5, 0
+};
+static const uint16_t s_distanceBase[30] = {
+    1, 2, 3, 4, 5, 7, 9, 13, 17, 25, 33, 49, 65, 97, 129, 193, 257, 385, 513, 769, 1025, 1537, 2049, 3073, 4097,
+    6145, 8193, 12289, 16385, 24577
+};
+static const uint8_t s_distanceExtraBits[30] = {
+    0, 0, 0, 0, 1, 1, 2, 2, 3, 3, 4, 4, 5, 5, 6, 6, 7, 7, 8, 8, 9, 9, 10, 10, 11, 11, 12, 12, 13, 13
+};
+static T_UtilDeflateTables s_tables;
+static bool s_isTablesBuilt = false;
+
+/* Exported functions definition ---------------------------------------------*/
+size_t UtilDeflate_GetMemorySize(void)
+{
+    return 2 * UTIL_DEFLATE_WINDOW_SIZE + UTIL_DEFLATE_HASH_SIZE * sizeof(uint32_t) +
+           UTIL_DEFLATE_WINDOW_SIZE * sizeof(uint32_t);
+}
+
+/**
+ * @brief Init the compressor on user memory of at least UtilDeflate_GetMemorySize bytes.
+ * @note The first call builds the shared code tables, make it before compressors are used from several tasks.
+ * @param maxChainLength: hash chain entries tried per position, trades speed for ratio, 0 selects the default.
+ */
+T_DjiReturnCode UtilDeflate_Init(T_UtilDeflate *deflate, void *memory, size_t memorySize, uint32_t maxChainLength)
+{
+    if (deflate == NULL || memory == NULL || memorySize < UtilDeflate_GetMemorySize() ||
+        ((uintptr_t) memory % sizeof(uint32_t)) != 0) {
+        return DJI_ERROR_SYSTEM_MODULE_CODE_INVALID_PARAMETER;
+    }
+
+    if (!s_isTablesBuilt) {
+        UtilDeflate_BuildTables();
+    }
+
+    memset(deflate, 0, sizeof(T_UtilDeflate));
+    deflate->head = memory;
+    deflate->prev = deflate->head + UTIL_DEFLATE_HASH_SIZE;
+    deflate->window = (uint8_t *) (deflate->prev + UTIL_DEFLATE_WINDOW_SIZE);
+    deflate->maxChainLength = maxChainLength != 0 ? maxChainLength : UTIL_DEFLATE_DEFAULT_MAX_CHAIN_LENGTH;
+
+    return DJI_ERROR_SYSTEM_MODULE_CODE_SUCCESS;
+}
+
+T_DjiReturnCode UtilDeflate_Start(T_UtilDeflate *deflate, UtilDeflateOutputFunc outputFunc, void *userData)
+{
+    if (deflate == NULL || outputFunc == NULL) {
+        return DJI_ERROR_SYSTEM_MODULE_CODE_INVALID_PARAMETER;
+    }
+
+    /* Only the heads need clearing, a chain is always entered through a head written by this stream. */
+    memset(deflate->head, 0, UTIL_DEFLATE_HASH_SIZE * sizeof(uint32_t));
+    deflate->windowStart = 0;
+    deflate->position = 0;
+    deflate->inputEnd = 0;
+    deflate->bitBuffer = 0;
+    deflate->bitCount = 0;
+    deflate->outputLen = 0;
+    deflate->totalOut = 0;
+    deflate->outputFunc = outputFunc;
+    deflate->userData = userData;
+    deflate->status = DJI_ERROR_SYSTEM_MODULE_CODE_SUCCESS;
+
+    /* The whole stream is one fixed-code block, the final flag goes to an empty block appended by Finish. */
+    UtilDeflate_PutBits(deflate, UTIL_DEFLATE_FIXED_BLOCK_HEADER, UTIL_DEFLATE_BLOCK_HEADER_BITS);
+
+    return DJI_ERROR_SYSTEM_MODULE_CODE_SUCCESS;
+}
+
+T_DjiReturnCode UtilDeflate_Write(T_UtilDeflate *deflate, const uint8_t *data, uint32_t len)
+{
+    uint32_t used;
+    uint32_t copyLen;
+
+    while (len > 0 && deflate->status == DJI_ERROR_SYSTEM_MODULE_CODE_SUCCESS) {
+        used = deflate->inputEnd - deflate->windowStart;
+        if (used == 2 * UTIL_DEFLATE_WINDOW_SIZE) {
+            /* Compress leaves less than a match of lookahead, so the upper half holds a full window of history. */
+            memcpy(deflate->window, deflate->window + UTIL_DEFLATE_WINDOW_SIZE, UTIL_DEFLATE_WINDOW_SIZE);
+            deflate->windowStart += UTIL_DEFLATE_WINDOW_SIZE;
+            used -= UTIL_DEFLATE_WINDOW_SIZE;
+        }
+
+        copyLen = 2 * UTIL_DEFLATE_WINDOW_SIZE - used;
+        if (copyLen > len) {
+            copyLen = len;
+        }
+        memcpy(deflate->window + used, data, copyLen);
+        deflate->inputEnd += copyLen;
+        data += copyLen;
+        len -= copyLen;
+
+        UtilDeflate_Compress(deflate, false);
+    }
+
+    return deflate->status;
+}
+
+T_DjiReturnCode UtilDeflate_Finish(T_UtilDeflate *deflate)
+{
+    UtilDeflate_Compress(deflate, true);
+
+    UtilDeflate_PutBits(deflate, s_tables.literalCode[UTIL_DEFLATE_END_OF_BLOCK],
+                        s_tables.literalBits[UTIL_DEFLATE_END_OF_BLOCK]);
+    UtilDeflate_PutBits(deflate, UTIL_DEFLATE_FINAL_BLOCK_HEADER, UTIL_DEFLATE_BLOCK_HEADER_BITS);
+    UtilDeflate_PutBits(deflate, s_tables.literalCode[UTIL_DEFLATE_END_OF_BLOCK],
+                        s_tables.literalBits[UTIL_DEFLATE_END_OF_BLOCK]);
+
+    while (deflate->bitCount > 0) {
+        UtilDeflate_PutByte(deflate, (uint8_t) deflate->bitBuffer);
+        deflate->bitBuffer >>= 8;
+        deflate->bitCount = deflate->bitCount > 8 ? deflate->bitCount - 8 : 0;
+    }
+    UtilDeflate_FlushOutput(deflate);
+
+    return deflate->status;
+}
+
+uint64_t UtilDeflate_GetTotalIn(const T_UtilDeflate *deflate)
+{
+    return deflate->inputEnd;
+}
+
+uint64_t UtilDeflate_GetTotalOut(const T_UtilDeflate *deflate)
+{
+    return deflate->totalOut + deflate->outputLen;
+}
+
+/* Private functions definition-----------------------------------------------*/
+static void UtilDeflate_BuildTables(void)
+{
+    uint32_t symbol, length, distance, bits, extraBits;
+    uint32_t code;
+    uint32_t i = 0;
+
+    for (symbol = 0; symbol <= UTIL_DEFLATE_END_OF_BLOCK; symbol++) {
+        code = UtilDeflate_GetFixedCode(symbol, &bits);
+        s_tables.literalCode[symbol] = code;
+        s_tables.literalBits[symbol] = (uint8_t) bits;
+    }
+
+    /* Length 258 has its own symbol although the range of the symbol before would also cover it. */
+    for (length = UTIL_DEFLATE_MIN_MATCH; length <= UTIL_DEFLATE_MAX_MATCH; length++) {
+        while (i + 1 < sizeof(s_lengthBase) / sizeof(s_lengthBase[0]) && s_lengthBase[i + 1] <= length) {
+            i++;
+        }
+        code = UtilDeflate_GetFixedCode(UTIL_DEFLATE_END_OF_BLOCK + 1 + i, &bits);
+        extraBits = s_lengthExtraBits[i];
+        s_tables.lengthCode[length] = code | ((length - s_lengthBase[i]) << bits);
+        s_tables.lengthBits[length] = (uint8_t) (bits + extraBits);
+    }
+
+    for (i = 0; i < sizeof(s_distanceBase) / sizeof(s_distanceBase[0]); i++) {
+        for (distance = s_distanceBase[i]; distance < s_distanceBase[i] + (1U << s_distanceExtraBits[i]);
+             distance++) {
+            if (distance - 1 < 256) {
+                s_tables.distanceCode[distance - 1] = (uint8_t) i;
+            } else {
+                s_tables.distanceCode[256 + ((distance - 1) >> 7)] = (uint8_t) i;
+            }
+        }
+    }
+
+    s_isTablesBuilt = true;
+}
+
+/**
+ * @brief Fixed literal/length code of RFC 1951 3.2.6, bit-reversed since Huffman codes are sent MSB first.
+ */
+static uint32_t UtilDeflate_GetFixedCode(uint32_t symbol, uint32_t *bits)
+{
+    if (symbol < 144) {
+        *bits = 8;
+        return UtilDeflate_ReverseBits(0x30 + symbol, 8);
+    } else if (symbol < 256) {
+        *bits = 9;
+        return UtilDeflate_ReverseBits(0x190 + symbol - 144, 9);
+    } else if (symbol < 280) {
+        *bits = 7;
+        return UtilDeflate_ReverseBits(symbol - 256, 7);
+    } else {
+        *bits = 8;
+        return UtilDeflate_ReverseBits(0xC0 + symbol - 280, 8);
+    }
+}
+
+static uint32_t UtilDeflate_ReverseBits(uint32_t code, uint32_t bits)
+{
+    uint32_t reversed = 0;
+    uint32_t i;
+
+    for (i = 0; i < bits; i++) {
+        reversed = (reversed << 1) | ((code >> i) & 1);
+    }
+
+    return reversed;
+}
+
+static uint32_t UtilDeflate_Hash(const uint8_t *data)
+{
+    uint32_t value = (uint32_t) data[0] | ((uint32_t) data[1] << 8) | ((uint32_t) data[2] << 16);
+
+    return (value * 2654435761U) >> (32 - UTIL_DEFLATE_HASH_BITS);
+}
+
+static uint32_t UtilDeflate_GetMatchLength(const uint8_t *match, const uint8_t *current, uint32_t maxLength)
+{
+    uint32_t length = 0;
+
+#if defined(__GNUC__) && defined(__BYTE_ORDER__) && (__BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__)
+    uint64_t matchWord, currentWord;
+
+    /* Compare eight bytes at a time, the lowest differing byte of the xor is the first mismatch. */
+    while (length + sizeof(uint64_t) <= maxLength) {
+        memcpy(&matchWord, match + length, sizeof(uint64_t));
+        memcpy(&currentWord, current + length, sizeof(uint64_t));
+        if (matchWord != currentWord) {
+            return length + (uint32_t) (__builtin_ctzll(matchWord ^ currentWord) / 8);
+        }
+        length += sizeof(uint64_t);
+    }
+#endif
+
+    while (length < maxLength && match[length] == current[length]) {
+        length++;
+    }
+
+    return length;
+}
+
+static void UtilDeflate_Compress(T_UtilDeflate *deflate, bool isFlush)
+{
+    uint32_t minLookahead = isFlush ? 0 : UTIL_DEFLATE_MAX_MATCH;
+    uint32_t available, maxLength, bestLength, bestDistance, limit, chainLength, hash, candidate, next;
+    const uint8_t *current;
+    const uint8_t *match;
+    uint32_t length;
+    uint32_t i;
+
+    while (deflate->inputEnd - deflate->position > minLookahead &&
+           deflate->status == DJI_ERROR_SYSTEM_MODULE_CODE_SUCCESS) {
+        available = deflate->inputEnd - deflate->position;
+        current = deflate->window + (deflate->position - deflate->windowStart);
+        bestLength = 0;
+        bestDistance = 0;
+
+        if (available >= UTIL_DEFLATE_MIN_MATCH) {
+            maxLength = available < UTIL_DEFLATE_MAX_MATCH ? available : UTIL_DEFLATE_MAX_MATCH;
+            limit = deflate->position > UTIL_DEFLATE_WINDOW_SIZE ? deflate->position - UTIL_DEFLATE_WINDOW_SIZE : 0;
+            if (limit < deflate->windowStart) {
+                limit = deflate->windowStart;
+            }
+
+            hash = UtilDeflate_Hash(current);
+            candidate = deflate->head[hash];
+            deflate->prev[deflate->position & UTIL_DEFLATE_WINDOW_MASK] = candidate;
+            deflate->head[hash] = deflate->position + 1;
+
+            for (chainLength = deflate->maxChainLength; candidate != 0 && chainLength > 0; chainLength--) {
+                if (candidate - 1 < limit) {
+                    break;
+                }
+                match = deflate->window + (candidate - 1 - deflate->windowStart);
+                if (match[bestLength] == current[bestLength] && match[0] == current[0]) {
+                    length = UtilDeflate_GetMatchLength(match, current, maxLength);
+                    if (length > bestLength) {
+                        bestLength = length;
+                        bestDistance = deflate->position - (candidate - 1);
+                        if (length == maxLength) {
+                            break;
+                        }
+                    }
+                }
+
+                /* A chain only goes back in time, anything else is a slot reused by a newer position. */
+                next = deflate->prev[(candidate - 1) & UTIL_DEFLATE_WINDOW_MASK];
+                if (next >= candidate) {
+                    break;
+                }
+                candidate = next;
+            }
+        }
+
+        if (bestLength >= UTIL_DEFLATE_MIN_MATCH) {
+            UtilDeflate_PutMatch(deflate, bestLength, bestDistance);
+            for (i = 1; i < bestLength; i++) {
+                if (deflate->inputEnd - (deflate->position + i) < UTIL_DEFLATE_MIN_MATCH) {
+                    break;
+                }
+                hash = UtilDeflate_Hash(current + i);
+                deflate->prev[(deflate->position + i) & UTIL_DEFLATE_WINDOW_MASK] = deflate->head[hash];
+                deflate->head[hash] = deflate->position + i + 1;
+            }
+            deflate->position += bestLength;
+        } else {
+            UtilDeflate_PutBits(deflate, s_tables.literalCode[current[0]], s_tables.literalBits[current[0]]);
+            deflate->position++;
+        }
+    }
+}
+
+static void UtilDeflate_PutMatch(T_UtilDeflate *deflate, uint32_t length, uint32_t distance)
+{
+    uint32_t code;
+
+    UtilDeflate_PutBits(deflate, s_tables.lengthCode[length], s_tables.lengthBits[length]);
+
+    code = distance <= 256 ? s_tables.distanceCode[distance - 1] : s_tables.distanceCode[256 + ((distance - 1) >> 7)];
+    UtilDeflate_PutBits(deflate, UtilDeflate_ReverseBits(code, 5) | ((distance - s_distanceBase[code]) << 5),
+                        5 + s_distanceExtraBits[code]);
+}
+
+static void UtilDeflate_PutBits(T_UtilDeflate *deflate, uint32_t value, uint32_t count)
+{
+    deflate->bitBuffer |= (uint64_t) value << deflate->bitCount;
+    deflate->bitCount += count;
+
+    if (deflate->bitCount >= 32) {
+        UtilDeflate_PutByte(deflate, (uint8_t) deflate->bitBuffer);
+        UtilDeflate_PutByte(deflate, (uint8_t) (deflate->bitBuffer >> 8));
+        UtilDeflate_PutByte(deflate, (uint8_t) (deflate->bitBuffer >> 16));
+        UtilDeflate_PutByte(deflate, (uint8_t) (deflate->bitBuffer >> 24));
+        deflate->bitBuffer >>= 32;
+        deflate->bitCount -= 32;
+    }
+}
+
+static void UtilDeflate_PutByte(T_UtilDeflate *deflate, uint8_t byte)
+{
+    deflate->output[deflate->outputLen++] = byte;
+    if (deflate->outputLen == UTIL_DEFLATE_OUTPUT_BUFFER_SIZE) {
+        UtilDeflate_FlushOutput(deflate);
+    }
+}
+
+static void UtilDeflate_FlushOutput(T_UtilDeflate *deflate)
+{
+    T_DjiReturnCode returnCode;
+
+    if (deflate->outputLen == 0) {
+        return;
+    }
+
+    if (deflate->status == DJI_ERROR_SYSTEM_MODULE_CODE_SUCCESS) {
+        returnCode = deflate->outputFunc(deflate->userData, deflate->output, deflate->outputLen);
+        if (returnCode != DJI_ERROR_SYSTEM_MODULE_CODE_SUCCESS) {
+            deflate->status = returnCode;
+        }
+    }
+    deflate->totalOut += deflate->outputLen;
+    deflate->outputLen = 0;
+}
+
+/****************** (C) COPYRIGHT DJI Innovations *****END OF FILE****/
@@ -0,0 +1,97 @@
+/**
+ ******************************************************************************
+ * @file    util_deflate.h
+ * @brief   This is the header file for "util_deflate.c", defining the streaming deflate compressor.
+ *
+ * @copyright (c) 2021 DJI. All rights reserved.
+ *
+ * All information contained herein is, and remains, the property of DJI.
+ * The intellectual and technical concepts contained herein are proprietary
+ * to DJI and may be covered by U.S. and foreign patents, patents in process,
+ * and protected by trade secret or copyright law.  Dissemination of this
+ * information, including but not limited to data and other proprietary
+ * material(s) incorporated within the information, in any form, is strictly
+ * prohibited without the express written consent of DJI.
+ *
+ * If you receive this source code without DJI’s authorization, you may not
+ * further disseminate the information, and you must immediately remove the
+ * source code and notify DJI of its removal. DJI reserves the right to pursue
+ * legal actions against you for any loss(es) or damage(s) caused by your
+ * failure to do so.
+ *
+ ******************************************************************************
+ */
+
+
+
+/* Define to prevent recursive inclusion -------------------------------------*/
+#ifndef UTIL_DEFLATE_H
+#define UTIL_DEFLATE_H
+
+/* Includes ------------------------------------------------------------------*/
+#include <stddef.h>
+#include "dji_typedef.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Exported constants --------------------------------------------------------*/
+#define UTIL_DEFLATE_WINDOW_SIZE                32768
+#define UTIL_DEFLATE_HASH_BITS                  15
+#define UTIL_DEFLATE_OUTPUT_BUFFER_SIZE         4096
+#define UTIL_DEFLATE_DEFAULT_MAX_CHAIN_LENGTH   16
+
+/* Exported types ------------------------------------------------------------*/
+/**
+ * @brief Receives the compressed stream in pieces of at most UTIL_DEFLATE_OUTPUT_BUFFER_SIZE bytes.
+ */
+typedef T_DjiReturnCode (*UtilDeflateOutputFunc)(void *userData, const uint8_t *data, uint32_t len);
+
+/**
+ * @brief Raw deflate stream without zlib or gzip framing, as stored in zip entries.
+ * @note Matches are searched greedily on hash chains over a 32KB window and coded with the fixed Huffman tables, so
+ * no block has to be buffered and the output follows the input closely. The window and hash tables live in memory
+ * supplied by the caller, see UtilDeflate_GetMemorySize. The compressor is not thread-safe.
+ */
+typedef struct {
+    uint8_t *window;                /*!< Twice the window size, history in the lower half once the input slid. */
+    uint32_t *head;                 /*!< Newest position + 1 of each hash, 0 for none. */
+    uint32_t *prev;                 /*!< Previous position + 1 with the same hash, indexed by position modulo window. */
+    uint32_t windowStart;           /*!< Stream position of window[0]. */
+    uint32_t position;              /*!< Stream position of the next byte to encode. */
+    uint32_t inputEnd;              /*!< Stream position after the last byte copied into the window. */
+    uint32_t maxChainLength;
+    uint64_t bitBuffer;
+    uint32_t bitCount;
+    uint8_t output[UTIL_DEFLATE_OUTPUT_BUFFER_SIZE];
+    uint32_t outputLen;
+    uint64_t totalOut;
+    UtilDeflateOutputFunc outputFunc;
+    void *userData;
+    T_DjiReturnCode status;         /*!< First error of the output function, every later call returns it. */
+} T_UtilDeflate;
+
+/* Exported functions --------------------------------------------------------*/
+size_t UtilDeflate_GetMemorySize(void);
+T_DjiReturnCode UtilDeflate_Init(T_UtilDeflate *deflate, void *memory, size_t memorySize, uint32_t maxChainLength);
+
+/**
+ * @brief Begin a new stream, the memory of the previous one is reused.
+ */
+T_DjiReturnCode UtilDeflate_Start(T_UtilDeflate *deflate, UtilDeflateOutputFunc outputFunc, void *userData);
+T_DjiReturnCode UtilDeflate_Write(T_UtilDeflate *deflate, const uint8_t *data, uint32_t len);
+
+/**
+ * @brief Encode the buffered input, terminate the stream and hand out the remaining bytes.
+ */
+T_DjiReturnCode UtilDeflate_Finish(T_UtilDeflate *deflate);
+uint64_t UtilDeflate_GetTotalIn(const T_UtilDeflate *deflate);
+uint64_t UtilDeflate_GetTotalOut(const T_UtilDeflate *deflate);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // UTIL_DEFLATE_H
+/************************ (C) COPYRIGHT DJI Innovations *******END OF FILE******/
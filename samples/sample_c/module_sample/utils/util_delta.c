@@ -0,0 +1,818 @@
+/**
+ ******************************************************************************
+ * @file    util_delta.c
+ * @brief   Binary patches between two images, created from block matches and applied as a stream.
+ *
+ * @copyright (c) 2021 DJI. All rights reserved.
+ *
+ * All information contained herein is, and remains, the property of DJI.
+ * The intellectual and technical concepts contained herein are proprietary
+ * to DJI and may be covered by U.S. and foreign patents, patents in process,
+ * and protected by trade secret or copyright law.  Dissemination of this
+ * information, including but not limited to data and other proprietary
+ * material(s) incorporated within the information, in any form, is strictly
+ * prohibited without the express written consent of DJI.
+ *
+ * If you receive this source code without DJI’s authorization, you may not
+ * further disseminate the information, and you must immediately remove the
+ * source code and notify DJI of its removal. DJI reserves the right to pursue
+ * legal actions against you for any loss(es) or damage(s) caused by your
+ * failure to do so.
+ *
+ ******************************************************************************
+ */
+
+
+/* Includes ------------------------------------------------------------------*/
+#include "util_delta.h"
+#include <string.h>
+#include "dji_platform.h"
+#include "util_lz4.h"
+#include "util_md5.h"
+#include "util_misc.h"
+
+/* Private constants ---------------------------------------------------------*/
+#define UTIL_DELTA_MAGIC                        0x4C444A44  /* "DJDL" */
+#define UTIL_DELTA_VERSION                      1
+#define UTIL_DELTA_OP_COPY                      0x01
+#define UTIL_DELTA_OP_DIFF                      0x02
+#define UTIL_DELTA_OP_ADD                       0x03
+#define UTIL_DELTA_OP_SPARSE_DIFF               0x04
+#define UTIL_DELTA_VARINT_MAX_SIZE              10
+#define UTIL_DELTA_OP_HEADER_MAX_SIZE           (1 + 2 * UTIL_DELTA_VARINT_MAX_SIZE)
+#define UTIL_DELTA_SPARSE_HEADER_SIZE           (1 + 3 * UTIL_DELTA_VARINT_MAX_SIZE)
+#define UTIL_DELTA_SPARSE_PAIR_MAX_SIZE         (UTIL_DELTA_VARINT_MAX_SIZE + 1)
+#define UTIL_DELTA_MIN_BLOCK_SIZE               8
+#define UTIL_DELTA_MIN_FRAME_SIZE               4096
+#define UTIL_DELTA_HASH_PRIME                   0x01000193U
+/* A DIFF ends when this many bytes after its end do not improve its score. */
+#define UTIL_DELTA_DIFF_LOOKAHEAD               64
+
+/* Private types -------------------------------------------------------------*/
+typedef struct {
+    T_UtilDeltaConfig config;
+    UtilDeltaOutputFunc outputFunc;
+    void *userData;
+    const uint8_t *oldData;
+    uint64_t oldSize;
+    uint64_t oldOffset;             /*!< End of the previous read from the old image, seeks are relative to it. */
+    uint8_t *rawBuffer;
+    uint32_t rawLen;
+    uint8_t *frameBuffer;
+    T_UtilLz4Encoder lz4Encoder;
+    T_UtilDeltaStatistics statistics;
+} T_UtilDeltaEncoder;
+
+/* Private functions declaration ---------------------------------------------*/
+static uint32_t UtilDelta_HashBlock(const uint8_t *data, uint32_t len);
+static uint32_t UtilDelta_GetSlot(uint32_t hash, uint32_t slotBits);
+static T_DjiReturnCode UtilDelta_EmitRead(T_UtilDeltaEncoder *encoder, uint8_t opcode, uint64_t oldOffset,
+                                          const uint8_t *newData, uint64_t len);
+static T_DjiReturnCode UtilDelta_EmitSparseDiff(T_UtilDeltaEncoder *encoder, uint64_t oldOffset,
+                                                const uint8_t *newData, uint64_t len);
+static T_DjiReturnCode UtilDelta_EmitAdd(T_UtilDeltaEncoder *encoder, const uint8_t *data, uint64_t len);
+static T_DjiReturnCode UtilDelta_Reserve(T_UtilDeltaEncoder *encoder, uint32_t len);
+static T_DjiReturnCode UtilDelta_FlushFrame(T_UtilDeltaEncoder *encoder);
+static T_DjiReturnCode UtilDelta_Output(T_UtilDeltaEncoder *encoder, const uint8_t *data, uint32_t len);
+static T_DjiReturnCode UtilDelta_RunFrame(T_UtilDeltaApplier *applier, const uint8_t *raw, uint32_t rawLen);
+static uint8_t *UtilDelta_PutVarint(uint8_t *out, uint64_t value);
+static uint8_t *UtilDelta_PutPaddedVarint(uint8_t *out, uint64_t value);
+static uint8_t *UtilDelta_PutPaddedVarint(uint8_t *out, uint64_t value)
+{
+    uint32_t i;
+
+    for (i = 0; i < UTIL_DELTA_VARINT_MAX_SIZE - 1; i++) {
+        *out++ = (uint8_t) (value | 0x80);
+        value >>= 7;
+    }
+    *out++ = (uint8_t) value;
+
+    return out;
+}
+
+static bool UtilDelta_GetVarint(const uint8_t **in, const uint8_t *end, uint64_t *value);
+static uint8_t *UtilDelta_PutUint32(uint8_t *out, uint32_t value);
+static uint8_t *UtilDelta_PutUint64(uint8_t *out, uint64_t value);
+static uint32_t UtilDelta_GetUint32(const uint8_t *in);
+static uint64_t UtilDelta_GetUint64(const uint8_t *in);
+
+/* Private values ------------------------------------------------------------*/
+
+/* Exported functions definition ---------------------------------------------*/
+void UtilDelta_GetDefaultConfig(T_UtilDeltaConfig *config)
+{
+    config->blockSize = 32;
+    config->frameSize = 1024 * 1024;
+}
+
+T_DjiReturnCode UtilDelta_Create(const T_UtilDeltaConfig *config, const uint8_t *oldData, uint64_t oldSize,
+                                 const uint8_t *newData, uint64_t newSize, UtilDeltaOutputFunc outputFunc,
+                                 void *userData, T_UtilDeltaStatistics *statistics)
+{
+    T_DjiOsalHandler *osalHandler = DjiPlatform_GetOsalHandler();
+    T_UtilDeltaEncoder encoder = {0};
+    T_DjiReturnCode returnCode;
+    uint8_t header[UTIL_DELTA_HEADER_SIZE];
+    uint8_t *out;
+    MD5_CTX md5Ctx;
+    uint32_t *slots = NULL;
+    uint32_t slotBits = 0;
+    uint64_t blockCount;
+    uint64_t literalStart = 0;
+    uint64_t newOffset = 0;
+    uint64_t oldOffset;
+    uint64_t matchLen;
+    uint64_t diffLen;
+    uint64_t scanLen;
+    uint64_t changeCount;
+    int64_t score;
+    int64_t bestScore;
+    int64_t displacement = 0;
+    bool isDisplacementValid = false;
+    bool isMatched;
+    uint32_t blockSize;
+    uint32_t hash = 0;
+    uint32_t hashPower = 1;
+    uint32_t slot;
+    uint64_t i;
+
+    if (config == NULL || outputFunc == NULL || (oldData == NULL && oldSize > 0) || (newData == NULL && newSize > 0) ||
+        config->blockSize < UTIL_DELTA_MIN_BLOCK_SIZE || config->frameSize < UTIL_DELTA_MIN_FRAME_SIZE ||
+        config->frameSize > UTIL_DELTA_FRAME_MAX_SIZE) {
+        return DJI_ERROR_SYSTEM_MODULE_CODE_INVALID_PARAMETER;
+    }
+    blockSize = config->blockSize;
+    blockCount = oldSize / blockSize;
+    if (blockCount >= UINT32_MAX) {
+        return DJI_ERROR_SYSTEM_MODULE_CODE_OUT_OF_RANGE;
+    }
+
+    encoder.config = *config;
+    encoder.outputFunc = outputFunc;
+    encoder.userData = userData;
+    encoder.oldData = oldData;
+    encoder.oldSize = oldSize;
+    encoder.rawBuffer = osalHandler->Malloc(config->frameSize);
+    encoder.frameBuffer = osalHandler->Malloc(UtilLz4_CompressBound(config->frameSize));
+    if (encoder.rawBuffer == NULL || encoder.frameBuffer == NULL) {
+        returnCode = DJI_ERROR_SYSTEM_MODULE_CODE_MEMORY_ALLOC_FAILED;
+        goto out;
+    }
+
+    /* One slot per block rounded up to a power of two, a block whose slot is taken is not indexed. */
+    while (((uint64_t) 1 << slotBits) < blockCount && slotBits < 31) {
+        slotBits++;
+    }
+    if (blockCount > 0) {
+        slots = osalHandler->Malloc((uint32_t) (sizeof(uint32_t) << slotBits));
+        if (slots == NULL) {
+            returnCode = DJI_ERROR_SYSTEM_MODULE_CODE_MEMORY_ALLOC_FAILED;
+            goto out;
+        }
+        memset(slots, 0, sizeof(uint32_t) << slotBits);
+        for (i = 0; i < blockCount; i++) {
+            slot = UtilDelta_GetSlot(UtilDelta_HashBlock(&oldData[i * blockSize], blockSize), slotBits);
+            if (slots[slot] == 0) {
+                slots[slot] = (uint32_t) (i + 1);
+            }
+        }
+    }
+
+    out = UtilDelta_PutUint32(header, UTIL_DELTA_MAGIC);
+    *out++ = (uint8_t) UTIL_DELTA_VERSION;
+    *out++ = 0;
+    *out++ = 0;
+    *out++ = 0;
+    out = UtilDelta_PutUint32(out, config->frameSize);
+    out = UtilDelta_PutUint64(out, oldSize);
+    out = UtilDelta_PutUint64(out, newSize);
+    UtilMd5_Init(&md5Ctx);
+    UtilMd5_Update(&md5Ctx, oldData, oldSize);
+    UtilMd5_Final(&md5Ctx, out);
+    out += UTIL_DELTA_MD5_SIZE;
+    UtilMd5_Init(&md5Ctx);
+    UtilMd5_Update(&md5Ctx, newData, newSize);
+    UtilMd5_Final(&md5Ctx, out);
+    returnCode = UtilDelta_Output(&encoder, header, UTIL_DELTA_HEADER_SIZE);
+    if (returnCode != DJI_ERROR_SYSTEM_MODULE_CODE_SUCCESS) {
+        goto out;
+    }
+
+    for (i = 1; i < blockSize; i++) {
+        hashPower *= UTIL_DELTA_HASH_PRIME;
+    }
+    if (newSize >= blockSize) {
+        hash = UtilDelta_HashBlock(newData, blockSize);
+    }
+
+    while (blockCount > 0 && newOffset + blockSize <= newSize) {
+        /* The old bytes at the displacement of the previous match come first, they follow small edits anywhere,
+         * the index only knows block starts. */
+        isMatched = false;
+        if (isDisplacementValid && (int64_t) newOffset + displacement >= 0 &&
+            (uint64_t) ((int64_t) newOffset + displacement) + blockSize <= oldSize) {
+            oldOffset = (uint64_t) ((int64_t) newOffset + displacement);
+            isMatched = memcmp(&oldData[oldOffset], &newData[newOffset], blockSize) == 0;
+        }
+        if (!isMatched) {
+            slot = slots[UtilDelta_GetSlot(hash, slotBits)];
+            if (slot != 0) {
+                oldOffset = (uint64_t) (slot - 1) * blockSize;
+                isMatched = memcmp(&oldData[oldOffset], &newData[newOffset], blockSize) == 0;
+            }
+        }
+
+        if (!isMatched) {
+            if (newOffset + blockSize < newSize) {
+                hash = (hash - newData[newOffset] * hashPower) * UTIL_DELTA_HASH_PRIME + newData[newOffset + blockSize];
+            }
+            newOffset++;
+            continue;
+        }
+
+        while (newOffset > literalStart && oldOffset > 0 && newData[newOffset - 1] == oldData[oldOffset - 1]) {
+            newOffset--;
+            oldOffset--;
+        }
+        matchLen = blockSize;
+        while (newOffset + matchLen < newSize && oldOffset + matchLen < oldSize &&
+               newData[newOffset + matchLen] == oldData[oldOffset + matchLen]) {
+            matchLen++;
+        }
+
+        returnCode = UtilDelta_EmitAdd(&encoder, &newData[literalStart], newOffset - literalStart);
+        if (returnCode != DJI_ERROR_SYSTEM_MODULE_CODE_SUCCESS) {
+            goto out;
+        }
+        returnCode = UtilDelta_EmitRead(&encoder, UTIL_DELTA_OP_COPY, oldOffset, NULL, matchLen);
+        if (returnCode != DJI_ERROR_SYSTEM_MODULE_CODE_SUCCESS) {
+            goto out;
+        }
+        newOffset += matchLen;
+        oldOffset += matchLen;
+
+        /* Extend past the first difference to the length where matches most exceed mismatches, as bsdiff does. */
+        score = 0;
+        bestScore = 0;
+        diffLen = 0;
+        for (scanLen = 0; newOffset + scanLen < newSize && oldOffset + scanLen < oldSize; scanLen++) {
+            score += newData[newOffset + scanLen] == oldData[oldOffset + scanLen] ? 1 : -1;
+            if (score > bestScore) {
+                bestScore = score;
+                diffLen = scanLen + 1;
+            }
+            if (scanLen + 1 - diffLen >= UTIL_DELTA_DIFF_LOOKAHEAD) {
+                break;
+            }
+        }
+        if (diffLen > 0) {
+            /* Moved addresses change a byte here and there, such a delta is smaller as {gap, delta} pairs. */
+            changeCount = (diffLen - (uint64_t) bestScore) / 2;
+            if (changeCount * 4 < diffLen) {
+                returnCode = UtilDelta_EmitSparseDiff(&encoder, oldOffset, &newData[newOffset], diffLen);
+            } else {
+                returnCode = UtilDelta_EmitRead(&encoder, UTIL_DELTA_OP_DIFF, oldOffset, &newData[newOffset],
+                                                diffLen);
+            }
+            if (returnCode != DJI_ERROR_SYSTEM_MODULE_CODE_SUCCESS) {
+                goto out;
+            }
+            newOffset += diffLen;
+            oldOffset += diffLen;
+        }
+
+        literalStart = newOffset;
+        displacement = (int64_t) oldOffset - (int64_t) newOffset;
+        isDisplacementValid = true;
+        if (newOffset + blockSize <= newSize) {
+            hash = UtilDelta_HashBlock(&newData[newOffset], blockSize);
+        }
+    }
+
+    returnCode = UtilDelta_EmitAdd(&encoder, &newData[literalStart], newSize - literalStart);
+    if (returnCode != DJI_ERROR_SYSTEM_MODULE_CODE_SUCCESS) {
+        goto out;
+    }
+    returnCode = UtilDelta_FlushFrame(&encoder);
+    if (returnCode != DJI_ERROR_SYSTEM_MODULE_CODE_SUCCESS) {
+        goto out;
+    }
+
+    if (statistics != NULL) {
+        *statistics = encoder.statistics;
+    }
+
+out:
+    osalHandler->Free(slots);
+    osalHandler->Free(encoder.frameBuffer);
+    osalHandler->Free(encoder.rawBuffer);
+
+    return returnCode;
+}
+
+T_DjiReturnCode UtilDelta_ParseHeader(const uint8_t *data, uint32_t len, T_UtilDeltaHeader *header)
+{
+    if (data == NULL || header == NULL || len < UTIL_DELTA_HEADER_SIZE) {
+        return DJI_ERROR_SYSTEM_MODULE_CODE_INVALID_PARAMETER;
+    }
+    if (UtilDelta_GetUint32(data) != UTIL_DELTA_MAGIC || data[4] != UTIL_DELTA_VERSION) {
+        return DJI_ERROR_SYSTEM_MODULE_CODE_NONSUPPORT;
+    }
+
+    header->frameSize = UtilDelta_GetUint32(&data[8]);
+    header->oldSize = UtilDelta_GetUint64(&data[12]);
+    header->newSize = UtilDelta_GetUint64(&data[20]);
+    memcpy(header->oldMd5, &data[28], UTIL_DELTA_MD5_SIZE);
+    memcpy(header->newMd5, &data[44], UTIL_DELTA_MD5_SIZE);
+    if (header->frameSize < UTIL_DELTA_MIN_FRAME_SIZE || header->frameSize > UTIL_DELTA_FRAME_MAX_SIZE) {
+        return DJI_ERROR_SYSTEM_MODULE_CODE_OUT_OF_RANGE;
+    }
+
+    return DJI_ERROR_SYSTEM_MODULE_CODE_SUCCESS;
+}
+
+T_DjiReturnCode UtilDelta_ApplierInit(T_UtilDeltaApplier *applier, UtilDeltaReadFunc readOldFunc,
+                                      UtilDeltaOutputFunc outputFunc, void *userData)
+{
+    if (applier == NULL || readOldFunc == NULL || outputFunc == NULL) {
+        return DJI_ERROR_SYSTEM_MODULE_CODE_INVALID_PARAMETER;
+    }
+
+    memset(applier, 0, sizeof(T_UtilDeltaApplier));
+    applier->readOldFunc = readOldFunc;
+    applier->outputFunc = outputFunc;
+    applier->userData = userData;
+    applier->status = DJI_ERROR_SYSTEM_MODULE_CODE_SUCCESS;
+
+    return DJI_ERROR_SYSTEM_MODULE_CODE_SUCCESS;
+}
+
+T_DjiReturnCode UtilDelta_ApplierWrite(T_UtilDeltaApplier *applier, const uint8_t *data, uint32_t len)
+{
+    T_DjiOsalHandler *osalHandler = DjiPlatform_GetOsalHandler();
+    uint32_t copyLen;
+    uint32_t rawLen;
+
+    if (applier == NULL || (data == NULL && len > 0)) {
+        return DJI_ERROR_SYSTEM_MODULE_CODE_INVALID_PARAMETER;
+    }
+
+    while (len > 0 && applier->status == DJI_ERROR_SYSTEM_MODULE_CODE_SUCCESS) {
+        if (applier->headerLen < UTIL_DELTA_HEADER_SIZE) {
+            copyLen = USER_UTIL_MIN(len, UTIL_DELTA_HEADER_SIZE - applier->headerLen);
+            memcpy(&applier->headerBuffer[applier->headerLen], data, copyLen);
+            applier->headerLen += copyLen;
+            data += copyLen;
+            len -= copyLen;
+            if (applier->headerLen < UTIL_DELTA_HEADER_SIZE) {
+                break;
+            }
+
+            applier->status = UtilDelta_ParseHeader(applier->headerBuffer, UTIL_DELTA_HEADER_SIZE, &applier->header);
+            if (applier->status != DJI_ERROR_SYSTEM_MODULE_CODE_SUCCESS) {
+                break;
+            }
+            applier->frameBuffer = osalHandler->Malloc(UtilLz4_CompressBound(applier->header.frameSize));
+            applier->rawBuffer = osalHandler->Malloc(applier->header.frameSize);
+            applier->readBuffer = osalHandler->Malloc(UTIL_DELTA_READ_BUFFER_SIZE);
+            if (applier->frameBuffer == NULL || applier->rawBuffer == NULL || applier->readBuffer == NULL) {
+                applier->status = DJI_ERROR_SYSTEM_MODULE_CODE_MEMORY_ALLOC_FAILED;
+            }
+            continue;
+        }
+
+        if (applier->frameReceivedLen < UTIL_DELTA_FRAME_HEADER_SIZE) {
+            copyLen = USER_UTIL_MIN(len, UTIL_DELTA_FRAME_HEADER_SIZE - applier->frameReceivedLen);
+            memcpy(&applier->frameBuffer[applier->frameReceivedLen], data, copyLen);
+            applier->frameReceivedLen += copyLen;
+            data += copyLen;
+            len -= copyLen;
+            if (applier->frameReceivedLen < UTIL_DELTA_FRAME_HEADER_SIZE) {
+                break;
+            }
+
+            applier->frameRawLen = UtilDelta_GetUint32(applier->frameBuffer);
+            applier->frameDataLen = UtilDelta_GetUint32(&applier->frameBuffer[4]);
+            if (applier->frameRawLen == 0 || applier->frameRawLen > applier->header.frameSize ||
+                applier->frameDataLen > UtilLz4_CompressBound(applier->header.frameSize) ||
+                applier->frameDataLen > applier->frameRawLen + applier->frameRawLen / 255 + 16) {
+                applier->status = DJI_ERROR_SYSTEM_MODULE_CODE_OUT_OF_RANGE;
+                break;
+            }
+        }
+
+        copyLen = USER_UTIL_MIN(len, UTIL_DELTA_FRAME_HEADER_SIZE + applier->frameDataLen - applier->frameReceivedLen);
+        memcpy(&applier->frameBuffer[applier->frameReceivedLen - UTIL_DELTA_FRAME_HEADER_SIZE], data, copyLen);
+        applier->frameReceivedLen += copyLen;
+        data += copyLen;
+        len -= copyLen;
+        if (applier->frameReceivedLen < UTIL_DELTA_FRAME_HEADER_SIZE + applier->frameDataLen) {
+            break;
+        }
+
+        if (applier->frameDataLen == applier->frameRawLen) {
+            applier->status = UtilDelta_RunFrame(applier, applier->frameBuffer, applier->frameRawLen);
+        } else {
+            applier->status = UtilLz4_Decompress(applier->frameBuffer, applier->frameDataLen, applier->rawBuffer,
+                                                 applier->header.frameSize, &rawLen);
+            if (applier->status == DJI_ERROR_SYSTEM_MODULE_CODE_SUCCESS) {
+                applier->status = rawLen == applier->frameRawLen ?
+                                  UtilDelta_RunFrame(applier, applier->rawBuffer, rawLen) :
+                                  DJI_ERROR_SYSTEM_MODULE_CODE_OUT_OF_RANGE;
+            }
+        }
+        applier->frameReceivedLen = 0;
+    }
+
+    return applier->status;
+}
+
+T_DjiReturnCode UtilDelta_ApplierFinish(T_UtilDeltaApplier *applier)
+{
+    if (applier == NULL) {
+        return DJI_ERROR_SYSTEM_MODULE_CODE_INVALID_PARAMETER;
+    }
+    if (applier->status != DJI_ERROR_SYSTEM_MODULE_CODE_SUCCESS) {
+        return applier->status;
+    }
+    if (applier->headerLen < UTIL_DELTA_HEADER_SIZE || applier->frameReceivedLen != 0 ||
+        applier->outputSize != applier->header.newSize) {
+        return DJI_ERROR_SYSTEM_MODULE_CODE_OUT_OF_RANGE;
+    }
+
+    return DJI_ERROR_SYSTEM_MODULE_CODE_SUCCESS;
+}
+
+void UtilDelta_ApplierDeInit(T_UtilDeltaApplier *applier)
+{
+    T_DjiOsalHandler *osalHandler = DjiPlatform_GetOsalHandler();
+
+    if (applier == NULL) {
+        return;
+    }
+
+    osalHandler->Free(applier->frameBuffer);
+    osalHandler->Free(applier->rawBuffer);
+    osalHandler->Free(applier->readBuffer);
+    applier->frameBuffer = NULL;
+    applier->rawBuffer = NULL;
+    applier->readBuffer = NULL;
+}
+
+/* Private functions definition-----------------------------------------------*/
+static uint32_t UtilDelta_HashBlock(const uint8_t *data, uint32_t len)
+{
+    uint32_t hash = 0;
+    uint32_t i;
+
+    for (i = 0; i < len; i++) {
+        hash = hash * UTIL_DELTA_HASH_PRIME + data[i];
+    }
+
+    return hash;
+}
+
+static uint32_t UtilDelta_GetSlot(uint32_t hash, uint32_t slotBits)
+{
+    return slotBits == 0 ? 0 : (hash * 2654435761U) >> (32 - slotBits);
+}
+
+/**
+ * @brief Emit a COPY, or a DIFF of newData against the old bytes, split so no instruction crosses a frame.
+ */
+static T_DjiReturnCode UtilDelta_EmitRead(T_UtilDeltaEncoder *encoder, uint8_t opcode, uint64_t oldOffset,
+                                          const uint8_t *newData, uint64_t len)
+{
+    T_DjiReturnCode returnCode;
+    uint8_t *out;
+    int64_t seek;
+    uint64_t chunkLen;
+    uint64_t i;
+
+    while (len > 0) {
+        returnCode = UtilDelta_Reserve(encoder, UTIL_DELTA_OP_HEADER_MAX_SIZE + (opcode == UTIL_DELTA_OP_DIFF));
+        if (returnCode != DJI_ERROR_SYSTEM_MODULE_CODE_SUCCESS) {
+            return returnCode;
+        }
+
+        chunkLen = len;
+        if (opcode == UTIL_DELTA_OP_DIFF) {
+            chunkLen = USER_UTIL_MIN(len, (uint64_t) (encoder->config.frameSize - encoder->rawLen -
+                                                      UTIL_DELTA_OP_HEADER_MAX_SIZE));
+        }
+
+        seek = (int64_t) oldOffset - (int64_t) encoder->oldOffset;
+        out = &encoder->rawBuffer[encoder->rawLen];
+        *out++ = opcode;
+        out = UtilDelta_PutVarint(out, ((uint64_t) seek << 1) ^ (uint64_t) (seek >> 63));
+        out = UtilDelta_PutVarint(out, chunkLen);
+        if (opcode == UTIL_DELTA_OP_DIFF) {
+            for (i = 0; i < chunkLen; i++) {
+                *out++ = (uint8_t) (newData[i] - encoder->oldData[oldOffset + i]);
+            }
+            newData += chunkLen;
+            encoder->statistics.diffBytes += chunkLen;
+        } else {
+            encoder->statistics.copyBytes += chunkLen;
+        }
+        encoder->rawLen = (uint32_t) (out - encoder->rawBuffer);
+        encoder->statistics.instructionCount++;
+
+        oldOffset += chunkLen;
+        encoder->oldOffset = oldOffset;
+        len -= chunkLen;
+    }
+
+    return DJI_ERROR_SYSTEM_MODULE_CODE_SUCCESS;
+}
+
+/**
+ * @brief Emit SPARSE_DIFF {0x04, seek, len, count, {gap, delta} * count}, gap counts the unchanged bytes before each
+ * changed one. The header varints are padded to a fixed size so they can be written after the pairs.
+ */
+static T_DjiReturnCode UtilDelta_EmitSparseDiff(T_UtilDeltaEncoder *encoder, uint64_t oldOffset,
+                                                const uint8_t *newData, uint64_t len)
+{
+    T_DjiReturnCode returnCode;
+    const uint8_t *oldData;
+    uint8_t *header;
+    uint8_t *out;
+    uint8_t *end;
+    uint64_t pairEnd;
+    uint64_t count;
+    uint64_t pos;
+    int64_t seek;
+    uint8_t delta;
+
+    while (len > 0) {
+        returnCode = UtilDelta_Reserve(encoder, UTIL_DELTA_SPARSE_HEADER_SIZE + UTIL_DELTA_SPARSE_PAIR_MAX_SIZE);
+        if (returnCode != DJI_ERROR_SYSTEM_MODULE_CODE_SUCCESS) {
+            return returnCode;
+        }
+
+        header = &encoder->rawBuffer[encoder->rawLen];
+        out = header + UTIL_DELTA_SPARSE_HEADER_SIZE;
+        end = &encoder->rawBuffer[encoder->config.frameSize];
+        oldData = &encoder->oldData[oldOffset];
+        pairEnd = 0;
+        count = 0;
+        for (pos = 0; pos < len; pos++) {
+            delta = (uint8_t) (newData[pos] - oldData[pos]);
+            if (delta == 0) {
+                continue;
+            }
+            if (end - out < UTIL_DELTA_SPARSE_PAIR_MAX_SIZE) {
+                break;
+            }
+            out = UtilDelta_PutVarint(out, pos - pairEnd);
+            *out++ = delta;
+            pairEnd = pos + 1;
+            count++;
+        }
+
+        seek = (int64_t) oldOffset - (int64_t) encoder->oldOffset;
+        *header++ = UTIL_DELTA_OP_SPARSE_DIFF;
+        header = UtilDelta_PutPaddedVarint(header, ((uint64_t) seek << 1) ^ (uint64_t) (seek >> 63));
+        header = UtilDelta_PutPaddedVarint(header, pos);
+        UtilDelta_PutPaddedVarint(header, count);
+        encoder->rawLen = (uint32_t) (out - encoder->rawBuffer);
+        encoder->statistics.diffBytes += pos;
+        encoder->statistics.instructionCount++;
+
+        oldOffset += pos;
+        encoder->oldOffset = oldOffset;
+        newData += pos;
+        len -= pos;
+    }
+
+    return DJI_ERROR_SYSTEM_MODULE_CODE_SUCCESS;
+}
+
+static T_DjiReturnCode UtilDelta_EmitAdd(T_UtilDeltaEncoder *encoder, const uint8_t *data, uint64_t len)
+{
+    T_DjiReturnCode returnCode;
+    uint8_t *out;
+    uint32_t chunkLen;
+
+    while (len > 0) {
+        returnCode = UtilDelta_Reserve(encoder, UTIL_DELTA_OP_HEADER_MAX_SIZE + 1);
+        if (returnCode != DJI_ERROR_SYSTEM_MODULE_CODE_SUCCESS) {
+            return returnCode;
+        }
+
+        chunkLen = (uint32_t) USER_UTIL_MIN(len, (uint64_t) (encoder->config.frameSize - encoder->rawLen -
+                                                             UTIL_DELTA_OP_HEADER_MAX_SIZE));
+        out = &encoder->rawBuffer[encoder->rawLen];
+        *out++ = UTIL_DELTA_OP_ADD;
+        out = UtilDelta_PutVarint(out, chunkLen);
+        memcpy(out, data, chunkLen);
+        encoder->rawLen = (uint32_t) (out + chunkLen - encoder->rawBuffer);
+        encoder->statistics.addBytes += chunkLen;
+        encoder->statistics.instructionCount++;
+
+        data += chunkLen;
+        len -= chunkLen;
+    }
+
+    return DJI_ERROR_SYSTEM_MODULE_CODE_SUCCESS;
+}
+
+static T_DjiReturnCode UtilDelta_Reserve(T_UtilDeltaEncoder *encoder, uint32_t len)
+{
+    if (encoder->rawLen + len <= encoder->config.frameSize) {
+        return DJI_ERROR_SYSTEM_MODULE_CODE_SUCCESS;
+    }
+
+    return UtilDelta_FlushFrame(encoder);
+}
+
+static T_DjiReturnCode UtilDelta_FlushFrame(T_UtilDeltaEncoder *encoder)
+{
+    T_DjiReturnCode returnCode;
+    uint8_t frameHeader[UTIL_DELTA_FRAME_HEADER_SIZE];
+    const uint8_t *frameData = encoder->frameBuffer;
+    uint32_t frameDataLen;
+
+    if (encoder->rawLen == 0) {
+        return DJI_ERROR_SYSTEM_MODULE_CODE_SUCCESS;
+    }
+
+    returnCode = UtilLz4_Compress(&encoder->lz4Encoder, encoder->rawBuffer, encoder->rawLen, encoder->frameBuffer,
+                                  UtilLz4_CompressBound(encoder->config.frameSize), &frameDataLen);
+    if (returnCode != DJI_ERROR_SYSTEM_MODULE_CODE_SUCCESS || frameDataLen >= encoder->rawLen) {
+        frameData = encoder->rawBuffer;
+        frameDataLen = encoder->rawLen;
+    }
+
+    UtilDelta_PutUint32(UtilDelta_PutUint32(frameHeader, encoder->rawLen), frameDataLen);
+    returnCode = UtilDelta_Output(encoder, frameHeader, sizeof(frameHeader));
+    if (returnCode != DJI_ERROR_SYSTEM_MODULE_CODE_SUCCESS) {
+        return returnCode;
+    }
+    returnCode = UtilDelta_Output(encoder, frameData, frameDataLen);
+    if (returnCode != DJI_ERROR_SYSTEM_MODULE_CODE_SUCCESS) {
+        return returnCode;
+    }
+
+    encoder->rawLen = 0;
+    encoder->statistics.frameCount++;
+
+    return DJI_ERROR_SYSTEM_MODULE_CODE_SUCCESS;
+}
+
+static T_DjiReturnCode UtilDelta_Output(T_UtilDeltaEncoder *encoder, const uint8_t *data, uint32_t len)
+{
+    encoder->statistics.patchSize += len;
+
+    return encoder->outputFunc(encoder->userData, data, len);
+}
+
+static T_DjiReturnCode UtilDelta_RunFrame(T_UtilDeltaApplier *applier, const uint8_t *raw, uint32_t rawLen)
+{
+    T_DjiReturnCode returnCode;
+    const uint8_t *end = raw + rawLen;
+    uint8_t *readBuffer = applier->readBuffer;
+    uint64_t zigzagSeek;
+    uint64_t len;
+    uint64_t pairCount = 0;
+    uint64_t pairPos = 0;
+    uint64_t chunkPos = 0;
+    uint64_t gap;
+    int64_t seek;
+    uint32_t readLen;
+    uint32_t i;
+    uint8_t opcode;
+
+    while (raw < end) {
+        opcode = *raw++;
+        if (opcode == UTIL_DELTA_OP_ADD) {
+            if (!UtilDelta_GetVarint(&raw, end, &len) || len > (uint64_t) (end - raw) ||
+                len > applier->header.newSize - applier->outputSize) {
+                return DJI_ERROR_SYSTEM_MODULE_CODE_OUT_OF_RANGE;
+            }
+            returnCode = applier->outputFunc(applier->userData, raw, (uint32_t) len);
+            if (returnCode != DJI_ERROR_SYSTEM_MODULE_CODE_SUCCESS) {
+                return returnCode;
+            }
+            raw += len;
+            applier->outputSize += len;
+            continue;
+        }
+
+        if ((opcode != UTIL_DELTA_OP_COPY && opcode != UTIL_DELTA_OP_DIFF && opcode != UTIL_DELTA_OP_SPARSE_DIFF) ||
+            !UtilDelta_GetVarint(&raw, end, &zigzagSeek) || !UtilDelta_GetVarint(&raw, end, &len) ||
+            (opcode == UTIL_DELTA_OP_SPARSE_DIFF && (!UtilDelta_GetVarint(&raw, end, &pairCount) || pairCount > len))) {
+            return DJI_ERROR_SYSTEM_MODULE_CODE_OUT_OF_RANGE;
+        }
+        seek = (int64_t) (zigzagSeek >> 1) ^ -(int64_t) (zigzagSeek & 1);
+        if ((seek < 0 && (uint64_t) -seek > applier->oldOffset) ||
+            (seek > 0 && (uint64_t) seek > applier->header.oldSize - applier->oldOffset)) {
+            return DJI_ERROR_SYSTEM_MODULE_CODE_OUT_OF_RANGE;
+        }
+        applier->oldOffset = (uint64_t) ((int64_t) applier->oldOffset + seek);
+        if (len > applier->header.oldSize - applier->oldOffset ||
+            len > applier->header.newSize - applier->outputSize ||
+            (opcode == UTIL_DELTA_OP_DIFF && len > (uint64_t) (end - raw))) {
+            return DJI_ERROR_SYSTEM_MODULE_CODE_OUT_OF_RANGE;
+        }
+
+        /* Position of the next sparse change within the instruction, len when there is none. */
+        chunkPos = 0;
+        pairPos = len;
+        if (pairCount > 0) {
+            if (!UtilDelta_GetVarint(&raw, end, &gap) || gap >= len || raw >= end) {
+                return DJI_ERROR_SYSTEM_MODULE_CODE_OUT_OF_RANGE;
+            }
+            pairPos = gap;
+        }
+
+        while (len > 0) {
+            readLen = (uint32_t) USER_UTIL_MIN(len, (uint64_t) UTIL_DELTA_READ_BUFFER_SIZE);
+            returnCode = applier->readOldFunc(applier->userData, applier->oldOffset, readBuffer, readLen);
+            if (returnCode != DJI_ERROR_SYSTEM_MODULE_CODE_SUCCESS) {
+                return returnCode;
+            }
+            if (opcode == UTIL_DELTA_OP_DIFF) {
+                for (i = 0; i < readLen; i++) {
+                    readBuffer[i] = (uint8_t) (readBuffer[i] + raw[i]);
+                }
+                raw += readLen;
+            }
+            while (opcode == UTIL_DELTA_OP_SPARSE_DIFF && pairCount > 0 && pairPos < chunkPos + readLen) {
+                readBuffer[pairPos - chunkPos] = (uint8_t) (readBuffer[pairPos - chunkPos] + *raw++);
+                if (--pairCount > 0) {
+                    if (!UtilDelta_GetVarint(&raw, end, &gap) || gap >= len + chunkPos - pairPos - 1 || raw >= end) {
+                        return DJI_ERROR_SYSTEM_MODULE_CODE_OUT_OF_RANGE;
+                    }
+                    pairPos += gap + 1;
+                }
+            }
+            chunkPos += readLen;
+            returnCode = applier->outputFunc(applier->userData, readBuffer, readLen);
+            if (returnCode != DJI_ERROR_SYSTEM_MODULE_CODE_SUCCESS) {
+                return returnCode;
+            }
+            applier->oldOffset += readLen;
+            applier->outputSize += readLen;
+            len -= readLen;
+        }
+    }
+
+    return DJI_ERROR_SYSTEM_MODULE_CODE_SUCCESS;
+}
+
+static uint8_t *UtilDelta_PutVarint(uint8_t *out, uint64_t value)
+{
+    while (value >= 0x80) {
+        *out++ = (uint8_t) (value | 0x80);
+        value >>= 7;
+    }
+    *out++ = (uint8_t) value;
+
+    return out;
+}
+
+static bool UtilDelta_GetVarint(const uint8_t **in, const uint8_t *end, uint64_t *value)
+{
+    const uint8_t *p = *in;
+    uint32_t shift = 0;
+
+    *value = 0;
+    while (p < end && shift < 64) {
+        *value |= (uint64_t) (*p & 0x7F) << shift;
+        if ((*p++ & 0x80) == 0) {
+            *in = p;
+            return true;
+        }
+        shift += 7;
+    }
+
+    return false;
+}
+
+static uint8_t *UtilDelta_PutUint32(uint8_t *out, uint32_t value)
+{
+    out[0] = (uint8_t) value;
+    out[1] = (uint8_t) (value >> 8);
+    out[2] = (uint8_t) (value >> 16);
+    out[3] = (uint8_t) (value >> 24);
+
+    return out + 4;
+}
+
+static uint8_t *UtilDelta_PutUint64(uint8_t *out, uint64_t value)
+{
+    return UtilDelta_PutUint32(UtilDelta_PutUint32(out, (uint32_t) value), (uint32_t) (value >> 32));
+}
+
+static uint32_t UtilDelta_GetUint32(const uint8_t *in)
+{
+    return (uint32_t) in[0] | ((uint32_t) in[1] << 8) | ((uint32_t) in[2] << 16) | ((uint32_t) in[3] << 24);
+}
+
+static uint64_t UtilDelta_GetUint64(const uint8_t *in)
+{
+    return (uint64_t) UtilDelta_GetUint32(in) | ((uint64_t) UtilDelta_GetUint32(&in[4]) << 32);
+}
+
+/****************** (C) COPYRIGHT DJI Innovations *****END OF FILE****/
@@ -0,0 +1,133 @@
+/**
+ ******************************************************************************
+ * @file    util_delta.h
+ * @brief   This is the header file for "util_delta.c", defining the binary patch format.
+ *
+ * @copyright (c) 2021 DJI. All rights reserved.
+ *
+ * All information contained herein is, and remains, the property of DJI.
+ * The intellectual and technical concepts contained herein are proprietary
+ * to DJI and may be covered by U.S. and foreign patents, patents in process,
+ * and protected by trade secret or copyright law.  Dissemination of this
+ * information, including but not limited to data and other proprietary
+ * material(s) incorporated within the information, in any form, is strictly
+ * prohibited without the express written consent of DJI.
+ *
+ * If you receive this source code without DJI’s authorization, you may not
+ * further disseminate the information, and you must immediately remove the
+ * source code and notify DJI of its removal. DJI reserves the right to pursue
+ * legal actions against you for any loss(es) or damage(s) caused by your
+ * failure to do so.
+ *
+ ******************************************************************************
+ */
+
+
+/* Define to prevent recursive inclusion -------------------------------------*/
+#ifndef UTIL_DELTA_H
+#define UTIL_DELTA_H
+
+/* Includes ------------------------------------------------------------------*/
+#include "dji_typedef.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Exported constants --------------------------------------------------------*/
+#define UTIL_DELTA_HEADER_SIZE                  60
+#define UTIL_DELTA_FRAME_HEADER_SIZE            8
+#define UTIL_DELTA_FRAME_MAX_SIZE               (4 * 1024 * 1024)
+#define UTIL_DELTA_MD5_SIZE                     16
+#define UTIL_DELTA_READ_BUFFER_SIZE             (64 * 1024)
+
+/* Exported types ------------------------------------------------------------*/
+/**
+ * @brief Patch header, stored little endian as {magic "DJDL", version u16, reserved u16, frameSize u32, oldSize u64,
+ * newSize u64, oldMd5[16], newMd5[16]}.
+ * @note The header is followed by frames of {rawLen u32, dataLen u32, data}, data is an LZ4 block of rawLen bytes or
+ * the raw bytes when dataLen equals rawLen. The raw bytes of a frame are whole instructions:
+ * COPY {0x01, seek, len} and DIFF {0x02, seek, len, delta[len]} read len bytes of the old image at the end of the
+ * previous read plus the zigzag varint seek, DIFF adds delta to them byte by byte. ADD {0x03, len, data[len]} outputs
+ * new bytes. SPARSE_DIFF {0x04, seek, len, count, {gap, delta} * count} reads like DIFF but adds only count deltas,
+ * each after gap unchanged bytes. Lengths are varints.
+ */
+typedef struct {
+    uint32_t frameSize;             /*!< Largest rawLen of the patch. */
+    uint64_t oldSize;
+    uint64_t newSize;
+    uint8_t oldMd5[UTIL_DELTA_MD5_SIZE];
+    uint8_t newMd5[UTIL_DELTA_MD5_SIZE];
+} T_UtilDeltaHeader;
+
+typedef T_DjiReturnCode (*UtilDeltaOutputFunc)(void *userData, const uint8_t *data, uint32_t len);
+typedef T_DjiReturnCode (*UtilDeltaReadFunc)(void *userData, uint64_t offset, uint8_t *data, uint32_t len);
+
+typedef struct {
+    uint32_t blockSize;             /*!< Bytes per index entry of the old image, shorter matches are not found. */
+    uint32_t frameSize;             /*!< Raw instruction bytes per frame, the applier buffers one frame. */
+} T_UtilDeltaConfig;
+
+typedef struct {
+    uint64_t copyBytes;             /*!< New bytes taken unchanged from the old image. */
+    uint64_t diffBytes;             /*!< New bytes taken from mostly equal old bytes plus a delta. */
+    uint64_t addBytes;              /*!< New bytes without a match in the old image. */
+    uint32_t instructionCount;
+    uint32_t frameCount;
+    uint64_t patchSize;
+} T_UtilDeltaStatistics;
+
+/**
+ * @brief Rebuilds the new image from a patch streamed in pieces of any size and random reads of the old image.
+ * @note The new image is output in order, in pieces of at most one frame. The applier checks every length and offset
+ * against the header, but it does not hash the output: the caller verifies it against newMd5, usually while storing
+ * it. Memory is two frames and the read buffer, allocated when the header arrives. The applier is not thread-safe.
+ */
+typedef struct {
+    T_UtilDeltaHeader header;
+    UtilDeltaReadFunc readOldFunc;
+    UtilDeltaOutputFunc outputFunc;
+    void *userData;
+    uint8_t headerBuffer[UTIL_DELTA_HEADER_SIZE];
+    uint32_t headerLen;
+    uint32_t frameRawLen;
+    uint32_t frameDataLen;
+    uint32_t frameReceivedLen;      /*!< Bytes of the current frame received, its header included. */
+    uint8_t *frameBuffer;
+    uint8_t *rawBuffer;
+    uint8_t *readBuffer;            /*!< Old bytes of a COPY or DIFF, UTIL_DELTA_READ_BUFFER_SIZE at a time. */
+    uint64_t oldOffset;
+    uint64_t outputSize;
+    T_DjiReturnCode status;         /*!< First error met, every later call returns it. */
+} T_UtilDeltaApplier;
+
+/* Exported functions --------------------------------------------------------*/
+void UtilDelta_GetDefaultConfig(T_UtilDeltaConfig *config);
+
+/**
+ * @brief Write the patch turning oldData into newData to outputFunc.
+ * @note Blocks of the old image are indexed by a rolling hash, the new image is scanned for them and every match is
+ * extended byte by byte, then past small changes as a DIFF while more than half the bytes still match, which keeps
+ * code whose addresses moved small after compression. The index takes 4 bytes per block of the old image.
+ */
+T_DjiReturnCode UtilDelta_Create(const T_UtilDeltaConfig *config, const uint8_t *oldData, uint64_t oldSize,
+                                 const uint8_t *newData, uint64_t newSize, UtilDeltaOutputFunc outputFunc,
+                                 void *userData, T_UtilDeltaStatistics *statistics);
+
+T_DjiReturnCode UtilDelta_ParseHeader(const uint8_t *data, uint32_t len, T_UtilDeltaHeader *header);
+
+T_DjiReturnCode UtilDelta_ApplierInit(T_UtilDeltaApplier *applier, UtilDeltaReadFunc readOldFunc,
+                                      UtilDeltaOutputFunc outputFunc, void *userData);
+T_DjiReturnCode UtilDelta_ApplierWrite(T_UtilDeltaApplier *applier, const uint8_t *data, uint32_t len);
+/**
+ * @brief Check the patch ended on a frame boundary with the whole new image output.
+ */
+T_DjiReturnCode UtilDelta_ApplierFinish(T_UtilDeltaApplier *applier);
+void UtilDelta_ApplierDeInit(T_UtilDeltaApplier *applier);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // UTIL_DELTA_H
+/************************ (C) COPYRIGHT DJI Innovations *******END OF FILE******/
@@ -0,0 +1,133 @@
+/**
+ ******************************************************************************
+ * @file    util_dlist.c
+ * @brief   Intrusive doubly linked list with a sentinel head.
+ *
+ * @copyright (c) 2021 DJI. All rights reserved.
+ *
+ * All information contained herein is, and remains, the property of DJI.
+ * The intellectual and technical concepts contained herein are proprietary
+ * to DJI and may be covered by U.S. and foreign patents, patents in process,
+ * and protected by trade secret or copyright law.  Dissemination of this
+ * information, including but not limited to data and other proprietary
+ * material(s) incorporated within the information, in any form, is strictly
+ * prohibited without the express written consent of DJI.
+ *
+ * If you receive this source code without DJI’s authorization, you may not
+ * further disseminate the information, and you must immediately remove the
+ * source code and notify DJI of its removal. DJI reserves the right to pursue
+ * legal actions against you for any loss(es) or damage(s) caused by your
+ * failure to do so.
+ *
+ ******************************************************************************
+ */
+
+
+/* Includes ------------------------------------------------------------------*/
+#include "util_dlist.h"
+
+/* Private constants ---------------------------------------------------------*/
+
+/* Private types -------------------------------------------------------------*/
+
+/* Private functions declaration ---------------------------------------------*/
+static void UtilDlist_Link(T_UtilDlistNode *prev, T_UtilDlistNode *next, T_UtilDlistNode *node);
+
+/* Private values ------------------------------------------------------------*/
+
+/* Exported functions definition ---------------------------------------------*/
+void UtilDlist_Init(T_UtilDlist *list)
+{
+    list->head.next = &list->head;
+    list->head.prev = &list->head;
+    list->count = 0;
+}
+
+void UtilDlist_InitNode(T_UtilDlistNode *node)
+{
+    node->next = NULL;
+    node->prev = NULL;
+}
+
+bool UtilDlist_IsEmpty(const T_UtilDlist *list)
+{
+    return list->head.next == &list->head;
+}
+
+bool UtilDlist_IsLinked(const T_UtilDlistNode *node)
+{
+    return node->next != NULL;
+}
+
+uint32_t UtilDlist_GetCount(const T_UtilDlist *list)
+{
+    return list->count;
+}
+
+void UtilDlist_AddFirst(T_UtilDlist *list, T_UtilDlistNode *node)
+{
+    UtilDlist_Link(&list->head, list->head.next, node);
+    list->count++;
+}
+
+void UtilDlist_AddLast(T_UtilDlist *list, T_UtilDlistNode *node)
+{
+    UtilDlist_Link(list->head.prev, &list->head, node);
+    list->count++;
+}
+
+void UtilDlist_InsertBefore(T_UtilDlist *list, T_UtilDlistNode *position, T_UtilDlistNode *node)
+{
+    UtilDlist_Link(position->prev, position, node);
+    list->count++;
+}
+
+void UtilDlist_Remove(T_UtilDlist *list, T_UtilDlistNode *node)
+{
+    if (!UtilDlist_IsLinked(node)) {
+        return;
+    }
+
+    node->prev->next = node->next;
+    node->next->prev = node->prev;
+    UtilDlist_InitNode(node);
+    list->count--;
+}
+
+T_UtilDlistNode *UtilDlist_GetFirst(const T_UtilDlist *list)
+{
+    return UtilDlist_IsEmpty(list) ? NULL : list->head.next;
+}
+
+T_UtilDlistNode *UtilDlist_GetLast(const T_UtilDlist *list)
+{
+    return UtilDlist_IsEmpty(list) ? NULL : list->head.prev;
+}
+
+T_UtilDlistNode *UtilDlist_RemoveFirst(T_UtilDlist *list)
+{
+    T_UtilDlistNode *node = UtilDlist_GetFirst(list);
+
+    if (node != NULL) {
+        UtilDlist_Remove(list, node);
+    }
+
+    return node;
+}
+
+void UtilDlist_MoveLast(T_UtilDlist *list, T_UtilDlistNode *node)
+{
+    UtilDlist_Remove(list, node);
+    UtilDlist_AddLast(list, node);
+}
+
+/* Private functions definition-----------------------------------------------*/
+static void UtilDlist_Link(T_UtilDlistNode *prev, T_UtilDlistNode *next, T_UtilDlistNode *node)
+{
+    node->prev = prev;
+    node->next = next;
+    prev->next = node;
+    next->prev = node;
+}
+
+/****************** (C) COPYRIGHT DJI Innovations *****END OF FILE****/
@@ -0,0 +1,86 @@
+/**
+ ******************************************************************************
+ * @file    util_dlist.h
+ * @brief   This is the header file for "util_dlist.c", defining the intrusive doubly linked list.
+ *
+ * @copyright (c) 2021 DJI. All rights reserved.
+ *
+ * All information contained herein is, and remains, the property of DJI.
+ * The intellectual and technical concepts contained herein are proprietary
+ * to DJI and may be covered by U.S. and foreign patents, patents in process,
+ * and protected by trade secret or copyright law.  Dissemination of this
+ * information, including but not limited to data and other proprietary
+ * material(s) incorporated within the information, in any form, is strictly
+ * prohibited without the express written consent of DJI.
+ *
+ * If you receive this source code without DJI’s authorization, you may not
+ * further disseminate the information, and you must immediately remove the
+ * source code and notify DJI of its removal. DJI reserves the right to pursue
+ * legal actions against you for any loss(es) or damage(s) caused by your
+ * failure to do so.
+ *
+ ******************************************************************************
+ */
+
+
+/* Define to prevent recursive inclusion -------------------------------------*/
+#ifndef UTIL_DLIST_H
+#define UTIL_DLIST_H
+
+/* Includes ------------------------------------------------------------------*/
+#include <stddef.h>
+#include "dji_typedef.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Exported constants --------------------------------------------------------*/
+/**
+ * @brief Get the object that embeds the list node "node" as its member "member".
+ */
+#define UTIL_DLIST_ENTRY(node, type, member)   ((type *) ((uint8_t *) (node) - offsetof(type, member)))
+
+/**
+ * @brief Iterate the list from first to last. The current node may be removed inside the loop body, "next" is
+ * fetched before the body runs.
+ */
+#define UTIL_DLIST_FOR_EACH_SAFE(list, node, next) \
+    for ((node) = (list)->head.next, (next) = (node)->next; (node) != &(list)->head; \
+         (node) = (next), (next) = (node)->next)
+
+/* Exported types ------------------------------------------------------------*/
+/**
+ * @brief List node embedded in the user object, the list itself never allocates.
+ */
+typedef struct T_UtilDlistNode {
+    struct T_UtilDlistNode *next;
+    struct T_UtilDlistNode *prev;
+} T_UtilDlistNode;
+
+typedef struct {
+    T_UtilDlistNode head;
+    uint32_t count;
+} T_UtilDlist;
+
+/* Exported functions --------------------------------------------------------*/
+void UtilDlist_Init(T_UtilDlist *list);
+void UtilDlist_InitNode(T_UtilDlistNode *node);
+bool UtilDlist_IsEmpty(const T_UtilDlist *list);
+bool UtilDlist_IsLinked(const T_UtilDlistNode *node);
+uint32_t UtilDlist_GetCount(const T_UtilDlist *list);
+void UtilDlist_AddFirst(T_UtilDlist *list, T_UtilDlistNode *node);
+void UtilDlist_AddLast(T_UtilDlist *list, T_UtilDlistNode *node);
+void UtilDlist_InsertBefore(T_UtilDlist *list, T_UtilDlistNode *position, T_UtilDlistNode *node);
+void UtilDlist_Remove(T_UtilDlist *list, T_UtilDlistNode *node);
+T_UtilDlistNode *UtilDlist_GetFirst(const T_UtilDlist *list);
+T_UtilDlistNode *UtilDlist_GetLast(const T_UtilDlist *list);
+T_UtilDlistNode *UtilDlist_RemoveFirst(T_UtilDlist *list);
+void UtilDlist_MoveLast(T_UtilDlist *list, T_UtilDlistNode *node);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // UTIL_DLIST_H
+/************************ (C) COPYRIGHT DJI Innovations *******END OF FILE******/
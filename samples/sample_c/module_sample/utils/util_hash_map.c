@@ -0,0 +1,271 @@
+/**
+ ******************************************************************************
+ * @file    util_hash_map.c
+ * @brief   Open-addressing hash map with linear probing and backward-shift deletion.
+ *
+ * @copyright (c) 2021 DJI. All rights reserved.
+ *
+ * All information contained herein is, and remains, the property of DJI.
+ * The intellectual and technical concepts contained herein are proprietary
+ * to DJI and may be covered by U.S. and foreign patents, patents in process,
+ * and protected by trade secret or copyright law.  Dissemination of this
+ * information, including but not limited to data and other proprietary
+ * material(s) incorporated within the information, in any form, is strictly
+ * prohibited without the express written consent of DJI.
+ *
+ * If you receive this source code without DJI’s authorization, you may not
+ * further disseminate the information, and you must immediately remove the
+ * source code and notify DJI of its removal. DJI reserves the right to pursue
+ * legal actions against you for any loss(es) or damage(s) caused by your
+ * failure to do so.
+ *
+ ******************************************************************************
+ */
+
+
+/* Includes ------------------------------------------------------------------*/
+#include "util_hash_map.h"
+#include <string.h>
+
+/* Private constants ---------------------------------------------------------*/
+#define UTIL_HASH_MAP_MIN_CAPACITY          8
+#define UTIL_HASH_MAP_FNV_OFFSET_BASIS      0xCBF29CE484222325ULL
+#define UTIL_HASH_MAP_FNV_PRIME             0x00000100000001B3ULL
+
+/* Private types -------------------------------------------------------------*/
+
+/* Private functions declaration ---------------------------------------------*/
+static uint32_t UtilHashMap_GetHome(const T_UtilHashMap *map, uint64_t key);
+static bool UtilHashMap_FindSlot(const T_UtilHashMap *map, uint64_t key, uint32_t *slot);
+static void UtilHashMap_RemoveSlot(T_UtilHashMap *map, uint32_t slot);
+
+/* Private values ------------------------------------------------------------*/
+
+/* Exported functions definition ---------------------------------------------*/
+size_t UtilHashMap_GetMemorySize(uint32_t maxCount)
+{
+    uint32_t capacity = UTIL_HASH_MAP_MIN_CAPACITY;
+
+    while (capacity - capacity / 8 < maxCount && capacity < 0x80000000U) {
+        capacity <<= 1;
+    }
+
+    return (size_t) capacity * sizeof(T_UtilHashMapEntry);
+}
+
+T_DjiReturnCode UtilHashMap_Init(T_UtilHashMap *map, void *memory, size_t memorySize)
+{
+    size_t slotNum;
+    uint32_t capacity = UTIL_HASH_MAP_MIN_CAPACITY;
+
+    if (map == NULL || memory == NULL || ((uintptr_t) memory % sizeof(uint64_t)) != 0) {
+        return DJI_ERROR_SYSTEM_MODULE_CODE_INVALID_PARAMETER;
+    }
+
+    slotNum = memorySize / sizeof(T_UtilHashMapEntry);
+    if (slotNum < UTIL_HASH_MAP_MIN_CAPACITY) {
+        return DJI_ERROR_SYSTEM_MODULE_CODE_INVALID_PARAMETER;
+    }
+
+    /* Round down to a power of two so the probe index is a mask instead of a division. */
+    while ((size_t) capacity * 2 <= slotNum && capacity < 0x80000000U) {
+        capacity <<= 1;
+    }
+
+    map->entries = memory;
+    map->capacity = capacity;
+    map->mask = capacity - 1;
+    map->maxCount = capacity - capacity / 8;
+    UtilHashMap_Clear(map);
+
+    return DJI_ERROR_SYSTEM_MODULE_CODE_SUCCESS;
+}
+
+void UtilHashMap_Clear(T_UtilHashMap *map)
+{
+    memset(map->entries, 0, (size_t) map->capacity * sizeof(T_UtilHashMapEntry));
+    map->count = 0;
+}
+
+uint32_t UtilHashMap_GetCount(const T_UtilHashMap *map)
+{
+    return map->count;
+}
+
+T_DjiReturnCode UtilHashMap_Put(T_UtilHashMap *map, uint64_t key, void *value)
+{
+    uint32_t slot;
+
+    if (value == NULL) {
+        return DJI_ERROR_SYSTEM_MODULE_CODE_INVALID_PARAMETER;
+    }
+
+    if (UtilHashMap_FindSlot(map, key, &slot)) {
+        map->entries[slot].value = value;
+        return DJI_ERROR_SYSTEM_MODULE_CODE_SUCCESS;
+    }
+
+    if (map->count >= map->maxCount) {
+        return DJI_ERROR_SYSTEM_MODULE_CODE_OUT_OF_RANGE;
+    }
+
+    map->entries[slot].key = key;
+    map->entries[slot].value = value;
+    map->count++;
+
+    return DJI_ERROR_SYSTEM_MODULE_CODE_SUCCESS;
+}
+
+void *UtilHashMap_Get(const T_UtilHashMap *map, uint64_t key)
+{
+    uint32_t slot;
+
+    if (!UtilHashMap_FindSlot(map, key, &slot)) {
+        return NULL;
+    }
+
+    return map->entries[slot].value;
+}
+
+void *UtilHashMap_Remove(T_UtilHashMap *map, uint64_t key)
+{
+    uint32_t slot;
+    void *value;
+
+    if (!UtilHashMap_FindSlot(map, key, &slot)) {
+        return NULL;
+    }
+
+    value = map->entries[slot].value;
+    UtilHashMap_RemoveSlot(map, slot);
+
+    return value;
+}
+
+void UtilHashMap_IteratorInit(const T_UtilHashMap *map, T_UtilHashMapIterator *iterator)
+{
+    uint32_t slot = 0;
+
+    /*
+     * Walk the table backwards starting from a free slot. Backward-shift deletion only moves entries towards lower
+     * slots inside one cluster and never across a free slot, so removing the current entry can only pull in entries
+     * that were already visited.
+     */
+    while (map->entries[slot].value != NULL) {
+        slot = (slot + 1) & map->mask;
+    }
+
+    iterator->start = slot;
+    iterator->position = slot;
+    iterator->isValid = false;
+}
+
+bool UtilHashMap_IteratorNext(const T_UtilHashMap *map, T_UtilHashMapIterator *iterator, uint64_t *key,
+                              void **value)
+{
+    for (;;) {
+        iterator->position = (iterator->position - 1) & map->mask;
+        if (iterator->position == iterator->start) {
+            iterator->isValid = false;
+            return false;
+        }
+
+        if (map->entries[iterator->position].value != NULL) {
+            break;
+        }
+    }
+
+    iterator->isValid = true;
+    if (key != NULL) {
+        *key = map->entries[iterator->position].key;
+    }
+    if (value != NULL) {
+        *value = map->entries[iterator->position].value;
+    }
+
+    return true;
+}
+
+void *UtilHashMap_RemoveCurrent(T_UtilHashMap *map, T_UtilHashMapIterator *iterator)
+{
+    void *value;
+
+    if (!iterator->isValid) {
+        return NULL;
+    }
+
+    value = map->entries[iterator->position].value;
+    UtilHashMap_RemoveSlot(map, iterator->position);
+    iterator->isValid = false;
+
+    return value;
+}
+
+uint64_t UtilHashMap_HashString(const char *str)
+{
+    uint64_t hash = UTIL_HASH_MAP_FNV_OFFSET_BASIS;
+
+    while (*str != '\0') {
+        hash ^= (uint8_t) *str++;
+        hash *= UTIL_HASH_MAP_FNV_PRIME;
+    }
+
+    return hash;
+}
+
+/* Private functions definition-----------------------------------------------*/
+static uint32_t UtilHashMap_GetHome(const T_UtilHashMap *map, uint64_t key)
+{
+    /* Finalizer of MurmurHash3, sequential ids such as file indexes would otherwise build one long cluster. */
+    key ^= key >> 33;
+    key *= 0xFF51AFD7ED558CCDULL;
+    key ^= key >> 33;
+    key *= 0xC4CEB9FE1A85EC53ULL;
+    key ^= key >> 33;
+
+    return (uint32_t) key & map->mask;
+}
+
+static bool UtilHashMap_FindSlot(const T_UtilHashMap *map, uint64_t key, uint32_t *slot)
+{
+    uint32_t index = UtilHashMap_GetHome(map, key);
+
+    while (map->entries[index].value != NULL) {
+        if (map->entries[index].key == key) {
+            *slot = index;
+            return true;
+        }
+        index = (index + 1) & map->mask;
+    }
+
+    *slot = index;
+    return false;
+}
+
+static void UtilHashMap_RemoveSlot(T_UtilHashMap *map, uint32_t slot)
+{
+    uint32_t hole = slot;
+    uint32_t index = slot;
+
+    /* Pull later entries of the cluster back into the hole, no tombstones are left behind. */
+    for (;;) {
+        uint32_t home;
+
+        index = (index + 1) & map->mask;
+        if (map->entries[index].value == NULL) {
+            break;
+        }
+
+        home = UtilHashMap_GetHome(map, map->entries[index].key);
+        if (((index - home) & map->mask) >= ((index - hole) & map->mask)) {
+            map->entries[hole] = map->entries[index];
+            hole = index;
+        }
+    }
+
+    map->entries[hole].key = 0;
+    map->entries[hole].value = NULL;
+    map->count--;
+}
+
+/****************** (C) COPYRIGHT DJI Innovations *****END OF FILE****/
@@ -0,0 +1,89 @@
+/**
+ ******************************************************************************
+ * @file    util_hash_map.h
+ * @brief   This is the header file for "util_hash_map.c", defining the open-addressing hash map.
+ *
+ * @copyright (c) 2021 DJI. All rights reserved.
+ *
+ * All information contained herein is, and remains, the property of DJI.
+ * The intellectual and technical concepts contained herein are proprietary
+ * to DJI and may be covered by U.S. and foreign patents, patents in process,
+ * and protected by trade secret or copyright law.  Dissemination of this
+ * information, including but not limited to data and other proprietary
+ * material(s) incorporated within the information, in any form, is strictly
+ * prohibited without the express written consent of DJI.
+ *
+ * If you receive this source code without DJI’s authorization, you may not
+ * further disseminate the information, and you must immediately remove the
+ * source code and notify DJI of its removal. DJI reserves the right to pursue
+ * legal actions against you for any loss(es) or damage(s) caused by your
+ * failure to do so.
+ *
+ ******************************************************************************
+ */
+
+
+/* Define to prevent recursive inclusion -------------------------------------*/
+#ifndef UTIL_HASH_MAP_H
+#define UTIL_HASH_MAP_H
+
+/* Includes ------------------------------------------------------------------*/
+#include <stddef.h>
+#include "dji_typedef.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Exported constants --------------------------------------------------------*/
+
+/* Exported types ------------------------------------------------------------*/
+typedef struct {
+    uint64_t key;
+    void *value;                    /*!< NULL marks a free slot, so NULL values can not be stored. */
+} T_UtilHashMapEntry;
+
+/**
+ * @brief Hash map from 64-bit keys to object pointers on a fixed slot table supplied by the caller.
+ * @note The map never allocates and never grows, the objects usually come from a T_UtilPool. At most 7/8 of the
+ * slots are filled so a probe always ends on a free slot. The map is not thread-safe.
+ */
+typedef struct {
+    T_UtilHashMapEntry *entries;
+    uint32_t capacity;
+    uint32_t mask;
+    uint32_t count;
+    uint32_t maxCount;
+} T_UtilHashMap;
+
+/**
+ * @brief Iteration cursor, UtilHashMap_RemoveCurrent is the only modification allowed while iterating.
+ */
+typedef struct {
+    uint32_t start;
+    uint32_t position;
+    bool isValid;
+} T_UtilHashMapIterator;
+
+/* Exported functions --------------------------------------------------------*/
+size_t UtilHashMap_GetMemorySize(uint32_t maxCount);
+T_DjiReturnCode UtilHashMap_Init(T_UtilHashMap *map, void *memory, size_t memorySize);
+void UtilHashMap_Clear(T_UtilHashMap *map);
+uint32_t UtilHashMap_GetCount(const T_UtilHashMap *map);
+T_DjiReturnCode UtilHashMap_Put(T_UtilHashMap *map, uint64_t key, void *value);
+void *UtilHashMap_Get(const T_UtilHashMap *map, uint64_t key);
+void *UtilHashMap_Remove(T_UtilHashMap *map, uint64_t key);
+
+void UtilHashMap_IteratorInit(const T_UtilHashMap *map, T_UtilHashMapIterator *iterator);
+bool UtilHashMap_IteratorNext(const T_UtilHashMap *map, T_UtilHashMapIterator *iterator, uint64_t *key,
+                              void **value);
+void *UtilHashMap_RemoveCurrent(T_UtilHashMap *map, T_UtilHashMapIterator *iterator);
+
+uint64_t UtilHashMap_HashString(const char *str);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // UTIL_HASH_MAP_H
+/************************ (C) COPYRIGHT DJI Innovations *******END OF FILE******/
@@ -0,0 +1,266 @@
+/**
+ ******************************************************************************
+ * @file    util_lz4.c
+ * @brief   LZ4 block format compressor and bounds-checked decompressor.
+ *
+ * @copyright (c) 2021 DJI. All rights reserved.
+ *
+ * All information contained herein is, and remains, the property of DJI.
+ * The intellectual and technical concepts contained herein are proprietary
+ * to DJI and may be covered by U.S. and foreign patents, patents in process,
+ * and protected by trade secret or copyright law.  Dissemination of this
+ * information, including but not limited to data and other proprietary
+ * material(s) incorporated within the information, in any form, is strictly
+ * prohibited without the express written consent of DJI.
+ *
+ * If you receive this source code without DJI’s authorization, you may not
+ * further disseminate the information, and you must immediately remove the
+ * source code and notify DJI of its removal. DJI reserves the right to pursue
+ * legal actions against you for any loss(es) or damage(s) caused by your
+ * failure to do so.
+ *
+ ******************************************************************************
+ */
+
+
+/* Includes ------------------------------------------------------------------*/
+#include "util_lz4.h"
+#include <string.h>
+#include "util_misc.h"
+
+/* Private constants ---------------------------------------------------------*/
+#define UTIL_LZ4_HASH_SIZE                  (1U << UTIL_LZ4_HASH_BITS)
+#define UTIL_LZ4_MIN_MATCH                  4
+#define UTIL_LZ4_MAX_OFFSET                 65535
+#define UTIL_LZ4_LAST_LITERALS              5       /* The block always ends with at least this many literals. */
+#define UTIL_LZ4_MATCH_FIND_LIMIT           12      /* No match starts in the last bytes of the block. */
+#define UTIL_LZ4_RUN_MASK                   15
+#define UTIL_LZ4_SKIP_TRIGGER               6       /* Step grows by one every 64 bytes without a match. */
+
+/* Private types -------------------------------------------------------------*/
+
+/* Private functions declaration ---------------------------------------------*/
+static uint32_t UtilLz4_Read32(const uint8_t *data);
+static uint32_t UtilLz4_Hash(uint32_t sequence);
+static uint8_t *UtilLz4_PutLength(uint8_t *op, uint32_t length);
+static uint8_t *UtilLz4_PutSequence(uint8_t *op, const uint8_t *literal, uint32_t literalLen, uint32_t offset,
+                                    uint32_t matchLen);
+
+/* Private values ------------------------------------------------------------*/
+
+/* Exported functions definition ---------------------------------------------*/
+uint32_t UtilLz4_CompressBound(uint32_t srcLen)
+{
+    return srcLen + srcLen / 255 + 16;
+}
+
+T_DjiReturnCode UtilLz4_Compress(T_UtilLz4Encoder *encoder, const uint8_t *src, uint32_t srcLen, uint8_t *dst,
+                                 uint32_t dstCapacity, uint32_t *dstLen)
+{
+    const uint8_t *ip = src;
+    const uint8_t *anchor = src;
+    const uint8_t *matchFindLimit = src + srcLen - UTIL_LZ4_MATCH_FIND_LIMIT;
+    const uint8_t *matchLimit = src + srcLen - UTIL_LZ4_LAST_LITERALS;
+    const uint8_t *ref;
+    uint8_t *op = dst;
+    uint32_t sequence;
+    uint32_t hash;
+    uint32_t matchLen;
+    uint32_t literalLen;
+    uint32_t searchCount;
+
+    if (encoder == NULL || (src == NULL && srcLen != 0) || dst == NULL || dstLen == NULL ||
+        srcLen > UTIL_LZ4_MAX_INPUT_SIZE || dstCapacity < UtilLz4_CompressBound(srcLen)) {
+        return DJI_ERROR_SYSTEM_MODULE_CODE_INVALID_PARAMETER;
+    }
+
+    if (srcLen >= UTIL_LZ4_MATCH_FIND_LIMIT + 1) {
+        /* Positions are stored relative to src, a stale entry only costs one failed compare. */
+        memset(encoder->hashTable, 0, sizeof(encoder->hashTable));
+        searchCount = 1U << UTIL_LZ4_SKIP_TRIGGER;
+        ip++;
+
+        while (ip < matchFindLimit) {
+            sequence = UtilLz4_Read32(ip);
+            hash = UtilLz4_Hash(sequence);
+            ref = src + encoder->hashTable[hash];
+            encoder->hashTable[hash] = (uint32_t) (ip - src);
+
+            if (ip - ref > UTIL_LZ4_MAX_OFFSET || ref >= ip || UtilLz4_Read32(ref) != sequence) {
+                ip += searchCount++ >> UTIL_LZ4_SKIP_TRIGGER;
+                continue;
+            }
+
+            while (ip > anchor && ref > src && ip[-1] == ref[-1]) {
+                ip--;
+                ref--;
+            }
+
+            matchLen = UTIL_LZ4_MIN_MATCH;
+            while (ip + matchLen < matchLimit && ip[matchLen] == ref[matchLen]) {
+                matchLen++;
+            }
+
+            op = UtilLz4_PutSequence(op, anchor, (uint32_t) (ip - anchor), (uint32_t) (ip - ref), matchLen);
+            ip += matchLen;
+            anchor = ip;
+            searchCount = 1U << UTIL_LZ4_SKIP_TRIGGER;
+
+            /* Index the position two bytes back, it often starts the next match. */
+            if (ip - 2 > src && ip < matchFindLimit) {
+                encoder->hashTable[UtilLz4_Hash(UtilLz4_Read32(ip - 2))] = (uint32_t) (ip - 2 - src);
+            }
+        }
+    }
+
+    /* Last literals, a sequence without match. */
+    literalLen = (uint32_t) (src + srcLen - anchor);
+    *op++ = (uint8_t) (USER_UTIL_MIN(literalLen, UTIL_LZ4_RUN_MASK) << 4);
+    if (literalLen >= UTIL_LZ4_RUN_MASK) {
+        op = UtilLz4_PutLength(op, literalLen - UTIL_LZ4_RUN_MASK);
+    }
+    memcpy(op, anchor, literalLen);
+    op += literalLen;
+
+    *dstLen = (uint32_t) (op - dst);
+
+    return DJI_ERROR_SYSTEM_MODULE_CODE_SUCCESS;
+}
+
+T_DjiReturnCode UtilLz4_Decompress(const uint8_t *src, uint32_t srcLen, uint8_t *dst, uint32_t dstCapacity,
+                                   uint32_t *dstLen)
+{
+    const uint8_t *ip = src;
+    const uint8_t *srcEnd = src + srcLen;
+    uint8_t *op = dst;
+    uint8_t *dstEnd = dst + dstCapacity;
+    const uint8_t *match;
+    uint32_t token;
+    uint32_t length;
+    uint32_t offset;
+    uint8_t byte;
+
+    if (src == NULL || srcLen == 0 || (dst == NULL && dstCapacity != 0) || dstLen == NULL) {
+        return DJI_ERROR_SYSTEM_MODULE_CODE_INVALID_PARAMETER;
+    }
+
+    while (1) {
+        token = *ip++;
+
+        length = token >> 4;
+        if (length == UTIL_LZ4_RUN_MASK) {
+            do {
+                if (ip >= srcEnd) {
+                    return DJI_ERROR_SYSTEM_MODULE_CODE_INVALID_PARAMETER;
+                }
+                byte = *ip++;
+                length += byte;
+            } while (byte == 255 && length < UTIL_LZ4_MAX_INPUT_SIZE);
+        }
+        if (length > (uint32_t) (srcEnd - ip) || length > (uint32_t) (dstEnd - op)) {
+            return DJI_ERROR_SYSTEM_MODULE_CODE_INVALID_PARAMETER;
+        }
+        memcpy(op, ip, length);
+        ip += length;
+        op += length;
+
+        if (ip == srcEnd) {
+            break;
+        }
+
+        if (srcEnd - ip < 2) {
+            return DJI_ERROR_SYSTEM_MODULE_CODE_INVALID_PARAMETER;
+        }
+        offset = (uint32_t) ip[0] | ((uint32_t) ip[1] << 8);
+        ip += 2;
+        if (offset == 0 || offset > (uint32_t) (op - dst)) {
+            return DJI_ERROR_SYSTEM_MODULE_CODE_INVALID_PARAMETER;
+        }
+
+        length = token & UTIL_LZ4_RUN_MASK;
+        if (length == UTIL_LZ4_RUN_MASK) {
+            do {
+                if (ip >= srcEnd) {
+                    return DJI_ERROR_SYSTEM_MODULE_CODE_INVALID_PARAMETER;
+                }
+                byte = *ip++;
+                length += byte;
+            } while (byte == 255 && length < UTIL_LZ4_MAX_INPUT_SIZE);
+        }
+        length += UTIL_LZ4_MIN_MATCH;
+        if (length > (uint32_t) (dstEnd - op)) {
+            return DJI_ERROR_SYSTEM_MODULE_CODE_INVALID_PARAMETER;
+        }
+
+        match = op - offset;
+        if (offset >= length) {
+            memcpy(op, match, length);
+            op += length;
+        } else {
+            /* Overlapping copy repeats the last offset bytes, it has to go byte by byte. */
+            while (length-- > 0) {
+                *op++ = *match++;
+            }
+        }
+
+        if (ip >= srcEnd) {
+            return DJI_ERROR_SYSTEM_MODULE_CODE_INVALID_PARAMETER;
+        }
+    }
+
+    *dstLen = (uint32_t) (op - dst);
+
+    return DJI_ERROR_SYSTEM_MODULE_CODE_SUCCESS;
+}
+
+/* Private functions definition-----------------------------------------------*/
+static uint32_t UtilLz4_Read32(const uint8_t *data)
+{
+    uint32_t value;
+
+    memcpy(&value, data, sizeof(value));
+
+    return value;
+}
+
+static uint32_t UtilLz4_Hash(uint32_t sequence)
+{
+    return (sequence * 2654435761U) >> (32 - UTIL_LZ4_HASH_BITS);
+}
+
+static uint8_t *UtilLz4_PutLength(uint8_t *op, uint32_t length)
+{
+    while (length >= 255) {
+        *op++ = 255;
+        length -= 255;
+    }
+    *op++ = (uint8_t) length;
+
+    return op;
+}
+
+static uint8_t *UtilLz4_PutSequence(uint8_t *op, const uint8_t *literal, uint32_t literalLen, uint32_t offset,
+                                    uint32_t matchLen)
+{
+    uint8_t *token = op++;
+    uint32_t matchCode = matchLen - UTIL_LZ4_MIN_MATCH;
+
+    *token = (uint8_t) ((USER_UTIL_MIN(literalLen, UTIL_LZ4_RUN_MASK) << 4) |
+                        USER_UTIL_MIN(matchCode, UTIL_LZ4_RUN_MASK));
+    if (literalLen >= UTIL_LZ4_RUN_MASK) {
+        op = UtilLz4_PutLength(op, literalLen - UTIL_LZ4_RUN_MASK);
+    }
+    memcpy(op, literal, literalLen);
+    op += literalLen;
+
+    *op++ = (uint8_t) offset;
+    *op++ = (uint8_t) (offset >> 8);
+
+    if (matchCode >= UTIL_LZ4_RUN_MASK) {
+        op = UtilLz4_PutLength(op, matchCode - UTIL_LZ4_RUN_MASK);
+    }
+
+    return op;
+}
+
+/****************** (C) COPYRIGHT DJI Innovations *****END OF FILE****/
@@ -0,0 +1,69 @@
+/**
+ ******************************************************************************
+ * @file    util_lz4.h
+ * @brief   This is the header file for "util_lz4.c", defining the LZ4 block codec.
+ *
+ * @copyright (c) 2021 DJI. All rights reserved.
+ *
+ * All information contained herein is, and remains, the property of DJI.
+ * The intellectual and technical concepts contained herein are proprietary
+ * to DJI and may be covered by U.S. and foreign patents, patents in process,
+ * and protected by trade secret or copyright law.  Dissemination of this
+ * information, including but not limited to data and other proprietary
+ * material(s) incorporated within the information, in any form, is strictly
+ * prohibited without the express written consent of DJI.
+ *
+ * If you receive this source code without DJI’s authorization, you may not
+ * further disseminate the information, and you must immediately remove the
+ * source code and notify DJI of its removal. DJI reserves the right to pursue
+ * legal actions against you for any loss(es) or damage(s) caused by your
+ * failure to do so.
+ *
+ ******************************************************************************
+ */
+
+/* Define to prevent recursive inclusion -------------------------------------*/
+#ifndef UTIL_LZ4_H
+#define UTIL_LZ4_H
+
+/* Includes ------------------------------------------------------------------*/
+#include "dji_typedef.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Exported constants --------------------------------------------------------*/
+#define UTIL_LZ4_HASH_BITS                      12
+#define UTIL_LZ4_MAX_INPUT_SIZE                 0x7E000000
+
+/* Exported types ------------------------------------------------------------*/
+/**
+ * @brief Compressor state of the LZ4 block format, the output is readable by any LZ4 block decoder.
+ * @note Matches are found greedily through a single-entry hash table, like the fast mode of the reference
+ * implementation. The table is 16KB, so keep the encoder off small task stacks. The encoder is not thread-safe.
+ */
+typedef struct {
+    uint32_t hashTable[1U << UTIL_LZ4_HASH_BITS];
+} T_UtilLz4Encoder;
+
+/* Exported functions --------------------------------------------------------*/
+/**
+ * @brief Worst case compressed size, a destination of this size never fails.
+ */
+uint32_t UtilLz4_CompressBound(uint32_t srcLen);
+T_DjiReturnCode UtilLz4_Compress(T_UtilLz4Encoder *encoder, const uint8_t *src, uint32_t srcLen, uint8_t *dst,
+                                 uint32_t dstCapacity, uint32_t *dstLen);
+
+/**
+ * @brief Decode one block, every length and offset is checked so corrupt input can not write outside dst.
+ */
+T_DjiReturnCode UtilLz4_Decompress(const uint8_t *src, uint32_t srcLen, uint8_t *dst, uint32_t dstCapacity,
+                                   uint32_t *dstLen);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // UTIL_LZ4_H
+/************************ (C) COPYRIGHT DJI Innovations *******END OF FILE******/
@@ -0,0 +1,141 @@
+/**
+ ******************************************************************************
+ * @file    util_pool.c
+ * @brief   Fixed-capacity object pool with an embedded free list.
+ *
+ * @copyright (c) 2021 DJI. All rights reserved.
+ *
+ * All information contained herein is, and remains, the property of DJI.
+ * The intellectual and technical concepts contained herein are proprietary
+ * to DJI and may be covered by U.S. and foreign patents, patents in process,
+ * and protected by trade secret or copyright law.  Dissemination of this
+ * information, including but not limited to data and other proprietary
+ * material(s) incorporated within the information, in any form, is strictly
+ * prohibited without the express written consent of DJI.
+ *
+ * If you receive this source code without DJI’s authorization, you may not
+ * further disseminate the information, and you must immediately remove the
+ * source code and notify DJI of its removal. DJI reserves the right to pursue
+ * legal actions against you for any loss(es) or damage(s) caused by your
+ * failure to do so.
+ *
+ ******************************************************************************
+ */
+
+/* Includes ------------------------------------------------------------------*/
+#include "util_pool.h"
+#include <string.h>
+
+/* Private constants ---------------------------------------------------------*/
+#define UTIL_POOL_ALIGN                     sizeof(void *)
+
+/* Private types -------------------------------------------------------------*/
+
+/* Private functions declaration ---------------------------------------------*/
+static size_t UtilPool_GetObjectStride(size_t objectSize);
+
+/* Private values ------------------------------------------------------------*/
+
+/* Exported functions definition ---------------------------------------------*/
+size_t UtilPool_GetMemorySize(uint32_t capacity, size_t objectSize)
+{
+    return (size_t) capacity * UtilPool_GetObjectStride(objectSize);
+}
+
+T_DjiReturnCode UtilPool_Init(T_UtilPool *pool, void *memory, size_t memorySize, size_t objectSize)
+{
+    size_t stride = UtilPool_GetObjectStride(objectSize);
+    uint32_t i;
+
+    if (pool == NULL || memory == NULL || objectSize == 0 || ((uintptr_t) memory % UTIL_POOL_ALIGN) != 0 ||
+        memorySize < stride || memorySize / stride >= UTIL_POOL_INVALID_INDEX) {
+        return DJI_ERROR_SYSTEM_MODULE_CODE_INVALID_PARAMETER;
+    }
+
+    pool->memory = memory;
+    pool->objectSize = stride;
+    pool->capacity = (uint32_t) (memorySize / stride);
+    pool->usedCount = 0;
+
+    /* Every free object stores the pointer to the next free object in its first bytes. */
+    pool->freeList = NULL;
+    for (i = pool->capacity; i > 0; i--) {
+        void **object = (void **) (pool->memory + (size_t) (i - 1) * stride);
+
+        *object = pool->freeList;
+        pool->freeList = object;
+    }
+
+    return DJI_ERROR_SYSTEM_MODULE_CODE_SUCCESS;
+}
+
+void *UtilPool_Alloc(T_UtilPool *pool)
+{
+    void **object = pool->freeList;
+
+    if (object == NULL) {
+        return NULL;
+    }
+
+    pool->freeList = *object;
+    pool->usedCount++;
+    memset(object, 0, pool->objectSize);
+
+    return object;
+}
+
+T_DjiReturnCode UtilPool_Free(T_UtilPool *pool, void *object)
+{
+    if (object == NULL || UtilPool_GetIndex(pool, object) == UTIL_POOL_INVALID_INDEX || pool->usedCount == 0) {
+        return DJI_ERROR_SYSTEM_MODULE_CODE_INVALID_PARAMETER;
+    }
+
+    *(void **) object = pool->freeList;
+    pool->freeList = object;
+    pool->usedCount--;
+
+    return DJI_ERROR_SYSTEM_MODULE_CODE_SUCCESS;
+}
+
+uint32_t UtilPool_GetIndex(const T_UtilPool *pool, const void *object)
+{
+    const uint8_t *address = object;
+    size_t offset;
+
+    if (address < pool->memory) {
+        return UTIL_POOL_INVALID_INDEX;
+    }
+
+    offset = (size_t) (address - pool->memory);
+    if (offset % pool->objectSize != 0 || offset / pool->objectSize >= pool->capacity) {
+        return UTIL_POOL_INVALID_INDEX;
+    }
+
+    return (uint32_t) (offset / pool->objectSize);
+}
+
+void *UtilPool_GetObject(const T_UtilPool *pool, uint32_t index)
+{
+    if (index >= pool->capacity) {
+        return NULL;
+    }
+
+    return pool->memory + (size_t) index * pool->objectSize;
+}
+
+uint32_t UtilPool_GetUsedCount(const T_UtilPool *pool)
+{
+    return pool->usedCount;
+}
+
+/* Private functions definition-----------------------------------------------*/
+static size_t UtilPool_GetObjectStride(size_t objectSize)
+{
+    if (objectSize < sizeof(void *)) {
+        objectSize = sizeof(void *);
+    }
+
+    return (objectSize + UTIL_POOL_ALIGN - 1) & ~(UTIL_POOL_ALIGN - 1);
+}
+
+/****************** (C) COPYRIGHT DJI Innovations *****END OF FILE****/
@@ -0,0 +1,68 @@
+/**
+ ******************************************************************************
+ * @file    util_pool.h
+ * @brief   This is the header file for "util_pool.c", defining the fixed-capacity object pool.
+ *
+ * @copyright (c) 2021 DJI. All rights reserved.
+ *
+ * All information contained herein is, and remains, the property of DJI.
+ * The intellectual and technical concepts contained herein are proprietary
+ * to DJI and may be covered by U.S. and foreign patents, patents in process,
+ * and protected by trade secret or copyright law.  Dissemination of this
+ * information, including but not limited to data and other proprietary
+ * material(s) incorporated within the information, in any form, is strictly
+ * prohibited without the express written consent of DJI.
+ *
+ * If you receive this source code without DJI’s authorization, you may not
+ * further disseminate the information, and you must immediately remove the
+ * source code and notify DJI of its removal. DJI reserves the right to pursue
+ * legal actions against you for any loss(es) or damage(s) caused by your
+ * failure to do so.
+ *
+ ******************************************************************************
+ */
+
+/* Define to prevent recursive inclusion -------------------------------------*/
+#ifndef UTIL_POOL_H
+#define UTIL_POOL_H
+
+/* Includes ------------------------------------------------------------------*/
+#include <stddef.h>
+#include "dji_typedef.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Exported constants --------------------------------------------------------*/
+#define UTIL_POOL_INVALID_INDEX             0xFFFFFFFFU
+
+/* Exported types ------------------------------------------------------------*/
+/**
+ * @brief Fixed-capacity pool of equally sized objects carved from user memory.
+ * @note Alloc and free are O(1) and never touch the heap. The pool is not thread-safe, protect it with the lock that
+ * already guards the containers holding its objects.
+ */
+typedef struct {
+    uint8_t *memory;
+    size_t objectSize;
+    uint32_t capacity;
+    uint32_t usedCount;
+    void *freeList;
+} T_UtilPool;
+
+/* Exported functions --------------------------------------------------------*/
+size_t UtilPool_GetMemorySize(uint32_t capacity, size_t objectSize);
+T_DjiReturnCode UtilPool_Init(T_UtilPool *pool, void *memory, size_t memorySize, size_t objectSize);
+void *UtilPool_Alloc(T_UtilPool *pool);
+T_DjiReturnCode UtilPool_Free(T_UtilPool *pool, void *object);
+uint32_t UtilPool_GetIndex(const T_UtilPool *pool, const void *object);
+void *UtilPool_GetObject(const T_UtilPool *pool, uint32_t index);
+uint32_t UtilPool_GetUsedCount(const T_UtilPool *pool);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // UTIL_POOL_H
+/************************ (C) COPYRIGHT DJI Innovations *******END OF FILE******/
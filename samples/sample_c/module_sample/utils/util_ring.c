@@ -0,0 +1,590 @@
+/**
+ ******************************************************************************
+ * @file    util_ring.c
+ * @brief   Lock-free spsc byte ring and mpmc fixed-slot message queue.
+ *
+ * @copyright (c) 2021 DJI. All rights reserved.
+ *
+ * All information contained herein is, and remains, the property of DJI.
+ * The intellectual and technical concepts contained herein are proprietary
+ * to DJI and may be covered by U.S. and foreign patents, patents in process,
+ * and protected by trade secret or copyright law.  Dissemination of this
+ * information, including but not limited to data and other proprietary
+ * material(s) incorporated within the information, in any form, is strictly
+ * prohibited without the express written consent of DJI.
+ *
+ * If you receive this source code without DJI’s authorization, you may not
+ * further disseminate the information, and you must immediately remove the
+ * source code and notify DJI of its removal. DJI reserves the right to pursue
+ * legal actions against you for any loss(es) or damage(s) caused by your
+ * failure to do so.
+ *
+ ******************************************************************************
+ */
+
+/* Includes ------------------------------------------------------------------*/
+#include "util_ring.h"
+#include <string.h>
+#include "util_misc.h"
+
+/* Private constants ---------------------------------------------------------*/
+#define UTIL_RING_SLOT_ALIGN                8
+
+/* Private types -------------------------------------------------------------*/
+typedef struct {
+    T_UtilRingIndex sequence;
+    size_t len;
+} T_UtilRingMpmcSlotHeader;
+
+typedef bool (*UtilRingIsReadyFunc)(const void *ring, size_t len);
+
+/* Private functions declaration ---------------------------------------------*/
+static T_UtilRingIndex UtilRing_CutSizeToPowOfTwo(size_t size);
+static T_DjiReturnCode UtilRing_WaiterInit(T_UtilRingWaiter *waiter);
+static void UtilRing_WaiterDeInit(T_UtilRingWaiter *waiter);
+static void UtilRing_WaiterNotify(T_UtilRingWaiter *waiter);
+static T_DjiReturnCode UtilRing_WaiterWait(T_UtilRingWaiter *waiter, UtilRingIsReadyFunc isReady, const void *ring,
+                                           size_t len, uint32_t startMs, uint32_t timeoutMs);
+static bool UtilRingSpsc_HasData(const void *ring, size_t len);
+static bool UtilRingSpsc_HasSpace(const void *ring, size_t len);
+static T_UtilRingMpmcSlotHeader *UtilRingMpmc_GetSlot(const T_UtilRingMpmc *ring, T_UtilRingIndex position);
+static bool UtilRingMpmc_HasData(const void *ring, size_t len);
+static bool UtilRingMpmc_HasSpace(const void *ring, size_t len);
+
+/* Private values ------------------------------------------------------------*/
+
+/* Exported functions definition ---------------------------------------------*/
+T_DjiReturnCode UtilRingSpsc_Init(T_UtilRingSpsc *ring, uint8_t *buffer, size_t bufferSize, bool isBlocking)
+{
+    T_DjiReturnCode returnCode;
+
+    if (ring == NULL || buffer == NULL || bufferSize < 2) {
+        return DJI_ERROR_SYSTEM_MODULE_CODE_INVALID_PARAMETER;
+    }
+
+    memset(ring, 0, sizeof(T_UtilRingSpsc));
+    ring->buffer = buffer;
+    ring->capacity = UtilRing_CutSizeToPowOfTwo(bufferSize);
+    ring->mask = ring->capacity - 1;
+    ring->isBlocking = isBlocking;
+
+    if (isBlocking) {
+        returnCode = UtilRing_WaiterInit(&ring->dataWaiter);
+        if (returnCode != DJI_ERROR_SYSTEM_MODULE_CODE_SUCCESS) {
+            return returnCode;
+        }
+
+        returnCode = UtilRing_WaiterInit(&ring->spaceWaiter);
+        if (returnCode != DJI_ERROR_SYSTEM_MODULE_CODE_SUCCESS) {
+            UtilRing_WaiterDeInit(&ring->dataWaiter);
+            return returnCode;
+        }
+    }
+
+    return DJI_ERROR_SYSTEM_MODULE_CODE_SUCCESS;
+}
+
+T_DjiReturnCode UtilRingSpsc_DeInit(T_UtilRingSpsc *ring)
+{
+    if (ring == NULL) {
+        return DJI_ERROR_SYSTEM_MODULE_CODE_INVALID_PARAMETER;
+    }
+
+    if (ring->isBlocking) {
+        UtilRing_WaiterDeInit(&ring->dataWaiter);
+        UtilRing_WaiterDeInit(&ring->spaceWaiter);
+    }
+
+    return DJI_ERROR_SYSTEM_MODULE_CODE_SUCCESS;
+}
+
+size_t UtilRingSpsc_GetUsedSize(const T_UtilRingSpsc *ring)
+{
+    T_UtilRingIndex readIndex = __atomic_load_n(&ring->readIndex, __ATOMIC_ACQUIRE);
+    T_UtilRingIndex writeIndex = __atomic_load_n(&ring->writeIndex, __ATOMIC_ACQUIRE);
+
+    return writeIndex - readIndex;
+}
+
+size_t UtilRingSpsc_GetUnusedSize(const T_UtilRingSpsc *ring)
+{
+    return ring->capacity - UtilRingSpsc_GetUsedSize(ring);
+}
+
+size_t UtilRingSpsc_Put(T_UtilRingSpsc *ring, const uint8_t *data, size_t len)
+{
+    T_UtilRingIndex writeIndex = __atomic_load_n(&ring->writeIndex, __ATOMIC_RELAXED);
+    T_UtilRingIndex readIndex = __atomic_load_n(&ring->readIndex, __ATOMIC_ACQUIRE);
+    T_UtilRingIndex offset = writeIndex & ring->mask;
+    size_t writeUpLen;
+
+    len = USER_UTIL_MIN(len, ring->capacity - (writeIndex - readIndex));
+
+    //fill up data, then the part wrapped to the beginning
+    writeUpLen = USER_UTIL_MIN(len, ring->capacity - offset);
+    memcpy(ring->buffer + offset, data, writeUpLen);
+    memcpy(ring->buffer, data + writeUpLen, len - writeUpLen);
+
+    UtilRingSpsc_Commit(ring, len);
+
+    return len;
+}
+
+size_t UtilRingSpsc_Get(T_UtilRingSpsc *ring, uint8_t *data, size_t len)
+{
+    T_UtilRingIndex readIndex = __atomic_load_n(&ring->readIndex, __ATOMIC_RELAXED);
+    T_UtilRingIndex writeIndex = __atomic_load_n(&ring->writeIndex, __ATOMIC_ACQUIRE);
+    T_UtilRingIndex offset = readIndex & ring->mask;
+    size_t readUpLen;
+
+    len = USER_UTIL_MIN(len, writeIndex - readIndex);
+
+    //get up data, then the part wrapped to the beginning
+    readUpLen = USER_UTIL_MIN(len, ring->capacity - offset);
+    memcpy(data, ring->buffer + offset, readUpLen);
+    memcpy(data + readUpLen, ring->buffer, len - readUpLen);
+
+    UtilRingSpsc_Consume(ring, len);
+
+    return len;
+}
+
+size_t UtilRingSpsc_Reserve(T_UtilRingSpsc *ring, uint8_t **data, size_t len)
+{
+    T_UtilRingIndex writeIndex = __atomic_load_n(&ring->writeIndex, __ATOMIC_RELAXED);
+    T_UtilRingIndex readIndex = __atomic_load_n(&ring->readIndex, __ATOMIC_ACQUIRE);
+    T_UtilRingIndex offset = writeIndex & ring->mask;
+    size_t unusedSize = ring->capacity - (writeIndex - readIndex);
+
+    *data = ring->buffer + offset;
+
+    return USER_UTIL_MIN(len, USER_UTIL_MIN(unusedSize, ring->capacity - offset));
+}
+
+void UtilRingSpsc_Commit(T_UtilRingSpsc *ring, size_t len)
+{
+    T_UtilRingIndex writeIndex = __atomic_load_n(&ring->writeIndex, __ATOMIC_RELAXED);
+
+    if (len == 0) {
+        return;
+    }
+
+    __atomic_store_n(&ring->writeIndex, writeIndex + len, __ATOMIC_RELEASE);
+    UtilRing_WaiterNotify(&ring->dataWaiter);
+}
+
+size_t UtilRingSpsc_Peek(T_UtilRingSpsc *ring, const uint8_t **data, size_t len)
+{
+    T_UtilRingIndex readIndex = __atomic_load_n(&ring->readIndex, __ATOMIC_RELAXED);
+    T_UtilRingIndex writeIndex = __atomic_load_n(&ring->writeIndex, __ATOMIC_ACQUIRE);
+    T_UtilRingIndex offset = readIndex & ring->mask;
+    size_t usedSize = writeIndex - readIndex;
+
+    *data = ring->buffer + offset;
+
+    return USER_UTIL_MIN(len, USER_UTIL_MIN(usedSize, ring->capacity - offset));
+}
+
+void UtilRingSpsc_Consume(T_UtilRingSpsc *ring, size_t len)
+{
+    T_UtilRingIndex readIndex = __atomic_load_n(&ring->readIndex, __ATOMIC_RELAXED);
+
+    if (len == 0) {
+        return;
+    }
+
+    __atomic_store_n(&ring->readIndex, readIndex + len, __ATOMIC_RELEASE);
+    UtilRing_WaiterNotify(&ring->spaceWaiter);
+}
+
+T_DjiReturnCode UtilRingSpsc_WaitForData(T_UtilRingSpsc *ring, size_t len, uint32_t timeoutMs)
+{
+    T_DjiOsalHandler *osalHandler = DjiPlatform_GetOsalHandler();
+    uint32_t startMs = 0;
+
+    if (len > ring->capacity) {
+        return DJI_ERROR_SYSTEM_MODULE_CODE_INVALID_PARAMETER;
+    }
+    if (!ring->isBlocking) {
+        return DJI_ERROR_SYSTEM_MODULE_CODE_NONSUPPORT_IN_CURRENT_STATE;
+    }
+
+    osalHandler->GetTimeMs(&startMs);
+
+    return UtilRing_WaiterWait(&ring->dataWaiter, UtilRingSpsc_HasData, ring, len, startMs, timeoutMs);
+}
+
+T_DjiReturnCode UtilRingSpsc_WaitForSpace(T_UtilRingSpsc *ring, size_t len, uint32_t timeoutMs)
+{
+    T_DjiOsalHandler *osalHandler = DjiPlatform_GetOsalHandler();
+    uint32_t startMs = 0;
+
+    if (len > ring->capacity) {
+        return DJI_ERROR_SYSTEM_MODULE_CODE_INVALID_PARAMETER;
+    }
+    if (!ring->isBlocking) {
+        return DJI_ERROR_SYSTEM_MODULE_CODE_NONSUPPORT_IN_CURRENT_STATE;
+    }
+
+    osalHandler->GetTimeMs(&startMs);
+
+    return UtilRing_WaiterWait(&ring->spaceWaiter, UtilRingSpsc_HasSpace, ring, len, startMs, timeoutMs);
+}
+
+size_t UtilRingMpmc_GetMemorySize(size_t slotCount, size_t slotSize)
+{
+    size_t slotStride = (sizeof(T_UtilRingMpmcSlotHeader) + slotSize + UTIL_RING_SLOT_ALIGN - 1) &
+                        ~((size_t) UTIL_RING_SLOT_ALIGN - 1);
+
+    return slotCount * slotStride;
+}
+
+T_DjiReturnCode UtilRingMpmc_Init(T_UtilRingMpmc *ring, void *memory, size_t memorySize, size_t slotSize,
+                                  bool isBlocking)
+{
+    T_DjiReturnCode returnCode;
+    T_UtilRingIndex slotCount;
+    T_UtilRingIndex i;
+
+    if (ring == NULL || memory == NULL || slotSize == 0 || ((uintptr_t) memory % UTIL_RING_SLOT_ALIGN) != 0) {
+        return DJI_ERROR_SYSTEM_MODULE_CODE_INVALID_PARAMETER;
+    }
+
+    memset(ring, 0, sizeof(T_UtilRingMpmc));
+    ring->slotSize = slotSize;
+    ring->slotStride = UtilRingMpmc_GetMemorySize(1, slotSize);
+    if (memorySize / ring->slotStride < 2) {
+        return DJI_ERROR_SYSTEM_MODULE_CODE_INVALID_PARAMETER;
+    }
+
+    slotCount = UtilRing_CutSizeToPowOfTwo(memorySize / ring->slotStride);
+    ring->slots = memory;
+    ring->mask = slotCount - 1;
+    ring->isBlocking = isBlocking;
+
+    /* A slot is free for position p when its sequence is p and holds a message when its sequence is p + 1. */
+    for (i = 0; i < slotCount; i++) {
+        UtilRingMpmc_GetSlot(ring, i)->sequence = i;
+    }
+
+    if (isBlocking) {
+        returnCode = UtilRing_WaiterInit(&ring->dataWaiter);
+        if (returnCode != DJI_ERROR_SYSTEM_MODULE_CODE_SUCCESS) {
+            return returnCode;
+        }
+
+        returnCode = UtilRing_WaiterInit(&ring->spaceWaiter);
+        if (returnCode != DJI_ERROR_SYSTEM_MODULE_CODE_SUCCESS) {
+            UtilRing_WaiterDeInit(&ring->dataWaiter);
+            return returnCode;
+        }
+    }
+
+    return DJI_ERROR_SYSTEM_MODULE_CODE_SUCCESS;
+}
+
+T_DjiReturnCode UtilRingMpmc_DeInit(T_UtilRingMpmc *ring)
+{
+    if (ring == NULL) {
+        return DJI_ERROR_SYSTEM_MODULE_CODE_INVALID_PARAMETER;
+    }
+
+    if (ring->isBlocking) {
+        UtilRing_WaiterDeInit(&ring->dataWaiter);
+        UtilRing_WaiterDeInit(&ring->spaceWaiter);
+    }
+
+    return DJI_ERROR_SYSTEM_MODULE_CODE_SUCCESS;
+}
+
+T_DjiReturnCode UtilRingMpmc_Push(T_UtilRingMpmc *ring, const void *data, size_t len)
+{
+    T_DjiReturnCode returnCode;
+    T_UtilRingMpmcSlot slot;
+
+    if (len > ring->slotSize) {
+        return DJI_ERROR_SYSTEM_MODULE_CODE_OUT_OF_RANGE;
+    }
+
+    returnCode = UtilRingMpmc_Reserve(ring, &slot);
+    if (returnCode != DJI_ERROR_SYSTEM_MODULE_CODE_SUCCESS) {
+        return returnCode;
+    }
+
+    memcpy(slot.data, data, len);
+    UtilRingMpmc_Commit(ring, &slot, len);
+
+    return DJI_ERROR_SYSTEM_MODULE_CODE_SUCCESS;
+}
+
+T_DjiReturnCode UtilRingMpmc_Pop(T_UtilRingMpmc *ring, void *data, size_t dataSize, size_t *len)
+{
+    T_DjiReturnCode returnCode;
+    T_UtilRingMpmcSlot slot;
+
+    returnCode = UtilRingMpmc_Acquire(ring, &slot);
+    if (returnCode != DJI_ERROR_SYSTEM_MODULE_CODE_SUCCESS) {
+        return returnCode;
+    }
+
+    /* The slot is already claimed, a too small buffer gets the truncated message and an out of range code. */
+    memcpy(data, slot.data, USER_UTIL_MIN(slot.len, dataSize));
+    if (len != NULL) {
+        *len = slot.len;
+    }
+    returnCode = slot.len > dataSize ? DJI_ERROR_SYSTEM_MODULE_CODE_OUT_OF_RANGE :
+                 DJI_ERROR_SYSTEM_MODULE_CODE_SUCCESS;
+    UtilRingMpmc_Release(ring, &slot);
+
+    return returnCode;
+}
+
+T_DjiReturnCode UtilRingMpmc_PushWait(T_UtilRingMpmc *ring, const void *data, size_t len, uint32_t timeoutMs)
+{
+    T_DjiReturnCode returnCode;
+    T_DjiOsalHandler *osalHandler = DjiPlatform_GetOsalHandler();
+    uint32_t startMs = 0;
+
+    if (!ring->isBlocking) {
+        return DJI_ERROR_SYSTEM_MODULE_CODE_NONSUPPORT_IN_CURRENT_STATE;
+    }
+
+    osalHandler->GetTimeMs(&startMs);
+    while (1) {
+        returnCode = UtilRingMpmc_Push(ring, data, len);
+        if (returnCode != DJI_ERROR_SYSTEM_MODULE_CODE_BUSY) {
+            return returnCode;
+        }
+
+        returnCode = UtilRing_WaiterWait(&ring->spaceWaiter, UtilRingMpmc_HasSpace, ring, 1, startMs, timeoutMs);
+        if (returnCode != DJI_ERROR_SYSTEM_MODULE_CODE_SUCCESS) {
+            return returnCode;
+        }
+    }
+}
+
+T_DjiReturnCode UtilRingMpmc_PopWait(T_UtilRingMpmc *ring, void *data, size_t dataSize, size_t *len,
+                                     uint32_t timeoutMs)
+{
+    T_DjiReturnCode returnCode;
+    T_DjiOsalHandler *osalHandler = DjiPlatform_GetOsalHandler();
+    uint32_t startMs = 0;
+
+    if (!ring->isBlocking) {
+        return DJI_ERROR_SYSTEM_MODULE_CODE_NONSUPPORT_IN_CURRENT_STATE;
+    }
+
+    osalHandler->GetTimeMs(&startMs);
+    while (1) {
+        returnCode = UtilRingMpmc_Pop(ring, data, dataSize, len);
+        if (returnCode != DJI_ERROR_SYSTEM_MODULE_CODE_BUSY) {
+            return returnCode;
+        }
+
+        returnCode = UtilRing_WaiterWait(&ring->dataWaiter, UtilRingMpmc_HasData, ring, 1, startMs, timeoutMs);
+        if (returnCode != DJI_ERROR_SYSTEM_MODULE_CODE_SUCCESS) {
+            return returnCode;
+        }
+    }
+}
+
+T_DjiReturnCode UtilRingMpmc_Reserve(T_UtilRingMpmc *ring, T_UtilRingMpmcSlot *slot)
+{
+    T_UtilRingMpmcSlotHeader *header;
+    T_UtilRingIndex position = __atomic_load_n(&ring->enqueueIndex, __ATOMIC_RELAXED);
+    T_UtilRingIndex sequence;
+    ptrdiff_t diff;
+
+    while (1) {
+        header = UtilRingMpmc_GetSlot(ring, position);
+        sequence = __atomic_load_n(&header->sequence, __ATOMIC_ACQUIRE);
+        diff = (ptrdiff_t) (sequence - position);
+
+        if (diff == 0) {
+            if (__atomic_compare_exchange_n(&ring->enqueueIndex, &position, position + 1, true,
+                                            __ATOMIC_RELAXED, __ATOMIC_RELAXED)) {
+                break;
+            }
+        } else if (diff < 0) {
+            return DJI_ERROR_SYSTEM_MODULE_CODE_BUSY;
+        } else {
+            position = __atomic_load_n(&ring->enqueueIndex, __ATOMIC_RELAXED);
+        }
+    }
+
+    slot->data = (uint8_t *) (header + 1);
+    slot->len = ring->slotSize;
+    slot->position = position;
+
+    return DJI_ERROR_SYSTEM_MODULE_CODE_SUCCESS;
+}
+
+void UtilRingMpmc_Commit(T_UtilRingMpmc *ring, T_UtilRingMpmcSlot *slot, size_t len)
+{
+    T_UtilRingMpmcSlotHeader *header = UtilRingMpmc_GetSlot(ring, slot->position);
+
+    header->len = USER_UTIL_MIN(len, ring->slotSize);
+    __atomic_store_n(&header->sequence, slot->position + 1, __ATOMIC_RELEASE);
+    UtilRing_WaiterNotify(&ring->dataWaiter);
+}
+
+T_DjiReturnCode UtilRingMpmc_Acquire(T_UtilRingMpmc *ring, T_UtilRingMpmcSlot *slot)
+{
+    T_UtilRingMpmcSlotHeader *header;
+    T_UtilRingIndex position = __atomic_load_n(&ring->dequeueIndex, __ATOMIC_RELAXED);
+    T_UtilRingIndex sequence;
+    ptrdiff_t diff;
+
+    while (1) {
+        header = UtilRingMpmc_GetSlot(ring, position);
+        sequence = __atomic_load_n(&header->sequence, __ATOMIC_ACQUIRE);
+        diff = (ptrdiff_t) (sequence - (position + 1));
+
+        if (diff == 0) {
+            if (__atomic_compare_exchange_n(&ring->dequeueIndex, &position, position + 1, true,
+                                            __ATOMIC_RELAXED, __ATOMIC_RELAXED)) {
+                break;
+            }
+        } else if (diff < 0) {
+            return DJI_ERROR_SYSTEM_MODULE_CODE_BUSY;
+        } else {
+            position = __atomic_load_n(&ring->dequeueIndex, __ATOMIC_RELAXED);
+        }
+    }
+
+    slot->data = (uint8_t *) (header + 1);
+    slot->len = header->len;
+    slot->position = position;
+
+    return DJI_ERROR_SYSTEM_MODULE_CODE_SUCCESS;
+}
+
+void UtilRingMpmc_Release(T_UtilRingMpmc *ring, T_UtilRingMpmcSlot *slot)
+{
+    T_UtilRingMpmcSlotHeader *header = UtilRingMpmc_GetSlot(ring, slot->position);
+
+    __atomic_store_n(&header->sequence, slot->position + ring->mask + 1, __ATOMIC_RELEASE);
+    UtilRing_WaiterNotify(&ring->spaceWaiter);
+}
+
+/* Private functions definition-----------------------------------------------*/
+static T_UtilRingIndex UtilRing_CutSizeToPowOfTwo(size_t size)
+{
+    T_UtilRingIndex result = 1;
+
+    while (result <= size / 2) {
+        result <<= 1;
+    }
+
+    return result;
+}
+
+static T_DjiReturnCode UtilRing_WaiterInit(T_UtilRingWaiter *waiter)
+{
+    T_DjiOsalHandler *osalHandler = DjiPlatform_GetOsalHandler();
+
+    waiter->waiters = 0;
+
+    return osalHandler->SemaphoreCreate(0, &waiter->sema);
+}
+
+static void UtilRing_WaiterDeInit(T_UtilRingWaiter *waiter)
+{
+    T_DjiOsalHandler *osalHandler = DjiPlatform_GetOsalHandler();
+
+    if (waiter->sema != NULL) {
+        osalHandler->SemaphoreDestroy(waiter->sema);
+        waiter->sema = NULL;
+    }
+}
+
+static void UtilRing_WaiterNotify(T_UtilRingWaiter *waiter)
+{
+    T_DjiOsalHandler *osalHandler;
+
+    if (waiter->sema == NULL) {
+        return;
+    }
+
+    /* Pairs with the fence in UtilRing_WaiterWait: either the waiter sees the new index or we see the waiter. */
+    __atomic_thread_fence(__ATOMIC_SEQ_CST);
+    if (__atomic_load_n(&waiter->waiters, __ATOMIC_RELAXED) != 0) {
+        osalHandler = DjiPlatform_GetOsalHandler();
+        osalHandler->SemaphorePost(waiter->sema);
+    }
+}
+
+static T_DjiReturnCode UtilRing_WaiterWait(T_UtilRingWaiter *waiter, UtilRingIsReadyFunc isReady, const void *ring,
+                                           size_t len, uint32_t startMs, uint32_t timeoutMs)
+{
+    T_DjiOsalHandler *osalHandler = DjiPlatform_GetOsalHandler();
+    uint32_t nowMs = 0;
+    uint32_t elapsedMs;
+    bool ready;
+
+    while (1) {
+        if (isReady(ring, len)) {
+            return DJI_ERROR_SYSTEM_MODULE_CODE_SUCCESS;
+        }
+
+        osalHandler->GetTimeMs(&nowMs);
+        elapsedMs = nowMs - startMs;
+        if (timeoutMs != UTIL_RING_WAIT_FOREVER && elapsedMs >= timeoutMs) {
+            return DJI_ERROR_SYSTEM_MODULE_CODE_TIMEOUT;
+        }
+
+        __atomic_add_fetch(&waiter->waiters, 1, __ATOMIC_SEQ_CST);
+        __atomic_thread_fence(__ATOMIC_SEQ_CST);
+        ready = isReady(ring, len);
+        if (!ready) {
+            /* Stale posts only cause an extra loop, the condition is always checked again. */
+            if (timeoutMs == UTIL_RING_WAIT_FOREVER) {
+                osalHandler->SemaphoreWait(waiter->sema);
+            } else {
+                osalHandler->SemaphoreTimedWait(waiter->sema, timeoutMs - elapsedMs);
+            }
+        }
+        __atomic_sub_fetch(&waiter->waiters, 1, __ATOMIC_SEQ_CST);
+
+        if (ready) {
+            return DJI_ERROR_SYSTEM_MODULE_CODE_SUCCESS;
+        }
+    }
+}
+
+static bool UtilRingSpsc_HasData(const void *ring, size_t len)
+{
+    return UtilRingSpsc_GetUsedSize((const T_UtilRingSpsc *) ring) >= len;
+}
+
+static bool UtilRingSpsc_HasSpace(const void *ring, size_t len)
+{
+    return UtilRingSpsc_GetUnusedSize((const T_UtilRingSpsc *) ring) >= len;
+}
+
+static T_UtilRingMpmcSlotHeader *UtilRingMpmc_GetSlot(const T_UtilRingMpmc *ring, T_UtilRingIndex position)
+{
+    return (T_UtilRingMpmcSlotHeader *) (ring->slots + (position & ring->mask) * ring->slotStride);
+}
+
+static bool UtilRingMpmc_HasData(const void *ring, size_t len)
+{
+    const T_UtilRingMpmc *mpmc = ring;
+    T_UtilRingIndex position = __atomic_load_n(&mpmc->dequeueIndex, __ATOMIC_RELAXED);
+
+    USER_UTIL_UNUSED(len);
+
+    return __atomic_load_n(&UtilRingMpmc_GetSlot(mpmc, position)->sequence, __ATOMIC_ACQUIRE) == position + 1;
+}
+
+static bool UtilRingMpmc_HasSpace(const void *ring, size_t len)
+{
+    const T_UtilRingMpmc *mpmc = ring;
+    T_UtilRingIndex position = __atomic_load_n(&mpmc->enqueueIndex, __ATOMIC_RELAXED);
+
+    USER_UTIL_UNUSED(len);
+
+    return __atomic_load_n(&UtilRingMpmc_GetSlot(mpmc, position)->sequence, __ATOMIC_ACQUIRE) == position;
+}
+
+/****************** (C) COPYRIGHT DJI Innovations *****END OF FILE****/
@@ -0,0 +1,172 @@
+/**
+ ******************************************************************************
+ * @file    util_ring.h
+ * @brief   This is the header file for "util_ring.c", defining the lock-free spsc byte ring and the mpmc fixed-slot
+ * message queue.
+ *
+ * @copyright (c) 2021 DJI. All rights reserved.
+ *
+ * All information contained herein is, and remains, the property of DJI.
+ * The intellectual and technical concepts contained herein are proprietary
+ * to DJI and may be covered by U.S. and foreign patents, patents in process,
+ * and protected by trade secret or copyright law.  Dissemination of this
+ * information, including but not limited to data and other proprietary
+ * material(s) incorporated within the information, in any form, is strictly
+ * prohibited without the express written consent of DJI.
+ *
+ * If you receive this source code without DJI’s authorization, you may not
+ * further disseminate the information, and you must immediately remove the
+ * source code and notify DJI of its removal. DJI reserves the right to pursue
+ * legal actions against you for any loss(es) or damage(s) caused by your
+ * failure to do so.
+ *
+ ******************************************************************************
+ */
+
+/* Define to prevent recursive inclusion -------------------------------------*/
+#ifndef UTIL_RING_H
+#define UTIL_RING_H
+
+/* Includes ------------------------------------------------------------------*/
+#include <stddef.h>
+#include "dji_platform.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Exported constants --------------------------------------------------------*/
+#define UTIL_RING_CACHE_LINE_SIZE           64
+#define UTIL_RING_WAIT_FOREVER              0xFFFFFFFFU
+
+/* Exported types ------------------------------------------------------------*/
+/**
+ * @brief Free-running ring index, as wide as a pointer so a ring is only limited by addressable memory.
+ * @note Indices are never masked when stored, the used size is always writeIndex - readIndex.
+ */
+typedef size_t T_UtilRingIndex;
+
+typedef struct {
+    T_DjiSemaHandle sema;
+    uint32_t waiters;
+} T_UtilRingWaiter;
+
+/**
+ * @brief Wait-free single producer / single consumer byte ring.
+ * @note Exactly one task may call the producer functions (Put, Reserve, Commit, WaitForSpace) and exactly one task
+ * may call the consumer functions (Get, Peek, Consume, WaitForData). No lock is needed between them.
+ */
+typedef struct {
+    uint8_t *buffer;
+    T_UtilRingIndex capacity;
+    T_UtilRingIndex mask;
+    bool isBlocking;
+    uint8_t reserved0[UTIL_RING_CACHE_LINE_SIZE];
+    T_UtilRingIndex writeIndex;
+    T_UtilRingWaiter dataWaiter;
+    uint8_t reserved1[UTIL_RING_CACHE_LINE_SIZE];
+    T_UtilRingIndex readIndex;
+    T_UtilRingWaiter spaceWaiter;
+    uint8_t reserved2[UTIL_RING_CACHE_LINE_SIZE];
+} T_UtilRingSpsc;
+
+/**
+ * @brief Multi producer / multi consumer queue of fixed-size slots, each slot carries one message up to slotSize.
+ */
+typedef struct {
+    uint8_t *slots;
+    size_t slotSize;
+    size_t slotStride;
+    T_UtilRingIndex mask;
+    bool isBlocking;
+    uint8_t reserved0[UTIL_RING_CACHE_LINE_SIZE];
+    T_UtilRingIndex enqueueIndex;
+    T_UtilRingWaiter dataWaiter;
+    uint8_t reserved1[UTIL_RING_CACHE_LINE_SIZE];
+    T_UtilRingIndex dequeueIndex;
+    T_UtilRingWaiter spaceWaiter;
+    uint8_t reserved2[UTIL_RING_CACHE_LINE_SIZE];
+} T_UtilRingMpmc;
+
+/**
+ * @brief Slot handed out by UtilRingMpmc_Reserve/UtilRingMpmc_Acquire for zero-copy access.
+ */
+typedef struct {
+    uint8_t *data;
+    size_t len;
+    T_UtilRingIndex position;
+} T_UtilRingMpmcSlot;
+
+/* Exported functions --------------------------------------------------------*/
+/**
+ * @brief Init the spsc ring on user memory, the capacity is cut to the largest power of two not above bufferSize.
+ * @param isBlocking: create semaphores for UtilRingSpsc_WaitForData/UtilRingSpsc_WaitForSpace, needs the osal handler.
+ */
+T_DjiReturnCode UtilRingSpsc_Init(T_UtilRingSpsc *ring, uint8_t *buffer, size_t bufferSize, bool isBlocking);
+T_DjiReturnCode UtilRingSpsc_DeInit(T_UtilRingSpsc *ring);
+size_t UtilRingSpsc_GetUsedSize(const T_UtilRingSpsc *ring);
+size_t UtilRingSpsc_GetUnusedSize(const T_UtilRingSpsc *ring);
+
+/**
+ * @brief Copy in/out up to len bytes, the return value is the number of bytes really copied.
+ */
+size_t UtilRingSpsc_Put(T_UtilRingSpsc *ring, const uint8_t *data, size_t len);
+size_t UtilRingSpsc_Get(T_UtilRingSpsc *ring, uint8_t *data, size_t len);
+
+/**
+ * @brief Zero-copy producer access: returns the contiguous writable length (at most len) starting at *data.
+ * @note The region stops at the end of the buffer, call again after UtilRingSpsc_Commit to get the wrapped part.
+ */
+size_t UtilRingSpsc_Reserve(T_UtilRingSpsc *ring, uint8_t **data, size_t len);
+void UtilRingSpsc_Commit(T_UtilRingSpsc *ring, size_t len);
+
+/**
+ * @brief Zero-copy consumer access: returns the contiguous readable length (at most len) starting at *data.
+ */
+size_t UtilRingSpsc_Peek(T_UtilRingSpsc *ring, const uint8_t **data, size_t len);
+void UtilRingSpsc_Consume(T_UtilRingSpsc *ring, size_t len);
+
+/**
+ * @brief Block until at least len bytes are readable/writable, timeoutMs may be UTIL_RING_WAIT_FOREVER.
+ * @return DJI_ERROR_SYSTEM_MODULE_CODE_TIMEOUT when the condition is not met in time.
+ */
+T_DjiReturnCode UtilRingSpsc_WaitForData(T_UtilRingSpsc *ring, size_t len, uint32_t timeoutMs);
+T_DjiReturnCode UtilRingSpsc_WaitForSpace(T_UtilRingSpsc *ring, size_t len, uint32_t timeoutMs);
+
+/**
+ * @brief Memory needed by an mpmc queue of slotCount slots of slotSize bytes, slotCount must be a power of two.
+ */
+size_t UtilRingMpmc_GetMemorySize(size_t slotCount, size_t slotSize);
+T_DjiReturnCode UtilRingMpmc_Init(T_UtilRingMpmc *ring, void *memory, size_t memorySize, size_t slotSize,
+                                  bool isBlocking);
+T_DjiReturnCode UtilRingMpmc_DeInit(T_UtilRingMpmc *ring);
+
+/**
+ * @brief Non-blocking copy in/out of one message.
+ * @return DJI_ERROR_SYSTEM_MODULE_CODE_BUSY when the queue is full (push) or empty (pop).
+ */
+T_DjiReturnCode UtilRingMpmc_Push(T_UtilRingMpmc *ring, const void *data, size_t len);
+T_DjiReturnCode UtilRingMpmc_Pop(T_UtilRingMpmc *ring, void *data, size_t dataSize, size_t *len);
+
+/**
+ * @brief Blocking variants of push/pop, timeoutMs may be UTIL_RING_WAIT_FOREVER.
+ */
+T_DjiReturnCode UtilRingMpmc_PushWait(T_UtilRingMpmc *ring, const void *data, size_t len, uint32_t timeoutMs);
+T_DjiReturnCode UtilRingMpmc_PopWait(T_UtilRingMpmc *ring, void *data, size_t dataSize, size_t *len,
+                                     uint32_t timeoutMs);
+
+/**
+ * @brief Zero-copy access: Reserve/Commit fill a slot in place, Acquire/Release read a slot in place.
+ * @note A reserved or acquired slot must be committed or released, later slots are not visible until it is.
+ */
+T_DjiReturnCode UtilRingMpmc_Reserve(T_UtilRingMpmc *ring, T_UtilRingMpmcSlot *slot);
+void UtilRingMpmc_Commit(T_UtilRingMpmc *ring, T_UtilRingMpmcSlot *slot, size_t len);
+T_DjiReturnCode UtilRingMpmc_Acquire(T_UtilRingMpmc *ring, T_UtilRingMpmcSlot *slot);
+void UtilRingMpmc_Release(T_UtilRingMpmc *ring, T_UtilRingMpmcSlot *slot);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // UTIL_RING_H
+/************************ (C) COPYRIGHT DJI Innovations *******END OF FILE******/
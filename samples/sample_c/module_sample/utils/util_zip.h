@@ -0,0 +1,95 @@
+/**
+ ******************************************************************************
+ * @file    util_zip.h
+ * @brief   This is the header file for "util_zip.c", defining the in-memory zip writer.
+ *
+ * @copyright (c) 2021 DJI. All rights reserved.
+ *
+ * All information contained herein is, and remains, the property of DJI.
+ * The intellectual and technical concepts contained herein are proprietary
+ * to DJI and may be covered by U.S. and foreign patents, patents in process,
+ * and protected by trade secret or copyright law.  Dissemination of this
+ * information, including but not limited to data and other proprietary
+ * material(s) incorporated within the information, in any form, is strictly
+ * prohibited without the express written consent of DJI.
+ *
+ * If you receive this source code without DJI’s authorization, you may not
+ * further disseminate the information, and you must immediately remove the
+ * source code and notify DJI of its removal. DJI reserves the right to pursue
+ * legal actions against you for any loss(es) or damage(s) caused by your
+ * failure to do so.
+ *
+ ******************************************************************************
+ */
+
+
+/* Define to prevent recursive inclusion -------------------------------------*/
+#ifndef UTIL_ZIP_H
+#define UTIL_ZIP_H
+
+/* Includes ------------------------------------------------------------------*/
+#include <stddef.h>
+#include "dji_typedef.h"
+#include "util_deflate.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Exported constants --------------------------------------------------------*/
+#define UTIL_ZIP_ENTRY_MAX_NUM              16
+#define UTIL_ZIP_ENTRY_NAME_MAX_LEN         64
+
+/* Exported types ------------------------------------------------------------*/
+typedef struct {
+    char name[UTIL_ZIP_ENTRY_NAME_MAX_LEN];
+    uint16_t method;
+    uint32_t crc;
+    uint32_t compressedSize;
+    uint32_t uncompressedSize;
+    uint32_t headerOffset;
+} T_UtilZipEntry;
+
+/**
+ * @brief Builds a zip archive in a growable memory buffer, entry data is streamed and never staged in a file.
+ * @note Entries are written one after the other, the sizes and crc of the local header are patched when the entry
+ * ends. Compressed entries need the deflate instance passed at init. The buffer is kept across UtilZip_WriterReset
+ * so repeated archives of similar size do not allocate. The writer is not thread-safe.
+ */
+typedef struct {
+    uint8_t *buffer;
+    size_t capacity;
+    size_t size;
+    T_UtilDeflate *deflate;
+    T_UtilZipEntry entries[UTIL_ZIP_ENTRY_MAX_NUM];
+    uint32_t entryCount;
+    bool isEntryOpen;
+    uint16_t dosTime;
+    uint16_t dosDate;
+    T_DjiReturnCode status;         /*!< First error met, every later call returns it until the writer is reset. */
+} T_UtilZipWriter;
+
+/* Exported functions --------------------------------------------------------*/
+T_DjiReturnCode UtilZip_WriterInit(T_UtilZipWriter *writer, size_t initialCapacity, T_UtilDeflate *deflate);
+void UtilZip_WriterReset(T_UtilZipWriter *writer);
+void UtilZip_WriterDeInit(T_UtilZipWriter *writer);
+void UtilZip_WriterSetModifyTime(T_UtilZipWriter *writer, uint16_t year, uint8_t month, uint8_t day, uint8_t hour,
+                                 uint8_t minute, uint8_t second);
+
+T_DjiReturnCode UtilZip_WriterBeginEntry(T_UtilZipWriter *writer, const char *name, bool isCompressed);
+T_DjiReturnCode UtilZip_WriterWriteEntryData(T_UtilZipWriter *writer, const uint8_t *data, uint32_t len);
+T_DjiReturnCode UtilZip_WriterEndEntry(T_UtilZipWriter *writer);
+
+/**
+ * @brief Append the central directory, the archive stays valid and owned by the writer until the next reset.
+ */
+T_DjiReturnCode UtilZip_WriterFinish(T_UtilZipWriter *writer, const uint8_t **data, uint32_t *size);
+
+uint32_t UtilZip_Crc32(uint32_t crc, const uint8_t *data, size_t len);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // UTIL_ZIP_H
+/************************ (C) COPYRIGHT DJI Innovations *******END OF FILE******/
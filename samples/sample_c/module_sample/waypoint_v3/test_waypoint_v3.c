@@ -23,9 +23,13 @@
  */
 
 /* Includes ------------------------------------------------------------------*/
+#include <math.h>
+#include <string.h>
+#include <time.h>
 #include <utils/util_file.h>
 #include <utils/util_misc.h>
 #include "test_waypoint_v3.h"
+#include "test_waypoint_v3_kmz.h"
 #include "dji_logger.h"
 #include "dji_waypoint_v3.h"
 #include "waypoint_file_c/waypoint_v3_test_file_kmz.h"
@@ -34,6 +38,16 @@
 
 /* Private constants ---------------------------------------------------------*/
 #define DJI_TEST_WAYPOINT_V3_KMZ_FILE_PATH_LEN_MAX         (256)
+#define DJI_TEST_WAYPOINT_V3_SURVEY_LINE_NUM               (6)
+#define DJI_TEST_WAYPOINT_V3_SURVEY_WAYPOINT_NUM           (2 * DJI_TEST_WAYPOINT_V3_SURVEY_LINE_NUM)
+#define DJI_TEST_WAYPOINT_V3_SURVEY_ACTION_NUM             (3)
+#define DJI_TEST_WAYPOINT_V3_SURVEY_LINE_LENGTH_M          (150.0)
+#define DJI_TEST_WAYPOINT_V3_SURVEY_LINE_SPACING_M         (20.0)
+#define DJI_TEST_WAYPOINT_V3_SURVEY_HEIGHT_M               (60.0f)
+#define DJI_TEST_WAYPOINT_V3_SURVEY_LONGITUDE              (113.94255)
+#define DJI_TEST_WAYPOINT_V3_SURVEY_LATITUDE               (22.57765)
+#define DJI_TEST_WAYPOINT_V3_METER_PER_LATITUDE_DEGREE     (111320.0)
+#define DJI_TEST_WAYPOINT_V3_PI                            (3.14159265358979323846)
 
 /* Private types -------------------------------------------------------------*/
 
@@ -48,13 +62,14 @@ static T_DjiReturnCode DjiTest_WaypointV3MissionStateCallback(T_DjiWaypointV3Mis
 static T_DjiReturnCode DjiTest_WaypointV3ActionStateCallback(T_DjiWaypointV3ActionState actionState);
 #endif
 static T_DjiReturnCode DjiTest_WaypointV3WaitEndFlightStatus(T_DjiFcSubscriptionFlightStatus status);
+static T_DjiReturnCode DjiTest_WaypointV3WaitMissionEnd(void);
+static void DjiTest_WaypointV3GenerateSurveyMission(T_DjiTestKmzMission *mission, T_DjiTestKmzWaypoint *waypoints,
+                                                    T_DjiTestKmzAction *actions);
 
 /* Exported functions definition ---------------------------------------------*/
 T_DjiReturnCode DjiTest_WaypointV3RunSample(void)
 {
     T_DjiReturnCode returnCode;
-    T_DjiFcSubscriptionFlightStatus flightStatus = 0;
-    T_DjiDataTimestamp flightStatusTimestamp = {0};
 
 #ifdef SYSTEM_ARCH_LINUX
     T_DjiOsalHandler *osalHandler = DjiPlatform_GetOsalHandler();
@@ -152,71 +167,109 @@ close_file:
     kmzFile = NULL;
 #endif
 
-    returnCode = DjiFcSubscription_SubscribeTopic(DJI_FC_SUBSCRIPTION_TOPIC_STATUS_FLIGHT,
-                                                  DJI_DATA_SUBSCRIPTION_TOPIC_10_HZ,
-                                                  NULL);
+    DjiTest_WaypointV3WaitMissionEnd();
+
+out:
+#ifdef SYSTEM_ARCH_LINUX
+    if (kmzFile != NULL) {
+        fclose(kmzFile);
+    }
+#endif
+
+    return DjiWaypointV3_DeInit();
+}
+
+/**
+ * @brief Build a lawnmower survey in memory, validate it and fly it without any kmz file.
+ * @note Set the simulator of DJI Assistant 2 to longitude 113.94255 and latitude 22.57765 as for the test file.
+ */
+T_DjiReturnCode DjiTest_WaypointV3RunGeneratedMissionSample(void)
+{
+    T_DjiOsalHandler *osalHandler = DjiPlatform_GetOsalHandler();
+    T_DjiTestKmzWaypoint waypoints[DJI_TEST_WAYPOINT_V3_SURVEY_WAYPOINT_NUM];
+    T_DjiTestKmzAction actions[DJI_TEST_WAYPOINT_V3_SURVEY_ACTION_NUM];
+    T_DjiTestKmzMission mission;
+    T_DjiTestKmzBuilderConfig builderConfig;
+    T_DjiTestKmzBuilder *kmzBuilder;
+    T_DjiTestKmzValidateResult validateResult;
+    const uint8_t *kmzData = NULL;
+    uint32_t kmzSize = 0;
+    T_DjiReturnCode returnCode;
+
+    DjiTest_WaypointV3GenerateSurveyMission(&mission, waypoints, actions);
+
+    /* The builder carries its staging buffer and compressor state, too large for the stack of a task. */
+    kmzBuilder = osalHandler->Malloc(sizeof(T_DjiTestKmzBuilder));
+    if (kmzBuilder == NULL) {
+        USER_LOG_ERROR("Malloc kmz builder error.");
+        return DJI_ERROR_SYSTEM_MODULE_CODE_MEMORY_ALLOC_FAILED;
+    }
+
+    DjiTest_KmzBuilderGetDefaultConfig(&builderConfig);
+    returnCode = DjiTest_KmzBuilderInit(kmzBuilder, &builderConfig);
     if (returnCode != DJI_ERROR_SYSTEM_MODULE_CODE_SUCCESS) {
-        USER_LOG_ERROR("Subscribe topic flight status failed, error code:0x%08llX", returnCode);
-        goto out;
+        USER_LOG_ERROR("Kmz builder init failed, error code:0x%08llX", returnCode);
+        goto free_builder;
     }
 
-    DjiTest_WidgetLogAppend("aircraft on the ground, motors stoped...");
-    USER_LOG_INFO("The aircraft is on the ground and motors are stoped...");
-    returnCode = DjiTest_WaypointV3WaitEndFlightStatus(DJI_FC_SUBSCRIPTION_FLIGHT_STATUS_STOPED);
+    returnCode = DjiTest_KmzBuilderBuild(kmzBuilder, &mission, &kmzData, &kmzSize, &validateResult);
     if (returnCode != DJI_ERROR_SYSTEM_MODULE_CODE_SUCCESS) {
-        USER_LOG_ERROR("Wait end flight status error.");
-        goto out;
+        if (!validateResult.isValid) {
+            USER_LOG_ERROR("Generated mission is rejected at waypoint %d action %d: %s",
+                           (int32_t) validateResult.waypointIndex, (int32_t) validateResult.actionIndex,
+                           validateResult.message);
+        } else {
+            USER_LOG_ERROR("Build kmz failed, error code:0x%08llX", returnCode);
+        }
+        goto deinit_builder;
     }
+    USER_LOG_INFO("Generated kmz of %d bytes, wayline %.1f m, about %.0f s.", kmzSize, validateResult.totalDistance,
+                  validateResult.estimatedDuration);
 
-    DjiTest_WidgetLogAppend("aircraft on the ground, motors rotating...");
-    USER_LOG_INFO("The aircraft is on the ground and motors are rotating...");
-    returnCode = DjiTest_WaypointV3WaitEndFlightStatus(DJI_FC_SUBSCRIPTION_FLIGHT_STATUS_ON_GROUND);
+    returnCode = DjiWaypointV3_Init();
     if (returnCode != DJI_ERROR_SYSTEM_MODULE_CODE_SUCCESS) {
-        USER_LOG_ERROR("Wait end flight status error.");
-        goto out;
+        USER_LOG_ERROR("Waypoint v3 init failed.");
+        goto deinit_builder;
     }
 
-    DjiTest_WidgetLogAppend("aircraft in the air...");
-    USER_LOG_INFO("The aircraft is in the air...");
-    returnCode = DjiTest_WaypointV3WaitEndFlightStatus(DJI_FC_SUBSCRIPTION_FLIGHT_STATUS_IN_AIR);
+#ifdef SYSTEM_ARCH_LINUX
+    returnCode = DjiWaypointV3_RegMissionStateCallback(DjiTest_WaypointV3MissionStateCallback);
     if (returnCode != DJI_ERROR_SYSTEM_MODULE_CODE_SUCCESS) {
-        USER_LOG_ERROR("Wait end flight status error.");
-        goto out;
+        USER_LOG_ERROR("Register waypoint v3 state callback failed.");
+        goto deinit_waypoint;
     }
 
-    DjiTest_WidgetLogAppend("aircraft on the ground, motors rotating...");
-    USER_LOG_INFO("The aircraft is on the ground and motors are rotating...");
-    returnCode = DjiTest_WaypointV3WaitEndFlightStatus(DJI_FC_SUBSCRIPTION_FLIGHT_STATUS_ON_GROUND);
+    returnCode = DjiWaypointV3_RegActionStateCallback(DjiTest_WaypointV3ActionStateCallback);
     if (returnCode != DJI_ERROR_SYSTEM_MODULE_CODE_SUCCESS) {
-        USER_LOG_ERROR("Wait end flight status error.");
-        goto out;
+        USER_LOG_ERROR("Register waypoint v3 action state callback failed.");
+        goto deinit_waypoint;
     }
+#endif
 
-    returnCode = DjiFcSubscription_GetLatestValueOfTopic(DJI_FC_SUBSCRIPTION_TOPIC_STATUS_FLIGHT,
-                                                        (uint8_t *) &flightStatus,
-                                                        sizeof(T_DjiFcSubscriptionFlightStatus),
-                                                        &flightStatusTimestamp);
+    returnCode = DjiWaypointV3_UploadKmzFile(kmzData, kmzSize);
     if (returnCode != DJI_ERROR_SYSTEM_MODULE_CODE_SUCCESS) {
-        USER_LOG_ERROR("Get value of topic flight status failed, error code:0x%08llX", returnCode);
-        goto out;
+        USER_LOG_ERROR("Upload generated kmz failed.");
+        goto deinit_waypoint;
     }
 
-    if (flightStatus != DJI_FC_SUBSCRIPTION_FLIGHT_STATUS_STOPED) {
-        USER_LOG_ERROR("Aircraft's flight status error, motors are not stoped.");
-        goto out;
+    DjiTest_WidgetLogAppend("Execute start action");
+    USER_LOG_INFO("Execute start action");
+    returnCode = DjiWaypointV3_Action(DJI_WAYPOINT_V3_ACTION_START);
+    if (returnCode != DJI_ERROR_SYSTEM_MODULE_CODE_SUCCESS) {
+        USER_LOG_ERROR("Execute start action failed.");
+        goto deinit_waypoint;
     }
 
-    DjiTest_WidgetLogAppend("aircraft on the ground, motor toped.");
-    USER_LOG_INFO("The aircraft is on the ground now, and motor are stoped.");
+    returnCode = DjiTest_WaypointV3WaitMissionEnd();
 
-out:
-#ifdef SYSTEM_ARCH_LINUX
-    if (kmzFile != NULL) {
-        fclose(kmzFile);
-    }
-#endif
+deinit_waypoint:
+    DjiWaypointV3_DeInit();
+deinit_builder:
+    DjiTest_KmzBuilderDeInit(kmzBuilder);
+free_builder:
+    osalHandler->Free(kmzBuilder);
 
-    return DjiWaypointV3_DeInit();
+    return returnCode;
 }
 
 /* Private functions definition-----------------------------------------------*/
@@ -277,4 +330,126 @@ static T_DjiReturnCode DjiTest_WaypointV3WaitEndFlightStatus(T_DjiFcSubscription
     return DJI_ERROR_SYSTEM_MODULE_CODE_SUCCESS;
 }
 
+static T_DjiReturnCode DjiTest_WaypointV3WaitMissionEnd(void)
+{
+    T_DjiReturnCode returnCode;
+    T_DjiFcSubscriptionFlightStatus flightStatus = 0;
+    T_DjiDataTimestamp flightStatusTimestamp = {0};
+
+    returnCode = DjiFcSubscription_SubscribeTopic(DJI_FC_SUBSCRIPTION_TOPIC_STATUS_FLIGHT,
+                                                  DJI_DATA_SUBSCRIPTION_TOPIC_10_HZ,
+                                                  NULL);
+    if (returnCode != DJI_ERROR_SYSTEM_MODULE_CODE_SUCCESS) {
+        USER_LOG_ERROR("Subscribe topic flight status failed, error code:0x%08llX", returnCode);
+        return returnCode;
+    }
+
+    DjiTest_WidgetLogAppend("aircraft on the ground, motors stoped...");
+    USER_LOG_INFO("The aircraft is on the ground and motors are stoped...");
+    returnCode = DjiTest_WaypointV3WaitEndFlightStatus(DJI_FC_SUBSCRIPTION_FLIGHT_STATUS_STOPED);
+    if (returnCode != DJI_ERROR_SYSTEM_MODULE_CODE_SUCCESS) {
+        USER_LOG_ERROR("Wait end flight status error.");
+        return returnCode;
+    }
+
+    DjiTest_WidgetLogAppend("aircraft on the ground, motors rotating...");
+    USER_LOG_INFO("The aircraft is on the ground and motors are rotating...");
+    returnCode = DjiTest_WaypointV3WaitEndFlightStatus(DJI_FC_SUBSCRIPTION_FLIGHT_STATUS_ON_GROUND);
+    if (returnCode != DJI_ERROR_SYSTEM_MODULE_CODE_SUCCESS) {
+        USER_LOG_ERROR("Wait end flight status error.");
+        return returnCode;
+    }
+
+    DjiTest_WidgetLogAppend("aircraft in the air...");
+    USER_LOG_INFO("The aircraft is in the air...");
+    returnCode = DjiTest_WaypointV3WaitEndFlightStatus(DJI_FC_SUBSCRIPTION_FLIGHT_STATUS_IN_AIR);
+    if (returnCode != DJI_ERROR_SYSTEM_MODULE_CODE_SUCCESS) {
+        USER_LOG_ERROR("Wait end flight status error.");
+        return returnCode;
+    }
+
+    DjiTest_WidgetLogAppend("aircraft on the ground, motors rotating...");
+    USER_LOG_INFO("The aircraft is on the ground and motors are rotating...");
+    returnCode = DjiTest_WaypointV3WaitEndFlightStatus(DJI_FC_SUBSCRIPTION_FLIGHT_STATUS_ON_GROUND);
+    if (returnCode != DJI_ERROR_SYSTEM_MODULE_CODE_SUCCESS) {
+        USER_LOG_ERROR("Wait end flight status error.");
+        return returnCode;
+    }
+
+    returnCode = DjiFcSubscription_GetLatestValueOfTopic(DJI_FC_SUBSCRIPTION_TOPIC_STATUS_FLIGHT,
+                                                        (uint8_t *) &flightStatus,
+                                                        sizeof(T_DjiFcSubscriptionFlightStatus),
+                                                        &flightStatusTimestamp);
+    if (returnCode != DJI_ERROR_SYSTEM_MODULE_CODE_SUCCESS) {
+        USER_LOG_ERROR("Get value of topic flight status failed, error code:0x%08llX", returnCode);
+        return returnCode;
+    }
+
+    if (flightStatus != DJI_FC_SUBSCRIPTION_FLIGHT_STATUS_STOPED) {
+        USER_LOG_ERROR("Aircraft's flight status error, motors are not stoped.");
+        return DJI_ERROR_SYSTEM_MODULE_CODE_SYSTEM_ERROR;
+    }
+
+    DjiTest_WidgetLogAppend("aircraft on the ground, motor toped.");
+    USER_LOG_INFO("The aircraft is on the ground now, and motor are stoped.");
+
+    return DJI_ERROR_SYSTEM_MODULE_CODE_SUCCESS;
+}
+
+/**
+ * @brief Parallel lines from west to east and back, joined by coordinate turns, recording the whole survey.
+ */
+static void DjiTest_WaypointV3GenerateSurveyMission(T_DjiTestKmzMission *mission, T_DjiTestKmzWaypoint *waypoints,
+                                                    T_DjiTestKmzAction *actions)
+{
+    dji_f64_t meterPerLongitudeDegree = DJI_TEST_WAYPOINT_V3_METER_PER_LATITUDE_DEGREE *
+                                        cos(DJI_TEST_WAYPOINT_V3_SURVEY_LATITUDE * DJI_TEST_WAYPOINT_V3_PI / 180);
+    dji_f64_t lineLength = DJI_TEST_WAYPOINT_V3_SURVEY_LINE_LENGTH_M / meterPerLongitudeDegree;
+    uint32_t line;
+    uint32_t i;
+
+    memset(waypoints, 0, sizeof(T_DjiTestKmzWaypoint) * DJI_TEST_WAYPOINT_V3_SURVEY_WAYPOINT_NUM);
+    for (i = 0; i < DJI_TEST_WAYPOINT_V3_SURVEY_WAYPOINT_NUM; i++) {
+        line = i / 2;
+        waypoints[i].latitude = DJI_TEST_WAYPOINT_V3_SURVEY_LATITUDE +
+                                line * DJI_TEST_WAYPOINT_V3_SURVEY_LINE_SPACING_M /
+                                DJI_TEST_WAYPOINT_V3_METER_PER_LATITUDE_DEGREE;
+        /* Even lines fly east, odd lines fly back west. */
+        waypoints[i].longitude = DJI_TEST_WAYPOINT_V3_SURVEY_LONGITUDE + ((i % 2) != (line % 2) ? lineLength : 0);
+        waypoints[i].height = DJI_TEST_WAYPOINT_V3_SURVEY_HEIGHT_M;
+        waypoints[i].headingMode = DJI_TEST_KMZ_HEADING_MODE_FOLLOW_WAYLINE;
+        waypoints[i].turnMode = DJI_TEST_KMZ_TURN_MODE_COORDINATE_TURN;
+        waypoints[i].turnDampingDist = 5.0f;
+    }
+    waypoints[0].turnMode = DJI_TEST_KMZ_TURN_MODE_STOP_WITH_DISCONTINUITY_CURVATURE;
+    waypoints[DJI_TEST_WAYPOINT_V3_SURVEY_WAYPOINT_NUM - 1].turnMode =
+        DJI_TEST_KMZ_TURN_MODE_STOP_WITH_DISCONTINUITY_CURVATURE;
+
+    memset(actions, 0, sizeof(T_DjiTestKmzAction) * DJI_TEST_WAYPOINT_V3_SURVEY_ACTION_NUM);
+    actions[0].waypointIndex = 0;
+    actions[0].type = DJI_TEST_KMZ_ACTION_GIMBAL_ROTATE;
+    actions[0].gimbalPitch = -90.0f;
+    actions[1].waypointIndex = 0;
+    actions[1].type = DJI_TEST_KMZ_ACTION_START_RECORD;
+    strcpy(actions[1].fileSuffix, "survey");
+    actions[2].waypointIndex = DJI_TEST_WAYPOINT_V3_SURVEY_WAYPOINT_NUM - 1;
+    actions[2].type = DJI_TEST_KMZ_ACTION_STOP_RECORD;
+
+    memset(mission, 0, sizeof(T_DjiTestKmzMission));
+    mission->finishAction = DJI_TEST_KMZ_FINISH_ACTION_GO_HOME;
+    mission->rcLostAction = DJI_TEST_KMZ_RC_LOST_ACTION_GO_BACK;
+    mission->takeOffSecurityHeight = 20.0f;
+    mission->globalTransitionalSpeed = 10.0f;
+    mission->autoFlightSpeed = 5.0f;
+    mission->droneEnumValue = 77;
+    mission->payloadEnumValue = 66;
+    mission->waypoints = waypoints;
+    mission->waypointNum = DJI_TEST_WAYPOINT_V3_SURVEY_WAYPOINT_NUM;
+    mission->actions = actions;
+    mission->actionNum = DJI_TEST_WAYPOINT_V3_SURVEY_ACTION_NUM;
+#ifdef SYSTEM_ARCH_LINUX
+    mission->createTimeMs = (uint64_t) time(NULL) * 1000;
+#endif
+}
+
 /****************** (C) COPYRIGHT DJI Innovations *****END OF FILE****/
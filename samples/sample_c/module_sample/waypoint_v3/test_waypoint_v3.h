@@ -40,6 +40,7 @@ extern "C" {
 
 /* Exported functions --------------------------------------------------------*/
 T_DjiReturnCode DjiTest_WaypointV3RunSample(void);
+T_DjiReturnCode DjiTest_WaypointV3RunGeneratedMissionSample(void);
 
 #ifdef __cplusplus
 }
@@ -0,0 +1,906 @@
+/**
+ ********************************************************************
+ * @file    test_waypoint_v3_kmz.c
+ * @brief   Builds waypoint v3 kmz missions in memory and validates them before upload.
+ *
+ * @copyright (c) 2021 DJI. All rights reserved.
+ *
+ * All information contained herein is, and remains, the property of DJI.
+ * The intellectual and technical concepts contained herein are proprietary
+ * to DJI and may be covered by U.S. and foreign patents, patents in process,
+ * and protected by trade secret or copyright law.  Dissemination of this
+ * information, including but not limited to data and other proprietary
+ * material(s) incorporated within the information, in any form, is strictly
+ * prohibited without the express written consent of DJI.
+ *
+ * If you receive this source code without DJI’s authorization, you may not
+ * further disseminate the information, and you must immediately remove the
+ * source code and notify DJI of its removal. DJI reserves the right to pursue
+ * legal actions against you for any loss(es) or damage(s) caused by your
+ * failure to do so.
+ *
+ *********************************************************************
+ */
+
+
+/* Includes ------------------------------------------------------------------*/
+#include "test_waypoint_v3_kmz.h"
+#include <math.h>
+#include <stdarg.h>
+#include <stdio.h>
+#include <string.h>
+#include "dji_platform.h"
+
+/* Private constants ---------------------------------------------------------*/
+#define DJI_TEST_KMZ_TEMPLATE_FILE_NAME         "wpmz/template.kml"
+#define DJI_TEST_KMZ_WAYLINES_FILE_NAME         "wpmz/waylines.wpml"
+#define DJI_TEST_KMZ_NUMBER_MAX_LEN             32
+#define DJI_TEST_KMZ_EARTH_RADIUS               6371000.0
+#define DJI_TEST_KMZ_PI                         3.14159265358979323846
+#define DJI_TEST_KMZ_COORDINATE_DECIMALS        10
+#define DJI_TEST_KMZ_VALUE_DECIMALS             3
+#define DJI_TEST_KMZ_MS_PER_DAY                 86400000ULL
+
+/* Private types -------------------------------------------------------------*/
+
+/* Private functions declaration ---------------------------------------------*/
+static T_DjiReturnCode DjiTest_KmzValidateFail(T_DjiTestKmzValidateResult *result, uint32_t waypointIndex,
+                                               uint32_t actionIndex, const char *fmt, ...);
+static T_DjiReturnCode DjiTest_KmzValidateAction(const T_DjiTestKmzAction *action, const T_DjiTestKmzLimits *limits,
+                                                 bool *isRecording, T_DjiTestKmzValidateResult *result,
+                                                 uint32_t actionIndex);
+static bool DjiTest_KmzIsInRange(dji_f64_t value, dji_f64_t min, dji_f64_t max);
+static bool DjiTest_KmzIsStopTurnMode(E_DjiTestKmzTurnMode turnMode);
+static dji_f64_t DjiTest_KmzGetDistance(const T_DjiTestKmzWaypoint *from, const T_DjiTestKmzWaypoint *to);
+static dji_f64_t DjiTest_KmzGetSegmentSpeed(const T_DjiTestKmzMission *mission, const T_DjiTestKmzWaypoint *from);
+static void DjiTest_KmzSetModifyTime(T_DjiTestKmzBuilder *builder, uint64_t unixTimeMs);
+
+static T_DjiReturnCode DjiTest_KmzWriteEntry(T_DjiTestKmzBuilder *builder, const char *name,
+                                             const T_DjiTestKmzMission *mission,
+                                             const T_DjiTestKmzValidateResult *result, bool isTemplate);
+static void DjiTest_KmzWriteMissionConfig(T_DjiTestKmzBuilder *builder, const T_DjiTestKmzMission *mission);
+static void DjiTest_KmzWriteTemplateFolder(T_DjiTestKmzBuilder *builder, const T_DjiTestKmzMission *mission);
+static void DjiTest_KmzWriteWaylinesFolder(T_DjiTestKmzBuilder *builder, const T_DjiTestKmzMission *mission,
+                                           const T_DjiTestKmzValidateResult *result);
+static void DjiTest_KmzWritePlacemark(T_DjiTestKmzBuilder *builder, const T_DjiTestKmzMission *mission,
+                                      uint32_t index, const T_DjiTestKmzAction *actions, uint32_t actionNum,
+                                      bool isTemplate);
+static void DjiTest_KmzWriteAction(T_DjiTestKmzBuilder *builder, const T_DjiTestKmzAction *action, uint32_t actionId);
+
+static void DjiTest_KmzPut(T_DjiTestKmzBuilder *builder, const char *data, uint32_t len);
+static void DjiTest_KmzPutString(T_DjiTestKmzBuilder *builder, const char *str);
+static void DjiTest_KmzPutEscaped(T_DjiTestKmzBuilder *builder, const char *str);
+static void DjiTest_KmzPutNumber(T_DjiTestKmzBuilder *builder, dji_f64_t value, uint8_t decimals);
+static void DjiTest_KmzPutNumberElement(T_DjiTestKmzBuilder *builder, const char *open, dji_f64_t value,
+                                        uint8_t decimals, const char *close);
+static void DjiTest_KmzPutStringElement(T_DjiTestKmzBuilder *builder, const char *open, const char *value,
+                                        const char *close);
+static void DjiTest_KmzFlush(T_DjiTestKmzBuilder *builder);
+static uint32_t DjiTest_KmzFormatNumber(char *out, dji_f64_t value, uint8_t decimals);
+
+/* Private values ------------------------------------------------------------*/
+static const char *const s_finishActionNames[] = {"goHome", "noAction", "autoLand", "gotoFirstWaypoint"};
+static const char *const s_rcLostActionNames[] = {"goBack", "landing", "hover"};
+static const char *const s_headingModeNames[] = {"followWayline", "manually", "fixed", "smoothTransition"};
+static const char *const s_turnModeNames[] = {
+    "coordinateTurn",
+    "toPointAndStopWithDiscontinuityCurvature",
+    "toPointAndStopWithContinuityCurvature",
+    "toPointAndPassWithContinuityCurvature",
+};
+static const char *const s_actionNames[] = {"takePhoto", "startRecord", "stopRecord", "gimbalRotate", "zoom", "hover"};
+static const uint64_t s_powersOfTen[DJI_TEST_KMZ_COORDINATE_DECIMALS + 1] = {
+    1ULL, 10ULL, 100ULL, 1000ULL, 10000ULL, 100000ULL, 1000000ULL, 10000000ULL, 100000000ULL, 1000000000ULL,
+    10000000000ULL
+};
+
+/* Exported functions definition ---------------------------------------------*/
+void DjiTest_KmzGetDefaultLimits(T_DjiTestKmzLimits *limits)
+{
+    memset(limits, 0, sizeof(T_DjiTestKmzLimits));
+    limits->maxWaypointNum = 65535;
+    limits->maxActionNumPerWaypoint = 16;
+    limits->minHeight = -200.0f;
+    limits->maxHeight = 1500.0f;
+    limits->minSpeed = 1.0f;
+    limits->maxSpeed = 15.0f;
+    limits->minWaypointSpacing = 0.5f;
+    limits->maxTotalDistance = 0;
+    limits->minGimbalPitch = -120.0f;
+    limits->maxGimbalPitch = 45.0f;
+    limits->maxFocalLength = 1000.0f;
+    limits->maxHoverTime = 900.0f;
+    limits->acceleration = 2.0f;
+}
+
+/**
+ * @brief Check the geometry and the actions of a mission against the limits before it is built or uploaded.
+ * @note Distances use an equirectangular projection around each segment, which is well below a meter of error for
+ * segments of a few kilometers. The first and last waypoints must stop since there is no segment to turn onto.
+ * @return DJI_ERROR_SYSTEM_MODULE_CODE_INVALID_PARAMETER with the reason in the result if the mission is rejected.
+ */
+T_DjiReturnCode DjiTest_KmzValidateMission(const T_DjiTestKmzMission *mission, const T_DjiTestKmzLimits *limits,
+                                           T_DjiTestKmzValidateResult *result)
+{
+    const T_DjiTestKmzWaypoint *waypoint;
+    dji_f64_t segment = 0;
+    dji_f64_t nextSegment;
+    dji_f64_t speed;
+    uint32_t actionNumAtWaypoint = 0;
+    bool isRecording = false;
+    uint32_t i;
+    T_DjiReturnCode returnCode;
+
+    if (mission == NULL || limits == NULL || result == NULL) {
+        return DJI_ERROR_SYSTEM_MODULE_CODE_INVALID_PARAMETER;
+    }
+
+    memset(result, 0, sizeof(T_DjiTestKmzValidateResult));
+    result->waypointIndex = DJI_TEST_KMZ_INDEX_NONE;
+    result->actionIndex = DJI_TEST_KMZ_INDEX_NONE;
+
+    if (mission->waypoints == NULL || mission->waypointNum < 2 || mission->waypointNum > limits->maxWaypointNum) {
+        return DjiTest_KmzValidateFail(result, DJI_TEST_KMZ_INDEX_NONE, DJI_TEST_KMZ_INDEX_NONE,
+                                       "Waypoint number %u is out of 2 to %u.", mission->waypointNum,
+                                       limits->maxWaypointNum);
+    }
+    if (mission->actionNum > 0 && mission->actions == NULL) {
+        return DjiTest_KmzValidateFail(result, DJI_TEST_KMZ_INDEX_NONE, DJI_TEST_KMZ_INDEX_NONE,
+                                       "Action array is missing.");
+    }
+    if (mission->finishAction > DJI_TEST_KMZ_FINISH_ACTION_GOTO_FIRST_WAYPOINT ||
+        mission->rcLostAction > DJI_TEST_KMZ_RC_LOST_ACTION_HOVER) {
+        return DjiTest_KmzValidateFail(result, DJI_TEST_KMZ_INDEX_NONE, DJI_TEST_KMZ_INDEX_NONE,
+                                       "Unknown finish or rc lost action.");
+    }
+    if (!DjiTest_KmzIsInRange(mission->autoFlightSpeed, limits->minSpeed, limits->maxSpeed) ||
+        !DjiTest_KmzIsInRange(mission->globalTransitionalSpeed, limits->minSpeed, limits->maxSpeed)) {
+        return DjiTest_KmzValidateFail(result, DJI_TEST_KMZ_INDEX_NONE, DJI_TEST_KMZ_INDEX_NONE,
+                                       "Global speeds must be in %.1f to %.1f m/s.", limits->minSpeed,
+                                       limits->maxSpeed);
+    }
+    if (!DjiTest_KmzIsInRange(mission->takeOffSecurityHeight, 1.2, limits->maxHeight)) {
+        return DjiTest_KmzValidateFail(result, DJI_TEST_KMZ_INDEX_NONE, DJI_TEST_KMZ_INDEX_NONE,
+                                       "Take-off security height %.1f m is out of range.",
+                                       mission->takeOffSecurityHeight);
+    }
+
+    for (i = 0; i < mission->waypointNum; i++) {
+        waypoint = &mission->waypoints[i];
+
+        if (!DjiTest_KmzIsInRange(waypoint->longitude, -180.0, 180.0) ||
+            !DjiTest_KmzIsInRange(waypoint->latitude, -90.0, 90.0)) {
+            return DjiTest_KmzValidateFail(result, i, DJI_TEST_KMZ_INDEX_NONE, "Invalid coordinate.");
+        }
+        if (!DjiTest_KmzIsInRange(waypoint->height, limits->minHeight, limits->maxHeight)) {
+            return DjiTest_KmzValidateFail(result, i, DJI_TEST_KMZ_INDEX_NONE, "Height %.1f m is out of %.1f to %.1f.",
+                                           waypoint->height, limits->minHeight, limits->maxHeight);
+        }
+        if (waypoint->speed != 0 && !DjiTest_KmzIsInRange(waypoint->speed, limits->minSpeed, limits->maxSpeed)) {
+            return DjiTest_KmzValidateFail(result, i, DJI_TEST_KMZ_INDEX_NONE, "Speed %.1f m/s is out of %.1f to %.1f.",
+                                           waypoint->speed, limits->minSpeed, limits->maxSpeed);
+        }
+        if (waypoint->headingMode > DJI_TEST_KMZ_HEADING_MODE_SMOOTH_TRANSITION ||
+            !DjiTest_KmzIsInRange(waypoint->headingAngle, -180.0, 180.0)) {
+            return DjiTest_KmzValidateFail(result, i, DJI_TEST_KMZ_INDEX_NONE, "Invalid heading.");
+        }
+        if (waypoint->turnMode > DJI_TEST_KMZ_TURN_MODE_PASS_WITH_CONTINUITY_CURVATURE) {
+            return DjiTest_KmzValidateFail(result, i, DJI_TEST_KMZ_INDEX_NONE, "Unknown turn mode.");
+        }
+
+        if (i > 0) {
+            segment = DjiTest_KmzGetDistance(&mission->waypoints[i - 1], waypoint);
+            if (segment < limits->minWaypointSpacing) {
+                return DjiTest_KmzValidateFail(result, i, DJI_TEST_KMZ_INDEX_NONE,
+                                               "Only %.2f m from the previous waypoint.", segment);
+            }
+            result->totalDistance += segment;
+            result->estimatedDuration += segment / DjiTest_KmzGetSegmentSpeed(mission, &mission->waypoints[i - 1]);
+        }
+
+        if (DjiTest_KmzIsStopTurnMode(waypoint->turnMode)) {
+            /* Braking to the waypoint and speeding up again, each half a speed / acceleration longer than cruising. */
+            if (i > 0 && i + 1 < mission->waypointNum && limits->acceleration > 0) {
+                speed = DjiTest_KmzGetSegmentSpeed(mission, waypoint);
+                result->estimatedDuration += speed / limits->acceleration;
+            }
+        } else if (i == 0 || i + 1 == mission->waypointNum) {
+            return DjiTest_KmzValidateFail(result, i, DJI_TEST_KMZ_INDEX_NONE,
+                                           "The first and the last waypoint must stop.");
+        } else if (waypoint->turnMode == DJI_TEST_KMZ_TURN_MODE_COORDINATE_TURN) {
+            nextSegment = DjiTest_KmzGetDistance(waypoint, &mission->waypoints[i + 1]);
+            if (!(waypoint->turnDampingDist > 0) || waypoint->turnDampingDist >= segment / 2 ||
+                waypoint->turnDampingDist >= nextSegment / 2) {
+                return DjiTest_KmzValidateFail(result, i, DJI_TEST_KMZ_INDEX_NONE,
+                                               "Damping distance %.2f m must be below half of both segments.",
+                                               waypoint->turnDampingDist);
+            }
+        }
+    }
+
+    if (limits->maxTotalDistance > 0 && result->totalDistance > limits->maxTotalDistance) {
+        return DjiTest_KmzValidateFail(result, DJI_TEST_KMZ_INDEX_NONE, DJI_TEST_KMZ_INDEX_NONE,
+                                       "Wayline of %.0f m is longer than %.0f m.", result->totalDistance,
+                                       limits->maxTotalDistance);
+    }
+
+    for (i = 0; i < mission->actionNum; i++) {
+        if (i > 0 && mission->actions[i].waypointIndex < mission->actions[i - 1].waypointIndex) {
+            return DjiTest_KmzValidateFail(result, mission->actions[i].waypointIndex, i,
+                                           "Actions are not sorted by waypoint.");
+        }
+        if (i > 0 && mission->actions[i].waypointIndex == mission->actions[i - 1].waypointIndex) {
+            actionNumAtWaypoint++;
+        } else {
+            actionNumAtWaypoint = 1;
+        }
+        if (actionNumAtWaypoint > limits->maxActionNumPerWaypoint) {
+            return DjiTest_KmzValidateFail(result, mission->actions[i].waypointIndex, i,
+                                           "More than %u actions on one waypoint.", limits->maxActionNumPerWaypoint);
+        }
+
+        returnCode = DjiTest_KmzValidateAction(&mission->actions[i], limits, &isRecording, result, i);
+        if (returnCode != DJI_ERROR_SYSTEM_MODULE_CODE_SUCCESS) {
+            return returnCode;
+        }
+        if (mission->actions[i].type == DJI_TEST_KMZ_ACTION_HOVER) {
+            result->estimatedDuration += mission->actions[i].hoverTime;
+        }
+    }
+
+    if (isRecording) {
+        return DjiTest_KmzValidateFail(result, DJI_TEST_KMZ_INDEX_NONE, DJI_TEST_KMZ_INDEX_NONE,
+                                       "Record is not stopped at the end of the mission.");
+    }
+
+    result->isValid = true;
+
+    return DJI_ERROR_SYSTEM_MODULE_CODE_SUCCESS;
+}
+
+void DjiTest_KmzBuilderGetDefaultConfig(T_DjiTestKmzBuilderConfig *config)
+{
+    memset(config, 0, sizeof(T_DjiTestKmzBuilderConfig));
+    config->isCompressed = true;
+    config->maxChainLength = UTIL_DEFLATE_DEFAULT_MAX_CHAIN_LENGTH;
+    config->initialBufferSize = 64 * 1024;
+    DjiTest_KmzGetDefaultLimits(&config->limits);
+}
+
+T_DjiReturnCode DjiTest_KmzBuilderInit(T_DjiTestKmzBuilder *builder, const T_DjiTestKmzBuilderConfig *config)
+{
+    T_DjiOsalHandler *osalHandler = DjiPlatform_GetOsalHandler();
+    T_DjiReturnCode returnCode;
+
+    if (builder == NULL || config == NULL) {
+        return DJI_ERROR_SYSTEM_MODULE_CODE_INVALID_PARAMETER;
+    }
+
+    memset(builder, 0, sizeof(T_DjiTestKmzBuilder));
+    builder->config = *config;
+
+    if (config->isCompressed) {
+        builder->deflateMemory = osalHandler->Malloc(UtilDeflate_GetMemorySize());
+        if (builder->deflateMemory == NULL) {
+            return DJI_ERROR_SYSTEM_MODULE_CODE_MEMORY_ALLOC_FAILED;
+        }
+
+        returnCode = UtilDeflate_Init(&builder->deflate, builder->deflateMemory, UtilDeflate_GetMemorySize(),
+                                      config->maxChainLength);
+        if (returnCode != DJI_ERROR_SYSTEM_MODULE_CODE_SUCCESS) {
+            goto free_deflate;
+        }
+    }
+
+    returnCode = UtilZip_WriterInit(&builder->zipWriter, config->initialBufferSize,
+                                    config->isCompressed ? &builder->deflate : NULL);
+    if (returnCode != DJI_ERROR_SYSTEM_MODULE_CODE_SUCCESS) {
+        goto free_deflate;
+    }
+
+    return DJI_ERROR_SYSTEM_MODULE_CODE_SUCCESS;
+
+free_deflate:
+    if (builder->deflateMemory != NULL) {
+        osalHandler->Free(builder->deflateMemory);
+        builder->deflateMemory = NULL;
+    }
+
+    return returnCode;
+}
+
+T_DjiReturnCode DjiTest_KmzBuilderDeInit(T_DjiTestKmzBuilder *builder)
+{
+    T_DjiOsalHandler *osalHandler = DjiPlatform_GetOsalHandler();
+
+    UtilZip_WriterDeInit(&builder->zipWriter);
+    if (builder->deflateMemory != NULL) {
+        osalHandler->Free(builder->deflateMemory);
+        builder->deflateMemory = NULL;
+    }
+
+    return DJI_ERROR_SYSTEM_MODULE_CODE_SUCCESS;
+}
+
+T_DjiReturnCode DjiTest_KmzBuilderBuild(T_DjiTestKmzBuilder *builder, const T_DjiTestKmzMission *mission,
+                                        const uint8_t **kmzData, uint32_t *kmzSize,
+                                        T_DjiTestKmzValidateResult *result)
+{
+    T_DjiTestKmzValidateResult localResult;
+    T_DjiReturnCode returnCode;
+
+    if (builder == NULL || kmzData == NULL || kmzSize == NULL) {
+        return DJI_ERROR_SYSTEM_MODULE_CODE_INVALID_PARAMETER;
+    }
+    if (result == NULL) {
+        result = &localResult;
+    }
+
+    returnCode = DjiTest_KmzValidateMission(mission, &builder->config.limits, result);
+    if (returnCode != DJI_ERROR_SYSTEM_MODULE_CODE_SUCCESS) {
+        return returnCode;
+    }
+
+    UtilZip_WriterReset(&builder->zipWriter);
+    DjiTest_KmzSetModifyTime(builder, mission->createTimeMs);
+
+    returnCode = DjiTest_KmzWriteEntry(builder, DJI_TEST_KMZ_TEMPLATE_FILE_NAME, mission, result, true);
+    if (returnCode != DJI_ERROR_SYSTEM_MODULE_CODE_SUCCESS) {
+        return returnCode;
+    }
+
+    returnCode = DjiTest_KmzWriteEntry(builder, DJI_TEST_KMZ_WAYLINES_FILE_NAME, mission, result, false);
+    if (returnCode != DJI_ERROR_SYSTEM_MODULE_CODE_SUCCESS) {
+        return returnCode;
+    }
+
+    return UtilZip_WriterFinish(&builder->zipWriter, kmzData, kmzSize);
+}
+
+/* Private functions definition-----------------------------------------------*/
+static T_DjiReturnCode DjiTest_KmzValidateFail(T_DjiTestKmzValidateResult *result, uint32_t waypointIndex,
+                                               uint32_t actionIndex, const char *fmt, ...)
+{
+    va_list args;
+
+    result->isValid = false;
+    result->waypointIndex = waypointIndex;
+    result->actionIndex = actionIndex;
+
+    va_start(args, fmt);
+    vsnprintf(result->message, sizeof(result->message), fmt, args);
+    va_end(args);
+
+    return DJI_ERROR_SYSTEM_MODULE_CODE_INVALID_PARAMETER;
+}
+
+static T_DjiReturnCode DjiTest_KmzValidateAction(const T_DjiTestKmzAction *action, const T_DjiTestKmzLimits *limits,
+                                                 bool *isRecording, T_DjiTestKmzValidateResult *result,
+                                                 uint32_t actionIndex)
+{
+    if (memchr(action->fileSuffix, '\0', sizeof(action->fileSuffix)) == NULL) {
+        return DjiTest_KmzValidateFail(result, action->waypointIndex, actionIndex, "File suffix is not terminated.");
+    }
+
+    switch (action->type) {
+        case DJI_TEST_KMZ_ACTION_TAKE_PHOTO:
+            break;
+        case DJI_TEST_KMZ_ACTION_START_RECORD:
+            if (*isRecording) {
+                return DjiTest_KmzValidateFail(result, action->waypointIndex, actionIndex, "Record already started.");
+            }
+            *isRecording = true;
+            break;
+        case DJI_TEST_KMZ_ACTION_STOP_RECORD:
+            if (!*isRecording) {
+                return DjiTest_KmzValidateFail(result, action->waypointIndex, actionIndex, "Record is not started.");
+            }
+            *isRecording = false;
+            break;
+        case DJI_TEST_KMZ_ACTION_GIMBAL_ROTATE:
+            if (!DjiTest_KmzIsInRange(action->gimbalPitch, limits->minGimbalPitch, limits->maxGimbalPitch) ||
+                !DjiTest_KmzIsInRange(action->gimbalYaw, -180.0, 180.0)) {
+                return DjiTest_KmzValidateFail(result, action->waypointIndex, actionIndex,
+                                               "Gimbal pitch %.1f must be in %.1f to %.1f.", action->gimbalPitch,
+                                               limits->minGimbalPitch, limits->maxGimbalPitch);
+            }
+            break;
+        case DJI_TEST_KMZ_ACTION_ZOOM:
+            if (!(action->focalLength > 0) || action->focalLength > limits->maxFocalLength) {
+                return DjiTest_KmzValidateFail(result, action->waypointIndex, actionIndex,
+                                               "Focal length %.1f mm is out of range.", action->focalLength);
+            }
+            break;
+        case DJI_TEST_KMZ_ACTION_HOVER:
+            if (!(action->hoverTime > 0) || action->hoverTime > limits->maxHoverTime) {
+                return DjiTest_KmzValidateFail(result, action->waypointIndex, actionIndex,
+                                               "Hover time %.1f s is out of range.", action->hoverTime);
+            }
+            break;
+        default:
+            return DjiTest_KmzValidateFail(result, action->waypointIndex, actionIndex, "Unknown action type.");
+    }
+
+    return DJI_ERROR_SYSTEM_MODULE_CODE_SUCCESS;
+}
+
+static bool DjiTest_KmzIsInRange(dji_f64_t value, dji_f64_t min, dji_f64_t max)
+{
+    /* Written so that nan fails as well. */
+    return value >= min && value <= max;
+}
+
+static bool DjiTest_KmzIsStopTurnMode(E_DjiTestKmzTurnMode turnMode)
+{
+    return turnMode == DJI_TEST_KMZ_TURN_MODE_STOP_WITH_DISCONTINUITY_CURVATURE ||
+           turnMode == DJI_TEST_KMZ_TURN_MODE_STOP_WITH_CONTINUITY_CURVATURE;
+}
+
+static dji_f64_t DjiTest_KmzGetDistance(const T_DjiTestKmzWaypoint *from, const T_DjiTestKmzWaypoint *to)
+{
+    dji_f64_t meanLatitude = (from->latitude + to->latitude) / 2 * DJI_TEST_KMZ_PI / 180;
+    dji_f64_t east = (to->longitude - from->longitude) * DJI_TEST_KMZ_PI / 180 * cos(meanLatitude) *
+                     DJI_TEST_KMZ_EARTH_RADIUS;
+    dji_f64_t north = (to->latitude - from->latitude) * DJI_TEST_KMZ_PI / 180 * DJI_TEST_KMZ_EARTH_RADIUS;
+    dji_f64_t up = (dji_f64_t) to->height - from->height;
+
+    return sqrt(east * east + north * north + up * up);
+}
+
+static dji_f64_t DjiTest_KmzGetSegmentSpeed(const T_DjiTestKmzMission *mission, const T_DjiTestKmzWaypoint *from)
+{
+    return from->speed != 0 ? from->speed : mission->autoFlightSpeed;
+}
+
+static void DjiTest_KmzSetModifyTime(T_DjiTestKmzBuilder *builder, uint64_t unixTimeMs)
+{
+    uint64_t days = unixTimeMs / DJI_TEST_KMZ_MS_PER_DAY;
+    uint32_t secondOfDay = (uint32_t) (unixTimeMs % DJI_TEST_KMZ_MS_PER_DAY / 1000);
+    uint64_t z = days + 719468;
+    uint64_t era = z / 146097;
+    uint32_t dayOfEra = (uint32_t) (z - era * 146097);
+    uint32_t yearOfEra = (dayOfEra - dayOfEra / 1460 + dayOfEra / 36524 - dayOfEra / 146096) / 365;
+    uint32_t dayOfYear = dayOfEra - (365 * yearOfEra + yearOfEra / 4 - yearOfEra / 100);
+    uint32_t monthIndex = (5 * dayOfYear + 2) / 153;
+    uint32_t day = dayOfYear - (153 * monthIndex + 2) / 5 + 1;
+    uint32_t month = monthIndex < 10 ? monthIndex + 3 : monthIndex - 9;
+    uint64_t year = yearOfEra + era * 400 + (month <= 2 ? 1 : 0);
+
+    /* Civil date of the days since 1970, zip keeps local time but the mission only knows utc. */
+    UtilZip_WriterSetModifyTime(&builder->zipWriter, (uint16_t) (year > 2107 ? 2107 : year), (uint8_t) month,
+                                (uint8_t) day, (uint8_t) (secondOfDay / 3600), (uint8_t) (secondOfDay / 60 % 60),
+                                (uint8_t) (secondOfDay % 60));
+}
+
+static T_DjiReturnCode DjiTest_KmzWriteEntry(T_DjiTestKmzBuilder *builder, const char *name,
+                                             const T_DjiTestKmzMission *mission,
+                                             const T_DjiTestKmzValidateResult *result, bool isTemplate)
+{
+    T_DjiReturnCode returnCode;
+
+    returnCode = UtilZip_WriterBeginEntry(&builder->zipWriter, name, builder->config.isCompressed);
+    if (returnCode != DJI_ERROR_SYSTEM_MODULE_CODE_SUCCESS) {
+        return returnCode;
+    }
+
+    builder->xmlLen = 0;
+    builder->actionGroupId = 0;
+    DjiTest_KmzPutString(builder, "<?xml version=\"1.0\" encoding=\"UTF-8\"?>\n"
+                                  "<kml xmlns=\"http://www.opengis.net/kml/2.2\" "
+                                  "xmlns:wpml=\"http://www.dji.com/wpmz/1.0.3\">\n"
+                                  "  <Document>\n");
+    if (isTemplate) {
+        DjiTest_KmzPutNumberElement(builder, "    <wpml:createTime>", (dji_f64_t) mission->createTimeMs, 0,
+                                    "</wpml:createTime>\n");
+        DjiTest_KmzPutNumberElement(builder, "    <wpml:updateTime>", (dji_f64_t) mission->createTimeMs, 0,
+                                    "</wpml:updateTime>\n");
+    }
+    DjiTest_KmzWriteMissionConfig(builder, mission);
+    if (isTemplate) {
+        DjiTest_KmzWriteTemplateFolder(builder, mission);
+    } else {
+        DjiTest_KmzWriteWaylinesFolder(builder, mission, result);
+    }
+    DjiTest_KmzPutString(builder, "  </Document>\n"
+                                  "</kml>\n");
+    DjiTest_KmzFlush(builder);
+
+    return UtilZip_WriterEndEntry(&builder->zipWriter);
+}
+
+static void DjiTest_KmzWriteMissionConfig(T_DjiTestKmzBuilder *builder, const T_DjiTestKmzMission *mission)
+{
+    DjiTest_KmzPutString(builder, "    <wpml:missionConfig>\n"
+                                  "      <wpml:flyToWaylineMode>safely</wpml:flyToWaylineMode>\n");
+    DjiTest_KmzPutStringElement(builder, "      <wpml:finishAction>", s_finishActionNames[mission->finishAction],
+                                "</wpml:finishAction>\n");
+    DjiTest_KmzPutString(builder, "      <wpml:exitOnRCLost>executeLostAction</wpml:exitOnRCLost>\n");
+    DjiTest_KmzPutStringElement(builder, "      <wpml:executeRCLostAction>",
+                                s_rcLostActionNames[mission->rcLostAction], "</wpml:executeRCLostAction>\n");
+    DjiTest_KmzPutNumberElement(builder, "      <wpml:takeOffSecurityHeight>", mission->takeOffSecurityHeight,
+                                DJI_TEST_KMZ_VALUE_DECIMALS, "</wpml:takeOffSecurityHeight>\n");
+    DjiTest_KmzPutNumberElement(builder, "      <wpml:globalTransitionalSpeed>", mission->globalTransitionalSpeed,
+                                DJI_TEST_KMZ_VALUE_DECIMALS, "</wpml:globalTransitionalSpeed>\n");
+    DjiTest_KmzPutNumberElement(builder, "      <wpml:droneInfo>\n"
+                                         "        <wpml:droneEnumValue>", mission->droneEnumValue, 0,
+                                "</wpml:droneEnumValue>\n");
+    DjiTest_KmzPutNumberElement(builder, "        <wpml:droneSubEnumValue>", mission->droneSubEnumValue, 0,
+                                "</wpml:droneSubEnumValue>\n"
+                                "      </wpml:droneInfo>\n");
+    DjiTest_KmzPutNumberElement(builder, "      <wpml:payloadInfo>\n"
+                                         "        <wpml:payloadEnumValue>", mission->payloadEnumValue, 0,
+                                "</wpml:payloadEnumValue>\n");
+    DjiTest_KmzPutNumberElement(builder, "        <wpml:payloadSubEnumValue>", mission->payloadSubEnumValue, 0,
+                                "</wpml:payloadSubEnumValue>\n"
+                                "        <wpml:payloadPositionIndex>0</wpml:payloadPositionIndex>\n"
+                                "      </wpml:payloadInfo>\n"
+                                "    </wpml:missionConfig>\n");
+}
+
+static void DjiTest_KmzWriteTemplateFolder(T_DjiTestKmzBuilder *builder, const T_DjiTestKmzMission *mission)
+{
+    const T_DjiTestKmzAction *action = mission->actions;
+    const T_DjiTestKmzAction *actionEnd = mission->actions + mission->actionNum;
+    const T_DjiTestKmzAction *first;
+    uint32_t i;
+
+    DjiTest_KmzPutString(builder, "    <Folder>\n"
+                                  "      <wpml:templateType>waypoint</wpml:templateType>\n"
+                                  "      <wpml:templateId>0</wpml:templateId>\n"
+                                  "      <wpml:waylineCoordinateSysParam>\n"
+                                  "        <wpml:coordinateMode>WGS84</wpml:coordinateMode>\n"
+                                  "        <wpml:heightMode>relativeToStartPoint</wpml:heightMode>\n"
+                                  "        <wpml:positioningType>GPS</wpml:positioningType>\n"
+                                  "      </wpml:waylineCoordinateSysParam>\n");
+    DjiTest_KmzPutNumberElement(builder, "      <wpml:autoFlightSpeed>", mission->autoFlightSpeed,
+                                DJI_TEST_KMZ_VALUE_DECIMALS, "</wpml:autoFlightSpeed>\n");
+    DjiTest_KmzPutNumberElement(builder, "      <wpml:globalHeight>", mission->waypoints[0].height,
+                                DJI_TEST_KMZ_VALUE_DECIMALS, "</wpml:globalHeight>\n");
+    DjiTest_KmzPutString(builder, "      <wpml:caliFlightEnable>0</wpml:caliFlightEnable>\n"
+                                  "      <wpml:gimbalPitchMode>manual</wpml:gimbalPitchMode>\n"
+                                  "      <wpml:globalWaypointHeadingParam>\n"
+                                  "        <wpml:waypointHeadingMode>followWayline</wpml:waypointHeadingMode>\n"
+                                  "        <wpml:waypointHeadingAngle>0</wpml:waypointHeadingAngle>\n"
+                                  "        <wpml:waypointPoiPoint>0.000000,0.000000,0.000000</wpml:waypointPoiPoint>\n"
+                                  "        <wpml:waypointHeadingPoiIndex>0</wpml:waypointHeadingPoiIndex>\n"
+                                  "      </wpml:globalWaypointHeadingParam>\n"
+                                  "      <wpml:globalWaypointTurnMode>toPointAndStopWithDiscontinuityCurvature"
+                                  "</wpml:globalWaypointTurnMode>\n"
+                                  "      <wpml:globalUseStraightLine>1</wpml:globalUseStraightLine>\n");
+
+    for (i = 0; i < mission->waypointNum; i++) {
+        first = action;
+        while (action < actionEnd && action->waypointIndex == i) {
+            action++;
+        }
+        DjiTest_KmzWritePlacemark(builder, mission, i, first, (uint32_t) (action - first), true);
+    }
+
+    DjiTest_KmzPutString(builder, "      <wpml:payloadParam>\n"
+                                  "        <wpml:payloadPositionIndex>0</wpml:payloadPositionIndex>\n"
+                                  "      </wpml:payloadParam>\n"
+                                  "    </Folder>\n");
+}
+
+static void DjiTest_KmzWriteWaylinesFolder(T_DjiTestKmzBuilder *builder, const T_DjiTestKmzMission *mission,
+                                           const T_DjiTestKmzValidateResult *result)
+{
+    const T_DjiTestKmzAction *action = mission->actions;
+    const T_DjiTestKmzAction *actionEnd = mission->actions + mission->actionNum;
+    const T_DjiTestKmzAction *first;
+    uint32_t i;
+
+    DjiTest_KmzPutString(builder, "    <Folder>\n"
+                                  "      <wpml:templateId>0</wpml:templateId>\n"
+                                  "      <wpml:executeHeightMode>relativeToStartPoint</wpml:executeHeightMode>\n"
+                                  "      <wpml:waylineId>0</wpml:waylineId>\n");
+    DjiTest_KmzPutNumberElement(builder, "      <wpml:distance>", result->totalDistance, DJI_TEST_KMZ_VALUE_DECIMALS,
+                                "</wpml:distance>\n");
+    DjiTest_KmzPutNumberElement(builder, "      <wpml:duration>", result->estimatedDuration,
+                                DJI_TEST_KMZ_VALUE_DECIMALS, "</wpml:duration>\n");
+    DjiTest_KmzPutNumberElement(builder, "      <wpml:autoFlightSpeed>", mission->autoFlightSpeed,
+                                DJI_TEST_KMZ_VALUE_DECIMALS, "</wpml:autoFlightSpeed>\n");
+
+    for (i = 0; i < mission->waypointNum; i++) {
+        first = action;
+        while (action < actionEnd && action->waypointIndex == i) {
+            action++;
+        }
+        DjiTest_KmzWritePlacemark(builder, mission, i, first, (uint32_t) (action - first), false);
+    }
+
+    DjiTest_KmzPutString(builder, "    </Folder>\n");
+}
+
+/**
+ * @brief Write one placemark, the template lists every parameter explicitly instead of relying on global ones.
+ */
+static void DjiTest_KmzWritePlacemark(T_DjiTestKmzBuilder *builder, const T_DjiTestKmzMission *mission,
+                                      uint32_t index, const T_DjiTestKmzAction *actions, uint32_t actionNum,
+                                      bool isTemplate)
+{
+    const T_DjiTestKmzWaypoint *waypoint = &mission->waypoints[index];
+    uint32_t i;
+
+    DjiTest_KmzPutString(builder, "      <Placemark>\n"
+                                  "        <Point>\n"
+                                  "          <coordinates>\n"
+                                  "            ");
+    DjiTest_KmzPutNumber(builder, waypoint->longitude, DJI_TEST_KMZ_COORDINATE_DECIMALS);
+    DjiTest_KmzPut(builder, ",", 1);
+    DjiTest_KmzPutNumber(builder, waypoint->latitude, DJI_TEST_KMZ_COORDINATE_DECIMALS);
+    DjiTest_KmzPutNumberElement(builder, "\n"
+                                         "          </coordinates>\n"
+                                         "        </Point>\n"
+                                         "        <wpml:index>", index, 0, "</wpml:index>\n");
+
+    if (isTemplate) {
+        DjiTest_KmzPutNumberElement(builder, "        <wpml:ellipsoidHeight>", waypoint->height,
+                                    DJI_TEST_KMZ_VALUE_DECIMALS, "</wpml:ellipsoidHeight>\n");
+        DjiTest_KmzPutNumberElement(builder, "        <wpml:height>", waypoint->height, DJI_TEST_KMZ_VALUE_DECIMALS,
+                                    "</wpml:height>\n"
+                                    "        <wpml:useGlobalHeight>0</wpml:useGlobalHeight>\n");
+        if (waypoint->speed != 0) {
+            DjiTest_KmzPutNumberElement(builder, "        <wpml:useGlobalSpeed>0</wpml:useGlobalSpeed>\n"
+                                                 "        <wpml:waypointSpeed>", waypoint->speed,
+                                        DJI_TEST_KMZ_VALUE_DECIMALS, "</wpml:waypointSpeed>\n");
+        } else {
+            DjiTest_KmzPutString(builder, "        <wpml:useGlobalSpeed>1</wpml:useGlobalSpeed>\n");
+        }
+        DjiTest_KmzPutString(builder, "        <wpml:useGlobalHeadingParam>0</wpml:useGlobalHeadingParam>\n"
+                                      "        <wpml:useGlobalTurnParam>0</wpml:useGlobalTurnParam>\n");
+    } else {
+        DjiTest_KmzPutNumberElement(builder, "        <wpml:executeHeight>", waypoint->height,
+                                    DJI_TEST_KMZ_VALUE_DECIMALS, "</wpml:executeHeight>\n");
+        DjiTest_KmzPutNumberElement(builder, "        <wpml:waypointSpeed>",
+                                    DjiTest_KmzGetSegmentSpeed(mission, waypoint), DJI_TEST_KMZ_VALUE_DECIMALS,
+                                    "</wpml:waypointSpeed>\n");
+    }
+
+    DjiTest_KmzPutStringElement(builder, "        <wpml:waypointHeadingParam>\n"
+                                         "          <wpml:waypointHeadingMode>",
+                                s_headingModeNames[waypoint->headingMode], "</wpml:waypointHeadingMode>\n");
+    DjiTest_KmzPutNumberElement(builder, "          <wpml:waypointHeadingAngle>", waypoint->headingAngle,
+                                DJI_TEST_KMZ_VALUE_DECIMALS, "</wpml:waypointHeadingAngle>\n"
+                                "          <wpml:waypointPoiPoint>0.000000,0.000000,0.000000</wpml:waypointPoiPoint>\n");
+    DjiTest_KmzPutNumberElement(builder, "          <wpml:waypointHeadingAngleEnable>",
+                                waypoint->headingMode == DJI_TEST_KMZ_HEADING_MODE_SMOOTH_TRANSITION ? 1 : 0, 0,
+                                "</wpml:waypointHeadingAngleEnable>\n"
+                                "          <wpml:waypointHeadingPoiIndex>0</wpml:waypointHeadingPoiIndex>\n"
+                                "        </wpml:waypointHeadingParam>\n");
+    DjiTest_KmzPutStringElement(builder, "        <wpml:waypointTurnParam>\n"
+                                         "          <wpml:waypointTurnMode>", s_turnModeNames[waypoint->turnMode],
+                                "</wpml:waypointTurnMode>\n");
+    DjiTest_KmzPutNumberElement(builder, "          <wpml:waypointTurnDampingDist>",
+                                waypoint->turnMode == DJI_TEST_KMZ_TURN_MODE_COORDINATE_TURN ?
+                                waypoint->turnDampingDist : 0, DJI_TEST_KMZ_VALUE_DECIMALS,
+                                "</wpml:waypointTurnDampingDist>\n"
+                                "        </wpml:waypointTurnParam>\n"
+                                "        <wpml:useStraightLine>1</wpml:useStraightLine>\n");
+
+    if (actionNum > 0) {
+        DjiTest_KmzPutNumberElement(builder, "        <wpml:actionGroup>\n"
+                                             "          <wpml:actionGroupId>", builder->actionGroupId, 0,
+                                    "</wpml:actionGroupId>\n");
+        DjiTest_KmzPutNumberElement(builder, "          <wpml:actionGroupStartIndex>", index, 0,
+                                    "</wpml:actionGroupStartIndex>\n");
+        DjiTest_KmzPutNumberElement(builder, "          <wpml:actionGroupEndIndex>", index, 0,
+                                    "</wpml:actionGroupEndIndex>\n"
+                                    "          <wpml:actionGroupMode>sequence</wpml:actionGroupMode>\n"
+                                    "          <wpml:actionTrigger>\n"
+                                    "            <wpml:actionTriggerType>reachPoint</wpml:actionTriggerType>\n"
+                                    "          </wpml:actionTrigger>\n");
+        for (i = 0; i < actionNum; i++) {
+            DjiTest_KmzWriteAction(builder, &actions[i], i);
+        }
+        DjiTest_KmzPutString(builder, "        </wpml:actionGroup>\n");
+        builder->actionGroupId++;
+    }
+
+    DjiTest_KmzPutString(builder, "      </Placemark>\n");
+}
+
+static void DjiTest_KmzWriteAction(T_DjiTestKmzBuilder *builder, const T_DjiTestKmzAction *action, uint32_t actionId)
+{
+    DjiTest_KmzPutNumberElement(builder, "          <wpml:action>\n"
+                                         "            <wpml:actionId>", actionId, 0, "</wpml:actionId>\n");
+    DjiTest_KmzPutStringElement(builder, "            <wpml:actionActuatorFunc>", s_actionNames[action->type],
+                                "</wpml:actionActuatorFunc>\n"
+                                "            <wpml:actionActuatorFuncParam>\n");
+
+    switch (action->type) {
+        case DJI_TEST_KMZ_ACTION_TAKE_PHOTO:
+        case DJI_TEST_KMZ_ACTION_START_RECORD:
+            if (action->fileSuffix[0] != '\0') {
+                DjiTest_KmzPutString(builder, "              <wpml:fileSuffix>");
+                DjiTest_KmzPutEscaped(builder, action->fileSuffix);
+                DjiTest_KmzPutString(builder, "</wpml:fileSuffix>\n");
+            }
+            DjiTest_KmzPutNumberElement(builder, "              <wpml:payloadPositionIndex>",
+                                        action->payloadPositionIndex, 0, "</wpml:payloadPositionIndex>\n"
+                                        "              <wpml:useGlobalPayloadLensIndex>0"
+                                        "</wpml:useGlobalPayloadLensIndex>\n");
+            break;
+        case DJI_TEST_KMZ_ACTION_STOP_RECORD:
+            DjiTest_KmzPutNumberElement(builder, "              <wpml:payloadPositionIndex>",
+                                        action->payloadPositionIndex, 0, "</wpml:payloadPositionIndex>\n");
+            break;
+        case DJI_TEST_KMZ_ACTION_GIMBAL_ROTATE:
+            DjiTest_KmzPutNumberElement(builder, "              <wpml:gimbalRotateMode>absoluteAngle"
+                                                 "</wpml:gimbalRotateMode>\n"
+                                                 "              <wpml:gimbalPitchRotateEnable>1"
+                                                 "</wpml:gimbalPitchRotateEnable>\n"
+                                                 "              <wpml:gimbalPitchRotateAngle>", action->gimbalPitch,
+                                        DJI_TEST_KMZ_VALUE_DECIMALS, "</wpml:gimbalPitchRotateAngle>\n"
+                                        "              <wpml:gimbalRollRotateEnable>0</wpml:gimbalRollRotateEnable>\n"
+                                        "              <wpml:gimbalRollRotateAngle>0</wpml:gimbalRollRotateAngle>\n");
+            DjiTest_KmzPutNumberElement(builder, "              <wpml:gimbalYawRotateEnable>",
+                                        action->isGimbalYawEnabled ? 1 : 0, 0, "</wpml:gimbalYawRotateEnable>\n");
+            DjiTest_KmzPutNumberElement(builder, "              <wpml:gimbalYawRotateAngle>",
+                                        action->isGimbalYawEnabled ? action->gimbalYaw : 0,
+                                        DJI_TEST_KMZ_VALUE_DECIMALS, "</wpml:gimbalYawRotateAngle>\n"
+                                        "              <wpml:gimbalRotateTimeEnable>0</wpml:gimbalRotateTimeEnable>\n"
+                                        "              <wpml:gimbalRotateTime>0</wpml:gimbalRotateTime>\n");
+            DjiTest_KmzPutNumberElement(builder, "              <wpml:payloadPositionIndex>",
+                                        action->payloadPositionIndex, 0, "</wpml:payloadPositionIndex>\n");
+            break;
+        case DJI_TEST_KMZ_ACTION_ZOOM:
+            DjiTest_KmzPutNumberElement(builder, "              <wpml:focalLength>", action->focalLength,
+                                        DJI_TEST_KMZ_VALUE_DECIMALS, "</wpml:focalLength>\n"
+                                        "              <wpml:isUseFocalFactor>0</wpml:isUseFocalFactor>\n");
+            DjiTest_KmzPutNumberElement(builder, "              <wpml:payloadPositionIndex>",
+                                        action->payloadPositionIndex, 0, "</wpml:payloadPositionIndex>\n");
+            break;
+        case DJI_TEST_KMZ_ACTION_HOVER:
+            DjiTest_KmzPutNumberElement(builder, "              <wpml:hoverTime>", action->hoverTime,
+                                        DJI_TEST_KMZ_VALUE_DECIMALS, "</wpml:hoverTime>\n");
+            break;
+        default:
+            break;
+    }
+
+    DjiTest_KmzPutString(builder, "            </wpml:actionActuatorFuncParam>\n"
+                                  "          </wpml:action>\n");
+}
+
+static void DjiTest_KmzPut(T_DjiTestKmzBuilder *builder, const char *data, uint32_t len)
+{
+    /* Errors of the zip writer are sticky and reported when the entry ends. */
+    if (builder->xmlLen + len > sizeof(builder->xmlBuffer)) {
+        DjiTest_KmzFlush(builder);
+        if (len > sizeof(builder->xmlBuffer)) {
+            UtilZip_WriterWriteEntryData(&builder->zipWriter, (const uint8_t *) data, len);
+            return;
+        }
+    }
+
+    memcpy(builder->xmlBuffer + builder->xmlLen, data, len);
+    builder->xmlLen += len;
+}
+
+static void DjiTest_KmzPutString(T_DjiTestKmzBuilder *builder, const char *str)
+{
+    DjiTest_KmzPut(builder, str, (uint32_t) strlen(str));
+}
+
+static void DjiTest_KmzPutEscaped(T_DjiTestKmzBuilder *builder, const char *str)
+{
+    const char *start = str;
+
+    for (; *str != '\0'; str++) {
+        const char *entity;
+
+        switch (*str) {
+            case '&':
+                entity = "&amp;";
+                break;
+            case '<':
+                entity = "&lt;";
+                break;
+            case '>':
+                entity = "&gt;";
+                break;
+            case '"':
+                entity = "&quot;";
+                break;
+            case '\'':
+                entity = "&apos;";
+                break;
+            default:
+                continue;
+        }
+        DjiTest_KmzPut(builder, start, (uint32_t) (str - start));
+        DjiTest_KmzPutString(builder, entity);
+        start = str + 1;
+    }
+    DjiTest_KmzPut(builder, start, (uint32_t) (str - start));
+}
+
+static void DjiTest_KmzPutNumber(T_DjiTestKmzBuilder *builder, dji_f64_t value, uint8_t decimals)
+{
+    if (builder->xmlLen + DJI_TEST_KMZ_NUMBER_MAX_LEN > sizeof(builder->xmlBuffer)) {
+        DjiTest_KmzFlush(builder);
+    }
+
+    builder->xmlLen += DjiTest_KmzFormatNumber(builder->xmlBuffer + builder->xmlLen, value, decimals);
+}
+
+static void DjiTest_KmzPutNumberElement(T_DjiTestKmzBuilder *builder, const char *open, dji_f64_t value,
+                                        uint8_t decimals, const char *close)
+{
+    DjiTest_KmzPutString(builder, open);
+    DjiTest_KmzPutNumber(builder, value, decimals);
+    DjiTest_KmzPutString(builder, close);
+}
+
+static void DjiTest_KmzPutStringElement(T_DjiTestKmzBuilder *builder, const char *open, const char *value,
+                                        const char *close)
+{
+    DjiTest_KmzPutString(builder, open);
+    DjiTest_KmzPutString(builder, value);
+    DjiTest_KmzPutString(builder, close);
+}
+
+static void DjiTest_KmzFlush(T_DjiTestKmzBuilder *builder)
+{
+    if (builder->xmlLen > 0) {
+        UtilZip_WriterWriteEntryData(&builder->zipWriter, (const uint8_t *) builder->xmlBuffer, builder->xmlLen);
+        builder->xmlLen = 0;
+    }
+}
+
+/**
+ * @brief Print a fixed point number with at most "decimals" digits and no trailing zeros, "5" rather than "5.000".
+ * @note Done on integers since printf of doubles dominates the generation of large missions.
+ * @return Characters written, at most DJI_TEST_KMZ_NUMBER_MAX_LEN - 1 and not terminated.
+ */
+static uint32_t DjiTest_KmzFormatNumber(char *out, dji_f64_t value, uint8_t decimals)
+{
+    char digits[24];
+    uint64_t scaled;
+    uint64_t integer;
+    uint64_t fraction;
+    uint32_t len = 0;
+    uint32_t digitNum = 0;
+    uint32_t i;
+    int printLen;
+
+    if (decimals > DJI_TEST_KMZ_COORDINATE_DECIMALS || !(fabs(value) * s_powersOfTen[decimals] < 9e18)) {
+        printLen = snprintf(out, DJI_TEST_KMZ_NUMBER_MAX_LEN, "%.*f", decimals, value);
+        return printLen < 0 ? 0 : (printLen >= DJI_TEST_KMZ_NUMBER_MAX_LEN ? DJI_TEST_KMZ_NUMBER_MAX_LEN - 1 :
+                                   (uint32_t) printLen);
+    }
+
+    scaled = (uint64_t) (fabs(value) * s_powersOfTen[decimals] + 0.5);
+    if (value < 0 && scaled != 0) {
+        out[len++] = '-';
+    }
+
+    integer = scaled / s_powersOfTen[decimals];
+    fraction = scaled % s_powersOfTen[decimals];
+    do {
+        digits[digitNum++] = (char) ('0' + integer % 10);
+        integer /= 10;
+    } while (integer != 0);
+    while (digitNum > 0) {
+        out[len++] = digits[--digitNum];
+    }
+
+    if (fraction != 0) {
+        out[len++] = '.';
+        digitNum = decimals;
+        while (fraction % 10 == 0) {
+            fraction /= 10;
+            digitNum--;
+        }
+        for (i = digitNum; i > 0; i--) {
+            out[len + i - 1] = (char) ('0' + fraction % 10);
+            fraction /= 10;
+        }
+        len += digitNum;
+    }
+
+    return len;
+}
+
+/****************** (C) COPYRIGHT DJI Innovations *****END OF FILE****/
@@ -0,0 +1,198 @@
+/**
+ ********************************************************************
+ * @file    test_waypoint_v3_kmz.h
+ * @brief   This is the header file for "test_waypoint_v3_kmz.c", defining the structure and
+ * (exported) function prototypes.
+ *
+ * @copyright (c) 2021 DJI. All rights reserved.
+ *
+ * All information contained herein is, and remains, the property of DJI.
+ * The intellectual and technical concepts contained herein are proprietary
+ * to DJI and may be covered by U.S. and foreign patents, patents in process,
+ * and protected by trade secret or copyright law.  Dissemination of this
+ * information, including but not limited to data and other proprietary
+ * material(s) incorporated within the information, in any form, is strictly
+ * prohibited without the express written consent of DJI.
+ *
+ * If you receive this source code without DJI’s authorization, you may not
+ * further disseminate the information, and you must immediately remove the
+ * source code and notify DJI of its removal. DJI reserves the right to pursue
+ * legal actions against you for any loss(es) or damage(s) caused by your
+ * failure to do so.
+ *
+ *********************************************************************
+ */
+
+/* Define to prevent recursive inclusion -------------------------------------*/
+#ifndef TEST_WAYPOINT_V3_KMZ_H
+#define TEST_WAYPOINT_V3_KMZ_H
+
+/* Includes ------------------------------------------------------------------*/
+#include "dji_typedef.h"
+#include "utils/util_deflate.h"
+#include "utils/util_zip.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Exported constants --------------------------------------------------------*/
+#define DJI_TEST_KMZ_XML_BUFFER_SIZE                    (16 * 1024)
+#define DJI_TEST_KMZ_FILE_SUFFIX_MAX_LEN                32
+#define DJI_TEST_KMZ_VALIDATE_MESSAGE_MAX_LEN           128
+#define DJI_TEST_KMZ_INDEX_NONE                         0xFFFFFFFF
+
+/* Exported types ------------------------------------------------------------*/
+typedef enum {
+    DJI_TEST_KMZ_FINISH_ACTION_GO_HOME = 0,
+    DJI_TEST_KMZ_FINISH_ACTION_NO_ACTION,
+    DJI_TEST_KMZ_FINISH_ACTION_AUTO_LAND,
+    DJI_TEST_KMZ_FINISH_ACTION_GOTO_FIRST_WAYPOINT,
+} E_DjiTestKmzFinishAction;
+
+typedef enum {
+    DJI_TEST_KMZ_RC_LOST_ACTION_GO_BACK = 0,
+    DJI_TEST_KMZ_RC_LOST_ACTION_LANDING,
+    DJI_TEST_KMZ_RC_LOST_ACTION_HOVER,
+} E_DjiTestKmzRcLostAction;
+
+typedef enum {
+    DJI_TEST_KMZ_HEADING_MODE_FOLLOW_WAYLINE = 0,
+    DJI_TEST_KMZ_HEADING_MODE_MANUALLY,
+    DJI_TEST_KMZ_HEADING_MODE_FIXED,
+    DJI_TEST_KMZ_HEADING_MODE_SMOOTH_TRANSITION,
+} E_DjiTestKmzHeadingMode;
+
+typedef enum {
+    DJI_TEST_KMZ_TURN_MODE_COORDINATE_TURN = 0,                 /*!< Pass by the waypoint on a curve of damping distance. */
+    DJI_TEST_KMZ_TURN_MODE_STOP_WITH_DISCONTINUITY_CURVATURE,
+    DJI_TEST_KMZ_TURN_MODE_STOP_WITH_CONTINUITY_CURVATURE,
+    DJI_TEST_KMZ_TURN_MODE_PASS_WITH_CONTINUITY_CURVATURE,
+} E_DjiTestKmzTurnMode;
+
+typedef enum {
+    DJI_TEST_KMZ_ACTION_TAKE_PHOTO = 0,
+    DJI_TEST_KMZ_ACTION_START_RECORD,
+    DJI_TEST_KMZ_ACTION_STOP_RECORD,
+    DJI_TEST_KMZ_ACTION_GIMBAL_ROTATE,
+    DJI_TEST_KMZ_ACTION_ZOOM,
+    DJI_TEST_KMZ_ACTION_HOVER,
+} E_DjiTestKmzActionType;
+
+/**
+ * @brief Waypoint of a mission, heights are relative to the take-off point.
+ */
+typedef struct {
+    double longitude;                   /*!< Degree, WGS84. */
+    double latitude;                    /*!< Degree, WGS84. */
+    dji_f32_t height;                   /*!< Meter. */
+    dji_f32_t speed;                    /*!< Meter per second towards the next waypoint, 0 uses the auto flight speed. */
+    E_DjiTestKmzHeadingMode headingMode;
+    dji_f32_t headingAngle;             /*!< Degree, used by the fixed and smooth transition heading modes. */
+    E_DjiTestKmzTurnMode turnMode;
+    dji_f32_t turnDampingDist;          /*!< Meter, only used by the coordinate turn. */
+} T_DjiTestKmzWaypoint;
+
+typedef struct {
+    uint32_t waypointIndex;             /*!< Actions run in array order when the aircraft reaches this waypoint. */
+    E_DjiTestKmzActionType type;
+    uint8_t payloadPositionIndex;
+    dji_f32_t gimbalPitch;              /*!< Degree, absolute angle of the gimbal rotate action. */
+    dji_f32_t gimbalYaw;                /*!< Degree, absolute angle of the gimbal rotate action. */
+    bool isGimbalYawEnabled;
+    dji_f32_t focalLength;              /*!< Millimeter of equivalent focal length, zoom action. */
+    dji_f32_t hoverTime;                /*!< Second, hover action. */
+    char fileSuffix[DJI_TEST_KMZ_FILE_SUFFIX_MAX_LEN];  /*!< Photo and record actions, may be empty. */
+} T_DjiTestKmzAction;
+
+typedef struct {
+    E_DjiTestKmzFinishAction finishAction;
+    E_DjiTestKmzRcLostAction rcLostAction;
+    dji_f32_t takeOffSecurityHeight;    /*!< Meter. */
+    dji_f32_t globalTransitionalSpeed;  /*!< Meter per second, flying to the first waypoint. */
+    dji_f32_t autoFlightSpeed;          /*!< Meter per second on the wayline. */
+    uint32_t droneEnumValue;
+    uint32_t droneSubEnumValue;
+    uint32_t payloadEnumValue;
+    uint32_t payloadSubEnumValue;
+    const T_DjiTestKmzWaypoint *waypoints;
+    uint32_t waypointNum;
+    const T_DjiTestKmzAction *actions;  /*!< Sorted by waypoint index. */
+    uint32_t actionNum;
+    uint64_t createTimeMs;              /*!< Unix time, also stamped on the kmz entries. */
+} T_DjiTestKmzMission;
+
+typedef struct {
+    uint32_t maxWaypointNum;
+    uint32_t maxActionNumPerWaypoint;
+    dji_f32_t minHeight;
+    dji_f32_t maxHeight;
+    dji_f32_t minSpeed;
+    dji_f32_t maxSpeed;
+    dji_f32_t minWaypointSpacing;       /*!< Meter between consecutive waypoints. */
+    dji_f32_t maxTotalDistance;         /*!< Meter of the whole wayline, 0 is unlimited. */
+    dji_f32_t minGimbalPitch;
+    dji_f32_t maxGimbalPitch;
+    dji_f32_t maxFocalLength;
+    dji_f32_t maxHoverTime;
+    dji_f32_t acceleration;             /*!< Meter per square second, only used for the duration estimate. */
+} T_DjiTestKmzLimits;
+
+/**
+ * @brief Outcome of a validation, the indexes point at the first offending waypoint or action.
+ */
+typedef struct {
+    bool isValid;
+    uint32_t waypointIndex;
+    uint32_t actionIndex;
+    char message[DJI_TEST_KMZ_VALIDATE_MESSAGE_MAX_LEN];
+    dji_f64_t totalDistance;            /*!< Meter along the wayline, only complete for a valid mission. */
+    dji_f64_t estimatedDuration;        /*!< Second, including stops and hovers. */
+} T_DjiTestKmzValidateResult;
+
+typedef struct {
+    bool isCompressed;                  /*!< Deflate the entries, otherwise they are stored. */
+    uint32_t maxChainLength;            /*!< Effort of the compressor, see UtilDeflate_Init. */
+    uint32_t initialBufferSize;
+    T_DjiTestKmzLimits limits;
+} T_DjiTestKmzBuilderConfig;
+
+/**
+ * @brief Generates wpmz/template.kml and wpmz/waylines.wpml of a mission straight into an in-memory kmz.
+ * @note The xml is staged in a small buffer that is streamed into the zip entry, so no document is ever held as a
+ * whole and nothing touches the file system. All buffers are kept between builds. The builder is not thread-safe.
+ */
+typedef struct {
+    T_DjiTestKmzBuilderConfig config;
+    T_UtilZipWriter zipWriter;
+    T_UtilDeflate deflate;
+    void *deflateMemory;
+    char xmlBuffer[DJI_TEST_KMZ_XML_BUFFER_SIZE];
+    uint32_t xmlLen;
+    uint32_t actionGroupId;
+} T_DjiTestKmzBuilder;
+
+/* Exported functions --------------------------------------------------------*/
+void DjiTest_KmzGetDefaultLimits(T_DjiTestKmzLimits *limits);
+T_DjiReturnCode DjiTest_KmzValidateMission(const T_DjiTestKmzMission *mission, const T_DjiTestKmzLimits *limits,
+                                           T_DjiTestKmzValidateResult *result);
+
+void DjiTest_KmzBuilderGetDefaultConfig(T_DjiTestKmzBuilderConfig *config);
+T_DjiReturnCode DjiTest_KmzBuilderInit(T_DjiTestKmzBuilder *builder, const T_DjiTestKmzBuilderConfig *config);
+T_DjiReturnCode DjiTest_KmzBuilderDeInit(T_DjiTestKmzBuilder *builder);
+
+/**
+ * @brief Validate the mission and build its kmz, the file stays owned by the builder until the next build.
+ * @param result: optional, receives the validation outcome.
+ * @return DJI_ERROR_SYSTEM_MODULE_CODE_INVALID_PARAMETER if the mission does not pass the validation.
+ */
+T_DjiReturnCode DjiTest_KmzBuilderBuild(T_DjiTestKmzBuilder *builder, const T_DjiTestKmzMission *mission,
+                                        const uint8_t **kmzData, uint32_t *kmzSize,
+                                        T_DjiTestKmzValidateResult *result);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // TEST_WAYPOINT_V3_KMZ_H
+/************************ (C) COPYRIGHT DJI Innovations *******END OF FILE******/
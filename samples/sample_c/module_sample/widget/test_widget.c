@@ -38,11 +38,21 @@
 #define WIDGET_TASK_STACK_SIZE          (2048)
 #define WIDGET_LOG_STRING_MAX_SIZE      (64)
 #define WIDGET_LOG_LINE_MAX_NUM         (4)
+#define WIDGET_FLOATING_WINDOW_DEFAULT_LATENCY_BUDGET_MS        (200)
+#define WIDGET_FLOATING_WINDOW_DEFAULT_HEARTBEAT_INTERVAL_MS    (1000)
+#define WIDGET_FLOATING_WINDOW_POLL_DIVISOR                     (4)
+#define WIDGET_FLOATING_WINDOW_MIN_POLL_INTERVAL_MS             (10)
 
 /* Private types -------------------------------------------------------------*/
+/**
+ * @brief The newest WIDGET_LOG_LINE_MAX_NUM lines, slot (appendCount % WIDGET_LOG_LINE_MAX_NUM) is the next to write.
+ * @note The mutex only covers the copy of one line, an append never moves the other lines.
+ */
 typedef struct {
-    bool valid;
-    char content[WIDGET_LOG_STRING_MAX_SIZE];
+    T_DjiMutexHandle mutex;
+    char lines[WIDGET_LOG_LINE_MAX_NUM][WIDGET_LOG_STRING_MAX_SIZE];
+    uint32_t appendCount;
+    bool isInited;
 } T_DjiTestWidgetLog;
 
 /* Private functions declaration ---------------------------------------------*/
@@ -50,12 +60,20 @@ static T_DjiReturnCode DjiTestWidget_SetWidgetValue(E_DjiWidgetType widgetType,
                                                     void *userData);
 static T_DjiReturnCode DjiTestWidget_GetWidgetValue(E_DjiWidgetType widgetType, uint32_t index, int32_t *value,
                                                     void *userData);
+static bool DjiTestWidget_UpdateFloatingWindowMessage(char *message, uint32_t size, uint32_t nowMs);
 
 /* Private values ------------------------------------------------------------*/
 static T_DjiTaskHandle s_widgetTestThread;
 static bool s_isWidgetFileDirPathConfigured = false;
 static char s_widgetFileDirPath[DJI_FILE_PATH_SIZE_MAX] = {0};
-static T_DjiTestWidgetLog s_djiTestWidgetLog[WIDGET_LOG_LINE_MAX_NUM] = {0};
+static T_DjiTestWidgetLog s_djiTestWidgetLog = {0};
+static T_DjiTestWidgetFloatingWindowConfig s_floatingWindowConfig = {
+    WIDGET_FLOATING_WINDOW_DEFAULT_LATENCY_BUDGET_MS,
+    WIDGET_FLOATING_WINDOW_DEFAULT_HEARTBEAT_INTERVAL_MS,
+};
+static T_DjiTestWidgetFloatingWindowStatistics s_floatingWindowStatistics = {0};
+static uint32_t s_floatingWindowShownAppendCount = 0;
+static uint32_t s_floatingWindowHeartbeatMs = 0;
 static const T_DjiWidgetHandlerListItem s_widgetHandlerList[] = {
     {0, DJI_WIDGET_TYPE_BUTTON,        DjiTestWidget_SetWidgetValue, DjiTestWidget_GetWidgetValue, NULL},
     {1, DJI_WIDGET_TYPE_LIST,          DjiTestWidget_SetWidgetValue, DjiTestWidget_GetWidgetValue, NULL},
@@ -83,30 +101,74 @@ static int32_t s_widgetValueList[sizeof(s_widgetHandlerList) / sizeof(T_DjiWidge
 /* Exported functions definition ---------------------------------------------*/
 
 
+/**
+ * @brief Create the log lock, call it before the widget task and any log producer start.
+ */
+T_DjiReturnCode DjiTest_WidgetLogInit(void)
+{
+    T_DjiOsalHandler *osalHandler = DjiPlatform_GetOsalHandler();
+    T_DjiReturnCode returnCode;
+
+    if (s_djiTestWidgetLog.isInited) {
+        return DJI_ERROR_SYSTEM_MODULE_CODE_SUCCESS;
+    }
+
+    returnCode = osalHandler->MutexCreate(&s_djiTestWidgetLog.mutex);
+    if (returnCode != DJI_ERROR_SYSTEM_MODULE_CODE_SUCCESS) {
+        return returnCode;
+    }
+
+    s_djiTestWidgetLog.appendCount = 0;
+    s_djiTestWidgetLog.isInited = true;
+
+    return DJI_ERROR_SYSTEM_MODULE_CODE_SUCCESS;
+}
+
+/**
+ * @brief Append one line to the floating window log, safe to call from any task and callback.
+ * @note Lines appended before the widget service started are dropped.
+ */
 void DjiTest_WidgetLogAppend(const char *fmt, ...)
 {
+    T_DjiOsalHandler *osalHandler = DjiPlatform_GetOsalHandler();
     va_list args;
     char string[WIDGET_LOG_STRING_MAX_SIZE];
-    int32_t i;
+
+    if (!s_djiTestWidgetLog.isInited) {
+        return;
+    }
 
     va_start(args, fmt);
     vsnprintf(string, WIDGET_LOG_STRING_MAX_SIZE, fmt, args);
     va_end(args);
 
-    for (i = 0; i < WIDGET_LOG_LINE_MAX_NUM; ++i) {
-        if (s_djiTestWidgetLog[i].valid == false) {
-            s_djiTestWidgetLog[i].valid = true;
-            strcpy(s_djiTestWidgetLog[i].content, string);
-            break;
-        }
-    }
+    osalHandler->MutexLock(s_djiTestWidgetLog.mutex);
+    memcpy(s_djiTestWidgetLog.lines[s_djiTestWidgetLog.appendCount % WIDGET_LOG_LINE_MAX_NUM], string,
+           sizeof(string));
+    s_djiTestWidgetLog.appendCount++;
+    osalHandler->MutexUnlock(s_djiTestWidgetLog.mutex);
+}
 
-    if (i == WIDGET_LOG_LINE_MAX_NUM) {
-        for (i = 0; i < WIDGET_LOG_LINE_MAX_NUM - 1; i++) {
-            strcpy(s_djiTestWidgetLog[i].content, s_djiTestWidgetLog[i + 1].content);
-        }
-        strcpy(s_djiTestWidgetLog[WIDGET_LOG_LINE_MAX_NUM - 1].content, string);
+/**
+ * @brief Set how the widget task refreshes the floating window, call it before the widget service starts.
+ */
+T_DjiReturnCode DjiTest_WidgetSetFloatingWindowConfig(const T_DjiTestWidgetFloatingWindowConfig *config)
+{
+    if (config == NULL || config->latencyBudgetMs == 0) {
+        return DJI_ERROR_SYSTEM_MODULE_CODE_INVALID_PARAMETER;
     }
+
+    s_floatingWindowConfig = *config;
+
+    return DJI_ERROR_SYSTEM_MODULE_CODE_SUCCESS;
+}
+
+/**
+ * @brief Counters of the widget task, read without lock so they may be a few updates apart from each other.
+ */
+void DjiTest_WidgetGetFloatingWindowStatistics(T_DjiTestWidgetFloatingWindowStatistics *statistics)
+{
+    *statistics = s_floatingWindowStatistics;
 }
 
 T_DjiReturnCode DjiTest_WidgetStartService(void)
@@ -121,6 +183,12 @@ T_DjiReturnCode DjiTest_WidgetStartService(void)
         return djiStat;
     }
 
+    djiStat = DjiTest_WidgetLogInit();
+    if (djiStat != DJI_ERROR_SYSTEM_MODULE_CODE_SUCCESS) {
+        USER_LOG_ERROR("Dji test widget log init error, stat = 0x%08llX", djiStat);
+        return djiStat;
+    }
+
 #ifdef SYSTEM_ARCH_LINUX
     //Step 2 : Set UI Config (Linux environment)
     char curFileDirPath[WIDGET_DIR_PATH_LEN_MAX];
@@ -214,35 +282,58 @@ T_DjiReturnCode DjiTest_WidgetSetConfigFilePath(const char *path)
 #pragma GCC diagnostic ignored "-Wreturn-type"
 #pragma GCC diagnostic ignored "-Wformat"
 #endif
+/**
+ * @brief Refresh the floating window only when its text changed, at most once per latency budget.
+ * @note The first change after a quiet period is sent at the next poll, a burst of changes arriving right after a
+ * send is coalesced into one message sent when the budget has elapsed. The system time line is refreshed once per
+ * heartbeat interval, so an idle window costs one message per heartbeat instead of one per poll.
+ */
 void *DjiTest_WidgetTask(void *arg)
 {
     char message[DJI_WIDGET_FLOATING_WINDOW_MSG_MAX_LEN];
     uint32_t sysTimeMs = 0;
+    uint32_t lastSendMs = 0;
+    uint32_t pollIntervalMs;
+    bool isPending = false;
+    bool isSentOnce = false;
     T_DjiReturnCode djiStat;
     T_DjiOsalHandler *osalHandler = DjiPlatform_GetOsalHandler();
 
     USER_UTIL_UNUSED(arg);
 
+    pollIntervalMs = USER_UTIL_MAX(s_floatingWindowConfig.latencyBudgetMs / WIDGET_FLOATING_WINDOW_POLL_DIVISOR,
+                                   WIDGET_FLOATING_WINDOW_MIN_POLL_INTERVAL_MS);
+
     while (1) {
         djiStat = osalHandler->GetTimeMs(&sysTimeMs);
         if (djiStat != DJI_ERROR_SYSTEM_MODULE_CODE_SUCCESS) {
             USER_LOG_ERROR("Get system time ms error, stat = 0x%08llX", djiStat);
         }
 
-        snprintf(message, DJI_WIDGET_FLOATING_WINDOW_MSG_MAX_LEN,
-                 "System time : %ld ms \r\n%s \r\n%s \r\n%s \r\n%s \r\n",
-                 sysTimeMs,
-                 s_djiTestWidgetLog[0].content,
-                 s_djiTestWidgetLog[1].content,
-                 s_djiTestWidgetLog[2].content,
-                 s_djiTestWidgetLog[3].content);
+        if (DjiTestWidget_UpdateFloatingWindowMessage(message, sizeof(message), sysTimeMs)) {
+            if (isPending) {
+                s_floatingWindowStatistics.coalescedCount++;
+            }
+            isPending = true;
+        } else if (!isPending) {
+            s_floatingWindowStatistics.suppressedCount++;
+        }
 
-        djiStat = DjiWidgetFloatingWindow_ShowMessage(message);
-        if (djiStat != DJI_ERROR_SYSTEM_MODULE_CODE_SUCCESS) {
-            USER_LOG_ERROR("Floating window show message error, stat = 0x%08llX", djiStat);
+        if (isPending && (!isSentOnce || sysTimeMs - lastSendMs >= s_floatingWindowConfig.latencyBudgetMs)) {
+            djiStat = DjiWidgetFloatingWindow_ShowMessage(message);
+            if (djiStat != DJI_ERROR_SYSTEM_MODULE_CODE_SUCCESS) {
+                USER_LOG_ERROR("Floating window show message error, stat = 0x%08llX", djiStat);
+                s_floatingWindowStatistics.failedCount++;
+            } else {
+                s_floatingWindowStatistics.sentCount++;
+                isPending = false;
+            }
+            /* A failed send is retried after a full budget as well, not on every poll. */
+            lastSendMs = sysTimeMs;
+            isSentOnce = true;
         }
 
-        osalHandler->TaskSleepMs(200);
+        osalHandler->TaskSleepMs(pollIntervalMs);
     }
 }
 #ifndef __CC_ARM
@@ -275,4 +366,54 @@ static T_DjiReturnCode DjiTestWidget_GetWidgetValue(E_DjiWidgetType widgetType,
     return DJI_ERROR_SYSTEM_MODULE_CODE_SUCCESS;
 }
 
+/**
+ * @brief Render the floating window text from the newest log lines.
+ * @return true if the text differs from the one rendered before, the message buffer is only written then.
+ */
+static bool DjiTestWidget_UpdateFloatingWindowMessage(char *message, uint32_t size, uint32_t nowMs)
+{
+    T_DjiOsalHandler *osalHandler = DjiPlatform_GetOsalHandler();
+    char lines[WIDGET_LOG_LINE_MAX_NUM][WIDGET_LOG_STRING_MAX_SIZE] = {0};
+    uint32_t appendCount;
+    uint32_t lineCount;
+    uint32_t i;
+    bool isHeartbeat;
+
+    isHeartbeat = s_floatingWindowConfig.heartbeatIntervalMs != 0 &&
+                  (s_floatingWindowStatistics.sentCount == 0 ||
+                   nowMs - s_floatingWindowHeartbeatMs >= s_floatingWindowConfig.heartbeatIntervalMs);
+    if (s_djiTestWidgetLog.isInited == false) {
+        appendCount = 0;
+    } else {
+        osalHandler->MutexLock(s_djiTestWidgetLog.mutex);
+        appendCount = s_djiTestWidgetLog.appendCount;
+        if (appendCount != s_floatingWindowShownAppendCount || isHeartbeat) {
+            /* Oldest line first, like the window always showed them. */
+            lineCount = USER_UTIL_MIN(appendCount, WIDGET_LOG_LINE_MAX_NUM);
+            for (i = 0; i < lineCount; i++) {
+                memcpy(lines[i], s_djiTestWidgetLog.lines[(appendCount - lineCount + i) % WIDGET_LOG_LINE_MAX_NUM],
+                       WIDGET_LOG_STRING_MAX_SIZE);
+            }
+        }
+        osalHandler->MutexUnlock(s_djiTestWidgetLog.mutex);
+    }
+
+    if (appendCount == s_floatingWindowShownAppendCount && !isHeartbeat) {
+        return false;
+    }
+
+    /* Lines overwritten before they were ever rendered. */
+    if (appendCount - s_floatingWindowShownAppendCount > WIDGET_LOG_LINE_MAX_NUM) {
+        s_floatingWindowStatistics.droppedLineCount +=
+            appendCount - s_floatingWindowShownAppendCount - WIDGET_LOG_LINE_MAX_NUM;
+    }
+    s_floatingWindowShownAppendCount = appendCount;
+    s_floatingWindowHeartbeatMs = nowMs;
+
+    snprintf(message, size, "System time : %u ms \r\n%s \r\n%s \r\n%s \r\n%s \r\n",
+             nowMs, lines[0], lines[1], lines[2], lines[3]);
+
+    return true;
+}
+
 /****************** (C) COPYRIGHT DJI Innovations *****END OF FILE****/
@@ -37,12 +37,28 @@ extern "C" {
 /* Exported constants --------------------------------------------------------*/
 
 /* Exported types ------------------------------------------------------------*/
+typedef struct {
+    uint32_t latencyBudgetMs;       /*!< Minimum interval between two floating window messages, must not be 0. */
+    uint32_t heartbeatIntervalMs;   /*!< Refresh interval of the system time line without new logs, 0 disables it. */
+} T_DjiTestWidgetFloatingWindowConfig;
+
+typedef struct {
+    uint32_t sentCount;             /*!< Messages accepted by DjiWidgetFloatingWindow_ShowMessage. */
+    uint32_t failedCount;           /*!< Messages rejected, they are retried after the latency budget. */
+    uint32_t suppressedCount;       /*!< Polls that found nothing new to show. */
+    uint32_t coalescedCount;        /*!< Renders merged into a later message while waiting for the latency budget. */
+    uint32_t droppedLineCount;      /*!< Log lines overwritten before they were ever rendered. */
+} T_DjiTestWidgetFloatingWindowStatistics;
 
 /* Exported functions --------------------------------------------------------*/
 T_DjiReturnCode DjiTest_WidgetStartService(void);
 T_DjiReturnCode DjiTest_WidgetSetConfigFilePath(const char *path);
+T_DjiReturnCode DjiTest_WidgetLogInit(void);
 void DjiTest_WidgetLogAppend(const char *fmt, ...);
+T_DjiReturnCode DjiTest_WidgetSetFloatingWindowConfig(const T_DjiTestWidgetFloatingWindowConfig *config);
+void DjiTest_WidgetGetFloatingWindowStatistics(T_DjiTestWidgetFloatingWindowStatistics *statistics);
 void *DjiTest_WidgetTask(void *arg);
+
 #ifdef __cplusplus
 }
 #endif
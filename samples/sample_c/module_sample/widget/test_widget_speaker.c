@@ -31,35 +31,24 @@
 #include <stdio.h>
 #include "utils/util_misc.h"
 #include "utils/util_md5.h"
+#include "test_widget_speaker_audio.h"
+#include "test_widget_speaker_tts.h"
 #include <dji_aircraft_info.h>
 
-#ifdef OPUS_INSTALLED
-
-#include <opus/opus.h>
-
-#endif
-
 /* Private constants ---------------------------------------------------------*/
 #define WIDGET_SPEAKER_TASK_STACK_SIZE          (2048)
 
-/*! Attention: replace your audio device name here. */
-#define WIDGET_SPEAKER_USB_AUDIO_DEVICE_NAME    "alsa_output.usb-C-Media_Electronics_Inc._USB_Audio_Device-00.analog-stereo"
-
-#define WIDGET_SPEAKER_AUDIO_OPUS_FILE_NAME     "test_audio.opus"
-#define WIDGET_SPEAKER_AUDIO_PCM_FILE_NAME      "test_audio.pcm"
+/*! Attention: replace your alsa audio device name here, e.g. "plughw:1,0" for an usb audio device. */
+#define WIDGET_SPEAKER_AUDIO_DEVICE_NAME        "default"
 
 #define WIDGET_SPEAKER_TTS_FILE_NAME            "test_tts.txt"
-#define WIDGET_SPEAKER_TTS_OUTPUT_FILE_NAME     "tts_audio.wav"
 #define WIDGET_SPEAKER_TTS_FILE_MAX_SIZE        (3000)
+#define WIDGET_SPEAKER_TTS_CACHE_MAX_BYTES      (8 * 1024 * 1024)
 
-/* The frame size is hardcoded for this sample code but it doesn't have to be */
-#define WIDGET_SPEAKER_AUDIO_OPUS_MAX_PACKET_SIZE          (3 * 1276)
-#define WIDGET_SPEAKER_AUDIO_OPUS_MAX_FRAME_SIZE           (6 * 960)
-#define WIDGET_SPEAKER_AUDIO_OPUS_SAMPLE_RATE              (16000)
-#define WIDGET_SPEAKER_AUDIO_OPUS_CHANNELS                 (1)
-
-#define WIDGET_SPEAKER_AUDIO_OPUS_DECODE_FRAME_SIZE_8KBPS  (40)
-#define WIDGET_SPEAKER_AUDIO_OPUS_DECODE_BITRATE_8KBPS     (8000)
+/* The audio engine parameters, prebuffer absorbs the jitter of voice data transmission */
+#define WIDGET_SPEAKER_AUDIO_PREBUFFER_MS       (200)
+#define WIDGET_SPEAKER_AUDIO_PERIOD_MS          (20)
+#define WIDGET_SPEAKER_AUDIO_MAX_CLIP_MS        (10 * 60 * 1000)
 
 /* The speaker initialization parameters */
 #define WIDGET_SPEAKER_DEFAULT_VOLUME                (60)
@@ -77,9 +66,6 @@ static T_DjiTaskHandle s_widgetSpeakerTestThread;
 static FILE *s_ttsFile = NULL;
 #endif
 
-static FILE *s_audioFile = NULL;
-static bool s_isDecodeFinished = true;
-static uint16_t s_decodeBitrate = 0;
 
 /* Private functions declaration ---------------------------------------------*/
 static void SetSpeakerState(E_DjiWidgetSpeakerState speakerState);
@@ -95,9 +81,6 @@ static T_DjiReturnCode ReceiveAudioData(E_DjiWidgetTransmitDataEvent event,
                                         uint32_t offset, uint8_t *buf, uint16_t size);
 #ifdef SYSTEM_ARCH_LINUX
 static void *DjiTest_WidgetSpeakerTask(void *arg);
-static uint32_t DjiTest_GetVoicePlayProcessId(void);
-static uint32_t DjiTest_KillVoicePlayProcess(uint32_t pid);
-static T_DjiReturnCode DjiTest_DecodeAudioData(void);
 static T_DjiReturnCode DjiTest_PlayAudioData(void);
 static T_DjiReturnCode DjiTest_PlayTtsData(void);
 static T_DjiReturnCode DjiTest_CheckFileMd5Sum(const char *path, uint8_t *buf, uint16_t size);
@@ -108,6 +91,15 @@ T_DjiReturnCode DjiTest_WidgetSpeakerStartService(void)
 {
     T_DjiReturnCode returnCode;
     T_DjiOsalHandler *osalHandler = DjiPlatform_GetOsalHandler();
+#ifdef SYSTEM_ARCH_LINUX
+    T_DjiTestSpeakerAudioConfig audioConfig = {
+        .sinkType = DJI_TEST_SPEAKER_AUDIO_SINK_ALSA,
+        .sinkName = WIDGET_SPEAKER_AUDIO_DEVICE_NAME,
+        .prebufferMs = WIDGET_SPEAKER_AUDIO_PREBUFFER_MS,
+        .periodMs = WIDGET_SPEAKER_AUDIO_PERIOD_MS,
+        .maxClipMs = WIDGET_SPEAKER_AUDIO_MAX_CLIP_MS,
+    };
+#endif
 
     s_speakerHandler.GetSpeakerState = GetSpeakerState;
     s_speakerHandler.SetWorkMode = SetWorkMode;
@@ -124,6 +116,27 @@ T_DjiReturnCode DjiTest_WidgetSpeakerStartService(void)
         return returnCode;
     }
 
+#ifdef SYSTEM_ARCH_LINUX
+    returnCode = DjiTest_SpeakerAudioInit(&audioConfig);
+    if (returnCode != DJI_ERROR_SYSTEM_MODULE_CODE_SUCCESS) {
+        USER_LOG_ERROR("Init speaker audio engine error: 0x%08llX", returnCode);
+        return returnCode;
+    }
+
+#if EKHO_INSTALLED
+    /*! Attention: you can register other tts opensource function as tts backend, example used ekho v7.5 */
+    returnCode = DjiTest_SpeakerTtsInit(DjiTest_SpeakerTtsGetEkhoBackend(), WIDGET_SPEAKER_TTS_CACHE_MAX_BYTES);
+#else
+    USER_LOG_WARN(
+        "Ekho is not installed, please visit https://www.eguidedog.net/ekho.php to install it or use other TTS tools to convert audio");
+    returnCode = DjiTest_SpeakerTtsInit(DjiTest_SpeakerTtsGetToneBackend(), WIDGET_SPEAKER_TTS_CACHE_MAX_BYTES);
+#endif
+    if (returnCode != DJI_ERROR_SYSTEM_MODULE_CODE_SUCCESS) {
+        USER_LOG_ERROR("Init speaker tts error: 0x%08llX", returnCode);
+        return returnCode;
+    }
+#endif
+
     returnCode = DjiWidget_RegSpeakerHandler(&s_speakerHandler);
     if (returnCode != DJI_ERROR_SYSTEM_MODULE_CODE_SUCCESS) {
         USER_LOG_ERROR("Register speaker handler error: 0x%08llX", returnCode);
@@ -167,146 +180,22 @@ T_DjiReturnCode DjiTest_WidgetSpeakerStartService(void)
 /* Private functions definition-----------------------------------------------*/
 #ifdef SYSTEM_ARCH_LINUX
 
-static uint32_t DjiTest_GetVoicePlayProcessId(void)
-{
-    FILE *fp;
-    char cmdStr[128];
-    uint32_t pid;
-    int ret;
-
-    snprintf(cmdStr, 128, "pgrep ffplay");
-    fp = popen(cmdStr, "r");
-    if (fp == NULL) {
-        USER_LOG_ERROR("fp is null.");
-        return 0;
-    }
-
-    ret = fscanf(fp, "%u", &pid);
-    if (ret <= 0) {
-        pid = 0;
-        goto out;
-    }
-
-out:
-    pclose(fp);
-
-    return pid;
-}
-
-static uint32_t DjiTest_KillVoicePlayProcess(uint32_t pid)
-{
-    FILE *fp;
-    char cmdStr[128];
-
-    snprintf(cmdStr, 128, "kill %d", pid);
-    fp = popen(cmdStr, "r");
-    if (fp == NULL) {
-        USER_LOG_ERROR("fp is null.");
-        return 0;
-    }
-
-    pclose(fp);
-
-    return pid;
-}
-
-static T_DjiReturnCode DjiTest_DecodeAudioData(void)
+static T_DjiReturnCode DjiTest_PlayAudioData(void)
 {
-#ifdef OPUS_INSTALLED
-    FILE *fin;
-    FILE *fout;
-    OpusDecoder *decoder;
-    opus_int16 out[WIDGET_SPEAKER_AUDIO_OPUS_MAX_FRAME_SIZE * WIDGET_SPEAKER_AUDIO_OPUS_CHANNELS];
-    uint8_t cbits[WIDGET_SPEAKER_AUDIO_OPUS_MAX_PACKET_SIZE];
-    int32_t nbBytes;
-    int32_t err;
-
-    /*! Attention: you can use "ffmpeg -i xxx.mp3 -ar 16000 -ac 1 out.wav" and use opus-tools to generate opus file for test */
-    fin = fopen(WIDGET_SPEAKER_AUDIO_OPUS_FILE_NAME, "r");
-    if (fin == NULL) {
-        fprintf(stderr, "failed to open input file: %s\n", strerror(errno));
-        return EXIT_FAILURE;
-    }
-
-    /* Create a new decoder state. */
-    decoder = opus_decoder_create(WIDGET_SPEAKER_AUDIO_OPUS_SAMPLE_RATE, WIDGET_SPEAKER_AUDIO_OPUS_CHANNELS, &err);
-    if (err < 0) {
-        fprintf(stderr, "failed to create decoder: %s\n", opus_strerror(err));
-        goto close_fin;
-    }
+    T_DjiReturnCode returnCode;
+    T_DjiTestSpeakerAudioMetrics metrics;
 
-    fout = fopen(WIDGET_SPEAKER_AUDIO_PCM_FILE_NAME, "w");
-    if (fout == NULL) {
-        fprintf(stderr, "failed to open output file: %s\n", strerror(errno));
-        goto close_fin;
+    returnCode = DjiTest_SpeakerAudioPlay();
+    if (returnCode != DJI_ERROR_SYSTEM_MODULE_CODE_SUCCESS) {
+        return returnCode;
     }
 
-    while (1) {
-        int i;
-        unsigned char pcm_bytes[WIDGET_SPEAKER_AUDIO_OPUS_MAX_FRAME_SIZE * WIDGET_SPEAKER_AUDIO_OPUS_CHANNELS * 2];
-        int frame_size;
-
-        /* Read a 16 bits/sample audio frame. */
-        nbBytes = fread(cbits, 1, s_decodeBitrate / WIDGET_SPEAKER_AUDIO_OPUS_DECODE_BITRATE_8KBPS *
-                                  WIDGET_SPEAKER_AUDIO_OPUS_DECODE_FRAME_SIZE_8KBPS, fin);
-        if (feof(fin))
-            break;
-
-        /* Decode the data. In this example, frame_size will be constant because
-           the encoder is using a constant frame size. However, that may not
-           be the case for all encoders, so the decoder must always check
-           the frame size returned. */
-        frame_size = opus_decode(decoder, cbits, nbBytes, out, WIDGET_SPEAKER_AUDIO_OPUS_MAX_FRAME_SIZE, 0);
-        if (frame_size < 0) {
-            fprintf(stderr, "decoder failed: %s\n", opus_strerror(frame_size));
-            goto close_fout;
-        }
-
-        USER_LOG_DEBUG("decode data to file: %d\r\n", frame_size * WIDGET_SPEAKER_AUDIO_OPUS_CHANNELS);
-        /* Convert to little-endian ordering. */
-        for (i = 0; i < WIDGET_SPEAKER_AUDIO_OPUS_CHANNELS * frame_size; i++) {
-            pcm_bytes[2 * i] = out[i] & 0xFF;
-            pcm_bytes[2 * i + 1] = (out[i] >> 8) & 0xFF;
-        }
-        /* Write the decoded audio to file. */
-        fwrite(pcm_bytes, sizeof(short), frame_size * WIDGET_SPEAKER_AUDIO_OPUS_CHANNELS, fout);
+    if (DjiTest_SpeakerAudioGetMetrics(&metrics) == DJI_ERROR_SYSTEM_MODULE_CODE_SUCCESS) {
+        USER_LOG_INFO("Voice play finished, start latency: %d ms, first packet to audio: %d ms, underrun: %d.",
+                      metrics.startLatencyMs, metrics.firstPacketToAudioMs, metrics.underrunCount);
     }
 
-    USER_LOG_INFO("Decode Finished...");
-    s_isDecodeFinished = true;
-
-decode_data_failed:
-    opus_decoder_destroy(decoder);
-create_decoder_failed:
-    fclose(fout);
-open_pcm_audio_failed:
-    fclose(fin);
-#endif
-    return EXIT_SUCCESS;
-
-#ifdef OPUS_INSTALLED
-close_fout:
-    fclose(fout);
-
-close_fin:
-    fclose(fin);
-
-    return EXIT_FAILURE;
-#endif
-
-}
-
-static T_DjiReturnCode DjiTest_PlayAudioData(void)
-{
-    char cmdStr[128];
-
-    memset(cmdStr, 0, sizeof(cmdStr));
-    USER_LOG_INFO("Start Playing...");
-
-    snprintf(cmdStr, sizeof(cmdStr), "ffplay -nodisp -autoexit -ar 16000 -ac 1 -f s16le -i %s 2>/dev/null",
-             WIDGET_SPEAKER_AUDIO_PCM_FILE_NAME);
-
-    return DjiUserUtil_RunSystemCmd(cmdStr);
+    return DJI_ERROR_SYSTEM_MODULE_CODE_SUCCESS;
 }
 
 static T_DjiReturnCode DjiTest_PlayTtsData(void)
@@ -314,7 +203,7 @@ static T_DjiReturnCode DjiTest_PlayTtsData(void)
     FILE *txtFile;
     uint8_t data[WIDGET_SPEAKER_TTS_FILE_MAX_SIZE] = {0};
     int32_t readLen;
-    char cmdStr[WIDGET_SPEAKER_TTS_FILE_MAX_SIZE + 128];
+    T_DjiTestSpeakerTtsMetrics ttsMetrics;
     T_DjiAircraftInfoBaseInfo aircraftInfoBaseInfo;
     T_DjiReturnCode returnCode;
 
@@ -356,27 +245,28 @@ static T_DjiReturnCode DjiTest_PlayTtsData(void)
         USER_LOG_INFO("Read tts file success, len: %d", readLen);
         USER_LOG_INFO("Content: %s", data);
 
-        memset(cmdStr, 0, sizeof(cmdStr));
-
         SetSpeakerState(DJI_WIDGET_SPEAKER_STATE_IN_TTS_CONVERSION);
 
-#if EKHO_INSTALLED
-        /*! Attention: you can use other tts opensource function to convert txt to speech, example used ekho v7.5 */
-        snprintf(cmdStr, sizeof(cmdStr), " ekho %s -s 20 -p 20 -a 100 -o %s", data,
-                 WIDGET_SPEAKER_TTS_OUTPUT_FILE_NAME);
-#else
-        USER_LOG_WARN(
-        "Ekho is not installed, please visit https://www.eguidedog.net/ekho.php to install it or use other TTS tools to convert audio");
-#endif
-        DjiUserUtil_RunSystemCmd(cmdStr);
+        returnCode = DjiTest_SpeakerTtsStartSpeak((const char *) data);
+        if (returnCode != DJI_ERROR_SYSTEM_MODULE_CODE_SUCCESS) {
+            USER_LOG_ERROR("Start tts speak failed, error: 0x%08llX.", returnCode);
+            DjiTest_SpeakerTtsWaitSpeakFinished();
+            return returnCode;
+        }
 
         SetSpeakerState(DJI_WIDGET_SPEAKER_STATE_PLAYING);
         USER_LOG_INFO("Start TTS Playing...");
-        memset(cmdStr, 0, sizeof(cmdStr));
-        snprintf(cmdStr, sizeof(cmdStr), "ffplay -nodisp -autoexit -ar 16000 -ac 1 -f s16le -i %s 2>/dev/null",
-                 WIDGET_SPEAKER_TTS_OUTPUT_FILE_NAME);
+        returnCode = DjiTest_PlayAudioData();
+        DjiTest_SpeakerTtsWaitSpeakFinished();
+
+        if (DjiTest_SpeakerTtsGetMetrics(&ttsMetrics) == DJI_ERROR_SYSTEM_MODULE_CODE_SUCCESS) {
+            USER_LOG_INFO("TTS first audio latency: %d ms, cache hit: %d/%d, cache: %d entries %d bytes, "
+                          "synthesis avg: %d ms max: %d ms.", ttsMetrics.firstAudioLatencyMs,
+                          ttsMetrics.cacheHitCount, ttsMetrics.sentenceCount, ttsMetrics.cacheEntryCount,
+                          ttsMetrics.cacheBytes, ttsMetrics.synthesisTimeAvgMs, ttsMetrics.synthesisTimeMaxMs);
+        }
 
-        return DjiUserUtil_RunSystemCmd(cmdStr);
+        return returnCode;
     }
 }
 
@@ -521,16 +411,10 @@ static T_DjiReturnCode SetPlayMode(E_DjiWidgetSpeakerPlayMode playMode)
 
 static T_DjiReturnCode StartPlay(void)
 {
-#ifdef SYSTEM_ARCH_LINUX
-    uint32_t pid;
-#endif
     T_DjiOsalHandler *osalHandler = DjiPlatform_GetOsalHandler();
 
 #ifdef SYSTEM_ARCH_LINUX
-    pid = DjiTest_GetVoicePlayProcessId();
-    if (pid != 0) {
-        DjiTest_KillVoicePlayProcess(pid);
-    }
+    DjiTest_SpeakerAudioRequestPlay();
 #endif
 
     osalHandler->TaskSleepMs(5);
@@ -544,9 +428,6 @@ static T_DjiReturnCode StopPlay(void)
 {
     T_DjiReturnCode returnCode;
     T_DjiOsalHandler *osalHandler = DjiPlatform_GetOsalHandler();
-#ifdef SYSTEM_ARCH_LINUX
-    uint32_t pid;
-#endif
 
     returnCode = osalHandler->MutexLock(s_speakerMutex);
     if (returnCode != DJI_ERROR_SYSTEM_MODULE_CODE_SUCCESS) {
@@ -558,10 +439,8 @@ static T_DjiReturnCode StopPlay(void)
     s_speakerState.state = DJI_WIDGET_SPEAKER_STATE_IDEL;
 
 #ifdef SYSTEM_ARCH_LINUX
-    pid = DjiTest_GetVoicePlayProcessId();
-    if (pid != 0) {
-        DjiTest_KillVoicePlayProcess(pid);
-    }
+    DjiTest_SpeakerTtsCancel();
+    DjiTest_SpeakerAudioStop();
 #endif
 
     returnCode = osalHandler->MutexUnlock(s_speakerMutex);
@@ -577,12 +456,6 @@ static T_DjiReturnCode SetVolume(uint8_t volume)
 {
     T_DjiReturnCode returnCode;
     T_DjiOsalHandler *osalHandler = DjiPlatform_GetOsalHandler();
-#ifdef PLATFORM_ARCH_x86_64
-    float realVolume;
-    int32_t ret = 0;
-    char cmdStr[128];
-#endif
-
     returnCode = osalHandler->MutexLock(s_speakerMutex);
     if (returnCode != DJI_ERROR_SYSTEM_MODULE_CODE_SUCCESS) {
         USER_LOG_ERROR("lock mutex error: 0x%08llX.", returnCode);
@@ -593,21 +466,10 @@ static T_DjiReturnCode SetVolume(uint8_t volume)
 
     USER_LOG_INFO("Set widget speaker volume: %d", volume);
 
-#ifdef PLATFORM_ARCH_x86_64
-    snprintf(cmdStr, sizeof(cmdStr), "pactl list | grep %s -q", WIDGET_SPEAKER_USB_AUDIO_DEVICE_NAME);
-    ret = system(cmdStr);
-    if (ret == DJI_ERROR_SYSTEM_MODULE_CODE_SUCCESS) {
-        memset(cmdStr, 0, sizeof(cmdStr));
-        realVolume = 1.5f * (float) volume;
-        snprintf(cmdStr, sizeof(cmdStr), "pactl set-sink-volume %s %d%%", WIDGET_SPEAKER_USB_AUDIO_DEVICE_NAME,
-                 (int32_t) realVolume);
-
-        returnCode = DjiUserUtil_RunSystemCmd(cmdStr);
-        if (returnCode != DJI_ERROR_SYSTEM_MODULE_CODE_SUCCESS) {
-            USER_LOG_ERROR("Set widget speaker volume error: %d", ret);
-        }
-    } else {
-        USER_LOG_WARN("No audio device found, please add audio device and init speaker volume here.");
+#ifdef SYSTEM_ARCH_LINUX
+    returnCode = DjiTest_SpeakerAudioSetVolume(volume);
+    if (returnCode != DJI_ERROR_SYSTEM_MODULE_CODE_SUCCESS) {
+        USER_LOG_ERROR("Set widget speaker volume error: 0x%08llX", returnCode);
     }
 #else
     USER_LOG_WARN("No audio device found, please add audio device and init speaker volume here!!!");
@@ -680,52 +542,39 @@ static T_DjiReturnCode ReceiveAudioData(E_DjiWidgetTransmitDataEvent event,
                                         uint32_t offset, uint8_t *buf, uint16_t size)
 {
 #ifdef SYSTEM_ARCH_LINUX
-    uint16_t writeLen;
     T_DjiReturnCode returnCode;
 #endif
 
     T_DjiWidgetTransDataContent transDataContent = {0};
 
     if (event == DJI_WIDGET_TRANSMIT_DATA_EVENT_START) {
-        s_isDecodeFinished = false;
+        memcpy(&transDataContent, buf, size);
+        USER_LOG_INFO("Create voice stream: %s, decoder bitrate: %d.", transDataContent.transDataStartContent.fileName,
+                      transDataContent.transDataStartContent.fileDecodeBitrate);
 #ifdef SYSTEM_ARCH_LINUX
-        USER_LOG_INFO("Create voice file.");
-        s_audioFile = fopen(WIDGET_SPEAKER_AUDIO_OPUS_FILE_NAME, "wb");
-        if (s_audioFile == NULL) {
-            USER_LOG_ERROR("Create tts file error.");
+        returnCode = DjiTest_SpeakerAudioBeginStream(transDataContent.transDataStartContent.fileDecodeBitrate);
+        if (returnCode != DJI_ERROR_SYSTEM_MODULE_CODE_SUCCESS) {
+            USER_LOG_ERROR("Begin voice stream error: 0x%08llX", returnCode);
         }
+#endif
         if (s_speakerState.state != DJI_WIDGET_SPEAKER_STATE_PLAYING) {
             SetSpeakerState(DJI_WIDGET_SPEAKER_STATE_TRANSMITTING);
         }
-#endif
-
-        memcpy(&transDataContent, buf, size);
-        s_decodeBitrate = transDataContent.transDataStartContent.fileDecodeBitrate;
-        USER_LOG_INFO("Create voice file: %s, decoder bitrate: %d.", transDataContent.transDataStartContent.fileName,
-                      transDataContent.transDataStartContent.fileDecodeBitrate);
     } else if (event == DJI_WIDGET_TRANSMIT_DATA_EVENT_TRANSMIT) {
-        USER_LOG_INFO("Transmit voice file, offset: %d, size: %d", offset, size);
+        USER_LOG_DEBUG("Transmit voice data, offset: %d, size: %d", offset, size);
 #ifdef SYSTEM_ARCH_LINUX
-        if (s_audioFile != NULL) {
-            fseek(s_audioFile, offset, SEEK_SET);
-            writeLen = fwrite(buf, 1, size, s_audioFile);
-            if (writeLen != size) {
-                USER_LOG_ERROR("Write tts file error %d", writeLen);
-            }
+        returnCode = DjiTest_SpeakerAudioFeedOpus(offset, buf, size);
+        if (returnCode != DJI_ERROR_SYSTEM_MODULE_CODE_SUCCESS) {
+            USER_LOG_ERROR("Feed voice data error: 0x%08llX", returnCode);
         }
 #endif
         if (s_speakerState.state != DJI_WIDGET_SPEAKER_STATE_PLAYING) {
             SetSpeakerState(DJI_WIDGET_SPEAKER_STATE_TRANSMITTING);
         }
     } else if (event == DJI_WIDGET_TRANSMIT_DATA_EVENT_FINISH) {
-        USER_LOG_INFO("Close voice file.");
-        if (s_audioFile != NULL) {
-            fclose(s_audioFile);
-            s_audioFile = NULL;
-        }
-
+        USER_LOG_INFO("Finish voice stream.");
 #ifdef SYSTEM_ARCH_LINUX
-        returnCode = DjiTest_CheckFileMd5Sum(WIDGET_SPEAKER_AUDIO_OPUS_FILE_NAME, buf, size);
+        returnCode = DjiTest_SpeakerAudioEndStream(buf, size);
         if (returnCode != DJI_ERROR_SYSTEM_MODULE_CODE_SUCCESS) {
             USER_LOG_ERROR("File md5 sum check failed");
             return DJI_ERROR_SYSTEM_MODULE_CODE_SYSTEM_ERROR;
@@ -734,9 +583,6 @@ static T_DjiReturnCode ReceiveAudioData(E_DjiWidgetTransmitDataEvent event,
         if (s_speakerState.state != DJI_WIDGET_SPEAKER_STATE_PLAYING) {
             SetSpeakerState(DJI_WIDGET_SPEAKER_STATE_IDEL);
         }
-#ifdef SYSTEM_ARCH_LINUX
-        DjiTest_DecodeAudioData();
-#endif
     }
 
     return DJI_ERROR_SYSTEM_MODULE_CODE_SUCCESS;
@@ -762,10 +608,6 @@ static void *DjiTest_WidgetSpeakerTask(void *arg)
         if (s_speakerState.state == DJI_WIDGET_SPEAKER_STATE_PLAYING) {
             if (s_speakerState.playMode == DJI_WIDGET_SPEAKER_PLAY_MODE_LOOP_PLAYBACK) {
                 if (s_speakerState.workMode == DJI_WIDGET_SPEAKER_WORK_MODE_VOICE) {
-                    USER_LOG_DEBUG("Waiting opus decoder finished...");
-                    while (s_isDecodeFinished == false) {
-                        osalHandler->TaskSleepMs(1);
-                    }
                     djiReturnCode = DjiTest_PlayAudioData();
                     if (djiReturnCode != DJI_ERROR_SYSTEM_MODULE_CODE_SUCCESS) {
                         USER_LOG_ERROR("Play audio data failed, error: 0x%08llX.", djiReturnCode);
@@ -779,10 +621,6 @@ static void *DjiTest_WidgetSpeakerTask(void *arg)
                 osalHandler->TaskSleepMs(1000);
             } else {
                 if (s_speakerState.workMode == DJI_WIDGET_SPEAKER_WORK_MODE_VOICE) {
-                    USER_LOG_DEBUG("Waiting opus decoder finished...");
-                    while (s_isDecodeFinished == false) {
-                        osalHandler->TaskSleepMs(1);
-                    }
                     djiReturnCode = DjiTest_PlayAudioData();
                     if (djiReturnCode != DJI_ERROR_SYSTEM_MODULE_CODE_SUCCESS) {
                         USER_LOG_ERROR("Play audio data failed, error: 0x%08llX.", djiReturnCode);
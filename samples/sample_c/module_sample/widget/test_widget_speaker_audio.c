@@ -0,0 +1,986 @@
+/**
+ ********************************************************************
+ * @file    test_widget_speaker_audio.c
+ * @brief   Streaming audio engine of the widget speaker sample. Opus packets are decoded as they are received
+ *          into an in-memory clip, which also acts as the jitter buffer of an in-process PCM sink.
+ *
+ * @copyright (c) 2021 DJI. All rights reserved.
+ *
+ * All information contained herein is, and remains, the property of DJI.
+ * The intellectual and technical concepts contained herein are proprietary
+ * to DJI and may be covered by U.S. and foreign patents, patents in process,
+ * and protected by trade secret or copyright law.  Dissemination of this
+ * information, including but not limited to data and other proprietary
+ * material(s) incorporated within the information, in any form, is strictly
+ * prohibited without the express written consent of DJI.
+ *
+ * If you receive this source code without DJI’s authorization, you may not
+ * further disseminate the information, and you must immediately remove the
+ * source code and notify DJI of its removal. DJI reserves the right to pursue
+ * legal actions against you for any loss(es) or damage(s) caused by your
+ * failure to do so.
+ *
+ *********************************************************************
+ */
+
+/* Includes ------------------------------------------------------------------*/
+#include "test_widget_speaker_audio.h"
+
+#ifdef SYSTEM_ARCH_LINUX
+
+#include <stdio.h>
+#include <string.h>
+#include <errno.h>
+#include <signal.h>
+#include <unistd.h>
+#include <sys/wait.h>
+#include "dji_platform.h"
+#include "dji_logger.h"
+#include "utils/util_misc.h"
+#include "utils/util_md5.h"
+
+#ifdef OPUS_INSTALLED
+
+#include <opus/opus.h>
+
+#endif
+
+#ifdef ALSA_INSTALLED
+
+#include <alsa/asoundlib.h>
+
+#endif
+
+/* Private constants ---------------------------------------------------------*/
+#define DJI_TEST_SPEAKER_AUDIO_OPUS_MAX_PACKET_SIZE         (3 * 1276)
+#define DJI_TEST_SPEAKER_AUDIO_OPUS_MAX_FRAME_SIZE          (6 * 960)
+#define DJI_TEST_SPEAKER_AUDIO_OPUS_FRAME_SIZE_8KBPS        (40)
+#define DJI_TEST_SPEAKER_AUDIO_OPUS_BITRATE_8KBPS           (8000)
+
+#define DJI_TEST_SPEAKER_AUDIO_PERIOD_MS_MAX                (100)
+#define DJI_TEST_SPEAKER_AUDIO_ALSA_LATENCY_US              (50000)
+#define DJI_TEST_SPEAKER_AUDIO_VOLUME_MAX                   (100)
+#define DJI_TEST_SPEAKER_AUDIO_GAIN_Q15_ONE                 (32768)
+#define DJI_TEST_SPEAKER_AUDIO_INIT_CLIP_MS                 (5000)
+#define DJI_TEST_SPEAKER_AUDIO_FFPLAY_LEAD_MS               (200)
+#define DJI_TEST_SPEAKER_AUDIO_FFPLAY_CHECK_CMD             "command -v ffplay >/dev/null 2>&1"
+
+#define DJI_TEST_SPEAKER_AUDIO_MS_TO_FRAMES(ms)             ((uint32_t) ((uint64_t) (ms) * \
+                                                             DJI_TEST_SPEAKER_AUDIO_SAMPLE_RATE / 1000))
+
+/* Private types -------------------------------------------------------------*/
+typedef struct {
+    T_DjiTestSpeakerAudioConfig config;
+    const T_DjiTestSpeakerAudioSink *sink;
+    T_DjiMutexHandle mutex;
+    T_DjiSemaHandle dataSema;
+
+    int16_t *clipBuf;
+    uint32_t clipCapacity;
+    uint32_t clipFrames;
+    uint32_t clipGeneration;
+    bool isStreamOpen;
+
+    uint8_t packetBuf[DJI_TEST_SPEAKER_AUDIO_OPUS_MAX_PACKET_SIZE];
+    uint16_t packetLen;
+    uint16_t packetSize;
+    uint32_t expectedOffset;
+    MD5_CTX md5Ctx;
+#ifdef OPUS_INSTALLED
+    OpusDecoder *decoder;
+#endif
+
+    int16_t *periodBuf;
+    volatile bool isStopRequested;
+    int32_t gainQ15;
+    uint64_t playRequestUs;
+    uint64_t stopRequestUs;
+    uint64_t firstPacketUs;
+    uint64_t decodeTimeTotalUs;
+    T_DjiTestSpeakerAudioMetrics metrics;
+} T_DjiTestSpeakerAudioContext;
+
+/* Private functions declaration ---------------------------------------------*/
+static T_DjiReturnCode DjiTest_SpeakerAudioReserveClip(uint32_t frameCount);
+static void DjiTest_SpeakerAudioApplyGain(int16_t *pcm, uint32_t sampleCount, int32_t gainQ15);
+static void DjiTest_SpeakerAudioDecodePacket(const uint8_t *packet, uint16_t len);
+static uint64_t DjiTest_SpeakerAudioGetTimeUs(void);
+
+#ifdef ALSA_INSTALLED
+static T_DjiReturnCode DjiTest_SpeakerAudioAlsaOpen(const char *name, uint32_t sampleRate, uint8_t channels);
+static T_DjiReturnCode DjiTest_SpeakerAudioAlsaWrite(const int16_t *pcm, uint32_t frameCount);
+static T_DjiReturnCode DjiTest_SpeakerAudioAlsaDrain(void);
+static T_DjiReturnCode DjiTest_SpeakerAudioAlsaClose(void);
+#else
+static T_DjiReturnCode DjiTest_SpeakerAudioFfplayOpen(const char *name, uint32_t sampleRate, uint8_t channels);
+static T_DjiReturnCode DjiTest_SpeakerAudioFfplayWrite(const int16_t *pcm, uint32_t frameCount);
+static T_DjiReturnCode DjiTest_SpeakerAudioFfplayDrain(void);
+static T_DjiReturnCode DjiTest_SpeakerAudioFfplayClose(void);
+#endif
+static T_DjiReturnCode DjiTest_SpeakerAudioFileOpen(const char *name, uint32_t sampleRate, uint8_t channels);
+static T_DjiReturnCode DjiTest_SpeakerAudioFileWrite(const int16_t *pcm, uint32_t frameCount);
+static T_DjiReturnCode DjiTest_SpeakerAudioFileDrain(void);
+static T_DjiReturnCode DjiTest_SpeakerAudioFileClose(void);
+static T_DjiReturnCode DjiTest_SpeakerAudioNullOpen(const char *name, uint32_t sampleRate, uint8_t channels);
+static T_DjiReturnCode DjiTest_SpeakerAudioNullWrite(const int16_t *pcm, uint32_t frameCount);
+static T_DjiReturnCode DjiTest_SpeakerAudioNullDrain(void);
+static T_DjiReturnCode DjiTest_SpeakerAudioNullClose(void);
+
+/* Private values -------------------------------------------------------------*/
+static T_DjiTestSpeakerAudioContext s_speakerAudio = {0};
+static bool s_isSpeakerAudioInited = false;
+
+#ifdef ALSA_INSTALLED
+static snd_pcm_t *s_alsaPcm = NULL;
+static const T_DjiTestSpeakerAudioSink s_alsaSink = {
+    DjiTest_SpeakerAudioAlsaOpen,
+    DjiTest_SpeakerAudioAlsaWrite,
+    DjiTest_SpeakerAudioAlsaDrain,
+    DjiTest_SpeakerAudioAlsaClose,
+};
+#else
+static pid_t s_ffplayPid = -1;
+static int s_ffplayFd = -1;
+static uint32_t s_ffplaySampleRate = 0;
+static uint64_t s_ffplayStartUs = 0;
+static uint64_t s_ffplayFrames = 0;
+static const T_DjiTestSpeakerAudioSink s_ffplaySink = {
+    DjiTest_SpeakerAudioFfplayOpen,
+    DjiTest_SpeakerAudioFfplayWrite,
+    DjiTest_SpeakerAudioFfplayDrain,
+    DjiTest_SpeakerAudioFfplayClose,
+};
+#endif
+
+static FILE *s_fileSinkFp = NULL;
+static const T_DjiTestSpeakerAudioSink s_fileSink = {
+    DjiTest_SpeakerAudioFileOpen,
+    DjiTest_SpeakerAudioFileWrite,
+    DjiTest_SpeakerAudioFileDrain,
+    DjiTest_SpeakerAudioFileClose,
+};
+
+static const T_DjiTestSpeakerAudioSink s_nullSink = {
+    DjiTest_SpeakerAudioNullOpen,
+    DjiTest_SpeakerAudioNullWrite,
+    DjiTest_SpeakerAudioNullDrain,
+    DjiTest_SpeakerAudioNullClose,
+};
+
+/* Exported functions definition ---------------------------------------------*/
+T_DjiReturnCode DjiTest_SpeakerAudioInit(const T_DjiTestSpeakerAudioConfig *config)
+{
+    T_DjiReturnCode returnCode;
+    T_DjiOsalHandler *osalHandler = DjiPlatform_GetOsalHandler();
+
+    if (config == NULL || config->periodMs == 0 || config->periodMs > DJI_TEST_SPEAKER_AUDIO_PERIOD_MS_MAX) {
+        return DJI_ERROR_SYSTEM_MODULE_CODE_INVALID_PARAMETER;
+    }
+
+    if (s_isSpeakerAudioInited) {
+        return DJI_ERROR_SYSTEM_MODULE_CODE_SUCCESS;
+    }
+
+    memset(&s_speakerAudio, 0, sizeof(s_speakerAudio));
+    s_speakerAudio.config = *config;
+    s_speakerAudio.gainQ15 = DJI_TEST_SPEAKER_AUDIO_GAIN_Q15_ONE;
+
+    switch (config->sinkType) {
+        case DJI_TEST_SPEAKER_AUDIO_SINK_ALSA:
+#ifdef ALSA_INSTALLED
+            s_speakerAudio.sink = &s_alsaSink;
+#else
+            if (system(DJI_TEST_SPEAKER_AUDIO_FFPLAY_CHECK_CMD) == 0) {
+                USER_LOG_WARN("ALSA was not found at build time, speaker audio is played through ffplay.");
+                s_speakerAudio.sink = &s_ffplaySink;
+            } else {
+                USER_LOG_WARN("ALSA was not found at build time and ffplay is not installed, "
+                              "speaker audio is discarded by the null sink.");
+                s_speakerAudio.sink = &s_nullSink;
+            }
+#endif
+            break;
+        case DJI_TEST_SPEAKER_AUDIO_SINK_FILE:
+            s_speakerAudio.sink = &s_fileSink;
+            break;
+        default:
+            s_speakerAudio.sink = &s_nullSink;
+            break;
+    }
+
+    returnCode = osalHandler->MutexCreate(&s_speakerAudio.mutex);
+    if (returnCode != DJI_ERROR_SYSTEM_MODULE_CODE_SUCCESS) {
+        USER_LOG_ERROR("Create speaker audio mutex error: 0x%08llX", returnCode);
+        return returnCode;
+    }
+
+    returnCode = osalHandler->SemaphoreCreate(0, &s_speakerAudio.dataSema);
+    if (returnCode != DJI_ERROR_SYSTEM_MODULE_CODE_SUCCESS) {
+        USER_LOG_ERROR("Create speaker audio semaphore error: 0x%08llX", returnCode);
+        osalHandler->MutexDestroy(s_speakerAudio.mutex);
+        return returnCode;
+    }
+
+    s_speakerAudio.periodBuf = osalHandler->Malloc(DJI_TEST_SPEAKER_AUDIO_MS_TO_FRAMES(config->periodMs) *
+                                                   DJI_TEST_SPEAKER_AUDIO_CHANNELS * sizeof(int16_t));
+    if (s_speakerAudio.periodBuf == NULL) {
+        osalHandler->SemaphoreDestroy(s_speakerAudio.dataSema);
+        osalHandler->MutexDestroy(s_speakerAudio.mutex);
+        return DJI_ERROR_SYSTEM_MODULE_CODE_MEMORY_ALLOC_FAILED;
+    }
+
+    returnCode = DjiTest_SpeakerAudioReserveClip(
+        DJI_TEST_SPEAKER_AUDIO_MS_TO_FRAMES(DJI_TEST_SPEAKER_AUDIO_INIT_CLIP_MS));
+    if (returnCode != DJI_ERROR_SYSTEM_MODULE_CODE_SUCCESS) {
+        osalHandler->Free(s_speakerAudio.periodBuf);
+        osalHandler->SemaphoreDestroy(s_speakerAudio.dataSema);
+        osalHandler->MutexDestroy(s_speakerAudio.mutex);
+        return returnCode;
+    }
+
+    s_isSpeakerAudioInited = true;
+
+    return DJI_ERROR_SYSTEM_MODULE_CODE_SUCCESS;
+}
+
+T_DjiReturnCode DjiTest_SpeakerAudioDeInit(void)
+{
+    T_DjiOsalHandler *osalHandler = DjiPlatform_GetOsalHandler();
+
+    if (!s_isSpeakerAudioInited) {
+        return DJI_ERROR_SYSTEM_MODULE_CODE_SUCCESS;
+    }
+
+#ifdef OPUS_INSTALLED
+    if (s_speakerAudio.decoder != NULL) {
+        opus_decoder_destroy(s_speakerAudio.decoder);
+    }
+#endif
+    osalHandler->Free(s_speakerAudio.clipBuf);
+    osalHandler->Free(s_speakerAudio.periodBuf);
+    osalHandler->SemaphoreDestroy(s_speakerAudio.dataSema);
+    osalHandler->MutexDestroy(s_speakerAudio.mutex);
+    memset(&s_speakerAudio, 0, sizeof(s_speakerAudio));
+    s_isSpeakerAudioInited = false;
+
+    return DJI_ERROR_SYSTEM_MODULE_CODE_SUCCESS;
+}
+
+/**
+ * @brief Start receiving a new clip, the previous clip is discarded.
+ * @param decodeBitrate: opus bitrate of the stream, it defines the constant packet size of the stream. Use 0 for
+ * a PCM stream fed by DjiTest_SpeakerAudioAppendPcm().
+ * @return Execution result.
+ */
+T_DjiReturnCode DjiTest_SpeakerAudioBeginStream(uint32_t decodeBitrate)
+{
+    T_DjiOsalHandler *osalHandler = DjiPlatform_GetOsalHandler();
+    uint32_t packetSize;
+#ifdef OPUS_INSTALLED
+    int32_t err;
+#endif
+
+    if (!s_isSpeakerAudioInited) {
+        return DJI_ERROR_SYSTEM_MODULE_CODE_NONSUPPORT_IN_CURRENT_STATE;
+    }
+
+    if (decodeBitrate != 0 && decodeBitrate < DJI_TEST_SPEAKER_AUDIO_OPUS_BITRATE_8KBPS) {
+        decodeBitrate = DJI_TEST_SPEAKER_AUDIO_OPUS_BITRATE_8KBPS;
+    }
+    packetSize = decodeBitrate / DJI_TEST_SPEAKER_AUDIO_OPUS_BITRATE_8KBPS *
+                 DJI_TEST_SPEAKER_AUDIO_OPUS_FRAME_SIZE_8KBPS;
+    if (packetSize > DJI_TEST_SPEAKER_AUDIO_OPUS_MAX_PACKET_SIZE) {
+        return DJI_ERROR_SYSTEM_MODULE_CODE_INVALID_PARAMETER;
+    }
+
+    osalHandler->MutexLock(s_speakerAudio.mutex);
+
+    s_speakerAudio.clipFrames = 0;
+    s_speakerAudio.clipGeneration++;
+    s_speakerAudio.isStreamOpen = true;
+    s_speakerAudio.packetLen = 0;
+    s_speakerAudio.packetSize = (uint16_t) packetSize;
+    s_speakerAudio.expectedOffset = 0;
+    s_speakerAudio.firstPacketUs = 0;
+    s_speakerAudio.decodeTimeTotalUs = 0;
+    s_speakerAudio.metrics.decodedPacketCount = 0;
+    s_speakerAudio.metrics.decodeErrorCount = 0;
+    s_speakerAudio.metrics.decodeTimeAvgUs = 0;
+    s_speakerAudio.metrics.decodeTimeMaxUs = 0;
+    s_speakerAudio.metrics.clipMs = 0;
+    UtilMd5_Init(&s_speakerAudio.md5Ctx);
+
+    if (decodeBitrate == 0) {
+        goto out;
+    }
+
+#ifdef OPUS_INSTALLED
+    if (s_speakerAudio.decoder == NULL) {
+        s_speakerAudio.decoder = opus_decoder_create(DJI_TEST_SPEAKER_AUDIO_SAMPLE_RATE,
+                                                     DJI_TEST_SPEAKER_AUDIO_CHANNELS, &err);
+        if (err < 0) {
+            USER_LOG_ERROR("Failed to create decoder: %s", opus_strerror(err));
+            s_speakerAudio.decoder = NULL;
+        }
+    } else {
+        opus_decoder_ctl(s_speakerAudio.decoder, OPUS_RESET_STATE);
+    }
+#else
+    USER_LOG_WARN("Opus is not installed, received voice data will not be decoded.");
+#endif
+
+out:
+    osalHandler->MutexUnlock(s_speakerAudio.mutex);
+    osalHandler->SemaphorePost(s_speakerAudio.dataSema);
+
+    return DJI_ERROR_SYSTEM_MODULE_CODE_SUCCESS;
+}
+
+/**
+ * @brief Feed received opus stream bytes. Complete packets are decoded immediately, so audio can be played
+ * while the rest of the clip is still being transmitted.
+ * @param offset: offset of the data in the stream.
+ * @param data: pointer to the data.
+ * @param len: length of the data.
+ * @return Execution result.
+ */
+T_DjiReturnCode DjiTest_SpeakerAudioFeedOpus(uint32_t offset, const uint8_t *data, uint16_t len)
+{
+    T_DjiOsalHandler *osalHandler = DjiPlatform_GetOsalHandler();
+    uint16_t copyLen;
+    uint16_t pos = 0;
+
+    if (!s_isSpeakerAudioInited || data == NULL) {
+        return DJI_ERROR_SYSTEM_MODULE_CODE_INVALID_PARAMETER;
+    }
+
+    osalHandler->MutexLock(s_speakerAudio.mutex);
+    if (!s_speakerAudio.isStreamOpen || s_speakerAudio.packetSize == 0) {
+        osalHandler->MutexUnlock(s_speakerAudio.mutex);
+        return DJI_ERROR_SYSTEM_MODULE_CODE_NONSUPPORT_IN_CURRENT_STATE;
+    }
+    if (offset + len <= s_speakerAudio.expectedOffset) {
+        osalHandler->MutexUnlock(s_speakerAudio.mutex);
+        return DJI_ERROR_SYSTEM_MODULE_CODE_SUCCESS;
+    }
+    if (offset != s_speakerAudio.expectedOffset) {
+        USER_LOG_WARN("Voice data offset %d is not continuous, expect %d.", offset, s_speakerAudio.expectedOffset);
+        s_speakerAudio.packetLen = 0;
+    }
+    if (s_speakerAudio.firstPacketUs == 0) {
+        s_speakerAudio.firstPacketUs = DjiTest_SpeakerAudioGetTimeUs();
+    }
+    UtilMd5_Update(&s_speakerAudio.md5Ctx, data, len);
+    s_speakerAudio.expectedOffset = offset + len;
+    osalHandler->MutexUnlock(s_speakerAudio.mutex);
+
+    /* Packet assembly and decoding only happen on the receive thread, only the clip append takes the lock. */
+    while (pos < len) {
+        copyLen = USER_UTIL_MIN((uint16_t) (len - pos),
+                                (uint16_t) (s_speakerAudio.packetSize - s_speakerAudio.packetLen));
+        memcpy(&s_speakerAudio.packetBuf[s_speakerAudio.packetLen], &data[pos], copyLen);
+        s_speakerAudio.packetLen += copyLen;
+        pos += copyLen;
+
+        if (s_speakerAudio.packetLen == s_speakerAudio.packetSize) {
+            DjiTest_SpeakerAudioDecodePacket(s_speakerAudio.packetBuf, s_speakerAudio.packetLen);
+            s_speakerAudio.packetLen = 0;
+        }
+    }
+
+    return DJI_ERROR_SYSTEM_MODULE_CODE_SUCCESS;
+}
+
+/**
+ * @brief Append decoded PCM to the current clip and wake up the player.
+ * @param pcm: interleaved signed 16 bits samples.
+ * @param frameCount: number of frames.
+ * @return Execution result.
+ */
+T_DjiReturnCode DjiTest_SpeakerAudioAppendPcm(const int16_t *pcm, uint32_t frameCount)
+{
+    T_DjiReturnCode returnCode;
+    T_DjiOsalHandler *osalHandler = DjiPlatform_GetOsalHandler();
+
+    if (!s_isSpeakerAudioInited || pcm == NULL) {
+        return DJI_ERROR_SYSTEM_MODULE_CODE_INVALID_PARAMETER;
+    }
+
+    osalHandler->MutexLock(s_speakerAudio.mutex);
+    returnCode = DjiTest_SpeakerAudioReserveClip(s_speakerAudio.clipFrames + frameCount);
+    if (returnCode == DJI_ERROR_SYSTEM_MODULE_CODE_SUCCESS) {
+        memcpy(&s_speakerAudio.clipBuf[s_speakerAudio.clipFrames * DJI_TEST_SPEAKER_AUDIO_CHANNELS], pcm,
+               frameCount * DJI_TEST_SPEAKER_AUDIO_CHANNELS * sizeof(int16_t));
+        s_speakerAudio.clipFrames += frameCount;
+        s_speakerAudio.metrics.clipMs = s_speakerAudio.clipFrames * 1000 / DJI_TEST_SPEAKER_AUDIO_SAMPLE_RATE;
+    }
+    osalHandler->MutexUnlock(s_speakerAudio.mutex);
+    osalHandler->SemaphorePost(s_speakerAudio.dataSema);
+
+    return returnCode;
+}
+
+/**
+ * @brief Finish the current clip and check the md5 sum of the received stream.
+ * @param md5Sum: md5 sum sent with the finish event, NULL to skip the check.
+ * @param md5Size: size of the md5 sum.
+ * @return Execution result.
+ */
+T_DjiReturnCode DjiTest_SpeakerAudioEndStream(const uint8_t *md5Sum, uint16_t md5Size)
+{
+    T_DjiOsalHandler *osalHandler = DjiPlatform_GetOsalHandler();
+    uint8_t streamMd5[MD5_BLOCK_SIZE];
+    T_DjiReturnCode returnCode = DJI_ERROR_SYSTEM_MODULE_CODE_SUCCESS;
+
+    if (!s_isSpeakerAudioInited) {
+        return DJI_ERROR_SYSTEM_MODULE_CODE_NONSUPPORT_IN_CURRENT_STATE;
+    }
+
+    osalHandler->MutexLock(s_speakerAudio.mutex);
+    UtilMd5_Final(&s_speakerAudio.md5Ctx, streamMd5);
+    s_speakerAudio.isStreamOpen = false;
+    if (s_speakerAudio.packetLen > 0) {
+        USER_LOG_DEBUG("Drop incomplete opus packet of %d bytes.", s_speakerAudio.packetLen);
+        s_speakerAudio.packetLen = 0;
+    }
+    osalHandler->MutexUnlock(s_speakerAudio.mutex);
+    osalHandler->SemaphorePost(s_speakerAudio.dataSema);
+
+    if (md5Sum != NULL) {
+        if (md5Size != sizeof(streamMd5)) {
+            USER_LOG_ERROR("MD5 sum length error");
+        } else if (memcmp(streamMd5, md5Sum, sizeof(streamMd5)) != 0) {
+            returnCode = DJI_ERROR_SYSTEM_MODULE_CODE_SYSTEM_ERROR;
+        } else {
+            USER_LOG_INFO("MD5 sum check success");
+        }
+    }
+
+    if (s_speakerAudio.packetSize > 0) {
+        USER_LOG_INFO("Decode Finished, clip %d ms, %d packets, decode avg %d us max %d us.",
+                      s_speakerAudio.metrics.clipMs, s_speakerAudio.metrics.decodedPacketCount,
+                      s_speakerAudio.metrics.decodeTimeAvgUs, s_speakerAudio.metrics.decodeTimeMaxUs);
+    }
+
+    return returnCode;
+}
+
+/**
+ * @brief Record the time the pilot asked to play, the start latency is measured from here.
+ * @return Execution result.
+ */
+T_DjiReturnCode DjiTest_SpeakerAudioRequestPlay(void)
+{
+    if (!s_isSpeakerAudioInited) {
+        return DJI_ERROR_SYSTEM_MODULE_CODE_NONSUPPORT_IN_CURRENT_STATE;
+    }
+
+    s_speakerAudio.playRequestUs = DjiTest_SpeakerAudioGetTimeUs();
+    s_speakerAudio.isStopRequested = false;
+
+    return DJI_ERROR_SYSTEM_MODULE_CODE_SUCCESS;
+}
+
+/**
+ * @brief Play the current clip once. Blocks until the clip is played, or until DjiTest_SpeakerAudioStop() is
+ * called. If the clip is still being received, playback follows the decoder and waits for the prebuffer
+ * whenever it catches up with it.
+ * @return Execution result.
+ */
+T_DjiReturnCode DjiTest_SpeakerAudioPlay(void)
+{
+    T_DjiReturnCode returnCode;
+    T_DjiOsalHandler *osalHandler = DjiPlatform_GetOsalHandler();
+    const T_DjiTestSpeakerAudioSink *sink = s_speakerAudio.sink;
+    uint32_t periodFrames = DJI_TEST_SPEAKER_AUDIO_MS_TO_FRAMES(s_speakerAudio.config.periodMs);
+    uint32_t prebufferFrames = DJI_TEST_SPEAKER_AUDIO_MS_TO_FRAMES(s_speakerAudio.config.prebufferMs);
+    uint32_t readFrames = 0;
+    uint32_t availableFrames;
+    uint32_t copyFrames;
+    uint32_t generation;
+    int32_t gainQ15;
+    bool isStreamOpen;
+    bool isBuffering = true;
+    bool isFirstWrite = true;
+    uint64_t nowUs;
+
+    if (!s_isSpeakerAudioInited) {
+        return DJI_ERROR_SYSTEM_MODULE_CODE_NONSUPPORT_IN_CURRENT_STATE;
+    }
+
+    osalHandler->MutexLock(s_speakerAudio.mutex);
+    generation = s_speakerAudio.clipGeneration;
+    if (s_speakerAudio.clipFrames == 0 && !s_speakerAudio.isStreamOpen) {
+        osalHandler->MutexUnlock(s_speakerAudio.mutex);
+        USER_LOG_WARN("No voice data to play.");
+        return DJI_ERROR_SYSTEM_MODULE_CODE_NOT_FOUND;
+    }
+    osalHandler->MutexUnlock(s_speakerAudio.mutex);
+
+    returnCode = sink->Open(s_speakerAudio.config.sinkName, DJI_TEST_SPEAKER_AUDIO_SAMPLE_RATE,
+                            DJI_TEST_SPEAKER_AUDIO_CHANNELS);
+    if (returnCode != DJI_ERROR_SYSTEM_MODULE_CODE_SUCCESS) {
+        USER_LOG_ERROR("Open speaker audio sink failed, error: 0x%08llX.", returnCode);
+        return returnCode;
+    }
+
+    USER_LOG_INFO("Start Playing...");
+    while (!s_speakerAudio.isStopRequested) {
+        osalHandler->MutexLock(s_speakerAudio.mutex);
+        if (generation != s_speakerAudio.clipGeneration) {
+            generation = s_speakerAudio.clipGeneration;
+            readFrames = 0;
+            isBuffering = true;
+        }
+        availableFrames = s_speakerAudio.clipFrames - readFrames;
+        isStreamOpen = s_speakerAudio.isStreamOpen;
+
+        if (availableFrames == 0 && !isStreamOpen) {
+            osalHandler->MutexUnlock(s_speakerAudio.mutex);
+            break;
+        }
+
+        if (isStreamOpen && availableFrames < (isBuffering ? prebufferFrames : 1)) {
+            osalHandler->MutexUnlock(s_speakerAudio.mutex);
+            if (!isBuffering) {
+                s_speakerAudio.metrics.underrunCount++;
+                isBuffering = true;
+            }
+            osalHandler->SemaphoreTimedWait(s_speakerAudio.dataSema, s_speakerAudio.config.periodMs);
+            continue;
+        }
+
+        isBuffering = false;
+        copyFrames = USER_UTIL_MIN(availableFrames, periodFrames);
+        memcpy(s_speakerAudio.periodBuf, &s_speakerAudio.clipBuf[readFrames * DJI_TEST_SPEAKER_AUDIO_CHANNELS],
+               copyFrames * DJI_TEST_SPEAKER_AUDIO_CHANNELS * sizeof(int16_t));
+        gainQ15 = s_speakerAudio.gainQ15;
+        osalHandler->MutexUnlock(s_speakerAudio.mutex);
+
+        DjiTest_SpeakerAudioApplyGain(s_speakerAudio.periodBuf, copyFrames * DJI_TEST_SPEAKER_AUDIO_CHANNELS, gainQ15);
+        returnCode = sink->Write(s_speakerAudio.periodBuf, copyFrames);
+        if (returnCode != DJI_ERROR_SYSTEM_MODULE_CODE_SUCCESS) {
+            USER_LOG_ERROR("Write speaker audio sink failed, error: 0x%08llX.", returnCode);
+            break;
+        }
+
+        if (isFirstWrite) {
+            isFirstWrite = false;
+            nowUs = DjiTest_SpeakerAudioGetTimeUs();
+            s_speakerAudio.metrics.startLatencyMs = (uint32_t) ((nowUs - s_speakerAudio.playRequestUs) / 1000);
+            if (isStreamOpen && s_speakerAudio.firstPacketUs != 0) {
+                s_speakerAudio.metrics.firstPacketToAudioMs =
+                    (uint32_t) ((nowUs - s_speakerAudio.firstPacketUs) / 1000);
+            }
+            USER_LOG_INFO("Speaker audio start latency %d ms.", s_speakerAudio.metrics.startLatencyMs);
+        }
+        readFrames += copyFrames;
+    }
+
+    if (s_speakerAudio.isStopRequested) {
+        sink->Close();
+        s_speakerAudio.metrics.stopLatencyMs =
+            (uint32_t) ((DjiTest_SpeakerAudioGetTimeUs() - s_speakerAudio.stopRequestUs) / 1000);
+        USER_LOG_INFO("Speaker audio stop latency %d ms.", s_speakerAudio.metrics.stopLatencyMs);
+    } else {
+        sink->Drain();
+        sink->Close();
+    }
+
+    return returnCode;
+}
+
+T_DjiReturnCode DjiTest_SpeakerAudioStop(void)
+{
+    if (!s_isSpeakerAudioInited) {
+        return DJI_ERROR_SYSTEM_MODULE_CODE_NONSUPPORT_IN_CURRENT_STATE;
+    }
+
+    s_speakerAudio.stopRequestUs = DjiTest_SpeakerAudioGetTimeUs();
+    s_speakerAudio.isStopRequested = true;
+    DjiPlatform_GetOsalHandler()->SemaphorePost(s_speakerAudio.dataSema);
+
+    return DJI_ERROR_SYSTEM_MODULE_CODE_SUCCESS;
+}
+
+/**
+ * @brief Set the software volume, applied to each period before it is written to the sink.
+ * @param volume: volume in percent, 0 ~ 100.
+ * @return Execution result.
+ */
+T_DjiReturnCode DjiTest_SpeakerAudioSetVolume(uint8_t volume)
+{
+    if (!s_isSpeakerAudioInited) {
+        return DJI_ERROR_SYSTEM_MODULE_CODE_NONSUPPORT_IN_CURRENT_STATE;
+    }
+
+    volume = USER_UTIL_MIN(volume, DJI_TEST_SPEAKER_AUDIO_VOLUME_MAX);
+    s_speakerAudio.gainQ15 = (int32_t) volume * DJI_TEST_SPEAKER_AUDIO_GAIN_Q15_ONE / DJI_TEST_SPEAKER_AUDIO_VOLUME_MAX;
+
+    return DJI_ERROR_SYSTEM_MODULE_CODE_SUCCESS;
+}
+
+T_DjiReturnCode DjiTest_SpeakerAudioGetMetrics(T_DjiTestSpeakerAudioMetrics *metrics)
+{
+    T_DjiOsalHandler *osalHandler = DjiPlatform_GetOsalHandler();
+
+    if (!s_isSpeakerAudioInited || metrics == NULL) {
+        return DJI_ERROR_SYSTEM_MODULE_CODE_INVALID_PARAMETER;
+    }
+
+    osalHandler->MutexLock(s_speakerAudio.mutex);
+    *metrics = s_speakerAudio.metrics;
+    osalHandler->MutexUnlock(s_speakerAudio.mutex);
+
+    return DJI_ERROR_SYSTEM_MODULE_CODE_SUCCESS;
+}
+
+/* Private functions definition-----------------------------------------------*/
+static T_DjiReturnCode DjiTest_SpeakerAudioReserveClip(uint32_t frameCount)
+{
+    T_DjiOsalHandler *osalHandler = DjiPlatform_GetOsalHandler();
+    uint32_t maxFrames = DJI_TEST_SPEAKER_AUDIO_MS_TO_FRAMES(s_speakerAudio.config.maxClipMs);
+    uint32_t capacity = s_speakerAudio.clipCapacity > 0 ? s_speakerAudio.clipCapacity : frameCount;
+    int16_t *clipBuf;
+
+    if (frameCount <= s_speakerAudio.clipCapacity) {
+        return DJI_ERROR_SYSTEM_MODULE_CODE_SUCCESS;
+    }
+
+    if (maxFrames > 0 && frameCount > maxFrames) {
+        USER_LOG_WARN("Voice clip exceeds %d ms, drop the rest.", s_speakerAudio.config.maxClipMs);
+        return DJI_ERROR_SYSTEM_MODULE_CODE_OUT_OF_RANGE;
+    }
+
+    while (capacity < frameCount) {
+        capacity *= 2;
+    }
+    if (maxFrames > 0) {
+        capacity = USER_UTIL_MIN(capacity, maxFrames);
+    }
+
+    clipBuf = osalHandler->Malloc(capacity * DJI_TEST_SPEAKER_AUDIO_CHANNELS * sizeof(int16_t));
+    if (clipBuf == NULL) {
+        return DJI_ERROR_SYSTEM_MODULE_CODE_MEMORY_ALLOC_FAILED;
+    }
+
+    if (s_speakerAudio.clipBuf != NULL) {
+        memcpy(clipBuf, s_speakerAudio.clipBuf,
+               s_speakerAudio.clipFrames * DJI_TEST_SPEAKER_AUDIO_CHANNELS * sizeof(int16_t));
+        osalHandler->Free(s_speakerAudio.clipBuf);
+    }
+    s_speakerAudio.clipBuf = clipBuf;
+    s_speakerAudio.clipCapacity = capacity;
+
+    return DJI_ERROR_SYSTEM_MODULE_CODE_SUCCESS;
+}
+
+static void DjiTest_SpeakerAudioApplyGain(int16_t *pcm, uint32_t sampleCount, int32_t gainQ15)
+{
+    uint32_t i;
+    int32_t sample;
+
+    if (gainQ15 == DJI_TEST_SPEAKER_AUDIO_GAIN_Q15_ONE) {
+        return;
+    }
+
+    for (i = 0; i < sampleCount; i++) {
+        sample = ((int32_t) pcm[i] * gainQ15) >> 15;
+        pcm[i] = (int16_t) sample;
+    }
+}
+
+static void DjiTest_SpeakerAudioDecodePacket(const uint8_t *packet, uint16_t len)
+{
+#ifdef OPUS_INSTALLED
+    opus_int16 out[DJI_TEST_SPEAKER_AUDIO_OPUS_MAX_FRAME_SIZE * DJI_TEST_SPEAKER_AUDIO_CHANNELS];
+    uint64_t startUs;
+    uint32_t costUs;
+    int32_t frameSize;
+
+    if (s_speakerAudio.decoder == NULL) {
+        return;
+    }
+
+    startUs = DjiTest_SpeakerAudioGetTimeUs();
+    frameSize = opus_decode(s_speakerAudio.decoder, packet, len, out, DJI_TEST_SPEAKER_AUDIO_OPUS_MAX_FRAME_SIZE, 0);
+    costUs = (uint32_t) (DjiTest_SpeakerAudioGetTimeUs() - startUs);
+
+    if (frameSize < 0) {
+        USER_LOG_ERROR("decoder failed: %s", opus_strerror(frameSize));
+        s_speakerAudio.metrics.decodeErrorCount++;
+        return;
+    }
+
+    s_speakerAudio.metrics.decodedPacketCount++;
+    s_speakerAudio.decodeTimeTotalUs += costUs;
+    s_speakerAudio.metrics.decodeTimeAvgUs =
+        (uint32_t) (s_speakerAudio.decodeTimeTotalUs / s_speakerAudio.metrics.decodedPacketCount);
+    s_speakerAudio.metrics.decodeTimeMaxUs = USER_UTIL_MAX(s_speakerAudio.metrics.decodeTimeMaxUs, costUs);
+
+    DjiTest_SpeakerAudioAppendPcm(out, (uint32_t) frameSize);
+#else
+    USER_UTIL_UNUSED(packet);
+    USER_UTIL_UNUSED(len);
+#endif
+}
+
+static uint64_t DjiTest_SpeakerAudioGetTimeUs(void)
+{
+    uint64_t timeUs = 0;
+
+    DjiPlatform_GetOsalHandler()->GetTimeUs(&timeUs);
+
+    return timeUs;
+}
+
+#ifdef ALSA_INSTALLED
+static T_DjiReturnCode DjiTest_SpeakerAudioAlsaOpen(const char *name, uint32_t sampleRate, uint8_t channels)
+{
+    int32_t ret;
+
+    ret = snd_pcm_open(&s_alsaPcm, name != NULL ? name : "default", SND_PCM_STREAM_PLAYBACK, 0);
+    if (ret < 0) {
+        USER_LOG_ERROR("Open alsa device %s failed: %s", name, snd_strerror(ret));
+        s_alsaPcm = NULL;
+        return DJI_ERROR_SYSTEM_MODULE_CODE_SYSTEM_ERROR;
+    }
+
+    ret = snd_pcm_set_params(s_alsaPcm, SND_PCM_FORMAT_S16_LE, SND_PCM_ACCESS_RW_INTERLEAVED, channels, sampleRate,
+                             1, DJI_TEST_SPEAKER_AUDIO_ALSA_LATENCY_US);
+    if (ret < 0) {
+        USER_LOG_ERROR("Set alsa params failed: %s", snd_strerror(ret));
+        snd_pcm_close(s_alsaPcm);
+        s_alsaPcm = NULL;
+        return DJI_ERROR_SYSTEM_MODULE_CODE_SYSTEM_ERROR;
+    }
+
+    return DJI_ERROR_SYSTEM_MODULE_CODE_SUCCESS;
+}
+
+static T_DjiReturnCode DjiTest_SpeakerAudioAlsaWrite(const int16_t *pcm, uint32_t frameCount)
+{
+    snd_pcm_sframes_t written;
+
+    while (frameCount > 0) {
+        written = snd_pcm_writei(s_alsaPcm, pcm, frameCount);
+        if (written < 0) {
+            written = snd_pcm_recover(s_alsaPcm, (int) written, 1);
+            if (written < 0) {
+                USER_LOG_ERROR("Write alsa device failed: %s", snd_strerror((int) written));
+                return DJI_ERROR_SYSTEM_MODULE_CODE_SYSTEM_ERROR;
+            }
+            continue;
+        }
+        pcm += written * DJI_TEST_SPEAKER_AUDIO_CHANNELS;
+        frameCount -= (uint32_t) written;
+    }
+
+    return DJI_ERROR_SYSTEM_MODULE_CODE_SUCCESS;
+}
+
+static T_DjiReturnCode DjiTest_SpeakerAudioAlsaDrain(void)
+{
+    if (s_alsaPcm != NULL) {
+        snd_pcm_drain(s_alsaPcm);
+    }
+
+    return DJI_ERROR_SYSTEM_MODULE_CODE_SUCCESS;
+}
+
+static T_DjiReturnCode DjiTest_SpeakerAudioAlsaClose(void)
+{
+    if (s_alsaPcm != NULL) {
+        snd_pcm_drop(s_alsaPcm);
+        snd_pcm_close(s_alsaPcm);
+        s_alsaPcm = NULL;
+    }
+
+    return DJI_ERROR_SYSTEM_MODULE_CODE_SUCCESS;
+}
+#else
+/*
+ * ffplay reads raw pcm from a pipe. It buffers far more than one period, so writes are paced to at most
+ * DJI_TEST_SPEAKER_AUDIO_FFPLAY_LEAD_MS ahead of real time to keep stop latency and the underrun metrics
+ * close to the ones of a real device.
+ */
+static T_DjiReturnCode DjiTest_SpeakerAudioFfplayOpen(const char *name, uint32_t sampleRate, uint8_t channels)
+{
+    int pipeFd[2];
+    char rateStr[16];
+    char channelStr[8];
+    sigset_t sigSet;
+
+    USER_UTIL_UNUSED(name);
+
+    if (pipe(pipeFd) != 0) {
+        USER_LOG_ERROR("Create ffplay pipe failed, errno %d.", errno);
+        return DJI_ERROR_SYSTEM_MODULE_CODE_SYSTEM_ERROR;
+    }
+    snprintf(rateStr, sizeof(rateStr), "%u", sampleRate);
+    snprintf(channelStr, sizeof(channelStr), "%u", channels);
+
+    s_ffplayPid = fork();
+    if (s_ffplayPid < 0) {
+        USER_LOG_ERROR("Fork ffplay failed, errno %d.", errno);
+        close(pipeFd[0]);
+        close(pipeFd[1]);
+        return DJI_ERROR_SYSTEM_MODULE_CODE_SYSTEM_ERROR;
+    }
+    if (s_ffplayPid == 0) {
+        dup2(pipeFd[0], STDIN_FILENO);
+        close(pipeFd[0]);
+        close(pipeFd[1]);
+        execlp("ffplay", "ffplay", "-nodisp", "-autoexit", "-loglevel", "quiet", "-f", "s16le",
+               "-ar", rateStr, "-ac", channelStr, "-i", "pipe:0", (char *) NULL);
+        _exit(127);
+    }
+    close(pipeFd[0]);
+    s_ffplayFd = pipeFd[1];
+
+    /* A dead ffplay must fail the write with EPIPE instead of killing the application. */
+    sigemptyset(&sigSet);
+    sigaddset(&sigSet, SIGPIPE);
+    pthread_sigmask(SIG_BLOCK, &sigSet, NULL);
+
+    s_ffplaySampleRate = sampleRate;
+    s_ffplayStartUs = DjiTest_SpeakerAudioGetTimeUs();
+    s_ffplayFrames = 0;
+
+    return DJI_ERROR_SYSTEM_MODULE_CODE_SUCCESS;
+}
+
+static T_DjiReturnCode DjiTest_SpeakerAudioFfplayWrite(const int16_t *pcm, uint32_t frameCount)
+{
+    const uint8_t *data = (const uint8_t *) pcm;
+    size_t remain = (size_t) frameCount * DJI_TEST_SPEAKER_AUDIO_CHANNELS * sizeof(int16_t);
+    uint64_t aheadUs;
+    uint64_t nowUs;
+    ssize_t written;
+
+    while (remain > 0) {
+        written = write(s_ffplayFd, data, remain);
+        if (written < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            USER_LOG_ERROR("Write ffplay pipe failed, errno %d.", errno);
+            return DJI_ERROR_SYSTEM_MODULE_CODE_SYSTEM_ERROR;
+        }
+        data += written;
+        remain -= (size_t) written;
+    }
+
+    s_ffplayFrames += frameCount;
+    aheadUs = s_ffplayFrames * 1000000 / s_ffplaySampleRate;
+    nowUs = DjiTest_SpeakerAudioGetTimeUs() - s_ffplayStartUs;
+    if (aheadUs > nowUs + DJI_TEST_SPEAKER_AUDIO_FFPLAY_LEAD_MS * 1000) {
+        DjiPlatform_GetOsalHandler()->TaskSleepMs(
+            (uint32_t) ((aheadUs - nowUs) / 1000 - DJI_TEST_SPEAKER_AUDIO_FFPLAY_LEAD_MS));
+    }
+
+    return DJI_ERROR_SYSTEM_MODULE_CODE_SUCCESS;
+}
+
+static T_DjiReturnCode DjiTest_SpeakerAudioFfplayDrain(void)
+{
+    /* End of input lets ffplay play out what it has buffered and exit on its own. */
+    if (s_ffplayFd >= 0) {
+        close(s_ffplayFd);
+        s_ffplayFd = -1;
+    }
+    if (s_ffplayPid > 0) {
+        waitpid(s_ffplayPid, NULL, 0);
+        s_ffplayPid = -1;
+    }
+
+    return DJI_ERROR_SYSTEM_MODULE_CODE_SUCCESS;
+}
+
+static T_DjiReturnCode DjiTest_SpeakerAudioFfplayClose(void)
+{
+    if (s_ffplayFd >= 0) {
+        close(s_ffplayFd);
+        s_ffplayFd = -1;
+    }
+    if (s_ffplayPid > 0) {
+        kill(s_ffplayPid, SIGTERM);
+        waitpid(s_ffplayPid, NULL, 0);
+        s_ffplayPid = -1;
+    }
+
+    return DJI_ERROR_SYSTEM_MODULE_CODE_SUCCESS;
+}
+#endif
+
+static T_DjiReturnCode DjiTest_SpeakerAudioFileOpen(const char *name, uint32_t sampleRate, uint8_t channels)
+{
+    USER_UTIL_UNUSED(sampleRate);
+    USER_UTIL_UNUSED(channels);
+
+    s_fileSinkFp = fopen(name, "wb");
+    if (s_fileSinkFp == NULL) {
+        USER_LOG_ERROR("Open audio output file %s failed.", name);
+        return DJI_ERROR_SYSTEM_MODULE_CODE_SYSTEM_ERROR;
+    }
+
+    return DJI_ERROR_SYSTEM_MODULE_CODE_SUCCESS;
+}
+
+static T_DjiReturnCode DjiTest_SpeakerAudioFileWrite(const int16_t *pcm, uint32_t frameCount)
+{
+    if (fwrite(pcm, sizeof(int16_t) * DJI_TEST_SPEAKER_AUDIO_CHANNELS, frameCount, s_fileSinkFp) != frameCount) {
+        return DJI_ERROR_SYSTEM_MODULE_CODE_SYSTEM_ERROR;
+    }
+
+    return DJI_ERROR_SYSTEM_MODULE_CODE_SUCCESS;
+}
+
+static T_DjiReturnCode DjiTest_SpeakerAudioFileDrain(void)
+{
+    if (s_fileSinkFp != NULL) {
+        fflush(s_fileSinkFp);
+    }
+
+    return DJI_ERROR_SYSTEM_MODULE_CODE_SUCCESS;
+}
+
+static T_DjiReturnCode DjiTest_SpeakerAudioFileClose(void)
+{
+    if (s_fileSinkFp != NULL) {
+        fclose(s_fileSinkFp);
+        s_fileSinkFp = NULL;
+    }
+
+    return DJI_ERROR_SYSTEM_MODULE_CODE_SUCCESS;
+}
+
+static T_DjiReturnCode DjiTest_SpeakerAudioNullOpen(const char *name, uint32_t sampleRate, uint8_t channels)
+{
+    USER_UTIL_UNUSED(name);
+    USER_UTIL_UNUSED(sampleRate);
+    USER_UTIL_UNUSED(channels);
+
+    return DJI_ERROR_SYSTEM_MODULE_CODE_SUCCESS;
+}
+
+static T_DjiReturnCode DjiTest_SpeakerAudioNullWrite(const int16_t *pcm, uint32_t frameCount)
+{
+    USER_UTIL_UNUSED(pcm);
+
+    return DjiPlatform_GetOsalHandler()->TaskSleepMs(frameCount * 1000 / DJI_TEST_SPEAKER_AUDIO_SAMPLE_RATE);
+}
+
+static T_DjiReturnCode DjiTest_SpeakerAudioNullDrain(void)
+{
+    return DJI_ERROR_SYSTEM_MODULE_CODE_SUCCESS;
+}
+
+static T_DjiReturnCode DjiTest_SpeakerAudioNullClose(void)
+{
+    return DJI_ERROR_SYSTEM_MODULE_CODE_SUCCESS;
+}
+
+#endif
+
+/****************** (C) COPYRIGHT DJI Innovations *****END OF FILE****/
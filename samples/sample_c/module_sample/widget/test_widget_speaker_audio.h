@@ -0,0 +1,111 @@
+/**
+ ********************************************************************
+ * @file    test_widget_speaker_audio.h
+ * @brief   This is the header file for "test_widget_speaker_audio.c", defining the structure and
+ * (exported) function prototypes.
+ *
+ * @copyright (c) 2021 DJI. All rights reserved.
+ *
+ * All information contained herein is, and remains, the property of DJI.
+ * The intellectual and technical concepts contained herein are proprietary
+ * to DJI and may be covered by U.S. and foreign patents, patents in process,
+ * and protected by trade secret or copyright law.  Dissemination of this
+ * information, including but not limited to data and other proprietary
+ * material(s) incorporated within the information, in any form, is strictly
+ * prohibited without the express written consent of DJI.
+ *
+ * If you receive this source code without DJI’s authorization, you may not
+ * further disseminate the information, and you must immediately remove the
+ * source code and notify DJI of its removal. DJI reserves the right to pursue
+ * legal actions against you for any loss(es) or damage(s) caused by your
+ * failure to do so.
+ *
+ *********************************************************************
+ */
+
+/* Define to prevent recursive inclusion -------------------------------------*/
+#ifndef TEST_WIDGET_SPEAKER_AUDIO_H
+#define TEST_WIDGET_SPEAKER_AUDIO_H
+
+/* Includes ------------------------------------------------------------------*/
+#include "dji_typedef.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#ifdef SYSTEM_ARCH_LINUX
+
+/* Exported constants --------------------------------------------------------*/
+#define DJI_TEST_SPEAKER_AUDIO_SAMPLE_RATE          (16000)
+#define DJI_TEST_SPEAKER_AUDIO_CHANNELS             (1)
+
+/* Exported types ------------------------------------------------------------*/
+/**
+ * @brief The alsa sink is played through an ffplay pipe when alsa is not found at build time, and through
+ * the null sink when ffplay is not installed either.
+ */
+typedef enum {
+    DJI_TEST_SPEAKER_AUDIO_SINK_ALSA = 0,
+    DJI_TEST_SPEAKER_AUDIO_SINK_FILE = 1,
+    DJI_TEST_SPEAKER_AUDIO_SINK_NULL = 2,
+} E_DjiTestSpeakerAudioSinkType;
+
+/**
+ * @brief Output device of the audio engine. Write() is expected to block at the device rate, the file sink
+ * does not block and the null sink sleeps to emulate a device clock.
+ */
+typedef struct {
+    T_DjiReturnCode (*Open)(const char *name, uint32_t sampleRate, uint8_t channels);
+    T_DjiReturnCode (*Write)(const int16_t *pcm, uint32_t frameCount);
+    T_DjiReturnCode (*Drain)(void);
+    T_DjiReturnCode (*Close)(void);
+} T_DjiTestSpeakerAudioSink;
+
+typedef struct {
+    E_DjiTestSpeakerAudioSinkType sinkType;
+    /*! ALSA device name or output file path, depends on sink type. */
+    const char *sinkName;
+    /*! Decoded audio buffered before playback starts, absorbs jitter of the incoming stream. */
+    uint32_t prebufferMs;
+    /*! Audio written to the sink per write call. */
+    uint32_t periodMs;
+    /*! Upper bound of one decoded clip kept in memory. */
+    uint32_t maxClipMs;
+} T_DjiTestSpeakerAudioConfig;
+
+typedef struct {
+    uint32_t startLatencyMs;
+    uint32_t stopLatencyMs;
+    uint32_t firstPacketToAudioMs;
+    uint32_t underrunCount;
+    uint32_t decodedPacketCount;
+    uint32_t decodeErrorCount;
+    uint32_t decodeTimeAvgUs;
+    uint32_t decodeTimeMaxUs;
+    uint32_t clipMs;
+} T_DjiTestSpeakerAudioMetrics;
+
+/* Exported functions --------------------------------------------------------*/
+T_DjiReturnCode DjiTest_SpeakerAudioInit(const T_DjiTestSpeakerAudioConfig *config);
+T_DjiReturnCode DjiTest_SpeakerAudioDeInit(void);
+
+T_DjiReturnCode DjiTest_SpeakerAudioBeginStream(uint32_t decodeBitrate);
+T_DjiReturnCode DjiTest_SpeakerAudioFeedOpus(uint32_t offset, const uint8_t *data, uint16_t len);
+T_DjiReturnCode DjiTest_SpeakerAudioAppendPcm(const int16_t *pcm, uint32_t frameCount);
+T_DjiReturnCode DjiTest_SpeakerAudioEndStream(const uint8_t *md5Sum, uint16_t md5Size);
+
+T_DjiReturnCode DjiTest_SpeakerAudioRequestPlay(void);
+T_DjiReturnCode DjiTest_SpeakerAudioPlay(void);
+T_DjiReturnCode DjiTest_SpeakerAudioStop(void);
+T_DjiReturnCode DjiTest_SpeakerAudioSetVolume(uint8_t volume);
+T_DjiReturnCode DjiTest_SpeakerAudioGetMetrics(T_DjiTestSpeakerAudioMetrics *metrics);
+
+#endif
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // TEST_WIDGET_SPEAKER_AUDIO_H
+/************************ (C) COPYRIGHT DJI Innovations *******END OF FILE******/
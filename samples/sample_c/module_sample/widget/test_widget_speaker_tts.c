@@ -0,0 +1,846 @@
+/**
+ ********************************************************************
+ * @file    test_widget_speaker_tts.c
+ * @brief   Text to speech pipeline of the widget speaker sample. Text is split into sentences which are
+ *          synthesized one by one by a pluggable backend and streamed to the speaker audio engine, so playback
+ *          starts after the first sentence. Synthesized sentences are kept in a content hashed cache.
+ *
+ * @copyright (c) 2021 DJI. All rights reserved.
+ *
+ * All information contained herein is, and remains, the property of DJI.
+ * The intellectual and technical concepts contained herein are proprietary
+ * to DJI and may be covered by U.S. and foreign patents, patents in process,
+ * and protected by trade secret or copyright law.  Dissemination of this
+ * information, including but not limited to data and other proprietary
+ * material(s) incorporated within the information, in any form, is strictly
+ * prohibited without the express written consent of DJI.
+ *
+ * If you receive this source code without DJI’s authorization, you may not
+ * further disseminate the information, and you must immediately remove the
+ * source code and notify DJI of its removal. DJI reserves the right to pursue
+ * legal actions against you for any loss(es) or damage(s) caused by your
+ * failure to do so.
+ *
+ *********************************************************************
+ */
+
+/* Includes ------------------------------------------------------------------*/
+#include "test_widget_speaker_tts.h"
+
+#ifdef SYSTEM_ARCH_LINUX
+
+#include <stdio.h>
+#include <string.h>
+#include <ctype.h>
+#include "dji_platform.h"
+#include "dji_logger.h"
+#include "utils/util_misc.h"
+#include "test_widget_speaker_audio.h"
+
+/* Private constants ---------------------------------------------------------*/
+#define DJI_TEST_SPEAKER_TTS_TASK_STACK_SIZE            (2048)
+#define DJI_TEST_SPEAKER_TTS_SENTENCE_MAX_SIZE          (512)
+#define DJI_TEST_SPEAKER_TTS_CACHE_ENTRY_MAX            (64)
+#define DJI_TEST_SPEAKER_TTS_WAIT_INTERVAL_MS           (100)
+
+#define DJI_TEST_SPEAKER_TTS_EKHO_INPUT_FILE_NAME       "tts_sentence.txt"
+#define DJI_TEST_SPEAKER_TTS_EKHO_OUTPUT_FILE_NAME      "tts_audio.wav"
+#define DJI_TEST_SPEAKER_TTS_EKHO_CMD_MAX_SIZE          (256)
+
+#define DJI_TEST_SPEAKER_TTS_TONE_CHAR_MS               (80)
+#define DJI_TEST_SPEAKER_TTS_TONE_GAP_MS                (20)
+#define DJI_TEST_SPEAKER_TTS_TONE_SPACE_MS              (40)
+#define DJI_TEST_SPEAKER_TTS_TONE_AMPLITUDE             (6000)
+
+#define DJI_TEST_SPEAKER_TTS_FNV_OFFSET_BASIS           (0xCBF29CE484222325ULL)
+#define DJI_TEST_SPEAKER_TTS_FNV_PRIME                  (0x100000001B3ULL)
+
+#define DJI_TEST_SPEAKER_TTS_MS_TO_FRAMES(ms)           ((uint32_t) ((uint64_t) (ms) * \
+                                                         DJI_TEST_SPEAKER_AUDIO_SAMPLE_RATE / 1000))
+
+/* Private types -------------------------------------------------------------*/
+typedef struct {
+    uint64_t key;
+    char *text;
+    int16_t *pcm;
+    uint32_t frameCount;
+    uint32_t lastUsedTick;
+    bool isUsed;
+} T_DjiTestSpeakerTtsCacheEntry;
+
+typedef struct {
+    const T_DjiTestSpeakerTtsBackend *backend;
+    T_DjiMutexHandle mutex;
+    T_DjiSemaHandle jobSema;
+    T_DjiSemaHandle eventSema;
+    T_DjiTaskHandle task;
+    char text[DJI_TEST_SPEAKER_TTS_TEXT_MAX_SIZE];
+    volatile bool isJobRunning;
+    volatile bool isFirstAudioReady;
+    volatile bool isCancelRequested;
+    uint32_t speakStartMs;
+    T_DjiTestSpeakerTtsCacheEntry cache[DJI_TEST_SPEAKER_TTS_CACHE_ENTRY_MAX];
+    uint32_t cacheMaxBytes;
+    uint32_t cacheTick;
+    uint64_t synthesisTimeTotalMs;
+    T_DjiTestSpeakerTtsMetrics metrics;
+} T_DjiTestSpeakerTtsContext;
+
+/* Private functions declaration ---------------------------------------------*/
+static void *DjiTest_SpeakerTtsTask(void *arg);
+static void DjiTest_SpeakerTtsProcessText(const char *text);
+static void DjiTest_SpeakerTtsSpeakSentence(const char *sentence);
+static const char *DjiTest_SpeakerTtsNextSentence(const char *text, char *sentence, uint32_t size);
+static uint8_t DjiTest_SpeakerTtsGetUtf8CharLen(const char *text);
+static bool DjiTest_SpeakerTtsIsTerminator(const char *ch, uint8_t charLen, const char *next);
+static uint64_t DjiTest_SpeakerTtsHash(const char *backendName, const char *sentence);
+static T_DjiTestSpeakerTtsCacheEntry *DjiTest_SpeakerTtsCacheFind(uint64_t key, const char *sentence);
+static T_DjiTestSpeakerTtsCacheEntry *DjiTest_SpeakerTtsCacheInsert(uint64_t key, const char *sentence,
+                                                                    int16_t *pcm, uint32_t frameCount);
+static void DjiTest_SpeakerTtsCacheEvict(T_DjiTestSpeakerTtsCacheEntry *entry);
+static uint32_t DjiTest_SpeakerTtsCacheEntryBytes(const char *sentence, uint32_t frameCount);
+static uint32_t DjiTest_SpeakerTtsGetTimeMs(void);
+static T_DjiReturnCode DjiTest_SpeakerTtsEkhoSynthesize(const char *sentence, int16_t **pcm, uint32_t *frameCount);
+static T_DjiReturnCode DjiTest_SpeakerTtsToneSynthesize(const char *sentence, int16_t **pcm, uint32_t *frameCount);
+static T_DjiReturnCode DjiTest_SpeakerTtsReadWav(const char *path, int16_t **pcm, uint32_t *frameCount);
+
+/* Private values -------------------------------------------------------------*/
+static T_DjiTestSpeakerTtsContext s_speakerTts = {0};
+static bool s_isSpeakerTtsInited = false;
+
+static const T_DjiTestSpeakerTtsBackend s_ekhoBackend = {
+    "ekho",
+    DjiTest_SpeakerTtsEkhoSynthesize,
+};
+
+static const T_DjiTestSpeakerTtsBackend s_toneBackend = {
+    "tone",
+    DjiTest_SpeakerTtsToneSynthesize,
+};
+
+/* Exported functions definition ---------------------------------------------*/
+/**
+ * @brief Backend running the ekho command line tool for each sentence, example used ekho v7.5.
+ * @return Pointer to the backend.
+ */
+const T_DjiTestSpeakerTtsBackend *DjiTest_SpeakerTtsGetEkhoBackend(void)
+{
+    return &s_ekhoBackend;
+}
+
+/**
+ * @brief Backend generating a short tone for each character, used when no speech synthesizer is installed.
+ * @return Pointer to the backend.
+ */
+const T_DjiTestSpeakerTtsBackend *DjiTest_SpeakerTtsGetToneBackend(void)
+{
+    return &s_toneBackend;
+}
+
+/**
+ * @brief Init the tts pipeline. The speaker audio engine must be initialized before.
+ * @param backend: speech synthesizer backend.
+ * @param cacheMaxBytes: memory limit of the synthesized sentence cache, 0 to disable the cache.
+ * @return Execution result.
+ */
+T_DjiReturnCode DjiTest_SpeakerTtsInit(const T_DjiTestSpeakerTtsBackend *backend, uint32_t cacheMaxBytes)
+{
+    T_DjiReturnCode returnCode;
+    T_DjiOsalHandler *osalHandler = DjiPlatform_GetOsalHandler();
+
+    if (backend == NULL || backend->Synthesize == NULL) {
+        return DJI_ERROR_SYSTEM_MODULE_CODE_INVALID_PARAMETER;
+    }
+
+    if (s_isSpeakerTtsInited) {
+        return DJI_ERROR_SYSTEM_MODULE_CODE_SUCCESS;
+    }
+
+    memset(&s_speakerTts, 0, sizeof(s_speakerTts));
+    s_speakerTts.backend = backend;
+    s_speakerTts.cacheMaxBytes = cacheMaxBytes;
+
+    returnCode = osalHandler->MutexCreate(&s_speakerTts.mutex);
+    if (returnCode != DJI_ERROR_SYSTEM_MODULE_CODE_SUCCESS) {
+        USER_LOG_ERROR("Create speaker tts mutex error: 0x%08llX", returnCode);
+        return returnCode;
+    }
+
+    returnCode = osalHandler->SemaphoreCreate(0, &s_speakerTts.jobSema);
+    if (returnCode != DJI_ERROR_SYSTEM_MODULE_CODE_SUCCESS) {
+        USER_LOG_ERROR("Create speaker tts semaphore error: 0x%08llX", returnCode);
+        goto destroy_mutex;
+    }
+
+    returnCode = osalHandler->SemaphoreCreate(0, &s_speakerTts.eventSema);
+    if (returnCode != DJI_ERROR_SYSTEM_MODULE_CODE_SUCCESS) {
+        USER_LOG_ERROR("Create speaker tts semaphore error: 0x%08llX", returnCode);
+        goto destroy_job_sema;
+    }
+
+    returnCode = osalHandler->TaskCreate("user_speaker_tts_task", DjiTest_SpeakerTtsTask,
+                                         DJI_TEST_SPEAKER_TTS_TASK_STACK_SIZE, NULL, &s_speakerTts.task);
+    if (returnCode != DJI_ERROR_SYSTEM_MODULE_CODE_SUCCESS) {
+        USER_LOG_ERROR("Create speaker tts task error: 0x%08llX", returnCode);
+        goto destroy_event_sema;
+    }
+
+    USER_LOG_INFO("Speaker tts backend: %s, cache limit: %d bytes.", backend->name, cacheMaxBytes);
+    s_isSpeakerTtsInited = true;
+
+    return DJI_ERROR_SYSTEM_MODULE_CODE_SUCCESS;
+
+destroy_event_sema:
+    osalHandler->SemaphoreDestroy(s_speakerTts.eventSema);
+destroy_job_sema:
+    osalHandler->SemaphoreDestroy(s_speakerTts.jobSema);
+destroy_mutex:
+    osalHandler->MutexDestroy(s_speakerTts.mutex);
+
+    return returnCode;
+}
+
+T_DjiReturnCode DjiTest_SpeakerTtsDeInit(void)
+{
+    T_DjiOsalHandler *osalHandler = DjiPlatform_GetOsalHandler();
+    uint32_t i;
+
+    if (!s_isSpeakerTtsInited) {
+        return DJI_ERROR_SYSTEM_MODULE_CODE_SUCCESS;
+    }
+
+    DjiTest_SpeakerTtsCancel();
+    DjiTest_SpeakerTtsWaitSpeakFinished();
+    osalHandler->TaskDestroy(s_speakerTts.task);
+
+    for (i = 0; i < DJI_TEST_SPEAKER_TTS_CACHE_ENTRY_MAX; i++) {
+        if (s_speakerTts.cache[i].isUsed) {
+            DjiTest_SpeakerTtsCacheEvict(&s_speakerTts.cache[i]);
+        }
+    }
+
+    osalHandler->SemaphoreDestroy(s_speakerTts.eventSema);
+    osalHandler->SemaphoreDestroy(s_speakerTts.jobSema);
+    osalHandler->MutexDestroy(s_speakerTts.mutex);
+    s_isSpeakerTtsInited = false;
+
+    return DJI_ERROR_SYSTEM_MODULE_CODE_SUCCESS;
+}
+
+/**
+ * @brief Start speaking the text on the speaker audio engine. Returns once the first sentence is ready to be
+ * played, the rest of the text is synthesized while the audio engine plays.
+ * @param text: UTF-8 text to speak.
+ * @return Execution result.
+ */
+T_DjiReturnCode DjiTest_SpeakerTtsStartSpeak(const char *text)
+{
+    T_DjiReturnCode returnCode;
+    T_DjiOsalHandler *osalHandler = DjiPlatform_GetOsalHandler();
+
+    if (!s_isSpeakerTtsInited) {
+        return DJI_ERROR_SYSTEM_MODULE_CODE_NONSUPPORT_IN_CURRENT_STATE;
+    }
+
+    if (text == NULL) {
+        return DJI_ERROR_SYSTEM_MODULE_CODE_INVALID_PARAMETER;
+    }
+
+    DjiTest_SpeakerTtsWaitSpeakFinished();
+
+    returnCode = DjiTest_SpeakerAudioBeginStream(0);
+    if (returnCode != DJI_ERROR_SYSTEM_MODULE_CODE_SUCCESS) {
+        USER_LOG_ERROR("Begin tts audio stream error: 0x%08llX", returnCode);
+        return returnCode;
+    }
+
+    strncpy(s_speakerTts.text, text, sizeof(s_speakerTts.text) - 1);
+    s_speakerTts.text[sizeof(s_speakerTts.text) - 1] = '\0';
+    s_speakerTts.isCancelRequested = false;
+    s_speakerTts.isFirstAudioReady = false;
+    s_speakerTts.isJobRunning = true;
+    s_speakerTts.speakStartMs = DjiTest_SpeakerTtsGetTimeMs();
+
+    osalHandler->MutexLock(s_speakerTts.mutex);
+    s_speakerTts.metrics.requestCount++;
+    osalHandler->MutexUnlock(s_speakerTts.mutex);
+
+    osalHandler->SemaphorePost(s_speakerTts.jobSema);
+
+    while (s_speakerTts.isJobRunning && !s_speakerTts.isFirstAudioReady) {
+        osalHandler->SemaphoreTimedWait(s_speakerTts.eventSema, DJI_TEST_SPEAKER_TTS_WAIT_INTERVAL_MS);
+    }
+
+    if (s_speakerTts.isCancelRequested) {
+        return DJI_ERROR_SYSTEM_MODULE_CODE_NONSUPPORT_IN_CURRENT_STATE;
+    }
+
+    if (!s_speakerTts.isFirstAudioReady) {
+        USER_LOG_ERROR("No speech synthesized for the tts text.");
+        return DJI_ERROR_SYSTEM_MODULE_CODE_SYSTEM_ERROR;
+    }
+
+    return DJI_ERROR_SYSTEM_MODULE_CODE_SUCCESS;
+}
+
+T_DjiReturnCode DjiTest_SpeakerTtsWaitSpeakFinished(void)
+{
+    T_DjiOsalHandler *osalHandler = DjiPlatform_GetOsalHandler();
+
+    if (!s_isSpeakerTtsInited) {
+        return DJI_ERROR_SYSTEM_MODULE_CODE_NONSUPPORT_IN_CURRENT_STATE;
+    }
+
+    while (s_speakerTts.isJobRunning) {
+        osalHandler->SemaphoreTimedWait(s_speakerTts.eventSema, DJI_TEST_SPEAKER_TTS_WAIT_INTERVAL_MS);
+    }
+
+    return DJI_ERROR_SYSTEM_MODULE_CODE_SUCCESS;
+}
+
+/**
+ * @brief Stop synthesizing the remaining sentences, the sentence being synthesized is completed.
+ * @return Execution result.
+ */
+T_DjiReturnCode DjiTest_SpeakerTtsCancel(void)
+{
+    if (!s_isSpeakerTtsInited) {
+        return DJI_ERROR_SYSTEM_MODULE_CODE_NONSUPPORT_IN_CURRENT_STATE;
+    }
+
+    s_speakerTts.isCancelRequested = true;
+
+    return DJI_ERROR_SYSTEM_MODULE_CODE_SUCCESS;
+}
+
+T_DjiReturnCode DjiTest_SpeakerTtsGetMetrics(T_DjiTestSpeakerTtsMetrics *metrics)
+{
+    T_DjiOsalHandler *osalHandler = DjiPlatform_GetOsalHandler();
+
+    if (!s_isSpeakerTtsInited || metrics == NULL) {
+        return DJI_ERROR_SYSTEM_MODULE_CODE_INVALID_PARAMETER;
+    }
+
+    osalHandler->MutexLock(s_speakerTts.mutex);
+    *metrics = s_speakerTts.metrics;
+    osalHandler->MutexUnlock(s_speakerTts.mutex);
+
+    return DJI_ERROR_SYSTEM_MODULE_CODE_SUCCESS;
+}
+
+/* Private functions definition-----------------------------------------------*/
+#ifndef __CC_ARM
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wmissing-noreturn"
+#pragma GCC diagnostic ignored "-Wreturn-type"
+#endif
+
+static void *DjiTest_SpeakerTtsTask(void *arg)
+{
+    T_DjiOsalHandler *osalHandler = DjiPlatform_GetOsalHandler();
+
+    USER_UTIL_UNUSED(arg);
+
+    while (1) {
+        if (osalHandler->SemaphoreWait(s_speakerTts.jobSema) != DJI_ERROR_SYSTEM_MODULE_CODE_SUCCESS) {
+            continue;
+        }
+
+        DjiTest_SpeakerTtsProcessText(s_speakerTts.text);
+        DjiTest_SpeakerAudioEndStream(NULL, 0);
+
+        s_speakerTts.isJobRunning = false;
+        osalHandler->SemaphorePost(s_speakerTts.eventSema);
+    }
+}
+
+#ifndef __CC_ARM
+#pragma GCC diagnostic pop
+#endif
+
+static void DjiTest_SpeakerTtsProcessText(const char *text)
+{
+    char sentence[DJI_TEST_SPEAKER_TTS_SENTENCE_MAX_SIZE];
+
+    while (!s_speakerTts.isCancelRequested) {
+        text = DjiTest_SpeakerTtsNextSentence(text, sentence, sizeof(sentence));
+        if (text == NULL) {
+            break;
+        }
+
+        DjiTest_SpeakerTtsSpeakSentence(sentence);
+    }
+}
+
+static void DjiTest_SpeakerTtsSpeakSentence(const char *sentence)
+{
+    T_DjiReturnCode returnCode;
+    T_DjiOsalHandler *osalHandler = DjiPlatform_GetOsalHandler();
+    T_DjiTestSpeakerTtsCacheEntry *entry;
+    uint64_t key = DjiTest_SpeakerTtsHash(s_speakerTts.backend->name, sentence);
+    int16_t *pcm = NULL;
+    uint32_t frameCount = 0;
+    uint32_t startMs;
+    uint32_t costMs;
+
+    entry = DjiTest_SpeakerTtsCacheFind(key, sentence);
+
+    osalHandler->MutexLock(s_speakerTts.mutex);
+    s_speakerTts.metrics.sentenceCount++;
+    if (entry != NULL) {
+        s_speakerTts.metrics.cacheHitCount++;
+    } else {
+        s_speakerTts.metrics.cacheMissCount++;
+    }
+    osalHandler->MutexUnlock(s_speakerTts.mutex);
+
+    if (entry != NULL) {
+        USER_LOG_DEBUG("Tts cache hit: %s", sentence);
+        entry->lastUsedTick = ++s_speakerTts.cacheTick;
+        pcm = entry->pcm;
+        frameCount = entry->frameCount;
+    } else {
+        startMs = DjiTest_SpeakerTtsGetTimeMs();
+        returnCode = s_speakerTts.backend->Synthesize(sentence, &pcm, &frameCount);
+        costMs = DjiTest_SpeakerTtsGetTimeMs() - startMs;
+        if (returnCode != DJI_ERROR_SYSTEM_MODULE_CODE_SUCCESS) {
+            USER_LOG_ERROR("Synthesize sentence failed, error: 0x%08llX, sentence: %s", returnCode, sentence);
+            return;
+        }
+        USER_LOG_DEBUG("Tts synthesized in %d ms: %s", costMs, sentence);
+
+        entry = DjiTest_SpeakerTtsCacheInsert(key, sentence, pcm, frameCount);
+
+        osalHandler->MutexLock(s_speakerTts.mutex);
+        s_speakerTts.synthesisTimeTotalMs += costMs;
+        s_speakerTts.metrics.synthesisTimeAvgMs =
+            (uint32_t) (s_speakerTts.synthesisTimeTotalMs / s_speakerTts.metrics.cacheMissCount);
+        s_speakerTts.metrics.synthesisTimeMaxMs = USER_UTIL_MAX(s_speakerTts.metrics.synthesisTimeMaxMs, costMs);
+        osalHandler->MutexUnlock(s_speakerTts.mutex);
+    }
+
+    if (frameCount > 0) {
+        returnCode = DjiTest_SpeakerAudioAppendPcm(pcm, frameCount);
+        if (returnCode != DJI_ERROR_SYSTEM_MODULE_CODE_SUCCESS) {
+            USER_LOG_ERROR("Append tts audio failed, error: 0x%08llX", returnCode);
+        }
+    }
+
+    if (entry == NULL) {
+        osalHandler->Free(pcm);
+    }
+
+    if (!s_speakerTts.isFirstAudioReady) {
+        osalHandler->MutexLock(s_speakerTts.mutex);
+        s_speakerTts.metrics.firstAudioLatencyMs = DjiTest_SpeakerTtsGetTimeMs() - s_speakerTts.speakStartMs;
+        osalHandler->MutexUnlock(s_speakerTts.mutex);
+
+        s_speakerTts.isFirstAudioReady = true;
+        osalHandler->SemaphorePost(s_speakerTts.eventSema);
+    }
+}
+
+/**
+ * @brief Copy the next sentence of the text. Runs of white space are collapsed to one space so that the same
+ * phrase hits the same cache entry, sentences longer than the buffer are cut at a character boundary.
+ * @return Pointer to the rest of the text, NULL when there is no more sentence.
+ */
+static const char *DjiTest_SpeakerTtsNextSentence(const char *text, char *sentence, uint32_t size)
+{
+    uint32_t len = 0;
+    uint8_t charLen;
+    bool isSpacePending = false;
+
+    while (*text != '\0' && isspace((unsigned char) *text)) {
+        text++;
+    }
+
+    if (*text == '\0') {
+        return NULL;
+    }
+
+    while (*text != '\0') {
+        if (*text == '\n' || *text == '\r') {
+            text++;
+            break;
+        }
+
+        if (isspace((unsigned char) *text)) {
+            isSpacePending = true;
+            text++;
+            continue;
+        }
+
+        charLen = DjiTest_SpeakerTtsGetUtf8CharLen(text);
+        if (len + charLen + (isSpacePending ? 1 : 0) >= size) {
+            break;
+        }
+
+        if (isSpacePending) {
+            sentence[len++] = ' ';
+            isSpacePending = false;
+        }
+
+        memcpy(&sentence[len], text, charLen);
+        len += charLen;
+        text += charLen;
+
+        if (DjiTest_SpeakerTtsIsTerminator(text - charLen, charLen, text)) {
+            break;
+        }
+    }
+
+    sentence[len] = '\0';
+
+    return text;
+}
+
+static uint8_t DjiTest_SpeakerTtsGetUtf8CharLen(const char *text)
+{
+    uint8_t lead = (uint8_t) text[0];
+    uint8_t charLen = 1;
+    uint8_t i;
+
+    if ((lead & 0xE0) == 0xC0) {
+        charLen = 2;
+    } else if ((lead & 0xF0) == 0xE0) {
+        charLen = 3;
+    } else if ((lead & 0xF8) == 0xF0) {
+        charLen = 4;
+    }
+
+    for (i = 1; i < charLen; i++) {
+        if (text[i] == '\0') {
+            return i;
+        }
+    }
+
+    return charLen;
+}
+
+static bool DjiTest_SpeakerTtsIsTerminator(const char *ch, uint8_t charLen, const char *next)
+{
+    /* Full width 。！？； */
+    static const char *s_cjkTerminators[] = {"\xE3\x80\x82", "\xEF\xBC\x81", "\xEF\xBC\x9F", "\xEF\xBC\x9B"};
+    uint32_t i;
+
+    if (charLen == 1) {
+        if (*ch == '!' || *ch == '?' || *ch == ';') {
+            return true;
+        }
+
+        /* Do not split numbers and abbreviations such as "3.5" */
+        return *ch == '.' && (*next == '\0' || isspace((unsigned char) *next));
+    }
+
+    if (charLen == 3) {
+        for (i = 0; i < UTIL_ARRAY_SIZE(s_cjkTerminators); i++) {
+            if (memcmp(ch, s_cjkTerminators[i], 3) == 0) {
+                return true;
+            }
+        }
+    }
+
+    return false;
+}
+
+static uint64_t DjiTest_SpeakerTtsHash(const char *backendName, const char *sentence)
+{
+    uint64_t hash = DJI_TEST_SPEAKER_TTS_FNV_OFFSET_BASIS;
+    const uint8_t *p;
+
+    for (p = (const uint8_t *) backendName; *p != '\0'; p++) {
+        hash = (hash ^ *p) * DJI_TEST_SPEAKER_TTS_FNV_PRIME;
+    }
+
+    hash = hash * DJI_TEST_SPEAKER_TTS_FNV_PRIME;
+
+    for (p = (const uint8_t *) sentence; *p != '\0'; p++) {
+        hash = (hash ^ *p) * DJI_TEST_SPEAKER_TTS_FNV_PRIME;
+    }
+
+    return hash;
+}
+
+static T_DjiTestSpeakerTtsCacheEntry *DjiTest_SpeakerTtsCacheFind(uint64_t key, const char *sentence)
+{
+    uint32_t i;
+
+    for (i = 0; i < DJI_TEST_SPEAKER_TTS_CACHE_ENTRY_MAX; i++) {
+        if (s_speakerTts.cache[i].isUsed && s_speakerTts.cache[i].key == key &&
+            strcmp(s_speakerTts.cache[i].text, sentence) == 0) {
+            return &s_speakerTts.cache[i];
+        }
+    }
+
+    return NULL;
+}
+
+/**
+ * @brief Insert a synthesized sentence, least recently used entries are evicted to stay in the memory limit.
+ * @return The entry which owns the pcm buffer, NULL if the sentence is not cached and the caller keeps it.
+ */
+static T_DjiTestSpeakerTtsCacheEntry *DjiTest_SpeakerTtsCacheInsert(uint64_t key, const char *sentence,
+                                                                    int16_t *pcm, uint32_t frameCount)
+{
+    T_DjiOsalHandler *osalHandler = DjiPlatform_GetOsalHandler();
+    T_DjiTestSpeakerTtsCacheEntry *entry;
+    T_DjiTestSpeakerTtsCacheEntry *freeEntry;
+    T_DjiTestSpeakerTtsCacheEntry *oldestEntry;
+    uint32_t entryBytes = DjiTest_SpeakerTtsCacheEntryBytes(sentence, frameCount);
+    uint32_t i;
+
+    if (entryBytes > s_speakerTts.cacheMaxBytes) {
+        return NULL;
+    }
+
+    while (1) {
+        freeEntry = NULL;
+        oldestEntry = NULL;
+        for (i = 0; i < DJI_TEST_SPEAKER_TTS_CACHE_ENTRY_MAX; i++) {
+            entry = &s_speakerTts.cache[i];
+            if (!entry->isUsed) {
+                if (freeEntry == NULL) {
+                    freeEntry = entry;
+                }
+            } else if (oldestEntry == NULL || entry->lastUsedTick < oldestEntry->lastUsedTick) {
+                oldestEntry = entry;
+            }
+        }
+
+        if (freeEntry != NULL && s_speakerTts.metrics.cacheBytes + entryBytes <= s_speakerTts.cacheMaxBytes) {
+            break;
+        }
+
+        DjiTest_SpeakerTtsCacheEvict(oldestEntry);
+    }
+
+    freeEntry->text = osalHandler->Malloc(strlen(sentence) + 1);
+    if (freeEntry->text == NULL) {
+        return NULL;
+    }
+    strcpy(freeEntry->text, sentence);
+    freeEntry->key = key;
+    freeEntry->pcm = pcm;
+    freeEntry->frameCount = frameCount;
+    freeEntry->lastUsedTick = ++s_speakerTts.cacheTick;
+    freeEntry->isUsed = true;
+
+    osalHandler->MutexLock(s_speakerTts.mutex);
+    s_speakerTts.metrics.cacheEntryCount++;
+    s_speakerTts.metrics.cacheBytes += entryBytes;
+    osalHandler->MutexUnlock(s_speakerTts.mutex);
+
+    return freeEntry;
+}
+
+static void DjiTest_SpeakerTtsCacheEvict(T_DjiTestSpeakerTtsCacheEntry *entry)
+{
+    T_DjiOsalHandler *osalHandler = DjiPlatform_GetOsalHandler();
+
+    osalHandler->MutexLock(s_speakerTts.mutex);
+    s_speakerTts.metrics.cacheEntryCount--;
+    s_speakerTts.metrics.cacheBytes -= DjiTest_SpeakerTtsCacheEntryBytes(entry->text, entry->frameCount);
+    osalHandler->MutexUnlock(s_speakerTts.mutex);
+
+    osalHandler->Free(entry->text);
+    osalHandler->Free(entry->pcm);
+    memset(entry, 0, sizeof(T_DjiTestSpeakerTtsCacheEntry));
+}
+
+static uint32_t DjiTest_SpeakerTtsCacheEntryBytes(const char *sentence, uint32_t frameCount)
+{
+    return (uint32_t) (strlen(sentence) + 1) + frameCount * DJI_TEST_SPEAKER_AUDIO_CHANNELS * sizeof(int16_t);
+}
+
+static uint32_t DjiTest_SpeakerTtsGetTimeMs(void)
+{
+    uint32_t timeMs = 0;
+
+    DjiPlatform_GetOsalHandler()->GetTimeMs(&timeMs);
+
+    return timeMs;
+}
+
+static T_DjiReturnCode DjiTest_SpeakerTtsEkhoSynthesize(const char *sentence, int16_t **pcm, uint32_t *frameCount)
+{
+    FILE *txtFile;
+    char cmdStr[DJI_TEST_SPEAKER_TTS_EKHO_CMD_MAX_SIZE];
+    T_DjiReturnCode returnCode;
+
+    /* The sentence is passed by file, so the text never goes through the shell. */
+    txtFile = fopen(DJI_TEST_SPEAKER_TTS_EKHO_INPUT_FILE_NAME, "wb");
+    if (txtFile == NULL) {
+        USER_LOG_ERROR("Open tts sentence file error.");
+        return DJI_ERROR_SYSTEM_MODULE_CODE_SYSTEM_ERROR;
+    }
+    fwrite(sentence, 1, strlen(sentence), txtFile);
+    fclose(txtFile);
+
+    remove(DJI_TEST_SPEAKER_TTS_EKHO_OUTPUT_FILE_NAME);
+    snprintf(cmdStr, sizeof(cmdStr), "ekho -s 20 -p 20 -a 100 -f %s -o %s",
+             DJI_TEST_SPEAKER_TTS_EKHO_INPUT_FILE_NAME, DJI_TEST_SPEAKER_TTS_EKHO_OUTPUT_FILE_NAME);
+
+    returnCode = DjiUserUtil_RunSystemCmd(cmdStr);
+    if (returnCode != DJI_ERROR_SYSTEM_MODULE_CODE_SUCCESS) {
+        return returnCode;
+    }
+
+    return DjiTest_SpeakerTtsReadWav(DJI_TEST_SPEAKER_TTS_EKHO_OUTPUT_FILE_NAME, pcm, frameCount);
+}
+
+static T_DjiReturnCode DjiTest_SpeakerTtsToneSynthesize(const char *sentence, int16_t **pcm, uint32_t *frameCount)
+{
+    T_DjiOsalHandler *osalHandler = DjiPlatform_GetOsalHandler();
+    const char *p;
+    uint32_t totalFrames = 0;
+    uint32_t pos = 0;
+    uint32_t period;
+    uint32_t i;
+    uint8_t charLen;
+
+    for (p = sentence; *p != '\0'; p += charLen) {
+        charLen = DjiTest_SpeakerTtsGetUtf8CharLen(p);
+        totalFrames += DJI_TEST_SPEAKER_TTS_MS_TO_FRAMES(*p == ' ' ? DJI_TEST_SPEAKER_TTS_TONE_SPACE_MS :
+                                                         DJI_TEST_SPEAKER_TTS_TONE_CHAR_MS +
+                                                         DJI_TEST_SPEAKER_TTS_TONE_GAP_MS);
+    }
+
+    *pcm = osalHandler->Malloc(totalFrames * sizeof(int16_t) + 1);
+    if (*pcm == NULL) {
+        return DJI_ERROR_SYSTEM_MODULE_CODE_MEMORY_ALLOC_FAILED;
+    }
+    memset(*pcm, 0, totalFrames * sizeof(int16_t));
+
+    for (p = sentence; *p != '\0'; p += charLen) {
+        charLen = DjiTest_SpeakerTtsGetUtf8CharLen(p);
+        if (*p == ' ') {
+            pos += DJI_TEST_SPEAKER_TTS_MS_TO_FRAMES(DJI_TEST_SPEAKER_TTS_TONE_SPACE_MS);
+            continue;
+        }
+
+        /* Square wave between 300 Hz and 720 Hz, picked by the character */
+        period = DJI_TEST_SPEAKER_AUDIO_SAMPLE_RATE / (300 + ((uint8_t) p[charLen - 1] % 8) * 60);
+        for (i = 0; i < DJI_TEST_SPEAKER_TTS_MS_TO_FRAMES(DJI_TEST_SPEAKER_TTS_TONE_CHAR_MS); i++) {
+            (*pcm)[pos + i] = (i % period) < period / 2 ? DJI_TEST_SPEAKER_TTS_TONE_AMPLITUDE :
+                              -DJI_TEST_SPEAKER_TTS_TONE_AMPLITUDE;
+        }
+        pos += DJI_TEST_SPEAKER_TTS_MS_TO_FRAMES(DJI_TEST_SPEAKER_TTS_TONE_CHAR_MS + DJI_TEST_SPEAKER_TTS_TONE_GAP_MS);
+    }
+
+    *frameCount = totalFrames;
+
+    return DJI_ERROR_SYSTEM_MODULE_CODE_SUCCESS;
+}
+
+/**
+ * @brief Read a 16 bits PCM wav file, converted to mono at the audio engine sample rate.
+ */
+static T_DjiReturnCode DjiTest_SpeakerTtsReadWav(const char *path, int16_t **pcm, uint32_t *frameCount)
+{
+    T_DjiOsalHandler *osalHandler = DjiPlatform_GetOsalHandler();
+    T_DjiReturnCode returnCode = DJI_ERROR_SYSTEM_MODULE_CODE_SYSTEM_ERROR;
+    FILE *wavFile;
+    uint8_t *fileBuf = NULL;
+    long fileSize;
+    uint32_t chunkPos = 12;
+    uint32_t chunkSize;
+    uint16_t audioFormat = 0;
+    uint16_t channels = 0;
+    uint32_t sampleRate = 0;
+    uint16_t bitsPerSample = 0;
+    const int16_t *data = NULL;
+    uint32_t srcFrames = 0;
+    uint32_t dstFrames;
+    uint32_t srcIndex;
+    uint32_t frac;
+    int32_t sample0;
+    int32_t sample1;
+    uint32_t i;
+    uint16_t ch;
+
+    wavFile = fopen(path, "rb");
+    if (wavFile == NULL) {
+        USER_LOG_ERROR("Open wav file %s failed.", path);
+        return DJI_ERROR_SYSTEM_MODULE_CODE_NOT_FOUND;
+    }
+
+    fseek(wavFile, 0, SEEK_END);
+    fileSize = ftell(wavFile);
+    fseek(wavFile, 0, SEEK_SET);
+    if (fileSize < 12) {
+        goto close_file;
+    }
+
+    fileBuf = osalHandler->Malloc(fileSize);
+    if (fileBuf == NULL) {
+        returnCode = DJI_ERROR_SYSTEM_MODULE_CODE_MEMORY_ALLOC_FAILED;
+        goto close_file;
+    }
+
+    if (fread(fileBuf, 1, fileSize, wavFile) != (size_t) fileSize ||
+        memcmp(fileBuf, "RIFF", 4) != 0 || memcmp(&fileBuf[8], "WAVE", 4) != 0) {
+        USER_LOG_ERROR("Invalid wav file %s.", path);
+        goto free_buf;
+    }
+
+    while (chunkPos + 8 <= (uint32_t) fileSize) {
+        memcpy(&chunkSize, &fileBuf[chunkPos + 4], sizeof(chunkSize));
+        chunkSize = USER_UTIL_MIN(chunkSize, (uint32_t) fileSize - chunkPos - 8);
+
+        if (memcmp(&fileBuf[chunkPos], "fmt ", 4) == 0 && chunkSize >= 16) {
+            memcpy(&audioFormat, &fileBuf[chunkPos + 8], sizeof(audioFormat));
+            memcpy(&channels, &fileBuf[chunkPos + 10], sizeof(channels));
+            memcpy(&sampleRate, &fileBuf[chunkPos + 12], sizeof(sampleRate));
+            memcpy(&bitsPerSample, &fileBuf[chunkPos + 22], sizeof(bitsPerSample));
+        } else if (memcmp(&fileBuf[chunkPos], "data", 4) == 0) {
+            data = (const int16_t *) &fileBuf[chunkPos + 8];
+            srcFrames = channels > 0 ? chunkSize / (channels * sizeof(int16_t)) : 0;
+            break;
+        }
+
+        chunkPos += 8 + chunkSize + (chunkSize & 1);
+    }
+
+    if (data == NULL || audioFormat != 1 || bitsPerSample != 16 || channels == 0 || sampleRate == 0) {
+        USER_LOG_ERROR("Unsupported wav file %s, format %d, bits %d.", path, audioFormat, bitsPerSample);
+        goto free_buf;
+    }
+
+    dstFrames = (uint32_t) ((uint64_t) srcFrames * DJI_TEST_SPEAKER_AUDIO_SAMPLE_RATE / sampleRate);
+    *pcm = osalHandler->Malloc(dstFrames * sizeof(int16_t) + 1);
+    if (*pcm == NULL) {
+        returnCode = DJI_ERROR_SYSTEM_MODULE_CODE_MEMORY_ALLOC_FAILED;
+        goto free_buf;
+    }
+
+    /* Down mix and resample with linear interpolation */
+    for (i = 0; i < dstFrames; i++) {
+        srcIndex = (uint32_t) ((uint64_t) i * sampleRate / DJI_TEST_SPEAKER_AUDIO_SAMPLE_RATE);
+        frac = (uint32_t) ((uint64_t) i * sampleRate % DJI_TEST_SPEAKER_AUDIO_SAMPLE_RATE);
+        sample0 = 0;
+        sample1 = 0;
+        for (ch = 0; ch < channels; ch++) {
+            sample0 += data[srcIndex * channels + ch];
+            sample1 += data[USER_UTIL_MIN(srcIndex + 1, srcFrames - 1) * channels + ch];
+        }
+        sample0 /= channels;
+        sample1 /= channels;
+        (*pcm)[i] = (int16_t) (sample0 + (sample1 - sample0) * (int32_t) frac /
+                                         DJI_TEST_SPEAKER_AUDIO_SAMPLE_RATE);
+    }
+
+    *frameCount = dstFrames;
+    returnCode = DJI_ERROR_SYSTEM_MODULE_CODE_SUCCESS;
+
+free_buf:
+    osalHandler->Free(fileBuf);
+close_file:
+    fclose(wavFile);
+
+    return returnCode;
+}
+
+#endif
+
+/****************** (C) COPYRIGHT DJI Innovations *****END OF FILE****/
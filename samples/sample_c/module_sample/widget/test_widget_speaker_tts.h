@@ -0,0 +1,84 @@
+/**
+ ********************************************************************
+ * @file    test_widget_speaker_tts.h
+ * @brief   This is the header file for "test_widget_speaker_tts.c", defining the structure and
+ * (exported) function prototypes.
+ *
+ * @copyright (c) 2021 DJI. All rights reserved.
+ *
+ * All information contained herein is, and remains, the property of DJI.
+ * The intellectual and technical concepts contained herein are proprietary
+ * to DJI and may be covered by U.S. and foreign patents, patents in process,
+ * and protected by trade secret or copyright law.  Dissemination of this
+ * information, including but not limited to data and other proprietary
+ * material(s) incorporated within the information, in any form, is strictly
+ * prohibited without the express written consent of DJI.
+ *
+ * If you receive this source code without DJI’s authorization, you may not
+ * further disseminate the information, and you must immediately remove the
+ * source code and notify DJI of its removal. DJI reserves the right to pursue
+ * legal actions against you for any loss(es) or damage(s) caused by your
+ * failure to do so.
+ *
+ *********************************************************************
+ */
+
+/* Define to prevent recursive inclusion -------------------------------------*/
+#ifndef TEST_WIDGET_SPEAKER_TTS_H
+#define TEST_WIDGET_SPEAKER_TTS_H
+
+/* Includes ------------------------------------------------------------------*/
+#include "dji_typedef.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#ifdef SYSTEM_ARCH_LINUX
+
+/* Exported constants --------------------------------------------------------*/
+#define DJI_TEST_SPEAKER_TTS_TEXT_MAX_SIZE          (3000)
+
+/* Exported types ------------------------------------------------------------*/
+/**
+ * @brief Speech synthesizer used by the tts pipeline. Synthesize() is called with one sentence at a time and
+ * returns mono PCM at DJI_TEST_SPEAKER_AUDIO_SAMPLE_RATE, allocated by the osal Malloc. The caller owns the
+ * returned buffer.
+ */
+typedef struct {
+    const char *name;
+    T_DjiReturnCode (*Synthesize)(const char *sentence, int16_t **pcm, uint32_t *frameCount);
+} T_DjiTestSpeakerTtsBackend;
+
+typedef struct {
+    uint32_t requestCount;
+    uint32_t sentenceCount;
+    uint32_t cacheHitCount;
+    uint32_t cacheMissCount;
+    uint32_t cacheEntryCount;
+    uint32_t cacheBytes;
+    uint32_t synthesisTimeAvgMs;
+    uint32_t synthesisTimeMaxMs;
+    uint32_t firstAudioLatencyMs;
+} T_DjiTestSpeakerTtsMetrics;
+
+/* Exported functions --------------------------------------------------------*/
+const T_DjiTestSpeakerTtsBackend *DjiTest_SpeakerTtsGetEkhoBackend(void);
+const T_DjiTestSpeakerTtsBackend *DjiTest_SpeakerTtsGetToneBackend(void);
+
+T_DjiReturnCode DjiTest_SpeakerTtsInit(const T_DjiTestSpeakerTtsBackend *backend, uint32_t cacheMaxBytes);
+T_DjiReturnCode DjiTest_SpeakerTtsDeInit(void);
+
+T_DjiReturnCode DjiTest_SpeakerTtsStartSpeak(const char *text);
+T_DjiReturnCode DjiTest_SpeakerTtsWaitSpeakFinished(void);
+T_DjiReturnCode DjiTest_SpeakerTtsCancel(void);
+T_DjiReturnCode DjiTest_SpeakerTtsGetMetrics(T_DjiTestSpeakerTtsMetrics *metrics);
+
+#endif
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // TEST_WIDGET_SPEAKER_TTS_H
+/************************ (C) COPYRIGHT DJI Innovations *******END OF FILE******/
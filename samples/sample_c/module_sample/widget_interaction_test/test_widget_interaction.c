@@ -249,6 +249,12 @@ T_DjiReturnCode DjiTest_WidgetInteractionStartService(void)
     }
 
     //Step 4 : Run widget api sample task
+    djiStat = DjiTest_WidgetLogInit();
+    if (djiStat != DJI_ERROR_SYSTEM_MODULE_CODE_SUCCESS) {
+        USER_LOG_ERROR("Dji test widget log init error, stat = 0x%08llX", djiStat);
+        return djiStat;
+    }
+
     if (osalHandler->TaskCreate("user_widget_task", DjiTest_WidgetTask, WIDGET_TASK_STACK_SIZE, NULL,
                                 &s_widgetTestThread) != DJI_ERROR_SYSTEM_MODULE_CODE_SUCCESS) {
         USER_LOG_ERROR("Dji widget test task create error.");
@@ -0,0 +1,457 @@
+/**
+ ********************************************************************
+ * @file    dji_benchmark.c
+ * @brief   Micro-benchmark harness for the sample utilities and the linux osal.
+ *
+ * @copyright (c) 2021 DJI. All rights reserved.
+ *
+ * All information contained herein is, and remains, the property of DJI.
+ * The intellectual and technical concepts contained herein are proprietary
+ * to DJI and may be covered by U.S. and foreign patents, patents in process,
+ * and protected by trade secret or copyright law.  Dissemination of this
+ * information, including but not limited to data and other proprietary
+ * material(s) incorporated within the information, in any form, is strictly
+ * prohibited without the express written consent of DJI.
+ *
+ * If you receive this source code without DJI’s authorization, you may not
+ * further disseminate the information, and you must immediately remove the
+ * source code and notify DJI of its removal. DJI reserves the right to pursue
+ * legal actions against you for any loss(es) or damage(s) caused by your
+ * failure to do so.
+ *
+ *********************************************************************
+ */
+
+/* Includes ------------------------------------------------------------------*/
+#include "dji_benchmark.h"
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <math.h>
+#include <unistd.h>
+#include <sys/utsname.h>
+#include "utils/cJSON.h"
+
+/* Private constants ---------------------------------------------------------*/
+#define DJI_BENCHMARK_TARGET_BATCH_NS           20000
+#define DJI_BENCHMARK_MIN_SAMPLES               10
+#define DJI_BENCHMARK_WARMUP_ITERATIONS         4
+#define DJI_BENCHMARK_DEFAULT_TMP_DIR           "/tmp"
+
+#ifndef DJI_BENCHMARK_DEFAULT_DATA_DIR
+#define DJI_BENCHMARK_DEFAULT_DATA_DIR          "."
+#endif
+
+/* Private types -------------------------------------------------------------*/
+typedef struct {
+    double min;
+    double p50;
+    double p90;
+    double p99;
+    double max;
+    double mean;
+} T_DjiBenchmarkStat;
+
+/* Private functions declaration ---------------------------------------------*/
+static uint64_t DjiBenchmark_GetTimeNs(void);
+static T_DjiReturnCode DjiBenchmark_RunBatch(const T_DjiBenchmarkCase *benchCase, void *context,
+                                             uint32_t iterations, uint64_t *elapsedNs);
+static int DjiBenchmark_CompareDouble(const void *a, const void *b);
+static double DjiBenchmark_Percentile(const double *sortedSamples, uint32_t count, double percent);
+static double DjiBenchmark_Round(double value);
+static void DjiBenchmark_CalculateStat(double *samples, uint32_t count, T_DjiBenchmarkStat *stat);
+static void DjiBenchmark_WriteLine(FILE *output, cJSON *object);
+static void DjiBenchmark_WriteMeta(const T_DjiBenchmarkConfig *config, FILE *output);
+static void DjiBenchmark_WriteError(FILE *output, const char *name, const char *stage, T_DjiReturnCode returnCode);
+
+/* Private values ------------------------------------------------------------*/
+static uint32_t s_caseCount = 0;
+static uint32_t s_failedCount = 0;
+
+/* Exported functions definition ---------------------------------------------*/
+void DjiBenchmark_GetDefaultConfig(T_DjiBenchmarkConfig *config)
+{
+    config->filter = NULL;
+    config->dataDir = DJI_BENCHMARK_DEFAULT_DATA_DIR;
+    config->tmpDir = DJI_BENCHMARK_DEFAULT_TMP_DIR;
+    config->minTimeMs = DJI_BENCHMARK_DEFAULT_MIN_TIME_MS;
+    config->maxSamples = DJI_BENCHMARK_DEFAULT_MAX_SAMPLES;
+}
+
+T_DjiReturnCode DjiBenchmark_RunAll(const T_DjiBenchmarkConfig *config, FILE *output)
+{
+    T_DjiReturnCode returnCode;
+    uint64_t startNs;
+    cJSON *summary;
+
+    if (config == NULL || output == NULL) {
+        return DJI_ERROR_SYSTEM_MODULE_CODE_INVALID_PARAMETER;
+    }
+
+    s_caseCount = 0;
+    s_failedCount = 0;
+    startNs = DjiBenchmark_GetTimeNs();
+
+    DjiBenchmark_WriteMeta(config, output);
+
+    returnCode = DjiBenchmark_RunUtilCases(config, output);
+    if (returnCode != DJI_ERROR_SYSTEM_MODULE_CODE_SUCCESS) {
+        return returnCode;
+    }
+
+    returnCode = DjiBenchmark_RunRingCases(config, output);
+    if (returnCode != DJI_ERROR_SYSTEM_MODULE_CODE_SUCCESS) {
+        return returnCode;
+    }
+
+    returnCode = DjiBenchmark_RunPoolCases(config, output);
+    if (returnCode != DJI_ERROR_SYSTEM_MODULE_CODE_SUCCESS) {
+        return returnCode;
+    }
+
+    returnCode = DjiBenchmark_RunOsalCases(config, output);
+    if (returnCode != DJI_ERROR_SYSTEM_MODULE_CODE_SUCCESS) {
+        return returnCode;
+    }
+
+    returnCode = DjiBenchmark_RunKmzCases(config, output);
+    if (returnCode != DJI_ERROR_SYSTEM_MODULE_CODE_SUCCESS) {
+        return returnCode;
+    }
+
+    returnCode = DjiBenchmark_RunDataTxCases(config, output);
+    if (returnCode != DJI_ERROR_SYSTEM_MODULE_CODE_SUCCESS) {
+        return returnCode;
+    }
+
+    returnCode = DjiBenchmark_RunStreamCases(config, output);
+    if (returnCode != DJI_ERROR_SYSTEM_MODULE_CODE_SUCCESS) {
+        return returnCode;
+    }
+
+    returnCode = DjiBenchmark_RunMopMuxCases(config, output);
+    if (returnCode != DJI_ERROR_SYSTEM_MODULE_CODE_SUCCESS) {
+        return returnCode;
+    }
+
+    returnCode = DjiBenchmark_RunMopFileCases(config, output);
+    if (returnCode != DJI_ERROR_SYSTEM_MODULE_CODE_SUCCESS) {
+        return returnCode;
+    }
+
+    returnCode = DjiBenchmark_RunUpgradeCases(config, output);
+    if (returnCode != DJI_ERROR_SYSTEM_MODULE_CODE_SUCCESS) {
+        return returnCode;
+    }
+
+    returnCode = DjiBenchmark_RunLogCases(config, output);
+    if (returnCode != DJI_ERROR_SYSTEM_MODULE_CODE_SUCCESS) {
+        return returnCode;
+    }
+
+    returnCode = DjiBenchmark_RunTelemetryCases(config, output);
+    if (returnCode != DJI_ERROR_SYSTEM_MODULE_CODE_SUCCESS) {
+        return returnCode;
+    }
+
+    returnCode = DjiBenchmark_RunFlightRecorderCases(config, output);
+    if (returnCode != DJI_ERROR_SYSTEM_MODULE_CODE_SUCCESS) {
+        return returnCode;
+    }
+
+    returnCode = DjiBenchmark_RunGimbalCases(config, output);
+    if (returnCode != DJI_ERROR_SYSTEM_MODULE_CODE_SUCCESS) {
+        return returnCode;
+    }
+
+    returnCode = DjiBenchmark_RunTimeSyncCases(config, output);
+    if (returnCode != DJI_ERROR_SYSTEM_MODULE_CODE_SUCCESS) {
+        return returnCode;
+    }
+
+    summary = cJSON_CreateObject();
+    if (summary == NULL) {
+        return DJI_ERROR_SYSTEM_MODULE_CODE_MEMORY_ALLOC_FAILED;
+    }
+    cJSON_AddStringToObject(summary, "type", "summary");
+    cJSON_AddNumberToObject(summary, "cases", s_caseCount);
+    cJSON_AddNumberToObject(summary, "failed", s_failedCount);
+    cJSON_AddNumberToObject(summary, "elapsed_ms", (double) ((DjiBenchmark_GetTimeNs() - startNs) / 1000000));
+    DjiBenchmark_WriteLine(output, summary);
+    cJSON_Delete(summary);
+
+    return s_failedCount == 0 ? DJI_ERROR_SYSTEM_MODULE_CODE_SUCCESS : DJI_ERROR_SYSTEM_MODULE_CODE_SYSTEM_ERROR;
+}
+
+T_DjiReturnCode DjiBenchmark_RunCase(const T_DjiBenchmarkConfig *config, const T_DjiBenchmarkCase *benchCase,
+                                     FILE *output)
+{
+    T_DjiReturnCode returnCode;
+    T_DjiBenchmarkStat stat;
+    void *context = NULL;
+    double *samples = NULL;
+    uint32_t maxSamples;
+    uint32_t maxBatch;
+    uint32_t batch = 1;
+    uint32_t sampleCount = 0;
+    uint64_t elapsedNs = 0;
+    uint64_t totalNs = 0;
+    uint64_t minTimeNs;
+    cJSON *result;
+    cJSON *latency;
+
+    if (config == NULL || benchCase == NULL || output == NULL || benchCase->Run == NULL) {
+        return DJI_ERROR_SYSTEM_MODULE_CODE_INVALID_PARAMETER;
+    }
+
+    if (config->filter != NULL && strstr(benchCase->name, config->filter) == NULL) {
+        return DJI_ERROR_SYSTEM_MODULE_CODE_SUCCESS;
+    }
+
+    s_caseCount++;
+
+    maxSamples = config->maxSamples;
+    if (benchCase->maxSamples != 0 && benchCase->maxSamples < maxSamples) {
+        maxSamples = benchCase->maxSamples;
+    }
+    if (maxSamples < DJI_BENCHMARK_MIN_SAMPLES) {
+        maxSamples = DJI_BENCHMARK_MIN_SAMPLES;
+    }
+    maxBatch = benchCase->maxBatch != 0 ? benchCase->maxBatch : UINT32_MAX / 2;
+    minTimeNs = (uint64_t) config->minTimeMs * 1000000;
+
+    samples = malloc(maxSamples * sizeof(double));
+    if (samples == NULL) {
+        s_failedCount++;
+        DjiBenchmark_WriteError(output, benchCase->name, "alloc", DJI_ERROR_SYSTEM_MODULE_CODE_MEMORY_ALLOC_FAILED);
+        return DJI_ERROR_SYSTEM_MODULE_CODE_SUCCESS;
+    }
+
+    if (benchCase->Setup != NULL) {
+        returnCode = benchCase->Setup(config, benchCase->param, &context);
+        if (returnCode != DJI_ERROR_SYSTEM_MODULE_CODE_SUCCESS) {
+            s_failedCount++;
+            DjiBenchmark_WriteError(output, benchCase->name, "setup", returnCode);
+            free(samples);
+            return DJI_ERROR_SYSTEM_MODULE_CODE_SUCCESS;
+        }
+    }
+
+    returnCode = DjiBenchmark_RunBatch(benchCase, context, maxBatch < DJI_BENCHMARK_WARMUP_ITERATIONS ?
+                                                           maxBatch : DJI_BENCHMARK_WARMUP_ITERATIONS, &elapsedNs);
+    if (returnCode != DJI_ERROR_SYSTEM_MODULE_CODE_SUCCESS) {
+        goto out;
+    }
+
+    /* Grow the batch until one batch is long enough to hide the clock overhead. */
+    while (batch < maxBatch) {
+        returnCode = DjiBenchmark_RunBatch(benchCase, context, batch, &elapsedNs);
+        if (returnCode != DJI_ERROR_SYSTEM_MODULE_CODE_SUCCESS) {
+            goto out;
+        }
+        if (elapsedNs >= DJI_BENCHMARK_TARGET_BATCH_NS) {
+            break;
+        }
+        batch = (elapsedNs == 0 || DJI_BENCHMARK_TARGET_BATCH_NS / elapsedNs >= 2) ? batch * 2 :
+                batch + batch / 2 + 1;
+    }
+    if (batch > maxBatch) {
+        batch = maxBatch;
+    }
+
+    while (sampleCount < maxSamples && (totalNs < minTimeNs || sampleCount < DJI_BENCHMARK_MIN_SAMPLES)) {
+        returnCode = DjiBenchmark_RunBatch(benchCase, context, batch, &elapsedNs);
+        if (returnCode != DJI_ERROR_SYSTEM_MODULE_CODE_SUCCESS) {
+            goto out;
+        }
+        samples[sampleCount++] = (double) elapsedNs / batch;
+        totalNs += elapsedNs;
+    }
+
+    DjiBenchmark_CalculateStat(samples, sampleCount, &stat);
+
+    result = cJSON_CreateObject();
+    latency = cJSON_CreateObject();
+    if (result == NULL || latency == NULL) {
+        cJSON_Delete(result);
+        cJSON_Delete(latency);
+        returnCode = DJI_ERROR_SYSTEM_MODULE_CODE_MEMORY_ALLOC_FAILED;
+        goto out;
+    }
+
+    cJSON_AddStringToObject(result, "type", "case");
+    cJSON_AddStringToObject(result, "name", benchCase->name);
+    cJSON_AddNumberToObject(result, "batch", batch);
+    cJSON_AddNumberToObject(result, "samples", sampleCount);
+    cJSON_AddNumberToObject(result, "iterations", (double) sampleCount * batch);
+    cJSON_AddNumberToObject(result, "bytes_per_op", benchCase->bytesPerOp);
+    cJSON_AddNumberToObject(latency, "min", DjiBenchmark_Round(stat.min));
+    cJSON_AddNumberToObject(latency, "p50", DjiBenchmark_Round(stat.p50));
+    cJSON_AddNumberToObject(latency, "p90", DjiBenchmark_Round(stat.p90));
+    cJSON_AddNumberToObject(latency, "p99", DjiBenchmark_Round(stat.p99));
+    cJSON_AddNumberToObject(latency, "max", DjiBenchmark_Round(stat.max));
+    cJSON_AddNumberToObject(latency, "mean", DjiBenchmark_Round(stat.mean));
+    cJSON_AddItemToObject(result, "ns_per_op", latency);
+    cJSON_AddNumberToObject(result, "ops_per_sec", DjiBenchmark_Round(stat.mean > 0 ? 1e9 / stat.mean : 0));
+    if (benchCase->bytesPerOp != 0) {
+        cJSON_AddNumberToObject(result, "mb_per_sec",
+                                DjiBenchmark_Round(stat.mean > 0 ? benchCase->bytesPerOp * 1e3 / stat.mean : 0));
+    }
+    DjiBenchmark_WriteLine(output, result);
+    cJSON_Delete(result);
+
+out:
+    if (returnCode != DJI_ERROR_SYSTEM_MODULE_CODE_SUCCESS) {
+        s_failedCount++;
+        DjiBenchmark_WriteError(output, benchCase->name, "run", returnCode);
+    }
+    if (benchCase->Teardown != NULL) {
+        benchCase->Teardown(context);
+    }
+    free(samples);
+
+    return DJI_ERROR_SYSTEM_MODULE_CODE_SUCCESS;
+}
+
+/* Private functions definition-----------------------------------------------*/
+static uint64_t DjiBenchmark_GetTimeNs(void)
+{
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+
+    return (uint64_t) ts.tv_sec * 1000000000ULL + (uint64_t) ts.tv_nsec;
+}
+
+static T_DjiReturnCode DjiBenchmark_RunBatch(const T_DjiBenchmarkCase *benchCase, void *context,
+                                             uint32_t iterations, uint64_t *elapsedNs)
+{
+    T_DjiReturnCode returnCode;
+    uint64_t startNs;
+
+    startNs = DjiBenchmark_GetTimeNs();
+    returnCode = benchCase->Run(context, iterations);
+    *elapsedNs = DjiBenchmark_GetTimeNs() - startNs;
+
+    return returnCode;
+}
+
+static int DjiBenchmark_CompareDouble(const void *a, const void *b)
+{
+    double left = *(const double *) a;
+    double right = *(const double *) b;
+
+    return (left > right) - (left < right);
+}
+
+static double DjiBenchmark_Percentile(const double *sortedSamples, uint32_t count, double percent)
+{
+    uint32_t rank;
+
+    /* Nearest-rank percentile, stable for the small sample counts of the slow cases. */
+    rank = (uint32_t) ceil(percent / 100.0 * count);
+    if (rank == 0) {
+        rank = 1;
+    }
+
+    return sortedSamples[rank - 1];
+}
+
+static double DjiBenchmark_Round(double value)
+{
+    return floor(value * 10.0 + 0.5) / 10.0;
+}
+
+static void DjiBenchmark_CalculateStat(double *samples, uint32_t count, T_DjiBenchmarkStat *stat)
+{
+    double sum = 0;
+    uint32_t i;
+
+    memset(stat, 0, sizeof(T_DjiBenchmarkStat));
+    if (count == 0) {
+        return;
+    }
+
+    qsort(samples, count, sizeof(double), DjiBenchmark_CompareDouble);
+    for (i = 0; i < count; i++) {
+        sum += samples[i];
+    }
+
+    stat->min = samples[0];
+    stat->p50 = DjiBenchmark_Percentile(samples, count, 50);
+    stat->p90 = DjiBenchmark_Percentile(samples, count, 90);
+    stat->p99 = DjiBenchmark_Percentile(samples, count, 99);
+    stat->max = samples[count - 1];
+    stat->mean = sum / count;
+}
+
+static void DjiBenchmark_WriteLine(FILE *output, cJSON *object)
+{
+    char *line;
+
+    line = cJSON_PrintUnformatted(object);
+    if (line == NULL) {
+        return;
+    }
+
+    fprintf(output, "%s\n", line);
+    fflush(output);
+    cJSON_free(line);
+}
+
+static void DjiBenchmark_WriteMeta(const T_DjiBenchmarkConfig *config, FILE *output)
+{
+    struct utsname systemName;
+    cJSON *meta;
+
+    meta = cJSON_CreateObject();
+    if (meta == NULL) {
+        return;
+    }
+
+    cJSON_AddStringToObject(meta, "type", "meta");
+    cJSON_AddStringToObject(meta, "suite", "dji_sdk_benchmark");
+    cJSON_AddNumberToObject(meta, "format", DJI_BENCHMARK_FORMAT_VERSION);
+    cJSON_AddNumberToObject(meta, "timestamp", (double) time(NULL));
+    if (uname(&systemName) == 0) {
+        cJSON_AddStringToObject(meta, "host", systemName.nodename);
+        cJSON_AddStringToObject(meta, "machine", systemName.machine);
+        cJSON_AddStringToObject(meta, "kernel", systemName.release);
+    }
+    cJSON_AddNumberToObject(meta, "cpus", (double) sysconf(_SC_NPROCESSORS_ONLN));
+    cJSON_AddStringToObject(meta, "compiler", __VERSION__);
+#ifdef __OPTIMIZE__
+    cJSON_AddTrueToObject(meta, "optimized");
+#else
+    cJSON_AddFalseToObject(meta, "optimized");
+#endif
+    cJSON_AddNumberToObject(meta, "min_time_ms", config->minTimeMs);
+    cJSON_AddNumberToObject(meta, "max_samples", config->maxSamples);
+    if (config->filter != NULL) {
+        cJSON_AddStringToObject(meta, "filter", config->filter);
+    }
+
+    DjiBenchmark_WriteLine(output, meta);
+    cJSON_Delete(meta);
+}
+
+static void DjiBenchmark_WriteError(FILE *output, const char *name, const char *stage, T_DjiReturnCode returnCode)
+{
+    char code[24];
+    cJSON *error;
+
+    error = cJSON_CreateObject();
+    if (error == NULL) {
+        return;
+    }
+
+    snprintf(code, sizeof(code), "0x%08llX", (unsigned long long) returnCode);
+    cJSON_AddStringToObject(error, "type", "error");
+    cJSON_AddStringToObject(error, "name", name);
+    cJSON_AddStringToObject(error, "stage", stage);
+    cJSON_AddStringToObject(error, "code", code);
+    DjiBenchmark_WriteLine(output, error);
+    cJSON_Delete(error);
+}
+
+/****************** (C) COPYRIGHT DJI Innovations *****END OF FILE****/
@@ -0,0 +1,96 @@
+/**
+ ********************************************************************
+ * @file    dji_benchmark.h
+ * @brief   This is the header file for "dji_benchmark.c", defining the structure and
+ * (exported) function prototypes.
+ *
+ * @copyright (c) 2021 DJI. All rights reserved.
+ *
+ * All information contained herein is, and remains, the property of DJI.
+ * The intellectual and technical concepts contained herein are proprietary
+ * to DJI and may be covered by U.S. and foreign patents, patents in process,
+ * and protected by trade secret or copyright law.  Dissemination of this
+ * information, including but not limited to data and other proprietary
+ * material(s) incorporated within the information, in any form, is strictly
+ * prohibited without the express written consent of DJI.
+ *
+ * If you receive this source code without DJI’s authorization, you may not
+ * further disseminate the information, and you must immediately remove the
+ * source code and notify DJI of its removal. DJI reserves the right to pursue
+ * legal actions against you for any loss(es) or damage(s) caused by your
+ * failure to do so.
+ *
+ *********************************************************************
+ */
+
+/* Define to prevent recursive inclusion -------------------------------------*/
+#ifndef DJI_BENCHMARK_H
+#define DJI_BENCHMARK_H
+
+/* Includes ------------------------------------------------------------------*/
+#include <stdio.h>
+#include "dji_typedef.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Exported constants --------------------------------------------------------*/
+#define DJI_BENCHMARK_FORMAT_VERSION            1
+#define DJI_BENCHMARK_DEFAULT_MIN_TIME_MS       200
+#define DJI_BENCHMARK_DEFAULT_MAX_SAMPLES       20000
+
+/* Exported types ------------------------------------------------------------*/
+typedef struct {
+    const char *filter;             /*!< Only cases whose name contains this string are run, NULL runs all. */
+    const char *dataDir;            /*!< Repository root used to locate the json files of the cjson cases. */
+    const char *tmpDir;             /*!< Scratch files of the file, mop, upgrade, log and flight_record cases. */
+    uint32_t minTimeMs;             /*!< Minimum measuring time of each case. */
+    uint32_t maxSamples;            /*!< Upper bound of timed batches of each case. */
+} T_DjiBenchmarkConfig;
+
+/**
+ * @brief Benchmark case descriptor.
+ * @note Run executes the measured operation "iterations" times back to back. The harness times whole batches and
+ * divides by the batch size, so percentiles describe the per-operation cost averaged over one batch. Cases whose
+ * single operation is already long (thread spawn, file open) set maxBatch to 1 to get true per-operation latencies.
+ */
+typedef struct {
+    const char *name;
+    uint32_t bytesPerOp;
+    uint32_t maxBatch;
+    uint32_t maxSamples;
+    T_DjiReturnCode (*Setup)(const T_DjiBenchmarkConfig *config, void *param, void **context);
+    T_DjiReturnCode (*Run)(void *context, uint32_t iterations);
+    void (*Teardown)(void *context);
+    void *param;
+} T_DjiBenchmarkCase;
+
+/* Exported functions --------------------------------------------------------*/
+void DjiBenchmark_GetDefaultConfig(T_DjiBenchmarkConfig *config);
+T_DjiReturnCode DjiBenchmark_RunAll(const T_DjiBenchmarkConfig *config, FILE *output);
+
+T_DjiReturnCode DjiBenchmark_RunCase(const T_DjiBenchmarkConfig *config, const T_DjiBenchmarkCase *benchCase,
+                                     FILE *output);
+T_DjiReturnCode DjiBenchmark_RunUtilCases(const T_DjiBenchmarkConfig *config, FILE *output);
+T_DjiReturnCode DjiBenchmark_RunRingCases(const T_DjiBenchmarkConfig *config, FILE *output);
+T_DjiReturnCode DjiBenchmark_RunPoolCases(const T_DjiBenchmarkConfig *config, FILE *output);
+T_DjiReturnCode DjiBenchmark_RunOsalCases(const T_DjiBenchmarkConfig *config, FILE *output);
+T_DjiReturnCode DjiBenchmark_RunKmzCases(const T_DjiBenchmarkConfig *config, FILE *output);
+T_DjiReturnCode DjiBenchmark_RunDataTxCases(const T_DjiBenchmarkConfig *config, FILE *output);
+T_DjiReturnCode DjiBenchmark_RunStreamCases(const T_DjiBenchmarkConfig *config, FILE *output);
+T_DjiReturnCode DjiBenchmark_RunMopMuxCases(const T_DjiBenchmarkConfig *config, FILE *output);
+T_DjiReturnCode DjiBenchmark_RunMopFileCases(const T_DjiBenchmarkConfig *config, FILE *output);
+T_DjiReturnCode DjiBenchmark_RunUpgradeCases(const T_DjiBenchmarkConfig *config, FILE *output);
+T_DjiReturnCode DjiBenchmark_RunLogCases(const T_DjiBenchmarkConfig *config, FILE *output);
+T_DjiReturnCode DjiBenchmark_RunTelemetryCases(const T_DjiBenchmarkConfig *config, FILE *output);
+T_DjiReturnCode DjiBenchmark_RunFlightRecorderCases(const T_DjiBenchmarkConfig *config, FILE *output);
+T_DjiReturnCode DjiBenchmark_RunGimbalCases(const T_DjiBenchmarkConfig *config, FILE *output);
+T_DjiReturnCode DjiBenchmark_RunTimeSyncCases(const T_DjiBenchmarkConfig *config, FILE *output);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // DJI_BENCHMARK_H
+/************************ (C) COPYRIGHT DJI Innovations *******END OF FILE******/
@@ -0,0 +1,204 @@
+/**
+ ********************************************************************
+ * @file    dji_benchmark_data_tx.c
+ * @brief   Benchmark cases of the low speed channel transmit scheduler on a simulated channel.
+ *
+ * @copyright (c) 2021 DJI. All rights reserved.
+ *
+ * All information contained herein is, and remains, the property of DJI.
+ * The intellectual and technical concepts contained herein are proprietary
+ * to DJI and may be covered by U.S. and foreign patents, patents in process,
+ * and protected by trade secret or copyright law.  Dissemination of this
+ * information, including but not limited to data and other proprietary
+ * material(s) incorporated within the information, in any form, is strictly
+ * prohibited without the express written consent of DJI.
+ *
+ * If you receive this source code without DJI’s authorization, you may not
+ * further disseminate the information, and you must immediately remove the
+ * source code and notify DJI of its removal. DJI reserves the right to pursue
+ * legal actions against you for any loss(es) or damage(s) caused by your
+ * failure to do so.
+ *
+ *********************************************************************
+ */
+
+/* Includes ------------------------------------------------------------------*/
+#include "dji_benchmark.h"
+#include <stdlib.h>
+#include <string.h>
+#include "data_transmission/test_data_transmission_scheduler.h"
+
+/* Private constants ---------------------------------------------------------*/
+#define DJI_BENCHMARK_DATA_TX_STEP_MS           (10)
+#define DJI_BENCHMARK_DATA_TX_BULK_SIZE         (100)
+#define DJI_BENCHMARK_DATA_TX_STATUS_SIZE       (40)
+#define DJI_BENCHMARK_DATA_TX_COMMAND_SIZE      (20)
+#define DJI_BENCHMARK_DATA_TX_STATUS_TOPIC      (1)
+
+/* Private types -------------------------------------------------------------*/
+typedef struct {
+    uint32_t bandwidth;
+    uint32_t destinationNum;
+} T_DjiBenchmarkDataTxParam;
+
+typedef struct {
+    const T_DjiBenchmarkDataTxParam *param;
+    T_DjiTestDataTxSimChannel simChannel;
+    T_DjiTestDataTxScheduler scheduler;
+    uint32_t nowMs;
+    uint32_t step;
+    uint8_t data[DJI_TEST_DATA_TX_MESSAGE_MAX_SIZE];
+} T_DjiBenchmarkDataTxContext;
+
+/* Private functions declaration ---------------------------------------------*/
+static T_DjiReturnCode DjiBenchmark_DataTxSetup(const T_DjiBenchmarkConfig *config, void *param, void **context);
+static T_DjiReturnCode DjiBenchmark_DataTxCoalesce(void *context, uint32_t iterations);
+static T_DjiReturnCode DjiBenchmark_DataTxMixed(void *context, uint32_t iterations);
+static void DjiBenchmark_DataTxTeardown(void *context);
+static uint32_t DjiBenchmark_DataTxGetTimeMs(void *userData);
+
+/* Private values ------------------------------------------------------------*/
+static const T_DjiBenchmarkDataTxParam s_dataTxSingleParam = {4000, 1};
+static const T_DjiBenchmarkDataTxParam s_dataTxMultiParam = {4000, DJI_TEST_DATA_TX_DESTINATION_MAX_NUM};
+static const E_DjiChannelAddress s_dataTxAddresses[DJI_TEST_DATA_TX_DESTINATION_MAX_NUM] = {
+    DJI_CHANNEL_ADDRESS_MASTER_RC_APP,
+    DJI_CHANNEL_ADDRESS_CLOUD_API,
+    DJI_CHANNEL_ADDRESS_EXTENSION_PORT,
+    DJI_CHANNEL_ADDRESS_PAYLOAD_PORT_NO1,
+};
+
+/* Exported functions definition ---------------------------------------------*/
+T_DjiReturnCode DjiBenchmark_RunDataTxCases(const T_DjiBenchmarkConfig *config, FILE *output)
+{
+    T_DjiBenchmarkCase benchCase;
+
+    benchCase = (T_DjiBenchmarkCase) {
+        .name = "data_tx/enqueue_coalesce", .bytesPerOp = DJI_BENCHMARK_DATA_TX_STATUS_SIZE,
+        .Setup = DjiBenchmark_DataTxSetup, .Run = DjiBenchmark_DataTxCoalesce,
+        .Teardown = DjiBenchmark_DataTxTeardown, .param = (void *) &s_dataTxSingleParam,
+    };
+    DjiBenchmark_RunCase(config, &benchCase, output);
+
+    /* One operation is 10 ms of simulated traffic: bulk and status for every destination, a command every 5th step. */
+    benchCase.name = "data_tx/mixed/1";
+    benchCase.bytesPerOp = 0;
+    benchCase.Run = DjiBenchmark_DataTxMixed;
+    DjiBenchmark_RunCase(config, &benchCase, output);
+
+    benchCase.name = "data_tx/mixed/4";
+    benchCase.param = (void *) &s_dataTxMultiParam;
+    DjiBenchmark_RunCase(config, &benchCase, output);
+
+    return DJI_ERROR_SYSTEM_MODULE_CODE_SUCCESS;
+}
+
+/* Private functions definition-----------------------------------------------*/
+static T_DjiReturnCode DjiBenchmark_DataTxSetup(const T_DjiBenchmarkConfig *config, void *param, void **context)
+{
+    T_DjiBenchmarkDataTxContext *dataTxContext;
+    T_DjiTestDataTxSchedulerConfig schedulerConfig;
+    T_DjiTestDataTxChannel channel;
+    T_DjiReturnCode returnCode;
+
+    (void) config;
+
+    dataTxContext = calloc(1, sizeof(T_DjiBenchmarkDataTxContext));
+    if (dataTxContext == NULL) {
+        return DJI_ERROR_SYSTEM_MODULE_CODE_MEMORY_ALLOC_FAILED;
+    }
+
+    dataTxContext->param = param;
+    memset(dataTxContext->data, 0x5A, sizeof(dataTxContext->data));
+
+    DjiTest_DataTxSimChannelInit(&dataTxContext->simChannel, dataTxContext->param->bandwidth);
+    dataTxContext->simChannel.GetTimeMs = DjiBenchmark_DataTxGetTimeMs;
+    dataTxContext->simChannel.timeUserData = dataTxContext;
+    DjiTest_DataTxSimChannelGetChannel(&dataTxContext->simChannel, &channel);
+
+    DjiTest_DataTxSchedulerGetDefaultConfig(&schedulerConfig);
+    schedulerConfig.maxRate = dataTxContext->param->bandwidth;
+    returnCode = DjiTest_DataTxSchedulerInit(&dataTxContext->scheduler, &schedulerConfig, &channel);
+    if (returnCode != DJI_ERROR_SYSTEM_MODULE_CODE_SUCCESS) {
+        free(dataTxContext);
+        return returnCode;
+    }
+
+    *context = dataTxContext;
+
+    return DJI_ERROR_SYSTEM_MODULE_CODE_SUCCESS;
+}
+
+static T_DjiReturnCode DjiBenchmark_DataTxCoalesce(void *context, uint32_t iterations)
+{
+    T_DjiBenchmarkDataTxContext *dataTxContext = context;
+    T_DjiReturnCode returnCode;
+    uint32_t i;
+
+    /* The clock stands still, so after the first send every enqueue replaces the queued value. */
+    for (i = 0; i < iterations; i++) {
+        dataTxContext->data[0] = (uint8_t) i;
+        returnCode = DjiTest_DataTxSchedulerEnqueue(&dataTxContext->scheduler, s_dataTxAddresses[0],
+                                                    DJI_TEST_DATA_TX_CLASS_STATUS, DJI_BENCHMARK_DATA_TX_STATUS_TOPIC,
+                                                    dataTxContext->data, DJI_BENCHMARK_DATA_TX_STATUS_SIZE);
+        if (returnCode != DJI_ERROR_SYSTEM_MODULE_CODE_SUCCESS) {
+            return returnCode;
+        }
+    }
+
+    return DjiTest_DataTxSchedulerProcess(&dataTxContext->scheduler);
+}
+
+static T_DjiReturnCode DjiBenchmark_DataTxMixed(void *context, uint32_t iterations)
+{
+    T_DjiBenchmarkDataTxContext *dataTxContext = context;
+    T_DjiTestDataTxScheduler *scheduler = &dataTxContext->scheduler;
+    T_DjiReturnCode returnCode;
+    uint32_t i;
+    uint32_t j;
+
+    for (i = 0; i < iterations; i++) {
+        dataTxContext->nowMs += DJI_BENCHMARK_DATA_TX_STEP_MS;
+        dataTxContext->step++;
+
+        for (j = 0; j < dataTxContext->param->destinationNum; j++) {
+            /* Overflowing bulk queues drop their oldest message, that is part of the measured work. */
+            DjiTest_DataTxSchedulerEnqueue(scheduler, s_dataTxAddresses[j], DJI_TEST_DATA_TX_CLASS_BULK, 0,
+                                           dataTxContext->data, DJI_BENCHMARK_DATA_TX_BULK_SIZE);
+            DjiTest_DataTxSchedulerEnqueue(scheduler, s_dataTxAddresses[j], DJI_TEST_DATA_TX_CLASS_STATUS,
+                                           DJI_BENCHMARK_DATA_TX_STATUS_TOPIC, dataTxContext->data,
+                                           DJI_BENCHMARK_DATA_TX_STATUS_SIZE);
+            if (dataTxContext->step % 5 == 0) {
+                DjiTest_DataTxSchedulerEnqueue(scheduler, s_dataTxAddresses[j], DJI_TEST_DATA_TX_CLASS_COMMAND, 0,
+                                               dataTxContext->data, DJI_BENCHMARK_DATA_TX_COMMAND_SIZE);
+            }
+        }
+
+        returnCode = DjiTest_DataTxSchedulerProcess(scheduler);
+        if (returnCode != DJI_ERROR_SYSTEM_MODULE_CODE_SUCCESS) {
+            return returnCode;
+        }
+    }
+
+    return DJI_ERROR_SYSTEM_MODULE_CODE_SUCCESS;
+}
+
+static void DjiBenchmark_DataTxTeardown(void *context)
+{
+    T_DjiBenchmarkDataTxContext *dataTxContext = context;
+
+    if (dataTxContext == NULL) {
+        return;
+    }
+
+    DjiTest_DataTxSchedulerDeInit(&dataTxContext->scheduler);
+    free(dataTxContext);
+}
+
+static uint32_t DjiBenchmark_DataTxGetTimeMs(void *userData)
+{
+    T_DjiBenchmarkDataTxContext *dataTxContext = userData;
+
+    return dataTxContext->nowMs;
+}
+
+/****************** (C) COPYRIGHT DJI Innovations *****END OF FILE****/
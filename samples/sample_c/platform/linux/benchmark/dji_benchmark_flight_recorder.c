@@ -0,0 +1,419 @@
+/**
+ ********************************************************************
+ * @file    dji_benchmark_flight_recorder.c
+ * @brief   Benchmark cases of recording the sample streams and reading the flight records back.
+ *
+ * @copyright (c) 2021 DJI. All rights reserved.
+ *
+ * All information contained herein is, and remains, the property of DJI.
+ * The intellectual and technical concepts contained herein are proprietary
+ * to DJI and may be covered by U.S. and foreign patents, patents in process,
+ * and protected by trade secret or copyright law.  Dissemination of this
+ * information, including but not limited to data and other proprietary
+ * material(s) incorporated within the information, in any form, is strictly
+ * prohibited without the express written consent of DJI.
+ *
+ * If you receive this source code without DJI’s authorization, you may not
+ * further disseminate the information, and you must immediately remove the
+ * source code and notify DJI of its removal. DJI reserves the right to pursue
+ * legal actions against you for any loss(es) or damage(s) caused by your
+ * failure to do so.
+ *
+ *********************************************************************
+ */
+
+/* Includes ------------------------------------------------------------------*/
+#include "dji_benchmark.h"
+#include <dirent.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include "flight_recorder/test_flight_recorder.h"
+
+/* Private constants ---------------------------------------------------------*/
+#define DJI_BENCHMARK_FLIGHT_PATH_MAX_LEN           (DJI_TEST_FLIGHT_RECORDER_PATH_MAX_SIZE)
+#define DJI_BENCHMARK_FLIGHT_PREFIX                 "bench"
+/* A quaternion with the T_DjiDataTimestamp in front, the way the fc subscription sample records it. */
+#define DJI_BENCHMARK_FLIGHT_SMALL_HEADER_SIZE      (8)
+#define DJI_BENCHMARK_FLIGHT_SMALL_DATA_SIZE        (16)
+/* A 640x480 8 bit stereo image. */
+#define DJI_BENCHMARK_FLIGHT_IMAGE_SIZE             (640 * 480)
+/* The read store holds 200000 records of three channels, the sparse one is in a few chunks only. */
+#define DJI_BENCHMARK_FLIGHT_STORE_RECORD_NUM       (200000)
+#define DJI_BENCHMARK_FLIGHT_STORE_DENSE_INTERVAL   (10)
+#define DJI_BENCHMARK_FLIGHT_STORE_SPARSE_INTERVAL  (20000)
+#define DJI_BENCHMARK_FLIGHT_STORE_CHUNK_SIZE       (256 * 1024)
+#define DJI_BENCHMARK_FLIGHT_SEEK_RECORD_NUM        (1000)
+#define DJI_BENCHMARK_FLIGHT_BUSY_WAIT_US           (1000)
+
+/* Private types -------------------------------------------------------------*/
+typedef enum {
+    DJI_BENCHMARK_FLIGHT_MODE_WRITE_SMALL = 0,  /*!< A running recorder, one small record per operation. */
+    DJI_BENCHMARK_FLIGHT_MODE_WRITE_IMAGE,      /*!< A running recorder, one image per operation. */
+    DJI_BENCHMARK_FLIGHT_MODE_READ_ALL,         /*!< All records of the store. */
+    DJI_BENCHMARK_FLIGHT_MODE_READ_SPARSE,      /*!< The sparse channel only, its chunks found by the index. */
+    DJI_BENCHMARK_FLIGHT_MODE_READ_SEEK,        /*!< A seek into the middle and the records after it. */
+} E_DjiBenchmarkFlightMode;
+
+typedef struct {
+    E_DjiBenchmarkFlightMode mode;
+    char rootPath[DJI_BENCHMARK_FLIGHT_PATH_MAX_LEN];
+    char filePath[DJI_BENCHMARK_FLIGHT_PATH_MAX_LEN * 2];
+    uint16_t channelIds[3];
+    uint8_t *data;
+    uint32_t dataSize;
+    uint64_t writeCount;
+    bool isRecording;
+} T_DjiBenchmarkFlightContext;
+
+/* Private functions declaration ---------------------------------------------*/
+static T_DjiReturnCode DjiBenchmark_FlightSetup(const T_DjiBenchmarkConfig *config, void *param, void **context);
+static T_DjiReturnCode DjiBenchmark_FlightRun(void *context, uint32_t iterations);
+static void DjiBenchmark_FlightTeardown(void *context);
+static T_DjiReturnCode DjiBenchmark_FlightAddChannels(T_DjiBenchmarkFlightContext *flightContext);
+static T_DjiReturnCode DjiBenchmark_FlightStart(T_DjiBenchmarkFlightContext *flightContext, uint32_t chunkSize);
+static T_DjiReturnCode DjiBenchmark_FlightCreateStore(T_DjiBenchmarkFlightContext *flightContext);
+static T_DjiReturnCode DjiBenchmark_FlightRead(T_DjiBenchmarkFlightContext *flightContext);
+static bool DjiBenchmark_FlightFindFile(T_DjiBenchmarkFlightContext *flightContext);
+
+/* Private values ------------------------------------------------------------*/
+static const E_DjiBenchmarkFlightMode s_flightWriteSmallMode = DJI_BENCHMARK_FLIGHT_MODE_WRITE_SMALL;
+static const E_DjiBenchmarkFlightMode s_flightWriteImageMode = DJI_BENCHMARK_FLIGHT_MODE_WRITE_IMAGE;
+static const E_DjiBenchmarkFlightMode s_flightReadAllMode = DJI_BENCHMARK_FLIGHT_MODE_READ_ALL;
+static const E_DjiBenchmarkFlightMode s_flightReadSparseMode = DJI_BENCHMARK_FLIGHT_MODE_READ_SPARSE;
+static const E_DjiBenchmarkFlightMode s_flightReadSeekMode = DJI_BENCHMARK_FLIGHT_MODE_READ_SEEK;
+static const T_DjiTestFlightRecorderChannelInfo s_flightChannelInfos[] = {
+    {"bench/quaternion", "bench.quaternion", "millisecond:u32 microsecond:u32 q:f32[4]"},
+    {"bench/image", "bench.image", "image:bytes"},
+    {"bench/rtcm", "bench.rtcm", "index:u8 rtcm:bytes"},
+};
+
+/* Exported functions definition ---------------------------------------------*/
+T_DjiReturnCode DjiBenchmark_RunFlightRecorderCases(const T_DjiBenchmarkConfig *config, FILE *output)
+{
+    T_DjiBenchmarkCase benchCase;
+
+    /* The cost a sample callback pays for recording while the writer task flushes the chunks. A record finding no
+     * free chunk would be dropped in a callback, here it is retried so the rate is what the disk sustains. */
+    benchCase = (T_DjiBenchmarkCase) {
+        .name = "flight_record/write/small",
+        .bytesPerOp = DJI_BENCHMARK_FLIGHT_SMALL_HEADER_SIZE + DJI_BENCHMARK_FLIGHT_SMALL_DATA_SIZE,
+        .maxBatch = 4096, .maxSamples = 0,
+        .Setup = DjiBenchmark_FlightSetup, .Run = DjiBenchmark_FlightRun,
+        .Teardown = DjiBenchmark_FlightTeardown, .param = (void *) &s_flightWriteSmallMode,
+    };
+    DjiBenchmark_RunCase(config, &benchCase, output);
+
+    benchCase.name = "flight_record/write/image";
+    benchCase.bytesPerOp = DJI_BENCHMARK_FLIGHT_IMAGE_SIZE;
+    benchCase.maxBatch = 16;
+    benchCase.param = (void *) &s_flightWriteImageMode;
+    DjiBenchmark_RunCase(config, &benchCase, output);
+
+    /* One operation reads a record of 200000 records, the cases fail when the number of records read is wrong. */
+    benchCase.name = "flight_record/read/all";
+    benchCase.bytesPerOp = 0;
+    benchCase.maxBatch = 1;
+    benchCase.maxSamples = 10;
+    benchCase.param = (void *) &s_flightReadAllMode;
+    DjiBenchmark_RunCase(config, &benchCase, output);
+
+    benchCase.name = "flight_record/read/sparse";
+    benchCase.param = (void *) &s_flightReadSparseMode;
+    DjiBenchmark_RunCase(config, &benchCase, output);
+
+    benchCase.name = "flight_record/read/seek";
+    benchCase.maxSamples = 100;
+    benchCase.param = (void *) &s_flightReadSeekMode;
+    DjiBenchmark_RunCase(config, &benchCase, output);
+
+    return DJI_ERROR_SYSTEM_MODULE_CODE_SUCCESS;
+}
+
+/* Private functions definition-----------------------------------------------*/
+static T_DjiReturnCode DjiBenchmark_FlightSetup(const T_DjiBenchmarkConfig *config, void *param, void **context)
+{
+    T_DjiBenchmarkFlightContext *flightContext;
+    T_DjiReturnCode returnCode;
+    uint32_t i;
+
+    flightContext = calloc(1, sizeof(T_DjiBenchmarkFlightContext));
+    if (flightContext == NULL) {
+        return DJI_ERROR_SYSTEM_MODULE_CODE_MEMORY_ALLOC_FAILED;
+    }
+    flightContext->mode = *(const E_DjiBenchmarkFlightMode *) param;
+    *context = flightContext;
+
+    snprintf(flightContext->rootPath, sizeof(flightContext->rootPath), "%s/dji_benchmark_XXXXXX", config->tmpDir);
+    if (mkdtemp(flightContext->rootPath) == NULL) {
+        flightContext->rootPath[0] = '\0';
+        return DJI_ERROR_SYSTEM_MODULE_CODE_SYSTEM_ERROR;
+    }
+
+    flightContext->dataSize = flightContext->mode == DJI_BENCHMARK_FLIGHT_MODE_WRITE_IMAGE ?
+                              DJI_BENCHMARK_FLIGHT_IMAGE_SIZE : DJI_BENCHMARK_FLIGHT_SMALL_DATA_SIZE;
+    flightContext->data = malloc(flightContext->dataSize);
+    if (flightContext->data == NULL) {
+        return DJI_ERROR_SYSTEM_MODULE_CODE_MEMORY_ALLOC_FAILED;
+    }
+    for (i = 0; i < flightContext->dataSize; i++) {
+        flightContext->data[i] = (uint8_t) (i * 31 + i / 640);
+    }
+
+    returnCode = DjiBenchmark_FlightAddChannels(flightContext);
+    if (returnCode != DJI_ERROR_SYSTEM_MODULE_CODE_SUCCESS) {
+        return returnCode;
+    }
+
+    switch (flightContext->mode) {
+        case DJI_BENCHMARK_FLIGHT_MODE_WRITE_SMALL:
+        case DJI_BENCHMARK_FLIGHT_MODE_WRITE_IMAGE:
+            return DjiBenchmark_FlightStart(flightContext, 0);
+        default:
+            return DjiBenchmark_FlightCreateStore(flightContext);
+    }
+}
+
+static T_DjiReturnCode DjiBenchmark_FlightRun(void *context, uint32_t iterations)
+{
+    T_DjiBenchmarkFlightContext *flightContext = context;
+    T_DjiReturnCode returnCode;
+    uint32_t timestamp[2];
+    uint32_t i;
+
+    for (i = 0; i < iterations; i++) {
+        switch (flightContext->mode) {
+            case DJI_BENCHMARK_FLIGHT_MODE_WRITE_SMALL:
+                timestamp[0] = (uint32_t) (flightContext->writeCount / 1000);
+                timestamp[1] = (uint32_t) flightContext->writeCount;
+                returnCode = DjiTest_FlightRecorderWrite(flightContext->channelIds[0], timestamp[1], timestamp,
+                                                         sizeof(timestamp), flightContext->data,
+                                                         flightContext->dataSize);
+                break;
+            case DJI_BENCHMARK_FLIGHT_MODE_WRITE_IMAGE:
+                returnCode = DjiTest_FlightRecorderWrite(flightContext->channelIds[1], flightContext->writeCount,
+                                                         NULL, 0, flightContext->data, flightContext->dataSize);
+                break;
+            default:
+                returnCode = DjiBenchmark_FlightRead(flightContext);
+                break;
+        }
+        if (returnCode == DJI_ERROR_SYSTEM_MODULE_CODE_BUSY) {
+            usleep(DJI_BENCHMARK_FLIGHT_BUSY_WAIT_US);
+            i--;
+            continue;
+        }
+        if (returnCode != DJI_ERROR_SYSTEM_MODULE_CODE_SUCCESS) {
+            return returnCode;
+        }
+        flightContext->writeCount++;
+    }
+
+    return DJI_ERROR_SYSTEM_MODULE_CODE_SUCCESS;
+}
+
+static void DjiBenchmark_FlightTeardown(void *context)
+{
+    T_DjiBenchmarkFlightContext *flightContext = context;
+
+    if (flightContext == NULL) {
+        return;
+    }
+
+    if (flightContext->isRecording) {
+        DjiTest_FlightRecorderStop();
+    }
+    if (flightContext->rootPath[0] != '\0') {
+        while (DjiBenchmark_FlightFindFile(flightContext)) {
+            remove(flightContext->filePath);
+        }
+        rmdir(flightContext->rootPath);
+    }
+
+    free(flightContext->data);
+    free(flightContext);
+}
+
+static T_DjiReturnCode DjiBenchmark_FlightAddChannels(T_DjiBenchmarkFlightContext *flightContext)
+{
+    T_DjiReturnCode returnCode;
+    uint32_t i;
+
+    /* Channels live as long as the process, a later case gets the same ids back. */
+    for (i = 0; i < sizeof(s_flightChannelInfos) / sizeof(s_flightChannelInfos[0]); i++) {
+        returnCode = DjiTest_FlightRecorderAddChannel(&s_flightChannelInfos[i], NULL, NULL,
+                                                      &flightContext->channelIds[i]);
+        if (returnCode != DJI_ERROR_SYSTEM_MODULE_CODE_SUCCESS) {
+            return returnCode;
+        }
+    }
+
+    return DJI_ERROR_SYSTEM_MODULE_CODE_SUCCESS;
+}
+
+static T_DjiReturnCode DjiBenchmark_FlightStart(T_DjiBenchmarkFlightContext *flightContext, uint32_t chunkSize)
+{
+    T_DjiTestFlightRecorderConfig recorderConfig;
+    T_DjiReturnCode returnCode;
+
+    DjiTest_FlightRecorderGetDefaultConfig(&recorderConfig);
+    recorderConfig.directory = flightContext->rootPath;
+    recorderConfig.prefix = DJI_BENCHMARK_FLIGHT_PREFIX;
+    if (chunkSize != 0) {
+        recorderConfig.chunkSize = chunkSize;
+    }
+
+    returnCode = DjiTest_FlightRecorderStart(&recorderConfig);
+    flightContext->isRecording = returnCode == DJI_ERROR_SYSTEM_MODULE_CODE_SUCCESS;
+
+    return returnCode;
+}
+
+/**
+ * @brief Record the store of the read cases, waiting for a free chunk instead of dropping so every record is there.
+ */
+static T_DjiReturnCode DjiBenchmark_FlightCreateStore(T_DjiBenchmarkFlightContext *flightContext)
+{
+    T_DjiTestFlightRecorderStatistics statistics;
+    T_DjiReturnCode returnCode;
+    uint32_t timestamp[2];
+    uint16_t channelId;
+    uint8_t index;
+    uint32_t i;
+
+    returnCode = DjiBenchmark_FlightStart(flightContext, DJI_BENCHMARK_FLIGHT_STORE_CHUNK_SIZE);
+    if (returnCode != DJI_ERROR_SYSTEM_MODULE_CODE_SUCCESS) {
+        return returnCode;
+    }
+
+    for (i = 0; i < DJI_BENCHMARK_FLIGHT_STORE_RECORD_NUM; i++) {
+        timestamp[0] = i;
+        timestamp[1] = i * 1000;
+        index = (uint8_t) i;
+
+        do {
+            if (i % DJI_BENCHMARK_FLIGHT_STORE_SPARSE_INTERVAL == 0) {
+                channelId = flightContext->channelIds[2];
+                returnCode = DjiTest_FlightRecorderWrite(channelId, 0, &index, sizeof(index), flightContext->data,
+                                                         flightContext->dataSize);
+            } else if (i % DJI_BENCHMARK_FLIGHT_STORE_DENSE_INTERVAL == 0) {
+                channelId = flightContext->channelIds[1];
+                returnCode = DjiTest_FlightRecorderWrite(channelId, i, NULL, 0, flightContext->data,
+                                                         flightContext->dataSize);
+            } else {
+                channelId = flightContext->channelIds[0];
+                returnCode = DjiTest_FlightRecorderWrite(channelId, timestamp[1], timestamp, sizeof(timestamp),
+                                                         flightContext->data, flightContext->dataSize);
+            }
+            if (returnCode == DJI_ERROR_SYSTEM_MODULE_CODE_BUSY) {
+                usleep(DJI_BENCHMARK_FLIGHT_BUSY_WAIT_US);
+            }
+        } while (returnCode == DJI_ERROR_SYSTEM_MODULE_CODE_BUSY);
+
+        if (returnCode != DJI_ERROR_SYSTEM_MODULE_CODE_SUCCESS) {
+            break;
+        }
+    }
+
+    DjiTest_FlightRecorderGetStatistics(&statistics);
+    if (DjiTest_FlightRecorderStop() != DJI_ERROR_SYSTEM_MODULE_CODE_SUCCESS &&
+        returnCode == DJI_ERROR_SYSTEM_MODULE_CODE_SUCCESS) {
+        returnCode = DJI_ERROR_SYSTEM_MODULE_CODE_SYSTEM_ERROR;
+    }
+    flightContext->isRecording = false;
+
+    if (returnCode != DJI_ERROR_SYSTEM_MODULE_CODE_SUCCESS) {
+        return returnCode;
+    }
+    if (statistics.writeErrorCount != 0 || !DjiBenchmark_FlightFindFile(flightContext)) {
+        return DJI_ERROR_SYSTEM_MODULE_CODE_SYSTEM_ERROR;
+    }
+
+    return DJI_ERROR_SYSTEM_MODULE_CODE_SUCCESS;
+}
+
+static T_DjiReturnCode DjiBenchmark_FlightRead(T_DjiBenchmarkFlightContext *flightContext)
+{
+    T_DjiTestFlightRecordReader reader;
+    T_DjiTestFlightRecordSample sample;
+    T_DjiReturnCode returnCode;
+    uint64_t expectedCount;
+    uint64_t readCount = 0;
+    uint16_t channelId;
+
+    returnCode = DjiTest_FlightRecordReaderOpen(&reader, flightContext->filePath);
+    if (returnCode != DJI_ERROR_SYSTEM_MODULE_CODE_SUCCESS) {
+        return returnCode;
+    }
+
+    switch (flightContext->mode) {
+        case DJI_BENCHMARK_FLIGHT_MODE_READ_SPARSE:
+            if (DjiTest_FlightRecordReaderFindChannel(&reader, s_flightChannelInfos[2].name, &channelId) !=
+                DJI_ERROR_SYSTEM_MODULE_CODE_SUCCESS) {
+                DjiTest_FlightRecordReaderClose(&reader);
+                return DJI_ERROR_SYSTEM_MODULE_CODE_NOT_FOUND;
+            }
+            DjiTest_FlightRecordReaderSetChannelMask(&reader, 1ULL << channelId);
+            expectedCount = DJI_BENCHMARK_FLIGHT_STORE_RECORD_NUM / DJI_BENCHMARK_FLIGHT_STORE_SPARSE_INTERVAL;
+            break;
+        case DJI_BENCHMARK_FLIGHT_MODE_READ_SEEK:
+            /* The middle of the record, the arrival times are those of the benchmark. */
+            DjiTest_FlightRecordReaderSeek(&reader, reader.chunks[reader.chunkCount / 2].startTimeUs);
+            expectedCount = DJI_BENCHMARK_FLIGHT_SEEK_RECORD_NUM;
+            break;
+        default:
+            expectedCount = DJI_BENCHMARK_FLIGHT_STORE_RECORD_NUM;
+            break;
+    }
+
+    while (readCount < expectedCount) {
+        returnCode = DjiTest_FlightRecordReaderReadNext(&reader, &sample);
+        if (returnCode != DJI_ERROR_SYSTEM_MODULE_CODE_SUCCESS) {
+            break;
+        }
+        readCount++;
+    }
+
+    /* All of the store must be read and nothing after it. */
+    if (returnCode == DJI_ERROR_SYSTEM_MODULE_CODE_SUCCESS &&
+        flightContext->mode != DJI_BENCHMARK_FLIGHT_MODE_READ_SEEK) {
+        returnCode = DjiTest_FlightRecordReaderReadNext(&reader, &sample) == DJI_ERROR_SYSTEM_MODULE_CODE_NOT_FOUND ?
+                     DJI_ERROR_SYSTEM_MODULE_CODE_SUCCESS : DJI_ERROR_SYSTEM_MODULE_CODE_SYSTEM_ERROR;
+    }
+    DjiTest_FlightRecordReaderClose(&reader);
+
+    if (returnCode != DJI_ERROR_SYSTEM_MODULE_CODE_SUCCESS || readCount != expectedCount) {
+        return DJI_ERROR_SYSTEM_MODULE_CODE_SYSTEM_ERROR;
+    }
+
+    return DJI_ERROR_SYSTEM_MODULE_CODE_SUCCESS;
+}
+
+/**
+ * @brief The recorder names the file by its start time, there is one file in the directory of a case.
+ */
+static bool DjiBenchmark_FlightFindFile(T_DjiBenchmarkFlightContext *flightContext)
+{
+    struct dirent *entry;
+    DIR *dir;
+    bool isFound = false;
+
+    dir = opendir(flightContext->rootPath);
+    if (dir == NULL) {
+        return false;
+    }
+
+    while ((entry = readdir(dir)) != NULL) {
+        if (strstr(entry->d_name, DJI_TEST_FLIGHT_RECORD_FILE_SUFFIX) != NULL) {
+            snprintf(flightContext->filePath, sizeof(flightContext->filePath), "%s/%s", flightContext->rootPath,
+                     entry->d_name);
+            isFound = true;
+            break;
+        }
+    }
+    closedir(dir);
+
+    return isFound;
+}
+
+/****************** (C) COPYRIGHT DJI Innovations *****END OF FILE****/
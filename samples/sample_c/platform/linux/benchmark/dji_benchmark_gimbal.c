@@ -0,0 +1,264 @@
+/**
+ ********************************************************************
+ * @file    dji_benchmark_gimbal.c
+ * @brief   Benchmark cases of the gimbal dynamics model driving the gimbal emulator.
+ *
+ * @copyright (c) 2021 DJI. All rights reserved.
+ *
+ * All information contained herein is, and remains, the property of DJI.
+ * The intellectual and technical concepts contained herein are proprietary
+ * to DJI and may be covered by U.S. and foreign patents, patents in process,
+ * and protected by trade secret or copyright law.  Dissemination of this
+ * information, including but not limited to data and other proprietary
+ * material(s) incorporated within the information, in any form, is strictly
+ * prohibited without the express written consent of DJI.
+ *
+ * If you receive this source code without DJI’s authorization, you may not
+ * further disseminate the information, and you must immediately remove the
+ * source code and notify DJI of its removal. DJI reserves the right to pursue
+ * legal actions against you for any loss(es) or damage(s) caused by your
+ * failure to do so.
+ *
+ *********************************************************************
+ */
+
+/* Includes ------------------------------------------------------------------*/
+#include "dji_benchmark.h"
+#include <math.h>
+#include <stdlib.h>
+#include <string.h>
+#include "utils/util_misc.h"
+#include "gimbal_emu/test_payload_gimbal_dynamics.h"
+
+/* Private constants ---------------------------------------------------------*/
+/* The gimbal emulator task steps the model at 100 Hz, the model controls at 1 kHz inside each step. */
+#define DJI_BENCHMARK_GIMBAL_TASK_STEP_TIME     (0.01f)
+#define DJI_BENCHMARK_GIMBAL_TRACK_STEP_NUM     (300)
+/* Settled once every measured axis stays within this band of the target, unit: degree. */
+#define DJI_BENCHMARK_GIMBAL_SETTLE_BAND        (0.5f)
+#define DJI_BENCHMARK_GIMBAL_SETTLE_TIME_MAX    (1.5f)
+#define DJI_BENCHMARK_GIMBAL_FINAL_ERROR_MAX    (0.2f)
+#define DJI_BENCHMARK_GIMBAL_OVERSHOOT_MAX      (0.5f)
+
+/* Private types -------------------------------------------------------------*/
+typedef struct {
+    T_DjiTestGimbalDynamicsHandle handle;
+} T_DjiBenchmarkGimbalContext;
+
+typedef struct {
+    float settleTime;               /*!< Unit: s. */
+    float finalError;               /*!< Largest ground truth error of an axis at the end, unit: degree. */
+    float overshoot;                /*!< Largest ground truth travel past the target, unit: degree. */
+    uint64_t digest;                /*!< Hash of every measured attitude, equal for equal trajectories. */
+} T_DjiBenchmarkGimbalTrackResult;
+
+/* Private functions declaration ---------------------------------------------*/
+static T_DjiReturnCode DjiBenchmark_GimbalSetup(const T_DjiBenchmarkConfig *config, void *param, void **context);
+static T_DjiReturnCode DjiBenchmark_GimbalTrackRun(void *context, uint32_t iterations);
+static void DjiBenchmark_GimbalTeardown(void *context);
+static T_DjiReturnCode DjiBenchmark_GimbalCheckDeterminism(void);
+static T_DjiReturnCode DjiBenchmark_GimbalTrack(T_DjiTestGimbalDynamicsHandle handle,
+                                                T_DjiBenchmarkGimbalTrackResult *result);
+static uint64_t DjiBenchmark_GimbalHashAttitude(uint64_t digest, const T_DjiAttitude3f *attitude);
+
+/* Private values ------------------------------------------------------------*/
+/* A step of every axis from level, the yaw step saturates the rate for half a second. */
+static const T_DjiAttitude3f s_gimbalTrackTarget = {-30.0f, 5.0f, 90.0f};
+
+/* Exported functions definition ---------------------------------------------*/
+T_DjiReturnCode DjiBenchmark_RunGimbalCases(const T_DjiBenchmarkConfig *config, FILE *output)
+{
+    T_DjiBenchmarkCase benchCase;
+
+    /* One operation is three seconds of the tracking loop of the emulator, 3000 control steps. The case fails when
+     * the default model settles too slowly, overshoots or keeps an error, and when the same seed does not give the
+     * same trajectory twice or another seed does. */
+    benchCase = (T_DjiBenchmarkCase) {
+        .name = "gimbal_dynamics/track_step", .bytesPerOp = 0,
+        .maxBatch = 1, .maxSamples = 0,
+        .Setup = DjiBenchmark_GimbalSetup, .Run = DjiBenchmark_GimbalTrackRun,
+        .Teardown = DjiBenchmark_GimbalTeardown, .param = NULL,
+    };
+    DjiBenchmark_RunCase(config, &benchCase, output);
+
+    return DJI_ERROR_SYSTEM_MODULE_CODE_SUCCESS;
+}
+
+/* Private functions definition-----------------------------------------------*/
+static T_DjiReturnCode DjiBenchmark_GimbalSetup(const T_DjiBenchmarkConfig *config, void *param, void **context)
+{
+    T_DjiBenchmarkGimbalContext *gimbalContext;
+    T_DjiTestGimbalDynamicsConfig dynamicsConfig;
+    T_DjiReturnCode returnCode;
+
+    USER_UTIL_UNUSED(config);
+    USER_UTIL_UNUSED(param);
+
+    returnCode = DjiBenchmark_GimbalCheckDeterminism();
+    if (returnCode != DJI_ERROR_SYSTEM_MODULE_CODE_SUCCESS) {
+        return returnCode;
+    }
+
+    gimbalContext = calloc(1, sizeof(T_DjiBenchmarkGimbalContext));
+    if (gimbalContext == NULL) {
+        return DJI_ERROR_SYSTEM_MODULE_CODE_MEMORY_ALLOC_FAILED;
+    }
+
+    DjiTest_GimbalDynamicsGetDefaultConfig(&dynamicsConfig);
+    returnCode = DjiTest_GimbalDynamicsCreate(&dynamicsConfig, &gimbalContext->handle);
+    if (returnCode != DJI_ERROR_SYSTEM_MODULE_CODE_SUCCESS) {
+        free(gimbalContext);
+        return returnCode;
+    }
+
+    *context = gimbalContext;
+
+    return DJI_ERROR_SYSTEM_MODULE_CODE_SUCCESS;
+}
+
+static T_DjiReturnCode DjiBenchmark_GimbalTrackRun(void *context, uint32_t iterations)
+{
+    T_DjiBenchmarkGimbalContext *gimbalContext = context;
+    T_DjiBenchmarkGimbalTrackResult result;
+    T_DjiReturnCode returnCode;
+    uint32_t i;
+
+    for (i = 0; i < iterations; i++) {
+        returnCode = DjiBenchmark_GimbalTrack(gimbalContext->handle, &result);
+        if (returnCode != DJI_ERROR_SYSTEM_MODULE_CODE_SUCCESS) {
+            return returnCode;
+        }
+        if (result.settleTime > DJI_BENCHMARK_GIMBAL_SETTLE_TIME_MAX ||
+            result.finalError > DJI_BENCHMARK_GIMBAL_FINAL_ERROR_MAX ||
+            result.overshoot > DJI_BENCHMARK_GIMBAL_OVERSHOOT_MAX) {
+            return DJI_ERROR_SYSTEM_MODULE_CODE_SYSTEM_ERROR;
+        }
+    }
+
+    return DJI_ERROR_SYSTEM_MODULE_CODE_SUCCESS;
+}
+
+static void DjiBenchmark_GimbalTeardown(void *context)
+{
+    T_DjiBenchmarkGimbalContext *gimbalContext = context;
+
+    if (gimbalContext == NULL) {
+        return;
+    }
+
+    DjiTest_GimbalDynamicsDestroy(gimbalContext->handle);
+    free(gimbalContext);
+}
+
+/**
+ * @brief Two models of the same seed follow bit identical trajectories, a third one of another seed does not.
+ */
+static T_DjiReturnCode DjiBenchmark_GimbalCheckDeterminism(void)
+{
+    T_DjiTestGimbalDynamicsConfig dynamicsConfig;
+    T_DjiTestGimbalDynamicsHandle handles[3] = {NULL};
+    T_DjiBenchmarkGimbalTrackResult results[3];
+    T_DjiReturnCode returnCode = DJI_ERROR_SYSTEM_MODULE_CODE_SUCCESS;
+    uint32_t i;
+
+    DjiTest_GimbalDynamicsGetDefaultConfig(&dynamicsConfig);
+    for (i = 0; i < 3 && returnCode == DJI_ERROR_SYSTEM_MODULE_CODE_SUCCESS; i++) {
+        dynamicsConfig.seed = i < 2 ? 1234 : 5678;
+        returnCode = DjiTest_GimbalDynamicsCreate(&dynamicsConfig, &handles[i]);
+        if (returnCode == DJI_ERROR_SYSTEM_MODULE_CODE_SUCCESS) {
+            returnCode = DjiBenchmark_GimbalTrack(handles[i], &results[i]);
+        }
+    }
+
+    if (returnCode == DJI_ERROR_SYSTEM_MODULE_CODE_SUCCESS &&
+        (results[0].digest != results[1].digest || results[0].digest == results[2].digest)) {
+        returnCode = DJI_ERROR_SYSTEM_MODULE_CODE_SYSTEM_ERROR;
+    }
+
+    for (i = 0; i < 3; i++) {
+        if (handles[i] != NULL) {
+            DjiTest_GimbalDynamicsDestroy(handles[i]);
+        }
+    }
+
+    return returnCode;
+}
+
+/**
+ * @brief Run the loop of the gimbal task from level to the target, the way the emulator steps and reads the model.
+ */
+static T_DjiReturnCode DjiBenchmark_GimbalTrack(T_DjiTestGimbalDynamicsHandle handle,
+                                                T_DjiBenchmarkGimbalTrackResult *result)
+{
+    T_DjiTestGimbalDynamicsCommand command = {0};
+    T_DjiTestGimbalDynamicsState state;
+    T_DjiAttitude3f level = {0};
+    T_DjiReturnCode returnCode;
+    float measuredError;
+    float error;
+    uint32_t i;
+
+    memset(result, 0, sizeof(T_DjiBenchmarkGimbalTrackResult));
+
+    returnCode = DjiTest_GimbalDynamicsReset(handle, &level);
+    if (returnCode != DJI_ERROR_SYSTEM_MODULE_CODE_SUCCESS) {
+        return returnCode;
+    }
+
+    command.type = DJI_TEST_GIMBAL_DYNAMICS_COMMAND_ANGLE;
+    command.value = s_gimbalTrackTarget;
+    returnCode = DjiTest_GimbalDynamicsCommand(handle, &command);
+    if (returnCode != DJI_ERROR_SYSTEM_MODULE_CODE_SUCCESS) {
+        return returnCode;
+    }
+
+    for (i = 0; i < DJI_BENCHMARK_GIMBAL_TRACK_STEP_NUM; i++) {
+        returnCode = DjiTest_GimbalDynamicsStep(handle, DJI_BENCHMARK_GIMBAL_TASK_STEP_TIME);
+        if (returnCode != DJI_ERROR_SYSTEM_MODULE_CODE_SUCCESS) {
+            return returnCode;
+        }
+        returnCode = DjiTest_GimbalDynamicsGetState(handle, &state);
+        if (returnCode != DJI_ERROR_SYSTEM_MODULE_CODE_SUCCESS) {
+            return returnCode;
+        }
+
+        measuredError = fmaxf(fabsf(state.measuredAttitude.pitch - s_gimbalTrackTarget.pitch),
+                              fmaxf(fabsf(state.measuredAttitude.roll - s_gimbalTrackTarget.roll),
+                                    fabsf(state.measuredAttitude.yaw - s_gimbalTrackTarget.yaw)));
+        if (measuredError > DJI_BENCHMARK_GIMBAL_SETTLE_BAND) {
+            result->settleTime = (float) (i + 1) * DJI_BENCHMARK_GIMBAL_TASK_STEP_TIME;
+        }
+
+        /* Travel past the target, the targets of pitch and yaw lie in opposite directions from level. */
+        error = fmaxf(s_gimbalTrackTarget.pitch - state.attitude.pitch,
+                      fmaxf(state.attitude.roll - s_gimbalTrackTarget.roll,
+                            state.attitude.yaw - s_gimbalTrackTarget.yaw));
+        result->overshoot = fmaxf(result->overshoot, error);
+
+        result->digest = DjiBenchmark_GimbalHashAttitude(result->digest, &state.measuredAttitude);
+    }
+
+    result->finalError = fmaxf(fabsf(state.attitude.pitch - s_gimbalTrackTarget.pitch),
+                               fmaxf(fabsf(state.attitude.roll - s_gimbalTrackTarget.roll),
+                                     fabsf(state.attitude.yaw - s_gimbalTrackTarget.yaw)));
+
+    return DJI_ERROR_SYSTEM_MODULE_CODE_SUCCESS;
+}
+
+static uint64_t DjiBenchmark_GimbalHashAttitude(uint64_t digest, const T_DjiAttitude3f *attitude)
+{
+    const uint8_t *bytes = (const uint8_t *) attitude;
+    uint32_t i;
+
+    /* FNV-1a over the bits, a difference in the last place of any reading changes it. */
+    if (digest == 0) {
+        digest = 0xCBF29CE484222325ULL;
+    }
+    for (i = 0; i < sizeof(T_DjiAttitude3f); i++) {
+        digest = (digest ^ bytes[i]) * 0x100000001B3ULL;
+    }
+
+    return digest;
+}
+
+/****************** (C) COPYRIGHT DJI Innovations *****END OF FILE****/
@@ -0,0 +1,232 @@
+/**
+ ********************************************************************
+ * @file    dji_benchmark_kmz.c
+ * @brief   Benchmark cases of the waypoint v3 kmz validator and builder.
+ *
+ * @copyright (c) 2021 DJI. All rights reserved.
+ *
+ * All information contained herein is, and remains, the property of DJI.
+ * The intellectual and technical concepts contained herein are proprietary
+ * to DJI and may be covered by U.S. and foreign patents, patents in process,
+ * and protected by trade secret or copyright law.  Dissemination of this
+ * information, including but not limited to data and other proprietary
+ * material(s) incorporated within the information, in any form, is strictly
+ * prohibited without the express written consent of DJI.
+ *
+ * If you receive this source code without DJI’s authorization, you may not
+ * further disseminate the information, and you must immediately remove the
+ * source code and notify DJI of its removal. DJI reserves the right to pursue
+ * legal actions against you for any loss(es) or damage(s) caused by your
+ * failure to do so.
+ *
+ *********************************************************************
+ */
+
+
+/* Includes ------------------------------------------------------------------*/
+#include "dji_benchmark.h"
+#include <stdlib.h>
+#include <string.h>
+#include "waypoint_v3/test_waypoint_v3_kmz.h"
+
+/* Private constants ---------------------------------------------------------*/
+#define DJI_BENCHMARK_KMZ_LONGITUDE             113.94255
+#define DJI_BENCHMARK_KMZ_LATITUDE              22.57765
+#define DJI_BENCHMARK_KMZ_LINE_WIDTH_DEGREE     0.002
+#define DJI_BENCHMARK_KMZ_LINE_SPACING_DEGREE   0.0002
+#define DJI_BENCHMARK_KMZ_PHOTO_INTERVAL        5
+#define DJI_BENCHMARK_KMZ_LARGE_MAX_SAMPLES     20
+
+/* Private types -------------------------------------------------------------*/
+typedef struct {
+    uint32_t waypointNum;
+    bool isCompressed;
+} T_DjiBenchmarkKmzParam;
+
+typedef struct {
+    T_DjiTestKmzBuilder *builder;
+    T_DjiTestKmzWaypoint *waypoints;
+    T_DjiTestKmzAction *actions;
+    T_DjiTestKmzMission mission;
+} T_DjiBenchmarkKmzContext;
+
+/* Private functions declaration ---------------------------------------------*/
+static T_DjiReturnCode DjiBenchmark_KmzSetup(const T_DjiBenchmarkConfig *config, void *param, void **context);
+static T_DjiReturnCode DjiBenchmark_KmzValidate(void *context, uint32_t iterations);
+static T_DjiReturnCode DjiBenchmark_KmzBuild(void *context, uint32_t iterations);
+static void DjiBenchmark_KmzTeardown(void *context);
+
+/* Private values ------------------------------------------------------------*/
+static const T_DjiBenchmarkKmzParam s_kmzValidateParam = {10000, false};
+static const T_DjiBenchmarkKmzParam s_kmzStoredParam = {10000, false};
+static const T_DjiBenchmarkKmzParam s_kmzDeflateParam = {10000, true};
+static const T_DjiBenchmarkKmzParam s_kmzLargeDeflateParam = {50000, true};
+
+/* Exported functions definition ---------------------------------------------*/
+T_DjiReturnCode DjiBenchmark_RunKmzCases(const T_DjiBenchmarkConfig *config, FILE *output)
+{
+    T_DjiBenchmarkCase benchCase;
+
+    benchCase = (T_DjiBenchmarkCase) {
+        .name = "kmz/validate/10000", .Setup = DjiBenchmark_KmzSetup, .Run = DjiBenchmark_KmzValidate,
+        .Teardown = DjiBenchmark_KmzTeardown, .param = (void *) &s_kmzValidateParam,
+    };
+    DjiBenchmark_RunCase(config, &benchCase, output);
+
+    /* A build writes both documents of the kmz, megabytes of xml, so every build is timed on its own. */
+    benchCase.name = "kmz/build_stored/10000";
+    benchCase.Run = DjiBenchmark_KmzBuild;
+    benchCase.maxBatch = 1;
+    benchCase.param = (void *) &s_kmzStoredParam;
+    DjiBenchmark_RunCase(config, &benchCase, output);
+
+    benchCase.name = "kmz/build_deflate/10000";
+    benchCase.param = (void *) &s_kmzDeflateParam;
+    DjiBenchmark_RunCase(config, &benchCase, output);
+
+    benchCase.name = "kmz/build_deflate/50000";
+    benchCase.maxSamples = DJI_BENCHMARK_KMZ_LARGE_MAX_SAMPLES;
+    benchCase.param = (void *) &s_kmzLargeDeflateParam;
+    DjiBenchmark_RunCase(config, &benchCase, output);
+
+    return DJI_ERROR_SYSTEM_MODULE_CODE_SUCCESS;
+}
+
+/* Private functions definition-----------------------------------------------*/
+/**
+ * @brief Survey of short lines joined by coordinate turns, with a photo every few waypoints and a recording.
+ */
+static T_DjiReturnCode DjiBenchmark_KmzSetup(const T_DjiBenchmarkConfig *config, void *param, void **context)
+{
+    const T_DjiBenchmarkKmzParam *kmzParam = param;
+    T_DjiBenchmarkKmzContext *kmzContext;
+    T_DjiTestKmzBuilderConfig builderConfig;
+    T_DjiTestKmzWaypoint *waypoint;
+    T_DjiTestKmzAction *action;
+    uint32_t actionNum = 0;
+    uint32_t i;
+
+    (void) config;
+
+    kmzContext = calloc(1, sizeof(T_DjiBenchmarkKmzContext));
+    if (kmzContext == NULL) {
+        return DJI_ERROR_SYSTEM_MODULE_CODE_MEMORY_ALLOC_FAILED;
+    }
+
+    kmzContext->builder = calloc(1, sizeof(T_DjiTestKmzBuilder));
+    kmzContext->waypoints = calloc(kmzParam->waypointNum, sizeof(T_DjiTestKmzWaypoint));
+    kmzContext->actions = calloc(kmzParam->waypointNum / DJI_BENCHMARK_KMZ_PHOTO_INTERVAL + 2,
+                                 sizeof(T_DjiTestKmzAction));
+    if (kmzContext->builder == NULL || kmzContext->waypoints == NULL || kmzContext->actions == NULL) {
+        DjiBenchmark_KmzTeardown(kmzContext);
+        return DJI_ERROR_SYSTEM_MODULE_CODE_MEMORY_ALLOC_FAILED;
+    }
+
+    for (i = 0; i < kmzParam->waypointNum; i++) {
+        waypoint = &kmzContext->waypoints[i];
+        waypoint->latitude = DJI_BENCHMARK_KMZ_LATITUDE + (i / 2) * DJI_BENCHMARK_KMZ_LINE_SPACING_DEGREE;
+        waypoint->longitude = DJI_BENCHMARK_KMZ_LONGITUDE +
+                              ((i % 2) != ((i / 2) % 2) ? DJI_BENCHMARK_KMZ_LINE_WIDTH_DEGREE : 0);
+        waypoint->height = 60.0f + (dji_f32_t) (i % 3);
+        waypoint->speed = (i % 4) == 0 ? 0 : 7.5f;
+        waypoint->headingMode = DJI_TEST_KMZ_HEADING_MODE_FOLLOW_WAYLINE;
+        waypoint->turnMode = DJI_TEST_KMZ_TURN_MODE_COORDINATE_TURN;
+        waypoint->turnDampingDist = 5.0f;
+
+        action = &kmzContext->actions[actionNum];
+        action->waypointIndex = i;
+        if (i == 0) {
+            action->type = DJI_TEST_KMZ_ACTION_START_RECORD;
+            actionNum++;
+        } else if (i + 1 == kmzParam->waypointNum) {
+            action->type = DJI_TEST_KMZ_ACTION_STOP_RECORD;
+            actionNum++;
+        } else if (i % DJI_BENCHMARK_KMZ_PHOTO_INTERVAL == 0) {
+            action->type = DJI_TEST_KMZ_ACTION_TAKE_PHOTO;
+            snprintf(action->fileSuffix, sizeof(action->fileSuffix), "wp%u", i);
+            actionNum++;
+        }
+    }
+    kmzContext->waypoints[0].turnMode = DJI_TEST_KMZ_TURN_MODE_STOP_WITH_DISCONTINUITY_CURVATURE;
+    kmzContext->waypoints[kmzParam->waypointNum - 1].turnMode =
+        DJI_TEST_KMZ_TURN_MODE_STOP_WITH_DISCONTINUITY_CURVATURE;
+
+    kmzContext->mission.finishAction = DJI_TEST_KMZ_FINISH_ACTION_GO_HOME;
+    kmzContext->mission.rcLostAction = DJI_TEST_KMZ_RC_LOST_ACTION_GO_BACK;
+    kmzContext->mission.takeOffSecurityHeight = 20.0f;
+    kmzContext->mission.globalTransitionalSpeed = 10.0f;
+    kmzContext->mission.autoFlightSpeed = 5.0f;
+    kmzContext->mission.droneEnumValue = 77;
+    kmzContext->mission.payloadEnumValue = 66;
+    kmzContext->mission.waypoints = kmzContext->waypoints;
+    kmzContext->mission.waypointNum = kmzParam->waypointNum;
+    kmzContext->mission.actions = kmzContext->actions;
+    kmzContext->mission.actionNum = actionNum;
+
+    DjiTest_KmzBuilderGetDefaultConfig(&builderConfig);
+    builderConfig.isCompressed = kmzParam->isCompressed;
+    if (DjiTest_KmzBuilderInit(kmzContext->builder, &builderConfig) != DJI_ERROR_SYSTEM_MODULE_CODE_SUCCESS) {
+        free(kmzContext->builder);
+        kmzContext->builder = NULL;
+        DjiBenchmark_KmzTeardown(kmzContext);
+        return DJI_ERROR_SYSTEM_MODULE_CODE_SYSTEM_ERROR;
+    }
+
+    *context = kmzContext;
+
+    return DJI_ERROR_SYSTEM_MODULE_CODE_SUCCESS;
+}
+
+static T_DjiReturnCode DjiBenchmark_KmzValidate(void *context, uint32_t iterations)
+{
+    T_DjiBenchmarkKmzContext *kmzContext = context;
+    T_DjiTestKmzValidateResult result;
+    T_DjiReturnCode returnCode;
+    uint32_t i;
+
+    for (i = 0; i < iterations; i++) {
+        returnCode = DjiTest_KmzValidateMission(&kmzContext->mission, &kmzContext->builder->config.limits, &result);
+        if (returnCode != DJI_ERROR_SYSTEM_MODULE_CODE_SUCCESS) {
+            return returnCode;
+        }
+    }
+
+    return DJI_ERROR_SYSTEM_MODULE_CODE_SUCCESS;
+}
+
+static T_DjiReturnCode DjiBenchmark_KmzBuild(void *context, uint32_t iterations)
+{
+    T_DjiBenchmarkKmzContext *kmzContext = context;
+    const uint8_t *kmzData;
+    uint32_t kmzSize;
+    T_DjiReturnCode returnCode;
+    uint32_t i;
+
+    for (i = 0; i < iterations; i++) {
+        returnCode = DjiTest_KmzBuilderBuild(kmzContext->builder, &kmzContext->mission, &kmzData, &kmzSize, NULL);
+        if (returnCode != DJI_ERROR_SYSTEM_MODULE_CODE_SUCCESS) {
+            return returnCode;
+        }
+    }
+
+    return DJI_ERROR_SYSTEM_MODULE_CODE_SUCCESS;
+}
+
+static void DjiBenchmark_KmzTeardown(void *context)
+{
+    T_DjiBenchmarkKmzContext *kmzContext = context;
+
+    if (kmzContext == NULL) {
+        return;
+    }
+
+    if (kmzContext->builder != NULL) {
+        DjiTest_KmzBuilderDeInit(kmzContext->builder);
+        free(kmzContext->builder);
+    }
+    free(kmzContext->waypoints);
+    free(kmzContext->actions);
+    free(kmzContext);
+}
+
+/****************** (C) COPYRIGHT DJI Innovations *****END OF FILE****/
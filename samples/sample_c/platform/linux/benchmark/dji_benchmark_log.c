@@ -0,0 +1,462 @@
+/**
+ ********************************************************************
+ * @file    dji_benchmark_log.c
+ * @brief   Benchmark cases of writing and querying the compressed log storage.
+ *
+ * @copyright (c) 2021 DJI. All rights reserved.
+ *
+ * All information contained herein is, and remains, the property of DJI.
+ * The intellectual and technical concepts contained herein are proprietary
+ * to DJI and may be covered by U.S. and foreign patents, patents in process,
+ * and protected by trade secret or copyright law.  Dissemination of this
+ * information, including but not limited to data and other proprietary
+ * material(s) incorporated within the information, in any form, is strictly
+ * prohibited without the express written consent of DJI.
+ *
+ * If you receive this source code without DJI’s authorization, you may not
+ * further disseminate the information, and you must immediately remove the
+ * source code and notify DJI of its removal. DJI reserves the right to pursue
+ * legal actions against you for any loss(es) or damage(s) caused by your
+ * failure to do so.
+ *
+ *********************************************************************
+ */
+
+/* Includes ------------------------------------------------------------------*/
+#include "dji_benchmark.h"
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <sys/stat.h>
+#include "utils/util_misc.h"
+#include "logger/test_log_storage.h"
+
+/* Private constants ---------------------------------------------------------*/
+#define DJI_BENCHMARK_LOG_PATH_MAX_LEN          (DJI_TEST_LOG_STORAGE_PATH_MAX_SIZE)
+#define DJI_BENCHMARK_LOG_PREFIX                "BENCH"
+#define DJI_BENCHMARK_LOG_LINE_NUM              (256)
+#define DJI_BENCHMARK_LOG_LINE_MAX_SIZE         (160)
+/* The queried store holds a flight of 400000 lines, one every 10 ms. */
+#define DJI_BENCHMARK_LOG_STORE_LINE_NUM        (400000)
+#define DJI_BENCHMARK_LOG_STORE_START_MS        (1700000000000ULL)
+#define DJI_BENCHMARK_LOG_STORE_INTERVAL_MS     (10)
+#define DJI_BENCHMARK_LOG_STORE_SEGMENT_SIZE    (4 * 1024 * 1024)
+/* Errors come in bursts, one every this many lines. */
+#define DJI_BENCHMARK_LOG_INCIDENT_INTERVAL     (50000)
+#define DJI_BENCHMARK_LOG_INCIDENT_LINE_NUM     (16)
+#define DJI_BENCHMARK_LOG_ERROR_LINE_NUM        \
+    (DJI_BENCHMARK_LOG_STORE_LINE_NUM / DJI_BENCHMARK_LOG_INCIDENT_INTERVAL * DJI_BENCHMARK_LOG_INCIDENT_LINE_NUM)
+/* One minute in the middle of the flight. */
+#define DJI_BENCHMARK_LOG_RANGE_LINE_NUM        (6000)
+#define DJI_BENCHMARK_LOG_RANGE_START_LINE      (DJI_BENCHMARK_LOG_STORE_LINE_NUM / 2 + 1234)
+
+/* Private types -------------------------------------------------------------*/
+typedef enum {
+    DJI_BENCHMARK_LOG_MODE_WRITE_STDIO = 0,     /*!< fwrite and fflush of every line to one text file. */
+    DJI_BENCHMARK_LOG_MODE_WRITE_STORAGE,       /*!< Lines through the logger console of the storage. */
+    DJI_BENCHMARK_LOG_MODE_QUERY_ERROR,         /*!< Error lines of the whole store. */
+    DJI_BENCHMARK_LOG_MODE_QUERY_RANGE,         /*!< All lines of one minute. */
+    DJI_BENCHMARK_LOG_MODE_QUERY_SCAN,          /*!< Keyword found nowhere, every block is decoded. */
+    DJI_BENCHMARK_LOG_MODE_QUERY_RECOVER,       /*!< All lines, the last index file cut short as by a crash. */
+} E_DjiBenchmarkLogMode;
+
+typedef struct {
+    E_DjiBenchmarkLogMode mode;
+    char rootPath[DJI_BENCHMARK_LOG_PATH_MAX_LEN];
+    char filePath[DJI_BENCHMARK_LOG_PATH_MAX_LEN + 16];
+    FILE *file;
+    T_DjiTestLogStorage storage;
+    bool isStorageOpened;
+    char lines[DJI_BENCHMARK_LOG_LINE_NUM][DJI_BENCHMARK_LOG_LINE_MAX_SIZE];
+    uint32_t lineLens[DJI_BENCHMARK_LOG_LINE_NUM];
+    uint32_t lineIndex;
+    uint32_t cutEntryCount;                     /*!< Index entries removed, the query finds their blocks by scanning. */
+} T_DjiBenchmarkLogContext;
+
+/* Private functions declaration ---------------------------------------------*/
+static T_DjiReturnCode DjiBenchmark_LogSetup(const T_DjiBenchmarkConfig *config, void *param, void **context);
+static T_DjiReturnCode DjiBenchmark_LogRun(void *context, uint32_t iterations);
+static void DjiBenchmark_LogTeardown(void *context);
+static T_DjiReturnCode DjiBenchmark_LogCreateStore(T_DjiBenchmarkLogContext *logContext);
+static T_DjiReturnCode DjiBenchmark_LogCutIndex(T_DjiBenchmarkLogContext *logContext);
+static T_DjiReturnCode DjiBenchmark_LogQuery(T_DjiBenchmarkLogContext *logContext);
+static T_DjiReturnCode DjiBenchmark_LogCountLine(void *userData, uint64_t timeMs, uint8_t level, const char *line,
+                                                 uint32_t len);
+static uint32_t DjiBenchmark_LogFormatLine(char *line, uint32_t size, uint32_t index, uint8_t level, bool isColored);
+
+/* Private values ------------------------------------------------------------*/
+static const E_DjiBenchmarkLogMode s_logWriteStdioMode = DJI_BENCHMARK_LOG_MODE_WRITE_STDIO;
+static const E_DjiBenchmarkLogMode s_logWriteStorageMode = DJI_BENCHMARK_LOG_MODE_WRITE_STORAGE;
+static const E_DjiBenchmarkLogMode s_logQueryErrorMode = DJI_BENCHMARK_LOG_MODE_QUERY_ERROR;
+static const E_DjiBenchmarkLogMode s_logQueryRangeMode = DJI_BENCHMARK_LOG_MODE_QUERY_RANGE;
+static const E_DjiBenchmarkLogMode s_logQueryScanMode = DJI_BENCHMARK_LOG_MODE_QUERY_SCAN;
+static const E_DjiBenchmarkLogMode s_logQueryRecoverMode = DJI_BENCHMARK_LOG_MODE_QUERY_RECOVER;
+static const char *s_logLevelNames[DJI_TEST_LOG_STORAGE_LEVEL_NUM] = {"Error", "Warn", "Info", "Debug"};
+static const char *s_logLevelColors[DJI_TEST_LOG_STORAGE_LEVEL_NUM] = {
+    "\033[31;1m", "\033[33;1m", "\033[32;1m", "\033[36;1m"
+};
+
+/* Exported functions definition ---------------------------------------------*/
+T_DjiReturnCode DjiBenchmark_RunLogCases(const T_DjiBenchmarkConfig *config, FILE *output)
+{
+    T_DjiBenchmarkCase benchCase;
+
+    /* One operation writes one colored line of about 100 bytes, the way DjiUser_LocalWrite did before the storage. */
+    benchCase = (T_DjiBenchmarkCase) {
+        .name = "log/write/stdio", .bytesPerOp = 100,
+        .maxBatch = 4096, .maxSamples = 0,
+        .Setup = DjiBenchmark_LogSetup, .Run = DjiBenchmark_LogRun,
+        .Teardown = DjiBenchmark_LogTeardown, .param = (void *) &s_logWriteStdioMode,
+    };
+    DjiBenchmark_RunCase(config, &benchCase, output);
+
+    /* Includes stripping the color codes and the compression of the sealed blocks. */
+    benchCase.name = "log/write/storage";
+    benchCase.param = (void *) &s_logWriteStorageMode;
+    DjiBenchmark_RunCase(config, &benchCase, output);
+
+    /* One operation queries a store of 400000 lines, about 40 MB of text. The cases fail when the number of lines
+     * found is wrong, the error and range cases also when they decode more than a tenth of the blocks. */
+    benchCase.name = "log/query/error";
+    benchCase.bytesPerOp = 0;
+    benchCase.maxBatch = 1;
+    benchCase.maxSamples = 10;
+    benchCase.param = (void *) &s_logQueryErrorMode;
+    DjiBenchmark_RunCase(config, &benchCase, output);
+
+    benchCase.name = "log/query/range";
+    benchCase.param = (void *) &s_logQueryRangeMode;
+    DjiBenchmark_RunCase(config, &benchCase, output);
+
+    benchCase.name = "log/query/scan";
+    benchCase.param = (void *) &s_logQueryScanMode;
+    DjiBenchmark_RunCase(config, &benchCase, output);
+
+    /* Fails unless every line is found and the blocks missing in the index are exactly those recovered. */
+    benchCase.name = "log/query/recover";
+    benchCase.param = (void *) &s_logQueryRecoverMode;
+    DjiBenchmark_RunCase(config, &benchCase, output);
+
+    return DJI_ERROR_SYSTEM_MODULE_CODE_SUCCESS;
+}
+
+/* Private functions definition-----------------------------------------------*/
+static T_DjiReturnCode DjiBenchmark_LogSetup(const T_DjiBenchmarkConfig *config, void *param, void **context)
+{
+    T_DjiBenchmarkLogContext *logContext;
+    T_DjiTestLogStorageConfig storageConfig;
+    T_DjiReturnCode returnCode = DJI_ERROR_SYSTEM_MODULE_CODE_SUCCESS;
+    uint32_t i;
+
+    logContext = calloc(1, sizeof(T_DjiBenchmarkLogContext));
+    if (logContext == NULL) {
+        return DJI_ERROR_SYSTEM_MODULE_CODE_MEMORY_ALLOC_FAILED;
+    }
+    logContext->mode = *(const E_DjiBenchmarkLogMode *) param;
+
+    snprintf(logContext->rootPath, sizeof(logContext->rootPath), "%s/dji_benchmark_XXXXXX", config->tmpDir);
+    if (mkdtemp(logContext->rootPath) == NULL) {
+        free(logContext);
+        return DJI_ERROR_SYSTEM_MODULE_CODE_SYSTEM_ERROR;
+    }
+
+    /* A flight log is mostly debug and info lines. */
+    for (i = 0; i < DJI_BENCHMARK_LOG_LINE_NUM; i++) {
+        logContext->lineLens[i] = DjiBenchmark_LogFormatLine(logContext->lines[i], DJI_BENCHMARK_LOG_LINE_MAX_SIZE, i,
+                                                             i % 64 == 0 ? DJI_LOGGER_CONSOLE_LOG_LEVEL_WARN :
+                                                             i % 2 == 0 ? DJI_LOGGER_CONSOLE_LOG_LEVEL_INFO :
+                                                             DJI_LOGGER_CONSOLE_LOG_LEVEL_DEBUG, true);
+    }
+
+    switch (logContext->mode) {
+        case DJI_BENCHMARK_LOG_MODE_WRITE_STDIO:
+            snprintf(logContext->filePath, sizeof(logContext->filePath), "%s/bench.log", logContext->rootPath);
+            logContext->file = fopen(logContext->filePath, "w+");
+            if (logContext->file == NULL) {
+                returnCode = DJI_ERROR_SYSTEM_MODULE_CODE_SYSTEM_ERROR;
+            }
+            break;
+        case DJI_BENCHMARK_LOG_MODE_WRITE_STORAGE:
+            DjiTest_LogStorageGetDefaultConfig(&storageConfig);
+            storageConfig.directory = logContext->rootPath;
+            storageConfig.prefix = DJI_BENCHMARK_LOG_PREFIX;
+            returnCode = DjiTest_LogStorageOpen(&logContext->storage, &storageConfig);
+            logContext->isStorageOpened = returnCode == DJI_ERROR_SYSTEM_MODULE_CODE_SUCCESS;
+            break;
+        default:
+            returnCode = DjiBenchmark_LogCreateStore(logContext);
+            if (returnCode == DJI_ERROR_SYSTEM_MODULE_CODE_SUCCESS &&
+                logContext->mode == DJI_BENCHMARK_LOG_MODE_QUERY_RECOVER) {
+                returnCode = DjiBenchmark_LogCutIndex(logContext);
+            }
+            break;
+    }
+
+    *context = logContext;
+
+    return returnCode;
+}
+
+static T_DjiReturnCode DjiBenchmark_LogRun(void *context, uint32_t iterations)
+{
+    T_DjiBenchmarkLogContext *logContext = context;
+    T_DjiReturnCode returnCode;
+    uint32_t index;
+    uint32_t i;
+
+    for (i = 0; i < iterations; i++) {
+        index = logContext->lineIndex++ % DJI_BENCHMARK_LOG_LINE_NUM;
+
+        switch (logContext->mode) {
+            case DJI_BENCHMARK_LOG_MODE_WRITE_STDIO:
+                if (fwrite(logContext->lines[index], 1, logContext->lineLens[index], logContext->file) !=
+                    logContext->lineLens[index]) {
+                    return DJI_ERROR_SYSTEM_MODULE_CODE_SYSTEM_ERROR;
+                }
+                fflush(logContext->file);
+                break;
+            case DJI_BENCHMARK_LOG_MODE_WRITE_STORAGE:
+                returnCode = DjiTest_LogStorageWrite(&logContext->storage, (const uint8_t *) logContext->lines[index],
+                                                     logContext->lineLens[index]);
+                if (returnCode != DJI_ERROR_SYSTEM_MODULE_CODE_SUCCESS) {
+                    return returnCode;
+                }
+                break;
+            default:
+                returnCode = DjiBenchmark_LogQuery(logContext);
+                if (returnCode != DJI_ERROR_SYSTEM_MODULE_CODE_SUCCESS) {
+                    return returnCode;
+                }
+                break;
+        }
+    }
+
+    return DJI_ERROR_SYSTEM_MODULE_CODE_SUCCESS;
+}
+
+static void DjiBenchmark_LogTeardown(void *context)
+{
+    T_DjiBenchmarkLogContext *logContext = context;
+    T_DjiTestLogSegment *segments;
+    char path[DJI_BENCHMARK_LOG_PATH_MAX_LEN + DJI_TEST_LOG_STORAGE_NAME_MAX_SIZE + 8];
+    uint32_t count = 0;
+    uint32_t i;
+
+    if (logContext == NULL) {
+        return;
+    }
+
+    if (logContext->file != NULL) {
+        fclose(logContext->file);
+        remove(logContext->filePath);
+    }
+    if (logContext->isStorageOpened) {
+        DjiTest_LogStorageClose(&logContext->storage);
+    }
+
+    segments = malloc(DJI_TEST_LOG_STORAGE_SEGMENT_MAX_NUM * sizeof(T_DjiTestLogSegment));
+    if (segments != NULL &&
+        DjiTest_LogStorageListSegments(logContext->rootPath, DJI_BENCHMARK_LOG_PREFIX, segments,
+                                       DJI_TEST_LOG_STORAGE_SEGMENT_MAX_NUM, &count) ==
+        DJI_ERROR_SYSTEM_MODULE_CODE_SUCCESS) {
+        for (i = 0; i < count; i++) {
+            snprintf(path, sizeof(path), "%s/%s%s", logContext->rootPath, segments[i].name,
+                     DJI_TEST_LOG_STORAGE_SEGMENT_SUFFIX);
+            remove(path);
+            snprintf(path, sizeof(path), "%s/%s%s", logContext->rootPath, segments[i].name,
+                     DJI_TEST_LOG_STORAGE_INDEX_SUFFIX);
+            remove(path);
+        }
+    }
+    free(segments);
+
+    rmdir(logContext->rootPath);
+    free(logContext);
+}
+
+/**
+ * @brief Write the store of the query cases with the times of a flight instead of the clock of the benchmark.
+ */
+static T_DjiReturnCode DjiBenchmark_LogCreateStore(T_DjiBenchmarkLogContext *logContext)
+{
+    T_DjiTestLogStorageConfig storageConfig;
+    T_DjiReturnCode returnCode;
+    char line[DJI_BENCHMARK_LOG_LINE_MAX_SIZE];
+    uint32_t lineLen;
+    uint8_t level;
+    uint32_t i;
+
+    DjiTest_LogStorageGetDefaultConfig(&storageConfig);
+    storageConfig.directory = logContext->rootPath;
+    storageConfig.prefix = DJI_BENCHMARK_LOG_PREFIX;
+    storageConfig.segmentMaxSize = DJI_BENCHMARK_LOG_STORE_SEGMENT_SIZE;
+    storageConfig.segmentMaxDurationS = 0;
+    storageConfig.maxTotalSize = 0;
+    storageConfig.maxAgeS = 0;
+    /* Error bursts stay in shared blocks, so the level index has blocks to skip. */
+    storageConfig.isSealOnError = false;
+
+    returnCode = DjiTest_LogStorageOpen(&logContext->storage, &storageConfig);
+    if (returnCode != DJI_ERROR_SYSTEM_MODULE_CODE_SUCCESS) {
+        return returnCode;
+    }
+
+    for (i = 0; i < DJI_BENCHMARK_LOG_STORE_LINE_NUM; i++) {
+        if (i % DJI_BENCHMARK_LOG_INCIDENT_INTERVAL >=
+            DJI_BENCHMARK_LOG_INCIDENT_INTERVAL - DJI_BENCHMARK_LOG_INCIDENT_LINE_NUM) {
+            level = DJI_LOGGER_CONSOLE_LOG_LEVEL_ERROR;
+        } else if (i % 64 == 0) {
+            level = DJI_LOGGER_CONSOLE_LOG_LEVEL_WARN;
+        } else {
+            level = i % 2 == 0 ? DJI_LOGGER_CONSOLE_LOG_LEVEL_INFO : DJI_LOGGER_CONSOLE_LOG_LEVEL_DEBUG;
+        }
+        lineLen = DjiBenchmark_LogFormatLine(line, sizeof(line), i, level, false);
+
+        returnCode = DjiTest_LogStorageWriteLine(&logContext->storage, DJI_BENCHMARK_LOG_STORE_START_MS +
+                                                 (uint64_t) i * DJI_BENCHMARK_LOG_STORE_INTERVAL_MS,
+                                                 level, line, lineLen);
+        if (returnCode != DJI_ERROR_SYSTEM_MODULE_CODE_SUCCESS) {
+            break;
+        }
+    }
+
+    if (DjiTest_LogStorageClose(&logContext->storage) != DJI_ERROR_SYSTEM_MODULE_CODE_SUCCESS &&
+        returnCode == DJI_ERROR_SYSTEM_MODULE_CODE_SUCCESS) {
+        returnCode = DJI_ERROR_SYSTEM_MODULE_CODE_SYSTEM_ERROR;
+    }
+
+    return returnCode;
+}
+
+/**
+ * @brief Cut the index file of the last segment to half its entries and a torn one, the way a crash leaves it.
+ */
+static T_DjiReturnCode DjiBenchmark_LogCutIndex(T_DjiBenchmarkLogContext *logContext)
+{
+    T_DjiTestLogSegment *segments;
+    T_DjiReturnCode returnCode;
+    char path[DJI_BENCHMARK_LOG_PATH_MAX_LEN + DJI_TEST_LOG_STORAGE_NAME_MAX_SIZE + 8];
+    struct stat fileStat;
+    uint32_t count = 0;
+    uint32_t entryCount;
+
+    segments = malloc(DJI_TEST_LOG_STORAGE_SEGMENT_MAX_NUM * sizeof(T_DjiTestLogSegment));
+    if (segments == NULL) {
+        return DJI_ERROR_SYSTEM_MODULE_CODE_MEMORY_ALLOC_FAILED;
+    }
+
+    returnCode = DjiTest_LogStorageListSegments(logContext->rootPath, DJI_BENCHMARK_LOG_PREFIX, segments,
+                                                DJI_TEST_LOG_STORAGE_SEGMENT_MAX_NUM, &count);
+    if (returnCode != DJI_ERROR_SYSTEM_MODULE_CODE_SUCCESS || count == 0) {
+        returnCode = DJI_ERROR_SYSTEM_MODULE_CODE_SYSTEM_ERROR;
+        goto FreeSegments;
+    }
+
+    snprintf(path, sizeof(path), "%s/%s%s", logContext->rootPath, segments[count - 1].name,
+             DJI_TEST_LOG_STORAGE_INDEX_SUFFIX);
+    if (stat(path, &fileStat) != 0) {
+        returnCode = DJI_ERROR_SYSTEM_MODULE_CODE_SYSTEM_ERROR;
+        goto FreeSegments;
+    }
+
+    /* Whole entries are removed from the end, the file header in front of them stays intact. */
+    entryCount = (uint32_t) (fileStat.st_size / sizeof(T_DjiTestLogIndexEntry));
+    logContext->cutEntryCount = entryCount / 2;
+    if (logContext->cutEntryCount == 0 ||
+        truncate(path, fileStat.st_size - (off_t) (logContext->cutEntryCount * sizeof(T_DjiTestLogIndexEntry)) +
+                       (off_t) (sizeof(T_DjiTestLogIndexEntry) / 2)) != 0) {
+        returnCode = DJI_ERROR_SYSTEM_MODULE_CODE_SYSTEM_ERROR;
+    }
+
+FreeSegments:
+    free(segments);
+
+    return returnCode;
+}
+
+static T_DjiReturnCode DjiBenchmark_LogQuery(T_DjiBenchmarkLogContext *logContext)
+{
+    T_DjiTestLogQuery query = {0};
+    T_DjiTestLogQueryStatistics statistics;
+    T_DjiReturnCode returnCode;
+    uint64_t expectedCount;
+    bool isSelective = true;
+
+    query.maxLevel = DJI_LOGGER_CONSOLE_LOG_LEVEL_DEBUG;
+
+    switch (logContext->mode) {
+        case DJI_BENCHMARK_LOG_MODE_QUERY_ERROR:
+            query.maxLevel = DJI_LOGGER_CONSOLE_LOG_LEVEL_ERROR;
+            expectedCount = DJI_BENCHMARK_LOG_ERROR_LINE_NUM;
+            break;
+        case DJI_BENCHMARK_LOG_MODE_QUERY_RANGE:
+            query.startTimeMs = DJI_BENCHMARK_LOG_STORE_START_MS +
+                                (uint64_t) DJI_BENCHMARK_LOG_RANGE_START_LINE * DJI_BENCHMARK_LOG_STORE_INTERVAL_MS;
+            query.endTimeMs = query.startTimeMs +
+                              (uint64_t) DJI_BENCHMARK_LOG_RANGE_LINE_NUM * DJI_BENCHMARK_LOG_STORE_INTERVAL_MS;
+            expectedCount = DJI_BENCHMARK_LOG_RANGE_LINE_NUM;
+            break;
+        case DJI_BENCHMARK_LOG_MODE_QUERY_RECOVER:
+            expectedCount = DJI_BENCHMARK_LOG_STORE_LINE_NUM;
+            isSelective = false;
+            break;
+        default:
+            query.keyword = "not in any line";
+            expectedCount = 0;
+            isSelective = false;
+            break;
+    }
+
+    returnCode = DjiTest_LogStorageQuery(logContext->rootPath, DJI_BENCHMARK_LOG_PREFIX, &query,
+                                         DjiBenchmark_LogCountLine, NULL, &statistics);
+    if (returnCode != DJI_ERROR_SYSTEM_MODULE_CODE_SUCCESS) {
+        return returnCode;
+    }
+
+    if (statistics.matchedLineCount != expectedCount || statistics.corruptBlockCount != 0 ||
+        statistics.recoveredBlockCount != logContext->cutEntryCount ||
+        (isSelective && statistics.decodedBlockCount * 10 > statistics.blockCount) ||
+        (!isSelective && statistics.decodedBlockCount != statistics.blockCount)) {
+        return DJI_ERROR_SYSTEM_MODULE_CODE_SYSTEM_ERROR;
+    }
+
+    return DJI_ERROR_SYSTEM_MODULE_CODE_SUCCESS;
+}
+
+static T_DjiReturnCode DjiBenchmark_LogCountLine(void *userData, uint64_t timeMs, uint8_t level, const char *line,
+                                                 uint32_t len)
+{
+    USER_UTIL_UNUSED(userData);
+    USER_UTIL_UNUSED(timeMs);
+    USER_UTIL_UNUSED(level);
+    USER_UTIL_UNUSED(line);
+    USER_UTIL_UNUSED(len);
+
+    return DJI_ERROR_SYSTEM_MODULE_CODE_SUCCESS;
+}
+
+/**
+ * @brief Lines in the format of the logger, the module, file and values vary with the index.
+ */
+static uint32_t DjiBenchmark_LogFormatLine(char *line, uint32_t size, uint32_t index, uint8_t level, bool isColored)
+{
+    static const char *moduleNames[] = {"user", "fc_subscription", "camera_emu", "gimbal_emu", "data_transmission"};
+    static const char *fileNames[] = {"test_fc_subscription.c", "test_payload_cam_emu_base.c",
+                                      "test_payload_gimbal_emu.c", "test_data_transmission.c"};
+    int len;
+
+    len = snprintf(line, size, "%s[%u.%03u][%s]-[%s]-%s:%u velocity %d.%02d m/s, altitude %u.%u m, quaternion "
+                               "%u %u %u %u%s\r\n",
+                   isColored ? s_logLevelColors[level] : "", index / 100, index % 100 * 10,
+                   moduleNames[index % 5], s_logLevelNames[level], fileNames[index % 4], 100 + index % 700,
+                   (int) (index % 17) - 8, index % 100, index % 1200, index % 10, index * 7919 % 65536,
+                   index * 104729 % 65536, index * 1299709 % 65536, index * 15485863 % 65536,
+                   isColored ? "\033[0m" : "");
+    if (len < 0) {
+        return 0;
+    }
+
+    return (uint32_t) len < size ? (uint32_t) len : size - 1;
+}
+
+/****************** (C) COPYRIGHT DJI Innovations *****END OF FILE****/
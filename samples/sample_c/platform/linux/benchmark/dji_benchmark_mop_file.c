@@ -0,0 +1,317 @@
+/**
+ ********************************************************************
+ * @file    dji_benchmark_mop_file.c
+ * @brief   Benchmark cases of the chunked file transfer over a multiplexed loopback link.
+ *
+ * @copyright (c) 2021 DJI. All rights reserved.
+ *
+ * All information contained herein is, and remains, the property of DJI.
+ * The intellectual and technical concepts contained herein are proprietary
+ * to DJI and may be covered by U.S. and foreign patents, patents in process,
+ * and protected by trade secret or copyright law.  Dissemination of this
+ * information, including but not limited to data and other proprietary
+ * material(s) incorporated within the information, in any form, is strictly
+ * prohibited without the express written consent of DJI.
+ *
+ * If you receive this source code without DJI’s authorization, you may not
+ * further disseminate the information, and you must immediately remove the
+ * source code and notify DJI of its removal. DJI reserves the right to pursue
+ * legal actions against you for any loss(es) or damage(s) caused by your
+ * failure to do so.
+ *
+ *********************************************************************
+ */
+
+/* Includes ------------------------------------------------------------------*/
+#include "dji_benchmark.h"
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include "mop_channel/test_mop_file_transfer.h"
+
+/* Private constants ---------------------------------------------------------*/
+#define DJI_BENCHMARK_MOP_FILE_SIZE             (8 * 1024 * 1024)
+#define DJI_BENCHMARK_MOP_FILE_CHUNK_SIZE       (64 * 1024)
+#define DJI_BENCHMARK_MOP_FILE_STREAM_ID        (1)
+#define DJI_BENCHMARK_MOP_FILE_REMOTE_NAME      "source.bin"
+
+/* Private types -------------------------------------------------------------*/
+typedef struct {
+    uint32_t maxInflight;
+    bool isInterrupted;             /*!< Cancel each download half way and resume it. */
+} T_DjiBenchmarkMopFileParam;
+
+typedef struct {
+    const T_DjiBenchmarkMopFileParam *param;
+    char rootPath[DJI_TEST_MOP_FILE_PATH_MAX_LEN];
+    char remotePath[DJI_TEST_MOP_FILE_PATH_MAX_LEN];
+    char localPath[DJI_TEST_MOP_FILE_PATH_MAX_LEN];
+    T_DjiTestMopMux clientMux;
+    T_DjiTestMopMux serverMux;
+    T_DjiTestMopMuxLoopback clientLink;
+    T_DjiTestMopMuxLoopback serverLink;
+    T_DjiTestMopFileServer server;
+    T_DjiTestMopFileClient client;
+} T_DjiBenchmarkMopFileContext;
+
+/* Private functions declaration ---------------------------------------------*/
+static T_DjiReturnCode DjiBenchmark_MopFileSetup(const T_DjiBenchmarkConfig *config, void *param, void **context);
+static T_DjiReturnCode DjiBenchmark_MopFileDownload(void *context, uint32_t iterations);
+static void DjiBenchmark_MopFileTeardown(void *context);
+static T_DjiReturnCode DjiBenchmark_MopFileCreateSource(const char *path);
+static void DjiBenchmark_MopFileOnClientMessage(void *userData, uint16_t streamId, const uint8_t *data, uint32_t len);
+static void DjiBenchmark_MopFileOnServerMessage(void *userData, uint16_t streamId, const uint8_t *data, uint32_t len);
+static void DjiBenchmark_MopFileCancelHalfWay(void *userData, const T_DjiTestMopFileTransferStatistics *statistics);
+
+/* Private values ------------------------------------------------------------*/
+static const T_DjiBenchmarkMopFileParam s_mopFileSerialParam = {1, false};
+static const T_DjiBenchmarkMopFileParam s_mopFilePipelinedParam = {8, false};
+static const T_DjiBenchmarkMopFileParam s_mopFileResumeParam = {8, true};
+
+/* Exported functions definition ---------------------------------------------*/
+T_DjiReturnCode DjiBenchmark_RunMopFileCases(const T_DjiBenchmarkConfig *config, FILE *output)
+{
+    T_DjiBenchmarkCase benchCase;
+
+    /* One operation is a download of the whole file in 64 KB chunks, verified and written to disk. */
+    benchCase = (T_DjiBenchmarkCase) {
+        .name = "mop_file/download/1_inflight", .bytesPerOp = DJI_BENCHMARK_MOP_FILE_SIZE,
+        .maxBatch = 1, .maxSamples = 20,
+        .Setup = DjiBenchmark_MopFileSetup, .Run = DjiBenchmark_MopFileDownload,
+        .Teardown = DjiBenchmark_MopFileTeardown, .param = (void *) &s_mopFileSerialParam,
+    };
+    DjiBenchmark_RunCase(config, &benchCase, output);
+
+    benchCase.name = "mop_file/download/8_inflight";
+    benchCase.param = (void *) &s_mopFilePipelinedParam;
+    DjiBenchmark_RunCase(config, &benchCase, output);
+
+    /* Same download cancelled half way and resumed from the manifest, the difference to the case above is the cost
+     * of the recovery. The case fails when the resume fetches chunks that were already on disk. */
+    benchCase.name = "mop_file/resume/half";
+    benchCase.param = (void *) &s_mopFileResumeParam;
+    DjiBenchmark_RunCase(config, &benchCase, output);
+
+    return DJI_ERROR_SYSTEM_MODULE_CODE_SUCCESS;
+}
+
+/* Private functions definition-----------------------------------------------*/
+static T_DjiReturnCode DjiBenchmark_MopFileSetup(const T_DjiBenchmarkConfig *config, void *param, void **context)
+{
+    T_DjiBenchmarkMopFileContext *fileContext;
+    T_DjiTestMopMuxConfig muxConfig;
+    T_DjiTestMopMuxTransport transport;
+    T_DjiTestMopFileClientConfig clientConfig;
+    char sourcePath[DJI_TEST_MOP_FILE_PATH_MAX_LEN + sizeof(DJI_BENCHMARK_MOP_FILE_REMOTE_NAME)];
+    T_DjiReturnCode returnCode;
+
+    fileContext = calloc(1, sizeof(T_DjiBenchmarkMopFileContext));
+    if (fileContext == NULL) {
+        return DJI_ERROR_SYSTEM_MODULE_CODE_MEMORY_ALLOC_FAILED;
+    }
+    fileContext->param = param;
+
+    snprintf(fileContext->rootPath, sizeof(fileContext->rootPath), "%s/dji_benchmark_XXXXXX", config->tmpDir);
+    if (mkdtemp(fileContext->rootPath) == NULL) {
+        free(fileContext);
+        return DJI_ERROR_SYSTEM_MODULE_CODE_SYSTEM_ERROR;
+    }
+    snprintf(sourcePath, sizeof(sourcePath), "%s/%s", fileContext->rootPath, DJI_BENCHMARK_MOP_FILE_REMOTE_NAME);
+    snprintf(fileContext->remotePath, sizeof(fileContext->remotePath), "%s", DJI_BENCHMARK_MOP_FILE_REMOTE_NAME);
+    snprintf(fileContext->localPath, sizeof(fileContext->localPath), "%s/download.bin", fileContext->rootPath);
+
+    returnCode = DjiBenchmark_MopFileCreateSource(sourcePath);
+    if (returnCode != DJI_ERROR_SYSTEM_MODULE_CODE_SUCCESS) {
+        goto removeRoot;
+    }
+
+    /* The server queue holds every chunk in flight, so no response is dropped. */
+    DjiTest_MopMuxGetDefaultConfig(&muxConfig);
+    muxConfig.sendQueueSize = fileContext->param->maxInflight * (DJI_BENCHMARK_MOP_FILE_CHUNK_SIZE + 64);
+
+    muxConfig.callbacks.OnMessage = DjiBenchmark_MopFileOnClientMessage;
+    muxConfig.callbacks.userData = fileContext;
+    DjiTest_MopMuxLoopbackInit(&fileContext->clientLink, &fileContext->serverMux, 0);
+    DjiTest_MopMuxLoopbackGetTransport(&fileContext->clientLink, &transport);
+    returnCode = DjiTest_MopMuxInit(&fileContext->clientMux, &muxConfig, &transport);
+    if (returnCode != DJI_ERROR_SYSTEM_MODULE_CODE_SUCCESS) {
+        goto removeSource;
+    }
+
+    muxConfig.callbacks.OnMessage = DjiBenchmark_MopFileOnServerMessage;
+    DjiTest_MopMuxLoopbackInit(&fileContext->serverLink, &fileContext->clientMux, 0);
+    DjiTest_MopMuxLoopbackGetTransport(&fileContext->serverLink, &transport);
+    returnCode = DjiTest_MopMuxInit(&fileContext->serverMux, &muxConfig, &transport);
+    if (returnCode != DJI_ERROR_SYSTEM_MODULE_CODE_SUCCESS) {
+        goto deInitClientMux;
+    }
+
+    returnCode = DjiTest_MopFileServerInit(&fileContext->server, &fileContext->serverMux,
+                                           DJI_BENCHMARK_MOP_FILE_STREAM_ID, fileContext->rootPath);
+    if (returnCode != DJI_ERROR_SYSTEM_MODULE_CODE_SUCCESS) {
+        goto deInitServerMux;
+    }
+
+    DjiTest_MopFileClientGetDefaultConfig(&clientConfig);
+    clientConfig.chunkSize = DJI_BENCHMARK_MOP_FILE_CHUNK_SIZE;
+    clientConfig.maxInflight = fileContext->param->maxInflight;
+    clientConfig.userData = fileContext;
+    returnCode = DjiTest_MopFileClientInit(&fileContext->client, &clientConfig, &fileContext->clientMux,
+                                           DJI_BENCHMARK_MOP_FILE_STREAM_ID);
+    if (returnCode != DJI_ERROR_SYSTEM_MODULE_CODE_SUCCESS) {
+        goto deInitServer;
+    }
+
+    if (DjiTest_MopMuxOpenStream(&fileContext->clientMux, DJI_BENCHMARK_MOP_FILE_STREAM_ID,
+                                 DJI_TEST_MOP_MUX_PRIORITY_DEFAULT) != DJI_ERROR_SYSTEM_MODULE_CODE_SUCCESS ||
+        DjiTest_MopMuxOpenStream(&fileContext->serverMux, DJI_BENCHMARK_MOP_FILE_STREAM_ID,
+                                 DJI_TEST_MOP_MUX_PRIORITY_DEFAULT) != DJI_ERROR_SYSTEM_MODULE_CODE_SUCCESS) {
+        returnCode = DJI_ERROR_SYSTEM_MODULE_CODE_SYSTEM_ERROR;
+        goto deInitClient;
+    }
+
+    returnCode = DjiTest_MopMuxStart(&fileContext->serverMux);
+    if (returnCode != DJI_ERROR_SYSTEM_MODULE_CODE_SUCCESS) {
+        goto deInitClient;
+    }
+    returnCode = DjiTest_MopMuxStart(&fileContext->clientMux);
+    if (returnCode != DJI_ERROR_SYSTEM_MODULE_CODE_SUCCESS) {
+        DjiTest_MopMuxStop(&fileContext->serverMux);
+        goto deInitClient;
+    }
+
+    *context = fileContext;
+
+    return DJI_ERROR_SYSTEM_MODULE_CODE_SUCCESS;
+
+deInitClient:
+    DjiTest_MopFileClientDeInit(&fileContext->client);
+deInitServer:
+    DjiTest_MopFileServerDeInit(&fileContext->server);
+deInitServerMux:
+    DjiTest_MopMuxDeInit(&fileContext->serverMux);
+deInitClientMux:
+    DjiTest_MopMuxDeInit(&fileContext->clientMux);
+removeSource:
+    remove(sourcePath);
+removeRoot:
+    rmdir(fileContext->rootPath);
+    free(fileContext);
+
+    return returnCode;
+}
+
+static T_DjiReturnCode DjiBenchmark_MopFileDownload(void *context, uint32_t iterations)
+{
+    T_DjiBenchmarkMopFileContext *fileContext = context;
+    T_DjiTestMopFileTransferStatistics statistics;
+    T_DjiReturnCode returnCode;
+    uint32_t i;
+
+    for (i = 0; i < iterations; i++) {
+        if (fileContext->param->isInterrupted) {
+            fileContext->client.config.progressCallback = DjiBenchmark_MopFileCancelHalfWay;
+            returnCode = DjiTest_MopFileClientDownload(&fileContext->client, fileContext->remotePath,
+                                                       fileContext->localPath);
+            fileContext->client.config.progressCallback = NULL;
+            if (returnCode != DJI_ERROR_SYSTEM_MODULE_CODE_NONSUPPORT_IN_CURRENT_STATE) {
+                return DJI_ERROR_SYSTEM_MODULE_CODE_SYSTEM_ERROR;
+            }
+        }
+
+        returnCode = DjiTest_MopFileClientDownload(&fileContext->client, fileContext->remotePath,
+                                                   fileContext->localPath);
+        if (returnCode != DJI_ERROR_SYSTEM_MODULE_CODE_SUCCESS) {
+            return returnCode;
+        }
+
+        DjiTest_MopFileClientGetStatistics(&fileContext->client, &statistics);
+        if (statistics.resumedBytes + statistics.receivedBytes != DJI_BENCHMARK_MOP_FILE_SIZE ||
+            (fileContext->param->isInterrupted && statistics.resumedBytes < DJI_BENCHMARK_MOP_FILE_SIZE / 2)) {
+            return DJI_ERROR_SYSTEM_MODULE_CODE_SYSTEM_ERROR;
+        }
+        remove(fileContext->localPath);
+    }
+
+    return DJI_ERROR_SYSTEM_MODULE_CODE_SUCCESS;
+}
+
+static void DjiBenchmark_MopFileTeardown(void *context)
+{
+    T_DjiBenchmarkMopFileContext *fileContext = context;
+    char path[DJI_TEST_MOP_FILE_PATH_MAX_LEN + 16];
+
+    if (fileContext == NULL) {
+        return;
+    }
+
+    DjiTest_MopMuxStop(&fileContext->clientMux);
+    DjiTest_MopMuxStop(&fileContext->serverMux);
+    DjiTest_MopFileClientDeInit(&fileContext->client);
+    DjiTest_MopFileServerDeInit(&fileContext->server);
+    DjiTest_MopMuxDeInit(&fileContext->serverMux);
+    DjiTest_MopMuxDeInit(&fileContext->clientMux);
+
+    remove(fileContext->localPath);
+    snprintf(path, sizeof(path), "%s.part", fileContext->localPath);
+    remove(path);
+    snprintf(path, sizeof(path), "%s.manifest", fileContext->localPath);
+    remove(path);
+    snprintf(path, sizeof(path), "%s/%s", fileContext->rootPath, DJI_BENCHMARK_MOP_FILE_REMOTE_NAME);
+    remove(path);
+    rmdir(fileContext->rootPath);
+    free(fileContext);
+}
+
+static T_DjiReturnCode DjiBenchmark_MopFileCreateSource(const char *path)
+{
+    uint8_t data[4096];
+    uint32_t written = 0;
+    uint32_t i;
+    FILE *fp;
+
+    fp = fopen(path, "wb");
+    if (fp == NULL) {
+        return DJI_ERROR_SYSTEM_MODULE_CODE_SYSTEM_ERROR;
+    }
+
+    while (written < DJI_BENCHMARK_MOP_FILE_SIZE) {
+        for (i = 0; i < sizeof(data); i++) {
+            data[i] = (uint8_t) ((written + i) * 31 + ((written + i) >> 12));
+        }
+        if (fwrite(data, 1, sizeof(data), fp) != sizeof(data)) {
+            fclose(fp);
+            return DJI_ERROR_SYSTEM_MODULE_CODE_SYSTEM_ERROR;
+        }
+        written += sizeof(data);
+    }
+
+    return fclose(fp) == 0 ? DJI_ERROR_SYSTEM_MODULE_CODE_SUCCESS : DJI_ERROR_SYSTEM_MODULE_CODE_SYSTEM_ERROR;
+}
+
+static void DjiBenchmark_MopFileOnClientMessage(void *userData, uint16_t streamId, const uint8_t *data, uint32_t len)
+{
+    T_DjiBenchmarkMopFileContext *fileContext = userData;
+
+    (void) streamId;
+    DjiTest_MopFileClientInput(&fileContext->client, data, len);
+}
+
+static void DjiBenchmark_MopFileOnServerMessage(void *userData, uint16_t streamId, const uint8_t *data, uint32_t len)
+{
+    T_DjiBenchmarkMopFileContext *fileContext = userData;
+
+    (void) streamId;
+    DjiTest_MopFileServerInput(&fileContext->server, data, len);
+}
+
+static void DjiBenchmark_MopFileCancelHalfWay(void *userData, const T_DjiTestMopFileTransferStatistics *statistics)
+{
+    T_DjiBenchmarkMopFileContext *fileContext = userData;
+
+    if (statistics->completedChunkCount == statistics->chunkCount / 2) {
+        DjiTest_MopFileClientCancel(&fileContext->client);
+    }
+}
+
+/****************** (C) COPYRIGHT DJI Innovations *****END OF FILE****/
@@ -0,0 +1,290 @@
+/**
+ ********************************************************************
+ * @file    dji_benchmark_mop_mux.c
+ * @brief   Benchmark cases of the mop channel stream multiplexer over a loopback.
+ *
+ * @copyright (c) 2021 DJI. All rights reserved.
+ *
+ * All information contained herein is, and remains, the property of DJI.
+ * The intellectual and technical concepts contained herein are proprietary
+ * to DJI and may be covered by U.S. and foreign patents, patents in process,
+ * and protected by trade secret or copyright law.  Dissemination of this
+ * information, including but not limited to data and other proprietary
+ * material(s) incorporated within the information, in any form, is strictly
+ * prohibited without the express written consent of DJI.
+ *
+ * If you receive this source code without DJI’s authorization, you may not
+ * further disseminate the information, and you must immediately remove the
+ * source code and notify DJI of its removal. DJI reserves the right to pursue
+ * legal actions against you for any loss(es) or damage(s) caused by your
+ * failure to do so.
+ *
+ *********************************************************************
+ */
+
+/* Includes ------------------------------------------------------------------*/
+#include "dji_benchmark.h"
+#include <stdlib.h>
+#include <string.h>
+#include "mop_channel/test_mop_channel_mux.h"
+
+/* Private constants ---------------------------------------------------------*/
+#define DJI_BENCHMARK_MOP_MUX_STREAM_NUM        (8)
+#define DJI_BENCHMARK_MOP_MUX_POLL_MAX_NUM      (100000)
+/* Link of the fairness case, about 20 MB/s with a tick standing for 1ms. */
+#define DJI_BENCHMARK_MOP_MUX_LINK_BYTES        (20000)
+#define DJI_BENCHMARK_MOP_MUX_FAIR_TICK_NUM     (100)
+#define DJI_BENCHMARK_MOP_MUX_FAIR_MESSAGE_SIZE (32 * 1024)
+/* Allowed deviation of a stream from its weighted share, unit: percent of the share. */
+#define DJI_BENCHMARK_MOP_MUX_FAIR_TOLERANCE    (10)
+
+/* Private types -------------------------------------------------------------*/
+typedef struct {
+    uint32_t messageSize;
+    uint32_t streamNum;
+} T_DjiBenchmarkMopMuxParam;
+
+typedef struct {
+    const T_DjiBenchmarkMopMuxParam *param;
+    T_DjiTestMopMux sender;
+    T_DjiTestMopMux receiver;
+    T_DjiTestMopMuxLoopback senderLink;
+    T_DjiTestMopMuxLoopback receiverLink;
+    uint32_t receivedCount;
+    T_DjiTestMopMuxStatistics statistics;
+    uint8_t *data;
+} T_DjiBenchmarkMopMuxContext;
+
+/* Private functions declaration ---------------------------------------------*/
+static T_DjiReturnCode DjiBenchmark_MopMuxSetup(const T_DjiBenchmarkConfig *config, void *param, void **context);
+static T_DjiReturnCode DjiBenchmark_MopMuxSendMessages(void *context, uint32_t iterations);
+static T_DjiReturnCode DjiBenchmark_MopMuxShareLink(void *context, uint32_t iterations);
+static void DjiBenchmark_MopMuxTeardown(void *context);
+static void DjiBenchmark_MopMuxOnMessage(void *userData, uint16_t streamId, const uint8_t *data, uint32_t len);
+
+/* Private values ------------------------------------------------------------*/
+static const T_DjiBenchmarkMopMuxParam s_mopMuxSmallParam = {64 * 1024, 1};
+static const T_DjiBenchmarkMopMuxParam s_mopMuxLargeParam = {1024 * 1024, 1};
+static const T_DjiBenchmarkMopMuxParam s_mopMuxStreamsParam = {16 * 1024, DJI_BENCHMARK_MOP_MUX_STREAM_NUM};
+static const T_DjiBenchmarkMopMuxParam s_mopMuxFairParam = {
+    DJI_BENCHMARK_MOP_MUX_FAIR_MESSAGE_SIZE, DJI_BENCHMARK_MOP_MUX_STREAM_NUM
+};
+
+/* Exported functions definition ---------------------------------------------*/
+T_DjiReturnCode DjiBenchmark_RunMopMuxCases(const T_DjiBenchmarkConfig *config, FILE *output)
+{
+    T_DjiBenchmarkCase benchCase;
+
+    /* One operation is a message queued, framed, credited, parsed and delivered on every stream of the case. */
+    benchCase = (T_DjiBenchmarkCase) {
+        .name = "mop_mux/loopback/64k", .bytesPerOp = 64 * 1024,
+        .Setup = DjiBenchmark_MopMuxSetup, .Run = DjiBenchmark_MopMuxSendMessages,
+        .Teardown = DjiBenchmark_MopMuxTeardown, .param = (void *) &s_mopMuxSmallParam,
+    };
+    DjiBenchmark_RunCase(config, &benchCase, output);
+
+    benchCase.name = "mop_mux/loopback/1m";
+    benchCase.bytesPerOp = 1024 * 1024;
+    benchCase.maxBatch = 4;
+    benchCase.maxSamples = 200;
+    benchCase.param = (void *) &s_mopMuxLargeParam;
+    DjiBenchmark_RunCase(config, &benchCase, output);
+
+    benchCase.name = "mop_mux/loopback/8x16k";
+    benchCase.bytesPerOp = DJI_BENCHMARK_MOP_MUX_STREAM_NUM * 16 * 1024;
+    benchCase.maxBatch = 0;
+    benchCase.maxSamples = 0;
+    benchCase.param = (void *) &s_mopMuxStreamsParam;
+    DjiBenchmark_RunCase(config, &benchCase, output);
+
+    /* One operation is a tick of a saturated link shared by streams of priority 0 to 7, the case fails when a
+     * stream gets a share off its weight. */
+    benchCase.name = "mop_mux/fair_share/8_streams";
+    benchCase.bytesPerOp = DJI_BENCHMARK_MOP_MUX_LINK_BYTES * DJI_BENCHMARK_MOP_MUX_FAIR_TICK_NUM;
+    benchCase.Run = DjiBenchmark_MopMuxShareLink;
+    benchCase.param = (void *) &s_mopMuxFairParam;
+    DjiBenchmark_RunCase(config, &benchCase, output);
+
+    return DJI_ERROR_SYSTEM_MODULE_CODE_SUCCESS;
+}
+
+/* Private functions definition-----------------------------------------------*/
+static T_DjiReturnCode DjiBenchmark_MopMuxSetup(const T_DjiBenchmarkConfig *config, void *param, void **context)
+{
+    T_DjiBenchmarkMopMuxContext *muxContext;
+    T_DjiTestMopMuxConfig muxConfig;
+    T_DjiTestMopMuxTransport transport;
+    T_DjiReturnCode returnCode;
+    uint32_t i;
+
+    (void) config;
+
+    muxContext = calloc(1, sizeof(T_DjiBenchmarkMopMuxContext));
+    if (muxContext == NULL) {
+        return DJI_ERROR_SYSTEM_MODULE_CODE_MEMORY_ALLOC_FAILED;
+    }
+    muxContext->param = param;
+
+    muxContext->data = malloc(muxContext->param->messageSize);
+    if (muxContext->data == NULL) {
+        returnCode = DJI_ERROR_SYSTEM_MODULE_CODE_MEMORY_ALLOC_FAILED;
+        goto freeContext;
+    }
+    for (i = 0; i < muxContext->param->messageSize; i++) {
+        muxContext->data[i] = (uint8_t) (i * 31 + (i >> 8));
+    }
+
+    DjiTest_MopMuxGetDefaultConfig(&muxConfig);
+    muxConfig.streamCount = DJI_BENCHMARK_MOP_MUX_STREAM_NUM;
+    muxConfig.callbacks.OnMessage = DjiBenchmark_MopMuxOnMessage;
+    muxConfig.callbacks.userData = muxContext;
+
+    DjiTest_MopMuxLoopbackInit(&muxContext->senderLink, &muxContext->receiver, 0);
+    DjiTest_MopMuxLoopbackGetTransport(&muxContext->senderLink, &transport);
+    returnCode = DjiTest_MopMuxInit(&muxContext->sender, &muxConfig, &transport);
+    if (returnCode != DJI_ERROR_SYSTEM_MODULE_CODE_SUCCESS) {
+        goto freeData;
+    }
+
+    DjiTest_MopMuxLoopbackInit(&muxContext->receiverLink, &muxContext->sender, 0);
+    DjiTest_MopMuxLoopbackGetTransport(&muxContext->receiverLink, &transport);
+    returnCode = DjiTest_MopMuxInit(&muxContext->receiver, &muxConfig, &transport);
+    if (returnCode != DJI_ERROR_SYSTEM_MODULE_CODE_SUCCESS) {
+        goto deInitSender;
+    }
+
+    /* Stream i has priority i, the receiver opens its streams on the first data. */
+    for (i = 0; i < muxContext->param->streamNum; i++) {
+        returnCode = DjiTest_MopMuxOpenStream(&muxContext->sender, (uint16_t) i, (uint8_t) i);
+        if (returnCode != DJI_ERROR_SYSTEM_MODULE_CODE_SUCCESS) {
+            goto deInitReceiver;
+        }
+    }
+
+    *context = muxContext;
+
+    return DJI_ERROR_SYSTEM_MODULE_CODE_SUCCESS;
+
+deInitReceiver:
+    DjiTest_MopMuxDeInit(&muxContext->receiver);
+deInitSender:
+    DjiTest_MopMuxDeInit(&muxContext->sender);
+freeData:
+    free(muxContext->data);
+freeContext:
+    free(muxContext);
+
+    return returnCode;
+}
+
+static T_DjiReturnCode DjiBenchmark_MopMuxSendMessages(void *context, uint32_t iterations)
+{
+    T_DjiBenchmarkMopMuxContext *muxContext = context;
+    T_DjiReturnCode returnCode;
+    uint32_t pollCount;
+    uint32_t i;
+    uint32_t j;
+
+    for (i = 0; i < iterations; i++) {
+        muxContext->receivedCount = 0;
+        for (j = 0; j < muxContext->param->streamNum; j++) {
+            returnCode = DjiTest_MopMuxSend(&muxContext->sender, (uint16_t) j, muxContext->data,
+                                            muxContext->param->messageSize);
+            if (returnCode != DJI_ERROR_SYSTEM_MODULE_CODE_SUCCESS) {
+                return returnCode;
+            }
+        }
+
+        for (pollCount = 0; muxContext->receivedCount < muxContext->param->streamNum; pollCount++) {
+            if (pollCount == DJI_BENCHMARK_MOP_MUX_POLL_MAX_NUM) {
+                return DJI_ERROR_SYSTEM_MODULE_CODE_TIMEOUT;
+            }
+            DjiTest_MopMuxPoll(&muxContext->sender);
+            DjiTest_MopMuxPoll(&muxContext->receiver);
+        }
+    }
+
+    return DJI_ERROR_SYSTEM_MODULE_CODE_SUCCESS;
+}
+
+static T_DjiReturnCode DjiBenchmark_MopMuxShareLink(void *context, uint32_t iterations)
+{
+    T_DjiBenchmarkMopMuxContext *muxContext = context;
+    uint64_t startBytes[DJI_BENCHMARK_MOP_MUX_STREAM_NUM];
+    uint64_t sentBytes[DJI_BENCHMARK_MOP_MUX_STREAM_NUM];
+    uint64_t totalBytes = 0;
+    uint64_t expectedBytes;
+    uint64_t slackBytes;
+    uint32_t tick;
+    uint32_t i;
+    uint32_t j;
+
+    muxContext->senderLink.bytesPerTick = DJI_BENCHMARK_MOP_MUX_LINK_BYTES;
+
+    /* The share is measured in framed bytes at the sender, streams are opened in order so index j is stream j. */
+    DjiTest_MopMuxGetStatistics(&muxContext->sender, &muxContext->statistics);
+    for (j = 0; j < muxContext->param->streamNum; j++) {
+        startBytes[j] = muxContext->statistics.streams[j].sentBytes;
+    }
+
+    for (i = 0; i < iterations; i++) {
+        for (tick = 0; tick < DJI_BENCHMARK_MOP_MUX_FAIR_TICK_NUM; tick++) {
+            /* Keep every stream backlogged so the link is the bottleneck. */
+            for (j = 0; j < muxContext->param->streamNum; j++) {
+                while (DjiTest_MopMuxSend(&muxContext->sender, (uint16_t) j, muxContext->data,
+                                          muxContext->param->messageSize) == DJI_ERROR_SYSTEM_MODULE_CODE_SUCCESS) {
+                }
+            }
+            DjiTest_MopMuxLoopbackTick(&muxContext->senderLink);
+            DjiTest_MopMuxPoll(&muxContext->sender);
+            DjiTest_MopMuxPoll(&muxContext->receiver);
+        }
+    }
+
+    DjiTest_MopMuxGetStatistics(&muxContext->sender, &muxContext->statistics);
+    for (j = 0; j < muxContext->param->streamNum; j++) {
+        sentBytes[j] = muxContext->statistics.streams[j].sentBytes - startBytes[j];
+        totalBytes += sentBytes[j];
+    }
+
+    /* Weights are priority + 1, so stream j is owed (j + 1) / (1 + 2 + ... + n) of what went through. The window may
+     * end inside a round robin turn, which is worth one quantum of the stream. */
+    for (j = 0; j < muxContext->param->streamNum; j++) {
+        expectedBytes = totalBytes * (j + 1) * 2 / (muxContext->param->streamNum * (muxContext->param->streamNum + 1));
+        slackBytes = expectedBytes * DJI_BENCHMARK_MOP_MUX_FAIR_TOLERANCE / 100 +
+                     (uint64_t) (j + 1) * muxContext->sender.config.maxFrameSize;
+        if (sentBytes[j] + slackBytes < expectedBytes || sentBytes[j] > expectedBytes + slackBytes) {
+            return DJI_ERROR_SYSTEM_MODULE_CODE_SYSTEM_ERROR;
+        }
+    }
+
+    return DJI_ERROR_SYSTEM_MODULE_CODE_SUCCESS;
+}
+
+static void DjiBenchmark_MopMuxTeardown(void *context)
+{
+    T_DjiBenchmarkMopMuxContext *muxContext = context;
+
+    if (muxContext == NULL) {
+        return;
+    }
+
+    DjiTest_MopMuxDeInit(&muxContext->receiver);
+    DjiTest_MopMuxDeInit(&muxContext->sender);
+    free(muxContext->data);
+    free(muxContext);
+}
+
+static void DjiBenchmark_MopMuxOnMessage(void *userData, uint16_t streamId, const uint8_t *data, uint32_t len)
+{
+    T_DjiBenchmarkMopMuxContext *muxContext = userData;
+
+    if (streamId >= DJI_BENCHMARK_MOP_MUX_STREAM_NUM || len != muxContext->param->messageSize ||
+        data[len - 1] != muxContext->data[len - 1]) {
+        return;
+    }
+
+    muxContext->receivedCount++;
+}
+
+/****************** (C) COPYRIGHT DJI Innovations *****END OF FILE****/
@@ -0,0 +1,402 @@
+/**
+ ********************************************************************
+ * @file    dji_benchmark_osal.c
+ * @brief   Benchmark cases of the linux osal task, mutex, semaphore, time and memory functions.
+ *
+ * @copyright (c) 2021 DJI. All rights reserved.
+ *
+ * All information contained herein is, and remains, the property of DJI.
+ * The intellectual and technical concepts contained herein are proprietary
+ * to DJI and may be covered by U.S. and foreign patents, patents in process,
+ * and protected by trade secret or copyright law.  Dissemination of this
+ * information, including but not limited to data and other proprietary
+ * material(s) incorporated within the information, in any form, is strictly
+ * prohibited without the express written consent of DJI.
+ *
+ * If you receive this source code without DJI’s authorization, you may not
+ * further disseminate the information, and you must immediately remove the
+ * source code and notify DJI of its removal. DJI reserves the right to pursue
+ * legal actions against you for any loss(es) or damage(s) caused by your
+ * failure to do so.
+ *
+ *********************************************************************
+ */
+
+/* Includes ------------------------------------------------------------------*/
+#include "dji_benchmark.h"
+#include <stdlib.h>
+#include <string.h>
+#include "osal/osal.h"
+
+/* Private constants ---------------------------------------------------------*/
+#define DJI_BENCHMARK_TASK_STACK_SIZE           2048
+#define DJI_BENCHMARK_TASK_MAX_SAMPLES          500
+#define DJI_BENCHMARK_NAME_MAX_LEN              64
+
+/* Private types -------------------------------------------------------------*/
+typedef struct {
+    T_DjiMutexHandle mutex;
+    T_DjiSemaHandle pingSema;
+    T_DjiSemaHandle pongSema;
+    T_DjiTaskHandle task;
+    volatile bool stop;
+} T_DjiBenchmarkOsalContext;
+
+/* Private functions declaration ---------------------------------------------*/
+static T_DjiReturnCode DjiBenchmark_OsalSetup(const T_DjiBenchmarkConfig *config, void *param, void **context);
+static void DjiBenchmark_OsalTeardown(void *context);
+static T_DjiReturnCode DjiBenchmark_MutexLockUnlock(void *context, uint32_t iterations);
+static T_DjiReturnCode DjiBenchmark_SemaphorePostWait(void *context, uint32_t iterations);
+static T_DjiReturnCode DjiBenchmark_SemaphorePostTimedWait(void *context, uint32_t iterations);
+static T_DjiReturnCode DjiBenchmark_PingPongSetup(const T_DjiBenchmarkConfig *config, void *param, void **context);
+static T_DjiReturnCode DjiBenchmark_SemaphorePingPong(void *context, uint32_t iterations);
+static void DjiBenchmark_PingPongTeardown(void *context);
+static void *DjiBenchmark_PongTask(void *arg);
+static T_DjiReturnCode DjiBenchmark_TaskCreateDestroy(void *context, uint32_t iterations);
+static void *DjiBenchmark_SpawnTask(void *arg);
+static T_DjiReturnCode DjiBenchmark_TaskDestroyAndJoin(T_DjiTaskHandle task);
+static T_DjiReturnCode DjiBenchmark_GetTimeMs(void *context, uint32_t iterations);
+static T_DjiReturnCode DjiBenchmark_GetTimeUs(void *context, uint32_t iterations);
+static T_DjiReturnCode DjiBenchmark_ParamSetup(const T_DjiBenchmarkConfig *config, void *param, void **context);
+static T_DjiReturnCode DjiBenchmark_MallocFree(void *context, uint32_t iterations);
+
+/* Private values ------------------------------------------------------------*/
+static const uint32_t s_mallocSizes[] = {64, 4096, 256 * 1024};
+
+/* Exported functions definition ---------------------------------------------*/
+T_DjiReturnCode DjiBenchmark_RunOsalCases(const T_DjiBenchmarkConfig *config, FILE *output)
+{
+    T_DjiBenchmarkCase benchCase;
+    char name[DJI_BENCHMARK_NAME_MAX_LEN];
+    uint32_t i;
+
+    benchCase = (T_DjiBenchmarkCase) {
+        .name = "osal/mutex_lock_unlock", .Setup = DjiBenchmark_OsalSetup,
+        .Run = DjiBenchmark_MutexLockUnlock, .Teardown = DjiBenchmark_OsalTeardown,
+    };
+    DjiBenchmark_RunCase(config, &benchCase, output);
+
+    benchCase.name = "osal/semaphore_post_wait";
+    benchCase.Run = DjiBenchmark_SemaphorePostWait;
+    DjiBenchmark_RunCase(config, &benchCase, output);
+
+    benchCase.name = "osal/semaphore_post_timed_wait";
+    benchCase.Run = DjiBenchmark_SemaphorePostTimedWait;
+    DjiBenchmark_RunCase(config, &benchCase, output);
+
+    benchCase = (T_DjiBenchmarkCase) {
+        .name = "osal/semaphore_ping_pong", .Setup = DjiBenchmark_PingPongSetup,
+        .Run = DjiBenchmark_SemaphorePingPong, .Teardown = DjiBenchmark_PingPongTeardown,
+    };
+    DjiBenchmark_RunCase(config, &benchCase, output);
+
+    benchCase = (T_DjiBenchmarkCase) {
+        .name = "osal/task_create_destroy", .maxBatch = 1, .maxSamples = DJI_BENCHMARK_TASK_MAX_SAMPLES,
+        .Setup = DjiBenchmark_OsalSetup, .Run = DjiBenchmark_TaskCreateDestroy,
+        .Teardown = DjiBenchmark_OsalTeardown,
+    };
+    DjiBenchmark_RunCase(config, &benchCase, output);
+
+    benchCase = (T_DjiBenchmarkCase) {
+        .name = "osal/get_time_ms", .Run = DjiBenchmark_GetTimeMs,
+    };
+    DjiBenchmark_RunCase(config, &benchCase, output);
+
+    benchCase.name = "osal/get_time_us";
+    benchCase.Run = DjiBenchmark_GetTimeUs;
+    DjiBenchmark_RunCase(config, &benchCase, output);
+
+    for (i = 0; i < sizeof(s_mallocSizes) / sizeof(s_mallocSizes[0]); i++) {
+        snprintf(name, sizeof(name), "osal/malloc_free/%u", s_mallocSizes[i]);
+        benchCase = (T_DjiBenchmarkCase) {
+            .name = name, .Setup = DjiBenchmark_ParamSetup, .Run = DjiBenchmark_MallocFree,
+            .param = (void *) &s_mallocSizes[i],
+        };
+        DjiBenchmark_RunCase(config, &benchCase, output);
+    }
+
+    return DJI_ERROR_SYSTEM_MODULE_CODE_SUCCESS;
+}
+
+/* Private functions definition-----------------------------------------------*/
+static T_DjiReturnCode DjiBenchmark_OsalSetup(const T_DjiBenchmarkConfig *config, void *param, void **context)
+{
+    T_DjiReturnCode returnCode;
+    T_DjiBenchmarkOsalContext *osalContext;
+
+    (void) config;
+    (void) param;
+
+    osalContext = calloc(1, sizeof(T_DjiBenchmarkOsalContext));
+    if (osalContext == NULL) {
+        return DJI_ERROR_SYSTEM_MODULE_CODE_MEMORY_ALLOC_FAILED;
+    }
+
+    returnCode = Osal_MutexCreate(&osalContext->mutex);
+    if (returnCode != DJI_ERROR_SYSTEM_MODULE_CODE_SUCCESS) {
+        goto err;
+    }
+
+    returnCode = Osal_SemaphoreCreate(0, &osalContext->pingSema);
+    if (returnCode != DJI_ERROR_SYSTEM_MODULE_CODE_SUCCESS) {
+        goto err;
+    }
+
+    returnCode = Osal_SemaphoreCreate(0, &osalContext->pongSema);
+    if (returnCode != DJI_ERROR_SYSTEM_MODULE_CODE_SUCCESS) {
+        goto err;
+    }
+
+    *context = osalContext;
+
+    return DJI_ERROR_SYSTEM_MODULE_CODE_SUCCESS;
+
+err:
+    DjiBenchmark_OsalTeardown(osalContext);
+    return returnCode;
+}
+
+static void DjiBenchmark_OsalTeardown(void *context)
+{
+    T_DjiBenchmarkOsalContext *osalContext = context;
+
+    if (osalContext == NULL) {
+        return;
+    }
+
+    if (osalContext->pongSema != NULL) {
+        Osal_SemaphoreDestroy(osalContext->pongSema);
+    }
+    if (osalContext->pingSema != NULL) {
+        Osal_SemaphoreDestroy(osalContext->pingSema);
+    }
+    if (osalContext->mutex != NULL) {
+        Osal_MutexDestroy(osalContext->mutex);
+    }
+    free(osalContext);
+}
+
+static T_DjiReturnCode DjiBenchmark_MutexLockUnlock(void *context, uint32_t iterations)
+{
+    T_DjiBenchmarkOsalContext *osalContext = context;
+    uint32_t i;
+
+    for (i = 0; i < iterations; i++) {
+        if (Osal_MutexLock(osalContext->mutex) != DJI_ERROR_SYSTEM_MODULE_CODE_SUCCESS) {
+            return DJI_ERROR_SYSTEM_MODULE_CODE_SYSTEM_ERROR;
+        }
+        Osal_MutexUnlock(osalContext->mutex);
+    }
+
+    return DJI_ERROR_SYSTEM_MODULE_CODE_SUCCESS;
+}
+
+static T_DjiReturnCode DjiBenchmark_SemaphorePostWait(void *context, uint32_t iterations)
+{
+    T_DjiBenchmarkOsalContext *osalContext = context;
+    uint32_t i;
+
+    for (i = 0; i < iterations; i++) {
+        Osal_SemaphorePost(osalContext->pingSema);
+        if (Osal_SemaphoreWait(osalContext->pingSema) != DJI_ERROR_SYSTEM_MODULE_CODE_SUCCESS) {
+            return DJI_ERROR_SYSTEM_MODULE_CODE_SYSTEM_ERROR;
+        }
+    }
+
+    return DJI_ERROR_SYSTEM_MODULE_CODE_SUCCESS;
+}
+
+static T_DjiReturnCode DjiBenchmark_SemaphorePostTimedWait(void *context, uint32_t iterations)
+{
+    T_DjiBenchmarkOsalContext *osalContext = context;
+    uint32_t i;
+
+    for (i = 0; i < iterations; i++) {
+        Osal_SemaphorePost(osalContext->pingSema);
+        if (Osal_SemaphoreTimedWait(osalContext->pingSema, 100) != DJI_ERROR_SYSTEM_MODULE_CODE_SUCCESS) {
+            return DJI_ERROR_SYSTEM_MODULE_CODE_SYSTEM_ERROR;
+        }
+    }
+
+    return DJI_ERROR_SYSTEM_MODULE_CODE_SUCCESS;
+}
+
+static T_DjiReturnCode DjiBenchmark_PingPongSetup(const T_DjiBenchmarkConfig *config, void *param, void **context)
+{
+    T_DjiReturnCode returnCode;
+    T_DjiBenchmarkOsalContext *osalContext = NULL;
+
+    returnCode = DjiBenchmark_OsalSetup(config, param, (void **) &osalContext);
+    if (returnCode != DJI_ERROR_SYSTEM_MODULE_CODE_SUCCESS) {
+        return returnCode;
+    }
+
+    returnCode = Osal_TaskCreate("bench_pong", DjiBenchmark_PongTask, DJI_BENCHMARK_TASK_STACK_SIZE, osalContext,
+                                 &osalContext->task);
+    if (returnCode != DJI_ERROR_SYSTEM_MODULE_CODE_SUCCESS) {
+        DjiBenchmark_OsalTeardown(osalContext);
+        return returnCode;
+    }
+
+    *context = osalContext;
+
+    return DJI_ERROR_SYSTEM_MODULE_CODE_SUCCESS;
+}
+
+static T_DjiReturnCode DjiBenchmark_SemaphorePingPong(void *context, uint32_t iterations)
+{
+    T_DjiBenchmarkOsalContext *osalContext = context;
+    uint32_t i;
+
+    /* One operation is a full round trip: wake the peer task and wait for its answer. */
+    for (i = 0; i < iterations; i++) {
+        Osal_SemaphorePost(osalContext->pingSema);
+        if (Osal_SemaphoreWait(osalContext->pongSema) != DJI_ERROR_SYSTEM_MODULE_CODE_SUCCESS) {
+            return DJI_ERROR_SYSTEM_MODULE_CODE_SYSTEM_ERROR;
+        }
+    }
+
+    return DJI_ERROR_SYSTEM_MODULE_CODE_SUCCESS;
+}
+
+static void DjiBenchmark_PingPongTeardown(void *context)
+{
+    T_DjiBenchmarkOsalContext *osalContext = context;
+
+    if (osalContext == NULL) {
+        return;
+    }
+
+    osalContext->stop = true;
+    Osal_SemaphorePost(osalContext->pingSema);
+    Osal_SemaphoreWait(osalContext->pongSema);
+    DjiBenchmark_TaskDestroyAndJoin(osalContext->task);
+    DjiBenchmark_OsalTeardown(osalContext);
+}
+
+static void *DjiBenchmark_PongTask(void *arg)
+{
+    T_DjiBenchmarkOsalContext *osalContext = arg;
+
+    while (1) {
+        Osal_SemaphoreWait(osalContext->pingSema);
+        Osal_SemaphorePost(osalContext->pongSema);
+        if (osalContext->stop) {
+            break;
+        }
+    }
+
+    return NULL;
+}
+
+static T_DjiReturnCode DjiBenchmark_TaskCreateDestroy(void *context, uint32_t iterations)
+{
+    T_DjiReturnCode returnCode;
+    T_DjiBenchmarkOsalContext *osalContext = context;
+    T_DjiTaskHandle task;
+    uint32_t i;
+
+    /* One operation spans create, first schedule of the new task, destroy and reclaiming its stack. */
+    for (i = 0; i < iterations; i++) {
+        returnCode = Osal_TaskCreate("bench_spawn", DjiBenchmark_SpawnTask, DJI_BENCHMARK_TASK_STACK_SIZE,
+                                     osalContext, &task);
+        if (returnCode != DJI_ERROR_SYSTEM_MODULE_CODE_SUCCESS) {
+            return returnCode;
+        }
+
+        Osal_SemaphoreWait(osalContext->pingSema);
+
+        returnCode = DjiBenchmark_TaskDestroyAndJoin(task);
+        if (returnCode != DJI_ERROR_SYSTEM_MODULE_CODE_SUCCESS) {
+            return returnCode;
+        }
+    }
+
+    return DJI_ERROR_SYSTEM_MODULE_CODE_SUCCESS;
+}
+
+static void *DjiBenchmark_SpawnTask(void *arg)
+{
+    T_DjiBenchmarkOsalContext *osalContext = arg;
+
+    Osal_SemaphorePost(osalContext->pingSema);
+    while (1) {
+        Osal_TaskSleepMs(1000);
+    }
+
+    return NULL;
+}
+
+static T_DjiReturnCode DjiBenchmark_TaskDestroyAndJoin(T_DjiTaskHandle task)
+{
+    T_DjiReturnCode returnCode;
+    pthread_t thread;
+
+    /* Osal_TaskDestroy only cancels the thread, join it here so repeated runs do not leak thread stacks. */
+    thread = *(pthread_t *) task;
+    returnCode = Osal_TaskDestroy(task);
+    pthread_join(thread, NULL);
+
+    return returnCode;
+}
+
+static T_DjiReturnCode DjiBenchmark_GetTimeMs(void *context, uint32_t iterations)
+{
+    uint32_t timeMs = 0;
+    uint32_t i;
+
+    (void) context;
+
+    for (i = 0; i < iterations; i++) {
+        if (Osal_GetTimeMs(&timeMs) != DJI_ERROR_SYSTEM_MODULE_CODE_SUCCESS) {
+            return DJI_ERROR_SYSTEM_MODULE_CODE_SYSTEM_ERROR;
+        }
+    }
+
+    return DJI_ERROR_SYSTEM_MODULE_CODE_SUCCESS;
+}
+
+static T_DjiReturnCode DjiBenchmark_GetTimeUs(void *context, uint32_t iterations)
+{
+    uint64_t timeUs = 0;
+    uint32_t i;
+
+    (void) context;
+
+    for (i = 0; i < iterations; i++) {
+        if (Osal_GetTimeUs(&timeUs) != DJI_ERROR_SYSTEM_MODULE_CODE_SUCCESS) {
+            return DJI_ERROR_SYSTEM_MODULE_CODE_SYSTEM_ERROR;
+        }
+    }
+
+    return DJI_ERROR_SYSTEM_MODULE_CODE_SUCCESS;
+}
+
+static T_DjiReturnCode DjiBenchmark_ParamSetup(const T_DjiBenchmarkConfig *config, void *param, void **context)
+{
+    (void) config;
+
+    *context = param;
+
+    return DJI_ERROR_SYSTEM_MODULE_CODE_SUCCESS;
+}
+
+static T_DjiReturnCode DjiBenchmark_MallocFree(void *context, uint32_t iterations)
+{
+    uint32_t size = *(const uint32_t *) context;
+    volatile uint8_t *ptr;
+    uint32_t i;
+
+    for (i = 0; i < iterations; i++) {
+        ptr = Osal_Malloc(size);
+        if (ptr == NULL) {
+            return DJI_ERROR_SYSTEM_MODULE_CODE_MEMORY_ALLOC_FAILED;
+        }
+        ptr[0] = (uint8_t) i;
+        Osal_Free((void *) ptr);
+    }
+
+    return DJI_ERROR_SYSTEM_MODULE_CODE_SUCCESS;
+}
+
+/****************** (C) COPYRIGHT DJI Innovations *****END OF FILE****/
@@ -0,0 +1,275 @@
+/**
+ ********************************************************************
+ * @file    dji_benchmark_pool.c
+ * @brief   Benchmark cases of the pool-backed util_dlist and util_hash_map containers.
+ *
+ * @copyright (c) 2021 DJI. All rights reserved.
+ *
+ * All information contained herein is, and remains, the property of DJI.
+ * The intellectual and technical concepts contained herein are proprietary
+ * to DJI and may be covered by U.S. and foreign patents, patents in process,
+ * and protected by trade secret or copyright law.  Dissemination of this
+ * information, including but not limited to data and other proprietary
+ * material(s) incorporated within the information, in any form, is strictly
+ * prohibited without the express written consent of DJI.
+ *
+ * If you receive this source code without DJI’s authorization, you may not
+ * further disseminate the information, and you must immediately remove the
+ * source code and notify DJI of its removal. DJI reserves the right to pursue
+ * legal actions against you for any loss(es) or damage(s) caused by your
+ * failure to do so.
+ *
+ *********************************************************************
+ */
+
+
+/* Includes ------------------------------------------------------------------*/
+#include "dji_benchmark.h"
+#include <stdlib.h>
+#include <string.h>
+#include "utils/util_pool.h"
+#include "utils/util_dlist.h"
+#include "utils/util_hash_map.h"
+
+/* Private constants ---------------------------------------------------------*/
+#define DJI_BENCHMARK_POOL_NODE_NUM             64
+#define DJI_BENCHMARK_POOL_MAP_ENTRY_NUM        1024
+#define DJI_BENCHMARK_POOL_MAP_KEY_BASE         0x10000ULL
+
+/* Private types -------------------------------------------------------------*/
+typedef struct {
+    T_UtilDlistNode listNode;
+    uint64_t key;
+    uint32_t payload;
+} T_DjiBenchmarkPoolItem;
+
+typedef struct {
+    T_UtilPool pool;
+    T_UtilDlist list;
+    T_UtilHashMap map;
+    uint8_t *poolMemory;
+    uint8_t *mapMemory;
+    uint32_t itemNum;
+    uint32_t cursor;
+} T_DjiBenchmarkPoolContext;
+
+/* Private functions declaration ---------------------------------------------*/
+static T_DjiReturnCode DjiBenchmark_PoolSetup(const T_DjiBenchmarkConfig *config, void *param, void **context);
+static T_DjiReturnCode DjiBenchmark_PoolAllocFree(void *context, uint32_t iterations);
+static T_DjiReturnCode DjiBenchmark_DlistRotate(void *context, uint32_t iterations);
+static T_DjiReturnCode DjiBenchmark_HashMapGet(void *context, uint32_t iterations);
+static T_DjiReturnCode DjiBenchmark_HashMapRemovePut(void *context, uint32_t iterations);
+static T_DjiReturnCode DjiBenchmark_HashMapIterateRemove(void *context, uint32_t iterations);
+static uint64_t DjiBenchmark_PoolGetKey(uint32_t index);
+static void DjiBenchmark_PoolTeardown(void *context);
+
+/* Private values ------------------------------------------------------------*/
+
+/* Exported functions definition ---------------------------------------------*/
+T_DjiReturnCode DjiBenchmark_RunPoolCases(const T_DjiBenchmarkConfig *config, FILE *output)
+{
+    T_DjiBenchmarkCase benchCase;
+
+    benchCase = (T_DjiBenchmarkCase) {
+        .name = "util_pool/alloc_free", .Setup = DjiBenchmark_PoolSetup, .Run = DjiBenchmark_PoolAllocFree,
+        .Teardown = DjiBenchmark_PoolTeardown, .param = (void *) (uintptr_t) DJI_BENCHMARK_POOL_NODE_NUM,
+    };
+    DjiBenchmark_RunCase(config, &benchCase, output);
+
+    /* Same access pattern as util_link_list/add_last_remove_first, for a direct comparison. */
+    benchCase.name = "util_dlist/add_last_remove_first";
+    benchCase.Run = DjiBenchmark_DlistRotate;
+    DjiBenchmark_RunCase(config, &benchCase, output);
+
+    benchCase.name = "util_hash_map/get/1024";
+    benchCase.Run = DjiBenchmark_HashMapGet;
+    benchCase.param = (void *) (uintptr_t) DJI_BENCHMARK_POOL_MAP_ENTRY_NUM;
+    DjiBenchmark_RunCase(config, &benchCase, output);
+
+    benchCase.name = "util_hash_map/remove_put/1024";
+    benchCase.Run = DjiBenchmark_HashMapRemovePut;
+    DjiBenchmark_RunCase(config, &benchCase, output);
+
+    /* One operation drains the whole map through the iterator and refills it, the run fails on a skipped entry. */
+    benchCase.name = "util_hash_map/iterate_remove/1024";
+    benchCase.Run = DjiBenchmark_HashMapIterateRemove;
+    benchCase.maxBatch = 1;
+    DjiBenchmark_RunCase(config, &benchCase, output);
+
+    return DJI_ERROR_SYSTEM_MODULE_CODE_SUCCESS;
+}
+
+/* Private functions definition-----------------------------------------------*/
+static T_DjiReturnCode DjiBenchmark_PoolSetup(const T_DjiBenchmarkConfig *config, void *param, void **context)
+{
+    T_DjiBenchmarkPoolContext *poolContext;
+    T_DjiBenchmarkPoolItem *item;
+    uint32_t itemNum = (uint32_t) (uintptr_t) param;
+    size_t poolSize = UtilPool_GetMemorySize(itemNum + 1, sizeof(T_DjiBenchmarkPoolItem));
+    size_t mapSize = UtilHashMap_GetMemorySize(itemNum);
+    uint32_t i;
+
+    (void) config;
+
+    poolContext = calloc(1, sizeof(T_DjiBenchmarkPoolContext));
+    if (poolContext == NULL) {
+        return DJI_ERROR_SYSTEM_MODULE_CODE_MEMORY_ALLOC_FAILED;
+    }
+
+    poolContext->itemNum = itemNum;
+    poolContext->poolMemory = malloc(poolSize);
+    poolContext->mapMemory = malloc(mapSize);
+    if (poolContext->poolMemory == NULL || poolContext->mapMemory == NULL) {
+        DjiBenchmark_PoolTeardown(poolContext);
+        return DJI_ERROR_SYSTEM_MODULE_CODE_MEMORY_ALLOC_FAILED;
+    }
+
+    /* One spare item so the rotate case can insert before it removes. */
+    if (UtilPool_Init(&poolContext->pool, poolContext->poolMemory, poolSize, sizeof(T_DjiBenchmarkPoolItem)) !=
+        DJI_ERROR_SYSTEM_MODULE_CODE_SUCCESS ||
+        UtilHashMap_Init(&poolContext->map, poolContext->mapMemory, mapSize) != DJI_ERROR_SYSTEM_MODULE_CODE_SUCCESS) {
+        DjiBenchmark_PoolTeardown(poolContext);
+        return DJI_ERROR_SYSTEM_MODULE_CODE_SYSTEM_ERROR;
+    }
+
+    UtilDlist_Init(&poolContext->list);
+    for (i = 0; i < itemNum; i++) {
+        item = UtilPool_Alloc(&poolContext->pool);
+        item->key = DjiBenchmark_PoolGetKey(i);
+        item->payload = i;
+        UtilDlist_AddLast(&poolContext->list, &item->listNode);
+        if (UtilHashMap_Put(&poolContext->map, item->key, item) != DJI_ERROR_SYSTEM_MODULE_CODE_SUCCESS) {
+            DjiBenchmark_PoolTeardown(poolContext);
+            return DJI_ERROR_SYSTEM_MODULE_CODE_SYSTEM_ERROR;
+        }
+    }
+
+    *context = poolContext;
+
+    return DJI_ERROR_SYSTEM_MODULE_CODE_SUCCESS;
+}
+
+static T_DjiReturnCode DjiBenchmark_PoolAllocFree(void *context, uint32_t iterations)
+{
+    T_DjiBenchmarkPoolContext *poolContext = context;
+    void *object;
+    uint32_t i;
+
+    for (i = 0; i < iterations; i++) {
+        object = UtilPool_Alloc(&poolContext->pool);
+        if (object == NULL) {
+            return DJI_ERROR_SYSTEM_MODULE_CODE_MEMORY_ALLOC_FAILED;
+        }
+        UtilPool_Free(&poolContext->pool, object);
+    }
+
+    return DJI_ERROR_SYSTEM_MODULE_CODE_SUCCESS;
+}
+
+static T_DjiReturnCode DjiBenchmark_DlistRotate(void *context, uint32_t iterations)
+{
+    T_DjiBenchmarkPoolContext *poolContext = context;
+    T_DjiBenchmarkPoolItem *item;
+    T_UtilDlistNode *node;
+    uint32_t i;
+
+    for (i = 0; i < iterations; i++) {
+        item = UtilPool_Alloc(&poolContext->pool);
+        if (item == NULL) {
+            return DJI_ERROR_SYSTEM_MODULE_CODE_MEMORY_ALLOC_FAILED;
+        }
+        item->payload = i;
+        UtilDlist_AddLast(&poolContext->list, &item->listNode);
+
+        node = UtilDlist_RemoveFirst(&poolContext->list);
+        UtilPool_Free(&poolContext->pool, UTIL_DLIST_ENTRY(node, T_DjiBenchmarkPoolItem, listNode));
+    }
+
+    return UtilDlist_GetCount(&poolContext->list) == poolContext->itemNum ? DJI_ERROR_SYSTEM_MODULE_CODE_SUCCESS :
+           DJI_ERROR_SYSTEM_MODULE_CODE_SYSTEM_ERROR;
+}
+
+static T_DjiReturnCode DjiBenchmark_HashMapGet(void *context, uint32_t iterations)
+{
+    T_DjiBenchmarkPoolContext *poolContext = context;
+    T_DjiBenchmarkPoolItem *item;
+    uint32_t i;
+
+    for (i = 0; i < iterations; i++) {
+        poolContext->cursor = (poolContext->cursor + 1) % poolContext->itemNum;
+        item = UtilHashMap_Get(&poolContext->map, DjiBenchmark_PoolGetKey(poolContext->cursor));
+        if (item == NULL || item->payload != poolContext->cursor) {
+            return DJI_ERROR_SYSTEM_MODULE_CODE_SYSTEM_ERROR;
+        }
+    }
+
+    return DJI_ERROR_SYSTEM_MODULE_CODE_SUCCESS;
+}
+
+static T_DjiReturnCode DjiBenchmark_HashMapRemovePut(void *context, uint32_t iterations)
+{
+    T_DjiBenchmarkPoolContext *poolContext = context;
+    T_DjiBenchmarkPoolItem *item;
+    uint32_t i;
+
+    for (i = 0; i < iterations; i++) {
+        poolContext->cursor = (poolContext->cursor + 1) % poolContext->itemNum;
+        item = UtilHashMap_Remove(&poolContext->map, DjiBenchmark_PoolGetKey(poolContext->cursor));
+        if (item == NULL || UtilHashMap_Put(&poolContext->map, item->key, item) != DJI_ERROR_SYSTEM_MODULE_CODE_SUCCESS) {
+            return DJI_ERROR_SYSTEM_MODULE_CODE_SYSTEM_ERROR;
+        }
+    }
+
+    return DJI_ERROR_SYSTEM_MODULE_CODE_SUCCESS;
+}
+
+static T_DjiReturnCode DjiBenchmark_HashMapIterateRemove(void *context, uint32_t iterations)
+{
+    T_DjiBenchmarkPoolContext *poolContext = context;
+    T_UtilHashMapIterator iterator;
+    T_DjiBenchmarkPoolItem *item;
+    T_UtilDlistNode *node;
+    T_UtilDlistNode *next;
+    uint32_t visited;
+    uint32_t i;
+
+    for (i = 0; i < iterations; i++) {
+        visited = 0;
+        UtilHashMap_IteratorInit(&poolContext->map, &iterator);
+        while (UtilHashMap_IteratorNext(&poolContext->map, &iterator, NULL, (void **) &item)) {
+            UtilHashMap_RemoveCurrent(&poolContext->map, &iterator);
+            visited++;
+        }
+
+        if (visited != poolContext->itemNum || UtilHashMap_GetCount(&poolContext->map) != 0) {
+            return DJI_ERROR_SYSTEM_MODULE_CODE_SYSTEM_ERROR;
+        }
+
+        UTIL_DLIST_FOR_EACH_SAFE(&poolContext->list, node, next) {
+            item = UTIL_DLIST_ENTRY(node, T_DjiBenchmarkPoolItem, listNode);
+            UtilHashMap_Put(&poolContext->map, item->key, item);
+        }
+    }
+
+    return DJI_ERROR_SYSTEM_MODULE_CODE_SUCCESS;
+}
+
+static uint64_t DjiBenchmark_PoolGetKey(uint32_t index)
+{
+    return DJI_BENCHMARK_POOL_MAP_KEY_BASE + index;
+}
+
+static void DjiBenchmark_PoolTeardown(void *context)
+{
+    T_DjiBenchmarkPoolContext *poolContext = context;
+
+    if (poolContext == NULL) {
+        return;
+    }
+
+    free(poolContext->poolMemory);
+    free(poolContext->mapMemory);
+    free(poolContext);
+}
+
+/****************** (C) COPYRIGHT DJI Innovations *****END OF FILE****/
@@ -0,0 +1,481 @@
+/**
+ ********************************************************************
+ * @file    dji_benchmark_ring.c
+ * @brief   Benchmark cases of the util_ring spsc byte ring and mpmc message queue.
+ *
+ * @copyright (c) 2021 DJI. All rights reserved.
+ *
+ * All information contained herein is, and remains, the property of DJI.
+ * The intellectual and technical concepts contained herein are proprietary
+ * to DJI and may be covered by U.S. and foreign patents, patents in process,
+ * and protected by trade secret or copyright law.  Dissemination of this
+ * information, including but not limited to data and other proprietary
+ * material(s) incorporated within the information, in any form, is strictly
+ * prohibited without the express written consent of DJI.
+ *
+ * If you receive this source code without DJI’s authorization, you may not
+ * further disseminate the information, and you must immediately remove the
+ * source code and notify DJI of its removal. DJI reserves the right to pursue
+ * legal actions against you for any loss(es) or damage(s) caused by your
+ * failure to do so.
+ *
+ *********************************************************************
+ */
+
+/* Includes ------------------------------------------------------------------*/
+#include "dji_benchmark.h"
+#include <stdlib.h>
+#include <string.h>
+#include "osal/osal.h"
+#include "utils/util_ring.h"
+
+/* Private constants ---------------------------------------------------------*/
+#define DJI_BENCHMARK_RING_SIZE                 (1024 * 1024)
+#define DJI_BENCHMARK_RING_CHUNK_SIZE           4096
+#define DJI_BENCHMARK_RING_SLOT_COUNT           1024
+#define DJI_BENCHMARK_RING_SLOT_SIZE            64
+#define DJI_BENCHMARK_RING_PRODUCER_NUM         2
+#define DJI_BENCHMARK_RING_WAIT_MS              100
+#define DJI_BENCHMARK_RING_TASK_STACK_SIZE      2048
+#define DJI_BENCHMARK_RING_WORD_NUM             (DJI_BENCHMARK_RING_CHUNK_SIZE / sizeof(uint32_t))
+
+/* Private types -------------------------------------------------------------*/
+/**
+ * @brief A message of the mpmc stream, the payload bytes are derived from the producer and the sequence.
+ */
+typedef struct {
+    uint32_t producerIndex;
+    uint32_t sequence;
+    uint8_t payload[DJI_BENCHMARK_RING_SLOT_SIZE - 2 * sizeof(uint32_t)];
+} T_DjiBenchmarkRingMessage;
+
+struct T_DjiBenchmarkRingContext;
+
+typedef struct {
+    struct T_DjiBenchmarkRingContext *ringContext;
+    uint32_t index;
+} T_DjiBenchmarkRingProducer;
+
+typedef struct T_DjiBenchmarkRingContext {
+    T_UtilRingSpsc spsc;
+    T_UtilRingMpmc mpmc;
+    uint8_t *memory;
+    uint8_t chunk[DJI_BENCHMARK_RING_CHUNK_SIZE];
+    uint8_t readChunk[DJI_BENCHMARK_RING_CHUNK_SIZE];
+    T_DjiTaskHandle producers[DJI_BENCHMARK_RING_PRODUCER_NUM];
+    T_DjiBenchmarkRingProducer producerArgs[DJI_BENCHMARK_RING_PRODUCER_NUM];
+    uint32_t producerNum;
+    uint32_t sequence;                          /*!< Next word or message the consumer expects. */
+    uint32_t producerSequences[DJI_BENCHMARK_RING_PRODUCER_NUM];
+    bool stop;
+} T_DjiBenchmarkRingContext;
+
+/* Private functions declaration ---------------------------------------------*/
+static T_DjiReturnCode DjiBenchmark_SpscSetup(const T_DjiBenchmarkConfig *config, void *param, void **context);
+static T_DjiReturnCode DjiBenchmark_SpscPutGet(void *context, uint32_t iterations);
+static T_DjiReturnCode DjiBenchmark_SpscReserveCommit(void *context, uint32_t iterations);
+static T_DjiReturnCode DjiBenchmark_SpscStreamSetup(const T_DjiBenchmarkConfig *config, void *param, void **context);
+static T_DjiReturnCode DjiBenchmark_SpscStream(void *context, uint32_t iterations);
+static void *DjiBenchmark_SpscProducerTask(void *arg);
+static T_DjiReturnCode DjiBenchmark_MpmcSetup(const T_DjiBenchmarkConfig *config, void *param, void **context);
+static T_DjiReturnCode DjiBenchmark_MpmcPushPop(void *context, uint32_t iterations);
+static T_DjiReturnCode DjiBenchmark_MpmcStreamSetup(const T_DjiBenchmarkConfig *config, void *param, void **context);
+static T_DjiReturnCode DjiBenchmark_MpmcStream(void *context, uint32_t iterations);
+static void *DjiBenchmark_MpmcProducerTask(void *arg);
+static void DjiBenchmark_RingTeardown(void *context);
+static void DjiBenchmark_RingFillMessage(T_DjiBenchmarkRingMessage *message, uint32_t producerIndex,
+                                         uint32_t sequence);
+static bool DjiBenchmark_RingCheckMessage(const T_DjiBenchmarkRingMessage *message, uint32_t producerIndex,
+                                          uint32_t sequence);
+
+/* Private values ------------------------------------------------------------*/
+
+/* Exported functions definition ---------------------------------------------*/
+T_DjiReturnCode DjiBenchmark_RunRingCases(const T_DjiBenchmarkConfig *config, FILE *output)
+{
+    T_DjiBenchmarkCase benchCase;
+
+    benchCase = (T_DjiBenchmarkCase) {
+        .name = "util_ring/spsc_put_get/4096", .bytesPerOp = DJI_BENCHMARK_RING_CHUNK_SIZE,
+        .Setup = DjiBenchmark_SpscSetup, .Run = DjiBenchmark_SpscPutGet, .Teardown = DjiBenchmark_RingTeardown,
+    };
+    DjiBenchmark_RunCase(config, &benchCase, output);
+
+    benchCase.name = "util_ring/spsc_reserve_commit/4096";
+    benchCase.Run = DjiBenchmark_SpscReserveCommit;
+    DjiBenchmark_RunCase(config, &benchCase, output);
+
+    benchCase = (T_DjiBenchmarkCase) {
+        .name = "util_ring/spsc_stream/4096", .bytesPerOp = DJI_BENCHMARK_RING_CHUNK_SIZE,
+        .Setup = DjiBenchmark_SpscStreamSetup, .Run = DjiBenchmark_SpscStream,
+        .Teardown = DjiBenchmark_RingTeardown,
+    };
+    DjiBenchmark_RunCase(config, &benchCase, output);
+
+    benchCase = (T_DjiBenchmarkCase) {
+        .name = "util_ring/mpmc_push_pop/64", .bytesPerOp = DJI_BENCHMARK_RING_SLOT_SIZE,
+        .Setup = DjiBenchmark_MpmcSetup, .Run = DjiBenchmark_MpmcPushPop, .Teardown = DjiBenchmark_RingTeardown,
+    };
+    DjiBenchmark_RunCase(config, &benchCase, output);
+
+    benchCase = (T_DjiBenchmarkCase) {
+        .name = "util_ring/mpmc_stream_2p1c/64", .bytesPerOp = DJI_BENCHMARK_RING_SLOT_SIZE,
+        .Setup = DjiBenchmark_MpmcStreamSetup, .Run = DjiBenchmark_MpmcStream,
+        .Teardown = DjiBenchmark_RingTeardown,
+    };
+    DjiBenchmark_RunCase(config, &benchCase, output);
+
+    return DJI_ERROR_SYSTEM_MODULE_CODE_SUCCESS;
+}
+
+/* Private functions definition-----------------------------------------------*/
+static T_DjiReturnCode DjiBenchmark_SpscSetup(const T_DjiBenchmarkConfig *config, void *param, void **context)
+{
+    T_DjiReturnCode returnCode;
+    T_DjiBenchmarkRingContext *ringContext;
+
+    (void) config;
+
+    ringContext = calloc(1, sizeof(T_DjiBenchmarkRingContext));
+    if (ringContext == NULL) {
+        return DJI_ERROR_SYSTEM_MODULE_CODE_MEMORY_ALLOC_FAILED;
+    }
+
+    ringContext->memory = malloc(DJI_BENCHMARK_RING_SIZE);
+    if (ringContext->memory == NULL) {
+        free(ringContext);
+        return DJI_ERROR_SYSTEM_MODULE_CODE_MEMORY_ALLOC_FAILED;
+    }
+
+    returnCode = UtilRingSpsc_Init(&ringContext->spsc, ringContext->memory, DJI_BENCHMARK_RING_SIZE, param != NULL);
+    if (returnCode != DJI_ERROR_SYSTEM_MODULE_CODE_SUCCESS) {
+        free(ringContext->memory);
+        free(ringContext);
+        return returnCode;
+    }
+
+    *context = ringContext;
+
+    return DJI_ERROR_SYSTEM_MODULE_CODE_SUCCESS;
+}
+
+static T_DjiReturnCode DjiBenchmark_SpscPutGet(void *context, uint32_t iterations)
+{
+    T_DjiBenchmarkRingContext *ringContext = context;
+    uint32_t i;
+
+    /* The first and the last word carry the sequence, a chunk read back out of order or torn is found. */
+    for (i = 0; i < iterations; i++) {
+        ringContext->sequence++;
+        memcpy(ringContext->chunk, &ringContext->sequence, sizeof(uint32_t));
+        memcpy(ringContext->chunk + sizeof(ringContext->chunk) - sizeof(uint32_t), &ringContext->sequence,
+               sizeof(uint32_t));
+        if (UtilRingSpsc_Put(&ringContext->spsc, ringContext->chunk, sizeof(ringContext->chunk)) !=
+            sizeof(ringContext->chunk)) {
+            return DJI_ERROR_SYSTEM_MODULE_CODE_SYSTEM_ERROR;
+        }
+        if (UtilRingSpsc_Get(&ringContext->spsc, ringContext->readChunk, sizeof(ringContext->readChunk)) !=
+            sizeof(ringContext->readChunk) ||
+            memcmp(ringContext->readChunk, ringContext->chunk, sizeof(uint32_t)) != 0 ||
+            memcmp(ringContext->readChunk + sizeof(ringContext->readChunk) - sizeof(uint32_t),
+                   &ringContext->sequence, sizeof(uint32_t)) != 0) {
+            return DJI_ERROR_SYSTEM_MODULE_CODE_SYSTEM_ERROR;
+        }
+    }
+
+    return DJI_ERROR_SYSTEM_MODULE_CODE_SUCCESS;
+}
+
+static T_DjiReturnCode DjiBenchmark_SpscReserveCommit(void *context, uint32_t iterations)
+{
+    T_DjiBenchmarkRingContext *ringContext = context;
+    const uint8_t *readRegion;
+    uint8_t *writeRegion;
+    size_t len;
+    uint32_t i;
+
+    /* The chunk size divides the ring size, so every region is contiguous and no copy is done at all. */
+    for (i = 0; i < iterations; i++) {
+        len = UtilRingSpsc_Reserve(&ringContext->spsc, &writeRegion, DJI_BENCHMARK_RING_CHUNK_SIZE);
+        if (len != DJI_BENCHMARK_RING_CHUNK_SIZE) {
+            return DJI_ERROR_SYSTEM_MODULE_CODE_SYSTEM_ERROR;
+        }
+        writeRegion[0] = (uint8_t) i;
+        writeRegion[len - 1] = (uint8_t) ~i;
+        UtilRingSpsc_Commit(&ringContext->spsc, len);
+
+        len = UtilRingSpsc_Peek(&ringContext->spsc, &readRegion, DJI_BENCHMARK_RING_CHUNK_SIZE);
+        if (len != DJI_BENCHMARK_RING_CHUNK_SIZE || readRegion[0] != (uint8_t) i ||
+            readRegion[len - 1] != (uint8_t) ~i) {
+            return DJI_ERROR_SYSTEM_MODULE_CODE_SYSTEM_ERROR;
+        }
+        UtilRingSpsc_Consume(&ringContext->spsc, len);
+    }
+
+    return DJI_ERROR_SYSTEM_MODULE_CODE_SUCCESS;
+}
+
+static T_DjiReturnCode DjiBenchmark_SpscStreamSetup(const T_DjiBenchmarkConfig *config, void *param, void **context)
+{
+    T_DjiReturnCode returnCode;
+    T_DjiBenchmarkRingContext *ringContext = NULL;
+
+    (void) param;
+
+    returnCode = DjiBenchmark_SpscSetup(config, (void *) 1, (void **) &ringContext);
+    if (returnCode != DJI_ERROR_SYSTEM_MODULE_CODE_SUCCESS) {
+        return returnCode;
+    }
+
+    returnCode = Osal_TaskCreate("bench_spsc", DjiBenchmark_SpscProducerTask, DJI_BENCHMARK_RING_TASK_STACK_SIZE,
+                                 ringContext, &ringContext->producers[0]);
+    if (returnCode != DJI_ERROR_SYSTEM_MODULE_CODE_SUCCESS) {
+        DjiBenchmark_RingTeardown(ringContext);
+        return returnCode;
+    }
+    ringContext->producerNum = 1;
+
+    *context = ringContext;
+
+    return DJI_ERROR_SYSTEM_MODULE_CODE_SUCCESS;
+}
+
+static T_DjiReturnCode DjiBenchmark_SpscStream(void *context, uint32_t iterations)
+{
+    T_DjiReturnCode returnCode;
+    T_DjiBenchmarkRingContext *ringContext = context;
+    uint32_t words[DJI_BENCHMARK_RING_WORD_NUM];
+    uint32_t i;
+    uint32_t j;
+
+    /* The producer writes consecutive words, any lost, repeated or reordered byte breaks the count. */
+    for (i = 0; i < iterations; i++) {
+        returnCode = UtilRingSpsc_WaitForData(&ringContext->spsc, sizeof(words), DJI_BENCHMARK_RING_WAIT_MS);
+        if (returnCode != DJI_ERROR_SYSTEM_MODULE_CODE_SUCCESS) {
+            return returnCode;
+        }
+        if (UtilRingSpsc_Get(&ringContext->spsc, (uint8_t *) words, sizeof(words)) != sizeof(words)) {
+            return DJI_ERROR_SYSTEM_MODULE_CODE_SYSTEM_ERROR;
+        }
+        for (j = 0; j < DJI_BENCHMARK_RING_WORD_NUM; j++) {
+            if (words[j] != ringContext->sequence++) {
+                return DJI_ERROR_SYSTEM_MODULE_CODE_SYSTEM_ERROR;
+            }
+        }
+    }
+
+    return DJI_ERROR_SYSTEM_MODULE_CODE_SUCCESS;
+}
+
+static void *DjiBenchmark_SpscProducerTask(void *arg)
+{
+    T_DjiBenchmarkRingContext *ringContext = arg;
+    uint32_t words[DJI_BENCHMARK_RING_WORD_NUM];
+    uint32_t sequence = 0;
+    uint32_t i;
+
+    while (!__atomic_load_n(&ringContext->stop, __ATOMIC_ACQUIRE)) {
+        if (UtilRingSpsc_WaitForSpace(&ringContext->spsc, sizeof(words), DJI_BENCHMARK_RING_WAIT_MS) !=
+            DJI_ERROR_SYSTEM_MODULE_CODE_SUCCESS) {
+            continue;
+        }
+        for (i = 0; i < DJI_BENCHMARK_RING_WORD_NUM; i++) {
+            words[i] = sequence++;
+        }
+        UtilRingSpsc_Put(&ringContext->spsc, (uint8_t *) words, sizeof(words));
+    }
+
+    return NULL;
+}
+
+static T_DjiReturnCode DjiBenchmark_MpmcSetup(const T_DjiBenchmarkConfig *config, void *param, void **context)
+{
+    T_DjiReturnCode returnCode;
+    T_DjiBenchmarkRingContext *ringContext;
+    size_t memorySize;
+
+    (void) config;
+
+    ringContext = calloc(1, sizeof(T_DjiBenchmarkRingContext));
+    if (ringContext == NULL) {
+        return DJI_ERROR_SYSTEM_MODULE_CODE_MEMORY_ALLOC_FAILED;
+    }
+
+    memorySize = UtilRingMpmc_GetMemorySize(DJI_BENCHMARK_RING_SLOT_COUNT, DJI_BENCHMARK_RING_SLOT_SIZE);
+    ringContext->memory = malloc(memorySize);
+    if (ringContext->memory == NULL) {
+        free(ringContext);
+        return DJI_ERROR_SYSTEM_MODULE_CODE_MEMORY_ALLOC_FAILED;
+    }
+
+    returnCode = UtilRingMpmc_Init(&ringContext->mpmc, ringContext->memory, memorySize, DJI_BENCHMARK_RING_SLOT_SIZE,
+                                   param != NULL);
+    if (returnCode != DJI_ERROR_SYSTEM_MODULE_CODE_SUCCESS) {
+        free(ringContext->memory);
+        free(ringContext);
+        return returnCode;
+    }
+
+    *context = ringContext;
+
+    return DJI_ERROR_SYSTEM_MODULE_CODE_SUCCESS;
+}
+
+static T_DjiReturnCode DjiBenchmark_MpmcPushPop(void *context, uint32_t iterations)
+{
+    T_DjiReturnCode returnCode;
+    T_DjiBenchmarkRingContext *ringContext = context;
+    T_DjiBenchmarkRingMessage message;
+    T_DjiBenchmarkRingMessage readMessage;
+    size_t len = 0;
+    uint32_t i;
+
+    for (i = 0; i < iterations; i++) {
+        DjiBenchmark_RingFillMessage(&message, 0, ringContext->sequence);
+        returnCode = UtilRingMpmc_Push(&ringContext->mpmc, &message, sizeof(message));
+        if (returnCode != DJI_ERROR_SYSTEM_MODULE_CODE_SUCCESS) {
+            return returnCode;
+        }
+        returnCode = UtilRingMpmc_Pop(&ringContext->mpmc, &readMessage, sizeof(readMessage), &len);
+        if (returnCode != DJI_ERROR_SYSTEM_MODULE_CODE_SUCCESS) {
+            return returnCode;
+        }
+        if (len != sizeof(readMessage) || !DjiBenchmark_RingCheckMessage(&readMessage, 0, ringContext->sequence++)) {
+            return DJI_ERROR_SYSTEM_MODULE_CODE_SYSTEM_ERROR;
+        }
+    }
+
+    return DJI_ERROR_SYSTEM_MODULE_CODE_SUCCESS;
+}
+
+static T_DjiReturnCode DjiBenchmark_MpmcStreamSetup(const T_DjiBenchmarkConfig *config, void *param, void **context)
+{
+    T_DjiReturnCode returnCode;
+    T_DjiBenchmarkRingContext *ringContext = NULL;
+    uint32_t i;
+
+    (void) param;
+
+    returnCode = DjiBenchmark_MpmcSetup(config, (void *) 1, (void **) &ringContext);
+    if (returnCode != DJI_ERROR_SYSTEM_MODULE_CODE_SUCCESS) {
+        return returnCode;
+    }
+
+    for (i = 0; i < DJI_BENCHMARK_RING_PRODUCER_NUM; i++) {
+        ringContext->producerArgs[i].ringContext = ringContext;
+        ringContext->producerArgs[i].index = i;
+        returnCode = Osal_TaskCreate("bench_mpmc", DjiBenchmark_MpmcProducerTask, DJI_BENCHMARK_RING_TASK_STACK_SIZE,
+                                     &ringContext->producerArgs[i], &ringContext->producers[i]);
+        if (returnCode != DJI_ERROR_SYSTEM_MODULE_CODE_SUCCESS) {
+            DjiBenchmark_RingTeardown(ringContext);
+            return returnCode;
+        }
+        ringContext->producerNum++;
+    }
+
+    *context = ringContext;
+
+    return DJI_ERROR_SYSTEM_MODULE_CODE_SUCCESS;
+}
+
+static T_DjiReturnCode DjiBenchmark_MpmcStream(void *context, uint32_t iterations)
+{
+    T_DjiReturnCode returnCode;
+    T_DjiBenchmarkRingContext *ringContext = context;
+    T_DjiBenchmarkRingMessage message;
+    size_t len = 0;
+    uint32_t i;
+
+    /* One consumer sees the messages of each producer in the order pushed, none lost or repeated. */
+    for (i = 0; i < iterations; i++) {
+        returnCode = UtilRingMpmc_PopWait(&ringContext->mpmc, &message, sizeof(message), &len,
+                                          DJI_BENCHMARK_RING_WAIT_MS);
+        if (returnCode != DJI_ERROR_SYSTEM_MODULE_CODE_SUCCESS) {
+            return returnCode;
+        }
+        if (len != sizeof(message) || message.producerIndex >= DJI_BENCHMARK_RING_PRODUCER_NUM ||
+            !DjiBenchmark_RingCheckMessage(&message, message.producerIndex,
+                                           ringContext->producerSequences[message.producerIndex]++)) {
+            return DJI_ERROR_SYSTEM_MODULE_CODE_SYSTEM_ERROR;
+        }
+    }
+
+    return DJI_ERROR_SYSTEM_MODULE_CODE_SUCCESS;
+}
+
+static void *DjiBenchmark_MpmcProducerTask(void *arg)
+{
+    T_DjiBenchmarkRingProducer *producer = arg;
+    T_DjiBenchmarkRingContext *ringContext = producer->ringContext;
+    T_DjiBenchmarkRingMessage message;
+    uint32_t sequence = 0;
+
+    DjiBenchmark_RingFillMessage(&message, producer->index, sequence);
+    while (!__atomic_load_n(&ringContext->stop, __ATOMIC_ACQUIRE)) {
+        if (UtilRingMpmc_PushWait(&ringContext->mpmc, &message, sizeof(message), DJI_BENCHMARK_RING_WAIT_MS) ==
+            DJI_ERROR_SYSTEM_MODULE_CODE_SUCCESS) {
+            DjiBenchmark_RingFillMessage(&message, producer->index, ++sequence);
+        }
+    }
+
+    return NULL;
+}
+
+static void DjiBenchmark_RingTeardown(void *context)
+{
+    T_DjiBenchmarkRingContext *ringContext = context;
+    pthread_t thread;
+    uint32_t i;
+
+    if (ringContext == NULL) {
+        return;
+    }
+
+    /* Producers only block in timed waits, they notice the stop flag within one wait period. */
+    __atomic_store_n(&ringContext->stop, true, __ATOMIC_RELEASE);
+    for (i = 0; i < ringContext->producerNum; i++) {
+        thread = *(pthread_t *) ringContext->producers[i];
+        pthread_join(thread, NULL);
+        free(ringContext->producers[i]);
+    }
+
+    if (ringContext->spsc.buffer != NULL) {
+        UtilRingSpsc_DeInit(&ringContext->spsc);
+    }
+    if (ringContext->mpmc.slots != NULL) {
+        UtilRingMpmc_DeInit(&ringContext->mpmc);
+    }
+    free(ringContext->memory);
+    free(ringContext);
+}
+
+static void DjiBenchmark_RingFillMessage(T_DjiBenchmarkRingMessage *message, uint32_t producerIndex,
+                                         uint32_t sequence)
+{
+    uint32_t i;
+
+    message->producerIndex = producerIndex;
+    message->sequence = sequence;
+    for (i = 0; i < sizeof(message->payload); i++) {
+        message->payload[i] = (uint8_t) (sequence * 31 + producerIndex * 7 + i);
+    }
+}
+
+static bool DjiBenchmark_RingCheckMessage(const T_DjiBenchmarkRingMessage *message, uint32_t producerIndex,
+                                          uint32_t sequence)
+{
+    uint32_t i;
+
+    if (message->producerIndex != producerIndex || message->sequence != sequence) {
+        return false;
+    }
+    for (i = 0; i < sizeof(message->payload); i++) {
+        if (message->payload[i] != (uint8_t) (sequence * 31 + producerIndex * 7 + i)) {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+/****************** (C) COPYRIGHT DJI Innovations *****END OF FILE****/
@@ -0,0 +1,228 @@
+/**
+ ********************************************************************
+ * @file    dji_benchmark_stream.c
+ * @brief   Benchmark cases of the framed data stream messages over a loopback channel.
+ *
+ * @copyright (c) 2021 DJI. All rights reserved.
+ *
+ * All information contained herein is, and remains, the property of DJI.
+ * The intellectual and technical concepts contained herein are proprietary
+ * to DJI and may be covered by U.S. and foreign patents, patents in process,
+ * and protected by trade secret or copyright law.  Dissemination of this
+ * information, including but not limited to data and other proprietary
+ * material(s) incorporated within the information, in any form, is strictly
+ * prohibited without the express written consent of DJI.
+ *
+ * If you receive this source code without DJI’s authorization, you may not
+ * further disseminate the information, and you must immediately remove the
+ * source code and notify DJI of its removal. DJI reserves the right to pursue
+ * legal actions against you for any loss(es) or damage(s) caused by your
+ * failure to do so.
+ *
+ *********************************************************************
+ */
+
+/* Includes ------------------------------------------------------------------*/
+#include "dji_benchmark.h"
+#include <stdlib.h>
+#include <string.h>
+#include "data_transmission/test_data_stream_message.h"
+
+/* Private constants ---------------------------------------------------------*/
+#define DJI_BENCHMARK_STREAM_SMALL_SIZE         (60 * 1024)
+#define DJI_BENCHMARK_STREAM_LARGE_SIZE         (4 * 1024 * 1024)
+#define DJI_BENCHMARK_STREAM_PIECE_NUM          (4)
+
+/* Private types -------------------------------------------------------------*/
+typedef struct {
+    uint32_t messageSize;
+    uint32_t reorderDepth;
+    uint32_t flags;
+} T_DjiBenchmarkStreamParam;
+
+typedef struct {
+    const T_DjiBenchmarkStreamParam *param;
+    T_DjiTestDataStreamReceiver receiver;
+    T_DjiTestDataStreamLoopback loopback;
+    T_DjiTestDataStreamSender sender;
+    T_DjiTestDataStreamIov iov[DJI_BENCHMARK_STREAM_PIECE_NUM];
+    uint32_t receivedCount;
+    uint8_t *data;
+} T_DjiBenchmarkStreamContext;
+
+/* Private functions declaration ---------------------------------------------*/
+static T_DjiReturnCode DjiBenchmark_StreamSetup(const T_DjiBenchmarkConfig *config, void *param, void **context);
+static T_DjiReturnCode DjiBenchmark_StreamSendMessage(void *context, uint32_t iterations);
+static void DjiBenchmark_StreamTeardown(void *context);
+static void DjiBenchmark_StreamOnMessage(void *userData, uint32_t messageId, const uint8_t *data, uint32_t len);
+
+/* Private values ------------------------------------------------------------*/
+static const T_DjiBenchmarkStreamParam s_streamSmallParam = {DJI_BENCHMARK_STREAM_SMALL_SIZE, 0, 0};
+static const T_DjiBenchmarkStreamParam s_streamLargeParam = {DJI_BENCHMARK_STREAM_LARGE_SIZE, 0, 0};
+static const T_DjiBenchmarkStreamParam s_streamReorderParam = {DJI_BENCHMARK_STREAM_LARGE_SIZE, 8, 0};
+static const T_DjiBenchmarkStreamParam s_streamLz4Param = {
+    DJI_BENCHMARK_STREAM_LARGE_SIZE, 0, DJI_TEST_DATA_STREAM_FLAG_COMPRESSED
+};
+
+/* Exported functions definition ---------------------------------------------*/
+T_DjiReturnCode DjiBenchmark_RunStreamCases(const T_DjiBenchmarkConfig *config, FILE *output)
+{
+    T_DjiBenchmarkCase benchCase;
+
+    /* One operation is a message sent, framed, checksummed, reassembled and delivered to the callback. */
+    benchCase = (T_DjiBenchmarkCase) {
+        .name = "stream/loopback/60k", .bytesPerOp = DJI_BENCHMARK_STREAM_SMALL_SIZE,
+        .Setup = DjiBenchmark_StreamSetup, .Run = DjiBenchmark_StreamSendMessage,
+        .Teardown = DjiBenchmark_StreamTeardown, .param = (void *) &s_streamSmallParam,
+    };
+    DjiBenchmark_RunCase(config, &benchCase, output);
+
+    benchCase.name = "stream/loopback/4m";
+    benchCase.bytesPerOp = DJI_BENCHMARK_STREAM_LARGE_SIZE;
+    benchCase.maxBatch = 4;
+    benchCase.maxSamples = 200;
+    benchCase.param = (void *) &s_streamLargeParam;
+    DjiBenchmark_RunCase(config, &benchCase, output);
+
+    benchCase.name = "stream/loopback/4m_reorder";
+    benchCase.param = (void *) &s_streamReorderParam;
+    DjiBenchmark_RunCase(config, &benchCase, output);
+
+    benchCase.name = "stream/loopback/4m_lz4";
+    benchCase.param = (void *) &s_streamLz4Param;
+    DjiBenchmark_RunCase(config, &benchCase, output);
+
+    return DJI_ERROR_SYSTEM_MODULE_CODE_SUCCESS;
+}
+
+/* Private functions definition-----------------------------------------------*/
+static T_DjiReturnCode DjiBenchmark_StreamSetup(const T_DjiBenchmarkConfig *config, void *param, void **context)
+{
+    T_DjiBenchmarkStreamContext *streamContext;
+    T_DjiTestDataStreamReceiverConfig receiverConfig;
+    T_DjiTestDataStreamSenderConfig senderConfig;
+    T_DjiTestDataStreamChannel channel;
+    T_DjiReturnCode returnCode;
+    uint32_t pieceLen;
+    uint32_t offset = 0;
+    uint32_t i;
+
+    (void) config;
+
+    streamContext = calloc(1, sizeof(T_DjiBenchmarkStreamContext));
+    if (streamContext == NULL) {
+        return DJI_ERROR_SYSTEM_MODULE_CODE_MEMORY_ALLOC_FAILED;
+    }
+    streamContext->param = param;
+
+    streamContext->data = malloc(streamContext->param->messageSize);
+    if (streamContext->data == NULL) {
+        returnCode = DJI_ERROR_SYSTEM_MODULE_CODE_MEMORY_ALLOC_FAILED;
+        goto freeContext;
+    }
+
+    /* Telemetry-like records: repeated field layout with slowly changing values, compressible about like logs. */
+    for (i = 0; i + 32 <= streamContext->param->messageSize; i += 32) {
+        snprintf((char *) streamContext->data + i, 33, "t=%08u,alt=%05u,yaw=%04u,ok\n", i / 32, (i / 256) % 100000,
+                 (i / 64) % 3600);
+    }
+    memset(streamContext->data + i, '\n', streamContext->param->messageSize - i);
+
+    /* The message is handed over as pieces to exercise the gather path, like a header and a body would be. */
+    pieceLen = streamContext->param->messageSize / DJI_BENCHMARK_STREAM_PIECE_NUM;
+    for (i = 0; i < DJI_BENCHMARK_STREAM_PIECE_NUM; i++) {
+        streamContext->iov[i].data = streamContext->data + offset;
+        streamContext->iov[i].len = i + 1 < DJI_BENCHMARK_STREAM_PIECE_NUM ? pieceLen :
+                                    streamContext->param->messageSize - offset;
+        offset += streamContext->iov[i].len;
+    }
+
+    DjiTest_DataStreamReceiverGetDefaultConfig(&receiverConfig);
+    receiverConfig.maxMessageSize = streamContext->param->messageSize;
+    receiverConfig.callback = DjiBenchmark_StreamOnMessage;
+    receiverConfig.userData = streamContext;
+    returnCode = DjiTest_DataStreamReceiverInit(&streamContext->receiver, &receiverConfig);
+    if (returnCode != DJI_ERROR_SYSTEM_MODULE_CODE_SUCCESS) {
+        goto freeData;
+    }
+
+    returnCode = DjiTest_DataStreamLoopbackInit(&streamContext->loopback, &streamContext->receiver,
+                                                streamContext->param->reorderDepth);
+    if (returnCode != DJI_ERROR_SYSTEM_MODULE_CODE_SUCCESS) {
+        goto deInitReceiver;
+    }
+    DjiTest_DataStreamLoopbackGetChannel(&streamContext->loopback, &channel);
+
+    DjiTest_DataStreamSenderGetDefaultConfig(&senderConfig);
+    senderConfig.maxMessageSize = streamContext->param->messageSize;
+    returnCode = DjiTest_DataStreamSenderInit(&streamContext->sender, &senderConfig, &channel);
+    if (returnCode != DJI_ERROR_SYSTEM_MODULE_CODE_SUCCESS) {
+        goto deInitLoopback;
+    }
+
+    *context = streamContext;
+
+    return DJI_ERROR_SYSTEM_MODULE_CODE_SUCCESS;
+
+deInitLoopback:
+    DjiTest_DataStreamLoopbackDeInit(&streamContext->loopback);
+deInitReceiver:
+    DjiTest_DataStreamReceiverDeInit(&streamContext->receiver);
+freeData:
+    free(streamContext->data);
+freeContext:
+    free(streamContext);
+
+    return returnCode;
+}
+
+static T_DjiReturnCode DjiBenchmark_StreamSendMessage(void *context, uint32_t iterations)
+{
+    T_DjiBenchmarkStreamContext *streamContext = context;
+    T_DjiReturnCode returnCode;
+    uint32_t i;
+
+    for (i = 0; i < iterations; i++) {
+        streamContext->receivedCount = 0;
+        returnCode = DjiTest_DataStreamSendMessage(&streamContext->sender, streamContext->iov,
+                                                   DJI_BENCHMARK_STREAM_PIECE_NUM, streamContext->param->flags, NULL);
+        if (returnCode != DJI_ERROR_SYSTEM_MODULE_CODE_SUCCESS) {
+            return returnCode;
+        }
+        DjiTest_DataStreamLoopbackFlush(&streamContext->loopback);
+
+        if (streamContext->receivedCount != 1) {
+            return DJI_ERROR_SYSTEM_MODULE_CODE_SYSTEM_ERROR;
+        }
+    }
+
+    return DJI_ERROR_SYSTEM_MODULE_CODE_SUCCESS;
+}
+
+static void DjiBenchmark_StreamTeardown(void *context)
+{
+    T_DjiBenchmarkStreamContext *streamContext = context;
+
+    if (streamContext == NULL) {
+        return;
+    }
+
+    DjiTest_DataStreamSenderDeInit(&streamContext->sender);
+    DjiTest_DataStreamLoopbackDeInit(&streamContext->loopback);
+    DjiTest_DataStreamReceiverDeInit(&streamContext->receiver);
+    free(streamContext->data);
+    free(streamContext);
+}
+
+static void DjiBenchmark_StreamOnMessage(void *userData, uint32_t messageId, const uint8_t *data, uint32_t len)
+{
+    T_DjiBenchmarkStreamContext *streamContext = userData;
+
+    (void) messageId;
+
+    if (len == streamContext->param->messageSize && data[len - 1] == streamContext->data[len - 1]) {
+        streamContext->receivedCount++;
+    }
+}
+
+/****************** (C) COPYRIGHT DJI Innovations *****END OF FILE****/
@@ -0,0 +1,571 @@
+/**
+ ********************************************************************
+ * @file    dji_benchmark_telemetry.c
+ * @brief   Benchmark cases of the shared memory telemetry bus against localhost TCP.
+ *
+ * @copyright (c) 2021 DJI. All rights reserved.
+ *
+ * All information contained herein is, and remains, the property of DJI.
+ * The intellectual and technical concepts contained herein are proprietary
+ * to DJI and may be covered by U.S. and foreign patents, patents in process,
+ * and protected by trade secret or copyright law.  Dissemination of this
+ * information, including but not limited to data and other proprietary
+ * material(s) incorporated within the information, in any form, is strictly
+ * prohibited without the express written consent of DJI.
+ *
+ * If you receive this source code without DJI’s authorization, you may not
+ * further disseminate the information, and you must immediately remove the
+ * source code and notify DJI of its removal. DJI reserves the right to pursue
+ * legal actions against you for any loss(es) or damage(s) caused by your
+ * failure to do so.
+ *
+ *********************************************************************
+ */
+
+/* Includes ------------------------------------------------------------------*/
+#include "dji_benchmark.h"
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <signal.h>
+#include <unistd.h>
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <sys/socket.h>
+#include <sys/wait.h>
+#include "utils/util_misc.h"
+#include "telemetry_bus/test_telemetry_bus.h"
+
+/* Private constants ---------------------------------------------------------*/
+#define DJI_BENCHMARK_TELEMETRY_QUATERNION_SIZE     (16)
+/* One 640x480 8 bit image of the perception cameras. */
+#define DJI_BENCHMARK_TELEMETRY_IMAGE_SIZE          (640 * 480)
+#define DJI_BENCHMARK_TELEMETRY_SLOT_COUNT          (4)
+#define DJI_BENCHMARK_TELEMETRY_TIMEOUT_MS          (1000)
+#define DJI_BENCHMARK_TELEMETRY_CONNECT_TIMEOUT_MS  (5000)
+#define DJI_BENCHMARK_TELEMETRY_CACHE_LINE_SIZE     (64)
+
+/* Private types -------------------------------------------------------------*/
+typedef enum {
+    DJI_BENCHMARK_TELEMETRY_MODE_PUBLISH = 0,       /*!< Publish without subscribers. */
+    DJI_BENCHMARK_TELEMETRY_MODE_ROUNDTRIP_BUS,     /*!< Sample to a forked reader and its acknowledge back, by bus. */
+    DJI_BENCHMARK_TELEMETRY_MODE_ROUNDTRIP_TCP,     /*!< The same over a localhost TCP connection. */
+} E_DjiBenchmarkTelemetryMode;
+
+typedef struct {
+    E_DjiBenchmarkTelemetryMode mode;
+    uint32_t payloadSize;
+} T_DjiBenchmarkTelemetryParam;
+
+typedef struct {
+    T_DjiBenchmarkTelemetryParam param;
+    uint8_t *payload;
+    T_DjiTestTelemetryBus bus;
+    bool isBusCreated;
+    uint16_t topicId;
+    T_DjiTestTelemetryClient ackClient;
+    bool isAckClientOpened;
+    T_DjiTestTelemetrySubscriber ackSubscriber;
+    bool isAckSubscribed;
+    int socketFd;
+    pid_t readerPid;
+    uint64_t sentCount;
+} T_DjiBenchmarkTelemetryContext;
+
+/* Private functions declaration ---------------------------------------------*/
+static T_DjiReturnCode DjiBenchmark_TelemetrySetup(const T_DjiBenchmarkConfig *config, void *param, void **context);
+static T_DjiReturnCode DjiBenchmark_TelemetryRun(void *context, uint32_t iterations);
+static void DjiBenchmark_TelemetryTeardown(void *context);
+static T_DjiReturnCode DjiBenchmark_TelemetryStartBusReader(T_DjiBenchmarkTelemetryContext *telemetryContext);
+static void DjiBenchmark_TelemetryRunBusReader(const char *busName, const char *ackBusName);
+static T_DjiReturnCode DjiBenchmark_TelemetryStartTcpReader(T_DjiBenchmarkTelemetryContext *telemetryContext);
+static void DjiBenchmark_TelemetryRunTcpReader(int socketFd, uint32_t payloadSize);
+static T_DjiReturnCode DjiBenchmark_TelemetryRoundTripBus(T_DjiBenchmarkTelemetryContext *telemetryContext);
+static T_DjiReturnCode DjiBenchmark_TelemetryRoundTripTcp(T_DjiBenchmarkTelemetryContext *telemetryContext);
+static bool DjiBenchmark_TelemetrySendAll(int socketFd, const void *data, uint32_t len);
+static bool DjiBenchmark_TelemetryReceiveAll(int socketFd, void *data, uint32_t len);
+static void DjiBenchmark_TelemetryTouch(const uint8_t *data, uint32_t len);
+static void DjiBenchmark_TelemetryGetBusNames(pid_t pid, char *busName, char *ackBusName);
+
+/* Private values ------------------------------------------------------------*/
+static volatile uint64_t s_telemetryTouchSum;
+static const T_DjiBenchmarkTelemetryParam s_telemetryPublishQuaternionParam = {
+    DJI_BENCHMARK_TELEMETRY_MODE_PUBLISH, DJI_BENCHMARK_TELEMETRY_QUATERNION_SIZE
+};
+static const T_DjiBenchmarkTelemetryParam s_telemetryPublishImageParam = {
+    DJI_BENCHMARK_TELEMETRY_MODE_PUBLISH, DJI_BENCHMARK_TELEMETRY_IMAGE_SIZE
+};
+static const T_DjiBenchmarkTelemetryParam s_telemetryBusQuaternionParam = {
+    DJI_BENCHMARK_TELEMETRY_MODE_ROUNDTRIP_BUS, DJI_BENCHMARK_TELEMETRY_QUATERNION_SIZE
+};
+static const T_DjiBenchmarkTelemetryParam s_telemetryBusImageParam = {
+    DJI_BENCHMARK_TELEMETRY_MODE_ROUNDTRIP_BUS, DJI_BENCHMARK_TELEMETRY_IMAGE_SIZE
+};
+static const T_DjiBenchmarkTelemetryParam s_telemetryTcpQuaternionParam = {
+    DJI_BENCHMARK_TELEMETRY_MODE_ROUNDTRIP_TCP, DJI_BENCHMARK_TELEMETRY_QUATERNION_SIZE
+};
+static const T_DjiBenchmarkTelemetryParam s_telemetryTcpImageParam = {
+    DJI_BENCHMARK_TELEMETRY_MODE_ROUNDTRIP_TCP, DJI_BENCHMARK_TELEMETRY_IMAGE_SIZE
+};
+
+/* Exported functions definition ---------------------------------------------*/
+T_DjiReturnCode DjiBenchmark_RunTelemetryCases(const T_DjiBenchmarkConfig *config, FILE *output)
+{
+    T_DjiBenchmarkCase benchCase;
+
+    /* One operation publishes one sample, the copy into the slot included. */
+    benchCase = (T_DjiBenchmarkCase) {
+        .name = "telemetry/publish/quaternion", .bytesPerOp = DJI_BENCHMARK_TELEMETRY_QUATERNION_SIZE,
+        .maxBatch = 4096, .maxSamples = 0,
+        .Setup = DjiBenchmark_TelemetrySetup, .Run = DjiBenchmark_TelemetryRun,
+        .Teardown = DjiBenchmark_TelemetryTeardown, .param = (void *) &s_telemetryPublishQuaternionParam,
+    };
+    DjiBenchmark_RunCase(config, &benchCase, output);
+
+    benchCase.name = "telemetry/publish/image";
+    benchCase.bytesPerOp = DJI_BENCHMARK_TELEMETRY_IMAGE_SIZE;
+    benchCase.maxBatch = 64;
+    benchCase.param = (void *) &s_telemetryPublishImageParam;
+    DjiBenchmark_RunCase(config, &benchCase, output);
+
+    /* One operation sends a sample to a reader process, which reads every cache line of it and acknowledges. The
+     * bus reader reads the slot in place, the TCP reader receives the sample into its buffer first. */
+    benchCase.name = "telemetry/roundtrip/bus/quaternion";
+    benchCase.bytesPerOp = DJI_BENCHMARK_TELEMETRY_QUATERNION_SIZE;
+    benchCase.maxBatch = 1;
+    benchCase.maxSamples = 5000;
+    benchCase.param = (void *) &s_telemetryBusQuaternionParam;
+    DjiBenchmark_RunCase(config, &benchCase, output);
+
+    benchCase.name = "telemetry/roundtrip/tcp/quaternion";
+    benchCase.param = (void *) &s_telemetryTcpQuaternionParam;
+    DjiBenchmark_RunCase(config, &benchCase, output);
+
+    benchCase.name = "telemetry/roundtrip/bus/image";
+    benchCase.bytesPerOp = DJI_BENCHMARK_TELEMETRY_IMAGE_SIZE;
+    benchCase.maxSamples = 1000;
+    benchCase.param = (void *) &s_telemetryBusImageParam;
+    DjiBenchmark_RunCase(config, &benchCase, output);
+
+    benchCase.name = "telemetry/roundtrip/tcp/image";
+    benchCase.param = (void *) &s_telemetryTcpImageParam;
+    DjiBenchmark_RunCase(config, &benchCase, output);
+
+    return DJI_ERROR_SYSTEM_MODULE_CODE_SUCCESS;
+}
+
+/* Private functions definition-----------------------------------------------*/
+static T_DjiReturnCode DjiBenchmark_TelemetrySetup(const T_DjiBenchmarkConfig *config, void *param, void **context)
+{
+    T_DjiBenchmarkTelemetryContext *telemetryContext;
+    T_DjiReturnCode returnCode = DJI_ERROR_SYSTEM_MODULE_CODE_SUCCESS;
+    uint32_t i;
+
+    USER_UTIL_UNUSED(config);
+
+    telemetryContext = calloc(1, sizeof(T_DjiBenchmarkTelemetryContext));
+    if (telemetryContext == NULL) {
+        return DJI_ERROR_SYSTEM_MODULE_CODE_MEMORY_ALLOC_FAILED;
+    }
+    telemetryContext->param = *(const T_DjiBenchmarkTelemetryParam *) param;
+    telemetryContext->socketFd = -1;
+    telemetryContext->readerPid = -1;
+    *context = telemetryContext;
+
+    telemetryContext->payload = malloc(telemetryContext->param.payloadSize);
+    if (telemetryContext->payload == NULL) {
+        return DJI_ERROR_SYSTEM_MODULE_CODE_MEMORY_ALLOC_FAILED;
+    }
+    for (i = 0; i < telemetryContext->param.payloadSize; i++) {
+        telemetryContext->payload[i] = (uint8_t) (i * 7);
+    }
+
+    switch (telemetryContext->param.mode) {
+        case DJI_BENCHMARK_TELEMETRY_MODE_ROUNDTRIP_TCP:
+            returnCode = DjiBenchmark_TelemetryStartTcpReader(telemetryContext);
+            break;
+        default:
+            returnCode = DjiBenchmark_TelemetryStartBusReader(telemetryContext);
+            break;
+    }
+
+    return returnCode;
+}
+
+static T_DjiReturnCode DjiBenchmark_TelemetryRun(void *context, uint32_t iterations)
+{
+    T_DjiBenchmarkTelemetryContext *telemetryContext = context;
+    T_DjiReturnCode returnCode;
+    uint32_t i;
+
+    for (i = 0; i < iterations; i++) {
+        switch (telemetryContext->param.mode) {
+            case DJI_BENCHMARK_TELEMETRY_MODE_PUBLISH:
+                returnCode = DjiTest_TelemetryBusPublish(&telemetryContext->bus, telemetryContext->topicId,
+                                                         telemetryContext->payload,
+                                                         telemetryContext->param.payloadSize);
+                break;
+            case DJI_BENCHMARK_TELEMETRY_MODE_ROUNDTRIP_BUS:
+                returnCode = DjiBenchmark_TelemetryRoundTripBus(telemetryContext);
+                break;
+            default:
+                returnCode = DjiBenchmark_TelemetryRoundTripTcp(telemetryContext);
+                break;
+        }
+        if (returnCode != DJI_ERROR_SYSTEM_MODULE_CODE_SUCCESS) {
+            return returnCode;
+        }
+    }
+
+    return DJI_ERROR_SYSTEM_MODULE_CODE_SUCCESS;
+}
+
+static void DjiBenchmark_TelemetryTeardown(void *context)
+{
+    T_DjiBenchmarkTelemetryContext *telemetryContext = context;
+
+    if (telemetryContext == NULL) {
+        return;
+    }
+
+    /* The readers return once the bus is destroyed or the connection closed. */
+    if (telemetryContext->isAckSubscribed) {
+        DjiTest_TelemetryUnsubscribe(&telemetryContext->ackSubscriber);
+    }
+    if (telemetryContext->isAckClientOpened) {
+        DjiTest_TelemetryClientClose(&telemetryContext->ackClient);
+    }
+    if (telemetryContext->isBusCreated) {
+        DjiTest_TelemetryBusDestroy(&telemetryContext->bus);
+    }
+    if (telemetryContext->socketFd >= 0) {
+        close(telemetryContext->socketFd);
+    }
+    if (telemetryContext->readerPid > 0) {
+        waitpid(telemetryContext->readerPid, NULL, 0);
+    }
+
+    free(telemetryContext->payload);
+    free(telemetryContext);
+}
+
+static T_DjiReturnCode DjiBenchmark_TelemetryStartBusReader(T_DjiBenchmarkTelemetryContext *telemetryContext)
+{
+    T_DjiTestTelemetryTopicConfig topicConfig = {0};
+    T_DjiReturnCode returnCode;
+    char busName[DJI_TEST_TELEMETRY_BUS_NAME_MAX_SIZE];
+    char ackBusName[DJI_TEST_TELEMETRY_BUS_NAME_MAX_SIZE];
+    uint16_t ackTopicId;
+    uint32_t waitedMs = 0;
+
+    DjiBenchmark_TelemetryGetBusNames(getpid(), busName, ackBusName);
+
+    returnCode = DjiTest_TelemetryBusCreate(&telemetryContext->bus, busName);
+    if (returnCode != DJI_ERROR_SYSTEM_MODULE_CODE_SUCCESS) {
+        return returnCode;
+    }
+    telemetryContext->isBusCreated = true;
+
+    returnCode = DjiTest_TelemetryBusRegisterSchema(&telemetryContext->bus, "bench.payload", 1, "payload:bytes",
+                                                    &topicConfig.schemaId);
+    if (returnCode != DJI_ERROR_SYSTEM_MODULE_CODE_SUCCESS) {
+        return returnCode;
+    }
+    strcpy(topicConfig.name, "bench/payload");
+    topicConfig.slotCount = DJI_BENCHMARK_TELEMETRY_SLOT_COUNT;
+    topicConfig.slotSize = telemetryContext->param.payloadSize;
+    returnCode = DjiTest_TelemetryBusAddTopic(&telemetryContext->bus, &topicConfig, &telemetryContext->topicId);
+    if (returnCode != DJI_ERROR_SYSTEM_MODULE_CODE_SUCCESS) {
+        return returnCode;
+    }
+
+    if (telemetryContext->param.mode == DJI_BENCHMARK_TELEMETRY_MODE_PUBLISH) {
+        return DJI_ERROR_SYSTEM_MODULE_CODE_SUCCESS;
+    }
+
+    fflush(NULL);
+    telemetryContext->readerPid = fork();
+    if (telemetryContext->readerPid < 0) {
+        return DJI_ERROR_SYSTEM_MODULE_CODE_SYSTEM_ERROR;
+    }
+    if (telemetryContext->readerPid == 0) {
+        DjiBenchmark_TelemetryRunBusReader(busName, ackBusName);
+        _exit(0);
+    }
+
+    /* The reader subscribes before it creates its bus, so the first sample is not published before it listens. */
+    while (true) {
+        if (DjiTest_TelemetryClientOpen(&telemetryContext->ackClient, ackBusName) ==
+            DJI_ERROR_SYSTEM_MODULE_CODE_SUCCESS) {
+            telemetryContext->isAckClientOpened = true;
+            if (DjiTest_TelemetryClientFindTopic(&telemetryContext->ackClient, "bench/ack", &ackTopicId) ==
+                DJI_ERROR_SYSTEM_MODULE_CODE_SUCCESS) {
+                break;
+            }
+            DjiTest_TelemetryClientClose(&telemetryContext->ackClient);
+            telemetryContext->isAckClientOpened = false;
+        }
+        if (waitedMs >= DJI_BENCHMARK_TELEMETRY_CONNECT_TIMEOUT_MS) {
+            return DJI_ERROR_SYSTEM_MODULE_CODE_TIMEOUT;
+        }
+        usleep(1000);
+        waitedMs++;
+    }
+
+    returnCode = DjiTest_TelemetrySubscribe(&telemetryContext->ackClient, ackTopicId, false,
+                                            &telemetryContext->ackSubscriber);
+    if (returnCode != DJI_ERROR_SYSTEM_MODULE_CODE_SUCCESS) {
+        return returnCode;
+    }
+    telemetryContext->isAckSubscribed = true;
+
+    return DJI_ERROR_SYSTEM_MODULE_CODE_SUCCESS;
+}
+
+static void DjiBenchmark_TelemetryRunBusReader(const char *busName, const char *ackBusName)
+{
+    T_DjiTestTelemetryClient client;
+    T_DjiTestTelemetrySubscriber subscriber;
+    T_DjiTestTelemetrySample sample;
+    T_DjiTestTelemetryTopicConfig topicConfig = {0};
+    T_DjiTestTelemetryBus *ackBus;
+    T_DjiReturnCode returnCode;
+    uint16_t topicId;
+    uint16_t ackTopicId;
+    uint64_t ack;
+
+    ackBus = calloc(1, sizeof(T_DjiTestTelemetryBus));
+    if (ackBus == NULL) {
+        return;
+    }
+    if (DjiTest_TelemetryClientOpen(&client, busName) != DJI_ERROR_SYSTEM_MODULE_CODE_SUCCESS) {
+        goto freeBus;
+    }
+    if (DjiTest_TelemetryClientFindTopic(&client, "bench/payload", &topicId) != DJI_ERROR_SYSTEM_MODULE_CODE_SUCCESS ||
+        DjiTest_TelemetrySubscribe(&client, topicId, false, &subscriber) != DJI_ERROR_SYSTEM_MODULE_CODE_SUCCESS) {
+        goto closeClient;
+    }
+
+    if (DjiTest_TelemetryBusCreate(ackBus, ackBusName) != DJI_ERROR_SYSTEM_MODULE_CODE_SUCCESS) {
+        goto unsubscribe;
+    }
+    strcpy(topicConfig.name, "bench/ack");
+    topicConfig.slotCount = DJI_BENCHMARK_TELEMETRY_SLOT_COUNT;
+    topicConfig.slotSize = sizeof(ack);
+    if (DjiTest_TelemetryBusRegisterSchema(ackBus, "bench.ack", 1, "seq:u64", &topicConfig.schemaId) !=
+        DJI_ERROR_SYSTEM_MODULE_CODE_SUCCESS ||
+        DjiTest_TelemetryBusAddTopic(ackBus, &topicConfig, &ackTopicId) != DJI_ERROR_SYSTEM_MODULE_CODE_SUCCESS) {
+        goto destroyBus;
+    }
+
+    while (true) {
+        returnCode = DjiTest_TelemetrySubscriberReceive(&subscriber, &sample, DJI_BENCHMARK_TELEMETRY_TIMEOUT_MS);
+        if (returnCode == DJI_ERROR_SYSTEM_MODULE_CODE_TIMEOUT) {
+            continue;
+        }
+        if (returnCode != DJI_ERROR_SYSTEM_MODULE_CODE_SUCCESS) {
+            break;
+        }
+
+        DjiBenchmark_TelemetryTouch(sample.data, sample.len);
+        ack = sample.seq;
+        if (DjiTest_TelemetrySubscriberRelease(&subscriber, &sample) != DJI_ERROR_SYSTEM_MODULE_CODE_SUCCESS) {
+            break;
+        }
+        DjiTest_TelemetryBusPublish(ackBus, ackTopicId, &ack, sizeof(ack));
+    }
+
+destroyBus:
+    DjiTest_TelemetryBusDestroy(ackBus);
+unsubscribe:
+    DjiTest_TelemetryUnsubscribe(&subscriber);
+closeClient:
+    DjiTest_TelemetryClientClose(&client);
+freeBus:
+    free(ackBus);
+}
+
+static T_DjiReturnCode DjiBenchmark_TelemetryStartTcpReader(T_DjiBenchmarkTelemetryContext *telemetryContext)
+{
+    struct sockaddr_in address = {0};
+    socklen_t addressLen = sizeof(address);
+    int listenFd;
+    int readerFd;
+    int isNoDelay = 1;
+
+    listenFd = socket(AF_INET, SOCK_STREAM | SOCK_CLOEXEC, 0);
+    if (listenFd < 0) {
+        return DJI_ERROR_SYSTEM_MODULE_CODE_SYSTEM_ERROR;
+    }
+    address.sin_family = AF_INET;
+    address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    if (bind(listenFd, (struct sockaddr *) &address, sizeof(address)) != 0 || listen(listenFd, 1) != 0 ||
+        getsockname(listenFd, (struct sockaddr *) &address, &addressLen) != 0) {
+        close(listenFd);
+        return DJI_ERROR_SYSTEM_MODULE_CODE_SYSTEM_ERROR;
+    }
+
+    fflush(NULL);
+    telemetryContext->readerPid = fork();
+    if (telemetryContext->readerPid < 0) {
+        close(listenFd);
+        return DJI_ERROR_SYSTEM_MODULE_CODE_SYSTEM_ERROR;
+    }
+    if (telemetryContext->readerPid == 0) {
+        close(listenFd);
+        readerFd = socket(AF_INET, SOCK_STREAM | SOCK_CLOEXEC, 0);
+        if (readerFd >= 0 && connect(readerFd, (struct sockaddr *) &address, sizeof(address)) == 0) {
+            setsockopt(readerFd, IPPROTO_TCP, TCP_NODELAY, &isNoDelay, sizeof(isNoDelay));
+            DjiBenchmark_TelemetryRunTcpReader(readerFd, telemetryContext->param.payloadSize);
+        }
+        _exit(0);
+    }
+
+    telemetryContext->socketFd = accept4(listenFd, NULL, NULL, SOCK_CLOEXEC);
+    close(listenFd);
+    if (telemetryContext->socketFd < 0) {
+        return DJI_ERROR_SYSTEM_MODULE_CODE_SYSTEM_ERROR;
+    }
+    setsockopt(telemetryContext->socketFd, IPPROTO_TCP, TCP_NODELAY, &isNoDelay, sizeof(isNoDelay));
+
+    return DJI_ERROR_SYSTEM_MODULE_CODE_SUCCESS;
+}
+
+static void DjiBenchmark_TelemetryRunTcpReader(int socketFd, uint32_t payloadSize)
+{
+    uint8_t *buffer = malloc(payloadSize);
+    uint64_t ack = 0;
+    uint32_t len;
+
+    /* Each sample is framed by its length, the way the TCP proxies of the samples sent them. */
+    while (buffer != NULL && DjiBenchmark_TelemetryReceiveAll(socketFd, &len, sizeof(len)) && len <= payloadSize &&
+           DjiBenchmark_TelemetryReceiveAll(socketFd, buffer, len)) {
+        DjiBenchmark_TelemetryTouch(buffer, len);
+        ack++;
+        if (!DjiBenchmark_TelemetrySendAll(socketFd, &ack, sizeof(ack))) {
+            break;
+        }
+    }
+
+    free(buffer);
+    close(socketFd);
+}
+
+static T_DjiReturnCode DjiBenchmark_TelemetryRoundTripBus(T_DjiBenchmarkTelemetryContext *telemetryContext)
+{
+    T_DjiTestTelemetrySample sample;
+    T_DjiReturnCode returnCode;
+    uint8_t *data;
+    uint32_t capacity;
+    uint64_t ack;
+
+    returnCode = DjiTest_TelemetryBusLoan(&telemetryContext->bus, telemetryContext->topicId, &data, &capacity);
+    if (returnCode != DJI_ERROR_SYSTEM_MODULE_CODE_SUCCESS) {
+        return returnCode;
+    }
+    memcpy(data, telemetryContext->payload, telemetryContext->param.payloadSize);
+    returnCode = DjiTest_TelemetryBusCommit(&telemetryContext->bus, telemetryContext->topicId,
+                                            telemetryContext->param.payloadSize);
+    if (returnCode != DJI_ERROR_SYSTEM_MODULE_CODE_SUCCESS) {
+        return returnCode;
+    }
+
+    returnCode = DjiTest_TelemetrySubscriberReceive(&telemetryContext->ackSubscriber, &sample,
+                                                    DJI_BENCHMARK_TELEMETRY_TIMEOUT_MS);
+    if (returnCode != DJI_ERROR_SYSTEM_MODULE_CODE_SUCCESS) {
+        return returnCode;
+    }
+    memcpy(&ack, sample.data, sizeof(ack));
+    returnCode = DjiTest_TelemetrySubscriberRelease(&telemetryContext->ackSubscriber, &sample);
+    if (returnCode != DJI_ERROR_SYSTEM_MODULE_CODE_SUCCESS) {
+        return returnCode;
+    }
+
+    /* The reader acknowledges the sequence number of the sample it read. */
+    if (ack != telemetryContext->sentCount++) {
+        return DJI_ERROR_SYSTEM_MODULE_CODE_OUT_OF_RANGE;
+    }
+
+    return DJI_ERROR_SYSTEM_MODULE_CODE_SUCCESS;
+}
+
+static T_DjiReturnCode DjiBenchmark_TelemetryRoundTripTcp(T_DjiBenchmarkTelemetryContext *telemetryContext)
+{
+    uint32_t len = telemetryContext->param.payloadSize;
+    uint64_t ack;
+
+    if (!DjiBenchmark_TelemetrySendAll(telemetryContext->socketFd, &len, sizeof(len)) ||
+        !DjiBenchmark_TelemetrySendAll(telemetryContext->socketFd, telemetryContext->payload, len) ||
+        !DjiBenchmark_TelemetryReceiveAll(telemetryContext->socketFd, &ack, sizeof(ack))) {
+        return DJI_ERROR_SYSTEM_MODULE_CODE_SYSTEM_ERROR;
+    }
+
+    if (ack != ++telemetryContext->sentCount) {
+        return DJI_ERROR_SYSTEM_MODULE_CODE_OUT_OF_RANGE;
+    }
+
+    return DJI_ERROR_SYSTEM_MODULE_CODE_SUCCESS;
+}
+
+static bool DjiBenchmark_TelemetrySendAll(int socketFd, const void *data, uint32_t len)
+{
+    const uint8_t *position = data;
+    ssize_t sentLen;
+
+    while (len > 0) {
+        sentLen = send(socketFd, position, len, MSG_NOSIGNAL);
+        if (sentLen < 0 && errno == EINTR) {
+            continue;
+        }
+        if (sentLen <= 0) {
+            return false;
+        }
+        position += sentLen;
+        len -= (uint32_t) sentLen;
+    }
+
+    return true;
+}
+
+static bool DjiBenchmark_TelemetryReceiveAll(int socketFd, void *data, uint32_t len)
+{
+    uint8_t *position = data;
+    ssize_t receivedLen;
+
+    while (len > 0) {
+        receivedLen = recv(socketFd, position, len, 0);
+        if (receivedLen < 0 && errno == EINTR) {
+            continue;
+        }
+        if (receivedLen <= 0) {
+            return false;
+        }
+        position += receivedLen;
+        len -= (uint32_t) receivedLen;
+    }
+
+    return true;
+}
+
+/**
+ * @brief Stand-in for a consumer of the sample, loads one byte of every cache line.
+ */
+static void DjiBenchmark_TelemetryTouch(const uint8_t *data, uint32_t len)
+{
+    uint64_t sum = 0;
+    uint32_t i;
+
+    for (i = 0; i < len; i += DJI_BENCHMARK_TELEMETRY_CACHE_LINE_SIZE) {
+        sum += data[i];
+    }
+    s_telemetryTouchSum += sum;
+}
+
+static void DjiBenchmark_TelemetryGetBusNames(pid_t pid, char *busName, char *ackBusName)
+{
+    snprintf(busName, DJI_TEST_TELEMETRY_BUS_NAME_MAX_SIZE, "bench_%d", (int) pid);
+    snprintf(ackBusName, DJI_TEST_TELEMETRY_BUS_NAME_MAX_SIZE, "bench_%d_ack", (int) pid);
+}
+
+/****************** (C) COPYRIGHT DJI Innovations *****END OF FILE****/
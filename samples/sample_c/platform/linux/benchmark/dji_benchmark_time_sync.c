@@ -0,0 +1,373 @@
+/**
+ ********************************************************************
+ * @file    dji_benchmark_time_sync.c
+ * @brief   Benchmark cases of the time sync clock model fed by the simulated PPS source.
+ *
+ * @copyright (c) 2021 DJI. All rights reserved.
+ *
+ * All information contained herein is, and remains, the property of DJI.
+ * The intellectual and technical concepts contained herein are proprietary
+ * to DJI and may be covered by U.S. and foreign patents, patents in process,
+ * and protected by trade secret or copyright law.  Dissemination of this
+ * information, including but not limited to data and other proprietary
+ * material(s) incorporated within the information, in any form, is strictly
+ * prohibited without the express written consent of DJI.
+ *
+ * If you receive this source code without DJI’s authorization, you may not
+ * further disseminate the information, and you must immediately remove the
+ * source code and notify DJI of its removal. DJI reserves the right to pursue
+ * legal actions against you for any loss(es) or damage(s) caused by your
+ * failure to do so.
+ *
+ *********************************************************************
+ */
+
+/* Includes ------------------------------------------------------------------*/
+#include "dji_benchmark.h"
+#include <math.h>
+#include <stdlib.h>
+#include <string.h>
+#include "dji_platform.h"
+#include "utils/util_misc.h"
+#include "time_sync/test_pps_capture.h"
+#include "time_sync/test_time_sync_model.h"
+
+/* Private constants ---------------------------------------------------------*/
+/* Aircraft time of the first edge, a date in 2024, and local time of the same edge: the known offset. */
+#define DJI_BENCHMARK_TIME_SYNC_AIRCRAFT_BASE_US    (1718000000000000ULL)
+#define DJI_BENCHMARK_TIME_SYNC_LOCAL_BASE_US       (123456789ULL)
+
+/* The synthetic track, ten minutes of edges generated the way the simulated source does, at full speed. */
+#define DJI_BENCHMARK_TIME_SYNC_TRACK_EDGE_NUM      (600)
+#define DJI_BENCHMARK_TIME_SYNC_TRACK_DRIFT_PPM     (35.0)
+#define DJI_BENCHMARK_TIME_SYNC_TRACK_JITTER_US     (20.0)
+#define DJI_BENCHMARK_TIME_SYNC_TRACK_OUTLIER_PERIOD (50)
+#define DJI_BENCHMARK_TIME_SYNC_TRACK_OUTLIER_US    (5000)
+#define DJI_BENCHMARK_TIME_SYNC_TRACK_SEED          (0x2545F491U)
+#define DJI_BENCHMARK_TIME_SYNC_TRACK_OFFSET_MAX_US (20.0)
+#define DJI_BENCHMARK_TIME_SYNC_TRACK_DRIFT_MAX_PPM (1.0)
+
+/* The live check, a few edges of the simulated source in real time, one per second. */
+#define DJI_BENCHMARK_TIME_SYNC_LIVE_EDGE_NUM       (4)
+#define DJI_BENCHMARK_TIME_SYNC_LIVE_DRIFT_PPM      (200.0f)
+#define DJI_BENCHMARK_TIME_SYNC_LIVE_JITTER_US      (20.0f)
+#define DJI_BENCHMARK_TIME_SYNC_LIVE_POLL_MS        (20)
+#define DJI_BENCHMARK_TIME_SYNC_LIVE_TIMEOUT_MS     (6000)
+/* Scheduling and clock read latency on top of the jitter, the source timestamps the edge it slept to. */
+#define DJI_BENCHMARK_TIME_SYNC_LIVE_SLACK_US       (200.0)
+#define DJI_BENCHMARK_TIME_SYNC_LIVE_DRIFT_MAX_PPM  (30.0)
+
+/* Private types -------------------------------------------------------------*/
+typedef struct {
+    T_DjiTestTimeSyncModel model;
+    uint32_t seed;
+} T_DjiBenchmarkTimeSyncContext;
+
+/* Private functions declaration ---------------------------------------------*/
+static T_DjiReturnCode DjiBenchmark_TimeSyncSetup(const T_DjiBenchmarkConfig *config, void *param, void **context);
+static T_DjiReturnCode DjiBenchmark_TimeSyncTrackRun(void *context, uint32_t iterations);
+static void DjiBenchmark_TimeSyncTeardown(void *context);
+static T_DjiReturnCode DjiBenchmark_TimeSyncTrack(T_DjiBenchmarkTimeSyncContext *timeSyncContext);
+static T_DjiReturnCode DjiBenchmark_TimeSyncCheckSimulatedSource(void);
+static T_DjiReturnCode DjiBenchmark_TimeSyncFeedLiveEdges(T_DjiTestTimeSyncModel *model, T_DjiTestPpsEdge *newestEdge);
+static uint32_t DjiBenchmark_TimeSyncRandom(uint32_t *seed);
+
+/* Exported functions definition ---------------------------------------------*/
+T_DjiReturnCode DjiBenchmark_RunTimeSyncCases(const T_DjiBenchmarkConfig *config, FILE *output)
+{
+    T_DjiBenchmarkCase benchCase;
+
+    /* One operation is ten minutes of PPS edges through the clock model, with the jitter, the drift and the late
+     * edges of the simulated source. The case fails when the model does not lock, misses the known offset or drift,
+     * accepts a late edge or reports residuals unlike the jitter. Setup first runs the simulated source itself for a
+     * few seconds and checks the model it feeds the same way. */
+    benchCase = (T_DjiBenchmarkCase) {
+        .name = "time_sync/model_track", .bytesPerOp = 0,
+        .maxBatch = 1, .maxSamples = 0,
+        .Setup = DjiBenchmark_TimeSyncSetup, .Run = DjiBenchmark_TimeSyncTrackRun,
+        .Teardown = DjiBenchmark_TimeSyncTeardown, .param = NULL,
+    };
+    DjiBenchmark_RunCase(config, &benchCase, output);
+
+    return DJI_ERROR_SYSTEM_MODULE_CODE_SUCCESS;
+}
+
+/* Private functions definition-----------------------------------------------*/
+static T_DjiReturnCode DjiBenchmark_TimeSyncSetup(const T_DjiBenchmarkConfig *config, void *param, void **context)
+{
+    T_DjiBenchmarkTimeSyncContext *timeSyncContext;
+    T_DjiTestTimeSyncModelConfig modelConfig;
+    T_DjiReturnCode returnCode;
+
+    USER_UTIL_UNUSED(config);
+    USER_UTIL_UNUSED(param);
+
+    returnCode = DjiBenchmark_TimeSyncCheckSimulatedSource();
+    if (returnCode != DJI_ERROR_SYSTEM_MODULE_CODE_SUCCESS) {
+        return returnCode;
+    }
+
+    timeSyncContext = calloc(1, sizeof(T_DjiBenchmarkTimeSyncContext));
+    if (timeSyncContext == NULL) {
+        return DJI_ERROR_SYSTEM_MODULE_CODE_MEMORY_ALLOC_FAILED;
+    }
+
+    DjiTest_TimeSyncModelGetDefaultConfig(&modelConfig);
+    returnCode = DjiTest_TimeSyncModelInit(&timeSyncContext->model, &modelConfig);
+    if (returnCode != DJI_ERROR_SYSTEM_MODULE_CODE_SUCCESS) {
+        free(timeSyncContext);
+        return returnCode;
+    }
+
+    *context = timeSyncContext;
+
+    return DJI_ERROR_SYSTEM_MODULE_CODE_SUCCESS;
+}
+
+static T_DjiReturnCode DjiBenchmark_TimeSyncTrackRun(void *context, uint32_t iterations)
+{
+    T_DjiBenchmarkTimeSyncContext *timeSyncContext = context;
+    T_DjiReturnCode returnCode;
+    uint32_t i;
+
+    for (i = 0; i < iterations; i++) {
+        returnCode = DjiBenchmark_TimeSyncTrack(timeSyncContext);
+        if (returnCode != DJI_ERROR_SYSTEM_MODULE_CODE_SUCCESS) {
+            return returnCode;
+        }
+    }
+
+    return DJI_ERROR_SYSTEM_MODULE_CODE_SUCCESS;
+}
+
+static void DjiBenchmark_TimeSyncTeardown(void *context)
+{
+    T_DjiBenchmarkTimeSyncContext *timeSyncContext = context;
+
+    if (timeSyncContext == NULL) {
+        return;
+    }
+
+    DjiTest_TimeSyncModelDeInit(&timeSyncContext->model);
+    free(timeSyncContext);
+}
+
+/**
+ * @brief Feed the edges of a local clock of known offset and drift with uniform jitter and periodic late edges.
+ * @note The edges follow DjiTest_PpsCaptureWaitSimulated: edge k is k periods of 1 + drift seconds after the first
+ * one, plus the jitter, plus 5 ms for every outlier. Every operation draws new jitter from the running seed.
+ */
+static T_DjiReturnCode DjiBenchmark_TimeSyncTrack(T_DjiBenchmarkTimeSyncContext *timeSyncContext)
+{
+    T_DjiTestTimeSyncModel *model = &timeSyncContext->model;
+    T_DjiTestTimeSyncModelStatistics statistics;
+    T_DjiReturnCode returnCode;
+    const double periodUs = 1e6 * (1.0 + DJI_BENCHMARK_TIME_SYNC_TRACK_DRIFT_PPM * 1e-6);
+    const double jitterStdUs = DJI_BENCHMARK_TIME_SYNC_TRACK_JITTER_US / sqrt(3.0);
+    uint64_t localTimeUs;
+    uint64_t aircraftTimeUs;
+    uint32_t outlierCount = 0;
+    double jitterUs;
+    double error;
+    bool isAccepted;
+    bool isOutlier;
+    uint32_t i;
+
+    if (timeSyncContext->seed == 0) {
+        timeSyncContext->seed = DJI_BENCHMARK_TIME_SYNC_TRACK_SEED;
+    }
+    DjiTest_TimeSyncModelReset(model);
+
+    for (i = 0; i < DJI_BENCHMARK_TIME_SYNC_TRACK_EDGE_NUM; i++) {
+        jitterUs = DJI_BENCHMARK_TIME_SYNC_TRACK_JITTER_US *
+                   (2.0 * DjiBenchmark_TimeSyncRandom(&timeSyncContext->seed) / UINT32_MAX - 1.0);
+        localTimeUs = DJI_BENCHMARK_TIME_SYNC_LOCAL_BASE_US + (uint64_t) llround(periodUs * i + jitterUs);
+        /* The first edges seed the model, a late one among them is a clock step rather than an outlier. */
+        isOutlier = i >= DJI_BENCHMARK_TIME_SYNC_TRACK_OUTLIER_PERIOD &&
+                    i % DJI_BENCHMARK_TIME_SYNC_TRACK_OUTLIER_PERIOD == 0;
+        if (isOutlier) {
+            localTimeUs += DJI_BENCHMARK_TIME_SYNC_TRACK_OUTLIER_US;
+            outlierCount++;
+        }
+        aircraftTimeUs = DJI_BENCHMARK_TIME_SYNC_AIRCRAFT_BASE_US +
+                         (uint64_t) i * DJI_TEST_TIME_SYNC_MODEL_US_PER_SECOND;
+
+        returnCode = DjiTest_TimeSyncModelUpdate(model, localTimeUs, aircraftTimeUs, &isAccepted);
+        if (returnCode != DJI_ERROR_SYSTEM_MODULE_CODE_SUCCESS) {
+            return returnCode;
+        }
+        if (isAccepted == isOutlier) {
+            return DJI_ERROR_SYSTEM_MODULE_CODE_SYSTEM_ERROR;
+        }
+    }
+
+    DjiTest_TimeSyncModelGetStatistics(model, &statistics);
+    if (!statistics.isLocked || statistics.resetCount != 0 || statistics.rejectedCount != outlierCount) {
+        return DJI_ERROR_SYSTEM_MODULE_CODE_SYSTEM_ERROR;
+    }
+
+    /* The offset against the true clock at the last edge, taken without its jitter. */
+    localTimeUs = DJI_BENCHMARK_TIME_SYNC_LOCAL_BASE_US +
+                  (uint64_t) llround(periodUs * (DJI_BENCHMARK_TIME_SYNC_TRACK_EDGE_NUM - 1));
+    returnCode = DjiTest_TimeSyncModelLocalToAircraft(model, localTimeUs, &aircraftTimeUs);
+    if (returnCode != DJI_ERROR_SYSTEM_MODULE_CODE_SUCCESS) {
+        return returnCode;
+    }
+    error = (double) (int64_t) (aircraftTimeUs - DJI_BENCHMARK_TIME_SYNC_AIRCRAFT_BASE_US) -
+            (DJI_BENCHMARK_TIME_SYNC_TRACK_EDGE_NUM - 1) * 1e6;
+    if (fabs(error) > DJI_BENCHMARK_TIME_SYNC_TRACK_OFFSET_MAX_US) {
+        return DJI_ERROR_SYSTEM_MODULE_CODE_SYSTEM_ERROR;
+    }
+
+    /* The aircraft clock runs slow against a fast local one. */
+    error = statistics.driftPpm + DJI_BENCHMARK_TIME_SYNC_TRACK_DRIFT_PPM * 1e6 / periodUs;
+    if (fabs(error) > DJI_BENCHMARK_TIME_SYNC_TRACK_DRIFT_MAX_PPM) {
+        return DJI_ERROR_SYSTEM_MODULE_CODE_SYSTEM_ERROR;
+    }
+
+    /* The residuals of accepted edges are the jitter, whatever the offset and the drift. The first edges are
+     * predicted before the drift is known, their residuals add up to a second of it. */
+    if (statistics.residualStdUs < 0.5 * jitterStdUs || statistics.residualStdUs > 2.0 * jitterStdUs ||
+        statistics.recentResidualRmsUs < 0.5 * jitterStdUs || statistics.recentResidualRmsUs > 2.0 * jitterStdUs ||
+        fabs(statistics.residualMeanUs) > jitterStdUs ||
+        statistics.residualMaxAbsUs > 3.0 * DJI_BENCHMARK_TIME_SYNC_TRACK_JITTER_US +
+                                      DJI_BENCHMARK_TIME_SYNC_TRACK_DRIFT_PPM) {
+        return DJI_ERROR_SYSTEM_MODULE_CODE_SYSTEM_ERROR;
+    }
+
+    return DJI_ERROR_SYSTEM_MODULE_CODE_SUCCESS;
+}
+
+/**
+ * @brief Run the simulated PPS source for a few edges and check them and the model they feed.
+ * @note The source sleeps to every edge on the real clock, so this takes about as many seconds as edges. The
+ * aircraft time of an edge is the known base plus its sequence in seconds, as the aircraft reports it.
+ */
+static T_DjiReturnCode DjiBenchmark_TimeSyncCheckSimulatedSource(void)
+{
+    T_DjiTestPpsCaptureConfig captureConfig;
+    T_DjiTestPpsCaptureStatistics captureStatistics;
+    T_DjiTestTimeSyncModelConfig modelConfig;
+    T_DjiTestTimeSyncModelStatistics modelStatistics;
+    T_DjiTestTimeSyncModel model;
+    T_DjiTestPpsEdge newestEdge;
+    T_DjiReturnCode returnCode;
+    const double periodUs = 1e6 * (1.0 + DJI_BENCHMARK_TIME_SYNC_LIVE_DRIFT_PPM * 1e-6);
+    const double intervalMaxErrorUs = 2.0 * DJI_BENCHMARK_TIME_SYNC_LIVE_JITTER_US +
+                                      DJI_BENCHMARK_TIME_SYNC_LIVE_SLACK_US;
+    uint64_t aircraftTimeUs;
+    double error;
+
+    DjiTest_PpsCaptureGetDefaultConfig(&captureConfig);
+    captureConfig.source = DJI_TEST_PPS_CAPTURE_SOURCE_SIMULATED;
+    captureConfig.simulatedDriftPpm = DJI_BENCHMARK_TIME_SYNC_LIVE_DRIFT_PPM;
+    captureConfig.simulatedJitterUs = DJI_BENCHMARK_TIME_SYNC_LIVE_JITTER_US;
+    captureConfig.simulatedOutlierPeriod = 0;
+    returnCode = DjiTest_PpsCaptureSetConfig(&captureConfig);
+    if (returnCode != DJI_ERROR_SYSTEM_MODULE_CODE_SUCCESS) {
+        return returnCode;
+    }
+
+    /* Lock on every live edge, the default asks for more seconds than the check is worth. */
+    DjiTest_TimeSyncModelGetDefaultConfig(&modelConfig);
+    modelConfig.minSamplesForLock = DJI_BENCHMARK_TIME_SYNC_LIVE_EDGE_NUM;
+    returnCode = DjiTest_TimeSyncModelInit(&model, &modelConfig);
+    if (returnCode != DJI_ERROR_SYSTEM_MODULE_CODE_SUCCESS) {
+        return returnCode;
+    }
+
+    returnCode = DjiTest_PpsCaptureSignalResponseInit();
+    if (returnCode != DJI_ERROR_SYSTEM_MODULE_CODE_SUCCESS) {
+        goto deinit_model;
+    }
+
+    returnCode = DjiBenchmark_TimeSyncFeedLiveEdges(&model, &newestEdge);
+    DjiTest_PpsCaptureGetStatistics(&captureStatistics);
+    DjiTest_PpsCaptureDeInit();
+    if (returnCode != DJI_ERROR_SYSTEM_MODULE_CODE_SUCCESS) {
+        goto deinit_model;
+    }
+
+    returnCode = DJI_ERROR_SYSTEM_MODULE_CODE_SYSTEM_ERROR;
+    if (captureStatistics.missedEdgeCount != 0 || captureStatistics.errorCount != 0 ||
+        fabs(captureStatistics.intervalMinUs - periodUs) > intervalMaxErrorUs ||
+        fabs(captureStatistics.intervalMaxUs - periodUs) > intervalMaxErrorUs) {
+        goto deinit_model;
+    }
+
+    DjiTest_TimeSyncModelGetStatistics(&model, &modelStatistics);
+    if (!modelStatistics.isLocked || modelStatistics.rejectedCount != 0 ||
+        modelStatistics.residualMaxAbsUs > intervalMaxErrorUs) {
+        goto deinit_model;
+    }
+
+    error = modelStatistics.driftPpm + DJI_BENCHMARK_TIME_SYNC_LIVE_DRIFT_PPM;
+    if (fabs(error) > DJI_BENCHMARK_TIME_SYNC_LIVE_DRIFT_MAX_PPM) {
+        goto deinit_model;
+    }
+
+    returnCode = DjiTest_TimeSyncModelLocalToAircraft(&model, newestEdge.localTimeUs, &aircraftTimeUs);
+    if (returnCode != DJI_ERROR_SYSTEM_MODULE_CODE_SUCCESS) {
+        goto deinit_model;
+    }
+    error = (double) (int64_t) (aircraftTimeUs - DJI_BENCHMARK_TIME_SYNC_AIRCRAFT_BASE_US) -
+            (double) newestEdge.sequence * 1e6;
+    if (fabs(error) > intervalMaxErrorUs) {
+        returnCode = DJI_ERROR_SYSTEM_MODULE_CODE_SYSTEM_ERROR;
+    }
+
+deinit_model:
+    DjiTest_TimeSyncModelDeInit(&model);
+
+    return returnCode;
+}
+
+static T_DjiReturnCode DjiBenchmark_TimeSyncFeedLiveEdges(T_DjiTestTimeSyncModel *model, T_DjiTestPpsEdge *newestEdge)
+{
+    T_DjiOsalHandler *osalHandler = DjiPlatform_GetOsalHandler();
+    T_DjiTestPpsEdge edge;
+    T_DjiReturnCode returnCode;
+    uint32_t edgeCount = 0;
+    uint32_t waitedMs = 0;
+    bool isAccepted;
+
+    while (edgeCount < DJI_BENCHMARK_TIME_SYNC_LIVE_EDGE_NUM) {
+        if (waitedMs >= DJI_BENCHMARK_TIME_SYNC_LIVE_TIMEOUT_MS) {
+            return DJI_ERROR_SYSTEM_MODULE_CODE_TIMEOUT;
+        }
+        osalHandler->TaskSleepMs(DJI_BENCHMARK_TIME_SYNC_LIVE_POLL_MS);
+        waitedMs += DJI_BENCHMARK_TIME_SYNC_LIVE_POLL_MS;
+
+        returnCode = DjiTest_PpsCaptureGetNewestEdge(&edge);
+        if (returnCode == DJI_ERROR_SYSTEM_MODULE_CODE_BUSY ||
+            (returnCode == DJI_ERROR_SYSTEM_MODULE_CODE_SUCCESS && edgeCount != 0 &&
+             edge.localTimeUs == newestEdge->localTimeUs)) {
+            continue;
+        } else if (returnCode != DJI_ERROR_SYSTEM_MODULE_CODE_SUCCESS) {
+            return returnCode;
+        }
+
+        returnCode = DjiTest_TimeSyncModelUpdate(model, edge.localTimeUs, DJI_BENCHMARK_TIME_SYNC_AIRCRAFT_BASE_US +
+                                                 (uint64_t) edge.sequence * DJI_TEST_TIME_SYNC_MODEL_US_PER_SECOND,
+                                                 &isAccepted);
+        if (returnCode != DJI_ERROR_SYSTEM_MODULE_CODE_SUCCESS) {
+            return returnCode;
+        }
+        *newestEdge = edge;
+        edgeCount++;
+    }
+
+    return DJI_ERROR_SYSTEM_MODULE_CODE_SUCCESS;
+}
+
+static uint32_t DjiBenchmark_TimeSyncRandom(uint32_t *seed)
+{
+    /* xorshift32, the same jitter sequence on every platform unlike rand_r. */
+    *seed ^= *seed << 13;
+    *seed ^= *seed >> 17;
+    *seed ^= *seed << 5;
+
+    return *seed;
+}
+
+/****************** (C) COPYRIGHT DJI Innovations *****END OF FILE****/
@@ -0,0 +1,505 @@
+/**
+ ********************************************************************
+ * @file    dji_benchmark_upgrade.c
+ * @brief   Benchmark cases of staging and installing upgrade packages.
+ *
+ * @copyright (c) 2021 DJI. All rights reserved.
+ *
+ * All information contained herein is, and remains, the property of DJI.
+ * The intellectual and technical concepts contained herein are proprietary
+ * to DJI and may be covered by U.S. and foreign patents, patents in process,
+ * and protected by trade secret or copyright law.  Dissemination of this
+ * information, including but not limited to data and other proprietary
+ * material(s) incorporated within the information, in any form, is strictly
+ * prohibited without the express written consent of DJI.
+ *
+ * If you receive this source code without DJI’s authorization, you may not
+ * further disseminate the information, and you must immediately remove the
+ * source code and notify DJI of its removal. DJI reserves the right to pursue
+ * legal actions against you for any loss(es) or damage(s) caused by your
+ * failure to do so.
+ *
+ *********************************************************************
+ */
+
+
+/* Includes ------------------------------------------------------------------*/
+#include "dji_benchmark.h"
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include "utils/util_misc.h"
+#include "utils/util_md5.h"
+#include "upgrade_platform_opt/upgrade_staging_linux.h"
+#include "upgrade_platform_opt/upgrade_delta_linux.h"
+
+/* Private constants ---------------------------------------------------------*/
+#define DJI_BENCHMARK_UPGRADE_FILE_SIZE         (16 * 1024 * 1024)
+/* Payload of one upgrade transfer packet, the size the common file transfer writes with. */
+#define DJI_BENCHMARK_UPGRADE_PACKET_SIZE       (1024)
+/* Packets that do not divide the staging buffer, so resume points fall inside a packet. */
+#define DJI_BENCHMARK_UPGRADE_UNALIGNED_PACKET_SIZE (1000)
+/* Read size of the md5 check the common file transfer did after receiving. */
+#define DJI_BENCHMARK_UPGRADE_REREAD_SIZE       (256)
+#define DJI_BENCHMARK_UPGRADE_PATH_MAX_LEN      (DJI_FILE_PATH_SIZE_MAX + 32)
+#define DJI_BENCHMARK_DELTA_IMAGE_SIZE          (64 * 1024 * 1024)
+/* The new program has this much code inserted a quarter in, which moves the addresses of everything behind it. */
+#define DJI_BENCHMARK_DELTA_INSERT_SIZE         (256 * 1024)
+#define DJI_BENCHMARK_DELTA_REPLACE_SIZE        (1024 * 1024)
+#define DJI_BENCHMARK_DELTA_INSTRUCTION_SIZE    (16)
+
+/* Private types -------------------------------------------------------------*/
+typedef enum {
+    DJI_BENCHMARK_UPGRADE_MODE_REREAD = 0,      /*!< Write through stdio, then read the file back for the md5. */
+    DJI_BENCHMARK_UPGRADE_MODE_STAGING,         /*!< Hash while writing through the staging. */
+    DJI_BENCHMARK_UPGRADE_MODE_RESUME,          /*!< Staging interrupted half way and the package sent again. */
+    DJI_BENCHMARK_UPGRADE_MODE_RESUME_LOST,     /*!< Staging lost without close, resumed from a mid-packet commit. */
+    DJI_BENCHMARK_UPGRADE_MODE_INSTALL,         /*!< Verified copy and rename of a staged package. */
+    DJI_BENCHMARK_UPGRADE_MODE_DELTA_CREATE,    /*!< Patch between two program versions. */
+    DJI_BENCHMARK_UPGRADE_MODE_DELTA_APPLY,     /*!< Patch applied to the old program into a verified staged image. */
+} E_DjiBenchmarkUpgradeMode;
+
+typedef struct {
+    E_DjiBenchmarkUpgradeMode mode;
+    char rootPath[DJI_BENCHMARK_UPGRADE_PATH_MAX_LEN];
+    char stagedPath[DJI_BENCHMARK_UPGRADE_PATH_MAX_LEN];
+    char targetPath[DJI_BENCHMARK_UPGRADE_PATH_MAX_LEN];
+    char oldImagePath[DJI_BENCHMARK_UPGRADE_PATH_MAX_LEN];
+    char newImagePath[DJI_BENCHMARK_UPGRADE_PATH_MAX_LEN];
+    char patchPath[DJI_BENCHMARK_UPGRADE_PATH_MAX_LEN];
+    uint8_t *package;
+    uint8_t md5[DJI_MD5_BUFFER_LEN];
+} T_DjiBenchmarkUpgradeContext;
+
+/* Private functions declaration ---------------------------------------------*/
+static T_DjiReturnCode DjiBenchmark_UpgradeSetup(const T_DjiBenchmarkConfig *config, void *param, void **context);
+static T_DjiReturnCode DjiBenchmark_UpgradeRun(void *context, uint32_t iterations);
+static void DjiBenchmark_UpgradeTeardown(void *context);
+static T_DjiReturnCode DjiBenchmark_UpgradeReceiveReread(T_DjiBenchmarkUpgradeContext *upgradeContext);
+static T_DjiReturnCode DjiBenchmark_UpgradeReceiveStaging(T_DjiBenchmarkUpgradeContext *upgradeContext,
+                                                          E_DjiBenchmarkUpgradeMode mode);
+static T_DjiReturnCode DjiBenchmark_UpgradeStage(T_DjiUpgradeStaging *staging, const uint8_t *package,
+                                                 uint32_t len, uint32_t packetSize);
+static T_DjiReturnCode DjiBenchmark_UpgradeCreateImages(T_DjiBenchmarkUpgradeContext *upgradeContext);
+static T_DjiReturnCode DjiBenchmark_UpgradeWriteFile(const char *path, const uint8_t *data, uint32_t len);
+
+/* Private values ------------------------------------------------------------*/
+static const E_DjiBenchmarkUpgradeMode s_upgradeRereadMode = DJI_BENCHMARK_UPGRADE_MODE_REREAD;
+static const E_DjiBenchmarkUpgradeMode s_upgradeStagingMode = DJI_BENCHMARK_UPGRADE_MODE_STAGING;
+static const E_DjiBenchmarkUpgradeMode s_upgradeResumeMode = DJI_BENCHMARK_UPGRADE_MODE_RESUME;
+static const E_DjiBenchmarkUpgradeMode s_upgradeResumeLostMode = DJI_BENCHMARK_UPGRADE_MODE_RESUME_LOST;
+static const E_DjiBenchmarkUpgradeMode s_upgradeInstallMode = DJI_BENCHMARK_UPGRADE_MODE_INSTALL;
+static const E_DjiBenchmarkUpgradeMode s_upgradeDeltaCreateMode = DJI_BENCHMARK_UPGRADE_MODE_DELTA_CREATE;
+static const E_DjiBenchmarkUpgradeMode s_upgradeDeltaApplyMode = DJI_BENCHMARK_UPGRADE_MODE_DELTA_APPLY;
+
+/* Exported functions definition ---------------------------------------------*/
+T_DjiReturnCode DjiBenchmark_RunUpgradeCases(const T_DjiBenchmarkConfig *config, FILE *output)
+{
+    T_DjiBenchmarkCase benchCase;
+
+    /* One operation receives a 16 MB package in 1 KB packets and verifies its md5. */
+    benchCase = (T_DjiBenchmarkCase) {
+        .name = "upgrade/receive/reread", .bytesPerOp = DJI_BENCHMARK_UPGRADE_FILE_SIZE,
+        .maxBatch = 1, .maxSamples = 10,
+        .Setup = DjiBenchmark_UpgradeSetup, .Run = DjiBenchmark_UpgradeRun,
+        .Teardown = DjiBenchmark_UpgradeTeardown, .param = (void *) &s_upgradeRereadMode,
+    };
+    DjiBenchmark_RunCase(config, &benchCase, output);
+
+    /* Includes the syncs of the resume points and of the finished file, which the case above does not do. */
+    benchCase.name = "upgrade/receive/staging";
+    benchCase.param = (void *) &s_upgradeStagingMode;
+    DjiBenchmark_RunCase(config, &benchCase, output);
+
+    /* The package is sent again from the start after the interruption, the staged half is skipped. The case fails
+     * when the resumed package does not hash to the md5 of the package. */
+    benchCase.name = "upgrade/receive/resume_half";
+    benchCase.param = (void *) &s_upgradeResumeMode;
+    DjiBenchmark_RunCase(config, &benchCase, output);
+
+    /* 1000 byte packets and no close before the resume, as after a power loss. The resume point is committed
+     * inside a packet, the case fails when the resumed package does not hash to the md5 of the package. */
+    benchCase.name = "upgrade/receive/resume_lost";
+    benchCase.param = (void *) &s_upgradeResumeLostMode;
+    DjiBenchmark_RunCase(config, &benchCase, output);
+
+    benchCase.name = "upgrade/install";
+    benchCase.param = (void *) &s_upgradeInstallMode;
+    DjiBenchmark_RunCase(config, &benchCase, output);
+
+    /* One operation patches a 64 MB program, bytes are those of the new program. The create case fails when the
+     * patch is larger than the changed code plus a sixteenth of the image, the apply case when the rebuilt image
+     * does not match. */
+    benchCase.name = "upgrade/delta/create";
+    benchCase.bytesPerOp = DJI_BENCHMARK_DELTA_IMAGE_SIZE + DJI_BENCHMARK_DELTA_INSERT_SIZE;
+    benchCase.param = (void *) &s_upgradeDeltaCreateMode;
+    DjiBenchmark_RunCase(config, &benchCase, output);
+
+    benchCase.name = "upgrade/delta/apply";
+    benchCase.param = (void *) &s_upgradeDeltaApplyMode;
+    DjiBenchmark_RunCase(config, &benchCase, output);
+
+    return DJI_ERROR_SYSTEM_MODULE_CODE_SUCCESS;
+}
+
+/* Private functions definition-----------------------------------------------*/
+static T_DjiReturnCode DjiBenchmark_UpgradeSetup(const T_DjiBenchmarkConfig *config, void *param, void **context)
+{
+    T_DjiBenchmarkUpgradeContext *upgradeContext;
+    T_DjiReturnCode returnCode;
+    MD5_CTX md5Ctx;
+    uint32_t i;
+
+    upgradeContext = calloc(1, sizeof(T_DjiBenchmarkUpgradeContext));
+    if (upgradeContext == NULL) {
+        return DJI_ERROR_SYSTEM_MODULE_CODE_MEMORY_ALLOC_FAILED;
+    }
+    upgradeContext->mode = *(const E_DjiBenchmarkUpgradeMode *) param;
+
+    snprintf(upgradeContext->rootPath, sizeof(upgradeContext->rootPath), "%s/dji_benchmark_XXXXXX", config->tmpDir);
+    if (mkdtemp(upgradeContext->rootPath) == NULL) {
+        free(upgradeContext);
+        return DJI_ERROR_SYSTEM_MODULE_CODE_SYSTEM_ERROR;
+    }
+    snprintf(upgradeContext->stagedPath, sizeof(upgradeContext->stagedPath), "%s/package.bin",
+             upgradeContext->rootPath);
+    snprintf(upgradeContext->targetPath, sizeof(upgradeContext->targetPath), "%s/program", upgradeContext->rootPath);
+    snprintf(upgradeContext->oldImagePath, sizeof(upgradeContext->oldImagePath), "%s/old_program",
+             upgradeContext->rootPath);
+    snprintf(upgradeContext->newImagePath, sizeof(upgradeContext->newImagePath), "%s/new_program",
+             upgradeContext->rootPath);
+    snprintf(upgradeContext->patchPath, sizeof(upgradeContext->patchPath), "%s/patch.bin", upgradeContext->rootPath);
+
+    if (upgradeContext->mode == DJI_BENCHMARK_UPGRADE_MODE_DELTA_CREATE ||
+        upgradeContext->mode == DJI_BENCHMARK_UPGRADE_MODE_DELTA_APPLY) {
+        returnCode = DjiBenchmark_UpgradeCreateImages(upgradeContext);
+        if (returnCode != DJI_ERROR_SYSTEM_MODULE_CODE_SUCCESS) {
+            DjiBenchmark_UpgradeTeardown(upgradeContext);
+            return returnCode;
+        }
+        *context = upgradeContext;
+        return DJI_ERROR_SYSTEM_MODULE_CODE_SUCCESS;
+    }
+
+    upgradeContext->package = malloc(DJI_BENCHMARK_UPGRADE_FILE_SIZE);
+    if (upgradeContext->package == NULL) {
+        DjiBenchmark_UpgradeTeardown(upgradeContext);
+        return DJI_ERROR_SYSTEM_MODULE_CODE_MEMORY_ALLOC_FAILED;
+    }
+    for (i = 0; i < DJI_BENCHMARK_UPGRADE_FILE_SIZE; i++) {
+        upgradeContext->package[i] = (uint8_t) (i * 31 + (i >> 12));
+    }
+    UtilMd5_Init(&md5Ctx);
+    UtilMd5_Update(&md5Ctx, upgradeContext->package, DJI_BENCHMARK_UPGRADE_FILE_SIZE);
+    UtilMd5_Final(&md5Ctx, upgradeContext->md5);
+
+    if (upgradeContext->mode == DJI_BENCHMARK_UPGRADE_MODE_INSTALL) {
+        returnCode = DjiBenchmark_UpgradeReceiveStaging(upgradeContext, false);
+        if (returnCode != DJI_ERROR_SYSTEM_MODULE_CODE_SUCCESS) {
+            DjiBenchmark_UpgradeTeardown(upgradeContext);
+            return returnCode;
+        }
+    }
+
+    *context = upgradeContext;
+
+    return DJI_ERROR_SYSTEM_MODULE_CODE_SUCCESS;
+}
+
+static T_DjiReturnCode DjiBenchmark_UpgradeRun(void *context, uint32_t iterations)
+{
+    T_DjiBenchmarkUpgradeContext *upgradeContext = context;
+    T_DjiReturnCode returnCode = DJI_ERROR_SYSTEM_MODULE_CODE_SUCCESS;
+    T_UtilDeltaStatistics statistics;
+    uint8_t md5[DJI_MD5_BUFFER_LEN];
+    uint32_t i;
+
+    for (i = 0; i < iterations && returnCode == DJI_ERROR_SYSTEM_MODULE_CODE_SUCCESS; i++) {
+        switch (upgradeContext->mode) {
+            case DJI_BENCHMARK_UPGRADE_MODE_REREAD:
+                returnCode = DjiBenchmark_UpgradeReceiveReread(upgradeContext);
+                break;
+            case DJI_BENCHMARK_UPGRADE_MODE_STAGING:
+            case DJI_BENCHMARK_UPGRADE_MODE_RESUME:
+            case DJI_BENCHMARK_UPGRADE_MODE_RESUME_LOST:
+                returnCode = DjiBenchmark_UpgradeReceiveStaging(upgradeContext, upgradeContext->mode);
+                break;
+            case DJI_BENCHMARK_UPGRADE_MODE_INSTALL:
+                returnCode = DjiUpgradeStagingLinux_Install(upgradeContext->stagedPath, upgradeContext->targetPath,
+                                                            upgradeContext->md5);
+                break;
+            case DJI_BENCHMARK_UPGRADE_MODE_DELTA_CREATE:
+                returnCode = DjiUpgradeDeltaLinux_CreatePatchFile(upgradeContext->oldImagePath,
+                                                                  upgradeContext->newImagePath,
+                                                                  upgradeContext->patchPath, &statistics);
+                if (returnCode == DJI_ERROR_SYSTEM_MODULE_CODE_SUCCESS &&
+                    statistics.patchSize > DJI_BENCHMARK_DELTA_INSERT_SIZE + DJI_BENCHMARK_DELTA_REPLACE_SIZE +
+                                           DJI_BENCHMARK_DELTA_IMAGE_SIZE / 16) {
+                    returnCode = DJI_ERROR_SYSTEM_MODULE_CODE_SYSTEM_ERROR;
+                }
+                break;
+            case DJI_BENCHMARK_UPGRADE_MODE_DELTA_APPLY:
+                returnCode = DjiUpgradeDeltaLinux_ApplyPatchFile(upgradeContext->patchPath,
+                                                                 upgradeContext->oldImagePath,
+                                                                 upgradeContext->stagedPath, md5);
+                if (returnCode == DJI_ERROR_SYSTEM_MODULE_CODE_SUCCESS &&
+                    memcmp(md5, upgradeContext->md5, DJI_MD5_BUFFER_LEN) != 0) {
+                    returnCode = DJI_ERROR_SYSTEM_MODULE_CODE_SYSTEM_ERROR;
+                }
+                break;
+            default:
+                returnCode = DJI_ERROR_SYSTEM_MODULE_CODE_INVALID_PARAMETER;
+                break;
+        }
+    }
+
+    return returnCode;
+}
+
+static void DjiBenchmark_UpgradeTeardown(void *context)
+{
+    T_DjiBenchmarkUpgradeContext *upgradeContext = context;
+    char path[DJI_BENCHMARK_UPGRADE_PATH_MAX_LEN + 16];
+
+    if (upgradeContext == NULL) {
+        return;
+    }
+
+    remove(upgradeContext->stagedPath);
+    snprintf(path, sizeof(path), "%s%s", upgradeContext->stagedPath, DJI_UPGRADE_STAGING_RESUME_SUFFIX);
+    remove(path);
+    remove(upgradeContext->targetPath);
+    remove(upgradeContext->oldImagePath);
+    remove(upgradeContext->newImagePath);
+    remove(upgradeContext->patchPath);
+    rmdir(upgradeContext->rootPath);
+    free(upgradeContext->package);
+    free(upgradeContext);
+}
+
+/**
+ * @brief The way the common file transfer received a package before the staging, kept as the baseline.
+ */
+static T_DjiReturnCode DjiBenchmark_UpgradeReceiveReread(T_DjiBenchmarkUpgradeContext *upgradeContext)
+{
+    uint8_t buffer[DJI_BENCHMARK_UPGRADE_REREAD_SIZE];
+    uint8_t md5[DJI_MD5_BUFFER_LEN];
+    T_DjiReturnCode returnCode = DJI_ERROR_SYSTEM_MODULE_CODE_SUCCESS;
+    MD5_CTX md5Ctx;
+    uint32_t offset;
+    FILE *fp;
+
+    fp = fopen(upgradeContext->stagedPath, "w+");
+    if (fp == NULL) {
+        return DJI_ERROR_SYSTEM_MODULE_CODE_SYSTEM_ERROR;
+    }
+
+    for (offset = 0; offset < DJI_BENCHMARK_UPGRADE_FILE_SIZE; offset += DJI_BENCHMARK_UPGRADE_PACKET_SIZE) {
+        if (fseek(fp, offset, SEEK_SET) != 0 ||
+            fwrite(&upgradeContext->package[offset], 1, DJI_BENCHMARK_UPGRADE_PACKET_SIZE, fp) !=
+            DJI_BENCHMARK_UPGRADE_PACKET_SIZE) {
+            returnCode = DJI_ERROR_SYSTEM_MODULE_CODE_SYSTEM_ERROR;
+            goto out;
+        }
+    }
+
+    UtilMd5_Init(&md5Ctx);
+    for (offset = 0; offset < DJI_BENCHMARK_UPGRADE_FILE_SIZE; offset += DJI_BENCHMARK_UPGRADE_REREAD_SIZE) {
+        if (fseek(fp, offset, SEEK_SET) != 0 || fread(buffer, 1, sizeof(buffer), fp) != sizeof(buffer)) {
+            returnCode = DJI_ERROR_SYSTEM_MODULE_CODE_SYSTEM_ERROR;
+            goto out;
+        }
+        UtilMd5_Update(&md5Ctx, buffer, sizeof(buffer));
+    }
+    UtilMd5_Final(&md5Ctx, md5);
+
+    if (memcmp(md5, upgradeContext->md5, DJI_MD5_BUFFER_LEN) != 0) {
+        returnCode = DJI_ERROR_SYSTEM_MODULE_CODE_SYSTEM_ERROR;
+    }
+
+out:
+    fclose(fp);
+    return returnCode;
+}
+
+static T_DjiReturnCode DjiBenchmark_UpgradeReceiveStaging(T_DjiBenchmarkUpgradeContext *upgradeContext,
+                                                          E_DjiBenchmarkUpgradeMode mode)
+{
+    T_DjiUpgradeStagingConfig config;
+    T_DjiUpgradeStagingStatistics statistics;
+    T_DjiUpgradeStaging staging;
+    T_DjiReturnCode returnCode;
+    uint8_t md5[DJI_MD5_BUFFER_LEN];
+    uint64_t resumeOffset = 0;
+    uint64_t expectedResumeOffset = 0;
+    uint32_t packetSize = DJI_BENCHMARK_UPGRADE_PACKET_SIZE;
+
+    DjiUpgradeStagingLinux_GetDefaultConfig(&config);
+
+    if (mode == DJI_BENCHMARK_UPGRADE_MODE_RESUME) {
+        returnCode = DjiUpgradeStagingLinux_Open(&staging, &config, upgradeContext->stagedPath,
+                                                 DJI_BENCHMARK_UPGRADE_FILE_SIZE, NULL);
+        if (returnCode != DJI_ERROR_SYSTEM_MODULE_CODE_SUCCESS) {
+            return returnCode;
+        }
+        returnCode = DjiBenchmark_UpgradeStage(&staging, upgradeContext->package,
+                                               DJI_BENCHMARK_UPGRADE_FILE_SIZE / 2, packetSize);
+        DjiUpgradeStagingLinux_Close(&staging);
+        if (returnCode != DJI_ERROR_SYSTEM_MODULE_CODE_SUCCESS) {
+            return returnCode;
+        }
+        expectedResumeOffset = DJI_BENCHMARK_UPGRADE_FILE_SIZE / 2;
+    } else if (mode == DJI_BENCHMARK_UPGRADE_MODE_RESUME_LOST) {
+        packetSize = DJI_BENCHMARK_UPGRADE_UNALIGNED_PACKET_SIZE;
+        returnCode = DjiUpgradeStagingLinux_Open(&staging, &config, upgradeContext->stagedPath,
+                                                 DJI_BENCHMARK_UPGRADE_FILE_SIZE, NULL);
+        if (returnCode != DJI_ERROR_SYSTEM_MODULE_CODE_SUCCESS) {
+            return returnCode;
+        }
+        returnCode = DjiBenchmark_UpgradeStage(&staging, upgradeContext->package,
+                                               DJI_BENCHMARK_UPGRADE_FILE_SIZE / 4 * 3, packetSize);
+        /* Drop the staging without close, only the resume point committed by the writes survives. */
+        close(staging.fd);
+        free(staging.buffer);
+        if (returnCode != DJI_ERROR_SYSTEM_MODULE_CODE_SUCCESS) {
+            return returnCode;
+        }
+        expectedResumeOffset = config.commitIntervalBytes;
+    }
+
+    returnCode = DjiUpgradeStagingLinux_Open(&staging, &config, upgradeContext->stagedPath,
+                                             DJI_BENCHMARK_UPGRADE_FILE_SIZE, &resumeOffset);
+    if (returnCode != DJI_ERROR_SYSTEM_MODULE_CODE_SUCCESS) {
+        return returnCode;
+    }
+
+    returnCode = DjiBenchmark_UpgradeStage(&staging, upgradeContext->package, DJI_BENCHMARK_UPGRADE_FILE_SIZE,
+                                           packetSize);
+    if (returnCode == DJI_ERROR_SYSTEM_MODULE_CODE_SUCCESS) {
+        returnCode = DjiUpgradeStagingLinux_Finish(&staging, md5);
+    }
+    DjiUpgradeStagingLinux_GetStatistics(&staging, &statistics);
+    DjiUpgradeStagingLinux_Close(&staging);
+
+    if (returnCode == DJI_ERROR_SYSTEM_MODULE_CODE_SUCCESS &&
+        (memcmp(md5, upgradeContext->md5, DJI_MD5_BUFFER_LEN) != 0 || resumeOffset != expectedResumeOffset ||
+         statistics.skippedBytes != expectedResumeOffset)) {
+        returnCode = DJI_ERROR_SYSTEM_MODULE_CODE_SYSTEM_ERROR;
+    }
+
+    return returnCode;
+}
+
+static T_DjiReturnCode DjiBenchmark_UpgradeStage(T_DjiUpgradeStaging *staging, const uint8_t *package, uint32_t len,
+                                                 uint32_t packetSize)
+{
+    T_DjiReturnCode returnCode;
+    uint32_t offset;
+
+    for (offset = 0; offset < len; offset += packetSize) {
+        returnCode = DjiUpgradeStagingLinux_Write(staging, offset, &package[offset],
+                                                  USER_UTIL_MIN(packetSize, len - offset));
+        if (returnCode != DJI_ERROR_SYSTEM_MODULE_CODE_SUCCESS) {
+            return returnCode;
+        }
+    }
+
+    return DJI_ERROR_SYSTEM_MODULE_CODE_SUCCESS;
+}
+
+/**
+ * @brief Write two versions of a program-like image: 16 byte instructions of opcodes from a small set, an absolute
+ * address into the image and an operand. The new version has code inserted and a region rewritten, so the addresses
+ * behind the insertion all change, the case where plain block matching falls back to literal bytes.
+ */
+static T_DjiReturnCode DjiBenchmark_UpgradeCreateImages(T_DjiBenchmarkUpgradeContext *upgradeContext)
+{
+    const uint32_t insertOffset = DJI_BENCHMARK_DELTA_IMAGE_SIZE / 4;
+    const uint32_t replaceOffset = DJI_BENCHMARK_DELTA_IMAGE_SIZE / 2;
+    const uint32_t newSize = DJI_BENCHMARK_DELTA_IMAGE_SIZE + DJI_BENCHMARK_DELTA_INSERT_SIZE;
+    T_DjiReturnCode returnCode;
+    uint8_t *oldImage;
+    uint8_t *newImage;
+    uint32_t seed = 1;
+    uint32_t address;
+    uint32_t offset;
+    uint32_t i;
+    MD5_CTX md5Ctx;
+
+    oldImage = malloc(DJI_BENCHMARK_DELTA_IMAGE_SIZE);
+    newImage = malloc(newSize);
+    if (oldImage == NULL || newImage == NULL) {
+        returnCode = DJI_ERROR_SYSTEM_MODULE_CODE_MEMORY_ALLOC_FAILED;
+        goto out;
+    }
+
+    for (offset = 0; offset < DJI_BENCHMARK_DELTA_IMAGE_SIZE; offset += DJI_BENCHMARK_DELTA_INSTRUCTION_SIZE) {
+        seed = seed * 1103515245 + 12345;
+        for (i = 0; i < 8; i++) {
+            oldImage[offset + i] = (uint8_t) ((seed >> 16) % 13 * 17 + i);
+        }
+        address = (seed >> 4) % DJI_BENCHMARK_DELTA_IMAGE_SIZE & ~3U;
+        memcpy(&oldImage[offset + 8], &address, sizeof(address));
+        memset(&oldImage[offset + 12], (int) (seed >> 24) & 0x0F, 4);
+    }
+
+    memcpy(newImage, oldImage, insertOffset);
+    for (i = 0; i < DJI_BENCHMARK_DELTA_INSERT_SIZE; i++) {
+        seed = seed * 1103515245 + 12345;
+        newImage[insertOffset + i] = (uint8_t) (seed >> 16);
+    }
+    memcpy(&newImage[insertOffset + DJI_BENCHMARK_DELTA_INSERT_SIZE], &oldImage[insertOffset],
+           DJI_BENCHMARK_DELTA_IMAGE_SIZE - insertOffset);
+    for (offset = 0; offset < newSize; offset += DJI_BENCHMARK_DELTA_INSTRUCTION_SIZE) {
+        if (offset >= insertOffset && offset < insertOffset + DJI_BENCHMARK_DELTA_INSERT_SIZE) {
+            continue;
+        }
+        memcpy(&address, &newImage[offset + 8], sizeof(address));
+        if (address >= insertOffset) {
+            address += DJI_BENCHMARK_DELTA_INSERT_SIZE;
+            memcpy(&newImage[offset + 8], &address, sizeof(address));
+        }
+    }
+    for (i = 0; i < DJI_BENCHMARK_DELTA_REPLACE_SIZE; i++) {
+        seed = seed * 1103515245 + 12345;
+        newImage[replaceOffset + i] = (uint8_t) (seed >> 16);
+    }
+
+    UtilMd5_Init(&md5Ctx);
+    UtilMd5_Update(&md5Ctx, newImage, newSize);
+    UtilMd5_Final(&md5Ctx, upgradeContext->md5);
+
+    returnCode = DjiBenchmark_UpgradeWriteFile(upgradeContext->oldImagePath, oldImage, DJI_BENCHMARK_DELTA_IMAGE_SIZE);
+    if (returnCode == DJI_ERROR_SYSTEM_MODULE_CODE_SUCCESS) {
+        returnCode = DjiBenchmark_UpgradeWriteFile(upgradeContext->newImagePath, newImage, newSize);
+    }
+    if (returnCode == DJI_ERROR_SYSTEM_MODULE_CODE_SUCCESS &&
+        upgradeContext->mode == DJI_BENCHMARK_UPGRADE_MODE_DELTA_APPLY) {
+        returnCode = DjiUpgradeDeltaLinux_CreatePatchFile(upgradeContext->oldImagePath, upgradeContext->newImagePath,
+                                                          upgradeContext->patchPath, NULL);
+    }
+
+out:
+    free(oldImage);
+    free(newImage);
+
+    return returnCode;
+}
+
+static T_DjiReturnCode DjiBenchmark_UpgradeWriteFile(const char *path, const uint8_t *data, uint32_t len)
+{
+    FILE *fp;
+
+    fp = fopen(path, "wb");
+    if (fp == NULL) {
+        return DJI_ERROR_SYSTEM_MODULE_CODE_SYSTEM_ERROR;
+    }
+    if (fwrite(data, 1, len, fp) != len) {
+        fclose(fp);
+        return DJI_ERROR_SYSTEM_MODULE_CODE_SYSTEM_ERROR;
+    }
+
+    return fclose(fp) == 0 ? DJI_ERROR_SYSTEM_MODULE_CODE_SUCCESS : DJI_ERROR_SYSTEM_MODULE_CODE_SYSTEM_ERROR;
+}
+
+/****************** (C) COPYRIGHT DJI Innovations *****END OF FILE****/
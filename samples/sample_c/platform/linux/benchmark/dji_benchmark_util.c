@@ -0,0 +1,518 @@
+/**
+ ********************************************************************
+ * @file    dji_benchmark_util.c
+ * @brief   Benchmark cases of util_buffer, util_link_list, util_md5, util_file and cJSON.
+ *
+ * @copyright (c) 2021 DJI. All rights reserved.
+ *
+ * All information contained herein is, and remains, the property of DJI.
+ * The intellectual and technical concepts contained herein are proprietary
+ * to DJI and may be covered by U.S. and foreign patents, patents in process,
+ * and protected by trade secret or copyright law.  Dissemination of this
+ * information, including but not limited to data and other proprietary
+ * material(s) incorporated within the information, in any form, is strictly
+ * prohibited without the express written consent of DJI.
+ *
+ * If you receive this source code without DJI’s authorization, you may not
+ * further disseminate the information, and you must immediately remove the
+ * source code and notify DJI of its removal. DJI reserves the right to pursue
+ * legal actions against you for any loss(es) or damage(s) caused by your
+ * failure to do so.
+ *
+ *********************************************************************
+ */
+
+/* Includes ------------------------------------------------------------------*/
+#include "dji_benchmark.h"
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include "utils/util_buffer.h"
+#include "utils/util_link_list.h"
+#include "utils/util_md5.h"
+#include "utils/util_file.h"
+#include "utils/cJSON.h"
+
+/* Private constants ---------------------------------------------------------*/
+#define DJI_BENCHMARK_BUFFER_SIZE               4096
+#define DJI_BENCHMARK_LINK_LIST_NODE_NUM        64
+#define DJI_BENCHMARK_FILE_SIZE                 (1024 * 1024)
+#define DJI_BENCHMARK_FILE_CHUNK_SIZE           4096
+#define DJI_BENCHMARK_NAME_MAX_LEN              96
+#define DJI_BENCHMARK_PATH_MAX_LEN              512
+
+/* Private types -------------------------------------------------------------*/
+typedef struct {
+    T_UtilBuffer buffer;
+    uint8_t storage[DJI_BENCHMARK_BUFFER_SIZE];
+    uint8_t data[DJI_BENCHMARK_BUFFER_SIZE];
+    uint16_t len;
+} T_DjiBenchmarkBufferContext;
+
+typedef struct {
+    T_UtilLinkList list;
+} T_DjiBenchmarkLinkListContext;
+
+typedef struct {
+    uint8_t *data;
+    uint32_t len;
+} T_DjiBenchmarkMd5Context;
+
+typedef struct {
+    char *text;
+    cJSON *root;
+} T_DjiBenchmarkJsonContext;
+
+typedef struct {
+    char path[DJI_BENCHMARK_PATH_MAX_LEN];
+    uint8_t data[DJI_BENCHMARK_FILE_CHUNK_SIZE];
+    uint32_t offset;
+} T_DjiBenchmarkFileContext;
+
+typedef struct {
+    const char *label;
+    const char *relativePath;
+} T_DjiBenchmarkJsonFile;
+
+/* Private functions declaration ---------------------------------------------*/
+static T_DjiReturnCode DjiBenchmark_BufferSetup(const T_DjiBenchmarkConfig *config, void *param, void **context);
+static T_DjiReturnCode DjiBenchmark_BufferPutGet(void *context, uint32_t iterations);
+static T_DjiReturnCode DjiBenchmark_LinkListSetup(const T_DjiBenchmarkConfig *config, void *param, void **context);
+static T_DjiReturnCode DjiBenchmark_LinkListRotate(void *context, uint32_t iterations);
+static T_DjiReturnCode DjiBenchmark_LinkListNewDelete(void *context, uint32_t iterations);
+static void DjiBenchmark_LinkListTeardown(void *context);
+static T_DjiReturnCode DjiBenchmark_Md5Setup(const T_DjiBenchmarkConfig *config, void *param, void **context);
+static T_DjiReturnCode DjiBenchmark_Md5Digest(void *context, uint32_t iterations);
+static void DjiBenchmark_Md5Teardown(void *context);
+static T_DjiReturnCode DjiBenchmark_JsonSetup(const T_DjiBenchmarkConfig *config, void *param, void **context);
+static T_DjiReturnCode DjiBenchmark_JsonParse(void *context, uint32_t iterations);
+static T_DjiReturnCode DjiBenchmark_JsonPrint(void *context, uint32_t iterations);
+static void DjiBenchmark_JsonTeardown(void *context);
+static T_DjiReturnCode DjiBenchmark_FileSetup(const T_DjiBenchmarkConfig *config, void *param, void **context);
+static T_DjiReturnCode DjiBenchmark_FileReadByPath(void *context, uint32_t iterations);
+static void DjiBenchmark_FileTeardown(void *context);
+static void DjiBenchmark_FreeContext(void *context);
+
+/* Private values ------------------------------------------------------------*/
+static const uint32_t s_bufferLengths[] = {16, 256, 1024};
+static const uint32_t s_md5Lengths[] = {64, 4096, 1024 * 1024};
+static const T_DjiBenchmarkJsonFile s_jsonFiles[] = {
+    {"dji_sdk_config", "samples/sample_c++/platform/linux/manifold2/application/dji_sdk_config.json"},
+    {"flying_config", "samples/sample_c++/module_sample/flight_controller/config/flying_config.json"},
+    {"widget_config_en", "samples/sample_c/module_sample/widget/widget_file/en_big_screen/widget_config.json"},
+    {"hms_text_config_en", "samples/sample_c/module_sample/hms/hms_text/en/hms_text_config.json"},
+    {"hms", "samples/sample_c/module_sample/hms/data/hms.json"},
+};
+
+/* Exported functions definition ---------------------------------------------*/
+T_DjiReturnCode DjiBenchmark_RunUtilCases(const T_DjiBenchmarkConfig *config, FILE *output)
+{
+    T_DjiBenchmarkCase benchCase;
+    char name[DJI_BENCHMARK_NAME_MAX_LEN];
+    char path[DJI_BENCHMARK_PATH_MAX_LEN];
+    uint32_t i;
+
+    for (i = 0; i < sizeof(s_bufferLengths) / sizeof(s_bufferLengths[0]); i++) {
+        snprintf(name, sizeof(name), "util_buffer/put_get/%u", s_bufferLengths[i]);
+        benchCase = (T_DjiBenchmarkCase) {
+            .name = name, .bytesPerOp = s_bufferLengths[i], .Setup = DjiBenchmark_BufferSetup,
+            .Run = DjiBenchmark_BufferPutGet, .Teardown = DjiBenchmark_FreeContext,
+            .param = (void *) &s_bufferLengths[i],
+        };
+        DjiBenchmark_RunCase(config, &benchCase, output);
+    }
+
+    benchCase = (T_DjiBenchmarkCase) {
+        .name = "util_link_list/add_last_remove_first", .Setup = DjiBenchmark_LinkListSetup,
+        .Run = DjiBenchmark_LinkListRotate, .Teardown = DjiBenchmark_LinkListTeardown,
+    };
+    DjiBenchmark_RunCase(config, &benchCase, output);
+
+    benchCase = (T_DjiBenchmarkCase) {
+        .name = "util_link_list/new_delete_node", .Setup = DjiBenchmark_LinkListSetup,
+        .Run = DjiBenchmark_LinkListNewDelete, .Teardown = DjiBenchmark_LinkListTeardown,
+    };
+    DjiBenchmark_RunCase(config, &benchCase, output);
+
+    for (i = 0; i < sizeof(s_md5Lengths) / sizeof(s_md5Lengths[0]); i++) {
+        snprintf(name, sizeof(name), "util_md5/digest/%u", s_md5Lengths[i]);
+        benchCase = (T_DjiBenchmarkCase) {
+            .name = name, .bytesPerOp = s_md5Lengths[i], .Setup = DjiBenchmark_Md5Setup,
+            .Run = DjiBenchmark_Md5Digest, .Teardown = DjiBenchmark_Md5Teardown,
+            .param = (void *) &s_md5Lengths[i],
+        };
+        DjiBenchmark_RunCase(config, &benchCase, output);
+    }
+
+    for (i = 0; i < sizeof(s_jsonFiles) / sizeof(s_jsonFiles[0]); i++) {
+        uint32_t fileSize = 0;
+
+        snprintf(path, sizeof(path), "%s/%s", config->dataDir, s_jsonFiles[i].relativePath);
+        if (UtilFile_GetFileSizeByPath(path, &fileSize) != DJI_ERROR_SYSTEM_MODULE_CODE_SUCCESS) {
+            continue;
+        }
+
+        snprintf(name, sizeof(name), "cjson/parse/%s", s_jsonFiles[i].label);
+        benchCase = (T_DjiBenchmarkCase) {
+            .name = name, .bytesPerOp = fileSize, .Setup = DjiBenchmark_JsonSetup,
+            .Run = DjiBenchmark_JsonParse, .Teardown = DjiBenchmark_JsonTeardown, .param = path,
+        };
+        DjiBenchmark_RunCase(config, &benchCase, output);
+
+        snprintf(name, sizeof(name), "cjson/print/%s", s_jsonFiles[i].label);
+        benchCase.Run = DjiBenchmark_JsonPrint;
+        DjiBenchmark_RunCase(config, &benchCase, output);
+    }
+
+    benchCase = (T_DjiBenchmarkCase) {
+        .name = "util_file/get_file_data_by_path/4096", .bytesPerOp = DJI_BENCHMARK_FILE_CHUNK_SIZE,
+        .Setup = DjiBenchmark_FileSetup, .Run = DjiBenchmark_FileReadByPath, .Teardown = DjiBenchmark_FileTeardown,
+    };
+    DjiBenchmark_RunCase(config, &benchCase, output);
+
+    return DJI_ERROR_SYSTEM_MODULE_CODE_SUCCESS;
+}
+
+/* Private functions definition-----------------------------------------------*/
+static T_DjiReturnCode DjiBenchmark_BufferSetup(const T_DjiBenchmarkConfig *config, void *param, void **context)
+{
+    T_DjiBenchmarkBufferContext *bufferContext;
+    uint32_t i;
+
+    (void) config;
+
+    bufferContext = calloc(1, sizeof(T_DjiBenchmarkBufferContext));
+    if (bufferContext == NULL) {
+        return DJI_ERROR_SYSTEM_MODULE_CODE_MEMORY_ALLOC_FAILED;
+    }
+
+    for (i = 0; i < sizeof(bufferContext->data); i++) {
+        bufferContext->data[i] = (uint8_t) i;
+    }
+    bufferContext->len = (uint16_t) *(const uint32_t *) param;
+    UtilBuffer_Init(&bufferContext->buffer, bufferContext->storage, sizeof(bufferContext->storage));
+
+    *context = bufferContext;
+
+    return DJI_ERROR_SYSTEM_MODULE_CODE_SUCCESS;
+}
+
+static T_DjiReturnCode DjiBenchmark_BufferPutGet(void *context, uint32_t iterations)
+{
+    T_DjiBenchmarkBufferContext *bufferContext = context;
+    uint32_t i;
+
+    for (i = 0; i < iterations; i++) {
+        if (UtilBuffer_Put(&bufferContext->buffer, bufferContext->data, bufferContext->len) != bufferContext->len) {
+            return DJI_ERROR_SYSTEM_MODULE_CODE_SYSTEM_ERROR;
+        }
+        if (UtilBuffer_Get(&bufferContext->buffer, bufferContext->data, bufferContext->len) != bufferContext->len) {
+            return DJI_ERROR_SYSTEM_MODULE_CODE_SYSTEM_ERROR;
+        }
+    }
+
+    return DJI_ERROR_SYSTEM_MODULE_CODE_SUCCESS;
+}
+
+static T_DjiReturnCode DjiBenchmark_LinkListSetup(const T_DjiBenchmarkConfig *config, void *param, void **context)
+{
+    T_DjiBenchmarkLinkListContext *listContext;
+    T_UtilListNode *node;
+    uint32_t i;
+
+    (void) config;
+    (void) param;
+
+    listContext = calloc(1, sizeof(T_DjiBenchmarkLinkListContext));
+    if (listContext == NULL) {
+        return DJI_ERROR_SYSTEM_MODULE_CODE_MEMORY_ALLOC_FAILED;
+    }
+
+    DjiUserUtil_InitLinkList(&listContext->list);
+    for (i = 0; i < DJI_BENCHMARK_LINK_LIST_NODE_NUM; i++) {
+        node = DjiUserUtil_NewListNode(NULL);
+        if (node == NULL) {
+            DjiBenchmark_LinkListTeardown(listContext);
+            return DJI_ERROR_SYSTEM_MODULE_CODE_MEMORY_ALLOC_FAILED;
+        }
+        DjiUserUtil_LinkListAddNodeLast(&listContext->list, node);
+    }
+
+    *context = listContext;
+
+    return DJI_ERROR_SYSTEM_MODULE_CODE_SUCCESS;
+}
+
+static T_DjiReturnCode DjiBenchmark_LinkListRotate(void *context, uint32_t iterations)
+{
+    T_DjiBenchmarkLinkListContext *listContext = context;
+    T_UtilListNode *node;
+    uint32_t i;
+
+    /* DjiUserUtil_LinkListRemoveNodeOnly also frees the node, so every insert needs a freshly allocated node. */
+    for (i = 0; i < iterations; i++) {
+        node = DjiUserUtil_NewListNode(NULL);
+        if (node == NULL) {
+            return DJI_ERROR_SYSTEM_MODULE_CODE_MEMORY_ALLOC_FAILED;
+        }
+        DjiUserUtil_LinkListAddNodeLast(&listContext->list, node);
+        DjiUserUtil_LinkListRemoveNodeOnly(&listContext->list, listContext->list.first);
+    }
+
+    return listContext->list.count == DJI_BENCHMARK_LINK_LIST_NODE_NUM ? DJI_ERROR_SYSTEM_MODULE_CODE_SUCCESS :
+           DJI_ERROR_SYSTEM_MODULE_CODE_SYSTEM_ERROR;
+}
+
+static T_DjiReturnCode DjiBenchmark_LinkListNewDelete(void *context, uint32_t iterations)
+{
+    T_UtilListNode *node;
+    uint32_t i;
+
+    (void) context;
+
+    for (i = 0; i < iterations; i++) {
+        node = DjiUserUtil_NewListNode(NULL);
+        if (node == NULL) {
+            return DJI_ERROR_SYSTEM_MODULE_CODE_MEMORY_ALLOC_FAILED;
+        }
+        DjiUserUtil_ListNodeDeleteNodeSelf(node);
+    }
+
+    return DJI_ERROR_SYSTEM_MODULE_CODE_SUCCESS;
+}
+
+static void DjiBenchmark_LinkListTeardown(void *context)
+{
+    T_DjiBenchmarkLinkListContext *listContext = context;
+
+    if (listContext == NULL) {
+        return;
+    }
+
+    DjiUserUtil_LinkListDestory(&listContext->list);
+    free(listContext);
+}
+
+static T_DjiReturnCode DjiBenchmark_Md5Setup(const T_DjiBenchmarkConfig *config, void *param, void **context)
+{
+    T_DjiBenchmarkMd5Context *md5Context;
+    uint32_t i;
+
+    (void) config;
+
+    md5Context = calloc(1, sizeof(T_DjiBenchmarkMd5Context));
+    if (md5Context == NULL) {
+        return DJI_ERROR_SYSTEM_MODULE_CODE_MEMORY_ALLOC_FAILED;
+    }
+
+    md5Context->len = *(const uint32_t *) param;
+    md5Context->data = malloc(md5Context->len);
+    if (md5Context->data == NULL) {
+        free(md5Context);
+        return DJI_ERROR_SYSTEM_MODULE_CODE_MEMORY_ALLOC_FAILED;
+    }
+    for (i = 0; i < md5Context->len; i++) {
+        md5Context->data[i] = (uint8_t) (i * 31 + 7);
+    }
+
+    *context = md5Context;
+
+    return DJI_ERROR_SYSTEM_MODULE_CODE_SUCCESS;
+}
+
+static T_DjiReturnCode DjiBenchmark_Md5Digest(void *context, uint32_t iterations)
+{
+    T_DjiBenchmarkMd5Context *md5Context = context;
+    MD5_CTX md5;
+    BYTE digest[MD5_BLOCK_SIZE];
+    uint32_t i;
+
+    for (i = 0; i < iterations; i++) {
+        UtilMd5_Init(&md5);
+        UtilMd5_Update(&md5, md5Context->data, md5Context->len);
+        UtilMd5_Final(&md5, digest);
+        md5Context->data[0] ^= digest[0];
+    }
+
+    return DJI_ERROR_SYSTEM_MODULE_CODE_SUCCESS;
+}
+
+static void DjiBenchmark_Md5Teardown(void *context)
+{
+    T_DjiBenchmarkMd5Context *md5Context = context;
+
+    if (md5Context == NULL) {
+        return;
+    }
+
+    free(md5Context->data);
+    free(md5Context);
+}
+
+static T_DjiReturnCode DjiBenchmark_JsonSetup(const T_DjiBenchmarkConfig *config, void *param, void **context)
+{
+    T_DjiReturnCode returnCode;
+    T_DjiBenchmarkJsonContext *jsonContext;
+    const char *path = param;
+    uint32_t fileSize = 0;
+    uint32_t realLen = 0;
+
+    (void) config;
+
+    returnCode = UtilFile_GetFileSizeByPath(path, &fileSize);
+    if (returnCode != DJI_ERROR_SYSTEM_MODULE_CODE_SUCCESS || fileSize == 0) {
+        return DJI_ERROR_SYSTEM_MODULE_CODE_INVALID_PARAMETER;
+    }
+
+    jsonContext = calloc(1, sizeof(T_DjiBenchmarkJsonContext));
+    if (jsonContext == NULL) {
+        return DJI_ERROR_SYSTEM_MODULE_CODE_MEMORY_ALLOC_FAILED;
+    }
+
+    jsonContext->text = calloc(1, fileSize + 1);
+    if (jsonContext->text == NULL) {
+        free(jsonContext);
+        return DJI_ERROR_SYSTEM_MODULE_CODE_MEMORY_ALLOC_FAILED;
+    }
+
+    returnCode = UtilFile_GetFileDataByPath(path, 0, fileSize, (uint8_t *) jsonContext->text, &realLen);
+    if (returnCode != DJI_ERROR_SYSTEM_MODULE_CODE_SUCCESS) {
+        DjiBenchmark_JsonTeardown(jsonContext);
+        return returnCode;
+    }
+
+    jsonContext->root = cJSON_Parse(jsonContext->text);
+    if (jsonContext->root == NULL) {
+        DjiBenchmark_JsonTeardown(jsonContext);
+        return DJI_ERROR_SYSTEM_MODULE_CODE_INVALID_PARAMETER;
+    }
+
+    *context = jsonContext;
+
+    return DJI_ERROR_SYSTEM_MODULE_CODE_SUCCESS;
+}
+
+static T_DjiReturnCode DjiBenchmark_JsonParse(void *context, uint32_t iterations)
+{
+    T_DjiBenchmarkJsonContext *jsonContext = context;
+    cJSON *root;
+    uint32_t i;
+
+    for (i = 0; i < iterations; i++) {
+        root = cJSON_Parse(jsonContext->text);
+        if (root == NULL) {
+            return DJI_ERROR_SYSTEM_MODULE_CODE_SYSTEM_ERROR;
+        }
+        cJSON_Delete(root);
+    }
+
+    return DJI_ERROR_SYSTEM_MODULE_CODE_SUCCESS;
+}
+
+static T_DjiReturnCode DjiBenchmark_JsonPrint(void *context, uint32_t iterations)
+{
+    T_DjiBenchmarkJsonContext *jsonContext = context;
+    char *text;
+    uint32_t i;
+
+    for (i = 0; i < iterations; i++) {
+        text = cJSON_PrintUnformatted(jsonContext->root);
+        if (text == NULL) {
+            return DJI_ERROR_SYSTEM_MODULE_CODE_MEMORY_ALLOC_FAILED;
+        }
+        cJSON_free(text);
+    }
+
+    return DJI_ERROR_SYSTEM_MODULE_CODE_SUCCESS;
+}
+
+static void DjiBenchmark_JsonTeardown(void *context)
+{
+    T_DjiBenchmarkJsonContext *jsonContext = context;
+
+    if (jsonContext == NULL) {
+        return;
+    }
+
+    cJSON_Delete(jsonContext->root);
+    free(jsonContext->text);
+    free(jsonContext);
+}
+
+static T_DjiReturnCode DjiBenchmark_FileSetup(const T_DjiBenchmarkConfig *config, void *param, void **context)
+{
+    T_DjiBenchmarkFileContext *fileContext;
+    uint32_t written = 0;
+    uint32_t i;
+    int fd;
+
+    (void) param;
+
+    fileContext = calloc(1, sizeof(T_DjiBenchmarkFileContext));
+    if (fileContext == NULL) {
+        return DJI_ERROR_SYSTEM_MODULE_CODE_MEMORY_ALLOC_FAILED;
+    }
+
+    snprintf(fileContext->path, sizeof(fileContext->path), "%s/dji_benchmark_XXXXXX", config->tmpDir);
+    fd = mkstemp(fileContext->path);
+    if (fd < 0) {
+        free(fileContext);
+        return DJI_ERROR_SYSTEM_MODULE_CODE_SYSTEM_ERROR;
+    }
+
+    for (i = 0; i < sizeof(fileContext->data); i++) {
+        fileContext->data[i] = (uint8_t) i;
+    }
+    while (written < DJI_BENCHMARK_FILE_SIZE) {
+        if (write(fd, fileContext->data, sizeof(fileContext->data)) != (ssize_t) sizeof(fileContext->data)) {
+            close(fd);
+            DjiBenchmark_FileTeardown(fileContext);
+            return DJI_ERROR_SYSTEM_MODULE_CODE_SYSTEM_ERROR;
+        }
+        written += sizeof(fileContext->data);
+    }
+    close(fd);
+
+    *context = fileContext;
+
+    return DJI_ERROR_SYSTEM_MODULE_CODE_SUCCESS;
+}
+
+static T_DjiReturnCode DjiBenchmark_FileReadByPath(void *context, uint32_t iterations)
+{
+    T_DjiReturnCode returnCode;
+    T_DjiBenchmarkFileContext *fileContext = context;
+    uint32_t realLen = 0;
+    uint32_t i;
+
+    /* UtilFile_GetFileDataByPath opens and closes the file on every call, which is what this case measures. */
+    for (i = 0; i < iterations; i++) {
+        returnCode = UtilFile_GetFileDataByPath(fileContext->path, fileContext->offset, DJI_BENCHMARK_FILE_CHUNK_SIZE,
+                                                fileContext->data, &realLen);
+        if (returnCode != DJI_ERROR_SYSTEM_MODULE_CODE_SUCCESS || realLen != DJI_BENCHMARK_FILE_CHUNK_SIZE) {
+            return DJI_ERROR_SYSTEM_MODULE_CODE_SYSTEM_ERROR;
+        }
+        fileContext->offset = (fileContext->offset + DJI_BENCHMARK_FILE_CHUNK_SIZE) % DJI_BENCHMARK_FILE_SIZE;
+    }
+
+    return DJI_ERROR_SYSTEM_MODULE_CODE_SUCCESS;
+}
+
+static void DjiBenchmark_FileTeardown(void *context)
+{
+    T_DjiBenchmarkFileContext *fileContext = context;
+
+    if (fileContext == NULL) {
+        return;
+    }
+
+    unlink(fileContext->path);
+    free(fileContext);
+}
+
+static void DjiBenchmark_FreeContext(void *context)
+{
+    free(context);
+}
+
+/****************** (C) COPYRIGHT DJI Innovations *****END OF FILE****/
@@ -0,0 +1,131 @@
+/**
+ ********************************************************************
+ * @file    main.c
+ * @brief   Entry of the micro-benchmark suite, results are written as json lines.
+ *
+ * @copyright (c) 2021 DJI. All rights reserved.
+ *
+ * All information contained herein is, and remains, the property of DJI.
+ * The intellectual and technical concepts contained herein are proprietary
+ * to DJI and may be covered by U.S. and foreign patents, patents in process,
+ * and protected by trade secret or copyright law.  Dissemination of this
+ * information, including but not limited to data and other proprietary
+ * material(s) incorporated within the information, in any form, is strictly
+ * prohibited without the express written consent of DJI.
+ *
+ * If you receive this source code without DJI’s authorization, you may not
+ * further disseminate the information, and you must immediately remove the
+ * source code and notify DJI of its removal. DJI reserves the right to pursue
+ * legal actions against you for any loss(es) or damage(s) caused by your
+ * failure to do so.
+ *
+ *********************************************************************
+ */
+
+/* Includes ------------------------------------------------------------------*/
+#include <dji_platform.h>
+#include <stdlib.h>
+#include <unistd.h>
+#include "osal/osal.h"
+#include "dji_benchmark.h"
+
+/* Private constants ---------------------------------------------------------*/
+
+/* Private types -------------------------------------------------------------*/
+
+/* Private functions declaration ---------------------------------------------*/
+static void DjiBenchmark_PrintUsage(const char *program);
+
+/* Private values -------------------------------------------------------------*/
+
+/* Exported functions definition ---------------------------------------------*/
+int main(int argc, char **argv)
+{
+    T_DjiReturnCode returnCode;
+    T_DjiBenchmarkConfig config;
+    const char *outputPath = NULL;
+    FILE *output = stdout;
+    int option;
+    T_DjiOsalHandler osalHandler = {
+        .TaskCreate = Osal_TaskCreate,
+        .TaskDestroy = Osal_TaskDestroy,
+        .TaskSleepMs = Osal_TaskSleepMs,
+        .MutexCreate= Osal_MutexCreate,
+        .MutexDestroy = Osal_MutexDestroy,
+        .MutexLock = Osal_MutexLock,
+        .MutexUnlock = Osal_MutexUnlock,
+        .SemaphoreCreate = Osal_SemaphoreCreate,
+        .SemaphoreDestroy = Osal_SemaphoreDestroy,
+        .SemaphoreWait = Osal_SemaphoreWait,
+        .SemaphoreTimedWait = Osal_SemaphoreTimedWait,
+        .SemaphorePost = Osal_SemaphorePost,
+        .Malloc = Osal_Malloc,
+        .Free = Osal_Free,
+        .GetTimeMs = Osal_GetTimeMs,
+        .GetTimeUs = Osal_GetTimeUs,
+        .GetRandomNum  = Osal_GetRandomNum,
+    };
+
+    DjiBenchmark_GetDefaultConfig(&config);
+
+    while ((option = getopt(argc, argv, "o:f:d:t:n:h")) != -1) {
+        switch (option) {
+            case 'o':
+                outputPath = optarg;
+                break;
+            case 'f':
+                config.filter = optarg;
+                break;
+            case 'd':
+                config.dataDir = optarg;
+                break;
+            case 't':
+                config.minTimeMs = (uint32_t) strtoul(optarg, NULL, 10);
+                break;
+            case 'n':
+                config.maxSamples = (uint32_t) strtoul(optarg, NULL, 10);
+                break;
+            case 'h':
+            default:
+                DjiBenchmark_PrintUsage(argv[0]);
+                return option == 'h' ? 0 : 1;
+        }
+    }
+
+    /* The link list utils allocate nodes through the registered osal handler. */
+    returnCode = DjiPlatform_RegOsalHandler(&osalHandler);
+    if (returnCode != DJI_ERROR_SYSTEM_MODULE_CODE_SUCCESS) {
+        fprintf(stderr, "Register osal handler error, stat = 0x%08llX\n", returnCode);
+        return 1;
+    }
+
+    if (outputPath != NULL) {
+        output = fopen(outputPath, "w");
+        if (output == NULL) {
+            fprintf(stderr, "Open output file %s error.\n", outputPath);
+            return 1;
+        }
+    }
+
+    returnCode = DjiBenchmark_RunAll(&config, output);
+
+    if (output != stdout) {
+        fclose(output);
+    }
+
+    return returnCode == DJI_ERROR_SYSTEM_MODULE_CODE_SUCCESS ? 0 : 1;
+}
+
+/* Private functions definition-----------------------------------------------*/
+static void DjiBenchmark_PrintUsage(const char *program)
+{
+    fprintf(stderr, "Usage: %s [-o output.jsonl] [-f filter] [-d repo_dir] [-t min_time_ms] [-n max_samples]\n"
+                    "  -o  write json lines to this file instead of stdout\n"
+                    "  -f  only run the cases whose name contains the filter, e.g. \"osal/\" or \"cjson/parse\"\n"
+                    "  -d  repository root used to find the json files of the cjson cases\n"
+                    "  -t  minimum measuring time of every case in ms, default %d\n"
+                    "  -n  maximum timed batches of every case, default %d\n",
+            program, DJI_BENCHMARK_DEFAULT_MIN_TIME_MS, DJI_BENCHMARK_DEFAULT_MAX_SAMPLES);
+}
+
+/****************** (C) COPYRIGHT DJI Innovations *****END OF FILE****/
@@ -0,0 +1,338 @@
+/**
+ ********************************************************************
+ * @file    upgrade_delta_linux.c
+ * @brief   Creates delta patches of program files and applies them into a verified staged image.
+ *
+ * @copyright (c) 2021 DJI. All rights reserved.
+ *
+ * All information contained herein is, and remains, the property of DJI.
+ * The intellectual and technical concepts contained herein are proprietary
+ * to DJI and may be covered by U.S. and foreign patents, patents in process,
+ * and protected by trade secret or copyright law.  Dissemination of this
+ * information, including but not limited to data and other proprietary
+ * material(s) incorporated within the information, in any form, is strictly
+ * prohibited without the express written consent of DJI.
+ *
+ * If you receive this source code without DJI’s authorization, you may not
+ * further disseminate the information, and you must immediately remove the
+ * source code and notify DJI of its removal. DJI reserves the right to pursue
+ * legal actions against you for any loss(es) or damage(s) caused by your
+ * failure to do so.
+ *
+ *********************************************************************
+ */
+
+
+/* Includes ------------------------------------------------------------------*/
+#include "upgrade_delta_linux.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <dji_logger.h>
+#include "utils/util_md5.h"
+#include "upgrade_staging_linux.h"
+
+/* Private constants ---------------------------------------------------------*/
+#define DJI_UPGRADE_DELTA_READ_BUFFER_SIZE      (1024 * 1024)
+#define DJI_UPGRADE_DELTA_PATH_SUFFIX_MAX_LEN   (16)
+
+/* Private types -------------------------------------------------------------*/
+typedef struct {
+    int oldFd;
+    T_DjiUpgradeStaging *staging;
+    uint64_t stagedOffset;
+} T_DjiUpgradeDeltaApplyContext;
+
+/* Private values -------------------------------------------------------------*/
+
+/* Private functions declaration ---------------------------------------------*/
+static T_DjiReturnCode DjiUpgradeDelta_MapFile(const char *path, const uint8_t **data, uint64_t *size);
+static T_DjiReturnCode DjiUpgradeDelta_GetFileMd5(int fd, uint8_t md5[DJI_MD5_BUFFER_LEN]);
+static T_DjiReturnCode DjiUpgradeDelta_WritePatch(void *userData, const uint8_t *data, uint32_t len);
+static T_DjiReturnCode DjiUpgradeDelta_ReadOld(void *userData, uint64_t offset, uint8_t *data, uint32_t len);
+static T_DjiReturnCode DjiUpgradeDelta_WriteStaged(void *userData, const uint8_t *data, uint32_t len);
+
+/* Exported functions definition ---------------------------------------------*/
+bool DjiUpgradeDeltaLinux_IsPatchFile(const char *path)
+{
+    uint8_t headerBuffer[UTIL_DELTA_HEADER_SIZE];
+    T_UtilDeltaHeader header;
+    size_t readLen;
+    FILE *fp;
+
+    fp = fopen(path, "rb");
+    if (fp == NULL) {
+        return false;
+    }
+    readLen = fread(headerBuffer, 1, sizeof(headerBuffer), fp);
+    fclose(fp);
+
+    return UtilDelta_ParseHeader(headerBuffer, (uint32_t) readLen, &header) == DJI_ERROR_SYSTEM_MODULE_CODE_SUCCESS;
+}
+
+/**
+ * @brief Write the patch from the program at oldPath to the one at newPath, usually on the host that builds the
+ * upgrade package. Both programs are mapped, not read into memory.
+ */
+T_DjiReturnCode DjiUpgradeDeltaLinux_CreatePatchFile(const char *oldPath, const char *newPath, const char *patchPath,
+                                                     T_UtilDeltaStatistics *statistics)
+{
+    char tempPath[DJI_FILE_PATH_SIZE_MAX + DJI_UPGRADE_DELTA_PATH_SUFFIX_MAX_LEN];
+    T_UtilDeltaConfig config;
+    T_DjiReturnCode returnCode;
+    const uint8_t *oldData = NULL;
+    const uint8_t *newData = NULL;
+    uint64_t oldSize = 0;
+    uint64_t newSize = 0;
+    FILE *fp;
+
+    if (oldPath == NULL || newPath == NULL || patchPath == NULL || strlen(patchPath) >= DJI_FILE_PATH_SIZE_MAX) {
+        return DJI_ERROR_SYSTEM_MODULE_CODE_INVALID_PARAMETER;
+    }
+
+    returnCode = DjiUpgradeDelta_MapFile(oldPath, &oldData, &oldSize);
+    if (returnCode != DJI_ERROR_SYSTEM_MODULE_CODE_SUCCESS) {
+        return returnCode;
+    }
+    returnCode = DjiUpgradeDelta_MapFile(newPath, &newData, &newSize);
+    if (returnCode != DJI_ERROR_SYSTEM_MODULE_CODE_SUCCESS) {
+        goto unmapOld;
+    }
+
+    snprintf(tempPath, sizeof(tempPath), "%s.tmp", patchPath);
+    fp = fopen(tempPath, "wb");
+    if (fp == NULL) {
+        USER_LOG_ERROR("Create patch file %s error: %s.", tempPath, strerror(errno));
+        returnCode = DJI_ERROR_SYSTEM_MODULE_CODE_SYSTEM_ERROR;
+        goto unmapNew;
+    }
+
+    UtilDelta_GetDefaultConfig(&config);
+    returnCode = UtilDelta_Create(&config, oldData, oldSize, newData, newSize, DjiUpgradeDelta_WritePatch, fp,
+                                  statistics);
+    if (fclose(fp) != 0 && returnCode == DJI_ERROR_SYSTEM_MODULE_CODE_SUCCESS) {
+        returnCode = DJI_ERROR_SYSTEM_MODULE_CODE_SYSTEM_ERROR;
+    }
+    if (returnCode == DJI_ERROR_SYSTEM_MODULE_CODE_SUCCESS && rename(tempPath, patchPath) != 0) {
+        returnCode = DJI_ERROR_SYSTEM_MODULE_CODE_SYSTEM_ERROR;
+    }
+    if (returnCode != DJI_ERROR_SYSTEM_MODULE_CODE_SUCCESS) {
+        USER_LOG_ERROR("Create patch file %s error, return code = 0x%08llX", patchPath, returnCode);
+        remove(tempPath);
+    }
+
+unmapNew:
+    if (newSize > 0) {
+        munmap((void *) newData, newSize);
+    }
+unmapOld:
+    if (oldSize > 0) {
+        munmap((void *) oldData, oldSize);
+    }
+
+    return returnCode;
+}
+
+/**
+ * @brief Rebuild the program of a patch from the program at oldPath into a staged image at stagedPath.
+ * @note The old program must be the one the patch was made from, it is checked before anything is written. The
+ * staged image is hashed while it is written and removed unless it matches the program the patch was made for.
+ * @param newMd5: md5 of the staged image, for the install.
+ */
+T_DjiReturnCode DjiUpgradeDeltaLinux_ApplyPatchFile(const char *patchPath, const char *oldPath,
+                                                    const char *stagedPath, uint8_t newMd5[DJI_MD5_BUFFER_LEN])
+{
+    T_DjiUpgradeDeltaApplyContext context = {.oldFd = -1};
+    T_DjiUpgradeStagingConfig stagingConfig;
+    T_DjiUpgradeStaging staging;
+    T_UtilDeltaApplier applier;
+    T_UtilDeltaHeader header;
+    T_DjiReturnCode returnCode;
+    uint8_t md5[DJI_MD5_BUFFER_LEN];
+    uint8_t *buffer;
+    struct stat oldStat;
+    size_t readLen;
+    FILE *patchFile;
+
+    if (patchPath == NULL || oldPath == NULL || stagedPath == NULL || newMd5 == NULL) {
+        return DJI_ERROR_SYSTEM_MODULE_CODE_INVALID_PARAMETER;
+    }
+
+    buffer = malloc(DJI_UPGRADE_DELTA_READ_BUFFER_SIZE);
+    if (buffer == NULL) {
+        return DJI_ERROR_SYSTEM_MODULE_CODE_MEMORY_ALLOC_FAILED;
+    }
+
+    patchFile = fopen(patchPath, "rb");
+    if (patchFile == NULL) {
+        USER_LOG_ERROR("Open patch file %s error: %s.", patchPath, strerror(errno));
+        returnCode = DJI_ERROR_SYSTEM_MODULE_CODE_NOT_FOUND;
+        goto freeBuffer;
+    }
+    readLen = fread(buffer, 1, UTIL_DELTA_HEADER_SIZE, patchFile);
+    returnCode = UtilDelta_ParseHeader(buffer, (uint32_t) readLen, &header);
+    if (returnCode != DJI_ERROR_SYSTEM_MODULE_CODE_SUCCESS) {
+        USER_LOG_ERROR("%s is not a patch file.", patchPath);
+        goto closePatch;
+    }
+
+    context.oldFd = open(oldPath, O_RDONLY);
+    if (context.oldFd < 0 || fstat(context.oldFd, &oldStat) != 0) {
+        USER_LOG_ERROR("Open old program %s error: %s.", oldPath, strerror(errno));
+        returnCode = DJI_ERROR_SYSTEM_MODULE_CODE_NOT_FOUND;
+        goto closeOld;
+    }
+    returnCode = DjiUpgradeDelta_GetFileMd5(context.oldFd, md5);
+    if (returnCode != DJI_ERROR_SYSTEM_MODULE_CODE_SUCCESS) {
+        goto closeOld;
+    }
+    if ((uint64_t) oldStat.st_size != header.oldSize || memcmp(md5, header.oldMd5, DJI_MD5_BUFFER_LEN) != 0) {
+        USER_LOG_ERROR("Patch %s is not made for the installed program %s.", patchPath, oldPath);
+        returnCode = DJI_ERROR_SYSTEM_MODULE_CODE_INVALID_PARAMETER;
+        goto closeOld;
+    }
+
+    /* The image is rebuilt from the kept patch after an interruption, so it needs no resume point. */
+    DjiUpgradeStagingLinux_GetDefaultConfig(&stagingConfig);
+    stagingConfig.commitIntervalBytes = 0;
+    returnCode = DjiUpgradeStagingLinux_Open(&staging, &stagingConfig, stagedPath, header.newSize, NULL);
+    if (returnCode != DJI_ERROR_SYSTEM_MODULE_CODE_SUCCESS) {
+        goto closeOld;
+    }
+    context.staging = &staging;
+
+    UtilDelta_ApplierInit(&applier, DjiUpgradeDelta_ReadOld, DjiUpgradeDelta_WriteStaged, &context);
+    returnCode = UtilDelta_ApplierWrite(&applier, buffer, UTIL_DELTA_HEADER_SIZE);
+    while (returnCode == DJI_ERROR_SYSTEM_MODULE_CODE_SUCCESS &&
+           (readLen = fread(buffer, 1, DJI_UPGRADE_DELTA_READ_BUFFER_SIZE, patchFile)) > 0) {
+        returnCode = UtilDelta_ApplierWrite(&applier, buffer, (uint32_t) readLen);
+    }
+    if (returnCode == DJI_ERROR_SYSTEM_MODULE_CODE_SUCCESS) {
+        returnCode = ferror(patchFile) ? DJI_ERROR_SYSTEM_MODULE_CODE_SYSTEM_ERROR : UtilDelta_ApplierFinish(&applier);
+    }
+    UtilDelta_ApplierDeInit(&applier);
+
+    if (returnCode == DJI_ERROR_SYSTEM_MODULE_CODE_SUCCESS) {
+        returnCode = DjiUpgradeStagingLinux_Finish(&staging, newMd5);
+    }
+    if (returnCode == DJI_ERROR_SYSTEM_MODULE_CODE_SUCCESS && memcmp(newMd5, header.newMd5, DJI_MD5_BUFFER_LEN) != 0) {
+        USER_LOG_ERROR("Program rebuilt from patch %s does not match its md5.", patchPath);
+        returnCode = DJI_ERROR_SYSTEM_MODULE_CODE_SYSTEM_ERROR;
+    }
+    DjiUpgradeStagingLinux_Close(&staging);
+
+    if (returnCode != DJI_ERROR_SYSTEM_MODULE_CODE_SUCCESS) {
+        USER_LOG_ERROR("Apply patch %s error, return code = 0x%08llX", patchPath, returnCode);
+        remove(stagedPath);
+    } else {
+        USER_LOG_INFO("Rebuilt %s from patch %s, %llu bytes.", stagedPath, patchPath, header.newSize);
+    }
+
+closeOld:
+    if (context.oldFd >= 0) {
+        close(context.oldFd);
+    }
+closePatch:
+    fclose(patchFile);
+freeBuffer:
+    free(buffer);
+
+    return returnCode;
+}
+
+/* Private functions definition-----------------------------------------------*/
+static T_DjiReturnCode DjiUpgradeDelta_MapFile(const char *path, const uint8_t **data, uint64_t *size)
+{
+    struct stat fileStat;
+    void *mapped;
+    int fd;
+
+    fd = open(path, O_RDONLY);
+    if (fd < 0 || fstat(fd, &fileStat) != 0) {
+        USER_LOG_ERROR("Open %s error: %s.", path, strerror(errno));
+        if (fd >= 0) {
+            close(fd);
+        }
+        return DJI_ERROR_SYSTEM_MODULE_CODE_NOT_FOUND;
+    }
+
+    *size = (uint64_t) fileStat.st_size;
+    *data = NULL;
+    if (*size > 0) {
+        mapped = mmap(NULL, *size, PROT_READ, MAP_PRIVATE, fd, 0);
+        if (mapped == MAP_FAILED) {
+            USER_LOG_ERROR("Map %s error: %s.", path, strerror(errno));
+            close(fd);
+            return DJI_ERROR_SYSTEM_MODULE_CODE_SYSTEM_ERROR;
+        }
+        *data = mapped;
+    }
+    close(fd);
+
+    return DJI_ERROR_SYSTEM_MODULE_CODE_SUCCESS;
+}
+
+static T_DjiReturnCode DjiUpgradeDelta_GetFileMd5(int fd, uint8_t md5[DJI_MD5_BUFFER_LEN])
+{
+    uint8_t *buffer;
+    uint64_t offset = 0;
+    ssize_t readLen;
+    MD5_CTX md5Ctx;
+
+    buffer = malloc(DJI_UPGRADE_DELTA_READ_BUFFER_SIZE);
+    if (buffer == NULL) {
+        return DJI_ERROR_SYSTEM_MODULE_CODE_MEMORY_ALLOC_FAILED;
+    }
+
+    UtilMd5_Init(&md5Ctx);
+    while ((readLen = pread(fd, buffer, DJI_UPGRADE_DELTA_READ_BUFFER_SIZE, (off_t) offset)) > 0) {
+        UtilMd5_Update(&md5Ctx, buffer, (size_t) readLen);
+        offset += (uint64_t) readLen;
+    }
+    UtilMd5_Final(&md5Ctx, md5);
+    free(buffer);
+
+    return readLen < 0 ? DJI_ERROR_SYSTEM_MODULE_CODE_SYSTEM_ERROR : DJI_ERROR_SYSTEM_MODULE_CODE_SUCCESS;
+}
+
+static T_DjiReturnCode DjiUpgradeDelta_WritePatch(void *userData, const uint8_t *data, uint32_t len)
+{
+    return fwrite(data, 1, len, (FILE *) userData) == len ? DJI_ERROR_SYSTEM_MODULE_CODE_SUCCESS :
+           DJI_ERROR_SYSTEM_MODULE_CODE_SYSTEM_ERROR;
+}
+
+static T_DjiReturnCode DjiUpgradeDelta_ReadOld(void *userData, uint64_t offset, uint8_t *data, uint32_t len)
+{
+    T_DjiUpgradeDeltaApplyContext *context = userData;
+    ssize_t readLen;
+
+    while (len > 0) {
+        readLen = pread(context->oldFd, data, len, (off_t) offset);
+        if (readLen <= 0) {
+            return DJI_ERROR_SYSTEM_MODULE_CODE_SYSTEM_ERROR;
+        }
+        data += readLen;
+        len -= (uint32_t) readLen;
+        offset += (uint64_t) readLen;
+    }
+
+    return DJI_ERROR_SYSTEM_MODULE_CODE_SUCCESS;
+}
+
+static T_DjiReturnCode DjiUpgradeDelta_WriteStaged(void *userData, const uint8_t *data, uint32_t len)
+{
+    T_DjiUpgradeDeltaApplyContext *context = userData;
+    T_DjiReturnCode returnCode;
+
+    returnCode = DjiUpgradeStagingLinux_Write(context->staging, context->stagedOffset, data, len);
+    context->stagedOffset += len;
+
+    return returnCode;
+}
+
+/****************** (C) COPYRIGHT DJI Innovations *****END OF FILE****/
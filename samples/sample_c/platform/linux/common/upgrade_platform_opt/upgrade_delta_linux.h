@@ -0,0 +1,54 @@
+/**
+ ********************************************************************
+ * @file    upgrade_delta_linux.h
+ * @brief   This is the header file for "upgrade_delta_linux.c", defining the structure and
+ * (exported) function prototypes.
+ *
+ * @copyright (c) 2021 DJI. All rights reserved.
+ *
+ * All information contained herein is, and remains, the property of DJI.
+ * The intellectual and technical concepts contained herein are proprietary
+ * to DJI and may be covered by U.S. and foreign patents, patents in process,
+ * and protected by trade secret or copyright law.  Dissemination of this
+ * information, including but not limited to data and other proprietary
+ * material(s) incorporated within the information, in any form, is strictly
+ * prohibited without the express written consent of DJI.
+ *
+ * If you receive this source code without DJI’s authorization, you may not
+ * further disseminate the information, and you must immediately remove the
+ * source code and notify DJI of its removal. DJI reserves the right to pursue
+ * legal actions against you for any loss(es) or damage(s) caused by your
+ * failure to do so.
+ *
+ *********************************************************************
+ */
+
+/* Define to prevent recursive inclusion -------------------------------------*/
+#ifndef UPGRADE_DELTA_LINUX_H
+#define UPGRADE_DELTA_LINUX_H
+
+/* Includes ------------------------------------------------------------------*/
+#include <dji_typedef.h>
+#include "utils/util_delta.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Exported constants --------------------------------------------------------*/
+
+/* Exported types ------------------------------------------------------------*/
+
+/* Exported functions --------------------------------------------------------*/
+bool DjiUpgradeDeltaLinux_IsPatchFile(const char *path);
+T_DjiReturnCode DjiUpgradeDeltaLinux_CreatePatchFile(const char *oldPath, const char *newPath, const char *patchPath,
+                                                     T_UtilDeltaStatistics *statistics);
+T_DjiReturnCode DjiUpgradeDeltaLinux_ApplyPatchFile(const char *patchPath, const char *oldPath,
+                                                    const char *stagedPath, uint8_t newMd5[DJI_MD5_BUFFER_LEN]);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // UPGRADE_DELTA_LINUX_H
+/************************ (C) COPYRIGHT DJI Innovations *******END OF FILE******/
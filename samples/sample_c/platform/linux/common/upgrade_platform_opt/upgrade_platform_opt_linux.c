@@ -28,20 +28,30 @@
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
+#include <dirent.h>
+#include <glob.h>
+#include <unistd.h>
+#include <sys/stat.h>
 #include <dji_logger.h>
 #include <dji_upgrade.h>
+#include "upgrade_staging_linux.h"
+#include "upgrade_delta_linux.h"
 
 /* Private constants ---------------------------------------------------------*/
 #define DJI_TEST_CMD_CALL_MAX_LEN              (DJI_FILE_PATH_SIZE_MAX + 256)
 #define DJI_REBOOT_STATE_FILE_NAME             "reboot_state"
+#define DJI_REBOOT_STATE_TEMP_FILE_NAME        DJI_REBOOT_STATE_FILE_NAME ".tmp"
+#define DJI_TEST_UPGRADE_DELTA_IMAGE_SUFFIX    ".image"
 
 /* Private types -------------------------------------------------------------*/
 
 /* Private values -------------------------------------------------------------*/
-static FILE *s_upgradeProgramFile = NULL;
+static T_DjiUpgradeStaging s_upgradeStaging = {.fd = -1};
+static bool s_isUpgradeStagingMd5Valid = false;
 
 /* Private functions declaration ---------------------------------------------*/
 static T_DjiReturnCode DjiTest_RunSystemCmd(char *systemCmdStr);
+static bool DjiTest_IsResumableUpgradeFile(const char *fileName);
 
 /* Exported functions definition ---------------------------------------------*/
 T_DjiReturnCode DjiUpgradePlatformLinux_RebootSystem(void)
@@ -53,38 +63,84 @@ T_DjiReturnCode DjiUpgradePlatformLinux_RebootSystem(void)
     return DjiTest_RunSystemCmd("reboot -h now");
 }
 
+/**
+ * @brief Remove the files of earlier upgrades. A package whose staging was interrupted is kept with its resume point,
+ * so the next transfer of the same package continues from there.
+ */
 T_DjiReturnCode DjiUpgradePlatformLinux_CleanUpgradeProgramFileStoreArea(void)
 {
     char cmdBuffer[DJI_TEST_CMD_CALL_MAX_LEN];
+    T_DjiReturnCode returnCode = DJI_ERROR_SYSTEM_MODULE_CODE_SUCCESS;
+    struct dirent *entry;
+    DIR *dir;
 
-    snprintf(cmdBuffer, DJI_TEST_CMD_CALL_MAX_LEN, "rm -rf %s*", DJI_TEST_UPGRADE_FILE_DIR);
+    dir = opendir(DJI_TEST_UPGRADE_FILE_DIR);
+    if (dir == NULL) {
+        return DJI_ERROR_SYSTEM_MODULE_CODE_SUCCESS;
+    }
 
-    USER_LOG_INFO("%s", cmdBuffer);
+    while ((entry = readdir(dir)) != NULL) {
+        if (strcmp(entry->d_name, ".") == 0 || strcmp(entry->d_name, "..") == 0 ||
+            DjiTest_IsResumableUpgradeFile(entry->d_name)) {
+            continue;
+        }
+
+        snprintf(cmdBuffer, DJI_TEST_CMD_CALL_MAX_LEN, "rm -rf %s%s", DJI_TEST_UPGRADE_FILE_DIR, entry->d_name);
+        USER_LOG_INFO("%s", cmdBuffer);
+        if (DjiTest_RunSystemCmd(cmdBuffer) != DJI_ERROR_SYSTEM_MODULE_CODE_SUCCESS) {
+            returnCode = DJI_ERROR_SYSTEM_MODULE_CODE_SYSTEM_ERROR;
+        }
+    }
+    closedir(dir);
 
-    return DjiTest_RunSystemCmd(cmdBuffer);
+    return returnCode;
 }
 
+/**
+ * @brief Install the received package over the old program. The package is verified against the md5 computed while
+ * it was received and renamed into place, a running program keeps its old image until it restarts.
+ * @note A package that is a delta patch is first applied to the old program, the rebuilt image must match the md5
+ * the patch carries for the new program before it is installed. The dji_delta_patch host tool builds such patches.
+ */
 T_DjiReturnCode DjiUpgradePlatformLinux_ReplaceOldProgram(void)
 {
-    char cmdBuffer[DJI_TEST_CMD_CALL_MAX_LEN];
+    char imagePath[DJI_FILE_PATH_SIZE_MAX + sizeof(DJI_TEST_UPGRADE_DELTA_IMAGE_SUFFIX)];
+    uint8_t imageMd5[DJI_MD5_BUFFER_LEN];
     T_DjiReturnCode returnCode;
+    bool isStagedPackage;
+    glob_t packageGlob;
 
-    snprintf(cmdBuffer, DJI_TEST_CMD_CALL_MAX_LEN, "cp -f %s*_V*.*.*.bin %s", DJI_TEST_UPGRADE_FILE_DIR,
-             DJI_TEST_UPGRADE_OLD_FIRMWARE_PATH);
+    if (glob(DJI_TEST_UPGRADE_FILE_DIR "*_V*.*.*.bin", 0, NULL, &packageGlob) != 0) {
+        USER_LOG_ERROR("Can't find upgrade program file in %s", DJI_TEST_UPGRADE_FILE_DIR);
+        return DJI_ERROR_SYSTEM_MODULE_CODE_NOT_FOUND;
+    }
 
-    USER_LOG_INFO("%s", cmdBuffer);
+    if (DjiUpgradeDeltaLinux_IsPatchFile(packageGlob.gl_pathv[0])) {
+        snprintf(imagePath, sizeof(imagePath), "%s%s", packageGlob.gl_pathv[0], DJI_TEST_UPGRADE_DELTA_IMAGE_SUFFIX);
+        USER_LOG_INFO("apply patch %s to %s", packageGlob.gl_pathv[0], DJI_TEST_UPGRADE_OLD_FIRMWARE_PATH);
 
-    returnCode = DjiTest_RunSystemCmd(cmdBuffer);
-    if (returnCode != DJI_ERROR_SYSTEM_MODULE_CODE_SUCCESS) {
-        USER_LOG_ERROR("Replace old program file error");
-        return returnCode;
+        returnCode = DjiUpgradeDeltaLinux_ApplyPatchFile(packageGlob.gl_pathv[0], DJI_TEST_UPGRADE_OLD_FIRMWARE_PATH,
+                                                         imagePath, imageMd5);
+        if (returnCode == DJI_ERROR_SYSTEM_MODULE_CODE_SUCCESS) {
+            returnCode = DjiUpgradeStagingLinux_Install(imagePath, DJI_TEST_UPGRADE_OLD_FIRMWARE_PATH, imageMd5);
+            remove(imagePath);
+        }
+        goto out;
     }
 
-    snprintf(cmdBuffer, DJI_TEST_CMD_CALL_MAX_LEN, "chmod 777 %s", DJI_TEST_UPGRADE_OLD_FIRMWARE_PATH);
+    isStagedPackage = s_isUpgradeStagingMd5Valid && strcmp(packageGlob.gl_pathv[0], s_upgradeStaging.path) == 0;
+    USER_LOG_INFO("install %s to %s", packageGlob.gl_pathv[0], DJI_TEST_UPGRADE_OLD_FIRMWARE_PATH);
 
-    USER_LOG_INFO("%s", cmdBuffer);
+    returnCode = DjiUpgradeStagingLinux_Install(packageGlob.gl_pathv[0], DJI_TEST_UPGRADE_OLD_FIRMWARE_PATH,
+                                                isStagedPackage ? s_upgradeStaging.md5 : NULL);
+
+out:
+    if (returnCode != DJI_ERROR_SYSTEM_MODULE_CODE_SUCCESS) {
+        USER_LOG_ERROR("Replace old program file error");
+    }
+    globfree(&packageGlob);
 
-    return DjiTest_RunSystemCmd(cmdBuffer);
+    return returnCode;
 }
 
 T_DjiReturnCode DjiUpgradePlatformLinux_SetUpgradeRebootState(const T_DjiUpgradeEndInfo *upgradeEndInfo)
@@ -93,7 +149,8 @@ T_DjiReturnCode DjiUpgradePlatformLinux_SetUpgradeRebootState(const T_DjiUpgrade
     size_t res;
     T_DjiReturnCode returnCode;
 
-    rebootStateFile = fopen(DJI_REBOOT_STATE_FILE_NAME, "w+");
+    /* Written aside and renamed, a power loss leaves the old state or the new one, never a partial one. */
+    rebootStateFile = fopen(DJI_REBOOT_STATE_TEMP_FILE_NAME, "w+");
     if (rebootStateFile == NULL) {
         USER_LOG_ERROR("Create reboot state file error");
         return DJI_ERROR_SYSTEM_MODULE_CODE_SYSTEM_ERROR;
@@ -107,10 +164,25 @@ T_DjiReturnCode DjiUpgradePlatformLinux_SetUpgradeRebootState(const T_DjiUpgrade
         returnCode = DJI_ERROR_SYSTEM_MODULE_CODE_SYSTEM_ERROR;
         goto out;
     }
+    if (fflush(rebootStateFile) != 0 || fsync(fileno(rebootStateFile)) != 0) {
+        USER_LOG_ERROR("Sync reboot state file error");
+        returnCode = DJI_ERROR_SYSTEM_MODULE_CODE_SYSTEM_ERROR;
+        goto out;
+    }
     returnCode = DJI_ERROR_SYSTEM_MODULE_CODE_SUCCESS;
 
 out:
-    fclose(rebootStateFile);
+    if (fclose(rebootStateFile) != 0) {
+        returnCode = DJI_ERROR_SYSTEM_MODULE_CODE_SYSTEM_ERROR;
+    }
+    if (returnCode == DJI_ERROR_SYSTEM_MODULE_CODE_SUCCESS &&
+        rename(DJI_REBOOT_STATE_TEMP_FILE_NAME, DJI_REBOOT_STATE_FILE_NAME) != 0) {
+        USER_LOG_ERROR("Rename reboot state file error");
+        returnCode = DJI_ERROR_SYSTEM_MODULE_CODE_SYSTEM_ERROR;
+    }
+    if (returnCode != DJI_ERROR_SYSTEM_MODULE_CODE_SUCCESS) {
+        remove(DJI_REBOOT_STATE_TEMP_FILE_NAME);
+    }
     return returnCode;
 }
 
@@ -146,15 +218,22 @@ out:
 
 T_DjiReturnCode DjiUpgradePlatformLinux_CleanUpgradeRebootState(void)
 {
-    USER_LOG_INFO("rm -f %s", DJI_REBOOT_STATE_FILE_NAME);
+    USER_LOG_INFO("remove %s", DJI_REBOOT_STATE_FILE_NAME);
 
-    return DjiTest_RunSystemCmd("rm -f "DJI_REBOOT_STATE_FILE_NAME);
+    if (remove(DJI_REBOOT_STATE_FILE_NAME) != 0 && access(DJI_REBOOT_STATE_FILE_NAME, F_OK) == 0) {
+        USER_LOG_ERROR("Remove reboot state file error");
+        return DJI_ERROR_SYSTEM_MODULE_CODE_SYSTEM_ERROR;
+    }
+
+    return DJI_ERROR_SYSTEM_MODULE_CODE_SUCCESS;
 }
 
 T_DjiReturnCode DjiUpgradePlatformLinux_CreateUpgradeProgramFile(const T_DjiUpgradeFileInfo *fileInfo)
 {
     char filePath[DJI_FILE_PATH_SIZE_MAX];
     char cmdBuffer[DJI_TEST_CMD_CALL_MAX_LEN];
+    T_DjiUpgradeStagingConfig stagingConfig;
+    T_DjiReturnCode returnCode;
 
     snprintf(cmdBuffer, DJI_TEST_CMD_CALL_MAX_LEN, "mkdir -p %s", DJI_TEST_UPGRADE_FILE_DIR);
 
@@ -164,12 +243,18 @@ T_DjiReturnCode DjiUpgradePlatformLinux_CreateUpgradeProgramFile(const T_DjiUpgr
 
     USER_LOG_INFO("create %s%s", DJI_TEST_UPGRADE_FILE_DIR, fileInfo->fileName);
 
-    s_upgradeProgramFile = NULL;
+    if (s_upgradeStaging.fd >= 0) {
+        DjiUpgradeStagingLinux_Close(&s_upgradeStaging);
+    }
+    s_isUpgradeStagingMd5Valid = false;
+
     snprintf(filePath, DJI_FILE_PATH_SIZE_MAX, "%s%s", DJI_TEST_UPGRADE_FILE_DIR, fileInfo->fileName);
-    s_upgradeProgramFile = fopen(filePath, "w+");
-    if (s_upgradeProgramFile == NULL) {
+    DjiUpgradeStagingLinux_GetDefaultConfig(&stagingConfig);
+    returnCode = DjiUpgradeStagingLinux_Open(&s_upgradeStaging, &stagingConfig, filePath, fileInfo->fileSize,
+                                             NULL);
+    if (returnCode != DJI_ERROR_SYSTEM_MODULE_CODE_SUCCESS) {
         USER_LOG_ERROR("Upgrade program file can't create: %s", filePath);
-        return DJI_ERROR_SYSTEM_MODULE_CODE_SYSTEM_ERROR;
+        return returnCode;
     }
 
     return DJI_ERROR_SYSTEM_MODULE_CODE_SUCCESS;
@@ -178,20 +263,17 @@ T_DjiReturnCode DjiUpgradePlatformLinux_CreateUpgradeProgramFile(const T_DjiUpgr
 T_DjiReturnCode
 DjiUpgradePlatformLinux_WriteUpgradeProgramFile(uint32_t offset, const uint8_t *data, uint16_t dataLen)
 {
-    size_t writeLen;
+    T_DjiReturnCode returnCode;
 
-    if (s_upgradeProgramFile == NULL) {
+    if (s_upgradeStaging.fd < 0) {
         USER_LOG_ERROR("upgrade program file can't be NULL");
         return DJI_ERROR_SYSTEM_MODULE_CODE_INVALID_PARAMETER;
     }
 
-    if (fseek(s_upgradeProgramFile, offset, SEEK_SET) != 0) {
-        return DJI_ERROR_SYSTEM_MODULE_CODE_SYSTEM_ERROR;
-    }
-    writeLen = fwrite(data, 1, dataLen, s_upgradeProgramFile);
-    if (writeLen != dataLen) {
-        USER_LOG_ERROR("Write upgrade program file error, writeLen = %d, dataLen = %d", writeLen);
-        return DJI_ERROR_SYSTEM_MODULE_CODE_SYSTEM_ERROR;
+    returnCode = DjiUpgradeStagingLinux_Write(&s_upgradeStaging, offset, data, dataLen);
+    if (returnCode != DJI_ERROR_SYSTEM_MODULE_CODE_SUCCESS) {
+        USER_LOG_ERROR("Write upgrade program file error, offset = %u, dataLen = %d", offset, dataLen);
+        return returnCode;
     }
 
     return DJI_ERROR_SYSTEM_MODULE_CODE_SUCCESS;
@@ -200,39 +282,55 @@ DjiUpgradePlatformLinux_WriteUpgradeProgramFile(uint32_t offset, const uint8_t *
 T_DjiReturnCode DjiUpgradePlatformLinux_ReadUpgradeProgramFile(uint32_t offset, uint16_t readDataLen, uint8_t *data,
                                                                uint16_t *realLen)
 {
-    uint32_t readRtn;
+    T_DjiReturnCode returnCode;
+    uint32_t readLen = 0;
 
-    if (s_upgradeProgramFile == NULL) {
+    if (s_upgradeStaging.fd < 0) {
         USER_LOG_ERROR("upgrade program file can't be NULL");
         return DJI_ERROR_SYSTEM_MODULE_CODE_INVALID_PARAMETER;
     }
 
-    if (fseek(s_upgradeProgramFile, offset, SEEK_SET) != 0) {
+    returnCode = DjiUpgradeStagingLinux_Read(&s_upgradeStaging, offset, readDataLen, data, &readLen);
+    if (returnCode != DJI_ERROR_SYSTEM_MODULE_CODE_SUCCESS || readLen == 0) {
         return DJI_ERROR_SYSTEM_MODULE_CODE_SYSTEM_ERROR;
     }
+    *realLen = (uint16_t) readLen;
 
-    readRtn = fread(data, 1, readDataLen, s_upgradeProgramFile);
-    if (readRtn == 0 || readRtn > readDataLen) {
-        return DJI_ERROR_SYSTEM_MODULE_CODE_SYSTEM_ERROR;
+    return DJI_ERROR_SYSTEM_MODULE_CODE_SUCCESS;
+}
+
+/**
+ * @brief Get the md5 of the completely received program file, it is computed while the file is received.
+ */
+T_DjiReturnCode DjiUpgradePlatformLinux_GetUpgradeProgramFileMd5(uint8_t md5[DJI_MD5_BUFFER_LEN])
+{
+    T_DjiReturnCode returnCode;
+
+    if (s_upgradeStaging.fd < 0) {
+        USER_LOG_ERROR("upgrade program file can't be NULL");
+        return DJI_ERROR_SYSTEM_MODULE_CODE_INVALID_PARAMETER;
     }
-    *realLen = readRtn;
+
+    returnCode = DjiUpgradeStagingLinux_Finish(&s_upgradeStaging, md5);
+    if (returnCode != DJI_ERROR_SYSTEM_MODULE_CODE_SUCCESS) {
+        USER_LOG_ERROR("Finish upgrade program file error, return code = 0x%08llX", returnCode);
+        return returnCode;
+    }
+    s_isUpgradeStagingMd5Valid = true;
 
     return DJI_ERROR_SYSTEM_MODULE_CODE_SUCCESS;
 }
 
 T_DjiReturnCode DjiUpgradePlatformLinux_CloseUpgradeProgramFile(void)
 {
-    if (s_upgradeProgramFile == NULL) {
+    if (s_upgradeStaging.fd < 0) {
         USER_LOG_ERROR("upgrade program file can't be NULL");
         return DJI_ERROR_SYSTEM_MODULE_CODE_INVALID_PARAMETER;
     }
 
     USER_LOG_INFO("close upgrade program file");
 
-    fclose(s_upgradeProgramFile);
-    s_upgradeProgramFile = NULL;
-
-    return DJI_ERROR_SYSTEM_MODULE_CODE_SUCCESS;
+    return DjiUpgradeStagingLinux_Close(&s_upgradeStaging);
 }
 
 /* Private functions definition-----------------------------------------------*/
@@ -253,4 +351,20 @@ static T_DjiReturnCode DjiTest_RunSystemCmd(char *systemCmdStr)
         return DJI_ERROR_SYSTEM_MODULE_CODE_INVALID_PARAMETER;
     }
 }
+
+static bool DjiTest_IsResumableUpgradeFile(const char *fileName)
+{
+    char filePath[DJI_FILE_PATH_SIZE_MAX];
+    size_t nameLen = strlen(fileName);
+    size_t suffixLen = strlen(DJI_UPGRADE_STAGING_RESUME_SUFFIX);
+
+    snprintf(filePath, DJI_FILE_PATH_SIZE_MAX, "%s%s", DJI_TEST_UPGRADE_FILE_DIR, fileName);
+    if (nameLen > suffixLen && strcmp(fileName + nameLen - suffixLen, DJI_UPGRADE_STAGING_RESUME_SUFFIX) == 0) {
+        filePath[strlen(filePath) - suffixLen] = '\0';
+        return access(filePath, F_OK) == 0 && DjiUpgradeStagingLinux_IsResumable(filePath);
+    }
+
+    return DjiUpgradeStagingLinux_IsResumable(filePath);
+}
+
 /****************** (C) COPYRIGHT DJI Innovations *****END OF FILE****/
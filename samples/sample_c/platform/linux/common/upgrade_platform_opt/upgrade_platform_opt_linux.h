@@ -52,6 +52,7 @@ T_DjiReturnCode DjiUpgradePlatformLinux_WriteUpgradeProgramFile(uint32_t offset,
                                                                   uint16_t dataLen);
 T_DjiReturnCode DjiUpgradePlatformLinux_ReadUpgradeProgramFile(uint32_t offset, uint16_t readDataLen, uint8_t *data,
                                                                  uint16_t *realLen);
+T_DjiReturnCode DjiUpgradePlatformLinux_GetUpgradeProgramFileMd5(uint8_t md5[DJI_MD5_BUFFER_LEN]);
 T_DjiReturnCode DjiUpgradePlatformLinux_CloseUpgradeProgramFile(void);
 
 T_DjiReturnCode DjiUpgradePlatformLinux_ReplaceOldProgram(void);
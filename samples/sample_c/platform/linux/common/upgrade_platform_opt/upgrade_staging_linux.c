@@ -0,0 +1,622 @@
+/**
+ ********************************************************************
+ * @file    upgrade_staging_linux.c
+ * @brief   Hashes, buffers and checkpoints an upgrade package while it is received, and installs it atomically.
+ *
+ * @copyright (c) 2021 DJI. All rights reserved.
+ *
+ * All information contained herein is, and remains, the property of DJI.
+ * The intellectual and technical concepts contained herein are proprietary
+ * to DJI and may be covered by U.S. and foreign patents, patents in process,
+ * and protected by trade secret or copyright law.  Dissemination of this
+ * information, including but not limited to data and other proprietary
+ * material(s) incorporated within the information, in any form, is strictly
+ * prohibited without the express written consent of DJI.
+ *
+ * If you receive this source code without DJI’s authorization, you may not
+ * further disseminate the information, and you must immediately remove the
+ * source code and notify DJI of its removal. DJI reserves the right to pursue
+ * legal actions against you for any loss(es) or damage(s) caused by your
+ * failure to do so.
+ *
+ *********************************************************************
+ */
+
+/* Includes ------------------------------------------------------------------*/
+#include "upgrade_staging_linux.h"
+#include <stdio.h>
+#include <stddef.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <libgen.h>
+#include <unistd.h>
+#include <sys/stat.h>
+#include <dji_logger.h>
+#include <dji_platform.h>
+#include "utils/util_misc.h"
+
+/* Private constants ---------------------------------------------------------*/
+#define DJI_UPGRADE_STAGING_RESUME_MAGIC        0x31535544  /* "DUS1" */
+#define DJI_UPGRADE_STAGING_RESUME_VERSION      1
+#define DJI_UPGRADE_STAGING_INSTALL_SUFFIX      ".new"
+#define DJI_UPGRADE_STAGING_PATH_SUFFIX_MAX_LEN (16)
+
+/* Private types -------------------------------------------------------------*/
+typedef struct {
+    uint32_t magic;
+    uint32_t version;
+    uint64_t fileSize;
+    uint64_t committedBytes;
+    MD5_CTX md5Ctx;                 /*!< Hash state after committedBytes, so resuming needs no read of the file. */
+    uint8_t checksum[DJI_MD5_BUFFER_LEN];
+} T_DjiUpgradeStagingResumeRecord;
+
+/* Private values -------------------------------------------------------------*/
+
+/* Private functions declaration ---------------------------------------------*/
+static T_DjiReturnCode DjiUpgradeStaging_Flush(T_DjiUpgradeStaging *staging);
+static T_DjiReturnCode DjiUpgradeStaging_Commit(T_DjiUpgradeStaging *staging);
+static T_DjiReturnCode DjiUpgradeStaging_LoadResumeRecord(const char *path, T_DjiUpgradeStagingResumeRecord *record);
+static void DjiUpgradeStaging_GetRecordChecksum(const T_DjiUpgradeStagingResumeRecord *record, uint8_t *checksum);
+static T_DjiReturnCode DjiUpgradeStaging_WriteAll(int fd, const uint8_t *data, uint32_t len, uint64_t offset);
+static T_DjiReturnCode DjiUpgradeStaging_SyncParentDir(const char *path);
+
+/* Exported functions definition ---------------------------------------------*/
+void DjiUpgradeStagingLinux_GetDefaultConfig(T_DjiUpgradeStagingConfig *config)
+{
+    memset(config, 0, sizeof(T_DjiUpgradeStagingConfig));
+
+    config->bufferSize = 1024 * 1024;
+    config->commitIntervalBytes = 8 * 1024 * 1024;
+    config->isPreallocate = true;
+}
+
+/**
+ * @brief Open the staged file at path, continuing an interrupted staging of the same size when one was recorded.
+ * @param resumeOffset: bytes already staged, the sender may start there or send them again. Can be NULL.
+ */
+T_DjiReturnCode DjiUpgradeStagingLinux_Open(T_DjiUpgradeStaging *staging, const T_DjiUpgradeStagingConfig *config,
+                                            const char *path, uint64_t fileSize, uint64_t *resumeOffset)
+{
+    T_DjiOsalHandler *osalHandler = DjiPlatform_GetOsalHandler();
+    T_DjiUpgradeStagingResumeRecord record;
+    T_DjiReturnCode returnCode;
+    char resumePath[DJI_FILE_PATH_SIZE_MAX + DJI_UPGRADE_STAGING_PATH_SUFFIX_MAX_LEN];
+    struct stat fileStat;
+    int result;
+
+    if (staging == NULL || config == NULL || path == NULL || strlen(path) >= DJI_FILE_PATH_SIZE_MAX ||
+        config->bufferSize == 0 || config->bufferSize % DJI_UPGRADE_STAGING_BUFFER_ALIGN != 0) {
+        return DJI_ERROR_SYSTEM_MODULE_CODE_INVALID_PARAMETER;
+    }
+
+    memset(staging, 0, sizeof(T_DjiUpgradeStaging));
+    staging->config = *config;
+    staging->fd = -1;
+    strcpy(staging->path, path);
+    staging->statistics.fileSize = fileSize;
+
+    if (posix_memalign((void **) &staging->buffer, DJI_UPGRADE_STAGING_BUFFER_ALIGN, config->bufferSize) != 0) {
+        staging->buffer = NULL;
+        return DJI_ERROR_SYSTEM_MODULE_CODE_MEMORY_ALLOC_FAILED;
+    }
+
+    /* The hash state of the record only describes the file if the file still holds every committed byte. */
+    if (config->commitIntervalBytes > 0 &&
+        DjiUpgradeStaging_LoadResumeRecord(path, &record) == DJI_ERROR_SYSTEM_MODULE_CODE_SUCCESS &&
+        record.fileSize == fileSize && stat(path, &fileStat) == 0 &&
+        (uint64_t) fileStat.st_size >= record.committedBytes) {
+        staging->fd = open(path, O_RDWR);
+    }
+
+    if (staging->fd >= 0) {
+        staging->md5Ctx = record.md5Ctx;
+        staging->bufferOffset = record.committedBytes;
+        staging->statistics.stagedBytes = record.committedBytes;
+        staging->statistics.committedBytes = record.committedBytes;
+        staging->statistics.resumedBytes = record.committedBytes;
+        staging->progressPercent = (uint32_t) (fileSize > 0 ? record.committedBytes * 10 / fileSize * 10 : 0);
+        USER_LOG_INFO("Resume upgrade staging %s at %llu of %llu bytes.", path, record.committedBytes, fileSize);
+    } else {
+        snprintf(resumePath, sizeof(resumePath), "%s%s", path, DJI_UPGRADE_STAGING_RESUME_SUFFIX);
+        remove(resumePath);
+        staging->fd = open(path, O_RDWR | O_CREAT | O_TRUNC, 0644);
+        if (staging->fd < 0) {
+            USER_LOG_ERROR("Create upgrade staging file %s error: %s.", path, strerror(errno));
+            returnCode = DJI_ERROR_SYSTEM_MODULE_CODE_SYSTEM_ERROR;
+            goto freeBuffer;
+        }
+
+        if (config->isPreallocate && fileSize > 0) {
+            result = posix_fallocate(staging->fd, 0, (off_t) fileSize);
+            if (result != 0) {
+                USER_LOG_ERROR("Reserve %llu bytes for %s error: %s.", fileSize, path, strerror(result));
+                returnCode = DJI_ERROR_SYSTEM_MODULE_CODE_SYSTEM_ERROR;
+                goto closeFile;
+            }
+        }
+        UtilMd5_Init(&staging->md5Ctx);
+    }
+
+    if (resumeOffset != NULL) {
+        *resumeOffset = staging->statistics.stagedBytes;
+    }
+    osalHandler->GetTimeMs(&staging->openTimeMs);
+
+    return DJI_ERROR_SYSTEM_MODULE_CODE_SUCCESS;
+
+closeFile:
+    close(staging->fd);
+    staging->fd = -1;
+freeBuffer:
+    free(staging->buffer);
+    staging->buffer = NULL;
+
+    return returnCode;
+}
+
+/**
+ * @brief Stage data at offset. Data below the staged length is skipped, data past it is an error.
+ */
+T_DjiReturnCode DjiUpgradeStagingLinux_Write(T_DjiUpgradeStaging *staging, uint64_t offset, const uint8_t *data,
+                                             uint32_t len)
+{
+    T_DjiReturnCode returnCode;
+    uint64_t stagedBytes;
+    uint32_t skipLen;
+    uint32_t copyLen;
+    uint32_t percent;
+
+    if (staging == NULL || staging->fd < 0 || (data == NULL && len > 0)) {
+        return DJI_ERROR_SYSTEM_MODULE_CODE_INVALID_PARAMETER;
+    }
+    if (staging->isFinished) {
+        return DJI_ERROR_SYSTEM_MODULE_CODE_NONSUPPORT_IN_CURRENT_STATE;
+    }
+
+    staging->statistics.writeCount++;
+    stagedBytes = staging->statistics.stagedBytes;
+    if (offset > stagedBytes) {
+        USER_LOG_ERROR("Upgrade staging expects offset %llu, got %llu.", stagedBytes, offset);
+        return DJI_ERROR_SYSTEM_MODULE_CODE_INVALID_PARAMETER;
+    }
+    if (offset + len <= stagedBytes) {
+        staging->statistics.skippedBytes += len;
+        return DJI_ERROR_SYSTEM_MODULE_CODE_SUCCESS;
+    }
+
+    skipLen = (uint32_t) (stagedBytes - offset);
+    data += skipLen;
+    len -= skipLen;
+    staging->statistics.skippedBytes += skipLen;
+    if (stagedBytes + len > staging->statistics.fileSize) {
+        USER_LOG_ERROR("Upgrade staging data exceeds the file size %llu.", staging->statistics.fileSize);
+        return DJI_ERROR_SYSTEM_MODULE_CODE_OUT_OF_RANGE;
+    }
+
+    staging->statistics.stagedBytes += len;
+
+    while (len > 0) {
+        copyLen = USER_UTIL_MIN(len, staging->config.bufferSize - staging->bufferLen);
+        memcpy(&staging->buffer[staging->bufferLen], data, copyLen);
+        staging->bufferLen += copyLen;
+        data += copyLen;
+        len -= copyLen;
+
+        if (staging->bufferLen < staging->config.bufferSize) {
+            continue;
+        }
+
+        returnCode = DjiUpgradeStaging_Flush(staging);
+        if (returnCode != DJI_ERROR_SYSTEM_MODULE_CODE_SUCCESS) {
+            return returnCode;
+        }
+
+        /* Commits follow full buffers, so the resumed file keeps writing in aligned blocks. */
+        if (staging->config.commitIntervalBytes > 0 &&
+            staging->bufferOffset - staging->statistics.committedBytes >= staging->config.commitIntervalBytes) {
+            returnCode = DjiUpgradeStaging_Commit(staging);
+            if (returnCode != DJI_ERROR_SYSTEM_MODULE_CODE_SUCCESS) {
+                return returnCode;
+            }
+        }
+    }
+
+    percent = (uint32_t) (staging->statistics.stagedBytes * 10 / staging->statistics.fileSize * 10);
+    if (percent > staging->progressPercent) {
+        staging->progressPercent = percent;
+        USER_LOG_INFO("Upgrade staging %u%%, %llu of %llu bytes.", percent, staging->statistics.stagedBytes,
+                      staging->statistics.fileSize);
+    }
+
+    return DJI_ERROR_SYSTEM_MODULE_CODE_SUCCESS;
+}
+
+T_DjiReturnCode DjiUpgradeStagingLinux_Read(T_DjiUpgradeStaging *staging, uint64_t offset, uint32_t len,
+                                            uint8_t *data, uint32_t *realLen)
+{
+    T_DjiReturnCode returnCode;
+    ssize_t readLen;
+
+    if (staging == NULL || staging->fd < 0 || data == NULL || realLen == NULL) {
+        return DJI_ERROR_SYSTEM_MODULE_CODE_INVALID_PARAMETER;
+    }
+
+    returnCode = DjiUpgradeStaging_Flush(staging);
+    if (returnCode != DJI_ERROR_SYSTEM_MODULE_CODE_SUCCESS) {
+        return returnCode;
+    }
+
+    if (offset >= staging->statistics.stagedBytes) {
+        *realLen = 0;
+        return DJI_ERROR_SYSTEM_MODULE_CODE_SUCCESS;
+    }
+    len = (uint32_t) USER_UTIL_MIN((uint64_t) len, staging->statistics.stagedBytes - offset);
+
+    readLen = pread(staging->fd, data, len, (off_t) offset);
+    if (readLen < 0) {
+        USER_LOG_ERROR("Read upgrade staging file error: %s.", strerror(errno));
+        return DJI_ERROR_SYSTEM_MODULE_CODE_SYSTEM_ERROR;
+    }
+    *realLen = (uint32_t) readLen;
+
+    return DJI_ERROR_SYSTEM_MODULE_CODE_SUCCESS;
+}
+
+/**
+ * @brief Sync the complete package to disk and get its md5, the resume point is dropped.
+ */
+T_DjiReturnCode DjiUpgradeStagingLinux_Finish(T_DjiUpgradeStaging *staging, uint8_t md5[DJI_MD5_BUFFER_LEN])
+{
+    T_DjiReturnCode returnCode;
+    char resumePath[DJI_FILE_PATH_SIZE_MAX + DJI_UPGRADE_STAGING_PATH_SUFFIX_MAX_LEN];
+
+    if (staging == NULL || staging->fd < 0 || md5 == NULL) {
+        return DJI_ERROR_SYSTEM_MODULE_CODE_INVALID_PARAMETER;
+    }
+
+    if (!staging->isFinished) {
+        if (staging->statistics.stagedBytes != staging->statistics.fileSize) {
+            USER_LOG_ERROR("Upgrade staging is incomplete, %llu of %llu bytes.", staging->statistics.stagedBytes,
+                           staging->statistics.fileSize);
+            return DJI_ERROR_SYSTEM_MODULE_CODE_INVALID_PARAMETER;
+        }
+
+        returnCode = DjiUpgradeStaging_Flush(staging);
+        if (returnCode != DJI_ERROR_SYSTEM_MODULE_CODE_SUCCESS) {
+            return returnCode;
+        }
+        if (fsync(staging->fd) != 0) {
+            USER_LOG_ERROR("Sync upgrade staging file error: %s.", strerror(errno));
+            return DJI_ERROR_SYSTEM_MODULE_CODE_SYSTEM_ERROR;
+        }
+
+        UtilMd5_Final(&staging->md5Ctx, staging->md5);
+        staging->isFinished = true;
+
+        snprintf(resumePath, sizeof(resumePath), "%s%s", staging->path, DJI_UPGRADE_STAGING_RESUME_SUFFIX);
+        remove(resumePath);
+    }
+
+    memcpy(md5, staging->md5, DJI_MD5_BUFFER_LEN);
+
+    return DJI_ERROR_SYSTEM_MODULE_CODE_SUCCESS;
+}
+
+/**
+ * @brief Close the staged file. An unfinished staging records its resume point first.
+ */
+T_DjiReturnCode DjiUpgradeStagingLinux_Close(T_DjiUpgradeStaging *staging)
+{
+    T_DjiUpgradeStagingStatistics statistics;
+    T_DjiReturnCode returnCode = DJI_ERROR_SYSTEM_MODULE_CODE_SUCCESS;
+
+    if (staging == NULL || staging->fd < 0) {
+        return DJI_ERROR_SYSTEM_MODULE_CODE_INVALID_PARAMETER;
+    }
+
+    if (!staging->isFinished) {
+        returnCode = DjiUpgradeStaging_Flush(staging);
+        if (returnCode == DJI_ERROR_SYSTEM_MODULE_CODE_SUCCESS && staging->config.commitIntervalBytes > 0 &&
+            staging->statistics.stagedBytes > staging->statistics.committedBytes) {
+            returnCode = DjiUpgradeStaging_Commit(staging);
+        }
+    }
+
+    DjiUpgradeStagingLinux_GetStatistics(staging, &statistics);
+    USER_LOG_INFO("Upgrade staging closed, %llu of %llu bytes, %llu resumed, %llu skipped, %u KB/s.",
+                  statistics.stagedBytes, statistics.fileSize, statistics.resumedBytes, statistics.skippedBytes,
+                  statistics.throughputKBps);
+
+    close(staging->fd);
+    staging->fd = -1;
+    free(staging->buffer);
+    staging->buffer = NULL;
+
+    return returnCode;
+}
+
+void DjiUpgradeStagingLinux_GetStatistics(T_DjiUpgradeStaging *staging, T_DjiUpgradeStagingStatistics *statistics)
+{
+    T_DjiOsalHandler *osalHandler = DjiPlatform_GetOsalHandler();
+    uint32_t nowMs;
+
+    osalHandler->GetTimeMs(&nowMs);
+    staging->statistics.elapsedMs = nowMs - staging->openTimeMs;
+    staging->statistics.throughputKBps = staging->statistics.elapsedMs == 0 ? 0 : (uint32_t)
+        ((staging->statistics.stagedBytes - staging->statistics.resumedBytes) / staging->statistics.elapsedMs);
+
+    *statistics = staging->statistics;
+}
+
+/**
+ * @brief Whether the staged file at path has a valid resume point. An invalid one is removed.
+ */
+bool DjiUpgradeStagingLinux_IsResumable(const char *path)
+{
+    T_DjiUpgradeStagingResumeRecord record;
+    char resumePath[DJI_FILE_PATH_SIZE_MAX + DJI_UPGRADE_STAGING_PATH_SUFFIX_MAX_LEN];
+
+    if (DjiUpgradeStaging_LoadResumeRecord(path, &record) == DJI_ERROR_SYSTEM_MODULE_CODE_SUCCESS) {
+        return true;
+    }
+
+    snprintf(resumePath, sizeof(resumePath), "%s%s", path, DJI_UPGRADE_STAGING_RESUME_SUFFIX);
+    remove(resumePath);
+
+    return false;
+}
+
+/**
+ * @brief Replace targetPath with the staged image. The copy is synced next to the target and renamed over it, so
+ * the target is the old or the new program after a power loss, never a partial one.
+ * @param expectedMd5: md5 the staged image was verified with, the copy is rejected when it differs. Can be NULL.
+ */
+T_DjiReturnCode DjiUpgradeStagingLinux_Install(const char *stagedPath, const char *targetPath,
+                                               const uint8_t expectedMd5[DJI_MD5_BUFFER_LEN])
+{
+    T_DjiReturnCode returnCode = DJI_ERROR_SYSTEM_MODULE_CODE_SUCCESS;
+    T_DjiUpgradeStagingConfig config;
+    char tempPath[DJI_FILE_PATH_SIZE_MAX + DJI_UPGRADE_STAGING_PATH_SUFFIX_MAX_LEN];
+    uint8_t md5[DJI_MD5_BUFFER_LEN];
+    uint8_t *buffer = NULL;
+    uint64_t offset = 0;
+    struct stat fileStat;
+    MD5_CTX md5Ctx;
+    ssize_t readLen;
+    int sourceFd;
+    int targetFd;
+
+    if (stagedPath == NULL || targetPath == NULL || strlen(targetPath) >= DJI_FILE_PATH_SIZE_MAX) {
+        return DJI_ERROR_SYSTEM_MODULE_CODE_INVALID_PARAMETER;
+    }
+
+    DjiUpgradeStagingLinux_GetDefaultConfig(&config);
+    if (posix_memalign((void **) &buffer, DJI_UPGRADE_STAGING_BUFFER_ALIGN, config.bufferSize) != 0) {
+        return DJI_ERROR_SYSTEM_MODULE_CODE_MEMORY_ALLOC_FAILED;
+    }
+
+    sourceFd = open(stagedPath, O_RDONLY);
+    if (sourceFd < 0 || fstat(sourceFd, &fileStat) != 0) {
+        USER_LOG_ERROR("Open staged image %s error: %s.", stagedPath, strerror(errno));
+        returnCode = DJI_ERROR_SYSTEM_MODULE_CODE_NOT_FOUND;
+        goto closeSource;
+    }
+
+    snprintf(tempPath, sizeof(tempPath), "%s%s", targetPath, DJI_UPGRADE_STAGING_INSTALL_SUFFIX);
+    targetFd = open(tempPath, O_WRONLY | O_CREAT | O_TRUNC, 0755);
+    if (targetFd < 0) {
+        USER_LOG_ERROR("Create %s error: %s.", tempPath, strerror(errno));
+        returnCode = DJI_ERROR_SYSTEM_MODULE_CODE_SYSTEM_ERROR;
+        goto closeSource;
+    }
+    if (fileStat.st_size > 0 && posix_fallocate(targetFd, 0, fileStat.st_size) != 0) {
+        USER_LOG_ERROR("Reserve space for %s error.", tempPath);
+        returnCode = DJI_ERROR_SYSTEM_MODULE_CODE_SYSTEM_ERROR;
+        goto closeTarget;
+    }
+
+    /* The copy is hashed on the way, which checks the image against its verification without another read. */
+    UtilMd5_Init(&md5Ctx);
+    while ((readLen = read(sourceFd, buffer, config.bufferSize)) > 0) {
+        UtilMd5_Update(&md5Ctx, buffer, (size_t) readLen);
+        returnCode = DjiUpgradeStaging_WriteAll(targetFd, buffer, (uint32_t) readLen, offset);
+        if (returnCode != DJI_ERROR_SYSTEM_MODULE_CODE_SUCCESS) {
+            goto closeTarget;
+        }
+        offset += (uint64_t) readLen;
+    }
+    UtilMd5_Final(&md5Ctx, md5);
+
+    if (readLen < 0 || offset != (uint64_t) fileStat.st_size) {
+        USER_LOG_ERROR("Read staged image %s error.", stagedPath);
+        returnCode = DJI_ERROR_SYSTEM_MODULE_CODE_SYSTEM_ERROR;
+        goto closeTarget;
+    }
+    if (expectedMd5 != NULL && memcmp(md5, expectedMd5, DJI_MD5_BUFFER_LEN) != 0) {
+        USER_LOG_ERROR("Staged image %s changed since it was verified.", stagedPath);
+        returnCode = DJI_ERROR_SYSTEM_MODULE_CODE_SYSTEM_ERROR;
+        goto closeTarget;
+    }
+    if (fchmod(targetFd, S_IRWXU | S_IRWXG | S_IRWXO) != 0 || fsync(targetFd) != 0) {
+        USER_LOG_ERROR("Sync %s error: %s.", tempPath, strerror(errno));
+        returnCode = DJI_ERROR_SYSTEM_MODULE_CODE_SYSTEM_ERROR;
+        goto closeTarget;
+    }
+
+closeTarget:
+    if (close(targetFd) != 0 && returnCode == DJI_ERROR_SYSTEM_MODULE_CODE_SUCCESS) {
+        returnCode = DJI_ERROR_SYSTEM_MODULE_CODE_SYSTEM_ERROR;
+    }
+    if (returnCode == DJI_ERROR_SYSTEM_MODULE_CODE_SUCCESS && rename(tempPath, targetPath) != 0) {
+        USER_LOG_ERROR("Rename %s to %s error: %s.", tempPath, targetPath, strerror(errno));
+        returnCode = DJI_ERROR_SYSTEM_MODULE_CODE_SYSTEM_ERROR;
+    }
+    if (returnCode != DJI_ERROR_SYSTEM_MODULE_CODE_SUCCESS) {
+        remove(tempPath);
+    } else {
+        returnCode = DjiUpgradeStaging_SyncParentDir(targetPath);
+        USER_LOG_INFO("Installed %s to %s, %llu bytes.", stagedPath, targetPath, offset);
+    }
+closeSource:
+    if (sourceFd >= 0) {
+        close(sourceFd);
+    }
+    free(buffer);
+
+    return returnCode;
+}
+
+/* Private functions definition-----------------------------------------------*/
+static T_DjiReturnCode DjiUpgradeStaging_Flush(T_DjiUpgradeStaging *staging)
+{
+    T_DjiReturnCode returnCode;
+
+    if (staging->bufferLen == 0) {
+        return DJI_ERROR_SYSTEM_MODULE_CODE_SUCCESS;
+    }
+
+    returnCode = DjiUpgradeStaging_WriteAll(staging->fd, staging->buffer, staging->bufferLen, staging->bufferOffset);
+    if (returnCode != DJI_ERROR_SYSTEM_MODULE_CODE_SUCCESS) {
+        USER_LOG_ERROR("Write upgrade staging file %s error.", staging->path);
+        return returnCode;
+    }
+
+    /* Hash on flush, so the hash state always ends at bufferOffset and a commit can save it as the resume point. */
+    UtilMd5_Update(&staging->md5Ctx, staging->buffer, staging->bufferLen);
+    staging->bufferOffset += staging->bufferLen;
+    staging->bufferLen = 0;
+    staging->statistics.flushCount++;
+
+    return DJI_ERROR_SYSTEM_MODULE_CODE_SUCCESS;
+}
+
+/**
+ * @brief Record the flushed length and hash state. The data is synced before the record is replaced, so the record
+ * never covers bytes a power loss could take back.
+ */
+static T_DjiReturnCode DjiUpgradeStaging_Commit(T_DjiUpgradeStaging *staging)
+{
+    T_DjiUpgradeStagingResumeRecord record = {0};
+    char resumePath[DJI_FILE_PATH_SIZE_MAX + DJI_UPGRADE_STAGING_PATH_SUFFIX_MAX_LEN];
+    char tempPath[DJI_FILE_PATH_SIZE_MAX + 2 * DJI_UPGRADE_STAGING_PATH_SUFFIX_MAX_LEN];
+    bool isWriteOk;
+    FILE *fp;
+
+    if (fdatasync(staging->fd) != 0) {
+        USER_LOG_ERROR("Sync upgrade staging file error: %s.", strerror(errno));
+        return DJI_ERROR_SYSTEM_MODULE_CODE_SYSTEM_ERROR;
+    }
+
+    record.magic = DJI_UPGRADE_STAGING_RESUME_MAGIC;
+    record.version = DJI_UPGRADE_STAGING_RESUME_VERSION;
+    record.fileSize = staging->statistics.fileSize;
+    record.committedBytes = staging->bufferOffset;
+    record.md5Ctx = staging->md5Ctx;
+    DjiUpgradeStaging_GetRecordChecksum(&record, record.checksum);
+
+    snprintf(resumePath, sizeof(resumePath), "%s%s", staging->path, DJI_UPGRADE_STAGING_RESUME_SUFFIX);
+    snprintf(tempPath, sizeof(tempPath), "%s.tmp", resumePath);
+    fp = fopen(tempPath, "wb");
+    if (fp == NULL) {
+        USER_LOG_ERROR("Open upgrade resume point %s failed.", tempPath);
+        return DJI_ERROR_SYSTEM_MODULE_CODE_SYSTEM_ERROR;
+    }
+
+    isWriteOk = fwrite(&record, 1, sizeof(record), fp) == sizeof(record) && fflush(fp) == 0 &&
+                fsync(fileno(fp)) == 0;
+    if (fclose(fp) != 0) {
+        isWriteOk = false;
+    }
+
+    if (!isWriteOk || rename(tempPath, resumePath) != 0) {
+        USER_LOG_ERROR("Write upgrade resume point %s failed.", resumePath);
+        remove(tempPath);
+        return DJI_ERROR_SYSTEM_MODULE_CODE_SYSTEM_ERROR;
+    }
+
+    staging->statistics.committedBytes = record.committedBytes;
+    staging->statistics.commitCount++;
+
+    return DJI_ERROR_SYSTEM_MODULE_CODE_SUCCESS;
+}
+
+static T_DjiReturnCode DjiUpgradeStaging_LoadResumeRecord(const char *path, T_DjiUpgradeStagingResumeRecord *record)
+{
+    char resumePath[DJI_FILE_PATH_SIZE_MAX + DJI_UPGRADE_STAGING_PATH_SUFFIX_MAX_LEN];
+    uint8_t checksum[DJI_MD5_BUFFER_LEN];
+    size_t readLen;
+    FILE *fp;
+
+    snprintf(resumePath, sizeof(resumePath), "%s%s", path, DJI_UPGRADE_STAGING_RESUME_SUFFIX);
+    fp = fopen(resumePath, "rb");
+    if (fp == NULL) {
+        return DJI_ERROR_SYSTEM_MODULE_CODE_NOT_FOUND;
+    }
+    readLen = fread(record, 1, sizeof(T_DjiUpgradeStagingResumeRecord), fp);
+    fclose(fp);
+
+    if (readLen != sizeof(T_DjiUpgradeStagingResumeRecord) || record->magic != DJI_UPGRADE_STAGING_RESUME_MAGIC ||
+        record->version != DJI_UPGRADE_STAGING_RESUME_VERSION || record->committedBytes > record->fileSize) {
+        return DJI_ERROR_SYSTEM_MODULE_CODE_INVALID_PARAMETER;
+    }
+
+    DjiUpgradeStaging_GetRecordChecksum(record, checksum);
+    if (memcmp(checksum, record->checksum, sizeof(checksum)) != 0) {
+        USER_LOG_WARN("Upgrade resume point %s is corrupted.", resumePath);
+        return DJI_ERROR_SYSTEM_MODULE_CODE_INVALID_PARAMETER;
+    }
+
+    return DJI_ERROR_SYSTEM_MODULE_CODE_SUCCESS;
+}
+
+static void DjiUpgradeStaging_GetRecordChecksum(const T_DjiUpgradeStagingResumeRecord *record, uint8_t *checksum)
+{
+    MD5_CTX md5Ctx;
+
+    UtilMd5_Init(&md5Ctx);
+    UtilMd5_Update(&md5Ctx, (const uint8_t *) record, offsetof(T_DjiUpgradeStagingResumeRecord, checksum));
+    UtilMd5_Final(&md5Ctx, checksum);
+}
+
+static T_DjiReturnCode DjiUpgradeStaging_WriteAll(int fd, const uint8_t *data, uint32_t len, uint64_t offset)
+{
+    ssize_t writeLen;
+
+    while (len > 0) {
+        writeLen = pwrite(fd, data, len, (off_t) offset);
+        if (writeLen < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            USER_LOG_ERROR("Write error: %s.", strerror(errno));
+            return DJI_ERROR_SYSTEM_MODULE_CODE_SYSTEM_ERROR;
+        }
+        data += writeLen;
+        len -= (uint32_t) writeLen;
+        offset += (uint64_t) writeLen;
+    }
+
+    return DJI_ERROR_SYSTEM_MODULE_CODE_SUCCESS;
+}
+
+static T_DjiReturnCode DjiUpgradeStaging_SyncParentDir(const char *path)
+{
+    char dirPath[DJI_FILE_PATH_SIZE_MAX];
+    int dirFd;
+    int result;
+
+    snprintf(dirPath, sizeof(dirPath), "%s", path);
+    dirFd = open(dirname(dirPath), O_RDONLY | O_DIRECTORY);
+    if (dirFd < 0) {
+        return DJI_ERROR_SYSTEM_MODULE_CODE_SYSTEM_ERROR;
+    }
+    result = fsync(dirFd);
+    close(dirFd);
+
+    return result == 0 ? DJI_ERROR_SYSTEM_MODULE_CODE_SUCCESS : DJI_ERROR_SYSTEM_MODULE_CODE_SYSTEM_ERROR;
+}
+
+/****************** (C) COPYRIGHT DJI Innovations *****END OF FILE****/
@@ -0,0 +1,105 @@
+/**
+ ********************************************************************
+ * @file    upgrade_staging_linux.h
+ * @brief   This is the header file for "upgrade_staging_linux.c", defining the structure and
+ * (exported) function prototypes.
+ *
+ * @copyright (c) 2021 DJI. All rights reserved.
+ *
+ * All information contained herein is, and remains, the property of DJI.
+ * The intellectual and technical concepts contained herein are proprietary
+ * to DJI and may be covered by U.S. and foreign patents, patents in process,
+ * and protected by trade secret or copyright law.  Dissemination of this
+ * information, including but not limited to data and other proprietary
+ * material(s) incorporated within the information, in any form, is strictly
+ * prohibited without the express written consent of DJI.
+ *
+ * If you receive this source code without DJI’s authorization, you may not
+ * further disseminate the information, and you must immediately remove the
+ * source code and notify DJI of its removal. DJI reserves the right to pursue
+ * legal actions against you for any loss(es) or damage(s) caused by your
+ * failure to do so.
+ *
+ *********************************************************************
+ */
+
+/* Define to prevent recursive inclusion -------------------------------------*/
+#ifndef UPGRADE_STAGING_LINUX_H
+#define UPGRADE_STAGING_LINUX_H
+
+/* Includes ------------------------------------------------------------------*/
+#include <dji_typedef.h>
+#include "utils/util_md5.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Exported constants --------------------------------------------------------*/
+#define DJI_UPGRADE_STAGING_BUFFER_ALIGN        (4096)
+#define DJI_UPGRADE_STAGING_RESUME_SUFFIX       ".resume"
+
+/* Exported types ------------------------------------------------------------*/
+typedef struct {
+    uint32_t bufferSize;            /*!< Write buffer, a multiple of DJI_UPGRADE_STAGING_BUFFER_ALIGN. */
+    uint32_t commitIntervalBytes;   /*!< Staged bytes between two resume points, 0 disables resuming. */
+    bool isPreallocate;             /*!< Reserve the whole file at open, a full disk fails before the transfer. */
+} T_DjiUpgradeStagingConfig;
+
+typedef struct {
+    uint64_t fileSize;
+    uint64_t stagedBytes;           /*!< Bytes received in order, resumed ones included. */
+    uint64_t resumedBytes;          /*!< Bytes recovered from the resume point at open. */
+    uint64_t skippedBytes;          /*!< Bytes sent again below the staged length, neither written nor hashed. */
+    uint64_t committedBytes;        /*!< Bytes synced to disk and recorded in the resume point. */
+    uint32_t writeCount;
+    uint32_t flushCount;            /*!< Buffer writes to the file. */
+    uint32_t commitCount;
+    uint32_t elapsedMs;             /*!< Since open. */
+    uint32_t throughputKBps;        /*!< Bytes staged by this open over elapsedMs. */
+} T_DjiUpgradeStagingStatistics;
+
+/**
+ * @brief Stages an upgrade package on disk while it is received.
+ * @note Data must arrive in order. It is written through an aligned buffer and hashed as the buffer is flushed, so
+ * verifying the package at the end needs no second read of the file. Every commitIntervalBytes the file is synced and
+ * the length and hash state are saved to "<path>.resume"; an open of the same path and size continues from there, and
+ * data sent again below that point is skipped.
+ */
+typedef struct {
+    T_DjiUpgradeStagingConfig config;
+    char path[DJI_FILE_PATH_SIZE_MAX];
+    int fd;
+    uint8_t *buffer;
+    uint32_t bufferLen;
+    uint64_t bufferOffset;          /*!< File offset of the first buffered byte. */
+    MD5_CTX md5Ctx;
+    bool isFinished;
+    uint8_t md5[DJI_MD5_BUFFER_LEN];
+    uint32_t openTimeMs;
+    uint32_t progressPercent;       /*!< Last progress logged, in steps of 10. */
+    T_DjiUpgradeStagingStatistics statistics;
+} T_DjiUpgradeStaging;
+
+/* Exported functions --------------------------------------------------------*/
+void DjiUpgradeStagingLinux_GetDefaultConfig(T_DjiUpgradeStagingConfig *config);
+T_DjiReturnCode DjiUpgradeStagingLinux_Open(T_DjiUpgradeStaging *staging, const T_DjiUpgradeStagingConfig *config,
+                                            const char *path, uint64_t fileSize, uint64_t *resumeOffset);
+T_DjiReturnCode DjiUpgradeStagingLinux_Write(T_DjiUpgradeStaging *staging, uint64_t offset, const uint8_t *data,
+                                             uint32_t len);
+T_DjiReturnCode DjiUpgradeStagingLinux_Read(T_DjiUpgradeStaging *staging, uint64_t offset, uint32_t len,
+                                            uint8_t *data, uint32_t *realLen);
+T_DjiReturnCode DjiUpgradeStagingLinux_Finish(T_DjiUpgradeStaging *staging, uint8_t md5[DJI_MD5_BUFFER_LEN]);
+T_DjiReturnCode DjiUpgradeStagingLinux_Close(T_DjiUpgradeStaging *staging);
+void DjiUpgradeStagingLinux_GetStatistics(T_DjiUpgradeStaging *staging, T_DjiUpgradeStagingStatistics *statistics);
+
+bool DjiUpgradeStagingLinux_IsResumable(const char *path);
+T_DjiReturnCode DjiUpgradeStagingLinux_Install(const char *stagedPath, const char *targetPath,
+                                               const uint8_t expectedMd5[DJI_MD5_BUFFER_LEN]);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // UPGRADE_STAGING_LINUX_H
+/************************ (C) COPYRIGHT DJI Innovations *******END OF FILE******/
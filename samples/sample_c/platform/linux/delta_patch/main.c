@@ -0,0 +1,167 @@
+/**
+ ********************************************************************
+ * @file    main.c
+ * @brief   Command line builder of the delta patch packages installed by the Linux upgrade samples.
+ *
+ * @copyright (c) 2021 DJI. All rights reserved.
+ *
+ * All information contained herein is, and remains, the property of DJI.
+ * The intellectual and technical concepts contained herein are proprietary
+ * to DJI and may be covered by U.S. and foreign patents, patents in process,
+ * and protected by trade secret or copyright law.  Dissemination of this
+ * information, including but not limited to data and other proprietary
+ * material(s) incorporated within the information, in any form, is strictly
+ * prohibited without the express written consent of DJI.
+ *
+ * If you receive this source code without DJI’s authorization, you may not
+ * further disseminate the information, and you must immediately remove the
+ * source code and notify DJI of its removal. DJI reserves the right to pursue
+ * legal actions against you for any loss(es) or damage(s) caused by your
+ * failure to do so.
+ *
+ *********************************************************************
+ */
+
+/* Includes ------------------------------------------------------------------*/
+#include <dji_platform.h>
+#include <stdio.h>
+#include <string.h>
+#include <unistd.h>
+#include "osal/osal.h"
+#include "upgrade_platform_opt/upgrade_delta_linux.h"
+
+/* Private constants ---------------------------------------------------------*/
+#define DJI_DELTA_PATCH_CHECK_IMAGE_SUFFIX  ".check"
+
+/* Private types -------------------------------------------------------------*/
+
+/* Private functions declaration ---------------------------------------------*/
+static void DjiDeltaPatch_PrintUsage(const char *program);
+
+/* Private values -------------------------------------------------------------*/
+
+/* Exported functions definition ---------------------------------------------*/
+int main(int argc, char **argv)
+{
+    T_DjiReturnCode returnCode;
+    T_UtilDeltaStatistics statistics = {0};
+    char checkPath[DJI_FILE_PATH_SIZE_MAX + sizeof(DJI_DELTA_PATCH_CHECK_IMAGE_SUFFIX)];
+    uint8_t newMd5[DJI_MD5_BUFFER_LEN];
+    const char *oldPath = NULL;
+    const char *newPath = NULL;
+    const char *patchPath = NULL;
+    bool isCheck = false;
+    bool isVerbose = false;
+    int option;
+    int i;
+    T_DjiOsalHandler osalHandler = {
+        .TaskCreate = Osal_TaskCreate,
+        .TaskDestroy = Osal_TaskDestroy,
+        .TaskSleepMs = Osal_TaskSleepMs,
+        .MutexCreate= Osal_MutexCreate,
+        .MutexDestroy = Osal_MutexDestroy,
+        .MutexLock = Osal_MutexLock,
+        .MutexUnlock = Osal_MutexUnlock,
+        .SemaphoreCreate = Osal_SemaphoreCreate,
+        .SemaphoreDestroy = Osal_SemaphoreDestroy,
+        .SemaphoreWait = Osal_SemaphoreWait,
+        .SemaphoreTimedWait = Osal_SemaphoreTimedWait,
+        .SemaphorePost = Osal_SemaphorePost,
+        .Malloc = Osal_Malloc,
+        .Free = Osal_Free,
+        .GetTimeMs = Osal_GetTimeMs,
+        .GetTimeUs = Osal_GetTimeUs,
+        .GetRandomNum  = Osal_GetRandomNum,
+    };
+
+    while ((option = getopt(argc, argv, "o:n:p:tvh")) != -1) {
+        switch (option) {
+            case 'o':
+                oldPath = optarg;
+                break;
+            case 'n':
+                newPath = optarg;
+                break;
+            case 'p':
+                patchPath = optarg;
+                break;
+            case 't':
+                isCheck = true;
+                break;
+            case 'v':
+                isVerbose = true;
+                break;
+            case 'h':
+            default:
+                DjiDeltaPatch_PrintUsage(argv[0]);
+                return option == 'h' ? 0 : 1;
+        }
+    }
+
+    if (oldPath == NULL || newPath == NULL || patchPath == NULL) {
+        DjiDeltaPatch_PrintUsage(argv[0]);
+        return 1;
+    }
+
+    /* The staged image of the check is written through buffers of the registered osal handler. */
+    returnCode = DjiPlatform_RegOsalHandler(&osalHandler);
+    if (returnCode != DJI_ERROR_SYSTEM_MODULE_CODE_SUCCESS) {
+        fprintf(stderr, "Register osal handler error, stat = 0x%08llX\n", returnCode);
+        return 1;
+    }
+
+    returnCode = DjiUpgradeDeltaLinux_CreatePatchFile(oldPath, newPath, patchPath, &statistics);
+    if (returnCode != DJI_ERROR_SYSTEM_MODULE_CODE_SUCCESS) {
+        fprintf(stderr, "Create patch %s error, stat = 0x%08llX\n", patchPath, returnCode);
+        return 1;
+    }
+
+    if (isVerbose) {
+        fprintf(stderr, "patch %llu bytes, copied %llu, diffed %llu, added %llu bytes, %u instructions in %u frames\n",
+                (unsigned long long) statistics.patchSize, (unsigned long long) statistics.copyBytes,
+                (unsigned long long) statistics.diffBytes, (unsigned long long) statistics.addBytes,
+                statistics.instructionCount, statistics.frameCount);
+    }
+
+    if (!isCheck) {
+        return 0;
+    }
+
+    /* The same apply as on the payload, it fails unless the rebuilt image matches the md5 of the new program. */
+    if (strlen(patchPath) >= DJI_FILE_PATH_SIZE_MAX) {
+        fprintf(stderr, "Patch path %s is too long to check.\n", patchPath);
+        return 1;
+    }
+    snprintf(checkPath, sizeof(checkPath), "%s%s", patchPath, DJI_DELTA_PATCH_CHECK_IMAGE_SUFFIX);
+    returnCode = DjiUpgradeDeltaLinux_ApplyPatchFile(patchPath, oldPath, checkPath, newMd5);
+    if (returnCode != DJI_ERROR_SYSTEM_MODULE_CODE_SUCCESS) {
+        fprintf(stderr, "Check patch %s error, stat = 0x%08llX\n", patchPath, returnCode);
+        return 1;
+    }
+    remove(checkPath);
+
+    if (isVerbose) {
+        fprintf(stderr, "check passed, md5 ");
+        for (i = 0; i < DJI_MD5_BUFFER_LEN; i++) {
+            fprintf(stderr, "%02x", newMd5[i]);
+        }
+        fprintf(stderr, "\n");
+    }
+
+    return 0;
+}
+
+/* Private functions definition-----------------------------------------------*/
+static void DjiDeltaPatch_PrintUsage(const char *program)
+{
+    fprintf(stderr, "Usage: %s -o old_program -n new_program -p patch [-t] [-v]\n"
+                    "  -o  program installed on the payload, the patch only applies to this exact file\n"
+                    "  -n  program the payload is upgraded to\n"
+                    "  -p  patch to write, upload it like a full package, e.g. named \"<name>_V01.02.03.bin\"\n"
+                    "  -t  apply the patch to the old program afterwards and check the rebuilt image\n"
+                    "  -v  print the statistics of the patch\n"
+                    "The payload recognizes a patch by its header, rebuilds the new program from the installed one\n"
+                    "and installs it only if it matches the md5 the patch carries.\n", program);
+}
+
+/****************** (C) COPYRIGHT DJI Innovations *****END OF FILE****/
@@ -0,0 +1,442 @@
+/**
+ ********************************************************************
+ * @file    main.c
+ * @brief   Command line inspection and telemetry bus replay of the flight records written by the Linux samples.
+ *
+ * @copyright (c) 2021 DJI. All rights reserved.
+ *
+ * All information contained herein is, and remains, the property of DJI.
+ * The intellectual and technical concepts contained herein are proprietary
+ * to DJI and may be covered by U.S. and foreign patents, patents in process,
+ * and protected by trade secret or copyright law.  Dissemination of this
+ * information, including but not limited to data and other proprietary
+ * material(s) incorporated within the information, in any form, is strictly
+ * prohibited without the express written consent of DJI.
+ *
+ * If you receive this source code without DJI’s authorization, you may not
+ * further disseminate the information, and you must immediately remove the
+ * source code and notify DJI of its removal. DJI reserves the right to pursue
+ * legal actions against you for any loss(es) or damage(s) caused by your
+ * failure to do so.
+ *
+ *********************************************************************
+ */
+
+/* Includes ------------------------------------------------------------------*/
+#include <dji_platform.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <signal.h>
+#include <time.h>
+#include <unistd.h>
+#include "osal/osal.h"
+#include "utils/util_misc.h"
+#include "flight_recorder/test_flight_recorder.h"
+#include "telemetry_bus/test_telemetry_bus.h"
+
+/* Private constants ---------------------------------------------------------*/
+#define DJI_FLIGHT_RECORD_DEFAULT_BUS_NAME      "psdk_replay"
+#define DJI_FLIGHT_RECORD_BUS_SLOT_COUNT        (8)
+#define DJI_FLIGHT_RECORD_TEXT_MAX_SIZE         (1024)
+/* Layout of the bus topic of a channel recorded without one. */
+#define DJI_FLIGHT_RECORD_RAW_LAYOUT            "data:bytes"
+
+/* Private types -------------------------------------------------------------*/
+typedef struct {
+    T_DjiTestTelemetrySchema schemas[DJI_TEST_FLIGHT_RECORDER_CHANNEL_MAX_NUM];
+    uint64_t maxCount;
+    bool isRaw;
+} T_DjiFlightRecordDump;
+
+typedef struct {
+    T_DjiTestTelemetryBus bus;
+    uint16_t topicIds[DJI_TEST_FLIGHT_RECORDER_CHANNEL_MAX_NUM];
+    uint64_t addedTopicMask;
+    double rate;
+    bool isLoop;
+} T_DjiFlightRecordBusReplay;
+
+/* Private functions declaration ---------------------------------------------*/
+static int DjiFlightRecord_PrintInfo(const T_DjiTestFlightRecordReader *reader);
+static int DjiFlightRecord_Dump(T_DjiTestFlightRecordReader *reader, T_DjiFlightRecordDump *dump);
+static int DjiFlightRecord_ReplayToBus(T_DjiTestFlightRecordReader *reader, const char *busName,
+                                       T_DjiFlightRecordBusReplay *replay, uint64_t startTimeUs);
+static bool DjiFlightRecord_AddChannelMask(const T_DjiTestFlightRecordReader *reader, const char *names,
+                                           uint64_t *channelMask);
+static uint64_t DjiFlightRecord_GetTimeUs(void);
+static void DjiFlightRecord_SleepUntilUs(uint64_t timeUs);
+static void DjiFlightRecord_HandleSignal(int signalNumber);
+static void DjiFlightRecord_PrintUsage(const char *program);
+
+/* Private values -------------------------------------------------------------*/
+static volatile sig_atomic_t s_isFlightRecordStopped = 0;
+
+/* Exported functions definition ---------------------------------------------*/
+int main(int argc, char **argv)
+{
+    T_DjiReturnCode returnCode;
+    T_DjiTestFlightRecordReader reader;
+    T_DjiFlightRecordDump dump = {0};
+    T_DjiFlightRecordBusReplay replay = {0};
+    const char *channelNames = NULL;
+    const char *busName = DJI_FLIGHT_RECORD_DEFAULT_BUS_NAME;
+    uint64_t channelMask = 0;
+    uint64_t startTimeUs = 0;
+    bool isInfo = false;
+    bool isReplay = false;
+    int option;
+    int result;
+    T_DjiOsalHandler osalHandler = {
+        .TaskCreate = Osal_TaskCreate,
+        .TaskDestroy = Osal_TaskDestroy,
+        .TaskSleepMs = Osal_TaskSleepMs,
+        .MutexCreate= Osal_MutexCreate,
+        .MutexDestroy = Osal_MutexDestroy,
+        .MutexLock = Osal_MutexLock,
+        .MutexUnlock = Osal_MutexUnlock,
+        .SemaphoreCreate = Osal_SemaphoreCreate,
+        .SemaphoreDestroy = Osal_SemaphoreDestroy,
+        .SemaphoreWait = Osal_SemaphoreWait,
+        .SemaphoreTimedWait = Osal_SemaphoreTimedWait,
+        .SemaphorePost = Osal_SemaphorePost,
+        .Malloc = Osal_Malloc,
+        .Free = Osal_Free,
+        .GetTimeMs = Osal_GetTimeMs,
+        .GetTimeUs = Osal_GetTimeUs,
+        .GetRandomNum  = Osal_GetRandomNum,
+    };
+
+    replay.rate = 1.0;
+
+    while ((option = getopt(argc, argv, "ic:s:n:xp:r:b:lh")) != -1) {
+        switch (option) {
+            case 'i':
+                isInfo = true;
+                break;
+            case 'c':
+                channelNames = optarg;
+                break;
+            case 's':
+                startTimeUs = (uint64_t) (strtod(optarg, NULL) * 1000000);
+                break;
+            case 'n':
+                dump.maxCount = strtoull(optarg, NULL, 10);
+                break;
+            case 'x':
+                dump.isRaw = true;
+                break;
+            case 'p':
+                isReplay = true;
+                replay.rate = strtod(optarg, NULL);
+                if (replay.rate < 0) {
+                    fprintf(stderr, "Invalid replay rate %s.\n", optarg);
+                    return 1;
+                }
+                break;
+            case 'b':
+                busName = optarg;
+                break;
+            case 'l':
+                replay.isLoop = true;
+                break;
+            case 'h':
+            default:
+                DjiFlightRecord_PrintUsage(argv[0]);
+                return option == 'h' ? 0 : 1;
+        }
+    }
+    if (optind != argc - 1) {
+        DjiFlightRecord_PrintUsage(argv[0]);
+        return 1;
+    }
+
+    /* The reader and the bus allocate through the registered osal handler. */
+    returnCode = DjiPlatform_RegOsalHandler(&osalHandler);
+    if (returnCode != DJI_ERROR_SYSTEM_MODULE_CODE_SUCCESS) {
+        fprintf(stderr, "Register osal handler error, stat = 0x%08llX\n", returnCode);
+        return 1;
+    }
+
+    returnCode = DjiTest_FlightRecordReaderOpen(&reader, argv[optind]);
+    if (returnCode != DJI_ERROR_SYSTEM_MODULE_CODE_SUCCESS) {
+        fprintf(stderr, "Open flight record %s error, stat = 0x%08llX\n", argv[optind], returnCode);
+        return 1;
+    }
+
+    if (channelNames != NULL) {
+        if (!DjiFlightRecord_AddChannelMask(&reader, channelNames, &channelMask)) {
+            DjiTest_FlightRecordReaderClose(&reader);
+            return 1;
+        }
+        DjiTest_FlightRecordReaderSetChannelMask(&reader, channelMask);
+    }
+
+    signal(SIGINT, DjiFlightRecord_HandleSignal);
+    signal(SIGTERM, DjiFlightRecord_HandleSignal);
+    signal(SIGPIPE, SIG_IGN);
+
+    if (isInfo) {
+        result = DjiFlightRecord_PrintInfo(&reader);
+    } else if (isReplay) {
+        result = DjiFlightRecord_ReplayToBus(&reader, busName, &replay, startTimeUs);
+    } else {
+        DjiTest_FlightRecordReaderSeek(&reader, startTimeUs);
+        result = DjiFlightRecord_Dump(&reader, &dump);
+    }
+
+    DjiTest_FlightRecordReaderClose(&reader);
+
+    return result;
+}
+
+/* Private functions definition-----------------------------------------------*/
+static int DjiFlightRecord_PrintInfo(const T_DjiTestFlightRecordReader *reader)
+{
+    const T_DjiTestFlightRecordChannelSummary *channel;
+    time_t seconds = (time_t) (reader->fileHeader.startRealTimeUs / 1000000);
+    struct tm localTime;
+    char timeText[32];
+    uint64_t durationUs = 0;
+    uint32_t i;
+
+    if (reader->chunkCount > 0) {
+        durationUs = reader->chunks[reader->chunkCount - 1].endTimeUs;
+    }
+
+    localtime_r(&seconds, &localTime);
+    strftime(timeText, sizeof(timeText), "%Y-%m-%d %H:%M:%S", &localTime);
+    printf("start %s.%06u, duration %.3f s, chunks %u, records %llu, dropped %u%s\n", timeText,
+           (uint32_t) (reader->fileHeader.startRealTimeUs % 1000000), (double) durationUs / 1000000,
+           reader->chunkCount, (unsigned long long) reader->footer.recordCount, reader->footer.droppedCount,
+           reader->isRecovered ? ", recovered without summary" : "");
+
+    for (i = 0; i < DJI_TEST_FLIGHT_RECORDER_CHANNEL_MAX_NUM; i++) {
+        if ((reader->definedChannelMask & (1ULL << i)) == 0) {
+            continue;
+        }
+        channel = &reader->channels[i];
+        printf("  [%2u] %-24s %-24s records %-8u dropped %-6u bytes %-12llu max %u\n", i,
+               channel->definition.name, channel->definition.schemaName, channel->recordCount,
+               channel->droppedCount, (unsigned long long) channel->byteCount, channel->maxRecordSize);
+    }
+
+    return 0;
+}
+
+static int DjiFlightRecord_Dump(T_DjiTestFlightRecordReader *reader, T_DjiFlightRecordDump *dump)
+{
+    T_DjiTestFlightRecordSample sample;
+    T_DjiTestTelemetrySchema *schema;
+    T_DjiReturnCode returnCode;
+    char text[DJI_FLIGHT_RECORD_TEXT_MAX_SIZE];
+    uint64_t printedCount = 0;
+    uint32_t len;
+    uint32_t i;
+
+    /* The recorded layouts cover the header and the data, formatted like the bus samples they mirror. */
+    for (i = 0; i < DJI_TEST_FLIGHT_RECORDER_CHANNEL_MAX_NUM; i++) {
+        bool isVariable = false;
+
+        schema = &dump->schemas[i];
+        strcpy(schema->layout, reader->channels[i].definition.layout[0] != '\0' ?
+                               reader->channels[i].definition.layout : DJI_FLIGHT_RECORD_RAW_LAYOUT);
+        if (DjiTest_TelemetryGetLayoutSize(schema->layout, &schema->fixedSize, &isVariable) !=
+            DJI_ERROR_SYSTEM_MODULE_CODE_SUCCESS) {
+            strcpy(schema->layout, DJI_FLIGHT_RECORD_RAW_LAYOUT);
+            DjiTest_TelemetryGetLayoutSize(schema->layout, &schema->fixedSize, &isVariable);
+        }
+        schema->isVariable = isVariable;
+    }
+
+    while (!s_isFlightRecordStopped && (dump->maxCount == 0 || printedCount < dump->maxCount)) {
+        returnCode = DjiTest_FlightRecordReaderReadNext(reader, &sample);
+        if (returnCode == DJI_ERROR_SYSTEM_MODULE_CODE_NOT_FOUND) {
+            break;
+        } else if (returnCode != DJI_ERROR_SYSTEM_MODULE_CODE_SUCCESS) {
+            fprintf(stderr, "Read flight record error, stat = 0x%08llX\n", returnCode);
+            return 1;
+        }
+
+        len = (uint32_t) sample.headerLen + sample.dataLen;
+        if (dump->isRaw) {
+            snprintf(text, sizeof(text), "len=%u", len);
+        } else {
+            /* The header and the data of a record are adjacent, the layout describes both. */
+            DjiTest_TelemetryFormatSample(&dump->schemas[sample.channelId],
+                                          sample.headerLen > 0 ? sample.header : sample.data, len, text,
+                                          sizeof(text));
+        }
+
+        if (printf("%llu.%06u %s seq=%u aircraftUs=%llu %s\n", (unsigned long long) (sample.monotonicUs / 1000000),
+                   (uint32_t) (sample.monotonicUs % 1000000), reader->channels[sample.channelId].definition.name,
+                   sample.sequence, (unsigned long long) sample.aircraftUs, text) < 0) {
+            /* The reader of a pipe went away, e.g. head. */
+            break;
+        }
+        printedCount++;
+    }
+
+    return 0;
+}
+
+/**
+ * @brief Publish the records on a bus of their own with the recorded spacing, readers such as telemetry_echo open it
+ * by name. The topics carry the header and the data of the records.
+ */
+static int DjiFlightRecord_ReplayToBus(T_DjiTestFlightRecordReader *reader, const char *busName,
+                                       T_DjiFlightRecordBusReplay *replay, uint64_t startTimeUs)
+{
+    const T_DjiTestFlightRecordChannelDefinition *definition;
+    T_DjiTestTelemetryTopicConfig topicConfig;
+    T_DjiTestFlightRecordSample sample;
+    T_DjiReturnCode returnCode;
+    uint64_t publishedCount = 0;
+    uint64_t baseTimeUs = 0;
+    uint64_t baseRecordUs = 0;
+    bool isFirst = true;
+    uint32_t i;
+    int result = 0;
+
+    returnCode = DjiTest_TelemetryBusCreate(&replay->bus, busName);
+    if (returnCode != DJI_ERROR_SYSTEM_MODULE_CODE_SUCCESS) {
+        fprintf(stderr, "Create telemetry bus %s error, stat = 0x%08llX\n", busName, returnCode);
+        return 1;
+    }
+
+    for (i = 0; i < DJI_TEST_FLIGHT_RECORDER_CHANNEL_MAX_NUM; i++) {
+        if ((reader->definedChannelMask & (1ULL << i)) == 0 ||
+            (reader->channelMask != 0 && (reader->channelMask & (1ULL << i)) == 0)) {
+            continue;
+        }
+        definition = &reader->channels[i].definition;
+
+        memset(&topicConfig, 0, sizeof(topicConfig));
+        returnCode = DjiTest_TelemetryBusRegisterSchema(&replay->bus, definition->schemaName, 1,
+                                                        definition->layout[0] != '\0' ? definition->layout :
+                                                        DJI_FLIGHT_RECORD_RAW_LAYOUT, &topicConfig.schemaId);
+        if (returnCode == DJI_ERROR_SYSTEM_MODULE_CODE_SUCCESS) {
+            strcpy(topicConfig.name, definition->name);
+            topicConfig.slotCount = DJI_FLIGHT_RECORD_BUS_SLOT_COUNT;
+            topicConfig.slotSize = reader->channels[i].maxRecordSize > 0 ? reader->channels[i].maxRecordSize : 1;
+            returnCode = DjiTest_TelemetryBusAddTopic(&replay->bus, &topicConfig, &replay->topicIds[i]);
+        }
+        if (returnCode != DJI_ERROR_SYSTEM_MODULE_CODE_SUCCESS) {
+            fprintf(stderr, "Add topic %s error, stat = 0x%08llX, skipped\n", definition->name, returnCode);
+            continue;
+        }
+        replay->addedTopicMask |= 1ULL << i;
+    }
+
+    DjiTest_FlightRecordReaderSeek(reader, startTimeUs);
+    while (!s_isFlightRecordStopped) {
+        returnCode = DjiTest_FlightRecordReaderReadNext(reader, &sample);
+        if (returnCode == DJI_ERROR_SYSTEM_MODULE_CODE_NOT_FOUND) {
+            if (!replay->isLoop) {
+                break;
+            }
+            DjiTest_FlightRecordReaderSeek(reader, startTimeUs);
+            isFirst = true;
+            continue;
+        } else if (returnCode != DJI_ERROR_SYSTEM_MODULE_CODE_SUCCESS) {
+            fprintf(stderr, "Read flight record error, stat = 0x%08llX\n", returnCode);
+            result = 1;
+            break;
+        }
+
+        if ((replay->addedTopicMask & (1ULL << sample.channelId)) == 0) {
+            continue;
+        }
+
+        if (isFirst) {
+            baseTimeUs = DjiFlightRecord_GetTimeUs();
+            baseRecordUs = sample.monotonicUs;
+            isFirst = false;
+        } else if (replay->rate > 0) {
+            DjiFlightRecord_SleepUntilUs(baseTimeUs +
+                                         (uint64_t) ((double) (sample.monotonicUs - baseRecordUs) / replay->rate));
+        }
+
+        DjiTest_TelemetryBusPublish(&replay->bus, replay->topicIds[sample.channelId],
+                                    sample.headerLen > 0 ? sample.header : sample.data,
+                                    (uint32_t) sample.headerLen + sample.dataLen);
+        publishedCount++;
+    }
+
+    fprintf(stderr, "Published %llu records on bus %s\n", (unsigned long long) publishedCount, busName);
+    DjiTest_TelemetryBusDestroy(&replay->bus);
+
+    return result;
+}
+
+static bool DjiFlightRecord_AddChannelMask(const T_DjiTestFlightRecordReader *reader, const char *names,
+                                           uint64_t *channelMask)
+{
+    char name[DJI_TEST_FLIGHT_RECORDER_NAME_MAX_SIZE];
+    const char *end;
+    uint16_t channelId;
+    size_t len;
+
+    while (*names != '\0') {
+        end = strchr(names, ',');
+        len = end != NULL ? (size_t) (end - names) : strlen(names);
+        if (len == 0 || len >= sizeof(name)) {
+            fprintf(stderr, "Invalid channel name %.*s.\n", (int) len, names);
+            return false;
+        }
+        memcpy(name, names, len);
+        name[len] = '\0';
+
+        if (DjiTest_FlightRecordReaderFindChannel(reader, name, &channelId) != DJI_ERROR_SYSTEM_MODULE_CODE_SUCCESS) {
+            fprintf(stderr, "No channel %s in the record.\n", name);
+            return false;
+        }
+        *channelMask |= 1ULL << channelId;
+
+        names += end != NULL ? len + 1 : len;
+    }
+
+    return true;
+}
+
+static uint64_t DjiFlightRecord_GetTimeUs(void)
+{
+    struct timespec now;
+
+    clock_gettime(CLOCK_MONOTONIC, &now);
+
+    return (uint64_t) now.tv_sec * 1000000 + (uint64_t) now.tv_nsec / 1000;
+}
+
+static void DjiFlightRecord_SleepUntilUs(uint64_t timeUs)
+{
+    struct timespec deadline = {
+        .tv_sec = (time_t) (timeUs / 1000000),
+        .tv_nsec = (long) (timeUs % 1000000) * 1000,
+    };
+
+    /* Interrupted by a signal the loop checks the stop flag, a late record is published at once. */
+    clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &deadline, NULL);
+}
+
+static void DjiFlightRecord_HandleSignal(int signalNumber)
+{
+    USER_UTIL_UNUSED(signalNumber);
+    s_isFlightRecordStopped = 1;
+}
+
+static void DjiFlightRecord_PrintUsage(const char *program)
+{
+    fprintf(stderr, "Usage: %s [-i] [-c channel[,channel]] [-s second] [-n count] [-x] [-p rate [-b bus] [-l]] file\n"
+                    "  -i  print the start, the duration and the channels of the record\n"
+                    "  -c  only the named channels, e.g. fc/quaternion,rtk/base_station\n"
+                    "  -s  start this many seconds after the beginning of the record\n"
+                    "  -n  print at most this many records\n"
+                    "  -x  print the length of the records instead of their fields\n"
+                    "  -p  publish the records on a telemetry bus instead, at this rate, 0 as fast as possible\n"
+                    "  -b  name of the bus to publish on, default \"%s\"\n"
+                    "  -l  replay in a loop until interrupted\n",
+            program, DJI_FLIGHT_RECORD_DEFAULT_BUS_NAME);
+}
+
+/****************** (C) COPYRIGHT DJI Innovations *****END OF FILE****/
@@ -0,0 +1,269 @@
+/**
+ ********************************************************************
+ * @file    main.c
+ * @brief   Command line query of the compressed log segments written by the Linux samples.
+ *
+ * @copyright (c) 2021 DJI. All rights reserved.
+ *
+ * All information contained herein is, and remains, the property of DJI.
+ * The intellectual and technical concepts contained herein are proprietary
+ * to DJI and may be covered by U.S. and foreign patents, patents in process,
+ * and protected by trade secret or copyright law.  Dissemination of this
+ * information, including but not limited to data and other proprietary
+ * material(s) incorporated within the information, in any form, is strictly
+ * prohibited without the express written consent of DJI.
+ *
+ * If you receive this source code without DJI’s authorization, you may not
+ * further disseminate the information, and you must immediately remove the
+ * source code and notify DJI of its removal. DJI reserves the right to pursue
+ * legal actions against you for any loss(es) or damage(s) caused by your
+ * failure to do so.
+ *
+ *********************************************************************
+ */
+
+/* Includes ------------------------------------------------------------------*/
+#include <dji_platform.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <strings.h>
+#include <time.h>
+#include <unistd.h>
+#include "osal/osal.h"
+#include "utils/util_misc.h"
+#include "logger/test_log_storage.h"
+
+/* Private constants ---------------------------------------------------------*/
+#define DJI_LOG_QUERY_DEFAULT_DIRECTORY     "Logs"
+#define DJI_LOG_QUERY_DEFAULT_PREFIX        "DJI"
+
+/* Private types -------------------------------------------------------------*/
+typedef struct {
+    FILE *output;
+    bool isCountOnly;
+} T_DjiLogQueryOutput;
+
+/* Private functions declaration ---------------------------------------------*/
+static T_DjiReturnCode DjiLogQuery_PrintLine(void *userData, uint64_t timeMs, uint8_t level, const char *line,
+                                             uint32_t len);
+static bool DjiLogQuery_ParseTime(const char *text, uint64_t *timeMs);
+static bool DjiLogQuery_ParseLevel(const char *text, uint8_t *level);
+static void DjiLogQuery_PrintUsage(const char *program);
+
+/* Private values -------------------------------------------------------------*/
+static const char *s_logQueryLevelNames[DJI_TEST_LOG_STORAGE_LEVEL_NUM] = {"error", "warn", "info", "debug"};
+
+/* Exported functions definition ---------------------------------------------*/
+int main(int argc, char **argv)
+{
+    T_DjiReturnCode returnCode;
+    T_DjiTestLogQuery query = {0};
+    T_DjiTestLogQueryStatistics statistics;
+    T_DjiLogQueryOutput output = {stdout, false};
+    const char *directory = DJI_LOG_QUERY_DEFAULT_DIRECTORY;
+    const char *prefix = DJI_LOG_QUERY_DEFAULT_PREFIX;
+    bool isVerbose = false;
+    int option;
+    T_DjiOsalHandler osalHandler = {
+        .TaskCreate = Osal_TaskCreate,
+        .TaskDestroy = Osal_TaskDestroy,
+        .TaskSleepMs = Osal_TaskSleepMs,
+        .MutexCreate= Osal_MutexCreate,
+        .MutexDestroy = Osal_MutexDestroy,
+        .MutexLock = Osal_MutexLock,
+        .MutexUnlock = Osal_MutexUnlock,
+        .SemaphoreCreate = Osal_SemaphoreCreate,
+        .SemaphoreDestroy = Osal_SemaphoreDestroy,
+        .SemaphoreWait = Osal_SemaphoreWait,
+        .SemaphoreTimedWait = Osal_SemaphoreTimedWait,
+        .SemaphorePost = Osal_SemaphorePost,
+        .Malloc = Osal_Malloc,
+        .Free = Osal_Free,
+        .GetTimeMs = Osal_GetTimeMs,
+        .GetTimeUs = Osal_GetTimeUs,
+        .GetRandomNum  = Osal_GetRandomNum,
+    };
+
+    query.maxLevel = DJI_LOGGER_CONSOLE_LOG_LEVEL_DEBUG;
+
+    while ((option = getopt(argc, argv, "d:p:s:e:l:k:cvh")) != -1) {
+        switch (option) {
+            case 'd':
+                directory = optarg;
+                break;
+            case 'p':
+                prefix = optarg;
+                break;
+            case 's':
+                if (!DjiLogQuery_ParseTime(optarg, &query.startTimeMs)) {
+                    fprintf(stderr, "Invalid start time %s.\n", optarg);
+                    return 1;
+                }
+                break;
+            case 'e':
+                if (!DjiLogQuery_ParseTime(optarg, &query.endTimeMs)) {
+                    fprintf(stderr, "Invalid end time %s.\n", optarg);
+                    return 1;
+                }
+                break;
+            case 'l':
+                if (!DjiLogQuery_ParseLevel(optarg, &query.maxLevel)) {
+                    fprintf(stderr, "Invalid level %s.\n", optarg);
+                    return 1;
+                }
+                break;
+            case 'k':
+                query.keyword = optarg;
+                break;
+            case 'c':
+                output.isCountOnly = true;
+                break;
+            case 'v':
+                isVerbose = true;
+                break;
+            case 'h':
+            default:
+                DjiLogQuery_PrintUsage(argv[0]);
+                return option == 'h' ? 0 : 1;
+        }
+    }
+
+    /* The storage allocates its buffers through the registered osal handler. */
+    returnCode = DjiPlatform_RegOsalHandler(&osalHandler);
+    if (returnCode != DJI_ERROR_SYSTEM_MODULE_CODE_SUCCESS) {
+        fprintf(stderr, "Register osal handler error, stat = 0x%08llX\n", returnCode);
+        return 1;
+    }
+
+    returnCode = DjiTest_LogStorageQuery(directory, prefix, &query, DjiLogQuery_PrintLine, &output, &statistics);
+    if (returnCode != DJI_ERROR_SYSTEM_MODULE_CODE_SUCCESS) {
+        fprintf(stderr, "Query logs in %s error, stat = 0x%08llX\n", directory, returnCode);
+        return 1;
+    }
+
+    if (output.isCountOnly) {
+        printf("%llu\n", (unsigned long long) statistics.matchedLineCount);
+    }
+    if (isVerbose) {
+        fprintf(stderr, "segments %u, blocks %u, decoded blocks %u (%llu bytes), recovered blocks %u, "
+                        "corrupt blocks %u, matched lines %llu\n",
+                statistics.segmentCount, statistics.blockCount, statistics.decodedBlockCount,
+                (unsigned long long) statistics.decodedBytes, statistics.recoveredBlockCount,
+                statistics.corruptBlockCount, (unsigned long long) statistics.matchedLineCount);
+    }
+
+    return 0;
+}
+
+/* Private functions definition-----------------------------------------------*/
+static T_DjiReturnCode DjiLogQuery_PrintLine(void *userData, uint64_t timeMs, uint8_t level, const char *line,
+                                             uint32_t len)
+{
+    T_DjiLogQueryOutput *output = userData;
+    time_t seconds = (time_t) (timeMs / 1000);
+    struct tm localTime;
+    char timeText[32];
+
+    USER_UTIL_UNUSED(level);
+
+    if (output->isCountOnly) {
+        return DJI_ERROR_SYSTEM_MODULE_CODE_SUCCESS;
+    }
+
+    localtime_r(&seconds, &localTime);
+    strftime(timeText, sizeof(timeText), "%Y-%m-%d %H:%M:%S", &localTime);
+    if (fprintf(output->output, "%s.%03u %.*s\n", timeText, (uint32_t) (timeMs % 1000), (int) len, line) < 0) {
+        /* The reader of a pipe went away, e.g. head. */
+        return DJI_ERROR_SYSTEM_MODULE_CODE_SYSTEM_ERROR;
+    }
+
+    return DJI_ERROR_SYSTEM_MODULE_CODE_SUCCESS;
+}
+
+/**
+ * @brief Accept "YYYY-mm-dd HH:MM:SS" in local time, seconds since the epoch or "-<n>[smhd]" before now.
+ */
+static bool DjiLogQuery_ParseTime(const char *text, uint64_t *timeMs)
+{
+    struct tm localTime;
+    const char *end;
+    char *unit;
+    unsigned long long value;
+    uint64_t scale;
+
+    if (text[0] == '-') {
+        value = strtoull(text + 1, &unit, 10);
+        if (unit == text + 1) {
+            return false;
+        }
+        switch (*unit) {
+            case 's':
+            case '\0':
+                scale = 1;
+                break;
+            case 'm':
+                scale = 60;
+                break;
+            case 'h':
+                scale = 3600;
+                break;
+            case 'd':
+                scale = 24 * 3600;
+                break;
+            default:
+                return false;
+        }
+        *timeMs = ((uint64_t) time(NULL) - value * scale) * 1000;
+        return true;
+    }
+
+    memset(&localTime, 0, sizeof(localTime));
+    end = strptime(text, "%Y-%m-%d %H:%M:%S", &localTime);
+    if (end == NULL) {
+        end = strptime(text, "%Y-%m-%dT%H:%M:%S", &localTime);
+    }
+    if (end != NULL && *end == '\0') {
+        localTime.tm_isdst = -1;
+        *timeMs = (uint64_t) mktime(&localTime) * 1000;
+        return true;
+    }
+
+    value = strtoull(text, &unit, 10);
+    if (unit == text || *unit != '\0') {
+        return false;
+    }
+    *timeMs = (uint64_t) value * 1000;
+
+    return true;
+}
+
+static bool DjiLogQuery_ParseLevel(const char *text, uint8_t *level)
+{
+    uint8_t i;
+
+    for (i = 0; i < DJI_TEST_LOG_STORAGE_LEVEL_NUM; i++) {
+        if (strcasecmp(text, s_logQueryLevelNames[i]) == 0 || (text[0] == '0' + i && text[1] == '\0')) {
+            *level = i;
+            return true;
+        }
+    }
+
+    return false;
+}
+
+static void DjiLogQuery_PrintUsage(const char *program)
+{
+    fprintf(stderr, "Usage: %s [-d directory] [-p prefix] [-s start] [-e end] [-l level] [-k keyword] [-c] [-v]\n"
+                    "  -d  directory of the log segments, default \"%s\"\n"
+                    "  -p  segment name prefix, default \"%s\"\n"
+                    "  -s  first time, \"YYYY-mm-dd HH:MM:SS\", epoch seconds or \"-<n>[smhd]\" before now\n"
+                    "  -e  end time, exclusive, same formats as -s\n"
+                    "  -l  most verbose level printed, error, warn, info or debug, default debug\n"
+                    "  -k  only lines containing the keyword\n"
+                    "  -c  print the number of matching lines instead of the lines\n"
+                    "  -v  print the blocks read and skipped to stderr\n",
+            program, DJI_LOG_QUERY_DEFAULT_DIRECTORY, DJI_LOG_QUERY_DEFAULT_PREFIX);
+}
+
+/****************** (C) COPYRIGHT DJI Innovations *****END OF FILE****/
@@ -66,10 +66,20 @@ extern "C" {
 
 #define CONFIG_MODULE_SAMPLE_HMS_CUSTOMIZATION_ON
 
+/*!< Attention: This function needs the PPS output of the aircraft wired to a pps device or a gpio line of the board,
+ * select the source in main.c .
+* */
+//#define CONFIG_MODULE_SAMPLE_TIME_SYNC_ON
+
 /*!< Attention: This function needs to be used together with mobile sdk mop sample.
 * */
 //#define CONFIG_MODULE_SAMPLE_MOP_CHANNEL_ON
 
+/*!< Attention: This function records the data of the started samples into the "Flights" folder, start the program
+ * with "-p <record file> [-r <rate>]" to replay a record into the callbacks of the samples instead.
+* */
+//#define CONFIG_MODULE_SAMPLE_FLIGHT_RECORDER_ON
+
 /* Exported types ------------------------------------------------------------*/
 
 /* Exported functions --------------------------------------------------------*/
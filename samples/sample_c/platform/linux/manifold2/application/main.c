@@ -40,6 +40,8 @@
 #include <payload_collaboration/test_payload_collaboration.h>
 #include <xport/test_payload_xport.h>
 #include <hms/test_hms.h>
+#include <time_sync/test_time_sync.h>
+#include <time_sync/test_pps_capture.h>
 #include "monitor/sys_monitor.h"
 #include "osal/osal.h"
 #include "osal/osal_fs.h"
@@ -53,17 +55,16 @@
 #include "widget/test_widget_speaker.h"
 #include "widget_interaction_test/test_widget_interaction.h"
 #include "data_transmission/test_data_transmission.h"
+#include "logger/test_log_storage.h"
+#include "flight_recorder/test_flight_recorder.h"
 #include "dji_sdk_config.h"
 
 /* Private constants ---------------------------------------------------------*/
-#define DJI_LOG_PATH                    "Logs/DJI"
-#define DJI_LOG_INDEX_FILE_NAME         "Logs/index"
 #define DJI_LOG_FOLDER_NAME             "Logs"
-#define DJI_LOG_PATH_MAX_SIZE           (128)
-#define DJI_LOG_FOLDER_NAME_MAX_SIZE    (32)
-#define DJI_LOG_MAX_COUNT               (10)
-#define DJI_SYSTEM_CMD_STR_MAX_SIZE     (64)
+#define DJI_LOG_FILE_PREFIX             "DJI"
 #define DJI_SYSTEM_RESULT_STR_MAX_SIZE  (128)
+#define DJI_FLIGHT_RECORD_FOLDER_NAME   "Flights"
+#define DJI_FLIGHT_RECORD_FILE_PREFIX   "flight"
 
 #define DJI_USE_WIDGET_INTERACTION       0
 
@@ -75,9 +76,12 @@ typedef struct {
 } T_ThreadAttribute;
 
 /* Private values -------------------------------------------------------------*/
-static FILE *s_djiLogFile;
-static FILE *s_djiLogFileCnt;
+static T_DjiTestLogStorage s_djiLogStorage;
 static pthread_t s_monitorThread = 0;
+#ifdef CONFIG_MODULE_SAMPLE_FLIGHT_RECORDER_ON
+static const char *s_flightReplayPath = NULL;
+static double s_flightReplayRate = 1.0;
+#endif
 
 /* Private functions declaration ---------------------------------------------*/
 static T_DjiReturnCode DjiUser_PrepareSystemEnvironment(void);
@@ -90,6 +94,9 @@ static void *DjiUser_MonitorTask(void *argument);
 static T_DjiReturnCode DjiTest_HighPowerApplyPinInit();
 static T_DjiReturnCode DjiTest_WriteHighPowerApplyPin(E_DjiPowerManagementPinState pinState);
 static void DjiUser_NormalExitHandler(int signalNum);
+#ifdef CONFIG_MODULE_SAMPLE_FLIGHT_RECORDER_ON
+static void DjiUser_ParseFlightRecorderArgs(int argc, char **argv);
+#endif
 
 /* Exported functions definition ---------------------------------------------*/
 int main(int argc, char **argv)
@@ -105,8 +112,12 @@ int main(int argc, char **argv)
         .debugVersion = 0,
     };
 
+#ifdef CONFIG_MODULE_SAMPLE_FLIGHT_RECORDER_ON
+    DjiUser_ParseFlightRecorderArgs(argc, argv);
+#else
     USER_UTIL_UNUSED(argc);
     USER_UTIL_UNUSED(argv);
+#endif
 
     // attention: when the program is hand up ctrl-c will generate the coredump file
     signal(SIGTERM, DjiUser_NormalExitHandler);
@@ -213,6 +224,7 @@ int main(int argc, char **argv)
             .writeUpgradeProgramFile = DjiUpgradePlatformLinux_WriteUpgradeProgramFile,
             .readUpgradeProgramFile = DjiUpgradePlatformLinux_ReadUpgradeProgramFile,
             .closeUpgradeProgramFile = DjiUpgradePlatformLinux_CloseUpgradeProgramFile,
+            .getUpgradeProgramFileMd5 = DjiUpgradePlatformLinux_GetUpgradeProgramFileMd5,
             .replaceOldProgram = DjiUpgradePlatformLinux_ReplaceOldProgram,
             .setUpgradeRebootState = DjiUpgradePlatformLinux_SetUpgradeRebootState,
             .getUpgradeRebootState = DjiUpgradePlatformLinux_GetUpgradeRebootState,
@@ -320,6 +332,7 @@ int main(int argc, char **argv)
             .writeUpgradeProgramFile = DjiUpgradePlatformLinux_WriteUpgradeProgramFile,
             .readUpgradeProgramFile = DjiUpgradePlatformLinux_ReadUpgradeProgramFile,
             .closeUpgradeProgramFile = DjiUpgradePlatformLinux_CloseUpgradeProgramFile,
+            .getUpgradeProgramFileMd5 = DjiUpgradePlatformLinux_GetUpgradeProgramFileMd5,
             .replaceOldProgram = DjiUpgradePlatformLinux_ReplaceOldProgram,
             .setUpgradeRebootState = DjiUpgradePlatformLinux_SetUpgradeRebootState,
             .getUpgradeRebootState = DjiUpgradePlatformLinux_GetUpgradeRebootState,
@@ -337,6 +350,24 @@ int main(int argc, char **argv)
 #endif
     }
 
+#ifdef CONFIG_MODULE_SAMPLE_TIME_SYNC_ON
+    T_DjiTestPpsCaptureConfig ppsCaptureConfig;
+    T_DjiTestTimeSyncHandler timeSyncHandler = {
+        .PpsSignalResponseInit = DjiTest_PpsCaptureSignalResponseInit,
+        .GetNewestPpsTriggerLocalTimeUs = DjiTest_PpsCaptureGetNewestPpsTriggerLocalTimeUs,
+    };
+
+    /*!< Use DJI_TEST_PPS_CAPTURE_SOURCE_GPIO with the line number if the board has no pps device. */
+    DjiTest_PpsCaptureGetDefaultConfig(&ppsCaptureConfig);
+    ppsCaptureConfig.source = DJI_TEST_PPS_CAPTURE_SOURCE_KERNEL_PPS;
+    if (DjiTest_PpsCaptureSetConfig(&ppsCaptureConfig) != DJI_ERROR_SYSTEM_MODULE_CODE_SUCCESS ||
+        DjiTest_TimeSyncRegHandler(&timeSyncHandler) != DJI_ERROR_SYSTEM_MODULE_CODE_SUCCESS) {
+        USER_LOG_ERROR("regsiter time sync handler error");
+    } else if (DjiTest_TimeSyncStartService() != DJI_ERROR_SYSTEM_MODULE_CODE_SUCCESS) {
+        USER_LOG_ERROR("psdk time sync init error");
+    }
+#endif
+
 #ifdef CONFIG_MODULE_SAMPLE_HMS_CUSTOMIZATION_ON
     returnCode = DjiTest_HmsCustomizationStartService();
     if (returnCode != DJI_ERROR_SYSTEM_MODULE_CODE_SUCCESS) {
@@ -344,6 +375,26 @@ int main(int argc, char **argv)
     }
 #endif
 
+#ifdef CONFIG_MODULE_SAMPLE_FLIGHT_RECORDER_ON
+    /*!< The samples above have added their channels, a replay feeds the record into their callbacks. */
+    if (s_flightReplayPath != NULL) {
+        returnCode = DjiTest_FlightRecorderReplayStart(s_flightReplayPath, s_flightReplayRate, false);
+        if (returnCode != DJI_ERROR_SYSTEM_MODULE_CODE_SUCCESS) {
+            USER_LOG_ERROR("flight record replay start error");
+        }
+    } else {
+        T_DjiTestFlightRecorderConfig flightRecorderConfig;
+
+        DjiTest_FlightRecorderGetDefaultConfig(&flightRecorderConfig);
+        flightRecorderConfig.directory = DJI_FLIGHT_RECORD_FOLDER_NAME;
+        flightRecorderConfig.prefix = DJI_FLIGHT_RECORD_FILE_PREFIX;
+        returnCode = DjiTest_FlightRecorderStart(&flightRecorderConfig);
+        if (returnCode != DJI_ERROR_SYSTEM_MODULE_CODE_SUCCESS) {
+            USER_LOG_ERROR("flight recorder start error");
+        }
+    }
+#endif
+
     /*!< Step 5: Tell the DJI Pilot you are ready. */
     returnCode = DjiCore_ApplicationStart();
     if (returnCode != DJI_ERROR_SYSTEM_MODULE_CODE_SUCCESS) {
@@ -462,7 +513,7 @@ static T_DjiReturnCode DjiUser_PrepareSystemEnvironment(void)
         return DJI_ERROR_SYSTEM_MODULE_CODE_SYSTEM_ERROR;
     }
 
-    if (DjiUser_LocalWriteFsInit(DJI_LOG_PATH) != DJI_ERROR_SYSTEM_MODULE_CODE_SUCCESS) {
+    if (DjiUser_LocalWriteFsInit(DJI_LOG_FOLDER_NAME) != DJI_ERROR_SYSTEM_MODULE_CODE_SUCCESS) {
         printf("file system init error");
         return DJI_ERROR_SYSTEM_MODULE_CODE_UNKNOWN;
     }
@@ -603,105 +654,33 @@ static T_DjiReturnCode DjiUser_PrintConsole(const uint8_t *data, uint16_t dataLe
 
 static T_DjiReturnCode DjiUser_LocalWrite(const uint8_t *data, uint16_t dataLen)
 {
-    uint32_t realLen;
-
-    if (s_djiLogFile == NULL) {
-        return DJI_ERROR_SYSTEM_MODULE_CODE_UNKNOWN;
-    }
-
-    realLen = fwrite(data, 1, dataLen, s_djiLogFile);
-    fflush(s_djiLogFile);
-    if (realLen == dataLen) {
-        return DJI_ERROR_SYSTEM_MODULE_CODE_SUCCESS;
-    } else {
-        return DJI_ERROR_SYSTEM_MODULE_CODE_UNKNOWN;
-    }
+    return DjiTest_LogStorageWrite(&s_djiLogStorage, data, dataLen);
 }
 
 static T_DjiReturnCode DjiUser_LocalWriteFsInit(const char *path)
 {
-    T_DjiReturnCode djiReturnCode = DJI_ERROR_SYSTEM_MODULE_CODE_SUCCESS;
-    char filePath[DJI_LOG_PATH_MAX_SIZE];
-    char systemCmd[DJI_SYSTEM_CMD_STR_MAX_SIZE];
-    char folderName[DJI_LOG_FOLDER_NAME_MAX_SIZE];
-    time_t currentTime = time(NULL);
-    struct tm *localTime = localtime(&currentTime);
-    uint16_t logFileIndex = 0;
-    uint16_t currentLogFileIndex;
-    uint8_t ret;
-
-    if (localTime == NULL) {
-        printf("Get local time error.\r\n");
-        return DJI_ERROR_SYSTEM_MODULE_CODE_SYSTEM_ERROR;
-    }
-
-    if (access(DJI_LOG_FOLDER_NAME, F_OK) != 0) {
-        sprintf(folderName, "mkdir %s", DJI_LOG_FOLDER_NAME);
-        ret = system(folderName);
-        if (ret != 0) {
-            return DJI_ERROR_SYSTEM_MODULE_CODE_SYSTEM_ERROR;
-        }
-    }
-
-    s_djiLogFileCnt = fopen(DJI_LOG_INDEX_FILE_NAME, "rb+");
-    if (s_djiLogFileCnt == NULL) {
-        s_djiLogFileCnt = fopen(DJI_LOG_INDEX_FILE_NAME, "wb+");
-        if (s_djiLogFileCnt == NULL) {
-            return DJI_ERROR_SYSTEM_MODULE_CODE_SYSTEM_ERROR;
-        }
-    } else {
-        ret = fseek(s_djiLogFileCnt, 0, SEEK_SET);
-        if (ret != 0) {
-            printf("Seek log count file error, ret: %d, errno: %d.\r\n", ret, errno);
-            return DJI_ERROR_SYSTEM_MODULE_CODE_SYSTEM_ERROR;
-        }
-
-        ret = fread((uint16_t *) &logFileIndex, 1, sizeof(uint16_t), s_djiLogFileCnt);
-        if (ret != sizeof(uint16_t)) {
-            printf("Read log file index error.\r\n");
-        }
-    }
-
-    currentLogFileIndex = logFileIndex;
-    logFileIndex++;
-
-    ret = fseek(s_djiLogFileCnt, 0, SEEK_SET);
-    if (ret != 0) {
-        printf("Seek log file error, ret: %d, errno: %d.\r\n", ret, errno);
-        return DJI_ERROR_SYSTEM_MODULE_CODE_SYSTEM_ERROR;
-    }
-
-    ret = fwrite((uint16_t *) &logFileIndex, 1, sizeof(uint16_t), s_djiLogFileCnt);
-    if (ret != sizeof(uint16_t)) {
-        printf("Write log file index error.\r\n");
-        fclose(s_djiLogFileCnt);
-        return DJI_ERROR_SYSTEM_MODULE_CODE_SYSTEM_ERROR;
-    }
-
-    fclose(s_djiLogFileCnt);
+    T_DjiTestLogStorageConfig logStorageConfig;
+    T_DjiReturnCode returnCode;
 
-    sprintf(filePath, "%s_%04d_%04d%02d%02d_%02d-%02d-%02d.log", path, currentLogFileIndex,
-            localTime->tm_year + 1900, localTime->tm_mon + 1, localTime->tm_mday,
-            localTime->tm_hour, localTime->tm_min, localTime->tm_sec);
+    /* Lines are stored in compressed, indexed segments, read them back with the dji_log_query tool. */
+    DjiTest_LogStorageGetDefaultConfig(&logStorageConfig);
+    logStorageConfig.directory = path;
+    logStorageConfig.prefix = DJI_LOG_FILE_PREFIX;
 
-    s_djiLogFile = fopen(filePath, "wb+");
-    if (s_djiLogFile == NULL) {
-        USER_LOG_ERROR("Open filepath time error.");
-        return DJI_ERROR_SYSTEM_MODULE_CODE_SYSTEM_ERROR;
+    returnCode = DjiTest_LogStorageOpen(&s_djiLogStorage, &logStorageConfig);
+    if (returnCode != DJI_ERROR_SYSTEM_MODULE_CODE_SUCCESS) {
+        printf("Open log storage in %s error, stat = 0x%08llX.\r\n", path, returnCode);
+        return returnCode;
     }
 
-    if (logFileIndex >= DJI_LOG_MAX_COUNT) {
-        sprintf(systemCmd, "rm -rf %s_%04d*.log", path, currentLogFileIndex - DJI_LOG_MAX_COUNT);
-        ret = system(systemCmd);
-        if (ret != 0) {
-            printf("Remove file error, ret:%d.\r\n", ret);
-            return DJI_ERROR_SYSTEM_MODULE_CODE_SYSTEM_ERROR;
-        }
+    /* Buffered lines also reach the file when the process exits or crashes. */
+    returnCode = DjiTest_LogStorageFlushOnExit(&s_djiLogStorage);
+    if (returnCode != DJI_ERROR_SYSTEM_MODULE_CODE_SUCCESS) {
+        printf("Register log storage exit flush error, stat = 0x%08llX.\r\n", returnCode);
+        return returnCode;
     }
 
-    sprintf(systemCmd, "ln -sfrv %s " DJI_LOG_FOLDER_NAME "/latest.log", filePath);
-    system(systemCmd);
-    return djiReturnCode;
+    return DJI_ERROR_SYSTEM_MODULE_CODE_SUCCESS;
 }
 
 #pragma GCC diagnostic push
@@ -774,6 +753,11 @@ static void DjiUser_NormalExitHandler(int signalNum)
 
     USER_UTIL_UNUSED(signalNum);
 
+#ifdef CONFIG_MODULE_SAMPLE_FLIGHT_RECORDER_ON
+    DjiTest_FlightRecorderReplayStop();
+    DjiTest_FlightRecorderStop();
+#endif
+
     returnCode = DjiUser_CleanSystemEnvironment();
     if (returnCode != DJI_ERROR_SYSTEM_MODULE_CODE_SUCCESS) {
         perror("Clean up system environment failed.");
@@ -782,6 +766,30 @@ static void DjiUser_NormalExitHandler(int signalNum)
     exit(0);
 }
 
+#ifdef CONFIG_MODULE_SAMPLE_FLIGHT_RECORDER_ON
+static void DjiUser_ParseFlightRecorderArgs(int argc, char **argv)
+{
+    int option;
+
+    while ((option = getopt(argc, argv, "p:r:")) != -1) {
+        switch (option) {
+            case 'p':
+                s_flightReplayPath = optarg;
+                break;
+            case 'r':
+                s_flightReplayRate = strtod(optarg, NULL);
+                if (s_flightReplayRate < 0) {
+                    s_flightReplayRate = 1.0;
+                }
+                break;
+            default:
+                printf("Usage: %s [-p <flight record file> [-r <replay rate, 0 as fast as possible>]]\r\n", argv[0]);
+                break;
+        }
+    }
+}
+#endif
+
 #pragma GCC diagnostic pop
 
 /****************** (C) COPYRIGHT DJI Innovations *****END OF FILE****/
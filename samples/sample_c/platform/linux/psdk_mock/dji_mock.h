@@ -0,0 +1,154 @@
+/**
+ ********************************************************************
+ * @file    dji_mock.h
+ * @brief   This is the header file for the host-side mock of the Payload SDK runtime, defining the structure and
+ * (exported) function prototypes.
+ *
+ * @copyright (c) 2021 DJI. All rights reserved.
+ *
+ * All information contained herein is, and remains, the property of DJI.
+ * The intellectual and technical concepts contained herein are proprietary
+ * to DJI and may be covered by U.S. and foreign patents, patents in process,
+ * and protected by trade secret or copyright law.  Dissemination of this
+ * information, including but not limited to data and other proprietary
+ * material(s) incorporated within the information, in any form, is strictly
+ * prohibited without the express written consent of DJI.
+ *
+ * If you receive this source code without DJI’s authorization, you may not
+ * further disseminate the information, and you must immediately remove the
+ * source code and notify DJI of its removal. DJI reserves the right to pursue
+ * legal actions against you for any loss(es) or damage(s) caused by your
+ * failure to do so.
+ *
+ *********************************************************************
+ */
+
+/* Define to prevent recursive inclusion -------------------------------------*/
+#ifndef DJI_MOCK_H
+#define DJI_MOCK_H
+
+/* Includes ------------------------------------------------------------------*/
+#include "dji_typedef.h"
+#include "dji_aircraft_info.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*
+ * The mock library "dji_psdk_mock" implements the public Payload SDK entry points on a host PC, so the Linux sample
+ * applications can be built with -DUSE_PSDK_MOCK=ON and run end to end without an aircraft. Flight controller
+ * subscription, liveview, perception, camera manager, mop channel and payload camera are driven by synthetic or
+ * recorded data at configurable rates, every other module returns DJI_ERROR_SYSTEM_MODULE_CODE_NONSUPPORT.
+ *
+ * Every configuration item can be overridden by an environment variable, see the DJI_MOCK_ENV_* names below. The
+ * statistics of all streams are printed every reportIntervalMs and can be read by DjiMock_GetStreamStatistics().
+ *
+ * The flight controller replay file is a sequence of records, each one is a T_DjiMockFcReplayRecordHeader followed by
+ * dataSize bytes of topic data in the layout of the topic data structure, timestamps increasing. The replay loops
+ * when the end of the file is reached.
+ */
+
+/* Exported constants --------------------------------------------------------*/
+#define DJI_MOCK_STREAM_NAME_MAX_SIZE               (32)
+#define DJI_MOCK_STREAM_MAX_NUM                     (32)
+
+#define DJI_MOCK_ENV_AIRCRAFT_TYPE                  "DJI_MOCK_AIRCRAFT_TYPE"
+#define DJI_MOCK_ENV_MOUNT_POSITION                 "DJI_MOCK_MOUNT_POSITION"
+#define DJI_MOCK_ENV_FC_REPLAY_FILE                 "DJI_MOCK_FC_REPLAY_FILE"
+#define DJI_MOCK_ENV_LIVEVIEW_FILE                  "DJI_MOCK_LIVEVIEW_FILE"
+#define DJI_MOCK_ENV_LIVEVIEW_FPS                   "DJI_MOCK_LIVEVIEW_FPS"
+#define DJI_MOCK_ENV_LIVEVIEW_BITRATE_KBPS          "DJI_MOCK_LIVEVIEW_BITRATE_KBPS"
+#define DJI_MOCK_ENV_LIVEVIEW_IMAGE_WIDTH           "DJI_MOCK_LIVEVIEW_IMAGE_WIDTH"
+#define DJI_MOCK_ENV_LIVEVIEW_IMAGE_HEIGHT          "DJI_MOCK_LIVEVIEW_IMAGE_HEIGHT"
+#define DJI_MOCK_ENV_PERCEPTION_FPS                 "DJI_MOCK_PERCEPTION_FPS"
+#define DJI_MOCK_ENV_PERCEPTION_IMAGE_WIDTH         "DJI_MOCK_PERCEPTION_IMAGE_WIDTH"
+#define DJI_MOCK_ENV_PERCEPTION_IMAGE_HEIGHT        "DJI_MOCK_PERCEPTION_IMAGE_HEIGHT"
+#define DJI_MOCK_ENV_VIDEO_BANDWIDTH_KBPS           "DJI_MOCK_VIDEO_BANDWIDTH_KBPS"
+#define DJI_MOCK_ENV_MOP_BANDWIDTH_KBPS             "DJI_MOCK_MOP_BANDWIDTH_KBPS"
+#define DJI_MOCK_ENV_MOP_PEER_MODE                  "DJI_MOCK_MOP_PEER_MODE"
+#define DJI_MOCK_ENV_MEDIA_FILE_COUNT               "DJI_MOCK_MEDIA_FILE_COUNT"
+#define DJI_MOCK_ENV_MEDIA_FILE_SIZE                "DJI_MOCK_MEDIA_FILE_SIZE"
+#define DJI_MOCK_ENV_MEDIA_DOWNLOAD_BANDWIDTH_KBPS  "DJI_MOCK_MEDIA_DOWNLOAD_BANDWIDTH_KBPS"
+#define DJI_MOCK_ENV_CAMERA_STATE_POLL_FREQ         "DJI_MOCK_CAMERA_STATE_POLL_FREQ"
+#define DJI_MOCK_ENV_REPORT_INTERVAL_MS             "DJI_MOCK_REPORT_INTERVAL_MS"
+
+/* Exported types ------------------------------------------------------------*/
+typedef enum {
+    DJI_MOCK_MOP_PEER_MODE_ECHO = 0, /*!< The peer sends back every byte it receives. */
+    DJI_MOCK_MOP_PEER_MODE_SINK = 1, /*!< The peer only consumes data, receiving blocks until the channel closes. */
+    DJI_MOCK_MOP_PEER_MODE_SOURCE = 2, /*!< The peer streams pattern data at the channel bandwidth. */
+} E_DjiMockMopPeerMode;
+
+typedef struct {
+    E_DjiAircraftType aircraftType;
+    E_DjiMountPosition mountPosition;
+    const char *fcReplayFile; /*!< NULL uses the synthetic flight, a circle around the home point. */
+    const char *liveviewFile; /*!< H.264 annex B file, NULL sends synthetic frames shaped like H.264 access units. */
+    uint32_t liveviewFps;
+    uint32_t liveviewBitrateKbps; /*!< Bitrate of the synthetic H.264 stream. */
+    uint32_t liveviewImageWidth;
+    uint32_t liveviewImageHeight;
+    uint32_t perceptionFps;
+    uint32_t perceptionImageWidth;
+    uint32_t perceptionImageHeight;
+    uint32_t videoStreamBandwidthKbps; /*!< Link limit seen by DjiPayloadCamera_SendVideoStream(). */
+    uint32_t mopBandwidthKbps; /*!< Link limit of every mop channel connection, 0 means unlimited. */
+    E_DjiMockMopPeerMode mopPeerMode;
+    uint32_t mediaFileCount;
+    uint32_t mediaFileSize; /*!< Unit: byte. */
+    uint32_t mediaDownloadBandwidthKbps; /*!< 0 means unlimited. */
+    uint32_t cameraStatePollFreq; /*!< Frequency the emulated pilot polls the payload camera state, 0 disables it. */
+    uint32_t reportIntervalMs; /*!< 0 disables the periodic statistics report. */
+} T_DjiMockConfig;
+
+typedef struct {
+    char name[DJI_MOCK_STREAM_NAME_MAX_SIZE];
+    uint64_t messageCount;
+    uint64_t byteCount;
+    uint64_t dropCount; /*!< Messages or bytes the emulated link discarded. */
+    uint64_t lateCount; /*!< Messages sent after their deadline because a callback blocked the stream. */
+    uint32_t callbackTimeAvgUs;
+    uint32_t callbackTimeMaxUs;
+    uint32_t runTimeMs;
+} T_DjiMockStreamStatistics;
+
+#pragma pack(1)
+typedef struct {
+    uint64_t timestampUs; /*!< Time since the start of the recording. */
+    uint32_t topic; /*!< E_DjiFcSubscriptionTopic. */
+    uint16_t dataSize;
+} T_DjiMockFcReplayRecordHeader;
+#pragma pack()
+
+/* Exported functions --------------------------------------------------------*/
+/**
+ * @brief Get the built-in configuration, environment variables are not applied.
+ * @param config: pointer to the configuration.
+ */
+void DjiMock_GetDefaultConfig(T_DjiMockConfig *config);
+
+/**
+ * @brief Set the configuration of the mock runtime. Has to be called before DjiCore_Init(), otherwise the default
+ * configuration is used. Environment variables override the items of the configuration.
+ * @param config: pointer to the configuration, the strings have to outlive the runtime.
+ * @return Execution result.
+ */
+T_DjiReturnCode DjiMock_SetConfig(const T_DjiMockConfig *config);
+
+/**
+ * @brief Get the statistics of all streams created so far.
+ * @param statistics: array receiving the statistics.
+ * @param maxCount: array length.
+ * @param count: number of statistics written.
+ * @return Execution result.
+ */
+T_DjiReturnCode DjiMock_GetStreamStatistics(T_DjiMockStreamStatistics *statistics, uint32_t maxCount,
+                                            uint32_t *count);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // DJI_MOCK_H
+/************************ (C) COPYRIGHT DJI Innovations *******END OF FILE******/
@@ -0,0 +1,705 @@
+/**
+ ********************************************************************
+ * @file    dji_mock_camera_manager.c
+ * @brief   Camera manager of the mock runtime, emulating the work state and the media library of the cameras.
+ *
+ * @copyright (c) 2021 DJI. All rights reserved.
+ *
+ * All information contained herein is, and remains, the property of DJI.
+ * The intellectual and technical concepts contained herein are proprietary
+ * to DJI and may be covered by U.S. and foreign patents, patents in process,
+ * and protected by trade secret or copyright law.  Dissemination of this
+ * information, including but not limited to data and other proprietary
+ * material(s) incorporated within the information, in any form, is strictly
+ * prohibited without the express written consent of DJI.
+ *
+ * If you receive this source code without DJI’s authorization, you may not
+ * further disseminate the information, and you must immediately remove the
+ * source code and notify DJI of its removal. DJI reserves the right to pursue
+ * legal actions against you for any loss(es) or damage(s) caused by your
+ * failure to do so.
+ *
+ *********************************************************************
+ */
+
+/* Includes ------------------------------------------------------------------*/
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "dji_mock_internal.h"
+#include "dji_camera_manager.h"
+
+/* Private constants ---------------------------------------------------------*/
+#define DJI_MOCK_CAMERA_POSITION_NUM            (3)
+#define DJI_MOCK_CAMERA_DOWNLOAD_PACKET_SIZE    (32 * 1024)
+#define DJI_MOCK_CAMERA_STORAGE_CAPACITY_MB     (64 * 1024)
+#define DJI_MOCK_CAMERA_MAX_OPTICAL_ZOOM_FACTOR (23.0f)
+#define DJI_MOCK_CAMERA_VIDEO_DURATION_S        (30)
+
+/* Private types -------------------------------------------------------------*/
+typedef struct {
+    pthread_mutex_t mutex;
+    E_DjiCameraManagerWorkMode workMode;
+    E_DjiCameraManagerShootPhotoMode shootPhotoMode;
+    bool isRecording;
+    uint64_t recordStartTimeUs;
+    dji_f32_t opticalZoomFactor;
+    bool hasDownloaderRights;
+    DjiCameraManagerDownloadFileDataCallback downloadCallback;
+    T_DjiCameraManagerFileListInfo *fileListInfo;
+    uint32_t fileCount;
+    uint32_t fileCapacity;
+    T_DjiCameraManagerFileList sliceList;
+    T_DjiMockLink downloadLink;
+    T_DjiMockStream downloadStream;
+} T_DjiMockCamera;
+
+/* Private functions declaration ---------------------------------------------*/
+static T_DjiMockCamera *DjiMock_CameraGet(E_DjiMountPosition position);
+static T_DjiReturnCode DjiMock_CameraCreateMediaList(T_DjiMockCamera *camera);
+static bool DjiMock_CameraAddMediaFile(T_DjiMockCamera *camera, E_DjiCameraMediaFileType type);
+static int32_t DjiMock_CameraSearchFile(const T_DjiMockCamera *camera, uint32_t fileIndex);
+
+/* Private values -------------------------------------------------------------*/
+static bool s_isCameraManagerInit = false;
+static T_DjiMockCamera s_cameraList[DJI_MOCK_CAMERA_POSITION_NUM];
+static uint32_t s_cameraNextFileIndex = 1;
+
+/* Exported functions definition ---------------------------------------------*/
+T_DjiReturnCode DjiCameraManager_Init(void)
+{
+    const T_DjiMockConfig *config = DjiMock_GetConfig();
+    T_DjiReturnCode returnCode;
+    T_DjiMockCamera *camera;
+    char name[DJI_MOCK_STREAM_NAME_MAX_SIZE];
+    uint32_t i;
+
+    returnCode = DjiMock_CheckInit();
+    if (returnCode != DJI_ERROR_SYSTEM_MODULE_CODE_SUCCESS) {
+        return returnCode;
+    }
+
+    if (s_isCameraManagerInit) {
+        return DJI_ERROR_SYSTEM_MODULE_CODE_SUCCESS;
+    }
+
+    for (i = 0; i < DJI_MOCK_CAMERA_POSITION_NUM; i++) {
+        camera = &s_cameraList[i];
+        memset(camera, 0, sizeof(T_DjiMockCamera));
+        pthread_mutex_init(&camera->mutex, NULL);
+        camera->workMode = DJI_CAMERA_MANAGER_WORK_MODE_SHOOT_PHOTO;
+        camera->shootPhotoMode = DJI_CAMERA_MANAGER_SHOOT_PHOTO_MODE_SINGLE;
+        camera->opticalZoomFactor = 1.0f;
+        DjiMock_LinkInit(&camera->downloadLink, config->mediaDownloadBandwidthKbps);
+        snprintf(name, sizeof(name), "camera.download.%d", i + 1);
+        DjiMock_StreamInit(&camera->downloadStream, name, 0);
+
+        returnCode = DjiMock_CameraCreateMediaList(camera);
+        if (returnCode != DJI_ERROR_SYSTEM_MODULE_CODE_SUCCESS) {
+            return returnCode;
+        }
+    }
+
+    s_isCameraManagerInit = true;
+
+    return DJI_ERROR_SYSTEM_MODULE_CODE_SUCCESS;
+}
+
+T_DjiReturnCode DjiCameraManager_DeInit(void)
+{
+    T_DjiMockCamera *camera;
+    uint32_t i;
+
+    if (!s_isCameraManagerInit) {
+        return DJI_ERROR_SYSTEM_MODULE_CODE_SUCCESS;
+    }
+
+    for (i = 0; i < DJI_MOCK_CAMERA_POSITION_NUM; i++) {
+        camera = &s_cameraList[i];
+        DjiMock_StreamDeinit(&camera->downloadStream);
+        free(camera->fileListInfo);
+        free(camera->sliceList.fileListInfo);
+        pthread_mutex_destroy(&camera->mutex);
+    }
+
+    memset(s_cameraList, 0, sizeof(s_cameraList));
+    s_isCameraManagerInit = false;
+
+    return DJI_ERROR_SYSTEM_MODULE_CODE_SUCCESS;
+}
+
+T_DjiReturnCode DjiCameraManager_GetCameraType(E_DjiMountPosition position, E_DjiCameraType *cameraType)
+{
+    if (DjiMock_CameraGet(position) == NULL || cameraType == NULL) {
+        return DJI_ERROR_SYSTEM_MODULE_CODE_INVALID_PARAMETER;
+    }
+
+    *cameraType = DJI_CAMERA_TYPE_H20T;
+
+    return DJI_ERROR_SYSTEM_MODULE_CODE_SUCCESS;
+}
+
+T_DjiReturnCode DjiCameraManager_GetFirmwareVersion(E_DjiMountPosition position,
+                                                    T_DjiCameraManagerFirmwareVersion *firmwareVersion)
+{
+    if (DjiMock_CameraGet(position) == NULL || firmwareVersion == NULL) {
+        return DJI_ERROR_SYSTEM_MODULE_CODE_INVALID_PARAMETER;
+    }
+
+    firmwareVersion->firmware_version[0] = 1;
+    firmwareVersion->firmware_version[1] = 0;
+    firmwareVersion->firmware_version[2] = 0;
+    firmwareVersion->firmware_version[3] = 0;
+
+    return DJI_ERROR_SYSTEM_MODULE_CODE_SUCCESS;
+}
+
+T_DjiReturnCode DjiCameraManager_GetCameraConnectStatus(E_DjiMountPosition position, bool *connectStatus)
+{
+    if (DjiMock_CameraGet(position) == NULL || connectStatus == NULL) {
+        return DJI_ERROR_SYSTEM_MODULE_CODE_INVALID_PARAMETER;
+    }
+
+    *connectStatus = true;
+
+    return DJI_ERROR_SYSTEM_MODULE_CODE_SUCCESS;
+}
+
+T_DjiReturnCode DjiCameraManager_SetMode(E_DjiMountPosition position, E_DjiCameraManagerWorkMode workMode)
+{
+    T_DjiMockCamera *camera = DjiMock_CameraGet(position);
+
+    if (camera == NULL || workMode > DJI_CAMERA_MANAGER_WORK_MODE_BROADCAST) {
+        return DJI_ERROR_SYSTEM_MODULE_CODE_INVALID_PARAMETER;
+    }
+
+    pthread_mutex_lock(&camera->mutex);
+    camera->workMode = workMode;
+    pthread_mutex_unlock(&camera->mutex);
+
+    return DJI_ERROR_SYSTEM_MODULE_CODE_SUCCESS;
+}
+
+T_DjiReturnCode DjiCameraManager_GetMode(E_DjiMountPosition position, E_DjiCameraManagerWorkMode *workMode)
+{
+    T_DjiMockCamera *camera = DjiMock_CameraGet(position);
+
+    if (camera == NULL || workMode == NULL) {
+        return DJI_ERROR_SYSTEM_MODULE_CODE_INVALID_PARAMETER;
+    }
+
+    pthread_mutex_lock(&camera->mutex);
+    *workMode = camera->workMode;
+    pthread_mutex_unlock(&camera->mutex);
+
+    return DJI_ERROR_SYSTEM_MODULE_CODE_SUCCESS;
+}
+
+T_DjiReturnCode DjiCameraManager_SetShootPhotoMode(E_DjiMountPosition position,
+                                                   E_DjiCameraManagerShootPhotoMode mode)
+{
+    T_DjiMockCamera *camera = DjiMock_CameraGet(position);
+
+    if (camera == NULL) {
+        return DJI_ERROR_SYSTEM_MODULE_CODE_INVALID_PARAMETER;
+    }
+
+    pthread_mutex_lock(&camera->mutex);
+    camera->shootPhotoMode = mode;
+    pthread_mutex_unlock(&camera->mutex);
+
+    return DJI_ERROR_SYSTEM_MODULE_CODE_SUCCESS;
+}
+
+T_DjiReturnCode DjiCameraManager_GetShootPhotoMode(E_DjiMountPosition position,
+                                                   E_DjiCameraManagerShootPhotoMode *takePhotoMode)
+{
+    T_DjiMockCamera *camera = DjiMock_CameraGet(position);
+
+    if (camera == NULL || takePhotoMode == NULL) {
+        return DJI_ERROR_SYSTEM_MODULE_CODE_INVALID_PARAMETER;
+    }
+
+    pthread_mutex_lock(&camera->mutex);
+    *takePhotoMode = camera->shootPhotoMode;
+    pthread_mutex_unlock(&camera->mutex);
+
+    return DJI_ERROR_SYSTEM_MODULE_CODE_SUCCESS;
+}
+
+T_DjiReturnCode DjiCameraManager_StartShootPhoto(E_DjiMountPosition position, E_DjiCameraManagerShootPhotoMode mode)
+{
+    T_DjiMockCamera *camera = DjiMock_CameraGet(position);
+    T_DjiReturnCode returnCode = DJI_ERROR_SYSTEM_MODULE_CODE_SUCCESS;
+
+    if (camera == NULL) {
+        return DJI_ERROR_SYSTEM_MODULE_CODE_INVALID_PARAMETER;
+    }
+
+    pthread_mutex_lock(&camera->mutex);
+    if (camera->workMode != DJI_CAMERA_MANAGER_WORK_MODE_SHOOT_PHOTO) {
+        returnCode = DJI_ERROR_CAMERA_MANAGER_MODULE_CODE_UNSUPPORTED_COMMAND_IN_CUR_STATE;
+    } else {
+        camera->shootPhotoMode = mode;
+        if (!DjiMock_CameraAddMediaFile(camera, DJI_CAMERA_FILE_TYPE_JPEG)) {
+            returnCode = DJI_ERROR_CAMERA_MANAGER_MODULE_CODE_SD_CARD_FULL;
+        }
+    }
+    pthread_mutex_unlock(&camera->mutex);
+
+    return returnCode;
+}
+
+T_DjiReturnCode DjiCameraManager_StopShootPhoto(E_DjiMountPosition position)
+{
+    if (DjiMock_CameraGet(position) == NULL) {
+        return DJI_ERROR_SYSTEM_MODULE_CODE_INVALID_PARAMETER;
+    }
+
+    return DJI_ERROR_SYSTEM_MODULE_CODE_SUCCESS;
+}
+
+T_DjiReturnCode DjiCameraManager_GetCapturingState(E_DjiMountPosition position,
+                                                   E_DjiCameraManagerCapturingState *capturingState)
+{
+    if (DjiMock_CameraGet(position) == NULL || capturingState == NULL) {
+        return DJI_ERROR_SYSTEM_MODULE_CODE_INVALID_PARAMETER;
+    }
+
+    *capturingState = DJI_CAMERA_MANAGER_CAPTURING_STATE_IDLE;
+
+    return DJI_ERROR_SYSTEM_MODULE_CODE_SUCCESS;
+}
+
+T_DjiReturnCode DjiCameraManager_StartRecordVideo(E_DjiMountPosition position)
+{
+    T_DjiMockCamera *camera = DjiMock_CameraGet(position);
+    T_DjiReturnCode returnCode = DJI_ERROR_SYSTEM_MODULE_CODE_SUCCESS;
+
+    if (camera == NULL) {
+        return DJI_ERROR_SYSTEM_MODULE_CODE_INVALID_PARAMETER;
+    }
+
+    pthread_mutex_lock(&camera->mutex);
+    if (camera->workMode != DJI_CAMERA_MANAGER_WORK_MODE_RECORD_VIDEO || camera->isRecording) {
+        returnCode = DJI_ERROR_CAMERA_MANAGER_MODULE_CODE_UNSUPPORTED_COMMAND_IN_CUR_STATE;
+    } else {
+        camera->isRecording = true;
+        camera->recordStartTimeUs = DjiMock_GetTimeUs();
+    }
+    pthread_mutex_unlock(&camera->mutex);
+
+    return returnCode;
+}
+
+T_DjiReturnCode DjiCameraManager_StopRecordVideo(E_DjiMountPosition position)
+{
+    T_DjiMockCamera *camera = DjiMock_CameraGet(position);
+    T_DjiReturnCode returnCode = DJI_ERROR_SYSTEM_MODULE_CODE_SUCCESS;
+
+    if (camera == NULL) {
+        return DJI_ERROR_SYSTEM_MODULE_CODE_INVALID_PARAMETER;
+    }
+
+    pthread_mutex_lock(&camera->mutex);
+    if (!camera->isRecording) {
+        returnCode = DJI_ERROR_CAMERA_MANAGER_MODULE_CODE_UNSUPPORTED_COMMAND_IN_CUR_STATE;
+    } else {
+        camera->isRecording = false;
+        if (!DjiMock_CameraAddMediaFile(camera, DJI_CAMERA_FILE_TYPE_MP4)) {
+            returnCode = DJI_ERROR_CAMERA_MANAGER_MODULE_CODE_SD_CARD_FULL;
+        }
+    }
+    pthread_mutex_unlock(&camera->mutex);
+
+    return returnCode;
+}
+
+T_DjiReturnCode DjiCameraManager_GetRecordingState(E_DjiMountPosition position,
+                                                   E_DjiCameraManagerRecordingState *recordingState)
+{
+    T_DjiMockCamera *camera = DjiMock_CameraGet(position);
+
+    if (camera == NULL || recordingState == NULL) {
+        return DJI_ERROR_SYSTEM_MODULE_CODE_INVALID_PARAMETER;
+    }
+
+    pthread_mutex_lock(&camera->mutex);
+    *recordingState = camera->isRecording ? DJI_CAMERA_MANAGER_RECORDING_STATE_RECORDING :
+                      DJI_CAMERA_MANAGER_RECORDING_STATE_IDLE;
+    pthread_mutex_unlock(&camera->mutex);
+
+    return DJI_ERROR_SYSTEM_MODULE_CODE_SUCCESS;
+}
+
+T_DjiReturnCode DjiCameraManager_GetRecordingTime(E_DjiMountPosition position, uint16_t *recordingTime)
+{
+    T_DjiMockCamera *camera = DjiMock_CameraGet(position);
+
+    if (camera == NULL || recordingTime == NULL) {
+        return DJI_ERROR_SYSTEM_MODULE_CODE_INVALID_PARAMETER;
+    }
+
+    pthread_mutex_lock(&camera->mutex);
+    *recordingTime = camera->isRecording ?
+                     (uint16_t) ((DjiMock_GetTimeUs() - camera->recordStartTimeUs) / 1000000) : 0;
+    pthread_mutex_unlock(&camera->mutex);
+
+    return DJI_ERROR_SYSTEM_MODULE_CODE_SUCCESS;
+}
+
+T_DjiReturnCode DjiCameraManager_SetOpticalZoomParam(E_DjiMountPosition position,
+                                                     E_DjiCameraZoomDirection zoomDirection,
+                                                     dji_f32_t factor)
+{
+    T_DjiMockCamera *camera = DjiMock_CameraGet(position);
+
+    DJI_MOCK_UNUSED(zoomDirection);
+
+    if (camera == NULL || factor < 1.0f || factor > DJI_MOCK_CAMERA_MAX_OPTICAL_ZOOM_FACTOR) {
+        return DJI_ERROR_SYSTEM_MODULE_CODE_INVALID_PARAMETER;
+    }
+
+    pthread_mutex_lock(&camera->mutex);
+    camera->opticalZoomFactor = factor;
+    pthread_mutex_unlock(&camera->mutex);
+
+    return DJI_ERROR_SYSTEM_MODULE_CODE_SUCCESS;
+}
+
+T_DjiReturnCode DjiCameraManager_GetOpticalZoomParam(E_DjiMountPosition position,
+                                                     T_DjiCameraManagerOpticalZoomParam *opticalZoomParam)
+{
+    T_DjiMockCamera *camera = DjiMock_CameraGet(position);
+
+    if (camera == NULL || opticalZoomParam == NULL) {
+        return DJI_ERROR_SYSTEM_MODULE_CODE_INVALID_PARAMETER;
+    }
+
+    pthread_mutex_lock(&camera->mutex);
+    opticalZoomParam->currentOpticalZoomFactor = camera->opticalZoomFactor;
+    opticalZoomParam->maxOpticalZoomFactor = DJI_MOCK_CAMERA_MAX_OPTICAL_ZOOM_FACTOR;
+    pthread_mutex_unlock(&camera->mutex);
+
+    return DJI_ERROR_SYSTEM_MODULE_CODE_SUCCESS;
+}
+
+T_DjiReturnCode DjiCameraManager_DownloadFileList(E_DjiMountPosition position, T_DjiCameraManagerFileList *fileList)
+{
+    T_DjiCameraManagerSliceConfig sliceConfig;
+
+    sliceConfig.sliceStartIndex = 0;
+    sliceConfig.countPerSlice = DJI_CAMERA_MANAGER_FILE_LIST_COUNT_ALL_PER_SLICE;
+
+    return DjiCameraManager_DownloadFileListBySlices(position, sliceConfig, fileList);
+}
+
+T_DjiReturnCode DjiCameraManager_DownloadFileListBySlices(E_DjiMountPosition position,
+                                                          T_DjiCameraManagerSliceConfig sliceConfig,
+                                                          T_DjiCameraManagerFileList *fileList)
+{
+    T_DjiMockCamera *camera = DjiMock_CameraGet(position);
+    T_DjiCameraManagerFileListInfo *sliceInfo;
+    uint32_t count;
+
+    if (camera == NULL || fileList == NULL) {
+        return DJI_ERROR_SYSTEM_MODULE_CODE_INVALID_PARAMETER;
+    }
+
+    pthread_mutex_lock(&camera->mutex);
+    if (!camera->hasDownloaderRights && camera->workMode != DJI_CAMERA_MANAGER_WORK_MODE_MEDIA_DOWNLOAD) {
+        pthread_mutex_unlock(&camera->mutex);
+        return DJI_ERROR_CAMERA_MANAGER_MODULE_CODE_UNSUPPORTED_COMMAND_IN_CUR_STATE;
+    }
+
+    // the list returned is owned by the mock and stays valid until the next request on this position
+    count = sliceConfig.sliceStartIndex < camera->fileCount ? camera->fileCount - sliceConfig.sliceStartIndex : 0;
+    count = DJI_MOCK_MIN(count, (uint32_t) sliceConfig.countPerSlice);
+    sliceInfo = realloc(camera->sliceList.fileListInfo,
+                        DJI_MOCK_MAX(count, 1) * sizeof(T_DjiCameraManagerFileListInfo));
+    if (sliceInfo == NULL) {
+        pthread_mutex_unlock(&camera->mutex);
+        return DJI_ERROR_SYSTEM_MODULE_CODE_MEMORY_ALLOC_FAILED;
+    }
+    if (count > 0) {
+        memcpy(sliceInfo, &camera->fileListInfo[sliceConfig.sliceStartIndex],
+               count * sizeof(T_DjiCameraManagerFileListInfo));
+    }
+    camera->sliceList.fileListInfo = sliceInfo;
+    camera->sliceList.totalCount = (uint16_t) count;
+    *fileList = camera->sliceList;
+    pthread_mutex_unlock(&camera->mutex);
+
+    return DJI_ERROR_SYSTEM_MODULE_CODE_SUCCESS;
+}
+
+T_DjiReturnCode DjiCameraManager_RegDownloadFileDataCallback(E_DjiMountPosition position,
+                                                             DjiCameraManagerDownloadFileDataCallback callback)
+{
+    T_DjiMockCamera *camera = DjiMock_CameraGet(position);
+
+    if (camera == NULL) {
+        return DJI_ERROR_SYSTEM_MODULE_CODE_INVALID_PARAMETER;
+    }
+
+    pthread_mutex_lock(&camera->mutex);
+    camera->downloadCallback = callback;
+    pthread_mutex_unlock(&camera->mutex);
+
+    return DJI_ERROR_SYSTEM_MODULE_CODE_SUCCESS;
+}
+
+T_DjiReturnCode DjiCameraManager_DownloadFileByIndex(E_DjiMountPosition position, uint32_t fileIndex)
+{
+    T_DjiMockCamera *camera = DjiMock_CameraGet(position);
+    DjiCameraManagerDownloadFileDataCallback callback;
+    T_DjiDownloadFilePacketInfo packetInfo = {0};
+    T_DjiReturnCode returnCode = DJI_ERROR_SYSTEM_MODULE_CODE_SUCCESS;
+    uint8_t *packet;
+    uint64_t seed = fileIndex;
+    uint64_t beginUs;
+    uint32_t offset = 0;
+    uint32_t packetLen;
+    uint32_t i;
+    int32_t pos;
+
+    if (camera == NULL) {
+        return DJI_ERROR_SYSTEM_MODULE_CODE_INVALID_PARAMETER;
+    }
+
+    pthread_mutex_lock(&camera->mutex);
+    callback = camera->downloadCallback;
+    pos = DjiMock_CameraSearchFile(camera, fileIndex);
+    if (pos >= 0) {
+        packetInfo.fileIndex = fileIndex;
+        packetInfo.fileSize = camera->fileListInfo[pos].fileSize;
+        packetInfo.fileType = (uint8_t) camera->fileListInfo[pos].type;
+    }
+    pthread_mutex_unlock(&camera->mutex);
+
+    if (pos < 0) {
+        return DJI_ERROR_CAMERA_MANAGER_MODULE_CODE_INVALID_COMMAND_PARAMETER;
+    }
+    if (callback == NULL) {
+        return DJI_ERROR_SYSTEM_MODULE_CODE_NONSUPPORT_IN_CURRENT_STATE;
+    }
+
+    packet = malloc(DJI_MOCK_CAMERA_DOWNLOAD_PACKET_SIZE);
+    if (packet == NULL) {
+        return DJI_ERROR_SYSTEM_MODULE_CODE_MEMORY_ALLOC_FAILED;
+    }
+    for (i = 0; i < DJI_MOCK_CAMERA_DOWNLOAD_PACKET_SIZE; i++) {
+        packet[i] = (uint8_t) DjiMock_Random(&seed);
+    }
+
+    // the file data is a repeated noise pattern, delivered at the media download bandwidth in fixed size packets
+    packetInfo.downloadFileEvent = DJI_DOWNLOAD_FILE_EVENT_START;
+    while (offset < packetInfo.fileSize || packetInfo.downloadFileEvent == DJI_DOWNLOAD_FILE_EVENT_START) {
+        packetLen = DJI_MOCK_MIN(packetInfo.fileSize - offset, DJI_MOCK_CAMERA_DOWNLOAD_PACKET_SIZE);
+        DjiMock_LinkWait(&camera->downloadLink, packetLen);
+
+        offset += packetLen;
+        packetInfo.progressInPercent = packetInfo.fileSize > 0 ? offset * 100.0f / packetInfo.fileSize : 100.0f;
+        if (offset >= packetInfo.fileSize) {
+            packetInfo.downloadFileEvent = packetInfo.downloadFileEvent == DJI_DOWNLOAD_FILE_EVENT_START ?
+                                           DJI_DOWNLOAD_FILE_EVENT_START_TRANSFER_END :
+                                           DJI_DOWNLOAD_FILE_EVENT_END;
+        }
+
+        beginUs = DjiMock_GetTimeUs();
+        returnCode = callback(packetInfo, packet, (uint16_t) packetLen);
+        DjiMock_StreamRecord(&camera->downloadStream, packetLen, DjiMock_GetTimeUs() - beginUs);
+        if (returnCode != DJI_ERROR_SYSTEM_MODULE_CODE_SUCCESS) {
+            USER_LOG_WARN("[mock] Download file %d aborted by callback, error code: 0x%08llX.", fileIndex,
+                          returnCode);
+            break;
+        }
+
+        if (packetInfo.downloadFileEvent == DJI_DOWNLOAD_FILE_EVENT_START) {
+            packetInfo.downloadFileEvent = DJI_DOWNLOAD_FILE_EVENT_TRANSFER;
+        }
+    }
+
+    free(packet);
+
+    return returnCode;
+}
+
+T_DjiReturnCode DjiCameraManager_ObtainDownloaderRights(E_DjiMountPosition position)
+{
+    T_DjiMockCamera *camera = DjiMock_CameraGet(position);
+
+    if (camera == NULL) {
+        return DJI_ERROR_SYSTEM_MODULE_CODE_INVALID_PARAMETER;
+    }
+
+    pthread_mutex_lock(&camera->mutex);
+    camera->hasDownloaderRights = true;
+    pthread_mutex_unlock(&camera->mutex);
+
+    return DJI_ERROR_SYSTEM_MODULE_CODE_SUCCESS;
+}
+
+T_DjiReturnCode DjiCameraManager_ReleaseDownloaderRights(E_DjiMountPosition position)
+{
+    T_DjiMockCamera *camera = DjiMock_CameraGet(position);
+
+    if (camera == NULL) {
+        return DJI_ERROR_SYSTEM_MODULE_CODE_INVALID_PARAMETER;
+    }
+
+    pthread_mutex_lock(&camera->mutex);
+    camera->hasDownloaderRights = false;
+    pthread_mutex_unlock(&camera->mutex);
+
+    return DJI_ERROR_SYSTEM_MODULE_CODE_SUCCESS;
+}
+
+T_DjiReturnCode DjiCameraManager_FormatStorage(E_DjiMountPosition position)
+{
+    T_DjiMockCamera *camera = DjiMock_CameraGet(position);
+
+    if (camera == NULL) {
+        return DJI_ERROR_SYSTEM_MODULE_CODE_INVALID_PARAMETER;
+    }
+
+    pthread_mutex_lock(&camera->mutex);
+    camera->fileCount = 0;
+    pthread_mutex_unlock(&camera->mutex);
+
+    return DJI_ERROR_SYSTEM_MODULE_CODE_SUCCESS;
+}
+
+T_DjiReturnCode DjiCameraManager_GetStorageInfo(E_DjiMountPosition position,
+                                                T_DjiCameraManagerStorageInfo *storageInfo)
+{
+    T_DjiMockCamera *camera = DjiMock_CameraGet(position);
+    uint64_t usedBytes = 0;
+    uint32_t i;
+
+    if (camera == NULL || storageInfo == NULL) {
+        return DJI_ERROR_SYSTEM_MODULE_CODE_INVALID_PARAMETER;
+    }
+
+    pthread_mutex_lock(&camera->mutex);
+    for (i = 0; i < camera->fileCount; i++) {
+        usedBytes += camera->fileListInfo[i].fileSize;
+    }
+    pthread_mutex_unlock(&camera->mutex);
+
+    storageInfo->totalCapacity = DJI_MOCK_CAMERA_STORAGE_CAPACITY_MB;
+    storageInfo->remainCapacity = (uint32_t) (DJI_MOCK_CAMERA_STORAGE_CAPACITY_MB -
+                                              DJI_MOCK_MIN(usedBytes / (1024 * 1024),
+                                                           DJI_MOCK_CAMERA_STORAGE_CAPACITY_MB));
+
+    return DJI_ERROR_SYSTEM_MODULE_CODE_SUCCESS;
+}
+
+T_DjiReturnCode DjiCameraManager_DeleteFileByIndex(E_DjiMountPosition position, uint32_t fileIndex)
+{
+    T_DjiMockCamera *camera = DjiMock_CameraGet(position);
+    int32_t pos;
+
+    if (camera == NULL) {
+        return DJI_ERROR_SYSTEM_MODULE_CODE_INVALID_PARAMETER;
+    }
+
+    pthread_mutex_lock(&camera->mutex);
+    pos = DjiMock_CameraSearchFile(camera, fileIndex);
+    if (pos >= 0) {
+        memmove(&camera->fileListInfo[pos], &camera->fileListInfo[pos + 1],
+                (camera->fileCount - pos - 1) * sizeof(T_DjiCameraManagerFileListInfo));
+        camera->fileCount--;
+    }
+    pthread_mutex_unlock(&camera->mutex);
+
+    return pos >= 0 ? DJI_ERROR_SYSTEM_MODULE_CODE_SUCCESS :
+           DJI_ERROR_CAMERA_MANAGER_MODULE_CODE_INVALID_COMMAND_PARAMETER;
+}
+
+/* Private functions definition-----------------------------------------------*/
+static T_DjiMockCamera *DjiMock_CameraGet(E_DjiMountPosition position)
+{
+    if (!s_isCameraManagerInit || position < DJI_MOUNT_POSITION_PAYLOAD_PORT_NO1 ||
+        position > DJI_MOUNT_POSITION_PAYLOAD_PORT_NO3) {
+        return NULL;
+    }
+
+    return &s_cameraList[position - DJI_MOUNT_POSITION_PAYLOAD_PORT_NO1];
+}
+
+static T_DjiReturnCode DjiMock_CameraCreateMediaList(T_DjiMockCamera *camera)
+{
+    const T_DjiMockConfig *config = DjiMock_GetConfig();
+    uint32_t i;
+
+    for (i = 0; i < config->mediaFileCount; i++) {
+        if (!DjiMock_CameraAddMediaFile(camera, i % 2 == 0 ? DJI_CAMERA_FILE_TYPE_JPEG : DJI_CAMERA_FILE_TYPE_MP4)) {
+            return DJI_ERROR_SYSTEM_MODULE_CODE_MEMORY_ALLOC_FAILED;
+        }
+    }
+
+    return DJI_ERROR_SYSTEM_MODULE_CODE_SUCCESS;
+}
+
+static bool DjiMock_CameraAddMediaFile(T_DjiMockCamera *camera, E_DjiCameraMediaFileType type)
+{
+    const T_DjiMockConfig *config = DjiMock_GetConfig();
+    T_DjiCameraManagerFileListInfo *fileListInfo;
+    T_DjiCameraManagerFileListInfo *fileInfo;
+    uint32_t fileIndex;
+    uint32_t capacity;
+
+    if (camera->fileCount == camera->fileCapacity) {
+        capacity = DJI_MOCK_MAX(camera->fileCapacity * 2, DJI_MOCK_MAX(config->mediaFileCount, 16));
+        fileListInfo = realloc(camera->fileListInfo, capacity * sizeof(T_DjiCameraManagerFileListInfo));
+        if (fileListInfo == NULL) {
+            return false;
+        }
+        camera->fileListInfo = fileListInfo;
+        camera->fileCapacity = capacity;
+    }
+
+    fileIndex = s_cameraNextFileIndex++;
+    fileInfo = &camera->fileListInfo[camera->fileCount++];
+    memset(fileInfo, 0, sizeof(T_DjiCameraManagerFileListInfo));
+    snprintf(fileInfo->fileName, sizeof(fileInfo->fileName), "DJI_%04u.%s", fileIndex,
+             type == DJI_CAMERA_FILE_TYPE_JPEG ? "JPG" : "MP4");
+    fileInfo->fileSize = config->mediaFileSize;
+    fileInfo->fileIndex = fileIndex;
+    fileInfo->type = type;
+    fileInfo->createTime.year = 2023;
+    fileInfo->createTime.month = 1 + (fileIndex / (28 * 24 * 60)) % 12;
+    fileInfo->createTime.day = 1 + (fileIndex / (24 * 60)) % 28;
+    fileInfo->createTime.hour = (fileIndex / 60) % 24;
+    fileInfo->createTime.minute = fileIndex % 60;
+    if (type == DJI_CAMERA_FILE_TYPE_MP4) {
+        fileInfo->attributeData.videoAttribute.attributeVideoDuration = DJI_MOCK_CAMERA_VIDEO_DURATION_S;
+    }
+
+    return true;
+}
+
+static int32_t DjiMock_CameraSearchFile(const T_DjiMockCamera *camera, uint32_t fileIndex)
+{
+    int32_t low = 0;
+    int32_t high = (int32_t) camera->fileCount - 1;
+    int32_t mid;
+
+    // file indexes are handed out increasing, so the list stays sorted across deletions
+    while (low <= high) {
+        mid = low + (high - low) / 2;
+        if (camera->fileListInfo[mid].fileIndex == fileIndex) {
+            return mid;
+        } else if (camera->fileListInfo[mid].fileIndex < fileIndex) {
+            low = mid + 1;
+        } else {
+            high = mid - 1;
+        }
+    }
+
+    return -1;
+}
+
+/****************** (C) COPYRIGHT DJI Innovations *****END OF FILE****/
@@ -0,0 +1,629 @@
+/**
+ ********************************************************************
+ * @file    dji_mock_core.c
+ * @brief   Core, platform, logger and aircraft information of the mock runtime.
+ *
+ * @copyright (c) 2021 DJI. All rights reserved.
+ *
+ * All information contained herein is, and remains, the property of DJI.
+ * The intellectual and technical concepts contained herein are proprietary
+ * to DJI and may be covered by U.S. and foreign patents, patents in process,
+ * and protected by trade secret or copyright law.  Dissemination of this
+ * information, including but not limited to data and other proprietary
+ * material(s) incorporated within the information, in any form, is strictly
+ * prohibited without the express written consent of DJI.
+ *
+ * If you receive this source code without DJI’s authorization, you may not
+ * further disseminate the information, and you must immediately remove the
+ * source code and notify DJI of its removal. DJI reserves the right to pursue
+ * legal actions against you for any loss(es) or damage(s) caused by your
+ * failure to do so.
+ *
+ *********************************************************************
+ */
+
+/* Includes ------------------------------------------------------------------*/
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdarg.h>
+#include "dji_mock_internal.h"
+#include "dji_core.h"
+#include "dji_aircraft_info.h"
+
+/* Private constants ---------------------------------------------------------*/
+#define DJI_MOCK_LOGGER_CONSOLE_MAX_NUM     (8)
+#define DJI_MOCK_LOGGER_BUFFER_SIZE         (1024)
+
+/* Private types -------------------------------------------------------------*/
+
+/* Private functions declaration ---------------------------------------------*/
+static void DjiMock_ApplyEnvironment(T_DjiMockConfig *config);
+static uint32_t DjiMock_GetEnvUint(const char *name, uint32_t defaultValue);
+static void *DjiMock_ReportTask(void *arg);
+
+/* Private values -------------------------------------------------------------*/
+static T_DjiMockConfig s_mockConfig;
+static bool s_isConfigSet = false;
+static bool s_isCoreInit = false;
+static uint64_t s_coreInitTimeUs = 0;
+static pthread_t s_reportThread;
+static bool s_isReportRunning = false;
+
+static T_DjiOsalHandler s_osalHandler;
+static T_DjiHalUartHandler s_halUartHandler;
+static T_DjiHalUsbBulkHandler s_halUsbBulkHandler;
+static T_DjiHalNetworkHandler s_halNetworkHandler;
+static T_DjiHalI2cHandler s_halI2cHandler;
+static T_DjiFileSystemHandler s_fileSystemHandler;
+static T_DjiSocketHandler s_socketHandler;
+static bool s_isOsalHandlerReg = false;
+static bool s_isHalUsbBulkHandlerReg = false;
+static bool s_isHalNetworkHandlerReg = false;
+static bool s_isHalI2cHandlerReg = false;
+static bool s_isFileSystemHandlerReg = false;
+static bool s_isSocketHandlerReg = false;
+
+static pthread_mutex_t s_loggerMutex = PTHREAD_MUTEX_INITIALIZER;
+static T_DjiLoggerConsole s_loggerConsoleList[DJI_MOCK_LOGGER_CONSOLE_MAX_NUM];
+static uint8_t s_loggerConsoleCount = 0;
+static const char *s_loggerLevelName[] = {"Error", "Warn", "Info", "Debug"};
+static const char *s_loggerLevelColor[] = {"\033[31;1m", "\033[33;1m", "\033[32m", "\033[0m"};
+
+/* Exported functions definition ---------------------------------------------*/
+void DjiMock_GetDefaultConfig(T_DjiMockConfig *config)
+{
+    memset(config, 0, sizeof(T_DjiMockConfig));
+
+    config->aircraftType = DJI_AIRCRAFT_TYPE_M300_RTK;
+    config->mountPosition = DJI_MOUNT_POSITION_PAYLOAD_PORT_NO1;
+    config->fcReplayFile = NULL;
+    config->liveviewFile = NULL;
+    config->liveviewFps = 30;
+    config->liveviewBitrateKbps = 8000;
+    config->liveviewImageWidth = 1280;
+    config->liveviewImageHeight = 720;
+    config->perceptionFps = 20;
+    config->perceptionImageWidth = 640;
+    config->perceptionImageHeight = 480;
+    config->videoStreamBandwidthKbps = 8000;
+    config->mopBandwidthKbps = 24000;
+    config->mopPeerMode = DJI_MOCK_MOP_PEER_MODE_ECHO;
+    config->mediaFileCount = 100;
+    config->mediaFileSize = 4 * 1024 * 1024;
+    config->mediaDownloadBandwidthKbps = 80000;
+    config->cameraStatePollFreq = 5;
+    config->reportIntervalMs = 5000;
+}
+
+T_DjiReturnCode DjiMock_SetConfig(const T_DjiMockConfig *config)
+{
+    if (config == NULL) {
+        return DJI_ERROR_SYSTEM_MODULE_CODE_INVALID_PARAMETER;
+    }
+
+    if (s_isCoreInit) {
+        return DJI_ERROR_SYSTEM_MODULE_CODE_BUSY;
+    }
+
+    s_mockConfig = *config;
+    s_isConfigSet = true;
+
+    return DJI_ERROR_SYSTEM_MODULE_CODE_SUCCESS;
+}
+
+const T_DjiMockConfig *DjiMock_GetConfig(void)
+{
+    if (!s_isConfigSet) {
+        DjiMock_GetDefaultConfig(&s_mockConfig);
+        s_isConfigSet = true;
+    }
+
+    return &s_mockConfig;
+}
+
+T_DjiReturnCode DjiMock_CheckInit(void)
+{
+    return s_isCoreInit ? DJI_ERROR_SYSTEM_MODULE_CODE_SUCCESS :
+           DJI_ERROR_SYSTEM_MODULE_CODE_NONSUPPORT_IN_CURRENT_STATE;
+}
+
+T_DjiReturnCode DjiMock_Unsupported(const char *function)
+{
+    USER_LOG_DEBUG("[mock] %s is not supported by the mock runtime.", function);
+
+    return DJI_ERROR_SYSTEM_MODULE_CODE_NONSUPPORT;
+}
+
+T_DjiReturnCode DjiCore_Init(const T_DjiUserInfo *userInfo)
+{
+    if (userInfo == NULL) {
+        return DJI_ERROR_SYSTEM_MODULE_CODE_INVALID_PARAMETER;
+    }
+
+    if (s_isCoreInit) {
+        return DJI_ERROR_SYSTEM_MODULE_CODE_SUCCESS;
+    }
+
+    if (!s_isOsalHandlerReg) {
+        USER_LOG_ERROR("[mock] Osal handler has to be registered before core init.");
+        return DJI_ERROR_SYSTEM_MODULE_CODE_NONSUPPORT_IN_CURRENT_STATE;
+    }
+
+    DjiMock_GetConfig();
+    DjiMock_ApplyEnvironment(&s_mockConfig);
+    s_coreInitTimeUs = DjiMock_GetTimeUs();
+    s_isCoreInit = true;
+
+    USER_LOG_INFO("[mock] Payload SDK mock runtime, app %s, aircraft type %d, mount position %d.",
+                  userInfo->appName, s_mockConfig.aircraftType, s_mockConfig.mountPosition);
+
+    if (s_mockConfig.reportIntervalMs > 0) {
+        s_isReportRunning = true;
+        if (pthread_create(&s_reportThread, NULL, DjiMock_ReportTask, NULL) != 0) {
+            s_isReportRunning = false;
+            USER_LOG_WARN("[mock] Create report task failed.");
+        }
+    }
+
+    return DJI_ERROR_SYSTEM_MODULE_CODE_SUCCESS;
+}
+
+T_DjiReturnCode DjiCore_SetAlias(const char *productAlias)
+{
+    if (productAlias == NULL) {
+        return DJI_ERROR_SYSTEM_MODULE_CODE_INVALID_PARAMETER;
+    }
+
+    return DjiMock_CheckInit();
+}
+
+T_DjiReturnCode DjiCore_SetFirmwareVersion(T_DjiFirmwareVersion version)
+{
+    DJI_MOCK_UNUSED(version);
+
+    return DjiMock_CheckInit();
+}
+
+T_DjiReturnCode DjiCore_SetSerialNumber(const char *productSerialNumber)
+{
+    if (productSerialNumber == NULL) {
+        return DJI_ERROR_SYSTEM_MODULE_CODE_INVALID_PARAMETER;
+    }
+
+    return DjiMock_CheckInit();
+}
+
+T_DjiReturnCode DjiCore_ApplicationStart(void)
+{
+    T_DjiReturnCode returnCode = DjiMock_CheckInit();
+
+    if (returnCode == DJI_ERROR_SYSTEM_MODULE_CODE_SUCCESS) {
+        USER_LOG_INFO("[mock] Application started, %u ms after core init.",
+                      (uint32_t) ((DjiMock_GetTimeUs() - s_coreInitTimeUs) / 1000));
+    }
+
+    return returnCode;
+}
+
+T_DjiReturnCode DjiCore_DeInit(void)
+{
+    if (!s_isCoreInit) {
+        return DJI_ERROR_SYSTEM_MODULE_CODE_SUCCESS;
+    }
+
+    if (s_isReportRunning) {
+        s_isReportRunning = false;
+        pthread_join(s_reportThread, NULL);
+    }
+
+    DjiMock_StreamReport();
+    s_isCoreInit = false;
+
+    return DJI_ERROR_SYSTEM_MODULE_CODE_SUCCESS;
+}
+
+T_DjiReturnCode DjiPlatform_RegHalUartHandler(const T_DjiHalUartHandler *halUartHandler)
+{
+    if (halUartHandler == NULL) {
+        return DJI_ERROR_SYSTEM_MODULE_CODE_INVALID_PARAMETER;
+    }
+
+    s_halUartHandler = *halUartHandler;
+
+    return DJI_ERROR_SYSTEM_MODULE_CODE_SUCCESS;
+}
+
+T_DjiReturnCode DjiPlatform_RegHalUsbBulkHandler(const T_DjiHalUsbBulkHandler *halUsbBulkHandler)
+{
+    if (halUsbBulkHandler == NULL) {
+        return DJI_ERROR_SYSTEM_MODULE_CODE_INVALID_PARAMETER;
+    }
+
+    s_halUsbBulkHandler = *halUsbBulkHandler;
+    s_isHalUsbBulkHandlerReg = true;
+
+    return DJI_ERROR_SYSTEM_MODULE_CODE_SUCCESS;
+}
+
+T_DjiReturnCode DjiPlatform_RegHalNetworkHandler(const T_DjiHalNetworkHandler *halNetworkHandler)
+{
+    if (halNetworkHandler == NULL) {
+        return DJI_ERROR_SYSTEM_MODULE_CODE_INVALID_PARAMETER;
+    }
+
+    s_halNetworkHandler = *halNetworkHandler;
+    s_isHalNetworkHandlerReg = true;
+
+    return DJI_ERROR_SYSTEM_MODULE_CODE_SUCCESS;
+}
+
+T_DjiReturnCode DjiPlatform_RegHalI2cHandler(const T_DjiHalI2cHandler *halI2cHandler)
+{
+    if (halI2cHandler == NULL) {
+        return DJI_ERROR_SYSTEM_MODULE_CODE_INVALID_PARAMETER;
+    }
+
+    s_halI2cHandler = *halI2cHandler;
+    s_isHalI2cHandlerReg = true;
+
+    return DJI_ERROR_SYSTEM_MODULE_CODE_SUCCESS;
+}
+
+T_DjiReturnCode DjiPlatform_RegOsalHandler(const T_DjiOsalHandler *osalHandler)
+{
+    if (osalHandler == NULL) {
+        return DJI_ERROR_SYSTEM_MODULE_CODE_INVALID_PARAMETER;
+    }
+
+    s_osalHandler = *osalHandler;
+    s_isOsalHandlerReg = true;
+
+    return DJI_ERROR_SYSTEM_MODULE_CODE_SUCCESS;
+}
+
+T_DjiReturnCode DjiPlatform_RegFileSystemHandler(const T_DjiFileSystemHandler *fileSystemHandler)
+{
+    if (fileSystemHandler == NULL) {
+        return DJI_ERROR_SYSTEM_MODULE_CODE_INVALID_PARAMETER;
+    }
+
+    s_fileSystemHandler = *fileSystemHandler;
+    s_isFileSystemHandlerReg = true;
+
+    return DJI_ERROR_SYSTEM_MODULE_CODE_SUCCESS;
+}
+
+T_DjiReturnCode DjiPlatform_RegSocketHandler(const T_DjiSocketHandler *socketHandler)
+{
+    if (socketHandler == NULL) {
+        return DJI_ERROR_SYSTEM_MODULE_CODE_INVALID_PARAMETER;
+    }
+
+    s_socketHandler = *socketHandler;
+    s_isSocketHandlerReg = true;
+
+    return DJI_ERROR_SYSTEM_MODULE_CODE_SUCCESS;
+}
+
+T_DjiOsalHandler *DjiPlatform_GetOsalHandler(void)
+{
+    return s_isOsalHandlerReg ? &s_osalHandler : NULL;
+}
+
+T_DjiHalUsbBulkHandler *DjiPlatform_GetHalUsbBulkHandler(void)
+{
+    return s_isHalUsbBulkHandlerReg ? &s_halUsbBulkHandler : NULL;
+}
+
+T_DjiHalNetworkHandler *DjiPlatform_GetHalNetworkHandler(void)
+{
+    return s_isHalNetworkHandlerReg ? &s_halNetworkHandler : NULL;
+}
+
+T_DjiHalI2cHandler *DjiPlatform_GetHalI2cHandler(void)
+{
+    return s_isHalI2cHandlerReg ? &s_halI2cHandler : NULL;
+}
+
+T_DjiFileSystemHandler *DjiPlatform_GetFileSystemHandler(void)
+{
+    return s_isFileSystemHandlerReg ? &s_fileSystemHandler : NULL;
+}
+
+T_DjiSocketHandler *DjiPlatform_GetSocketHandler(void)
+{
+    return s_isSocketHandlerReg ? &s_socketHandler : NULL;
+}
+
+T_DjiReturnCode DjiLogger_AddConsole(T_DjiLoggerConsole *console)
+{
+    if (console == NULL || console->func == NULL) {
+        return DJI_ERROR_SYSTEM_MODULE_CODE_INVALID_PARAMETER;
+    }
+
+    pthread_mutex_lock(&s_loggerMutex);
+    if (s_loggerConsoleCount >= DJI_MOCK_LOGGER_CONSOLE_MAX_NUM) {
+        pthread_mutex_unlock(&s_loggerMutex);
+        return DJI_ERROR_SYSTEM_MODULE_CODE_OUT_OF_RANGE;
+    }
+    s_loggerConsoleList[s_loggerConsoleCount++] = *console;
+    pthread_mutex_unlock(&s_loggerMutex);
+
+    return DJI_ERROR_SYSTEM_MODULE_CODE_SUCCESS;
+}
+
+T_DjiReturnCode DjiLogger_RemoveConsole(T_DjiLoggerConsole *console)
+{
+    uint8_t i;
+
+    if (console == NULL) {
+        return DJI_ERROR_SYSTEM_MODULE_CODE_INVALID_PARAMETER;
+    }
+
+    pthread_mutex_lock(&s_loggerMutex);
+    for (i = 0; i < s_loggerConsoleCount; i++) {
+        if (s_loggerConsoleList[i].func == console->func) {
+            s_loggerConsoleList[i] = s_loggerConsoleList[--s_loggerConsoleCount];
+            pthread_mutex_unlock(&s_loggerMutex);
+            return DJI_ERROR_SYSTEM_MODULE_CODE_SUCCESS;
+        }
+    }
+    pthread_mutex_unlock(&s_loggerMutex);
+
+    return DJI_ERROR_SYSTEM_MODULE_CODE_NOT_FOUND;
+}
+
+void DjiLogger_UserLogOutput(E_DjiLoggerConsoleLogLevel level, const char *fmt, ...)
+{
+    char plainBuffer[DJI_MOCK_LOGGER_BUFFER_SIZE];
+    char colorBuffer[DJI_MOCK_LOGGER_BUFFER_SIZE + 16];
+    char message[DJI_MOCK_LOGGER_BUFFER_SIZE - 64];
+    uint64_t timeMs = DjiMock_GetTimeUs() / 1000;
+    int plainLen;
+    int colorLen;
+    va_list args;
+    uint8_t i;
+
+    if ((uint32_t) level > DJI_LOGGER_CONSOLE_LOG_LEVEL_DEBUG) {
+        return;
+    }
+
+    va_start(args, fmt);
+    vsnprintf(message, sizeof(message), fmt, args);
+    va_end(args);
+
+    plainLen = snprintf(plainBuffer, sizeof(plainBuffer), "[%llu.%03u][user]-[%s]-%s\r\n",
+                        (unsigned long long) (timeMs / 1000), (uint32_t) (timeMs % 1000),
+                        s_loggerLevelName[level], message);
+    plainLen = DJI_MOCK_MIN(plainLen, (int) sizeof(plainBuffer) - 1);
+    colorLen = snprintf(colorBuffer, sizeof(colorBuffer), "%s%.*s\033[0m", s_loggerLevelColor[level],
+                        plainLen, plainBuffer);
+    colorLen = DJI_MOCK_MIN(colorLen, (int) sizeof(colorBuffer) - 1);
+
+    pthread_mutex_lock(&s_loggerMutex);
+    for (i = 0; i < s_loggerConsoleCount; i++) {
+        if (level > s_loggerConsoleList[i].consoleLevel) {
+            continue;
+        }
+        if (s_loggerConsoleList[i].isSupportColor) {
+            s_loggerConsoleList[i].func((const uint8_t *) colorBuffer, (uint16_t) colorLen);
+        } else {
+            s_loggerConsoleList[i].func((const uint8_t *) plainBuffer, (uint16_t) plainLen);
+        }
+    }
+    pthread_mutex_unlock(&s_loggerMutex);
+}
+
+T_DjiReturnCode DjiAircraftInfo_GetBaseInfo(T_DjiAircraftInfoBaseInfo *baseInfo)
+{
+    const T_DjiMockConfig *config = DjiMock_GetConfig();
+
+    if (baseInfo == NULL) {
+        return DJI_ERROR_SYSTEM_MODULE_CODE_INVALID_PARAMETER;
+    }
+
+    memset(baseInfo, 0, sizeof(T_DjiAircraftInfoBaseInfo));
+    baseInfo->aircraftType = config->aircraftType;
+    baseInfo->mountPosition = config->mountPosition;
+    baseInfo->djiAdapterType = DJI_SDK_ADAPTER_TYPE_SKYPORT_V2;
+
+    switch (config->aircraftType) {
+        case DJI_AIRCRAFT_TYPE_M300_RTK:
+            baseInfo->aircraftSeries = DJI_AIRCRAFT_SERIES_M300;
+            break;
+        case DJI_AIRCRAFT_TYPE_M350_RTK:
+            baseInfo->aircraftSeries = DJI_AIRCRAFT_SERIES_M350;
+            break;
+        case DJI_AIRCRAFT_TYPE_M30:
+        case DJI_AIRCRAFT_TYPE_M30T:
+            baseInfo->aircraftSeries = DJI_AIRCRAFT_SERIES_M30;
+            break;
+        case DJI_AIRCRAFT_TYPE_M3E:
+        case DJI_AIRCRAFT_TYPE_M3T:
+        case DJI_AIRCRAFT_TYPE_M3TA:
+            baseInfo->aircraftSeries = DJI_AIRCRAFT_SERIES_M3;
+            break;
+        case DJI_AIRCRAFT_TYPE_M3D:
+        case DJI_AIRCRAFT_TYPE_M3TD:
+            baseInfo->aircraftSeries = DJI_AIRCRAFT_SERIES_M3D;
+            break;
+        case DJI_AIRCRAFT_TYPE_M400:
+            baseInfo->aircraftSeries = DJI_AIRCRAFT_SERIES_M400;
+            break;
+        default:
+            baseInfo->aircraftSeries = DJI_AIRCRAFT_SERIES_UNKNOWN;
+            break;
+    }
+
+    if (config->mountPosition == DJI_MOUNT_POSITION_EXTENSION_PORT) {
+        baseInfo->mountPositionType = DJI_MOUNT_POSITION_TYPE_EXTENSION_PORT;
+        baseInfo->djiAdapterType = DJI_SDK_ADAPTER_TYPE_NONE;
+    } else if (config->mountPosition == DJI_MOUNT_POSITION_EXTENSION_LITE_PORT) {
+        baseInfo->mountPositionType = DJI_MOUNT_POSITION_TYPE_EXTENSION_LITE_PORT;
+        baseInfo->djiAdapterType = DJI_SDK_ADAPTER_TYPE_NONE;
+    } else {
+        baseInfo->mountPositionType = DJI_MOUNT_POSITION_TYPE_PAYLOAD_PORT;
+    }
+
+    return DJI_ERROR_SYSTEM_MODULE_CODE_SUCCESS;
+}
+
+T_DjiReturnCode DjiAircraftInfo_GetMobileAppInfo(T_DjiMobileAppInfo *mobileAppInfo)
+{
+    if (mobileAppInfo == NULL) {
+        return DJI_ERROR_SYSTEM_MODULE_CODE_INVALID_PARAMETER;
+    }
+
+    mobileAppInfo->appLanguage = DJI_MOBILE_APP_LANGUAGE_ENGLISH;
+    mobileAppInfo->appScreenType = DJI_MOBILE_APP_SCREEN_TYPE_BIG_SCREEN;
+
+    return DJI_ERROR_SYSTEM_MODULE_CODE_SUCCESS;
+}
+
+T_DjiReturnCode DjiAircraftInfo_GetConnectionStatus(bool *isConnected)
+{
+    if (isConnected == NULL) {
+        return DJI_ERROR_SYSTEM_MODULE_CODE_INVALID_PARAMETER;
+    }
+
+    *isConnected = s_isCoreInit;
+
+    return DJI_ERROR_SYSTEM_MODULE_CODE_SUCCESS;
+}
+
+T_DjiReturnCode DjiAircraftInfo_GetAircraftVersion(T_DjiAircraftVersion *aircraftVersion)
+{
+    if (aircraftVersion == NULL) {
+        return DJI_ERROR_SYSTEM_MODULE_CODE_INVALID_PARAMETER;
+    }
+
+    aircraftVersion->majorVersion = 1;
+    aircraftVersion->minorVersion = 0;
+    aircraftVersion->modifyVersion = 0;
+    aircraftVersion->debugVersion = 0;
+
+    return DJI_ERROR_SYSTEM_MODULE_CODE_SUCCESS;
+}
+
+T_DjiReturnCode DjiAircraftInfo_GetEnhancedTransmission(E_DjiEnhancedTransmissionState *state)
+{
+    if (state == NULL) {
+        return DJI_ERROR_SYSTEM_MODULE_CODE_INVALID_PARAMETER;
+    }
+
+    *state = DJI_ENHANCEED_TRANSMISSION_STATE_DISABLED;
+
+    return DJI_ERROR_SYSTEM_MODULE_CODE_SUCCESS;
+}
+
+T_DjiReturnCode DjiFile_Delete(const char *filePath)
+{
+    if (filePath == NULL) {
+        return DJI_ERROR_SYSTEM_MODULE_CODE_INVALID_PARAMETER;
+    }
+
+    if (remove(filePath) != 0) {
+        return DJI_ERROR_SYSTEM_MODULE_CODE_SYSTEM_ERROR;
+    }
+
+    return DJI_ERROR_SYSTEM_MODULE_CODE_SUCCESS;
+}
+
+/* Private functions definition-----------------------------------------------*/
+static void DjiMock_ApplyEnvironment(T_DjiMockConfig *config)
+{
+    const char *value;
+
+    config->aircraftType = (E_DjiAircraftType) DjiMock_GetEnvUint(DJI_MOCK_ENV_AIRCRAFT_TYPE,
+                                                                  config->aircraftType);
+    config->mountPosition = (E_DjiMountPosition) DjiMock_GetEnvUint(DJI_MOCK_ENV_MOUNT_POSITION,
+                                                                    config->mountPosition);
+
+    value = getenv(DJI_MOCK_ENV_FC_REPLAY_FILE);
+    if (value != NULL && value[0] != '\0') {
+        config->fcReplayFile = value;
+    }
+    value = getenv(DJI_MOCK_ENV_LIVEVIEW_FILE);
+    if (value != NULL && value[0] != '\0') {
+        config->liveviewFile = value;
+    }
+
+    config->liveviewFps = DjiMock_GetEnvUint(DJI_MOCK_ENV_LIVEVIEW_FPS, config->liveviewFps);
+    config->liveviewBitrateKbps = DjiMock_GetEnvUint(DJI_MOCK_ENV_LIVEVIEW_BITRATE_KBPS, config->liveviewBitrateKbps);
+    config->liveviewImageWidth = DjiMock_GetEnvUint(DJI_MOCK_ENV_LIVEVIEW_IMAGE_WIDTH, config->liveviewImageWidth);
+    config->liveviewImageHeight = DjiMock_GetEnvUint(DJI_MOCK_ENV_LIVEVIEW_IMAGE_HEIGHT, config->liveviewImageHeight);
+    config->perceptionFps = DjiMock_GetEnvUint(DJI_MOCK_ENV_PERCEPTION_FPS, config->perceptionFps);
+    config->perceptionImageWidth = DjiMock_GetEnvUint(DJI_MOCK_ENV_PERCEPTION_IMAGE_WIDTH,
+                                                      config->perceptionImageWidth);
+    config->perceptionImageHeight = DjiMock_GetEnvUint(DJI_MOCK_ENV_PERCEPTION_IMAGE_HEIGHT,
+                                                       config->perceptionImageHeight);
+    config->videoStreamBandwidthKbps = DjiMock_GetEnvUint(DJI_MOCK_ENV_VIDEO_BANDWIDTH_KBPS,
+                                                          config->videoStreamBandwidthKbps);
+    config->mopBandwidthKbps = DjiMock_GetEnvUint(DJI_MOCK_ENV_MOP_BANDWIDTH_KBPS, config->mopBandwidthKbps);
+    config->mediaFileCount = DjiMock_GetEnvUint(DJI_MOCK_ENV_MEDIA_FILE_COUNT, config->mediaFileCount);
+    config->mediaFileSize = DjiMock_GetEnvUint(DJI_MOCK_ENV_MEDIA_FILE_SIZE, config->mediaFileSize);
+    config->mediaDownloadBandwidthKbps = DjiMock_GetEnvUint(DJI_MOCK_ENV_MEDIA_DOWNLOAD_BANDWIDTH_KBPS,
+                                                            config->mediaDownloadBandwidthKbps);
+    config->cameraStatePollFreq = DjiMock_GetEnvUint(DJI_MOCK_ENV_CAMERA_STATE_POLL_FREQ,
+                                                     config->cameraStatePollFreq);
+    config->reportIntervalMs = DjiMock_GetEnvUint(DJI_MOCK_ENV_REPORT_INTERVAL_MS, config->reportIntervalMs);
+
+    value = getenv(DJI_MOCK_ENV_MOP_PEER_MODE);
+    if (value != NULL) {
+        if (strcmp(value, "echo") == 0) {
+            config->mopPeerMode = DJI_MOCK_MOP_PEER_MODE_ECHO;
+        } else if (strcmp(value, "sink") == 0) {
+            config->mopPeerMode = DJI_MOCK_MOP_PEER_MODE_SINK;
+        } else if (strcmp(value, "source") == 0) {
+            config->mopPeerMode = DJI_MOCK_MOP_PEER_MODE_SOURCE;
+        } else {
+            USER_LOG_WARN("[mock] Unknown mop peer mode %s, use echo, sink or source.", value);
+        }
+    }
+}
+
+static uint32_t DjiMock_GetEnvUint(const char *name, uint32_t defaultValue)
+{
+    const char *value = getenv(name);
+    char *end = NULL;
+    unsigned long result;
+
+    if (value == NULL || value[0] == '\0') {
+        return defaultValue;
+    }
+
+    result = strtoul(value, &end, 0);
+    if (end == NULL || *end != '\0') {
+        USER_LOG_WARN("[mock] Invalid value %s of %s, keep %u.", value, name, defaultValue);
+        return defaultValue;
+    }
+
+    return (uint32_t) result;
+}
+
+static void *DjiMock_ReportTask(void *arg)
+{
+    uint64_t nextReportUs = DjiMock_GetTimeUs();
+    uint64_t nowUs;
+
+    DJI_MOCK_UNUSED(arg);
+
+    while (s_isReportRunning) {
+        // sleep in short slices, so deinit does not wait for a whole report interval
+        nowUs = DjiMock_GetTimeUs();
+        if (nowUs < nextReportUs + (uint64_t) s_mockConfig.reportIntervalMs * 1000) {
+            DjiMock_SleepUntilUs(DJI_MOCK_MIN(nowUs + 100000,
+                                              nextReportUs + (uint64_t) s_mockConfig.reportIntervalMs * 1000));
+            continue;
+        }
+
+        nextReportUs += (uint64_t) s_mockConfig.reportIntervalMs * 1000;
+        DjiMock_StreamReport();
+    }
+
+    return NULL;
+}
+
+/****************** (C) COPYRIGHT DJI Innovations *****END OF FILE****/
@@ -0,0 +1,775 @@
+/**
+ ********************************************************************
+ * @file    dji_mock_fc_subscription.c
+ * @brief   Flight controller data subscription of the mock runtime, pushing a synthetic flight or a recording.
+ *
+ * @copyright (c) 2021 DJI. All rights reserved.
+ *
+ * All information contained herein is, and remains, the property of DJI.
+ * The intellectual and technical concepts contained herein are proprietary
+ * to DJI and may be covered by U.S. and foreign patents, patents in process,
+ * and protected by trade secret or copyright law.  Dissemination of this
+ * information, including but not limited to data and other proprietary
+ * material(s) incorporated within the information, in any form, is strictly
+ * prohibited without the express written consent of DJI.
+ *
+ * If you receive this source code without DJI’s authorization, you may not
+ * further disseminate the information, and you must immediately remove the
+ * source code and notify DJI of its removal. DJI reserves the right to pursue
+ * legal actions against you for any loss(es) or damage(s) caused by your
+ * failure to do so.
+ *
+ *********************************************************************
+ */
+
+/* Includes ------------------------------------------------------------------*/
+#include <math.h>
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include "dji_mock_internal.h"
+#include "dji_fc_subscription.h"
+
+/* Private constants ---------------------------------------------------------*/
+#define DJI_MOCK_FC_TOPIC_CODE_NUM              (DJI_DATA_SUBSCRIPTION_TOPIC_GET_CODE(DJI_FC_SUBSCRIPTION_TOPIC_TOTAL_NUMBER))
+#define DJI_MOCK_FC_TOPIC_DATA_MAX_SIZE         (256)
+#define DJI_MOCK_FC_IDLE_SLEEP_US               (10000)
+
+#define DJI_MOCK_FC_PI                          (3.14159265358979323846)
+#define DJI_MOCK_FC_EARTH_RADIUS                (6378137.0)
+#define DJI_MOCK_FC_HOME_LATITUDE_DEG           (22.5431)
+#define DJI_MOCK_FC_HOME_LONGITUDE_DEG          (113.9365)
+#define DJI_MOCK_FC_HOME_ALTITUDE               (50.0f)
+#define DJI_MOCK_FC_CIRCLE_RADIUS               (50.0)
+#define DJI_MOCK_FC_CIRCLE_SPEED                (5.0)
+#define DJI_MOCK_FC_FLIGHT_HEIGHT               (100.0)
+#define DJI_MOCK_FC_BATTERY_LIFE_S              (1800.0)
+
+/* Private types -------------------------------------------------------------*/
+typedef struct {
+    bool isSubscribed;
+    E_DjiFcSubscriptionTopic topic;
+    uint32_t periodUs;
+    uint64_t nextDeadlineUs;
+    DjiReceiveDataOfTopicCallback callback;
+    uint16_t dataSize;
+    uint8_t data[DJI_MOCK_FC_TOPIC_DATA_MAX_SIZE];
+    T_DjiDataTimestamp timestamp;
+    uint32_t replayCursor;
+} T_DjiMockFcTopic;
+
+typedef struct {
+    uint64_t timestampUs;
+    uint16_t dataSize;
+    const uint8_t *data;
+} T_DjiMockFcReplayRecord;
+
+typedef struct {
+    T_DjiMockFcReplayRecord *recordList;
+    uint32_t recordCount;
+} T_DjiMockFcReplayTopic;
+
+typedef struct {
+    E_DjiFcSubscriptionTopic topic;
+    DjiReceiveDataOfTopicCallback callback;
+    uint16_t dataSize;
+    uint8_t data[DJI_MOCK_FC_TOPIC_DATA_MAX_SIZE];
+    T_DjiDataTimestamp timestamp;
+} T_DjiMockFcPush;
+
+/* Private functions declaration ---------------------------------------------*/
+static uint16_t DjiMock_FcGetTopicSize(uint32_t code);
+static uint32_t DjiMock_FcFrequencyToHz(E_DjiDataSubscriptionTopicFreq frequency);
+static void DjiMock_FcUpdateTopic(T_DjiMockFcTopic *topic, uint64_t nowUs);
+static void DjiMock_FcGenerateSynthetic(uint32_t code, uint8_t *data, double flightTime);
+static T_DjiReturnCode DjiMock_FcLoadReplay(const char *path);
+static void DjiMock_FcFreeReplay(void);
+static void *DjiMock_FcSubscriptionTask(void *arg);
+
+/* Private values -------------------------------------------------------------*/
+static pthread_mutex_t s_fcMutex = PTHREAD_MUTEX_INITIALIZER;
+static pthread_t s_fcThread;
+static bool s_isFcInit = false;
+static bool s_isFcRunning = false;
+static uint64_t s_fcStartTimeUs = 0;
+static T_DjiMockFcTopic s_fcTopicList[DJI_MOCK_FC_TOPIC_CODE_NUM];
+static T_DjiMockStream s_fcStream;
+static bool s_isCode48ImuAtti = false;
+
+static uint8_t *s_fcReplayBuffer = NULL;
+static T_DjiMockFcReplayTopic s_fcReplayTopicList[DJI_MOCK_FC_TOPIC_CODE_NUM];
+static uint64_t s_fcReplayDurationUs = 0;
+
+/* Exported functions definition ---------------------------------------------*/
+T_DjiReturnCode DjiFcSubscription_Init(void)
+{
+    const T_DjiMockConfig *config = DjiMock_GetConfig();
+    T_DjiReturnCode returnCode;
+
+    returnCode = DjiMock_CheckInit();
+    if (returnCode != DJI_ERROR_SYSTEM_MODULE_CODE_SUCCESS) {
+        return returnCode;
+    }
+
+    if (s_isFcInit) {
+        return DJI_ERROR_SYSTEM_MODULE_CODE_SUCCESS;
+    }
+
+    // code 48 is the imu attitude on M300 series and the gimbal angles of the first payload on newer aircraft
+    s_isCode48ImuAtti = config->aircraftType == DJI_AIRCRAFT_TYPE_M300_RTK ||
+                        config->aircraftType == DJI_AIRCRAFT_TYPE_M350_RTK;
+
+    if (config->fcReplayFile != NULL) {
+        returnCode = DjiMock_FcLoadReplay(config->fcReplayFile);
+        if (returnCode != DJI_ERROR_SYSTEM_MODULE_CODE_SUCCESS) {
+            return returnCode;
+        }
+    }
+
+    memset(s_fcTopicList, 0, sizeof(s_fcTopicList));
+    DjiMock_StreamInit(&s_fcStream, "fc_subscription", 0);
+    s_fcStartTimeUs = DjiMock_GetTimeUs();
+
+    s_isFcRunning = true;
+    if (pthread_create(&s_fcThread, NULL, DjiMock_FcSubscriptionTask, NULL) != 0) {
+        s_isFcRunning = false;
+        DjiMock_FcFreeReplay();
+        return DJI_ERROR_SYSTEM_MODULE_CODE_SYSTEM_ERROR;
+    }
+
+    s_isFcInit = true;
+
+    return DJI_ERROR_SYSTEM_MODULE_CODE_SUCCESS;
+}
+
+T_DjiReturnCode DjiFcSubscription_DeInit(void)
+{
+    if (!s_isFcInit) {
+        return DJI_ERROR_SYSTEM_MODULE_CODE_SUCCESS;
+    }
+
+    s_isFcRunning = false;
+    pthread_join(s_fcThread, NULL);
+
+    pthread_mutex_lock(&s_fcMutex);
+    memset(s_fcTopicList, 0, sizeof(s_fcTopicList));
+    pthread_mutex_unlock(&s_fcMutex);
+
+    DjiMock_FcFreeReplay();
+    s_isFcInit = false;
+
+    return DJI_ERROR_SYSTEM_MODULE_CODE_SUCCESS;
+}
+
+T_DjiReturnCode DjiFcSubscription_SubscribeTopic(E_DjiFcSubscriptionTopic topic,
+                                                 E_DjiDataSubscriptionTopicFreq frequency,
+                                                 DjiReceiveDataOfTopicCallback callback)
+{
+    uint32_t code = DJI_DATA_SUBSCRIPTION_TOPIC_GET_CODE(topic);
+    uint32_t frequencyHz = DjiMock_FcFrequencyToHz(frequency);
+    T_DjiMockFcTopic *fcTopic;
+
+    if (!s_isFcInit) {
+        return DJI_ERROR_SYSTEM_MODULE_CODE_NONSUPPORT_IN_CURRENT_STATE;
+    }
+
+    if (code >= DJI_MOCK_FC_TOPIC_CODE_NUM) {
+        return DJI_ERROR_SUBSCRIPTION_MODULE_CODE_TOPIC_NOT_SUPPORTED;
+    }
+
+    if (frequencyHz == 0) {
+        return DJI_ERROR_SUBSCRIPTION_MODULE_CODE_INVALID_TOPIC_FREQ;
+    }
+
+    pthread_mutex_lock(&s_fcMutex);
+    fcTopic = &s_fcTopicList[code];
+    if (fcTopic->isSubscribed) {
+        pthread_mutex_unlock(&s_fcMutex);
+        return DJI_ERROR_SUBSCRIPTION_MODULE_CODE_TOPIC_DUPLICATE;
+    }
+
+    memset(fcTopic, 0, sizeof(T_DjiMockFcTopic));
+    fcTopic->topic = topic;
+    fcTopic->periodUs = 1000000 / frequencyHz;
+    fcTopic->callback = callback;
+    fcTopic->dataSize = DjiMock_FcGetTopicSize(code);
+    DjiMock_FcUpdateTopic(fcTopic, DjiMock_GetTimeUs());
+    fcTopic->nextDeadlineUs = DjiMock_GetTimeUs() + fcTopic->periodUs;
+    fcTopic->isSubscribed = true;
+    pthread_mutex_unlock(&s_fcMutex);
+
+    return DJI_ERROR_SYSTEM_MODULE_CODE_SUCCESS;
+}
+
+T_DjiReturnCode DjiFcSubscription_UnSubscribeTopic(E_DjiFcSubscriptionTopic topic)
+{
+    uint32_t code = DJI_DATA_SUBSCRIPTION_TOPIC_GET_CODE(topic);
+
+    if (!s_isFcInit) {
+        return DJI_ERROR_SYSTEM_MODULE_CODE_NONSUPPORT_IN_CURRENT_STATE;
+    }
+
+    if (code >= DJI_MOCK_FC_TOPIC_CODE_NUM) {
+        return DJI_ERROR_SUBSCRIPTION_MODULE_CODE_TOPIC_NOT_SUPPORTED;
+    }
+
+    pthread_mutex_lock(&s_fcMutex);
+    if (!s_fcTopicList[code].isSubscribed) {
+        pthread_mutex_unlock(&s_fcMutex);
+        return DJI_ERROR_SUBSCRIPTION_MODULE_CODE_TOPIC_NOT_SUBSCRIBED;
+    }
+    s_fcTopicList[code].isSubscribed = false;
+    pthread_mutex_unlock(&s_fcMutex);
+
+    return DJI_ERROR_SYSTEM_MODULE_CODE_SUCCESS;
+}
+
+T_DjiReturnCode DjiFcSubscription_GetLatestValueOfTopic(E_DjiFcSubscriptionTopic topic,
+                                                        uint8_t *data, uint16_t dataSizeOfTopic,
+                                                        T_DjiDataTimestamp *timestamp)
+{
+    uint32_t code = DJI_DATA_SUBSCRIPTION_TOPIC_GET_CODE(topic);
+    T_DjiMockFcTopic *fcTopic;
+
+    if (data == NULL) {
+        return DJI_ERROR_SYSTEM_MODULE_CODE_INVALID_PARAMETER;
+    }
+
+    if (!s_isFcInit) {
+        return DJI_ERROR_SYSTEM_MODULE_CODE_NONSUPPORT_IN_CURRENT_STATE;
+    }
+
+    if (code >= DJI_MOCK_FC_TOPIC_CODE_NUM) {
+        return DJI_ERROR_SUBSCRIPTION_MODULE_CODE_TOPIC_NOT_SUPPORTED;
+    }
+
+    pthread_mutex_lock(&s_fcMutex);
+    fcTopic = &s_fcTopicList[code];
+    if (!fcTopic->isSubscribed) {
+        pthread_mutex_unlock(&s_fcMutex);
+        return DJI_ERROR_SUBSCRIPTION_MODULE_CODE_TOPIC_NOT_SUBSCRIBED;
+    }
+
+    if (dataSizeOfTopic != fcTopic->dataSize) {
+        pthread_mutex_unlock(&s_fcMutex);
+        USER_LOG_WARN("[mock] Size %d of topic code %d does not match %d.", dataSizeOfTopic, code,
+                      fcTopic->dataSize);
+        return DJI_ERROR_SYSTEM_MODULE_CODE_INVALID_PARAMETER;
+    }
+
+    memcpy(data, fcTopic->data, fcTopic->dataSize);
+    if (timestamp != NULL) {
+        *timestamp = fcTopic->timestamp;
+    }
+    pthread_mutex_unlock(&s_fcMutex);
+
+    return DJI_ERROR_SYSTEM_MODULE_CODE_SUCCESS;
+}
+
+/* Private functions definition-----------------------------------------------*/
+static uint16_t DjiMock_FcGetTopicSize(uint32_t code)
+{
+    switch (code) {
+        case 0:
+            return sizeof(T_DjiFcSubscriptionQuaternion);
+        case 1:
+        case 2:
+        case 3:
+        case 5:
+        case 6:
+        case 16:
+        case 20:
+        case 26:
+            return sizeof(T_DjiVector3f);
+        case 4:
+            return sizeof(T_DjiFcSubscriptionVelocity);
+        case 7:
+        case 8:
+        case 9:
+        case 10:
+        case 11:
+            return sizeof(dji_f32_t);
+        case 12:
+            return sizeof(T_DjiFcSubscriptionPositionFused);
+        case 13:
+        case 14:
+            return sizeof(uint32_t);
+        case 15:
+            return sizeof(T_DjiFcSubscriptionGpsPosition);
+        case 17:
+            return sizeof(T_DjiFcSubscriptionGpsDetails);
+        case 19:
+            return sizeof(T_DjiFcSubscriptionRtkPosition);
+        case 21:
+            return sizeof(T_DjiFcSubscriptionRtkYaw);
+        case 24:
+            return sizeof(T_DjiFcSubscriptionCompass);
+        case 25:
+            return sizeof(T_DjiFcSubscriptionRC);
+        case 27:
+            return sizeof(T_DjiFcSubscriptionGimbalStatus);
+        case 31:
+            return sizeof(T_DjiFcSubscriptionMotorStartError);
+        case 32:
+            return sizeof(T_DjiFcSubscriptionWholeBatteryInfo);
+        case 33:
+            return sizeof(T_DjiFcSubscriptionControlDevice);
+        case 34:
+            return sizeof(T_DjiFcSubscriptionHardSync);
+        case 36:
+            return sizeof(T_DjiFcSubscriptionRCWithFlagData);
+        case 37:
+            return sizeof(T_DjiFcSubscriptionEscData);
+        case 38:
+            return sizeof(T_DjiFcSubscriptionRTKConnectStatus);
+        case 40:
+            return sizeof(T_DjiFcSubscriptionFlightAnomaly);
+        case 41:
+            return sizeof(T_DjiFcSubscriptionPositionVO);
+        case 42:
+            return sizeof(T_DjiFcSubscriptionAvoidData);
+        case 44:
+            return sizeof(T_DjiFcSubscriptionHomePointInfo);
+        case 45:
+            return sizeof(T_DjiFcSubscriptionThreeGimbalData);
+        case 46:
+        case 47:
+            return sizeof(T_DjiFcSubscriptionSingleBatteryInfo);
+        case 48:
+            return s_isCode48ImuAtti ? sizeof(T_DjiFcSubscriptionImuAttiNaviDataWithTimestamp) :
+                   sizeof(T_DjiFcSubscriptionGimbalAngles);
+        case 49:
+        case 50:
+        case 51:
+        case 52:
+        case 53:
+        case 54:
+            return sizeof(T_DjiFcSubscriptionGimbalAngles);
+        default:
+            return sizeof(uint8_t);
+    }
+}
+
+static uint32_t DjiMock_FcFrequencyToHz(E_DjiDataSubscriptionTopicFreq frequency)
+{
+    switch (frequency) {
+        case DJI_DATA_SUBSCRIPTION_TOPIC_1_HZ:
+        case DJI_DATA_SUBSCRIPTION_TOPIC_5_HZ:
+        case DJI_DATA_SUBSCRIPTION_TOPIC_10_HZ:
+        case DJI_DATA_SUBSCRIPTION_TOPIC_50_HZ:
+        case DJI_DATA_SUBSCRIPTION_TOPIC_100_HZ:
+        case DJI_DATA_SUBSCRIPTION_TOPIC_200_HZ:
+        case DJI_DATA_SUBSCRIPTION_TOPIC_400_HZ:
+            return (uint32_t) frequency;
+        default:
+            return 0;
+    }
+}
+
+static void DjiMock_FcUpdateTopic(T_DjiMockFcTopic *topic, uint64_t nowUs)
+{
+    uint32_t code = DJI_DATA_SUBSCRIPTION_TOPIC_GET_CODE(topic->topic);
+    uint64_t elapsedUs = nowUs - s_fcStartTimeUs;
+    T_DjiMockFcReplayTopic *replayTopic = &s_fcReplayTopicList[code];
+    uint64_t replayTimeUs;
+
+    topic->timestamp.millisecond = (uint32_t) (elapsedUs / 1000);
+    topic->timestamp.microsecond = (uint32_t) elapsedUs;
+
+    if (replayTopic->recordCount == 0) {
+        memset(topic->data, 0, topic->dataSize);
+        DjiMock_FcGenerateSynthetic(code, topic->data, elapsedUs / 1000000.0);
+        return;
+    }
+
+    replayTimeUs = elapsedUs % s_fcReplayDurationUs;
+    if (replayTopic->recordList[topic->replayCursor].timestampUs > replayTimeUs) {
+        topic->replayCursor = 0;
+    }
+    while (topic->replayCursor + 1 < replayTopic->recordCount &&
+           replayTopic->recordList[topic->replayCursor + 1].timestampUs <= replayTimeUs) {
+        topic->replayCursor++;
+    }
+    memcpy(topic->data, replayTopic->recordList[topic->replayCursor].data, topic->dataSize);
+}
+
+static void DjiMock_FcGenerateSynthetic(uint32_t code, uint8_t *data, double flightTime)
+{
+    const double omega = DJI_MOCK_FC_CIRCLE_SPEED / DJI_MOCK_FC_CIRCLE_RADIUS;
+    const double theta = omega * flightTime;
+    const double homeLatitude = DJI_MOCK_FC_HOME_LATITUDE_DEG * DJI_MOCK_FC_PI / 180.0;
+    const double homeLongitude = DJI_MOCK_FC_HOME_LONGITUDE_DEG * DJI_MOCK_FC_PI / 180.0;
+    const double north = DJI_MOCK_FC_CIRCLE_RADIUS * cos(theta);
+    const double east = DJI_MOCK_FC_CIRCLE_RADIUS * sin(theta);
+    const double velocityNorth = -DJI_MOCK_FC_CIRCLE_SPEED * sin(theta);
+    const double velocityEast = DJI_MOCK_FC_CIRCLE_SPEED * cos(theta);
+    const double height = DJI_MOCK_FC_FLIGHT_HEIGHT + 2.0 * sin(0.2 * flightTime);
+    const double velocityUp = 0.4 * cos(0.2 * flightTime);
+    const double centripetal = DJI_MOCK_FC_CIRCLE_SPEED * omega;
+    const double yaw = atan2(velocityEast, velocityNorth);
+    const double roll = atan(centripetal / 9.80665);
+    const double latitude = homeLatitude + north / DJI_MOCK_FC_EARTH_RADIUS;
+    const double longitude = homeLongitude + east / (DJI_MOCK_FC_EARTH_RADIUS * cos(homeLatitude));
+    const double battery = DJI_MOCK_MAX(0.0, 1.0 - flightTime / DJI_MOCK_FC_BATTERY_LIFE_S);
+    const float gimbalPitch = (float) (-30.0 + 10.0 * sin(0.1 * flightTime));
+    const float gimbalYaw = (float) (yaw * 180.0 / DJI_MOCK_FC_PI);
+    time_t wallTime = time(NULL);
+    struct tm utcTime;
+
+    switch (code) {
+        case 0: {
+            T_DjiFcSubscriptionQuaternion *quaternion = (T_DjiFcSubscriptionQuaternion *) data;
+            // yaw then roll, hamilton convention
+            quaternion->q0 = (float) (cos(yaw / 2) * cos(roll / 2));
+            quaternion->q1 = (float) (cos(yaw / 2) * sin(roll / 2));
+            quaternion->q2 = (float) (sin(yaw / 2) * sin(roll / 2));
+            quaternion->q3 = (float) (sin(yaw / 2) * cos(roll / 2));
+            break;
+        }
+        case 1:
+        case 2:
+        case 3: {
+            T_DjiVector3f *acceleration = (T_DjiVector3f *) data;
+            if (code == 1) {
+                acceleration->x = (float) (-centripetal * cos(theta));
+                acceleration->y = (float) (-centripetal * sin(theta));
+            } else {
+                acceleration->y = (float) centripetal;
+                acceleration->z = code == 3 ? -9.80665f : 0.0f;
+            }
+            break;
+        }
+        case 4: {
+            T_DjiFcSubscriptionVelocity *velocity = (T_DjiFcSubscriptionVelocity *) data;
+            // north, east, up
+            velocity->data.x = (float) velocityNorth;
+            velocity->data.y = (float) velocityEast;
+            velocity->data.z = (float) velocityUp;
+            velocity->health = 1;
+            break;
+        }
+        case 5:
+        case 6:
+            ((T_DjiVector3f *) data)->z = (float) omega;
+            break;
+        case 7:
+        case 8:
+            *(dji_f32_t *) data = (float) (DJI_MOCK_FC_HOME_ALTITUDE + height);
+            break;
+        case 9:
+            *(dji_f32_t *) data = DJI_MOCK_FC_HOME_ALTITUDE;
+            break;
+        case 10:
+        case 11:
+            *(dji_f32_t *) data = (float) height;
+            break;
+        case 12: {
+            T_DjiFcSubscriptionPositionFused *position = (T_DjiFcSubscriptionPositionFused *) data;
+            position->latitude = latitude;
+            position->longitude = longitude;
+            position->altitude = (float) (DJI_MOCK_FC_HOME_ALTITUDE + height);
+            position->visibleSatelliteNumber = 24;
+            break;
+        }
+        case 13:
+            gmtime_r(&wallTime, &utcTime);
+            *(uint32_t *) data = (uint32_t) ((utcTime.tm_year + 1900) * 10000 + (utcTime.tm_mon + 1) * 100 +
+                                             utcTime.tm_mday);
+            break;
+        case 14:
+            gmtime_r(&wallTime, &utcTime);
+            *(uint32_t *) data = (uint32_t) (utcTime.tm_hour * 10000 + utcTime.tm_min * 100 + utcTime.tm_sec);
+            break;
+        case 15: {
+            T_DjiFcSubscriptionGpsPosition *position = (T_DjiFcSubscriptionGpsPosition *) data;
+            position->x = (int32_t) (longitude * 180.0 / DJI_MOCK_FC_PI * 1e7);
+            position->y = (int32_t) (latitude * 180.0 / DJI_MOCK_FC_PI * 1e7);
+            position->z = (int32_t) ((DJI_MOCK_FC_HOME_ALTITUDE + height) * 1000);
+            break;
+        }
+        case 16:
+        case 20: {
+            T_DjiVector3f *velocity = (T_DjiVector3f *) data;
+            velocity->x = (float) (velocityNorth * 100);
+            velocity->y = (float) (velocityEast * 100);
+            velocity->z = (float) (velocityUp * 100);
+            break;
+        }
+        case 17: {
+            T_DjiFcSubscriptionGpsDetails *details = (T_DjiFcSubscriptionGpsDetails *) data;
+            details->hdop = 80;
+            details->pdop = 120;
+            details->fixState = 3;
+            details->vacc = 1500;
+            details->hacc = 800;
+            details->sacc = 20;
+            details->gpsSatelliteNumberUsed = 14;
+            details->glonassSatelliteNumberUsed = 10;
+            details->totalSatelliteNumberUsed = 24;
+            details->gpsCounter = (uint16_t) (flightTime * 5);
+            break;
+        }
+        case 18:
+            *data = 5;
+            break;
+        case 19: {
+            T_DjiFcSubscriptionRtkPosition *position = (T_DjiFcSubscriptionRtkPosition *) data;
+            position->latitude = latitude * 180.0 / DJI_MOCK_FC_PI;
+            position->longitude = longitude * 180.0 / DJI_MOCK_FC_PI;
+            position->hfsl = (float) (DJI_MOCK_FC_HOME_ALTITUDE + height);
+            break;
+        }
+        case 21:
+            *(int16_t *) data = (int16_t) gimbalYaw;
+            break;
+        case 22:
+        case 23:
+            *data = 50;
+            break;
+        case 24: {
+            T_DjiFcSubscriptionCompass *compass = (T_DjiFcSubscriptionCompass *) data;
+            compass->x = (int16_t) (1500 * cos(yaw));
+            compass->y = (int16_t) (-1500 * sin(yaw));
+            compass->z = 400;
+            break;
+        }
+        case 26:
+        case 48:
+        case 49:
+        case 50:
+        case 51:
+        case 52:
+        case 53:
+        case 54: {
+            if (code == 48 && s_isCode48ImuAtti) {
+                T_DjiFcSubscriptionImuAttiNaviDataWithTimestamp *imu =
+                    (T_DjiFcSubscriptionImuAttiNaviDataWithTimestamp *) data;
+                imu->pn_x = (float) north;
+                imu->pn_y = (float) east;
+                imu->pn_z = (float) -height;
+                imu->vn_x = (float) velocityNorth;
+                imu->vn_y = (float) velocityEast;
+                imu->vn_z = (float) -velocityUp;
+                imu->an_x = (float) (-centripetal * cos(theta));
+                imu->an_y = (float) (-centripetal * sin(theta));
+                imu->q[0] = (float) (cos(yaw / 2) * cos(roll / 2));
+                imu->q[1] = (float) (cos(yaw / 2) * sin(roll / 2));
+                imu->q[2] = (float) (sin(yaw / 2) * sin(roll / 2));
+                imu->q[3] = (float) (sin(yaw / 2) * cos(roll / 2));
+                imu->cnt = (uint16_t) (flightTime * 50);
+                imu->timestamp = (uint32_t) (flightTime * 1000);
+            } else {
+                T_DjiFcSubscriptionGimbalAngles *angles = (T_DjiFcSubscriptionGimbalAngles *) data;
+                // x pitch, y roll, z yaw, unit: degree
+                angles->x = gimbalPitch;
+                angles->z = gimbalYaw;
+            }
+            break;
+        }
+        case 28:
+            *data = DJI_FC_SUBSCRIPTION_FLIGHT_STATUS_IN_AIR;
+            break;
+        case 29:
+            *data = DJI_FC_SUBSCRIPTION_DISPLAY_MODE_P_GPS;
+            break;
+        case 32: {
+            T_DjiFcSubscriptionWholeBatteryInfo *batteryInfo = (T_DjiFcSubscriptionWholeBatteryInfo *) data;
+            batteryInfo->capacity = (uint32_t) (5935 * battery);
+            batteryInfo->voltage = (int32_t) (44400 + 8000 * battery);
+            batteryInfo->current = -18000;
+            batteryInfo->percentage = (uint8_t) (100 * battery);
+            break;
+        }
+        case 35:
+            *data = 5;
+            break;
+        case 43:
+            *data = 1;
+            break;
+        case 44: {
+            T_DjiFcSubscriptionHomePointInfo *homePoint = (T_DjiFcSubscriptionHomePointInfo *) data;
+            homePoint->latitude = homeLatitude;
+            homePoint->longitude = homeLongitude;
+            break;
+        }
+        case 45: {
+            T_DjiFcSubscriptionThreeGimbalData *gimbalData = (T_DjiFcSubscriptionThreeGimbalData *) data;
+            gimbalData->anglesData[0].pitch = gimbalPitch;
+            gimbalData->anglesData[0].yaw = gimbalYaw;
+            break;
+        }
+        default:
+            break;
+    }
+}
+
+static T_DjiReturnCode DjiMock_FcLoadReplay(const char *path)
+{
+    FILE *file;
+    long fileSize;
+    uint32_t offset = 0;
+    uint32_t code;
+    uint32_t count[DJI_MOCK_FC_TOPIC_CODE_NUM] = {0};
+    uint32_t skipCount = 0;
+    uint32_t recordCount = 0;
+    T_DjiMockFcReplayRecordHeader header;
+    T_DjiMockFcReplayTopic *replayTopic;
+
+    file = fopen(path, "rb");
+    if (file == NULL) {
+        USER_LOG_ERROR("[mock] Open flight controller replay file %s failed.", path);
+        return DJI_ERROR_SYSTEM_MODULE_CODE_NOT_FOUND;
+    }
+
+    fseek(file, 0, SEEK_END);
+    fileSize = ftell(file);
+    fseek(file, 0, SEEK_SET);
+    if (fileSize <= 0) {
+        fclose(file);
+        return DJI_ERROR_SYSTEM_MODULE_CODE_INVALID_PARAMETER;
+    }
+
+    s_fcReplayBuffer = malloc((size_t) fileSize);
+    if (s_fcReplayBuffer == NULL) {
+        fclose(file);
+        return DJI_ERROR_SYSTEM_MODULE_CODE_MEMORY_ALLOC_FAILED;
+    }
+    if (fread(s_fcReplayBuffer, 1, (size_t) fileSize, file) != (size_t) fileSize) {
+        fclose(file);
+        DjiMock_FcFreeReplay();
+        return DJI_ERROR_SYSTEM_MODULE_CODE_SYSTEM_ERROR;
+    }
+    fclose(file);
+
+    // first pass counts the records of every topic, second pass fills the index
+    for (int pass = 0; pass < 2; pass++) {
+        offset = 0;
+        while (offset + sizeof(header) <= (uint32_t) fileSize) {
+            memcpy(&header, s_fcReplayBuffer + offset, sizeof(header));
+            offset += sizeof(header);
+            if (offset + header.dataSize > (uint32_t) fileSize) {
+                break;
+            }
+
+            code = DJI_DATA_SUBSCRIPTION_TOPIC_GET_CODE(header.topic);
+            if (code < DJI_MOCK_FC_TOPIC_CODE_NUM && header.dataSize == DjiMock_FcGetTopicSize(code)) {
+                replayTopic = &s_fcReplayTopicList[code];
+                if (pass == 0) {
+                    count[code]++;
+                    recordCount++;
+                } else {
+                    replayTopic->recordList[replayTopic->recordCount].timestampUs = header.timestampUs;
+                    replayTopic->recordList[replayTopic->recordCount].dataSize = header.dataSize;
+                    replayTopic->recordList[replayTopic->recordCount].data = s_fcReplayBuffer + offset;
+                    replayTopic->recordCount++;
+                    s_fcReplayDurationUs = DJI_MOCK_MAX(s_fcReplayDurationUs, header.timestampUs + 1);
+                }
+            } else if (pass == 0) {
+                skipCount++;
+            }
+            offset += header.dataSize;
+        }
+
+        if (pass == 0) {
+            for (code = 0; code < DJI_MOCK_FC_TOPIC_CODE_NUM; code++) {
+                if (count[code] == 0) {
+                    continue;
+                }
+                s_fcReplayTopicList[code].recordList = malloc(count[code] * sizeof(T_DjiMockFcReplayRecord));
+                if (s_fcReplayTopicList[code].recordList == NULL) {
+                    DjiMock_FcFreeReplay();
+                    return DJI_ERROR_SYSTEM_MODULE_CODE_MEMORY_ALLOC_FAILED;
+                }
+            }
+        }
+    }
+
+    USER_LOG_INFO("[mock] Replay %u records of %.1f s from %s, %u records skipped.", recordCount,
+                  s_fcReplayDurationUs / 1000000.0, path, skipCount);
+
+    return DJI_ERROR_SYSTEM_MODULE_CODE_SUCCESS;
+}
+
+static void DjiMock_FcFreeReplay(void)
+{
+    uint32_t code;
+
+    for (code = 0; code < DJI_MOCK_FC_TOPIC_CODE_NUM; code++) {
+        free(s_fcReplayTopicList[code].recordList);
+    }
+    memset(s_fcReplayTopicList, 0, sizeof(s_fcReplayTopicList));
+    free(s_fcReplayBuffer);
+    s_fcReplayBuffer = NULL;
+    s_fcReplayDurationUs = 0;
+}
+
+static void *DjiMock_FcSubscriptionTask(void *arg)
+{
+    static T_DjiMockFcPush pushList[DJI_MOCK_FC_TOPIC_CODE_NUM];
+    uint32_t pushCount;
+    uint64_t earliestUs;
+    uint64_t nowUs;
+    uint64_t beginUs;
+    uint32_t code;
+    uint32_t i;
+    T_DjiMockFcTopic *fcTopic;
+
+    DJI_MOCK_UNUSED(arg);
+
+    while (s_isFcRunning) {
+        earliestUs = UINT64_MAX;
+        pthread_mutex_lock(&s_fcMutex);
+        for (code = 0; code < DJI_MOCK_FC_TOPIC_CODE_NUM; code++) {
+            if (s_fcTopicList[code].isSubscribed && s_fcTopicList[code].nextDeadlineUs < earliestUs) {
+                earliestUs = s_fcTopicList[code].nextDeadlineUs;
+            }
+        }
+        pthread_mutex_unlock(&s_fcMutex);
+
+        nowUs = DjiMock_GetTimeUs();
+        if (earliestUs == UINT64_MAX || earliestUs > nowUs + DJI_MOCK_FC_IDLE_SLEEP_US) {
+            DjiMock_SleepUntilUs(DJI_MOCK_MIN(earliestUs, nowUs + DJI_MOCK_FC_IDLE_SLEEP_US));
+            continue;
+        }
+        DjiMock_SleepUntilUs(earliestUs);
+
+        pushCount = 0;
+        nowUs = DjiMock_GetTimeUs();
+        pthread_mutex_lock(&s_fcMutex);
+        for (code = 0; code < DJI_MOCK_FC_TOPIC_CODE_NUM; code++) {
+            fcTopic = &s_fcTopicList[code];
+            if (!fcTopic->isSubscribed || fcTopic->nextDeadlineUs > nowUs) {
+                continue;
+            }
+
+            DjiMock_FcUpdateTopic(fcTopic, nowUs);
+            fcTopic->nextDeadlineUs += fcTopic->periodUs;
+            if (fcTopic->nextDeadlineUs <= nowUs) {
+                DjiMock_StreamRecordLate(&s_fcStream, 1);
+                fcTopic->nextDeadlineUs = nowUs + fcTopic->periodUs;
+            }
+
+            if (fcTopic->callback != NULL) {
+                pushList[pushCount].topic = fcTopic->topic;
+                pushList[pushCount].callback = fcTopic->callback;
+                pushList[pushCount].dataSize = fcTopic->dataSize;
+                pushList[pushCount].timestamp = fcTopic->timestamp;
+                memcpy(pushList[pushCount].data, fcTopic->data, fcTopic->dataSize);
+                pushCount++;
+            }
+        }
+        pthread_mutex_unlock(&s_fcMutex);
+
+        for (i = 0; i < pushCount; i++) {
+            beginUs = DjiMock_GetTimeUs();
+            pushList[i].callback(pushList[i].data, pushList[i].dataSize, &pushList[i].timestamp);
+            DjiMock_StreamRecord(&s_fcStream, pushList[i].dataSize, DjiMock_GetTimeUs() - beginUs);
+        }
+    }
+
+    return NULL;
+}
+
+/****************** (C) COPYRIGHT DJI Innovations *****END OF FILE****/
@@ -0,0 +1,97 @@
+/**
+ ********************************************************************
+ * @file    dji_mock_internal.h
+ * @brief   This is the header file shared by the modules of the mock runtime, defining the structure and
+ * (exported) function prototypes.
+ *
+ * @copyright (c) 2021 DJI. All rights reserved.
+ *
+ * All information contained herein is, and remains, the property of DJI.
+ * The intellectual and technical concepts contained herein are proprietary
+ * to DJI and may be covered by U.S. and foreign patents, patents in process,
+ * and protected by trade secret or copyright law.  Dissemination of this
+ * information, including but not limited to data and other proprietary
+ * material(s) incorporated within the information, in any form, is strictly
+ * prohibited without the express written consent of DJI.
+ *
+ * If you receive this source code without DJI’s authorization, you may not
+ * further disseminate the information, and you must immediately remove the
+ * source code and notify DJI of its removal. DJI reserves the right to pursue
+ * legal actions against you for any loss(es) or damage(s) caused by your
+ * failure to do so.
+ *
+ *********************************************************************
+ */
+
+/* Define to prevent recursive inclusion -------------------------------------*/
+#ifndef DJI_MOCK_INTERNAL_H
+#define DJI_MOCK_INTERNAL_H
+
+/* Includes ------------------------------------------------------------------*/
+#include "dji_mock.h"
+#include "dji_platform.h"
+#include "dji_logger.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Exported constants --------------------------------------------------------*/
+#define DJI_MOCK_TASK_STACK_SIZE            (2048)
+#define DJI_MOCK_UNUSED(x)                  ((x) = (x))
+#define DJI_MOCK_MIN(a, b)                  (((a) < (b)) ? (a) : (b))
+#define DJI_MOCK_MAX(a, b)                  (((a) > (b)) ? (a) : (b))
+
+/* Exported types ------------------------------------------------------------*/
+/**
+ * @brief A paced stream of messages. The deadlines are absolute, so a slow callback makes the following messages
+ * late instead of lowering the rate, and a callback blocking longer than one period drops the missed periods.
+ */
+typedef struct {
+    T_DjiMockStreamStatistics statistics;
+    uint32_t periodUs;
+    uint64_t startTimeUs;
+    uint64_t nextDeadlineUs;
+    uint64_t callbackTimeTotalUs;
+} T_DjiMockStream;
+
+/**
+ * @brief Token bucket emulating the bandwidth of a link, not thread safe.
+ */
+typedef struct {
+    uint32_t bytesPerSecond;
+    uint32_t burstBytes;
+    double tokens;
+    uint64_t lastTimeUs;
+} T_DjiMockLink;
+
+/* Exported functions --------------------------------------------------------*/
+const T_DjiMockConfig *DjiMock_GetConfig(void);
+T_DjiReturnCode DjiMock_CheckInit(void);
+T_DjiReturnCode DjiMock_Unsupported(const char *function);
+
+uint64_t DjiMock_GetTimeUs(void);
+void DjiMock_SleepUntilUs(uint64_t timeUs);
+
+void DjiMock_StreamInit(T_DjiMockStream *stream, const char *name, uint32_t frequency);
+void DjiMock_StreamSetFrequency(T_DjiMockStream *stream, uint32_t frequency);
+void DjiMock_StreamWaitNext(T_DjiMockStream *stream);
+void DjiMock_StreamRecord(T_DjiMockStream *stream, uint32_t bytes, uint64_t callbackTimeUs);
+void DjiMock_StreamRecordDrop(T_DjiMockStream *stream, uint32_t count);
+void DjiMock_StreamRecordLate(T_DjiMockStream *stream, uint32_t count);
+void DjiMock_StreamDeinit(T_DjiMockStream *stream);
+void DjiMock_StreamReport(void);
+
+void DjiMock_LinkInit(T_DjiMockLink *link, uint32_t bandwidthKbps);
+void DjiMock_LinkWait(T_DjiMockLink *link, uint32_t bytes);
+bool DjiMock_LinkTryConsume(T_DjiMockLink *link, uint32_t bytes);
+uint32_t DjiMock_LinkAvailable(T_DjiMockLink *link);
+
+uint32_t DjiMock_Random(uint64_t *state);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // DJI_MOCK_INTERNAL_H
+/************************ (C) COPYRIGHT DJI Innovations *******END OF FILE******/
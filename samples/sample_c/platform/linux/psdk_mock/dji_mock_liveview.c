@@ -0,0 +1,641 @@
+/**
+ ********************************************************************
+ * @file    dji_mock_liveview.c
+ * @brief   Liveview of the mock runtime, pushing a recorded or synthetic H.264 stream and synthetic images.
+ *
+ * @copyright (c) 2021 DJI. All rights reserved.
+ *
+ * All information contained herein is, and remains, the property of DJI.
+ * The intellectual and technical concepts contained herein are proprietary
+ * to DJI and may be covered by U.S. and foreign patents, patents in process,
+ * and protected by trade secret or copyright law.  Dissemination of this
+ * information, including but not limited to data and other proprietary
+ * material(s) incorporated within the information, in any form, is strictly
+ * prohibited without the express written consent of DJI.
+ *
+ * If you receive this source code without DJI’s authorization, you may not
+ * further disseminate the information, and you must immediately remove the
+ * source code and notify DJI of its removal. DJI reserves the right to pursue
+ * legal actions against you for any loss(es) or damage(s) caused by your
+ * failure to do so.
+ *
+ *********************************************************************
+ */
+
+/* Includes ------------------------------------------------------------------*/
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "dji_mock_internal.h"
+#include "dji_liveview.h"
+
+/* Private constants ---------------------------------------------------------*/
+#define DJI_MOCK_LIVEVIEW_POSITION_NUM          (4)
+#define DJI_MOCK_LIVEVIEW_SLOT_NUM              (DJI_MOCK_LIVEVIEW_POSITION_NUM * 2)
+#define DJI_MOCK_LIVEVIEW_IDR_SIZE_RATIO        (4)
+#define DJI_MOCK_LIVEVIEW_NAL_TYPE_IDR          (5)
+#define DJI_MOCK_LIVEVIEW_NAL_TYPE_SEI          (6)
+#define DJI_MOCK_LIVEVIEW_NAL_TYPE_SPS          (7)
+#define DJI_MOCK_LIVEVIEW_NAL_TYPE_PPS          (8)
+#define DJI_MOCK_LIVEVIEW_NAL_TYPE_AUD          (9)
+
+/* Private types -------------------------------------------------------------*/
+typedef enum {
+    DJI_MOCK_LIVEVIEW_SLOT_H264 = 0,
+    DJI_MOCK_LIVEVIEW_SLOT_IMAGE = 1,
+} E_DjiMockLiveviewSlotType;
+
+typedef struct {
+    bool isRunning;
+    pthread_t thread;
+    E_DjiMockLiveviewSlotType type;
+    E_DjiLiveViewCameraPosition position;
+    E_DjiLiveViewCameraSource source;
+    E_DjiLiveViewPixFormate pixFmt;
+    DjiLiveview_H264Callback h264Callback;
+    DjiLiveview_ImageCallback imageCallback;
+    bool isIntraframeRequested;
+    T_DjiMockStream stream;
+} T_DjiMockLiveviewSlot;
+
+typedef struct {
+    uint32_t offset;
+    uint32_t size;
+    bool isIntraframe;
+} T_DjiMockLiveviewAccessUnit;
+
+/* Private functions declaration ---------------------------------------------*/
+static int DjiMock_LiveviewGetPositionIndex(E_DjiLiveViewCameraPosition position);
+static T_DjiReturnCode DjiMock_LiveviewStartSlot(E_DjiLiveViewCameraPosition position,
+                                                 E_DjiLiveViewCameraSource source,
+                                                 E_DjiMockLiveviewSlotType type,
+                                                 T_DjiMockLiveviewSlot **slot);
+static T_DjiReturnCode DjiMock_LiveviewStopSlot(E_DjiLiveViewCameraPosition position,
+                                                E_DjiMockLiveviewSlotType type);
+static T_DjiReturnCode DjiMock_LiveviewLoadFile(const char *path);
+static uint32_t DjiMock_LiveviewFillSyntheticFrame(uint8_t *buffer, uint32_t size, bool isIntraframe);
+static void *DjiMock_LiveviewH264Task(void *arg);
+static void *DjiMock_LiveviewImageTask(void *arg);
+
+/* Private values -------------------------------------------------------------*/
+static pthread_mutex_t s_liveviewMutex = PTHREAD_MUTEX_INITIALIZER;
+static bool s_isLiveviewInit = false;
+static T_DjiMockLiveviewSlot s_liveviewSlotList[DJI_MOCK_LIVEVIEW_SLOT_NUM];
+static uint8_t *s_liveviewFileBuffer = NULL;
+static T_DjiMockLiveviewAccessUnit *s_liveviewAccessUnitList = NULL;
+static uint32_t s_liveviewAccessUnitCount = 0;
+static uint8_t *s_liveviewNoiseBuffer = NULL;
+static uint32_t s_liveviewNoiseSize = 0;
+static DjiLiveview_EncoderCallback s_liveviewEncoderCallback = NULL;
+static T_DjiMockStream s_liveviewEncoderStream;
+static T_DjiMockStream s_liveviewAiMetaStream;
+
+/* Exported functions definition ---------------------------------------------*/
+T_DjiReturnCode DjiLiveview_Init(void)
+{
+    const T_DjiMockConfig *config = DjiMock_GetConfig();
+    uint64_t seed = 0x9E3779B97F4A7C15ULL;
+    T_DjiReturnCode returnCode;
+    uint32_t i;
+
+    returnCode = DjiMock_CheckInit();
+    if (returnCode != DJI_ERROR_SYSTEM_MODULE_CODE_SUCCESS) {
+        return returnCode;
+    }
+
+    if (s_isLiveviewInit) {
+        return DJI_ERROR_SYSTEM_MODULE_CODE_SUCCESS;
+    }
+
+    if (config->liveviewFile != NULL) {
+        returnCode = DjiMock_LiveviewLoadFile(config->liveviewFile);
+        if (returnCode != DJI_ERROR_SYSTEM_MODULE_CODE_SUCCESS) {
+            return returnCode;
+        }
+    }
+
+    // the synthetic frames are slices of one noise buffer, sized for the largest intraframe
+    s_liveviewNoiseSize = (config->liveviewBitrateKbps * 1000 / 8) /
+                          (DJI_MOCK_MAX(config->liveviewFps, 1) + DJI_MOCK_LIVEVIEW_IDR_SIZE_RATIO - 1) *
+                          DJI_MOCK_LIVEVIEW_IDR_SIZE_RATIO + 64;
+    s_liveviewNoiseBuffer = malloc(s_liveviewNoiseSize);
+    if (s_liveviewNoiseBuffer == NULL) {
+        return DJI_ERROR_SYSTEM_MODULE_CODE_MEMORY_ALLOC_FAILED;
+    }
+    for (i = 0; i < s_liveviewNoiseSize; i++) {
+        // no zero byte, so the payload never contains a start code
+        s_liveviewNoiseBuffer[i] = (uint8_t) (DjiMock_Random(&seed) | 0x01);
+    }
+
+    memset(s_liveviewSlotList, 0, sizeof(s_liveviewSlotList));
+    s_isLiveviewInit = true;
+
+    return DJI_ERROR_SYSTEM_MODULE_CODE_SUCCESS;
+}
+
+T_DjiReturnCode DjiLiveview_Deinit(void)
+{
+    uint32_t i;
+
+    if (!s_isLiveviewInit) {
+        return DJI_ERROR_SYSTEM_MODULE_CODE_SUCCESS;
+    }
+
+    for (i = 0; i < DJI_MOCK_LIVEVIEW_SLOT_NUM; i++) {
+        if (s_liveviewSlotList[i].isRunning) {
+            DjiMock_LiveviewStopSlot(s_liveviewSlotList[i].position, s_liveviewSlotList[i].type);
+        }
+    }
+
+    free(s_liveviewAccessUnitList);
+    free(s_liveviewFileBuffer);
+    free(s_liveviewNoiseBuffer);
+    s_liveviewAccessUnitList = NULL;
+    s_liveviewFileBuffer = NULL;
+    s_liveviewNoiseBuffer = NULL;
+    s_liveviewAccessUnitCount = 0;
+    s_liveviewEncoderCallback = NULL;
+    s_isLiveviewInit = false;
+
+    return DJI_ERROR_SYSTEM_MODULE_CODE_SUCCESS;
+}
+
+T_DjiReturnCode DjiLiveview_StartH264Stream(E_DjiLiveViewCameraPosition position, E_DjiLiveViewCameraSource source,
+                                            DjiLiveview_H264Callback callback)
+{
+    T_DjiMockLiveviewSlot *slot = NULL;
+    T_DjiReturnCode returnCode;
+
+    if (callback == NULL) {
+        return DJI_ERROR_SYSTEM_MODULE_CODE_INVALID_PARAMETER;
+    }
+
+    returnCode = DjiMock_LiveviewStartSlot(position, source, DJI_MOCK_LIVEVIEW_SLOT_H264, &slot);
+    if (returnCode != DJI_ERROR_SYSTEM_MODULE_CODE_SUCCESS) {
+        return returnCode;
+    }
+
+    slot->h264Callback = callback;
+    if (pthread_create(&slot->thread, NULL, DjiMock_LiveviewH264Task, slot) != 0) {
+        slot->isRunning = false;
+        return DJI_ERROR_SYSTEM_MODULE_CODE_SYSTEM_ERROR;
+    }
+
+    return DJI_ERROR_SYSTEM_MODULE_CODE_SUCCESS;
+}
+
+T_DjiReturnCode DjiLiveview_StopH264Stream(E_DjiLiveViewCameraPosition position, E_DjiLiveViewCameraSource source)
+{
+    DJI_MOCK_UNUSED(source);
+
+    return DjiMock_LiveviewStopSlot(position, DJI_MOCK_LIVEVIEW_SLOT_H264);
+}
+
+T_DjiReturnCode DjiLiveview_RequestIntraframeFrameData(E_DjiLiveViewCameraPosition position,
+                                                       E_DjiLiveViewCameraSource source)
+{
+    int index = DjiMock_LiveviewGetPositionIndex(position);
+
+    DJI_MOCK_UNUSED(source);
+
+    if (index < 0) {
+        return DJI_ERROR_SYSTEM_MODULE_CODE_INVALID_PARAMETER;
+    }
+
+    if (!s_liveviewSlotList[index].isRunning) {
+        return DJI_ERROR_SYSTEM_MODULE_CODE_NONSUPPORT_IN_CURRENT_STATE;
+    }
+
+    s_liveviewSlotList[index].isIntraframeRequested = true;
+
+    return DJI_ERROR_SYSTEM_MODULE_CODE_SUCCESS;
+}
+
+T_DjiReturnCode DjiLiveview_StartImageStream(E_DjiLiveViewCameraPosition position, E_DjiLiveViewCameraSource source,
+                                             E_DjiLiveViewPixFormate pixFmt, DjiLiveview_ImageCallback callback)
+{
+    T_DjiMockLiveviewSlot *slot = NULL;
+    T_DjiReturnCode returnCode;
+
+    if (callback == NULL ||
+        (pixFmt != PIXFMT_NV12 && pixFmt != PIXFMT_RGB_PLANAR && pixFmt != PIXFMT_RGB_PACKED)) {
+        return DJI_ERROR_SYSTEM_MODULE_CODE_INVALID_PARAMETER;
+    }
+
+    returnCode = DjiMock_LiveviewStartSlot(position, source, DJI_MOCK_LIVEVIEW_SLOT_IMAGE, &slot);
+    if (returnCode != DJI_ERROR_SYSTEM_MODULE_CODE_SUCCESS) {
+        return returnCode;
+    }
+
+    slot->pixFmt = pixFmt;
+    slot->imageCallback = callback;
+    if (pthread_create(&slot->thread, NULL, DjiMock_LiveviewImageTask, slot) != 0) {
+        slot->isRunning = false;
+        return DJI_ERROR_SYSTEM_MODULE_CODE_SYSTEM_ERROR;
+    }
+
+    return DJI_ERROR_SYSTEM_MODULE_CODE_SUCCESS;
+}
+
+T_DjiReturnCode DjiLiveview_StopImageStream(E_DjiLiveViewCameraPosition position, E_DjiLiveViewCameraSource source)
+{
+    DJI_MOCK_UNUSED(source);
+
+    return DjiMock_LiveviewStopSlot(position, DJI_MOCK_LIVEVIEW_SLOT_IMAGE);
+}
+
+T_DjiReturnCode DjiLiveview_RegEncoderCallback(DjiLiveview_EncoderCallback callback)
+{
+    if (callback == NULL) {
+        return DJI_ERROR_SYSTEM_MODULE_CODE_INVALID_PARAMETER;
+    }
+
+    if (!s_isLiveviewInit) {
+        return DJI_ERROR_SYSTEM_MODULE_CODE_NONSUPPORT_IN_CURRENT_STATE;
+    }
+
+    s_liveviewEncoderCallback = callback;
+    DjiMock_StreamInit(&s_liveviewEncoderStream, "liveview.encoder", 0);
+
+    return DJI_ERROR_SYSTEM_MODULE_CODE_SUCCESS;
+}
+
+T_DjiReturnCode DjiLiveview_UnregEncoderCallback()
+{
+    s_liveviewEncoderCallback = NULL;
+
+    return DJI_ERROR_SYSTEM_MODULE_CODE_SUCCESS;
+}
+
+T_DjiReturnCode DjiLiveview_EncodeAFrameToH264(const uint8_t *buf, uint32_t len, T_DjiLiveviewImageInfo imageInfo,
+                                               T_DjiLiveViewStandardMetaData *metaData)
+{
+    const T_DjiMockConfig *config = DjiMock_GetConfig();
+    uint32_t frameSize;
+    uint64_t beginUs;
+    uint8_t *frame;
+
+    DJI_MOCK_UNUSED(metaData);
+
+    if (buf == NULL || len == 0) {
+        return DJI_ERROR_SYSTEM_MODULE_CODE_INVALID_PARAMETER;
+    }
+
+    if (s_liveviewEncoderCallback == NULL) {
+        return DJI_ERROR_SYSTEM_MODULE_CODE_NONSUPPORT_IN_CURRENT_STATE;
+    }
+
+    frameSize = (config->liveviewBitrateKbps * 1000 / 8) / DJI_MOCK_MAX(config->liveviewFps, 1);
+    frame = malloc(frameSize + 64);
+    if (frame == NULL) {
+        return DJI_ERROR_SYSTEM_MODULE_CODE_MEMORY_ALLOC_FAILED;
+    }
+
+    frameSize = DjiMock_LiveviewFillSyntheticFrame(frame, frameSize, imageInfo.frameId % 30 == 0);
+    beginUs = DjiMock_GetTimeUs();
+    s_liveviewEncoderCallback(frame, frameSize);
+    DjiMock_StreamRecord(&s_liveviewEncoderStream, frameSize, DjiMock_GetTimeUs() - beginUs);
+    free(frame);
+
+    return DJI_ERROR_SYSTEM_MODULE_CODE_SUCCESS;
+}
+
+T_DjiReturnCode DjiLiveview_RegUserAiTargetLableList(uint8_t lableCount, const char *labels[])
+{
+    if (labels == NULL && lableCount > 0) {
+        return DJI_ERROR_SYSTEM_MODULE_CODE_INVALID_PARAMETER;
+    }
+
+    DjiMock_StreamInit(&s_liveviewAiMetaStream, "liveview.ai_meta", 0);
+
+    return DJI_ERROR_SYSTEM_MODULE_CODE_SUCCESS;
+}
+
+T_DjiReturnCode DjiLiveview_UnregUserAiTargetLableList()
+{
+    return DJI_ERROR_SYSTEM_MODULE_CODE_SUCCESS;
+}
+
+T_DjiReturnCode DjiLiveview_SendAiMetaToPilot(T_DjiLiveViewStandardMetaData *metaData)
+{
+    if (metaData == NULL) {
+        return DJI_ERROR_SYSTEM_MODULE_CODE_INVALID_PARAMETER;
+    }
+
+    DjiMock_StreamRecord(&s_liveviewAiMetaStream,
+                         sizeof(T_DjiLiveViewStandardMetaData) +
+                         (metaData->boxCount > 0 ? metaData->boxCount - 1 : 0) * sizeof(T_DjiLiveViewBoundingBox), 0);
+
+    return DJI_ERROR_SYSTEM_MODULE_CODE_SUCCESS;
+}
+
+/* Private functions definition-----------------------------------------------*/
+static int DjiMock_LiveviewGetPositionIndex(E_DjiLiveViewCameraPosition position)
+{
+    switch (position) {
+        case DJI_LIVEVIEW_CAMERA_POSITION_NO_1:
+            return 0;
+        case DJI_LIVEVIEW_CAMERA_POSITION_NO_2:
+            return 1;
+        case DJI_LIVEVIEW_CAMERA_POSITION_NO_3:
+            return 2;
+        case DJI_LIVEVIEW_CAMERA_POSITION_FPV:
+            return 3;
+        default:
+            return -1;
+    }
+}
+
+static T_DjiReturnCode DjiMock_LiveviewStartSlot(E_DjiLiveViewCameraPosition position,
+                                                 E_DjiLiveViewCameraSource source,
+                                                 E_DjiMockLiveviewSlotType type,
+                                                 T_DjiMockLiveviewSlot **slot)
+{
+    const T_DjiMockConfig *config = DjiMock_GetConfig();
+    int index = DjiMock_LiveviewGetPositionIndex(position);
+    char name[DJI_MOCK_STREAM_NAME_MAX_SIZE];
+
+    if (!s_isLiveviewInit) {
+        return DJI_ERROR_SYSTEM_MODULE_CODE_NONSUPPORT_IN_CURRENT_STATE;
+    }
+
+    if (index < 0) {
+        return DJI_ERROR_SYSTEM_MODULE_CODE_INVALID_PARAMETER;
+    }
+
+    pthread_mutex_lock(&s_liveviewMutex);
+    *slot = &s_liveviewSlotList[type * DJI_MOCK_LIVEVIEW_POSITION_NUM + index];
+    if ((*slot)->isRunning) {
+        pthread_mutex_unlock(&s_liveviewMutex);
+        return DJI_ERROR_SYSTEM_MODULE_CODE_BUSY;
+    }
+
+    memset(*slot, 0, sizeof(T_DjiMockLiveviewSlot));
+    (*slot)->type = type;
+    (*slot)->position = position;
+    (*slot)->source = source;
+    (*slot)->isIntraframeRequested = true;
+    (*slot)->isRunning = true;
+    snprintf(name, sizeof(name), "liveview.%s.%d.%d", type == DJI_MOCK_LIVEVIEW_SLOT_H264 ? "h264" : "image",
+             position, source);
+    DjiMock_StreamInit(&(*slot)->stream, name, config->liveviewFps);
+    pthread_mutex_unlock(&s_liveviewMutex);
+
+    return DJI_ERROR_SYSTEM_MODULE_CODE_SUCCESS;
+}
+
+static T_DjiReturnCode DjiMock_LiveviewStopSlot(E_DjiLiveViewCameraPosition position,
+                                                E_DjiMockLiveviewSlotType type)
+{
+    int index = DjiMock_LiveviewGetPositionIndex(position);
+    T_DjiMockLiveviewSlot *slot;
+
+    if (index < 0) {
+        return DJI_ERROR_SYSTEM_MODULE_CODE_INVALID_PARAMETER;
+    }
+
+    pthread_mutex_lock(&s_liveviewMutex);
+    slot = &s_liveviewSlotList[type * DJI_MOCK_LIVEVIEW_POSITION_NUM + index];
+    if (!slot->isRunning) {
+        pthread_mutex_unlock(&s_liveviewMutex);
+        return DJI_ERROR_SYSTEM_MODULE_CODE_NONSUPPORT_IN_CURRENT_STATE;
+    }
+    slot->isRunning = false;
+    pthread_mutex_unlock(&s_liveviewMutex);
+
+    pthread_join(slot->thread, NULL);
+
+    return DJI_ERROR_SYSTEM_MODULE_CODE_SUCCESS;
+}
+
+static T_DjiReturnCode DjiMock_LiveviewLoadFile(const char *path)
+{
+    FILE *file;
+    long fileSize;
+    uint32_t offset;
+    uint32_t nalType;
+    uint32_t capacity = 0;
+    bool hasSlice = false;
+    bool isNewAccessUnit;
+    T_DjiMockLiveviewAccessUnit *accessUnit = NULL;
+    T_DjiMockLiveviewAccessUnit *accessUnitList;
+
+    file = fopen(path, "rb");
+    if (file == NULL) {
+        USER_LOG_ERROR("[mock] Open liveview file %s failed.", path);
+        return DJI_ERROR_SYSTEM_MODULE_CODE_NOT_FOUND;
+    }
+
+    fseek(file, 0, SEEK_END);
+    fileSize = ftell(file);
+    fseek(file, 0, SEEK_SET);
+    s_liveviewFileBuffer = fileSize > 0 ? malloc((size_t) fileSize) : NULL;
+    if (s_liveviewFileBuffer == NULL || fread(s_liveviewFileBuffer, 1, (size_t) fileSize, file) != (size_t) fileSize) {
+        fclose(file);
+        free(s_liveviewFileBuffer);
+        s_liveviewFileBuffer = NULL;
+        return DJI_ERROR_SYSTEM_MODULE_CODE_SYSTEM_ERROR;
+    }
+    fclose(file);
+
+    // an access unit starts at an access unit delimiter, at parameter sets following a slice, or at a slice
+    // with first_mb_in_slice equal to 0 following another slice
+    for (offset = 0; offset + 4 < (uint32_t) fileSize; offset++) {
+        if (s_liveviewFileBuffer[offset] != 0 || s_liveviewFileBuffer[offset + 1] != 0 ||
+            s_liveviewFileBuffer[offset + 2] != 1) {
+            continue;
+        }
+
+        nalType = s_liveviewFileBuffer[offset + 3] & 0x1F;
+        if (nalType == 1 || nalType == DJI_MOCK_LIVEVIEW_NAL_TYPE_IDR) {
+            isNewAccessUnit = hasSlice && (s_liveviewFileBuffer[offset + 4] & 0x80) != 0;
+        } else {
+            isNewAccessUnit = nalType == DJI_MOCK_LIVEVIEW_NAL_TYPE_AUD ||
+                              (hasSlice && (nalType == DJI_MOCK_LIVEVIEW_NAL_TYPE_SEI ||
+                                            nalType == DJI_MOCK_LIVEVIEW_NAL_TYPE_SPS ||
+                                            nalType == DJI_MOCK_LIVEVIEW_NAL_TYPE_PPS));
+        }
+
+        if (accessUnit == NULL || isNewAccessUnit) {
+            if (s_liveviewAccessUnitCount == capacity) {
+                capacity = capacity == 0 ? 1024 : capacity * 2;
+                accessUnitList = realloc(s_liveviewAccessUnitList, capacity * sizeof(T_DjiMockLiveviewAccessUnit));
+                if (accessUnitList == NULL) {
+                    return DJI_ERROR_SYSTEM_MODULE_CODE_MEMORY_ALLOC_FAILED;
+                }
+                s_liveviewAccessUnitList = accessUnitList;
+            }
+            if (accessUnit != NULL) {
+                // include the zero byte of a four bytes start code in the next access unit
+                accessUnit->size = (offset > 0 && s_liveviewFileBuffer[offset - 1] == 0 ? offset - 1 : offset) -
+                                   accessUnit->offset;
+            }
+            accessUnit = &s_liveviewAccessUnitList[s_liveviewAccessUnitCount++];
+            accessUnit->offset = offset > 0 && s_liveviewFileBuffer[offset - 1] == 0 ? offset - 1 : offset;
+            accessUnit->isIntraframe = false;
+            hasSlice = false;
+        }
+
+        if (nalType == 1 || nalType == DJI_MOCK_LIVEVIEW_NAL_TYPE_IDR) {
+            hasSlice = true;
+        }
+        if (nalType == DJI_MOCK_LIVEVIEW_NAL_TYPE_IDR) {
+            accessUnit->isIntraframe = true;
+        }
+        offset += 3;
+    }
+
+    if (accessUnit == NULL) {
+        USER_LOG_ERROR("[mock] No H.264 start code in %s.", path);
+        return DJI_ERROR_SYSTEM_MODULE_CODE_INVALID_PARAMETER;
+    }
+    accessUnit->size = (uint32_t) fileSize - accessUnit->offset;
+
+    USER_LOG_INFO("[mock] Liveview replays %u access units from %s.", s_liveviewAccessUnitCount, path);
+
+    return DJI_ERROR_SYSTEM_MODULE_CODE_SUCCESS;
+}
+
+static uint32_t DjiMock_LiveviewFillSyntheticFrame(uint8_t *buffer, uint32_t size, bool isIntraframe)
+{
+    static const uint8_t s_audNal[] = {0x00, 0x00, 0x00, 0x01, 0x09, 0xF0};
+    static const uint8_t s_parameterSetNal[] = {
+        0x00, 0x00, 0x00, 0x01, 0x67, 0x64, 0x00, 0x28, 0xAC, 0xD9,
+        0x00, 0x00, 0x00, 0x01, 0x68, 0xEB, 0xE3, 0xCB, 0x22, 0xC0,
+    };
+    uint32_t length = 0;
+    uint32_t payloadSize;
+
+    memcpy(buffer, s_audNal, sizeof(s_audNal));
+    length += sizeof(s_audNal);
+    if (isIntraframe) {
+        memcpy(buffer + length, s_parameterSetNal, sizeof(s_parameterSetNal));
+        length += sizeof(s_parameterSetNal);
+    }
+
+    buffer[length++] = 0x00;
+    buffer[length++] = 0x00;
+    buffer[length++] = 0x00;
+    buffer[length++] = 0x01;
+    buffer[length++] = isIntraframe ? 0x65 : 0x41;
+    payloadSize = size > length ? size - length : 1;
+    payloadSize = DJI_MOCK_MIN(payloadSize, s_liveviewNoiseSize);
+    memcpy(buffer + length, s_liveviewNoiseBuffer, payloadSize);
+
+    return length + payloadSize;
+}
+
+static void *DjiMock_LiveviewH264Task(void *arg)
+{
+    T_DjiMockLiveviewSlot *slot = (T_DjiMockLiveviewSlot *) arg;
+    const T_DjiMockConfig *config = DjiMock_GetConfig();
+    uint32_t fps = DJI_MOCK_MAX(config->liveviewFps, 1);
+    uint32_t frameSize = (config->liveviewBitrateKbps * 1000 / 8) / (fps + DJI_MOCK_LIVEVIEW_IDR_SIZE_RATIO - 1);
+    uint8_t *frame = NULL;
+    const uint8_t *data;
+    uint32_t dataSize;
+    uint32_t frameIndex = 0;
+    uint32_t accessUnitIndex = 0;
+    bool isIntraframe;
+    uint64_t beginUs;
+
+    if (s_liveviewAccessUnitCount == 0) {
+        frame = malloc(s_liveviewNoiseSize + 64);
+        if (frame == NULL) {
+            USER_LOG_ERROR("[mock] Malloc liveview frame failed.");
+            slot->isRunning = false;
+            return NULL;
+        }
+    }
+
+    while (slot->isRunning) {
+        if (s_liveviewAccessUnitCount > 0) {
+            if (slot->isIntraframeRequested) {
+                while (!s_liveviewAccessUnitList[accessUnitIndex].isIntraframe &&
+                       accessUnitIndex + 1 < s_liveviewAccessUnitCount) {
+                    accessUnitIndex++;
+                }
+                slot->isIntraframeRequested = false;
+            }
+            data = s_liveviewFileBuffer + s_liveviewAccessUnitList[accessUnitIndex].offset;
+            dataSize = s_liveviewAccessUnitList[accessUnitIndex].size;
+            accessUnitIndex = (accessUnitIndex + 1) % s_liveviewAccessUnitCount;
+        } else {
+            isIntraframe = slot->isIntraframeRequested || frameIndex % fps == 0;
+            slot->isIntraframeRequested = false;
+            dataSize = DjiMock_LiveviewFillSyntheticFrame(frame, isIntraframe ?
+                                                                 frameSize * DJI_MOCK_LIVEVIEW_IDR_SIZE_RATIO :
+                                                                 frameSize, isIntraframe);
+            data = frame;
+        }
+
+        beginUs = DjiMock_GetTimeUs();
+        slot->h264Callback(slot->position, data, dataSize);
+        DjiMock_StreamRecord(&slot->stream, dataSize, DjiMock_GetTimeUs() - beginUs);
+        frameIndex++;
+
+        DjiMock_StreamWaitNext(&slot->stream);
+    }
+
+    free(frame);
+
+    return NULL;
+}
+
+static void *DjiMock_LiveviewImageTask(void *arg)
+{
+    T_DjiMockLiveviewSlot *slot = (T_DjiMockLiveviewSlot *) arg;
+    const T_DjiMockConfig *config = DjiMock_GetConfig();
+    T_DjiLiveviewImageInfo imageInfo = {0};
+    uint32_t width = config->liveviewImageWidth;
+    uint32_t height = config->liveviewImageHeight;
+    uint32_t planeSize = width * height;
+    uint32_t imageSize = slot->pixFmt == PIXFMT_NV12 ? planeSize * 3 / 2 : planeSize * 3;
+    uint8_t *image;
+    uint32_t row;
+    uint64_t beginUs;
+
+    image = malloc(imageSize);
+    if (image == NULL) {
+        USER_LOG_ERROR("[mock] Malloc liveview image failed.");
+        slot->isRunning = false;
+        return NULL;
+    }
+
+    imageInfo.pixFmt = slot->pixFmt;
+    imageInfo.width = (uint16_t) width;
+    imageInfo.height = (uint16_t) height;
+
+    while (slot->isRunning) {
+        // horizontal bands moving down by two rows per frame, chroma kept neutral
+        if (slot->pixFmt == PIXFMT_RGB_PACKED) {
+            for (row = 0; row < height; row++) {
+                memset(image + row * width * 3, (int) ((row + imageInfo.frameId * 2) & 0xFF), width * 3);
+            }
+        } else {
+            for (row = 0; row < height; row++) {
+                memset(image + row * width, (int) ((row + imageInfo.frameId * 2) & 0xFF), width);
+            }
+            if (slot->pixFmt == PIXFMT_NV12) {
+                memset(image + planeSize, 0x80, planeSize / 2);
+            } else {
+                memcpy(image + planeSize, image, planeSize);
+                memcpy(image + planeSize * 2, image, planeSize);
+            }
+        }
+
+        beginUs = DjiMock_GetTimeUs();
+        slot->imageCallback(slot->position, image, imageSize, imageInfo);
+        DjiMock_StreamRecord(&slot->stream, imageSize, DjiMock_GetTimeUs() - beginUs);
+        imageInfo.frameId++;
+
+        DjiMock_StreamWaitNext(&slot->stream);
+    }
+
+    free(image);
+
+    return NULL;
+}
+
+/****************** (C) COPYRIGHT DJI Innovations *****END OF FILE****/
@@ -0,0 +1,414 @@
+/**
+ ********************************************************************
+ * @file    dji_mock_mop_channel.c
+ * @brief   Mop channel of the mock runtime, connecting the channels to an emulated peer over a paced link.
+ *
+ * @copyright (c) 2021 DJI. All rights reserved.
+ *
+ * All information contained herein is, and remains, the property of DJI.
+ * The intellectual and technical concepts contained herein are proprietary
+ * to DJI and may be covered by U.S. and foreign patents, patents in process,
+ * and protected by trade secret or copyright law.  Dissemination of this
+ * information, including but not limited to data and other proprietary
+ * material(s) incorporated within the information, in any form, is strictly
+ * prohibited without the express written consent of DJI.
+ *
+ * If you receive this source code without DJI’s authorization, you may not
+ * further disseminate the information, and you must immediately remove the
+ * source code and notify DJI of its removal. DJI reserves the right to pursue
+ * legal actions against you for any loss(es) or damage(s) caused by your
+ * failure to do so.
+ *
+ *********************************************************************
+ */
+
+/* Includes ------------------------------------------------------------------*/
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include "dji_mock_internal.h"
+#include "dji_mop_channel.h"
+
+/* Private constants ---------------------------------------------------------*/
+#define DJI_MOCK_MOP_RX_BUFFER_SIZE         (512 * 1024)
+#define DJI_MOCK_MOP_ACCEPT_POLL_TIME_MS    (100)
+
+/* Private types -------------------------------------------------------------*/
+typedef enum {
+    DJI_MOCK_MOP_STATE_CREATED = 0,
+    DJI_MOCK_MOP_STATE_BOUND,
+    DJI_MOCK_MOP_STATE_CONNECTED,
+    DJI_MOCK_MOP_STATE_CLOSED,
+} E_DjiMockMopState;
+
+typedef struct T_DjiMockMopChannel {
+    E_DjiMopChannelTransType transType;
+    E_DjiMockMopState state;
+    uint16_t channelId;
+    uint32_t connectionCount;
+    struct T_DjiMockMopChannel *listener;
+    struct T_DjiMockMopChannel *connection;
+    pthread_mutex_t mutex;
+    pthread_cond_t cond;
+    uint8_t *rxBuffer;
+    uint32_t rxHead;
+    uint32_t rxCount;
+    uint8_t rxPattern;
+    T_DjiMockLink txLink;
+    T_DjiMockLink rxLink;
+    T_DjiMockStream txStream;
+    T_DjiMockStream rxStream;
+} T_DjiMockMopChannel;
+
+/* Private functions declaration ---------------------------------------------*/
+static T_DjiMockMopChannel *DjiMock_MopChannelNew(E_DjiMopChannelTransType transType);
+static void DjiMock_MopChannelConnect(T_DjiMockMopChannel *channel, uint16_t channelId, uint32_t connectionId);
+static void DjiMock_MopChannelTimedWait(T_DjiMockMopChannel *channel, uint32_t timeMs);
+
+/* Private values -------------------------------------------------------------*/
+static pthread_mutex_t s_mopChannelMutex = PTHREAD_MUTEX_INITIALIZER;
+static bool s_isMopChannelInit = false;
+
+/* Exported functions definition ---------------------------------------------*/
+T_DjiReturnCode DjiMopChannel_Init(void)
+{
+    T_DjiReturnCode returnCode;
+
+    returnCode = DjiMock_CheckInit();
+    if (returnCode != DJI_ERROR_SYSTEM_MODULE_CODE_SUCCESS) {
+        return returnCode;
+    }
+
+    s_isMopChannelInit = true;
+
+    return DJI_ERROR_SYSTEM_MODULE_CODE_SUCCESS;
+}
+
+T_DjiReturnCode DjiMopChannel_Create(T_DjiMopChannelHandle *channelHandle, E_DjiMopChannelTransType transType)
+{
+    T_DjiMockMopChannel *channel;
+
+    if (channelHandle == NULL || transType > DJI_MOP_CHANNEL_TRANS_UNRELIABLE) {
+        return DJI_ERROR_SYSTEM_MODULE_CODE_INVALID_PARAMETER;
+    }
+
+    if (!s_isMopChannelInit) {
+        return DJI_ERROR_SYSTEM_MODULE_CODE_NONSUPPORT_IN_CURRENT_STATE;
+    }
+
+    channel = DjiMock_MopChannelNew(transType);
+    if (channel == NULL) {
+        return DJI_ERROR_SYSTEM_MODULE_CODE_MEMORY_ALLOC_FAILED;
+    }
+
+    *channelHandle = channel;
+
+    return DJI_ERROR_SYSTEM_MODULE_CODE_SUCCESS;
+}
+
+T_DjiReturnCode DjiMopChannel_Destroy(T_DjiMopChannelHandle channelHandle)
+{
+    T_DjiMockMopChannel *channel = (T_DjiMockMopChannel *) channelHandle;
+
+    if (channel == NULL) {
+        return DJI_ERROR_SYSTEM_MODULE_CODE_INVALID_PARAMETER;
+    }
+
+    DjiMopChannel_Close(channelHandle);
+
+    pthread_mutex_lock(&s_mopChannelMutex);
+    if (channel->listener != NULL && channel->listener->connection == channel) {
+        channel->listener->connection = NULL;
+    }
+    if (channel->connection != NULL && channel->connection->listener == channel) {
+        channel->connection->listener = NULL;
+    }
+    pthread_mutex_unlock(&s_mopChannelMutex);
+
+    DjiMock_StreamDeinit(&channel->txStream);
+    DjiMock_StreamDeinit(&channel->rxStream);
+    pthread_cond_destroy(&channel->cond);
+    pthread_mutex_destroy(&channel->mutex);
+    free(channel->rxBuffer);
+    free(channel);
+
+    return DJI_ERROR_SYSTEM_MODULE_CODE_SUCCESS;
+}
+
+T_DjiReturnCode DjiMopChannel_Bind(T_DjiMopChannelHandle channelHandle, uint16_t channelId)
+{
+    T_DjiMockMopChannel *channel = (T_DjiMockMopChannel *) channelHandle;
+
+    if (channel == NULL) {
+        return DJI_ERROR_SYSTEM_MODULE_CODE_INVALID_PARAMETER;
+    }
+
+    pthread_mutex_lock(&channel->mutex);
+    if (channel->state != DJI_MOCK_MOP_STATE_CREATED) {
+        pthread_mutex_unlock(&channel->mutex);
+        return DJI_ERROR_SYSTEM_MODULE_CODE_NONSUPPORT_IN_CURRENT_STATE;
+    }
+    channel->channelId = channelId;
+    channel->state = DJI_MOCK_MOP_STATE_BOUND;
+    pthread_mutex_unlock(&channel->mutex);
+
+    return DJI_ERROR_SYSTEM_MODULE_CODE_SUCCESS;
+}
+
+T_DjiReturnCode DjiMopChannel_Accept(T_DjiMopChannelHandle channelHandle, T_DjiMopChannelHandle *outChannelHandle)
+{
+    T_DjiMockMopChannel *channel = (T_DjiMockMopChannel *) channelHandle;
+    T_DjiMockMopChannel *connection;
+    bool isBusy;
+
+    if (channel == NULL || outChannelHandle == NULL) {
+        return DJI_ERROR_SYSTEM_MODULE_CODE_INVALID_PARAMETER;
+    }
+
+    if (channel->state != DJI_MOCK_MOP_STATE_BOUND) {
+        return DJI_ERROR_SYSTEM_MODULE_CODE_NONSUPPORT_IN_CURRENT_STATE;
+    }
+
+    // the emulated peer connects at once, and again only after the previous connection has been closed
+    while (1) {
+        pthread_mutex_lock(&s_mopChannelMutex);
+        isBusy = channel->connection != NULL && channel->connection->state != DJI_MOCK_MOP_STATE_CLOSED;
+        pthread_mutex_unlock(&s_mopChannelMutex);
+        if (!isBusy) {
+            break;
+        }
+        DjiMock_MopChannelTimedWait(channel, DJI_MOCK_MOP_ACCEPT_POLL_TIME_MS);
+        if (channel->state != DJI_MOCK_MOP_STATE_BOUND) {
+            return DJI_ERROR_MOP_CHANNEL_MODULE_CODE_CONNECTION_CLOSE;
+        }
+    }
+
+    connection = DjiMock_MopChannelNew(channel->transType);
+    if (connection == NULL) {
+        return DJI_ERROR_SYSTEM_MODULE_CODE_MEMORY_ALLOC_FAILED;
+    }
+
+    pthread_mutex_lock(&s_mopChannelMutex);
+    if (channel->connection != NULL) {
+        channel->connection->listener = NULL;
+    }
+    channel->connection = connection;
+    connection->listener = channel;
+    DjiMock_MopChannelConnect(connection, channel->channelId, ++channel->connectionCount);
+    pthread_mutex_unlock(&s_mopChannelMutex);
+
+    *outChannelHandle = connection;
+
+    return DJI_ERROR_SYSTEM_MODULE_CODE_SUCCESS;
+}
+
+T_DjiReturnCode DjiMopChannel_Connect(T_DjiMopChannelHandle channelHandle, E_DjiChannelAddress channelAddress,
+                                      uint16_t channelId)
+{
+    T_DjiMockMopChannel *channel = (T_DjiMockMopChannel *) channelHandle;
+
+    DJI_MOCK_UNUSED(channelAddress);
+
+    if (channel == NULL) {
+        return DJI_ERROR_SYSTEM_MODULE_CODE_INVALID_PARAMETER;
+    }
+
+    if (channel->state != DJI_MOCK_MOP_STATE_CREATED) {
+        return DJI_ERROR_SYSTEM_MODULE_CODE_NONSUPPORT_IN_CURRENT_STATE;
+    }
+
+    DjiMock_MopChannelConnect(channel, channelId, 1);
+
+    return DJI_ERROR_SYSTEM_MODULE_CODE_SUCCESS;
+}
+
+T_DjiReturnCode DjiMopChannel_Close(T_DjiMopChannelHandle channelHandle)
+{
+    T_DjiMockMopChannel *channel = (T_DjiMockMopChannel *) channelHandle;
+    T_DjiMockMopChannel *listener;
+
+    if (channel == NULL) {
+        return DJI_ERROR_SYSTEM_MODULE_CODE_INVALID_PARAMETER;
+    }
+
+    pthread_mutex_lock(&channel->mutex);
+    channel->state = DJI_MOCK_MOP_STATE_CLOSED;
+    pthread_cond_broadcast(&channel->cond);
+    pthread_mutex_unlock(&channel->mutex);
+
+    pthread_mutex_lock(&s_mopChannelMutex);
+    listener = channel->listener;
+    if (listener != NULL) {
+        pthread_mutex_lock(&listener->mutex);
+        pthread_cond_broadcast(&listener->cond);
+        pthread_mutex_unlock(&listener->mutex);
+    }
+    pthread_mutex_unlock(&s_mopChannelMutex);
+
+    return DJI_ERROR_SYSTEM_MODULE_CODE_SUCCESS;
+}
+
+T_DjiReturnCode DjiMopChannel_SendData(T_DjiMopChannelHandle channelHandle, uint8_t *data, uint32_t len,
+                                       uint32_t *realLen)
+{
+    T_DjiMockMopChannel *channel = (T_DjiMockMopChannel *) channelHandle;
+    const T_DjiMockConfig *config = DjiMock_GetConfig();
+    uint32_t tail;
+    uint32_t copyLen;
+    uint32_t firstLen;
+    uint64_t beginUs;
+
+    if (channel == NULL || data == NULL || realLen == NULL) {
+        return DJI_ERROR_SYSTEM_MODULE_CODE_INVALID_PARAMETER;
+    }
+
+    *realLen = 0;
+    if (channel->state != DJI_MOCK_MOP_STATE_CONNECTED) {
+        return DJI_ERROR_MOP_CHANNEL_MODULE_CODE_CONNECTION_CLOSE;
+    }
+
+    beginUs = DjiMock_GetTimeUs();
+    DjiMock_LinkWait(&channel->txLink, len);
+    pthread_mutex_lock(&channel->mutex);
+    copyLen = len;
+    if (config->mopPeerMode == DJI_MOCK_MOP_PEER_MODE_ECHO) {
+        // the peer echoes what it receives, a reliable channel waits for room and an unreliable one drops the rest
+        while (channel->transType == DJI_MOP_CHANNEL_TRANS_RELIABLE &&
+               DJI_MOCK_MOP_RX_BUFFER_SIZE - channel->rxCount < DJI_MOCK_MIN(len, DJI_MOCK_MOP_RX_BUFFER_SIZE) &&
+               channel->state == DJI_MOCK_MOP_STATE_CONNECTED) {
+            pthread_cond_wait(&channel->cond, &channel->mutex);
+        }
+        copyLen = DJI_MOCK_MIN(len, DJI_MOCK_MOP_RX_BUFFER_SIZE - channel->rxCount);
+        tail = (channel->rxHead + channel->rxCount) % DJI_MOCK_MOP_RX_BUFFER_SIZE;
+        firstLen = DJI_MOCK_MIN(copyLen, DJI_MOCK_MOP_RX_BUFFER_SIZE - tail);
+        memcpy(&channel->rxBuffer[tail], data, firstLen);
+        memcpy(channel->rxBuffer, data + firstLen, copyLen - firstLen);
+        channel->rxCount += copyLen;
+        pthread_cond_broadcast(&channel->cond);
+    }
+    pthread_mutex_unlock(&channel->mutex);
+
+    DjiMock_StreamRecord(&channel->txStream, copyLen, DjiMock_GetTimeUs() - beginUs);
+    if (copyLen < len) {
+        DjiMock_StreamRecordDrop(&channel->txStream, 1);
+    }
+    *realLen = channel->transType == DJI_MOP_CHANNEL_TRANS_RELIABLE ? copyLen : len;
+
+    return DJI_ERROR_SYSTEM_MODULE_CODE_SUCCESS;
+}
+
+T_DjiReturnCode DjiMopChannel_RecvData(T_DjiMopChannelHandle channelHandle, uint8_t *data, uint32_t len,
+                                       uint32_t *realLen)
+{
+    T_DjiMockMopChannel *channel = (T_DjiMockMopChannel *) channelHandle;
+    const T_DjiMockConfig *config = DjiMock_GetConfig();
+    uint32_t copyLen = 0;
+    uint32_t firstLen;
+    uint32_t i;
+    uint64_t beginUs;
+
+    if (channel == NULL || data == NULL || realLen == NULL || len == 0) {
+        return DJI_ERROR_SYSTEM_MODULE_CODE_INVALID_PARAMETER;
+    }
+
+    *realLen = 0;
+    beginUs = DjiMock_GetTimeUs();
+    pthread_mutex_lock(&channel->mutex);
+    switch (config->mopPeerMode) {
+        case DJI_MOCK_MOP_PEER_MODE_SOURCE:
+            // the peer sends a counting pattern as fast as the link allows
+            if (channel->state == DJI_MOCK_MOP_STATE_CONNECTED) {
+                copyLen = DJI_MOCK_MIN(len, DJI_MOCK_MAX(channel->rxLink.burstBytes, 1));
+                DjiMock_LinkWait(&channel->rxLink, copyLen);
+                for (i = 0; i < copyLen; i++) {
+                    data[i] = channel->rxPattern++;
+                }
+            }
+            break;
+        case DJI_MOCK_MOP_PEER_MODE_SINK:
+            while (channel->state == DJI_MOCK_MOP_STATE_CONNECTED) {
+                pthread_cond_wait(&channel->cond, &channel->mutex);
+            }
+            break;
+        case DJI_MOCK_MOP_PEER_MODE_ECHO:
+        default:
+            while (channel->rxCount == 0 && channel->state == DJI_MOCK_MOP_STATE_CONNECTED) {
+                pthread_cond_wait(&channel->cond, &channel->mutex);
+            }
+            copyLen = DJI_MOCK_MIN(len, channel->rxCount);
+            firstLen = DJI_MOCK_MIN(copyLen, DJI_MOCK_MOP_RX_BUFFER_SIZE - channel->rxHead);
+            memcpy(data, &channel->rxBuffer[channel->rxHead], firstLen);
+            memcpy(data + firstLen, channel->rxBuffer, copyLen - firstLen);
+            channel->rxHead = (channel->rxHead + copyLen) % DJI_MOCK_MOP_RX_BUFFER_SIZE;
+            channel->rxCount -= copyLen;
+            pthread_cond_broadcast(&channel->cond);
+            break;
+    }
+    pthread_mutex_unlock(&channel->mutex);
+
+    if (copyLen == 0) {
+        return DJI_ERROR_MOP_CHANNEL_MODULE_CODE_CONNECTION_CLOSE;
+    }
+
+    DjiMock_StreamRecord(&channel->rxStream, copyLen, DjiMock_GetTimeUs() - beginUs);
+    *realLen = copyLen;
+
+    return DJI_ERROR_SYSTEM_MODULE_CODE_SUCCESS;
+}
+
+/* Private functions definition-----------------------------------------------*/
+static T_DjiMockMopChannel *DjiMock_MopChannelNew(E_DjiMopChannelTransType transType)
+{
+    T_DjiMockMopChannel *channel;
+
+    channel = calloc(1, sizeof(T_DjiMockMopChannel));
+    if (channel == NULL) {
+        return NULL;
+    }
+
+    channel->transType = transType;
+    channel->state = DJI_MOCK_MOP_STATE_CREATED;
+    pthread_mutex_init(&channel->mutex, NULL);
+    pthread_cond_init(&channel->cond, NULL);
+
+    return channel;
+}
+
+static void DjiMock_MopChannelConnect(T_DjiMockMopChannel *channel, uint16_t channelId, uint32_t connectionId)
+{
+    const T_DjiMockConfig *config = DjiMock_GetConfig();
+    char name[DJI_MOCK_STREAM_NAME_MAX_SIZE];
+
+    pthread_mutex_lock(&channel->mutex);
+    if (channel->rxBuffer == NULL && config->mopPeerMode == DJI_MOCK_MOP_PEER_MODE_ECHO) {
+        channel->rxBuffer = malloc(DJI_MOCK_MOP_RX_BUFFER_SIZE);
+    }
+    channel->channelId = channelId;
+    DjiMock_LinkInit(&channel->txLink, config->mopBandwidthKbps);
+    DjiMock_LinkInit(&channel->rxLink, config->mopBandwidthKbps);
+    snprintf(name, sizeof(name), "mop.%u.%u.tx", channelId, connectionId);
+    DjiMock_StreamInit(&channel->txStream, name, 0);
+    snprintf(name, sizeof(name), "mop.%u.%u.rx", channelId, connectionId);
+    DjiMock_StreamInit(&channel->rxStream, name, 0);
+    channel->state = config->mopPeerMode != DJI_MOCK_MOP_PEER_MODE_ECHO || channel->rxBuffer != NULL ?
+                     DJI_MOCK_MOP_STATE_CONNECTED : DJI_MOCK_MOP_STATE_CLOSED;
+    pthread_mutex_unlock(&channel->mutex);
+}
+
+static void DjiMock_MopChannelTimedWait(T_DjiMockMopChannel *channel, uint32_t timeMs)
+{
+    struct timespec ts;
+
+    clock_gettime(CLOCK_REALTIME, &ts);
+    ts.tv_nsec += (long) (timeMs % 1000) * 1000000;
+    ts.tv_sec += timeMs / 1000 + ts.tv_nsec / 1000000000;
+    ts.tv_nsec %= 1000000000;
+
+    pthread_mutex_lock(&channel->mutex);
+    pthread_cond_timedwait(&channel->cond, &channel->mutex, &ts);
+    pthread_mutex_unlock(&channel->mutex);
+}
+
+/****************** (C) COPYRIGHT DJI Innovations *****END OF FILE****/
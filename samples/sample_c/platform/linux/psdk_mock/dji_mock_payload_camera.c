@@ -0,0 +1,281 @@
+/**
+ ********************************************************************
+ * @file    dji_mock_payload_camera.c
+ * @brief   Payload camera of the mock runtime, polling the registered handlers and flow controlling the video stream.
+ *
+ * @copyright (c) 2021 DJI. All rights reserved.
+ *
+ * All information contained herein is, and remains, the property of DJI.
+ * The intellectual and technical concepts contained herein are proprietary
+ * to DJI and may be covered by U.S. and foreign patents, patents in process,
+ * and protected by trade secret or copyright law.  Dissemination of this
+ * information, including but not limited to data and other proprietary
+ * material(s) incorporated within the information, in any form, is strictly
+ * prohibited without the express written consent of DJI.
+ *
+ * If you receive this source code without DJI’s authorization, you may not
+ * further disseminate the information, and you must immediately remove the
+ * source code and notify DJI of its removal. DJI reserves the right to pursue
+ * legal actions against you for any loss(es) or damage(s) caused by your
+ * failure to do so.
+ *
+ *********************************************************************
+ */
+
+/* Includes ------------------------------------------------------------------*/
+#include <pthread.h>
+#include <string.h>
+#include "dji_mock_internal.h"
+#include "dji_payload_camera.h"
+
+/* Private constants ---------------------------------------------------------*/
+#define DJI_MOCK_PAYLOAD_CAMERA_RATE_WINDOW_US  (1000000)
+
+/* Private types -------------------------------------------------------------*/
+typedef struct {
+    uint64_t windowStartUs;
+    uint32_t windowBytes;
+    int32_t bytesPerSecond;
+} T_DjiMockRateMeter;
+
+/* Private functions declaration ---------------------------------------------*/
+static void DjiMock_RateMeterAdd(T_DjiMockRateMeter *meter, uint32_t bytes, uint64_t nowUs);
+static void *DjiMock_PayloadCameraStatePollTask(void *arg);
+
+/* Private values -------------------------------------------------------------*/
+static pthread_mutex_t s_payloadCameraMutex = PTHREAD_MUTEX_INITIALIZER;
+static bool s_isPayloadCameraInit = false;
+static bool s_isStatePollRunning = false;
+static pthread_t s_statePollThread;
+static T_DjiCameraCommonHandler s_commonHandler;
+static bool s_isCommonHandlerRegistered = false;
+static E_DjiCameraVideoStreamType s_videoStreamType = DJI_CAMERA_VIDEO_STREAM_TYPE_H264_CUSTOM_FORMAT;
+static T_DjiMockLink s_videoStreamLink;
+static T_DjiMockStream s_videoStream;
+static T_DjiMockStream s_statePollStream;
+static T_DjiMockRateMeter s_rateBeforeFlowController;
+static T_DjiMockRateMeter s_rateAfterFlowController;
+static bool s_isVideoStreamBusy = false;
+
+/* Exported functions definition ---------------------------------------------*/
+T_DjiReturnCode DjiPayloadCamera_Init(void)
+{
+    const T_DjiMockConfig *config = DjiMock_GetConfig();
+    T_DjiReturnCode returnCode;
+
+    returnCode = DjiMock_CheckInit();
+    if (returnCode != DJI_ERROR_SYSTEM_MODULE_CODE_SUCCESS) {
+        return returnCode;
+    }
+
+    if (s_isPayloadCameraInit) {
+        return DJI_ERROR_SYSTEM_MODULE_CODE_SUCCESS;
+    }
+
+    DjiMock_LinkInit(&s_videoStreamLink, config->videoStreamBandwidthKbps);
+    DjiMock_StreamInit(&s_videoStream, "camera.video_stream", 0);
+    DjiMock_StreamInit(&s_statePollStream, "camera.state_poll", config->cameraStatePollFreq);
+    memset(&s_rateBeforeFlowController, 0, sizeof(T_DjiMockRateMeter));
+    memset(&s_rateAfterFlowController, 0, sizeof(T_DjiMockRateMeter));
+
+    if (config->cameraStatePollFreq > 0) {
+        s_isStatePollRunning = true;
+        if (pthread_create(&s_statePollThread, NULL, DjiMock_PayloadCameraStatePollTask, NULL) != 0) {
+            s_isStatePollRunning = false;
+            return DJI_ERROR_SYSTEM_MODULE_CODE_SYSTEM_ERROR;
+        }
+        pthread_detach(s_statePollThread);
+    }
+
+    s_isPayloadCameraInit = true;
+
+    return DJI_ERROR_SYSTEM_MODULE_CODE_SUCCESS;
+}
+
+T_DjiReturnCode DjiPayloadCamera_RegCommonHandler(const T_DjiCameraCommonHandler *cameraCommonHandler)
+{
+    if (cameraCommonHandler == NULL) {
+        return DJI_ERROR_SYSTEM_MODULE_CODE_INVALID_PARAMETER;
+    }
+
+    pthread_mutex_lock(&s_payloadCameraMutex);
+    s_commonHandler = *cameraCommonHandler;
+    s_isCommonHandlerRegistered = true;
+    pthread_mutex_unlock(&s_payloadCameraMutex);
+
+    return DJI_ERROR_SYSTEM_MODULE_CODE_SUCCESS;
+}
+
+T_DjiReturnCode DjiPayloadCamera_RegExposureMeteringHandler(const T_DjiCameraExposureMeteringHandler
+                                                            *cameraExposureMeteringHandler)
+{
+    return cameraExposureMeteringHandler != NULL ? DJI_ERROR_SYSTEM_MODULE_CODE_SUCCESS :
+           DJI_ERROR_SYSTEM_MODULE_CODE_INVALID_PARAMETER;
+}
+
+T_DjiReturnCode DjiPayloadCamera_RegFocusHandler(const T_DjiCameraFocusHandler *cameraFocusHandler)
+{
+    return cameraFocusHandler != NULL ? DJI_ERROR_SYSTEM_MODULE_CODE_SUCCESS :
+           DJI_ERROR_SYSTEM_MODULE_CODE_INVALID_PARAMETER;
+}
+
+T_DjiReturnCode DjiPayloadCamera_RegDigitalZoomHandler(const T_DjiCameraDigitalZoomHandler
+                                                       *cameraDigitalZoomHandler)
+{
+    return cameraDigitalZoomHandler != NULL ? DJI_ERROR_SYSTEM_MODULE_CODE_SUCCESS :
+           DJI_ERROR_SYSTEM_MODULE_CODE_INVALID_PARAMETER;
+}
+
+T_DjiReturnCode DjiPayloadCamera_RegOpticalZoomHandler(const T_DjiCameraOpticalZoomHandler
+                                                       *cameraOpticalZoomHandler)
+{
+    return cameraOpticalZoomHandler != NULL ? DJI_ERROR_SYSTEM_MODULE_CODE_SUCCESS :
+           DJI_ERROR_SYSTEM_MODULE_CODE_INVALID_PARAMETER;
+}
+
+T_DjiReturnCode DjiPayloadCamera_RegTapZoomHandler(const T_DjiCameraTapZoomHandler *cameraTapZoomHandler)
+{
+    return cameraTapZoomHandler != NULL ? DJI_ERROR_SYSTEM_MODULE_CODE_SUCCESS :
+           DJI_ERROR_SYSTEM_MODULE_CODE_INVALID_PARAMETER;
+}
+
+T_DjiReturnCode DjiPayloadCamera_RegMediaDownloadPlaybackHandler(const T_DjiCameraMediaDownloadPlaybackHandler
+                                                                 *cameraMediaHandler)
+{
+    return cameraMediaHandler != NULL ? DJI_ERROR_SYSTEM_MODULE_CODE_SUCCESS :
+           DJI_ERROR_SYSTEM_MODULE_CODE_INVALID_PARAMETER;
+}
+
+T_DjiReturnCode DjiPayloadCamera_SetVideoStreamType(E_DjiCameraVideoStreamType videoStreamType)
+{
+    if (videoStreamType > DJI_CAMERA_VIDEO_STREAM_TYPE_H264_DJI_FORMAT) {
+        return DJI_ERROR_SYSTEM_MODULE_CODE_INVALID_PARAMETER;
+    }
+
+    s_videoStreamType = videoStreamType;
+
+    return DJI_ERROR_SYSTEM_MODULE_CODE_SUCCESS;
+}
+
+T_DjiReturnCode DjiPayloadCamera_GetVideoStreamRemoteAddress(char *ipAddr, uint16_t *port)
+{
+    if (ipAddr == NULL || port == NULL) {
+        return DJI_ERROR_SYSTEM_MODULE_CODE_INVALID_PARAMETER;
+    }
+
+    strcpy(ipAddr, "127.0.0.1");
+    *port = 23003;
+
+    return DJI_ERROR_SYSTEM_MODULE_CODE_SUCCESS;
+}
+
+T_DjiReturnCode DjiPayloadCamera_SendVideoStream(const uint8_t *data, uint32_t len)
+{
+    uint64_t nowUs;
+    bool isSent;
+
+    if (data == NULL || len == 0) {
+        return DJI_ERROR_SYSTEM_MODULE_CODE_INVALID_PARAMETER;
+    }
+
+    if (!s_isPayloadCameraInit) {
+        return DJI_ERROR_SYSTEM_MODULE_CODE_NONSUPPORT_IN_CURRENT_STATE;
+    }
+
+    // data beyond the link bandwidth is discarded by the flow controller and the channel reports busy
+    pthread_mutex_lock(&s_payloadCameraMutex);
+    nowUs = DjiMock_GetTimeUs();
+    DjiMock_RateMeterAdd(&s_rateBeforeFlowController, len, nowUs);
+    isSent = DjiMock_LinkTryConsume(&s_videoStreamLink, len);
+    DjiMock_RateMeterAdd(&s_rateAfterFlowController, isSent ? len : 0, nowUs);
+    s_isVideoStreamBusy = !isSent;
+    pthread_mutex_unlock(&s_payloadCameraMutex);
+
+    if (isSent) {
+        DjiMock_StreamRecord(&s_videoStream, len, 0);
+    } else {
+        DjiMock_StreamRecordDrop(&s_videoStream, 1);
+    }
+
+    return DJI_ERROR_SYSTEM_MODULE_CODE_SUCCESS;
+}
+
+T_DjiReturnCode DjiPayloadCamera_GetVideoStreamState(T_DjiDataChannelState *state)
+{
+    uint64_t nowUs;
+
+    if (state == NULL) {
+        return DJI_ERROR_SYSTEM_MODULE_CODE_INVALID_PARAMETER;
+    }
+
+    pthread_mutex_lock(&s_payloadCameraMutex);
+    nowUs = DjiMock_GetTimeUs();
+    DjiMock_RateMeterAdd(&s_rateBeforeFlowController, 0, nowUs);
+    DjiMock_RateMeterAdd(&s_rateAfterFlowController, 0, nowUs);
+    state->realtimeBandwidthLimit = s_videoStreamLink.bytesPerSecond > 0 ?
+                                    (int32_t) s_videoStreamLink.bytesPerSecond : INT32_MAX;
+    state->realtimeBandwidthBeforeFlowController = s_rateBeforeFlowController.bytesPerSecond;
+    state->realtimeBandwidthAfterFlowController = s_rateAfterFlowController.bytesPerSecond;
+    state->busyState = s_isVideoStreamBusy;
+    pthread_mutex_unlock(&s_payloadCameraMutex);
+
+    return DJI_ERROR_SYSTEM_MODULE_CODE_SUCCESS;
+}
+
+T_DjiReturnCode DjiPayloadCamera_PushAddedMediaFileInfo(const char *filePath, T_DjiCameraMediaFileInfo mediaFileInfo)
+{
+    DJI_MOCK_UNUSED(mediaFileInfo);
+
+    if (filePath == NULL) {
+        return DJI_ERROR_SYSTEM_MODULE_CODE_INVALID_PARAMETER;
+    }
+
+    USER_LOG_DEBUG("[mock] Added media file %s.", filePath);
+
+    return DJI_ERROR_SYSTEM_MODULE_CODE_SUCCESS;
+}
+
+/* Private functions definition-----------------------------------------------*/
+static void DjiMock_RateMeterAdd(T_DjiMockRateMeter *meter, uint32_t bytes, uint64_t nowUs)
+{
+    if (nowUs - meter->windowStartUs >= DJI_MOCK_PAYLOAD_CAMERA_RATE_WINDOW_US) {
+        meter->bytesPerSecond = meter->windowStartUs == 0 ? 0 :
+                                (int32_t) ((uint64_t) meter->windowBytes * 1000000 /
+                                           (nowUs - meter->windowStartUs));
+        meter->windowStartUs = nowUs;
+        meter->windowBytes = 0;
+    }
+
+    meter->windowBytes += bytes;
+}
+
+static void *DjiMock_PayloadCameraStatePollTask(void *arg)
+{
+    T_DjiCameraSystemState systemState;
+    T_DjiCameraCommonHandler handler;
+    bool isRegistered;
+    uint64_t beginUs;
+
+    DJI_MOCK_UNUSED(arg);
+
+    // the remote controller polls the camera state at a fixed rate, a slow handler shows up as late polls
+    while (s_isStatePollRunning) {
+        pthread_mutex_lock(&s_payloadCameraMutex);
+        handler = s_commonHandler;
+        isRegistered = s_isCommonHandlerRegistered;
+        pthread_mutex_unlock(&s_payloadCameraMutex);
+
+        if (isRegistered && handler.GetSystemState != NULL) {
+            memset(&systemState, 0, sizeof(systemState));
+            beginUs = DjiMock_GetTimeUs();
+            handler.GetSystemState(&systemState);
+            DjiMock_StreamRecord(&s_statePollStream, sizeof(systemState), DjiMock_GetTimeUs() - beginUs);
+        }
+
+        DjiMock_StreamWaitNext(&s_statePollStream);
+    }
+
+    return NULL;
+}
+
+/****************** (C) COPYRIGHT DJI Innovations *****END OF FILE****/
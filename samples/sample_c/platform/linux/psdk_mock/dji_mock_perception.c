@@ -0,0 +1,452 @@
+/**
+ ********************************************************************
+ * @file    dji_mock_perception.c
+ * @brief   Perception of the mock runtime, pushing synthetic stereo image pairs and radar point clouds.
+ *
+ * @copyright (c) 2021 DJI. All rights reserved.
+ *
+ * All information contained herein is, and remains, the property of DJI.
+ * The intellectual and technical concepts contained herein are proprietary
+ * to DJI and may be covered by U.S. and foreign patents, patents in process,
+ * and protected by trade secret or copyright law.  Dissemination of this
+ * information, including but not limited to data and other proprietary
+ * material(s) incorporated within the information, in any form, is strictly
+ * prohibited without the express written consent of DJI.
+ *
+ * If you receive this source code without DJI’s authorization, you may not
+ * further disseminate the information, and you must immediately remove the
+ * source code and notify DJI of its removal. DJI reserves the right to pursue
+ * legal actions against you for any loss(es) or damage(s) caused by your
+ * failure to do so.
+ *
+ *********************************************************************
+ */
+
+/* Includes ------------------------------------------------------------------*/
+#include <math.h>
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "dji_mock_internal.h"
+#include "dji_perception.h"
+
+/* Private constants ---------------------------------------------------------*/
+#define DJI_MOCK_PERCEPTION_BASELINE            (0.1f)
+#define DJI_MOCK_PERCEPTION_MIN_DISPARITY       (8)
+#define DJI_MOCK_PERCEPTION_MAX_DISPARITY       (32)
+#define DJI_MOCK_PERCEPTION_RADAR_FREQ          (10)
+#define DJI_MOCK_PERCEPTION_RADAR_TARGET_NUM    (3)
+#define DJI_MOCK_PERCEPTION_RADAR_TARGET_POINTS (12)
+#define DJI_MOCK_PERCEPTION_RADAR_CLUTTER_NUM   (40)
+#define DJI_MOCK_PERCEPTION_RADAR_POINT_NUM     (DJI_MOCK_PERCEPTION_RADAR_TARGET_NUM * \
+                                                 DJI_MOCK_PERCEPTION_RADAR_TARGET_POINTS + \
+                                                 DJI_MOCK_PERCEPTION_RADAR_CLUTTER_NUM)
+#define DJI_MOCK_PERCEPTION_PI                  (3.14159265358979323846)
+
+/* Private types -------------------------------------------------------------*/
+typedef struct {
+    bool isRunning;
+    pthread_t thread;
+    uint8_t direction;
+    DjiPerceptionImageCallback imageCallback;
+    DjiPerceptionRadarCallback radarCallback;
+    T_DjiMockStream stream;
+} T_DjiMockPerceptionSlot;
+
+/* Private functions declaration ---------------------------------------------*/
+static T_DjiReturnCode DjiMock_PerceptionCreateTemplate(void);
+static T_DjiReturnCode DjiMock_PerceptionStopSlot(T_DjiMockPerceptionSlot *slot);
+static void *DjiMock_PerceptionImageTask(void *arg);
+static void *DjiMock_PerceptionRadarTask(void *arg);
+
+/* Private values -------------------------------------------------------------*/
+static pthread_mutex_t s_perceptionMutex = PTHREAD_MUTEX_INITIALIZER;
+static bool s_isPerceptionInit = false;
+static T_DjiMockPerceptionSlot s_perceptionImageSlotList[IMAGE_MAX_DIRECTION_NUM];
+static T_DjiMockPerceptionSlot s_perceptionRadarSlotList[MAX_RADAR_NUM];
+static uint8_t *s_perceptionLeftTemplate = NULL;
+static uint8_t *s_perceptionRightTemplate = NULL;
+static uint64_t s_perceptionStartTimeUs = 0;
+static const uint32_t s_perceptionLeftPosition[IMAGE_MAX_DIRECTION_NUM] = {
+    RECTIFY_DOWN_LEFT, RECTIFY_FRONT_LEFT, RECTIFY_REAR_LEFT, RECTIFY_UP_LEFT, RECTIFY_LEFT_LEFT, RECTIFY_RIGHT_LEFT,
+};
+static const uint32_t s_perceptionRightPosition[IMAGE_MAX_DIRECTION_NUM] = {
+    RECTIFY_DOWN_RIGHT, RECTIFY_FRONT_RIGHT, RECTIFY_REAR_RIGHT, RECTIFY_UP_RIGHT, RECTIFY_LEFT_RIGHT,
+    RECTIFY_RIGHT_RIGHT,
+};
+
+/* Exported functions definition ---------------------------------------------*/
+T_DjiReturnCode DjiPerception_Init(void)
+{
+    T_DjiReturnCode returnCode;
+
+    returnCode = DjiMock_CheckInit();
+    if (returnCode != DJI_ERROR_SYSTEM_MODULE_CODE_SUCCESS) {
+        return returnCode;
+    }
+
+    if (s_isPerceptionInit) {
+        return DJI_ERROR_SYSTEM_MODULE_CODE_SUCCESS;
+    }
+
+    returnCode = DjiMock_PerceptionCreateTemplate();
+    if (returnCode != DJI_ERROR_SYSTEM_MODULE_CODE_SUCCESS) {
+        return returnCode;
+    }
+
+    memset(s_perceptionImageSlotList, 0, sizeof(s_perceptionImageSlotList));
+    memset(s_perceptionRadarSlotList, 0, sizeof(s_perceptionRadarSlotList));
+    s_perceptionStartTimeUs = DjiMock_GetTimeUs();
+    s_isPerceptionInit = true;
+
+    return DJI_ERROR_SYSTEM_MODULE_CODE_SUCCESS;
+}
+
+T_DjiReturnCode DjiPerception_Deinit(void)
+{
+    uint32_t i;
+
+    if (!s_isPerceptionInit) {
+        return DJI_ERROR_SYSTEM_MODULE_CODE_SUCCESS;
+    }
+
+    for (i = 0; i < IMAGE_MAX_DIRECTION_NUM; i++) {
+        DjiMock_PerceptionStopSlot(&s_perceptionImageSlotList[i]);
+    }
+    for (i = 0; i < MAX_RADAR_NUM; i++) {
+        DjiMock_PerceptionStopSlot(&s_perceptionRadarSlotList[i]);
+    }
+
+    free(s_perceptionLeftTemplate);
+    free(s_perceptionRightTemplate);
+    s_perceptionLeftTemplate = NULL;
+    s_perceptionRightTemplate = NULL;
+    s_isPerceptionInit = false;
+
+    return DJI_ERROR_SYSTEM_MODULE_CODE_SUCCESS;
+}
+
+T_DjiReturnCode DjiPerception_SubscribePerceptionImage(E_DjiPerceptionDirection direction,
+                                                       DjiPerceptionImageCallback callback)
+{
+    const T_DjiMockConfig *config = DjiMock_GetConfig();
+    T_DjiMockPerceptionSlot *slot;
+    char name[DJI_MOCK_STREAM_NAME_MAX_SIZE];
+
+    if (!s_isPerceptionInit) {
+        return DJI_ERROR_SYSTEM_MODULE_CODE_NONSUPPORT_IN_CURRENT_STATE;
+    }
+
+    if ((uint32_t) direction >= IMAGE_MAX_DIRECTION_NUM || callback == NULL) {
+        return DJI_ERROR_SYSTEM_MODULE_CODE_INVALID_PARAMETER;
+    }
+
+    pthread_mutex_lock(&s_perceptionMutex);
+    slot = &s_perceptionImageSlotList[direction];
+    if (slot->isRunning) {
+        pthread_mutex_unlock(&s_perceptionMutex);
+        return DJI_ERROR_SYSTEM_MODULE_CODE_BUSY;
+    }
+
+    slot->direction = (uint8_t) direction;
+    slot->imageCallback = callback;
+    snprintf(name, sizeof(name), "perception.image.%d", direction);
+    DjiMock_StreamInit(&slot->stream, name, config->perceptionFps);
+    slot->isRunning = true;
+    if (pthread_create(&slot->thread, NULL, DjiMock_PerceptionImageTask, slot) != 0) {
+        slot->isRunning = false;
+        pthread_mutex_unlock(&s_perceptionMutex);
+        return DJI_ERROR_SYSTEM_MODULE_CODE_SYSTEM_ERROR;
+    }
+    pthread_mutex_unlock(&s_perceptionMutex);
+
+    return DJI_ERROR_SYSTEM_MODULE_CODE_SUCCESS;
+}
+
+T_DjiReturnCode DjiPerception_UnsubscribePerceptionImage(E_DjiPerceptionDirection direction)
+{
+    if ((uint32_t) direction >= IMAGE_MAX_DIRECTION_NUM) {
+        return DJI_ERROR_SYSTEM_MODULE_CODE_INVALID_PARAMETER;
+    }
+
+    return DjiMock_PerceptionStopSlot(&s_perceptionImageSlotList[direction]);
+}
+
+T_DjiReturnCode DjiPerception_GetStereoCameraParameters(T_DjiPerceptionCameraParametersPacket *packet)
+{
+    const T_DjiMockConfig *config = DjiMock_GetConfig();
+    T_DjiPerceptionCameraParameters *parameters;
+    float focalLength = config->perceptionImageWidth / 2.0f;
+    uint32_t i;
+
+    if (packet == NULL) {
+        return DJI_ERROR_SYSTEM_MODULE_CODE_INVALID_PARAMETER;
+    }
+
+    if (!s_isPerceptionInit) {
+        return DJI_ERROR_SYSTEM_MODULE_CODE_NONSUPPORT_IN_CURRENT_STATE;
+    }
+
+    memset(packet, 0, sizeof(T_DjiPerceptionCameraParametersPacket));
+    packet->timeStamp = (uint32_t) ((DjiMock_GetTimeUs() - s_perceptionStartTimeUs) / 1000);
+    packet->directionNum = IMAGE_MAX_DIRECTION_NUM;
+
+    // rectified pairs with a 90 degree horizontal field of view, the right camera one baseline along x
+    for (i = 0; i < IMAGE_MAX_DIRECTION_NUM; i++) {
+        parameters = &packet->cameraParameters[i];
+        parameters->direction = (uint8_t) i;
+        parameters->leftIntrinsics[0] = focalLength;
+        parameters->leftIntrinsics[2] = config->perceptionImageWidth / 2.0f;
+        parameters->leftIntrinsics[4] = focalLength;
+        parameters->leftIntrinsics[5] = config->perceptionImageHeight / 2.0f;
+        parameters->leftIntrinsics[8] = 1.0f;
+        memcpy(parameters->rightIntrinsics, parameters->leftIntrinsics, sizeof(parameters->rightIntrinsics));
+        parameters->rotationLeftInRight[0] = 1.0f;
+        parameters->rotationLeftInRight[4] = 1.0f;
+        parameters->rotationLeftInRight[8] = 1.0f;
+        parameters->translationLeftInRight[0] = -DJI_MOCK_PERCEPTION_BASELINE;
+    }
+
+    return DJI_ERROR_SYSTEM_MODULE_CODE_SUCCESS;
+}
+
+T_DjiReturnCode DjiPerception_SubscribeLidarData(DjiPerceptionLidarDataCallback callback)
+{
+    DJI_MOCK_UNUSED(callback);
+
+    return DjiMock_Unsupported(__FUNCTION__);
+}
+
+T_DjiReturnCode DjiPerception_UnsubscribeLidarData(void)
+{
+    return DjiMock_Unsupported(__FUNCTION__);
+}
+
+T_DjiReturnCode DjiPerception_SubscribeRadarData(E_DjiPerceptionRadarPosition position,
+                                                 DjiPerceptionRadarCallback callback)
+{
+    T_DjiMockPerceptionSlot *slot;
+    char name[DJI_MOCK_STREAM_NAME_MAX_SIZE];
+
+    if (!s_isPerceptionInit) {
+        return DJI_ERROR_SYSTEM_MODULE_CODE_NONSUPPORT_IN_CURRENT_STATE;
+    }
+
+    if ((uint32_t) position >= MAX_RADAR_NUM || callback == NULL) {
+        return DJI_ERROR_SYSTEM_MODULE_CODE_INVALID_PARAMETER;
+    }
+
+    pthread_mutex_lock(&s_perceptionMutex);
+    slot = &s_perceptionRadarSlotList[position];
+    if (slot->isRunning) {
+        pthread_mutex_unlock(&s_perceptionMutex);
+        return DJI_ERROR_SYSTEM_MODULE_CODE_BUSY;
+    }
+
+    slot->direction = (uint8_t) position;
+    slot->radarCallback = callback;
+    snprintf(name, sizeof(name), "perception.radar.%d", position);
+    DjiMock_StreamInit(&slot->stream, name, DJI_MOCK_PERCEPTION_RADAR_FREQ);
+    slot->isRunning = true;
+    if (pthread_create(&slot->thread, NULL, DjiMock_PerceptionRadarTask, slot) != 0) {
+        slot->isRunning = false;
+        pthread_mutex_unlock(&s_perceptionMutex);
+        return DJI_ERROR_SYSTEM_MODULE_CODE_SYSTEM_ERROR;
+    }
+    pthread_mutex_unlock(&s_perceptionMutex);
+
+    return DJI_ERROR_SYSTEM_MODULE_CODE_SUCCESS;
+}
+
+T_DjiReturnCode DjiPerception_UnsubscribeRadarData(E_DjiPerceptionRadarPosition position)
+{
+    if ((uint32_t) position >= MAX_RADAR_NUM) {
+        return DJI_ERROR_SYSTEM_MODULE_CODE_INVALID_PARAMETER;
+    }
+
+    return DjiMock_PerceptionStopSlot(&s_perceptionRadarSlotList[position]);
+}
+
+/* Private functions definition-----------------------------------------------*/
+static T_DjiReturnCode DjiMock_PerceptionCreateTemplate(void)
+{
+    const T_DjiMockConfig *config = DjiMock_GetConfig();
+    uint32_t width = config->perceptionImageWidth;
+    uint32_t height = config->perceptionImageHeight;
+    uint64_t seed = 0x2545F4914F6CDD1DULL;
+    uint32_t disparity;
+    uint32_t x;
+    uint32_t y;
+
+    s_perceptionLeftTemplate = malloc(width * height);
+    s_perceptionRightTemplate = malloc(width * height);
+    if (s_perceptionLeftTemplate == NULL || s_perceptionRightTemplate == NULL) {
+        free(s_perceptionLeftTemplate);
+        free(s_perceptionRightTemplate);
+        s_perceptionLeftTemplate = NULL;
+        s_perceptionRightTemplate = NULL;
+        return DJI_ERROR_SYSTEM_MODULE_CODE_MEMORY_ALLOC_FAILED;
+    }
+
+    // random dot texture in 2x2 blocks on a slanted plane, the disparity grows linearly from the top row to the
+    // bottom row, so the right image is the left image shifted by a known amount per row
+    for (y = 0; y < height; y++) {
+        for (x = 0; x < width; x++) {
+            if ((y & 1) == 0 && (x & 1) == 0) {
+                s_perceptionLeftTemplate[y * width + x] = (uint8_t) DjiMock_Random(&seed);
+            } else {
+                s_perceptionLeftTemplate[y * width + x] = s_perceptionLeftTemplate[(y & ~1u) * width + (x & ~1u)];
+            }
+        }
+    }
+
+    for (y = 0; y < height; y++) {
+        disparity = DJI_MOCK_PERCEPTION_MIN_DISPARITY +
+                    (DJI_MOCK_PERCEPTION_MAX_DISPARITY - DJI_MOCK_PERCEPTION_MIN_DISPARITY) * y /
+                    DJI_MOCK_MAX(height - 1, 1);
+        for (x = 0; x < width; x++) {
+            s_perceptionRightTemplate[y * width + x] = x + disparity < width ?
+                                                       s_perceptionLeftTemplate[y * width + x + disparity] : 0;
+        }
+    }
+
+    return DJI_ERROR_SYSTEM_MODULE_CODE_SUCCESS;
+}
+
+static T_DjiReturnCode DjiMock_PerceptionStopSlot(T_DjiMockPerceptionSlot *slot)
+{
+    pthread_mutex_lock(&s_perceptionMutex);
+    if (!slot->isRunning) {
+        pthread_mutex_unlock(&s_perceptionMutex);
+        return DJI_ERROR_SYSTEM_MODULE_CODE_NONSUPPORT_IN_CURRENT_STATE;
+    }
+    slot->isRunning = false;
+    pthread_mutex_unlock(&s_perceptionMutex);
+
+    pthread_join(slot->thread, NULL);
+
+    return DJI_ERROR_SYSTEM_MODULE_CODE_SUCCESS;
+}
+
+static void *DjiMock_PerceptionImageTask(void *arg)
+{
+    T_DjiMockPerceptionSlot *slot = (T_DjiMockPerceptionSlot *) arg;
+    const T_DjiMockConfig *config = DjiMock_GetConfig();
+    uint32_t imageSize = config->perceptionImageWidth * config->perceptionImageHeight;
+    T_DjiPerceptionImageInfo imageInfo;
+    uint8_t *image;
+    uint16_t sequence = 0;
+    uint32_t index = 0;
+    uint64_t beginUs;
+    int side;
+
+    image = malloc(imageSize);
+    if (image == NULL) {
+        USER_LOG_ERROR("[mock] Malloc perception image failed.");
+        slot->isRunning = false;
+        return NULL;
+    }
+
+    while (slot->isRunning) {
+        // the left and right images of a pair share the sequence and timestamp
+        memset(&imageInfo, 0, sizeof(imageInfo));
+        imageInfo.rawInfo.direction = slot->direction;
+        imageInfo.rawInfo.bpp = 8;
+        imageInfo.rawInfo.width = config->perceptionImageWidth;
+        imageInfo.rawInfo.height = config->perceptionImageHeight;
+        imageInfo.sequence = sequence++;
+        imageInfo.timeStamp = (DjiMock_GetTimeUs() - s_perceptionStartTimeUs) / 1000;
+
+        for (side = 0; side < 2; side++) {
+            imageInfo.rawInfo.index = index++;
+            imageInfo.dataId = (uint16_t) imageInfo.rawInfo.index;
+            imageInfo.dataType = side == 0 ? s_perceptionLeftPosition[slot->direction] :
+                                 s_perceptionRightPosition[slot->direction];
+            memcpy(image, side == 0 ? s_perceptionLeftTemplate : s_perceptionRightTemplate, imageSize);
+
+            beginUs = DjiMock_GetTimeUs();
+            slot->imageCallback(imageInfo, image, imageSize);
+            DjiMock_StreamRecord(&slot->stream, imageSize, DjiMock_GetTimeUs() - beginUs);
+        }
+
+        DjiMock_StreamWaitNext(&slot->stream);
+    }
+
+    free(image);
+
+    return NULL;
+}
+
+static void *DjiMock_PerceptionRadarTask(void *arg)
+{
+    T_DjiMockPerceptionSlot *slot = (T_DjiMockPerceptionSlot *) arg;
+    uint32_t frameSize = sizeof(T_DjiRadarDataHeader) +
+                         DJI_MOCK_PERCEPTION_RADAR_POINT_NUM * sizeof(T_DjiRadarCloudUnit);
+    T_DjiRadarDataFrame *frame;
+    T_DjiRadarCloudUnit *unit;
+    uint64_t seed = 0xD1B54A32D192ED03ULL + slot->direction;
+    double elapsedTime;
+    double azimuth;
+    double elevation;
+    double radius;
+    double velocity;
+    uint32_t target;
+    uint32_t i;
+    uint64_t beginUs;
+
+    frame = malloc(frameSize);
+    if (frame == NULL) {
+        USER_LOG_ERROR("[mock] Malloc radar frame failed.");
+        slot->isRunning = false;
+        return NULL;
+    }
+
+    while (slot->isRunning) {
+        elapsedTime = (DjiMock_GetTimeUs() - s_perceptionStartTimeUs) / 1000000.0;
+        memset(frame, 0, frameSize);
+        // dataLen counts the point units that follow the header, as the radar sends it
+        frame->headInfo.dataLen = DJI_MOCK_PERCEPTION_RADAR_POINT_NUM;
+        frame->headInfo.curPack = 1;
+        frame->headInfo.packNum = 1;
+
+        // a few targets approaching and receding on slow arcs, each a small cluster, then uniform clutter
+        for (i = 0; i < DJI_MOCK_PERCEPTION_RADAR_POINT_NUM; i++) {
+            unit = &frame->data[i];
+            if (i < DJI_MOCK_PERCEPTION_RADAR_TARGET_NUM * DJI_MOCK_PERCEPTION_RADAR_TARGET_POINTS) {
+                target = i / DJI_MOCK_PERCEPTION_RADAR_TARGET_POINTS;
+                radius = 15.0 + 10.0 * sin(0.2 * elapsedTime + target * 2.1) +
+                         ((int32_t) (DjiMock_Random(&seed) % 61) - 30) / 100.0;
+                velocity = -2.0 * cos(0.2 * elapsedTime + target * 2.1);
+                azimuth = (target - 1.0) * 0.4 + 0.1 * sin(0.1 * elapsedTime) +
+                          ((int32_t) (DjiMock_Random(&seed) % 41) - 20) / 1000.0;
+                elevation = ((int32_t) (DjiMock_Random(&seed) % 41) - 20) / 1000.0;
+                unit->base_info.snr = 30 + DjiMock_Random(&seed) % 20;
+            } else {
+                radius = 1.0 + (DjiMock_Random(&seed) % 4000) / 100.0;
+                velocity = 0.0;
+                azimuth = ((int32_t) (DjiMock_Random(&seed) % 1571) - 785) / 1000.0;
+                elevation = ((int32_t) (DjiMock_Random(&seed) % 401) - 200) / 1000.0;
+                unit->base_info.snr = 3 + DjiMock_Random(&seed) % 8;
+                unit->base_info.clitterFlag = 1;
+            }
+            unit->azimuth = (uint16_t) ((azimuth + 2 * DJI_MOCK_PERCEPTION_PI) * 1000);
+            unit->elevation = (uint16_t) ((elevation + 2 * DJI_MOCK_PERCEPTION_PI) * 1000);
+            unit->radius = (uint16_t) (radius * 100);
+            unit->ene = (uint16_t) (unit->base_info.snr * 100);
+            unit->base_info.velocity = (uint16_t) (velocity * 100 + 32767);
+        }
+
+        beginUs = DjiMock_GetTimeUs();
+        slot->radarCallback((E_DjiPerceptionRadarPosition) slot->direction, (uint8_t *) frame, frameSize);
+        DjiMock_StreamRecord(&slot->stream, frameSize, DjiMock_GetTimeUs() - beginUs);
+
+        DjiMock_StreamWaitNext(&slot->stream);
+    }
+
+    free(frame);
+
+    return NULL;
+}
+
+/****************** (C) COPYRIGHT DJI Innovations *****END OF FILE****/
@@ -0,0 +1,271 @@
+/**
+ ********************************************************************
+ * @file    dji_mock_stream.c
+ * @brief   Pacing, link emulation and statistics shared by the streams of the mock runtime.
+ *
+ * @copyright (c) 2021 DJI. All rights reserved.
+ *
+ * All information contained herein is, and remains, the property of DJI.
+ * The intellectual and technical concepts contained herein are proprietary
+ * to DJI and may be covered by U.S. and foreign patents, patents in process,
+ * and protected by trade secret or copyright law.  Dissemination of this
+ * information, including but not limited to data and other proprietary
+ * material(s) incorporated within the information, in any form, is strictly
+ * prohibited without the express written consent of DJI.
+ *
+ * If you receive this source code without DJI’s authorization, you may not
+ * further disseminate the information, and you must immediately remove the
+ * source code and notify DJI of its removal. DJI reserves the right to pursue
+ * legal actions against you for any loss(es) or damage(s) caused by your
+ * failure to do so.
+ *
+ *********************************************************************
+ */
+
+/* Includes ------------------------------------------------------------------*/
+#include <pthread.h>
+#include <string.h>
+#include <time.h>
+#include <errno.h>
+#include "dji_mock_internal.h"
+
+/* Private constants ---------------------------------------------------------*/
+#define DJI_MOCK_LINK_BURST_TIME_MS     (20)
+#define DJI_MOCK_LINK_MIN_BURST_BYTES   (4096)
+
+/* Private types -------------------------------------------------------------*/
+
+/* Private functions declaration ---------------------------------------------*/
+
+/* Private values -------------------------------------------------------------*/
+static pthread_mutex_t s_streamMutex = PTHREAD_MUTEX_INITIALIZER;
+static T_DjiMockStream *s_streamList[DJI_MOCK_STREAM_MAX_NUM];
+static uint32_t s_streamCount = 0;
+
+/* Exported functions definition ---------------------------------------------*/
+uint64_t DjiMock_GetTimeUs(void)
+{
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+
+    return (uint64_t) ts.tv_sec * 1000000 + (uint64_t) ts.tv_nsec / 1000;
+}
+
+void DjiMock_SleepUntilUs(uint64_t timeUs)
+{
+    struct timespec ts;
+
+    ts.tv_sec = (time_t) (timeUs / 1000000);
+    ts.tv_nsec = (long) (timeUs % 1000000) * 1000;
+
+    while (clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &ts, NULL) == EINTR) {
+    }
+}
+
+void DjiMock_StreamInit(T_DjiMockStream *stream, const char *name, uint32_t frequency)
+{
+    uint32_t i;
+
+    pthread_mutex_lock(&s_streamMutex);
+    memset(stream, 0, sizeof(T_DjiMockStream));
+    strncpy(stream->statistics.name, name, DJI_MOCK_STREAM_NAME_MAX_SIZE - 1);
+    stream->periodUs = frequency > 0 ? 1000000 / frequency : 0;
+    stream->startTimeUs = DjiMock_GetTimeUs();
+    stream->nextDeadlineUs = stream->startTimeUs;
+
+    for (i = 0; i < s_streamCount; i++) {
+        if (s_streamList[i] == stream) {
+            break;
+        }
+    }
+    if (i == s_streamCount && s_streamCount < DJI_MOCK_STREAM_MAX_NUM) {
+        s_streamList[s_streamCount++] = stream;
+    }
+    pthread_mutex_unlock(&s_streamMutex);
+}
+
+void DjiMock_StreamSetFrequency(T_DjiMockStream *stream, uint32_t frequency)
+{
+    pthread_mutex_lock(&s_streamMutex);
+    stream->periodUs = frequency > 0 ? 1000000 / frequency : 0;
+    stream->nextDeadlineUs = DjiMock_GetTimeUs();
+    pthread_mutex_unlock(&s_streamMutex);
+}
+
+void DjiMock_StreamWaitNext(T_DjiMockStream *stream)
+{
+    uint64_t nowUs;
+
+    if (stream->periodUs == 0) {
+        return;
+    }
+
+    stream->nextDeadlineUs += stream->periodUs;
+    nowUs = DjiMock_GetTimeUs();
+    if (nowUs < stream->nextDeadlineUs) {
+        DjiMock_SleepUntilUs(stream->nextDeadlineUs);
+        return;
+    }
+
+    pthread_mutex_lock(&s_streamMutex);
+    stream->statistics.lateCount++;
+    if (nowUs >= stream->nextDeadlineUs + stream->periodUs) {
+        stream->statistics.dropCount += (nowUs - stream->nextDeadlineUs) / stream->periodUs;
+        stream->nextDeadlineUs = nowUs;
+    }
+    pthread_mutex_unlock(&s_streamMutex);
+}
+
+void DjiMock_StreamRecord(T_DjiMockStream *stream, uint32_t bytes, uint64_t callbackTimeUs)
+{
+    pthread_mutex_lock(&s_streamMutex);
+    stream->statistics.messageCount++;
+    stream->statistics.byteCount += bytes;
+    stream->callbackTimeTotalUs += callbackTimeUs;
+    if (callbackTimeUs > stream->statistics.callbackTimeMaxUs) {
+        stream->statistics.callbackTimeMaxUs = (uint32_t) callbackTimeUs;
+    }
+    pthread_mutex_unlock(&s_streamMutex);
+}
+
+void DjiMock_StreamRecordDrop(T_DjiMockStream *stream, uint32_t count)
+{
+    pthread_mutex_lock(&s_streamMutex);
+    stream->statistics.dropCount += count;
+    pthread_mutex_unlock(&s_streamMutex);
+}
+
+void DjiMock_StreamRecordLate(T_DjiMockStream *stream, uint32_t count)
+{
+    pthread_mutex_lock(&s_streamMutex);
+    stream->statistics.lateCount += count;
+    pthread_mutex_unlock(&s_streamMutex);
+}
+
+void DjiMock_StreamDeinit(T_DjiMockStream *stream)
+{
+    uint32_t i;
+
+    pthread_mutex_lock(&s_streamMutex);
+    for (i = 0; i < s_streamCount; i++) {
+        if (s_streamList[i] == stream) {
+            s_streamList[i] = s_streamList[--s_streamCount];
+            break;
+        }
+    }
+    pthread_mutex_unlock(&s_streamMutex);
+}
+
+T_DjiReturnCode DjiMock_GetStreamStatistics(T_DjiMockStreamStatistics *statistics, uint32_t maxCount,
+                                            uint32_t *count)
+{
+    uint32_t i;
+    uint64_t nowUs = DjiMock_GetTimeUs();
+    T_DjiMockStream *stream;
+
+    if (statistics == NULL || count == NULL) {
+        return DJI_ERROR_SYSTEM_MODULE_CODE_INVALID_PARAMETER;
+    }
+
+    pthread_mutex_lock(&s_streamMutex);
+    for (i = 0; i < s_streamCount && i < maxCount; i++) {
+        stream = s_streamList[i];
+        statistics[i] = stream->statistics;
+        statistics[i].runTimeMs = (uint32_t) ((nowUs - stream->startTimeUs) / 1000);
+        statistics[i].callbackTimeAvgUs = stream->statistics.messageCount > 0 ?
+                                          (uint32_t) (stream->callbackTimeTotalUs /
+                                                      stream->statistics.messageCount) : 0;
+    }
+    *count = i;
+    pthread_mutex_unlock(&s_streamMutex);
+
+    return DJI_ERROR_SYSTEM_MODULE_CODE_SUCCESS;
+}
+
+void DjiMock_StreamReport(void)
+{
+    T_DjiMockStreamStatistics statistics[DJI_MOCK_STREAM_MAX_NUM];
+    uint32_t count = 0;
+    uint32_t i;
+    double seconds;
+
+    DjiMock_GetStreamStatistics(statistics, DJI_MOCK_STREAM_MAX_NUM, &count);
+    for (i = 0; i < count; i++) {
+        seconds = statistics[i].runTimeMs > 0 ? statistics[i].runTimeMs / 1000.0 : 1.0;
+        USER_LOG_INFO("[mock] %-20s msg %8llu  %8.1f msg/s  %9.1f KB/s  cb avg %6u us max %7u us  late %llu drop %llu",
+                      statistics[i].name, (unsigned long long) statistics[i].messageCount,
+                      statistics[i].messageCount / seconds, statistics[i].byteCount / seconds / 1024.0,
+                      statistics[i].callbackTimeAvgUs, statistics[i].callbackTimeMaxUs,
+                      (unsigned long long) statistics[i].lateCount, (unsigned long long) statistics[i].dropCount);
+    }
+}
+
+void DjiMock_LinkInit(T_DjiMockLink *link, uint32_t bandwidthKbps)
+{
+    link->bytesPerSecond = bandwidthKbps * 1000 / 8;
+    link->burstBytes = DJI_MOCK_MAX(link->bytesPerSecond / (1000 / DJI_MOCK_LINK_BURST_TIME_MS),
+                                    DJI_MOCK_LINK_MIN_BURST_BYTES);
+    link->tokens = link->burstBytes;
+    link->lastTimeUs = DjiMock_GetTimeUs();
+}
+
+uint32_t DjiMock_LinkAvailable(T_DjiMockLink *link)
+{
+    uint64_t nowUs;
+
+    if (link->bytesPerSecond == 0) {
+        return UINT32_MAX;
+    }
+
+    nowUs = DjiMock_GetTimeUs();
+    link->tokens += (double) (nowUs - link->lastTimeUs) * link->bytesPerSecond / 1000000.0;
+    if (link->tokens > link->burstBytes) {
+        link->tokens = link->burstBytes;
+    }
+    link->lastTimeUs = nowUs;
+
+    return link->tokens > 0 ? (uint32_t) link->tokens : 0;
+}
+
+void DjiMock_LinkWait(T_DjiMockLink *link, uint32_t bytes)
+{
+    if (link->bytesPerSecond == 0) {
+        return;
+    }
+
+    DjiMock_LinkAvailable(link);
+    link->tokens -= bytes;
+    if (link->tokens < 0) {
+        DjiMock_SleepUntilUs(link->lastTimeUs + (uint64_t) (-link->tokens * 1000000.0 / link->bytesPerSecond));
+    }
+}
+
+bool DjiMock_LinkTryConsume(T_DjiMockLink *link, uint32_t bytes)
+{
+    if (DjiMock_LinkAvailable(link) < bytes) {
+        return false;
+    }
+
+    if (link->bytesPerSecond != 0) {
+        link->tokens -= bytes;
+    }
+
+    return true;
+}
+
+uint32_t DjiMock_Random(uint64_t *state)
+{
+    uint64_t x = *state;
+
+    x ^= x >> 12;
+    x ^= x << 25;
+    x ^= x >> 27;
+    *state = x;
+
+    return (uint32_t) ((x * 0x2545F4914F6CDD1DULL) >> 32);
+}
+
+/* Private functions definition-----------------------------------------------*/
+
+/****************** (C) COPYRIGHT DJI Innovations *****END OF FILE****/
@@ -0,0 +1,1529 @@
+/**
+ ********************************************************************
+ * @file    dji_mock_unsupported.c
+ * @brief   Modules of the public API not emulated by the mock runtime, returning unsupported so that the samples
+ * using them link and fail softly.
+ *
+ * @copyright (c) 2021 DJI. All rights reserved.
+ *
+ * All information contained herein is, and remains, the property of DJI.
+ * The intellectual and technical concepts contained herein are proprietary
+ * to DJI and may be covered by U.S. and foreign patents, patents in process,
+ * and protected by trade secret or copyright law.  Dissemination of this
+ * information, including but not limited to data and other proprietary
+ * material(s) incorporated within the information, in any form, is strictly
+ * prohibited without the express written consent of DJI.
+ *
+ * If you receive this source code without DJI’s authorization, you may not
+ * further disseminate the information, and you must immediately remove the
+ * source code and notify DJI of its removal. DJI reserves the right to pursue
+ * legal actions against you for any loss(es) or damage(s) caused by your
+ * failure to do so.
+ *
+ *********************************************************************
+ */
+
+/* Includes ------------------------------------------------------------------*/
+#include "dji_camera_manager.h"
+#include "dji_cloud_api_by_websockt.h"
+#include "dji_flight_controller.h"
+#include "dji_gimbal.h"
+#include "dji_gimbal_manager.h"
+#include "dji_high_speed_data_channel.h"
+#include "dji_hms_customization.h"
+#include "dji_hms_manager.h"
+#include "dji_interest_point.h"
+#include "dji_low_speed_data_channel.h"
+#include "dji_network_rtk.h"
+#include "dji_open_ar.h"
+#include "dji_payload_camera.h"
+#include "dji_positioning.h"
+#include "dji_power_management.h"
+#include "dji_tethered_battery.h"
+#include "dji_time_sync.h"
+#include "dji_upgrade.h"
+#include "dji_waypoint_v2.h"
+#include "dji_waypoint_v3.h"
+#include "dji_widget.h"
+#include "dji_widget_manager.h"
+#include "dji_xport.h"
+#include "dji_mock_internal.h"
+
+/* Private constants ---------------------------------------------------------*/
+
+/* Private types -------------------------------------------------------------*/
+
+/* Private functions declaration ---------------------------------------------*/
+
+/* Private values -------------------------------------------------------------*/
+
+/* Exported functions definition ---------------------------------------------*/
+// dji_camera_manager.h
+T_DjiReturnCode DjiCameraManager_SetPhotoBurstCount(E_DjiMountPosition position, E_DjiCameraBurstCount count)
+{
+    return DjiMock_Unsupported(__FUNCTION__);
+}
+
+T_DjiReturnCode DjiCameraManager_SetPhotoTimeIntervalSettings(E_DjiMountPosition position,
+                                                              T_DjiCameraPhotoTimeIntervalSettings intervalSetting)
+{
+    return DjiMock_Unsupported(__FUNCTION__);
+}
+
+T_DjiReturnCode DjiCameraManager_GetPhotoTimeIntervalSettings(E_DjiMountPosition position,
+                                                              T_DjiCameraPhotoTimeIntervalSettings *intervalSetting)
+{
+    return DjiMock_Unsupported(__FUNCTION__);
+}
+
+T_DjiReturnCode DjiCameraManager_GetIntervalShootingRemainTime(E_DjiMountPosition position, uint8_t *remainTime)
+{
+    return DjiMock_Unsupported(__FUNCTION__);
+}
+
+T_DjiReturnCode DjiCameraManager_SetFocusMode(E_DjiMountPosition position, E_DjiCameraManagerFocusMode focusMode)
+{
+    return DjiMock_Unsupported(__FUNCTION__);
+}
+
+T_DjiReturnCode DjiCameraManager_GetFocusMode(E_DjiMountPosition position, E_DjiCameraManagerFocusMode *focusMode)
+{
+    return DjiMock_Unsupported(__FUNCTION__);
+}
+
+T_DjiReturnCode DjiCameraManager_SetFocusTarget(E_DjiMountPosition position,
+                                                T_DjiCameraManagerFocusPosData focusPosData)
+{
+    return DjiMock_Unsupported(__FUNCTION__);
+}
+
+T_DjiReturnCode DjiCameraManager_GetFocusTarget(E_DjiMountPosition position,
+                                                T_DjiCameraManagerFocusPosData *tapFocusPos)
+{
+    return DjiMock_Unsupported(__FUNCTION__);
+}
+
+T_DjiReturnCode DjiCameraManager_StartContinuousOpticalZoom(E_DjiMountPosition position,
+                                                            E_DjiCameraZoomDirection zoomDirection,
+                                                            E_DjiCameraZoomSpeed zoomSpeed)
+{
+    return DjiMock_Unsupported(__FUNCTION__);
+}
+
+T_DjiReturnCode DjiCameraManager_StopContinuousOpticalZoom(E_DjiMountPosition position)
+{
+    return DjiMock_Unsupported(__FUNCTION__);
+}
+
+T_DjiReturnCode DjiCameraManager_SetInfraredZoomParam(E_DjiMountPosition position, dji_f32_t factor)
+{
+    return DjiMock_Unsupported(__FUNCTION__);
+}
+
+T_DjiReturnCode DjiCameraManager_SetTapZoomEnabled(E_DjiMountPosition position, bool param)
+{
+    return DjiMock_Unsupported(__FUNCTION__);
+}
+
+T_DjiReturnCode DjiCameraManager_GetTapZoomEnabled(E_DjiMountPosition position, bool *param)
+{
+    return DjiMock_Unsupported(__FUNCTION__);
+}
+
+T_DjiReturnCode DjiCameraManager_SetTapZoomMultiplier(E_DjiMountPosition position, uint8_t tapZoomMultiplier)
+{
+    return DjiMock_Unsupported(__FUNCTION__);
+}
+
+T_DjiReturnCode DjiCameraManager_GetTapZoomMultiplier(E_DjiMountPosition position, uint8_t *tapZoomMultiplier)
+{
+    return DjiMock_Unsupported(__FUNCTION__);
+}
+
+T_DjiReturnCode DjiCameraManager_TapZoomAtTarget(E_DjiMountPosition position,
+                                                 T_DjiCameraManagerTapZoomPosData tapZoomPos)
+{
+    return DjiMock_Unsupported(__FUNCTION__);
+}
+
+T_DjiReturnCode DjiCameraManager_GetFocusRingRange(E_DjiMountPosition position, T_DjiCameraManagerRangeList *rangeList)
+{
+    return DjiMock_Unsupported(__FUNCTION__);
+}
+
+T_DjiReturnCode DjiCameraManager_SetFocusRingValue(E_DjiMountPosition position, uint16_t value)
+{
+    return DjiMock_Unsupported(__FUNCTION__);
+}
+
+T_DjiReturnCode DjiCameraManager_GetFocusRingValue(E_DjiMountPosition position, uint16_t *value)
+{
+    return DjiMock_Unsupported(__FUNCTION__);
+}
+
+T_DjiReturnCode DjiCameraManager_SetExposureMode(E_DjiMountPosition position, E_DjiCameraManagerExposureMode mode)
+{
+    return DjiMock_Unsupported(__FUNCTION__);
+}
+
+T_DjiReturnCode DjiCameraManager_GetExposureMode(E_DjiMountPosition position, E_DjiCameraManagerExposureMode *mode)
+{
+    return DjiMock_Unsupported(__FUNCTION__);
+}
+
+T_DjiReturnCode DjiCameraManager_SetISO(E_DjiMountPosition position, E_DjiCameraManagerISO iso)
+{
+    return DjiMock_Unsupported(__FUNCTION__);
+}
+
+T_DjiReturnCode DjiCameraManager_GetISO(E_DjiMountPosition position, E_DjiCameraManagerISO *iso)
+{
+    return DjiMock_Unsupported(__FUNCTION__);
+}
+
+T_DjiReturnCode DjiCameraManager_SetAperture(E_DjiMountPosition position, E_DjiCameraManagerAperture aperture)
+{
+    return DjiMock_Unsupported(__FUNCTION__);
+}
+
+T_DjiReturnCode DjiCameraManager_GetAperture(E_DjiMountPosition position, E_DjiCameraManagerAperture *aperture)
+{
+    return DjiMock_Unsupported(__FUNCTION__);
+}
+
+T_DjiReturnCode DjiCameraManager_SetShutterSpeed(E_DjiMountPosition position,
+                                                 E_DjiCameraManagerShutterSpeed shutterSpeed)
+{
+    return DjiMock_Unsupported(__FUNCTION__);
+}
+
+T_DjiReturnCode DjiCameraManager_GetShutterSpeed(E_DjiMountPosition position,
+                                                 E_DjiCameraManagerShutterSpeed *shutterSpeed)
+{
+    return DjiMock_Unsupported(__FUNCTION__);
+}
+
+T_DjiReturnCode DjiCameraManager_SetExposureCompensation(E_DjiMountPosition position,
+                                                         E_DjiCameraManagerExposureCompensation ev)
+{
+    return DjiMock_Unsupported(__FUNCTION__);
+}
+
+T_DjiReturnCode DjiCameraManager_GetExposureCompensation(E_DjiMountPosition position,
+                                                         E_DjiCameraManagerExposureCompensation *ev)
+{
+    return DjiMock_Unsupported(__FUNCTION__);
+}
+
+T_DjiReturnCode DjiCameraManager_SetAELockEnabled(E_DjiMountPosition position, bool enable)
+{
+    return DjiMock_Unsupported(__FUNCTION__);
+}
+
+T_DjiReturnCode DjiCameraManager_GetAELockEnabled(E_DjiMountPosition position, bool *enable)
+{
+    return DjiMock_Unsupported(__FUNCTION__);
+}
+
+T_DjiReturnCode DjiCameraManager_ResetCameraSettings(E_DjiMountPosition position)
+{
+    return DjiMock_Unsupported(__FUNCTION__);
+}
+
+T_DjiReturnCode DjiCameraManager_GetStreamSourceRange(E_DjiMountPosition position,
+                                                      T_DjiCameraManagerRangeList *rangeList)
+{
+    return DjiMock_Unsupported(__FUNCTION__);
+}
+
+T_DjiReturnCode DjiCameraManager_SetStreamSource(E_DjiMountPosition position,
+                                                 E_DjiCameraManagerStreamSource streamSource)
+{
+    return DjiMock_Unsupported(__FUNCTION__);
+}
+
+T_DjiReturnCode DjiCameraManager_GetPhotoStorageFormatRange(E_DjiMountPosition position,
+                                                            T_DjiCameraManagerRangeList *rangeList)
+{
+    return DjiMock_Unsupported(__FUNCTION__);
+}
+
+T_DjiReturnCode DjiCameraManager_SetPhotoFormat(E_DjiMountPosition position,
+                                                E_DjiCameraManagerPhotoStorageFormat format)
+{
+    return DjiMock_Unsupported(__FUNCTION__);
+}
+
+T_DjiReturnCode DjiCameraManager_GetPhotoFormat(E_DjiMountPosition position,
+                                                E_DjiCameraManagerPhotoStorageFormat *format)
+{
+    return DjiMock_Unsupported(__FUNCTION__);
+}
+
+T_DjiReturnCode DjiCameraManager_GetVideoFormatRange(E_DjiMountPosition position,
+                                                     T_DjiCameraManagerRangeList *rangeList)
+{
+    return DjiMock_Unsupported(__FUNCTION__);
+}
+
+T_DjiReturnCode DjiCameraManager_SetVideoStorageFormat(E_DjiMountPosition position,
+                                                       E_DjiCameraManagerVideoStorageFormat format)
+{
+    return DjiMock_Unsupported(__FUNCTION__);
+}
+
+T_DjiReturnCode DjiCameraManager_GetVideoFormat(E_DjiMountPosition position,
+                                                E_DjiCameraManagerVideoStorageFormat *format)
+{
+    return DjiMock_Unsupported(__FUNCTION__);
+}
+
+T_DjiReturnCode DjiCameraManager_GetPhotoRatioRange(E_DjiMountPosition position, T_DjiCameraManagerRangeList *rangeList)
+{
+    return DjiMock_Unsupported(__FUNCTION__);
+}
+
+T_DjiReturnCode DjiCameraManager_SetPhotoRatio(E_DjiMountPosition position, E_DjiCameraManagerPhotoRatio photoRatio)
+{
+    return DjiMock_Unsupported(__FUNCTION__);
+}
+
+T_DjiReturnCode DjiCameraManager_GetPhotoRatio(E_DjiMountPosition position, E_DjiCameraManagerPhotoRatio *photoRatio)
+{
+    return DjiMock_Unsupported(__FUNCTION__);
+}
+
+T_DjiReturnCode DjiCameraManager_GetVideoResolutionFrameRate(E_DjiMountPosition position,
+                                                             T_DjiCameraManagerVideoFormat *videoParam)
+{
+    return DjiMock_Unsupported(__FUNCTION__);
+}
+
+T_DjiReturnCode DjiCameraManager_GetNightSceneModeRange(E_DjiMountPosition position,
+                                                        T_DjiCameraManagerRangeList *rangeList)
+{
+    return DjiMock_Unsupported(__FUNCTION__);
+}
+
+T_DjiReturnCode DjiCameraManager_SetNightSceneMode(E_DjiMountPosition position,
+                                                   E_DjiCameraManagerNightSceneMode nightSceneMode)
+{
+    return DjiMock_Unsupported(__FUNCTION__);
+}
+
+T_DjiReturnCode DjiCameraManager_GetNightSceneMode(E_DjiMountPosition position,
+                                                   E_DjiCameraManagerNightSceneMode *nightSceneMode)
+{
+    return DjiMock_Unsupported(__FUNCTION__);
+}
+
+T_DjiReturnCode DjiCameraManager_GetStreamStorageRange(E_DjiMountPosition position,
+                                                       T_DjiCameraManagerRangeList *rangeList)
+{
+    return DjiMock_Unsupported(__FUNCTION__);
+}
+
+T_DjiReturnCode DjiCameraManager_SetCaptureRecordingStreams(E_DjiMountPosition position,
+                                                            E_DjiCameraManagerCaptureOrRecording streamType,
+                                                            T_DjiCameraManagerStreamList *streamStorageList)
+{
+    return DjiMock_Unsupported(__FUNCTION__);
+}
+
+T_DjiReturnCode DjiCameraManager_GetCaptureRecordingStreams(E_DjiMountPosition position,
+                                                            E_DjiCameraManagerCaptureOrRecording streamType,
+                                                            T_DjiCameraManagerStreamList *streamStorageList)
+{
+    return DjiMock_Unsupported(__FUNCTION__);
+}
+
+T_DjiReturnCode DjiCameraManager_SetSynchronizedSplitScreenZoomEnabled(E_DjiMountPosition position, bool enable)
+{
+    return DjiMock_Unsupported(__FUNCTION__);
+}
+
+T_DjiReturnCode DjiCameraManager_SetCustomExpandName(E_DjiMountPosition position,
+                                                     E_DjiCameraManagerExpandNameType nameType, const uint8_t *nameStr,
+                                                     uint32_t nameSize)
+{
+    return DjiMock_Unsupported(__FUNCTION__);
+}
+
+T_DjiReturnCode DjiCameraManager_GetCustomExpandName(E_DjiMountPosition position,
+                                                     E_DjiCameraManagerExpandNameType nameType, uint8_t *nameStr,
+                                                     uint32_t *nameSize)
+{
+    return DjiMock_Unsupported(__FUNCTION__);
+}
+
+T_DjiReturnCode DjiCameraManager_DownloadSubFileByIndexAndSubType(E_DjiMountPosition position, uint32_t index,
+                                                                  E_DjiCameraMediaFileSubType fileType)
+{
+    return DjiMock_Unsupported(__FUNCTION__);
+}
+
+T_DjiReturnCode DjiCameraManager_GetLaserRangingInfo(E_DjiMountPosition position,
+                                                     T_DjiCameraManagerLaserRangingInfo *laserRangingInfo)
+{
+    return DjiMock_Unsupported(__FUNCTION__);
+}
+
+T_DjiReturnCode DjiCameraManager_SetPointThermometryCoordinate(
+    E_DjiMountPosition position,
+    T_DjiCameraManagerPointThermometryCoordinate pointCoordinate)
+{
+    return DjiMock_Unsupported(__FUNCTION__);
+}
+
+T_DjiReturnCode DjiCameraManager_GetPointThermometryData(E_DjiMountPosition position,
+                                                         T_DjiCameraManagerPointThermometryData *pointThermometryData)
+{
+    return DjiMock_Unsupported(__FUNCTION__);
+}
+
+T_DjiReturnCode DjiCameraManager_SetAreaThermometryCoordinate(
+    E_DjiMountPosition position,
+    T_DjiCameraManagerAreaThermometryCoordinate areaCoordinate)
+{
+    return DjiMock_Unsupported(__FUNCTION__);
+}
+
+T_DjiReturnCode DjiCameraManager_GetAreaThermometryData(E_DjiMountPosition position,
+                                                        T_DjiCameraManagerAreaThermometryData *areaThermometryData)
+{
+    return DjiMock_Unsupported(__FUNCTION__);
+}
+
+T_DjiReturnCode DjiCameraManager_SetFfcMode(E_DjiMountPosition position, E_DjiCameraManagerFfcMode ffcMode)
+{
+    return DjiMock_Unsupported(__FUNCTION__);
+}
+
+T_DjiReturnCode DjiCameraManager_TriggerFfc(E_DjiMountPosition position)
+{
+    return DjiMock_Unsupported(__FUNCTION__);
+}
+
+T_DjiReturnCode DjiCameraManager_SetInfraredCameraGainMode(E_DjiMountPosition position,
+                                                           E_DjiCameraManagerIrGainMode gainMode)
+{
+    return DjiMock_Unsupported(__FUNCTION__);
+}
+
+T_DjiReturnCode DjiCameraManager_GetInfraredCameraGainModeTemperatureRange(
+    E_DjiMountPosition position,
+    T_DjiCameraManagerIrTempMeterRange *tempRange)
+{
+    return DjiMock_Unsupported(__FUNCTION__);
+}
+
+T_DjiReturnCode DjiCameraManager_GetMeteringModeRange(E_DjiMountPosition position,
+                                                      T_DjiCameraManagerRangeList *rangeList)
+{
+    return DjiMock_Unsupported(__FUNCTION__);
+}
+
+T_DjiReturnCode DjiCameraManager_SetMeteringMode(E_DjiMountPosition position,
+                                                 E_DjiCameraManagerMeteringMode meteringMode)
+{
+    return DjiMock_Unsupported(__FUNCTION__);
+}
+
+T_DjiReturnCode DjiCameraManager_GetMeteringMode(E_DjiMountPosition position,
+                                                 E_DjiCameraManagerMeteringMode *meteringMode)
+{
+    return DjiMock_Unsupported(__FUNCTION__);
+}
+
+T_DjiReturnCode DjiCameraManager_GetMeteringPointRegionRange(E_DjiMountPosition position, uint8_t *hrzNum,
+                                                             uint8_t *vtcNum)
+{
+    return DjiMock_Unsupported(__FUNCTION__);
+}
+
+T_DjiReturnCode DjiCameraManager_SetMeteringPoint(E_DjiMountPosition position, uint8_t x, uint8_t y)
+{
+    return DjiMock_Unsupported(__FUNCTION__);
+}
+
+T_DjiReturnCode DjiCameraManager_SetMeteringPointNormalized(E_DjiMountPosition position, dji_f32_t x, dji_f32_t y)
+{
+    return DjiMock_Unsupported(__FUNCTION__);
+}
+
+T_DjiReturnCode DjiCameraManager_GetMeteringPoint(E_DjiMountPosition position, uint8_t *x, uint8_t *y)
+{
+    return DjiMock_Unsupported(__FUNCTION__);
+}
+
+T_DjiReturnCode DjiCameraManager_GetMeteringPointNormalized(E_DjiMountPosition position, dji_f32_t *x, dji_f32_t *y)
+{
+    return DjiMock_Unsupported(__FUNCTION__);
+}
+
+T_DjiReturnCode DjiCameraManager_StartRecordPointCloud(E_DjiMountPosition position)
+{
+    return DjiMock_Unsupported(__FUNCTION__);
+}
+
+T_DjiReturnCode DjiCameraManager_StopRecordPointCloud(E_DjiMountPosition position)
+{
+    return DjiMock_Unsupported(__FUNCTION__);
+}
+
+
+// dji_cloud_api_by_websockt.h
+T_DjiReturnCode DjiCloudApi_SendDataByWebSocket(uint8_t *data, uint32_t len, uint32_t *realLen)
+{
+    return DjiMock_Unsupported(__FUNCTION__);
+}
+
+
+// dji_flight_controller.h
+T_DjiReturnCode DjiFlightController_Init(T_DjiFlightControllerRidInfo ridInfo)
+{
+    return DjiMock_Unsupported(__FUNCTION__);
+}
+
+T_DjiReturnCode DjiFlightController_DeInit(void)
+{
+    return DjiMock_Unsupported(__FUNCTION__);
+}
+
+T_DjiReturnCode DjiFlightController_SetPlanningAlgo(uint8_t algo)
+{
+    return DjiMock_Unsupported(__FUNCTION__);
+}
+
+T_DjiReturnCode DjiFlightController_SetMaxVelocity(uint8_t value)
+{
+    return DjiMock_Unsupported(__FUNCTION__);
+}
+
+T_DjiReturnCode DjiFlightController_SetRetardedHeigh(float value)
+{
+    return DjiMock_Unsupported(__FUNCTION__);
+}
+
+T_DjiReturnCode DjiFlightController_GetExitReason(uint16_t *reason)
+{
+    return DjiMock_Unsupported(__FUNCTION__);
+}
+
+T_DjiReturnCode DjiFlightController_RegisterOpenMisInfoCallBack(FcCmderModeOpenMisEventCbFunc callback)
+{
+    return DjiMock_Unsupported(__FUNCTION__);
+}
+
+T_DjiReturnCode DjiFlightController_RegisterCoreTrajCallBack(FcCmderModeCoreTrajEventCbFunc callback)
+{
+    return DjiMock_Unsupported(__FUNCTION__);
+}
+
+T_DjiReturnCode DjiFlightController_SetModeStartMossion(T_DjiFlightControllerStartMissionReq command,
+                                                        T_DjiFlightControllerStartMissionRsp *rsp)
+{
+    return DjiMock_Unsupported(__FUNCTION__);
+}
+
+T_DjiReturnCode DjiFlightController_SetRtkPositionEnableStatus(
+    E_DjiFlightControllerRtkPositionEnableStatus rtkEnableStatus)
+{
+    return DjiMock_Unsupported(__FUNCTION__);
+}
+
+T_DjiReturnCode DjiFlightController_GetRtkPositionEnableStatus(
+    E_DjiFlightControllerRtkPositionEnableStatus *rtkEnableStatus)
+{
+    return DjiMock_Unsupported(__FUNCTION__);
+}
+
+T_DjiReturnCode DjiFlightController_SetRCLostAction(E_DjiFlightControllerRCLostAction rcLostAction)
+{
+    return DjiMock_Unsupported(__FUNCTION__);
+}
+
+T_DjiReturnCode DjiFlightController_GetRCLostAction(E_DjiFlightControllerRCLostAction *rcLostAction)
+{
+    return DjiMock_Unsupported(__FUNCTION__);
+}
+
+T_DjiReturnCode DjiFlightController_SetHorizontalVisualObstacleAvoidanceEnableStatus(
+    E_DjiFlightControllerObstacleAvoidanceEnableStatus horizontalObstacleAvoidanceEnableStatus)
+{
+    return DjiMock_Unsupported(__FUNCTION__);
+}
+
+T_DjiReturnCode DjiFlightController_GetHorizontalVisualObstacleAvoidanceEnableStatus(
+    E_DjiFlightControllerObstacleAvoidanceEnableStatus *horizontalObstacleAvoidanceEnableStatus)
+{
+    return DjiMock_Unsupported(__FUNCTION__);
+}
+
+T_DjiReturnCode DjiFlightController_SetHorizontalRadarObstacleAvoidanceEnableStatus(
+    E_DjiFlightControllerObstacleAvoidanceEnableStatus horizontalObstacleAvoidanceEnableStatus)
+{
+    return DjiMock_Unsupported(__FUNCTION__);
+}
+
+T_DjiReturnCode DjiFlightController_GetHorizontalRadarObstacleAvoidanceEnableStatus(
+    E_DjiFlightControllerObstacleAvoidanceEnableStatus *horizontalObstacleAvoidanceEnableStatus)
+{
+    return DjiMock_Unsupported(__FUNCTION__);
+}
+
+T_DjiReturnCode DjiFlightController_SetUpwardsVisualObstacleAvoidanceEnableStatus(
+    E_DjiFlightControllerObstacleAvoidanceEnableStatus upwardsObstacleAvoidanceEnableStatus)
+{
+    return DjiMock_Unsupported(__FUNCTION__);
+}
+
+T_DjiReturnCode DjiFlightController_GetUpwardsVisualObstacleAvoidanceEnableStatus(
+    E_DjiFlightControllerObstacleAvoidanceEnableStatus *upwardsObstacleAvoidanceEnableStatus)
+{
+    return DjiMock_Unsupported(__FUNCTION__);
+}
+
+T_DjiReturnCode DjiFlightController_SetUpwardsRadarObstacleAvoidanceEnableStatus(
+    E_DjiFlightControllerObstacleAvoidanceEnableStatus upwardsObstacleAvoidanceEnableStatus)
+{
+    return DjiMock_Unsupported(__FUNCTION__);
+}
+
+T_DjiReturnCode DjiFlightController_GetUpwardsRadarObstacleAvoidanceEnableStatus(
+    E_DjiFlightControllerObstacleAvoidanceEnableStatus *upwardsObstacleAvoidanceEnableStatus)
+{
+    return DjiMock_Unsupported(__FUNCTION__);
+}
+
+T_DjiReturnCode DjiFlightController_SetDownwardsVisualObstacleAvoidanceEnableStatus(
+    E_DjiFlightControllerObstacleAvoidanceEnableStatus downwardsObstacleAvoidanceEnableStatus)
+{
+    return DjiMock_Unsupported(__FUNCTION__);
+}
+
+T_DjiReturnCode DjiFlightController_GetDownwardsVisualObstacleAvoidanceEnableStatus(
+    E_DjiFlightControllerObstacleAvoidanceEnableStatus *downwardsObstacleAvoidanceEnableStatus)
+{
+    return DjiMock_Unsupported(__FUNCTION__);
+}
+
+T_DjiReturnCode DjiFlightController_ArrestFlying(void)
+{
+    return DjiMock_Unsupported(__FUNCTION__);
+}
+
+T_DjiReturnCode DjiFlightController_CancelArrestFlying(void)
+{
+    return DjiMock_Unsupported(__FUNCTION__);
+}
+
+T_DjiReturnCode DjiFlightController_TurnOnMotors(void)
+{
+    return DjiMock_Unsupported(__FUNCTION__);
+}
+
+T_DjiReturnCode DjiFlightController_TurnOffMotors(void)
+{
+    return DjiMock_Unsupported(__FUNCTION__);
+}
+
+T_DjiReturnCode DjiFlightController_EmergencyStopMotor(E_DjiFlightControllerEmergencyStopMotor cmd,
+                                                       char debugMsg[EMERGENCY_STOP_MOTOR_MSG_MAX_LENGTH])
+{
+    return DjiMock_Unsupported(__FUNCTION__);
+}
+
+T_DjiReturnCode DjiFlightController_StartTakeoff(void)
+{
+    return DjiMock_Unsupported(__FUNCTION__);
+}
+
+T_DjiReturnCode DjiFlightController_StartLanding(void)
+{
+    return DjiMock_Unsupported(__FUNCTION__);
+}
+
+T_DjiReturnCode DjiFlightController_CancelLanding(void)
+{
+    return DjiMock_Unsupported(__FUNCTION__);
+}
+
+T_DjiReturnCode DjiFlightController_StartConfirmLanding(void)
+{
+    return DjiMock_Unsupported(__FUNCTION__);
+}
+
+T_DjiReturnCode DjiFlightController_StartForceLanding(void)
+{
+    return DjiMock_Unsupported(__FUNCTION__);
+}
+
+T_DjiReturnCode DjiFlightController_SetHomeLocationUsingGPSCoordinates(T_DjiFlightControllerHomeLocation homeLocation)
+{
+    return DjiMock_Unsupported(__FUNCTION__);
+}
+
+T_DjiReturnCode DjiFlightController_SetHomeLocationUsingCurrentAircraftLocation(void)
+{
+    return DjiMock_Unsupported(__FUNCTION__);
+}
+
+T_DjiReturnCode DjiFlightController_SetGoHomeAltitude(E_DjiFlightControllerGoHomeAltitude altitude)
+{
+    return DjiMock_Unsupported(__FUNCTION__);
+}
+
+T_DjiReturnCode DjiFlightController_GetGoHomeAltitude(E_DjiFlightControllerGoHomeAltitude *altitude)
+{
+    return DjiMock_Unsupported(__FUNCTION__);
+}
+
+T_DjiReturnCode DjiFlightController_GetCountryCode(uint16_t *countryCode)
+{
+    return DjiMock_Unsupported(__FUNCTION__);
+}
+
+T_DjiReturnCode DjiFlightController_StartGoHome(void)
+{
+    return DjiMock_Unsupported(__FUNCTION__);
+}
+
+T_DjiReturnCode DjiFlightController_CancelGoHome(void)
+{
+    return DjiMock_Unsupported(__FUNCTION__);
+}
+
+T_DjiReturnCode DjiFlightController_ObtainJoystickCtrlAuthority(void)
+{
+    return DjiMock_Unsupported(__FUNCTION__);
+}
+
+T_DjiReturnCode DjiFlightController_ReleaseJoystickCtrlAuthority(void)
+{
+    return DjiMock_Unsupported(__FUNCTION__);
+}
+
+T_DjiReturnCode DjiFlightController_RegJoystickCtrlAuthorityEventCallback(JoystickCtrlAuthorityEventCbFunc callback)
+{
+    return DjiMock_Unsupported(__FUNCTION__);
+}
+
+void DjiFlightController_SetJoystickMode(T_DjiFlightControllerJoystickMode joystickMode)
+{
+    DjiMock_Unsupported(__FUNCTION__);
+}
+
+T_DjiReturnCode DjiFlightController_ExecuteJoystickAction(T_DjiFlightControllerJoystickCommand joystickCommand)
+{
+    return DjiMock_Unsupported(__FUNCTION__);
+}
+
+T_DjiReturnCode DjiFlightController_ExecuteEmergencyBrakeAction(void)
+{
+    return DjiMock_Unsupported(__FUNCTION__);
+}
+
+T_DjiReturnCode DjiFlightController_CancelEmergencyBrakeAction(void)
+{
+    return DjiMock_Unsupported(__FUNCTION__);
+}
+
+T_DjiReturnCode DjiFlightController_GetGeneralInfo(T_DjiFlightControllerGeneralInfo *generalInfo)
+{
+    return DjiMock_Unsupported(__FUNCTION__);
+}
+
+T_DjiReturnCode DjiFlightController_SetRCLostActionEnableStatus(E_DjiFlightControllerRCLostActionEnableStatus command)
+{
+    return DjiMock_Unsupported(__FUNCTION__);
+}
+
+T_DjiReturnCode DjiFlightController_GetEnableRCLostActionStatus(E_DjiFlightControllerRCLostActionEnableStatus *command)
+{
+    return DjiMock_Unsupported(__FUNCTION__);
+}
+
+T_DjiReturnCode DjiFlightController_RegTriggerFtsEventCallback(TriggerFtsEventCallback callback)
+{
+    return DjiMock_Unsupported(__FUNCTION__);
+}
+
+T_DjiReturnCode DjiFlightController_StartSlowRotateMotor(void)
+{
+    return DjiMock_Unsupported(__FUNCTION__);
+}
+
+T_DjiReturnCode DjiFlightController_StopSlowRotateMotor(void)
+{
+    return DjiMock_Unsupported(__FUNCTION__);
+}
+
+T_DjiReturnCode DjiFlightController_GetElectronicSpeedControllerStatus(
+    E_DjiFlightControllerElectronicSpeedControllerStatus *status)
+{
+    return DjiMock_Unsupported(__FUNCTION__);
+}
+
+T_DjiReturnCode DjiFlightController_SelectFtsPwmTrigger(E_DjiMountPosition position)
+{
+    return DjiMock_Unsupported(__FUNCTION__);
+}
+
+T_DjiReturnCode DjiFlightController_GetFtsPwmTriggerStatus(T_DjiFtsPwmEscTriggerStatus* trigger_status)
+{
+    return DjiMock_Unsupported(__FUNCTION__);
+}
+
+
+// dji_gimbal.h
+T_DjiReturnCode DjiGimbal_Init(void)
+{
+    return DjiMock_Unsupported(__FUNCTION__);
+}
+
+T_DjiReturnCode DjiGimbal_DeInit(void)
+{
+    return DjiMock_Unsupported(__FUNCTION__);
+}
+
+T_DjiReturnCode DjiGimbal_RegCommonHandler(const T_DjiGimbalCommonHandler *commonHandler)
+{
+    return DjiMock_Unsupported(__FUNCTION__);
+}
+
+
+// dji_gimbal_manager.h
+T_DjiReturnCode DjiGimbalManager_Init(void)
+{
+    return DjiMock_Unsupported(__FUNCTION__);
+}
+
+T_DjiReturnCode DjiGimbalManager_Deinit(void)
+{
+    return DjiMock_Unsupported(__FUNCTION__);
+}
+
+T_DjiReturnCode DjiGimbalManager_SetMode(E_DjiMountPosition mountPosition, E_DjiGimbalMode mode)
+{
+    return DjiMock_Unsupported(__FUNCTION__);
+}
+
+T_DjiReturnCode DjiGimbalManager_Reset(E_DjiMountPosition mountPosition, E_DjiGimbalResetMode resetMode)
+{
+    return DjiMock_Unsupported(__FUNCTION__);
+}
+
+T_DjiReturnCode DjiGimbalManager_Rotate(E_DjiMountPosition mountPosition, T_DjiGimbalManagerRotation rotation)
+{
+    return DjiMock_Unsupported(__FUNCTION__);
+}
+
+T_DjiReturnCode DjiGimbalManager_SetPitchRangeExtensionEnabled(E_DjiMountPosition mountPosition, bool enabledFlag)
+{
+    return DjiMock_Unsupported(__FUNCTION__);
+}
+
+T_DjiReturnCode DjiGimbalManager_SetControllerMaxSpeedPercentage(E_DjiMountPosition mountPosition, E_DjiGimbalAxis axis,
+                                                                 uint8_t maxSpeedPercentage)
+{
+    return DjiMock_Unsupported(__FUNCTION__);
+}
+
+T_DjiReturnCode DjiGimbalManager_SetControllerSmoothFactor(E_DjiMountPosition mountPosition, E_DjiGimbalAxis axis,
+                                                           uint8_t smoothingFactor)
+{
+    return DjiMock_Unsupported(__FUNCTION__);
+}
+
+T_DjiReturnCode DjiGimbalManager_RestoreFactorySettings(E_DjiMountPosition mountPosition)
+{
+    return DjiMock_Unsupported(__FUNCTION__);
+}
+
+
+// dji_high_speed_data_channel.h
+T_DjiReturnCode DjiHighSpeedDataChannel_SetBandwidthProportion(
+    T_DjiDataChannelBandwidthProportionOfHighspeedChannel bandwidthProportion)
+{
+    return DjiMock_Unsupported(__FUNCTION__);
+}
+
+T_DjiReturnCode DjiHighSpeedDataChannel_GetDataStreamRemoteAddress(char *ipAddr, uint16_t *port)
+{
+    return DjiMock_Unsupported(__FUNCTION__);
+}
+
+T_DjiReturnCode DjiHighSpeedDataChannel_SendDataStreamData(const uint8_t *data, uint16_t len)
+{
+    return DjiMock_Unsupported(__FUNCTION__);
+}
+
+T_DjiReturnCode DjiHighSpeedDataChannel_GetDataStreamState(T_DjiDataChannelState *state)
+{
+    return DjiMock_Unsupported(__FUNCTION__);
+}
+
+
+// dji_hms_customization.h
+T_DjiReturnCode DjiHmsCustomization_Init(void)
+{
+    return DjiMock_Unsupported(__FUNCTION__);
+}
+
+T_DjiReturnCode DjiHmsCustomization_DeInit(void)
+{
+    return DjiMock_Unsupported(__FUNCTION__);
+}
+
+T_DjiReturnCode DjiHmsCustomization_InjectHmsErrorCode(uint32_t errorCode, E_DjiHmsErrorLevel errorLevel)
+{
+    return DjiMock_Unsupported(__FUNCTION__);
+}
+
+T_DjiReturnCode DjiHmsCustomization_EliminateHmsErrorCode(uint32_t errorCode)
+{
+    return DjiMock_Unsupported(__FUNCTION__);
+}
+
+T_DjiReturnCode DjiHmsCustomization_RegDefaultHmsTextConfigByDirPath(const char *configDirPath)
+{
+    return DjiMock_Unsupported(__FUNCTION__);
+}
+
+T_DjiReturnCode DjiHmsCustomization_RegHmsTextConfigByDirPath(E_DjiMobileAppLanguage appLanguage,
+                                                              const char *configDirPath)
+{
+    return DjiMock_Unsupported(__FUNCTION__);
+}
+
+T_DjiReturnCode DjiHmsCustomization_RegDefaultHmsTextConfigByBinaryArray(
+    const T_DjiHmsBinaryArrayConfig *binaryArrayConfig)
+{
+    return DjiMock_Unsupported(__FUNCTION__);
+}
+
+T_DjiReturnCode DjiHmsCustomization_RegHmsTextConfigByBinaryArray(E_DjiMobileAppLanguage appLanguage,
+                                                                  const T_DjiHmsBinaryArrayConfig *binaryArrayConfig)
+{
+    return DjiMock_Unsupported(__FUNCTION__);
+}
+
+T_DjiReturnCode DjiHmsCustomization_AlarmEnhancedCtrl(E_DjiHmsAlarmEnhancedAction action,
+                                                      T_DjiHmsAlarmEnhancedSetting setting)
+{
+    return DjiMock_Unsupported(__FUNCTION__);
+}
+
+
+// dji_hms_manager.h
+T_DjiReturnCode DjiHmsManager_Init(void)
+{
+    return DjiMock_Unsupported(__FUNCTION__);
+}
+
+T_DjiReturnCode DjiHmsManager_DeInit(void)
+{
+    return DjiMock_Unsupported(__FUNCTION__);
+}
+
+T_DjiReturnCode DjiHmsManager_RegHmsInfoCallback(DjiHmsInfoCallback callback)
+{
+    return DjiMock_Unsupported(__FUNCTION__);
+}
+
+
+// dji_interest_point.h
+T_DjiReturnCode DjiInterestPoint_Init(void)
+{
+    return DjiMock_Unsupported(__FUNCTION__);
+}
+
+T_DjiReturnCode DjiInterestPoint_DeInit(void)
+{
+    return DjiMock_Unsupported(__FUNCTION__);
+}
+
+T_DjiReturnCode DjiInterestPoint_Start(T_DjiInterestPointSettings settings)
+{
+    return DjiMock_Unsupported(__FUNCTION__);
+}
+
+T_DjiReturnCode DjiInterestPoint_Stop(void)
+{
+    return DjiMock_Unsupported(__FUNCTION__);
+}
+
+T_DjiReturnCode DjiInterestPoint_SetSpeed(dji_f32_t speed)
+{
+    return DjiMock_Unsupported(__FUNCTION__);
+}
+
+T_DjiReturnCode DjiInterestPoint_RegMissionStateCallback(InterestPointMissionStateCallback callback)
+{
+    return DjiMock_Unsupported(__FUNCTION__);
+}
+
+
+// dji_low_speed_data_channel.h
+T_DjiReturnCode DjiLowSpeedDataChannel_Init(void)
+{
+    return DjiMock_Unsupported(__FUNCTION__);
+}
+
+T_DjiReturnCode DjiLowSpeedDataChannel_DeInit(void)
+{
+    return DjiMock_Unsupported(__FUNCTION__);
+}
+
+T_DjiReturnCode DjiLowSpeedDataChannel_SendData(E_DjiChannelAddress channelAddress, const uint8_t *data, uint8_t len)
+{
+    return DjiMock_Unsupported(__FUNCTION__);
+}
+
+T_DjiReturnCode DjiLowSpeedDataChannel_GetSendDataState(E_DjiChannelAddress channelAddress,
+                                                        T_DjiDataChannelState *state)
+{
+    return DjiMock_Unsupported(__FUNCTION__);
+}
+
+T_DjiReturnCode DjiLowSpeedDataChannel_RegRecvDataCallback(E_DjiChannelAddress channelAddress,
+                                                           DjiLowSpeedDataChannelRecvDataCallback callback)
+{
+    return DjiMock_Unsupported(__FUNCTION__);
+}
+
+
+// dji_network_rtk.h
+T_DjiReturnCode DjiNetworkRtk_RegReceiveNetworkRtkStateCallback(DjiReceiveNetworkRtkStateCallback callback)
+{
+    return DjiMock_Unsupported(__FUNCTION__);
+}
+
+T_DjiReturnCode DjiNetworkRtk_StartService(const T_DjiNetworkRtkServiceConfig* config)
+{
+    return DjiMock_Unsupported(__FUNCTION__);
+}
+
+T_DjiReturnCode DjiNetworkRtk_StopService(void)
+{
+    return DjiMock_Unsupported(__FUNCTION__);
+}
+
+
+// dji_open_ar.h
+T_DjiReturnCode DjiLiveview_ArSetPoint(const T_DjiOpenArPointArray* entry)
+{
+    return DjiMock_Unsupported(__FUNCTION__);
+}
+
+T_DjiReturnCode DjiLiveview_ArUpdatePoint(const T_DjiOpenArPointArray* entry)
+{
+    return DjiMock_Unsupported(__FUNCTION__);
+}
+
+T_DjiReturnCode DjiLiveview_ArDeletePoint(const T_DjiOpenArDeletePointEntry* entry)
+{
+    return DjiMock_Unsupported(__FUNCTION__);
+}
+
+T_DjiReturnCode DjiLiveview_ArClearPoint(uint32_t resource_id)
+{
+    return DjiMock_Unsupported(__FUNCTION__);
+}
+
+T_DjiReturnCode DjiLiveview_ArSetLine(const T_DjiOpenArLine* entry)
+{
+    return DjiMock_Unsupported(__FUNCTION__);
+}
+
+T_DjiReturnCode DjiLiveview_ArUpdateLine(const T_DjiOpenArLine* entry)
+{
+    return DjiMock_Unsupported(__FUNCTION__);
+}
+
+T_DjiReturnCode DjiLiveview_ArDeleteLine(const T_DjiOpenArDeleteLineEntry* entry, uint32_t entry_len)
+{
+    return DjiMock_Unsupported(__FUNCTION__);
+}
+
+T_DjiReturnCode DjiLiveview_ArClearLine(void)
+{
+    return DjiMock_Unsupported(__FUNCTION__);
+}
+
+T_DjiReturnCode DjiLiveview_ArSetPolygon(const T_DjiOpenArPolygon* entry)
+{
+    return DjiMock_Unsupported(__FUNCTION__);
+}
+
+T_DjiReturnCode DjiLiveview_ArUpdatePolygon(const T_DjiOpenArPolygon* entry)
+{
+    return DjiMock_Unsupported(__FUNCTION__);
+}
+
+T_DjiReturnCode DjiLiveview_ArDeletePolygon(const T_DjiOpenArDeletePolygonEntry* entry, uint32_t entry_len)
+{
+    return DjiMock_Unsupported(__FUNCTION__);
+}
+
+T_DjiReturnCode DjiLiveview_ArClearPolygon(void)
+{
+    return DjiMock_Unsupported(__FUNCTION__);
+}
+
+T_DjiReturnCode DjiLiveview_ArSetCircle(const T_DjiOpenArCircle* entry)
+{
+    return DjiMock_Unsupported(__FUNCTION__);
+}
+
+T_DjiReturnCode DjiLiveview_ArUpdateCircle(const T_DjiOpenArCircle* entry)
+{
+    return DjiMock_Unsupported(__FUNCTION__);
+}
+
+T_DjiReturnCode DjiLiveview_ArDeleteCircle(const T_DjiOpenArDeleteCircleEntry* entry, uint32_t entry_len)
+{
+    return DjiMock_Unsupported(__FUNCTION__);
+}
+
+T_DjiReturnCode DjiLiveview_ArClearCircle(void)
+{
+    return DjiMock_Unsupported(__FUNCTION__);
+}
+
+T_DjiReturnCode DjiLiveview_ArSetPivotAxis(const T_DjiOpenArPivotAxis* entry)
+{
+    return DjiMock_Unsupported(__FUNCTION__);
+}
+
+T_DjiReturnCode DjiLiveview_ArUpdatePivotAxis(const T_DjiOpenArPivotAxis* entry)
+{
+    return DjiMock_Unsupported(__FUNCTION__);
+}
+
+T_DjiReturnCode DjiLiveview_ArDeletePivotAxis(const T_DjiOpenArDeletePovixAxisEntry* entry, uint32_t entry_len)
+{
+    return DjiMock_Unsupported(__FUNCTION__);
+}
+
+T_DjiReturnCode DjiLiveview_ArClearPivotAxis(void)
+{
+    return DjiMock_Unsupported(__FUNCTION__);
+}
+
+T_DjiReturnCode DjiLiveview_ArRegRefleshAllCallback(DjiLiveview_ArRefleshAllCallback callback)
+{
+    return DjiMock_Unsupported(__FUNCTION__);
+}
+
+
+// dji_payload_camera.h
+T_DjiReturnCode DjiPayloadCamera_GetCameraTypeOfPayload(E_DjiMountPosition payloadPosition, E_DjiCameraType *cameraType)
+{
+    return DjiMock_Unsupported(__FUNCTION__);
+}
+
+T_DjiReturnCode DjiPayloadCamera_GetCameraOpticalZoomSpecOfPayload(E_DjiMountPosition payloadPosition,
+                                                                   T_DjiCameraOpticalZoomSpec *opticalZoomSpec)
+{
+    return DjiMock_Unsupported(__FUNCTION__);
+}
+
+T_DjiReturnCode DjiPayloadCamera_GetCameraHybridZoomFocalLengthOfPayload(E_DjiMountPosition payloadPosition,
+                                                                         uint16_t *focalLength)
+{
+    return DjiMock_Unsupported(__FUNCTION__);
+}
+
+
+// dji_time_sync.h
+T_DjiReturnCode DjiTimeSync_Init(void)
+{
+    return DjiMock_Unsupported(__FUNCTION__);
+}
+
+T_DjiReturnCode DjiTimeSync_RegGetNewestPpsTriggerTimeCallback(DjiGetNewestPpsTriggerLocalTimeUsCallback callback)
+{
+    return DjiMock_Unsupported(__FUNCTION__);
+}
+
+T_DjiReturnCode DjiTimeSync_TransferToAircraftTime(uint64_t localTimeUs, T_DjiTimeSyncAircraftTime *aircraftTime)
+{
+    return DjiMock_Unsupported(__FUNCTION__);
+}
+
+
+// dji_positioning.h
+T_DjiReturnCode DjiPositioning_Init(void)
+{
+    return DjiMock_Unsupported(__FUNCTION__);
+}
+
+void DjiPositioning_SetTaskIndex(uint8_t index)
+{
+    DjiMock_Unsupported(__FUNCTION__);
+}
+
+T_DjiReturnCode DjiPositioning_GetPositionInformationSync(uint8_t eventCount, T_DjiPositioningEventInfo *eventInfo,
+                                                          T_DjiPositioningPositionInfo *positionInfo)
+{
+    return DjiMock_Unsupported(__FUNCTION__);
+}
+
+T_DjiReturnCode DjiPositioning_RegReceiveRtcmDataCallback(E_DjiPositioningRtcmDataType dataType,
+                                                          DjiReceiveRtkRtcmDataCallback callback)
+{
+    return DjiMock_Unsupported(__FUNCTION__);
+}
+
+
+// dji_power_management.h
+T_DjiReturnCode DjiPowerManagement_Init(void)
+{
+    return DjiMock_Unsupported(__FUNCTION__);
+}
+
+T_DjiReturnCode DjiPowerManagement_DeInit(void)
+{
+    return DjiMock_Unsupported(__FUNCTION__);
+}
+
+T_DjiReturnCode DjiPowerManagement_ApplyHighPowerSync(void)
+{
+    return DjiMock_Unsupported(__FUNCTION__);
+}
+
+T_DjiReturnCode DjiPowerManagement_ApplyHighPowerSyncV2(E_DjiHighPowerVoltage voltage)
+{
+    return DjiMock_Unsupported(__FUNCTION__);
+}
+
+T_DjiReturnCode DjiPowerManagement_RegWriteHighPowerApplyPinCallback(DjiWriteHighPowerApplyPinCallback callback)
+{
+    return DjiMock_Unsupported(__FUNCTION__);
+}
+
+T_DjiReturnCode DjiPowerManagement_RegPowerOffNotificationCallback(DjiPowerOffNotificationCallback callback)
+{
+    return DjiMock_Unsupported(__FUNCTION__);
+}
+
+T_DjiReturnCode DjiPowerManagement_OutputHighPower(bool stat)
+{
+    return DjiMock_Unsupported(__FUNCTION__);
+}
+
+
+// dji_tethered_battery.h
+T_DjiReturnCode DjiTetheredBattery_Init(void)
+{
+    return DjiMock_Unsupported(__FUNCTION__);
+}
+
+T_DjiReturnCode DjiTetheredBattery_DeInit(void)
+{
+    return DjiMock_Unsupported(__FUNCTION__);
+}
+
+T_DjiReturnCode DjiTetheredBattery_PushTetherLineStatus(T_DjiTetherLineStatus tetherLineStatus)
+{
+    return DjiMock_Unsupported(__FUNCTION__);
+}
+
+
+// dji_upgrade.h
+T_DjiReturnCode DjiUpgrade_Init(const T_DjiUpgradeConfig *upgradeConfig)
+{
+    return DjiMock_Unsupported(__FUNCTION__);
+}
+
+T_DjiReturnCode DjiUpgrade_EnableLocalUpgrade(void)
+{
+    return DjiMock_Unsupported(__FUNCTION__);
+}
+
+T_DjiReturnCode DjiUpgrade_RegHandler(const T_DjiUpgradeHandler *upgradeHandler)
+{
+    return DjiMock_Unsupported(__FUNCTION__);
+}
+
+T_DjiReturnCode DjiUpgrade_PushUpgradeState(const T_DjiUpgradeState *upgradeState)
+{
+    return DjiMock_Unsupported(__FUNCTION__);
+}
+
+
+// dji_waypoint_v2.h
+T_DjiReturnCode DjiWaypointV2_Init(void)
+{
+    return DjiMock_Unsupported(__FUNCTION__);
+}
+
+T_DjiReturnCode DjiWaypointV2_Deinit(void)
+{
+    return DjiMock_Unsupported(__FUNCTION__);
+}
+
+T_DjiReturnCode DjiWaypointV2_UploadMission(const T_DjiWayPointV2MissionSettings *info)
+{
+    return DjiMock_Unsupported(__FUNCTION__);
+}
+
+T_DjiReturnCode DjiWaypointV2_Start(void)
+{
+    return DjiMock_Unsupported(__FUNCTION__);
+}
+
+T_DjiReturnCode DjiWaypointV2_Stop(void)
+{
+    return DjiMock_Unsupported(__FUNCTION__);
+}
+
+T_DjiReturnCode DjiWaypointV2_Pause(void)
+{
+    return DjiMock_Unsupported(__FUNCTION__);
+}
+
+T_DjiReturnCode DjiWaypointV2_Resume(void)
+{
+    return DjiMock_Unsupported(__FUNCTION__);
+}
+
+T_DjiReturnCode DjiWaypointV2_GetGlobalCruiseSpeed(T_DjiWaypointV2GlobalCruiseSpeed *cruiseSpeed)
+{
+    return DjiMock_Unsupported(__FUNCTION__);
+}
+
+T_DjiReturnCode DjiWaypointV2_SetGlobalCruiseSpeed(T_DjiWaypointV2GlobalCruiseSpeed cruiseSpeed)
+{
+    return DjiMock_Unsupported(__FUNCTION__);
+}
+
+T_DjiReturnCode DjiWaypointV2_RegisterMissionEventCallback(WaypointV2EventCbFunc callback)
+{
+    return DjiMock_Unsupported(__FUNCTION__);
+}
+
+T_DjiReturnCode DjiWaypointV2_RegisterMissionStateCallback(WaypointV2StateCbFunc callback)
+{
+    return DjiMock_Unsupported(__FUNCTION__);
+}
+
+
+// dji_waypoint_v3.h
+T_DjiReturnCode DjiWaypointV3_Init(void)
+{
+    return DjiMock_Unsupported(__FUNCTION__);
+}
+
+T_DjiReturnCode DjiWaypointV3_DeInit(void)
+{
+    return DjiMock_Unsupported(__FUNCTION__);
+}
+
+T_DjiReturnCode DjiWaypointV3_UploadKmzFile(const uint8_t *data, uint32_t dataLen)
+{
+    return DjiMock_Unsupported(__FUNCTION__);
+}
+
+T_DjiReturnCode DjiWaypointV3_Action(E_DjiWaypointV3Action action)
+{
+    return DjiMock_Unsupported(__FUNCTION__);
+}
+
+T_DjiReturnCode DjiWaypointV3_RegMissionStateCallback(WaypointV3MissionStateCallback callback)
+{
+    return DjiMock_Unsupported(__FUNCTION__);
+}
+
+T_DjiReturnCode DjiWaypointV3_RegActionStateCallback(WaypointV3ActionStateCallback callback)
+{
+    return DjiMock_Unsupported(__FUNCTION__);
+}
+
+
+// dji_widget.h
+T_DjiReturnCode DjiWidget_Init(void)
+{
+    return DjiMock_Unsupported(__FUNCTION__);
+}
+
+T_DjiReturnCode DjiWidget_RegDefaultUiConfigByDirPath(const char *widgetConfigDirPath)
+{
+    return DjiMock_Unsupported(__FUNCTION__);
+}
+
+T_DjiReturnCode DjiWidget_RegUiConfigByDirPath(E_DjiMobileAppLanguage appLanguage,
+                                               E_DjiMobileAppScreenType appScreenType, const char *widgetConfigDirPath)
+{
+    return DjiMock_Unsupported(__FUNCTION__);
+}
+
+T_DjiReturnCode DjiWidget_RegDefaultUiConfigByBinaryArray(const T_DjiWidgetBinaryArrayConfig *binaryArrayConfig)
+{
+    return DjiMock_Unsupported(__FUNCTION__);
+}
+
+T_DjiReturnCode DjiWidget_RegUiConfigByBinaryArray(E_DjiMobileAppLanguage appLanguage,
+                                                   E_DjiMobileAppScreenType screenType,
+                                                   const T_DjiWidgetBinaryArrayConfig *binaryArrayConfig)
+{
+    return DjiMock_Unsupported(__FUNCTION__);
+}
+
+T_DjiReturnCode DjiWidget_RegHandlerList(const T_DjiWidgetHandlerListItem *widgetHandlerList, uint32_t itemCount)
+{
+    return DjiMock_Unsupported(__FUNCTION__);
+}
+
+T_DjiReturnCode DjiWidgetFloatingWindow_ShowMessage(const char *str)
+{
+    return DjiMock_Unsupported(__FUNCTION__);
+}
+
+T_DjiReturnCode DjiWidgetFloatingWindow_GetChannelState(T_DjiDataChannelState *state)
+{
+    return DjiMock_Unsupported(__FUNCTION__);
+}
+
+T_DjiReturnCode DjiWidget_RegSpeakerHandler(const T_DjiWidgetSpeakerHandler *widgetSpeakerHandler)
+{
+    return DjiMock_Unsupported(__FUNCTION__);
+}
+
+
+// dji_widget_manager.h
+T_DjiReturnCode DjiWidgetManager_Init(void)
+{
+    return DjiMock_Unsupported(__FUNCTION__);
+}
+
+T_DjiReturnCode DjiWidgetManager_DeInit(void)
+{
+    return DjiMock_Unsupported(__FUNCTION__);
+}
+
+T_DjiReturnCode DjiWidgetManager_SubscribePayloadWidgetStates(E_DjiMountPosition position,
+                                                              RecvWidgetStatesCallback recvStatesCallback)
+{
+    return DjiMock_Unsupported(__FUNCTION__);
+}
+
+T_DjiReturnCode DjiWidgetManager_UnsubscribePayloadWidgetStates(E_DjiMountPosition position)
+{
+    return DjiMock_Unsupported(__FUNCTION__);
+}
+
+T_DjiReturnCode DjiWidgetManager_SetWidgetState(E_DjiMountPosition position, T_DjiWidgetStates states)
+{
+    return DjiMock_Unsupported(__FUNCTION__);
+}
+
+T_DjiReturnCode DjiWidgetManager_SubscribeSpeakerStates(E_DjiMountPosition position,
+                                                        RecvSpeakerStatesCallback recvStatesCallback)
+{
+    return DjiMock_Unsupported(__FUNCTION__);
+}
+
+T_DjiReturnCode DjiWidgetManager_UnsubscribeSpeakerStates(E_DjiMountPosition position)
+{
+    return DjiMock_Unsupported(__FUNCTION__);
+}
+
+T_DjiReturnCode DjiWidgetManager_SetSpeakertState(E_DjiMountPosition position, T_DjiSpeakerWidgetStatesParam *states)
+{
+    return DjiMock_Unsupported(__FUNCTION__);
+}
+
+T_DjiReturnCode DjiWidgetManager_SendSpeakerAudioData(E_DjiMountPosition position,
+                                                      T_DjiSpeakerAudioFileInfo *audioFileInfo)
+{
+    return DjiMock_Unsupported(__FUNCTION__);
+}
+
+T_DjiReturnCode DjiWidgetManager_WidgetDownloadFileList(E_DjiMountPosition position,
+                                                        T_DjiWidgetManagerFileList *fileList)
+{
+    return DjiMock_Unsupported(__FUNCTION__);
+}
+
+T_DjiReturnCode DjiWidgetManager_RegDownloadFileDataCallback(E_DjiMountPosition position,
+                                                             DjiWidgetDownloadFileDataCallback recvFileCallback)
+{
+    return DjiMock_Unsupported(__FUNCTION__);
+}
+
+T_DjiReturnCode DjiWidgetManager_UnRegDownloadFileDataCallback(E_DjiMountPosition position)
+{
+    return DjiMock_Unsupported(__FUNCTION__);
+}
+
+T_DjiReturnCode DjiWidgetManager_DownloadFileByIndex(E_DjiMountPosition position, uint32_t fileIndex)
+{
+    return DjiMock_Unsupported(__FUNCTION__);
+}
+
+
+// dji_xport.h
+T_DjiReturnCode DjiXPort_Init(void)
+{
+    return DjiMock_Unsupported(__FUNCTION__);
+}
+
+T_DjiReturnCode DjiXPort_DeInit(void)
+{
+    return DjiMock_Unsupported(__FUNCTION__);
+}
+
+T_DjiReturnCode DjiXPort_RegReceiveSystemStateCallback(DjiReceiveXPortSystemStateCallback callback)
+{
+    return DjiMock_Unsupported(__FUNCTION__);
+}
+
+T_DjiReturnCode DjiXPort_RegReceiveAttitudeInformationCallback(DjiReceiveXPortAttitudeInformationCallback callback)
+{
+    return DjiMock_Unsupported(__FUNCTION__);
+}
+
+T_DjiReturnCode DjiXPort_SetGimbalModeSync(E_DjiGimbalMode mode)
+{
+    return DjiMock_Unsupported(__FUNCTION__);
+}
+
+T_DjiReturnCode DjiXPort_RotateSync(E_DjiGimbalRotationMode rotationMode, T_DjiGimbalRotationProperty rotationProperty,
+                                    T_DjiAttitude3d rotationValue)
+{
+    return DjiMock_Unsupported(__FUNCTION__);
+}
+
+T_DjiReturnCode DjiXPort_ReleaseControlPermissionSync(void)
+{
+    return DjiMock_Unsupported(__FUNCTION__);
+}
+
+T_DjiReturnCode DjiXPort_ResetSync(E_DjiGimbalResetMode mode)
+{
+    return DjiMock_Unsupported(__FUNCTION__);
+}
+
+T_DjiReturnCode DjiXPort_SetLimitAngleSync(E_DjiXPortLimitAngleCategory limitAngleCategory,
+                                           T_DjiXPortLimitAngle limitAngle)
+{
+    return DjiMock_Unsupported(__FUNCTION__);
+}
+
+T_DjiReturnCode DjiXPort_GetLimitAngleSync(E_DjiXPortLimitAngleCategory limitAngleCategory,
+                                           T_DjiXPortLimitAngle *limitAngle)
+{
+    return DjiMock_Unsupported(__FUNCTION__);
+}
+
+T_DjiReturnCode DjiXPort_SetSpeedConversionFactor(float factor)
+{
+    return DjiMock_Unsupported(__FUNCTION__);
+}
+
+/* Private functions definition-----------------------------------------------*/
+
+/****************** (C) COPYRIGHT DJI Innovations *****END OF FILE****/
@@ -0,0 +1,217 @@
+/**
+ ********************************************************************
+ * @file    main.c
+ * @brief   Command line reader of the telemetry bus the Linux samples publish the received data on.
+ *
+ * @copyright (c) 2021 DJI. All rights reserved.
+ *
+ * All information contained herein is, and remains, the property of DJI.
+ * The intellectual and technical concepts contained herein are proprietary
+ * to DJI and may be covered by U.S. and foreign patents, patents in process,
+ * and protected by trade secret or copyright law.  Dissemination of this
+ * information, including but not limited to data and other proprietary
+ * material(s) incorporated within the information, in any form, is strictly
+ * prohibited without the express written consent of DJI.
+ *
+ * If you receive this source code without DJI’s authorization, you may not
+ * further disseminate the information, and you must immediately remove the
+ * source code and notify DJI of its removal. DJI reserves the right to pursue
+ * legal actions against you for any loss(es) or damage(s) caused by your
+ * failure to do so.
+ *
+ *********************************************************************
+ */
+
+/* Includes ------------------------------------------------------------------*/
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <signal.h>
+#include <unistd.h>
+#include "telemetry_bus/test_telemetry_bus.h"
+
+/* Private constants ---------------------------------------------------------*/
+#define DJI_TELEMETRY_ECHO_RECEIVE_TIMEOUT_MS   (500)
+#define DJI_TELEMETRY_ECHO_TEXT_MAX_SIZE        (1024)
+
+/* Private types -------------------------------------------------------------*/
+
+/* Private functions declaration ---------------------------------------------*/
+static int DjiTelemetryEcho_ListTopics(const T_DjiTestTelemetryClient *client);
+static int DjiTelemetryEcho_PrintTopic(const T_DjiTestTelemetryClient *client, const char *topicName,
+                                       uint64_t maxCount, bool isFromOldest, bool isVerbose);
+static void DjiTelemetryEcho_HandleSignal(int signalNumber);
+static void DjiTelemetryEcho_PrintUsage(const char *program);
+
+/* Private values -------------------------------------------------------------*/
+static volatile sig_atomic_t s_isTelemetryEchoStopped = 0;
+
+/* Exported functions definition ---------------------------------------------*/
+int main(int argc, char **argv)
+{
+    T_DjiTestTelemetryClient client;
+    T_DjiReturnCode returnCode;
+    const char *busName = DJI_TEST_TELEMETRY_BUS_DEFAULT_NAME;
+    const char *topicName = NULL;
+    uint64_t maxCount = 0;
+    bool isList = false;
+    bool isFromOldest = false;
+    bool isVerbose = false;
+    int option;
+    int result;
+
+    while ((option = getopt(argc, argv, "b:t:n:lovh")) != -1) {
+        switch (option) {
+            case 'b':
+                busName = optarg;
+                break;
+            case 't':
+                topicName = optarg;
+                break;
+            case 'n':
+                maxCount = strtoull(optarg, NULL, 10);
+                break;
+            case 'l':
+                isList = true;
+                break;
+            case 'o':
+                isFromOldest = true;
+                break;
+            case 'v':
+                isVerbose = true;
+                break;
+            case 'h':
+            default:
+                DjiTelemetryEcho_PrintUsage(argv[0]);
+                return option == 'h' ? 0 : 1;
+        }
+    }
+    if (!isList && topicName == NULL) {
+        DjiTelemetryEcho_PrintUsage(argv[0]);
+        return 1;
+    }
+
+    returnCode = DjiTest_TelemetryClientOpen(&client, busName);
+    if (returnCode != DJI_ERROR_SYSTEM_MODULE_CODE_SUCCESS) {
+        fprintf(stderr, "Open telemetry bus %s error, stat = 0x%08llX, is the sample running?\n", busName,
+                (unsigned long long) returnCode);
+        return 1;
+    }
+
+    signal(SIGINT, DjiTelemetryEcho_HandleSignal);
+    signal(SIGTERM, DjiTelemetryEcho_HandleSignal);
+    signal(SIGPIPE, SIG_IGN);
+
+    if (isList) {
+        result = DjiTelemetryEcho_ListTopics(&client);
+    } else {
+        result = DjiTelemetryEcho_PrintTopic(&client, topicName, maxCount, isFromOldest, isVerbose);
+    }
+
+    DjiTest_TelemetryClientClose(&client);
+
+    return result;
+}
+
+/* Private functions definition-----------------------------------------------*/
+static int DjiTelemetryEcho_ListTopics(const T_DjiTestTelemetryClient *client)
+{
+    T_DjiTestTelemetryTopicInfo info;
+    T_DjiTestTelemetrySchema schema;
+    uint32_t count = DjiTest_TelemetryClientGetTopicCount(client);
+    uint16_t i;
+
+    printf("bus %s, publisher %d%s, %u topics\n", client->name, client->header->pid,
+           DjiTest_TelemetryClientIsAlive(client) ? "" : " (gone)", count);
+    for (i = 0; i < count; i++) {
+        if (DjiTest_TelemetryClientGetTopic(client, i, &info, &schema) != DJI_ERROR_SYSTEM_MODULE_CODE_SUCCESS) {
+            continue;
+        }
+        printf("%-20s %s v%u, %u slots of %u bytes\n    %s\n", info.name, schema.name, schema.version,
+               info.slotCount, info.slotSize, schema.layout);
+    }
+
+    return 0;
+}
+
+static int DjiTelemetryEcho_PrintTopic(const T_DjiTestTelemetryClient *client, const char *topicName,
+                                       uint64_t maxCount, bool isFromOldest, bool isVerbose)
+{
+    T_DjiTestTelemetrySubscriber subscriber;
+    T_DjiTestTelemetrySample sample;
+    T_DjiTestTelemetryTopicInfo info;
+    T_DjiTestTelemetrySchema schema;
+    T_DjiReturnCode returnCode;
+    char text[DJI_TELEMETRY_ECHO_TEXT_MAX_SIZE];
+    uint64_t printedCount = 0;
+    uint16_t topicId;
+    int result = 0;
+
+    returnCode = DjiTest_TelemetryClientFindTopic(client, topicName, &topicId);
+    if (returnCode == DJI_ERROR_SYSTEM_MODULE_CODE_SUCCESS) {
+        returnCode = DjiTest_TelemetryClientGetTopic(client, topicId, &info, &schema);
+    }
+    if (returnCode == DJI_ERROR_SYSTEM_MODULE_CODE_SUCCESS) {
+        returnCode = DjiTest_TelemetrySubscribe(client, topicId, isFromOldest, &subscriber);
+    }
+    if (returnCode != DJI_ERROR_SYSTEM_MODULE_CODE_SUCCESS) {
+        fprintf(stderr, "Subscribe topic %s error, stat = 0x%08llX\n", topicName, (unsigned long long) returnCode);
+        return 1;
+    }
+
+    while (!s_isTelemetryEchoStopped && (maxCount == 0 || printedCount < maxCount)) {
+        returnCode = DjiTest_TelemetrySubscriberReceive(&subscriber, &sample, DJI_TELEMETRY_ECHO_RECEIVE_TIMEOUT_MS);
+        if (returnCode == DJI_ERROR_SYSTEM_MODULE_CODE_TIMEOUT) {
+            continue;
+        }
+        if (returnCode != DJI_ERROR_SYSTEM_MODULE_CODE_SUCCESS) {
+            fprintf(stderr, "Publisher of %s is gone.\n", topicName);
+            result = 1;
+            break;
+        }
+
+        DjiTest_TelemetryFormatSample(&schema, sample.data, sample.len, text, sizeof(text));
+        /* Formatted from the shared memory, printed only if the slot was not overwritten meanwhile. */
+        if (DjiTest_TelemetrySubscriberRelease(&subscriber, &sample) != DJI_ERROR_SYSTEM_MODULE_CODE_SUCCESS) {
+            continue;
+        }
+        if (printf("%llu %llu.%06llu %s\n", (unsigned long long) sample.seq,
+                   (unsigned long long) (sample.timeUs / 1000000), (unsigned long long) (sample.timeUs % 1000000),
+                   text) < 0) {
+            break;
+        }
+        printedCount++;
+    }
+
+    if (isVerbose) {
+        fprintf(stderr, "received %llu, lost %llu, torn %llu, waited %llu\n",
+                (unsigned long long) subscriber.statistics.receivedCount,
+                (unsigned long long) subscriber.statistics.lostCount,
+                (unsigned long long) subscriber.statistics.tornCount,
+                (unsigned long long) subscriber.statistics.waitCount);
+    }
+
+    DjiTest_TelemetryUnsubscribe(&subscriber);
+
+    return result;
+}
+
+static void DjiTelemetryEcho_HandleSignal(int signalNumber)
+{
+    (void) signalNumber;
+    s_isTelemetryEchoStopped = 1;
+}
+
+static void DjiTelemetryEcho_PrintUsage(const char *program)
+{
+    fprintf(stderr, "Usage: %s [-b bus] -l | -t topic [-n count] [-o] [-v]\n"
+                    "  -b  bus name, default \"%s\"\n"
+                    "  -l  list the topics and their schemas\n"
+                    "  -t  print the samples of the topic, one line each: seq, monotonic time, fields\n"
+                    "  -n  stop after count samples, default never\n"
+                    "  -o  start with the oldest sample still in the ring instead of the next one\n"
+                    "  -v  print the received, lost and torn samples to stderr at the end\n",
+            program, DJI_TEST_TELEMETRY_BUS_DEFAULT_NAME);
+}
+
+/****************** (C) COPYRIGHT DJI Innovations *****END OF FILE****/